@@ -48,6 +48,8 @@ public:
   bool isReadOnly(StringRef functionName);
   bool isMemoryless(StringRef functionName);
 
+  static bool isAnAllocatorCall(CallInst *call);
+
 private:
   std::set<Function *> CGUnderMain;
   // TODO: These should become objects representing the full usage of these
@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/AllocAA.hpp"
+#include "noelle/core/LibraryFunctions.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
@@ -33,9 +34,14 @@ static cl::opt<int> Verbose(
     cl::Hidden,
     cl::desc("Verbose output (0: disabled, 1: minimal, 2: maximal"));
 
+/*
+ * Functions that allocate a new heap object.
+ */
+static const std::set<std::string> allocators{ "malloc", "calloc" };
+
 bool AllocAA::doInitialization(Module &M) {
   this->readOnlyFunctionNames = {};
-  this->allocatorFunctionNames = { "malloc", "calloc" };
+  this->allocatorFunctionNames = allocators;
   this->memorylessFunctionNames = {
     "sqrt",
     "sqrtf",
@@ -193,13 +199,23 @@ bool AllocAA::areIdenticalGEPAccessesInSameLoop(GetElementPtrInst *gep1,
 }
 
 bool AllocAA::isReadOnly(StringRef functionName) {
-  return readOnlyFunctionNames.find(functionName)
-         != readOnlyFunctionNames.end();
+  return (readOnlyFunctionNames.find(functionName)
+          != readOnlyFunctionNames.end())
+         || LibraryFunctions::isReadOnly(functionName);
+}
+
+bool AllocAA::isAnAllocatorCall(CallInst *call) {
+  auto callee = call->getCalledFunction();
+  if (callee == nullptr) {
+    return false;
+  }
+  return allocators.find(callee->getName()) != allocators.end();
 }
 
 bool AllocAA::isMemoryless(StringRef functionName) {
-  return memorylessFunctionNames.find(functionName)
-         != memorylessFunctionNames.end();
+  return (memorylessFunctionNames.find(functionName)
+          != memorylessFunctionNames.end())
+         || LibraryFunctions::isPure(functionName);
 }
 
 void AllocAA::collectCGUnderFunctionMain(Module &M, CallGraph &callGraph) {
@@ -396,7 +412,7 @@ bool AllocAA::isPrimitiveArray(Value *V,
       auto calleeFn = callUser->getCalledFunction();
       if (calleeFn != nullptr) {
         auto fnName = calleeFn->getName();
-        if (readOnlyFunctionNames.find(fnName) != readOnlyFunctionNames.end())
+        if (this->isReadOnly(fnName))
           continue;
       }
     }
@@ -29,13 +29,49 @@ class Architecture {
 public:
   Architecture();
 
+  /*
+   * Cores the compiler is allowed to run on, which are the ones of its
+   * affinity mask capped by the CPU quota of its control group.
+   * Physical cores are the ones with an allowed logical core.
+   */
   static uint32_t getNumberOfLogicalCores(void);
 
   static uint32_t getNumberOfPhysicalCores(void);
 
+  /*
+   * Number of last level caches and of NUMA nodes shared by the allowed
+   * logical cores.
+   */
+  static uint32_t getNumberOfLastLevelCaches(void);
+
+  static uint32_t getNumberOfNUMANodes(void);
+
   static int32_t getCacheLineBytes(void);
 
+  /*
+   * Sizes of the caches, which are the ones of the machine that runs the
+   * compiler if they are known. Otherwise, common sizes are assumed.
+   */
+  static uint64_t getL1DataCacheBytes(void);
+
+  static uint64_t getL2CacheBytes(void);
+
+  static uint64_t getLastLevelCacheBytes(void);
+
 private:
+  struct Topology;
+
+  static const Topology &getTopology(void);
+
+  static uint64_t getCacheBytes(int cacheParameter,
+                                uint32_t level,
+                                uint64_t defaultBytes);
+
+  static std::string getCoreDirectory(uint32_t core);
+
+  static bool readUnsigned(std::string const &fileName, uint64_t &value);
+
+  static std::vector<uint32_t> parseList(std::string const &list);
 };
 
 } // namespace llvm::noelle
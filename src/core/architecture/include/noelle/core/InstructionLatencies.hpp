@@ -0,0 +1,79 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Cycles that the instructions of the program take on a micro-architecture.
+ *
+ * Every opcode and intrinsic has a latency (the cycles until its result can
+ * be used) and a reciprocal throughput (the cycles between the starts of two
+ * independent instances of it). Opcodes and intrinsics missing from the
+ * table of a micro-architecture take one cycle.
+ */
+class InstructionLatencies {
+public:
+  /*
+   * Use the table of @microArchitecture, or the generic one if it is not
+   * shipped (see getMicroArchitectures).
+   */
+  InstructionLatencies(const std::string &microArchitecture);
+
+  const std::string &getMicroArchitecture(void) const;
+
+  double getLatency(Instruction *inst) const;
+
+  double getReciprocalThroughput(Instruction *inst) const;
+
+  /*
+   * Return the micro-architecture of the shipped ones that is closest to the
+   * one of the current machine.
+   */
+  static std::string getHostMicroArchitecture(void);
+
+  static std::vector<std::string> getMicroArchitectures(void);
+
+private:
+  struct Cost {
+    double latency;
+    double reciprocalThroughput;
+  };
+
+  std::string microArchitecture;
+  std::unordered_map<unsigned, Cost> opcodeCosts;
+  std::unordered_map<unsigned, Cost> intrinsicCosts;
+
+  Cost getCost(Instruction *inst) const;
+
+  void setGenericCosts(void);
+
+  void setSkylakeCosts(void);
+
+  void setZen2Costs(void);
+
+  void setCortexA72Costs(void);
+};
+
+} // namespace llvm::noelle
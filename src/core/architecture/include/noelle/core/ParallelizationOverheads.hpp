@@ -0,0 +1,103 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Costs of running a loop in parallel on the current machine.
+ *
+ * The costs are measured by the micro-benchmarks of noelle-overheads, which
+ * write them to a model file with one "NAME VALUE" line per cost (lines that
+ * start with '#' are ignored). Costs missing from the file keep their
+ * default values.
+ */
+class ParallelizationOverheads {
+public:
+  static constexpr const char *defaultFileName = "noelle_overheads.txt";
+
+  ParallelizationOverheads();
+
+  /*
+   * Load the costs from the model file @fileName.
+   *
+   * @return false if the file cannot be read.
+   */
+  bool load(const std::string &fileName);
+
+  /*
+   * Cycles to dispatch the tasks of an invocation of a loop and to wait for
+   * them to finish.
+   */
+  double getDispatchCycles(void) const;
+
+  /*
+   * Cycles a task spends to load a live-in from the environment.
+   */
+  double getLiveInCycles(void) const;
+
+  /*
+   * Cycles to store a live-out of a task to the environment and to read it
+   * back once the tasks are done.
+   */
+  double getLiveOutCycles(void) const;
+
+  /*
+   * Cycles between the signal of a HELIX sequential segment by a core and
+   * the end of the wait of the next core.
+   */
+  double getSequentialSegmentCycles(void) const;
+
+  /*
+   * Cycles a DSWP stage spends to push a value to a queue of the runtime and
+   * to pop a value from it.
+   */
+  double getQueuePushCycles(void) const;
+
+  double getQueuePopCycles(void) const;
+
+  /*
+   * Cycles needed to execute an instruction on average.
+   */
+  double getCyclesPerInstruction(void) const;
+
+  /*
+   * Costs of running a loop on an accelerator (e.g., a GPU): the cycles to
+   * launch a kernel and wait for it, the cycles to move a byte between the
+   * memory of the host and the one of the accelerator, and how many times the
+   * accelerator runs the iterations of a DOALL loop faster than a core.
+   */
+  double getOffloadLaunchCycles(void) const;
+
+  double getOffloadCyclesPerByte(void) const;
+
+  double getOffloadSpeedup(void) const;
+
+private:
+  std::map<std::string, double> costs;
+
+  double getCost(const std::string &name) const;
+};
+
+} // namespace llvm::noelle
@@ -19,24 +19,352 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <unistd.h>
+#include <sched.h>
+#include <fstream>
+
 #include "noelle/core/Architecture.hpp"
 
 namespace llvm::noelle {
 
+/*
+ * Topology of the machine that runs the compiler, restricted to the logical
+ * cores the compiler is allowed to run on.
+ */
+struct Architecture::Topology {
+  std::vector<uint32_t> allowedCores;
+  uint32_t physicalCores;
+  uint32_t lastLevelCaches;
+  uint32_t nodes;
+  uint32_t quotaCores;
+};
+
 Architecture::Architecture() {
   return;
 }
 
 uint32_t Architecture::getNumberOfLogicalCores(void) {
-  return std::thread::hardware_concurrency();
+  auto &topology = getTopology();
+  uint32_t cores = topology.allowedCores.size();
+  if (true && (topology.quotaCores > 0) && (topology.quotaCores < cores)) {
+    cores = topology.quotaCores;
+  }
+
+  return cores;
 }
 
 uint32_t Architecture::getNumberOfPhysicalCores(void) {
-  return getNumberOfLogicalCores() / 2;
+  auto &topology = getTopology();
+  auto cores = topology.physicalCores;
+  if (true && (topology.quotaCores > 0) && (topology.quotaCores < cores)) {
+    cores = topology.quotaCores;
+  }
+
+  return cores;
+}
+
+uint32_t Architecture::getNumberOfLastLevelCaches(void) {
+  return getTopology().lastLevelCaches;
+}
+
+uint32_t Architecture::getNumberOfNUMANodes(void) {
+  return getTopology().nodes;
 }
 
 int32_t Architecture::getCacheLineBytes(void) {
-  return 64;
+  static int32_t bytes = 0;
+  if (bytes == 0) {
+
+    /*
+     * Common machines have lines of 64 bytes.
+     */
+    bytes = 64;
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    auto systemBytes = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+#else
+    long systemBytes = 0;
+#endif
+    uint64_t sysfsBytes = 0;
+    auto coreDirectory = getCoreDirectory(getTopology().allowedCores[0]);
+    if (systemBytes > 0) {
+      bytes = (int32_t)systemBytes;
+    } else if (true
+               && readUnsigned(coreDirectory
+                                   + "cache/index0/coherency_line_size",
+                               sysfsBytes)
+               && (sysfsBytes > 0)) {
+      bytes = (int32_t)sysfsBytes;
+    }
+  }
+
+  return bytes;
+}
+
+uint64_t Architecture::getL1DataCacheBytes(void) {
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  return getCacheBytes(_SC_LEVEL1_DCACHE_SIZE, 1, 32 * 1024);
+#else
+  return getCacheBytes(-1, 1, 32 * 1024);
+#endif
+}
+
+uint64_t Architecture::getL2CacheBytes(void) {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  return getCacheBytes(_SC_LEVEL2_CACHE_SIZE, 2, 256 * 1024);
+#else
+  return getCacheBytes(-1, 2, 256 * 1024);
+#endif
+}
+
+uint64_t Architecture::getLastLevelCacheBytes(void) {
+#ifdef _SC_LEVEL3_CACHE_SIZE
+  auto bytes = getCacheBytes(_SC_LEVEL3_CACHE_SIZE, 3, 0);
+#else
+  auto bytes = getCacheBytes(-1, 3, 0);
+#endif
+  if (bytes > 0) {
+    return bytes;
+  }
+
+  /*
+   * The machine might not have a third level of cache.
+   */
+  return getL2CacheBytes();
+}
+
+uint64_t Architecture::getCacheBytes(int cacheParameter,
+                                     uint32_t level,
+                                     uint64_t defaultBytes) {
+
+  /*
+   * The system reports 0 or a negative value if it does not know the size.
+   */
+  if (cacheParameter >= 0) {
+    auto bytes = sysconf(cacheParameter);
+    if (bytes > 0) {
+      return (uint64_t)bytes;
+    }
+  }
+
+  /*
+   * Look for the cache in sysfs (e.g., on machines where the C library does
+   * not know the cache hierarchy).
+   * Instruction caches are skipped.
+   */
+  auto coreDirectory = getCoreDirectory(getTopology().allowedCores[0]);
+  for (auto index = 0;; index++) {
+    auto cacheDirectory =
+        coreDirectory + "cache/index" + std::to_string(index) + "/";
+    uint64_t cacheLevel;
+    if (!readUnsigned(cacheDirectory + "level", cacheLevel)) {
+      break;
+    }
+    std::string type, size;
+    std::ifstream typeFile(cacheDirectory + "type");
+    std::ifstream sizeFile(cacheDirectory + "size");
+    if (false || (cacheLevel != level) || !(typeFile >> type)
+        || (type == "Instruction") || !(sizeFile >> size)) {
+      continue;
+    }
+    uint64_t bytes = 0;
+    auto digits = 0u;
+    while (true && (digits < size.size()) && isdigit(size[digits])) {
+      bytes = (bytes * 10) + (size[digits] - '0');
+      digits++;
+    }
+    if (digits < size.size()) {
+      switch (size[digits]) {
+        case 'K':
+          bytes *= 1024;
+          break;
+        case 'M':
+          bytes *= 1024 * 1024;
+          break;
+        case 'G':
+          bytes *= 1024 * 1024 * 1024;
+          break;
+      }
+    }
+    if (bytes > 0) {
+      return bytes;
+    }
+  }
+
+  return defaultBytes;
+}
+
+const Architecture::Topology &Architecture::getTopology(void) {
+  static Topology *topology = nullptr;
+  if (topology != nullptr) {
+    return *topology;
+  }
+  topology = new Topology();
+
+  /*
+   * Fetch the logical cores we are allowed to run on.
+   */
+  cpu_set_t allowedSet;
+  CPU_ZERO(&allowedSet);
+  if (sched_getaffinity(0, sizeof(allowedSet), &allowedSet) == 0) {
+    for (auto core = 0; core < CPU_SETSIZE; core++) {
+      if (CPU_ISSET(core, &allowedSet)) {
+        topology->allowedCores.push_back(core);
+      }
+    }
+  }
+  if (topology->allowedCores.size() == 0) {
+    auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto core = 0u; core < cores; core++) {
+      topology->allowedCores.push_back(core);
+    }
+  }
+
+  /*
+   * Group the allowed logical cores by physical core and by last level cache.
+   * If the topology is not exposed, then we assume every physical core has
+   * two logical cores.
+   */
+  std::set<std::pair<uint64_t, uint64_t>> physicalCores;
+  std::set<std::string> lastLevelCaches;
+  for (auto core : topology->allowedCores) {
+    auto coreDirectory = getCoreDirectory(core);
+    uint64_t package, coreID;
+    if (true && readUnsigned(coreDirectory + "topology/physical_package_id",
+                             package)
+        && readUnsigned(coreDirectory + "topology/core_id", coreID)) {
+      physicalCores.insert(std::make_pair(package, coreID));
+    }
+
+    /*
+     * The last level cache is the one with the highest level.
+     */
+    uint64_t highestLevel = 0;
+    std::string sharedCores;
+    for (auto index = 0;; index++) {
+      auto cacheDirectory =
+          coreDirectory + "cache/index" + std::to_string(index) + "/";
+      uint64_t level;
+      if (!readUnsigned(cacheDirectory + "level", level)) {
+        break;
+      }
+      std::ifstream sharedFile(cacheDirectory + "shared_cpu_list");
+      std::string cores;
+      if (true && (level >= highestLevel) && (sharedFile >> cores)) {
+        highestLevel = level;
+        sharedCores = cores;
+      }
+    }
+    if (sharedCores != "") {
+      lastLevelCaches.insert(sharedCores);
+    }
+  }
+  topology->physicalCores = physicalCores.size();
+  if (topology->physicalCores == 0) {
+    topology->physicalCores =
+        std::max((uint32_t)topology->allowedCores.size() / 2, 1u);
+  }
+  topology->lastLevelCaches = std::max((uint32_t)lastLevelCaches.size(), 1u);
+
+  /*
+   * Count the NUMA nodes that include allowed logical cores.
+   */
+  topology->nodes = 0;
+  for (auto node = 0;; node++) {
+    auto nodeDirectory =
+        "/sys/devices/system/node/node" + std::to_string(node) + "/";
+    std::ifstream cpuListFile(nodeDirectory + "cpulist");
+    if (!cpuListFile.is_open()) {
+      if (access(nodeDirectory.c_str(), F_OK) != 0) {
+        break;
+      }
+      continue;
+    }
+    std::string cpuList;
+    cpuListFile >> cpuList;
+    auto cores = parseList(cpuList);
+    auto hasAllowedCores = false;
+    for (auto core : cores) {
+      if (std::find(topology->allowedCores.begin(),
+                    topology->allowedCores.end(),
+                    core)
+          != topology->allowedCores.end()) {
+        hasAllowedCores = true;
+        break;
+      }
+    }
+    if (hasAllowedCores) {
+      topology->nodes++;
+    }
+  }
+  topology->nodes = std::max(topology->nodes, 1u);
+
+  /*
+   * Fetch the CPU quota of the control group (cgroup v2, then v1).
+   */
+  topology->quotaCores = 0;
+  std::ifstream quotaV2File("/sys/fs/cgroup/cpu.max");
+  std::string quotaV2;
+  uint64_t period = 0;
+  if (true && (quotaV2File >> quotaV2 >> period) && (quotaV2 != "max")
+      && (period > 0)) {
+    auto quota = std::stoull(quotaV2);
+    topology->quotaCores = std::max((quota + period - 1) / period, 1ULL);
+  } else {
+    for (auto cgroupDirectory :
+         { "/sys/fs/cgroup/cpu/", "/sys/fs/cgroup/cpu,cpuacct/" }) {
+      std::ifstream quotaFile(std::string(cgroupDirectory)
+                              + "cpu.cfs_quota_us");
+      std::ifstream periodFile(std::string(cgroupDirectory)
+                               + "cpu.cfs_period_us");
+      int64_t quota = 0;
+      if (true && (quotaFile >> quota) && (periodFile >> period)
+          && (quota > 0) && (period > 0)) {
+        topology->quotaCores =
+            std::max((uint64_t)((quota + period - 1) / period), (uint64_t)1);
+        break;
+      }
+    }
+  }
+
+  return *topology;
+}
+
+std::string Architecture::getCoreDirectory(uint32_t core) {
+  return "/sys/devices/system/cpu/cpu" + std::to_string(core) + "/";
+}
+
+bool Architecture::readUnsigned(std::string const &fileName, uint64_t &value) {
+  std::ifstream file(fileName);
+  if (!(file >> value)) {
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<uint32_t> Architecture::parseList(std::string const &list) {
+
+  /*
+   * Lists are ranges separated by commas (e.g., "0-3,8,10-11").
+   */
+  std::vector<uint32_t> elements;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range == "") {
+      continue;
+    }
+    auto separator = range.find('-');
+    auto first = std::stoul(range.substr(0, separator));
+    auto last = (separator == std::string::npos)
+                    ? first
+                    : std::stoul(range.substr(separator + 1));
+    for (auto element = first; element <= last; element++) {
+      elements.push_back(element);
+    }
+  }
+
+  return elements;
 }
 
 } // namespace llvm::noelle
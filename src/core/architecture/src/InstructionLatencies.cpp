@@ -0,0 +1,340 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/Host.h"
+#include "noelle/core/InstructionLatencies.hpp"
+
+namespace llvm::noelle {
+
+InstructionLatencies::InstructionLatencies(
+    const std::string &microArchitecture)
+  : microArchitecture{ microArchitecture } {
+
+  /*
+   * Set the costs of the micro-architecture.
+   */
+  if (microArchitecture == "skylake") {
+    this->setSkylakeCosts();
+  } else if (microArchitecture == "zen2") {
+    this->setZen2Costs();
+  } else if (microArchitecture == "cortex-a72") {
+    this->setCortexA72Costs();
+  } else {
+    if (microArchitecture != "generic") {
+      errs() << "InstructionLatencies: Warning = micro-architecture "
+             << microArchitecture << " is unknown. Using generic\n";
+      this->microArchitecture = "generic";
+    }
+    this->setGenericCosts();
+  }
+
+  /*
+   * Set the costs of the instructions that do not generate machine code
+   * (they are folded into their users).
+   */
+  std::vector<unsigned> freeOpcodes = { Instruction::PHI,
+                                        Instruction::GetElementPtr,
+                                        Instruction::BitCast,
+                                        Instruction::PtrToInt,
+                                        Instruction::IntToPtr,
+                                        Instruction::Trunc,
+                                        Instruction::ZExt,
+                                        Instruction::SExt };
+  for (auto opcode : freeOpcodes) {
+    this->opcodeCosts[opcode] = { 0, 0 };
+  }
+
+  return;
+}
+
+const std::string &InstructionLatencies::getMicroArchitecture(void) const {
+  return this->microArchitecture;
+}
+
+double InstructionLatencies::getLatency(Instruction *inst) const {
+  return this->getCost(inst).latency;
+}
+
+double InstructionLatencies::getReciprocalThroughput(Instruction *inst) const {
+  return this->getCost(inst).reciprocalThroughput;
+}
+
+InstructionLatencies::Cost InstructionLatencies::getCost(
+    Instruction *inst) const {
+
+  /*
+   * Intrinsics that only carry information for the compiler are free.
+   */
+  if (false || isa<DbgInfoIntrinsic>(inst)
+      || inst->isLifetimeStartOrEnd()) {
+    return { 0, 0 };
+  }
+
+  /*
+   * Check the intrinsics.
+   */
+  if (auto intrinsicInst = dyn_cast<IntrinsicInst>(inst)) {
+    auto it = this->intrinsicCosts.find(intrinsicInst->getIntrinsicID());
+    if (it != this->intrinsicCosts.end()) {
+      return it->second;
+    }
+  }
+
+  /*
+   * Check the opcodes.
+   */
+  auto it = this->opcodeCosts.find(inst->getOpcode());
+  if (it != this->opcodeCosts.end()) {
+    return it->second;
+  }
+
+  return { 1, 1 };
+}
+
+std::string InstructionLatencies::getHostMicroArchitecture(void) {
+  auto cpu = sys::getHostCPUName().str();
+
+  /*
+   * Map the CPU to the shipped micro-architecture of its family.
+   */
+  for (auto intelCore : { "haswell",
+                          "broadwell",
+                          "skylake",
+                          "cannonlake",
+                          "cascadelake",
+                          "cooperlake",
+                          "icelake",
+                          "tigerlake" }) {
+    if (cpu.find(intelCore) == 0) {
+      return "skylake";
+    }
+  }
+  if (cpu.find("znver") == 0) {
+    return "zen2";
+  }
+  if (false || (cpu.find("cortex-a") == 0) || (cpu.find("neoverse") == 0)) {
+    return "cortex-a72";
+  }
+
+  return "generic";
+}
+
+std::vector<std::string> InstructionLatencies::getMicroArchitectures(void) {
+  return { "generic", "skylake", "zen2", "cortex-a72" };
+}
+
+/*
+ * The costs below are the ones of the scalar instructions that the opcodes
+ * are lowered to. Divisions and square roots take the cycles of 32-bit integer
+ * and double-precision operands. Loads take the cycles of L1 hits. Calls take
+ * the cycles of the call and the return only (not the callee).
+ */
+void InstructionLatencies::setGenericCosts(void) {
+  this->opcodeCosts = { { Instruction::Mul, { 3, 1 } },
+                        { Instruction::UDiv, { 25, 10 } },
+                        { Instruction::SDiv, { 25, 10 } },
+                        { Instruction::URem, { 25, 10 } },
+                        { Instruction::SRem, { 25, 10 } },
+                        { Instruction::FAdd, { 4, 1 } },
+                        { Instruction::FSub, { 4, 1 } },
+                        { Instruction::FMul, { 4, 1 } },
+                        { Instruction::FDiv, { 15, 5 } },
+                        { Instruction::FRem, { 40, 40 } },
+                        { Instruction::FCmp, { 3, 1 } },
+                        { Instruction::SIToFP, { 4, 1 } },
+                        { Instruction::UIToFP, { 4, 1 } },
+                        { Instruction::FPToSI, { 5, 1 } },
+                        { Instruction::FPToUI, { 5, 1 } },
+                        { Instruction::FPExt, { 4, 1 } },
+                        { Instruction::FPTrunc, { 4, 1 } },
+                        { Instruction::Load, { 4, 1 } },
+                        { Instruction::Store, { 1, 1 } },
+                        { Instruction::AtomicRMW, { 20, 20 } },
+                        { Instruction::AtomicCmpXchg, { 20, 20 } },
+                        { Instruction::Fence, { 30, 30 } },
+                        { Instruction::Call, { 5, 2 } },
+                        { Instruction::Invoke, { 5, 2 } } };
+  this->intrinsicCosts = { { Intrinsic::sqrt, { 20, 8 } },
+                           { Intrinsic::fma, { 5, 1 } },
+                           { Intrinsic::fmuladd, { 5, 1 } },
+                           { Intrinsic::memcpy, { 30, 30 } },
+                           { Intrinsic::memmove, { 30, 30 } },
+                           { Intrinsic::memset, { 30, 30 } } };
+
+  return;
+}
+
+void InstructionLatencies::setSkylakeCosts(void) {
+  this->opcodeCosts = { { Instruction::Add, { 1, 0.25 } },
+                        { Instruction::Sub, { 1, 0.25 } },
+                        { Instruction::And, { 1, 0.25 } },
+                        { Instruction::Or, { 1, 0.25 } },
+                        { Instruction::Xor, { 1, 0.25 } },
+                        { Instruction::Shl, { 1, 0.5 } },
+                        { Instruction::LShr, { 1, 0.5 } },
+                        { Instruction::AShr, { 1, 0.5 } },
+                        { Instruction::ICmp, { 1, 0.25 } },
+                        { Instruction::Select, { 1, 0.5 } },
+                        { Instruction::Br, { 1, 0.5 } },
+                        { Instruction::Mul, { 3, 1 } },
+                        { Instruction::UDiv, { 26, 6 } },
+                        { Instruction::SDiv, { 26, 6 } },
+                        { Instruction::URem, { 26, 6 } },
+                        { Instruction::SRem, { 26, 6 } },
+                        { Instruction::FAdd, { 4, 0.5 } },
+                        { Instruction::FSub, { 4, 0.5 } },
+                        { Instruction::FMul, { 4, 0.5 } },
+                        { Instruction::FDiv, { 14, 4 } },
+                        { Instruction::FRem, { 40, 40 } },
+                        { Instruction::FCmp, { 3, 1 } },
+                        { Instruction::SIToFP, { 5, 1 } },
+                        { Instruction::UIToFP, { 5, 1 } },
+                        { Instruction::FPToSI, { 6, 1 } },
+                        { Instruction::FPToUI, { 6, 1 } },
+                        { Instruction::FPExt, { 5, 1 } },
+                        { Instruction::FPTrunc, { 5, 1 } },
+                        { Instruction::Load, { 5, 0.5 } },
+                        { Instruction::Store, { 1, 1 } },
+                        { Instruction::AtomicRMW, { 18, 18 } },
+                        { Instruction::AtomicCmpXchg, { 18, 18 } },
+                        { Instruction::Fence, { 33, 33 } },
+                        { Instruction::Call, { 4, 2 } },
+                        { Instruction::Invoke, { 4, 2 } } };
+  this->intrinsicCosts = { { Intrinsic::sqrt, { 18, 6 } },
+                           { Intrinsic::fma, { 4, 0.5 } },
+                           { Intrinsic::fmuladd, { 4, 0.5 } },
+                           { Intrinsic::fabs, { 1, 0.33 } },
+                           { Intrinsic::minnum, { 4, 0.5 } },
+                           { Intrinsic::maxnum, { 4, 0.5 } },
+                           { Intrinsic::ctpop, { 3, 1 } },
+                           { Intrinsic::ctlz, { 3, 1 } },
+                           { Intrinsic::cttz, { 3, 1 } },
+                           { Intrinsic::memcpy, { 25, 25 } },
+                           { Intrinsic::memmove, { 25, 25 } },
+                           { Intrinsic::memset, { 25, 25 } } };
+
+  return;
+}
+
+void InstructionLatencies::setZen2Costs(void) {
+  this->opcodeCosts = { { Instruction::Add, { 1, 0.25 } },
+                        { Instruction::Sub, { 1, 0.25 } },
+                        { Instruction::And, { 1, 0.25 } },
+                        { Instruction::Or, { 1, 0.25 } },
+                        { Instruction::Xor, { 1, 0.25 } },
+                        { Instruction::Shl, { 1, 0.5 } },
+                        { Instruction::LShr, { 1, 0.5 } },
+                        { Instruction::AShr, { 1, 0.5 } },
+                        { Instruction::ICmp, { 1, 0.25 } },
+                        { Instruction::Select, { 1, 0.25 } },
+                        { Instruction::Br, { 1, 0.5 } },
+                        { Instruction::Mul, { 3, 1 } },
+                        { Instruction::UDiv, { 25, 20 } },
+                        { Instruction::SDiv, { 25, 20 } },
+                        { Instruction::URem, { 25, 20 } },
+                        { Instruction::SRem, { 25, 20 } },
+                        { Instruction::FAdd, { 3, 0.5 } },
+                        { Instruction::FSub, { 3, 0.5 } },
+                        { Instruction::FMul, { 3, 0.5 } },
+                        { Instruction::FDiv, { 13, 4.5 } },
+                        { Instruction::FRem, { 40, 40 } },
+                        { Instruction::FCmp, { 2, 1 } },
+                        { Instruction::SIToFP, { 4, 1 } },
+                        { Instruction::UIToFP, { 4, 1 } },
+                        { Instruction::FPToSI, { 5, 1 } },
+                        { Instruction::FPToUI, { 5, 1 } },
+                        { Instruction::FPExt, { 4, 1 } },
+                        { Instruction::FPTrunc, { 4, 1 } },
+                        { Instruction::Load, { 4, 0.5 } },
+                        { Instruction::Store, { 1, 1 } },
+                        { Instruction::AtomicRMW, { 8, 8 } },
+                        { Instruction::AtomicCmpXchg, { 8, 8 } },
+                        { Instruction::Fence, { 8, 8 } },
+                        { Instruction::Call, { 4, 2 } },
+                        { Instruction::Invoke, { 4, 2 } } };
+  this->intrinsicCosts = { { Intrinsic::sqrt, { 20, 9 } },
+                           { Intrinsic::fma, { 5, 0.5 } },
+                           { Intrinsic::fmuladd, { 5, 0.5 } },
+                           { Intrinsic::fabs, { 1, 0.25 } },
+                           { Intrinsic::minnum, { 3, 0.5 } },
+                           { Intrinsic::maxnum, { 3, 0.5 } },
+                           { Intrinsic::ctpop, { 1, 0.25 } },
+                           { Intrinsic::ctlz, { 1, 0.25 } },
+                           { Intrinsic::cttz, { 2, 0.5 } },
+                           { Intrinsic::memcpy, { 25, 25 } },
+                           { Intrinsic::memmove, { 25, 25 } },
+                           { Intrinsic::memset, { 25, 25 } } };
+
+  return;
+}
+
+void InstructionLatencies::setCortexA72Costs(void) {
+  this->opcodeCosts = { { Instruction::Add, { 1, 0.5 } },
+                        { Instruction::Sub, { 1, 0.5 } },
+                        { Instruction::And, { 1, 0.5 } },
+                        { Instruction::Or, { 1, 0.5 } },
+                        { Instruction::Xor, { 1, 0.5 } },
+                        { Instruction::Shl, { 1, 0.5 } },
+                        { Instruction::LShr, { 1, 0.5 } },
+                        { Instruction::AShr, { 1, 0.5 } },
+                        { Instruction::ICmp, { 1, 0.5 } },
+                        { Instruction::Select, { 1, 0.5 } },
+                        { Instruction::Br, { 1, 1 } },
+                        { Instruction::Mul, { 3, 1 } },
+                        { Instruction::UDiv, { 12, 12 } },
+                        { Instruction::SDiv, { 12, 12 } },
+                        { Instruction::URem, { 15, 12 } },
+                        { Instruction::SRem, { 15, 12 } },
+                        { Instruction::FAdd, { 4, 0.5 } },
+                        { Instruction::FSub, { 4, 0.5 } },
+                        { Instruction::FMul, { 4, 0.5 } },
+                        { Instruction::FDiv, { 17, 10 } },
+                        { Instruction::FRem, { 60, 60 } },
+                        { Instruction::FCmp, { 3, 1 } },
+                        { Instruction::SIToFP, { 8, 1 } },
+                        { Instruction::UIToFP, { 8, 1 } },
+                        { Instruction::FPToSI, { 8, 1 } },
+                        { Instruction::FPToUI, { 8, 1 } },
+                        { Instruction::FPExt, { 3, 1 } },
+                        { Instruction::FPTrunc, { 3, 1 } },
+                        { Instruction::Load, { 4, 0.5 } },
+                        { Instruction::Store, { 1, 1 } },
+                        { Instruction::AtomicRMW, { 20, 20 } },
+                        { Instruction::AtomicCmpXchg, { 20, 20 } },
+                        { Instruction::Fence, { 30, 30 } },
+                        { Instruction::Call, { 4, 2 } },
+                        { Instruction::Invoke, { 4, 2 } } };
+  this->intrinsicCosts = { { Intrinsic::sqrt, { 32, 29 } },
+                           { Intrinsic::fma, { 7, 0.5 } },
+                           { Intrinsic::fmuladd, { 7, 0.5 } },
+                           { Intrinsic::fabs, { 3, 0.5 } },
+                           { Intrinsic::minnum, { 3, 0.5 } },
+                           { Intrinsic::maxnum, { 3, 0.5 } },
+                           { Intrinsic::ctlz, { 1, 0.5 } },
+                           { Intrinsic::memcpy, { 40, 40 } },
+                           { Intrinsic::memmove, { 40, 40 } },
+                           { Intrinsic::memset, { 40, 40 } } };
+
+  return;
+}
+
+} // namespace llvm::noelle
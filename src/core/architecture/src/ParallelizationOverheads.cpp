@@ -0,0 +1,119 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include "noelle/core/ParallelizationOverheads.hpp"
+
+namespace llvm::noelle {
+
+ParallelizationOverheads::ParallelizationOverheads()
+  : costs{ { "dispatch_cycles", 20000 },
+           { "live_in_cycles", 100 },
+           { "live_out_cycles", 200 },
+           { "sequential_segment_cycles", 300 },
+           { "queue_push_cycles", 50 },
+           { "queue_pop_cycles", 50 },
+           { "cycles_per_instruction", 1 },
+           { "offload_launch_cycles", 50000 },
+           { "offload_cycles_per_byte", 0.3 },
+           { "offload_speedup", 100 } } {
+  return;
+}
+
+bool ParallelizationOverheads::load(const std::string &fileName) {
+  std::ifstream file(fileName);
+  if (!file.good()) {
+    return false;
+  }
+
+  /*
+   * Read the costs.
+   */
+  std::string line;
+  while (std::getline(file, line)) {
+    if (false || (line.size() == 0) || (line[0] == '#')) {
+      continue;
+    }
+    std::istringstream lineStream(line);
+    std::string name;
+    double value = 0;
+    if (!(lineStream >> name >> value)) {
+      continue;
+    }
+    if (this->costs.find(name) == this->costs.end()) {
+      errs() << "ParallelizationOverheads: Warning = cost " << name
+             << " in " << fileName << " is unknown\n";
+      continue;
+    }
+    if (value < 0) {
+      continue;
+    }
+    this->costs[name] = value;
+  }
+
+  return true;
+}
+
+double ParallelizationOverheads::getDispatchCycles(void) const {
+  return this->getCost("dispatch_cycles");
+}
+
+double ParallelizationOverheads::getLiveInCycles(void) const {
+  return this->getCost("live_in_cycles");
+}
+
+double ParallelizationOverheads::getLiveOutCycles(void) const {
+  return this->getCost("live_out_cycles");
+}
+
+double ParallelizationOverheads::getSequentialSegmentCycles(void) const {
+  return this->getCost("sequential_segment_cycles");
+}
+
+double ParallelizationOverheads::getQueuePushCycles(void) const {
+  return this->getCost("queue_push_cycles");
+}
+
+double ParallelizationOverheads::getQueuePopCycles(void) const {
+  return this->getCost("queue_pop_cycles");
+}
+
+double ParallelizationOverheads::getCyclesPerInstruction(void) const {
+  return this->getCost("cycles_per_instruction");
+}
+
+double ParallelizationOverheads::getOffloadLaunchCycles(void) const {
+  return this->getCost("offload_launch_cycles");
+}
+
+double ParallelizationOverheads::getOffloadCyclesPerByte(void) const {
+  return this->getCost("offload_cycles_per_byte");
+}
+
+double ParallelizationOverheads::getOffloadSpeedup(void) const {
+  return this->getCost("offload_speedup");
+}
+
+double ParallelizationOverheads::getCost(const std::string &name) const {
+  return this->costs.at(name);
+}
+
+} // namespace llvm::noelle
@@ -9,8 +9,12 @@ namespace llvm {
 // BitMatrix is a NxN bit-matrix that depicts whether a relation R
 // holds for a pair with indices (i,j) (i.e., R(i,j) = 0/1)
 // BitMatrix is intended for a dense, asymmetric relation R.
+// Each row is stored in its own sequence of 64-bit words, so rows can be
+// combined a word at a time.
 struct BitMatrix {
-  BitMatrix(uint32_t n = 1) : N(n), bv(n * n) {}
+  BitMatrix(uint32_t n = 1) {
+    resize(n);
+  }
 
   // Returns the size of BitVector
   uint32_t count() const;
@@ -34,8 +38,12 @@ struct BitMatrix {
   void dump(raw_ostream &fout) const;
 
 private:
+  typedef uint64_t Word;
+  static constexpr uint32_t BitsPerWord = 64;
+
   uint32_t N;
-  BitVector bv;
+  uint32_t wordsPerRow;
+  std::vector<Word> words;
 
   // For a given row returns the first col that is set.
   // Returns -1 if none found.
@@ -45,9 +53,18 @@ private:
   // Returns -1 if none found.
   int32_t nextSuccessor(uint32_t row, uint32_t prev) const;
 
-  // Returns the index corresponding to a pair (row.col)
-  // i.e., idx = row * N + col
-  uint32_t idx(uint32_t row, uint32_t col) const;
+  // Returns the index of the word that includes the pair (row,col)
+  // i.e., idx = row * wordsPerRow + col / BitsPerWord
+  uint64_t idx(uint32_t row, uint32_t col) const;
+
+  // Sets row dst to (row dst | row src)
+  // Returns true if row dst changed
+  bool orRows(uint32_t dst, uint32_t src);
+
+  // Computes in topOrder the rows sorted so that every row comes after its
+  // successors.
+  // Returns false if the relation has a cycle
+  bool computeReverseTopologicalOrder(std::vector<uint32_t> &topOrder) const;
 };
 
 } // namespace llvm
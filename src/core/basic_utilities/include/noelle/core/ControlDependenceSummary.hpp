@@ -0,0 +1,93 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <mutex>
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/DominatorSummary.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Control dependences among the basic blocks of a function.
+ *
+ * The summary of a function is computed once and it is shared by its users
+ * (e.g., the PDG builder and the schedulers) until the CFG of the function
+ * changes.
+ */
+class ControlDependenceSummary {
+public:
+  ControlDependenceSummary(Function &F);
+
+  ControlDependenceSummary() = delete;
+
+  /*
+   * Fetch the summary of @F.
+   * The summary is computed if @F does not have one, or if the CFG of @F has
+   * changed since its summary has been computed.
+   * This can be invoked by different threads at the same time.
+   */
+  static std::shared_ptr<const ControlDependenceSummary> fetch(Function &F);
+
+  /*
+   * Forget the summary of @F (e.g., because @F is going to be deleted).
+   */
+  static void invalidate(Function &F);
+
+  /*
+   * Return the basic blocks whose terminators control @bb.
+   * They follow the order they have been found, which is deterministic. A
+   * basic block is repeated for each of its CFG edges @bb is control dependent
+   * on.
+   */
+  const std::vector<BasicBlock *> &getControllingBasicBlocks(
+      BasicBlock *bb) const;
+
+  /*
+   * Check if @first dominates @second and @second post-dominates @first.
+   */
+  bool areControlEquivalent(BasicBlock *first, BasicBlock *second) const;
+
+  /*
+   * Check if @bb1 post-dominates @bb2.
+   */
+  bool postDominates(BasicBlock *bb1, BasicBlock *bb2) const;
+
+  /*
+   * Return the dominators of the function used to compute the summary.
+   */
+  const DominatorSummary &getDominators(void) const;
+
+private:
+  std::vector<BasicBlock *> cfg;
+  std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> controllingBBs;
+  std::unique_ptr<DominatorSummary> dominators;
+
+  static std::vector<BasicBlock *> encodeCFG(Function &F);
+
+  static std::mutex summariesMutex;
+  static std::unordered_map<Function *,
+                            std::shared_ptr<const ControlDependenceSummary>>
+      summaries;
+};
+
+} // namespace llvm::noelle
@@ -51,8 +51,21 @@ private:
   DomNodeSummary *parent;
   std::vector<DomNodeSummary *> children;
   DomNodeSummary *iDom;
+
+  /*
+   * Interval of the node in a depth-first visit of its tree.
+   * A node is an ancestor of another one iff its interval includes the other.
+   */
+  uint32_t dfsIn;
+  uint32_t dfsOut;
 };
 
+/*
+ * The nodes of a summary are shared (and reference counted) by the summaries
+ * created from it (e.g., copies, or the slices of the loops of a function).
+ * A slice includes only the nodes of its basic blocks; its nodes keep the
+ * relations they have in the whole tree (parent, children, level).
+ */
 class DomTreeSummary {
 public:
   DomTreeSummary(DominatorTree &DT);
@@ -65,15 +78,23 @@ public:
   raw_ostream &print(raw_ostream &stream, std::string prefixToUse = "") const;
 
 private:
-  DomTreeSummary(std::set<DTAliases::Node *> nodes);
-  DomTreeSummary(std::set<DomNodeSummary *> nodesSubset);
+  class Tree {
+  public:
+    Tree(bool post);
+
+    std::vector<DomNodeSummary> nodes;
+    std::unordered_map<BasicBlock *, DomNodeSummary *> bbNodeMap;
+    bool post;
+  };
 
   template <typename TreeType>
   std::set<DTAliases::Node *> collectNodesOfTree(TreeType &T);
-  std::set<DomNodeSummary *> filterNodes(std::set<DomNodeSummary *> &nodes,
-                                         std::set<BasicBlock *> &bbSubset);
   template <typename NodeType>
   void cloneNodes(std::set<NodeType *> &nodes);
+  void numberNodes(void);
+  bool isAncestor(DomNodeSummary *node1, DomNodeSummary *node2) const;
+  bool isIncluded(DomNodeSummary *node) const;
+  DomNodeSummary *getParentInSummary(DomNodeSummary *node) const;
 
 public:
   DomNodeSummary *getNode(BasicBlock *B) const;
@@ -86,14 +107,23 @@ public:
                                              DomNodeSummary *node2) const;
 
 private:
-  std::set<DomNodeSummary *> nodes;
-  std::unordered_map<BasicBlock *, DomNodeSummary *> bbNodeMap;
-  bool post;
+  std::shared_ptr<Tree> tree;
+
+  /*
+   * For slices: the root, within the slice, of the subtree of each node of
+   * the slice.
+   */
+  bool isSlice;
+  std::unordered_map<DomNodeSummary *, DomNodeSummary *> sliceRoots;
 };
 
 class DominatorSummary {
 public:
   DominatorSummary(DominatorTree &DT, PostDominatorTree &PDT);
+
+  /*
+   * Slice @DS to the basic blocks @bbSubset without copying its trees.
+   */
   DominatorSummary(DominatorSummary &DS, std::set<BasicBlock *> &bbSubset);
 
   void transferSummaryToClones(
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Properties of library functions (i.e., functions without a body in the
+ * module) described by the user in specification files.
+ *
+ * Each line of a specification file names a function followed by its
+ * properties:
+ *   <function name> <property> ...
+ * The properties are:
+ *   pure         the function does not access memory
+ *   readonly     the function only reads memory
+ *   argmemonly   the function only accesses memory pointed to by its arguments
+ *   thread-safe  invocations of the function can run concurrently
+ *   commutative  invocations of the function can run in any order
+ * Empty lines and lines starting with # are ignored.
+ *
+ * Specification files are given with -noelle-library-spec=FILE, which can be
+ * repeated (e.g., one file per library).
+ */
+class LibraryFunctions {
+public:
+  static bool isPure(StringRef functionName);
+
+  static bool isReadOnly(StringRef functionName);
+
+  static bool isArgMemOnly(StringRef functionName);
+
+  static bool isThreadSafe(StringRef functionName);
+
+  static bool isCommutative(StringRef functionName);
+
+  /*
+   * Add the attributes implied by the specifications (e.g., readnone for pure
+   * functions) to the declarations of @M, so the LLVM alias analyses rely on
+   * them as well.
+   * Return true if @M has been modified.
+   */
+  static bool addAttributesToDeclarations(Module &M);
+
+  /*
+   * Return a hash of the specifications loaded, which changes whenever the
+   * properties of a function do.
+   */
+  static uint64_t getHashOfSpecifications(void);
+};
+
+} // namespace llvm::noelle
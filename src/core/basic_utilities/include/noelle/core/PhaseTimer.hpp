@@ -0,0 +1,60 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "llvm/Support/Timer.h"
+
+namespace llvm::noelle {
+
+class PhaseTimerRecord;
+
+/*
+ * Time and resident memory of a phase of NOELLE (e.g., the construction of the
+ * PDG) from the creation of the object to its destruction.
+ *
+ * The phases are measured only when -noelle-time-passes, -time-passes, or
+ * -noelle-time-passes-json are given. All phases are reported together at
+ * exit: to the standard error (or -info-output-file) and, with
+ * -noelle-time-passes-json=FILE, to FILE as JSON.
+ *
+ * Only the thread that loaded NOELLE is measured. A phase invoked while it is
+ * already being measured (e.g., through recursion) is timed once.
+ */
+class PhaseTimer {
+public:
+  PhaseTimer(StringRef name, StringRef description);
+
+  PhaseTimer(const PhaseTimer &) = delete;
+
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+  ~PhaseTimer();
+
+  static bool isEnabled(void);
+
+private:
+  PhaseTimerRecord *record;
+  int64_t residentBytesAtStart;
+};
+
+} // namespace llvm::noelle
@@ -32,6 +32,31 @@ public:
   std::vector<Function *> queuePushes;
   std::vector<Function *> queuePops;
   std::vector<Type *> queueTypes;
+
+  /*
+   * Queues that move values in batches.
+   * These vectors are empty if the runtime does not provide batched queues.
+   */
+  std::vector<Function *> queueBatchedPushes;
+  std::vector<Function *> queueBatchedPops;
+  std::vector<Function *> queueBatchedFlushes;
+  std::vector<Type *> queueBatchedTypes;
+
+  /*
+   * Queues with exactly one producer and one consumer.
+   * These vectors are empty if the runtime does not provide such queues.
+   */
+  std::vector<Function *> queueSPSCPushes;
+  std::vector<Function *> queueSPSCPops;
+  std::vector<Type *> queueSPSCTypes;
+
+  /*
+   * Queues with slots of any number of bytes.
+   * These are nullptr if the runtime does not provide such queues.
+   */
+  Function *queueSlotPush = nullptr;
+  Function *queueSlotPop = nullptr;
+  Type *queueSlotType = nullptr;
 };
 
 } // namespace llvm
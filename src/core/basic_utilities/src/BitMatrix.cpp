@@ -4,111 +4,160 @@ namespace llvm {
 
 void BitMatrix::resize(uint32_t n) {
   N = n;
-  bv.clear();
-  bv.resize(n * n);
+  wordsPerRow = (n + BitsPerWord - 1) / BitsPerWord;
+  words.clear();
+  words.resize(((uint64_t)n) * wordsPerRow, 0);
 }
 
-uint32_t BitMatrix::idx(uint32_t row, uint32_t col) const {
+uint64_t BitMatrix::idx(uint32_t row, uint32_t col) const {
   assert(row < N);
   assert(col < N);
-  return row * N + col;
+  return ((uint64_t)row) * wordsPerRow + (col / BitsPerWord);
 }
 
 uint32_t BitMatrix::count() const {
-  return bv.count();
+  uint32_t total = 0;
+  for (auto word : words) {
+    total += countPopulation(word);
+  }
+
+  return total;
 }
 
 void BitMatrix::set(uint32_t row, uint32_t col, bool v) {
-  const uint32_t i = idx(row, col);
+  const uint64_t i = idx(row, col);
+  const Word mask = ((Word)1) << (col % BitsPerWord);
 
   if (v) {
-    bv.set(i);
+    words[i] |= mask;
   } else {
-    bv.reset(i);
+    words[i] &= ~mask;
   }
 }
 
 bool BitMatrix::test(uint32_t row, uint32_t col) const {
-  const uint32_t i = idx(row, col);
+  const uint64_t i = idx(row, col);
+  const Word mask = ((Word)1) << (col % BitsPerWord);
 
-  return bv.test(i);
+  return (words[i] & mask) != 0;
 }
 
 int32_t BitMatrix::firstSuccessor(uint32_t row) const {
-  const uint32_t rowBegin = N * row;
-  int32_t next = -1;
+  const Word *rowWords = words.data() + ((uint64_t)row) * wordsPerRow;
 
-  if (0 == rowBegin) {
-    next = bv.find_first();
-  } else {
-    next = bv.find_next(rowBegin - 1);
+  for (uint32_t w = 0; w < wordsPerRow; ++w) {
+    if (rowWords[w] != 0) {
+      return w * BitsPerWord + countTrailingZeros(rowWords[w]);
+    }
   }
 
-  if (-1 == next) {
-    return -1;
-  }
+  return -1;
+}
 
-  const uint32_t rowEnd = rowBegin + N;
-  if (((uint32_t)next) >= rowEnd) {
+int32_t BitMatrix::nextSuccessor(uint32_t row, uint32_t prev) const {
+  const uint32_t col = prev + 1;
+  if (col >= N) {
     return -1;
   }
+  const Word *rowWords = words.data() + ((uint64_t)row) * wordsPerRow;
 
-  return next - rowBegin;
-}
+  // Check the rest of the word that includes col
+  uint32_t w = col / BitsPerWord;
+  const Word remaining = rowWords[w] & (~((Word)0) << (col % BitsPerWord));
+  if (remaining != 0) {
+    return w * BitsPerWord + countTrailingZeros(remaining);
+  }
 
-int32_t BitMatrix::nextSuccessor(uint32_t row, uint32_t prev) const {
-  int32_t next = bv.find_next(N * row + prev);
-  if (-1 == next) {
-    return -1;
+  // Check the next words
+  for (++w; w < wordsPerRow; ++w) {
+    if (rowWords[w] != 0) {
+      return w * BitsPerWord + countTrailingZeros(rowWords[w]);
+    }
   }
 
-  const uint32_t rowBegin = N * row;
-  const uint32_t rowEnd = rowBegin + N;
-  if (((uint32_t)next) >= rowEnd) {
-    return -1;
+  return -1;
+}
+
+bool BitMatrix::orRows(uint32_t dst, uint32_t src) {
+  Word *dstWords = words.data() + ((uint64_t)dst) * wordsPerRow;
+  const Word *srcWords = words.data() + ((uint64_t)src) * wordsPerRow;
+
+  // The loop has no dependences between iterations so that the compiler can
+  // vectorize it (e.g., with AVX2 or AVX-512 when they are enabled)
+  Word changed = 0;
+  for (uint32_t w = 0; w < wordsPerRow; ++w) {
+    const Word merged = dstWords[w] | srcWords[w];
+    changed |= merged ^ dstWords[w];
+    dstWords[w] = merged;
   }
 
-  return next - rowBegin;
+  return changed != 0;
 }
 
-void BitMatrix::transitiveClosure() {
-  uint32_t nAdd = 0;
+bool BitMatrix::computeReverseTopologicalOrder(
+    std::vector<uint32_t> &topOrder) const {
 
-  typedef std::list<uint32_t> Worklist;
-  Worklist worklist;
+  // Collect the predecessors and the number of successors of each row
+  std::vector<std::vector<uint32_t>> predecessors(N);
+  std::vector<uint32_t> successorsLeft(N, 0);
   for (uint32_t i = 0; i < N; ++i) {
-    worklist.push_back(i);
+    for (int32_t j = firstSuccessor(i); j != -1; j = nextSuccessor(i, j)) {
+      predecessors[j].push_back(i);
+      successorsLeft[i]++;
+    }
   }
 
-  while (!worklist.empty()) {
-    uint32_t i = worklist.front();
-    worklist.pop_front();
+  // Emit a row once all of its successors have been emitted
+  topOrder.clear();
+  topOrder.reserve(N);
+  for (uint32_t i = 0; i < N; ++i) {
+    if (successorsLeft[i] == 0) {
+      topOrder.push_back(i);
+    }
+  }
+  for (uint32_t next = 0; next < topOrder.size(); ++next) {
+    for (auto p : predecessors[topOrder[next]]) {
+      successorsLeft[p]--;
+      if (successorsLeft[p] == 0) {
+        topOrder.push_back(p);
+      }
+    }
+  }
 
-    bool changedI = false;
+  // The rows that have not been emitted belong to (or reach) a cycle
+  return topOrder.size() == N;
+}
 
-    // (i->j)
-    for (int32_t j = firstSuccessor(i); j != -1; j = nextSuccessor(i, j)) {
-      // bit-wise or row[i] |= row[j]
-
-      // (j->k)
-      for (int32_t k = firstSuccessor(j); k != -1; k = nextSuccessor(j, k)) {
-        // but not (i->k)
-        if (!test(i, k)) {
-          changedI = true;
-          ++nAdd;
-          set(i, k);
-        }
+void BitMatrix::transitiveClosure() {
+
+  // Relations without cycles (e.g., the ones of a DAG) are closed by visiting
+  // each row after its successors: the row of a successor is already closed,
+  // so it is merged only once.
+  // The cost is proportional to the number of pairs set rather than to N^3,
+  // which is what sparse relations need.
+  std::vector<uint32_t> topOrder;
+  if (computeReverseTopologicalOrder(topOrder)) {
+    for (auto i : topOrder) {
+      std::vector<uint32_t> successors;
+      for (int32_t j = firstSuccessor(i); j != -1; j = nextSuccessor(i, j)) {
+        successors.push_back(j);
+      }
+      for (auto j : successors) {
+        orRows(i, j);
       }
     }
+    return;
+  }
 
-    if (changedI) {
-      for (uint32_t p = 0; p < N; ++p) {
-        if (test(p, i)) {
-          if (std::find(worklist.begin(), worklist.end(), p)
-              == worklist.end()) {
-            worklist.push_back(p);
-          }
-        }
+  // Relations with cycles are closed with Warshall's algorithm, which merges
+  // whole rows one word at a time.
+  // Rows are stored contiguously, so each merge streams through two rows.
+  for (uint32_t k = 0; k < N; ++k) {
+    const uint32_t wordK = k / BitsPerWord;
+    const Word maskK = ((Word)1) << (k % BitsPerWord);
+    for (uint32_t i = 0; i < N; ++i) {
+      if (words[((uint64_t)i) * wordsPerRow + wordK] & maskK) {
+        orRows(i, k);
       }
     }
   }
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/ControlDependenceSummary.hpp"
+
+namespace llvm::noelle {
+
+std::mutex ControlDependenceSummary::summariesMutex;
+
+std::unordered_map<Function *, std::shared_ptr<const ControlDependenceSummary>>
+    ControlDependenceSummary::summaries;
+
+ControlDependenceSummary::ControlDependenceSummary(Function &F)
+  : cfg{ ControlDependenceSummary::encodeCFG(F) },
+    controllingBBs{},
+    dominators{ nullptr } {
+
+  /*
+   * Compute the dominators of the function.
+   */
+  DominatorTree DT(F);
+  PostDominatorTree PDT(F);
+  this->dominators = std::make_unique<DominatorSummary>(DT, PDT);
+
+  /*
+   * There is a control dependence from a basic block A to a basic block B iff
+   * 1) there is E such that E is a successor of A, and
+   * 2) B post-dominates E, and
+   * 3) B doesn't strictly post-dominate A
+   */
+  for (auto &B : F) {
+
+    /*
+     * Fetch the basic blocks post-dominated by the current one.
+     */
+    SmallVector<BasicBlock *, 10> dominatedBBs;
+    PDT.getDescendants(&B, dominatedBBs);
+
+    /*
+     * For each basic block that B post dominates, check if B doesn't stricly
+     * post dominate its predecessor If it does not, then there is a control
+     * dependency from the predecessor to B
+     */
+    auto &controllingBBsOfB = this->controllingBBs[&B];
+    for (auto dominatedBB : dominatedBBs) {
+      for (auto predBB :
+           make_range(pred_begin(dominatedBB), pred_end(dominatedBB))) {
+
+        /*
+         * Check if the predecessor terminator is a conditional branch.
+         * This is necessary to avoid adding incorrect control dependences
+         * between basic blocks of a loop that has no exit blocks. For example:
+         *
+         * predBB:
+         *  branch B
+         *
+         * B:
+         *  i
+         *  branch %B
+         *
+         * In this case, if we don't check that the terminator of predBB is a
+         * conditional branch, we would add a control dependence from branch %B
+         * to i
+         */
+        if (predBB->getTerminator()->getNumSuccessors() == 1) {
+          continue;
+        }
+
+        /*
+         * Check if B strictly post-dominates predBB.
+         */
+        if (PDT.properlyDominates(&B, predBB)) {
+
+          /*
+           * B strictly post-dominates predBB.
+           * Therefore, there is no control dependence from predBB to B
+           */
+          continue;
+        }
+
+        /*
+         * There is a control dependence from predBB to B
+         */
+        controllingBBsOfB.push_back(predBB);
+      }
+    }
+  }
+
+  return;
+}
+
+std::shared_ptr<const ControlDependenceSummary> ControlDependenceSummary::fetch(
+    Function &F) {
+
+  /*
+   * Check if the summary of @F can be reused.
+   * This is the case if the CFG of @F did not change.
+   */
+  auto cfg = ControlDependenceSummary::encodeCFG(F);
+  {
+    std::lock_guard<std::mutex> guard{ summariesMutex };
+    auto found = summaries.find(&F);
+    if (true && (found != summaries.end()) && (found->second->cfg == cfg)) {
+      return found->second;
+    }
+  }
+
+  /*
+   * Compute the summary.
+   * This is done without holding the lock, so the summaries of different
+   * functions can be computed in parallel.
+   */
+  auto summary = std::make_shared<const ControlDependenceSummary>(F);
+  {
+    std::lock_guard<std::mutex> guard{ summariesMutex };
+    summaries[&F] = summary;
+  }
+
+  return summary;
+}
+
+void ControlDependenceSummary::invalidate(Function &F) {
+  std::lock_guard<std::mutex> guard{ summariesMutex };
+  summaries.erase(&F);
+
+  return;
+}
+
+const std::vector<BasicBlock *> &ControlDependenceSummary::
+    getControllingBasicBlocks(BasicBlock *bb) const {
+  static const std::vector<BasicBlock *> empty{};
+
+  auto found = this->controllingBBs.find(bb);
+  if (found == this->controllingBBs.end()) {
+    return empty;
+  }
+
+  return found->second;
+}
+
+bool ControlDependenceSummary::areControlEquivalent(BasicBlock *first,
+                                                    BasicBlock *second) const {
+  return (true && this->dominators->DT.dominates(first, second)
+          && this->dominators->PDT.dominates(second, first));
+}
+
+bool ControlDependenceSummary::postDominates(BasicBlock *bb1,
+                                             BasicBlock *bb2) const {
+  return this->dominators->PDT.dominates(bb1, bb2);
+}
+
+const DominatorSummary &ControlDependenceSummary::getDominators(void) const {
+  return *this->dominators;
+}
+
+std::vector<BasicBlock *> ControlDependenceSummary::encodeCFG(Function &F) {
+
+  /*
+   * Encode the basic blocks of @F, in order, each followed by its successors
+   * and by a separator.
+   */
+  std::vector<BasicBlock *> cfg;
+  for (auto &B : F) {
+    cfg.push_back(&B);
+    for (auto succBB : successors(&B)) {
+      cfg.push_back(succBB);
+    }
+    cfg.push_back(nullptr);
+  }
+
+  return cfg;
+}
+
+} // namespace llvm::noelle
@@ -33,7 +33,9 @@ DomNodeSummary::DomNodeSummary(const DTAliases::Node &node)
     level{ node.getLevel() },
     parent{ nullptr },
     children{},
-    iDom{ nullptr } {
+    iDom{ nullptr },
+    dfsIn{ 0 },
+    dfsOut{ 0 } {
 
   return;
 }
@@ -43,7 +45,9 @@ DomNodeSummary::DomNodeSummary(const DomNodeSummary &node)
     level{ node.getLevel() },
     parent{ nullptr },
     children{},
-    iDom{ nullptr } {
+    iDom{ nullptr },
+    dfsIn{ 0 },
+    dfsOut{ 0 } {
 
   return;
 }
@@ -95,47 +99,109 @@ DomNodeSummary *DomNodeSummary::getIDom(void) {
  * Dominator Tree Summary implementation
  */
 
-DomTreeSummary::DomTreeSummary(DominatorTree &DT)
-  : DomTreeSummary{ collectNodesOfTree<DominatorTree>(DT) } {
-  this->post = false;
+DomTreeSummary::Tree::Tree(bool post) : nodes{}, bbNodeMap{}, post{ post } {
   return;
 }
 
-DomTreeSummary::DomTreeSummary(PostDominatorTree &PDT)
-  : DomTreeSummary{ collectNodesOfTree<PostDominatorTree>(PDT) } {
-  this->post = true;
+DomTreeSummary::DomTreeSummary(DominatorTree &DT)
+  : tree{ std::make_shared<Tree>(false) },
+    isSlice{ false },
+    sliceRoots{} {
+  auto nodesOfTree = this->collectNodesOfTree<DominatorTree>(DT);
+  this->cloneNodes<DTAliases::Node>(nodesOfTree);
+  this->numberNodes();
+
   return;
 }
 
-DomTreeSummary::DomTreeSummary(std::set<DTAliases::Node *> nodeSubset)
-  : nodes{},
-    bbNodeMap{} {
-  this->cloneNodes<DTAliases::Node>(nodeSubset);
+DomTreeSummary::DomTreeSummary(PostDominatorTree &PDT)
+  : tree{ std::make_shared<Tree>(true) },
+    isSlice{ false },
+    sliceRoots{} {
+  auto nodesOfTree = this->collectNodesOfTree<PostDominatorTree>(PDT);
+  this->cloneNodes<DTAliases::Node>(nodesOfTree);
+  this->numberNodes();
+
+  return;
 }
 
 DomTreeSummary::DomTreeSummary(DomTreeSummary &DTS,
                                std::set<BasicBlock *> &bbSubset)
-  : DomTreeSummary{ filterNodes(DTS.nodes, bbSubset) } {}
+  : tree{ DTS.tree },
+    isSlice{ true },
+    sliceRoots{} {
+
+  /*
+   * Collect the nodes of the slice sorted by their position in the tree, so
+   * parents come before their children.
+   */
+  std::vector<DomNodeSummary *> nodesOfSlice;
+  for (auto bb : bbSubset) {
+    auto node = DTS.getNode(bb);
+    if (node != nullptr) {
+      nodesOfSlice.push_back(node);
+    }
+  }
+  std::sort(nodesOfSlice.begin(),
+            nodesOfSlice.end(),
+            [](DomNodeSummary *n1, DomNodeSummary *n2) -> bool {
+              return n1->dfsIn < n2->dfsIn;
+            });
 
-DomTreeSummary::DomTreeSummary(std::set<DomNodeSummary *> nodeSubset)
-  : nodes{},
-    bbNodeMap{} {
-  this->cloneNodes<DomNodeSummary>(nodeSubset);
+  /*
+   * A node is the root of its subtree within the slice iff its parent is not
+   * part of the slice.
+   */
+  for (auto node : nodesOfSlice) {
+    auto parent = DTS.getParentInSummary(node);
+    auto parentRoot = this->sliceRoots.find(parent);
+    if (true && (parent != nullptr) && (parentRoot != this->sliceRoots.end())) {
+      this->sliceRoots[node] = parentRoot->second;
+    } else {
+      this->sliceRoots[node] = node;
+    }
+  }
+
+  return;
 }
 
 DomTreeSummary::~DomTreeSummary() {
-  for (auto node : nodes)
-    delete node;
-  nodes.clear();
-  bbNodeMap.clear();
+  return;
 }
 
 void DomTreeSummary::transferToClones(
     std::unordered_map<BasicBlock *, BasicBlock *> &bbCloneMap) {
-  for (auto node : nodes) {
-    assert(bbCloneMap.find(node->B) != bbCloneMap.end());
-    node->B = bbCloneMap[node->B];
+
+  /*
+   * The nodes might be shared with other summaries.
+   * In this case, copy the ones of this summary before renaming them.
+   */
+  if (false || this->isSlice || (this->tree.use_count() > 1)) {
+    std::set<DomNodeSummary *> nodesToCopy;
+    for (auto &node : this->tree->nodes) {
+      if (this->isIncluded(&node)) {
+        nodesToCopy.insert(&node);
+      }
+    }
+    auto sharedTree = this->tree;
+    this->tree = std::make_shared<Tree>(sharedTree->post);
+    this->isSlice = false;
+    this->sliceRoots.clear();
+    this->cloneNodes<DomNodeSummary>(nodesToCopy);
+    this->numberNodes();
   }
+
+  /*
+   * Rename the nodes.
+   */
+  this->tree->bbNodeMap.clear();
+  for (auto &node : this->tree->nodes) {
+    assert(bbCloneMap.find(node.B) != bbCloneMap.end());
+    node.B = bbCloneMap[node.B];
+    this->tree->bbNodeMap[node.B] = &node;
+  }
+
+  return;
 }
 
 template <typename TreeType>
@@ -164,30 +230,21 @@ std::set<DTAliases::Node *> DomTreeSummary::collectNodesOfTree(TreeType &T) {
   return nodes;
 }
 
-std::set<DomNodeSummary *> DomTreeSummary::filterNodes(
-    std::set<DomNodeSummary *> &nodes,
-    std::set<BasicBlock *> &bbSubset) {
-  std::set<DomNodeSummary *> nodesSubset;
-  for (auto node : nodes) {
-    if (bbSubset.find(node->B) != bbSubset.end()) {
-      nodesSubset.insert(node);
-    }
-  }
-  return nodesSubset;
-}
-
 template <typename NodeType>
 void DomTreeSummary::cloneNodes(std::set<NodeType *> &nodesToClone) {
 
   /*
-   * Clone nodes using DomNodeSummary constructors. Track cloned pairs in map
+   * Clone nodes using DomNodeSummary constructors. Track cloned pairs in map.
+   * The storage is allocated once, so the nodes never move.
    */
+  auto &nodes = this->tree->nodes;
+  nodes.reserve(nodesToClone.size());
   std::unordered_map<NodeType *, DomNodeSummary *> nodeMap;
   for (auto node : nodesToClone) {
-    auto summary = new DomNodeSummary(*node);
+    nodes.emplace_back(*node);
+    auto summary = &nodes.back();
     nodeMap[node] = summary;
-    this->nodes.insert(summary);
-    this->bbNodeMap[summary->B] = summary;
+    this->tree->bbNodeMap[summary->B] = summary;
   }
 
   /*
@@ -211,11 +268,70 @@ void DomTreeSummary::cloneNodes(std::set<NodeType *> &nodesToClone) {
       summary->children.push_back(childSummary);
     }
   }
+
+  return;
+}
+
+void DomTreeSummary::numberNodes(void) {
+
+  /*
+   * Visit the trees depth-first to assign the interval of each node.
+   */
+  uint32_t counter = 0;
+  std::vector<std::pair<DomNodeSummary *, uint32_t>> stack;
+  for (auto &root : this->tree->nodes) {
+    if (root.parent != nullptr) {
+      continue;
+    }
+    root.dfsIn = counter++;
+    stack.push_back(std::make_pair(&root, 0));
+    while (!stack.empty()) {
+      auto node = stack.back().first;
+      auto nextChild = stack.back().second;
+      if (nextChild < node->children.size()) {
+        stack.back().second++;
+        auto child = node->children[nextChild];
+        child->dfsIn = counter++;
+        stack.push_back(std::make_pair(child, 0));
+        continue;
+      }
+      node->dfsOut = counter++;
+      stack.pop_back();
+    }
+  }
+
+  return;
+}
+
+bool DomTreeSummary::isAncestor(DomNodeSummary *node1,
+                                DomNodeSummary *node2) const {
+  return (true && (node1->dfsIn <= node2->dfsIn)
+          && (node2->dfsOut <= node1->dfsOut));
+}
+
+bool DomTreeSummary::isIncluded(DomNodeSummary *node) const {
+  if (!this->isSlice) {
+    return true;
+  }
+  return this->sliceRoots.find(node) != this->sliceRoots.end();
+}
+
+DomNodeSummary *DomTreeSummary::getParentInSummary(
+    DomNodeSummary *node) const {
+  if (true && this->isSlice && (this->sliceRoots.at(node) == node)) {
+    return nullptr;
+  }
+  return node->parent;
 }
 
 DomNodeSummary *DomTreeSummary::getNode(BasicBlock *B) const {
+  auto &bbNodeMap = this->tree->bbNodeMap;
   auto nodeIter = bbNodeMap.find(B);
-  return nodeIter == bbNodeMap.end() ? nullptr : nodeIter->second;
+  if (false || (nodeIter == bbNodeMap.end())
+      || (!this->isIncluded(nodeIter->second))) {
+    return nullptr;
+  }
+  return nodeIter->second;
 }
 
 bool DomTreeSummary::dominates(Instruction *I, Instruction *J) const {
@@ -244,7 +360,7 @@ bool DomTreeSummary::dominates(Instruction *I, Instruction *J) const {
          * Hence, I dominates J.
          * Also, J postdominates I.
          */
-        if (this->post) {
+        if (this->tree->post) {
 
           /*
            * I does not post-dominate J.
@@ -266,7 +382,7 @@ bool DomTreeSummary::dominates(Instruction *I, Instruction *J) const {
      * Hence, J dominates I.
      * Also, I post-dominates J.
      */
-    if (this->post) {
+    if (this->tree->post) {
 
       /*
        * I post-dominates J.
@@ -301,26 +417,32 @@ bool DomTreeSummary::dominates(BasicBlock *B1, BasicBlock *B2) const {
 
 bool DomTreeSummary::dominates(DomNodeSummary *node1,
                                DomNodeSummary *node2) const {
-  std::queue<DomNodeSummary *> worklist;
-  worklist.push(node1);
-  while (!worklist.empty()) {
-    auto node = worklist.front();
-    worklist.pop();
+  if (!this->isAncestor(node1, node2)) {
+    return false;
+  }
 
-    if (node == node2)
-      return true;
-    for (auto child : node->children)
-      worklist.push(child);
+  /*
+   * Within a slice, the path from node1 to node2 must be part of the slice.
+   * This is the case if node1 is in the subtree, within the slice, of node2.
+   */
+  if (this->isSlice) {
+    auto rootOfNode2 = this->sliceRoots.find(node2);
+    if (false || (rootOfNode2 == this->sliceRoots.end())
+        || (!this->isIncluded(node1))) {
+      return false;
+    }
+    return this->isAncestor(rootOfNode2->second, node1);
   }
-  return false;
+
+  return true;
 }
 
 std::set<DomNodeSummary *> DomTreeSummary::dominates(
     DomNodeSummary *node) const {
   std::set<DomNodeSummary *> dominators;
-  while (node->parent) {
+  while (this->getParentInSummary(node)) {
     dominators.insert(node);
-    node = node->parent;
+    node = this->getParentInSummary(node);
   }
   return dominators;
 }
@@ -351,27 +473,22 @@ DomNodeSummary *DomTreeSummary::findNearestCommonDominator(
     DomNodeSummary *node1,
     DomNodeSummary *node2) const {
 
-  /*
-   * Helpers to determine whether a node n dominates node2
-   */
-  auto dominatorsOf2 = this->dominates(node2);
-  auto dominates2 = [&](DomNodeSummary *node) -> bool {
-    return dominatorsOf2.find(node) != dominatorsOf2.end();
-  };
-
   /*
    * Traversal of parents of node1 to find common dominator
    */
   DomNodeSummary *node = node1;
-  while (node && !dominates2(node))
-    node = node->parent;
+  while (node && !this->dominates(node, node2))
+    node = this->getParentInSummary(node);
   return node;
 }
 
 raw_ostream &DomTreeSummary::print(raw_ostream &stream,
                                    std::string prefixToUse) const {
-  for (auto node : nodes) {
-    node->print(stream, prefixToUse);
+  for (auto &node : this->tree->nodes) {
+    if (!this->isIncluded(&node)) {
+      continue;
+    }
+    node.print(stream, prefixToUse);
   }
   return stream;
 }
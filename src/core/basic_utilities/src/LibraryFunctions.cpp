@@ -0,0 +1,193 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "noelle/core/LibraryFunctions.hpp"
+
+namespace llvm::noelle {
+
+static cl::list<std::string> LibrarySpecificationFiles(
+    "noelle-library-spec",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File with the properties of library functions"));
+
+enum LibraryFunctionProperty : uint32_t {
+  PURE = 1 << 0,
+  READ_ONLY = 1 << 1,
+  ARG_MEM_ONLY = 1 << 2,
+  THREAD_SAFE = 1 << 3,
+  COMMUTATIVE = 1 << 4
+};
+
+static const std::map<std::string, uint32_t> propertyNames{
+  { "pure", PURE },
+  { "readonly", READ_ONLY },
+  { "argmemonly", ARG_MEM_ONLY },
+  { "thread-safe", THREAD_SAFE },
+  { "commutative", COMMUTATIVE }
+};
+
+static void loadSpecificationFile(const std::string &fileName,
+                                  StringMap<uint32_t> &specifications) {
+
+  /*
+   * Read the file.
+   */
+  auto fileOrError = MemoryBuffer::getFile(fileName);
+  if (!fileOrError) {
+    errs() << "LibraryFunctions: ERROR = the specification file " << fileName
+           << " cannot be read\n";
+    abort();
+  }
+  SmallVector<StringRef, 128> lines;
+  (*fileOrError)->getBuffer().split(lines, '\n');
+
+  /*
+   * Parse the functions described.
+   */
+  auto lineNumber = 0;
+  for (auto line : lines) {
+    lineNumber++;
+    line = line.trim();
+    if (false || line.empty() || line.startswith("#")) {
+      continue;
+    }
+    SmallVector<StringRef, 8> fields;
+    line.split(fields, ' ', -1, false);
+
+    /*
+     * The properties of a function described multiple times (e.g., by more
+     * than one file) are merged.
+     */
+    auto &properties = specifications[fields[0]];
+    for (auto i = 1u; i < fields.size(); i++) {
+      auto property = propertyNames.find(fields[i].trim().str());
+      if (property == propertyNames.end()) {
+        errs() << "LibraryFunctions: ERROR = " << fileName << ":" << lineNumber
+               << ": the property \"" << fields[i] << "\" does not exist\n";
+        abort();
+      }
+      properties |= property->second;
+    }
+  }
+
+  return;
+}
+
+static const StringMap<uint32_t> &getSpecifications(void) {
+
+  /*
+   * The files are loaded the first time a property is queried. This can
+   * happen from the threads that compute the dependence graphs in parallel.
+   */
+  static const StringMap<uint32_t> specifications = []() {
+    StringMap<uint32_t> s;
+    for (auto &fileName : LibrarySpecificationFiles) {
+      loadSpecificationFile(fileName, s);
+    }
+    return s;
+  }();
+
+  return specifications;
+}
+
+static bool hasProperty(StringRef functionName, uint32_t property) {
+  auto &specifications = getSpecifications();
+  auto it = specifications.find(functionName);
+  if (it == specifications.end()) {
+    return false;
+  }
+
+  return (it->second & property) != 0;
+}
+
+bool LibraryFunctions::isPure(StringRef functionName) {
+  return hasProperty(functionName, PURE);
+}
+
+bool LibraryFunctions::isReadOnly(StringRef functionName) {
+  return hasProperty(functionName, READ_ONLY);
+}
+
+bool LibraryFunctions::isArgMemOnly(StringRef functionName) {
+  return hasProperty(functionName, ARG_MEM_ONLY);
+}
+
+bool LibraryFunctions::isThreadSafe(StringRef functionName) {
+  return hasProperty(functionName, THREAD_SAFE);
+}
+
+bool LibraryFunctions::isCommutative(StringRef functionName) {
+  return hasProperty(functionName, COMMUTATIVE);
+}
+
+bool LibraryFunctions::addAttributesToDeclarations(Module &M) {
+  auto modified = false;
+  for (auto &F : M) {
+
+    /*
+     * Only library functions are described by the specifications.
+     */
+    if (false || (!F.empty()) || F.isIntrinsic()) {
+      continue;
+    }
+    auto name = F.getName();
+    if (true && LibraryFunctions::isPure(name) && (!F.doesNotAccessMemory())) {
+      F.setDoesNotAccessMemory();
+      modified = true;
+    }
+    if (true && LibraryFunctions::isReadOnly(name)
+        && (!F.onlyReadsMemory())) {
+      F.setOnlyReadsMemory();
+      modified = true;
+    }
+    if (true && LibraryFunctions::isArgMemOnly(name)
+        && (!F.onlyAccessesArgMemory())) {
+      F.setOnlyAccessesArgMemory();
+      modified = true;
+    }
+  }
+
+  return modified;
+}
+
+uint64_t LibraryFunctions::getHashOfSpecifications(void) {
+
+  /*
+   * Hash the functions in a fixed order.
+   */
+  auto &specifications = getSpecifications();
+  std::vector<std::pair<std::string, uint32_t>> functions;
+  for (auto &spec : specifications) {
+    functions.push_back(std::make_pair(spec.getKey().str(), spec.getValue()));
+  }
+  std::sort(functions.begin(), functions.end());
+  hash_code h = hash_value(functions.size());
+  for (auto &function : functions) {
+    h = hash_combine(h, function.first, function.second);
+  }
+
+  return h;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <sys/resource.h>
+#include <unistd.h>
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "noelle/core/PhaseTimer.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<bool> NoelleTimePasses(
+    "noelle-time-passes",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Report the time and memory of the NOELLE phases"));
+
+static cl::opt<std::string> NoelleTimePassesJSON(
+    "noelle-time-passes-json",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Dump the time and memory of the NOELLE phases to a JSON file"));
+
+/*
+ * The thread that loaded NOELLE.
+ */
+static const std::thread::id mainThread = std::this_thread::get_id();
+
+class PhaseTimerRecord {
+public:
+  PhaseTimerRecord(StringRef name, StringRef description, TimerGroup &group)
+    : timer{ name, description, group },
+      invocations{ 0 },
+      residentBytesGrowth{ 0 } {}
+
+  Timer timer;
+  uint64_t invocations;
+  int64_t residentBytesGrowth;
+};
+
+/*
+ * All phases measured.
+ * The group is declared before the records, so the records are destroyed
+ * first and the group prints their times when the last one goes away.
+ */
+class PhaseTimers {
+public:
+  PhaseTimers() : group{ "noelle", "NOELLE phases" } {}
+
+  ~PhaseTimers();
+
+  PhaseTimerRecord *getRecord(StringRef name, StringRef description);
+
+private:
+  TimerGroup group;
+  std::vector<std::unique_ptr<PhaseTimerRecord>> records;
+  StringMap<PhaseTimerRecord *> recordOfPhase;
+
+  void printMemory(raw_ostream &OS, uint64_t peakResidentKB) const;
+
+  void dumpJSON(StringRef fileName, uint64_t peakResidentKB) const;
+};
+
+static ManagedStatic<PhaseTimers> phaseTimers;
+
+static int64_t getResidentBytes(void) {
+  long pages = 0;
+  long residentPages = 0;
+  auto statm = fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+  if (fscanf(statm, "%ld %ld", &pages, &residentPages) != 2) {
+    residentPages = 0;
+  }
+  fclose(statm);
+
+  return ((int64_t)residentPages) * sysconf(_SC_PAGESIZE);
+}
+
+static uint64_t getPeakResidentKB(void) {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+
+  return usage.ru_maxrss;
+}
+
+PhaseTimerRecord *PhaseTimers::getRecord(StringRef name,
+                                         StringRef description) {
+  auto &record = this->recordOfPhase[name];
+  if (record == nullptr) {
+    this->records.push_back(
+        std::make_unique<PhaseTimerRecord>(name, description, this->group));
+    record = this->records.back().get();
+  }
+
+  return record;
+}
+
+void PhaseTimers::printMemory(raw_ostream &OS, uint64_t peakResidentKB) const {
+  OS << "===" << std::string(73, '-') << "===\n";
+  OS << "                       NOELLE phases: invocations and memory\n";
+  OS << "===" << std::string(73, '-') << "===\n";
+  OS << "  Peak resident memory: " << peakResidentKB << " KB\n\n";
+  OS << "  Invocations  Resident growth (KB)  --- Name ---\n";
+  for (auto &record : this->records) {
+    OS << format("  %11lu  %20ld  ",
+                 record->invocations,
+                 record->residentBytesGrowth / 1024)
+       << record->timer.getDescription() << "\n";
+  }
+  OS << "\n";
+
+  return;
+}
+
+void PhaseTimers::dumpJSON(StringRef fileName, uint64_t peakResidentKB) const {
+  std::error_code EC;
+  raw_fd_ostream file(fileName, EC);
+  if (EC) {
+    errs() << "NOELLE: PhaseTimer: cannot write " << fileName << "\n";
+    return;
+  }
+
+  json::OStream J(file, 2);
+  J.object([&] {
+    J.attribute("peak_resident_kb", (int64_t)peakResidentKB);
+    J.attributeArray("phases", [&] {
+      for (auto &record : this->records) {
+        auto time = record->timer.getTotalTime();
+        J.object([&] {
+          J.attribute("name", record->timer.getName());
+          J.attribute("description", record->timer.getDescription());
+          J.attribute("invocations", (int64_t)record->invocations);
+          J.attribute("wall_seconds", time.getWallTime());
+          J.attribute("user_seconds", time.getUserTime());
+          J.attribute("system_seconds", time.getSystemTime());
+          J.attribute("resident_growth_kb",
+                      record->residentBytesGrowth / 1024);
+        });
+      }
+    });
+  });
+  file << "\n";
+
+  return;
+}
+
+PhaseTimers::~PhaseTimers() {
+  if (this->records.empty()) {
+    return;
+  }
+
+  /*
+   * Report the invocations and the memory.
+   * The times are reported by the group.
+   */
+  auto peakResidentKB = getPeakResidentKB();
+  if (NoelleTimePassesJSON.getNumOccurrences() > 0) {
+    this->dumpJSON(NoelleTimePassesJSON, peakResidentKB);
+  }
+  this->printMemory(*CreateInfoOutputFile(), peakResidentKB);
+
+  return;
+}
+
+bool PhaseTimer::isEnabled(void) {
+  return false || TimePassesIsEnabled || NoelleTimePasses
+         || (NoelleTimePassesJSON.getNumOccurrences() > 0);
+}
+
+PhaseTimer::PhaseTimer(StringRef name, StringRef description)
+  : record{ nullptr },
+    residentBytesAtStart{ 0 } {
+
+  /*
+   * Check if the phase should be measured.
+   */
+  if (false || (!PhaseTimer::isEnabled())
+      || (std::this_thread::get_id() != mainThread)) {
+    return;
+  }
+  auto record = phaseTimers->getRecord(name, description);
+  if (record->timer.isRunning()) {
+    return;
+  }
+
+  /*
+   * Start measuring.
+   */
+  this->record = record;
+  this->record->invocations++;
+  this->residentBytesAtStart = getResidentBytes();
+  this->record->timer.startTimer();
+
+  return;
+}
+
+PhaseTimer::~PhaseTimer() {
+  if (this->record == nullptr) {
+    return;
+  }
+  this->record->timer.stopTimer();
+  this->record->residentBytesGrowth +=
+      getResidentBytes() - this->residentBytesAtStart;
+
+  return;
+}
+
+} // namespace llvm::noelle
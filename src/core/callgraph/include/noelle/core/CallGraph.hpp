@@ -55,8 +55,27 @@ public:
 
   bool doesItBelongToASCC(Function *f);
 
+  /*
+   * Update the call graph after the call instructions of @f changed (e.g.,
+   * a call of @f has been inlined or devirtualized).
+   * The SCCCAG is updated as well if it has been computed.
+   */
+  void refreshFunction(Function *f);
+
+  /*
+   * Add a function created after the call graph.
+   */
+  void addFunction(Function *f);
+
+  /*
+   * Remove a function that is going to be deleted from the module.
+   */
+  void removeFunction(Function *f);
+
 private:
   Module &m;
+  std::function<bool(CallInst *)> hasIndCSCallees;
+  std::function<const std::set<const Function *>(CallInst *)> getIndCSCallees;
   std::unordered_map<Function *, CallGraphFunctionNode *> functions;
   std::unordered_map<Instruction *, CallGraphInstructionNode *>
       instructionNodes;
@@ -72,6 +91,13 @@ private:
       std::function<const std::set<const Function *>(CallInst *)>
           getIndCSCallees);
 
+  void removeOutgoingEdges(
+      CallGraphFunctionNode *fromNode,
+      std::unordered_set<Instruction *> &calls,
+      std::unordered_set<CallGraphFunctionNode *> &callees);
+
+  void removeEdge(CallGraphFunctionFunctionEdge *edge);
+
   CallGraphFunctionFunctionEdge *fetchOrCreateEdge(
       CallGraphFunctionNode *fromNode,
       CallBase *callInst,
@@ -66,6 +66,10 @@ public:
 
   void addIncomingEdge(CallGraphFunctionFunctionEdge *edge);
 
+  void removeOutgoingEdge(CallGraphFunctionFunctionEdge *edge);
+
+  void removeIncomingEdge(CallGraphFunctionFunctionEdge *edge);
+
   std::unordered_set<CallGraphFunctionFunctionEdge *> getIncomingEdges(
       void) const;
 
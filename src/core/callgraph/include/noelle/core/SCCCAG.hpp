@@ -43,6 +43,8 @@ public:
 
   bool isAnSCC(void) const override;
 
+  std::unordered_set<CallGraphNode *> getNodes(void) const;
+
   virtual ~SCCCAGNode_SCC();
 
 private:
@@ -71,8 +73,29 @@ public:
 
   SCCCAGNode *getNode(CallGraphNode *n) const;
 
+  /*
+   * Update the SCCCAG after the callees of @caller changed.
+   * Only the SCCs that include @caller or that are merged by the new edges
+   * are computed again.
+   */
+  void updateAfterCalleesChanged(
+      CallGraphFunctionNode *caller,
+      const std::unordered_set<CallGraphFunctionNode *> &removedCallees,
+      const std::unordered_set<CallGraphFunctionNode *> &addedCallees);
+
+  /*
+   * Remove a node that has no edges anymore.
+   */
+  void removeNode(CallGraphFunctionNode *n);
+
 private:
   std::unordered_map<CallGraphNode *, SCCCAGNode *> nodes;
+
+  void computeSCCs(const std::unordered_set<CallGraphFunctionNode *> &region);
+
+  void deleteNodes(const std::unordered_set<SCCCAGNode *> &toDelete);
+
+  std::unordered_set<CallGraphFunctionNode *> getNodesOf(SCCCAGNode *n) const;
 };
 
 } // namespace llvm::noelle
@@ -33,6 +33,8 @@ CallGraph::CallGraph(
     std::function<bool(CallInst *)> hasIndCSCallees,
     std::function<const std::set<const Function *>(CallInst *)> getIndCSCallees)
   : m{ M },
+    hasIndCSCallees{ hasIndCSCallees },
+    getIndCSCallees{ getIndCSCallees },
     scccag{ nullptr } {
 
   /*
@@ -210,6 +212,194 @@ bool CallGraph::doesItBelongToASCC(Function *f) {
   return false;
 }
 
+void CallGraph::refreshFunction(Function *f) {
+
+  /*
+   * Fetch the node of @f.
+   */
+  auto fromNode = this->getFunctionNode(f);
+  assert(fromNode != nullptr);
+
+  /*
+   * Remove the edges from @f.
+   */
+  std::unordered_set<Instruction *> oldCalls{};
+  std::unordered_set<CallGraphFunctionNode *> oldCallees{};
+  this->removeOutgoingEdges(fromNode, oldCalls, oldCallees);
+
+  /*
+   * Add the edges of the current call instructions of @f.
+   *
+   * Indirect calls that did not exist when the callees of @f were computed
+   * (e.g., the ones copied by inlining) are unknown to the pointer analysis.
+   * They can invoke any escaping function of the same type.
+   */
+  auto hasNewIndCSCallees = [](CallInst *) -> bool { return true; };
+  auto getNewIndCSCallees =
+      [this](CallInst *call) -> const std::set<const Function *> {
+    std::set<const Function *> callees{};
+    for (auto &F : this->m) {
+      if (true && (F.getFunctionType() == call->getFunctionType())
+          && this->canFunctionEscape(&F)) {
+        callees.insert(&F);
+      }
+    }
+    return callees;
+  };
+  for (auto &inst : instructions(f)) {
+    if (!isa<CallInst>(&inst) && !isa<InvokeInst>(&inst)) {
+      continue;
+    }
+    auto callInst = cast<CallBase>(&inst);
+    if (true && (oldCalls.count(callInst) > 0) && this->hasIndCSCallees) {
+      this->handleCallInstruction(fromNode,
+                                  callInst,
+                                  this->hasIndCSCallees,
+                                  this->getIndCSCallees);
+    } else {
+      this->handleCallInstruction(fromNode,
+                                  callInst,
+                                  hasNewIndCSCallees,
+                                  getNewIndCSCallees);
+    }
+  }
+
+  /*
+   * Update the SCCCAG.
+   */
+  if (this->scccag != nullptr) {
+    std::unordered_set<CallGraphFunctionNode *> newCallees{};
+    for (auto edge : fromNode->getOutgoingEdges()) {
+      newCallees.insert(edge->getCallee());
+    }
+    std::unordered_set<CallGraphFunctionNode *> removedCallees{};
+    for (auto callee : oldCallees) {
+      if (newCallees.count(callee) == 0) {
+        removedCallees.insert(callee);
+      }
+    }
+    std::unordered_set<CallGraphFunctionNode *> addedCallees{};
+    for (auto callee : newCallees) {
+      if (oldCallees.count(callee) == 0) {
+        addedCallees.insert(callee);
+      }
+    }
+    this->scccag->updateAfterCalleesChanged(fromNode,
+                                            removedCallees,
+                                            addedCallees);
+  }
+
+  return;
+}
+
+void CallGraph::addFunction(Function *f) {
+
+  /*
+   * Create the node of @f.
+   */
+  if (this->getFunctionNode(f) == nullptr) {
+    this->functions[f] = new CallGraphFunctionNode(*f);
+  }
+
+  /*
+   * Add the edges from @f.
+   */
+  this->refreshFunction(f);
+
+  return;
+}
+
+void CallGraph::removeFunction(Function *f) {
+
+  /*
+   * Fetch the node of @f.
+   */
+  auto node = this->getFunctionNode(f);
+  if (node == nullptr) {
+    return;
+  }
+
+  /*
+   * Remove the edges from and to @f.
+   */
+  std::unordered_set<Instruction *> oldCalls{};
+  std::unordered_set<CallGraphFunctionNode *> oldCallees{};
+  this->removeOutgoingEdges(node, oldCalls, oldCallees);
+  for (auto edge : node->getIncomingEdges()) {
+    this->removeEdge(edge);
+  }
+
+  /*
+   * Remove the node.
+   */
+  if (this->scccag != nullptr) {
+    this->scccag->removeNode(node);
+  }
+  this->functions.erase(f);
+  delete node;
+
+  return;
+}
+
+void CallGraph::removeOutgoingEdges(
+    CallGraphFunctionNode *fromNode,
+    std::unordered_set<Instruction *> &calls,
+    std::unordered_set<CallGraphFunctionNode *> &callees) {
+
+  /*
+   * Collect the nodes of the call instructions, which can be shared by several
+   * edges (e.g., by the ones of an indirect call).
+   */
+  std::unordered_set<CallGraphInstructionNode *> instNodes{};
+  for (auto edge : fromNode->getOutgoingEdges()) {
+    callees.insert(edge->getCallee());
+    for (auto subEdge : edge->getSubEdges()) {
+      auto instNode = subEdge->getCaller();
+      instNodes.insert(instNode);
+      calls.insert(instNode->getInstruction());
+    }
+  }
+
+  /*
+   * Remove the edges.
+   */
+  for (auto edge : fromNode->getOutgoingEdges()) {
+    this->removeEdge(edge);
+  }
+
+  /*
+   * Remove the nodes of the call instructions.
+   * The instructions might have been deleted already, so they are only used as
+   * keys.
+   */
+  for (auto instNode : instNodes) {
+    this->instructionNodes.erase(instNode->getInstruction());
+    delete instNode;
+  }
+
+  return;
+}
+
+void CallGraph::removeEdge(CallGraphFunctionFunctionEdge *edge) {
+
+  /*
+   * Remove the sub-edges.
+   */
+  for (auto subEdge : edge->getSubEdges()) {
+    delete subEdge;
+  }
+
+  /*
+   * Remove the edge.
+   */
+  edge->getCaller()->removeOutgoingEdge(edge);
+  edge->getCallee()->removeIncomingEdge(edge);
+  this->edges.erase(edge);
+  delete edge;
+
+  return;
+}
+
 std::unordered_map<Function *, CallGraph *> CallGraph::getIslands(void) const {
   std::unordered_map<Function *, CallGraph *> islands{};
 
@@ -448,9 +638,13 @@ CallGraphFunctionFunctionEdge *CallGraph::fetchOrCreateEdge(
 
   /*
    * Fetch the callee node.
+   * Functions created after the call graph get their node here.
    */
-  assert(this->functions.find(&callee) != this->functions.end());
-  auto toNode = this->functions.at(&callee);
+  auto toNode = this->getFunctionNode(&callee);
+  if (toNode == nullptr) {
+    toNode = new CallGraphFunctionNode(callee);
+    this->functions[&callee] = toNode;
+  }
 
   /*
    * Create the sub-edge.
@@ -523,7 +717,13 @@ bool CallGraph::canFunctionEscape(Function *f) const {
      */
     auto user = use.getUser();
     if (!isa<Instruction>(user)) {
-      continue;
+
+      /*
+       * @f is referenced by a constant (e.g., a global initializer or a
+       * constant expression). We do not track where such references go, so
+       * @f can escape.
+       */
+      return true;
     }
     auto userInst = cast<Instruction>(user);
 
@@ -555,14 +755,16 @@ bool CallGraph::canFunctionEscape(Function *f) const {
     }
 
     /*
-     * Handle store instructions.
+     * Any other use of the reference of @f (e.g., a store, a cast, a PHI) can
+     * make it reachable by code we do not track.
      */
-    if (auto storeInst = dyn_cast<StoreInst>(userInst)) {
-      return true;
-    }
+    return true;
   }
 
-  return true;
+  /*
+   * @f is only invoked directly.
+   */
+  return false;
 }
 
 } // namespace llvm::noelle
@@ -122,4 +122,229 @@ SCCCAGNode *SCCCAG::getNode(CallGraphNode *n) const {
   return node;
 }
 
+void SCCCAG::updateAfterCalleesChanged(
+    CallGraphFunctionNode *caller,
+    const std::unordered_set<CallGraphFunctionNode *> &removedCallees,
+    const std::unordered_set<CallGraphFunctionNode *> &addedCallees) {
+
+  /*
+   * Add the nodes of functions that were not in the call graph when the
+   * SCCCAG was computed.
+   */
+  auto addNodeIfMissing = [this](CallGraphFunctionNode *n) {
+    if (this->getNode(n) == nullptr) {
+      this->nodes[n] = new SCCCAGNode_Function(n);
+    }
+  };
+  addNodeIfMissing(caller);
+  for (auto callee : removedCallees) {
+    addNodeIfMissing(callee);
+  }
+  for (auto callee : addedCallees) {
+    addNodeIfMissing(callee);
+  }
+
+  /*
+   * A removed edge can split only the SCC that includes both @caller and the
+   * callee.
+   */
+  auto callerSCC = this->getNode(caller);
+  if (callerSCC->isAnSCC()) {
+    for (auto callee : removedCallees) {
+      if (this->getNode(callee) != callerSCC) {
+        continue;
+      }
+      auto region = this->getNodesOf(callerSCC);
+      this->deleteNodes({ callerSCC });
+      this->computeSCCs(region);
+      break;
+    }
+  }
+
+  /*
+   * A new edge merges the SCCs of all functions in the paths from the callee
+   * back to @caller.
+   */
+  for (auto callee : addedCallees) {
+    auto callerNode = this->getNode(caller);
+    auto calleeNode = this->getNode(callee);
+    if (callee == caller) {
+      if (!callerNode->isAnSCC()) {
+        this->deleteNodes({ callerNode });
+        this->computeSCCs({ caller });
+      }
+      continue;
+    }
+    if (callerNode == calleeNode) {
+      continue;
+    }
+
+    /*
+     * Collect the functions reachable from the callee.
+     */
+    std::unordered_set<CallGraphFunctionNode *> reachable{ callee };
+    std::stack<CallGraphFunctionNode *> todos{};
+    todos.push(callee);
+    while (!todos.empty()) {
+      auto n = todos.top();
+      todos.pop();
+      for (auto edge : n->getOutgoingEdges()) {
+        auto next = edge->getCallee();
+        if (reachable.insert(next).second) {
+          todos.push(next);
+        }
+      }
+    }
+    if (reachable.count(caller) == 0) {
+      continue;
+    }
+
+    /*
+     * Collect the functions that reach @caller and that are reachable from the
+     * callee.
+     */
+    std::unordered_set<CallGraphFunctionNode *> region{ caller };
+    todos.push(caller);
+    while (!todos.empty()) {
+      auto n = todos.top();
+      todos.pop();
+      for (auto edge : n->getIncomingEdges()) {
+        auto previous = edge->getCaller();
+        if (true && (reachable.count(previous) > 0)
+            && region.insert(previous).second) {
+          todos.push(previous);
+        }
+      }
+    }
+
+    /*
+     * Merge the SCCs of these functions.
+     */
+    std::unordered_set<SCCCAGNode *> toDelete{};
+    for (auto n : region) {
+      toDelete.insert(this->getNode(n));
+    }
+    this->deleteNodes(toDelete);
+    this->computeSCCs(region);
+  }
+
+  return;
+}
+
+void SCCCAG::removeNode(CallGraphFunctionNode *n) {
+
+  /*
+   * Fetch the SCCCAG node of @n.
+   */
+  auto nodeOfN = this->getNode(n);
+  if (nodeOfN == nullptr) {
+    return;
+  }
+
+  /*
+   * The other functions of the SCC of @n might not be in a cycle anymore.
+   */
+  auto region = this->getNodesOf(nodeOfN);
+  region.erase(n);
+  this->deleteNodes({ nodeOfN });
+  if (region.size() > 0) {
+    this->computeSCCs(region);
+  }
+
+  return;
+}
+
+void SCCCAG::computeSCCs(
+    const std::unordered_set<CallGraphFunctionNode *> &region) {
+
+  /*
+   * Identify the SCCs of the sub-graph induced by @region (Tarjan).
+   */
+  std::unordered_map<CallGraphFunctionNode *, uint32_t> indexes{};
+  std::unordered_map<CallGraphFunctionNode *, uint32_t> lowLinks{};
+  std::unordered_set<CallGraphFunctionNode *> onStack{};
+  std::vector<CallGraphFunctionNode *> stack{};
+  std::function<void(CallGraphFunctionNode *)> visit;
+  visit = [&](CallGraphFunctionNode *n) {
+    auto index = indexes.size();
+    indexes[n] = index;
+    lowLinks[n] = index;
+    stack.push_back(n);
+    onStack.insert(n);
+    for (auto edge : n->getOutgoingEdges()) {
+      auto callee = edge->getCallee();
+      if (region.count(callee) == 0) {
+        continue;
+      }
+      if (indexes.count(callee) == 0) {
+        visit(callee);
+        lowLinks[n] = std::min(lowLinks[n], lowLinks[callee]);
+      } else if (onStack.count(callee) > 0) {
+        lowLinks[n] = std::min(lowLinks[n], indexes[callee]);
+      }
+    }
+    if (lowLinks[n] != indexes[n]) {
+      return;
+    }
+
+    /*
+     * @n is the root of an SCC.
+     */
+    std::unordered_set<CallGraphNode *> cgNodes{};
+    CallGraphFunctionNode *m = nullptr;
+    do {
+      m = stack.back();
+      stack.pop_back();
+      onStack.erase(m);
+      cgNodes.insert(m);
+    } while (m != n);
+
+    /*
+     * Create the correct node like the constructor does.
+     */
+    if ((cgNodes.size() == 1) && (n->getCallEdgeTo(n) == nullptr)) {
+      this->nodes[n] = new SCCCAGNode_Function(n);
+      return;
+    }
+    auto sccNode = new SCCCAGNode_SCC(cgNodes);
+    for (auto node : cgNodes) {
+      this->nodes[node] = sccNode;
+    }
+  };
+  for (auto n : region) {
+    if (indexes.count(n) == 0) {
+      visit(n);
+    }
+  }
+
+  return;
+}
+
+void SCCCAG::deleteNodes(const std::unordered_set<SCCCAGNode *> &toDelete) {
+  for (auto n : toDelete) {
+    for (auto cgNode : this->getNodesOf(n)) {
+      this->nodes.erase(cgNode);
+    }
+    delete n;
+  }
+
+  return;
+}
+
+std::unordered_set<CallGraphFunctionNode *> SCCCAG::getNodesOf(
+    SCCCAGNode *n) const {
+  std::unordered_set<CallGraphFunctionNode *> s{};
+  if (!n->isAnSCC()) {
+    auto functionNode = static_cast<SCCCAGNode_Function *>(n);
+    s.insert(static_cast<CallGraphFunctionNode *>(functionNode->getNode()));
+    return s;
+  }
+  auto sccNode = static_cast<SCCCAGNode_SCC *>(n);
+  for (auto cgNode : sccNode->getNodes()) {
+    s.insert(static_cast<CallGraphFunctionNode *>(cgNode));
+  }
+
+  return s;
+}
+
 } // namespace llvm::noelle
@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/CleanMetadata.hpp"
+#include "noelle/core/PhaseTimer.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
@@ -30,6 +31,7 @@ CleanMetadata::CleanMetadata() : ModulePass{ ID }, cleanPDG{ false } {
 
 void CleanMetadata::cleanPDGMetadata(Module &M) {
   errs() << "noelle/core/Clean PDG Metadata\n";
+  PhaseTimer timer("pdg-unembedding", "PDG un-embedding");
 
   for (auto &F : M) {
     if (F.hasMetadata("noelle.pdg.args.id")) {
@@ -38,6 +40,9 @@ void CleanMetadata::cleanPDGMetadata(Module &M) {
     if (F.hasMetadata("noelle.pdg.edges")) {
       F.setMetadata("noelle.pdg.edges", nullptr);
     }
+    if (F.hasMetadata("noelle.pdg.coarse")) {
+      F.setMetadata("noelle.pdg.coarse", nullptr);
+    }
 
     for (auto &B : F) {
       for (auto &I : B) {
@@ -51,6 +56,9 @@ void CleanMetadata::cleanPDGMetadata(Module &M) {
   if (auto n = M.getNamedMetadata("noelle.module.pdg")) {
     M.eraseNamedMetadata(n);
   }
+  if (auto n = M.getNamedMetadata("noelle.module.pdg.binary")) {
+    M.eraseNamedMetadata(n);
+  }
 
   return;
 }
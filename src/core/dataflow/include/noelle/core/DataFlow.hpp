@@ -24,5 +24,8 @@
 #include "noelle/core/SystemHeaders.hpp"
 
 #include "noelle/core/DataFlowResult.hpp"
+#include "noelle/core/DataFlowWorkingList.hpp"
 #include "noelle/core/DataFlowEngine.hpp"
 #include "noelle/core/DataFlowAnalysis.hpp"
+#include "noelle/core/DataFlowBitVectorResult.hpp"
+#include "noelle/core/DataFlowBitVectorEngine.hpp"
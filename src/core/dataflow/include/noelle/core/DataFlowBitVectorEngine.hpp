@@ -0,0 +1,106 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/DataFlowBitVectorResult.hpp"
+#include "noelle/core/DataFlowWorkingList.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Data-flow engine based on bit vectors.
+ *
+ * The transfer function of an instruction is OUT = GEN U (IN - KILL) for
+ * forward analyses and IN = GEN U (OUT - KILL) for backward analyses.
+ * The lambdas given to the engine customize the meet of a basic block with
+ * its predecessors (forward) or successors (backward).
+ * The transfer functions of the instructions of a basic block are composed
+ * once, so the fixed point is computed at basic block granularity.
+ */
+class DataFlowBitVectorEngine {
+public:
+  /*
+   * Methods
+   */
+  DataFlowBitVectorEngine();
+
+  DataFlowBitVectorResult *applyForward(
+      Function *f,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeGEN,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeKILL,
+      std::function<void(Instruction *inst, BitVector &IN)> initializeIN,
+      std::function<void(Instruction *inst, BitVector &OUT)> initializeOUT,
+      std::function<void(Instruction *inst,
+                         BitVector &IN,
+                         Instruction *predecessor,
+                         DataFlowBitVectorResult *df)> computeIN);
+
+  DataFlowBitVectorResult *applyForward(
+      Function *f,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeGEN,
+      std::function<void(Instruction *inst, BitVector &IN)> initializeIN,
+      std::function<void(Instruction *inst, BitVector &OUT)> initializeOUT,
+      std::function<void(Instruction *inst,
+                         BitVector &IN,
+                         Instruction *predecessor,
+                         DataFlowBitVectorResult *df)> computeIN);
+
+  DataFlowBitVectorResult *applyBackward(
+      Function *f,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeGEN,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeKILL,
+      std::function<void(BitVector &OUT,
+                         Instruction *successor,
+                         DataFlowBitVectorResult *df)> computeOUT);
+
+  DataFlowBitVectorResult *applyBackward(
+      Function *f,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeGEN,
+      std::function<void(BitVector &OUT,
+                         Instruction *successor,
+                         DataFlowBitVectorResult *df)> computeOUT);
+
+protected:
+  void computeGENAndKILL(
+      Function *f,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeGEN,
+      std::function<void(Instruction *, DataFlowBitVectorResult *)>
+          computeKILL,
+      DataFlowBitVectorResult *df);
+
+  void composeTransfers(
+      BasicBlock *bb,
+      bool isForward,
+      DataFlowBitVectorResult *df,
+      SparseBitVector<> &gen,
+      SparseBitVector<> &kill);
+};
+
+} // namespace llvm::noelle
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "llvm/ADT/SparseBitVector.h"
+
+namespace llvm::noelle {
+
+/*
+ * Result of a data-flow analysis computed by DataFlowBitVectorEngine.
+ *
+ * Values are identified by dense indices local to the function analyzed.
+ * GEN and KILL sets are stored per instruction as sparse bit vectors.
+ * IN and OUT sets are stored per basic block only; the ones of an instruction
+ * are recomputed on demand from the boundary of its basic block.
+ */
+class DataFlowBitVectorResult {
+public:
+  /*
+   * Methods
+   */
+  DataFlowBitVectorResult(Function *f, bool isForward);
+
+  uint32_t getIndex(Value *value);
+  Value *getValue(uint32_t index) const;
+  uint32_t getNumberOfValues(void) const;
+  std::set<Value *> getValues(const BitVector &bits) const;
+
+  SparseBitVector<> &GEN(Instruction *inst);
+  SparseBitVector<> &KILL(Instruction *inst);
+
+  BitVector &IN(BasicBlock *bb);
+  BitVector &OUT(BasicBlock *bb);
+
+  BitVector IN(Instruction *inst);
+  BitVector OUT(Instruction *inst);
+
+  static void applyTransfer(BitVector &bits,
+                            const SparseBitVector<> &gen,
+                            const SparseBitVector<> &kill);
+
+  /*
+   * Number of basic blocks popped from the working list.
+   */
+  uint64_t getNumberOfIterations(void) const;
+
+  /*
+   * Number of invocations of the transfer functions of the basic blocks.
+   */
+  uint64_t getNumberOfVisits(void) const;
+
+private:
+  friend class DataFlowBitVectorEngine;
+
+  uint64_t iterations;
+  uint64_t visits;
+  bool isForward;
+  std::vector<Value *> values;
+  std::unordered_map<Value *, uint32_t> indices;
+  std::unordered_map<Instruction *, SparseBitVector<>> gens;
+  std::unordered_map<Instruction *, SparseBitVector<>> kills;
+  std::unordered_map<BasicBlock *, BitVector> ins;
+  std::unordered_map<BasicBlock *, BitVector> outs;
+
+  BitVector &fetchBoundary(std::unordered_map<BasicBlock *, BitVector> &sets,
+                           BasicBlock *bb);
+};
+
+} // namespace llvm::noelle
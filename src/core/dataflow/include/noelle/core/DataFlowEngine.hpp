@@ -23,6 +23,7 @@
 
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/DataFlowResult.hpp"
+#include "noelle/core/DataFlowWorkingList.hpp"
 
 namespace llvm::noelle {
 
@@ -108,8 +109,6 @@ private:
       std::function<void(Instruction *inst,
                          std::set<Value *> &OUT,
                          DataFlowResult *df)> computeOUT,
-      std::function<void(std::list<BasicBlock *> &workingList, BasicBlock *bb)>
-          appendBB,
       std::function<Instruction *(BasicBlock *bb)> getFirstInstruction,
       std::function<Instruction *(BasicBlock *bb)> getLastInstruction);
 };
@@ -37,7 +37,22 @@ public:
   std::set<Value *> &IN(Instruction *inst);
   std::set<Value *> &OUT(Instruction *inst);
 
+  /*
+   * Number of basic blocks popped from the working list.
+   */
+  uint64_t getNumberOfIterations(void) const;
+
+  /*
+   * Number of invocations of the transfer functions (computeIN and
+   * computeOUT).
+   */
+  uint64_t getNumberOfVisits(void) const;
+
 private:
+  friend class DataFlowEngine;
+
+  uint64_t iterations;
+  uint64_t visits;
   std::map<Instruction *, std::set<Value *>> gens;
   std::map<Instruction *, std::set<Value *>> kills;
   std::map<Instruction *, std::set<Value *>> ins;
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Working list of the basic blocks of a function that a data-flow engine
+ * still needs to process.
+ *
+ * Basic blocks are popped in reverse post-order for forward analyses and in
+ * post-order for backward ones, so a block is processed after the blocks that
+ * feed it (back edges aside). A block is included at most once.
+ */
+class DataFlowWorkingList {
+public:
+  /*
+   * Methods
+   */
+  DataFlowWorkingList(Function *f, bool isForward);
+
+  void push(BasicBlock *bb);
+
+  void pushAll(void);
+
+  BasicBlock *pop(void);
+
+  bool empty(void) const;
+
+private:
+  std::vector<BasicBlock *> order;
+  std::unordered_map<BasicBlock *, uint32_t> positions;
+  std::set<uint32_t> pending;
+};
+
+} // namespace llvm::noelle
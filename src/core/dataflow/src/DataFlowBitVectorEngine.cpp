@@ -0,0 +1,306 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/DataFlowBitVectorEngine.hpp"
+
+namespace llvm::noelle {
+
+DataFlowBitVectorEngine::DataFlowBitVectorEngine() {
+  return;
+}
+
+DataFlowBitVectorResult *DataFlowBitVectorEngine::applyForward(
+    Function *f,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeGEN,
+    std::function<void(Instruction *inst, BitVector &IN)> initializeIN,
+    std::function<void(Instruction *inst, BitVector &OUT)> initializeOUT,
+    std::function<void(Instruction *inst,
+                       BitVector &IN,
+                       Instruction *predecessor,
+                       DataFlowBitVectorResult *df)> computeIN) {
+
+  /*
+   * Define an empty KILL set.
+   */
+  auto computeKILL = [](Instruction *, DataFlowBitVectorResult *) { return; };
+
+  /*
+   * Run the data-flow analysis.
+   */
+  auto dfr = this->applyForward(f,
+                                computeGEN,
+                                computeKILL,
+                                initializeIN,
+                                initializeOUT,
+                                computeIN);
+
+  return dfr;
+}
+
+DataFlowBitVectorResult *DataFlowBitVectorEngine::applyForward(
+    Function *f,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeGEN,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeKILL,
+    std::function<void(Instruction *inst, BitVector &IN)> initializeIN,
+    std::function<void(Instruction *inst, BitVector &OUT)> initializeOUT,
+    std::function<void(Instruction *inst,
+                       BitVector &IN,
+                       Instruction *predecessor,
+                       DataFlowBitVectorResult *df)> computeIN) {
+
+  /*
+   * Compute the GENs and KILLs
+   */
+  auto df = new DataFlowBitVectorResult(f, true);
+  this->computeGENAndKILL(f, computeGEN, computeKILL, df);
+
+  /*
+   * Compose the transfer functions of the instructions of each basic block.
+   */
+  std::unordered_map<BasicBlock *, SparseBitVector<>> blockGENs;
+  std::unordered_map<BasicBlock *, SparseBitVector<>> blockKILLs;
+  for (auto &bb : *f) {
+    this->composeTransfers(&bb, true, df, blockGENs[&bb], blockKILLs[&bb]);
+  }
+
+  /*
+   * Initialize IN and OUT sets.
+   * This is done after the GENs and KILLs have been computed to let the
+   * initializers cover every value numbered by them.
+   */
+  for (auto &bb : *f) {
+    initializeIN(&*bb.begin(), df->IN(&bb));
+    initializeOUT(bb.getTerminator(), df->OUT(&bb));
+  }
+
+  /*
+   * Create the working list by adding all basic blocks to it.
+   */
+  DataFlowWorkingList workingList(f, true);
+  workingList.pushAll();
+
+  /*
+   * Compute the INs and OUTs iteratively until the working list is empty.
+   */
+  std::unordered_set<BasicBlock *> computedOnce;
+  while (!workingList.empty()) {
+
+    /*
+     * Fetch a basic block that needs to be processed.
+     */
+    auto bb = workingList.pop();
+    df->iterations++;
+
+    /*
+     * Compute IN[bb]
+     */
+    auto inst = &*bb->begin();
+    auto &inSetOfBB = df->IN(bb);
+    for (auto predecessorBB : predecessors(bb)) {
+      computeIN(inst, inSetOfBB, predecessorBB->getTerminator(), df);
+    }
+
+    /*
+     * Compute OUT[bb]
+     */
+    auto newOutSetOfBB = inSetOfBB;
+    DataFlowBitVectorResult::applyTransfer(newOutSetOfBB,
+                                           blockGENs[bb],
+                                           blockKILLs[bb]);
+    df->visits++;
+
+    /*
+     * Check if OUT[bb] changed.
+     */
+    auto &outSetOfBB = df->OUT(bb);
+    if (true && (computedOnce.find(bb) != computedOnce.end())
+        && (newOutSetOfBB == outSetOfBB)) {
+      continue;
+    }
+    computedOnce.insert(bb);
+    outSetOfBB = std::move(newOutSetOfBB);
+
+    /*
+     * Add the successors of the current basic block to the working list.
+     */
+    for (auto successorBB : successors(bb)) {
+      workingList.push(successorBB);
+    }
+  }
+
+  return df;
+}
+
+DataFlowBitVectorResult *DataFlowBitVectorEngine::applyBackward(
+    Function *f,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeGEN,
+    std::function<void(BitVector &OUT,
+                       Instruction *successor,
+                       DataFlowBitVectorResult *df)> computeOUT) {
+
+  /*
+   * Define an empty KILL set.
+   */
+  auto computeKILL = [](Instruction *, DataFlowBitVectorResult *) { return; };
+
+  /*
+   * Run the data-flow analysis.
+   */
+  auto dfr = this->applyBackward(f, computeGEN, computeKILL, computeOUT);
+
+  return dfr;
+}
+
+DataFlowBitVectorResult *DataFlowBitVectorEngine::applyBackward(
+    Function *f,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeGEN,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeKILL,
+    std::function<void(BitVector &OUT,
+                       Instruction *successor,
+                       DataFlowBitVectorResult *df)> computeOUT) {
+
+  /*
+   * Compute the GENs and KILLs
+   */
+  auto df = new DataFlowBitVectorResult(f, false);
+  this->computeGENAndKILL(f, computeGEN, computeKILL, df);
+
+  /*
+   * Compose the transfer functions of the instructions of each basic block.
+   */
+  std::unordered_map<BasicBlock *, SparseBitVector<>> blockGENs;
+  std::unordered_map<BasicBlock *, SparseBitVector<>> blockKILLs;
+  for (auto &bb : *f) {
+    this->composeTransfers(&bb, false, df, blockGENs[&bb], blockKILLs[&bb]);
+  }
+
+  /*
+   * Create the working list by adding all basic blocks to it.
+   */
+  DataFlowWorkingList workingList(f, false);
+  workingList.pushAll();
+
+  /*
+   * Compute the INs and OUTs iteratively until the working list is empty.
+   */
+  std::unordered_set<BasicBlock *> computedOnce;
+  while (!workingList.empty()) {
+
+    /*
+     * Fetch a basic block that needs to be processed.
+     */
+    auto bb = workingList.pop();
+    df->iterations++;
+
+    /*
+     * Compute OUT[bb]
+     */
+    auto &outSetOfBB = df->OUT(bb);
+    for (auto successorBB : successors(bb)) {
+      computeOUT(outSetOfBB, &*successorBB->begin(), df);
+    }
+
+    /*
+     * Compute IN[bb]
+     */
+    auto newInSetOfBB = outSetOfBB;
+    DataFlowBitVectorResult::applyTransfer(newInSetOfBB,
+                                           blockGENs[bb],
+                                           blockKILLs[bb]);
+    df->visits++;
+
+    /*
+     * Check if IN[bb] changed.
+     */
+    auto &inSetOfBB = df->IN(bb);
+    if (true && (computedOnce.find(bb) != computedOnce.end())
+        && (newInSetOfBB == inSetOfBB)) {
+      continue;
+    }
+    computedOnce.insert(bb);
+    inSetOfBB = std::move(newInSetOfBB);
+
+    /*
+     * Add the predecessors of the current basic block to the working list.
+     */
+    for (auto predecessorBB : predecessors(bb)) {
+      workingList.push(predecessorBB);
+    }
+  }
+
+  return df;
+}
+
+void DataFlowBitVectorEngine::computeGENAndKILL(
+    Function *f,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeGEN,
+    std::function<void(Instruction *, DataFlowBitVectorResult *)> computeKILL,
+    DataFlowBitVectorResult *df) {
+
+  /*
+   * Compute the GENs and KILLs
+   */
+  for (auto &bb : *f) {
+    for (auto &i : bb) {
+      computeGEN(&i, df);
+      computeKILL(&i, df);
+    }
+  }
+
+  return;
+}
+
+void DataFlowBitVectorEngine::composeTransfers(BasicBlock *bb,
+                                               bool isForward,
+                                               DataFlowBitVectorResult *df,
+                                               SparseBitVector<> &gen,
+                                               SparseBitVector<> &kill) {
+
+  /*
+   * Fold the transfer of one instruction into the one of the basic block.
+   * Applying GEN_i U (X - KILL_i) after GEN U (X - KILL) results in
+   * (GEN_i U (GEN - KILL_i)) U (X - (KILL U KILL_i)).
+   */
+  auto fold = [df, &gen, &kill](Instruction *i) {
+    auto &genOfI = df->GEN(i);
+    auto &killOfI = df->KILL(i);
+    gen.intersectWithComplement(killOfI);
+    gen |= genOfI;
+    kill |= killOfI;
+  };
+
+  /*
+   * Follow the direction of the analysis.
+   */
+  if (isForward) {
+    for (auto &i : *bb) {
+      fold(&i);
+    }
+  } else {
+    for (auto it = bb->rbegin(); it != bb->rend(); ++it) {
+      fold(&*it);
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/DataFlowBitVectorResult.hpp"
+
+namespace llvm::noelle {
+
+DataFlowBitVectorResult::DataFlowBitVectorResult(Function *f, bool isForward)
+  : iterations{ 0 },
+    visits{ 0 },
+    isForward{ isForward } {
+
+  /*
+   * Number the arguments and the instructions of the function.
+   * Other values (e.g., globals) get their index when they are first used.
+   */
+  for (auto &arg : f->args()) {
+    this->getIndex(&arg);
+  }
+  for (auto &bb : *f) {
+    for (auto &i : bb) {
+      this->getIndex(&i);
+    }
+  }
+
+  return;
+}
+
+uint32_t DataFlowBitVectorResult::getIndex(Value *value) {
+
+  /*
+   * Check if the value has already been numbered.
+   */
+  auto it = this->indices.find(value);
+  if (it != this->indices.end()) {
+    return it->second;
+  }
+
+  /*
+   * Number the new value.
+   */
+  uint32_t index = this->values.size();
+  this->values.push_back(value);
+  this->indices[value] = index;
+
+  return index;
+}
+
+Value *DataFlowBitVectorResult::getValue(uint32_t index) const {
+  assert(index < this->values.size());
+
+  return this->values[index];
+}
+
+uint32_t DataFlowBitVectorResult::getNumberOfValues(void) const {
+  return this->values.size();
+}
+
+std::set<Value *> DataFlowBitVectorResult::getValues(
+    const BitVector &bits) const {
+  std::set<Value *> s;
+  for (auto index : bits.set_bits()) {
+    s.insert(this->getValue(index));
+  }
+
+  return s;
+}
+
+SparseBitVector<> &DataFlowBitVectorResult::GEN(Instruction *inst) {
+  auto &s = this->gens[inst];
+
+  return s;
+}
+
+SparseBitVector<> &DataFlowBitVectorResult::KILL(Instruction *inst) {
+  auto &s = this->kills[inst];
+
+  return s;
+}
+
+BitVector &DataFlowBitVectorResult::IN(BasicBlock *bb) {
+  return this->fetchBoundary(this->ins, bb);
+}
+
+BitVector &DataFlowBitVectorResult::OUT(BasicBlock *bb) {
+  return this->fetchBoundary(this->outs, bb);
+}
+
+BitVector DataFlowBitVectorResult::IN(Instruction *inst) {
+  auto bb = inst->getParent();
+
+  /*
+   * Forward analysis: apply the transfer of the instructions that precede
+   * "inst" to the IN of its basic block.
+   */
+  if (this->isForward) {
+    auto bits = this->IN(bb);
+    for (auto &i : *bb) {
+      if (&i == inst) {
+        break;
+      }
+      this->applyTransfer(bits, this->GEN(&i), this->KILL(&i));
+    }
+    return bits;
+  }
+
+  /*
+   * Backward analysis: apply the transfer of the instructions from the
+   * terminator up to "inst" to the OUT of its basic block.
+   */
+  auto bits = this->OUT(bb);
+  for (auto it = bb->rbegin(); it != bb->rend(); ++it) {
+    auto i = &*it;
+    this->applyTransfer(bits, this->GEN(i), this->KILL(i));
+    if (i == inst) {
+      break;
+    }
+  }
+
+  return bits;
+}
+
+BitVector DataFlowBitVectorResult::OUT(Instruction *inst) {
+  auto bb = inst->getParent();
+
+  /*
+   * Forward analysis: apply the transfer of the instructions up to "inst" to
+   * the IN of its basic block.
+   */
+  if (this->isForward) {
+    auto bits = this->IN(bb);
+    for (auto &i : *bb) {
+      this->applyTransfer(bits, this->GEN(&i), this->KILL(&i));
+      if (&i == inst) {
+        break;
+      }
+    }
+    return bits;
+  }
+
+  /*
+   * Backward analysis: apply the transfer of the instructions that follow
+   * "inst" to the OUT of its basic block.
+   */
+  auto bits = this->OUT(bb);
+  for (auto it = bb->rbegin(); it != bb->rend(); ++it) {
+    auto i = &*it;
+    if (i == inst) {
+      break;
+    }
+    this->applyTransfer(bits, this->GEN(i), this->KILL(i));
+  }
+
+  return bits;
+}
+
+void DataFlowBitVectorResult::applyTransfer(BitVector &bits,
+                                            const SparseBitVector<> &gen,
+                                            const SparseBitVector<> &kill) {
+
+  /*
+   * Compute GEN U (bits - KILL).
+   */
+  for (auto index : kill) {
+    if (index < bits.size()) {
+      bits.reset(index);
+    }
+  }
+  for (auto index : gen) {
+    if (index >= bits.size()) {
+      bits.resize(index + 1);
+    }
+    bits.set(index);
+  }
+
+  return;
+}
+
+uint64_t DataFlowBitVectorResult::getNumberOfIterations(void) const {
+  return this->iterations;
+}
+
+uint64_t DataFlowBitVectorResult::getNumberOfVisits(void) const {
+  return this->visits;
+}
+
+BitVector &DataFlowBitVectorResult::fetchBoundary(
+    std::unordered_map<BasicBlock *, BitVector> &sets,
+    BasicBlock *bb) {
+
+  /*
+   * Make sure the set can host every value numbered so far.
+   */
+  auto &s = sets[bb];
+  if (s.size() < this->values.size()) {
+    s.resize(this->values.size());
+  }
+
+  return s;
+}
+
+} // namespace llvm::noelle
@@ -78,10 +78,6 @@ DataFlowResult *DataFlowEngine::applyForward(
   /*
    * Define the customization.
    */
-  auto appendBB = [](std::list<BasicBlock *> &workingList, BasicBlock *bb) {
-    workingList.push_back(bb);
-  };
-
   auto getFirstInst = [](BasicBlock *bb) -> Instruction * {
     return &*bb->begin();
   };
@@ -99,7 +95,6 @@ DataFlowResult *DataFlowEngine::applyForward(
                                                           initializeOUT,
                                                           computeIN,
                                                           computeOUT,
-                                                          appendBB,
                                                           getFirstInst,
                                                           getLastInst);
 
@@ -151,12 +146,11 @@ DataFlowResult *DataFlowEngine::applyBackward(
    * Compute the IN and OUT
    *
    * Create the working list by adding all basic blocks to it.
+   * Basic blocks are processed in post-order.
    */
   std::unordered_set<BasicBlock *> computedOnce;
-  std::list<BasicBlock *> workingList;
-  for (auto &bb : *f) {
-    workingList.push_front(&bb);
-  }
+  DataFlowWorkingList workingList(f, false);
+  workingList.pushAll();
 
   /*
    * Compute the INs and OUTs iteratively until the working list is empty.
@@ -166,8 +160,8 @@ DataFlowResult *DataFlowEngine::applyBackward(
     /*
      * Fetch a basic block that needs to be processed.
      */
-    auto bb = workingList.front();
-    workingList.pop_front();
+    auto bb = workingList.pop();
+    df->iterations++;
 
     /*
      * Fetch the last instruction of the current basic block.
@@ -195,6 +189,7 @@ DataFlowResult *DataFlowEngine::applyBackward(
        * Compute OUT[inst]
        */
       computeOUT(outSetOfInst, successorInst, df);
+      df->visits++;
     }
 
     /*
@@ -202,6 +197,7 @@ DataFlowResult *DataFlowEngine::applyBackward(
      */
     auto oldSize = inSetOfInst.size();
     computeIN(inSetOfInst, inst, df);
+    df->visits++;
 
     /*
      * Check if IN[inst] changed.
@@ -243,6 +239,7 @@ DataFlowResult *DataFlowEngine::applyBackward(
          */
         auto &inSetOfI = df->IN(i);
         computeIN(inSetOfI, i, df);
+        df->visits += 2;
 
         /*
          * Update the successor.
@@ -254,7 +251,7 @@ DataFlowResult *DataFlowEngine::applyBackward(
        * Add predecessors of the current basic block to the working list.
        */
       for (auto predBB : predecessors(bb)) {
-        workingList.push_back(predBB);
+        workingList.push(predBB);
       }
     }
   }
@@ -295,8 +292,6 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
     std::function<void(Instruction *inst,
                        std::set<Value *> &OUT,
                        DataFlowResult *df)> computeOUT,
-    std::function<void(std::list<BasicBlock *> &workingList, BasicBlock *bb)>
-        appendBB,
     std::function<Instruction *(BasicBlock *bb)> getFirstInstruction,
     std::function<Instruction *(BasicBlock *bb)> getLastInstruction) {
 
@@ -322,13 +317,10 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
    * Compute the IN and OUT
    *
    * Create the working list by adding all basic blocks to it.
+   * Basic blocks are processed in reverse post-order.
    */
-  std::list<BasicBlock *> workingList;
-  std::unordered_map<BasicBlock *, bool> worklingListContent;
-  for (auto &bb : *f) {
-    appendBB(workingList, &bb);
-    worklingListContent[&bb] = true;
-  }
+  DataFlowWorkingList workingList(f, true);
+  workingList.pushAll();
 
   /*
    * Compute the INs and OUTs iteratively until the working list is empty.
@@ -339,14 +331,8 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
     /*
      * Fetch a basic block that needs to be processed.
      */
-    auto bb = workingList.front();
-    assert(worklingListContent[bb] == true);
-
-    /*
-     * Remove the basic block from the workingList.
-     */
-    workingList.pop_front();
-    worklingListContent[bb] = false;
+    auto bb = workingList.pop();
+    df->iterations++;
 
     /*
      * Fetch the first instruction of the basic block.
@@ -373,6 +359,7 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
        * Compute IN[inst]
        */
       computeIN(inst, inSetOfInst, predecessorInst, df);
+      df->visits++;
     }
 
     /*
@@ -380,6 +367,7 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
      */
     auto oldSize = outSetOfInst.size();
     computeOUT(inst, outSetOfInst, df);
+    df->visits++;
 
     /* Check if the OUT of the first instruction of the current basic block
      * changed.
@@ -412,6 +400,7 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
          */
         auto &outSetOfI = df->OUT(i);
         computeOUT(i, outSetOfI, df);
+        df->visits += 2;
 
         /*
          * Update the predecessor.
@@ -428,11 +417,7 @@ DataFlowResult *DataFlowEngine::applyCustomizableForwardAnalysis(
        * Add successors of the current basic block to the working list.
        */
       for (auto succBB : successors(bb)) {
-        if (worklingListContent[succBB] == true) {
-          continue;
-        }
-        workingList.push_back(succBB);
-        worklingListContent[succBB] = true;
+        workingList.push(succBB);
       }
     }
   }
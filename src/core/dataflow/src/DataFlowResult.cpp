@@ -24,7 +24,7 @@
 using namespace llvm;
 using namespace llvm::noelle;
 
-DataFlowResult::DataFlowResult() {
+DataFlowResult::DataFlowResult() : iterations{ 0 }, visits{ 0 } {
   return;
 }
 
@@ -51,3 +51,11 @@ std::set<Value *> &DataFlowResult::OUT(Instruction *inst) {
 
   return s;
 }
+
+uint64_t DataFlowResult::getNumberOfIterations(void) const {
+  return this->iterations;
+}
+
+uint64_t DataFlowResult::getNumberOfVisits(void) const {
+  return this->visits;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/ADT/PostOrderIterator.h"
+#include "noelle/core/DataFlowWorkingList.hpp"
+
+namespace llvm::noelle {
+
+DataFlowWorkingList::DataFlowWorkingList(Function *f, bool isForward) {
+
+  /*
+   * Order the basic blocks reachable from the entry.
+   */
+  ReversePostOrderTraversal<Function *> rpot(f);
+  for (auto bb : rpot) {
+    this->order.push_back(bb);
+  }
+  if (!isForward) {
+    std::reverse(this->order.begin(), this->order.end());
+  }
+
+  /*
+   * Basic blocks that are not reachable from the entry are processed last.
+   */
+  std::unordered_set<BasicBlock *> reachable(this->order.begin(),
+                                             this->order.end());
+  for (auto &bb : *f) {
+    if (reachable.find(&bb) == reachable.end()) {
+      this->order.push_back(&bb);
+    }
+  }
+
+  /*
+   * Remember the position of every basic block.
+   */
+  for (uint32_t i = 0; i < this->order.size(); i++) {
+    this->positions[this->order[i]] = i;
+  }
+
+  return;
+}
+
+void DataFlowWorkingList::push(BasicBlock *bb) {
+  assert(this->positions.find(bb) != this->positions.end());
+  this->pending.insert(this->positions[bb]);
+
+  return;
+}
+
+void DataFlowWorkingList::pushAll(void) {
+  for (uint32_t i = 0; i < this->order.size(); i++) {
+    this->pending.insert(i);
+  }
+
+  return;
+}
+
+BasicBlock *DataFlowWorkingList::pop(void) {
+  assert(!this->pending.empty());
+
+  /*
+   * Fetch the pending basic block that comes first in the order.
+   */
+  auto it = this->pending.begin();
+  auto bb = this->order[*it];
+  this->pending.erase(it);
+
+  return bb;
+}
+
+bool DataFlowWorkingList::empty(void) const {
+  return this->pending.empty();
+}
+
+} // namespace llvm::noelle
@@ -282,6 +282,25 @@ StayConnectedNestedLoopForestNode *StayConnectedNestedLoopForest::
     /*
      * The current tree includes the target instruction.
      *
+     * If the loops have been built from the summary of the loops of their
+     * function, walk the loops that contain the instruction from the innermost
+     * one outwards until one of them belongs to the forest.
+     */
+    uint32_t summaryLoop;
+    auto summary = ls->getFunctionLoopSummary(summaryLoop);
+    if (summary != nullptr) {
+      for (auto l = summary->getInnermostLoopThatContains(i->getParent());
+           l >= 0;
+           l = summary->getParent(l)) {
+        auto nodeIt = this->headerLoops.find(summary->getHeader(l));
+        if (true && (nodeIt != this->headerLoops.end())
+            && nodeIt->second->getLoop()->isIncluded(i)) {
+          return nodeIt->second;
+        }
+      }
+    }
+
+    /*
      * Fetch the innermost loop that contains it.
      */
     StayConnectedNestedLoopForestNode *innermostLoop = nullptr;
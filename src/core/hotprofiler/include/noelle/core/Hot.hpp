@@ -33,6 +33,18 @@ public:
 
   bool isAvailable(void) const;
 
+  /*
+   * Fetch the profiles of a function of @M only the first time they are
+   * queried: @loadProfiles sets the ones of the function it gets.
+   * The profiles of the whole program (e.g., its total instructions) are
+   * computed the first time they are queried, after the ones of all functions.
+   *
+   * @available tells whether @M has been profiled at all.
+   */
+  void setProfilesLoader(Module &M,
+                         bool available,
+                         std::function<void(Function &F)> loadProfiles);
+
   /*
    * =========================== Instructions ================================
    */
@@ -46,6 +58,20 @@ public:
 
   uint64_t getTotalInstructions(Instruction *i) const;
 
+  /*
+   * Return the callees the indirect call @call has invoked with the number of
+   * times each one has been invoked, sorted from the most frequent one (see
+   * noelle-prof-coverage).
+   *
+   * @return Empty if the targets of @call have not been profiled.
+   */
+  std::vector<std::pair<Function *, uint64_t>> getIndirectCallTargets(
+      CallBase *call) const;
+
+  void setIndirectCallTargets(
+      CallBase *call,
+      std::vector<std::pair<Function *, uint64_t>> targets);
+
   /*
    * =========================== Basic blocks ================================
    */
@@ -121,6 +147,148 @@ public:
 
   double getAverageTotalInstructionsPerIteration(LoopStructure *loop) const;
 
+  /*
+   * Check if the trip counts of @loop have been profiled
+   * (see LoopProfiles.hpp).
+   */
+  bool hasTripCountHistogram(LoopStructure *loop) const;
+
+  /*
+   * Return the histogram of the trip counts of the invocations of @loop.
+   * Element i is the number of invocations with a trip count in
+   * [2^(i-1), 2^i); element 0 is the number of invocations with no trip.
+   * Missing elements at the end are 0.
+   *
+   * @return Empty if the trip counts of @loop have not been profiled.
+   */
+  const std::vector<uint64_t> &getTripCountHistogram(LoopStructure *loop) const;
+
+  /*
+   * Return the number of invocations of @loop with a trip count lower than
+   * 2^@log2TripCount.
+   */
+  uint64_t getInvocationsWithTripCountBelow(LoopStructure *loop,
+                                            uint32_t log2TripCount) const;
+
+  void setTripCountHistogram(BasicBlock *header,
+                             std::vector<uint64_t> histogram);
+
+  /*
+   * Check if the cycles spent in @loop have been profiled
+   * (see LoopProfiles.hpp).
+   */
+  bool areCyclesAvailable(LoopStructure *loop) const;
+
+  /*
+   * Return the cycles spent in @loop among all its invocations, including the
+   * ones spent in its callees.
+   */
+  uint64_t getCycles(LoopStructure *loop) const;
+
+  /*
+   * Return the fraction of the cycles of the program spent in @loop.
+   *
+   * @return Between 0 and 1
+   */
+  double getDynamicCycleCoverage(LoopStructure *loop) const;
+
+  void setLoopCycles(BasicBlock *header, uint64_t cycles);
+
+  /*
+   * Return the calling contexts @loop has been profiled in
+   * (see LoopProfiles.hpp).
+   * A context is the chain of call sites that invoked the function of @loop,
+   * from the innermost one. Contexts whose call sites do not exist anymore
+   * (e.g., they have been inlined) are skipped.
+   */
+  std::vector<std::vector<CallBase *>> getCallingContexts(
+      LoopStructure *loop) const;
+
+  /*
+   * Return the cycles spent in @loop, and the number of times it has been
+   * invoked, when its function has been invoked through @context.
+   * These add up the profiles of all the calling contexts of @loop that
+   * start with @context (e.g., the ones of a call site of the function of
+   * @loop).
+   */
+  uint64_t getCycles(LoopStructure *loop,
+                     const std::vector<CallBase *> &context) const;
+
+  uint64_t getInvocations(LoopStructure *loop,
+                          const std::vector<CallBase *> &context) const;
+
+  /*
+   * Return the fraction of the cycles of the program spent in @loop when its
+   * function has been invoked through @context.
+   *
+   * @return Between 0 and 1
+   */
+  double getDynamicCycleCoverage(LoopStructure *loop,
+                                 const std::vector<CallBase *> &context) const;
+
+  /*
+   * Set the profiles of the calling context of the loop of @header made of
+   * the call sites with ID @callSites (see LoopProfiles.hpp) of their
+   * function, from the innermost one.
+   */
+  void setLoopContextProfiles(
+      BasicBlock *header,
+      std::vector<std::pair<Function *, uint64_t>> callSites,
+      uint64_t cycles,
+      uint64_t invocations);
+
+  /*
+   * =========================== Inputs ======================================
+   *
+   * The program can be profiled with several inputs (see InputProfiles.hpp).
+   * The rest of the profiles are the merge of the ones of the inputs scaled
+   * by their weights.
+   */
+
+  /*
+   * Return the names of the inputs the program has been profiled with.
+   *
+   * @return Empty if the inputs have not been profiled separately.
+   */
+  std::vector<std::string> getInputs(void) const;
+
+  /*
+   * Return the weight of @input relative to the other inputs.
+   *
+   * @return Between 0 and 1
+   */
+  double getInputWeight(const std::string &input) const;
+
+  /*
+   * Return the coverage of @loop when the program runs with @input.
+   *
+   * @return Between 0 and 1
+   */
+  double getDynamicTotalInstructionCoverage(LoopStructure *loop,
+                                            const std::string &input) const;
+
+  /*
+   * Return the weighted mean, the minimum, and the maximum of the coverages
+   * of @loop among the inputs.
+   * These are the coverage of the merged profiles if the inputs have not been
+   * profiled separately.
+   *
+   * @return Between 0 and 1
+   */
+  double getExpectedDynamicTotalInstructionCoverage(LoopStructure *loop) const;
+
+  double getMinimumDynamicTotalInstructionCoverage(LoopStructure *loop) const;
+
+  double getMaximumDynamicTotalInstructionCoverage(LoopStructure *loop) const;
+
+  void setInput(const std::string &input,
+                uint64_t weight,
+                uint64_t totalInstructions);
+
+  void setLoopInputInstructions(BasicBlock *header,
+                                const std::string &input,
+                                uint64_t totalInstructions);
+
   /*
    * =========================== Functions ==================================
    */
@@ -135,6 +303,8 @@ public:
 
   uint64_t getInvocations(Function *f) const;
 
+  void setFunctionInvocations(Function *f, uint64_t invocations);
+
   uint64_t getSelfInstructions(Function *f) const;
 
   uint64_t getTotalInstructions(Function *f) const;
@@ -153,6 +323,14 @@ public:
 
   uint64_t getTotalInstructions(void) const;
 
+  /*
+   * Return the cycles spent by the program (0 if they have not been
+   * profiled).
+   */
+  uint64_t getCycles(void) const;
+
+  void setProgramCycles(uint64_t cycles);
+
   /*
    * =========================== Branches ====================================
    */
@@ -164,6 +342,22 @@ public:
 
   void computeProgramInvocations(Module &M);
 
+  /*
+   * ======================= Code transformations ============================
+   *
+   * Carry the profiles of @f through a transformation of its code, so the
+   * program does not need to be profiled again.
+   * Call snapshotProfiles before transforming @f, and remapProfiles after.
+   * Basic blocks are tracked through the IDs of their instructions (see
+   * UniqueIRMarker); instructions without an ID get one.
+   *
+   * remapProfiles also stores the invocations of @f into its branch weights
+   * and entry count.
+   */
+  void snapshotProfiles(Function *f);
+
+  void remapProfiles(Function *f);
+
 private:
   std::unordered_map<BasicBlock *, std::unordered_map<BasicBlock *, double>>
       branchProbability;
@@ -172,7 +366,59 @@ private:
   std::unordered_map<Function *, uint64_t> functionSelfInstructions;
   std::unordered_map<Function *, uint64_t> functionTotalInstructions;
   std::unordered_map<Instruction *, uint64_t> instructionTotalInstructions;
+  std::unordered_map<CallBase *, std::vector<std::pair<Function *, uint64_t>>>
+      indirectCallTargets;
+  std::unordered_map<BasicBlock *, std::vector<uint64_t>> tripCountHistograms;
+  std::unordered_map<BasicBlock *, uint64_t> loopCycles;
+  std::unordered_map<
+      BasicBlock *,
+      std::map<std::vector<std::pair<Function *, uint64_t>>,
+               std::pair<uint64_t, uint64_t>>>
+      loopContextProfiles;
+  mutable std::unordered_map<Function *, std::unordered_map<uint64_t, WeakVH>>
+      callSites;
+  mutable bool areCallSitesLoaded;
+  std::map<std::string, std::pair<uint64_t, uint64_t>> inputs;
+  std::unordered_map<BasicBlock *, std::unordered_map<std::string, uint64_t>>
+      loopInputInstructions;
+  uint64_t programCycles;
   uint64_t moduleNumberOfInstructionsExecuted;
+  Module *program;
+  bool isProgramProfiled;
+  std::function<void(Function &F)> loadFunctionProfiles;
+  mutable std::unordered_set<Function *> loadedFunctions;
+  mutable bool areProgramProfilesLoaded;
+  std::unordered_map<uint64_t, std::pair<Function *, uint64_t>>
+      snapshotInvocations;
+  uint64_t nextInstructionID;
+  bool isNextInstructionIDKnown;
+
+  void fetchProfiles(Function *f) const;
+
+  void fetchProgramProfiles(void) const;
+
+  /*
+   * Return the call site of @f with ID @callSiteID (see LoopProfiles.hpp).
+   * The call sites of the module are fetched the first time one of them is
+   * queried after the module has been transformed.
+   *
+   * @return nullptr if it does not exist.
+   */
+  CallBase *getCallSite(Function *f, uint64_t callSiteID) const;
+
+  /*
+   * Return the cycles and the invocations of the calling contexts of @loop
+   * that start with @context.
+   */
+  std::pair<uint64_t, uint64_t> getContextProfiles(
+      LoopStructure *loop,
+      const std::vector<CallBase *> &context) const;
+
+  void invalidateProfiles(Function *f);
+
+  void embedProfiles(Function *f);
+
+  uint64_t markInstruction(Instruction *inst);
 
   void computeTotalInstructions(Module &M);
 
@@ -23,6 +23,7 @@
 
 #include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/ProfileData/InstrProf.h"
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/Hot.hpp"
 
@@ -44,8 +45,21 @@ public:
   Hot &getHot(void);
 
 private:
+  /*
+   * Maximum number of targets of an indirect call to fetch from its profiles.
+   */
+  static constexpr uint32_t maxIndirectCallTargets = 8;
+
   Hot hot;
 
+  /*
+   * Names of the functions the value profiles refer to (see
+   * noelle-prof-coverage), built the first time they are needed.
+   */
+  std::unique_ptr<InstrProfSymtab> symtab;
+
   void analyzeProfiles(Module &M);
+
+  void analyzeProfiles(Function &F, bool isProgramProfiled);
 };
 } // namespace llvm::noelle
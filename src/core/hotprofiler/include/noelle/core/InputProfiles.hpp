@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Profiles of a program run with several inputs (see noelle-meta-prof-embed
+ * -inputs).
+ *
+ * Each input has a name and a weight, which is the fraction of the runs of
+ * the program the input represents relative to the other inputs. The profile
+ * the rest of NOELLE uses is the merge of the ones of the inputs scaled by
+ * their weights. On top of it, the instructions executed by each loop and by
+ * the whole program are kept per input, so the loops that are hot only for
+ * some inputs can be told apart from the ones hot for all of them.
+ *
+ * Loops are identified as in LoopProfiles.
+ */
+class InputProfiles {
+public:
+  static constexpr const char *metadataName = "noelle.input_instructions";
+
+  static constexpr const char *programMetadataName = "noelle.inputs";
+
+  static constexpr const char *defaultFileName = "noelle_input_profiles.txt";
+};
+
+/*
+ * Append the instructions executed by the loops and by the program, following
+ * the profile embedded in the module, to InputProfiles::defaultFileName,
+ * tagged with the name and the weight of the input.
+ */
+struct InputProfilesDumper : public ModulePass {
+public:
+  static char ID;
+
+  InputProfilesDumper();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+};
+
+/*
+ * Embed the profiles dumped by InputProfilesDumper as metadata attached to
+ * the terminators of the headers of the loops. The names, weights, and
+ * instructions of the program of the inputs are embedded as named metadata of
+ * the module.
+ */
+struct InputProfilesEmbedder : public ModulePass {
+public:
+  static char ID;
+
+  InputProfilesEmbedder();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+};
+
+} // namespace llvm::noelle
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Profiling of the trip counts and of the cycles of loops.
+ *
+ * The trip count of an invocation of a loop is the number of times its header
+ * executes during that invocation. Trip counts are collected in log2 buckets:
+ * bucket i counts the invocations with a trip count in [2^(i-1), 2^i), and
+ * bucket 0 counts the invocations with a trip count of 0.
+ *
+ * The cycles of a loop are the cycles elapsed between entering its pre-header
+ * and reaching one of its exit blocks, summed over all its invocations. They
+ * are measured with the cycle counter of the processor, so they include the
+ * time spent waiting for memory and the time spent in callees. Invocations
+ * of a loop nested within another invocation of the same loop (i.e., through
+ * recursion) are counted twice.
+ *
+ * Loops are identified by their function and by the position of their header
+ * within it, so the instrumented module and the module the histograms are
+ * embedded to must have the same basic blocks (e.g., the same bitcode given to
+ * noelle-prof-coverage and noelle-meta-prof-embed).
+ *
+ * The cycles and the invocations of a loop are also profiled per calling
+ * context. The calling context of an invocation is the chain of the last call
+ * sites that led to the function of the loop, from the innermost one, up to a
+ * given depth. Only the contexts made of direct calls (not invokes) are
+ * profiled, and at most maxContextsPerLoop of them per loop. Call sites are
+ * identified by their function and by their position within it, like loops.
+ */
+class LoopProfiles {
+public:
+  static constexpr uint32_t numberOfBuckets = 65;
+
+  /*
+   * Each loop has a counter per bucket followed by its cycles counter.
+   */
+  static constexpr uint32_t cyclesCounter = numberOfBuckets;
+
+  static constexpr uint32_t countersPerLoop = numberOfBuckets + 1;
+
+  static constexpr const char *metadataName = "noelle.loop_trip_counts";
+
+  static constexpr const char *cyclesMetadataName = "noelle.loop_cycles";
+
+  static constexpr const char *programCyclesMetadataName =
+      "noelle.program_cycles";
+
+  static constexpr const char *defaultFileName = "noelle_loop_profiles.txt";
+
+  /*
+   * Each calling context of a loop has its cycles counter followed by its
+   * invocations counter.
+   */
+  static constexpr uint32_t contextCyclesCounter = 0;
+
+  static constexpr uint32_t contextInvocationsCounter = 1;
+
+  static constexpr uint32_t countersPerContext = 2;
+
+  static constexpr uint32_t maxContextDepth = 4;
+
+  static constexpr uint32_t maxContextsPerLoop = 64;
+
+  /*
+   * The metadata of a loop has a node per calling context: its cycles, its
+   * invocations, and then the function and the ID of each of its call sites
+   * from the innermost one. Call sites are tagged with their ID, which is
+   * unique within the module.
+   */
+  static constexpr const char *contextsMetadataName = "noelle.loop_contexts";
+
+  static constexpr const char *callSiteMetadataName =
+      "noelle.loop_contexts.call_site";
+
+  /*
+   * Return the position of the header of @loop within its function.
+   */
+  static uint64_t getHeaderIndex(Loop *loop);
+
+  /*
+   * Return the position of @inst within its function.
+   */
+  static uint64_t getInstructionIndex(Instruction *inst);
+
+  /*
+   * Return the instruction at the position @index of @F.
+   *
+   * @return nullptr if @F has fewer instructions.
+   */
+  static Instruction *getInstruction(Function &F, uint64_t index);
+};
+
+/*
+ * Instrument the loops of a module to dump their trip-count histograms and
+ * their cycles, together with the cycles of the whole program, to
+ * LoopProfiles::defaultFileName when the program exits.
+ * If the file exists already, the profiles are appended to it.
+ *
+ * Calls keep the chain of the call sites that are running in a thread-local
+ * variable, so the loops can attribute their invocations to their calling
+ * contexts.
+ */
+struct LoopProfilesInstrumenter : public ModulePass {
+public:
+  static char ID;
+
+  LoopProfilesInstrumenter();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+private:
+  /*
+   * Call sites are encoded in a calling context with this number of bits, so
+   * they have IDs between 1 and 2^bitsPerCallSite - 1.
+   */
+  static constexpr uint32_t bitsPerCallSite = 16;
+
+  uint32_t contextDepth;
+  std::unordered_map<CallInst *, uint64_t> callSiteIDs;
+  std::unordered_map<CallInst *, std::string> callSiteNames;
+
+  bool canBeInstrumented(Loop *loop) const;
+
+  bool canBeInstrumented(CallInst *call) const;
+
+  /*
+   * Return the encodings of the calling contexts of the invocations of @F
+   * together with their names, which list the position and the function of
+   * each of their call sites from the innermost one.
+   * A context is encoded with the IDs of its call sites, the innermost one in
+   * the lowest bits.
+   */
+  std::vector<std::pair<uint64_t, std::string>> getContexts(Function *F) const;
+
+  void getContexts(Function *F,
+                   uint32_t depth,
+                   uint64_t context,
+                   std::string name,
+                   std::vector<std::pair<uint64_t, std::string>> &contexts)
+      const;
+
+  void instrumentLoop(Loop *loop,
+                      GlobalVariable *counters,
+                      uint64_t loopIndex,
+                      GlobalVariable *context,
+                      GlobalVariable *contextCounters,
+                      uint64_t firstContext,
+                      std::vector<uint64_t> &contexts);
+
+  void instrumentCall(CallInst *call, GlobalVariable *context);
+
+  Function *createDumpFunction(Module &M,
+                               GlobalVariable *counters,
+                               GlobalVariable *contextCounters,
+                               GlobalVariable *programStart,
+                               std::vector<std::string> &loopNames,
+                               std::vector<std::string> &contextNames);
+
+  /*
+   * Dump the non-zero counters among the first @numberOfCounters ones of
+   * @counters with @format, which gets the position of the counter within
+   * its group of @countersPerName, its value, and the name of the group.
+   * The code is appended to the insertion point of @builder, which is left
+   * at its end.
+   */
+  void dumpCounters(IRBuilder<> &builder,
+                    Module &M,
+                    Value *file,
+                    GlobalVariable *counters,
+                    uint64_t numberOfCounters,
+                    uint64_t countersPerName,
+                    std::vector<std::string> &names,
+                    const std::string &format);
+
+  Function *createStartFunction(Module &M, GlobalVariable *programStart);
+};
+
+/*
+ * Embed the profiles dumped by the loops instrumented by
+ * LoopProfilesInstrumenter as metadata attached to the terminators of their
+ * headers. The cycles of the whole program are embedded as named metadata of
+ * the module.
+ */
+struct LoopProfilesEmbedder : public ModulePass {
+public:
+  static char ID;
+
+  LoopProfilesEmbedder();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+};
+
+} // namespace llvm::noelle
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/LoopStructure.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * The most frequent values that some integer live-ins of loops (e.g., the
+ * bounds of their loop-governing induction variables) had when the loops
+ * started.
+ *
+ * The profiles are embedded by the value profiler (see noelle-prof-values).
+ * The first LoopValueProfiles::numberOfValues distinct values of a live-in
+ * are counted; the other ones are only included in the number of invocations
+ * of its loop.
+ *
+ * The profiles of a loop are attached to the terminator of its header with
+ * LoopValueProfiles::metadataName as a list of
+ * "!{LIVE_IN, INVOCATIONS, VALUE, COUNT, VALUE, COUNT, ...}". A live-in that
+ * is an argument is identified by its position; an instruction is identified
+ * by the node it is tagged with by LoopValueProfiles::valueMetadataName.
+ */
+class LoopValueProfiles {
+public:
+  static constexpr uint32_t numberOfValues = 4;
+
+  static constexpr const char *valueMetadataName = "noelle.loop_values.value";
+
+  static constexpr const char *metadataName = "noelle.loop_values";
+
+  LoopValueProfiles(Module &M);
+
+  LoopValueProfiles() = delete;
+
+  /*
+   * Check if the module includes profiles of values.
+   */
+  bool isAvailable(void) const;
+
+  bool isProfiled(LoopStructure *loop, Value *liveIn) const;
+
+  /*
+   * Return the number of invocations of @loop that have been profiled.
+   */
+  uint64_t getInvocations(LoopStructure *loop, Value *liveIn) const;
+
+  /*
+   * Return the values of @liveIn with the number of invocations of @loop that
+   * started with them, sorted from the most frequent one.
+   */
+  std::vector<std::pair<int64_t, uint64_t>> getHotValues(LoopStructure *loop,
+                                                         Value *liveIn) const;
+
+private:
+  struct ValueProfile {
+    uint64_t invocations;
+    std::vector<std::pair<int64_t, uint64_t>> values;
+  };
+
+  std::map<std::pair<BasicBlock *, Value *>, ValueProfile> profiles;
+};
+
+} // namespace llvm::noelle
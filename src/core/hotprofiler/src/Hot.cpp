@@ -24,37 +24,119 @@
 
 namespace llvm::noelle {
 
-Hot::Hot() : moduleNumberOfInstructionsExecuted{ 0 } {
+Hot::Hot()
+  : programCycles{ 0 },
+    moduleNumberOfInstructionsExecuted{ 0 },
+    program{ nullptr },
+    isProgramProfiled{ false },
+    areProgramProfilesLoaded{ false },
+    areCallSitesLoaded{ false },
+    nextInstructionID{ 0 },
+    isNextInstructionIDKnown{ false } {
   return;
 }
 
 bool Hot::isAvailable(void) const {
+
+  /*
+   * Check if we know whether the program has been profiled without fetching
+   * its profiles.
+   */
+  if (this->loadFunctionProfiles) {
+    return this->isProgramProfiled;
+  }
+
   return this->hasBeenExecuted();
 }
 
+void Hot::setProfilesLoader(Module &M,
+                            bool available,
+                            std::function<void(Function &F)> loadProfiles) {
+  this->program = &M;
+  this->isProgramProfiled = available;
+  this->loadFunctionProfiles = loadProfiles;
+  this->loadedFunctions.clear();
+  this->areProgramProfilesLoaded = false;
+  this->callSites.clear();
+  this->areCallSitesLoaded = false;
+
+  return;
+}
+
+void Hot::fetchProfiles(Function *f) const {
+
+  /*
+   * Check if the profiles of @f have to be fetched.
+   */
+  if (false || (!this->loadFunctionProfiles) || f->empty()) {
+    return;
+  }
+  if (!this->loadedFunctions.insert(f).second) {
+    return;
+  }
+
+  /*
+   * Fetch the profiles of @f.
+   */
+  this->loadFunctionProfiles(*f);
+
+  return;
+}
+
+void Hot::fetchProgramProfiles(void) const {
+
+  /*
+   * Check if the profiles of the program have to be computed.
+   */
+  if (false || (this->program == nullptr) || this->areProgramProfilesLoaded) {
+    return;
+  }
+  this->areProgramProfilesLoaded = true;
+
+  /*
+   * The profiles of the program depend on the ones of all its functions.
+   */
+  for (auto &F : *this->program) {
+    this->fetchProfiles(&F);
+  }
+
+  /*
+   * Compute the profiles of the program.
+   * These are cached counters, so computing them does not change what the
+   * profiles are.
+   */
+  const_cast<Hot *>(this)->computeProgramInvocations(*this->program);
+
+  return;
+}
+
 void Hot::computeProgramInvocations(Module &M) {
 
   /*
    * Compute the total number of instructions executed.
+   *
+   * The profiles might have been fetched lazily, so we iterate over the
+   * basic blocks of @M rather than over the profiles to skip the ones that
+   * no longer exist.
    */
-  for (auto pairs : this->bbInvocations) {
-
-    /*
-     * Fetch the current basic block
-     */
-    auto bb = pairs.first;
-    auto bbInv = pairs.second;
+  for (auto &F : M) {
+    for (auto &bb : F) {
+      auto bbInvocationsIt = this->bbInvocations.find(&bb);
+      if (bbInvocationsIt == this->bbInvocations.end()) {
+        continue;
+      }
 
-    /*
-     * Fetch the number of invocations of the basic block and its length.
-     */
-    auto totalBBInsts = this->getInvocations(bb);
-    auto bbLength = std::distance(bb->begin(), bb->end());
+      /*
+       * Fetch the number of invocations of the basic block and its length.
+       */
+      auto totalBBInsts = bbInvocationsIt->second;
+      auto bbLength = std::distance(bb.begin(), bb.end());
 
-    /*
-     * Update the module counter
-     */
-    this->moduleNumberOfInstructionsExecuted += (totalBBInsts * bbLength);
+      /*
+       * Update the module counter
+       */
+      this->moduleNumberOfInstructionsExecuted += (totalBBInsts * bbLength);
+    }
   }
 
   /*
@@ -62,21 +144,22 @@ void Hot::computeProgramInvocations(Module &M) {
    * Each call instructions is considered one; so callee instructions are not
    * considered.
    */
-  for (auto pairs : this->functionInvocations) {
-
-    /*
-     * Fetch the function.
-     */
-    auto f = pairs.first;
+  for (auto &F : M) {
+    if (this->functionInvocations.find(&F) == this->functionInvocations.end()) {
+      continue;
+    }
 
     /*
      * Consider all basic blocks.
      */
     uint64_t c = 0;
-    for (auto &bb : *f) {
+    for (auto &bb : F) {
+      if (this->bbInvocations.find(&bb) == this->bbInvocations.end()) {
+        continue;
+      }
       c += this->getStaticInstructions(&bb);
     }
-    this->functionSelfInstructions[f] = c;
+    this->functionSelfInstructions[&F] = c;
   }
 
   /*
@@ -19,8 +19,11 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "llvm/ProfileData/InstrProf.h"
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/HotProfiler.hpp"
+#include "noelle/core/LoopProfiles.hpp"
+#include "noelle/core/InputProfiles.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
@@ -28,67 +31,251 @@ using namespace llvm::noelle;
 void HotProfiler::analyzeProfiles(Module &M) {
 
   /*
-   * Fetch the invocations of each basic block of each function.
+   * Fetch the invocations of each function from its entry count.
+   * This does not need the frequencies of its basic blocks, which are the
+   * expensive part of the profiles.
    */
+  auto isProgramProfiled = false;
   for (auto &F : M) {
     if (F.empty()) {
       continue;
     }
-    auto &bfi = getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
-    auto &bpi = getAnalysis<BranchProbabilityInfoWrapperPass>(F).getBPI();
+    uint64_t invocations = 0;
+    auto entryCount = F.getEntryCount();
+    if (entryCount.hasValue()) {
+      invocations = entryCount->getCount();
+    }
+    this->hot.setFunctionInvocations(&F, invocations);
+    if (invocations > 0) {
+      isProgramProfiled = true;
+    }
+  }
+
+  /*
+   * Fetch the cycles of the program, if they have been embedded.
+   */
+  auto programCyclesMetadata =
+      M.getNamedMetadata(LoopProfiles::programCyclesMetadataName);
+  if (true && (programCyclesMetadata != nullptr)
+      && (programCyclesMetadata->getNumOperands() > 0)) {
+    auto programCyclesNode = programCyclesMetadata->getOperand(0);
+    auto cycles =
+        mdconst::extract<ConstantInt>(programCyclesNode->getOperand(0));
+    this->hot.setProgramCycles(cycles->getZExtValue());
+  }
+
+  /*
+   * Fetch the inputs the program has been profiled with, if they have been
+   * embedded.
+   */
+  auto inputsMetadata =
+      M.getNamedMetadata(InputProfiles::programMetadataName);
+  if (inputsMetadata != nullptr) {
+    for (auto inputNode : inputsMetadata->operands()) {
+      if (inputNode->getNumOperands() != 3) {
+        continue;
+      }
+      auto name = cast<MDString>(inputNode->getOperand(0))->getString();
+      auto weight = mdconst::extract<ConstantInt>(inputNode->getOperand(1));
+      auto instructions =
+          mdconst::extract<ConstantInt>(inputNode->getOperand(2));
+      this->hot.setInput(name.str(),
+                         weight->getZExtValue(),
+                         instructions->getZExtValue());
+    }
+  }
+
+  /*
+   * The rest of the profiles of a function are fetched the first time they
+   * are queried.
+   * Hence, the frequencies of the basic blocks of the functions that are never
+   * queried are never computed.
+   */
+  this->symtab = nullptr;
+  this->hot.setProfilesLoader(
+      M,
+      isProgramProfiled,
+      [this, isProgramProfiled](Function &F) {
+        this->analyzeProfiles(F, isProgramProfiled);
+      });
+
+  return;
+}
+
+void HotProfiler::analyzeProfiles(Function &F, bool isProgramProfiled) {
+
+  /*
+   * Map the names of the functions the value profiles refer to (see
+   * noelle-prof-coverage) to the functions of the module.
+   */
+  if (this->symtab == nullptr) {
+    this->symtab = std::make_unique<InstrProfSymtab>();
+    if (auto error = this->symtab->create(*F.getParent())) {
+      consumeError(std::move(error));
+    }
+  }
+
+  /*
+   * Compute the frequencies of the basic blocks of @F only if the program has
+   * been profiled.
+   */
+  std::unique_ptr<DominatorTree> dt;
+  std::unique_ptr<LoopInfo> li;
+  std::unique_ptr<BranchProbabilityInfo> bpi;
+  std::unique_ptr<BlockFrequencyInfo> bfi;
+  if (isProgramProfiled) {
+    dt = std::make_unique<DominatorTree>(F);
+    li = std::make_unique<LoopInfo>(*dt);
+    bpi = std::make_unique<BranchProbabilityInfo>(F, *li);
+    bfi = std::make_unique<BlockFrequencyInfo>(F, *bpi, *li);
+  }
+
+  /*
+   * Set the invocations of basic blocks.
+   */
+  for (auto &bb : F) {
 
     /*
-     * Set the invocations of basic blocks.
+     * Fetch the profiles of the loop headed by the basic block, if they
+     * have been embedded.
      */
-    for (auto &bb : F) {
-
-      /*
-       * Check if the basic block has been executed at least once.
-       */
-      if (!bfi.getBlockProfileCount(&bb).hasValue()) {
+    auto terminator = bb.getTerminator();
+    auto histogramMetadata =
+        terminator->getMetadata(LoopProfiles::metadataName);
+    if (histogramMetadata != nullptr) {
+      std::vector<uint64_t> histogram;
+      for (auto &operand : histogramMetadata->operands()) {
+        auto count = mdconst::extract<ConstantInt>(operand);
+        histogram.push_back(count->getZExtValue());
+      }
+      this->hot.setTripCountHistogram(&bb, std::move(histogram));
+    }
+    auto cyclesMetadata =
+        terminator->getMetadata(LoopProfiles::cyclesMetadataName);
+    if (cyclesMetadata != nullptr) {
+      auto cycles =
+          mdconst::extract<ConstantInt>(cyclesMetadata->getOperand(0));
+      this->hot.setLoopCycles(&bb, cycles->getZExtValue());
+    }
+    auto contextsMetadata =
+        terminator->getMetadata(LoopProfiles::contextsMetadataName);
+    if (contextsMetadata != nullptr) {
+      for (auto &contextOperand : contextsMetadata->operands()) {
+        auto contextMetadata = dyn_cast<MDNode>(contextOperand);
+        if (false || (contextMetadata == nullptr)
+            || (contextMetadata->getNumOperands() < 2)) {
+          continue;
+        }
+        auto cycles =
+            mdconst::extract<ConstantInt>(contextMetadata->getOperand(0));
+        auto invocations =
+            mdconst::extract<ConstantInt>(contextMetadata->getOperand(1));
+        std::vector<std::pair<Function *, uint64_t>> callSites;
+        for (auto i = 2u; (i + 1) < contextMetadata->getNumOperands(); i += 2) {
+          auto caller = mdconst::dyn_extract_or_null<Function>(
+              contextMetadata->getOperand(i));
+          if (caller == nullptr) {
+            break;
+          }
+          auto callSiteID =
+              mdconst::extract<ConstantInt>(contextMetadata->getOperand(i + 1));
+          callSites.push_back({ caller, callSiteID->getZExtValue() });
+        }
+        if ((2 + (callSites.size() * 2)) != contextMetadata->getNumOperands()) {
+          continue;
+        }
+        this->hot.setLoopContextProfiles(&bb,
+                                         std::move(callSites),
+                                         cycles->getZExtValue(),
+                                         invocations->getZExtValue());
+      }
+    }
+    auto inputsMetadata = terminator->getMetadata(InputProfiles::metadataName);
+    if (inputsMetadata != nullptr) {
+      for (auto i = 0u; (i + 1) < inputsMetadata->getNumOperands(); i += 2) {
+        auto name = cast<MDString>(inputsMetadata->getOperand(i))->getString();
+        auto instructions =
+            mdconst::extract<ConstantInt>(inputsMetadata->getOperand(i + 1));
+        this->hot.setLoopInputInstructions(&bb,
+                                           name.str(),
+                                           instructions->getZExtValue());
+      }
+    }
 
-        /*
-         * The basic block hasn't been executed.
-         */
-        this->hot.setBasicBlockInvocations(&bb, 0);
+    /*
+     * Fetch the targets of the indirect calls of the basic block, if they
+     * have been profiled.
+     */
+    for (auto &I : bb) {
+      auto call = dyn_cast<CallBase>(&I);
+      if (false || (call == nullptr) || (call->getCalledFunction() != nullptr)
+          || call->isInlineAsm()) {
         continue;
       }
+      InstrProfValueData valueData[maxIndirectCallTargets];
+      uint32_t numberOfTargets = 0;
+      uint64_t totalCount = 0;
+      if (!getValueProfDataFromInst(I,
+                                    IPVK_IndirectCallTarget,
+                                    maxIndirectCallTargets,
+                                    valueData,
+                                    numberOfTargets,
+                                    totalCount)) {
+        continue;
+      }
+      std::vector<std::pair<Function *, uint64_t>> targets;
+      for (auto i = 0u; i < numberOfTargets; i++) {
+        auto target = this->symtab->getFunction(valueData[i].Value);
+        if (target == nullptr) {
+          continue;
+        }
+        targets.push_back({ target, valueData[i].Count });
+      }
+      this->hot.setIndirectCallTargets(call, std::move(targets));
+    }
 
-      /*
-       * Fetch the basic block counter.
-       */
-      auto v = bfi.getBlockProfileCount(&bb).getValue();
+    /*
+     * Check if the basic block has been executed at least once.
+     */
+    if (false || (bfi == nullptr)
+        || !bfi->getBlockProfileCount(&bb).hasValue()) {
 
       /*
-       * Set the invocations.
+       * The basic block hasn't been executed.
        */
-      this->hot.setBasicBlockInvocations(&bb, v);
+      this->hot.setBasicBlockInvocations(&bb, 0);
+      continue;
+    }
+
+    /*
+     * Fetch the basic block counter.
+     */
+    auto v = bfi->getBlockProfileCount(&bb).getValue();
+
+    /*
+     * Set the invocations.
+     */
+    this->hot.setBasicBlockInvocations(&bb, v);
+
+    /*
+     * Compute the frequency of jumping to the successors of bb.
+     */
+    for (auto succBB : successors(&bb)) {
+      auto prob = bpi->getEdgeProbability(&bb, succBB);
+      if (prob.isUnknown()) {
+        continue;
+      }
+      auto probNum = double(prob.getNumerator());
+      auto probDen = double(prob.getDenominator());
+      auto probValue = probNum / probDen;
 
       /*
-       * Compute the frequency of jumping to the successors of bb.
+       * Set the frequency.
        */
-      for (auto succBB : successors(&bb)) {
-        auto prob = bpi.getEdgeProbability(&bb, succBB);
-        if (prob.isUnknown()) {
-          continue;
-        }
-        auto probNum = double(prob.getNumerator());
-        auto probDen = double(prob.getDenominator());
-        auto probValue = probNum / probDen;
-
-        /*
-         * Set the frequency.
-         */
-        this->hot.setBranchFrequency(&bb, succBB, probValue);
-      }
+      this->hot.setBranchFrequency(&bb, succBB, probValue);
     }
   }
 
-  /*
-   * Compute the global counters.
-   */
-  this->hot.computeProgramInvocations(M);
-
   return;
 }
 
@@ -57,6 +57,7 @@ bool Hot::hasBeenExecuted(BasicBlock *bb) const {
 
 uint64_t Hot::getInvocations(BasicBlock *bb) const {
   assert(bb != nullptr);
+  this->fetchProfiles(bb->getParent());
 
   auto inv = this->bbInvocations.at(bb);
 
@@ -104,6 +105,7 @@ uint64_t Hot::getStaticInstructions(
 
 double Hot::getBranchFrequency(BasicBlock *sourceBB,
                                BasicBlock *targetBB) const {
+  this->fetchProfiles(sourceBB->getParent());
   auto &branchSuccessors = this->branchProbability.at(sourceBB);
 
   /*
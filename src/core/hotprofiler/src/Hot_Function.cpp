@@ -48,17 +48,32 @@ uint64_t Hot::getStaticInstructions(
 }
 
 uint64_t Hot::getSelfInstructions(Function *f) const {
+  this->fetchProgramProfiles();
   auto insts = this->functionSelfInstructions.at(f);
 
   return insts;
 }
 
 uint64_t Hot::getInvocations(Function *f) const {
+
+  /*
+   * The invocations of functions are often known without fetching the rest of
+   * their profiles.
+   */
+  if (this->functionInvocations.find(f) == this->functionInvocations.end()) {
+    this->fetchProfiles(f);
+  }
   auto invs = this->functionInvocations.at(f);
 
   return invs;
 }
 
+void Hot::setFunctionInvocations(Function *f, uint64_t invocations) {
+  this->functionInvocations[f] = invocations;
+
+  return;
+}
+
 void Hot::setFunctionTotalInstructions(Function *f,
                                        uint64_t totalInstructions) {
   this->functionTotalInstructions[f] = totalInstructions;
@@ -75,6 +90,7 @@ bool Hot::isFunctionTotalInstructionsAvailable(Function &F) const {
 }
 
 uint64_t Hot::getTotalInstructions(Function *f) const {
+  this->fetchProgramProfiles();
   if (!this->isFunctionTotalInstructionsAvailable(*f)) {
     return 0;
   }
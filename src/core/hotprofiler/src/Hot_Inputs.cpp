@@ -0,0 +1,141 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Hot.hpp"
+
+namespace llvm::noelle {
+
+std::vector<std::string> Hot::getInputs(void) const {
+  std::vector<std::string> names;
+  for (auto &pair : this->inputs) {
+    names.push_back(pair.first);
+  }
+
+  return names;
+}
+
+double Hot::getInputWeight(const std::string &input) const {
+  uint64_t totalWeight = 0;
+  for (auto &pair : this->inputs) {
+    totalWeight += pair.second.first;
+  }
+  auto inputIt = this->inputs.find(input);
+  if (false || (inputIt == this->inputs.end()) || (totalWeight == 0)) {
+    return 0;
+  }
+
+  return ((double)inputIt->second.first) / ((double)totalWeight);
+}
+
+double Hot::getDynamicTotalInstructionCoverage(
+    LoopStructure *loop,
+    const std::string &input) const {
+  auto inputIt = this->inputs.find(input);
+  if (false || (inputIt == this->inputs.end())
+      || (inputIt->second.second == 0)) {
+    return 0;
+  }
+
+  /*
+   * Fetch the instructions of @loop with @input.
+   * Loops that did not run with @input have none.
+   */
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+  auto loopIt = this->loopInputInstructions.find(header);
+  if (loopIt == this->loopInputInstructions.end()) {
+    return 0;
+  }
+  auto instructionsIt = loopIt->second.find(input);
+  if (instructionsIt == loopIt->second.end()) {
+    return 0;
+  }
+  auto coverage = ((double)instructionsIt->second)
+                  / ((double)inputIt->second.second);
+
+  return coverage;
+}
+
+double Hot::getExpectedDynamicTotalInstructionCoverage(
+    LoopStructure *loop) const {
+  if (this->inputs.size() == 0) {
+    return this->getDynamicTotalInstructionCoverage(loop);
+  }
+
+  double coverage = 0;
+  for (auto &pair : this->inputs) {
+    coverage += this->getInputWeight(pair.first)
+                * this->getDynamicTotalInstructionCoverage(loop, pair.first);
+  }
+
+  return coverage;
+}
+
+double Hot::getMinimumDynamicTotalInstructionCoverage(
+    LoopStructure *loop) const {
+  if (this->inputs.size() == 0) {
+    return this->getDynamicTotalInstructionCoverage(loop);
+  }
+
+  auto coverage = 1.0;
+  for (auto &pair : this->inputs) {
+    coverage = std::min(
+        coverage,
+        this->getDynamicTotalInstructionCoverage(loop, pair.first));
+  }
+
+  return coverage;
+}
+
+double Hot::getMaximumDynamicTotalInstructionCoverage(
+    LoopStructure *loop) const {
+  if (this->inputs.size() == 0) {
+    return this->getDynamicTotalInstructionCoverage(loop);
+  }
+
+  auto coverage = 0.0;
+  for (auto &pair : this->inputs) {
+    coverage = std::max(
+        coverage,
+        this->getDynamicTotalInstructionCoverage(loop, pair.first));
+  }
+
+  return coverage;
+}
+
+void Hot::setInput(const std::string &input,
+                   uint64_t weight,
+                   uint64_t totalInstructions) {
+  this->inputs[input] = { weight, totalInstructions };
+
+  return;
+}
+
+void Hot::setLoopInputInstructions(BasicBlock *header,
+                                   const std::string &input,
+                                   uint64_t totalInstructions) {
+  this->loopInputInstructions[header][input] = totalInstructions;
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -78,6 +78,7 @@ uint64_t Hot::getInvocations(Instruction *i) const {
 }
 
 uint64_t Hot::getTotalInstructions(Instruction *i) const {
+  this->fetchProgramProfiles();
   if (this->instructionTotalInstructions.find(i)
       == this->instructionTotalInstructions.end()) {
 
@@ -106,4 +107,34 @@ bool Hot::hasBeenExecuted(Instruction *i) const {
   return true;
 }
 
+std::vector<std::pair<Function *, uint64_t>> Hot::getIndirectCallTargets(
+    CallBase *call) const {
+  this->fetchProfiles(call->getFunction());
+
+  auto it = this->indirectCallTargets.find(call);
+  if (it == this->indirectCallTargets.end()) {
+    return {};
+  }
+
+  return it->second;
+}
+
+void Hot::setIndirectCallTargets(
+    CallBase *call,
+    std::vector<std::pair<Function *, uint64_t>> targets) {
+
+  /*
+   * Sort the targets from the most frequent one.
+   */
+  std::stable_sort(targets.begin(),
+                   targets.end(),
+                   [](const std::pair<Function *, uint64_t> &a,
+                      const std::pair<Function *, uint64_t> &b) -> bool {
+                     return a.second > b.second;
+                   });
+  this->indirectCallTargets[call] = std::move(targets);
+
+  return;
+}
+
 } // namespace llvm::noelle
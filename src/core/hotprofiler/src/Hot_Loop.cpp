@@ -21,6 +21,7 @@
  */
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/Hot.hpp"
+#include "noelle/core/LoopProfiles.hpp"
 
 namespace llvm::noelle {
 
@@ -163,6 +164,239 @@ double Hot::getAverageTotalInstructionsPerIteration(LoopStructure *loop) const {
   return instsPerIteration;
 }
 
+bool Hot::hasTripCountHistogram(LoopStructure *loop) const {
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+
+  return (this->tripCountHistograms.find(header)
+          != this->tripCountHistograms.end());
+}
+
+const std::vector<uint64_t> &Hot::getTripCountHistogram(
+    LoopStructure *loop) const {
+  static const std::vector<uint64_t> empty{};
+
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+  auto found = this->tripCountHistograms.find(header);
+  if (found == this->tripCountHistograms.end()) {
+    return empty;
+  }
+
+  return found->second;
+}
+
+uint64_t Hot::getInvocationsWithTripCountBelow(LoopStructure *loop,
+                                               uint32_t log2TripCount) const {
+
+  /*
+   * Bucket i includes trip counts lower than 2^i.
+   */
+  auto &histogram = this->getTripCountHistogram(loop);
+  uint64_t invocations = 0;
+  for (uint32_t i = 0; (i <= log2TripCount) && (i < histogram.size()); i++) {
+    invocations += histogram[i];
+  }
+
+  return invocations;
+}
+
+void Hot::setTripCountHistogram(BasicBlock *header,
+                                std::vector<uint64_t> histogram) {
+  this->tripCountHistograms[header] = std::move(histogram);
+
+  return;
+}
+
+bool Hot::areCyclesAvailable(LoopStructure *loop) const {
+  if (this->programCycles == 0) {
+    return false;
+  }
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+
+  return (this->loopCycles.find(header) != this->loopCycles.end());
+}
+
+uint64_t Hot::getCycles(LoopStructure *loop) const {
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+  auto found = this->loopCycles.find(header);
+  if (found == this->loopCycles.end()) {
+    return 0;
+  }
+
+  return found->second;
+}
+
+double Hot::getDynamicCycleCoverage(LoopStructure *loop) const {
+  if (this->programCycles == 0) {
+    return 0;
+  }
+  auto lCycles = this->getCycles(loop);
+  auto coverage = ((double)lCycles) / ((double)this->programCycles);
+
+  /*
+   * Invocations of the loop through recursion are counted more than once.
+   */
+  if (coverage > 1) {
+    coverage = 1;
+  }
+
+  return coverage;
+}
+
+void Hot::setLoopCycles(BasicBlock *header, uint64_t cycles) {
+  this->loopCycles[header] = cycles;
+
+  return;
+}
+
+std::vector<std::vector<CallBase *>> Hot::getCallingContexts(
+    LoopStructure *loop) const {
+  std::vector<std::vector<CallBase *>> contexts;
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+  auto found = this->loopContextProfiles.find(header);
+  if (found == this->loopContextProfiles.end()) {
+    return contexts;
+  }
+
+  for (auto &contextProfile : found->second) {
+    std::vector<CallBase *> context;
+    for (auto &callSite : contextProfile.first) {
+      auto call = this->getCallSite(callSite.first, callSite.second);
+      if (call == nullptr) {
+        break;
+      }
+      context.push_back(call);
+    }
+    if (context.size() != contextProfile.first.size()) {
+      continue;
+    }
+    contexts.push_back(std::move(context));
+  }
+
+  return contexts;
+}
+
+uint64_t Hot::getCycles(LoopStructure *loop,
+                        const std::vector<CallBase *> &context) const {
+  return this->getContextProfiles(loop, context).first;
+}
+
+uint64_t Hot::getInvocations(LoopStructure *loop,
+                             const std::vector<CallBase *> &context) const {
+  return this->getContextProfiles(loop, context).second;
+}
+
+double Hot::getDynamicCycleCoverage(
+    LoopStructure *loop,
+    const std::vector<CallBase *> &context) const {
+  if (this->programCycles == 0) {
+    return 0;
+  }
+  auto contextCycles = this->getCycles(loop, context);
+  auto coverage = ((double)contextCycles) / ((double)this->programCycles);
+
+  /*
+   * Invocations of the loop through recursion are counted more than once.
+   */
+  if (coverage > 1) {
+    coverage = 1;
+  }
+
+  return coverage;
+}
+
+void Hot::setLoopContextProfiles(
+    BasicBlock *header,
+    std::vector<std::pair<Function *, uint64_t>> callSites,
+    uint64_t cycles,
+    uint64_t invocations) {
+  this->loopContextProfiles[header][std::move(callSites)] = { cycles,
+                                                             invocations };
+
+  return;
+}
+
+std::pair<uint64_t, uint64_t> Hot::getContextProfiles(
+    LoopStructure *loop,
+    const std::vector<CallBase *> &context) const {
+  std::pair<uint64_t, uint64_t> profiles{ 0, 0 };
+  auto header = loop->getHeader();
+  this->fetchProfiles(header->getParent());
+  auto found = this->loopContextProfiles.find(header);
+  if (found == this->loopContextProfiles.end()) {
+    return profiles;
+  }
+
+  for (auto &contextProfile : found->second) {
+
+    /*
+     * Check if the context starts with @context.
+     */
+    auto &callSites = contextProfile.first;
+    if (callSites.size() < context.size()) {
+      continue;
+    }
+    auto isPrefix = true;
+    for (auto i = 0u; i < context.size(); i++) {
+      auto call = this->getCallSite(callSites[i].first, callSites[i].second);
+      if (call != context[i]) {
+        isPrefix = false;
+        break;
+      }
+    }
+    if (!isPrefix) {
+      continue;
+    }
+    profiles.first += contextProfile.second.first;
+    profiles.second += contextProfile.second.second;
+  }
+
+  return profiles;
+}
+
+CallBase *Hot::getCallSite(Function *f, uint64_t callSiteID) const {
+
+  /*
+   * Fetch the call sites of the module.
+   * Functions that have been deleted are not part of the module anymore, so
+   * @f is only compared with the functions of the module.
+   */
+  if (true && (!this->areCallSitesLoaded) && (this->program != nullptr)) {
+    for (auto &F : *this->program) {
+      for (auto &I : instructions(F)) {
+        auto callSiteMetadata =
+            I.getMetadata(LoopProfiles::callSiteMetadataName);
+        if (callSiteMetadata == nullptr) {
+          continue;
+        }
+        auto id =
+            mdconst::extract<ConstantInt>(callSiteMetadata->getOperand(0));
+        this->callSites[&F][id->getZExtValue()] = WeakVH(&I);
+      }
+    }
+    this->areCallSitesLoaded = true;
+  }
+
+  /*
+   * Fetch the call site.
+   * Call sites deleted after being fetched are null.
+   */
+  auto found = this->callSites.find(f);
+  if (found == this->callSites.end()) {
+    return nullptr;
+  }
+  auto foundCall = found->second.find(callSiteID);
+  if (foundCall == found->second.end()) {
+    return nullptr;
+  }
+
+  return dyn_cast_or_null<CallBase>((Value *)foundCall->second);
+}
+
 uint64_t Hot::getIterations(LoopStructure *l) const {
 
   /*
@@ -25,6 +25,8 @@
 namespace llvm::noelle {
 
 uint64_t Hot::getSelfInstructions(void) const {
+  this->fetchProgramProfiles();
+
   return this->moduleNumberOfInstructionsExecuted;
 }
 
@@ -48,4 +50,14 @@ uint64_t Hot::getTotalInstructions(void) const {
   return this->getSelfInstructions();
 }
 
+uint64_t Hot::getCycles(void) const {
+  return this->programCycles;
+}
+
+void Hot::setProgramCycles(uint64_t cycles) {
+  this->programCycles = cycles;
+
+  return;
+}
+
 } // namespace llvm::noelle
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/IR/MDBuilder.h"
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Hot.hpp"
+#include "noelle/core/UniqueIRMarker.hpp"
+
+namespace llvm::noelle {
+
+void Hot::snapshotProfiles(Function *f) {
+  if (false || (!this->isAvailable()) || f->empty()) {
+    return;
+  }
+
+  /*
+   * Basic blocks are identified by the ID of their terminator.
+   * Transformations that clone code copy these IDs, and the ones that move
+   * instructions (e.g., LICM) do not move terminators.
+   */
+  for (auto &bb : *f) {
+    auto terminator = bb.getTerminator();
+    auto id = UniqueIRMarkerReader::getInstructionID(terminator);
+    if (!id) {
+      id = this->markInstruction(terminator);
+    }
+    this->snapshotInvocations[*id] = { f, this->getInvocations(&bb) };
+  }
+
+  return;
+}
+
+void Hot::remapProfiles(Function *f) {
+  if (false || (!this->isAvailable()) || f->empty()) {
+    return;
+  }
+
+  /*
+   * Fetch the profiles of the new code of @f from its branch weights.
+   */
+  this->invalidateProfiles(f);
+  this->fetchProfiles(f);
+
+  /*
+   * Group the basic blocks of @f by the basic block of the snapshot they come
+   * from.
+   * Basic blocks copied from other functions (e.g., by inlining) are left as
+   * they are: the branch weights they carry are scaled by the invocations of
+   * the call they replaced.
+   */
+  std::unordered_map<IDType, std::vector<BasicBlock *>> copies;
+  for (auto &bb : *f) {
+    auto id = UniqueIRMarkerReader::getInstructionID(bb.getTerminator());
+    if (!id) {
+      continue;
+    }
+    auto snapshotIt = this->snapshotInvocations.find(*id);
+    if (false || (snapshotIt == this->snapshotInvocations.end())
+        || (snapshotIt->second.first != f)) {
+      continue;
+    }
+    copies[*id].push_back(&bb);
+  }
+
+  /*
+   * A basic block that has only been moved keeps the invocations of its
+   * original.
+   * Copies of a basic block never run more often than their original: they
+   * run either one after the other (e.g., the loops generated by distributing
+   * a loop) or alternatively (e.g., the bodies of an unrolled loop).
+   * Hence, the invocations estimated from their branch weights are capped to
+   * the ones of their original.
+   */
+  for (auto &pair : copies) {
+    auto originalInvocations = this->snapshotInvocations[pair.first].second;
+    auto &blocks = pair.second;
+    if (blocks.size() == 1) {
+      this->setBasicBlockInvocations(blocks[0], originalInvocations);
+      continue;
+    }
+    for (auto bb : blocks) {
+      auto estimatedInvocations = this->bbInvocations.at(bb);
+      this->setBasicBlockInvocations(
+          bb,
+          std::min(estimatedInvocations, originalInvocations));
+    }
+  }
+
+  /*
+   * Store the invocations remapped, so the next invocations of NOELLE find
+   * them without profiling the program again.
+   */
+  this->embedProfiles(f);
+
+  return;
+}
+
+void Hot::invalidateProfiles(Function *f) {
+
+  /*
+   * Forget the profiles of the basic blocks of @f.
+   * Basic blocks that have been deleted are never queried again.
+   */
+  for (auto &bb : *f) {
+    this->bbInvocations.erase(&bb);
+    this->branchProbability.erase(&bb);
+    this->tripCountHistograms.erase(&bb);
+    this->loopCycles.erase(&bb);
+    this->loopContextProfiles.erase(&bb);
+    this->loopInputInstructions.erase(&bb);
+    for (auto &inst : bb) {
+      if (auto call = dyn_cast<CallBase>(&inst)) {
+        this->indirectCallTargets.erase(call);
+      }
+    }
+  }
+  this->functionInvocations.erase(f);
+  this->loadedFunctions.erase(f);
+  this->callSites.clear();
+  this->areCallSitesLoaded = false;
+
+  /*
+   * The profiles of the program depend on the ones of @f.
+   */
+  this->functionSelfInstructions.clear();
+  this->functionTotalInstructions.clear();
+  this->instructionTotalInstructions.clear();
+  this->moduleNumberOfInstructionsExecuted = 0;
+  this->areProgramProfilesLoaded = false;
+
+  return;
+}
+
+void Hot::embedProfiles(Function *f) {
+
+  /*
+   * Set the invocations of @f.
+   */
+  auto entryInvocations = this->getInvocations(&f->getEntryBlock());
+  f->setEntryCount(
+      Function::ProfileCount(entryInvocations, Function::PCT_Real));
+
+  /*
+   * Set the branch weights.
+   * The weight of an edge is the number of invocations of its destination if
+   * this is its only predecessor, or the frequency of the edge otherwise.
+   */
+  MDBuilder mdBuilder(f->getContext());
+  for (auto &bb : *f) {
+    auto terminator = bb.getTerminator();
+    if (false || (terminator->getNumSuccessors() < 2)
+        || (!isa<BranchInst>(terminator) && !isa<SwitchInst>(terminator))) {
+      continue;
+    }
+    auto invocations = this->getInvocations(&bb);
+    if (invocations == 0) {
+      continue;
+    }
+    std::vector<uint64_t> edgeInvocations;
+    uint64_t maximumEdgeInvocations = 0;
+    for (auto succBB : successors(&bb)) {
+      uint64_t edge = 0;
+      if (succBB->getSinglePredecessor() == &bb) {
+        edge = this->getInvocations(succBB);
+      } else {
+        edge = (uint64_t)(this->getBranchFrequency(&bb, succBB) * invocations);
+      }
+      edgeInvocations.push_back(edge);
+      maximumEdgeInvocations = std::max(maximumEdgeInvocations, edge);
+    }
+
+    /*
+     * Branch weights are 32 bits.
+     */
+    uint64_t scale = (maximumEdgeInvocations / UINT32_MAX) + 1;
+    std::vector<uint32_t> weights;
+    for (auto edge : edgeInvocations) {
+      weights.push_back((uint32_t)(edge / scale));
+    }
+    terminator->setMetadata(LLVMContext::MD_prof,
+                            mdBuilder.createBranchWeights(weights));
+  }
+
+  return;
+}
+
+uint64_t Hot::markInstruction(Instruction *inst) {
+
+  /*
+   * Start from the IDs after the ones already given (see UniqueIRMarker).
+   */
+  if (!this->isNextInstructionIDKnown) {
+    this->nextInstructionID = 0;
+    for (auto &F : *this->program) {
+      for (auto &i : instructions(F)) {
+        auto id = UniqueIRMarkerReader::getInstructionID(&i);
+        if (id) {
+          this->nextInstructionID =
+              std::max(this->nextInstructionID, *id + 1);
+        }
+      }
+    }
+    this->isNextInstructionIDKnown = true;
+  }
+
+  /*
+   * Give the next ID to @inst.
+   */
+  auto &cxt = inst->getContext();
+  auto id = this->nextInstructionID++;
+  auto idMetadata = MDNode::get(
+      cxt,
+      ConstantAsMetadata::get(ConstantInt::get(
+          cxt,
+          llvm::APInt(UniqueIRMarker::IDSize, id, false))));
+  inst->setMetadata(UniqueIRConstants::VIAInstruction, idMetadata);
+
+  return id;
+}
+
+} // namespace llvm::noelle
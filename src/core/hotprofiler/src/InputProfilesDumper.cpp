@@ -0,0 +1,118 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include "noelle/core/HotProfiler.hpp"
+#include "noelle/core/LoopProfiles.hpp"
+#include "noelle/core/InputProfiles.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<std::string> InputName(
+    "noelle-input-profiles-name",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Name of the input the embedded profile comes from"));
+static cl::opt<uint64_t> InputWeight(
+    "noelle-input-profiles-weight",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init(1),
+    cl::desc("Weight of the input the embedded profile comes from"));
+
+InputProfilesDumper::InputProfilesDumper() : ModulePass(ID) {
+  return;
+}
+
+bool InputProfilesDumper::doInitialization(Module &M) {
+  return false;
+}
+
+bool InputProfilesDumper::runOnModule(Module &M) {
+  if (InputName.getNumOccurrences() == 0) {
+    errs() << "InputProfilesDumper: ERROR = the name of the input is missing "
+              "(see -noelle-input-profiles-name)\n";
+    abort();
+  }
+  auto name = InputName.getValue();
+  auto weight = InputWeight.getValue();
+
+  /*
+   * Fetch the profiles.
+   */
+  auto &hot = getAnalysis<HotProfiler>().getHot();
+  if (!hot.isAvailable()) {
+    errs() << "InputProfilesDumper: Warning = the input " << name
+           << " has no profile\n";
+    return false;
+  }
+
+  /*
+   * Append the profiles of the input.
+   * Each line is either "program NAME WEIGHT INSTRUCTIONS" or
+   * "NAME WEIGHT INSTRUCTIONS HEADER_INDEX FUNCTION_NAME".
+   */
+  std::ofstream file(InputProfiles::defaultFileName, std::ios::app);
+  if (!file.good()) {
+    errs() << "InputProfilesDumper: Warning = file "
+           << InputProfiles::defaultFileName << " cannot be written\n";
+    return false;
+  }
+  file << "program " << name << " " << weight << " "
+       << hot.getTotalInstructions() << "\n";
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    for (auto loop : LI.getLoopsInPreorder()) {
+      LoopStructure ls{ loop };
+      auto instructions = hot.getTotalInstructions(&ls);
+      if (instructions == 0) {
+        continue;
+      }
+      file << name << " " << weight << " " << instructions << " "
+           << LoopProfiles::getHeaderIndex(loop) << " " << F.getName().str()
+           << "\n";
+    }
+  }
+
+  return false;
+}
+
+void InputProfilesDumper::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
+  AU.addRequired<HotProfiler>();
+  AU.setPreservesAll();
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char InputProfilesDumper::ID = 0;
+static RegisterPass<InputProfilesDumper> X(
+    "noelle-input-profiles-dump",
+    "Dump the instructions executed by loops with the profile of an input");
+
+} // namespace llvm::noelle
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include "noelle/core/LoopProfiles.hpp"
+#include "noelle/core/InputProfiles.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<std::string> InputProfilesFile(
+    "noelle-input-profiles-file",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File with the profiles dumped by noelle-input-profiles-dump"));
+
+InputProfilesEmbedder::InputProfilesEmbedder() : ModulePass(ID) {
+  return;
+}
+
+bool InputProfilesEmbedder::doInitialization(Module &M) {
+  return false;
+}
+
+bool InputProfilesEmbedder::runOnModule(Module &M) {
+
+  /*
+   * Open the file with the profiles.
+   */
+  std::string fileName = InputProfiles::defaultFileName;
+  if (InputProfilesFile.getNumOccurrences() > 0) {
+    fileName = InputProfilesFile.getValue();
+  }
+  std::ifstream file(fileName);
+  if (!file.good()) {
+    errs() << "InputProfilesEmbedder: Warning = file " << fileName
+           << " cannot be read\n";
+    return false;
+  }
+
+  /*
+   * Read the profiles (see InputProfilesDumper).
+   * An input dumped more than once has its instructions summed.
+   */
+  std::map<std::string, std::pair<uint64_t, uint64_t>> inputs;
+  std::map<std::pair<std::string, uint64_t>, std::map<std::string, uint64_t>>
+      loops;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream lineStream(line);
+    std::string name;
+    uint64_t weight = 0;
+    uint64_t instructions = 0;
+    if (line.compare(0, 8, "program ") == 0) {
+      std::string tag;
+      if (lineStream >> tag >> name >> weight >> instructions) {
+        inputs[name].first = weight;
+        inputs[name].second += instructions;
+      }
+      continue;
+    }
+    uint64_t headerIndex = 0;
+    std::string functionName;
+    if (!(lineStream >> name >> weight >> instructions >> headerIndex)) {
+      continue;
+    }
+    lineStream >> std::ws;
+    std::getline(lineStream, functionName);
+    loops[{ functionName, headerIndex }][name] += instructions;
+  }
+  if (inputs.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Embed the inputs.
+   */
+  auto &context = M.getContext();
+  auto int64 = IntegerType::get(context, 64);
+  auto getValueMetadata = [int64](uint64_t value) -> Metadata * {
+    return ConstantAsMetadata::get(ConstantInt::get(int64, value));
+  };
+  auto inputsMetadata =
+      M.getOrInsertNamedMetadata(InputProfiles::programMetadataName);
+  inputsMetadata->clearOperands();
+  for (auto &pair : inputs) {
+    inputsMetadata->addOperand(
+        MDNode::get(context,
+                    { MDString::get(context, pair.first),
+                      getValueMetadata(pair.second.first),
+                      getValueMetadata(pair.second.second) }));
+  }
+
+  /*
+   * Embed the instructions of the loops.
+   * The terminator of the header, which represents the loop, is tagged with
+   * the name of each input followed by the instructions of the loop with it.
+   */
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    for (auto loop : LI.getLoopsInPreorder()) {
+      auto headerIndex = LoopProfiles::getHeaderIndex(loop);
+      auto found = loops.find({ F.getName().str(), headerIndex });
+      if (found == loops.end()) {
+        continue;
+      }
+      std::vector<Metadata *> operands;
+      for (auto &pair : found->second) {
+        operands.push_back(MDString::get(context, pair.first));
+        operands.push_back(getValueMetadata(pair.second));
+      }
+      auto headerTerminator = loop->getHeader()->getTerminator();
+      headerTerminator->setMetadata(InputProfiles::metadataName,
+                                    MDNode::get(context, operands));
+    }
+  }
+
+  return true;
+}
+
+void InputProfilesEmbedder::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char InputProfilesEmbedder::ID = 0;
+static RegisterPass<InputProfilesEmbedder> X(
+    "noelle-input-profiles-embed",
+    "Embed the instructions executed by loops with each input as metadata");
+
+} // namespace llvm::noelle
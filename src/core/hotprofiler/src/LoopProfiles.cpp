@@ -0,0 +1,66 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/LoopProfiles.hpp"
+
+namespace llvm::noelle {
+
+uint64_t LoopProfiles::getHeaderIndex(Loop *loop) {
+  auto header = loop->getHeader();
+  auto F = header->getParent();
+
+  uint64_t index = 0;
+  for (auto &bb : *F) {
+    if (&bb == header) {
+      break;
+    }
+    index++;
+  }
+
+  return index;
+}
+
+uint64_t LoopProfiles::getInstructionIndex(Instruction *inst) {
+  auto F = inst->getFunction();
+
+  uint64_t index = 0;
+  for (auto &I : instructions(F)) {
+    if (&I == inst) {
+      break;
+    }
+    index++;
+  }
+
+  return index;
+}
+
+Instruction *LoopProfiles::getInstruction(Function &F, uint64_t index) {
+  for (auto &I : instructions(F)) {
+    if (index == 0) {
+      return &I;
+    }
+    index--;
+  }
+
+  return nullptr;
+}
+
+} // namespace llvm::noelle
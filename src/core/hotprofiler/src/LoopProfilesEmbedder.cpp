@@ -0,0 +1,281 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include "noelle/core/LoopProfiles.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<std::string> ProfilesFile(
+    "noelle-loop-profiles-file",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File with the profiles dumped by the loops "
+             "instrumented by noelle-loop-profiles-instr"));
+
+LoopProfilesEmbedder::LoopProfilesEmbedder() : ModulePass(ID) {
+  return;
+}
+
+bool LoopProfilesEmbedder::doInitialization(Module &M) {
+  return false;
+}
+
+bool LoopProfilesEmbedder::runOnModule(Module &M) {
+
+  /*
+   * Open the file with the profiles.
+   */
+  std::string fileName = LoopProfiles::defaultFileName;
+  if (ProfilesFile.getNumOccurrences() > 0) {
+    fileName = ProfilesFile.getValue();
+  }
+  std::ifstream file(fileName);
+  if (!file.good()) {
+    errs() << "LoopProfilesEmbedder: Warning = file " << fileName
+           << " cannot be read\n";
+    return false;
+  }
+
+  /*
+   * Read the profiles.
+   * Each line is either "program CYCLES",
+   * "COUNTER VALUE HEADER_INDEX FUNCTION_NAME", or
+   * "context COUNTER VALUE HEADER_INDEX FUNCTION_NAME CALLS" where CALLS lists
+   * the position and the function of each call site of a calling context.
+   * Several runs of the program append to the same file, so the values of a
+   * counter are summed.
+   */
+  std::map<std::pair<std::string, uint64_t>, std::vector<uint64_t>> profiles;
+  std::map<std::pair<std::string, uint64_t>,
+           std::map<std::vector<std::pair<std::string, uint64_t>>,
+                    std::vector<uint64_t>>>
+      contextProfiles;
+  uint64_t programCycles = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream lineStream(line);
+    if (line.compare(0, 8, "program ") == 0) {
+      std::string tag;
+      uint64_t cycles = 0;
+      if (lineStream >> tag >> cycles) {
+        programCycles += cycles;
+      }
+      continue;
+    }
+    if (line.compare(0, 8, "context ") == 0) {
+      std::string tag;
+      uint64_t counter = 0;
+      uint64_t value = 0;
+      uint64_t headerIndex = 0;
+      std::string functionName;
+      if (!(lineStream >> tag >> counter >> value >> headerIndex
+            >> functionName)) {
+        continue;
+      }
+      std::vector<std::pair<std::string, uint64_t>> calls;
+      uint64_t callIndex = 0;
+      std::string callerName;
+      while (lineStream >> callIndex >> callerName) {
+        calls.push_back({ callerName, callIndex });
+      }
+      if (false || (counter >= LoopProfiles::countersPerContext)
+          || (calls.size() == 0)) {
+        continue;
+      }
+      auto &counters = contextProfiles[{ functionName, headerIndex }][calls];
+      counters.resize(LoopProfiles::countersPerContext, 0);
+      counters[counter] += value;
+      continue;
+    }
+    uint64_t counter = 0;
+    uint64_t value = 0;
+    uint64_t headerIndex = 0;
+    std::string functionName;
+    if (!(lineStream >> counter >> value >> headerIndex)) {
+      continue;
+    }
+    lineStream >> std::ws;
+    std::getline(lineStream, functionName);
+    if (counter >= LoopProfiles::countersPerLoop) {
+      continue;
+    }
+    auto &counters = profiles[{ functionName, headerIndex }];
+    counters.resize(LoopProfiles::countersPerLoop, 0);
+    counters[counter] += value;
+  }
+  if (profiles.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Embed the cycles of the program.
+   */
+  auto &context = M.getContext();
+  auto int64 = IntegerType::get(context, 64);
+  auto getValueMetadata = [int64](uint64_t value) -> Metadata * {
+    return ConstantAsMetadata::get(ConstantInt::get(int64, value));
+  };
+
+  /*
+   * Call sites keep the IDs they have been tagged with by previous
+   * embeddings, so IDs stay unique within the module.
+   */
+  uint64_t nextCallSiteID = 0;
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      auto callSiteMetadata =
+          I.getMetadata(LoopProfiles::callSiteMetadataName);
+      if (callSiteMetadata == nullptr) {
+        continue;
+      }
+      auto callSiteID =
+          mdconst::extract<ConstantInt>(callSiteMetadata->getOperand(0));
+      nextCallSiteID =
+          std::max(nextCallSiteID, callSiteID->getZExtValue() + 1);
+    }
+  }
+  auto getCallSiteID = [&context, &getValueMetadata, &nextCallSiteID](
+                           CallBase *call) -> uint64_t {
+    auto callSiteMetadata =
+        call->getMetadata(LoopProfiles::callSiteMetadataName);
+    if (callSiteMetadata != nullptr) {
+      auto callSiteID =
+          mdconst::extract<ConstantInt>(callSiteMetadata->getOperand(0));
+      return callSiteID->getZExtValue();
+    }
+    auto callSiteID = nextCallSiteID++;
+    call->setMetadata(LoopProfiles::callSiteMetadataName,
+                      MDNode::get(context, { getValueMetadata(callSiteID) }));
+
+    return callSiteID;
+  };
+  auto programCyclesMetadata =
+      M.getOrInsertNamedMetadata(LoopProfiles::programCyclesMetadataName);
+  programCyclesMetadata->clearOperands();
+  programCyclesMetadata->addOperand(
+      MDNode::get(context, { getValueMetadata(programCycles) }));
+
+  /*
+   * Embed the profiles to the loops.
+   */
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    for (auto loop : LI.getLoopsInPreorder()) {
+      auto headerIndex = LoopProfiles::getHeaderIndex(loop);
+      auto found = profiles.find({ F.getName().str(), headerIndex });
+      if (found == profiles.end()) {
+        continue;
+      }
+      auto &counters = found->second;
+
+      /*
+       * Fetch the histogram dropping its empty buckets at the end.
+       */
+      std::vector<uint64_t> histogram(
+          counters.begin(),
+          counters.begin() + LoopProfiles::numberOfBuckets);
+      while ((histogram.size() > 0) && (histogram.back() == 0)) {
+        histogram.pop_back();
+      }
+
+      /*
+       * Tag the terminator of the header, which represents the loop.
+       */
+      std::vector<Metadata *> buckets;
+      for (auto count : histogram) {
+        buckets.push_back(getValueMetadata(count));
+      }
+      auto headerTerminator = loop->getHeader()->getTerminator();
+      headerTerminator->setMetadata(LoopProfiles::metadataName,
+                                    MDNode::get(context, buckets));
+      auto cycles = counters[LoopProfiles::cyclesCounter];
+      headerTerminator->setMetadata(
+          LoopProfiles::cyclesMetadataName,
+          MDNode::get(context, { getValueMetadata(cycles) }));
+
+      /*
+       * Embed the profiles of the calling contexts of the loop.
+       * Each call site is tagged with an ID the contexts refer to.
+       */
+      auto foundContexts =
+          contextProfiles.find({ F.getName().str(), headerIndex });
+      if (foundContexts == contextProfiles.end()) {
+        continue;
+      }
+      std::vector<Metadata *> contexts;
+      for (auto &contextProfile : foundContexts->second) {
+        auto &contextCounters = contextProfile.second;
+        std::vector<Metadata *> contextOperands;
+        contextOperands.push_back(getValueMetadata(
+            contextCounters[LoopProfiles::contextCyclesCounter]));
+        contextOperands.push_back(getValueMetadata(
+            contextCounters[LoopProfiles::contextInvocationsCounter]));
+        for (auto &callSite : contextProfile.first) {
+          auto caller = M.getFunction(callSite.first);
+          if (caller == nullptr) {
+            break;
+          }
+          auto call = dyn_cast_or_null<CallBase>(
+              LoopProfiles::getInstruction(*caller, callSite.second));
+          if (call == nullptr) {
+            break;
+          }
+          auto callSiteID = getCallSiteID(call);
+          contextOperands.push_back(ValueAsMetadata::get(caller));
+          contextOperands.push_back(getValueMetadata(callSiteID));
+        }
+        if (contextOperands.size()
+            != (2 + (contextProfile.first.size() * 2))) {
+          errs() << "LoopProfilesEmbedder: Warning = a calling context of a "
+                    "loop of "
+                 << F.getName() << " does not match the module\n";
+          continue;
+        }
+        contexts.push_back(MDNode::get(context, contextOperands));
+      }
+      headerTerminator->setMetadata(LoopProfiles::contextsMetadataName,
+                                    MDNode::get(context, contexts));
+    }
+  }
+
+  return true;
+}
+
+void LoopProfilesEmbedder::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char LoopProfilesEmbedder::ID = 0;
+static RegisterPass<LoopProfilesEmbedder> X(
+    "noelle-loop-profiles-embed",
+    "Embed the trip-count histograms of loops as metadata");
+
+} // namespace llvm::noelle
@@ -0,0 +1,729 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+#include "noelle/core/LoopProfiles.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<uint32_t> ContextDepth(
+    "noelle-loop-profiles-context-depth",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init(2),
+    cl::desc("Number of call sites of the calling contexts the loops are "
+             "profiled in (0 disables them)"));
+
+LoopProfilesInstrumenter::LoopProfilesInstrumenter()
+  : ModulePass(ID),
+    contextDepth{ 0 } {
+  return;
+}
+
+bool LoopProfilesInstrumenter::doInitialization(Module &M) {
+  return false;
+}
+
+bool LoopProfilesInstrumenter::runOnModule(Module &M) {
+  this->contextDepth =
+      std::min(ContextDepth.getValue(), LoopProfiles::maxContextDepth);
+
+  /*
+   * Fetch the loops to instrument.
+   */
+  std::vector<Loop *> loops;
+  std::vector<std::string> loopNames;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    for (auto loop : LI.getLoopsInPreorder()) {
+      if (!this->canBeInstrumented(loop)) {
+        continue;
+      }
+      loops.push_back(loop);
+      auto headerIndex = LoopProfiles::getHeaderIndex(loop);
+      loopNames.push_back(std::to_string(headerIndex) + " "
+                          + F.getName().str());
+    }
+  }
+  if (loops.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Fetch the call sites that keep track of the calling contexts.
+   * Like loops, they are named by their position before any instrumentation.
+   */
+  std::vector<CallInst *> calls;
+  uint64_t maxCallSites = (((uint64_t)1) << bitsPerCallSite) - 1;
+  for (auto &F : M) {
+    if (this->contextDepth == 0) {
+      break;
+    }
+    uint64_t index = 0;
+    for (auto &I : instructions(F)) {
+      auto call = dyn_cast<CallInst>(&I);
+      if (true && (call != nullptr) && this->canBeInstrumented(call)
+          && (calls.size() < maxCallSites)) {
+        calls.push_back(call);
+        this->callSiteIDs[call] = calls.size();
+        this->callSiteNames[call] =
+            std::to_string(index) + " " + F.getName().str();
+      }
+      index++;
+    }
+  }
+
+  /*
+   * Fetch the calling contexts of the loops.
+   */
+  std::unordered_map<Function *, std::vector<std::pair<uint64_t, std::string>>>
+      functionContexts;
+  std::vector<std::vector<uint64_t>> loopContexts;
+  std::vector<std::string> contextNames;
+  for (uint64_t loopIndex = 0; loopIndex < loops.size(); loopIndex++) {
+    auto F = loops[loopIndex]->getHeader()->getParent();
+    if (functionContexts.find(F) == functionContexts.end()) {
+      functionContexts[F] = this->getContexts(F);
+    }
+    loopContexts.emplace_back();
+    for (auto &context : functionContexts[F]) {
+      loopContexts.back().push_back(context.first);
+      contextNames.push_back(loopNames[loopIndex] + " " + context.second);
+    }
+  }
+
+  /*
+   * Allocate the counters of the loops.
+   */
+  auto int64 = IntegerType::get(M.getContext(), 64);
+  auto countersType =
+      ArrayType::get(int64, loops.size() * LoopProfiles::countersPerLoop);
+  auto counters =
+      new GlobalVariable(M,
+                         countersType,
+                         /*isConstant=*/false,
+                         GlobalValue::InternalLinkage,
+                         Constant::getNullValue(countersType),
+                         "noelle.loop_profiles.counters");
+  auto programStart =
+      new GlobalVariable(M,
+                         int64,
+                         /*isConstant=*/false,
+                         GlobalValue::InternalLinkage,
+                         ConstantInt::get(int64, 0),
+                         "noelle.loop_profiles.program_start");
+
+
+  /*
+   * Allocate the calling context of the running code and the counters of the
+   * contexts of the loops.
+   * The last counters are the ones of the contexts that are not profiled,
+   * which are not dumped.
+   */
+  auto context = new GlobalVariable(M,
+                                    int64,
+                                    /*isConstant=*/false,
+                                    GlobalValue::InternalLinkage,
+                                    ConstantInt::get(int64, 0),
+                                    "noelle.loop_profiles.context",
+                                    nullptr,
+                                    GlobalValue::GeneralDynamicTLSModel);
+  auto contextCountersType =
+      ArrayType::get(int64,
+                     (contextNames.size() + 1)
+                         * LoopProfiles::countersPerContext);
+  auto contextCounters =
+      new GlobalVariable(M,
+                         contextCountersType,
+                         /*isConstant=*/false,
+                         GlobalValue::InternalLinkage,
+                         Constant::getNullValue(contextCountersType),
+                         "noelle.loop_profiles.context_counters");
+
+  /*
+   * Instrument the loops.
+   */
+  uint64_t firstContext = 0;
+  for (uint64_t loopIndex = 0; loopIndex < loops.size(); loopIndex++) {
+    this->instrumentLoop(loops[loopIndex],
+                         counters,
+                         loopIndex,
+                         context,
+                         contextCounters,
+                         firstContext,
+                         loopContexts[loopIndex]);
+    firstContext += loopContexts[loopIndex].size();
+  }
+
+  /*
+   * Keep track of the calling contexts.
+   */
+  for (auto call : calls) {
+    this->instrumentCall(call, context);
+  }
+
+  /*
+   * Measure the cycles of the program from when it starts, and dump the
+   * profiles when it exits.
+   */
+  auto startFunction = this->createStartFunction(M, programStart);
+  appendToGlobalCtors(M, startFunction, 0);
+  auto dumpFunction = this->createDumpFunction(M,
+                                               counters,
+                                               contextCounters,
+                                               programStart,
+                                               loopNames,
+                                               contextNames);
+  appendToGlobalDtors(M, dumpFunction, 0);
+
+  return true;
+}
+
+bool LoopProfilesInstrumenter::canBeInstrumented(Loop *loop) const {
+
+  /*
+   * The counters of an invocation are reset in the pre-header and they are
+   * read when the loop exits. Hence, the loop must have a pre-header and exit
+   * blocks that are reachable only from it.
+   */
+  if (false || (loop->getLoopPreheader() == nullptr)
+      || (!loop->hasDedicatedExits())) {
+    return false;
+  }
+  SmallVector<BasicBlock *, 4> exitBlocks;
+  loop->getUniqueExitBlocks(exitBlocks);
+  for (auto exitBlock : exitBlocks) {
+    if (exitBlock->getFirstInsertionPt() == exitBlock->end()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool LoopProfilesInstrumenter::canBeInstrumented(CallInst *call) const {
+
+  /*
+   * The calling context is updated around the call, so the call must return
+   * to the instruction after it.
+   */
+  if (false || call->isInlineAsm() || call->isMustTailCall()) {
+    return false;
+  }
+
+  /*
+   * Indirect calls might reach the loops.
+   * Direct calls can only if their callee has a body in the module.
+   */
+  auto callee = call->getCalledFunction();
+  if (callee == nullptr) {
+    return true;
+  }
+
+  return !callee->empty();
+}
+
+std::vector<std::pair<uint64_t, std::string>> LoopProfilesInstrumenter::
+    getContexts(Function *F) const {
+  std::vector<std::pair<uint64_t, std::string>> contexts;
+  if (this->contextDepth == 0) {
+    return contexts;
+  }
+  this->getContexts(F, 0, 0, "", contexts);
+
+  return contexts;
+}
+
+void LoopProfilesInstrumenter::getContexts(
+    Function *F,
+    uint32_t depth,
+    uint64_t context,
+    std::string name,
+    std::vector<std::pair<uint64_t, std::string>> &contexts) const {
+
+  /*
+   * Fetch the direct calls to @F that keep track of the calling contexts.
+   */
+  std::vector<CallInst *> calls;
+  for (auto user : F->users()) {
+    auto call = dyn_cast<CallInst>(user);
+    if (false || (call == nullptr) || (call->getCalledFunction() != F)
+        || (this->callSiteIDs.find(call) == this->callSiteIDs.end())) {
+      continue;
+    }
+    calls.push_back(call);
+  }
+
+  /*
+   * A context ends at the maximum depth, or at a function that is not called
+   * directly (e.g., main), which runs in an empty context.
+   */
+  if (false || (depth == this->contextDepth) || (calls.size() == 0)) {
+    if (true && (depth > 0)
+        && (contexts.size() < LoopProfiles::maxContextsPerLoop)) {
+      contexts.push_back({ context, name });
+    }
+    return;
+  }
+
+  /*
+   * Extend the context with each call to @F.
+   */
+  for (auto call : calls) {
+    if (contexts.size() == LoopProfiles::maxContextsPerLoop) {
+      break;
+    }
+    auto callSiteID = this->callSiteIDs.at(call);
+    auto callerContext = context | (callSiteID << (depth * bitsPerCallSite));
+    auto callerName = name + (depth > 0 ? " " : "")
+                      + this->callSiteNames.at(call);
+    this->getContexts(call->getFunction(),
+                      depth + 1,
+                      callerContext,
+                      callerName,
+                      contexts);
+  }
+
+  return;
+}
+
+void LoopProfilesInstrumenter::instrumentCall(CallInst *call,
+                                              GlobalVariable *context) {
+  auto int64 = IntegerType::get(call->getContext(), 64);
+  auto callSiteID = this->callSiteIDs.at(call);
+
+  /*
+   * Push the call site to the calling context before the call, dropping the
+   * oldest call site beyond the depth of the contexts.
+   */
+  IRBuilder<> beforeBuilder{ call };
+  auto callerContext = beforeBuilder.CreateLoad(context);
+  auto calleeContext =
+      beforeBuilder.CreateOr(beforeBuilder.CreateShl(callerContext,
+                                                     bitsPerCallSite),
+                             ConstantInt::get(int64, callSiteID));
+  auto contextBits = this->contextDepth * bitsPerCallSite;
+  if (contextBits < 64) {
+    auto mask = (((uint64_t)1) << contextBits) - 1;
+    calleeContext =
+        beforeBuilder.CreateAnd(calleeContext, ConstantInt::get(int64, mask));
+  }
+  beforeBuilder.CreateStore(calleeContext, context);
+
+  /*
+   * Restore the calling context when the call returns.
+   */
+  IRBuilder<> afterBuilder{ call->getNextNode() };
+  afterBuilder.CreateStore(callerContext, context);
+
+  return;
+}
+
+void LoopProfilesInstrumenter::instrumentLoop(
+    Loop *loop,
+    GlobalVariable *counters,
+    uint64_t loopIndex,
+    GlobalVariable *context,
+    GlobalVariable *contextCounters,
+    uint64_t firstContext,
+    std::vector<uint64_t> &contexts) {
+  auto header = loop->getHeader();
+  auto F = header->getParent();
+  auto M = F->getParent();
+  auto int64 = IntegerType::get(F->getContext(), 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto one = ConstantInt::get(int64, 1);
+  auto readCycleCounter =
+      Intrinsic::getDeclaration(M, Intrinsic::readcyclecounter);
+
+  /*
+   * Allocate the trip counter and the start time of the invocations of the
+   * loop.
+   * They are local to the invocation of the function, so recursive
+   * invocations have their own.
+   */
+  IRBuilder<> entryBuilder{ &*F->getEntryBlock().getFirstInsertionPt() };
+  auto tripCounter = entryBuilder.CreateAlloca(int64);
+  auto startTime = entryBuilder.CreateAlloca(int64);
+
+  /*
+   * Reset the trip counter and the start time when the loop starts.
+   */
+  IRBuilder<> preHeaderBuilder{ loop->getLoopPreheader()->getTerminator() };
+  preHeaderBuilder.CreateStore(zero, tripCounter);
+  preHeaderBuilder.CreateStore(preHeaderBuilder.CreateCall(readCycleCounter),
+                               startTime);
+
+  /*
+   * Count the executions of the header.
+   */
+  IRBuilder<> headerBuilder{ &*header->getFirstInsertionPt() };
+  auto tripCount = headerBuilder.CreateLoad(tripCounter);
+  headerBuilder.CreateStore(headerBuilder.CreateAdd(tripCount, one),
+                            tripCounter);
+
+  /*
+   * Update the counters when the loop exits.
+   * The bucket of a trip count is the number of bits needed to represent it.
+   */
+  auto ctlz = Intrinsic::getDeclaration(M,
+                                        Intrinsic::ctlz,
+                                        ArrayRef<Type *>({ int64 }));
+  auto firstCounter = loopIndex * LoopProfiles::countersPerLoop;
+  auto cyclesCounter = firstCounter + LoopProfiles::cyclesCounter;
+  auto unprofiledContext =
+      contextCounters->getValueType()->getArrayNumElements()
+          / LoopProfiles::countersPerContext
+      - 1;
+  SmallVector<BasicBlock *, 4> exitBlocks;
+  loop->getUniqueExitBlocks(exitBlocks);
+  for (auto exitBlock : exitBlocks) {
+    IRBuilder<> exitBuilder{ &*exitBlock->getFirstInsertionPt() };
+
+    /*
+     * Add the cycles of the invocation.
+     */
+    auto endTime = exitBuilder.CreateCall(readCycleCounter);
+    auto cycles = exitBuilder.CreateSub(endTime,
+                                        exitBuilder.CreateLoad(startTime));
+    auto cyclesCounterPtr = exitBuilder.CreateInBoundsGEP(
+        counters,
+        ArrayRef<Value *>({ zero, ConstantInt::get(int64, cyclesCounter) }));
+    exitBuilder.CreateAtomicRMW(AtomicRMWInst::Add,
+                                cyclesCounterPtr,
+                                cycles,
+                                AtomicOrdering::Monotonic);
+
+    /*
+     * Add the invocation to the bucket of its trip count.
+     */
+    auto finalTripCount = exitBuilder.CreateLoad(tripCounter);
+    auto leadingZeros = exitBuilder.CreateCall(
+        ctlz,
+        ArrayRef<Value *>({ finalTripCount, exitBuilder.getFalse() }));
+    auto bucket = exitBuilder.CreateSub(ConstantInt::get(int64, 64),
+                                        leadingZeros);
+    auto counterIndex =
+        exitBuilder.CreateAdd(ConstantInt::get(int64, firstCounter), bucket);
+    auto counter = exitBuilder.CreateInBoundsGEP(
+        counters,
+        ArrayRef<Value *>({ zero, counterIndex }));
+    exitBuilder.CreateAtomicRMW(AtomicRMWInst::Add,
+                                counter,
+                                one,
+                                AtomicOrdering::Monotonic);
+
+    /*
+     * Add the cycles and the invocation to the calling context of the
+     * invocation.
+     */
+    if (contexts.size() == 0) {
+      continue;
+    }
+    auto currentContext = exitBuilder.CreateLoad(context);
+    Value *contextIndex = ConstantInt::get(int64, unprofiledContext);
+    for (uint64_t i = 0; i < contexts.size(); i++) {
+      auto isContext =
+          exitBuilder.CreateICmpEQ(currentContext,
+                                   ConstantInt::get(int64, contexts[i]));
+      contextIndex =
+          exitBuilder.CreateSelect(isContext,
+                                   ConstantInt::get(int64, firstContext + i),
+                                   contextIndex);
+    }
+    auto firstContextCounter = exitBuilder.CreateMul(
+        contextIndex,
+        ConstantInt::get(int64, LoopProfiles::countersPerContext));
+    auto contextCyclesCounter = exitBuilder.CreateInBoundsGEP(
+        contextCounters,
+        ArrayRef<Value *>(
+            { zero,
+              exitBuilder.CreateAdd(
+                  firstContextCounter,
+                  ConstantInt::get(int64,
+                                   LoopProfiles::contextCyclesCounter)) }));
+    exitBuilder.CreateAtomicRMW(AtomicRMWInst::Add,
+                                contextCyclesCounter,
+                                cycles,
+                                AtomicOrdering::Monotonic);
+    auto contextInvocationsCounter = exitBuilder.CreateInBoundsGEP(
+        contextCounters,
+        ArrayRef<Value *>(
+            { zero,
+              exitBuilder.CreateAdd(
+                  firstContextCounter,
+                  ConstantInt::get(
+                      int64,
+                      LoopProfiles::contextInvocationsCounter)) }));
+    exitBuilder.CreateAtomicRMW(AtomicRMWInst::Add,
+                                contextInvocationsCounter,
+                                one,
+                                AtomicOrdering::Monotonic);
+  }
+
+  return;
+}
+
+Function *LoopProfilesInstrumenter::createStartFunction(
+    Module &M,
+    GlobalVariable *programStart) {
+  auto &context = M.getContext();
+
+  /*
+   * Create the function.
+   */
+  auto startFunction =
+      Function::Create(FunctionType::get(Type::getVoidTy(context), false),
+                       GlobalValue::InternalLinkage,
+                       "noelle.loop_profiles.start",
+                       M);
+  auto entryBB = BasicBlock::Create(context, "entry", startFunction);
+
+  /*
+   * Store the current cycle.
+   */
+  IRBuilder<> builder{ entryBB };
+  auto readCycleCounter =
+      Intrinsic::getDeclaration(&M, Intrinsic::readcyclecounter);
+  builder.CreateStore(builder.CreateCall(readCycleCounter), programStart);
+  builder.CreateRetVoid();
+
+  return startFunction;
+}
+
+Function *LoopProfilesInstrumenter::createDumpFunction(
+    Module &M,
+    GlobalVariable *counters,
+    GlobalVariable *contextCounters,
+    GlobalVariable *programStart,
+    std::vector<std::string> &loopNames,
+    std::vector<std::string> &contextNames) {
+  auto &context = M.getContext();
+  auto voidType = Type::getVoidTy(context);
+  auto int32 = IntegerType::get(context, 32);
+  auto ptrType = PointerType::getUnqual(IntegerType::get(context, 8));
+
+  /*
+   * Fetch the functions of the C library used to dump the profiles.
+   * Files are represented as opaque pointers.
+   */
+  auto fopenFunction = M.getOrInsertFunction(
+      "fopen",
+      FunctionType::get(ptrType, { ptrType, ptrType }, false));
+  auto fprintfFunction = M.getOrInsertFunction(
+      "fprintf",
+      FunctionType::get(int32, { ptrType, ptrType }, true));
+  auto fcloseFunction =
+      M.getOrInsertFunction("fclose",
+                            FunctionType::get(int32, { ptrType }, false));
+
+  /*
+   * Create the function.
+   */
+  auto dumpFunction = Function::Create(FunctionType::get(voidType, false),
+                                       GlobalValue::InternalLinkage,
+                                       "noelle.loop_profiles.dump",
+                                       M);
+  auto entryBB = BasicBlock::Create(context, "entry", dumpFunction);
+  auto programBB = BasicBlock::Create(context, "program", dumpFunction);
+  auto exitBB = BasicBlock::Create(context, "exit", dumpFunction);
+
+  /*
+   * Compute the cycles of the program.
+   */
+  IRBuilder<> builder{ entryBB };
+  auto readCycleCounter =
+      Intrinsic::getDeclaration(&M, Intrinsic::readcyclecounter);
+  auto programCycles =
+      builder.CreateSub(builder.CreateCall(readCycleCounter),
+                        builder.CreateLoad(programStart));
+
+  /*
+   * Open the file.
+   */
+  auto file = builder.CreateCall(
+      fopenFunction,
+      ArrayRef<Value *>(
+          { builder.CreateGlobalStringPtr(LoopProfiles::defaultFileName),
+            builder.CreateGlobalStringPtr("a") }));
+  auto isFileOpen =
+      builder.CreateICmpNE(file, ConstantPointerNull::get(ptrType));
+  builder.CreateCondBr(isFileOpen, programBB, exitBB);
+
+  /*
+   * Dump the cycles of the program as "program CYCLES"
+   */
+  builder.SetInsertPoint(programBB);
+  builder.CreateCall(
+      fprintfFunction,
+      ArrayRef<Value *>({ file,
+                          builder.CreateGlobalStringPtr("program %llu\n"),
+                          programCycles }));
+
+  /*
+   * Dump the counters of the loops as
+   * "COUNTER VALUE HEADER_INDEX FUNCTION_NAME"
+   */
+  this->dumpCounters(builder,
+                     M,
+                     file,
+                     counters,
+                     counters->getValueType()->getArrayNumElements(),
+                     LoopProfiles::countersPerLoop,
+                     loopNames,
+                     "%llu %llu %s\n");
+
+  /*
+   * Dump the counters of the calling contexts as
+   * "context COUNTER VALUE HEADER_INDEX FUNCTION_NAME CALLS", where CALLS
+   * lists the position and the function of each call site of the context.
+   */
+  this->dumpCounters(builder,
+                     M,
+                     file,
+                     contextCounters,
+                     contextNames.size() * LoopProfiles::countersPerContext,
+                     LoopProfiles::countersPerContext,
+                     contextNames,
+                     "context %llu %llu %s\n");
+
+  /*
+   * Close the file.
+   */
+  builder.CreateCall(fcloseFunction, ArrayRef<Value *>({ file }));
+  builder.CreateBr(exitBB);
+
+  builder.SetInsertPoint(exitBB);
+  builder.CreateRetVoid();
+
+  return dumpFunction;
+}
+
+void LoopProfilesInstrumenter::dumpCounters(IRBuilder<> &builder,
+                                            Module &M,
+                                            Value *file,
+                                            GlobalVariable *counters,
+                                            uint64_t numberOfCounters,
+                                            uint64_t countersPerName,
+                                            std::vector<std::string> &names,
+                                            const std::string &format) {
+  if (numberOfCounters == 0) {
+    return;
+  }
+  auto &context = M.getContext();
+  auto int32 = IntegerType::get(context, 32);
+  auto int64 = IntegerType::get(context, 64);
+  auto ptrType = PointerType::getUnqual(IntegerType::get(context, 8));
+  auto fprintfFunction = M.getOrInsertFunction(
+      "fprintf",
+      FunctionType::get(int32, { ptrType, ptrType }, true));
+
+  /*
+   * Create the basic blocks.
+   */
+  auto dumpFunction = builder.GetInsertBlock()->getParent();
+  auto counterBB = BasicBlock::Create(context, "counter", dumpFunction);
+  auto printBB = BasicBlock::Create(context, "print", dumpFunction);
+  auto nextCounterBB = BasicBlock::Create(context, "nextCounter", dumpFunction);
+  auto doneBB = BasicBlock::Create(context, "done", dumpFunction);
+
+  /*
+   * Allocate the names.
+   */
+  std::vector<Constant *> nameConstants;
+  for (auto &name : names) {
+    nameConstants.push_back(
+        cast<Constant>(builder.CreateGlobalStringPtr(name)));
+  }
+  auto namesType = ArrayType::get(ptrType, nameConstants.size());
+  auto namesArray =
+      new GlobalVariable(M,
+                         namesType,
+                         /*isConstant=*/true,
+                         GlobalValue::InternalLinkage,
+                         ConstantArray::get(namesType, nameConstants),
+                         counters->getName() + ".names");
+  auto formatString = builder.CreateGlobalStringPtr(format);
+  auto startBB = builder.GetInsertBlock();
+  builder.CreateBr(counterBB);
+
+  /*
+   * Iterate over the counters.
+   */
+  auto countersPerNameValue = ConstantInt::get(int64, countersPerName);
+  auto zero = ConstantInt::get(int64, 0);
+  builder.SetInsertPoint(counterBB);
+  auto counterIndex = builder.CreatePHI(int64, 2);
+  counterIndex->addIncoming(zero, startBB);
+  auto counter = builder.CreateLoad(
+      builder.CreateInBoundsGEP(counters,
+                                ArrayRef<Value *>({ zero, counterIndex })));
+  builder.CreateCondBr(builder.CreateICmpEQ(counter, zero),
+                       nextCounterBB,
+                       printBB);
+
+  /*
+   * Dump the non-zero counters.
+   */
+  builder.SetInsertPoint(printBB);
+  auto nameIndex = builder.CreateUDiv(counterIndex, countersPerNameValue);
+  auto nameCounter = builder.CreateURem(counterIndex, countersPerNameValue);
+  auto name = builder.CreateLoad(
+      builder.CreateInBoundsGEP(namesArray,
+                                ArrayRef<Value *>({ zero, nameIndex })));
+  builder.CreateCall(
+      fprintfFunction,
+      ArrayRef<Value *>({ file, formatString, nameCounter, counter, name }));
+  builder.CreateBr(nextCounterBB);
+
+  builder.SetInsertPoint(nextCounterBB);
+  auto nextCounterIndex =
+      builder.CreateAdd(counterIndex, ConstantInt::get(int64, 1));
+  counterIndex->addIncoming(nextCounterIndex, nextCounterBB);
+  auto isLastCounter = builder.CreateICmpEQ(
+      nextCounterIndex,
+      ConstantInt::get(int64, numberOfCounters));
+  builder.CreateCondBr(isLastCounter, doneBB, counterBB);
+
+  builder.SetInsertPoint(doneBB);
+
+  return;
+}
+
+void LoopProfilesInstrumenter::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char LoopProfilesInstrumenter::ID = 0;
+static RegisterPass<LoopProfilesInstrumenter> X(
+    "noelle-loop-profiles-instr",
+    "Instrument loops to profile their trip counts and their cycles");
+
+} // namespace llvm::noelle
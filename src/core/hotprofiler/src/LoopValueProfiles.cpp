@@ -0,0 +1,135 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/LoopValueProfiles.hpp"
+
+namespace llvm::noelle {
+
+LoopValueProfiles::LoopValueProfiles(Module &M) {
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+
+    /*
+     * Fetch the instructions that are profiled live-ins.
+     */
+    std::unordered_map<MDNode *, Instruction *> liveInInstructions;
+    for (auto &I : instructions(F)) {
+      if (auto valueID = I.getMetadata(valueMetadataName)) {
+        liveInInstructions[valueID] = &I;
+      }
+    }
+
+    /*
+     * Fetch the profiles of the loops of the function.
+     */
+    for (auto &bb : F) {
+      auto profilesOfLoop = bb.getTerminator()->getMetadata(metadataName);
+      if (profilesOfLoop == nullptr) {
+        continue;
+      }
+      for (auto &operand : profilesOfLoop->operands()) {
+        auto profile = dyn_cast<MDNode>(operand);
+        if (false || (profile == nullptr) || (profile->getNumOperands() < 2)
+            || ((profile->getNumOperands() % 2) != 0)) {
+          continue;
+        }
+
+        /*
+         * Fetch the live-in.
+         */
+        Value *liveIn = nullptr;
+        auto &liveInOperand = profile->getOperand(0);
+        if (auto valueID = dyn_cast<MDNode>(liveInOperand)) {
+          auto found = liveInInstructions.find(valueID);
+          if (found != liveInInstructions.end()) {
+            liveIn = found->second;
+          }
+        } else if (auto position =
+                       mdconst::dyn_extract<ConstantInt>(liveInOperand)) {
+          if (position->getZExtValue() < F.arg_size()) {
+            liveIn = F.arg_begin() + position->getZExtValue();
+          }
+        }
+        if (liveIn == nullptr) {
+          continue;
+        }
+
+        /*
+         * Fetch the values.
+         */
+        auto &valueProfile = this->profiles[{ &bb, liveIn }];
+        valueProfile.invocations =
+            mdconst::extract<ConstantInt>(profile->getOperand(1))
+                ->getZExtValue();
+        for (auto i = 2u; i < profile->getNumOperands(); i += 2) {
+          auto value = mdconst::extract<ConstantInt>(profile->getOperand(i));
+          auto count =
+              mdconst::extract<ConstantInt>(profile->getOperand(i + 1));
+          valueProfile.values.push_back(
+              { value->getSExtValue(), count->getZExtValue() });
+        }
+        std::stable_sort(
+            valueProfile.values.begin(),
+            valueProfile.values.end(),
+            [](const std::pair<int64_t, uint64_t> &a,
+               const std::pair<int64_t, uint64_t> &b) -> bool {
+              return a.second > b.second;
+            });
+      }
+    }
+  }
+
+  return;
+}
+
+bool LoopValueProfiles::isAvailable(void) const {
+  return (this->profiles.size() > 0);
+}
+
+bool LoopValueProfiles::isProfiled(LoopStructure *loop, Value *liveIn) const {
+  auto header = loop->getHeader();
+  return (this->profiles.find({ header, liveIn }) != this->profiles.end());
+}
+
+uint64_t LoopValueProfiles::getInvocations(LoopStructure *loop,
+                                           Value *liveIn) const {
+  auto found = this->profiles.find({ loop->getHeader(), liveIn });
+  if (found == this->profiles.end()) {
+    return 0;
+  }
+
+  return found->second.invocations;
+}
+
+std::vector<std::pair<int64_t, uint64_t>> LoopValueProfiles::getHotValues(
+    LoopStructure *loop,
+    Value *liveIn) const {
+  auto found = this->profiles.find({ loop->getHeader(), liveIn });
+  if (found == this->profiles.end()) {
+    return {};
+  }
+
+  return found->second.values;
+}
+
+} // namespace llvm::noelle
@@ -45,8 +45,6 @@ bool HotProfiler::runOnModule(Module &M) {
 }
 
 void HotProfiler::getAnalysisUsage(AnalysisUsage &AU) const {
-  AU.addRequired<BlockFrequencyInfoWrapperPass>();
-  AU.addRequired<BranchProbabilityInfoWrapperPass>();
   AU.setPreservesAll();
 
   return;
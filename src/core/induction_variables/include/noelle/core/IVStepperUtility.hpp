@@ -100,6 +100,15 @@ public:
 
   Value *generateCodeToComputeTheTripCount(IRBuilder<> &builder);
 
+  /*
+   * @return Value that is true if the step value has the sign assumed to
+   * transform the exit condition of the loop. This is always the case if the
+   * sign is known at compile time.
+   */
+  Value *generateCodeToCheckIfTheStepValueHasTheExpectedSign(
+      IRBuilder<> &builder,
+      Value *stepValue);
+
   /*
    * @return Value of the IV that is used to compare against the exit condition
    * value of the loop
@@ -130,6 +139,7 @@ private:
   bool doesOriginalCmpInstHaveIVAsLeftOperand;
   bool flipOperandsToUseNonStrictPredicate;
   bool flipBrSuccessorsToUseNonStrictPredicate;
+  bool isStepValuePositive;
   bool isWhile;
 };
 
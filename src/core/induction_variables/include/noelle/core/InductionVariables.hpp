@@ -76,6 +76,12 @@ public:
 
   bool isStepValueLoopInvariant(void) const;
 
+  /*
+   * Steps computed at run time might have a sign that is unknown at compile
+   * time.
+   */
+  bool isStepValueSignKnown(void) const;
+
   bool isStepValuePositive(void) const;
 
   const SCEV *getStepSCEV(void) const;
@@ -155,6 +161,13 @@ private:
    */
   bool isComputedStepValueLoopInvariant;
 
+  /*
+   * Whether the sign of the computed step value is known at compile time, and
+   * whether it is positive
+   */
+  bool isComputedStepValueSignKnown;
+  bool isComputedStepValuePositive;
+
   /*
    * Type of the loopEntryPHI which represents the type of the whole IV
    */
@@ -180,6 +193,7 @@ private:
       const SCEV *scev,
       ScalarEvolutionReferentialExpander &referentialExpander,
       LoopStructure *LS);
+  void deriveStepValueSign(ScalarEvolution &SE);
 
   void traverseCycleThroughLoopEntryPHIToGetAllIVInstructions(
       LoopStructure *LS);
@@ -199,6 +213,21 @@ public:
                            LoopEnvironment &loopEnv,
                            Loop &LLVMLoop);
 
+  /*
+   * Identify the induction variables by using @referentialExpander, which must
+   * have been created for the function of @loop with @SE.
+   * The same expander can be shared by the managers of all the loops of the
+   * function while its code does not change.
+   */
+  InductionVariableManager(
+      StayConnectedNestedLoopForestNode *loop,
+      InvariantManager &IVM,
+      ScalarEvolution &SE,
+      SCCDAG &sccdag,
+      LoopEnvironment &loopEnv,
+      Loop &LLVMLoop,
+      ScalarEvolutionReferentialExpander &referentialExpander);
+
   InductionVariableManager() = delete;
 
   /*
@@ -242,6 +271,14 @@ private:
       loopToIVsMap;
   std::unordered_map<LoopStructure *, LoopGoverningIVAttribution *>
       loopToGoverningIVAttrMap;
+
+  void identifyInductionVariables(
+      InvariantManager &IVM,
+      ScalarEvolution &SE,
+      SCCDAG &sccdag,
+      LoopEnvironment &loopEnv,
+      Loop &LLVMLoop,
+      ScalarEvolutionReferentialExpander &referentialExpander);
 };
 
 } // namespace llvm::noelle
@@ -40,7 +40,9 @@ InductionVariable::InductionVariable(
     stepSCEV{ ID.getStep() },
     computationOfStepValue{},
     singleStepValue{ ID.getConstIntStepValue() },
-    isComputedStepValueLoopInvariant{ false } {
+    isComputedStepValueLoopInvariant{ false },
+    isComputedStepValueSignKnown{ false },
+    isComputedStepValuePositive{ false } {
 
   traverseCycleThroughLoopEntryPHIToGetAllIVInstructions(LS);
   traverseConsumersOfIVInstructionsToGetAllDerivedSCEVInstructions(LS, IVM, SE);
@@ -52,6 +54,7 @@ InductionVariable::InductionVariable(
   } else {
     deriveStepValue(LS, SE, referentialExpander);
   }
+  deriveStepValueSign(SE);
 }
 
 InductionVariable::InductionVariable(
@@ -68,7 +71,10 @@ InductionVariable::InductionVariable(
     loopEntryPHIType{ loopEntryPHI->getType() },
     stepSCEV{ nullptr },
     computationOfStepValue{},
-    isComputedStepValueLoopInvariant{ false } {
+    singleStepValue{ nullptr },
+    isComputedStepValueLoopInvariant{ false },
+    isComputedStepValueSignKnown{ false },
+    isComputedStepValuePositive{ false } {
 
   /*
    * Fetch initial value of induction variable
@@ -86,6 +92,7 @@ InductionVariable::InductionVariable(
   traverseConsumersOfIVInstructionsToGetAllDerivedSCEVInstructions(LS, IVM, SE);
   collectValuesInternalAndExternalToLoopAndSCC(LS, loopEnv);
   deriveStepValue(LS, SE, referentialExpander);
+  deriveStepValueSign(SE);
 
   return;
 }
@@ -414,7 +421,7 @@ bool InductionVariable::deriveStepValueFromCompositeSCEV(
   auto references = stepSizeReferenceTree->collectAllReferences();
   // TODO: Only check leaf reference values
   for (auto reference : references) {
-    if (reference->getValue() && LS->isLoopInvariant(reference->getValue())) {
+    if (reference->getValue() && !LS->isLoopInvariant(reference->getValue())) {
       this->isComputedStepValueLoopInvariant = false;
       break;
     }
@@ -442,6 +449,47 @@ bool InductionVariable::deriveStepValueFromCompositeSCEV(
   return true;
 }
 
+void InductionVariable::deriveStepValueSign(ScalarEvolution &SE) {
+
+  /*
+   * Check if the step value is a constant.
+   */
+  auto stepValue = this->singleStepValue;
+  if (auto constantInt = dyn_cast_or_null<ConstantInt>(stepValue)) {
+    this->isComputedStepValueSignKnown = true;
+    this->isComputedStepValuePositive =
+        constantInt->getValue().isStrictlyPositive();
+    return;
+  }
+  if (auto constantFP = dyn_cast_or_null<ConstantFP>(stepValue)) {
+    auto fpValue = constantFP->getValueAPF();
+    this->isComputedStepValueSignKnown = true;
+    this->isComputedStepValuePositive =
+        fpValue.isNonZero() && !fpValue.isNegative();
+    return;
+  }
+
+  /*
+   * The step value is computed at run time.
+   * Its sign can still be proved at compile time (e.g., the step is the zero
+   * extension of a value that cannot be zero).
+   */
+  if (false || (this->stepSCEV == nullptr)
+      || (!this->isComputedStepValueLoopInvariant)
+      || (!this->stepSCEV->getType()->isIntegerTy())) {
+    return;
+  }
+  if (SE.isKnownPositive(this->stepSCEV)) {
+    this->isComputedStepValueSignKnown = true;
+    this->isComputedStepValuePositive = true;
+  } else if (SE.isKnownNegative(this->stepSCEV)) {
+    this->isComputedStepValueSignKnown = true;
+    this->isComputedStepValuePositive = false;
+  }
+
+  return;
+}
+
 InductionVariable::~InductionVariable() {
   BasicBlock *tempBlock = nullptr;
   if (tempBlock) {
@@ -505,32 +553,15 @@ bool InductionVariable::isDerivedFromIVInstructions(Instruction *I) const {
   return derivedSCEVInstructions.find(I) != derivedSCEVInstructions.end();
 }
 
-bool InductionVariable::isStepValuePositive(void) const {
+bool InductionVariable::isStepValueSignKnown(void) const {
+  return this->isComputedStepValueSignKnown;
+}
 
-  /*
-   * Fetch the step value.
-   */
+bool InductionVariable::isStepValuePositive(void) const {
   assert(this->isComputedStepValueLoopInvariant);
-  auto stepValue = this->getSingleComputedStepValue();
+  assert(this->isComputedStepValueSignKnown);
 
-  /*
-   * Check if the step value is positive
-   *
-   * Check if the value is an integer
-   */
-  if (this->loopEntryPHIType->isIntegerTy()) {
-    auto constant = cast<ConstantInt>(stepValue);
-    auto constantValue = constant->getValue();
-    auto isPositive = constantValue.isStrictlyPositive();
-    return isPositive;
-  }
-
-  /*
-   * The value is a floating point one
-   */
-  assert(this->loopEntryPHIType->isFloatingPointTy());
-  auto fpValue = cast<ConstantFP>(stepValue)->getValueAPF();
-  return fpValue.isNonZero() && !fpValue.isNegative();
+  return this->isComputedStepValuePositive;
 }
 
 Type *InductionVariable::getIVType(void) const {
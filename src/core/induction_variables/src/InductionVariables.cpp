@@ -38,20 +38,66 @@ InductionVariableManager::InductionVariableManager(
   assert(this->loop != nullptr);
 
   /*
-   * Fetch the loop to analyze.
+   * Fetch the function that includes the loop.
    */
   auto loopToAnalyze = this->loop->getLoop();
   assert(loopToAnalyze != nullptr);
+  auto &F = *loopToAnalyze->getHeader()->getParent();
 
   /*
-   * Fetch the function that includes the loop.
+   * Identify the induction variables.
    */
-  auto &F = *loopToAnalyze->getHeader()->getParent();
+  ScalarEvolutionReferentialExpander referentialExpander(SE, F);
+  this->identifyInductionVariables(IVM,
+                                   SE,
+                                   sccdag,
+                                   loopEnv,
+                                   LLVMLoop,
+                                   referentialExpander);
+
+  return;
+}
+
+InductionVariableManager::InductionVariableManager(
+    StayConnectedNestedLoopForestNode *loopNode,
+    InvariantManager &IVM,
+    ScalarEvolution &SE,
+    SCCDAG &sccdag,
+    LoopEnvironment &loopEnv,
+    Loop &LLVMLoop,
+    ScalarEvolutionReferentialExpander &referentialExpander)
+  : loop{ loopNode },
+    loopToIVsMap{},
+    loopToGoverningIVAttrMap{} {
+  assert(this->loop != nullptr);
+
+  this->identifyInductionVariables(IVM,
+                                   SE,
+                                   sccdag,
+                                   loopEnv,
+                                   LLVMLoop,
+                                   referentialExpander);
+
+  return;
+}
+
+void InductionVariableManager::identifyInductionVariables(
+    InvariantManager &IVM,
+    ScalarEvolution &SE,
+    SCCDAG &sccdag,
+    LoopEnvironment &loopEnv,
+    Loop &LLVMLoop,
+    ScalarEvolutionReferentialExpander &referentialExpander) {
+
+  /*
+   * Fetch the loop to analyze.
+   */
+  auto loopToAnalyze = this->loop->getLoop();
+  assert(loopToAnalyze != nullptr);
 
   /*
    * Identify the induction variables.
    */
-  ScalarEvolutionReferentialExpander referentialExpander(SE, F);
   for (auto loop : this->loop->getLoops()) {
     this->loopToIVsMap[loop] = std::unordered_set<InductionVariable *>();
 
@@ -38,26 +38,38 @@ LoopGoverningIVAttribution::LoopGoverningIVAttribution(
   assert(l != nullptr);
 
   /*
-   * To understand how to transform the loop governing condition, it is far
-   * simpler to know the sign of the step size at compile time. Extra overhead
-   * is necessary if this is only known at runtime, and that enhancement has yet
-   * to be made
+   * The step of the IV must not change within the loop.
+   * It can be either a constant or an integer computed at run time before
+   * entering the loop.
    */
-  if (!iv.getSingleComputedStepValue()
-      || !(isa<ConstantInt>(iv.getSingleComputedStepValue())
-           || isa<ConstantFP>(iv.getSingleComputedStepValue()))) {
-    return;
+  auto stepValue = iv.getSingleComputedStepValue();
+  auto isStepValueConstant =
+      (stepValue != nullptr)
+      && (isa<ConstantInt>(stepValue) || isa<ConstantFP>(stepValue));
+  if (!isStepValueConstant) {
+    if (false || (!iv.isStepValueLoopInvariant())
+        || ((stepValue == nullptr)
+            && (iv.getComputationOfStepValue().size() == 0))) {
+      return;
+    }
+    auto stepSCEV = iv.getStepSCEV();
+    if (false || (stepSCEV == nullptr)
+        || (!stepSCEV->getType()->isIntegerTy())) {
+      return;
+    }
   }
 
   auto headerPHI = iv.getLoopEntryPHI();
   auto ivInstructions = iv.getAllInstructions();
 
   /*
-   * This attribution only understands integer and floating point typed
-   * induction variables
+   * This attribution only understands integer, pointer, and floating point
+   * typed induction variables.
+   * Pointers are stepped by a number of bytes.
    */
-  if (!headerPHI->getType()->isIntegerTy()
-      && !headerPHI->getType()->isFloatingPointTy()) {
+  if (true && (!headerPHI->getType()->isIntegerTy())
+      && (!headerPHI->getType()->isPointerTy())
+      && (!headerPHI->getType()->isFloatingPointTy())) {
     return;
   }
 
@@ -151,6 +163,23 @@ LoopGoverningIVAttribution::LoopGoverningIVAttribution(
    * Find the last value and the updated value of the IV.
    */
   this->headerCmp = cast<CmpInst>(headerCondition);
+
+  /*
+   * To understand how to transform the loop governing condition, we need to
+   * know the sign of the step at compile time.
+   * If the step is computed at run time and its sign cannot be proved, then the
+   * condition must be a relational one: the loop can exit only by moving the IV
+   * towards the exit condition value, which implies the sign of the step. If
+   * the step turns out to have the other sign, then the loop executes either no
+   * iteration or forever.
+   */
+  if (true && (!iv.isStepValueSignKnown()) && this->headerCmp->isEquality()) {
+    return;
+  }
+
+  /*
+   * Find the compared values.
+   */
   auto opL = headerCmp->getOperand(0), opR = headerCmp->getOperand(1);
   auto isOpLHSLoopEntryPHI =
       isa<Instruction>(opL) && headerPHI == cast<Instruction>(opL);
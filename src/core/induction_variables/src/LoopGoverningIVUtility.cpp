@@ -32,6 +32,7 @@ LoopGoverningIVUtility::LoopGoverningIVUtility(
     conditionValueOrderedDerivation{},
     flipOperandsToUseNonStrictPredicate{ false },
     flipBrSuccessorsToUseNonStrictPredicate{ false },
+    isStepValuePositive{ false },
     isWhile{ false } {
 
   /*
@@ -61,14 +62,7 @@ LoopGoverningIVUtility::LoopGoverningIVUtility(
       continue;
     conditionValueOrderedDerivation.push_back(&I);
   }
-  assert(IV.getSingleComputedStepValue()
-         && (isa<ConstantInt>(IV.getSingleComputedStepValue())
-             || isa<ConstantFP>(IV.getSingleComputedStepValue())));
-
-  /*
-   * Fetch information about the step value for the IV.
-   */
-  auto isStepValuePositive = IV.isStepValuePositive();
+  assert(IV.isStepValueLoopInvariant());
 
   /*
    * Fetch information about the predicate that when true the execution needs to
@@ -86,6 +80,26 @@ LoopGoverningIVUtility::LoopGoverningIVUtility(
   this->flipBrSuccessorsToUseNonStrictPredicate = !conditionExitsOnTrue;
   this->nonStrictPredicate = exitPredicate;
   this->strictPredicate = exitPredicate;
+
+  /*
+   * Fetch information about the step value for the IV.
+   * If its sign is unknown at compile time, then the exit condition is a
+   * relational one and it implies the sign (see LoopGoverningIVAttribution).
+   */
+  if (IV.isStepValueSignKnown()) {
+    this->isStepValuePositive = IV.isStepValuePositive();
+  } else {
+    this->isStepValuePositive = false || (exitPredicate == CmpInst::ICMP_SGT)
+                                || (exitPredicate == CmpInst::ICMP_SGE)
+                                || (exitPredicate == CmpInst::ICMP_UGT)
+                                || (exitPredicate == CmpInst::ICMP_UGE);
+  }
+  auto isStepValuePositive = this->isStepValuePositive;
+
+  /*
+   * Pointers are compared as unsigned integers.
+   */
+  auto isPointer = IV.getIVType()->isPointerTy();
   switch (exitPredicate) {
     case CmpInst::Predicate::ICMP_NE:
 
@@ -98,11 +112,15 @@ LoopGoverningIVUtility::LoopGoverningIVUtility(
       // This predicate is strict and needs to be extended to LTE/GTE to catch
       // jumping past the exiting value
       if (isStepValuePositive) {
-        this->nonStrictPredicate = CmpInst::Predicate::ICMP_SGE;
-        this->strictPredicate = CmpInst::Predicate::ICMP_SGT;
+        this->nonStrictPredicate = isPointer ? CmpInst::Predicate::ICMP_UGE
+                                             : CmpInst::Predicate::ICMP_SGE;
+        this->strictPredicate = isPointer ? CmpInst::Predicate::ICMP_UGT
+                                          : CmpInst::Predicate::ICMP_SGT;
       } else {
-        this->nonStrictPredicate = CmpInst::Predicate::ICMP_SLE;
-        this->strictPredicate = CmpInst::Predicate::ICMP_SLT;
+        this->nonStrictPredicate = isPointer ? CmpInst::Predicate::ICMP_ULE
+                                             : CmpInst::Predicate::ICMP_SLE;
+        this->strictPredicate = isPointer ? CmpInst::Predicate::ICMP_ULT
+                                          : CmpInst::Predicate::ICMP_SLT;
       }
       break;
     case CmpInst::Predicate::ICMP_SLE:
@@ -265,33 +283,69 @@ Value *LoopGoverningIVUtility::generateCodeToComputeTheTripCount(
 
   /*
    * Fetch the start and last value.
+   * Pointers are compared as addresses.
    */
-  auto IV = this->attribution.getInductionVariable();
+  auto &IV = this->attribution.getInductionVariable();
+  assert(!IV.getIVType()->isFloatingPointTy());
+  auto stepValue = IV.getSingleComputedStepValue();
   auto startValue = IV.getStartValue();
   auto lastValue = this->attribution.getExitConditionValue();
+  if (IV.getIVType()->isPointerTy()) {
+    startValue = builder.CreatePtrToInt(startValue, stepValue->getType());
+    lastValue = builder.CreatePtrToInt(lastValue, stepValue->getType());
+  }
 
   /*
-   * Compute the delta.
+   * Compute the delta and the magnitude of the step.
    */
   Value *delta = nullptr;
-  if (IV.isStepValuePositive()) {
-    delta = IV.getIVType()->isIntegerTy()
-                ? builder.CreateSub(lastValue, startValue)
-                : builder.CreateFSub(lastValue, startValue);
+  auto stepMagnitude = stepValue;
+  if (this->isStepValuePositive) {
+    delta = builder.CreateSub(lastValue, startValue);
   } else {
-    delta = IV.getIVType()->isIntegerTy()
-                ? builder.CreateSub(startValue, lastValue)
-                : builder.CreateFSub(startValue, lastValue);
+    delta = builder.CreateSub(startValue, lastValue);
+    stepMagnitude = builder.CreateNeg(stepValue);
   }
 
   /*
    * Compute the number of steps to reach the delta.
+   * The last step can go past the exit condition value, so the division rounds
+   * up. Moreover, the iteration with the exit condition value is executed if
+   * the loop exits only after passing it (e.g., i <= N).
    */
-  auto tripCount = builder.CreateUDiv(delta, IV.getSingleComputedStepValue());
+  auto exitsAfterPassingTheValue =
+      false || (this->nonStrictPredicate == CmpInst::ICMP_SGT)
+      || (this->nonStrictPredicate == CmpInst::ICMP_UGT)
+      || (this->nonStrictPredicate == CmpInst::ICMP_SLT)
+      || (this->nonStrictPredicate == CmpInst::ICMP_ULT);
+  auto roundingValue =
+      exitsAfterPassingTheValue
+          ? stepMagnitude
+          : builder.CreateSub(stepMagnitude,
+                              ConstantInt::get(stepMagnitude->getType(), 1));
+  auto roundedDelta = builder.CreateAdd(delta, roundingValue);
+  auto tripCount = builder.CreateUDiv(roundedDelta, stepMagnitude);
 
   return tripCount;
 }
 
+Value *LoopGoverningIVUtility::
+    generateCodeToCheckIfTheStepValueHasTheExpectedSign(IRBuilder<> &builder,
+                                                        Value *stepValue) {
+
+  /*
+   * Compare the step value against zero.
+   */
+  auto zero = Constant::getNullValue(stepValue->getType());
+  if (stepValue->getType()->isFloatingPointTy()) {
+    return this->isStepValuePositive ? builder.CreateFCmpOGT(stepValue, zero)
+                                     : builder.CreateFCmpOLT(stepValue, zero);
+  }
+
+  return this->isStepValuePositive ? builder.CreateICmpSGT(stepValue, zero)
+                                   : builder.CreateICmpSLT(stepValue, zero);
+}
+
 Value *LoopGoverningIVUtility::
     generateCodeToComputePreviousValueUsedToCompareAgainstExitConditionValue(
         IRBuilder<> &builder,
@@ -334,10 +388,19 @@ Value *LoopGoverningIVUtility::generateCodeToComputeValueToUseForAnIterationAgo(
      * Hence, we must generate code to compute the value of the previous
      * iteration.
      */
-    auto prevIterationValue =
-        IV.getIVType()->isIntegerTy()
-            ? builder.CreateSub(currentIterationValue, stepValue)
-            : builder.CreateFSub(currentIterationValue, stepValue);
+    Value *prevIterationValue = nullptr;
+    if (IV.getIVType()->isPointerTy()) {
+      auto currentAddress =
+          builder.CreatePtrToInt(currentIterationValue, stepValue->getType());
+      prevIterationValue =
+          builder.CreateIntToPtr(builder.CreateSub(currentAddress, stepValue),
+                                 IV.getIVType());
+    } else {
+      prevIterationValue =
+          IV.getIVType()->isIntegerTy()
+              ? builder.CreateSub(currentIterationValue, stepValue)
+              : builder.CreateFSub(currentIterationValue, stepValue);
+    }
 
     return prevIterationValue;
   }
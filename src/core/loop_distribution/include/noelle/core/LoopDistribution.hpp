@@ -35,6 +35,12 @@ public:
    */
   LoopDistribution();
 
+  /*
+   * @forwardDataDependences: allow the values the remaining loop produces for
+   * the instructions pulled out to be forwarded through temporary arrays.
+   */
+  LoopDistribution(bool forwardDataDependences);
+
   bool splitLoop(LoopDependenceInfo const &LDI,
                  SCC *SCCToPullOut,
                  std::set<Instruction *> &instructionsRemoved,
@@ -49,6 +55,7 @@ private:
   /*
    * Fields
    */
+  bool forwardDataDependences;
 
   /*
    * Methods
@@ -69,11 +76,20 @@ private:
   bool splitWouldRequireForwardingDataDependencies(
       LoopDependenceInfo const &LDI,
       std::set<Instruction *> const &instsToPullOut,
-      std::set<Instruction *> const &instsToClone);
+      std::set<Instruction *> const &instsToClone,
+      std::set<Instruction *> &valuesToForward);
+
+  bool canBeForwarded(Instruction *producer,
+                      Instruction *consumer,
+                      DominatorTree &DT);
+
+  Value *generateCodeToComputeTheTripCount(IRBuilder<> &builder,
+                                           LoopDependenceInfo const &LDI);
 
   void doSplit(LoopDependenceInfo const &LDI,
                std::set<Instruction *> const &instsToPullOut,
                std::set<Instruction *> const &instsToClone,
+               std::set<Instruction *> const &valuesToForward,
                std::set<Instruction *> &instructionsRemoved,
                std::set<Instruction *> &instructionsAdded);
 };
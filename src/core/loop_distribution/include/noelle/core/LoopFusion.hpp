@@ -0,0 +1,75 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/LoopDependenceInfo.hpp"
+#include "noelle/core/PDG.hpp"
+
+namespace llvm::noelle {
+
+class LoopFusion {
+public:
+  /*
+   * Methods
+   */
+  LoopFusion();
+
+  /*
+   * Fuse @secondLoop into @firstLoop.
+   * The second loop must start right after the first one ends, and the two
+   * loops must execute the same number of iterations. Every iteration of the
+   * fused loop executes the body of the first loop followed by the body of
+   * the second one.
+   */
+  bool fuseLoops(LoopDependenceInfo const &firstLoop,
+                 LoopDependenceInfo const &secondLoop,
+                 PDG *pdg,
+                 DominatorTree &DT,
+                 LoopInfo &LI,
+                 ScalarEvolution &SE);
+
+private:
+  /*
+   * Methods
+   */
+  bool areLoopsAdjacent(Loop *firstLoop, Loop *secondLoop);
+
+  bool haveTheSameIterationSpace(Loop *firstLoop,
+                                 Loop *secondLoop,
+                                 ScalarEvolution &SE);
+
+  bool isThereAFusionPreventingDependence(Loop *firstLoop,
+                                          Loop *secondLoop,
+                                          PDG *pdg,
+                                          ScalarEvolution &SE);
+
+  bool isDependenceWithinTheSameIteration(Instruction *firstAccess,
+                                          Loop *firstLoop,
+                                          Instruction *secondAccess,
+                                          Loop *secondLoop,
+                                          ScalarEvolution &SE);
+
+  void doFusion(Loop *firstLoop, Loop *secondLoop);
+};
+
+} // namespace llvm::noelle
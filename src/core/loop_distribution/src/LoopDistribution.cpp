@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/Utils.hpp"
+#include "noelle/core/IVStepperUtility.hpp"
 #include "noelle/core/LoopDistribution.hpp"
 
 namespace llvm::noelle {
@@ -200,22 +201,37 @@ bool LoopDistribution::splitLoop(LoopDependenceInfo const &LDI,
 
   /*
    * Require that there are no data dependencies between instsToPullOut and the
-   * rest of the loop
+   * rest of the loop other than the ones we can forward
    */
+  std::set<Instruction *> valuesToForward{};
   if (this->splitWouldRequireForwardingDataDependencies(LDI,
                                                         instsToPullOut,
-                                                        instsToClone)) {
+                                                        instsToClone,
+                                                        valuesToForward)) {
     // errs() << "LoopDistribution: Abort: Distribution would require forwarding
     // data dependencies\n";
     return false;
   }
 
+  /*
+   * Forwarding values requires a preheader to allocate the temporary arrays
+   * and a trip count to size them
+   */
+  if (valuesToForward.size() > 0) {
+    if (false || (loopStructure->getPreHeader() == nullptr)
+        || (true && (!LDI.doesHaveCompileTimeKnownTripCount())
+            && (LDI.getLoopGoverningIVAttribution() == nullptr))) {
+      return false;
+    }
+  }
+
   /*
    * Splitting the loop is now safe
    */
   this->doSplit(LDI,
                 instsToPullOut,
                 instsToClone,
+                valuesToForward,
                 instructionsRemoved,
                 instructionsAdded);
   return true;
@@ -300,11 +316,19 @@ bool LoopDistribution::splitWouldBeTrivial(
 bool LoopDistribution::splitWouldRequireForwardingDataDependencies(
     LoopDependenceInfo const &LDI,
     std::set<Instruction *> const &instsToPullOut,
-    std::set<Instruction *> const &instsToClone) {
-  auto BBs = LDI.getLoopStructure()->getBasicBlocks();
-  auto fromFn = [&BBs, &instsToPullOut, &instsToClone](
-                    Value *from,
-                    DGEdge<Value> *dependence) -> bool {
+    std::set<Instruction *> const &instsToClone,
+    std::set<Instruction *> &valuesToForward) {
+  auto loopStructure = LDI.getLoopStructure();
+  auto BBs = loopStructure->getBasicBlocks();
+  DominatorTree DT(*loopStructure->getFunction());
+  Instruction *consumer = nullptr;
+  auto fromFn = [this,
+                 &BBs,
+                 &instsToPullOut,
+                 &instsToClone,
+                 &valuesToForward,
+                 &DT,
+                 &consumer](Value *from, DGEdge<Value> *dependence) -> bool {
     if (!isa<Instruction>(from)) {
       return false;
     }
@@ -323,6 +347,18 @@ bool LoopDistribution::splitWouldRequireForwardingDataDependencies(
        * Only dependencies inside the loop should cause us to abort
        */
       if (std::find(BBs.begin(), BBs.end(), bb) != BBs.end()) {
+
+        /*
+         * The remaining loop runs first, so the values it produces can be
+         * forwarded to the new loop.
+         */
+        if (true && this->forwardDataDependences
+            && (!dependence->isMemoryDependence())
+            && this->canBeForwarded(i, consumer, DT)) {
+          valuesToForward.insert(i);
+          return false;
+        }
+
         // errs() << "LoopDistribution: Instruction "
         //  << *i << " is the source of a data dependency that would need to be
         //  forwarded\n";
@@ -360,6 +396,7 @@ bool LoopDistribution::splitWouldRequireForwardingDataDependencies(
   };
   auto pdg = LDI.getLoopDG();
   for (auto inst : instsToPullOut) {
+    consumer = inst;
     bool isSourceOfExternalDataDependency =
         pdg->iterateOverDependencesFrom(inst,
                                         false, // Control
@@ -386,16 +423,179 @@ bool LoopDistribution::splitWouldRequireForwardingDataDependencies(
   return false;
 }
 
-void LoopDistribution::doSplit(LoopDependenceInfo const &LDI,
-                               std::set<Instruction *> const &instsToPullOut,
-                               std::set<Instruction *> const &instsToClone,
-                               std::set<Instruction *> &instructionsRemoved,
-                               std::set<Instruction *> &instructionsAdded) {
+/*
+ * Checks if the value @producer generates in an iteration can be stored in a
+ * temporary array and loaded back by @consumer in the same iteration of the
+ * new loop
+ */
+bool LoopDistribution::canBeForwarded(Instruction *producer,
+                                      Instruction *consumer,
+                                      DominatorTree &DT) {
+
+  /*
+   * Only values of the current iteration can be forwarded. PHIs consume values
+   * of the previous one.
+   */
+  if (isa<PHINode>(consumer)) {
+    return false;
+  }
+
+  /*
+   * The consumer must use the value the producer generated in its iteration.
+   */
+  if (!DT.dominates(producer, consumer)) {
+    return false;
+  }
+
+  /*
+   * The value must be storable in memory.
+   */
+  auto producerType = producer->getType();
+  if (false || producerType->isVoidTy() || producerType->isTokenTy()
+      || (!producerType->isSized())) {
+    return false;
+  }
+
+  return true;
+}
+
+/*
+ * Generate the code that computes the number of iterations the loop will
+ * execute. Return nullptr if that number cannot be computed before the loop
+ * starts.
+ */
+Value *LoopDistribution::generateCodeToComputeTheTripCount(
+    IRBuilder<> &builder,
+    LoopDependenceInfo const &LDI) {
+  auto int64 = builder.getInt64Ty();
+
+  /*
+   * Check if the trip count is known at compile time.
+   */
+  if (LDI.doesHaveCompileTimeKnownTripCount()) {
+    return ConstantInt::get(int64, LDI.getCompileTimeTripCount());
+  }
+
+  /*
+   * Compute the trip count through the loop governing IV.
+   */
+  auto GIV = LDI.getLoopGoverningIVAttribution();
+  if (GIV == nullptr) {
+    return nullptr;
+  }
+  auto &IV = GIV->getInductionVariable();
+  auto IVM = LDI.getInductionVariableManager();
+  LoopGoverningIVUtility ivUtility(LDI.getLoopStructure(), *IVM, *GIV);
+  auto tripCount = builder.CreateZExtOrTrunc(
+      ivUtility.generateCodeToComputeTheTripCount(builder),
+      int64);
+
+  /*
+   * A loop that does not execute its first iteration has a trip count of 0.
+   */
+  auto firstCheck =
+      GIV->getHeaderCompareInstructionToComputeExitCondition()->clone();
+  builder.Insert(firstCheck);
+  firstCheck->replaceUsesOfWith(IV.getLoopEntryPHI(), IV.getStartValue());
+  auto isTheFirstIterationExecuted =
+      GIV->valueOfExitConditionToJumpToTheLoopBody()
+          ? firstCheck
+          : builder.CreateNot(firstCheck);
+
+  return builder.CreateSelect(isTheFirstIterationExecuted,
+                              tripCount,
+                              ConstantInt::get(int64, 0));
+}
+
+void LoopDistribution::doSplit(
+    LoopDependenceInfo const &LDI,
+    std::set<Instruction *> const &instsToPullOut,
+    std::set<Instruction *> const &originalInstsToClone,
+    std::set<Instruction *> const &valuesToForward,
+    std::set<Instruction *> &instructionsRemoved,
+    std::set<Instruction *> &instructionsAdded) {
   auto loopStructure = LDI.getLoopStructure();
-  auto &cxt = loopStructure->getFunction()->getContext();
+  auto loopFunction = loopStructure->getFunction();
+  auto &cxt = loopFunction->getContext();
+  auto instsToClone = originalInstsToClone;
   // errs() << "LoopDistribution: About to do split of " <<
   // *loopStructure->getFunction() << "\n";
 
+  /*
+   * Forward the values through temporary arrays indexed by the iteration of
+   * the loop. The iteration is counted by a new PHI that is cloned in the new
+   * loop, so both loops index the arrays the same way.
+   */
+  PHINode *iteration = nullptr;
+  std::unordered_map<Instruction *, Value *> forwardingArrays{};
+  std::vector<Value *> allocatedArrays{};
+  if (valuesToForward.size() > 0) {
+    auto int64 = IntegerType::get(cxt, 64);
+    auto int8Ptr = PointerType::getUnqual(IntegerType::get(cxt, 8));
+    auto &DL = loopFunction->getParent()->getDataLayout();
+    auto header = loopStructure->getHeader();
+    auto preHeader = loopStructure->getPreHeader();
+    IRBuilder<> preHeaderBuilder{ preHeader->getTerminator() };
+
+    /*
+     * Count the iterations.
+     */
+    iteration = PHINode::Create(int64, 0, "", &*header->begin());
+    IRBuilder<> headerBuilder{ header->getFirstNonPHI() };
+    auto nextIteration =
+        cast<Instruction>(headerBuilder.CreateAdd(iteration,
+                                                  ConstantInt::get(int64, 1)));
+    for (auto predecessor : predecessors(header)) {
+      if (loopStructure->isIncluded(predecessor)) {
+        iteration->addIncoming(nextIteration, predecessor);
+      } else {
+        iteration->addIncoming(ConstantInt::get(int64, 0), predecessor);
+      }
+    }
+    instsToClone.insert(iteration);
+    instsToClone.insert(nextIteration);
+    instructionsAdded.insert(iteration);
+    instructionsAdded.insert(nextIteration);
+
+    /*
+     * Allocate the arrays in the preheader.
+     * They have an extra element for the last execution of the header.
+     */
+    auto tripCount =
+        this->generateCodeToComputeTheTripCount(preHeaderBuilder, LDI);
+    assert(tripCount != nullptr);
+    auto elements =
+        preHeaderBuilder.CreateAdd(tripCount, ConstantInt::get(int64, 1));
+    auto mallocFunction = loopFunction->getParent()->getOrInsertFunction(
+        "malloc",
+        FunctionType::get(int8Ptr, { int64 }, false));
+    for (auto producer : valuesToForward) {
+      auto producerType = producer->getType();
+      auto bytes = preHeaderBuilder.CreateMul(
+          elements,
+          ConstantInt::get(int64, DL.getTypeAllocSize(producerType)));
+      auto memory = preHeaderBuilder.CreateCall(mallocFunction, { bytes });
+      auto array = preHeaderBuilder.CreateBitCast(
+          memory,
+          PointerType::getUnqual(producerType));
+      forwardingArrays[producer] = array;
+      allocatedArrays.push_back(memory);
+
+      /*
+       * Store the value in the remaining loop.
+       */
+      auto insertPoint = isa<PHINode>(producer)
+                             ? producer->getParent()->getFirstNonPHI()
+                             : producer->getNextNode();
+      IRBuilder<> producerBuilder{ insertPoint };
+      auto element = producerBuilder.CreateInBoundsGEP(producerType,
+                                                       array,
+                                                       iteration);
+      auto store = producerBuilder.CreateStore(producer, element);
+      instructionsAdded.insert(store);
+    }
+  }
+
   /*
    * Duplicate the basic blocks of the loop and insert clones of all necessary
    *   non-branch instructions in order
@@ -530,6 +730,34 @@ void LoopDistribution::doSplit(LoopDependenceInfo const &LDI,
   // errs() << "LoopDistribution: Finished fixing instruction dependencies in
   // the new loop\n";
 
+  /*
+   * Load the forwarded values in the new loop
+   */
+  for (auto inst : instsToPullOut) {
+    if (instsToClone.find(inst) != instsToClone.end()) {
+      continue;
+    }
+    auto cloneInst = instMap.at(inst);
+    for (unsigned idx = 0; idx < cloneInst->getNumOperands(); idx++) {
+      auto producer = dyn_cast<Instruction>(cloneInst->getOperand(idx));
+      if (producer == nullptr) {
+        continue;
+      }
+      auto it = forwardingArrays.find(producer);
+      if (it == forwardingArrays.end()) {
+        continue;
+      }
+      IRBuilder<> consumerBuilder{ cloneInst };
+      auto element =
+          consumerBuilder.CreateInBoundsGEP(producer->getType(),
+                                            it->second,
+                                            instMap.at(iteration));
+      auto load = consumerBuilder.CreateLoad(producer->getType(), element);
+      instructionsAdded.insert(load);
+      cloneInst->setOperand(idx, load);
+    }
+  }
+
   /*
    * Fix data flows for all instructions in exit blocks (only need to fix phi
    * nodes)
@@ -579,6 +807,24 @@ void LoopDistribution::doSplit(LoopDependenceInfo const &LDI,
   // errs() << "LoopDistribution: Finished fixing instruction dependencies in
   // exit blocks\n";
 
+  /*
+   * Free the temporary arrays once the new loop exits
+   */
+  if (allocatedArrays.size() > 0) {
+    auto freeFunction = loopFunction->getParent()->getOrInsertFunction(
+        "free",
+        FunctionType::get(Type::getVoidTy(cxt),
+                          { PointerType::getUnqual(IntegerType::get(cxt, 8)) },
+                          false));
+    for (auto loopExitBlock : loopStructure->getLoopExitBasicBlocks()) {
+      IRBuilder<> exitBuilder{ &*loopExitBlock->getFirstInsertionPt() };
+      for (auto memory : allocatedArrays) {
+        auto call = exitBuilder.CreateCall(freeFunction, { memory });
+        instructionsAdded.insert(call);
+      }
+    }
+  }
+
   /*
    * Remove instructions from the original loop if they were not cloned and are
    * not branches. Also replace all uses of an instruction with its
@@ -0,0 +1,419 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/LoopFusion.hpp"
+
+namespace llvm::noelle {
+
+LoopFusion::LoopFusion() {
+  return;
+}
+
+bool LoopFusion::fuseLoops(LoopDependenceInfo const &firstLoop,
+                           LoopDependenceInfo const &secondLoop,
+                           PDG *pdg,
+                           DominatorTree &DT,
+                           LoopInfo &LI,
+                           ScalarEvolution &SE) {
+  assert(pdg != nullptr);
+
+  /*
+   * Fetch the LLVM loops.
+   */
+  auto firstLS = firstLoop.getLoopStructure();
+  auto secondLS = secondLoop.getLoopStructure();
+  if (firstLS->getFunction() != secondLS->getFunction()) {
+    return false;
+  }
+  auto l1 = LI.getLoopFor(firstLS->getHeader());
+  auto l2 = LI.getLoopFor(secondLS->getHeader());
+  if (false || (l1 == nullptr) || (l2 == nullptr) || (l1 == l2)
+      || (l1->getParentLoop() != l2->getParentLoop())) {
+    return false;
+  }
+
+  /*
+   * The fusion requires both loops to be in their canonical form, so the
+   * values they produce reach the rest of the function only through the PHIs
+   * of their exits.
+   */
+  for (auto l : { l1, l2 }) {
+    if (false || (!l->isLoopSimplifyForm())
+        || (!l->isRecursivelyLCSSAForm(DT, LI))
+        || (l->getExitingBlock() != l->getHeader())
+        || (l->getExitBlock() == nullptr)
+        || (l->getLoopLatch() == l->getHeader())) {
+      return false;
+    }
+  }
+
+  /*
+   * Check that the second loop starts right after the first one ends.
+   */
+  if (!this->areLoopsAdjacent(l1, l2)) {
+    return false;
+  }
+
+  /*
+   * Check that the loops execute the same number of iterations.
+   */
+  if (!this->haveTheSameIterationSpace(l1, l2, SE)) {
+    return false;
+  }
+
+  /*
+   * Check that every iteration of the second loop depends only on the same
+   * iteration of the first loop.
+   */
+  if (this->isThereAFusionPreventingDependence(l1, l2, pdg, SE)) {
+    return false;
+  }
+
+  /*
+   * Fuse the loops.
+   * The information the scalar evolution has about them is going to be stale.
+   */
+  SE.forgetLoop(l1);
+  SE.forgetLoop(l2);
+  this->doFusion(l1, l2);
+
+  return true;
+}
+
+bool LoopFusion::areLoopsAdjacent(Loop *firstLoop, Loop *secondLoop) {
+
+  /*
+   * The exit of the first loop must be the pre-header of the second loop, and
+   * it must only forward the values the first loop produces.
+   */
+  auto firstExit = firstLoop->getExitBlock();
+  if (firstExit != secondLoop->getLoopPreheader()) {
+    return false;
+  }
+  for (auto &I : *firstExit) {
+    if (false || isa<PHINode>(&I) || I.isTerminator()) {
+      continue;
+    }
+    return false;
+  }
+
+  /*
+   * The values produced by the first loop can be used only after the second
+   * loop ends.
+   */
+  auto secondExit = secondLoop->getExitBlock();
+  for (auto &phi : firstExit->phis()) {
+    for (auto user : phi.users()) {
+      auto userInst = cast<Instruction>(user);
+      if (false || secondLoop->contains(userInst)
+          || (true && isa<PHINode>(userInst)
+              && (userInst->getParent() == secondExit))) {
+        return false;
+      }
+    }
+  }
+
+  /*
+   * The header of the second loop must only include the values the second
+   * loop carries between iterations and code free of side effects.
+   * The values it carries must be available before the first loop starts.
+   */
+  auto secondHeader = secondLoop->getHeader();
+  for (auto &I : *secondHeader) {
+    if (I.isTerminator()) {
+      continue;
+    }
+    if (auto phi = dyn_cast<PHINode>(&I)) {
+      auto initialValue =
+          dyn_cast<Instruction>(phi->getIncomingValueForBlock(firstExit));
+      if (true && (initialValue != nullptr)
+          && (false || firstLoop->contains(initialValue)
+              || (initialValue->getParent() == firstExit))) {
+        return false;
+      }
+      continue;
+    }
+    if (false || I.mayHaveSideEffects() || I.mayReadFromMemory()
+        || isa<AllocaInst>(&I)) {
+      return false;
+    }
+  }
+
+  /*
+   * The body of the second loop must be reachable only from its header,
+   * which will be removed.
+   */
+  auto secondHeaderBr = dyn_cast<BranchInst>(secondHeader->getTerminator());
+  if (false || (secondHeaderBr == nullptr)
+      || (!secondHeaderBr->isConditional())) {
+    return false;
+  }
+  auto secondBody = secondHeaderBr->getSuccessor(0);
+  if (secondBody == secondExit) {
+    secondBody = secondHeaderBr->getSuccessor(1);
+  }
+  if (false || (secondBody->getSinglePredecessor() != secondHeader)
+      || isa<PHINode>(&*secondBody->begin())) {
+    return false;
+  }
+
+  /*
+   * The values produced by the second loop must be either the ones it
+   * carries between iterations or values computed before both loops.
+   */
+  for (auto &phi : secondExit->phis()) {
+    auto exitValue =
+        dyn_cast<Instruction>(phi.getIncomingValueForBlock(secondHeader));
+    if (exitValue == nullptr) {
+      continue;
+    }
+    if (true && isa<PHINode>(exitValue)
+        && (exitValue->getParent() == secondHeader)) {
+      continue;
+    }
+    if (false || firstLoop->contains(exitValue)
+        || secondLoop->contains(exitValue)
+        || (exitValue->getParent() == firstExit)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool LoopFusion::haveTheSameIterationSpace(Loop *firstLoop,
+                                           Loop *secondLoop,
+                                           ScalarEvolution &SE) {
+
+  /*
+   * Both loops leave from their headers. Hence, the number of times they take
+   * their backedges is the number of times they execute their bodies.
+   * SCEVs are uniqued, so identical expressions are the same object.
+   */
+  auto firstTripCount = SE.getBackedgeTakenCount(firstLoop);
+  auto secondTripCount = SE.getBackedgeTakenCount(secondLoop);
+  if (false || isa<SCEVCouldNotCompute>(firstTripCount)
+      || (firstTripCount != secondTripCount)) {
+    return false;
+  }
+
+  return true;
+}
+
+bool LoopFusion::isThereAFusionPreventingDependence(Loop *firstLoop,
+                                                    Loop *secondLoop,
+                                                    PDG *pdg,
+                                                    ScalarEvolution &SE) {
+
+  /*
+   * Values computed by the first loop reach the second one only through the
+   * PHIs of the exit of the first loop, which have been checked already.
+   * Hence, only dependences through memory can prevent the fusion.
+   */
+  for (auto bb : firstLoop->blocks()) {
+    for (auto &I : *bb) {
+      if (!I.mayReadOrWriteMemory()) {
+        continue;
+      }
+      auto isFusionPreventing = [this, &I, firstLoop, secondLoop, &SE](
+                                    Value *v,
+                                    DGEdge<Value> *dep) -> bool {
+        auto secondAccess = dyn_cast<Instruction>(v);
+        if (false || (secondAccess == nullptr)
+            || (!secondLoop->contains(secondAccess))) {
+          return false;
+        }
+        return !this->isDependenceWithinTheSameIteration(&I,
+                                                         firstLoop,
+                                                         secondAccess,
+                                                         secondLoop,
+                                                         SE);
+      };
+      if (false
+          || pdg->iterateOverDependencesFrom(&I,
+                                             false,
+                                             true,
+                                             false,
+                                             isFusionPreventing)
+          || pdg->iterateOverDependencesTo(&I,
+                                           false,
+                                           true,
+                                           false,
+                                           isFusionPreventing)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool LoopFusion::isDependenceWithinTheSameIteration(Instruction *firstAccess,
+                                                    Loop *firstLoop,
+                                                    Instruction *secondAccess,
+                                                    Loop *secondLoop,
+                                                    ScalarEvolution &SE) {
+
+  /*
+   * Only loads and stores have addresses we can reason about.
+   */
+  auto firstPointer = getLoadStorePointerOperand(firstAccess);
+  auto secondPointer = getLoadStorePointerOperand(secondAccess);
+  if (false || (firstPointer == nullptr) || (secondPointer == nullptr)) {
+    return false;
+  }
+
+  /*
+   * The two accesses must go through the same sequence of addresses, one per
+   * iteration of their loops.
+   */
+  auto firstAddress = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(firstPointer));
+  auto secondAddress = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(secondPointer));
+  if (false || (firstAddress == nullptr) || (secondAddress == nullptr)
+      || (firstAddress->getLoop() != firstLoop)
+      || (secondAddress->getLoop() != secondLoop)
+      || (!firstAddress->isAffine()) || (!secondAddress->isAffine())
+      || (firstAddress->getStart() != secondAddress->getStart())
+      || (firstAddress->getStepRecurrence(SE)
+          != secondAddress->getStepRecurrence(SE))) {
+    return false;
+  }
+
+  /*
+   * The locations accessed by different iterations must not overlap.
+   */
+  auto step = dyn_cast<SCEVConstant>(firstAddress->getStepRecurrence(SE));
+  if (step == nullptr) {
+    return false;
+  }
+  auto &DL = firstAccess->getModule()->getDataLayout();
+  auto firstSize = DL.getTypeStoreSize(
+      cast<PointerType>(firstPointer->getType())->getElementType());
+  auto secondSize = DL.getTypeStoreSize(
+      cast<PointerType>(secondPointer->getType())->getElementType());
+  if (false || (firstSize != secondSize)
+      || (step->getAPInt().abs().ult(firstSize))) {
+    return false;
+  }
+
+  return true;
+}
+
+void LoopFusion::doFusion(Loop *firstLoop, Loop *secondLoop) {
+
+  /*
+   * Fetch the basic blocks of the loops.
+   */
+  auto firstPreHeader = firstLoop->getLoopPreheader();
+  auto firstHeader = firstLoop->getHeader();
+  auto firstLatch = firstLoop->getLoopLatch();
+  auto firstExit = firstLoop->getExitBlock();
+  auto secondHeader = secondLoop->getHeader();
+  auto secondLatch = secondLoop->getLoopLatch();
+  auto secondExit = secondLoop->getExitBlock();
+  auto secondHeaderBr = cast<BranchInst>(secondHeader->getTerminator());
+  auto secondBody = secondHeaderBr->getSuccessor(0);
+  if (secondBody == secondExit) {
+    secondBody = secondHeaderBr->getSuccessor(1);
+  }
+
+  /*
+   * The header of the first loop becomes the header of the fused loop, which
+   * iterates back from the latch of the second loop.
+   */
+  for (auto &phi : firstHeader->phis()) {
+    auto index = phi.getBasicBlockIndex(firstLatch);
+    phi.setIncomingBlock(index, secondLatch);
+  }
+  std::vector<PHINode *> secondPHIs;
+  for (auto &phi : secondHeader->phis()) {
+    secondPHIs.push_back(&phi);
+  }
+  for (auto phi : secondPHIs) {
+    auto index = phi->getBasicBlockIndex(firstExit);
+    phi->setIncomingBlock(index, firstPreHeader);
+    phi->moveBefore(firstHeader->getFirstNonPHI());
+  }
+
+  /*
+   * The rest of the header of the second loop is recomputed at the beginning
+   * of its body.
+   */
+  std::vector<Instruction *> instructionsToMove;
+  for (auto &I : *secondHeader) {
+    if (I.isTerminator()) {
+      continue;
+    }
+    instructionsToMove.push_back(&I);
+  }
+  auto insertPoint = &*secondBody->getFirstInsertionPt();
+  for (auto I : instructionsToMove) {
+    I->moveBefore(insertPoint);
+  }
+
+  /*
+   * The values produced by both loops are now forwarded by the exit of the
+   * second loop.
+   */
+  std::vector<PHINode *> firstExitPHIs;
+  for (auto &phi : firstExit->phis()) {
+    firstExitPHIs.push_back(&phi);
+  }
+  for (auto phi : firstExitPHIs) {
+    phi->moveBefore(secondExit->getFirstNonPHI());
+  }
+  for (auto &phi : secondExit->phis()) {
+    auto index = phi.getBasicBlockIndex(secondHeader);
+    if (index >= 0) {
+      phi.setIncomingBlock(index, firstHeader);
+    }
+  }
+
+  /*
+   * Link the bodies of the loops.
+   * The latch of the first loop is not a latch anymore, so it must not keep
+   * the metadata of the loop.
+   */
+  auto firstLatchTerminator = firstLatch->getTerminator();
+  firstHeader->getTerminator()->replaceUsesOfWith(firstExit, secondExit);
+  firstLatchTerminator->replaceUsesOfWith(firstHeader, secondBody);
+  firstLatchTerminator->setMetadata(LLVMContext::MD_loop, nullptr);
+  secondLatch->getTerminator()->replaceUsesOfWith(secondHeader, firstHeader);
+
+  /*
+   * Remove the basic blocks that are not needed anymore.
+   */
+  firstExit->getTerminator()->eraseFromParent();
+  secondHeaderBr->eraseFromParent();
+  firstExit->eraseFromParent();
+  secondHeader->eraseFromParent();
+  for (auto it = instructionsToMove.rbegin(); it != instructionsToMove.rend();
+       it++) {
+    auto I = *it;
+    if (I->use_empty()) {
+      I->eraseFromParent();
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -26,7 +26,14 @@
 using namespace llvm;
 using namespace llvm::noelle;
 
-LoopDistribution::LoopDistribution() {
+LoopDistribution::LoopDistribution()
+  : LoopDistribution(false) {
+
+  return;
+}
+
+LoopDistribution::LoopDistribution(bool forwardDataDependences)
+  : forwardDataDependences{ forwardDataDependences } {
 
   return;
 }
@@ -56,7 +56,9 @@ public:
 
   /*
    * Reduce live out variables given binary operators to reduce
-   * with and initial values to start at
+   * with, initial values to start at, and identities of the operators.
+   * With many reducers, or with vector variables, private copies are combined
+   * by independent partial accumulators (see getNumberOfPartialAccumulators).
    */
   BasicBlock *reduceLiveOutVariables(
       BasicBlock *bb,
@@ -64,8 +66,22 @@ public:
       const std::unordered_map<uint32_t, Instruction::BinaryOps>
           &reducableBinaryOps,
       const std::unordered_map<uint32_t, Value *> &initialValues,
+      const std::unordered_map<uint32_t, Value *> &identityValues,
       Value *numberOfThreadsExecuted);
 
+  /*
+   * Reduce live out variables by combining all private copies as a balanced
+   * tree whose shape only depends on the number of reducers.
+   * Hence, the result is reproducible as long as every private copy
+   * accumulates the same values (e.g., the same partition of the iterations).
+   * The code is added at the end of @bb, which is returned.
+   */
+  BasicBlock *reduceLiveOutVariablesDeterministically(
+      BasicBlock *bb,
+      const std::unordered_map<uint32_t, Instruction::BinaryOps>
+          &reducableBinaryOps,
+      const std::unordered_map<uint32_t, Value *> &initialValues);
+
   /*
    * As all users of the environment know its structure, pass around the
    * equivalent of a void pointer
@@ -77,11 +93,60 @@ public:
   LoopEnvironmentUser *getUser(uint32_t user) const;
   uint32_t getNumberOfUsers(void) const;
 
+  /*
+   * Return the offset (in 64-bit values) of the variable @ind within the
+   * environment array.
+   * Read-only scalar live-ins are packed together at the beginning of the
+   * array, while every other variable starts its own cache line.
+   */
+  uint64_t getOffsetOfEnvironmentVariable(uint32_t ind) const;
+
+  /*
+   * Return the cache line of the environment array that holds the variable
+   * @ind, which must not be packed.
+   */
+  uint64_t getCacheLineOfEnvironmentVariable(uint32_t ind) const;
+
+  bool isEnvironmentVariablePacked(uint32_t ind) const;
+
   Value *getEnvironmentVariable(uint32_t ind) const;
   Value *getAccumulatedReducedEnvironmentVariable(uint32_t ind) const;
   Value *getReducedEnvironmentVariable(uint32_t ind, uint32_t reducerInd) const;
   bool hasVariableBeenReduced(uint32_t ind) const;
 
+  /*
+   * Return true if the tasks write the variable @ind within the environment
+   * array.
+   * Read-only variables are written only before the tasks start, and reduced
+   * ones are written to the private copies of the tasks.
+   */
+  bool isEnvironmentVariableWrittenByTasks(uint32_t ind) const;
+
+  /*
+   * Return the cache lines of the environment array that hold more than one
+   * variable while at least one of them is written by the tasks.
+   * These cache lines move between cores whenever a task writes them (false
+   * sharing).
+   * Each cache line is mapped to the variables it holds.
+   */
+  std::map<uint64_t, std::set<uint32_t>> getFalselySharedCacheLines(
+      const DataLayout &DL) const;
+
+  /*
+   * Print the layout of the environment: where every variable is stored and
+   * who writes it.
+   */
+  void printLayout(raw_ostream &stream,
+                   const DataLayout &DL,
+                   const std::string &prefixToUse) const;
+
+  /*
+   * Return the layout of the environment in the format read by the runtime
+   * (see NOELLE_registerEnvironment).
+   * It must be called after generateEnvVariables.
+   */
+  std::string getLayoutDescriptor(const DataLayout &DL) const;
+
   ~LoopEnvironmentBuilder();
 
 private:
@@ -102,8 +167,21 @@ private:
   std::unordered_map<uint32_t, Value *> envIndexToAccumulatedReducableVar;
   std::unordered_map<uint32_t, std::vector<Value *>> envIndexToReducableVar;
   std::unordered_map<uint32_t, AllocaInst *> envIndexToVectorOfReducableVar;
+  std::unordered_map<uint32_t, uint64_t> envIndexToReducerStride;
   uint64_t numReducers;
 
+  /*
+   * The read-only scalar live-ins packed at the beginning of the environment
+   * and the number of cache lines they take.
+   */
+  std::unordered_map<uint32_t, uint64_t> envIndexToPackedOffset;
+  uint64_t packedCacheLines;
+
+  /*
+   * The variables that tasks only read.
+   */
+  std::set<uint32_t> readOnlyVars;
+
   /*
    * Information on a specific user (a function, stage, chunk, etc...)
    */
@@ -112,10 +190,25 @@ private:
   void initializeBuilder(const std::vector<Type *> &varTypes,
                          const std::set<uint32_t> &singleVarIndices,
                          const std::set<uint32_t> &reducableVarIndices,
+                         const std::set<uint32_t> &readOnlyVarIndices,
                          uint64_t reducerCount,
                          uint64_t numberOfUsers);
 
+  void packReadOnlyVariables(const std::set<uint32_t> &readOnlyVarIndices);
+
+  std::set<uint32_t> getEnvironmentIndices(void) const;
+
+  uint64_t getBytesOfEnvironmentVariable(const DataLayout &DL,
+                                         uint32_t ind) const;
+
   void createUsers(uint32_t numUsers);
+
+  /*
+   * Number of private copies combined by each iteration of the reduction loop.
+   * The vector of each reducable variable has a multiple of this number of
+   * private copies.
+   */
+  uint32_t getNumberOfPartialAccumulators(void) const;
 };
 
 } // namespace llvm::noelle
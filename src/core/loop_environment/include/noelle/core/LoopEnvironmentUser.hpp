@@ -31,6 +31,14 @@ public:
 
   void setEnvironmentArray(Value *envArr);
 
+  /*
+   * Declare the read-only variables packed at the beginning of the
+   * environment (see LoopEnvironmentBuilder::getOffsetOfEnvironmentVariable).
+   */
+  void setPackedVariables(
+      const std::unordered_map<uint32_t, uint64_t> &packedOffsets,
+      uint64_t packedCacheLines);
+
   Instruction *createEnvironmentVariablePointer(IRBuilder<> b,
                                                 uint32_t envIndex,
                                                 Type *type);
@@ -51,11 +59,27 @@ public:
 
   Instruction *getEnvPtr(uint32_t ind);
 
+  /*
+   * Return the number of 64-bit values between the private copies of a
+   * reducable variable of type @type.
+   * Each copy starts at a cache line and it spans as many cache lines as
+   * needed, so the copies of different reducers never share a cache line.
+   */
+  static uint64_t getReducerStride(const DataLayout &DL, Type *type);
+
   ~LoopEnvironmentUser();
 
 private:
   Value *envArray;
 
+  /*
+   * Layout of the environment
+   */
+  std::unordered_map<uint32_t, uint64_t> envIndexToPackedOffset;
+  uint64_t packedCacheLines;
+
+  uint64_t getOffsetOfEnvironmentVariable(uint32_t envIndex) const;
+
   /*
    * Maps from environment index to load/stores
    */
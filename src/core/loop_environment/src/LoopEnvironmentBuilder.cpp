@@ -25,6 +25,17 @@
 
 namespace llvm::noelle {
 
+/*
+ * Reducers above which private copies are combined by independent partial
+ * accumulators.
+ */
+#define NOELLE_REDUCERS_FOR_PARTIAL_ACCUMULATORS 8
+
+/*
+ * Number of partial accumulators used in that case.
+ */
+#define NOELLE_PARTIAL_ACCUMULATORS 4
+
 LoopEnvironmentBuilder::LoopEnvironmentBuilder(
     LLVMContext &cxt,
     LoopEnvironment *environment,
@@ -40,11 +51,17 @@ LoopEnvironmentBuilder::LoopEnvironmentBuilder(
    */
   std::set<uint32_t> nonReducableVars;
   std::set<uint32_t> reducableVars;
+  std::set<uint32_t> readOnlyVars;
   for (auto liveInVariableIndex : environment->getEnvIndicesOfLiveInVars()) {
     if (shouldThisVariableBeReduced(liveInVariableIndex, false)) {
       reducableVars.insert(liveInVariableIndex);
     } else {
       nonReducableVars.insert(liveInVariableIndex);
+
+      /*
+       * Tasks only read live-ins that are not reduced.
+       */
+      readOnlyVars.insert(liveInVariableIndex);
     }
   }
   for (auto liveOutVariableIndex : environment->getEnvIndicesOfLiveOutVars()) {
@@ -68,6 +85,7 @@ LoopEnvironmentBuilder::LoopEnvironmentBuilder(
   this->initializeBuilder(environment->getTypesOfEnvironmentLocations(),
                           nonReducableVars,
                           reducableVars,
+                          readOnlyVars,
                           reducerCount,
                           numberOfUsers);
 
@@ -89,6 +107,7 @@ LoopEnvironmentBuilder::LoopEnvironmentBuilder(
   this->initializeBuilder(varTypes,
                           singleVarIndices,
                           reducableVarIndices,
+                          {},
                           reducerCount,
                           numberOfUsers);
 
@@ -99,6 +118,7 @@ void LoopEnvironmentBuilder::initializeBuilder(
     const std::vector<Type *> &varTypes,
     const std::set<uint32_t> &singleVarIndices,
     const std::set<uint32_t> &reducableVarIndices,
+    const std::set<uint32_t> &readOnlyVarIndices,
     uint64_t reducerCount,
     uint64_t numberOfUsers) {
 
@@ -111,9 +131,16 @@ void LoopEnvironmentBuilder::initializeBuilder(
   this->envArrayType = nullptr;
   this->envTypes = varTypes;
   this->numReducers = reducerCount;
+  this->packedCacheLines = 0;
+  this->readOnlyVars = readOnlyVarIndices;
   assert(this->envSize == this->envTypes.size()
          && "Environment variables must either be singular or reducible\n");
 
+  /*
+   * Pack the read-only variables.
+   */
+  this->packReadOnlyVariables(readOnlyVarIndices);
+
   /*
    * Compute how many values can fit in a cache line.
    */
@@ -123,7 +150,9 @@ void LoopEnvironmentBuilder::initializeBuilder(
    * Define the LLVM type for the array of environment values.
    */
   auto int64 = IntegerType::get(this->CXT, 64);
-  this->envArrayType = ArrayType::get(int64, this->envSize * valuesInCacheLine);
+  this->envArrayType = ArrayType::get(
+      int64,
+      (this->packedCacheLines + this->envSize) * valuesInCacheLine);
 
   /*
    * Initialize the index-to-variable map.
@@ -143,14 +172,83 @@ void LoopEnvironmentBuilder::initializeBuilder(
   return;
 }
 
+void LoopEnvironmentBuilder::packReadOnlyVariables(
+    const std::set<uint32_t> &readOnlyVarIndices) {
+
+  /*
+   * Every task reads the read-only variables, but none writes them.
+   * Hence, they can share cache lines without false sharing: packing them
+   * makes tasks fetch a few cache lines rather than one per live-in.
+   *
+   * Only scalars that fit a 64-bit value are packed.
+   */
+  uint64_t packedVariables = 0;
+  for (auto envIndex : readOnlyVarIndices) {
+    auto varType = this->envTypes[envIndex];
+    auto isScalar =
+        false || varType->isPointerTy() || varType->isFloatTy()
+        || varType->isDoubleTy()
+        || (varType->isIntegerTy() && (varType->getIntegerBitWidth() <= 64));
+    if (!isScalar) {
+      continue;
+    }
+    this->envIndexToPackedOffset[envIndex] = packedVariables;
+    packedVariables++;
+  }
+
+  /*
+   * Compute the number of cache lines of the packed variables.
+   * The variables that follow them start at a new cache line.
+   */
+  auto valuesInCacheLine = Architecture::getCacheLineBytes() / sizeof(int64_t);
+  this->packedCacheLines =
+      (packedVariables + valuesInCacheLine - 1) / valuesInCacheLine;
+
+  return;
+}
+
 void LoopEnvironmentBuilder::createUsers(uint32_t numUsers) {
   for (auto i = 0u; i < numUsers; ++i) {
-    this->envUsers.push_back(new LoopEnvironmentUser());
+    auto envUser = new LoopEnvironmentUser();
+    envUser->setPackedVariables(this->envIndexToPackedOffset,
+                                this->packedCacheLines);
+    this->envUsers.push_back(envUser);
   }
 
   return;
 }
 
+uint64_t LoopEnvironmentBuilder::getOffsetOfEnvironmentVariable(
+    uint32_t ind) const {
+
+  /*
+   * Check if the variable is packed with the other read-only ones.
+   */
+  auto packedIt = this->envIndexToPackedOffset.find(ind);
+  if (packedIt != this->envIndexToPackedOffset.end()) {
+    return packedIt->second;
+  }
+
+  /*
+   * The variable has its own cache line after the packed ones.
+   */
+  auto valuesInCacheLine = Architecture::getCacheLineBytes() / sizeof(int64_t);
+
+  return this->getCacheLineOfEnvironmentVariable(ind) * valuesInCacheLine;
+}
+
+uint64_t LoopEnvironmentBuilder::getCacheLineOfEnvironmentVariable(
+    uint32_t ind) const {
+  assert(!this->isEnvironmentVariablePacked(ind));
+
+  return this->packedCacheLines + ind;
+}
+
+bool LoopEnvironmentBuilder::isEnvironmentVariablePacked(uint32_t ind) const {
+  return this->envIndexToPackedOffset.find(ind)
+         != this->envIndexToPackedOffset.end();
+}
+
 void LoopEnvironmentBuilder::addVariableToEnvironment(uint64_t varIndex,
                                                       Type *varType) {
   this->envSize++;
@@ -165,7 +263,9 @@ void LoopEnvironmentBuilder::addVariableToEnvironment(uint64_t varIndex,
    * Define the LLVM type for the array of environment values.
    */
   auto int64 = IntegerType::get(this->CXT, 64);
-  this->envArrayType = ArrayType::get(int64, this->envSize * valuesInCacheLine);
+  this->envArrayType = ArrayType::get(
+      int64,
+      (this->packedCacheLines + this->envSize) * valuesInCacheLine);
 
   /*
    * Set the index-to-var map for the new variable.
@@ -186,8 +286,15 @@ void LoopEnvironmentBuilder::allocateEnvironmentArray(IRBuilder<> builder) {
 
   auto int8 = IntegerType::get(builder.getContext(), 8);
   auto ptrTy_int8 = PointerType::getUnqual(int8);
-  this->envArray =
+  auto envAlloca =
       builder.CreateAlloca(this->envArrayType, nullptr, "loop_environment");
+
+  /*
+   * Align the environment to the cache line, so the packed read-only variables
+   * and every other variable do not straddle cache lines.
+   */
+  envAlloca->setAlignment(Architecture::getCacheLineBytes());
+  this->envArray = envAlloca;
   this->envArrayInt8Ptr =
       cast<Value>(builder.CreateBitCast(this->envArray, ptrTy_int8));
 
@@ -213,13 +320,9 @@ void LoopEnvironmentBuilder::generateEnvVariables(IRBuilder<> builder) {
     /*
      * Compute the offset of the variable with index "envIndex" that is stored
      * inside the environment.
-     *
-     * Compute how many values can fit in a cache line.
      */
-    auto valuesInCacheLine =
-        Architecture::getCacheLineBytes() / sizeof(int64_t);
-    auto indValue =
-        cast<Value>(ConstantInt::get(int64, envIndex * valuesInCacheLine));
+    auto indValue = cast<Value>(
+        ConstantInt::get(int64, this->getOffsetOfEnvironmentVariable(envIndex)));
 
     /*
      * Compute the address of the variable with index "envIndex".
@@ -262,6 +365,11 @@ void LoopEnvironmentBuilder::generateEnvVariables(IRBuilder<> builder) {
   for (auto indexVarPair : this->envIndexToReducableVar) {
     reducableIndices.insert(indexVarPair.first);
   }
+  auto &DL = builder.GetInsertBlock()->getModule()->getDataLayout();
+  auto partialAccumulators = this->getNumberOfPartialAccumulators();
+  auto numberOfPrivateCopies =
+      ((this->numReducers + partialAccumulators - 1) / partialAccumulators)
+      * partialAccumulators;
   for (auto envIndex : reducableIndices) {
 
     /*
@@ -272,19 +380,24 @@ void LoopEnvironmentBuilder::generateEnvVariables(IRBuilder<> builder) {
 
     /*
      * Define the type of the vectorized form of the reducable variable.
+     * Every private copy is padded to a multiple of the cache line to avoid
+     * false sharing between reducers.
      */
-    auto valuesInCacheLine =
-        Architecture::getCacheLineBytes() / sizeof(int64_t);
+    auto reducerStride = LoopEnvironmentUser::getReducerStride(DL, varType);
+    this->envIndexToReducerStride[envIndex] = reducerStride;
     auto reduceArrType =
-        ArrayType::get(int64, this->numReducers * valuesInCacheLine);
+        ArrayType::get(int64, numberOfPrivateCopies * reducerStride);
 
     /*
      * Allocate the vectorized form of the current reducable variable on the
      * stack.
+     * The vector is aligned to the cache line, so each private copy starts at
+     * its own cache line.
      */
     auto reduceArrAlloca = builder.CreateAlloca(reduceArrType,
                                                 nullptr,
                                                 "reduction_variable_array");
+    reduceArrAlloca->setAlignment(Architecture::getCacheLineBytes());
     this->envIndexToVectorOfReducableVar[envIndex] = reduceArrAlloca;
 
     /*
@@ -299,7 +412,12 @@ void LoopEnvironmentBuilder::generateEnvVariables(IRBuilder<> builder) {
      * Compute and cache the pointer of each element of the vectorized variable.
      */
     for (auto i = 0u; i < this->numReducers; ++i) {
-      auto reducePtr = fetchCastedEnvPtr(reduceArrAlloca, i, ptrType);
+      auto indValue =
+          cast<Value>(ConstantInt::get(int64, i * reducerStride));
+      auto reducePtr = builder.CreateBitCast(
+          builder.CreateInBoundsGEP(reduceArrAlloca,
+                                    ArrayRef<Value *>({ zeroV, indValue })),
+          ptrType);
       this->envIndexToReducableVar[envIndex].push_back(reducePtr);
     }
   }
@@ -313,6 +431,7 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
     const std::unordered_map<uint32_t, Instruction::BinaryOps>
         &reducableBinaryOps,
     const std::unordered_map<uint32_t, Value *> &initialValues,
+    const std::unordered_map<uint32_t, Value *> &identityValues,
     Value *numberOfThreadsExecuted) {
   assert(bb != nullptr);
 
@@ -329,6 +448,14 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
   auto f = bb->getParent();
   assert(f != nullptr);
 
+  /*
+   * Fetch the number of private copies combined by each iteration of the
+   * reduction loop.
+   * Each of them is combined into its own partial accumulator, so the
+   * combinations of the same iteration do not depend on each other.
+   */
+  auto partialAccumulators = this->getNumberOfPartialAccumulators();
+
   /*
    * Create a new basic block that will include the loop body.
    */
@@ -361,83 +488,107 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
   IVReductionLoop->addIncoming(constantZero, bb);
 
   /*
-   * Add the PHI nodes about the current accumulated value
+   * Add the PHI nodes about the current accumulated values.
+   * The first partial accumulator starts from the initial value of the
+   * variable, and the others start from the identity of the operator.
    */
-  std::vector<PHINode *> phiNodes;
-  auto count = 0;
+  std::vector<std::vector<PHINode *>> phiNodes;
   for (auto envIndexInitValue : initialValues) {
     auto envIndex = envIndexInitValue.first;
     auto initialValue = envIndexInitValue.second;
 
     /*
-     * Create a PHI node for the current reduced variable.
+     * Create the PHI nodes for the current reduced variable.
      */
     auto variableType = envTypes[envIndex];
-    auto phiNode = loopBodyBuilder.CreatePHI(variableType, 2);
+    std::vector<PHINode *> partialPHINodes;
+    for (auto j = 0u; j < partialAccumulators; j++) {
+      auto phiNode = loopBodyBuilder.CreatePHI(variableType, 2);
 
-    /*
-     * Add the value in case we just started accumulating.
-     */
-    phiNode->addIncoming(initialValue, bb);
+      /*
+       * Add the value in case we just started accumulating.
+       */
+      auto startValue = (j == 0) ? initialValue : identityValues.at(envIndex);
+      phiNode->addIncoming(startValue, bb);
+
+      partialPHINodes.push_back(phiNode);
+    }
 
     /*
-     * Keep track of the PHI node just created.
+     * Keep track of the PHI nodes just created.
      */
-    phiNodes.push_back(phiNode);
+    phiNodes.push_back(partialPHINodes);
   }
 
-  /*
-   * Compute how many values can fit in a cache line.
-   */
-  auto valuesInCacheLine = Architecture::getCacheLineBytes() / sizeof(int64_t);
-
   /*
    * Load the values stored in the private copies of the threads.
+   * Copies that go beyond the number of threads executed are replaced by the
+   * identity of the operator.
    */
-  count = 0;
-  std::vector<Value *> loadedValues;
+  auto count = 0;
+  std::vector<std::vector<Value *>> loadedValues;
   for (auto envIndexInitValue : initialValues) {
     auto envIndex = envIndexInitValue.first;
-
-    /*
-     * Compute the pointer of the private copy of the current thread.
-     *
-     * First, we compute the offset, which is "index" times 8 because
-     * environment values are 64 byte aligned.
-     */
-    auto eightValue = ConstantInt::get(int32Type, valuesInCacheLine);
-    auto offsetValue = loopBodyBuilder.CreateMul(IVReductionLoop, eightValue);
-
-    /*
-     * Now, we compute the effective address.
-     */
-    auto baseAddressOfReducedVar =
-        this->envIndexToVectorOfReducableVar.at(envIndex);
-    auto zeroV = cast<Value>(ConstantInt::get(int32Type, 0));
-    auto effectiveAddressOfReducedVar = loopBodyBuilder.CreateInBoundsGEP(
-        baseAddressOfReducedVar,
-        ArrayRef<Value *>({ zeroV, offsetValue }));
-
-    /*
-     * Finally, cast the effective address to the correct LLVM type.
-     */
-    auto varType = envTypes[envIndex];
-    auto ptrType = PointerType::getUnqual(varType);
-    auto effectiveAddressOfReducedVarProperlyCasted =
-        loopBodyBuilder.CreateBitCast(effectiveAddressOfReducedVar, ptrType);
-
-    /*
-     * Load the next value that needs to be accumulated.
-     */
-    auto envVar =
-        loopBodyBuilder.CreateLoad(effectiveAddressOfReducedVarProperlyCasted);
-    loadedValues.push_back(envVar);
+    auto reducerStride = this->envIndexToReducerStride.at(envIndex);
+    std::vector<Value *> partialValues;
+    for (auto j = 0u; j < partialAccumulators; j++) {
+
+      /*
+       * Compute the pointer of the private copy of the current thread.
+       *
+       * First, we compute the offset, which is "index" times the stride of
+       * the private copies.
+       */
+      Value *reducerIndex = IVReductionLoop;
+      if (j > 0) {
+        reducerIndex =
+            loopBodyBuilder.CreateAdd(IVReductionLoop,
+                                      ConstantInt::get(int32Type, j));
+      }
+      auto strideValue = ConstantInt::get(int32Type, reducerStride);
+      auto offsetValue = loopBodyBuilder.CreateMul(reducerIndex, strideValue);
+
+      /*
+       * Now, we compute the effective address.
+       */
+      auto baseAddressOfReducedVar =
+          this->envIndexToVectorOfReducableVar.at(envIndex);
+      auto zeroV = cast<Value>(ConstantInt::get(int32Type, 0));
+      auto effectiveAddressOfReducedVar = loopBodyBuilder.CreateInBoundsGEP(
+          baseAddressOfReducedVar,
+          ArrayRef<Value *>({ zeroV, offsetValue }));
+
+      /*
+       * Finally, cast the effective address to the correct LLVM type.
+       */
+      auto varType = envTypes[envIndex];
+      auto ptrType = PointerType::getUnqual(varType);
+      auto effectiveAddressOfReducedVarProperlyCasted =
+          loopBodyBuilder.CreateBitCast(effectiveAddressOfReducedVar, ptrType);
+
+      /*
+       * Load the next value that needs to be accumulated.
+       */
+      Value *envVar = loopBodyBuilder.CreateLoad(
+          effectiveAddressOfReducedVarProperlyCasted);
+      if (j > 0) {
+        auto isThreadExecuted =
+            loopBodyBuilder.CreateICmpSLT(reducerIndex,
+                                          numberOfThreadsExecuted);
+        envVar = loopBodyBuilder.CreateSelect(isThreadExecuted,
+                                              envVar,
+                                              identityValues.at(envIndex));
+      }
+      partialValues.push_back(envVar);
+    }
+    loadedValues.push_back(partialValues);
   }
 
   /*
    * Accumulate values to the appropriate accumulators.
    */
   count = 0;
+  std::vector<std::vector<Value *>> newAccumulatorValues;
   for (auto envIndexInitValue : initialValues) {
     auto envIndex = envIndexInitValue.first;
 
@@ -448,22 +599,22 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
     auto binOp = reducableBinaryOps.at(envIndex);
 
     /*
-     * Fetch the accumulator, which is the PHI node related to the current
-     * reduced variable.
+     * Accumulate values to the partial accumulators of the current reduced
+     * variable, which are the PHI nodes related to it.
      */
-    auto accumVal = phiNodes[count];
-
-    /*
-     * Accumulate values to the accumulator of the current reduced variable.
-     */
-    auto privateCurrentCopy = loadedValues[count];
-    auto newAccumulatorValue =
-        loopBodyBuilder.CreateBinOp(binOp, accumVal, privateCurrentCopy);
+    std::vector<Value *> partialValues;
+    for (auto j = 0u; j < partialAccumulators; j++) {
+      auto accumVal = phiNodes[count][j];
+      auto privateCurrentCopy = loadedValues[count][j];
+      auto newAccumulatorValue =
+          loopBodyBuilder.CreateBinOp(binOp, accumVal, privateCurrentCopy);
+      partialValues.push_back(newAccumulatorValue);
+    }
 
     /*
-     * Keep track of the new accumulator value.
+     * Keep track of the new accumulator values.
      */
-    this->envIndexToAccumulatedReducableVar[envIndex] = newAccumulatorValue;
+    newAccumulatorValues.push_back(partialValues);
 
     count++;
   }
@@ -473,23 +624,15 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
    */
   count = 0;
   for (auto envIndexInitValue : initialValues) {
-    auto envIndex = envIndexInitValue.first;
-
-    /*
-     * Fetch the PHI node of the accumulator of the current reduced variable.
-     */
-    auto phiNode = phiNodes[count];
-
-    /*
-     * Fetch the value computed by the previous iteration.
-     */
-    auto previousIterationAccumulatorValue =
-        this->envIndexToAccumulatedReducableVar.at(envIndex);
-
-    /*
-     * Add the value related to the previous iteration of the reduction loop.
-     */
-    phiNode->addIncoming(previousIterationAccumulatorValue, loopBodyBB);
+    for (auto j = 0u; j < partialAccumulators; j++) {
+
+      /*
+       * Add the value related to the previous iteration of the reduction
+       * loop.
+       */
+      auto phiNode = phiNodes[count][j];
+      phiNode->addIncoming(newAccumulatorValues[count][j], loopBodyBB);
+    }
 
     count++;
   }
@@ -497,9 +640,9 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
   /*
    * Update the induction variable for the reduction loop.
    */
-  auto constantOne = ConstantInt::get(int32Type, 1);
+  auto constantStep = ConstantInt::get(int32Type, partialAccumulators);
   auto updatedIVReductionLoop =
-      loopBodyBuilder.CreateAdd(IVReductionLoop, constantOne);
+      loopBodyBuilder.CreateAdd(IVReductionLoop, constantStep);
   IVReductionLoop->addIncoming(updatedIVReductionLoop, loopBodyBB);
 
   /*
@@ -517,9 +660,125 @@ BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariables(
                                loopBodyBB,
                                afterReductionBB);
 
+  /*
+   * Combine the partial accumulators as a tree.
+   */
+  IRBuilder<> afterReductionBuilder{ afterReductionBB };
+  count = 0;
+  for (auto envIndexInitValue : initialValues) {
+    auto envIndex = envIndexInitValue.first;
+    auto binOp = reducableBinaryOps.at(envIndex);
+    auto partialValues = newAccumulatorValues[count];
+    while (partialValues.size() > 1) {
+      std::vector<Value *> combinedValues;
+      for (auto j = 0u; (j + 1) < partialValues.size(); j += 2) {
+        auto combinedValue =
+            afterReductionBuilder.CreateBinOp(binOp,
+                                              partialValues[j],
+                                              partialValues[j + 1]);
+        combinedValues.push_back(combinedValue);
+      }
+      if ((partialValues.size() % 2) == 1) {
+        combinedValues.push_back(partialValues.back());
+      }
+      partialValues = combinedValues;
+    }
+
+    /*
+     * Keep track of the accumulated value of the current reduced variable.
+     */
+    this->envIndexToAccumulatedReducableVar[envIndex] = partialValues[0];
+
+    count++;
+  }
+
   return afterReductionBB;
 }
 
+BasicBlock *LoopEnvironmentBuilder::reduceLiveOutVariablesDeterministically(
+    BasicBlock *bb,
+    const std::unordered_map<uint32_t, Instruction::BinaryOps>
+        &reducableBinaryOps,
+    const std::unordered_map<uint32_t, Value *> &initialValues) {
+  assert(bb != nullptr);
+
+  /*
+   * Add the code at the end of @bb.
+   */
+  IRBuilder<> builder{ bb };
+  if (auto terminator = bb->getTerminator()) {
+    builder.SetInsertPoint(terminator);
+  }
+
+  /*
+   * Reduce the variables one at a time.
+   * The iteration order over the variables does not change the results.
+   */
+  for (auto envIndexInitValue : initialValues) {
+    auto envIndex = envIndexInitValue.first;
+    auto initialValue = envIndexInitValue.second;
+    auto binOp = reducableBinaryOps.at(envIndex);
+
+    /*
+     * Load all private copies.
+     */
+    std::vector<Value *> partialValues;
+    for (auto reducerPtr : this->envIndexToReducableVar.at(envIndex)) {
+      partialValues.push_back(builder.CreateLoad(reducerPtr));
+    }
+    assert(partialValues.size() > 0);
+
+    /*
+     * Combine neighbouring values level by level.
+     */
+    while (partialValues.size() > 1) {
+      std::vector<Value *> combinedValues;
+      for (auto j = 0u; (j + 1) < partialValues.size(); j += 2) {
+        auto combinedValue = builder.CreateBinOp(binOp,
+                                                 partialValues[j],
+                                                 partialValues[j + 1]);
+        combinedValues.push_back(combinedValue);
+      }
+      if ((partialValues.size() % 2) == 1) {
+        combinedValues.push_back(partialValues.back());
+      }
+      partialValues = combinedValues;
+    }
+
+    /*
+     * Finally, combine the initial value of the variable with the values
+     * accumulated by the loop.
+     */
+    this->envIndexToAccumulatedReducableVar[envIndex] =
+        builder.CreateBinOp(binOp, initialValue, partialValues[0]);
+  }
+
+  return bb;
+}
+
+uint32_t LoopEnvironmentBuilder::getNumberOfPartialAccumulators(void) const {
+
+  /*
+   * Check if the reduction has enough private copies to hide the latency of
+   * the operators.
+   */
+  if (this->numReducers >= NOELLE_REDUCERS_FOR_PARTIAL_ACCUMULATORS) {
+    return NOELLE_PARTIAL_ACCUMULATORS;
+  }
+
+  /*
+   * Operators on vectors have long latencies.
+   */
+  for (auto indexVarPair : this->envIndexToReducableVar) {
+    auto varType = this->envTypes[indexVarPair.first];
+    if (varType->isVectorTy()) {
+      return NOELLE_PARTIAL_ACCUMULATORS;
+    }
+  }
+
+  return 1;
+}
+
 Value *LoopEnvironmentBuilder::getEnvironmentArrayVoidPtr(void) const {
   assert(this->envArrayInt8Ptr != nullptr);
 
@@ -562,6 +821,199 @@ bool LoopEnvironmentBuilder::hasVariableBeenReduced(uint32_t ind) const {
   return isReduce;
 }
 
+bool LoopEnvironmentBuilder::isEnvironmentVariableWrittenByTasks(
+    uint32_t ind) const {
+
+  /*
+   * Reduced variables are stored in the environment as pointers to the
+   * vectors of their private copies, which tasks only read.
+   */
+  if (this->hasVariableBeenReduced(ind)) {
+    return false;
+  }
+
+  return this->readOnlyVars.find(ind) == this->readOnlyVars.end();
+}
+
+std::set<uint32_t> LoopEnvironmentBuilder::getEnvironmentIndices(void) const {
+  std::set<uint32_t> indices;
+  for (auto indexVarPair : this->envIndexToVar) {
+    indices.insert(indexVarPair.first);
+  }
+  for (auto &indexVarPair : this->envIndexToReducableVar) {
+    indices.insert(indexVarPair.first);
+  }
+
+  return indices;
+}
+
+uint64_t LoopEnvironmentBuilder::getBytesOfEnvironmentVariable(
+    const DataLayout &DL,
+    uint32_t ind) const {
+
+  /*
+   * The environment stores the pointer to the vector of a reduced variable.
+   */
+  if (this->hasVariableBeenReduced(ind)) {
+    return sizeof(void *);
+  }
+
+  /*
+   * Other variables are stored in the environment.
+   */
+  uint64_t typeBytes = DL.getTypeAllocSize(this->envTypes[ind]);
+  if (typeBytes == 0) {
+    typeBytes = 1;
+  }
+
+  return typeBytes;
+}
+
+std::map<uint64_t, std::set<uint32_t>> LoopEnvironmentBuilder::
+    getFalselySharedCacheLines(const DataLayout &DL) const {
+
+  /*
+   * Map each cache line of the environment array to the variables it holds.
+   * Variables larger than a cache line span several of them.
+   */
+  uint64_t cacheLineBytes = Architecture::getCacheLineBytes();
+  std::map<uint64_t, std::set<uint32_t>> cacheLines;
+  for (auto envIndex : this->getEnvironmentIndices()) {
+    auto firstByte =
+        this->getOffsetOfEnvironmentVariable(envIndex) * sizeof(int64_t);
+    auto lastByte =
+        firstByte + this->getBytesOfEnvironmentVariable(DL, envIndex) - 1;
+    for (auto cacheLine = firstByte / cacheLineBytes;
+         cacheLine <= (lastByte / cacheLineBytes);
+         cacheLine++) {
+      cacheLines[cacheLine].insert(envIndex);
+    }
+  }
+
+  /*
+   * Keep the cache lines where a variable written by the tasks sits next to
+   * other variables.
+   */
+  std::map<uint64_t, std::set<uint32_t>> sharedCacheLines;
+  for (auto &cacheLinePair : cacheLines) {
+    auto &variables = cacheLinePair.second;
+    if (variables.size() < 2) {
+      continue;
+    }
+    auto isWritten = false;
+    for (auto envIndex : variables) {
+      if (this->isEnvironmentVariableWrittenByTasks(envIndex)) {
+        isWritten = true;
+        break;
+      }
+    }
+    if (!isWritten) {
+      continue;
+    }
+    sharedCacheLines.insert(cacheLinePair);
+  }
+
+  return sharedCacheLines;
+}
+
+void LoopEnvironmentBuilder::printLayout(raw_ostream &stream,
+                                         const DataLayout &DL,
+                                         const std::string &prefixToUse) const {
+  uint64_t cacheLineBytes = Architecture::getCacheLineBytes();
+  uint64_t envBytes = this->envArrayType->getNumElements() * sizeof(int64_t);
+  stream << prefixToUse << "Environment of " << envBytes << " bytes ("
+         << (envBytes / cacheLineBytes) << " cache lines)\n";
+
+  /*
+   * Print the variables.
+   */
+  for (auto envIndex : this->getEnvironmentIndices()) {
+    auto firstByte =
+        this->getOffsetOfEnvironmentVariable(envIndex) * sizeof(int64_t);
+    auto bytes = this->getBytesOfEnvironmentVariable(DL, envIndex);
+    stream << prefixToUse << "  Variable " << envIndex << ": bytes "
+           << firstByte << "-" << (firstByte + bytes - 1) << " (cache line "
+           << (firstByte / cacheLineBytes);
+    if (this->isEnvironmentVariablePacked(envIndex)) {
+      stream << ", packed";
+    }
+    stream << "), ";
+    if (this->isEnvironmentVariableWrittenByTasks(envIndex)) {
+      stream << "written by the tasks\n";
+      continue;
+    }
+    stream << "read by the tasks";
+    if (this->hasVariableBeenReduced(envIndex)) {
+      auto strideIt = this->envIndexToReducerStride.find(envIndex);
+      if (strideIt != this->envIndexToReducerStride.end()) {
+        auto strideBytes = strideIt->second * sizeof(int64_t);
+        stream << ", which write " << this->numReducers
+               << " private copies every " << strideBytes << " bytes";
+      }
+    }
+    stream << "\n";
+  }
+
+  /*
+   * Print the cache lines that are falsely shared.
+   */
+  auto sharedCacheLines = this->getFalselySharedCacheLines(DL);
+  if (sharedCacheLines.size() == 0) {
+    stream << prefixToUse << "  No cache line is falsely shared\n";
+    return;
+  }
+  for (auto &cacheLinePair : sharedCacheLines) {
+    stream << prefixToUse << "  Cache line " << cacheLinePair.first
+           << " is falsely shared by the variables";
+    for (auto envIndex : cacheLinePair.second) {
+      stream << " " << envIndex;
+    }
+    stream << "\n";
+  }
+
+  return;
+}
+
+std::string LoopEnvironmentBuilder::getLayoutDescriptor(
+    const DataLayout &DL) const {
+
+  /*
+   * Every variable is described by "INDEX:KIND:OFFSET:BYTES", where OFFSET
+   * and BYTES locate it in the environment array and KIND is
+   * - r: the tasks read it,
+   * - w: the tasks write it,
+   * - p: the tasks read the pointer to their private copies, which is then
+   *      followed by ":STRIDE:COPIES:COPY_BYTES".
+   * Variables are separated by commas.
+   */
+  std::string descriptor;
+  for (auto envIndex : this->getEnvironmentIndices()) {
+    if (descriptor != "") {
+      descriptor += ",";
+    }
+    auto firstByte =
+        this->getOffsetOfEnvironmentVariable(envIndex) * sizeof(int64_t);
+    auto bytes = this->getBytesOfEnvironmentVariable(DL, envIndex);
+    std::string kind = "r";
+    if (this->hasVariableBeenReduced(envIndex)) {
+      kind = "p";
+    } else if (this->isEnvironmentVariableWrittenByTasks(envIndex)) {
+      kind = "w";
+    }
+    descriptor += std::to_string(envIndex) + ":" + kind + ":"
+                  + std::to_string(firstByte) + ":" + std::to_string(bytes);
+    if (kind == "p") {
+      auto stride = this->envIndexToReducerStride.at(envIndex);
+      uint64_t copyBytes = DL.getTypeAllocSize(this->envTypes[envIndex]);
+      descriptor += ":" + std::to_string(stride * sizeof(int64_t)) + ":"
+                    + std::to_string(this->numReducers) + ":"
+                    + std::to_string(copyBytes);
+    }
+  }
+
+  return descriptor;
+}
+
 LoopEnvironmentUser *LoopEnvironmentBuilder::getUser(uint32_t user) const {
   if (user >= this->getNumberOfUsers()) {
     abort();
@@ -27,7 +27,9 @@ namespace llvm::noelle {
 LoopEnvironmentUser::LoopEnvironmentUser()
   : envIndexToPtr{},
     liveInInds{},
-    liveOutInds{} {
+    liveOutInds{},
+    envIndexToPackedOffset{},
+    packedCacheLines{ 0 } {
   envIndexToPtr.clear();
   liveInInds.clear();
   liveOutInds.clear();
@@ -39,6 +41,34 @@ void LoopEnvironmentUser::setEnvironmentArray(Value *envArr) {
   this->envArray = envArr;
 }
 
+void LoopEnvironmentUser::setPackedVariables(
+    const std::unordered_map<uint32_t, uint64_t> &packedOffsets,
+    uint64_t packedCacheLines) {
+  this->envIndexToPackedOffset = packedOffsets;
+  this->packedCacheLines = packedCacheLines;
+
+  return;
+}
+
+uint64_t LoopEnvironmentUser::getOffsetOfEnvironmentVariable(
+    uint32_t envIndex) const {
+
+  /*
+   * Check if the variable is packed with the other read-only ones.
+   */
+  auto packedIt = this->envIndexToPackedOffset.find(envIndex);
+  if (packedIt != this->envIndexToPackedOffset.end()) {
+    return packedIt->second;
+  }
+
+  /*
+   * The variable has its own cache line after the packed ones.
+   */
+  auto valuesInCacheLine = Architecture::getCacheLineBytes() / sizeof(int64_t);
+
+  return (this->packedCacheLines + envIndex) * valuesInCacheLine;
+}
+
 Instruction *LoopEnvironmentUser::createEnvironmentVariablePointer(
     IRBuilder<> builder,
     uint32_t envIndex,
@@ -59,16 +89,11 @@ Instruction *LoopEnvironmentUser::createEnvironmentVariablePointer(
   auto int64 = IntegerType::get(builder.getContext(), 64);
   auto zeroV = cast<Value>(ConstantInt::get(int64, 0));
 
-  /*
-   * Compute how many values can fit in a cache line.
-   */
-  auto valuesInCacheLine = Architecture::getCacheLineBytes() / sizeof(int64_t);
-
   /*
    * Compute the offset of the environment variable.
    */
-  auto envIndV =
-      cast<Value>(ConstantInt::get(int64, envIndex * valuesInCacheLine));
+  auto envIndV = cast<Value>(
+      ConstantInt::get(int64, this->getOffsetOfEnvironmentVariable(envIndex)));
 
   /*
    * Compute the address of the environment variable
@@ -99,26 +124,26 @@ void LoopEnvironmentUser::createReducableEnvPtr(IRBuilder<> builder,
   }
 
   /*
-   * Compute how many values can fit in a cache line.
+   * Compute the distance between the private copies of the variable.
    */
-  auto valuesInCacheLine = Architecture::getCacheLineBytes() / sizeof(int64_t);
+  auto &DL = builder.GetInsertBlock()->getModule()->getDataLayout();
+  auto reducerStride = LoopEnvironmentUser::getReducerStride(DL, type);
 
   auto int64 = IntegerType::get(builder.getContext(), 64);
   auto zeroV = cast<Value>(ConstantInt::get(int64, 0));
-  auto envIndV =
-      cast<Value>(ConstantInt::get(int64, envIndex * valuesInCacheLine));
+  auto envIndV = cast<Value>(
+      ConstantInt::get(int64, this->getOffsetOfEnvironmentVariable(envIndex)));
 
   auto envReduceGEP =
       builder.CreateInBoundsGEP(this->envArray,
                                 ArrayRef<Value *>({ zeroV, envIndV }));
   auto arrPtr = PointerType::getUnqual(
-      ArrayType::get(int64, reducerCount * valuesInCacheLine));
+      ArrayType::get(int64, reducerCount * reducerStride));
   auto envReducePtr =
       builder.CreateBitCast(envReduceGEP, PointerType::getUnqual(arrPtr));
 
   auto reduceIndAlignedV =
-      builder.CreateMul(reducerIndV,
-                        ConstantInt::get(int64, valuesInCacheLine));
+      builder.CreateMul(reducerIndV, ConstantInt::get(int64, reducerStride));
   auto envGEP = builder.CreateInBoundsGEP(
       builder.CreateLoad(envReducePtr),
       ArrayRef<Value *>({ zeroV, reduceIndAlignedV }));
@@ -127,6 +152,22 @@ void LoopEnvironmentUser::createReducableEnvPtr(IRBuilder<> builder,
   this->envIndexToPtr[envIndex] = cast<Instruction>(envPtr);
 }
 
+uint64_t LoopEnvironmentUser::getReducerStride(const DataLayout &DL,
+                                               Type *type) {
+  uint64_t cacheLineBytes = Architecture::getCacheLineBytes();
+
+  /*
+   * Compute the number of cache lines needed by a private copy.
+   */
+  uint64_t typeBytes = DL.getTypeAllocSize(type);
+  auto cacheLines = (typeBytes + cacheLineBytes - 1) / cacheLineBytes;
+  if (cacheLines == 0) {
+    cacheLines = 1;
+  }
+
+  return (cacheLines * cacheLineBytes) / sizeof(int64_t);
+}
+
 void LoopEnvironmentUser::addLiveInIndex(uint32_t ind) {
   liveInInds.insert(ind);
 
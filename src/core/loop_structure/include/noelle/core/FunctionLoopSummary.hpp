@@ -0,0 +1,111 @@
+/*
+ * Copyright 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Summary of the loops of a function, which is computed once from the LLVM
+ * loop analysis and shared by the LoopStructure objects of these loops until
+ * the CFG of the function changes.
+ *
+ * Loops are identified by their position in the preorder of their forest
+ * (the one of LoopInfo::getLoopsInPreorder), and basic blocks by their
+ * position in the function.
+ */
+class FunctionLoopSummary {
+public:
+  FunctionLoopSummary(Function &F, LoopInfo &LI);
+
+  Function *getFunction(void) const;
+
+  /*
+   * Check if the CFG of the function is the one the summary has been
+   * computed from.
+   */
+  bool isUpToDate(void) const;
+
+  uint32_t getNumberOfLoops(void) const;
+
+  BasicBlock *getHeader(uint32_t loop) const;
+
+  BasicBlock *getPreHeader(uint32_t loop) const;
+
+  /*
+   * Return the nesting level of @loop.
+   * 1 means outermost loop.
+   */
+  uint32_t getNestingLevel(uint32_t loop) const;
+
+  /*
+   * Return the loop that immediately contains @loop, or -1 if @loop is an
+   * outermost loop.
+   */
+  int32_t getParent(uint32_t loop) const;
+
+  const std::vector<BasicBlock *> &getBasicBlocks(uint32_t loop) const;
+
+  const std::vector<BasicBlock *> &getLatches(uint32_t loop) const;
+
+  const std::vector<BasicBlock *> &getExitBasicBlocks(uint32_t loop) const;
+
+  const std::vector<std::pair<BasicBlock *, BasicBlock *>> &getExitEdges(
+      uint32_t loop) const;
+
+  bool isIncluded(uint32_t loop, BasicBlock *bb) const;
+
+  /*
+   * Return the innermost loop that contains @bb, or -1 if no loop contains
+   * it.
+   */
+  int32_t getInnermostLoopThatContains(BasicBlock *bb) const;
+
+private:
+  struct LoopSummary {
+    BasicBlock *header;
+    BasicBlock *preHeader;
+    uint32_t depth;
+    int32_t parent;
+    BitVector blocks;
+    std::vector<BasicBlock *> basicBlocks;
+    std::vector<BasicBlock *> latches;
+    std::vector<BasicBlock *> exitBlocks;
+    std::vector<std::pair<BasicBlock *, BasicBlock *>> exitEdges;
+  };
+
+  Function *function;
+  std::vector<LoopSummary> loops;
+  std::unordered_map<BasicBlock *, uint32_t> blockIndices;
+  std::vector<int32_t> innermostLoops;
+
+  /*
+   * The basic blocks of the function, each one followed by its successors
+   * and by nullptr.
+   */
+  std::vector<BasicBlock *> cfg;
+
+  static std::vector<BasicBlock *> computeCFG(Function &F);
+};
+
+} // namespace llvm::noelle
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/FunctionLoopSummary.hpp"
 
 namespace llvm::noelle {
 
@@ -29,6 +30,11 @@ class LoopStructure {
 public:
   LoopStructure(Loop *l);
 
+  /*
+   * Build the loop @loop of @summary without querying the LLVM loops again.
+   */
+  LoopStructure(std::shared_ptr<FunctionLoopSummary> summary, uint32_t loop);
+
   uint64_t getID(void) const;
 
   Function *getFunction(void) const;
@@ -72,6 +78,14 @@ public:
 
   void print(raw_ostream &stream);
 
+  /*
+   * Return the summary of the loops of the function that this loop has been
+   * built from, or nullptr if it has been built from an LLVM loop.
+   * The position of this loop in the summary is stored in @loop.
+   */
+  std::shared_ptr<FunctionLoopSummary> getFunctionLoopSummary(
+      uint32_t &loop) const;
+
 private:
   uint64_t ID;
   BasicBlock *header;
@@ -91,6 +105,13 @@ private:
   std::vector<BasicBlock *> exitBlocks;
   std::vector<std::pair<BasicBlock *, BasicBlock *>> exitEdges;
 
+  /*
+   * Summary this loop has been built from, if any, which makes the membership
+   * of basic blocks a lookup in its bitset.
+   */
+  std::shared_ptr<FunctionLoopSummary> summary;
+  uint32_t summaryLoop;
+
   static uint64_t globalID;
 
   void instantiateIDsAndBasicBlocks(Loop *llvmLoop);
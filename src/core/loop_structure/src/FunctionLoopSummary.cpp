@@ -0,0 +1,165 @@
+/*
+ * Copyright 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/FunctionLoopSummary.hpp"
+
+namespace llvm::noelle {
+
+FunctionLoopSummary::FunctionLoopSummary(Function &F, LoopInfo &LI)
+  : function{ &F },
+    cfg{ FunctionLoopSummary::computeCFG(F) } {
+
+  /*
+   * Index the basic blocks.
+   */
+  for (auto &bb : F) {
+    auto index = this->blockIndices.size();
+    this->blockIndices[&bb] = index;
+  }
+  this->innermostLoops.resize(this->blockIndices.size(), -1);
+
+  /*
+   * Summarize the loops.
+   * Parents precede their children in the preorder, so the innermost loops
+   * of the basic blocks are the last ones that contain them.
+   */
+  std::unordered_map<Loop *, int32_t> loopIndices;
+  for (auto l : LI.getLoopsInPreorder()) {
+    auto loopIndex = (int32_t)this->loops.size();
+    loopIndices[l] = loopIndex;
+
+    LoopSummary summary;
+    summary.header = l->getHeader();
+    summary.preHeader = l->getLoopPreheader();
+    summary.depth = l->getLoopDepth();
+    auto parentLoop = l->getParentLoop();
+    summary.parent =
+        (parentLoop != nullptr) ? loopIndices.at(parentLoop) : -1;
+    summary.blocks.resize(this->blockIndices.size());
+    for (auto bb : l->blocks()) {
+      auto bbIndex = this->blockIndices.at(bb);
+      summary.blocks.set(bbIndex);
+      summary.basicBlocks.push_back(bb);
+      this->innermostLoops[bbIndex] = loopIndex;
+      if (l->isLoopLatch(bb)) {
+        summary.latches.push_back(bb);
+      }
+    }
+
+    /*
+     * Keep the order of the exits of LLVM (see LoopStructure).
+     */
+    SmallVector<BasicBlock *, 10> exits;
+    l->getExitBlocks(exits);
+    summary.exitBlocks = std::vector<BasicBlock *>(exits.begin(), exits.end());
+    SmallVector<std::pair<BasicBlock *, BasicBlock *>, 10> exitEdges;
+    l->getExitEdges(exitEdges);
+    summary.exitEdges =
+        std::vector<std::pair<BasicBlock *, BasicBlock *>>(exitEdges.begin(),
+                                                           exitEdges.end());
+
+    this->loops.push_back(std::move(summary));
+  }
+
+  return;
+}
+
+Function *FunctionLoopSummary::getFunction(void) const {
+  return this->function;
+}
+
+bool FunctionLoopSummary::isUpToDate(void) const {
+  return this->cfg == FunctionLoopSummary::computeCFG(*this->function);
+}
+
+uint32_t FunctionLoopSummary::getNumberOfLoops(void) const {
+  return this->loops.size();
+}
+
+BasicBlock *FunctionLoopSummary::getHeader(uint32_t loop) const {
+  return this->loops[loop].header;
+}
+
+BasicBlock *FunctionLoopSummary::getPreHeader(uint32_t loop) const {
+  return this->loops[loop].preHeader;
+}
+
+uint32_t FunctionLoopSummary::getNestingLevel(uint32_t loop) const {
+  return this->loops[loop].depth;
+}
+
+int32_t FunctionLoopSummary::getParent(uint32_t loop) const {
+  return this->loops[loop].parent;
+}
+
+const std::vector<BasicBlock *> &FunctionLoopSummary::getBasicBlocks(
+    uint32_t loop) const {
+  return this->loops[loop].basicBlocks;
+}
+
+const std::vector<BasicBlock *> &FunctionLoopSummary::getLatches(
+    uint32_t loop) const {
+  return this->loops[loop].latches;
+}
+
+const std::vector<BasicBlock *> &FunctionLoopSummary::getExitBasicBlocks(
+    uint32_t loop) const {
+  return this->loops[loop].exitBlocks;
+}
+
+const std::vector<std::pair<BasicBlock *, BasicBlock *>>
+    &FunctionLoopSummary::getExitEdges(uint32_t loop) const {
+  return this->loops[loop].exitEdges;
+}
+
+bool FunctionLoopSummary::isIncluded(uint32_t loop, BasicBlock *bb) const {
+  auto bbIt = this->blockIndices.find(bb);
+  if (bbIt == this->blockIndices.end()) {
+    return false;
+  }
+
+  return this->loops[loop].blocks.test(bbIt->second);
+}
+
+int32_t FunctionLoopSummary::getInnermostLoopThatContains(
+    BasicBlock *bb) const {
+  auto bbIt = this->blockIndices.find(bb);
+  if (bbIt == this->blockIndices.end()) {
+    return -1;
+  }
+
+  return this->innermostLoops[bbIt->second];
+}
+
+std::vector<BasicBlock *> FunctionLoopSummary::computeCFG(Function &F) {
+  std::vector<BasicBlock *> cfg;
+  for (auto &bb : F) {
+    cfg.push_back(&bb);
+    for (auto succ : successors(&bb)) {
+      cfg.push_back(succ);
+    }
+    cfg.push_back(nullptr);
+  }
+
+  return cfg;
+}
+
+} // namespace llvm::noelle
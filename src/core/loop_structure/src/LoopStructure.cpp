@@ -25,7 +25,9 @@ namespace llvm::noelle {
 
 uint64_t LoopStructure::globalID = 0;
 
-LoopStructure::LoopStructure(Loop *l) {
+LoopStructure::LoopStructure(Loop *l)
+  : summary{ nullptr },
+    summaryLoop{ 0 } {
 
   /*
    * Set the nesting level
@@ -82,6 +84,34 @@ LoopStructure::LoopStructure(Loop *l) {
   return;
 }
 
+LoopStructure::LoopStructure(std::shared_ptr<FunctionLoopSummary> summary,
+                             uint32_t loop)
+  : summary{ summary },
+    summaryLoop{ loop } {
+
+  /*
+   * Fetch the loop from the summary.
+   */
+  this->depth = summary->getNestingLevel(loop);
+  this->header = summary->getHeader(loop);
+  this->preHeader = summary->getPreHeader(loop);
+  auto &bbs = summary->getBasicBlocks(loop);
+  this->bbs = std::unordered_set<BasicBlock *>(bbs.begin(), bbs.end());
+  auto &latches = summary->getLatches(loop);
+  this->latchBBs =
+      std::unordered_set<BasicBlock *>(latches.begin(), latches.end());
+  this->exitBlocks = summary->getExitBasicBlocks(loop);
+  this->exitEdges = summary->getExitEdges(loop);
+
+  /*
+   * LLVM considers loop invariant only the instructions outside the loop (see
+   * the constructor above), so there is no invariant to cache.
+   */
+  this->ID = LoopStructure::globalID++;
+
+  return;
+}
+
 BasicBlock *LoopStructure::getHeader(void) const {
   return this->header;
 }
@@ -213,6 +243,9 @@ bool LoopStructure::isContainedInstructionLoopInvariant(
 }
 
 bool LoopStructure::isIncluded(BasicBlock *bb) const {
+  if (this->summary != nullptr) {
+    return this->summary->isIncluded(this->summaryLoop, bb);
+  }
   auto found = this->bbs.find(bb) != this->bbs.end();
 
   return found;
@@ -233,6 +266,12 @@ void LoopStructure::print(raw_ostream &stream) {
   return;
 }
 
+std::shared_ptr<FunctionLoopSummary> LoopStructure::getFunctionLoopSummary(
+    uint32_t &loop) const {
+  loop = this->summaryLoop;
+  return this->summary;
+}
+
 uint64_t LoopStructure::getID(void) const {
   return this->ID;
 }
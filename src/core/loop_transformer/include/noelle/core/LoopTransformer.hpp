@@ -21,7 +21,10 @@
  */
 #pragma once
 
+#include "llvm/Analysis/LoopAccessAnalysis.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Transforms/Utils/LoopVersioning.h"
 #include "llvm/Transforms/Utils/UnrollLoop.h"
 
 #include "noelle/core/SystemHeaders.hpp"
@@ -41,6 +44,12 @@ public:
 
   bool fullyUnrollLoop(LoopDependenceInfo *loop);
 
+  /*
+   * Unroll the loop by @unrollFactor, generating a remainder loop for the
+   * iterations left over.
+   */
+  bool partiallyUnrollLoop(LoopDependenceInfo *loop, uint32_t unrollFactor);
+
   bool whilifyLoop(LoopDependenceInfo *loop);
 
   bool splitLoop(LoopDependenceInfo *loop,
@@ -48,6 +57,110 @@ public:
                  std::set<Instruction *> &instructionsRemoved,
                  std::set<Instruction *> &instructionsAdded);
 
+  /*
+   * Split the loop like above. The values the SCCs pulled out consume from the
+   * rest of the loop are forwarded through temporary arrays if
+   * @forwardDataDependences is true.
+   */
+  bool splitLoop(LoopDependenceInfo *loop,
+                 std::set<SCC *> const &SCCsToPullOut,
+                 std::set<Instruction *> &instructionsRemoved,
+                 std::set<Instruction *> &instructionsAdded,
+                 bool forwardDataDependences);
+
+  /*
+   * Clone the loop behind a runtime check that its pointers do not overlap.
+   * The memory accesses of the checked copy are tagged as not aliasing, while
+   * the original code runs when the check fails.
+   */
+  bool versionLoopWithAliasChecks(LoopDependenceInfo *loop);
+
+  /*
+   * Clone the loop behind a runtime check that each integer live-in of
+   * @values has the constant paired with it. The live-ins are replaced by
+   * their constants in the checked copy, while the original code runs when
+   * the check fails.
+   */
+  bool specializeLoop(
+      LoopDependenceInfo *loop,
+      std::vector<std::pair<Value *, ConstantInt *>> const &values);
+
+  /*
+   * Collapse a perfect nest of two loops with a rectangular iteration space
+   * into a single loop that iterates over the linearized space. The original
+   * indices are recovered at the beginning of every iteration.
+   */
+  bool collapseLoopNest(LoopDependenceInfo *loop);
+
+  /*
+   * Tile the inner loop of a perfect nest of two loops with a rectangular
+   * iteration space. The tiles, each one composed by @tileSize iterations of
+   * the inner loop, are iterated by a new loop that includes the nest.
+   */
+  bool tileLoopNest(LoopDependenceInfo *loop, uint64_t tileSize);
+
+  /*
+   * Interchange the two loops of a perfect nest with a rectangular iteration
+   * space: the outer loop iterates over the indices of the inner one, and
+   * vice versa. The legality of the new order of the iterations is left to
+   * the caller.
+   */
+  bool interchangeLoopNest(LoopDependenceInfo *loop);
+
+  /*
+   * Split a loop that traverses a linked list, and that exits when it reaches
+   * the null node, into a loop over chunks of @chunkSize nodes. Each chunk is
+   * first traversed into a buffer, and then the original loop iterates over
+   * the nodes of the buffer with a counted IV. Two buffers are used: the loop
+   * that traverses the next chunk into one of them follows the original loop,
+   * which reads the other one, and it is tagged with noelle.loop.chunk.fill.
+   */
+  bool chunkPointerChasingLoop(LoopDependenceInfo *loop, uint32_t chunkSize);
+
+  /*
+   * Fuse @secondLoop, which must start right after @firstLoop ends, into
+   * @firstLoop. The loops must execute the same number of iterations, and
+   * every iteration of the second loop must depend only on the same iteration
+   * of the first one.
+   */
+  bool fuseLoops(LoopDependenceInfo *firstLoop, LoopDependenceInfo *secondLoop);
+
+  /*
+   * Give each iteration of @loop its own copy of the @temporaries (allocas
+   * or global variables), which are accessed only by @loop. The copies are
+   * allocated on the heap before the loop starts and they are indexed by the
+   * number of the iteration. Each iteration must write a temporary before
+   * reading it, which is left to the caller to check.
+   * The loop is versioned: its original copy runs when the copies would take
+   * more than @maximumBytes or when they cannot be allocated.
+   */
+  bool expandTemporaries(LoopDependenceInfo *loop,
+                         std::unordered_set<Value *> const &temporaries,
+                         uint64_t maximumBytes);
+
+  /*
+   * Fetch the conditional branches of @loop that take one of their paths
+   * only in the first iteration (@firstIterationBranches) or only in the last
+   * one (@lastIterationBranches). These branches check whether an IV of the
+   * loop is equal to its start value or to the value it has in the last
+   * iteration.
+   */
+  void fetchBranchesOfConditionalIterations(
+      LoopDependenceInfo *loop,
+      std::set<BranchInst *> &firstIterationBranches,
+      std::set<BranchInst *> &lastIterationBranches);
+
+  /*
+   * Peel the first iteration of @loop if @firstIterationBranches is not
+   * empty, and the last one if @lastIterationBranches is not empty (see
+   * fetchBranchesOfConditionalIterations). The branches become unconditional
+   * in the loop that runs the remaining iterations.
+   */
+  bool peelConditionalIterations(
+      LoopDependenceInfo *loop,
+      std::set<BranchInst *> const &firstIterationBranches,
+      std::set<BranchInst *> const &lastIterationBranches);
+
   virtual ~LoopTransformer();
 
   bool doInitialization(Module &M) override;
@@ -58,6 +171,30 @@ public:
 
 private:
   PDG *pdg;
+
+  bool canIterationSpaceBeLinearized(Loop *nest,
+                                     LoopGoverningIVAttribution *GIV);
+
+  Value *generateCodeToComputeTheTripCount(IRBuilder<> &builder,
+                                           LoopStructure *loop,
+                                           InductionVariableManager *IVM,
+                                           LoopGoverningIVAttribution *GIV);
+
+  Value *generateCodeToComputeTheIVValue(IRBuilder<> &builder,
+                                         LoopGoverningIVAttribution *GIV,
+                                         Value *iteration);
+
+  /*
+   * Clone @loop before it. The clone runs the iterations until the IV of @GIV
+   * has @switchValue at the beginning of an iteration. Then, @loop runs from
+   * that iteration on.
+   */
+  Loop *peelIterationsOfLoop(Loop *loop,
+                             LoopGoverningIVAttribution *GIV,
+                             Value *switchValue,
+                             ValueToValueMapTy &VMap,
+                             LoopInfo &LLVMLoops,
+                             DominatorTree &DT);
 };
 
 } // namespace llvm::noelle
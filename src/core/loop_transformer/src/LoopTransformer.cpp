@@ -24,6 +24,7 @@
 #include "noelle/core/LoopWhilify.hpp"
 #include "noelle/core/LoopUnroll.hpp"
 #include "noelle/core/LoopDistribution.hpp"
+#include "noelle/core/LoopFusion.hpp"
 
 namespace llvm::noelle {
 
@@ -111,6 +112,30 @@ bool LoopTransformer::fullyUnrollLoop(LoopDependenceInfo *loop) {
   return modified;
 }
 
+bool LoopTransformer::partiallyUnrollLoop(LoopDependenceInfo *loop,
+                                          uint32_t unrollFactor) {
+
+  /*
+   * Fetch the unroller
+   */
+  auto loopUnroll = LoopUnroll();
+
+  /*
+   * Fetch the function
+   */
+  auto ls = loop->getLoopStructure();
+  auto &loopFunction = *ls->getFunction();
+  auto &LS = getAnalysis<LoopInfoWrapperPass>(loopFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(loopFunction).getDomTree();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(loopFunction).getSE();
+  auto &AC =
+      getAnalysis<AssumptionCacheTracker>().getAssumptionCache(loopFunction);
+  auto modified =
+      loopUnroll.partiallyUnrollLoop(*loop, unrollFactor, LS, DT, SE, AC);
+
+  return modified;
+}
+
 bool LoopTransformer::whilifyLoop(LoopDependenceInfo *loop) {
   assert(this->pdg != nullptr);
 
@@ -138,14 +163,2392 @@ bool LoopTransformer::whilifyLoop(LoopDependenceInfo *loop) {
   return modified;
 }
 
-LoopTransformer::~LoopTransformer() {
-  return;
+bool LoopTransformer::versionLoopWithAliasChecks(LoopDependenceInfo *loop) {
+
+  /*
+   * Fetch the function that contains the loop we want to version.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+  auto &AA = getAnalysis<AAResultsWrapperPass>(*lsFunction).getAAResults();
+  auto &TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
+
+  /*
+   * Fetch the LLVM loop.
+   */
+  auto h = ls->getHeader();
+  auto llvmLoop = LLVMLoops.getLoopFor(h);
+  assert(llvmLoop != nullptr);
+
+  /*
+   * Loops are versioned only once: neither the checked copy nor the fallback
+   * one can benefit from another versioning.
+   */
+  if (getBooleanLoopAttribute(llvmLoop, "noelle.loop.versioned")) {
+    return false;
+  }
+
+  /*
+   * The versioning requires the loop to be in its canonical form.
+   */
+  if (false || (!llvmLoop->isLoopSimplifyForm())
+      || (!llvmLoop->isRecursivelyLCSSAForm(DT, LLVMLoops))) {
+    return false;
+  }
+
+  /*
+   * Compute the checks needed to prove that the pointers of the loop do not
+   * overlap.
+   * The versioning is worth it only if these checks are enough to remove all
+   * memory dependences that are carried between iterations.
+   */
+  LoopAccessInfo LAI(llvmLoop, &SE, &TLI, &AA, &DT, &LLVMLoops);
+  if (false || (!LAI.canVectorizeMemory())
+      || (LAI.getNumRuntimePointerChecks() == 0)) {
+    return false;
+  }
+
+  /*
+   * Version the loop.
+   * The original loop becomes the checked copy; the pointers it accesses are
+   * tagged with the scoped no-alias metadata, which the dependence analyses
+   * rely on to drop the may-alias dependences.
+   */
+  LoopVersioning versioning(LAI, llvmLoop, &LLVMLoops, &DT, &SE);
+  versioning.versionLoop();
+  versioning.annotateLoopWithNoAlias();
+  addStringMetadataToLoop(versioning.getVersionedLoop(),
+                          "noelle.loop.versioned",
+                          1);
+  addStringMetadataToLoop(versioning.getNonVersionedLoop(),
+                          "noelle.loop.versioned",
+                          1);
+
+  return true;
 }
 
-bool LoopTransformer::splitLoop(LoopDependenceInfo *loop,
-                                std::set<SCC *> const &SCCsToPullOut,
-                                std::set<Instruction *> &instructionsRemoved,
-                                std::set<Instruction *> &instructionsAdded) {
+bool LoopTransformer::specializeLoop(
+    LoopDependenceInfo *loop,
+    std::vector<std::pair<Value *, ConstantInt *>> const &values) {
+  if (values.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Fetch the function that contains the loop we want to specialize.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+
+  /*
+   * Fetch the LLVM loop.
+   */
+  auto h = ls->getHeader();
+  auto llvmLoop = LLVMLoops.getLoopFor(h);
+  assert(llvmLoop != nullptr);
+
+  /*
+   * Loops are specialized only once: the checked copy has constants already,
+   * and the fallback one runs only when the profiled values do not occur.
+   */
+  if (getBooleanLoopAttribute(llvmLoop, "noelle.loop.specialized")) {
+    return false;
+  }
+
+  /*
+   * The specialization requires the loop to be in its canonical form, so
+   * the values the loop produces reach the rest of the function only
+   * through the PHIs of its dedicated exits.
+   */
+  if (false || (!llvmLoop->isLoopSimplifyForm())
+      || (!llvmLoop->isRecursivelyLCSSAForm(DT, LLVMLoops))) {
+    return false;
+  }
+
+  /*
+   * The values to check must be available before the loop starts.
+   */
+  for (auto &pair : values) {
+    auto liveIn = pair.first;
+    if (liveIn->getType() != pair.second->getType()) {
+      return false;
+    }
+    if (auto liveInInst = dyn_cast<Instruction>(liveIn)) {
+      if (llvmLoop->contains(liveInInst)) {
+        return false;
+      }
+    }
+  }
+
+  /*
+   * Clone the loop.
+   * The pre-header of the loop becomes the block that checks the values,
+   * and the clone gets its own pre-header.
+   */
+  auto checkBB = llvmLoop->getLoopPreheader();
+  auto preHeader =
+      SplitBlock(checkBB, checkBB->getTerminator(), &DT, &LLVMLoops);
+  ValueToValueMapTy VMap;
+  SmallVector<BasicBlock *, 8> specializedBlocks;
+  auto specializedLoop = cloneLoopWithPreheader(preHeader,
+                                                checkBB,
+                                                llvmLoop,
+                                                VMap,
+                                                ".specialized",
+                                                &LLVMLoops,
+                                                &DT,
+                                                specializedBlocks);
+  remapInstructionsInBlocks(specializedBlocks, VMap);
+
+  /*
+   * Propagate the values produced by the clone to the exits of the loop.
+   */
+  SmallVector<BasicBlock *, 4> exitBlocks;
+  llvmLoop->getUniqueExitBlocks(exitBlocks);
+  for (auto exitBlock : exitBlocks) {
+    for (auto &phi : exitBlock->phis()) {
+      auto numberOfIncomingValues = phi.getNumIncomingValues();
+      for (auto i = 0u; i < numberOfIncomingValues; i++) {
+        auto incomingBB = phi.getIncomingBlock(i);
+        if (!llvmLoop->contains(incomingBB)) {
+          continue;
+        }
+        Value *incomingValue = phi.getIncomingValue(i);
+        if (VMap.count(incomingValue) > 0) {
+          incomingValue = VMap[incomingValue];
+        }
+        phi.addIncoming(incomingValue, cast<BasicBlock>(VMap[incomingBB]));
+      }
+    }
+  }
+
+  /*
+   * Specialize the clone.
+   */
+  for (auto bb : specializedBlocks) {
+    for (auto &I : *bb) {
+      for (auto &pair : values) {
+        I.replaceUsesOfWith(pair.first, pair.second);
+      }
+    }
+  }
+
+  /*
+   * Check the values before the loop starts.
+   */
+  auto originalTerminator = checkBB->getTerminator();
+  IRBuilder<> builder{ originalTerminator };
+  Value *areTheValuesExpected = nullptr;
+  for (auto &pair : values) {
+    auto isTheValueExpected = builder.CreateICmpEQ(pair.first, pair.second);
+    areTheValuesExpected =
+        (areTheValuesExpected == nullptr)
+            ? isTheValueExpected
+            : builder.CreateAnd(areTheValuesExpected, isTheValueExpected);
+  }
+  builder.CreateCondBr(areTheValuesExpected,
+                       specializedLoop->getLoopPreheader(),
+                       preHeader);
+  originalTerminator->eraseFromParent();
+  DT.recalculate(*lsFunction);
+
+  /*
+   * Tag both copies.
+   */
+  addStringMetadataToLoop(llvmLoop, "noelle.loop.specialized", 1);
+  addStringMetadataToLoop(specializedLoop, "noelle.loop.specialized", 1);
+
+  return true;
+}
+
+bool LoopTransformer::collapseLoopNest(LoopDependenceInfo *loop) {
+
+  /*
+   * Fetch the function that contains the loop nest we want to collapse.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+
+  /*
+   * Fetch the LLVM loops of the nest.
+   * The nest must be composed by two loops: the outer one includes only the
+   * inner one, which includes no other loop.
+   */
+  auto outerLoop = LLVMLoops.getLoopFor(ls->getHeader());
+  assert(outerLoop != nullptr);
+  if (getBooleanLoopAttribute(outerLoop, "noelle.loop.collapsed")) {
+    return false;
+  }
+  if (outerLoop->getSubLoops().size() != 1) {
+    return false;
+  }
+  auto innerLoop = outerLoop->getSubLoops()[0];
+  if (innerLoop->getSubLoops().size() != 0) {
+    return false;
+  }
+  auto loopNode = loop->getLoopHierarchyStructures();
+  auto children = loopNode->getChildren();
+  if (children.size() != 1) {
+    return false;
+  }
+  auto innerLS = (*children.begin())->getLoop();
+  if (innerLS->getHeader() != innerLoop->getHeader()) {
+    return false;
+  }
+
+  /*
+   * Both loops must be in their canonical form and they must leave only from
+   * their headers.
+   */
+  for (auto l : { outerLoop, innerLoop }) {
+    if (false || (!l->isLoopSimplifyForm())
+        || (l->getExitingBlock() != l->getHeader())
+        || (l->getExitBlock() == nullptr)) {
+      return false;
+    }
+  }
+  if (!outerLoop->isRecursivelyLCSSAForm(DT, LLVMLoops)) {
+    return false;
+  }
+
+  /*
+   * Fetch the loop-governing IVs of both loops.
+   * The iteration space of the nest must be rectangular.
+   */
+  auto IVM = loop->getInductionVariableManager();
+  auto outerGIV = IVM->getLoopGoverningIVAttribution(*ls);
+  auto innerGIV = IVM->getLoopGoverningIVAttribution(*innerLS);
+  if (false || (outerGIV == nullptr) || (innerGIV == nullptr)) {
+    return false;
+  }
+  auto isDefinedBeforeTheNest = [outerLoop](Value *v) -> bool {
+    auto inst = dyn_cast<Instruction>(v);
+    return (inst == nullptr) || (!outerLoop->contains(inst));
+  };
+  if (false || (!this->canIterationSpaceBeLinearized(outerLoop, outerGIV))
+      || (!this->canIterationSpaceBeLinearized(outerLoop, innerGIV))) {
+    return false;
+  }
+  auto outerPHI = outerGIV->getInductionVariable().getLoopEntryPHI();
+  auto innerPHI = innerGIV->getInductionVariable().getLoopEntryPHI();
+
+  /*
+   * Fetch the basic blocks of the nest.
+   * The outer loop must be composed by its header, the pre-header of the inner
+   * loop, the inner loop, its exit, and the latch of the outer loop.
+   */
+  auto outerPreHeader = outerLoop->getLoopPreheader();
+  auto outerHeader = outerLoop->getHeader();
+  auto outerLatch = outerLoop->getLoopLatch();
+  auto outerExit = outerLoop->getExitBlock();
+  auto innerPreHeader = innerLoop->getLoopPreheader();
+  auto innerHeader = innerLoop->getHeader();
+  auto innerLatch = innerLoop->getLoopLatch();
+  auto innerExit = innerLoop->getExitBlock();
+  auto innerHeaderBr = innerGIV->getHeaderBrInst();
+  auto innerBody = innerHeaderBr->getSuccessor(0);
+  if (innerBody == innerExit) {
+    innerBody = innerHeaderBr->getSuccessor(1);
+  }
+  std::unordered_set<BasicBlock *> outerBlocks{ outerHeader,
+                                                innerPreHeader,
+                                                innerExit,
+                                                outerLatch };
+  if (false || (innerLatch == innerHeader)
+      || (innerPreHeader->getSinglePredecessor() != outerHeader)
+      || (innerExit->getSingleSuccessor()
+          != ((innerExit == outerLatch) ? outerHeader : outerLatch))
+      || (outerLoop->getNumBlocks()
+          != (innerLoop->getNumBlocks() + outerBlocks.size()))) {
+    return false;
+  }
+  for (auto bb : outerBlocks) {
+    if (!outerLoop->contains(bb) || innerLoop->contains(bb)) {
+      return false;
+    }
+  }
+
+  /*
+   * Check that the nest is perfect.
+   *
+   * Values carried by both loops (e.g., a reduction over the whole nest) are
+   * allowed. These are PHIs of the outer header that initialize a PHI of the
+   * inner header, which in turn flows back to the outer header through the
+   * exit of the inner loop.
+   */
+  std::unordered_map<PHINode *, PHINode *> carriedValues;
+  for (auto &phi : outerHeader->phis()) {
+    if (&phi == outerPHI) {
+      continue;
+    }
+    auto lcssaPHI =
+        dyn_cast<PHINode>(phi.getIncomingValueForBlock(outerLatch));
+    if (false || (lcssaPHI == nullptr) || (lcssaPHI->getParent() != innerExit)
+        || (lcssaPHI->getNumIncomingValues() != 1)) {
+      return false;
+    }
+    auto innerCarriedPHI = dyn_cast<PHINode>(lcssaPHI->getIncomingValue(0));
+    if (false || (innerCarriedPHI == nullptr)
+        || (innerCarriedPHI->getParent() != innerHeader)
+        || (innerCarriedPHI->getIncomingValueForBlock(innerPreHeader)
+            != &phi)) {
+      return false;
+    }
+    for (auto user : phi.users()) {
+      auto userInst = cast<Instruction>(user);
+      if (true && (userInst != innerCarriedPHI)
+          && (userInst->getParent() != outerExit)) {
+        return false;
+      }
+    }
+    carriedValues[innerCarriedPHI] = &phi;
+  }
+  for (auto &phi : innerHeader->phis()) {
+    if (true && (&phi != innerPHI) && (carriedValues.count(&phi) == 0)) {
+      return false;
+    }
+  }
+  for (auto &phi : innerExit->phis()) {
+    for (auto user : phi.users()) {
+      auto userPHI = dyn_cast<PHINode>(user);
+      if (false || (userPHI == nullptr)
+          || (userPHI->getParent() != outerHeader)) {
+        return false;
+      }
+    }
+  }
+  for (auto &phi : outerExit->phis()) {
+    auto exitValue = phi.getIncomingValueForBlock(outerHeader);
+    auto exitPHI = dyn_cast<PHINode>(exitValue);
+    if (true && (!isDefinedBeforeTheNest(exitValue))
+        && ((exitPHI == nullptr) || (exitPHI == outerPHI)
+            || (exitPHI->getParent() != outerHeader))) {
+      return false;
+    }
+  }
+
+  /*
+   * The rest of the code of the outer loop, and the one of the header of the
+   * inner loop, must be free of side effects. This code is recomputed at every
+   * iteration of the collapsed loop.
+   * The code that follows the inner loop must only update the outer IV.
+   */
+  auto &outerIV = outerGIV->getInductionVariable();
+  std::vector<Instruction *> instructionsToMove;
+  for (auto bb : { outerHeader, innerPreHeader, innerHeader }) {
+    for (auto &I : *bb) {
+      if (false || isa<PHINode>(&I) || I.isTerminator()) {
+        continue;
+      }
+      if (false || I.mayHaveSideEffects() || I.mayReadFromMemory()
+          || isa<AllocaInst>(&I)) {
+        return false;
+      }
+      instructionsToMove.push_back(&I);
+    }
+  }
+  for (auto bb : { innerExit, outerLatch }) {
+    for (auto &I : *bb) {
+      if (false || isa<PHINode>(&I) || I.isTerminator()) {
+        continue;
+      }
+      if (!outerIV.isIVInstruction(&I)) {
+        return false;
+      }
+    }
+  }
+
+  /*
+   * The information the scalar evolution has about the nest is going to be
+   * stale.
+   */
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+  SE.forgetLoop(outerLoop);
+
+  /*
+   * Compute the trip counts of the two loops before the nest starts.
+   */
+  auto &cxt = lsFunction->getContext();
+  auto int64 = IntegerType::get(cxt, 64);
+  auto zero = ConstantInt::get(int64, 0);
+  IRBuilder<> preHeaderBuilder{ outerPreHeader->getTerminator() };
+  auto outerTripCount =
+      this->generateCodeToComputeTheTripCount(preHeaderBuilder,
+                                              ls,
+                                              IVM,
+                                              outerGIV);
+  auto innerTripCount =
+      this->generateCodeToComputeTheTripCount(preHeaderBuilder,
+                                              innerLS,
+                                              IVM,
+                                              innerGIV);
+  auto tripCount = preHeaderBuilder.CreateMul(outerTripCount, innerTripCount);
+
+  /*
+   * The header of the inner loop becomes the header of the collapsed loop.
+   * Its IV linearizes the iteration space of the nest.
+   */
+  auto collapsedIV = PHINode::Create(int64, 2, "", &*innerHeader->begin());
+  IRBuilder<> latchBuilder{ innerLatch->getTerminator() };
+  auto collapsedIVNext =
+      latchBuilder.CreateAdd(collapsedIV, ConstantInt::get(int64, 1));
+  collapsedIV->addIncoming(zero, outerPreHeader);
+  collapsedIV->addIncoming(collapsedIVNext, innerLatch);
+  outerPreHeader->getTerminator()->replaceUsesOfWith(outerHeader, innerHeader);
+  for (auto &pair : carriedValues) {
+    auto innerCarriedPHI = pair.first;
+    auto outerCarriedPHI = pair.second;
+    auto index = innerCarriedPHI->getBasicBlockIndex(innerPreHeader);
+    innerCarriedPHI->setIncomingBlock(index, outerPreHeader);
+    innerCarriedPHI->setIncomingValue(
+        index,
+        outerCarriedPHI->getIncomingValueForBlock(outerPreHeader));
+  }
+
+  /*
+   * Exit the collapsed loop once all iterations of the nest have been
+   * executed.
+   */
+  auto collapsedBody = BasicBlock::Create(cxt, "", lsFunction, innerBody);
+  IRBuilder<> headerBuilder{ innerHeaderBr };
+  auto isWithinTheSpace = headerBuilder.CreateICmpULT(collapsedIV, tripCount);
+  headerBuilder.CreateCondBr(isWithinTheSpace, collapsedBody, outerExit);
+  innerHeaderBr->eraseFromParent();
+  for (auto &phi : innerBody->phis()) {
+    auto index = phi.getBasicBlockIndex(innerHeader);
+    phi.setIncomingBlock(index, collapsedBody);
+  }
+  for (auto &phi : outerExit->phis()) {
+    auto index = phi.getBasicBlockIndex(outerHeader);
+    auto exitPHI = dyn_cast<PHINode>(phi.getIncomingValue(index));
+    phi.setIncomingBlock(index, innerHeader);
+    if (true && (exitPHI != nullptr) && (exitPHI->getParent() == outerHeader)) {
+      for (auto &pair : carriedValues) {
+        if (pair.second == exitPHI) {
+          phi.setIncomingValue(index, pair.first);
+        }
+      }
+    }
+  }
+
+  /*
+   * Recover the original indices at the beginning of the body of the
+   * collapsed loop, followed by the code of the outer loop they rely on.
+   */
+  IRBuilder<> bodyBuilder{ collapsedBody };
+  auto bodyBr = bodyBuilder.CreateBr(innerBody);
+  bodyBuilder.SetInsertPoint(bodyBr);
+  auto outerIteration = bodyBuilder.CreateUDiv(collapsedIV, innerTripCount);
+  auto innerIteration = bodyBuilder.CreateURem(collapsedIV, innerTripCount);
+  auto outerIndex = this->generateCodeToComputeTheIVValue(bodyBuilder,
+                                                          outerGIV,
+                                                          outerIteration);
+  auto innerIndex = this->generateCodeToComputeTheIVValue(bodyBuilder,
+                                                          innerGIV,
+                                                          innerIteration);
+  for (auto I : instructionsToMove) {
+    I->moveBefore(bodyBr);
+  }
+  auto innerIVUpdate = dyn_cast<Instruction>(
+      innerPHI->getIncomingValueForBlock(innerLatch));
+  outerPHI->replaceAllUsesWith(outerIndex);
+  innerPHI->replaceAllUsesWith(innerIndex);
+  innerPHI->eraseFromParent();
+  if (true && (innerIVUpdate != nullptr)
+      && (innerIVUpdate->getParent() != collapsedBody)
+      && innerIVUpdate->use_empty()) {
+    innerIVUpdate->eraseFromParent();
+  }
+
+  /*
+   * Remove the code of the outer loop that is not needed anymore.
+   */
+  std::vector<BasicBlock *> deadBlocks{ outerBlocks.begin(),
+                                        outerBlocks.end() };
+  for (auto bb : deadBlocks) {
+    for (auto &I : *bb) {
+      if (!I.use_empty()) {
+        I.replaceAllUsesWith(UndefValue::get(I.getType()));
+      }
+    }
+  }
+  for (auto bb : deadBlocks) {
+    bb->dropAllReferences();
+  }
+  for (auto bb : deadBlocks) {
+    bb->eraseFromParent();
+  }
+  for (auto it = instructionsToMove.rbegin(); it != instructionsToMove.rend();
+       it++) {
+    auto I = *it;
+    if (I->use_empty()) {
+      I->eraseFromParent();
+    }
+  }
+
+  /*
+   * Update the LLVM loop abstractions and tag the collapsed loop.
+   */
+  DT.recalculate(*lsFunction);
+  LLVMLoops.releaseMemory();
+  LLVMLoops.analyze(DT);
+  auto collapsedLoop = LLVMLoops.getLoopFor(innerHeader);
+  assert(collapsedLoop != nullptr);
+  addStringMetadataToLoop(collapsedLoop, "noelle.loop.collapsed", 1);
+
+  return true;
+}
+
+bool LoopTransformer::tileLoopNest(LoopDependenceInfo *loop,
+                                   uint64_t tileSize) {
+  if (tileSize < 2) {
+    return false;
+  }
+
+  /*
+   * Fetch the function that contains the loop nest we want to tile.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+
+  /*
+   * Fetch the LLVM loops of the nest.
+   * The nest must be composed by two loops: the outer one includes only the
+   * inner one, which includes no other loop.
+   */
+  auto outerLoop = LLVMLoops.getLoopFor(ls->getHeader());
+  assert(outerLoop != nullptr);
+  if (getBooleanLoopAttribute(outerLoop, "noelle.loop.tiled")) {
+    return false;
+  }
+  if (outerLoop->getSubLoops().size() != 1) {
+    return false;
+  }
+  auto innerLoop = outerLoop->getSubLoops()[0];
+  if (innerLoop->getSubLoops().size() != 0) {
+    return false;
+  }
+  auto loopNode = loop->getLoopHierarchyStructures();
+  auto children = loopNode->getChildren();
+  if (children.size() != 1) {
+    return false;
+  }
+  auto innerLS = (*children.begin())->getLoop();
+  if (innerLS->getHeader() != innerLoop->getHeader()) {
+    return false;
+  }
+
+  /*
+   * Both loops must be in their canonical form and they must leave only from
+   * their headers.
+   */
+  for (auto l : { outerLoop, innerLoop }) {
+    if (false || (!l->isLoopSimplifyForm())
+        || (l->getExitingBlock() != l->getHeader())
+        || (l->getExitBlock() == nullptr)) {
+      return false;
+    }
+  }
+  if (!outerLoop->isRecursivelyLCSSAForm(DT, LLVMLoops)) {
+    return false;
+  }
+
+  /*
+   * Fetch the loop-governing IVs of both loops.
+   * The iteration space of the nest must be rectangular.
+   */
+  auto IVM = loop->getInductionVariableManager();
+  auto outerGIV = IVM->getLoopGoverningIVAttribution(*ls);
+  auto innerGIV = IVM->getLoopGoverningIVAttribution(*innerLS);
+  if (false || (outerGIV == nullptr) || (innerGIV == nullptr)) {
+    return false;
+  }
+  if (false || (!this->canIterationSpaceBeLinearized(outerLoop, outerGIV))
+      || (!this->canIterationSpaceBeLinearized(outerLoop, innerGIV))) {
+    return false;
+  }
+  auto outerPHI = outerGIV->getInductionVariable().getLoopEntryPHI();
+  auto innerPHI = innerGIV->getInductionVariable().getLoopEntryPHI();
+
+  /*
+   * Fetch the basic blocks of the nest.
+   * The outer loop must be composed by its header, the pre-header of the inner
+   * loop, the inner loop, its exit, and the latch of the outer loop.
+   */
+  auto outerPreHeader = outerLoop->getLoopPreheader();
+  auto outerHeader = outerLoop->getHeader();
+  auto outerLatch = outerLoop->getLoopLatch();
+  auto outerExit = outerLoop->getExitBlock();
+  auto innerPreHeader = innerLoop->getLoopPreheader();
+  auto innerHeader = innerLoop->getHeader();
+  auto innerLatch = innerLoop->getLoopLatch();
+  auto innerExit = innerLoop->getExitBlock();
+  auto innerHeaderBr = innerGIV->getHeaderBrInst();
+  auto innerBody = innerHeaderBr->getSuccessor(0);
+  if (innerBody == innerExit) {
+    innerBody = innerHeaderBr->getSuccessor(1);
+  }
+  std::unordered_set<BasicBlock *> outerBlocks{ outerHeader,
+                                                innerPreHeader,
+                                                innerExit,
+                                                outerLatch };
+  if (false || (innerLatch == innerHeader)
+      || (innerPreHeader->getSinglePredecessor() != outerHeader)
+      || (outerLoop->getNumBlocks()
+          != (innerLoop->getNumBlocks() + outerBlocks.size()))) {
+    return false;
+  }
+  for (auto bb : outerBlocks) {
+    if (!outerLoop->contains(bb) || innerLoop->contains(bb)) {
+      return false;
+    }
+  }
+
+  /*
+   * Check that the nest is perfect.
+   * The loops must not carry values other than their IVs, and the nest must
+   * produce only values computed before it starts.
+   */
+  for (auto &phi : outerHeader->phis()) {
+    if (&phi != outerPHI) {
+      return false;
+    }
+  }
+  for (auto &phi : innerHeader->phis()) {
+    if (&phi != innerPHI) {
+      return false;
+    }
+  }
+  for (auto &phi : innerExit->phis()) {
+    if (!phi.use_empty()) {
+      return false;
+    }
+  }
+  for (auto &phi : outerExit->phis()) {
+    auto exitValue =
+        dyn_cast<Instruction>(phi.getIncomingValueForBlock(outerHeader));
+    if (true && (exitValue != nullptr) && outerLoop->contains(exitValue)) {
+      return false;
+    }
+  }
+
+  /*
+   * The rest of the code of the outer loop, and the one of the header of the
+   * inner loop, must be free of side effects. This code is executed again for
+   * every tile.
+   * The code that follows the inner loop must only update the outer IV.
+   */
+  auto &outerIV = outerGIV->getInductionVariable();
+  std::vector<Instruction *> instructionsToMove;
+  for (auto bb : { outerHeader, innerPreHeader, innerHeader }) {
+    for (auto &I : *bb) {
+      if (false || isa<PHINode>(&I) || I.isTerminator()) {
+        continue;
+      }
+      if (false || I.mayHaveSideEffects() || I.mayReadFromMemory()
+          || isa<AllocaInst>(&I)) {
+        return false;
+      }
+      if (bb == innerHeader) {
+        instructionsToMove.push_back(&I);
+      }
+    }
+  }
+  for (auto bb : { innerExit, outerLatch }) {
+    for (auto &I : *bb) {
+      if (false || isa<PHINode>(&I) || I.isTerminator()) {
+        continue;
+      }
+      if (!outerIV.isIVInstruction(&I)) {
+        return false;
+      }
+    }
+  }
+
+  /*
+   * The information the scalar evolution has about the nest is going to be
+   * stale.
+   */
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+  SE.forgetLoop(outerLoop);
+
+  /*
+   * Compute the number of tiles before the nest starts.
+   * The last tile can include fewer iterations of the inner loop.
+   */
+  auto &cxt = lsFunction->getContext();
+  auto int64 = IntegerType::get(cxt, 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto one = ConstantInt::get(int64, 1);
+  auto tileSizeValue = ConstantInt::get(int64, tileSize);
+  IRBuilder<> preHeaderBuilder{ outerPreHeader->getTerminator() };
+  auto innerTripCount =
+      this->generateCodeToComputeTheTripCount(preHeaderBuilder,
+                                              innerLS,
+                                              IVM,
+                                              innerGIV);
+  auto numberOfTiles = preHeaderBuilder.CreateUDiv(
+      preHeaderBuilder.CreateAdd(innerTripCount,
+                                 ConstantInt::get(int64, tileSize - 1)),
+      tileSizeValue);
+
+  /*
+   * Add the loop that iterates over the tiles around the nest.
+   * Each of its iterations executes the whole outer loop, whose inner loop
+   * iterates only over the current tile.
+   */
+  auto tileHeader = BasicBlock::Create(cxt, "", lsFunction, outerHeader);
+  auto tileBody = BasicBlock::Create(cxt, "", lsFunction, outerHeader);
+  auto tileLatch = BasicBlock::Create(cxt, "", lsFunction, outerExit);
+  IRBuilder<> tileHeaderBuilder{ tileHeader };
+  auto tileIV = tileHeaderBuilder.CreatePHI(int64, 2);
+  auto isWithinTheTiles =
+      tileHeaderBuilder.CreateICmpULT(tileIV, numberOfTiles);
+  tileHeaderBuilder.CreateCondBr(isWithinTheTiles, tileBody, outerExit);
+  IRBuilder<> tileBodyBuilder{ tileBody };
+  auto tileStart = tileBodyBuilder.CreateMul(tileIV, tileSizeValue);
+  auto nextTileStart = tileBodyBuilder.CreateAdd(tileStart, tileSizeValue);
+  auto tileEnd = tileBodyBuilder.CreateSelect(
+      tileBodyBuilder.CreateICmpULT(nextTileStart, innerTripCount),
+      nextTileStart,
+      innerTripCount);
+  tileBodyBuilder.CreateBr(outerHeader);
+  IRBuilder<> tileLatchBuilder{ tileLatch };
+  auto tileIVNext = tileLatchBuilder.CreateAdd(tileIV, one);
+  tileLatchBuilder.CreateBr(tileHeader);
+  tileIV->addIncoming(zero, outerPreHeader);
+  tileIV->addIncoming(tileIVNext, tileLatch);
+
+  /*
+   * Link the loop of the tiles with the outer loop.
+   */
+  outerPreHeader->getTerminator()->replaceUsesOfWith(outerHeader, tileHeader);
+  outerPHI->setIncomingBlock(outerPHI->getBasicBlockIndex(outerPreHeader),
+                             tileBody);
+  outerHeader->getTerminator()->replaceUsesOfWith(outerExit, tileLatch);
+  for (auto &phi : outerExit->phis()) {
+    auto index = phi.getBasicBlockIndex(outerHeader);
+    phi.setIncomingBlock(index, tileHeader);
+  }
+
+  /*
+   * The inner loop iterates over the current tile.
+   * Its original IV is recovered at the beginning of its body.
+   */
+  std::vector<PHINode *> innerExitPHIs;
+  for (auto &phi : innerExit->phis()) {
+    innerExitPHIs.push_back(&phi);
+  }
+  for (auto phi : innerExitPHIs) {
+    phi->eraseFromParent();
+  }
+  auto innerIteration = PHINode::Create(int64, 2, "", &*innerHeader->begin());
+  IRBuilder<> latchBuilder{ innerLatch->getTerminator() };
+  auto innerIterationNext = latchBuilder.CreateAdd(innerIteration, one);
+  innerIteration->addIncoming(tileStart, innerPreHeader);
+  innerIteration->addIncoming(innerIterationNext, innerLatch);
+  auto tileInnerBody = BasicBlock::Create(cxt, "", lsFunction, innerBody);
+  IRBuilder<> headerBuilder{ innerHeaderBr };
+  auto isWithinTheTile = headerBuilder.CreateICmpULT(innerIteration, tileEnd);
+  headerBuilder.CreateCondBr(isWithinTheTile, tileInnerBody, innerExit);
+  innerHeaderBr->eraseFromParent();
+  for (auto &phi : innerBody->phis()) {
+    auto index = phi.getBasicBlockIndex(innerHeader);
+    phi.setIncomingBlock(index, tileInnerBody);
+  }
+  IRBuilder<> bodyBuilder{ tileInnerBody };
+  auto bodyBr = bodyBuilder.CreateBr(innerBody);
+  bodyBuilder.SetInsertPoint(bodyBr);
+  auto innerIndex = this->generateCodeToComputeTheIVValue(bodyBuilder,
+                                                          innerGIV,
+                                                          innerIteration);
+  for (auto I : instructionsToMove) {
+    I->moveBefore(bodyBr);
+  }
+  auto innerIVUpdate = dyn_cast<Instruction>(
+      innerPHI->getIncomingValueForBlock(innerLatch));
+  innerPHI->replaceAllUsesWith(innerIndex);
+  innerPHI->eraseFromParent();
+  if (true && (innerIVUpdate != nullptr)
+      && (innerIVUpdate->getParent() != tileInnerBody)
+      && innerIVUpdate->use_empty()) {
+    innerIVUpdate->eraseFromParent();
+  }
+  for (auto it = instructionsToMove.rbegin(); it != instructionsToMove.rend();
+       it++) {
+    auto I = *it;
+    if (I->use_empty()) {
+      I->eraseFromParent();
+    }
+  }
+
+  /*
+   * Update the LLVM loop abstractions and tag the loops of the tiled nest.
+   */
+  DT.recalculate(*lsFunction);
+  LLVMLoops.releaseMemory();
+  LLVMLoops.analyze(DT);
+  for (auto header : { tileHeader, outerHeader }) {
+    auto tiledLoop = LLVMLoops.getLoopFor(header);
+    assert(tiledLoop != nullptr);
+    addStringMetadataToLoop(tiledLoop, "noelle.loop.tiled", 1);
+  }
+
+  return true;
+}
+
+bool LoopTransformer::interchangeLoopNest(LoopDependenceInfo *loop) {
+
+  /*
+   * Fetch the function that contains the loop nest we want to interchange.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+
+  /*
+   * Fetch the LLVM loops of the nest.
+   * The nest must be composed by two loops: the outer one includes only the
+   * inner one, which includes no other loop.
+   * Nests that have been tiled or interchanged already are left untouched.
+   */
+  auto outerLoop = LLVMLoops.getLoopFor(ls->getHeader());
+  assert(outerLoop != nullptr);
+  if (false || getBooleanLoopAttribute(outerLoop, "noelle.loop.tiled")
+      || getBooleanLoopAttribute(outerLoop, "noelle.loop.interchanged")) {
+    return false;
+  }
+  if (outerLoop->getSubLoops().size() != 1) {
+    return false;
+  }
+  auto innerLoop = outerLoop->getSubLoops()[0];
+  if (innerLoop->getSubLoops().size() != 0) {
+    return false;
+  }
+  auto loopNode = loop->getLoopHierarchyStructures();
+  auto children = loopNode->getChildren();
+  if (children.size() != 1) {
+    return false;
+  }
+  auto innerLS = (*children.begin())->getLoop();
+  if (innerLS->getHeader() != innerLoop->getHeader()) {
+    return false;
+  }
+
+  /*
+   * Both loops must be in their canonical form and they must leave only from
+   * their headers.
+   */
+  for (auto l : { outerLoop, innerLoop }) {
+    if (false || (!l->isLoopSimplifyForm())
+        || (l->getExitingBlock() != l->getHeader())
+        || (l->getExitBlock() == nullptr)) {
+      return false;
+    }
+  }
+  if (!outerLoop->isRecursivelyLCSSAForm(DT, LLVMLoops)) {
+    return false;
+  }
+
+  /*
+   * Fetch the loop-governing IVs of both loops.
+   * The iteration space of the nest must be rectangular.
+   */
+  auto IVM = loop->getInductionVariableManager();
+  auto outerGIV = IVM->getLoopGoverningIVAttribution(*ls);
+  auto innerGIV = IVM->getLoopGoverningIVAttribution(*innerLS);
+  if (false || (outerGIV == nullptr) || (innerGIV == nullptr)) {
+    return false;
+  }
+  if (false || (!this->canIterationSpaceBeLinearized(outerLoop, outerGIV))
+      || (!this->canIterationSpaceBeLinearized(outerLoop, innerGIV))) {
+    return false;
+  }
+  auto outerPHI = outerGIV->getInductionVariable().getLoopEntryPHI();
+  auto innerPHI = innerGIV->getInductionVariable().getLoopEntryPHI();
+
+  /*
+   * Fetch the basic blocks of the nest.
+   * The outer loop must be composed by its header, the pre-header of the inner
+   * loop, the inner loop, its exit, and the latch of the outer loop.
+   */
+  auto outerPreHeader = outerLoop->getLoopPreheader();
+  auto outerHeader = outerLoop->getHeader();
+  auto outerLatch = outerLoop->getLoopLatch();
+  auto outerExit = outerLoop->getExitBlock();
+  auto innerPreHeader = innerLoop->getLoopPreheader();
+  auto innerHeader = innerLoop->getHeader();
+  auto innerLatch = innerLoop->getLoopLatch();
+  auto innerExit = innerLoop->getExitBlock();
+  auto innerHeaderBr = innerGIV->getHeaderBrInst();
+  auto innerBody = innerHeaderBr->getSuccessor(0);
+  if (innerBody == innerExit) {
+    innerBody = innerHeaderBr->getSuccessor(1);
+  }
+  std::unordered_set<BasicBlock *> outerBlocks{ outerHeader,
+                                                innerPreHeader,
+                                                innerExit,
+                                                outerLatch };
+  if (false || (innerLatch == innerHeader)
+      || (innerPreHeader->getSinglePredecessor() != outerHeader)
+      || (outerLoop->getNumBlocks()
+          != (innerLoop->getNumBlocks() + outerBlocks.size()))) {
+    return false;
+  }
+  for (auto bb : outerBlocks) {
+    if (!outerLoop->contains(bb) || innerLoop->contains(bb)) {
+      return false;
+    }
+  }
+
+  /*
+   * Check that the nest is perfect.
+   * The loops must not carry values other than their IVs, and the nest must
+   * produce only values computed before it starts.
+   */
+  for (auto &phi : outerHeader->phis()) {
+    if (&phi != outerPHI) {
+      return false;
+    }
+  }
+  for (auto &phi : innerHeader->phis()) {
+    if (&phi != innerPHI) {
+      return false;
+    }
+  }
+  for (auto &phi : innerExit->phis()) {
+    if (!phi.use_empty()) {
+      return false;
+    }
+  }
+  for (auto &phi : outerExit->phis()) {
+    auto exitValue =
+        dyn_cast<Instruction>(phi.getIncomingValueForBlock(outerHeader));
+    if (true && (exitValue != nullptr) && outerLoop->contains(exitValue)) {
+      return false;
+    }
+  }
+
+  /*
+   * The rest of the code of the outer loop, and the one of the header of the
+   * inner loop, must be free of side effects. This code is recomputed at every
+   * iteration of the interchanged inner loop.
+   * The code that follows the inner loop must only update the outer IV.
+   */
+  auto &outerIV = outerGIV->getInductionVariable();
+  std::vector<Instruction *> instructionsToMove;
+  for (auto bb : { outerHeader, innerPreHeader, innerHeader }) {
+    for (auto &I : *bb) {
+      if (false || isa<PHINode>(&I) || I.isTerminator()) {
+        continue;
+      }
+      if (false || I.mayHaveSideEffects() || I.mayReadFromMemory()
+          || isa<AllocaInst>(&I)) {
+        return false;
+      }
+      instructionsToMove.push_back(&I);
+    }
+  }
+  std::vector<Instruction *> outerIVUpdates;
+  for (auto bb : { innerExit, outerLatch }) {
+    for (auto &I : *bb) {
+      if (false || isa<PHINode>(&I) || I.isTerminator()) {
+        continue;
+      }
+      if (!outerIV.isIVInstruction(&I)) {
+        return false;
+      }
+      outerIVUpdates.push_back(&I);
+    }
+  }
+
+  /*
+   * The information the scalar evolution has about the nest is going to be
+   * stale.
+   */
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+  SE.forgetLoop(outerLoop);
+
+  /*
+   * Compute the trip counts of the two loops before the nest starts.
+   */
+  auto &cxt = lsFunction->getContext();
+  auto int64 = IntegerType::get(cxt, 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto one = ConstantInt::get(int64, 1);
+  IRBuilder<> preHeaderBuilder{ outerPreHeader->getTerminator() };
+  auto outerTripCount =
+      this->generateCodeToComputeTheTripCount(preHeaderBuilder,
+                                              ls,
+                                              IVM,
+                                              outerGIV);
+  auto innerTripCount =
+      this->generateCodeToComputeTheTripCount(preHeaderBuilder,
+                                              innerLS,
+                                              IVM,
+                                              innerGIV);
+
+  /*
+   * The outer loop iterates over the iterations of the original inner loop.
+   */
+  auto outerIteration = PHINode::Create(int64, 2, "", &*outerHeader->begin());
+  IRBuilder<> outerLatchBuilder{ outerLatch->getTerminator() };
+  auto outerIterationNext = outerLatchBuilder.CreateAdd(outerIteration, one);
+  outerIteration->addIncoming(zero, outerPreHeader);
+  outerIteration->addIncoming(outerIterationNext, outerLatch);
+  auto outerHeaderBr = outerHeader->getTerminator();
+  IRBuilder<> outerHeaderBuilder{ outerHeaderBr };
+  auto isWithinTheInnerSpace =
+      outerHeaderBuilder.CreateICmpULT(outerIteration, innerTripCount);
+  outerHeaderBuilder.CreateCondBr(isWithinTheInnerSpace,
+                                  innerPreHeader,
+                                  outerExit);
+  outerHeaderBr->eraseFromParent();
+
+  /*
+   * The inner loop iterates over the iterations of the original outer loop.
+   */
+  std::vector<PHINode *> innerExitPHIs;
+  for (auto &phi : innerExit->phis()) {
+    innerExitPHIs.push_back(&phi);
+  }
+  for (auto phi : innerExitPHIs) {
+    phi->eraseFromParent();
+  }
+  auto innerIteration = PHINode::Create(int64, 2, "", &*innerHeader->begin());
+  IRBuilder<> innerLatchBuilder{ innerLatch->getTerminator() };
+  auto innerIterationNext = innerLatchBuilder.CreateAdd(innerIteration, one);
+  innerIteration->addIncoming(zero, innerPreHeader);
+  innerIteration->addIncoming(innerIterationNext, innerLatch);
+  auto interchangedBody = BasicBlock::Create(cxt, "", lsFunction, innerBody);
+  IRBuilder<> innerHeaderBuilder{ innerHeaderBr };
+  auto isWithinTheOuterSpace =
+      innerHeaderBuilder.CreateICmpULT(innerIteration, outerTripCount);
+  innerHeaderBuilder.CreateCondBr(isWithinTheOuterSpace,
+                                  interchangedBody,
+                                  innerExit);
+  innerHeaderBr->eraseFromParent();
+  for (auto &phi : innerBody->phis()) {
+    auto index = phi.getBasicBlockIndex(innerHeader);
+    phi.setIncomingBlock(index, interchangedBody);
+  }
+
+  /*
+   * Recover the original indices at the beginning of the body of the
+   * interchanged nest, followed by the code of the loops they rely on.
+   */
+  IRBuilder<> bodyBuilder{ interchangedBody };
+  auto bodyBr = bodyBuilder.CreateBr(innerBody);
+  bodyBuilder.SetInsertPoint(bodyBr);
+  auto outerIndex = this->generateCodeToComputeTheIVValue(bodyBuilder,
+                                                          outerGIV,
+                                                          innerIteration);
+  auto innerIndex = this->generateCodeToComputeTheIVValue(bodyBuilder,
+                                                          innerGIV,
+                                                          outerIteration);
+  for (auto I : instructionsToMove) {
+    I->moveBefore(bodyBr);
+  }
+  auto innerIVUpdate = dyn_cast<Instruction>(
+      innerPHI->getIncomingValueForBlock(innerLatch));
+  outerPHI->replaceAllUsesWith(outerIndex);
+  innerPHI->replaceAllUsesWith(innerIndex);
+  outerPHI->eraseFromParent();
+  innerPHI->eraseFromParent();
+  if (true && (innerIVUpdate != nullptr)
+      && (innerIVUpdate->getParent() != interchangedBody)
+      && innerIVUpdate->use_empty()) {
+    innerIVUpdate->eraseFromParent();
+  }
+
+  /*
+   * Remove the updates of the original outer IV, which are not needed
+   * anymore, and the code that was needed only to exit the original loops.
+   */
+  for (auto I : outerIVUpdates) {
+    if (!I->use_empty()) {
+      I->replaceAllUsesWith(UndefValue::get(I->getType()));
+    }
+  }
+  for (auto I : outerIVUpdates) {
+    I->eraseFromParent();
+  }
+  for (auto it = instructionsToMove.rbegin(); it != instructionsToMove.rend();
+       it++) {
+    auto I = *it;
+    if (I->use_empty()) {
+      I->eraseFromParent();
+    }
+  }
+
+  /*
+   * Update the LLVM loop abstractions and tag the loops of the interchanged
+   * nest.
+   */
+  DT.recalculate(*lsFunction);
+  LLVMLoops.releaseMemory();
+  LLVMLoops.analyze(DT);
+  for (auto header : { outerHeader, innerHeader }) {
+    auto interchangedLoop = LLVMLoops.getLoopFor(header);
+    assert(interchangedLoop != nullptr);
+    addStringMetadataToLoop(interchangedLoop, "noelle.loop.interchanged", 1);
+  }
+
+  return true;
+}
+
+bool LoopTransformer::chunkPointerChasingLoop(LoopDependenceInfo *loop,
+                                              uint32_t chunkSize) {
+  assert(chunkSize > 0);
+
+  /*
+   * Fetch the function that contains the loop we want to chunk.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   * Loops that have been chunked already are left untouched.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+  auto llvmLoop = LLVMLoops.getLoopFor(ls->getHeader());
+  assert(llvmLoop != nullptr);
+  if (getBooleanLoopAttribute(llvmLoop, "noelle.loop.chunked")) {
+    return false;
+  }
+
+  /*
+   * The loop must be in its canonical form and it must leave only from its
+   * header.
+   */
+  auto header = llvmLoop->getHeader();
+  auto preHeader = llvmLoop->getLoopPreheader();
+  auto latch = llvmLoop->getLoopLatch();
+  auto exitBB = llvmLoop->getExitBlock();
+  if (false || (!llvmLoop->isLoopSimplifyForm())
+      || (llvmLoop->getExitingBlock() != header) || (exitBB == nullptr)
+      || (exitBB->getSinglePredecessor() != header)) {
+    return false;
+  }
+
+  /*
+   * The loop must exit when the node it is visiting is null.
+   * The header must include only the PHIs of the loop and the code that
+   * computes this condition, which is going to be executed once more per
+   * chunk.
+   */
+  auto headerBr = dyn_cast<BranchInst>(header->getTerminator());
+  if (false || (headerBr == nullptr) || (!headerBr->isConditional())) {
+    return false;
+  }
+  auto cmpInst = dyn_cast<ICmpInst>(headerBr->getCondition());
+  if (false || (cmpInst == nullptr) || (!cmpInst->isEquality())
+      || (!cmpInst->hasOneUse()) || (cmpInst->getParent() != header)) {
+    return false;
+  }
+  auto nodePHI = dyn_cast<PHINode>(cmpInst->getOperand(0));
+  auto nullValue = cmpInst->getOperand(1);
+  if (nodePHI == nullptr) {
+    nodePHI = dyn_cast<PHINode>(cmpInst->getOperand(1));
+    nullValue = cmpInst->getOperand(0);
+  }
+  if (false || (nodePHI == nullptr) || (nodePHI->getParent() != header)
+      || (!isa<ConstantPointerNull>(nullValue))) {
+    return false;
+  }
+  for (auto &I : *header) {
+    if (false || isa<PHINode>(&I) || (&I == cmpInst) || (&I == headerBr)) {
+      continue;
+    }
+    return false;
+  }
+  auto bodyBB = headerBr->getSuccessor(0);
+  if (bodyBB == exitBB) {
+    bodyBB = headerBr->getSuccessor(1);
+  }
+  if (bodyBB->getSinglePredecessor() != header) {
+    return false;
+  }
+
+  /*
+   * Fetch the code that computes the next node to visit.
+   * This code must be executed at every iteration, and it must be composed by
+   * loads of the current node and by the computation of their addresses.
+   * These loads are going to be anticipated to traverse a whole chunk of the
+   * list before its nodes are processed. Hence, they cannot depend on the
+   * memory the loop writes.
+   */
+  auto nextNode =
+      dyn_cast<Instruction>(nodePHI->getIncomingValueForBlock(latch));
+  if (false || (nextNode == nullptr) || (!llvmLoop->contains(nextNode))) {
+    return false;
+  }
+  auto loopDG = loop->getLoopDG();
+  std::vector<Instruction *> traversal;
+  std::unordered_set<Instruction *> visited;
+  std::function<bool(Instruction *)> collectTraversal;
+  collectTraversal = [&](Instruction *I) -> bool {
+    if (false || (I == nodePHI) || (!llvmLoop->contains(I))
+        || (visited.count(I) > 0)) {
+      return true;
+    }
+    visited.insert(I);
+    if (false || (!DT.dominates(I->getParent(), latch))
+        || ((!isa<GetElementPtrInst>(I)) && (!isa<CastInst>(I))
+            && (!isa<LoadInst>(I)))) {
+      return false;
+    }
+    if (auto loadInst = dyn_cast<LoadInst>(I)) {
+      if (!loadInst->isSimple()) {
+        return false;
+      }
+      for (auto dep : loopDG->fetchNode(loadInst)->getIncomingEdges()) {
+        auto fromInst = dyn_cast<Instruction>(dep->getOutgoingT());
+        if (true && dep->isMemoryDependence() && (fromInst != nullptr)
+            && llvmLoop->contains(fromInst)
+            && fromInst->mayWriteToMemory()) {
+          return false;
+        }
+      }
+    }
+    for (auto op : I->operand_values()) {
+      auto opInst = dyn_cast<Instruction>(op);
+      if (true && (opInst != nullptr) && (!collectTraversal(opInst))) {
+        return false;
+      }
+    }
+    traversal.push_back(I);
+    return true;
+  };
+  if (!collectTraversal(nextNode)) {
+    return false;
+  }
+
+  /*
+   * The information the scalar evolution has about the loop is going to be
+   * stale.
+   */
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+  SE.forgetLoop(llvmLoop);
+
+  /*
+   * Allocate the two buffers that store the nodes of a chunk.
+   * While the nodes of a chunk are processed from one buffer, the nodes of
+   * the next chunk are collected into the other one.
+   */
+  auto &cxt = lsFunction->getContext();
+  auto int64 = IntegerType::get(cxt, 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto one = ConstantInt::get(int64, 1);
+  auto nodeType = nodePHI->getType();
+  auto bufferType = ArrayType::get(nodeType, chunkSize);
+  auto &entryBB = lsFunction->getEntryBlock();
+  IRBuilder<> entryBuilder{ &*entryBB.getFirstInsertionPt() };
+  auto firstBuffer = entryBuilder.CreateAlloca(bufferType);
+  auto secondBuffer = entryBuilder.CreateAlloca(bufferType);
+
+  /*
+   * Define the code that traverses the list from @firstNode until either the
+   * chunk is full or the list ends, and that stores the nodes traversed into
+   * @chunkBuffer.
+   * This code starts when @startBB, which has no terminator yet, ends.
+   * It returns the block it leaves to, which has no terminator yet, and the
+   * PHIs of this block with the number of nodes stored and the node after
+   * them.
+   */
+  auto fillChunk = [&](BasicBlock *startBB,
+                       Value *firstNode,
+                       Value *chunkBuffer,
+                       BasicBlock *insertPoint)
+      -> std::tuple<BasicBlock *, PHINode *, PHINode *> {
+    auto fillHeader = BasicBlock::Create(cxt, "", lsFunction, insertPoint);
+    auto fillBody = BasicBlock::Create(cxt, "", lsFunction, insertPoint);
+    auto fillExit = BasicBlock::Create(cxt, "", lsFunction, insertPoint);
+    IRBuilder<>{ startBB }.CreateBr(fillHeader);
+    IRBuilder<> fillHeaderBuilder{ fillHeader };
+    auto storedNodes = fillHeaderBuilder.CreatePHI(int64, 2);
+    auto fillNode = fillHeaderBuilder.CreatePHI(nodeType, 2);
+    storedNodes->addIncoming(zero, startBB);
+    fillNode->addIncoming(firstNode, startBB);
+    auto isListOver = fillHeaderBuilder.CreateICmpEQ(fillNode, nullValue);
+    auto isChunkFull =
+        fillHeaderBuilder.CreateICmpEQ(storedNodes,
+                                       ConstantInt::get(int64, chunkSize));
+    auto isChunkReady = fillHeaderBuilder.CreateOr(isListOver, isChunkFull);
+    fillHeaderBuilder.CreateCondBr(isChunkReady, fillExit, fillBody);
+    IRBuilder<> fillBodyBuilder{ fillBody };
+    auto fillSlot =
+        fillBodyBuilder.CreateInBoundsGEP(chunkBuffer, { zero, storedNodes });
+    fillBodyBuilder.CreateStore(fillNode, fillSlot);
+    std::unordered_map<Value *, Value *> clones{ { nodePHI, fillNode } };
+    for (auto I : traversal) {
+      auto cloneI = I->clone();
+      for (auto &op : cloneI->operands()) {
+        if (clones.find(op.get()) != clones.end()) {
+          op.set(clones[op.get()]);
+        }
+      }
+      fillBodyBuilder.Insert(cloneI);
+      clones[I] = cloneI;
+    }
+    fillNode->addIncoming(clones[nextNode], fillBody);
+    storedNodes->addIncoming(fillBodyBuilder.CreateAdd(storedNodes, one),
+                              fillBody);
+    fillBodyBuilder.CreateBr(fillHeader);
+    IRBuilder<> fillExitBuilder{ fillExit };
+    auto nodesStored = fillExitBuilder.CreatePHI(int64, 1);
+    nodesStored->addIncoming(storedNodes, fillHeader);
+    auto nodeAfter = fillExitBuilder.CreatePHI(nodeType, 1);
+    nodeAfter->addIncoming(fillNode, fillHeader);
+    return std::make_tuple(fillExit, nodesStored, nodeAfter);
+  };
+
+  /*
+   * Collect the nodes of the first chunk before the loop over the chunks
+   * starts.
+   */
+  auto startNode = nodePHI->getIncomingValueForBlock(preHeader);
+  auto firstFillBB = BasicBlock::Create(cxt, "", lsFunction, header);
+  preHeader->getTerminator()->replaceUsesOfWith(header, firstFillBB);
+  auto firstFill = fillChunk(firstFillBB, startNode, firstBuffer, header);
+  auto firstFillExit = std::get<0>(firstFill);
+
+  /*
+   * Create the loop over the chunks.
+   * Its header carries the buffers, the nodes of the current chunk and the
+   * node after them, and the values the original loop carries from one chunk
+   * to the next one.
+   */
+  auto chunkHeader = BasicBlock::Create(cxt, "", lsFunction, header);
+  auto drainBB = BasicBlock::Create(cxt, "", lsFunction, exitBB);
+  IRBuilder<>{ firstFillExit }.CreateBr(chunkHeader);
+  IRBuilder<> chunkBuilder{ chunkHeader };
+  auto chunkBuffer = chunkBuilder.CreatePHI(firstBuffer->getType(), 2);
+  auto otherBuffer = chunkBuilder.CreatePHI(secondBuffer->getType(), 2);
+  auto nodesOfChunk = chunkBuilder.CreatePHI(int64, 2);
+  auto nodeAfterChunk = chunkBuilder.CreatePHI(nodeType, 2);
+  chunkBuffer->addIncoming(firstBuffer, firstFillExit);
+  otherBuffer->addIncoming(secondBuffer, firstFillExit);
+  nodesOfChunk->addIncoming(std::get<1>(firstFill), firstFillExit);
+  nodeAfterChunk->addIncoming(std::get<2>(firstFill), firstFillExit);
+  std::vector<PHINode *> headerPHIs;
+  for (auto &phi : header->phis()) {
+    if (&phi != nodePHI) {
+      headerPHIs.push_back(&phi);
+    }
+  }
+  std::unordered_map<PHINode *, PHINode *> chunkPHIs;
+  for (auto phi : headerPHIs) {
+    auto chunkPHI = chunkBuilder.CreatePHI(phi->getType(), 2);
+    chunkPHI->addIncoming(phi->getIncomingValueForBlock(preHeader),
+                          firstFillExit);
+    auto index = phi->getBasicBlockIndex(preHeader);
+    phi->setIncomingBlock(index, chunkHeader);
+    phi->setIncomingValue(index, chunkPHI);
+    chunkPHIs[phi] = chunkPHI;
+  }
+  chunkBuilder.CreateBr(header);
+
+  /*
+   * The original loop now iterates over the nodes of the chunk.
+   */
+  auto nodeIndex = PHINode::Create(int64, 2, "", &*header->begin());
+  nodeIndex->addIncoming(zero, chunkHeader);
+  IRBuilder<> latchBuilder{ latch->getTerminator() };
+  nodeIndex->addIncoming(latchBuilder.CreateAdd(nodeIndex, one), latch);
+  IRBuilder<> headerBuilder{ headerBr };
+  auto isWithinTheChunk = headerBuilder.CreateICmpULT(nodeIndex, nodesOfChunk);
+  headerBuilder.CreateCondBr(isWithinTheChunk, bodyBB, drainBB);
+  headerBr->eraseFromParent();
+  cmpInst->eraseFromParent();
+  IRBuilder<> bodyBuilder{ &*bodyBB->getFirstInsertionPt() };
+  auto nodeSlot =
+      bodyBuilder.CreateInBoundsGEP(chunkBuffer, { zero, nodeIndex });
+  auto node = bodyBuilder.CreateLoad(nodeSlot);
+
+  /*
+   * Uses of the node outside the loop can only observe the end of the list.
+   */
+  std::vector<Use *> nodeUses;
+  for (auto &use : nodePHI->uses()) {
+    nodeUses.push_back(&use);
+  }
+  for (auto use : nodeUses) {
+    auto userInst = cast<Instruction>(use->getUser());
+    if (llvmLoop->contains(userInst)) {
+      use->set(node);
+    } else {
+      use->set(nullValue);
+    }
+  }
+  nodePHI->eraseFromParent();
+  for (auto it = traversal.rbegin(); it != traversal.rend(); it++) {
+    auto I = *it;
+    if (I->use_empty()) {
+      I->eraseFromParent();
+    }
+  }
+
+  /*
+   * The values the loop carries leave it through the PHIs of its exit.
+   */
+  IRBuilder<> drainBuilder{ drainBB };
+  std::unordered_map<Value *, Value *> liveOuts;
+  for (auto phi : headerPHIs) {
+    auto liveOut = drainBuilder.CreatePHI(phi->getType(), 1);
+    liveOut->addIncoming(phi, header);
+    liveOuts[phi] = liveOut;
+  }
+
+  /*
+   * Collect the nodes of the next chunk into the other buffer once the loop
+   * ends.
+   * The parallelizer runs this code while the tasks process the current
+   * chunk (see Parallelizer::overlapChunkWithTheFillOfTheNextOne).
+   */
+  auto nextFill = fillChunk(drainBB, nodeAfterChunk, otherBuffer, exitBB);
+  auto nextFillExit = std::get<0>(nextFill);
+  auto nodesOfNextChunk = std::get<1>(nextFill);
+
+  /*
+   * Move to the next chunk, if any.
+   */
+  IRBuilder<> nextFillExitBuilder{ nextFillExit };
+  auto isOver = nextFillExitBuilder.CreateICmpEQ(nodesOfNextChunk, zero);
+  nextFillExitBuilder.CreateCondBr(isOver, exitBB, chunkHeader);
+  chunkBuffer->addIncoming(otherBuffer, nextFillExit);
+  otherBuffer->addIncoming(chunkBuffer, nextFillExit);
+  nodesOfChunk->addIncoming(nodesOfNextChunk, nextFillExit);
+  nodeAfterChunk->addIncoming(std::get<2>(nextFill), nextFillExit);
+  for (auto phi : headerPHIs) {
+    chunkPHIs[phi]->addIncoming(liveOuts[phi], nextFillExit);
+  }
+  for (auto &phi : exitBB->phis()) {
+    auto index = phi.getBasicBlockIndex(header);
+    phi.setIncomingBlock(index, nextFillExit);
+    auto incomingValue = phi.getIncomingValue(index);
+    if (liveOuts.find(incomingValue) != liveOuts.end()) {
+      phi.setIncomingValue(index, liveOuts[incomingValue]);
+    }
+  }
+
+  /*
+   * Update the LLVM loop abstractions and tag the loop that iterates over the
+   * nodes of a chunk and the one that collects the nodes of the next chunk.
+   */
+  DT.recalculate(*lsFunction);
+  LLVMLoops.releaseMemory();
+  LLVMLoops.analyze(DT);
+  auto chunkedLoop = LLVMLoops.getLoopFor(header);
+  assert(chunkedLoop != nullptr);
+  addStringMetadataToLoop(chunkedLoop, "noelle.loop.chunked", 1);
+  auto nextFillLoop =
+      LLVMLoops.getLoopFor(nodesOfNextChunk->getIncomingBlock(0));
+  assert(nextFillLoop != nullptr);
+  addStringMetadataToLoop(nextFillLoop, "noelle.loop.chunk.fill", 1);
+
+  return true;
+}
+
+bool LoopTransformer::expandTemporaries(
+    LoopDependenceInfo *loop,
+    std::unordered_set<Value *> const &temporaries,
+    uint64_t maximumBytes) {
+  if (temporaries.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Fetch the function that contains the loop.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+  auto M = lsFunction->getParent();
+  auto &DL = M->getDataLayout();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+  auto llvmLoop = LLVMLoops.getLoopFor(ls->getHeader());
+  assert(llvmLoop != nullptr);
+
+  /*
+   * Loops are expanded only once: the fallback copy keeps the temporaries,
+   * and expanding it again would only add another copy of it.
+   */
+  if (getBooleanLoopAttribute(llvmLoop, "noelle.loop.expanded")) {
+    return false;
+  }
+
+  /*
+   * The loop must be in its canonical form, and every exit must be reachable
+   * only from the loop, so the storage can be released there.
+   * The values the loop produces must reach the rest of the function only
+   * through the PHIs of its exits, so the fallback copy can feed them too.
+   */
+  if (false || (!llvmLoop->isLoopSimplifyForm())
+      || (!llvmLoop->hasDedicatedExits())
+      || (!llvmLoop->isRecursivelyLCSSAForm(DT, LLVMLoops))) {
+    return false;
+  }
+
+  /*
+   * Every iteration needs its own copy of the temporaries.
+   * The header executes once more than the body of the loop when the loop
+   * exits from it, so one more copy is allocated.
+   * The copies of all temporaries can take at most @maximumBytes.
+   */
+  auto getTemporaryType = [](Value *temporary) -> Type * {
+    if (auto allocaInst = dyn_cast<AllocaInst>(temporary)) {
+      return allocaInst->getAllocatedType();
+    }
+    return cast<GlobalVariable>(temporary)->getValueType();
+  };
+  uint64_t bytesPerIteration = 0;
+  for (auto temporary : temporaries) {
+    bytesPerIteration += DL.getTypeAllocSize(getTemporaryType(temporary));
+  }
+  if (bytesPerIteration == 0) {
+    return false;
+  }
+  auto maximumCopies = maximumBytes / bytesPerIteration;
+  if (maximumCopies == 0) {
+    return false;
+  }
+  auto GIV = loop->getLoopGoverningIVAttribution();
+  if (loop->doesHaveCompileTimeKnownTripCount()) {
+    if (loop->getCompileTimeTripCount() >= maximumCopies) {
+      return false;
+    }
+  } else if (false || (GIV == nullptr)
+             || (!this->canIterationSpaceBeLinearized(llvmLoop, GIV))) {
+    return false;
+  }
+
+  /*
+   * Clone the loop before expanding its temporaries.
+   * The clone keeps using the temporaries, and it runs when the copies do not
+   * fit within @maximumBytes or when they cannot be allocated.
+   * The pre-header of the loop becomes the block that checks the number of
+   * copies, and it is followed by the block that allocates them.
+   */
+  auto checkBB = llvmLoop->getLoopPreheader();
+  auto allocationBB =
+      SplitBlock(checkBB, checkBB->getTerminator(), &DT, &LLVMLoops);
+  auto preHeader =
+      SplitBlock(allocationBB, allocationBB->getTerminator(), &DT, &LLVMLoops);
+  ValueToValueMapTy VMap;
+  SmallVector<BasicBlock *, 8> fallbackBlocks;
+  auto fallbackLoop = cloneLoopWithPreheader(preHeader,
+                                             checkBB,
+                                             llvmLoop,
+                                             VMap,
+                                             ".unexpanded",
+                                             &LLVMLoops,
+                                             &DT,
+                                             fallbackBlocks);
+  remapInstructionsInBlocks(fallbackBlocks, VMap);
+  auto fallbackPreHeader = fallbackLoop->getLoopPreheader();
+
+  /*
+   * Propagate the values produced by the clone to the exits of the loop.
+   */
+  SmallVector<BasicBlock *, 4> exitBBs;
+  llvmLoop->getUniqueExitBlocks(exitBBs);
+  for (auto exitBB : exitBBs) {
+    for (auto &phi : exitBB->phis()) {
+      auto numberOfIncomingValues = phi.getNumIncomingValues();
+      for (auto i = 0u; i < numberOfIncomingValues; i++) {
+        auto incomingBB = phi.getIncomingBlock(i);
+        if (!llvmLoop->contains(incomingBB)) {
+          continue;
+        }
+        Value *incomingValue = phi.getIncomingValue(i);
+        if (VMap.count(incomingValue) > 0) {
+          incomingValue = VMap[incomingValue];
+        }
+        phi.addIncoming(incomingValue, cast<BasicBlock>(VMap[incomingBB]));
+      }
+    }
+  }
+
+  /*
+   * Check that the copies fit within @maximumBytes before the loop starts.
+   */
+  auto &cxt = lsFunction->getContext();
+  auto int64 = IntegerType::get(cxt, 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto one = ConstantInt::get(int64, 1);
+  auto checkTerminator = checkBB->getTerminator();
+  IRBuilder<> checkBuilder{ checkTerminator };
+  Value *tripCount = nullptr;
+  if (loop->doesHaveCompileTimeKnownTripCount()) {
+    tripCount = ConstantInt::get(int64, loop->getCompileTimeTripCount());
+  } else {
+    auto IVM = loop->getInductionVariableManager();
+    tripCount =
+        checkBuilder.CreateZExtOrTrunc(this->generateCodeToComputeTheTripCount(
+                                           checkBuilder,
+                                           ls,
+                                           IVM,
+                                           GIV),
+                                       int64);
+  }
+  auto doCopiesFit =
+      checkBuilder.CreateICmpULT(tripCount,
+                                 ConstantInt::get(int64, maximumCopies));
+  auto copies = checkBuilder.CreateAdd(tripCount, one);
+  checkBuilder.CreateCondBr(doCopiesFit, allocationBB, fallbackPreHeader);
+  checkTerminator->eraseFromParent();
+
+  /*
+   * Fetch the functions that allocate and release the storage of the copies.
+   */
+  auto int8Ptr = Type::getInt8PtrTy(cxt);
+  auto nullPointer = ConstantPointerNull::get(int8Ptr);
+  auto mallocFunction = M->getOrInsertFunction(
+      "malloc",
+      FunctionType::get(int8Ptr, { int64 }, false));
+  auto freeFunction = M->getOrInsertFunction(
+      "free",
+      FunctionType::get(Type::getVoidTy(cxt), { int8Ptr }, false));
+
+  /*
+   * Allocate the copies before the loop starts.
+   * If any of them cannot be allocated, the ones that have been allocated are
+   * released and the clone runs.
+   */
+  auto allocationTerminator = allocationBB->getTerminator();
+  IRBuilder<> allocationBuilder{ allocationTerminator };
+  std::unordered_map<Value *, Value *> storages;
+  Value *isAnyStorageMissing = nullptr;
+  for (auto temporary : temporaries) {
+    auto temporarySize = DL.getTypeAllocSize(getTemporaryType(temporary));
+    auto bytes = allocationBuilder.CreateMul(
+        copies,
+        ConstantInt::get(int64, temporarySize));
+    auto storage = allocationBuilder.CreateCall(mallocFunction, { bytes });
+    auto isStorageMissing = allocationBuilder.CreateICmpEQ(storage, nullPointer);
+    isAnyStorageMissing =
+        (isAnyStorageMissing == nullptr)
+            ? isStorageMissing
+            : allocationBuilder.CreateOr(isAnyStorageMissing,
+                                         isStorageMissing);
+    storages[temporary] = storage;
+  }
+  auto releaseBB =
+      BasicBlock::Create(cxt, "", lsFunction, fallbackPreHeader);
+  if (auto parentLoop = llvmLoop->getParentLoop()) {
+    parentLoop->addBasicBlockToLoop(releaseBB, LLVMLoops);
+  }
+  allocationBuilder.CreateCondBr(isAnyStorageMissing, releaseBB, preHeader);
+  allocationTerminator->eraseFromParent();
+  IRBuilder<> releaseBuilder{ releaseBB };
+  for (auto &pair : storages) {
+    releaseBuilder.CreateCall(freeFunction, { pair.second });
+  }
+  releaseBuilder.CreateBr(fallbackPreHeader);
+  DT.recalculate(*lsFunction);
+
+  /*
+   * Release the copies when the loop ends.
+   * The exits are shared with the clone, which has no copy to release.
+   */
+  for (auto exitBB : exitBBs) {
+    for (auto &pair : storages) {
+      auto storageToRelease =
+          PHINode::Create(int8Ptr, pred_size(exitBB), "", &*exitBB->begin());
+      for (auto predBB : predecessors(exitBB)) {
+        storageToRelease->addIncoming(
+            llvmLoop->contains(predBB) ? pair.second : nullPointer,
+            predBB);
+      }
+      IRBuilder<> exitBuilder{ &*exitBB->getFirstInsertionPt() };
+      exitBuilder.CreateCall(freeFunction, { storageToRelease });
+    }
+  }
+
+  /*
+   * Number the iterations of the loop.
+   */
+  auto header = llvmLoop->getHeader();
+  auto iteration =
+      PHINode::Create(int64, pred_size(header), "", &*header->begin());
+  iteration->addIncoming(zero, preHeader);
+  SmallVector<BasicBlock *, 4> latches;
+  llvmLoop->getLoopLatches(latches);
+  for (auto latch : latches) {
+    IRBuilder<> latchBuilder{ latch->getTerminator() };
+    iteration->addIncoming(latchBuilder.CreateAdd(iteration, one), latch);
+  }
+
+  /*
+   * Expand the temporaries.
+   */
+  IRBuilder<> headerBuilder{ &*header->getFirstInsertionPt() };
+  for (auto temporary : temporaries) {
+    auto temporarySize = DL.getTypeAllocSize(getTemporaryType(temporary));
+    auto storage = storages[temporary];
+
+    /*
+     * Compute the pointer to the copy of the current iteration.
+     */
+    auto offset = headerBuilder.CreateMul(
+        iteration,
+        ConstantInt::get(int64, temporarySize));
+    auto copy =
+        headerBuilder.CreatePointerCast(
+            headerBuilder.CreateInBoundsGEP(storage, offset),
+            temporary->getType());
+
+    /*
+     * The lifetime of the temporary is now the one of its copies.
+     * Constant expressions that use the temporary become instructions, so
+     * each of their uses can be redirected to the copy.
+     */
+    std::function<void(Value *)> removeLifetimeMarkers;
+    removeLifetimeMarkers = [&removeLifetimeMarkers](Value *v) {
+      std::vector<User *> users(v->user_begin(), v->user_end());
+      for (auto user : users) {
+        if (auto intrinsic = dyn_cast<IntrinsicInst>(user)) {
+          auto intrinsicID = intrinsic->getIntrinsicID();
+          if (false || (intrinsicID == Intrinsic::lifetime_start)
+              || (intrinsicID == Intrinsic::lifetime_end)) {
+            intrinsic->eraseFromParent();
+          }
+          continue;
+        }
+        if (false || isa<CastInst>(user) || isa<GetElementPtrInst>(user)
+            || isa<ConstantExpr>(user)) {
+          removeLifetimeMarkers(user);
+          auto userInst = dyn_cast<Instruction>(user);
+          if (true && (userInst != nullptr) && userInst->use_empty()) {
+            userInst->eraseFromParent();
+          }
+        }
+      }
+      return;
+    };
+    removeLifetimeMarkers(temporary);
+    std::function<void(ConstantExpr *)> convertToInstructions;
+    convertToInstructions = [&convertToInstructions](ConstantExpr *expr) {
+      std::vector<User *> users(expr->user_begin(), expr->user_end());
+      for (auto user : users) {
+        if (auto userExpr = dyn_cast<ConstantExpr>(user)) {
+          convertToInstructions(userExpr);
+        }
+      }
+      users.assign(expr->user_begin(), expr->user_end());
+      for (auto user : users) {
+        auto userInst = dyn_cast<Instruction>(user);
+        if (userInst == nullptr) {
+          continue;
+        }
+        auto exprInst = expr->getAsInstruction();
+        exprInst->insertBefore(userInst);
+        userInst->replaceUsesOfWith(expr, exprInst);
+      }
+      return;
+    };
+    std::vector<User *> users(temporary->user_begin(), temporary->user_end());
+    for (auto user : users) {
+      if (auto expr = dyn_cast<ConstantExpr>(user)) {
+        convertToInstructions(expr);
+      }
+    }
+
+    /*
+     * Redirect the accesses of the loop to the copy of the current
+     * iteration.
+     */
+    std::vector<Use *> uses;
+    for (auto &use : temporary->uses()) {
+      uses.push_back(&use);
+    }
+    for (auto use : uses) {
+      auto userInst = dyn_cast<Instruction>(use->getUser());
+      if (true && (userInst != nullptr) && llvmLoop->contains(userInst)) {
+        use->set(copy);
+      }
+    }
+    if (auto tmpInst = dyn_cast<Instruction>(temporary)) {
+      if (tmpInst->use_empty()) {
+        tmpInst->eraseFromParent();
+      }
+    } else {
+      auto g = cast<GlobalVariable>(temporary);
+      g->removeDeadConstantUsers();
+      if (g->use_empty()) {
+        g->eraseFromParent();
+      }
+    }
+  }
+
+  /*
+   * The information the scalar evolution has about the loop is going to be
+   * stale.
+   */
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+  SE.forgetLoop(llvmLoop);
+
+  /*
+   * Tag both copies.
+   */
+  addStringMetadataToLoop(llvmLoop, "noelle.loop.expanded", 1);
+  addStringMetadataToLoop(fallbackLoop, "noelle.loop.expanded", 1);
+
+  return true;
+}
+
+bool LoopTransformer::fuseLoops(LoopDependenceInfo *firstLoop,
+                                LoopDependenceInfo *secondLoop) {
+  assert(this->pdg != nullptr);
+
+  /*
+   * Check trivial cases
+   */
+  if (false || (firstLoop == nullptr) || (secondLoop == nullptr)) {
+    return false;
+  }
+
+  /*
+   * Fetch the LLVM abstractions of the function that contains the loops.
+   */
+  auto lsFunction = firstLoop->getLoopStructure()->getFunction();
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+
+  /*
+   * Fuse the loops.
+   */
+  LoopFusion lf;
+  auto modified =
+      lf.fuseLoops(*firstLoop, *secondLoop, this->pdg, DT, LLVMLoops, SE);
+  if (!modified) {
+    return false;
+  }
+
+  /*
+   * Update the LLVM loop abstractions.
+   */
+  DT.recalculate(*lsFunction);
+  LLVMLoops.releaseMemory();
+  LLVMLoops.analyze(DT);
+
+  return true;
+}
+
+void LoopTransformer::fetchBranchesOfConditionalIterations(
+    LoopDependenceInfo *loop,
+    std::set<BranchInst *> &firstIterationBranches,
+    std::set<BranchInst *> &lastIterationBranches) {
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+
+  /*
+   * Fetch the LLVM loop.
+   */
+  auto h = ls->getHeader();
+  auto llvmLoop = LLVMLoops.getLoopFor(h);
+  assert(llvmLoop != nullptr);
+
+  /*
+   * The last iteration is the one before the header exits the loop.
+   * Hence, it is known only if the loop is in while form and its header is
+   * the only block that exits it.
+   */
+  const SCEV *lastIteration = nullptr;
+  auto backedgeTakenCount = SE.getBackedgeTakenCount(llvmLoop);
+  if (true && (llvmLoop->getExitingBlock() == h)
+      && (llvmLoop->getLoopLatch() != h)
+      && (!isa<SCEVCouldNotCompute>(backedgeTakenCount))) {
+    lastIteration =
+        SE.getMinusSCEV(backedgeTakenCount,
+                        SE.getOne(backedgeTakenCount->getType()));
+  }
+
+  /*
+   * Check the conditional branches of the loop that neither exit it nor
+   * jump to its header.
+   */
+  for (auto bb : llvmLoop->blocks()) {
+    auto branch = dyn_cast<BranchInst>(bb->getTerminator());
+    if (false || (bb == h) || (branch == nullptr)
+        || (!branch->isConditional())) {
+      continue;
+    }
+    auto trueSuccessor = branch->getSuccessor(0);
+    auto falseSuccessor = branch->getSuccessor(1);
+    if (false || (trueSuccessor == falseSuccessor) || (trueSuccessor == h)
+        || (falseSuccessor == h) || (!llvmLoop->contains(trueSuccessor))
+        || (!llvmLoop->contains(falseSuccessor))) {
+      continue;
+    }
+
+    /*
+     * The branch must check whether an IV of the loop is equal to a value
+     * that does not change within the loop.
+     */
+    auto cmpInst = dyn_cast<ICmpInst>(branch->getCondition());
+    if (false || (cmpInst == nullptr) || (!cmpInst->isEquality())) {
+      continue;
+    }
+    for (auto i = 0u; i < 2; i++) {
+      auto ivSCEV =
+          dyn_cast<SCEVAddRecExpr>(SE.getSCEV(cmpInst->getOperand(i)));
+      auto valueSCEV = SE.getSCEV(cmpInst->getOperand(1 - i));
+      if (false || (ivSCEV == nullptr) || (ivSCEV->getLoop() != llvmLoop)
+          || (!ivSCEV->isAffine())
+          || (!SE.isLoopInvariant(valueSCEV, llvmLoop))) {
+        continue;
+      }
+
+      /*
+       * The IV must not have the same value in two iterations, so the check
+       * can hold in one iteration only.
+       */
+      auto stepSCEV = dyn_cast<SCEVConstant>(ivSCEV->getStepRecurrence(SE));
+      if (false || (stepSCEV == nullptr) || stepSCEV->getValue()->isZero()
+          || ((!ivSCEV->hasNoSelfWrap()) && (!ivSCEV->hasNoSignedWrap())
+              && (!ivSCEV->hasNoUnsignedWrap()))) {
+        continue;
+      }
+
+      /*
+       * Check the iteration where the IV has the value compared.
+       */
+      if (ivSCEV->getStart() == valueSCEV) {
+        firstIterationBranches.insert(branch);
+        break;
+      }
+      if (true && (lastIteration != nullptr)
+          && (ivSCEV->evaluateAtIteration(lastIteration, SE) == valueSCEV)) {
+        lastIterationBranches.insert(branch);
+        break;
+      }
+    }
+  }
+
+  return;
+}
+
+bool LoopTransformer::peelConditionalIterations(
+    LoopDependenceInfo *loop,
+    std::set<BranchInst *> const &firstIterationBranches,
+    std::set<BranchInst *> const &lastIterationBranches) {
+  auto peelFirstIteration = (firstIterationBranches.size() > 0);
+  auto peelLastIteration = (lastIterationBranches.size() > 0);
+  if (true && (!peelFirstIteration) && (!peelLastIteration)) {
+    return false;
+  }
+
+  /*
+   * Fetch the function that contains the loop we want to peel.
+   */
+  auto ls = loop->getLoopStructure();
+  auto lsFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop abstractions.
+   */
+  auto &LLVMLoops = getAnalysis<LoopInfoWrapperPass>(*lsFunction).getLoopInfo();
+  auto &DT = getAnalysis<DominatorTreeWrapperPass>(*lsFunction).getDomTree();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*lsFunction).getSE();
+
+  /*
+   * Fetch the LLVM loop.
+   */
+  auto h = ls->getHeader();
+  auto llvmLoop = LLVMLoops.getLoopFor(h);
+  assert(llvmLoop != nullptr);
+
+  /*
+   * Loops are peeled only once: the branches the peeling targets are not in
+   * the loop of the remaining iterations anymore.
+   */
+  if (getBooleanLoopAttribute(llvmLoop, "noelle.loop.peeled")) {
+    return false;
+  }
+
+  /*
+   * The peeling requires the loop to be in its canonical form, so the values
+   * the loop produces reach the rest of the function only through the PHIs
+   * of its dedicated exits.
+   */
+  if (false || (!llvmLoop->isLoopSimplifyForm())
+      || (!llvmLoop->isRecursivelyLCSSAForm(DT, LLVMLoops))) {
+    return false;
+  }
+
+  /*
+   * The iterations to peel are identified by the values of the
+   * loop-governing IV, which must be computable before the loop starts.
+   */
+  auto GIV = loop->getLoopGoverningIVAttribution();
+  if (false || (GIV == nullptr)
+      || (!this->canIterationSpaceBeLinearized(llvmLoop, GIV))) {
+    return false;
+  }
+
+  /*
+   * Compute the values of the IV at the beginning of the second iteration
+   * and of the last one.
+   */
+  auto preHeader = llvmLoop->getLoopPreheader();
+  IRBuilder<> preHeaderBuilder{ preHeader->getTerminator() };
+  auto int64 = preHeaderBuilder.getInt64Ty();
+  Value *secondIterationValue = nullptr;
+  if (peelFirstIteration) {
+    secondIterationValue =
+        this->generateCodeToComputeTheIVValue(preHeaderBuilder,
+                                              GIV,
+                                              ConstantInt::get(int64, 1));
+  }
+  Value *lastIterationValue = nullptr;
+  if (peelLastIteration) {
+    auto IVM = loop->getInductionVariableManager();
+    auto tripCount = this->generateCodeToComputeTheTripCount(preHeaderBuilder,
+                                                             ls,
+                                                             IVM,
+                                                             GIV);
+    auto lastIteration =
+        preHeaderBuilder.CreateSub(tripCount, ConstantInt::get(int64, 1));
+    lastIterationValue =
+        this->generateCodeToComputeTheIVValue(preHeaderBuilder,
+                                              GIV,
+                                              lastIteration);
+  }
+
+  /*
+   * Define the code that removes a branch from a loop that does not run the
+   * iteration where the branch takes its conditional path.
+   */
+  auto removeBranch = [](BranchInst *branch) {
+    auto cmpInst = cast<ICmpInst>(branch->getCondition());
+    auto isConditionTrue = (cmpInst->getPredicate() == ICmpInst::ICMP_NE);
+    auto successorTaken = branch->getSuccessor(isConditionTrue ? 0 : 1);
+    auto successorNotTaken = branch->getSuccessor(isConditionTrue ? 1 : 0);
+    successorNotTaken->removePredecessor(branch->getParent());
+    BranchInst::Create(successorTaken, branch);
+    branch->eraseFromParent();
+    if (cmpInst->use_empty()) {
+      cmpInst->eraseFromParent();
+    }
+  };
+
+  /*
+   * Peel the first iteration.
+   * The copy runs only the first iteration, so the loop runs the others.
+   */
+  Loop *firstIterationLoop = nullptr;
+  if (peelFirstIteration) {
+    ValueToValueMapTy VMap;
+    firstIterationLoop = this->peelIterationsOfLoop(llvmLoop,
+                                                    GIV,
+                                                    secondIterationValue,
+                                                    VMap,
+                                                    LLVMLoops,
+                                                    DT);
+    for (auto branch : firstIterationBranches) {
+      removeBranch(branch);
+    }
+    DT.recalculate(*lsFunction);
+  }
+
+  /*
+   * Peel the last iteration.
+   * The copy runs the iterations before the last one, so the branches that
+   * take their conditional path in the last iteration are removed from the
+   * copy, which is the loop to parallelize.
+   */
+  Loop *iterationsLoop = nullptr;
+  if (peelLastIteration) {
+    ValueToValueMapTy VMap;
+    iterationsLoop = this->peelIterationsOfLoop(llvmLoop,
+                                                GIV,
+                                                lastIterationValue,
+                                                VMap,
+                                                LLVMLoops,
+                                                DT);
+    for (auto branch : lastIterationBranches) {
+      removeBranch(cast<BranchInst>(VMap[branch]));
+    }
+  }
+
+  /*
+   * Tag all copies.
+   */
+  for (auto peeledLoop : { llvmLoop, firstIterationLoop, iterationsLoop }) {
+    if (peeledLoop != nullptr) {
+      addStringMetadataToLoop(peeledLoop, "noelle.loop.peeled", 1);
+    }
+  }
+
+  /*
+   * Remove the code of the conditional paths that cannot run anymore.
+   */
+  SE.forgetLoop(llvmLoop);
+  EliminateUnreachableBlocks(*lsFunction);
+
+  /*
+   * Update the LLVM loop abstractions.
+   */
+  DT.recalculate(*lsFunction);
+  LLVMLoops.releaseMemory();
+  LLVMLoops.analyze(DT);
+
+  return true;
+}
+
+Loop *LoopTransformer::peelIterationsOfLoop(Loop *loop,
+                                            LoopGoverningIVAttribution *GIV,
+                                            Value *switchValue,
+                                            ValueToValueMapTy &VMap,
+                                            LoopInfo &LLVMLoops,
+                                            DominatorTree &DT) {
+
+  /*
+   * Clone the loop.
+   * The pre-header of the loop jumps to the clone, and the clone gets its
+   * own pre-header.
+   */
+  auto h = loop->getHeader();
+  auto entryBB = loop->getLoopPreheader();
+  auto preHeader =
+      SplitBlock(entryBB, entryBB->getTerminator(), &DT, &LLVMLoops);
+  SmallVector<BasicBlock *, 8> clonedBlocks;
+  auto clonedLoop = cloneLoopWithPreheader(preHeader,
+                                           entryBB,
+                                           loop,
+                                           VMap,
+                                           ".peeled",
+                                           &LLVMLoops,
+                                           &DT,
+                                           clonedBlocks);
+  remapInstructionsInBlocks(clonedBlocks, VMap);
+  entryBB->getTerminator()->replaceUsesOfWith(preHeader,
+                                              clonedLoop->getLoopPreheader());
+
+  /*
+   * Propagate the values produced by the clone to the exits of the loop.
+   */
+  SmallVector<BasicBlock *, 4> exitBlocks;
+  loop->getUniqueExitBlocks(exitBlocks);
+  for (auto exitBlock : exitBlocks) {
+    for (auto &phi : exitBlock->phis()) {
+      auto numberOfIncomingValues = phi.getNumIncomingValues();
+      for (auto i = 0u; i < numberOfIncomingValues; i++) {
+        auto incomingBB = phi.getIncomingBlock(i);
+        if (!loop->contains(incomingBB)) {
+          continue;
+        }
+        Value *incomingValue = phi.getIncomingValue(i);
+        if (VMap.count(incomingValue) > 0) {
+          incomingValue = VMap[incomingValue];
+        }
+        phi.addIncoming(incomingValue, cast<BasicBlock>(VMap[incomingBB]));
+      }
+    }
+  }
+
+  /*
+   * The clone jumps to the loop at the beginning of the iteration where the
+   * IV has @switchValue.
+   */
+  auto clonedHeader = cast<BasicBlock>(VMap[h]);
+  auto clonedBody = SplitBlock(clonedHeader,
+                               clonedHeader->getFirstNonPHI(),
+                               &DT,
+                               &LLVMLoops);
+  auto clonedHeaderTerminator = clonedHeader->getTerminator();
+  IRBuilder<> headerBuilder{ clonedHeaderTerminator };
+  Value *clonedIV = VMap[GIV->getInductionVariable().getLoopEntryPHI()];
+  auto isTheSwitchIteration =
+      headerBuilder.CreateICmpEQ(clonedIV, switchValue);
+  headerBuilder.CreateCondBr(isTheSwitchIteration, preHeader, clonedBody);
+  clonedHeaderTerminator->eraseFromParent();
+
+  /*
+   * The loop starts from the values the clone has when it jumps to it.
+   */
+  IRBuilder<> preHeaderBuilder{ &*preHeader->begin() };
+  for (auto &phi : h->phis()) {
+    Value *clonedPHI = VMap[&phi];
+    auto exitPHI = preHeaderBuilder.CreatePHI(phi.getType(), 1);
+    exitPHI->addIncoming(clonedPHI, clonedHeader);
+    phi.setIncomingValue(phi.getBasicBlockIndex(preHeader), exitPHI);
+  }
+  DT.recalculate(*h->getParent());
+
+  return clonedLoop;
+}
+
+bool LoopTransformer::canIterationSpaceBeLinearized(
+    Loop *nest,
+    LoopGoverningIVAttribution *GIV) {
+
+  /*
+   * The start value and the exit condition value of the IV must be available
+   * before the nest starts (i.e., the iteration space is rectangular), and its
+   * step must be an integer constant.
+   */
+  auto isDefinedBeforeTheNest = [nest](Value *v) -> bool {
+    auto inst = dyn_cast<Instruction>(v);
+    return (inst == nullptr) || (!nest->contains(inst));
+  };
+  auto &IV = GIV->getInductionVariable();
+  auto stepValue =
+      dyn_cast_or_null<ConstantInt>(IV.getSingleComputedStepValue());
+  if (false || (!IV.getIVType()->isIntegerTy()) || (stepValue == nullptr)
+      || stepValue->isZero()
+      || (GIV->getConditionValueDerivation().size() > 0)
+      || (GIV->getValueToCompareAgainstExitConditionValue()
+          != IV.getLoopEntryPHI())
+      || (!isDefinedBeforeTheNest(IV.getStartValue()))
+      || (!isDefinedBeforeTheNest(GIV->getExitConditionValue()))) {
+    return false;
+  }
+
+  /*
+   * The trip count must be computable from the exit condition (see
+   * LoopGoverningIVUtility).
+   */
+  auto cmpInst = GIV->getHeaderCompareInstructionToComputeExitCondition();
+  auto exitPredicate = GIV->valueOfExitConditionToJumpToTheLoopBody()
+                           ? cmpInst->getInversePredicate()
+                           : cmpInst->getPredicate();
+  if (cmpInst->getOperand(0) != IV.getLoopEntryPHI()) {
+    exitPredicate = CmpInst::getSwappedPredicate(exitPredicate);
+  }
+  auto exitsBelowTheValue = false || (exitPredicate == CmpInst::ICMP_SLT)
+                            || (exitPredicate == CmpInst::ICMP_SLE)
+                            || (exitPredicate == CmpInst::ICMP_ULT)
+                            || (exitPredicate == CmpInst::ICMP_ULE);
+  auto exitsAboveTheValue = false || (exitPredicate == CmpInst::ICMP_SGT)
+                            || (exitPredicate == CmpInst::ICMP_SGE)
+                            || (exitPredicate == CmpInst::ICMP_UGT)
+                            || (exitPredicate == CmpInst::ICMP_UGE);
+  auto isStepValuePositive = stepValue->getValue().isStrictlyPositive();
+  if (false || (exitPredicate == CmpInst::ICMP_NE)
+      || (isStepValuePositive && exitsBelowTheValue)
+      || ((!isStepValuePositive) && exitsAboveTheValue)) {
+    return false;
+  }
+
+  return true;
+}
+
+Value *LoopTransformer::generateCodeToComputeTheTripCount(
+    IRBuilder<> &builder,
+    LoopStructure *loop,
+    InductionVariableManager *IVM,
+    LoopGoverningIVAttribution *GIV) {
+
+  /*
+   * Compute the trip count as a 64-bit integer.
+   */
+  auto &IV = GIV->getInductionVariable();
+  auto int64 = builder.getInt64Ty();
+  LoopGoverningIVUtility ivUtility(loop, *IVM, *GIV);
+  auto tripCount = builder.CreateZExtOrTrunc(
+      ivUtility.generateCodeToComputeTheTripCount(builder),
+      int64);
+
+  /*
+   * A loop that does not execute its first iteration has a trip count of 0.
+   */
+  auto firstCheck =
+      GIV->getHeaderCompareInstructionToComputeExitCondition()->clone();
+  builder.Insert(firstCheck);
+  firstCheck->replaceUsesOfWith(IV.getLoopEntryPHI(), IV.getStartValue());
+  auto isTheFirstIterationExecuted =
+      GIV->valueOfExitConditionToJumpToTheLoopBody()
+          ? firstCheck
+          : builder.CreateNot(firstCheck);
+
+  return builder.CreateSelect(isTheFirstIterationExecuted,
+                              tripCount,
+                              ConstantInt::get(int64, 0));
+}
+
+Value *LoopTransformer::generateCodeToComputeTheIVValue(
+    IRBuilder<> &builder,
+    LoopGoverningIVAttribution *GIV,
+    Value *iteration) {
+
+  /*
+   * Compute the value the IV has at the iteration given as input.
+   */
+  auto &IV = GIV->getInductionVariable();
+  auto stepValue = IV.getSingleComputedStepValue();
+  auto offset =
+      builder.CreateMul(builder.CreateZExtOrTrunc(iteration, IV.getIVType()),
+                        stepValue);
+
+  return builder.CreateAdd(IV.getStartValue(), offset);
+}
+
+LoopTransformer::~LoopTransformer() {
+  return;
+}
+
+bool LoopTransformer::splitLoop(LoopDependenceInfo *loop,
+                                std::set<SCC *> const &SCCsToPullOut,
+                                std::set<Instruction *> &instructionsRemoved,
+                                std::set<Instruction *> &instructionsAdded) {
+  return this->splitLoop(loop,
+                         SCCsToPullOut,
+                         instructionsRemoved,
+                         instructionsAdded,
+                         false);
+}
+
+bool LoopTransformer::splitLoop(LoopDependenceInfo *loop,
+                                std::set<SCC *> const &SCCsToPullOut,
+                                std::set<Instruction *> &instructionsRemoved,
+                                std::set<Instruction *> &instructionsAdded,
+                                bool forwardDataDependences) {
 
   /*
    * Check trivial cases
@@ -157,7 +2560,7 @@ bool LoopTransformer::splitLoop(LoopDependenceInfo *loop,
   /*
    * Split the loop.
    */
-  LoopDistribution ld;
+  LoopDistribution ld{ forwardDataDependences };
   auto modified = ld.splitLoop(*loop,
                                SCCsToPullOut,
                                instructionsRemoved,
@@ -43,6 +43,18 @@ public:
                        ScalarEvolution &SE,
                        AssumptionCache &AC);
 
+  /*
+   * Unroll the loop by @unrollFactor.
+   * The trip count does not need to be known at compile time: the iterations
+   * left over by the unrolled loop are executed by a remainder loop.
+   */
+  bool partiallyUnrollLoop(LoopDependenceInfo const &LDI,
+                           uint32_t unrollFactor,
+                           LoopInfo &LI,
+                           DominatorTree &DT,
+                           ScalarEvolution &SE,
+                           AssumptionCache &AC);
+
 private:
   /*
    * Fields
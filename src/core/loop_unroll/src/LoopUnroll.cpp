@@ -102,3 +102,88 @@ bool LoopUnroll::fullyUnrollLoop(LoopDependenceInfo const &LDI,
 
   return modified;
 }
+
+bool LoopUnroll::partiallyUnrollLoop(LoopDependenceInfo const &LDI,
+                                     uint32_t unrollFactor,
+                                     LoopInfo &LI,
+                                     DominatorTree &DT,
+                                     ScalarEvolution &SE,
+                                     AssumptionCache &AC) {
+
+  /*
+   * Check if there is anything to unroll.
+   */
+  if (unrollFactor <= 1) {
+    return false;
+  }
+
+  /*
+   * Fetch the loop summary
+   */
+  auto ls = LDI.getLoopStructure();
+
+  /*
+   * Check if the loop has the shape necessary to generate the remainder loop.
+   */
+  if (false || (ls->getPreHeader() == nullptr)
+      || (ls->getLatches().size() != 1)) {
+    return false;
+  }
+
+  /*
+   * Fetch the function that includes the loop.
+   */
+  auto loopFunction = ls->getFunction();
+
+  /*
+   * Fetch the LLVM loop.
+   */
+  auto h = ls->getHeader();
+  auto llvmLoop = LI.getLoopFor(h);
+  assert(llvmLoop != nullptr);
+
+  /*
+   * Try to unroll the loop.
+   * The trip count is 0 when it is not known at compile time, in which case
+   * the remainder is computed at run time.
+   */
+  UnrollLoopOptions opts;
+  opts.Count = unrollFactor;
+  opts.TripCount = SE.getSmallConstantTripCount(llvmLoop);
+  opts.Force = false;
+  opts.AllowRuntime = true;
+  opts.AllowExpensiveTripCount = true;
+  opts.PreserveCondBr = false;
+  opts.TripMultiple = SE.getSmallConstantTripMultiple(llvmLoop);
+  opts.PeelCount = 0;
+  opts.UnrollRemainder = false;
+  opts.ForgetAllSCEV = true;
+  OptimizationRemarkEmitter ORE(loopFunction);
+  auto unrolled = UnrollLoop(llvmLoop, opts, &LI, &SE, &DT, &AC, &ORE, true);
+
+  /*
+   * Check if the loop unrolled.
+   */
+  auto modified = false;
+  switch (unrolled) {
+    case LoopUnrollResult::FullyUnrolled:
+      errs() << "   Fully unrolled\n";
+      modified = true;
+      break;
+
+    case LoopUnrollResult::PartiallyUnrolled:
+      errs() << "   Partially unrolled by " << unrollFactor << "\n";
+      modified = true;
+      break;
+
+    case LoopUnrollResult::Unmodified:
+      errs() << "   Not unrolled\n";
+      modified = false;
+      break;
+
+    default:
+      abort();
+  }
+
+  return modified;
+}
@@ -21,6 +21,8 @@
  */
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/PDG.hpp"
 #include "noelle/core/SCCDAG.hpp"
@@ -37,6 +39,18 @@ namespace llvm::noelle {
 
 class LoopDependenceInfo {
 public:
+  /*
+   * Callbacks used to compute the analyses of a loop lazily.
+   * A provider invokes the consumer given as input with the function
+   * dependence graph, the LLVM loop, and the analyses of the function that
+   * includes the loop. These are valid only during the invocation.
+   */
+  typedef std::function<
+      void(PDG *fG, Loop *l, DominatorSummary &DS, ScalarEvolution &SE)>
+      AnalysesConsumer;
+  typedef std::function<void(AnalysesConsumer computeAnalyses)>
+      AnalysesProvider;
+
   /*
    * Constructors.
    */
@@ -96,8 +110,47 @@ public:
       bool enableLoopAwareDependenceAnalyses,
       uint32_t chunkSize);
 
+  /*
+   * Constructor that starts from the dependence graph of the loop @loopDG,
+   * which must have been created by fG->createLoopsSubgraph(l).
+   * The LDI takes the ownership of @loopDG.
+   */
+  LoopDependenceInfo(PDG *fG,
+                     PDG *loopDG,
+                     StayConnectedNestedLoopForestNode *loop,
+                     Loop *l,
+                     DominatorSummary &DS,
+                     ScalarEvolution &SE,
+                     uint32_t maxCores,
+                     bool enableFloatAsReal,
+                     bool enableLoopAwareDependenceAnalyses);
+
+  /*
+   * Lazy constructor: the dependence graph of the loop and the analyses that
+   * depend on it are computed by invoking @fetchAnalyses when one of them is
+   * requested for the first time.
+   */
+  LoopDependenceInfo(
+      StayConnectedNestedLoopForestNode *loop,
+      uint32_t maxCores,
+      bool enableFloatAsReal,
+      std::unordered_set<LoopDependenceInfoOptimization> optimizations,
+      bool enableLoopAwareDependenceAnalyses,
+      uint32_t chunkSize,
+      AnalysesProvider fetchAnalyses);
+
   LoopDependenceInfo() = delete;
 
+  /*
+   * Return true if the dependence graph of the loop and the analyses that
+   * depend on it have been computed.
+   *
+   * The analyses of a loop are computed the first time they are requested,
+   * and only once even if multiple threads request them at the same time.
+   * The const methods of the LDI can therefore be invoked concurrently.
+   */
+  bool isMaterialized(void) const;
+
   /*
    * Return the ID of the loop.
    */
@@ -164,6 +217,15 @@ public:
 
   uint64_t getCompileTimeTripCount(void) const;
 
+  /*
+   * Return the calls of the loop that write to FILE streams whose loop-carried
+   * dependences have been removed (see
+   * LoopDependenceInfoOptimization::BUFFERED_OUTPUT_ID).
+   * A parallelized loop must buffer the output of these calls per iteration
+   * and write it in the order of the iterations.
+   */
+  const std::unordered_set<CallBase *> &getCallsWithBufferedOutput(void) const;
+
   /*
    * Deconstructor.
    */
@@ -175,6 +237,22 @@ private:
    */
   StayConnectedNestedLoopForestNode *loop;
 
+  bool enableFloatAsReal;
+
+  AnalysesProvider analysesProvider; /* Set until the analyses are computed.
+                                      */
+
+  std::atomic<bool> materialized; /* Set once the analyses are computed.
+                                   */
+
+  static std::recursive_mutex
+      materializationMutex; /* Held while the analyses of a loop are computed.
+                             * The providers share the analyses of the
+                             * functions, so loops are materialized one at a
+                             * time. The mutex is recursive because computing
+                             * the analyses of a loop can query them.
+                             */
+
   LoopEnvironment *environment;
 
   PDG *loopDG; /* Dependence graph of the loop.
@@ -200,15 +278,32 @@ private:
 
   LoopTransformationsManager *loopTransformationsManager;
 
+  std::unordered_set<CallBase *> callsWithBufferedOutput;
+
+  ScalarEvolutionReferentialExpander
+      *referentialExpander; /* Set while the analyses are computed.
+                             * It is shared by the induction variable
+                             * managers computed for the loop.
+                             */
+
   /*
    * Methods
    */
+  void computeAnalyses(PDG *fG,
+                       PDG *precomputedLoopDG,
+                       Loop *l,
+                       DominatorSummary &DS,
+                       ScalarEvolution &SE);
+
+  void materialize(void) const;
+
   void fetchLoopAndBBInfo(Loop *l, ScalarEvolution &SE);
 
   std::pair<PDG *, SCCDAG *> createDGsForLoop(
       Loop *l,
       StayConnectedNestedLoopForestNode *loopNode,
       PDG *functionDG,
+      PDG *loopDG,
       DominatorSummary &DS,
       ScalarEvolution &SE);
 
@@ -216,15 +311,48 @@ private:
 
   void removeUnnecessaryDependenciesThatCloningMemoryNegates(
       StayConnectedNestedLoopForestNode *loopNode,
+      PDG *loopDG,
       PDG *loopInternalDG,
+      SCCDAG *loopSCCDAG,
       DominatorSummary &DS);
 
   void removeUnnecessaryDependenciesWithThreadSafeLibraryFunctions(
       StayConnectedNestedLoopForestNode *loopNode,
       PDG *loopDG,
+      PDG *loopInternalDG,
+      SCCDAG *loopSCCDAG,
       DominatorSummary &DS);
 
+  void removeUnnecessaryDependenciesOfParallelLoop(
+      StayConnectedNestedLoopForestNode *loopNode,
+      PDG *loopDG);
+
+  void removeUnnecessaryDependenciesWithBufferedOutput(
+      StayConnectedNestedLoopForestNode *loopNode,
+      PDG *loopDG,
+      PDG *loopInternalDG,
+      SCCDAG *loopSCCDAG);
+
+  /*
+   * Remove @edges from @loopDG.
+   * If the SCCDAG of the loop has been built already, then their copies are
+   * removed from @loopInternalDG, the graph of @loopSCCDAG, and only the SCCs
+   * they connect are recomputed (see SCCDAG::splitSCCs).
+   */
+  void removeDependences(std::unordered_set<DGEdge<Value> *> &edges,
+                         PDG *loopDG,
+                         PDG *loopInternalDG,
+                         SCCDAG *loopSCCDAG);
+
+  static DGEdge<Value> *fetchCopyOfDependence(PDG *graph, DGEdge<Value> *edge);
+
   SCCDAG *computeSCCDAGWithOnlyVariableAndControlDependences(PDG *loopDG);
+
+  InductionVariableManager *computeInductionVariables(InvariantManager &IVM,
+                                                      ScalarEvolution &SE,
+                                                      SCCDAG &sccdag,
+                                                      LoopEnvironment &env,
+                                                      Loop &l);
 };
 
 } // namespace llvm::noelle
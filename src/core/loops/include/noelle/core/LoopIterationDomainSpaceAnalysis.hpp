@@ -51,6 +51,41 @@ public:
       Instruction *from,
       Instruction *to) const;
 
+  /*
+   * Check if the memory locations @I accesses are known for every iteration
+   * of the loop: every subscript of the access is governed by an induction
+   * variable.
+   * The range of such accesses can then be computed before running the loop.
+   */
+  bool isMemoryAccessSpaceKnown(Instruction *I) const;
+
+  /*
+   * Return the number of iterations of the loop between an instance of @from
+   * and the instance of @to that accesses the same memory location, if this
+   * is the same for every iteration (e.g., 2 between a store to A[i+2] and a
+   * load from A[i]).
+   *
+   * @return 0 if the distance is unknown, or if @to never accesses the
+   * location accessed by @from in a later iteration.
+   */
+  uint64_t getDependenceDistanceBetweenIterations(Instruction *from,
+                                                  Instruction *to) const;
+
+  /*
+   * Check if the instances of @from and @to that access the same memory
+   * location are always the same number of iterations of the loop apart, and
+   * they run at the same iteration of @nestedLoop, which is nested in the loop
+   * (e.g., a store to A[i][j] and a load from A[i-1][j] for the loop i and its
+   * nested loop j).
+   * If so, the number of iterations is stored in @distance. This is 0 if they
+   * access the same locations only within an iteration of the loop, and it is
+   * negative if @to accesses them in an earlier iteration than @from.
+   */
+  bool getDependenceDistanceBetweenIterations(Instruction *from,
+                                              Instruction *to,
+                                              LoopStructure *nestedLoop,
+                                              int64_t &distance) const;
+
 private:
   /*
    * Long-lived references
@@ -69,6 +104,50 @@ private:
 
   void indexIVInstructionSCEVs(ScalarEvolution &SE);
 
+  /*
+   * Delinearized form of an access function: the SCEV of each dimension's
+   * subscript and size.
+   */
+  class DelinearizedAccess {
+  public:
+    SmallVector<const SCEV *, 4> subscripts;
+    SmallVector<const SCEV *, 4> sizes;
+  };
+
+  /*
+   * Delinearizations keyed by (base pointer, accessor SCEV, element size).
+   * SCEVs are uniqued by their ScalarEvolution, so the cache is shared by the
+   * analyses of all loops (e.g., the loops of a nest) that use the same one.
+   */
+  class DelinearizationCache {
+  public:
+    DelinearizationCache(ScalarEvolution &SE);
+
+    ScalarEvolution *SE;
+    std::map<std::tuple<const SCEV *, const SCEV *, const SCEV *>,
+             DelinearizedAccess>
+        accesses;
+  };
+
+  std::shared_ptr<DelinearizationCache> delinearizationCache;
+
+  /*
+   * The cache of the analyses that are currently alive.
+   * It is released when the last of them is destroyed.
+   */
+  static std::weak_ptr<DelinearizationCache> liveDelinearizationCache;
+
+  bool computeDependenceDistanceBetweenIterations(Instruction *from,
+                                                  Instruction *to,
+                                                  LoopStructure *nestedLoop,
+                                                  int64_t &distance) const;
+
+  const DelinearizedAccess *fetchDelinearization(
+      ScalarEvolution &SE,
+      const SCEVUnknown *basePointer,
+      const SCEV *accessorSCEV,
+      const SCEV *elementSize);
+
   class MemoryAccessSpace {
   public:
     MemoryAccessSpace(Instruction *memoryAccessor);
@@ -88,6 +167,12 @@ private:
     SmallVector<const SCEV *, 4> sizes;
     const SCEV *elementSize;
 
+    /*
+     * The cached delinearization the subscripts and sizes come from, if any.
+     * Spaces with the same canonical form have the same subscripts.
+     */
+    const DelinearizedAccess *canonicalForm;
+
     /*
      * Track the instruction and the IV corresponding to each subscript
      * This instruction may either be
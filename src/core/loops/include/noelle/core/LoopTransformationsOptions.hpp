@@ -26,6 +26,29 @@
 
 namespace llvm::noelle {
 
+/*
+ * Policies to distribute DOALL chunks among cores.
+ * The numerical values are shared with the NOELLE runtime.
+ */
+enum DOALLChunkScheduling {
+  DOALL_STATIC_SCHEDULING = 0,
+  DOALL_DYNAMIC_SCHEDULING = 1,
+  DOALL_GUIDED_SCHEDULING = 2
+};
+
+/*
+ * Mechanisms HELIX can use to synchronize sequential segments.
+ *
+ * With HELIX_DYNAMIC_SYNCHRONIZATION, cores claim the next iteration to run
+ * from a shared ticket rather than running every N-th one, and each sequential
+ * segment waits for the iteration that precedes the claimed one.
+ */
+enum HELIXSynchronization {
+  HELIX_SPINLOCK_SYNCHRONIZATION = 0,
+  HELIX_ADAPTIVE_SYNCHRONIZATION = 1,
+  HELIX_DYNAMIC_SYNCHRONIZATION = 2
+};
+
 class LoopTransformationsManager {
 public:
   LoopTransformationsManager(
@@ -38,8 +61,34 @@ public:
 
   uint32_t getChunkSize(void) const;
 
+  void setChunkSize(uint32_t chunkSize);
+
   uint32_t getMaximumNumberOfCores(void) const;
 
+  void setMaximumNumberOfCores(uint32_t cores);
+
+  /*
+   * Policy used to assign DOALL chunks to cores.
+   */
+  DOALLChunkScheduling getDOALLChunkScheduling(void) const;
+
+  void setDOALLChunkScheduling(DOALLChunkScheduling scheduling);
+
+  /*
+   * Mechanism used by HELIX to synchronize sequential segments.
+   */
+  HELIXSynchronization getHELIXSynchronization(void) const;
+
+  void setHELIXSynchronization(HELIXSynchronization synchronization);
+
+  /*
+   * Number of iterations of the loop to execute per iteration of its unrolled
+   * version before parallelizing it (1 means no unrolling).
+   */
+  uint32_t getUnrollFactor(void) const;
+
+  void setUnrollFactor(uint32_t unrollFactor);
+
   /*
    * Check whether a transformation is enabled.
    */
@@ -65,6 +114,9 @@ public:
 private:
   uint32_t chunkSize;
   uint32_t maxCores;
+  DOALLChunkScheduling doallScheduling;
+  HELIXSynchronization helixSynchronization;
+  uint32_t unrollFactor;
   std::set<Transformation>
       enabledTransformations; /* Transformations enabled. */
   std::unordered_set<LoopDependenceInfoOptimization>
@@ -49,14 +49,26 @@ private:
 
 class ClonableMemoryLocation {
 public:
-  ClonableMemoryLocation(AllocaInst *allocation,
+  ClonableMemoryLocation(Value *object,
                          uint64_t sizeInBits,
                          LoopStructure *loop,
                          DominatorSummary &DS,
                          PDG *ldg);
 
+  /*
+   * Return the stack object, or nullptr if the location is a heap object or a
+   * global variable.
+   */
   AllocaInst *getAllocation(void) const;
 
+  Value *getMemoryObject(void) const;
+
+  bool isStackObject(void) const;
+  bool isHeapObject(void) const;
+  bool isGlobalObject(void) const;
+
+  uint64_t getSizeInBytes(void) const;
+
   std::unordered_set<Instruction *> getLoopInstructionsUsingLocation(
       void) const;
 
@@ -73,7 +85,12 @@ public:
 
   static bool isMemCpyInstrinsicCall(CallInst *call);
 
+  static bool isMemSetInstrinsicCall(CallInst *call);
+
+  static bool isFreeCall(CallInst *call);
+
 private:
+  Value *object;
   AllocaInst *allocation;
   Type *allocatedType;
   uint64_t sizeInBits;
@@ -88,16 +105,21 @@ private:
 
   bool identifyStoresAndOtherUsers(LoopStructure *loop, DominatorSummary &DS);
 
+  bool areUsesPrivatizable(LoopStructure *loop) const;
+
   bool isThereRAWThroughMemoryFromOutsideLoop(LoopStructure *loop,
-                                              AllocaInst *al,
+                                              Value *al,
                                               PDG *ldg) const;
 
   bool isThereRAWThroughMemoryFromOutsideLoop(
       LoopStructure *loop,
-      AllocaInst *al,
+      Value *al,
       PDG *ldg,
       std::unordered_set<Instruction *> insts) const;
 
+  bool canReadsObserveValuesOfOtherIterations(LoopStructure *loop,
+                                              PDG *ldg) const;
+
   /*
    * A set of storing instructions that completely override the allocation's
    * values before any use it dominates gets to using the allocation
@@ -117,7 +139,7 @@ private:
   bool isOverrideSetFullyCoveringTheAllocationSpace(
       OverrideSet *overrideSet) const;
 
-  void setObjectScope(AllocaInst *allocation,
+  void setObjectScope(Value *object,
                       LoopStructure *loop,
                       DominatorSummary &ds);
 };
@@ -107,11 +107,21 @@ public:
   bool isInductionVariableSCC(void) const;
 
   /*
-   * Return true if the SCC is commutative
+   * Return true if the SCC is commutative (i.e., its loop-carried data
+   * dependences are between operations that can run in any order, like calls
+   * to commutative functions).
    * Return false otherwise.
    */
   bool isCommutative(void) const;
 
+  /*
+   * Return the instruction that updates the variable of the SCC if the SCC
+   * computes the prefix (i.e., the scan) of an associative operation whose
+   * intermediate values are used by the loop (e.g., s = s + a[i]; x[i] = s).
+   * Return nullptr otherwise.
+   */
+  Instruction *getScanOperation(void) const;
+
   /*
    * Get the PHIs.
    */
@@ -169,7 +179,7 @@ public:
    * Return the memory locations that can be safely clone to void reusing the
    * same memory locations between invocations of this SCC.
    */
-  std::unordered_set<AllocaInst *> getMemoryLocationsToClone(void) const;
+  std::unordered_set<Value *> getMemoryLocationsToClone(void) const;
 
   /*
    * Add a loop carried cycle
@@ -193,6 +203,16 @@ public:
 
   void setSCCToBeClonableUsingLocalMemory(void);
 
+  /*
+   * Set the SCC to be commutative.
+   */
+  void setSCCToBeCommutative(bool isCommutative = true);
+
+  /*
+   * Set the SCC to compute a prefix with @operation.
+   */
+  void setSCCToBeScan(Instruction *operation);
+
   void addClonableMemoryLocationsContainedInSCC(
       std::unordered_set<const ClonableMemoryLocation *> locations);
 
@@ -215,6 +235,7 @@ private:
   bool isClonable;
   bool hasIV;
   bool commutative;
+  Instruction *scanOperation;
 
   void collectPHIsAndAccumulators(LoopStructure &LS);
   void collectControlFlowInstructions(void);
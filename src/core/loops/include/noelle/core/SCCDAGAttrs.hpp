@@ -129,8 +129,14 @@ private:
   /*
    * Helper methods on single SCC
    */
+  void classifySCC(SCC *scc,
+                   ScalarEvolution &SE,
+                   StayConnectedNestedLoopForestNode *loopNode);
   bool checkIfReducible(SCC *scc, StayConnectedNestedLoopForestNode *loop);
   bool checkIfIndependent(SCC *scc);
+  bool checkIfCommutative(SCC *scc);
+  Instruction *getOperationOfScan(SCC *scc,
+                                  StayConnectedNestedLoopForestNode *loop);
   bool checkIfSCCOnlyContainsInductionVariables(
       SCC *scc,
       StayConnectedNestedLoopForestNode *loop,
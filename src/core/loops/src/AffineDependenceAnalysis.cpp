@@ -0,0 +1,797 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/ScalarEvolutionDelinearization.hpp"
+#include "AffineDependenceAnalysis.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Copies of the variables of a dependence system.
+ * The iterations of the loops that include the loop analyzed, and the values
+ * invariant in the loop analyzed, are shared by the two instructions.
+ */
+static const uint32_t fromCopy = 0;
+static const uint32_t toCopy = 1;
+static const uint32_t sharedCopy = 2;
+
+/*
+ * Maximum number of inequalities of a system during its elimination.
+ * Systems that grow beyond it are considered feasible.
+ */
+static const uint64_t maximumNumberOfInequalities = 1024;
+
+static int64_t computeGCD(int64_t a, int64_t b) {
+  while (b != 0) {
+    auto t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+static int64_t divideAndRoundDown(int64_t a, int64_t b) {
+  assert(b > 0);
+  auto q = a / b;
+  if (true && ((a % b) != 0) && (a < 0)) {
+    q--;
+  }
+
+  return q;
+}
+
+/*
+ * Compute @a += @factor * @b.
+ * Return false if the result does not fit in 64 bits.
+ */
+static bool addScaled(int64_t &a, int64_t factor, int64_t b) {
+  int64_t product;
+  if (__builtin_mul_overflow(factor, b, &product)) {
+    return false;
+  }
+  if (__builtin_add_overflow(a, product, &a)) {
+    return false;
+  }
+
+  return true;
+}
+
+/*
+ * Fetch the pointer and the number of bytes accessed by @inst.
+ */
+static bool fetchAccess(Instruction *inst, Value *&pointer, uint64_t &bytes) {
+  auto &DL = inst->getModule()->getDataLayout();
+  if (auto load = dyn_cast<LoadInst>(inst)) {
+    pointer = load->getPointerOperand();
+    bytes = DL.getTypeStoreSize(load->getType());
+    return true;
+  }
+  if (auto store = dyn_cast<StoreInst>(inst)) {
+    pointer = store->getPointerOperand();
+    bytes = DL.getTypeStoreSize(store->getValueOperand()->getType());
+    return true;
+  }
+
+  return false;
+}
+
+AffineDependenceAnalysis::AffineDependenceAnalysis(Loop *loop,
+                                                   ScalarEvolution &SE)
+  : loop{ loop },
+    SE{ SE } {
+
+  return;
+}
+
+bool AffineDependenceAnalysis::canAccessTheSameLocationAcrossIterations(
+    Instruction *from,
+    Instruction *to) {
+  if (this->canAccessTheSameLocation(from, to, EARLIER)) {
+    return true;
+  }
+  if (this->canAccessTheSameLocation(from, to, LATER)) {
+    return true;
+  }
+
+  return false;
+}
+
+bool AffineDependenceAnalysis::canAccessTheSameLocationWithinAnIteration(
+    Instruction *from,
+    Instruction *to) {
+  return this->canAccessTheSameLocation(from, to, SAME);
+}
+
+bool AffineDependenceAnalysis::canAccessTheSameLocation(Instruction *from,
+                                                        Instruction *to,
+                                                        IterationOrder order) {
+  if (false || (!this->loop->contains(from)) || (!this->loop->contains(to))) {
+    return true;
+  }
+
+  /*
+   * Fetch the iterations of the loop analyzed that run the two instructions.
+   */
+  DependenceSystem system{ this->loop, this->SE };
+  auto fromIteration = system.fetchIteration(this->loop, fromCopy);
+  auto toIteration = system.fetchIteration(this->loop, toCopy);
+
+  /*
+   * Add the constraints of the locations accessed.
+   */
+  if (!this->addAccessConstraints(system, from, to)) {
+    return true;
+  }
+
+  /*
+   * Add the order between the iterations.
+   */
+  AffineExpression orderExpression{ 0 };
+  switch (order) {
+    case EARLIER:
+      orderExpression.constant = -1;
+      orderExpression.coefficients[toIteration] = 1;
+      orderExpression.coefficients[fromIteration] = -1;
+      system.addInequality(orderExpression);
+      break;
+    case LATER:
+      orderExpression.constant = -1;
+      orderExpression.coefficients[fromIteration] = 1;
+      orderExpression.coefficients[toIteration] = -1;
+      system.addInequality(orderExpression);
+      break;
+    case SAME:
+      orderExpression.coefficients[fromIteration] = 1;
+      orderExpression.coefficients[toIteration] = -1;
+      system.addEquality(orderExpression);
+      break;
+  }
+
+  return system.isFeasible();
+}
+
+bool AffineDependenceAnalysis::addAccessConstraints(DependenceSystem &system,
+                                                    Instruction *from,
+                                                    Instruction *to) {
+
+  /*
+   * Fetch the addresses accessed.
+   * They must be offsets from the same base pointer.
+   */
+  Value *fromPointer;
+  Value *toPointer;
+  uint64_t fromBytes;
+  uint64_t toBytes;
+  if (false || (!fetchAccess(from, fromPointer, fromBytes))
+      || (!fetchAccess(to, toPointer, toBytes))) {
+    return false;
+  }
+  auto fromAddress = this->SE.getSCEV(fromPointer);
+  auto toAddress = this->SE.getSCEV(toPointer);
+  auto base = dyn_cast<SCEVUnknown>(this->SE.getPointerBase(fromAddress));
+  if (false || (base == nullptr)
+      || (base != this->SE.getPointerBase(toAddress))) {
+    return false;
+  }
+  auto fromOffset = this->SE.getMinusSCEV(fromAddress, base);
+  auto toOffset = this->SE.getMinusSCEV(toAddress, base);
+
+  /*
+   * Check if the offsets are affine.
+   * If they are, then the bytes accessed overlap if the difference between
+   * the offsets is smaller than the bytes accessed.
+   */
+  AffineExpression fromExpression{ 0 };
+  AffineExpression toExpression{ 0 };
+  if (true
+      && system.translate(fromOffset,
+                          from->getParent(),
+                          fromCopy,
+                          fromExpression)
+      && system.translate(toOffset, to->getParent(), toCopy, toExpression)) {
+    AffineExpression fromFirst{ (int64_t)toBytes - 1 };
+    AffineExpression toFirst{ (int64_t)fromBytes - 1 };
+    if (false || (!fromFirst.add(toExpression, 1))
+        || (!fromFirst.add(fromExpression, -1))
+        || (!toFirst.add(fromExpression, 1))
+        || (!toFirst.add(toExpression, -1))) {
+      return false;
+    }
+    system.addInequality(fromFirst);
+    system.addInequality(toFirst);
+    return true;
+  }
+
+  /*
+   * The offsets are not affine (e.g., A[i*n + j]).
+   * Delinearize them.
+   * Both accesses must be whole elements of an array with the same sizes.
+   */
+  auto elementSize = this->SE.getElementSize(from);
+  auto constantElementSize = dyn_cast<SCEVConstant>(elementSize);
+  if (false || (constantElementSize == nullptr)
+      || (elementSize != this->SE.getElementSize(to))
+      || (constantElementSize->getAPInt() != fromBytes)
+      || (fromBytes != toBytes)) {
+    return false;
+  }
+  SmallVector<const SCEV *, 4> fromSubscripts;
+  SmallVector<const SCEV *, 4> fromSizes;
+  SmallVector<const SCEV *, 4> toSubscripts;
+  SmallVector<const SCEV *, 4> toSizes;
+  ScalarEvolutionDelinearization::delinearize(this->SE,
+                                              fromOffset,
+                                              fromSubscripts,
+                                              fromSizes,
+                                              elementSize);
+  ScalarEvolutionDelinearization::delinearize(this->SE,
+                                              toOffset,
+                                              toSubscripts,
+                                              toSizes,
+                                              elementSize);
+  if (false || (fromSubscripts.size() < 2)
+      || (fromSubscripts.size() != fromSizes.size())
+      || (fromSubscripts.size() != toSubscripts.size())
+      || (fromSizes != toSizes)) {
+    return false;
+  }
+
+  /*
+   * Check that the subscripts identify the offsets.
+   * This is the case if the offsets are their linearization, and if the
+   * subscripts of the inner dimensions do not exceed the sizes of the
+   * dimensions.
+   */
+  auto isLinearization = [this](const SCEV *offset,
+                                SmallVectorImpl<const SCEV *> &subscripts,
+                                SmallVectorImpl<const SCEV *> &sizes) -> bool {
+    for (auto S : subscripts) {
+      if (S->getType() != offset->getType()) {
+        return false;
+      }
+    }
+    for (auto S : sizes) {
+      if (S->getType() != offset->getType()) {
+        return false;
+      }
+    }
+    auto linearization = subscripts[0];
+    for (auto d = 1u; d < subscripts.size(); d++) {
+      linearization =
+          this->SE.getAddExpr(this->SE.getMulExpr(linearization, sizes[d - 1]),
+                              subscripts[d]);
+    }
+    linearization = this->SE.getMulExpr(linearization, sizes.back());
+    return (linearization == offset);
+  };
+  if (false || (!isLinearization(fromOffset, fromSubscripts, fromSizes))
+      || (!isLinearization(toOffset, toSubscripts, toSizes))
+      || (!this->areSubscriptsWithinTheirDimensions(from,
+                                                    fromSubscripts,
+                                                    fromSizes))
+      || (!this->areSubscriptsWithinTheirDimensions(to,
+                                                    toSubscripts,
+                                                    toSizes))) {
+    return false;
+  }
+
+  /*
+   * The two instructions access the same element if all their subscripts are
+   * the same.
+   */
+  for (auto d = 0u; d < fromSubscripts.size(); d++) {
+    AffineExpression fromSubscript{ 0 };
+    AffineExpression toSubscript{ 0 };
+    if (false
+        || (!system.translate(fromSubscripts[d],
+                              from->getParent(),
+                              fromCopy,
+                              fromSubscript))
+        || (!system.translate(toSubscripts[d],
+                              to->getParent(),
+                              toCopy,
+                              toSubscript))
+        || (!fromSubscript.add(toSubscript, -1))) {
+      return false;
+    }
+    system.addEquality(fromSubscript);
+  }
+
+  return true;
+}
+
+bool AffineDependenceAnalysis::areSubscriptsWithinTheirDimensions(
+    Instruction *inst,
+    SmallVectorImpl<const SCEV *> const &subscripts,
+    SmallVectorImpl<const SCEV *> const &sizes) {
+  for (auto d = 1u; d < subscripts.size(); d++) {
+
+    /*
+     * Check if the subscript can be negative.
+     */
+    DependenceSystem negative{ this->loop, this->SE };
+    AffineExpression subscript{ 0 };
+    if (!negative.translate(subscripts[d],
+                            inst->getParent(),
+                            fromCopy,
+                            subscript)) {
+      return false;
+    }
+    AffineExpression belowZero{ -1 };
+    if (!belowZero.add(subscript, -1)) {
+      return false;
+    }
+    negative.addInequality(belowZero);
+    if (negative.isFeasible()) {
+      return false;
+    }
+
+    /*
+     * Check if the subscript can reach the size of its dimension.
+     */
+    DependenceSystem overflowing{ this->loop, this->SE };
+    AffineExpression size{ 0 };
+    if (false
+        || (!overflowing.translate(subscripts[d],
+                                   inst->getParent(),
+                                   fromCopy,
+                                   subscript))
+        || (!overflowing.translate(sizes[d - 1],
+                                   inst->getParent(),
+                                   fromCopy,
+                                   size))
+        || (!subscript.add(size, -1))) {
+      return false;
+    }
+    overflowing.addInequality(subscript);
+    if (overflowing.isFeasible()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+AffineDependenceAnalysis::AffineExpression::AffineExpression(int64_t constant)
+  : constant{ constant } {
+
+  return;
+}
+
+bool AffineDependenceAnalysis::AffineExpression::add(
+    AffineExpression const &other,
+    int64_t factor) {
+  if (!addScaled(this->constant, factor, other.constant)) {
+    return false;
+  }
+  for (auto &variableCoefficient : other.coefficients) {
+    auto &coefficient = this->coefficients[variableCoefficient.first];
+    if (!addScaled(coefficient, factor, variableCoefficient.second)) {
+      return false;
+    }
+    if (coefficient == 0) {
+      this->coefficients.erase(variableCoefficient.first);
+    }
+  }
+
+  return true;
+}
+
+AffineDependenceAnalysis::DependenceSystem::DependenceSystem(
+    Loop *loop,
+    ScalarEvolution &SE)
+  : loop{ loop },
+    SE{ SE } {
+
+  return;
+}
+
+uint32_t AffineDependenceAnalysis::DependenceSystem::fetchIteration(
+    const Loop *l,
+    uint32_t copy) {
+
+  /*
+   * The iterations of the loops that include the loop analyzed are shared.
+   */
+  if (!this->loop->contains(l)) {
+    copy = sharedCopy;
+  }
+
+  /*
+   * Check if the variable exists already.
+   */
+  auto key = std::make_pair((const void *)l, copy);
+  auto found = this->variables.find(key);
+  if (found != this->variables.end()) {
+    return found->second;
+  }
+  uint32_t variable = this->variables.size();
+  this->variables[key] = variable;
+
+  /*
+   * Bound the iteration: 0 <= iteration <= backedges taken.
+   * The upper bound is added only if it is affine.
+   */
+  AffineExpression iteration{ 0 };
+  iteration.coefficients[variable] = 1;
+  this->addInequality(iteration);
+  auto backedges = this->SE.getBackedgeTakenCount(l);
+  AffineExpression upperBound{ 0 };
+  if (true && (!isa<SCEVCouldNotCompute>(backedges))
+      && this->translate(backedges, l->getHeader(), copy, upperBound)
+      && upperBound.add(iteration, -1)) {
+    this->addInequality(upperBound);
+  }
+
+  return variable;
+}
+
+bool AffineDependenceAnalysis::DependenceSystem::translate(
+    const SCEV *S,
+    BasicBlock *scope,
+    uint32_t copy,
+    AffineExpression &expression) {
+  expression = AffineExpression{ 0 };
+
+  /*
+   * Constants.
+   */
+  if (auto constant = dyn_cast<SCEVConstant>(S)) {
+    auto &value = constant->getAPInt();
+    if (value.getMinSignedBits() > 64) {
+      return false;
+    }
+    expression.constant = value.getSExtValue();
+    return true;
+  }
+
+  /*
+   * Sums.
+   */
+  if (auto sum = dyn_cast<SCEVAddExpr>(S)) {
+    auto isAffine = true;
+    for (auto op : sum->operands()) {
+      AffineExpression opExpression{ 0 };
+      if (false || (!this->translate(op, scope, copy, opExpression))
+          || (!expression.add(opExpression, 1))) {
+        isAffine = false;
+        break;
+      }
+    }
+    if (isAffine) {
+      return true;
+    }
+  }
+
+  /*
+   * Products by a constant.
+   */
+  if (auto product = dyn_cast<SCEVMulExpr>(S)) {
+    int64_t factor = 1;
+    std::vector<const SCEV *> terms;
+    auto isAffine = true;
+    for (auto op : product->operands()) {
+      auto constant = dyn_cast<SCEVConstant>(op);
+      if (constant == nullptr) {
+        terms.push_back(op);
+        continue;
+      }
+      auto &value = constant->getAPInt();
+      if (false || (value.getMinSignedBits() > 64)
+          || __builtin_mul_overflow(factor, value.getSExtValue(), &factor)) {
+        isAffine = false;
+      }
+    }
+    AffineExpression term{ 0 };
+    if (true && isAffine && (terms.size() == 1)
+        && this->translate(terms[0], scope, copy, term)) {
+      expression = AffineExpression{ 0 };
+      if (expression.add(term, factor)) {
+        return true;
+      }
+    }
+  }
+
+  /*
+   * Induction variables: start + step * iteration.
+   * The step must be a constant, and the loop must include the scope where the
+   * expression is evaluated.
+   */
+  if (auto recurrence = dyn_cast<SCEVAddRecExpr>(S)) {
+    auto step =
+        dyn_cast<SCEVConstant>(recurrence->getStepRecurrence(this->SE));
+    auto recurrenceLoop = recurrence->getLoop();
+    if (true && recurrence->isAffine() && (step != nullptr)
+        && (step->getAPInt().getMinSignedBits() <= 64)
+        && recurrenceLoop->contains(scope)) {
+      AffineExpression start{ 0 };
+      if (this->translate(recurrence->getStart(), scope, copy, start)) {
+        auto iteration = this->fetchIteration(recurrenceLoop, copy);
+        AffineExpression iterationExpression{ 0 };
+        iterationExpression.coefficients[iteration] = 1;
+        expression = start;
+        if (expression.add(iterationExpression,
+                           step->getAPInt().getSExtValue())) {
+          return true;
+        }
+      }
+    }
+  }
+
+  /*
+   * Extensions of induction variables that do not wrap.
+   */
+  if (auto extension = dyn_cast<SCEVSignExtendExpr>(S)) {
+    auto recurrence = dyn_cast<SCEVAddRecExpr>(extension->getOperand());
+    if (true && (recurrence != nullptr) && recurrence->hasNoSignedWrap()
+        && this->translate(recurrence, scope, copy, expression)) {
+      return true;
+    }
+  }
+  if (auto extension = dyn_cast<SCEVZeroExtendExpr>(S)) {
+    auto recurrence = dyn_cast<SCEVAddRecExpr>(extension->getOperand());
+    if (true && (recurrence != nullptr) && recurrence->hasNoUnsignedWrap()
+        && this->translate(recurrence, scope, copy, expression)) {
+      return true;
+    }
+  }
+
+  /*
+   * Values invariant in the loop analyzed are parameters of the system.
+   */
+  if (this->SE.isLoopInvariant(S, this->loop)) {
+    auto key = std::make_pair((const void *)S, sharedCopy);
+    auto found = this->variables.find(key);
+    uint32_t variable;
+    if (found != this->variables.end()) {
+      variable = found->second;
+    } else {
+      variable = this->variables.size();
+      this->variables[key] = variable;
+    }
+    expression = AffineExpression{ 0 };
+    expression.coefficients[variable] = 1;
+    return true;
+  }
+
+  return false;
+}
+
+void AffineDependenceAnalysis::DependenceSystem::addInequality(
+    AffineExpression const &expression) {
+  this->inequalities.push_back(expression);
+
+  return;
+}
+
+void AffineDependenceAnalysis::DependenceSystem::addEquality(
+    AffineExpression const &expression) {
+  this->equalities.push_back(expression);
+
+  return;
+}
+
+bool AffineDependenceAnalysis::DependenceSystem::isFeasible(void) const {
+
+  /*
+   * Represent the constraints as rows of coefficients.
+   * The last element of a row is its constant.
+   */
+  auto numberOfVariables = this->variables.size();
+  typedef std::vector<int64_t> Row;
+  auto toRow = [numberOfVariables](AffineExpression const &e) -> Row {
+    Row row(numberOfVariables + 1, 0);
+    for (auto &variableCoefficient : e.coefficients) {
+      row[variableCoefficient.first] = variableCoefficient.second;
+    }
+    row[numberOfVariables] = e.constant;
+    return row;
+  };
+  std::vector<Row> equalities;
+  std::vector<Row> inequalities;
+  for (auto &e : this->equalities) {
+    equalities.push_back(toRow(e));
+  }
+  for (auto &e : this->inequalities) {
+    inequalities.push_back(toRow(e));
+  }
+
+  /*
+   * Divide the coefficients of a row by their greatest common divisor.
+   * The divisor is returned; it is 0 if all coefficients are 0.
+   */
+  auto fetchDivisor = [numberOfVariables](Row const &row) -> int64_t {
+    int64_t divisor = 0;
+    for (auto i = 0u; i < numberOfVariables; i++) {
+      if (row[i] == INT64_MIN) {
+        return -1;
+      }
+      divisor = computeGCD(divisor, std::abs(row[i]));
+    }
+    return divisor;
+  };
+
+  /*
+   * Eliminate the equalities.
+   * A variable with a unit coefficient is replaced in all the other
+   * constraints. The equalities without such a variable become a pair of
+   * inequalities.
+   */
+  while (equalities.size() > 0) {
+    auto row = equalities.back();
+    equalities.pop_back();
+    auto divisor = fetchDivisor(row);
+    if (divisor < 0) {
+      return true;
+    }
+    if (divisor == 0) {
+      if (row[numberOfVariables] != 0) {
+        return false;
+      }
+      continue;
+    }
+    if ((row[numberOfVariables] % divisor) != 0) {
+      return false;
+    }
+    for (auto &coefficient : row) {
+      coefficient /= divisor;
+    }
+    auto pivot = numberOfVariables;
+    for (auto i = 0u; i < numberOfVariables; i++) {
+      if (std::abs(row[i]) == 1) {
+        pivot = i;
+        break;
+      }
+    }
+    if (pivot == numberOfVariables) {
+      inequalities.push_back(row);
+      for (auto &coefficient : row) {
+        coefficient = -coefficient;
+      }
+      inequalities.push_back(row);
+      continue;
+    }
+    auto substitute = [&row, pivot](Row &other) -> bool {
+      auto factor = other[pivot] * row[pivot];
+      if (factor == 0) {
+        return true;
+      }
+      for (auto i = 0u; i < row.size(); i++) {
+        if (!addScaled(other[i], -factor, row[i])) {
+          return false;
+        }
+      }
+      return true;
+    };
+    for (auto &other : equalities) {
+      if (!substitute(other)) {
+        return true;
+      }
+    }
+    for (auto &other : inequalities) {
+      if (!substitute(other)) {
+        return true;
+      }
+    }
+  }
+
+  /*
+   * Eliminate the variables of the inequalities one at a time.
+   */
+  while (true) {
+
+    /*
+     * Tighten the inequalities to integers, and check the ones without
+     * variables.
+     */
+    std::vector<Row> tightened;
+    for (auto &row : inequalities) {
+      auto divisor = fetchDivisor(row);
+      if (divisor < 0) {
+        return true;
+      }
+      if (divisor == 0) {
+        if (row[numberOfVariables] < 0) {
+          return false;
+        }
+        continue;
+      }
+      if (divisor > 1) {
+        for (auto i = 0u; i < numberOfVariables; i++) {
+          row[i] /= divisor;
+        }
+        row[numberOfVariables] =
+            divideAndRoundDown(row[numberOfVariables], divisor);
+      }
+      tightened.push_back(row);
+    }
+    std::sort(tightened.begin(), tightened.end());
+    tightened.erase(std::unique(tightened.begin(), tightened.end()),
+                    tightened.end());
+
+    /*
+     * Pick the variable whose elimination adds the fewest inequalities.
+     */
+    auto variable = numberOfVariables;
+    int64_t variableCost = 0;
+    for (auto i = 0u; i < numberOfVariables; i++) {
+      int64_t positives = 0;
+      int64_t negatives = 0;
+      for (auto &row : tightened) {
+        if (row[i] > 0) {
+          positives++;
+        } else if (row[i] < 0) {
+          negatives++;
+        }
+      }
+      if ((positives + negatives) == 0) {
+        continue;
+      }
+      auto cost = (positives * negatives) - positives - negatives;
+      if (false || (variable == numberOfVariables) || (cost < variableCost)) {
+        variable = i;
+        variableCost = cost;
+      }
+    }
+    if (variable == numberOfVariables) {
+      return true;
+    }
+
+    /*
+     * Eliminate the variable.
+     * Every pair of a lower and an upper bound of the variable becomes an
+     * inequality without it.
+     */
+    std::vector<Row> eliminated;
+    for (auto &row : tightened) {
+      if (row[variable] == 0) {
+        eliminated.push_back(row);
+      }
+    }
+    for (auto &lower : tightened) {
+      if (lower[variable] <= 0) {
+        continue;
+      }
+      for (auto &upper : tightened) {
+        if (upper[variable] >= 0) {
+          continue;
+        }
+        Row combined(numberOfVariables + 1, 0);
+        for (auto i = 0u; i <= numberOfVariables; i++) {
+          if (false || (!addScaled(combined[i], -upper[variable], lower[i]))
+              || (!addScaled(combined[i], lower[variable], upper[i]))) {
+            return true;
+          }
+        }
+        eliminated.push_back(combined);
+      }
+      if (eliminated.size() > maximumNumberOfInequalities) {
+        return true;
+      }
+    }
+    inequalities = eliminated;
+  }
+
+  return true;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Exact dependence test between the memory accesses of an affine loop nest.
+ *
+ * Two accesses can touch the same memory location only if the system of
+ * linear constraints built from the iterations of the loops that include
+ * them, the bounds of these loops, and the addresses accessed has an integer
+ * solution. The addresses must be affine functions of the iterations of the
+ * loops and of values invariant in the loop analyzed. Addresses with
+ * parametric sizes (e.g., A[i*n + j]) are delinearized, and their subscripts
+ * are compared one by one if they are provably within the sizes of their
+ * dimensions.
+ *
+ * The constraints are solved by eliminating the equalities and by
+ * Fourier-Motzkin elimination of the inequalities, tightened to integers.
+ * The elimination is exact when the coefficients of the variables eliminated
+ * are units, which is the common case; otherwise the accesses are considered
+ * dependent unless the rational relaxation has no solution.
+ */
+class AffineDependenceAnalysis {
+public:
+  AffineDependenceAnalysis(Loop *loop, ScalarEvolution &SE);
+
+  AffineDependenceAnalysis() = delete;
+
+  /*
+   * Check if @from and @to can access the same memory location at different
+   * iterations of the loop.
+   */
+  bool canAccessTheSameLocationAcrossIterations(Instruction *from,
+                                                Instruction *to);
+
+  /*
+   * Check if @from and @to can access the same memory location at the same
+   * iteration of the loop.
+   */
+  bool canAccessTheSameLocationWithinAnIteration(Instruction *from,
+                                                 Instruction *to);
+
+private:
+  /*
+   * Iteration of the loop that runs @from compared to the one that runs @to.
+   */
+  enum IterationOrder { EARLIER, LATER, SAME };
+
+  /*
+   * Linear combination of variables plus a constant.
+   */
+  class AffineExpression {
+  public:
+    AffineExpression(int64_t constant);
+
+    std::map<uint32_t, int64_t> coefficients;
+    int64_t constant;
+
+    bool add(AffineExpression const &other, int64_t factor);
+  };
+
+  /*
+   * System of the accesses of two instructions.
+   * Accesses of the same instruction at different iterations use different
+   * copies of the iterations of the loops nested in the loop analyzed.
+   */
+  class DependenceSystem {
+  public:
+    DependenceSystem(Loop *loop, ScalarEvolution &SE);
+
+    bool translate(const SCEV *S,
+                   BasicBlock *scope,
+                   uint32_t copy,
+                   AffineExpression &expression);
+
+    uint32_t fetchIteration(const Loop *l, uint32_t copy);
+
+    /*
+     * Constraints: @expression >= 0, and @expression == 0.
+     */
+    void addInequality(AffineExpression const &expression);
+
+    void addEquality(AffineExpression const &expression);
+
+    bool isFeasible(void) const;
+
+  private:
+    Loop *loop;
+    ScalarEvolution &SE;
+    std::map<std::pair<const void *, uint32_t>, uint32_t> variables;
+    std::vector<AffineExpression> inequalities;
+    std::vector<AffineExpression> equalities;
+  };
+
+  Loop *loop;
+  ScalarEvolution &SE;
+
+  bool canAccessTheSameLocation(Instruction *from,
+                                Instruction *to,
+                                IterationOrder order);
+
+  bool addAccessConstraints(DependenceSystem &system,
+                            Instruction *from,
+                            Instruction *to);
+
+  bool areSubscriptsWithinTheirDimensions(
+      Instruction *inst,
+      SmallVectorImpl<const SCEV *> const &subscripts,
+      SmallVectorImpl<const SCEV *> const &sizes);
+};
+
+} // namespace llvm::noelle
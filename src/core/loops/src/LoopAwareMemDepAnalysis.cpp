@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "LoopAwareMemDepAnalysis.hpp"
+#include "AffineDependenceAnalysis.hpp"
 #include "noelle/core/DataFlow.hpp"
 
 /*
@@ -33,6 +34,13 @@
 
 namespace llvm::noelle {
 
+static cl::opt<bool> AffineDependences(
+    "noelle-affine-dependences",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Disprove loop-carried memory dependences with an exact affine test"));
+
 /*
  * SCAF
  */
@@ -77,12 +85,17 @@ void refinePDGWithLoopAwareMemDepAnalysis(
     Loop *l,
     LoopStructure *loopStructure,
     StayConnectedNestedLoopForestNode *loops,
-    LoopIterationDomainSpaceAnalysis *LIDS) {
+    LoopIterationDomainSpaceAnalysis *LIDS,
+    ScalarEvolution &SE) {
   refinePDGWithSCAF(loopDG, l);
 
   if (LIDS) {
     refinePDGWithLIDS(loopDG, loopStructure, loops, LIDS);
   }
+
+  if (AffineDependences) {
+    refinePDGWithAffineDependences(loopDG, l, loopStructure, loops, SE);
+  }
 }
 
 void refinePDGWithSCAF(PDG *loopDG, Loop *l) {
@@ -290,6 +303,13 @@ void refinePDGWithLIDS(PDG *loopDG,
     if (!fromInst || !toInst)
       continue;
 
+    /*
+     * Record how many iterations apart the instances of the instructions
+     * access the same location, if this is known (e.g., A[i+2] and A[i]).
+     */
+    dependency->setLoopCarriedDistance(
+        LIDS->getDependenceDistanceBetweenIterations(fromInst, toInst));
+
     /*
      * Loop carried dependencies are conservatively marked as such; we can only
      * remove dependencies between a producer and consumer where we know the
@@ -319,6 +339,73 @@ void refinePDGWithLIDS(PDG *loopDG,
   return;
 }
 
+void refinePDGWithAffineDependences(PDG *loopDG,
+                                    Loop *l,
+                                    LoopStructure *loopStructure,
+                                    StayConnectedNestedLoopForestNode *loops,
+                                    ScalarEvolution &SE) {
+
+  /*
+   * Compute the reachability of instructions within the loop.
+   */
+  auto dfr = computeReachabilityFromInstructions(loopStructure);
+
+  AffineDependenceAnalysis affine{ l, SE };
+  std::unordered_set<DGEdge<Value> *> edgesToRemove;
+  for (auto dependency :
+       LoopCarriedDependencies::getLoopCarriedDependenciesForLoop(
+           *loopStructure,
+           loops,
+           *loopDG)) {
+
+    /*
+     * Only memory dependences between instructions can be disproved.
+     */
+    if (!dependency->isMemoryDependence()) {
+      continue;
+    }
+    auto fromInst = dyn_cast<Instruction>(dependency->getOutgoingT());
+    auto toInst = dyn_cast<Instruction>(dependency->getIncomingT());
+    if (false || (fromInst == nullptr) || (toInst == nullptr)) {
+      continue;
+    }
+
+    /*
+     * Check if the instructions can access the same location in different
+     * iterations.
+     */
+    if (affine.canAccessTheSameLocationAcrossIterations(fromInst, toInst)) {
+      continue;
+    }
+
+    /*
+     * The dependence is not loop-carried.
+     * It still exists if the producer can reach the consumer within an
+     * iteration, and they can access the same location in it.
+     */
+    auto &afterInstructions = dfr->OUT(fromInst);
+    if (true && (afterInstructions.find(toInst) != afterInstructions.end())
+        && affine.canAccessTheSameLocationWithinAnIteration(fromInst,
+                                                            toInst)) {
+      dependency->setLoopCarried(false);
+      continue;
+    }
+    edgesToRemove.insert(dependency);
+  }
+
+  for (auto edge : edgesToRemove) {
+    edge->setLoopCarried(false);
+    loopDG->removeEdge(edge);
+  }
+
+  /*
+   * Free the memory
+   */
+  delete dfr;
+
+  return;
+}
+
 NoelleSCAFIntegration::NoelleSCAFIntegration() : ModulePass{ ID } {
   return;
 }
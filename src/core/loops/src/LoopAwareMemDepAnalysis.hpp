@@ -36,7 +36,8 @@ void refinePDGWithLoopAwareMemDepAnalysis(
     Loop *l,
     LoopStructure *loopStructure,
     StayConnectedNestedLoopForestNode *loops,
-    LoopIterationDomainSpaceAnalysis *LIDS);
+    LoopIterationDomainSpaceAnalysis *LIDS,
+    ScalarEvolution &SE);
 
 // Refine the loop PDG with SCAF
 void refinePDGWithSCAF(PDG *loopDG, Loop *l);
@@ -46,4 +47,11 @@ void refinePDGWithLIDS(PDG *loopDG,
                        StayConnectedNestedLoopForestNode *loops,
                        LoopIterationDomainSpaceAnalysis *LIDS);
 
+// Refine the loop PDG with an exact test of affine memory accesses
+void refinePDGWithAffineDependences(PDG *loopDG,
+                                    Loop *l,
+                                    LoopStructure *loopStructure,
+                                    StayConnectedNestedLoopForestNode *loops,
+                                    ScalarEvolution &SE);
+
 } // namespace llvm::noelle
@@ -24,10 +24,14 @@
 #include "noelle/core/PDGAnalysis.hpp"
 #include "noelle/core/SCCDAG.hpp"
 #include "noelle/core/LoopDependenceInfo.hpp"
+#include "noelle/core/PhaseTimer.hpp"
+#include "noelle/core/TalkDown.hpp"
 #include "LoopAwareMemDepAnalysis.hpp"
 
 namespace llvm::noelle {
 
+std::recursive_mutex LoopDependenceInfo::materializationMutex;
+
 LoopDependenceInfo::LoopDependenceInfo(
     PDG *fG,
     StayConnectedNestedLoopForestNode *loopNode,
@@ -126,16 +130,73 @@ LoopDependenceInfo::LoopDependenceInfo(
     std::unordered_set<LoopDependenceInfoOptimization> optimizations,
     bool enableLoopAwareDependenceAnalyses,
     uint32_t chunkSize)
-  : loop{ loopNode },
-    memoryCloningAnalysis{ nullptr } {
-  assert(this->loop != nullptr);
+  : LoopDependenceInfo(loopNode,
+                       maxCores,
+                       enableFloatAsReal,
+                       optimizations,
+                       enableLoopAwareDependenceAnalyses,
+                       chunkSize,
+                       nullptr) {
 
   /*
-   * Assertions.
+   * Compute the analyses of the loop.
    */
-  for (auto edge : fG->getEdges()) {
-    assert(!edge->isLoopCarriedDependence() && "Flag was already set");
-  }
+  this->computeAnalyses(fG, nullptr, l, DS, SE);
+
+  return;
+}
+
+LoopDependenceInfo::LoopDependenceInfo(
+    PDG *fG,
+    PDG *loopDG,
+    StayConnectedNestedLoopForestNode *loopNode,
+    Loop *l,
+    DominatorSummary &DS,
+    ScalarEvolution &SE,
+    uint32_t maxCores,
+    bool enableFloatAsReal,
+    bool enableLoopAwareDependenceAnalyses)
+  : LoopDependenceInfo(loopNode,
+                       maxCores,
+                       enableFloatAsReal,
+                       {},
+                       enableLoopAwareDependenceAnalyses,
+                       8,
+                       nullptr) {
+  assert(loopDG != nullptr);
+
+  /*
+   * Compute the analyses of the loop.
+   */
+  this->computeAnalyses(fG, loopDG, l, DS, SE);
+
+  return;
+}
+
+LoopDependenceInfo::LoopDependenceInfo(
+    StayConnectedNestedLoopForestNode *loopNode,
+    uint32_t maxCores,
+    bool enableFloatAsReal,
+    std::unordered_set<LoopDependenceInfoOptimization> optimizations,
+    bool enableLoopAwareDependenceAnalyses,
+    uint32_t chunkSize,
+    AnalysesProvider fetchAnalyses)
+  : loop{ loopNode },
+    enableFloatAsReal{ enableFloatAsReal },
+    analysesProvider{ fetchAnalyses },
+    materialized{ fetchAnalyses == nullptr },
+    environment{ nullptr },
+    loopDG{ nullptr },
+    inductionVariables{ nullptr },
+    invariantManager{ nullptr },
+    loopGoverningIVAttribution{ nullptr },
+    domainSpaceAnalysis{ nullptr },
+    memoryCloningAnalysis{ nullptr },
+    compileTimeKnownTripCount{ false },
+    tripCount{ 0 },
+    sccdagAttrs{ nullptr },
+    referentialExpander{ nullptr } {
+  assert(this->loop != nullptr);
 
   /*
    * Create the loop transformations manager
@@ -151,6 +212,69 @@ LoopDependenceInfo::LoopDependenceInfo(
    */
   this->loopTransformationsManager->enableAllTransformations();
 
+  return;
+}
+
+bool LoopDependenceInfo::isMaterialized(void) const {
+  return this->materialized.load(std::memory_order_acquire);
+}
+
+void LoopDependenceInfo::materialize(void) const {
+  if (this->isMaterialized()) {
+    return;
+  }
+
+  /*
+   * Check again while holding the lock: another thread could have computed the
+   * analyses meanwhile, or this thread could be computing them already.
+   */
+  std::lock_guard<std::recursive_mutex> guard{ materializationMutex };
+  if (this->analysesProvider == nullptr) {
+    return;
+  }
+
+  /*
+   * Compute the analyses of the loop.
+   * They are cached in the LDI, which is conceptually unchanged.
+   */
+  auto ldi = const_cast<LoopDependenceInfo *>(this);
+  auto provider = ldi->analysesProvider;
+  ldi->analysesProvider = nullptr;
+  provider([ldi](PDG *fG, Loop *l, DominatorSummary &DS, ScalarEvolution &SE) {
+    ldi->computeAnalyses(fG, nullptr, l, DS, SE);
+  });
+
+  /*
+   * Publish the analyses to the threads that do not hold the lock.
+   */
+  ldi->materialized.store(true, std::memory_order_release);
+
+  return;
+}
+
+void LoopDependenceInfo::computeAnalyses(PDG *fG,
+                                         PDG *precomputedLoopDG,
+                                         Loop *l,
+                                         DominatorSummary &DS,
+                                         ScalarEvolution &SE) {
+  PhaseTimer timer("ldi", "LDI construction");
+
+  /*
+   * Assertions.
+   */
+  for (auto edge : fG->getEdges()) {
+    assert(!edge->isLoopCarriedDependence() && "Flag was already set");
+  }
+
+  /*
+   * Map the SCEVs of the function to their values once for all the
+   * induction variable managers computed for the loop.
+   */
+  ScalarEvolutionReferentialExpander referentialExpander(
+      SE,
+      *l->getHeader()->getParent());
+  this->referentialExpander = &referentialExpander;
+
   /*
    * Fetch the loop dependence graph (i.e., the subset of the PDG that relates
    * to the loop @l) and its SCCDAG.
@@ -158,26 +282,34 @@ LoopDependenceInfo::LoopDependenceInfo(
   this->fetchLoopAndBBInfo(l, SE);
   auto ls = this->getLoopStructure();
   auto loopExitBlocks = ls->getLoopExitBasicBlocks();
-  auto DGs = this->createDGsForLoop(l, loopNode, fG, DS, SE);
+  std::pair<PDG *, SCCDAG *> DGs;
+  {
+    PhaseTimer dgTimer("ldi-dg", "LDI: loop dependence graph and SCCDAG");
+    DGs = this->createDGsForLoop(l, this->loop, fG, precomputedLoopDG, DS, SE);
+  }
   this->loopDG = DGs.first;
   auto loopSCCDAG = DGs.second;
 
   /*
    * Create the environment for the loop.
    *
-   * Exclude stack objects that will be cloned. To do so, we need to collect
-   * this set of objects.
+   * Exclude stack and heap objects that will be cloned. To do so, we need to
+   * collect this set of objects.
    */
   std::set<Value *> stackObjectsThatWillBeCloned;
   if (this->memoryCloningAnalysis != nullptr) {
     for (auto memObject :
          this->memoryCloningAnalysis->getClonableMemoryLocations()) {
-      auto stackObject = memObject->getAllocation();
-      stackObjectsThatWillBeCloned.insert(stackObject);
+      auto object = memObject->getMemoryObject();
+      stackObjectsThatWillBeCloned.insert(object);
     }
   }
-  this->environment =
-      new LoopEnvironment(loopDG, loopExitBlocks, stackObjectsThatWillBeCloned);
+  {
+    PhaseTimer environmentTimer("ldi-environment", "LDI: environment");
+    this->environment = new LoopEnvironment(loopDG,
+                                            loopExitBlocks,
+                                            stackObjectsThatWillBeCloned);
+  }
 
   /*
    * Create the invariant manager.
@@ -185,7 +317,10 @@ LoopDependenceInfo::LoopDependenceInfo(
    * This step identifies instructions that are loop invariants.
    */
   auto topLoop = this->loop->getLoop();
-  this->invariantManager = new InvariantManager(topLoop, this->loopDG);
+  {
+    PhaseTimer invariantsTimer("ldi-invariants", "LDI: invariants");
+    this->invariantManager = new InvariantManager(topLoop, this->loopDG);
+  }
 
   /*
    * Create the induction variable manager.
@@ -197,34 +332,44 @@ LoopDependenceInfo::LoopDependenceInfo(
    * Then, we compute the SCCDAG of this sub-LDG.
    * And then, we can identify IVs from this new SCCDAG.
    */
-  auto loopSCCDAGWithoutMemoryDeps =
-      this->computeSCCDAGWithOnlyVariableAndControlDependences(loopDG);
-  this->inductionVariables =
-      new InductionVariableManager(this->loop,
-                                   *invariantManager,
-                                   SE,
-                                   *loopSCCDAGWithoutMemoryDeps,
-                                   *environment,
-                                   *l);
+  {
+    PhaseTimer ivTimer("ldi-ivs", "LDI: induction variables");
+    auto loopSCCDAGWithoutMemoryDeps =
+        this->computeSCCDAGWithOnlyVariableAndControlDependences(loopDG);
+    this->inductionVariables =
+        this->computeInductionVariables(*invariantManager,
+                                        SE,
+                                        *loopSCCDAGWithoutMemoryDeps,
+                                        *environment,
+                                        *l);
+  }
 
   /*
    * Calculate various attributes on SCCs
    */
-  this->sccdagAttrs = new SCCDAGAttrs(enableFloatAsReal,
-                                      loopDG,
-                                      loopSCCDAG,
-                                      this->loop,
-                                      SE,
-                                      *inductionVariables,
-                                      DS);
-  this->domainSpaceAnalysis =
-      new LoopIterationDomainSpaceAnalysis(this->loop,
-                                           *this->inductionVariables,
-                                           SE);
+  {
+    PhaseTimer sccdagAttrsTimer("ldi-sccdag-attrs", "LDI: SCCDAGAttrs");
+    this->sccdagAttrs = new SCCDAGAttrs(this->enableFloatAsReal,
+                                        loopDG,
+                                        loopSCCDAG,
+                                        this->loop,
+                                        SE,
+                                        *inductionVariables,
+                                        DS);
+  }
+  {
+    PhaseTimer domainSpaceTimer("ldi-domain-space", "LDI: domain space");
+    this->domainSpaceAnalysis =
+        new LoopIterationDomainSpaceAnalysis(this->loop,
+                                             *this->inductionVariables,
+                                             SE);
+  }
 
   /*
    * Collect induction variable information
    */
+  PhaseTimer governingIVTimer("ldi-governing-iv",
+                              "LDI: loop-governing IV attribution");
   auto iv =
       this->inductionVariables->getLoopGoverningInductionVariable(*topLoop);
   loopGoverningIVAttribution =
@@ -234,10 +379,28 @@ LoopDependenceInfo::LoopDependenceInfo(
                         *iv,
                         *loopSCCDAG->sccOfValue(iv->getLoopEntryPHI()),
                         loopExitBlocks);
+  this->referentialExpander = nullptr;
 
   return;
 }
 
+InductionVariableManager *LoopDependenceInfo::computeInductionVariables(
+    InvariantManager &IVM,
+    ScalarEvolution &SE,
+    SCCDAG &sccdag,
+    LoopEnvironment &env,
+    Loop &l) {
+  assert(this->referentialExpander != nullptr);
+
+  return new InductionVariableManager(this->loop,
+                                      IVM,
+                                      SE,
+                                      sccdag,
+                                      env,
+                                      l,
+                                      *this->referentialExpander);
+}
+
 void LoopDependenceInfo::copyParallelizationOptionsFrom(
     LoopDependenceInfo *otherLDI) {
   auto otherLTM = otherLDI->getLoopTransformationsManager();
@@ -288,16 +451,19 @@ std::pair<PDG *, SCCDAG *> LoopDependenceInfo::createDGsForLoop(
     Loop *l,
     StayConnectedNestedLoopForestNode *loopNode,
     PDG *functionDG,
+    PDG *loopDG,
     DominatorSummary &DS,
     ScalarEvolution &SE) {
 
   /*
-   * Create the loop dependence graph.
+   * Create the loop dependence graph (if it has not been given as input).
    */
   for (auto edge : functionDG->getEdges()) {
     assert(!edge->isLoopCarriedDependence() && "Flag was already set");
   }
-  auto loopDG = functionDG->createLoopsSubgraph(l);
+  if (loopDG == nullptr) {
+    loopDG = functionDG->createLoopsSubgraph(l);
+  }
   for (auto edge : loopDG->getEdges()) {
     assert(!edge->isLoopCarriedDependence() && "Flag was already set");
   }
@@ -336,33 +502,58 @@ std::pair<PDG *, SCCDAG *> LoopDependenceInfo::createDGsForLoop(
   auto loopExitBlocks = loopStructure->getLoopExitBasicBlocks();
   auto env = LoopEnvironment(loopDG, loopExitBlocks, {});
   auto invManager = InvariantManager(loopStructure, loopDG);
-  auto ivManager = InductionVariableManager(loopNode,
-                                            invManager,
-                                            SE,
-                                            *loopSCCDAGWithoutMemoryDeps,
-                                            env,
-                                            *l);
+  auto ivManager = std::unique_ptr<InductionVariableManager>(
+      this->computeInductionVariables(invManager,
+                                      SE,
+                                      *loopSCCDAGWithoutMemoryDeps,
+                                      env,
+                                      *l));
+
+  /*
+   * Remove the loop-carried memory dependences of loops that the source code
+   * declared parallel.
+   * The loop-aware analyses cannot remove more dependences of these loops, so
+   * they are skipped.
+   */
+  auto isDeclaredParallel = TalkDown::isParallel(l);
+  if (isDeclaredParallel) {
+    this->removeUnnecessaryDependenciesOfParallelLoop(loopNode, loopDG);
+  }
 
   /*
    * Perform loop-aware memory dependence analysis to refine the loop dependence
    * graph.
    */
-  auto domainSpace = LoopIterationDomainSpaceAnalysis(loopNode, ivManager, SE);
-  if (this->loopTransformationsManager->areLoopAwareAnalysesEnabled()) {
+  auto domainSpace =
+      LoopIterationDomainSpaceAnalysis(loopNode, *ivManager, SE);
+  if (true && (!isDeclaredParallel)
+      && this->loopTransformationsManager->areLoopAwareAnalysesEnabled()) {
     refinePDGWithLoopAwareMemDepAnalysis(loopDG,
                                          l,
                                          loopStructure,
                                          loopNode,
-                                         &domainSpace);
+                                         &domainSpace,
+                                         SE);
   }
 
+  /*
+   * Build a SCCDAG of loop-internal instructions
+   */
+  loopInternalDG = loopDG->createSubgraphFromValues(loopInternals, false);
+  auto loopSCCDAG = new SCCDAG(loopInternalDG);
+
   /*
    * Analyze the loop to identify opportunities of cloning stack objects.
+   *
+   * The refinements below remove dependences from the SCCDAG as well, so only
+   * the SCCs they affect are recomputed.
    */
   if (this->loopTransformationsManager->isOptimizationEnabled(
           LoopDependenceInfoOptimization::MEMORY_CLONING_ID)) {
     this->removeUnnecessaryDependenciesThatCloningMemoryNegates(loopNode,
                                                                 loopDG,
+                                                                loopInternalDG,
+                                                                loopSCCDAG,
                                                                 DS);
   }
 
@@ -371,16 +562,25 @@ std::pair<PDG *, SCCDAG *> LoopDependenceInfo::createDGsForLoop(
    */
   if (this->loopTransformationsManager->isOptimizationEnabled(
           LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID)) {
-    this->removeUnnecessaryDependenciesWithThreadSafeLibraryFunctions(loopNode,
-                                                                      loopDG,
-                                                                      DS);
+    this->removeUnnecessaryDependenciesWithThreadSafeLibraryFunctions(
+        loopNode,
+        loopDG,
+        loopInternalDG,
+        loopSCCDAG,
+        DS);
   }
 
   /*
-   * Build a SCCDAG of loop-internal instructions
+   * Remove memory dependences between calls that write to streams if their
+   * output can be buffered.
    */
-  loopInternalDG = loopDG->createSubgraphFromValues(loopInternals, false);
-  auto loopSCCDAG = new SCCDAG(loopInternalDG);
+  if (this->loopTransformationsManager->isOptimizationEnabled(
+          LoopDependenceInfoOptimization::BUFFERED_OUTPUT_ID)) {
+    this->removeUnnecessaryDependenciesWithBufferedOutput(loopNode,
+                                                         loopDG,
+                                                         loopInternalDG,
+                                                         loopSCCDAG);
+  }
 
 /*
  * Safety check: check that the SCCDAG includes all instructions of the loop
@@ -418,6 +618,8 @@ void LoopDependenceInfo::
     removeUnnecessaryDependenciesWithThreadSafeLibraryFunctions(
         StayConnectedNestedLoopForestNode *loopNode,
         PDG *loopDG,
+        PDG *loopInternalDG,
+        SCCDAG *loopSCCDAG,
         DominatorSummary &DS) {
 
   /*
@@ -451,40 +653,156 @@ void LoopDependenceInfo::
     }
 
     /*
-     * Only self-dependences can be removed.
+     * Only dependences between invocations of the same thread-safe library
+     * function can be removed.
      */
-    if (producer != consumer) {
+    auto producerCall = dyn_cast<CallInst>(producer);
+    auto consumerCall = dyn_cast<CallInst>(consumer);
+    if (!producerCall || !consumerCall) {
+      continue;
+    }
+    auto callee = producerCall->getCalledFunction();
+    if (false || (callee == nullptr)
+        || (callee != consumerCall->getCalledFunction())
+        || (!PDGAnalysis::isTheLibraryFunctionThreadSafe(callee))) {
       continue;
     }
 
     /*
-     * Only dependences with thread-safe library functions can be removed.
+     * Dependences between different call sites can be removed only if the
+     * invocations of the function can run in any order.
      */
-    if (auto producerCall = dyn_cast<CallInst>(producer)) {
-      auto callee = producerCall->getCalledFunction();
-      if (callee != nullptr) {
-        if (PDGAnalysis::isTheLibraryFunctionThreadSafe(callee)) {
-          edgesToRemove.insert(edge);
-          continue;
-        }
-      }
+    if (true && (producer != consumer)
+        && (!PDGAnalysis::isTheLibraryFunctionCommutative(callee))) {
+      continue;
     }
+    edgesToRemove.insert(edge);
   }
 
   /*
    * Removed the identified dependences.
    */
-  for (auto edge : edgesToRemove) {
-    edge->setLoopCarried(false);
-    loopDG->removeEdge(edge);
+  this->removeDependences(edgesToRemove, loopDG, loopInternalDG, loopSCCDAG);
+
+  return;
+}
+
+void LoopDependenceInfo::removeUnnecessaryDependenciesWithBufferedOutput(
+    StayConnectedNestedLoopForestNode *loopNode,
+    PDG *loopDG,
+    PDG *loopInternalDG,
+    SCCDAG *loopSCCDAG) {
+
+  /*
+   * Fetch the calls of the loop that write to streams.
+   * Their output can be buffered only if no other code of the loop can access
+   * the streams (e.g., fflush, scanf, or a function of the program that
+   * prints), as that code would not see the output buffered so far.
+   */
+  auto rootLoop = loopNode->getLoop();
+  std::unordered_set<CallBase *> calls;
+  for (auto bb : rootLoop->getBasicBlocks()) {
+    for (auto &inst : *bb) {
+      auto call = dyn_cast<CallBase>(&inst);
+      if (false || (call == nullptr) || isa<IntrinsicInst>(call)) {
+        continue;
+      }
+      auto callee = call->getCalledFunction();
+      if (callee == nullptr) {
+        return;
+      }
+      if (true && callee->isDeclaration()
+          && PDGAnalysis::isTheLibraryFunctionAStreamWriter(callee)) {
+        calls.insert(call);
+        continue;
+      }
+      if (false || call->onlyReadsMemory() || call->onlyAccessesArgMemory()) {
+        continue;
+      }
+      if (true && callee->isDeclaration()
+          && PDGAnalysis::isTheLibraryFunctionThreadSafe(callee)) {
+        continue;
+      }
+      return;
+    }
+  }
+  if (calls.size() == 0) {
+    return;
+  }
+
+  /*
+   * Identify the dependences to remove.
+   * Only the loop-carried ones are removed: the calls of an iteration keep
+   * their order, and the runtime writes the output of the iterations in their
+   * order.
+   */
+  std::unordered_set<DGEdge<Value> *> edgesToRemove;
+  for (auto edge :
+       LoopCarriedDependencies::getLoopCarriedDependenciesForLoop(*rootLoop,
+                                                                  loopNode,
+                                                                  *loopDG)) {
+    if (!edge->isMemoryDependence()) {
+      continue;
+    }
+    auto producer = dyn_cast<CallBase>(edge->getOutgoingT());
+    auto consumer = dyn_cast<CallBase>(edge->getIncomingT());
+    if (false || (calls.find(producer) == calls.end())
+        || (calls.find(consumer) == calls.end())) {
+      continue;
+    }
+    edgesToRemove.insert(edge);
   }
 
+  /*
+   * Remove the identified dependences.
+   */
+  this->removeDependences(edgesToRemove, loopDG, loopInternalDG, loopSCCDAG);
+  this->callsWithBufferedOutput = calls;
+
+  return;
+}
+
+void LoopDependenceInfo::removeUnnecessaryDependenciesOfParallelLoop(
+    StayConnectedNestedLoopForestNode *loopNode,
+    PDG *loopDG) {
+
+  /*
+   * Fetch the loop sub-tree rooted at @this.
+   */
+  auto rootLoop = loopNode->getLoop();
+
+  /*
+   * Identify the dependences to remove.
+   * The iterations of the loop are independent, so no memory dependence is
+   * carried by the loop.
+   * Dependences that reach a sub-loop are kept as they can be carried by the
+   * sub-loop.
+   */
+  std::unordered_set<DGEdge<Value> *> edgesToRemove;
+  for (auto edge :
+       LoopCarriedDependencies::getLoopCarriedDependenciesForLoop(*rootLoop,
+                                                                  loopNode,
+                                                                  *loopDG)) {
+    if (!edge->isMemoryDependence()) {
+      continue;
+    }
+    edgesToRemove.insert(edge);
+  }
+
+  /*
+   * Removed the identified dependences.
+   * The SCCDAG of the loop has not been built yet.
+   */
+  this->removeDependences(edgesToRemove, loopDG, nullptr, nullptr);
+
   return;
 }
 
 void LoopDependenceInfo::removeUnnecessaryDependenciesThatCloningMemoryNegates(
     StayConnectedNestedLoopForestNode *loopNode,
+    PDG *loopDG,
     PDG *loopInternalDG,
+    SCCDAG *loopSCCDAG,
     DominatorSummary &DS) {
 
   /*
@@ -496,7 +814,7 @@ void LoopDependenceInfo::removeUnnecessaryDependenciesThatCloningMemoryNegates(
    * Create the memory cloning analyzer.
    */
   this->memoryCloningAnalysis =
-      new MemoryCloningAnalysis(rootLoop, DS, loopInternalDG);
+      new MemoryCloningAnalysis(rootLoop, DS, loopDG);
 
   /*
    * Identify opportunities for cloning stack locations.
@@ -505,7 +823,7 @@ void LoopDependenceInfo::removeUnnecessaryDependenciesThatCloningMemoryNegates(
   for (auto edge : LoopCarriedDependencies::getLoopCarriedDependenciesForLoop(
            *rootLoop,
            loopNode,
-           *loopInternalDG)) {
+           *loopDG)) {
 
     /*
      * Only memory dependences can be removed by cloning memory objects.
@@ -576,15 +894,81 @@ void LoopDependenceInfo::removeUnnecessaryDependenciesThatCloningMemoryNegates(
   /*
    * Remove the dependences.
    */
-  for (auto edge : edgesToRemove) {
+  this->removeDependences(edgesToRemove, loopDG, loopInternalDG, loopSCCDAG);
+
+  return;
+}
+
+void LoopDependenceInfo::removeDependences(
+    std::unordered_set<DGEdge<Value> *> &edges,
+    PDG *loopDG,
+    PDG *loopInternalDG,
+    SCCDAG *loopSCCDAG) {
+
+  /*
+   * Remove the copies of the dependences from the graph the SCCDAG has been
+   * built from, and collect the SCCs they connect.
+   * The SCCs that only depend on each other through a removed dependence are
+   * recomputed as well, so the dependences between SCCs are kept exact.
+   */
+  std::unordered_set<SCC *> sccsToSplit;
+  if (loopSCCDAG != nullptr) {
+    for (auto edge : edges) {
+      auto copy = fetchCopyOfDependence(loopInternalDG, edge);
+      if (copy == nullptr) {
+        continue;
+      }
+      sccsToSplit.insert(loopSCCDAG->sccOfValue(edge->getOutgoingT()));
+      sccsToSplit.insert(loopSCCDAG->sccOfValue(edge->getIncomingT()));
+      loopInternalDG->removeEdge(copy);
+    }
+  }
+
+  /*
+   * Remove the dependences from the loop dependence graph.
+   */
+  for (auto edge : edges) {
     edge->setLoopCarried(false);
-    loopInternalDG->removeEdge(edge);
+    loopDG->removeEdge(edge);
+  }
+
+  /*
+   * Recompute only the SCCs affected.
+   */
+  if (sccsToSplit.size() > 0) {
+    loopSCCDAG->splitSCCs(sccsToSplit, loopInternalDG);
   }
 
   return;
 }
 
+DGEdge<Value> *LoopDependenceInfo::fetchCopyOfDependence(PDG *graph,
+                                                          DGEdge<Value> *edge) {
+  auto fromNode = graph->fetchNode(edge->getOutgoingT());
+  auto toNode = graph->fetchNode(edge->getIncomingT());
+  if (false || (fromNode == nullptr) || (toNode == nullptr)) {
+    return nullptr;
+  }
+
+  /*
+   * The copy has the same attributes of @edge.
+   */
+  for (auto copy : graph->fetchEdges(fromNode, toNode)) {
+    if (true && (copy->isMemoryDependence() == edge->isMemoryDependence())
+        && (copy->isMustDependence() == edge->isMustDependence())
+        && (copy->isControlDependence() == edge->isControlDependence())
+        && (copy->isRAWDependence() == edge->isRAWDependence())
+        && (copy->isWARDependence() == edge->isWARDependence())
+        && (copy->isWAWDependence() == edge->isWAWDependence())) {
+      return copy;
+    }
+  }
+
+  return nullptr;
+}
+
 PDG *LoopDependenceInfo::getLoopDG(void) const {
+  this->materialize();
   return this->loopDG;
 }
 
@@ -628,21 +1012,25 @@ LoopStructure *LoopDependenceInfo::getNestedMostLoopStructure(
 }
 
 bool LoopDependenceInfo::isSCCContainedInSubloop(SCC *scc) const {
+  this->materialize();
   return this->sccdagAttrs->isSCCContainedInSubloop(this->loop, scc);
 }
 
 InductionVariableManager *LoopDependenceInfo::getInductionVariableManager(
     void) const {
+  this->materialize();
   return inductionVariables;
 }
 
 LoopGoverningIVAttribution *LoopDependenceInfo::getLoopGoverningIVAttribution(
     void) const {
+  this->materialize();
   return loopGoverningIVAttribution;
 }
 
 MemoryCloningAnalysis *LoopDependenceInfo::getMemoryCloningAnalysis(
     void) const {
+  this->materialize();
   assert(
       this->memoryCloningAnalysis != nullptr
       && "Requesting memory cloning analysis without having specified LoopDependenceInfoOptimization::MEMORY_CLONING");
@@ -650,19 +1038,29 @@ MemoryCloningAnalysis *LoopDependenceInfo::getMemoryCloningAnalysis(
 }
 
 bool LoopDependenceInfo::doesHaveCompileTimeKnownTripCount(void) const {
+  this->materialize();
   return this->compileTimeKnownTripCount;
 }
 
+const std::unordered_set<CallBase *> &LoopDependenceInfo::
+    getCallsWithBufferedOutput(void) const {
+  this->materialize();
+  return this->callsWithBufferedOutput;
+}
+
 uint64_t LoopDependenceInfo::getCompileTimeTripCount(void) const {
+  this->materialize();
   return this->tripCount;
 }
 
 InvariantManager *LoopDependenceInfo::getInvariantManager(void) const {
+  this->materialize();
   return this->invariantManager;
 }
 
 LoopIterationDomainSpaceAnalysis *LoopDependenceInfo::
     getLoopIterationDomainSpaceAnalysis(void) const {
+  this->materialize();
   return this->domainSpaceAnalysis;
 }
 
@@ -672,10 +1070,12 @@ StayConnectedNestedLoopForestNode *LoopDependenceInfo::
 }
 
 SCCDAGAttrs *LoopDependenceInfo::getSCCManager(void) const {
+  this->materialize();
   return this->sccdagAttrs;
 }
 
 LoopEnvironment *LoopDependenceInfo::getEnvironment(void) const {
+  this->materialize();
   return this->environment;
 }
 
@@ -683,33 +1083,15 @@ SCCDAG *LoopDependenceInfo::computeSCCDAGWithOnlyVariableAndControlDependences(
     PDG *loopDG) {
 
   /*
-   * Compute the set of internal instructions of the loop.
-   */
-  std::vector<Value *> loopInternals;
-  for (auto internalNode : loopDG->internalNodePairs()) {
-    loopInternals.push_back(internalNode.first);
-  }
-
-  /*
-   * Collect the dependences that we want to ignore.
-   */
-  std::unordered_set<DGEdge<Value> *> memDeps{};
-  for (auto currentDependence : loopDG->getSortedDependences()) {
-    if (currentDependence->isMemoryDependence()) {
-      memDeps.insert(currentDependence);
-    }
-  }
-
-  /*
-   * Compute the new loop dependence graph
-   */
-  auto loopDGWithoutMemoryDeps =
-      loopDG->createSubgraphFromValues(loopInternals, false, memDeps);
-
-  /*
-   * Compute the SCCDAG
+   * Compute the SCCDAG of the view of the loop dependence graph that includes
+   * only the internal instructions of the loop and the dependences that are
+   * not through memory.
    */
-  auto loopSCCDAGWithoutMemoryDeps = new SCCDAG(loopDGWithoutMemoryDeps);
+  auto isInternal = [loopDG](DGNode<Value> *node) -> bool {
+    return loopDG->isInternal(node->getT());
+  };
+  auto loopSCCDAGWithoutMemoryDeps =
+      new SCCDAG(loopDG, isInternal, DGSnapshot<Value>::isNotMemoryEdge);
 
   return loopSCCDAGWithoutMemoryDeps;
 }
@@ -720,6 +1102,10 @@ LoopTransformationsManager *LoopDependenceInfo::getLoopTransformationsManager(
 }
 
 LoopDependenceInfo::~LoopDependenceInfo() {
+  if (!this->isMaterialized()) {
+    return;
+  }
+
   delete this->loopDG;
   delete this->environment;
 
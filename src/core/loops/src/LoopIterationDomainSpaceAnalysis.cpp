@@ -23,6 +23,9 @@
 
 namespace llvm::noelle {
 
+std::weak_ptr<LoopIterationDomainSpaceAnalysis::DelinearizationCache>
+    LoopIterationDomainSpaceAnalysis::liveDelinearizationCache;
+
 LoopIterationDomainSpaceAnalysis::LoopIterationDomainSpaceAnalysis(
     StayConnectedNestedLoopForestNode *loops,
     InductionVariableManager &ivManager,
@@ -38,6 +41,18 @@ LoopIterationDomainSpaceAnalysis::LoopIterationDomainSpaceAnalysis(
     return;
   }
 
+  /*
+   * Share the delinearizations with the other analyses that are alive and that
+   * use the same scalar evolution (e.g., the ones of the other loops of the
+   * nest).
+   */
+  this->delinearizationCache = liveDelinearizationCache.lock();
+  if (false || (this->delinearizationCache == nullptr)
+      || (this->delinearizationCache->SE != &SE)) {
+    this->delinearizationCache = std::make_shared<DelinearizationCache>(SE);
+    liveDelinearizationCache = this->delinearizationCache;
+  }
+
   /*
    * Derive memory access information for linear indexing
    * Use memory access information to identify non-overlapping memory accesses
@@ -86,6 +101,278 @@ bool LoopIterationDomainSpaceAnalysis::
                                                                accessSpaceJ);
 }
 
+/*
+ * Split @scev into a constant and the rest of it (nullptr if @scev is only a
+ * constant).
+ */
+static std::pair<const SCEV *, APInt> splitConstantOffset(const SCEV *scev) {
+  if (auto constant = dyn_cast<SCEVConstant>(scev)) {
+    return std::make_pair(nullptr, constant->getAPInt());
+  }
+  auto zero = APInt(scev->getType()->getScalarSizeInBits(), 0);
+  auto add = dyn_cast<SCEVAddExpr>(scev);
+  if (false || (add == nullptr) || (add->getNumOperands() != 2)) {
+    return std::make_pair(scev, zero);
+  }
+
+  /*
+   * Constants are the first operand of the canonical form of additions.
+   */
+  auto constant = dyn_cast<SCEVConstant>(add->getOperand(0));
+  if (constant == nullptr) {
+    return std::make_pair(scev, zero);
+  }
+
+  return std::make_pair(add->getOperand(1), constant->getAPInt());
+}
+
+/*
+ * Check if @scev does not change within the iterations of @loop, except for
+ * the evolutions of the loops nested in it (e.g., {0,+,1}<j> for the loop i of
+ * A[i][j]).
+ */
+static bool isInvariantExceptForNestedLoops(const SCEV *scev,
+                                            LoopStructure *loop) {
+  auto header = loop->getHeader();
+  auto isVariant = [loop, header](const SCEV *s) -> bool {
+    if (auto addRec = dyn_cast<SCEVAddRecExpr>(s)) {
+      return addRec->getLoop()->getHeader() == header;
+    }
+    if (auto unknown = dyn_cast<SCEVUnknown>(s)) {
+      auto inst = dyn_cast<Instruction>(unknown->getValue());
+      return true && (inst != nullptr) && loop->isIncluded(inst);
+    }
+    return false;
+  };
+
+  return !SCEVExprContains(scev, isVariant);
+}
+
+bool LoopIterationDomainSpaceAnalysis::
+    computeDependenceDistanceBetweenIterations(Instruction *from,
+                                               Instruction *to,
+                                               LoopStructure *nestedLoop,
+                                               int64_t &distance) const {
+
+  /*
+   * The distance can be computed only between accesses whose subscripts are
+   * bounded in their dimensions, and that evolve with the IV of the loop.
+   * Then, two accesses touch the same location only if all their subscripts
+   * are the same.
+   */
+  auto fromIt = this->accessSpaceByInstruction.find(from);
+  auto toIt = this->accessSpaceByInstruction.find(to);
+  if (false || (fromIt == this->accessSpaceByInstruction.end())
+      || (toIt == this->accessSpaceByInstruction.end())) {
+    return false;
+  }
+  auto fromSpace = fromIt->second;
+  auto toSpace = toIt->second;
+  if (false
+      || (this->nonOverlappingAccessesBetweenIterations.find(fromSpace)
+          == this->nonOverlappingAccessesBetweenIterations.end())
+      || (this->nonOverlappingAccessesBetweenIterations.find(toSpace)
+          == this->nonOverlappingAccessesBetweenIterations.end())) {
+    return false;
+  }
+
+  /*
+   * The accesses must be to the same array with the same shape.
+   */
+  auto fromBase = dyn_cast<SCEVAddRecExpr>(fromSpace->memoryAccessorSCEV);
+  auto toBase = dyn_cast<SCEVAddRecExpr>(toSpace->memoryAccessorSCEV);
+  if (false || (fromSpace->subscripts.size() != toSpace->subscripts.size())
+      || (fromSpace->sizes != toSpace->sizes)
+      || (fromSpace->elementSize != toSpace->elementSize)
+      || (fromSpace->subscripts.size() == 0)) {
+    return false;
+  }
+  if (true && (fromBase != nullptr) && (toBase != nullptr)) {
+    auto fromPointer = fromBase;
+    while (auto addRec = dyn_cast<SCEVAddRecExpr>(fromPointer->getStart())) {
+      fromPointer = addRec;
+    }
+    auto toPointer = toBase;
+    while (auto addRec = dyn_cast<SCEVAddRecExpr>(toPointer->getStart())) {
+      toPointer = addRec;
+    }
+    auto fromStart = splitConstantOffset(fromPointer->getStart()).first;
+    auto toStart = splitConstantOffset(toPointer->getStart()).first;
+    if (fromStart != toStart) {
+      return false;
+    }
+  } else if (fromSpace->memoryAccessorSCEV != toSpace->memoryAccessorSCEV) {
+    return false;
+  }
+
+  /*
+   * Compute the distance of each subscript that evolves with the IV of the
+   * loop (GCD test).
+   * @from accesses start1 + step * i, and @to accesses start2 + step * i'.
+   * These are the same when i' - i = (start1 - start2) / step.
+   */
+  auto rootLoop = this->loops->getLoop();
+  auto rootHeader = rootLoop->getHeader();
+  auto isRootSubscript = [rootHeader](const SCEVAddRecExpr *subscript) {
+    return true && (subscript != nullptr)
+           && (subscript->getLoop()->getHeader() == rootHeader);
+  };
+  std::vector<uint32_t> otherDimensions;
+  auto isDistanceKnown = false;
+  for (auto idx = 0u; idx < fromSpace->subscripts.size(); idx++) {
+    auto fromAddRec = dyn_cast<SCEVAddRecExpr>(fromSpace->subscripts[idx]);
+    auto toAddRec = dyn_cast<SCEVAddRecExpr>(toSpace->subscripts[idx]);
+    auto isFromRoot = isRootSubscript(fromAddRec);
+    auto isToRoot = isRootSubscript(toAddRec);
+    if (true && (!isFromRoot) && (!isToRoot)) {
+      otherDimensions.push_back(idx);
+      continue;
+    }
+    if (false || (!isFromRoot) || (!isToRoot) || (!fromAddRec->isAffine())
+        || (!toAddRec->isAffine())) {
+      return false;
+    }
+
+    /*
+     * The subscripts must evolve with the same constant step.
+     */
+    auto fromStep = dyn_cast<SCEVConstant>(fromAddRec->getOperand(1));
+    auto toStep = dyn_cast<SCEVConstant>(toAddRec->getOperand(1));
+    if (false || (fromStep == nullptr) || (toStep == nullptr)
+        || (fromStep != toStep) || fromStep->isZero()) {
+      return false;
+    }
+
+    /*
+     * The subscripts must start from the same value up to a constant.
+     */
+    auto fromStart = splitConstantOffset(fromAddRec->getStart());
+    auto toStart = splitConstantOffset(toAddRec->getStart());
+    if (false || (fromStart.first != toStart.first)
+        || (fromStart.second.getBitWidth() != toStart.second.getBitWidth())
+        || (fromStart.second.getBitWidth() > 64)) {
+      return false;
+    }
+    auto delta =
+        fromStart.second.getSExtValue() - toStart.second.getSExtValue();
+    auto step = fromStep->getAPInt().getSExtValue();
+    if ((delta % step) != 0) {
+
+      /*
+       * The accesses never touch the same location.
+       * We do not have a distance to report.
+       */
+      return false;
+    }
+    auto subscriptDistance = delta / step;
+    if (true && isDistanceKnown && (subscriptDistance != distance)) {
+      return false;
+    }
+    distance = subscriptDistance;
+    isDistanceKnown = true;
+  }
+  if (!isDistanceKnown) {
+    return false;
+  }
+
+  /*
+   * Accesses of different iterations never touch the same location if the
+   * distance is 0.
+   */
+  if (distance == 0) {
+    return true;
+  }
+
+  /*
+   * The other subscripts must be the same.
+   */
+  auto isAlignedWithNestedLoop = false;
+  for (auto idx : otherDimensions) {
+    auto subscript = fromSpace->subscripts[idx];
+    if (subscript != toSpace->subscripts[idx]) {
+      return false;
+    }
+    if (nestedLoop == nullptr) {
+      continue;
+    }
+
+    /*
+     * The subscripts must have the same value at the same iteration of
+     * @nestedLoop in every iteration of the loop.
+     * Then, one of them must change at every iteration of @nestedLoop.
+     */
+    if (!isInvariantExceptForNestedLoops(subscript, rootLoop)) {
+      return false;
+    }
+    auto addRec = dyn_cast<SCEVAddRecExpr>(subscript);
+    if (false || (addRec == nullptr) || (!addRec->isAffine())
+        || (addRec->getLoop()->getHeader() != nestedLoop->getHeader())) {
+      continue;
+    }
+    auto step = dyn_cast<SCEVConstant>(addRec->getOperand(1));
+    if (true && (step != nullptr) && (!step->isZero())) {
+      isAlignedWithNestedLoop = true;
+    }
+  }
+  if (true && (nestedLoop != nullptr) && (!isAlignedWithNestedLoop)) {
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t LoopIterationDomainSpaceAnalysis::
+    getDependenceDistanceBetweenIterations(Instruction *from,
+                                           Instruction *to) const {
+  int64_t distance = 0;
+  if (false
+      || (!this->computeDependenceDistanceBetweenIterations(from,
+                                                            to,
+                                                            nullptr,
+                                                            distance))
+      || (distance <= 0)) {
+    return 0;
+  }
+
+  return distance;
+}
+
+bool LoopIterationDomainSpaceAnalysis::getDependenceDistanceBetweenIterations(
+    Instruction *from,
+    Instruction *to,
+    LoopStructure *nestedLoop,
+    int64_t &distance) const {
+  assert(nestedLoop != nullptr);
+
+  return this->computeDependenceDistanceBetweenIterations(from,
+                                                          to,
+                                                          nestedLoop,
+                                                          distance);
+}
+
+bool LoopIterationDomainSpaceAnalysis::isMemoryAccessSpaceKnown(
+    Instruction *I) const {
+  auto accessSpaceIt = accessSpaceByInstruction.find(I);
+  if (accessSpaceIt == accessSpaceByInstruction.end()) {
+    return false;
+  }
+  auto accessSpace = accessSpaceIt->second;
+
+  /*
+   * Check the subscripts.
+   */
+  if (accessSpace->subscriptIVs.size() == 0) {
+    return false;
+  }
+  for (auto &instIVPair : accessSpace->subscriptIVs) {
+    if (instIVPair.second == nullptr) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool LoopIterationDomainSpaceAnalysis::
     isMemoryAccessSpaceEquivalentForTopLoopIVSubscript(
         MemoryAccessSpace *space1,
@@ -112,6 +399,22 @@ bool LoopIterationDomainSpaceAnalysis::
    * and governed by the same SCEV derived from that IV
    */
   auto rootLoopStructure = this->loops->getLoop();
+
+  /*
+   * Spaces with the same canonical form have the same subscripts, and
+   * therefore the same IVs: they only need each subscript to be governed by
+   * an IV.
+   */
+  if (true && (space1->canonicalForm != nullptr)
+      && (space1->canonicalForm == space2->canonicalForm)) {
+    for (auto &instIVPair : space1->subscriptIVs) {
+      if (instIVPair.second == nullptr) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   for (auto subscriptIdx = 0; subscriptIdx < space1->subscriptIVs.size();
        ++subscriptIdx) {
     auto iv1 = space1->subscriptIVs[subscriptIdx].second;
@@ -267,23 +570,27 @@ void LoopIterationDomainSpaceAnalysis::computeMemoryAccessSpace(
       continue;
 
     /*
-     * De-linearize: collect parametric SCEV terms, dimension sizes, and
-     * computed access SCEVs per dimension
+     * De-linearize the access, or fetch the delinearization of an equivalent
+     * one (same base pointer and SCEV) computed for this loop or another one
      */
     auto basePointer = dyn_cast<SCEVUnknown>(
         SE.getPointerBase(memAccessSpace->memoryAccessorSCEV));
     if (!basePointer)
       continue;
 
-    auto accessFunction =
-        SE.getMinusSCEV(memAccessSpace->memoryAccessorSCEV, basePointer);
-    ScalarEvolutionDelinearization::delinearize(SE,
-                                                accessFunction,
-                                                memAccessSpace->subscripts,
-                                                memAccessSpace->sizes,
-                                                memAccessSpace->elementSize);
+    auto delinearization =
+        this->fetchDelinearization(SE,
+                                   basePointer,
+                                   memAccessSpace->memoryAccessorSCEV,
+                                   memAccessSpace->elementSize);
+    memAccessSpace->subscripts = delinearization->subscripts;
+    memAccessSpace->sizes = delinearization->sizes;
+    memAccessSpace->canonicalForm = delinearization;
 
     if (memAccessSpace->subscripts.size() == 0) {
+      memAccessSpace->canonicalForm = nullptr;
+      auto accessFunction =
+          SE.getMinusSCEV(memAccessSpace->memoryAccessorSCEV, basePointer);
       if (auto gep =
               dyn_cast<GetElementPtrInst>(memAccessSpace->memoryAccessor)) {
         SmallVector<int, 4> sizes;
@@ -326,6 +633,7 @@ void LoopIterationDomainSpaceAnalysis::computeMemoryAccessSpace(
     if (!isFullyDelinearized) {
       memAccessSpace->subscripts.clear();
       memAccessSpace->sizes.clear();
+      memAccessSpace->canonicalForm = nullptr;
     }
 
     // basePointer->print(errs() << "Base pointer: "); errs() << "\n";
@@ -533,19 +841,70 @@ void LoopIterationDomainSpaceAnalysis::identifyIVForMemoryAccessSubscripts(
     return emptyPair;
   };
 
+  /*
+   * Subscripts are uniqued SCEVs shared by many accesses (e.g., the rows and
+   * the columns of the matrices of a nest), so look each of them up once.
+   */
+  std::unordered_map<const SCEV *,
+                     std::pair<Instruction *, InductionVariable *>>
+      subscriptIVsBySCEV;
   for (auto &memAccessSpace : this->accessSpaces) {
     for (auto subscriptSCEV : memAccessSpace->subscripts) {
-      auto ivOrNullptr = findCorrespondingIVForSubscript(subscriptSCEV);
-      memAccessSpace->subscriptIVs.push_back(ivOrNullptr);
+      auto found = subscriptIVsBySCEV.find(subscriptSCEV);
+      if (found == subscriptIVsBySCEV.end()) {
+        auto ivOrNullptr = findCorrespondingIVForSubscript(subscriptSCEV);
+        auto pair = std::make_pair(subscriptSCEV, ivOrNullptr);
+        found = subscriptIVsBySCEV.insert(pair).first;
+      }
+      memAccessSpace->subscriptIVs.push_back(found->second);
     }
   }
 
   return;
 }
 
+const LoopIterationDomainSpaceAnalysis::DelinearizedAccess *
+LoopIterationDomainSpaceAnalysis::fetchDelinearization(
+    ScalarEvolution &SE,
+    const SCEVUnknown *basePointer,
+    const SCEV *accessorSCEV,
+    const SCEV *elementSize) {
+
+  /*
+   * Check if the access has already been delinearized.
+   */
+  auto &accesses = this->delinearizationCache->accesses;
+  auto key = std::make_tuple(basePointer, accessorSCEV, elementSize);
+  auto found = accesses.find(key);
+  if (found != accesses.end()) {
+    return &found->second;
+  }
+
+  /*
+   * De-linearize: collect parametric SCEV terms, dimension sizes, and
+   * computed access SCEVs per dimension
+   */
+  auto &delinearization = accesses[key];
+  auto accessFunction = SE.getMinusSCEV(accessorSCEV, basePointer);
+  ScalarEvolutionDelinearization::delinearize(SE,
+                                              accessFunction,
+                                              delinearization.subscripts,
+                                              delinearization.sizes,
+                                              elementSize);
+
+  return &delinearization;
+}
+
+LoopIterationDomainSpaceAnalysis::DelinearizationCache::DelinearizationCache(
+    ScalarEvolution &SE)
+  : SE{ &SE } {}
+
 LoopIterationDomainSpaceAnalysis::MemoryAccessSpace::MemoryAccessSpace(
     Instruction *memoryAccessor)
-  : memoryAccessor{ memoryAccessor } {}
+  : memoryAccessor{ memoryAccessor },
+    memoryAccessorSCEV{ nullptr },
+    elementSize{ nullptr },
+    canonicalForm{ nullptr } {}
 
 LoopIterationDomainSpaceAnalysis::~LoopIterationDomainSpaceAnalysis() {
   accessSpaces.clear();
@@ -30,6 +30,9 @@ LoopTransformationsManager::LoopTransformationsManager(
     bool enableLoopAwareDependenceAnalyses)
   : chunkSize{ chunkSize },
     maxCores{ maxNumberOfCores },
+    doallScheduling{ DOALL_STATIC_SCHEDULING },
+    helixSynchronization{ HELIX_SPINLOCK_SYNCHRONIZATION },
+    unrollFactor{ 1 },
     _areLoopAwareAnalysesEnabled{ enableLoopAwareDependenceAnalyses },
     enabledOptimizations{ optimizations } {
 
@@ -40,6 +43,9 @@ LoopTransformationsManager::LoopTransformationsManager(
     const LoopTransformationsManager &other) {
   this->chunkSize = other.chunkSize;
   this->maxCores = other.maxCores;
+  this->doallScheduling = other.doallScheduling;
+  this->helixSynchronization = other.helixSynchronization;
+  this->unrollFactor = other.unrollFactor;
   this->enabledTransformations = other.enabledTransformations;
   this->_areLoopAwareAnalysesEnabled = other._areLoopAwareAnalysesEnabled;
 
@@ -50,10 +56,57 @@ uint32_t LoopTransformationsManager::getMaximumNumberOfCores(void) const {
   return this->maxCores;
 }
 
+void LoopTransformationsManager::setMaximumNumberOfCores(uint32_t cores) {
+  this->maxCores = cores;
+
+  return;
+}
+
 uint32_t LoopTransformationsManager::getChunkSize(void) const {
   return this->chunkSize;
 }
 
+void LoopTransformationsManager::setChunkSize(uint32_t chunkSize) {
+  this->chunkSize = chunkSize;
+
+  return;
+}
+
+DOALLChunkScheduling LoopTransformationsManager::getDOALLChunkScheduling(
+    void) const {
+  return this->doallScheduling;
+}
+
+void LoopTransformationsManager::setDOALLChunkScheduling(
+    DOALLChunkScheduling scheduling) {
+  this->doallScheduling = scheduling;
+
+  return;
+}
+
+HELIXSynchronization LoopTransformationsManager::getHELIXSynchronization(
+    void) const {
+  return this->helixSynchronization;
+}
+
+void LoopTransformationsManager::setHELIXSynchronization(
+    HELIXSynchronization synchronization) {
+  this->helixSynchronization = synchronization;
+
+  return;
+}
+
+uint32_t LoopTransformationsManager::getUnrollFactor(void) const {
+  return this->unrollFactor;
+}
+
+void LoopTransformationsManager::setUnrollFactor(uint32_t unrollFactor) {
+  assert(unrollFactor > 0);
+  this->unrollFactor = unrollFactor;
+
+  return;
+}
+
 bool LoopTransformationsManager::isTransformationEnabled(
     Transformation transformation) {
   auto exist = this->enabledTransformations.find(transformation)
@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/MemoryCloningAnalysis.hpp"
+#include "noelle/core/AllocAA.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
@@ -96,6 +97,75 @@ MemoryCloningAnalysis::MemoryCloningAnalysis(LoopStructure *loop,
     this->clonableMemoryLocations.insert(std::move(location));
   }
 
+  /*
+   * Collect the heap objects allocated before the loop with a size known at
+   * compile time.
+   */
+  std::unordered_map<Value *, uint64_t> otherObjects;
+  auto header = loop->getHeader();
+  for (auto &BB : *function) {
+    if (false || loop->isIncluded(&BB) || (!DS.DT.dominates(&BB, header))) {
+      continue;
+    }
+    for (auto &I : BB) {
+      auto call = dyn_cast<CallInst>(&I);
+      if (false || (call == nullptr) || (!AllocAA::isAnAllocatorCall(call))) {
+        continue;
+      }
+      uint64_t bytes = 1;
+      for (auto &arg : call->arg_operands()) {
+        auto constArg = dyn_cast<ConstantInt>(arg.get());
+        if (constArg == nullptr) {
+          bytes = 0;
+          break;
+        }
+        bytes *= constArg->getZExtValue();
+      }
+      if (bytes == 0) {
+        continue;
+      }
+      otherObjects[call] = bytes * 8;
+    }
+  }
+
+  /*
+   * Collect the global variables that only the current function can access
+   * and that the loop uses directly.
+   */
+  for (auto &global : function->getParent()->globals()) {
+    if (false || global.isConstant() || (!global.hasLocalLinkage())
+        || (!global.getValueType()->isSized())) {
+      continue;
+    }
+    auto isUsedByLoop = false;
+    for (auto user : global.users()) {
+      auto inst = dyn_cast<Instruction>(user);
+      if ((inst != nullptr) && loop->isIncluded(inst)) {
+        isUsedByLoop = true;
+        break;
+      }
+    }
+    if (!isUsedByLoop) {
+      continue;
+    }
+    otherObjects[&global] = DL.getTypeAllocSizeInBits(global.getValueType());
+  }
+
+  /*
+   * Check whether the heap objects and global variables can be privatized.
+   */
+  for (auto objectPair : otherObjects) {
+    auto location = std::make_unique<ClonableMemoryLocation>(objectPair.first,
+                                                             objectPair.second,
+                                                             loop,
+                                                             DS,
+                                                             ldg);
+    if (!location->isClonableLocation()) {
+      continue;
+    }
+    this->clonableMemoryLocations.insert(std::move(location));
+  }
+
   return;
 }
 
@@ -116,7 +186,7 @@ const std::unordered_set<ClonableMemoryLocation *> MemoryCloningAnalysis::
    * TODO: Determine if it is worth mapping from instructions to locations
    */
   for (auto &location : this->clonableMemoryLocations) {
-    if (location->getAllocation() == I) {
+    if (location->getMemoryObject() == I) {
       locs.insert(location.get());
     }
     if (location->isInstructionCastOrGEPOfLocation(I)) {
@@ -175,7 +245,7 @@ bool ClonableMemoryLocation::mustAliasAMemoryLocationWithinObject(
   /*
    * Same value.
    */
-  if (ptr == this->allocation) {
+  if (ptr == this->object) {
     return true;
   }
 
@@ -217,12 +287,14 @@ std::unordered_set<Instruction *> ClonableMemoryLocation::
   return instructions;
 }
 
-ClonableMemoryLocation::ClonableMemoryLocation(AllocaInst *allocation,
+ClonableMemoryLocation::ClonableMemoryLocation(Value *object,
                                                uint64_t sizeInBits,
                                                LoopStructure *loop,
                                                DominatorSummary &DS,
                                                PDG *ldg)
-  : allocation{ allocation },
+  : object{ object },
+    allocation{ dyn_cast<AllocaInst>(object) },
+    allocatedType{ nullptr },
     sizeInBits{ sizeInBits },
     loop{ loop },
     isClonable{ false },
@@ -233,23 +305,33 @@ ClonableMemoryLocation::ClonableMemoryLocation(AllocaInst *allocation,
   /*
    * Check if the current stack object's scope is the loop.
    */
-  this->setObjectScope(allocation, loop, DS);
+  this->setObjectScope(object, loop, DS);
+
+  /*
+   * Fetch the type of the object.
+   * Heap objects do not have one.
+   */
+  if (this->allocation != nullptr) {
+    this->allocatedType = this->allocation->getAllocatedType();
+  } else if (auto global = dyn_cast<GlobalVariable>(object)) {
+    this->allocatedType = global->getValueType();
+  }
 
   /*
-   * Only consider struct and integer types for objects that has scope outside
-   * the loop.
+   * Only consider struct and integer types for stack objects that has scope
+   * outside the loop.
    * TODO: Remove this when array/vector types are supported
    */
-  this->allocatedType = allocation->getAllocatedType();
-  if (true && (!this->isScopeWithinLoop) && (!allocatedType->isStructTy())
-      && (!allocatedType->isIntegerTy())) {
+  if (true && this->isStackObject() && (!this->isScopeWithinLoop)
+      && (!allocatedType->isStructTy()) && (!allocatedType->isIntegerTy())) {
     return;
   }
 
   /*
-   * Identify the instructions that access the stack location.
+   * Identify the instructions that access the memory location.
    */
-  if (!this->identifyStoresAndOtherUsers(loop, DS)) {
+  if (false || (!this->identifyStoresAndOtherUsers(loop, DS))
+      || (!this->areUsesPrivatizable(loop))) {
     return;
   }
 
@@ -260,8 +342,9 @@ ClonableMemoryLocation::ClonableMemoryLocation(AllocaInst *allocation,
    * dependences that involve this stack object and 2) there is no RAW from
    * outside the loop to inside it.
    */
-  this->identifyInitialStoringInstructions(loop, DS);
-  if (!this->isScopeWithinLoop) {
+  auto areReadsPrecededByStores =
+      this->identifyInitialStoringInstructions(loop, DS);
+  if (true && this->isStackObject() && (!this->isScopeWithinLoop)) {
     if (false || (!this->areOverrideSetsFullyCoveringTheAllocationSpace())
         || (this->isThereRAWThroughMemoryFromOutsideLoop(loop,
                                                          allocation,
@@ -270,6 +353,21 @@ ClonableMemoryLocation::ClonableMemoryLocation(AllocaInst *allocation,
     }
   }
 
+  /*
+   * Heap objects and global variables can be partially written by an
+   * iteration (e.g., an array indexed by an induction variable), so the
+   * coverage of the stores cannot be proven syntactically.
+   * Instead, every read must be preceded by a store of the same iteration,
+   * and the dependence graph must not show any read observing a value stored
+   * by another iteration or before the loop.
+   */
+  if (!this->isStackObject()) {
+    if (false || (!areReadsPrecededByStores)
+        || this->canReadsObserveValuesOfOtherIterations(loop, ldg)) {
+      return;
+    }
+  }
+
   /*
    * The location is clonable.
    */
@@ -278,7 +376,7 @@ ClonableMemoryLocation::ClonableMemoryLocation(AllocaInst *allocation,
   return;
 }
 
-void ClonableMemoryLocation::setObjectScope(AllocaInst *allocation,
+void ClonableMemoryLocation::setObjectScope(Value *object,
                                             LoopStructure *loop,
                                             DominatorSummary &ds) {
 
@@ -307,7 +405,7 @@ void ClonableMemoryLocation::setObjectScope(AllocaInst *allocation,
     if (auto castInst = dyn_cast<CastInst>(objectUsed)) {
       objectUsed = castInst->getOperand(0);
     }
-    if (objectUsed == allocation) {
+    if (objectUsed == object) {
 
       /*
        * We found a lifetime call about our stack object.
@@ -324,6 +422,26 @@ AllocaInst *ClonableMemoryLocation::getAllocation(void) const {
   return this->allocation;
 }
 
+Value *ClonableMemoryLocation::getMemoryObject(void) const {
+  return this->object;
+}
+
+bool ClonableMemoryLocation::isStackObject(void) const {
+  return this->allocation != nullptr;
+}
+
+bool ClonableMemoryLocation::isHeapObject(void) const {
+  return isa<CallInst>(this->object);
+}
+
+bool ClonableMemoryLocation::isGlobalObject(void) const {
+  return isa<GlobalVariable>(this->object);
+}
+
+uint64_t ClonableMemoryLocation::getSizeInBytes(void) const {
+  return (this->sizeInBits + 7) / 8;
+}
+
 bool ClonableMemoryLocation::isClonableLocation(void) const {
   return this->isClonable;
 }
@@ -360,15 +478,29 @@ bool ClonableMemoryLocation::isMemCpyInstrinsicCall(CallInst *call) {
   return nameString.find("llvm.memcpy") != std::string::npos;
 }
 
+bool ClonableMemoryLocation::isMemSetInstrinsicCall(CallInst *call) {
+  auto calledFn = call->getCalledFunction();
+  if (!calledFn || !calledFn->hasName())
+    return false;
+  return calledFn->getName().startswith("llvm.memset");
+}
+
+bool ClonableMemoryLocation::isFreeCall(CallInst *call) {
+  auto calledFn = call->getCalledFunction();
+  if (!calledFn || !calledFn->hasName())
+    return false;
+  return calledFn->getName() == "free";
+}
+
 bool ClonableMemoryLocation::identifyStoresAndOtherUsers(LoopStructure *loop,
                                                          DominatorSummary &DS) {
 
   /*
-   * Determine all uses of the stack location.
+   * Determine all uses of the memory location.
    * Ensure they only exist within the loop provided.
    */
-  std::queue<Instruction *> allocationUses{};
-  allocationUses.push(this->allocation);
+  std::queue<Value *> allocationUses{};
+  allocationUses.push(this->object);
   while (!allocationUses.empty()) {
 
     /*
@@ -429,11 +561,22 @@ bool ClonableMemoryLocation::identifyStoresAndOtherUsers(LoopStructure *loop,
           continue;
         }
 
+        /*
+         * Ignore the de-allocation of heap objects after the loop: the clones
+         * do not outlive the tasks.
+         */
+        if (true && this->isHeapObject()
+            && ClonableMemoryLocation::isFreeCall(call)
+            && (!loop->isIncluded(call))) {
+          continue;
+        }
+
         /*
          * We consider llvm.memcpy as a storing instruction if the use is the
          * dest (first operand)
          */
         auto isMemCpy = ClonableMemoryLocation::isMemCpyInstrinsicCall(call);
+        auto isMemSet = ClonableMemoryLocation::isMemSetInstrinsicCall(call);
         auto isUseTheDestinationOp =
             (call->getNumArgOperands() == 4) && (call->getArgOperand(0) == I);
         auto isUseTheSourceOp =
@@ -444,6 +587,9 @@ bool ClonableMemoryLocation::identifyStoresAndOtherUsers(LoopStructure *loop,
         } else if (isMemCpy && isUseTheSourceOp) {
           loadInstructions.insert(call);
 
+        } else if (isMemSet && isUseTheDestinationOp) {
+          storingInstructions.insert(call);
+
         } else {
           this->nonStoringInstructions.insert(call);
         }
@@ -466,6 +612,9 @@ bool ClonableMemoryLocation::identifyStoresAndOtherUsers(LoopStructure *loop,
        * this check
        */
       auto inst = cast<Instruction>(user);
+      if (inst->getFunction() != loop->getFunction()) {
+        return false;
+      }
       if (!loop->isIncluded(inst)) {
         auto block = inst->getParent();
         auto header = loop->getHeader();
@@ -488,7 +637,7 @@ bool ClonableMemoryLocation::identifyStoresAndOtherUsers(LoopStructure *loop,
 
 bool ClonableMemoryLocation::isThereRAWThroughMemoryFromOutsideLoop(
     LoopStructure *loop,
-    AllocaInst *al,
+    Value *al,
     PDG *ldg,
     std::unordered_set<Instruction *> insts) const {
 
@@ -563,7 +712,7 @@ bool ClonableMemoryLocation::isThereRAWThroughMemoryFromOutsideLoop(
 
 bool ClonableMemoryLocation::isThereRAWThroughMemoryFromOutsideLoop(
     LoopStructure *loop,
-    AllocaInst *al,
+    Value *al,
     PDG *ldg) const {
 
   /*
@@ -585,6 +734,79 @@ bool ClonableMemoryLocation::isThereRAWThroughMemoryFromOutsideLoop(
   return false;
 }
 
+bool ClonableMemoryLocation::areUsesPrivatizable(LoopStructure *loop) const {
+
+  /*
+   * Stack objects are checked by the coverage of their stores.
+   */
+  if (this->isStackObject()) {
+    return true;
+  }
+
+  /*
+   * Heap objects and global variables outlive the loop, so the loop must be
+   * the only code that accesses them: only the pointers to them (casts and
+   * GEPs) can be computed before the loop.
+   * Moreover, the pointers to them must not escape: they can only be used to
+   * load and store values, or to copy and set memory.
+   */
+  if (this->nonStoringInstructions.size() > 0) {
+    return false;
+  }
+  for (auto inst : this->storingInstructions) {
+    if (!loop->isIncluded(inst)) {
+      return false;
+    }
+    auto store = dyn_cast<StoreInst>(inst);
+    if (true && (store != nullptr)
+        && this->mustAliasAMemoryLocationWithinObject(
+            store->getValueOperand())) {
+      return false;
+    }
+  }
+  for (auto inst : this->loadInstructions) {
+    if (!loop->isIncluded(inst)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ClonableMemoryLocation::canReadsObserveValuesOfOtherIterations(
+    LoopStructure *loop,
+    PDG *ldg) const {
+
+  /*
+   * Check every read of the memory location.
+   */
+  for (auto inst : this->loadInstructions) {
+
+    /*
+     * Check if the read depends on a store of a previous iteration or of the
+     * code that precedes the loop.
+     */
+    auto functor = [loop](Value *fromValue, DGEdge<Value> *d) -> bool {
+      if (!d->isRAWDependence()) {
+        return false;
+      }
+      if (d->isLoopCarriedDependence()) {
+        return true;
+      }
+      auto fromInst = dyn_cast<Instruction>(fromValue);
+      if (true && (fromInst != nullptr) && loop->isIncluded(fromInst)) {
+        return false;
+      }
+      return true;
+    };
+    if (ldg->iterateOverDependencesTo(inst, false, true, false, functor)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool ClonableMemoryLocation::identifyInitialStoringInstructions(
     LoopStructure *loop,
     DominatorSummary &DS) {
@@ -763,7 +985,8 @@ bool ClonableMemoryLocation::isOverrideSetFullyCoveringTheAllocationSpace(
       }
 
     } else if (auto call = dyn_cast<CallInst>(storingInstruction)) {
-      assert(ClonableMemoryLocation::isMemCpyInstrinsicCall(call));
+      assert(ClonableMemoryLocation::isMemCpyInstrinsicCall(call)
+             || ClonableMemoryLocation::isMemSetInstrinsicCall(call));
 
       // call->print(errs() << "Examining llvm.memcpy call: "); errs() << "\n";
 
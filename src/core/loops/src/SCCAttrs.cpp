@@ -36,7 +36,8 @@ SCCAttrs::SCCAttrs(SCC *s, AccumulatorOpInfo &opInfo, LoopStructure *loop)
     isClonable{ false },
     isSCCClonableIntoLocalMemory{ false },
     hasIV{ false },
-    commutative{ false } {
+    commutative{ false },
+    scanOperation{ nullptr } {
 
   /*
    * Collect the basic blocks of the instructions contained within SCC.
@@ -91,6 +92,10 @@ bool SCCAttrs::isCommutative(void) const {
   return this->commutative;
 }
 
+Instruction *SCCAttrs::getScanOperation(void) const {
+  return this->scanOperation;
+}
+
 uint32_t SCCAttrs::numberOfPHIs(void) {
   return this->PHINodes.size();
 }
@@ -252,6 +257,16 @@ void SCCAttrs::setSCCToBeClonable(bool isClonable) {
   return;
 }
 
+void SCCAttrs::setSCCToBeCommutative(bool isCommutative) {
+  this->commutative = isCommutative;
+  return;
+}
+
+void SCCAttrs::setSCCToBeScan(Instruction *operation) {
+  this->scanOperation = operation;
+  return;
+}
+
 void SCCAttrs::addLoopCarriedVariable(LoopCarriedVariable *variable) {
   loopCarriedVariables.insert(variable);
 }
@@ -275,11 +290,11 @@ void SCCAttrs::addClonableMemoryLocationsContainedInSCC(
   this->clonableMemoryLocations = locations;
 }
 
-std::unordered_set<AllocaInst *> SCCAttrs::getMemoryLocationsToClone(
+std::unordered_set<Value *> SCCAttrs::getMemoryLocationsToClone(
     void) const {
-  std::unordered_set<AllocaInst *> allocations;
+  std::unordered_set<Value *> allocations;
   for (auto location : clonableMemoryLocations) {
-    allocations.insert(location->getAllocation());
+    allocations.insert(location->getMemoryObject());
   }
   return allocations;
 }
@@ -19,12 +19,31 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <future>
+
 #include "noelle/core/SCCDAGAttrs.hpp"
 #include "noelle/core/PDGPrinter.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+#include "noelle/core/TalkDown.hpp"
 #include "LoopCarriedDependencies.hpp"
 
 namespace llvm::noelle {
 
+/*
+ * Options of the SCCDAG attributes
+ */
+static cl::opt<int> SCCDAGAttrsThreads(
+    "noelle-sccdag-attrs-threads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Threads that classify the SCCs of a loop (0: one per core)"),
+    cl::init(1));
+
+/*
+ * Minimum number of SCCs a thread classifies.
+ */
+static const uint64_t minimumSCCsPerThread = 64;
+
 SCCDAGAttrs::SCCDAGAttrs(bool enableFloatAsReal,
                          PDG *loopDG,
                          SCCDAG *loopSCCDAG,
@@ -74,46 +93,90 @@ SCCDAGAttrs::SCCDAGAttrs(bool enableFloatAsReal,
   this->memoryCloningAnalysis = new MemoryCloningAnalysis(rootLoop, DS, loopDG);
 
   /*
-   * Tag SCCs depending on their characteristics.
+   * Allocate the metadata about the SCCs and identify the ones that only
+   * contain induction variables.
+   * This relies on the induction variable manager, so it is done serially.
    */
+  std::vector<SCC *> sccs;
   loopSCCDAG->iterateOverSCCs(
-      [this, &SE, loopNode, rootLoop, &ivs, &loopGoverningIVs](
+      [this, &sccs, loopNode, rootLoop, &ivs, &loopGoverningIVs](
           SCC *scc) -> bool {
-        /*
-         * Allocate the metadata about this SCC.
-         */
         auto sccInfo = new SCCAttrs(scc, this->accumOpInfo, rootLoop);
         this->sccToInfo[scc] = sccInfo;
+        sccs.push_back(scc);
 
-        /*
-         * Collect information about the current SCC.
-         */
-        bool doesSCCOnlyContainIV =
+        auto doesSCCOnlyContainIV =
             this->checkIfSCCOnlyContainsInductionVariables(scc,
                                                            loopNode,
                                                            ivs,
                                                            loopGoverningIVs);
         sccInfo->setSCCToBeInductionVariable(doesSCCOnlyContainIV);
 
-        this->checkIfClonable(scc, SE, loopNode);
+        return false;
+      });
 
-        /*
-         * Categorize the current SCC.
-         */
-        if (this->checkIfIndependent(scc)) {
-          sccInfo->setType(SCCAttrs::SCCType::INDEPENDENT);
+  /*
+   * Tag SCCs depending on their characteristics.
+   * Classifying a SCC only reads the graphs, the IR, and the metadata
+   * allocated above, and it only writes the metadata of that SCC. Hence,
+   * SCCs are classified in parallel and the result does not depend on the
+   * number of threads.
+   */
+  uint64_t numThreads = (SCCDAGAttrsThreads.getValue() > 0)
+                            ? SCCDAGAttrsThreads.getValue()
+                            : std::thread::hardware_concurrency();
+  numThreads = std::min(numThreads, sccs.size() / minimumSCCsPerThread);
+  auto classify = [this, &sccs, &SE, loopNode](uint64_t first,
+                                               uint64_t last) {
+    for (auto i = first; i < last; i++) {
+      this->classifySCC(sccs[i], SE, loopNode);
+    }
+  };
+  if (numThreads <= 1) {
+    classify(0, sccs.size());
+  } else {
+    std::vector<std::future<void>> tasks;
+    uint64_t sccsPerTask = (sccs.size() + numThreads - 1) / numThreads;
+    for (uint64_t first = 0; first < sccs.size(); first += sccsPerTask) {
+      auto last = std::min(first + sccsPerTask, (uint64_t)sccs.size());
+      tasks.push_back(std::async(std::launch::async, classify, first, last));
+    }
+    for (auto &task : tasks) {
+      task.get();
+    }
+  }
 
-        } else if (this->checkIfReducible(scc, loopNode)) {
-          sccInfo->setType(SCCAttrs::SCCType::REDUCIBLE);
+  collectSCCGraphAssumingDistributedClones();
 
-        } else {
-          sccInfo->setType(SCCAttrs::SCCType::SEQUENTIAL);
-        }
+  return;
+}
 
-        return false;
-      });
+void SCCDAGAttrs::classifySCC(SCC *scc,
+                              ScalarEvolution &SE,
+                              StayConnectedNestedLoopForestNode *loopNode) {
+  auto sccInfo = this->getSCCAttrs(scc);
 
-  collectSCCGraphAssumingDistributedClones();
+  /*
+   * Collect information about the current SCC.
+   */
+  this->checkIfClonable(scc, SE, loopNode);
+
+  /*
+   * Categorize the current SCC.
+   */
+  if (this->checkIfIndependent(scc)) {
+    sccInfo->setType(SCCAttrs::SCCType::INDEPENDENT);
+
+  } else if (this->checkIfReducible(scc, loopNode)) {
+    sccInfo->setType(SCCAttrs::SCCType::REDUCIBLE);
+
+  } else {
+    sccInfo->setType(SCCAttrs::SCCType::SEQUENTIAL);
+    sccInfo->setSCCToBeCommutative(this->checkIfCommutative(scc));
+    if (!sccInfo->isInductionVariableSCC()) {
+      sccInfo->setSCCToBeScan(this->getOperationOfScan(scc, loopNode));
+    }
+  }
 
   return;
 }
@@ -576,6 +639,200 @@ bool SCCDAGAttrs::checkIfIndependent(SCC *scc) {
          == this->sccToLoopCarriedDependencies.end();
 }
 
+/*
+ * The SCC is commutative if its loop-carried data dependences are only between
+ * operations that can run in any order: the ones annotated as commutative in
+ * the source code and the calls to library functions specified as such.
+ */
+bool SCCDAGAttrs::checkIfCommutative(SCC *scc) {
+  auto isCommutativeOperation = [](Value *value) -> bool {
+    auto inst = dyn_cast<Instruction>(value);
+    if (inst == nullptr) {
+      return false;
+    }
+    if (TalkDown::isCommutative(inst)) {
+      return true;
+    }
+    if (auto call = dyn_cast<CallBase>(inst)) {
+      auto callee = call->getCalledFunction();
+      if (true && (callee != nullptr) && callee->empty()
+          && PDGAnalysis::isTheLibraryFunctionCommutative(callee)) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto lcDeps = this->sccToLoopCarriedDependencies.find(scc);
+  if (lcDeps == this->sccToLoopCarriedDependencies.end()) {
+    return false;
+  }
+  for (auto dep : lcDeps->second) {
+    if (false || (!dep->isMemoryDependence())
+        || (!isCommutativeOperation(dep->getOutgoingT()))
+        || (!isCommutativeOperation(dep->getIncomingT()))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * The SCC computes a scan if it is the recurrence of a single variable updated
+ * once per iteration by an associative operation (i.e., x = x op v): an integer
+ * addition, multiplication, or bitwise operation, or a minimum or a maximum
+ * (i.e., a compare and a select). Floating point operations are considered
+ * only if floating point values can be considered real numbers.
+ * Unlike reducible SCCs, the intermediate values of the variable can be used
+ * by the rest of the loop.
+ */
+Instruction *SCCDAGAttrs::getOperationOfScan(
+    SCC *scc,
+    StayConnectedNestedLoopForestNode *loopNode) {
+
+  /*
+   * The loop-carried data dependences of the SCC must all reach the same PHI
+   * in the header of the loop.
+   */
+  auto lcDeps = this->sccToLoopCarriedDependencies.find(scc);
+  if (lcDeps == this->sccToLoopCarriedDependencies.end()) {
+    return nullptr;
+  }
+  auto rootLoop = loopNode->getLoop();
+  PHINode *phi = nullptr;
+  for (auto dep : lcDeps->second) {
+    if (dep->isMemoryDependence()) {
+      return nullptr;
+    }
+    if (dep->isControlDependence()) {
+      if (scc->isInternal(dep->getOutgoingT())) {
+        return nullptr;
+      }
+      continue;
+    }
+    auto consumer = dyn_cast<PHINode>(dep->getIncomingT());
+    if (false || (consumer == nullptr) || (!scc->isInternal(consumer))
+        || (consumer->getParent() != rootLoop->getHeader())
+        || ((phi != nullptr) && (phi != consumer))) {
+      return nullptr;
+    }
+    phi = consumer;
+  }
+  if (phi == nullptr) {
+    return nullptr;
+  }
+
+  /*
+   * The initial value of the variable must come from outside the loop, and
+   * the loop must update it once per iteration.
+   */
+  if (phi->getNumIncomingValues() != 2) {
+    return nullptr;
+  }
+  auto latchIndex = rootLoop->isIncluded(phi->getIncomingBlock(0)) ? 0 : 1;
+  if (false || (!rootLoop->isIncluded(phi->getIncomingBlock(latchIndex)))
+      || rootLoop->isIncluded(phi->getIncomingBlock(1 - latchIndex))) {
+    return nullptr;
+  }
+  auto operation = dyn_cast<Instruction>(phi->getIncomingValue(latchIndex));
+  if (false || (operation == nullptr) || (!scc->isInternal(operation))) {
+    return nullptr;
+  }
+
+  /*
+   * The variable must be an integer or a floating point value.
+   */
+  auto variableType = phi->getType();
+  if (true && (variableType->isFloatTy() || variableType->isDoubleTy())) {
+    if (!this->enableFloatAsReal) {
+      return nullptr;
+    }
+  } else if (false || (!variableType->isIntegerTy())
+             || (variableType->getIntegerBitWidth() > 64)) {
+    return nullptr;
+  }
+
+  /*
+   * Check the operation.
+   */
+  Instruction *compare = nullptr;
+  Value *value = nullptr;
+  if (auto binaryOperation = dyn_cast<BinaryOperator>(operation)) {
+    switch (binaryOperation->getOpcode()) {
+      case Instruction::Add:
+      case Instruction::Mul:
+      case Instruction::And:
+      case Instruction::Or:
+      case Instruction::Xor:
+      case Instruction::FAdd:
+      case Instruction::FMul:
+        break;
+      default:
+        return nullptr;
+    }
+    if (binaryOperation->getOperand(0) == phi) {
+      value = binaryOperation->getOperand(1);
+    } else if (binaryOperation->getOperand(1) == phi) {
+      value = binaryOperation->getOperand(0);
+    } else {
+      return nullptr;
+    }
+
+  } else if (auto selectInst = dyn_cast<SelectInst>(operation)) {
+
+    /*
+     * The select must pick either the variable or the value compared with it.
+     */
+    if (selectInst->getTrueValue() == phi) {
+      value = selectInst->getFalseValue();
+    } else if (selectInst->getFalseValue() == phi) {
+      value = selectInst->getTrueValue();
+    } else {
+      return nullptr;
+    }
+    auto cmpInst = dyn_cast<CmpInst>(selectInst->getCondition());
+    if (false || (cmpInst == nullptr) || (!cmpInst->hasOneUse())
+        || cmpInst->isEquality()) {
+      return nullptr;
+    }
+    auto predicate = cmpInst->getPredicate();
+    if (false || (predicate == CmpInst::FCMP_FALSE)
+        || (predicate == CmpInst::FCMP_TRUE)
+        || (predicate == CmpInst::FCMP_ORD)
+        || (predicate == CmpInst::FCMP_UNO)) {
+      return nullptr;
+    }
+    auto lhs = cmpInst->getOperand(0);
+    auto rhs = cmpInst->getOperand(1);
+    auto comparesTheVariableWithTheValue =
+        false || ((lhs == phi) && (rhs == value))
+        || ((lhs == value) && (rhs == phi));
+    if (!comparesTheVariableWithTheValue) {
+      return nullptr;
+    }
+    compare = cmpInst;
+
+  } else {
+    return nullptr;
+  }
+
+  /*
+   * The SCC must include only the variable and its update.
+   */
+  if (scc->isInternal(value)) {
+    return nullptr;
+  }
+  for (auto nodePair : scc->internalNodePairs()) {
+    auto inst = nodePair.first;
+    if (true && (inst != phi) && (inst != operation) && (inst != compare)) {
+      return nullptr;
+    }
+  }
+
+  return operation;
+}
+
 void SCCDAGAttrs::checkIfClonable(SCC *scc,
                                   ScalarEvolution &SE,
                                   StayConnectedNestedLoopForestNode *loopNode) {
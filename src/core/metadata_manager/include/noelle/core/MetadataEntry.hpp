@@ -25,18 +25,58 @@
 
 namespace llvm::noelle {
 
+/*
+ * Types of the values of metadata.
+ * Enumerations are stored as their integer values.
+ */
+enum MetadataKind {
+  STRING_METADATA,
+  INTEGER_METADATA,
+  DOUBLE_METADATA,
+  ENUM_METADATA
+};
+
 class MetadataEntry {
 public:
   MetadataEntry(const std::string metadataName,
                 const std::string metadataValue);
 
+  /*
+   * Create an integer or an enumeration entry.
+   */
+  MetadataEntry(const std::string metadataName,
+                MetadataKind metadataKind,
+                int64_t metadataValue);
+
+  MetadataEntry(const std::string metadataName, double metadataValue);
+
   std::string getName(void) const;
 
+  MetadataKind getKind(void) const;
+
+  /*
+   * Return the value as a string (numeric values are printed).
+   */
   std::string getValue(void) const;
 
+  /*
+   * Return the value of an integer or an enumeration entry.
+   * A string entry is parsed.
+   */
+  int64_t getValueAsInteger(void) const;
+
+  /*
+   * Return the value of a numeric entry.
+   * A string entry is parsed.
+   */
+  double getValueAsDouble(void) const;
+
 private:
   const std::string name;
+  const MetadataKind kind;
   const std::string value;
+  const int64_t integerValue;
+  const double doubleValue;
 };
 
 } // namespace llvm::noelle
@@ -86,6 +86,78 @@ public:
                       const std::string &metadataName,
                       const std::string &metadataValue);
 
+  /*
+   *************** Typed loop APIs
+   *********************************************************
+   *
+   * Typed metadata of loops are stored in a single table of the module,
+   * which is indexed by the ID of the loops (i.e., "noelle.loop_ID").
+   * The table is serialized in the named metadata "noelle.loops.metadata".
+   * The APIs above see typed metadata as strings, and the APIs below parse
+   * string metadata of loops that are not in the table.
+   */
+
+  /*
+   * Return the type of the metadata of the loop.
+   * The metadata must exist.
+   */
+  MetadataKind getMetadataKind(LoopStructure *loop,
+                               const std::string &metadataName);
+
+  /*
+   * Fetch integer metadata attached to the loop.
+   */
+  int64_t getIntegerMetadata(LoopStructure *loop,
+                             const std::string &metadataName);
+
+  /*
+   * Fetch floating point metadata attached to the loop.
+   */
+  double getDoubleMetadata(LoopStructure *loop,
+                           const std::string &metadataName);
+
+  /*
+   * Fetch enumeration metadata attached to the loop.
+   */
+  template <typename T>
+  T getEnumMetadata(LoopStructure *loop, const std::string &metadataName) {
+    return static_cast<T>(this->getIntegerMetadata(loop, metadataName));
+  }
+
+  /*
+   * Add or overwrite integer metadata of the loop.
+   *
+   * Warning: this modifies the IR code.
+   */
+  void setIntegerMetadata(LoopStructure *loop,
+                          const std::string &metadataName,
+                          int64_t metadataValue);
+
+  /*
+   * Add or overwrite floating point metadata of the loop.
+   *
+   * Warning: this modifies the IR code.
+   */
+  void setDoubleMetadata(LoopStructure *loop,
+                         const std::string &metadataName,
+                         double metadataValue);
+
+  /*
+   * Add or overwrite enumeration metadata of the loop.
+   *
+   * Warning: this modifies the IR code.
+   */
+  template <typename T>
+  void setEnumMetadata(LoopStructure *loop,
+                       const std::string &metadataName,
+                       T metadataValue) {
+    this->setLoopEntry(
+        loop,
+        new MetadataEntry(metadataName,
+                          ENUM_METADATA,
+                          static_cast<int64_t>(metadataValue)));
+  }
+
   /*
    *************** Instruction APIs
    **********************************************************
@@ -134,7 +206,34 @@ private:
                      std::unordered_map<std::string, MetadataEntry *>>
       metadata;
 
+  /*
+   * Typed metadata of loops indexed by loop ID, and the operand of
+   * "noelle.loops.metadata" that serializes each of them.
+   */
+  bool isLoopsTableLoaded;
+  std::unordered_map<uint64_t, std::unordered_map<std::string, MetadataEntry *>>
+      loopsTable;
+  std::unordered_map<MetadataEntry *, uint32_t> loopsTableOperands;
+  uint64_t nextLoopID;
+
   void addMetadata(LoopStructure *loop, const std::string &metadataName);
+
+  void loadLoopsTable(void);
+
+  bool getLoopID(LoopStructure *loop, uint64_t &loopID);
+
+  uint64_t getOrAssignLoopID(LoopStructure *loop);
+
+  MetadataEntry *getLoopEntry(LoopStructure *loop,
+                              const std::string &metadataName);
+
+  void setLoopEntry(LoopStructure *loop, MetadataEntry *entry);
+
+  bool deleteLoopEntry(LoopStructure *loop, const std::string &metadataName);
+
+  MDNode *serializeLoopEntry(uint64_t loopID, MetadataEntry *entry);
+
+  void serializeLoopsTable(void);
 };
 
 } // namespace llvm::noelle
@@ -26,7 +26,33 @@ namespace llvm::noelle {
 MetadataEntry::MetadataEntry(const std::string metadataName,
                              const std::string metadataValue)
   : name{ metadataName },
-    value{ metadataValue } {
+    kind{ STRING_METADATA },
+    value{ metadataValue },
+    integerValue{ 0 },
+    doubleValue{ 0 } {
+  return;
+}
+
+MetadataEntry::MetadataEntry(const std::string metadataName,
+                             MetadataKind metadataKind,
+                             int64_t metadataValue)
+  : name{ metadataName },
+    kind{ metadataKind },
+    value{ std::to_string(metadataValue) },
+    integerValue{ metadataValue },
+    doubleValue{ static_cast<double>(metadataValue) } {
+  assert(false || (metadataKind == INTEGER_METADATA)
+         || (metadataKind == ENUM_METADATA));
+  return;
+}
+
+MetadataEntry::MetadataEntry(const std::string metadataName,
+                             double metadataValue)
+  : name{ metadataName },
+    kind{ DOUBLE_METADATA },
+    value{ std::to_string(metadataValue) },
+    integerValue{ static_cast<int64_t>(metadataValue) },
+    doubleValue{ metadataValue } {
   return;
 }
 
@@ -34,8 +60,28 @@ std::string MetadataEntry::getName(void) const {
   return this->name;
 }
 
+MetadataKind MetadataEntry::getKind(void) const {
+  return this->kind;
+}
+
 std::string MetadataEntry::getValue(void) const {
   return this->value;
 }
 
+int64_t MetadataEntry::getValueAsInteger(void) const {
+  if (this->kind == STRING_METADATA) {
+    return std::stoll(this->value);
+  }
+
+  return this->integerValue;
+}
+
+double MetadataEntry::getValueAsDouble(void) const {
+  if (this->kind == STRING_METADATA) {
+    return std::stod(this->value);
+  }
+
+  return this->doubleValue;
+}
+
 } // namespace llvm::noelle
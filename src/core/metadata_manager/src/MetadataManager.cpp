@@ -23,13 +23,23 @@
 
 namespace llvm::noelle {
 
-MetadataManager::MetadataManager(Module &M) : program{ M } {
+MetadataManager::MetadataManager(Module &M)
+  : program{ M },
+    isLoopsTableLoaded{ false },
+    nextLoopID{ 0 } {
   return;
 }
 
 bool MetadataManager::doesHaveMetadata(LoopStructure *loop,
                                        const std::string &metadataName) {
 
+  /*
+   * Check the typed metadata of the loop.
+   */
+  if (this->getLoopEntry(loop, metadataName) != nullptr) {
+    return true;
+  }
+
   /*
    * Check if we have already cached the metadata.
    */
@@ -75,6 +85,14 @@ bool MetadataManager::doesHaveMetadata(LoopStructure *loop,
 std::string MetadataManager::getMetadata(LoopStructure *loop,
                                          const std::string &metadataName) {
 
+  /*
+   * Check the typed metadata of the loop.
+   */
+  auto entry = this->getLoopEntry(loop, metadataName);
+  if (entry != nullptr) {
+    return entry->getValue();
+  }
+
   /*
    * Check if the metadata exists.
    */
@@ -82,7 +100,7 @@ std::string MetadataManager::getMetadata(LoopStructure *loop,
     return "";
   }
 
-  auto loopEntries = this->metadata.at(loop);
+  const auto &loopEntries = this->metadata.at(loop);
   auto metadataEntry = loopEntries.at(metadataName);
   return metadataEntry->getValue();
 }
@@ -91,6 +109,14 @@ void MetadataManager::setMetadata(LoopStructure *loop,
                                   const std::string &metadataName,
                                   const std::string &metadataValue) {
 
+  /*
+   * Typed metadata stay in the table of the loops.
+   */
+  if (this->getLoopEntry(loop, metadataName) != nullptr) {
+    this->setLoopEntry(loop, new MetadataEntry(metadataName, metadataValue));
+    return;
+  }
+
   /*
    * Fetch the header terminator.
    */
@@ -127,6 +153,13 @@ void MetadataManager::deleteMetadata(LoopStructure *loop,
                                      const std::string &metadataName,
                                      const std::string &metadataValue) {
 
+  /*
+   * Check the typed metadata of the loop.
+   */
+  if (this->deleteLoopEntry(loop, metadataName)) {
+    return;
+  }
+
   /*
    * Fetch the header terminator.
    */
@@ -151,7 +184,7 @@ void MetadataManager::deleteMetadata(LoopStructure *loop,
   /*
    * Remove the metadata from our mapping.
    */
-  auto loopEntries = this->metadata[loop];
+  auto &loopEntries = this->metadata[loop];
   delete loopEntries[metadataName];
   loopEntries.erase(metadataName);
 
@@ -171,7 +204,7 @@ void MetadataManager::addMetadata(LoopStructure *loop,
    * Check if the metadata node already exists.
    */
   auto metaNode = headerTerm->getMetadata(metadataName);
-  if (metaNode) {
+  if (metaNode || (this->getLoopEntry(loop, metadataName) != nullptr)) {
     errs() << "MetadataManager::addMetadata: ERROR = the metadata \""
            << metadataName << "\" already exists in the loop " << *headerTerm
            << "\n";
@@ -218,7 +251,8 @@ void MetadataManager::addMetadata(LoopStructure *loop,
   /*
    * Add the metadata.
    */
-  auto loopEntries = this->metadata[loop];
+  auto &loopEntries = this->metadata[loop];
+  delete loopEntries[metadataName];
   loopEntries[metadataName] = new MetadataEntry(metadataName, metaString);
 
   return;
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/MetadataManager.hpp"
+
+namespace llvm::noelle {
+
+MetadataKind MetadataManager::getMetadataKind(
+    LoopStructure *loop,
+    const std::string &metadataName) {
+
+  /*
+   * Check the typed metadata of the loop.
+   */
+  auto entry = this->getLoopEntry(loop, metadataName);
+  if (entry != nullptr) {
+    return entry->getKind();
+  }
+
+  /*
+   * The metadata must be attached to the header of the loop.
+   */
+  if (!this->doesHaveMetadata(loop, metadataName)) {
+    errs() << "MetadataManager::getMetadataKind: ERROR = the metadata \""
+           << metadataName << "\" does not exists in the loop "
+           << *loop->getHeader()->getTerminator() << "\n";
+    abort();
+  }
+
+  return STRING_METADATA;
+}
+
+int64_t MetadataManager::getIntegerMetadata(LoopStructure *loop,
+                                            const std::string &metadataName) {
+
+  /*
+   * Check the typed metadata of the loop.
+   */
+  auto entry = this->getLoopEntry(loop, metadataName);
+  if (entry != nullptr) {
+    return entry->getValueAsInteger();
+  }
+
+  /*
+   * Parse the metadata attached to the header of the loop.
+   */
+  return std::stoll(this->getMetadata(loop, metadataName));
+}
+
+double MetadataManager::getDoubleMetadata(LoopStructure *loop,
+                                          const std::string &metadataName) {
+
+  /*
+   * Check the typed metadata of the loop.
+   */
+  auto entry = this->getLoopEntry(loop, metadataName);
+  if (entry != nullptr) {
+    return entry->getValueAsDouble();
+  }
+
+  /*
+   * Parse the metadata attached to the header of the loop.
+   */
+  return std::stod(this->getMetadata(loop, metadataName));
+}
+
+void MetadataManager::setIntegerMetadata(LoopStructure *loop,
+                                         const std::string &metadataName,
+                                         int64_t metadataValue) {
+  this->setLoopEntry(
+      loop,
+      new MetadataEntry(metadataName, INTEGER_METADATA, metadataValue));
+
+  return;
+}
+
+void MetadataManager::setDoubleMetadata(LoopStructure *loop,
+                                        const std::string &metadataName,
+                                        double metadataValue) {
+  this->setLoopEntry(loop, new MetadataEntry(metadataName, metadataValue));
+
+  return;
+}
+
+void MetadataManager::loadLoopsTable(void) {
+
+  /*
+   * Check if we have already loaded the table.
+   */
+  if (this->isLoopsTableLoaded) {
+    return;
+  }
+  this->isLoopsTableLoaded = true;
+
+  /*
+   * Compute the ID to assign to loops that do not have one.
+   */
+  for (auto &F : this->program) {
+    for (auto &bb : F) {
+      auto terminator = bb.getTerminator();
+      if (terminator == nullptr) {
+        continue;
+      }
+      auto metaNode = terminator->getMetadata("noelle.loop_ID");
+      if (!metaNode) {
+        continue;
+      }
+      auto metaString = cast<MDString>(metaNode->getOperand(0))->getString();
+      uint64_t loopID = std::stoull(metaString.str());
+      this->nextLoopID = std::max(this->nextLoopID, loopID + 1);
+    }
+  }
+
+  /*
+   * Fetch the serialized table.
+   */
+  auto table = this->program.getNamedMetadata("noelle.loops.metadata");
+  if (!table) {
+    return;
+  }
+
+  /*
+   * Load the entries.
+   * Each entry is a tuple with the loop ID, the name, the type, and the value.
+   */
+  for (auto i = 0u; i < table->getNumOperands(); i++) {
+    auto tuple = table->getOperand(i);
+    auto loopID =
+        mdconst::extract<ConstantInt>(tuple->getOperand(0))->getZExtValue();
+    auto name = cast<MDString>(tuple->getOperand(1))->getString().str();
+    auto kind = static_cast<MetadataKind>(
+        mdconst::extract<ConstantInt>(tuple->getOperand(2))->getZExtValue());
+    MetadataEntry *entry = nullptr;
+    switch (kind) {
+      case STRING_METADATA:
+        entry = new MetadataEntry(
+            name,
+            cast<MDString>(tuple->getOperand(3))->getString().str());
+        break;
+      case INTEGER_METADATA:
+      case ENUM_METADATA:
+        entry = new MetadataEntry(
+            name,
+            kind,
+            mdconst::extract<ConstantInt>(tuple->getOperand(3))
+                ->getSExtValue());
+        break;
+      case DOUBLE_METADATA:
+        entry = new MetadataEntry(
+            name,
+            mdconst::extract<ConstantFP>(tuple->getOperand(3))
+                ->getValueAPF()
+                .convertToDouble());
+        break;
+    }
+    assert(entry != nullptr);
+    this->loopsTable[loopID][name] = entry;
+    this->loopsTableOperands[entry] = i;
+    this->nextLoopID = std::max(this->nextLoopID, loopID + 1);
+  }
+
+  return;
+}
+
+bool MetadataManager::getLoopID(LoopStructure *loop, uint64_t &loopID) {
+
+  /*
+   * Fetch the ID of the loop from the terminator of its header.
+   */
+  auto headerTerm = loop->getHeader()->getTerminator();
+  auto metaNode = headerTerm->getMetadata("noelle.loop_ID");
+  if (!metaNode) {
+    return false;
+  }
+  auto metaString = cast<MDString>(metaNode->getOperand(0))->getString();
+  loopID = std::stoull(metaString.str());
+
+  return true;
+}
+
+uint64_t MetadataManager::getOrAssignLoopID(LoopStructure *loop) {
+
+  /*
+   * Check if the loop has an ID already.
+   */
+  uint64_t loopID;
+  if (this->getLoopID(loop, loopID)) {
+    return loopID;
+  }
+
+  /*
+   * Assign a new ID to the loop.
+   */
+  this->loadLoopsTable();
+  loopID = this->nextLoopID++;
+  auto headerTerm = loop->getHeader()->getTerminator();
+  auto &cxt = headerTerm->getContext();
+  auto s = MDString::get(cxt, std::to_string(loopID));
+  auto n = MDNode::get(cxt, s);
+  headerTerm->setMetadata("noelle.loop_ID", n);
+
+  return loopID;
+}
+
+MetadataEntry *MetadataManager::getLoopEntry(
+    LoopStructure *loop,
+    const std::string &metadataName) {
+
+  /*
+   * Fetch the ID of the loop.
+   */
+  uint64_t loopID;
+  if (!this->getLoopID(loop, loopID)) {
+    return nullptr;
+  }
+
+  /*
+   * Fetch the entry.
+   */
+  this->loadLoopsTable();
+  auto loopEntriesIt = this->loopsTable.find(loopID);
+  if (loopEntriesIt == this->loopsTable.end()) {
+    return nullptr;
+  }
+  auto &loopEntries = loopEntriesIt->second;
+  auto entryIt = loopEntries.find(metadataName);
+  if (entryIt == loopEntries.end()) {
+    return nullptr;
+  }
+
+  return entryIt->second;
+}
+
+void MetadataManager::setLoopEntry(LoopStructure *loop, MetadataEntry *entry) {
+
+  /*
+   * Fetch the entries of the loop.
+   */
+  auto loopID = this->getOrAssignLoopID(loop);
+  this->loadLoopsTable();
+  auto &loopEntries = this->loopsTable[loopID];
+
+  /*
+   * Serialize the entry.
+   * An entry that already exists is overwritten in place.
+   */
+  auto table = this->program.getOrInsertNamedMetadata("noelle.loops.metadata");
+  auto node = this->serializeLoopEntry(loopID, entry);
+  auto &oldEntry = loopEntries[entry->getName()];
+  if (oldEntry != nullptr) {
+    auto operandIndex = this->loopsTableOperands.at(oldEntry);
+    table->setOperand(operandIndex, node);
+    this->loopsTableOperands.erase(oldEntry);
+    this->loopsTableOperands[entry] = operandIndex;
+    delete oldEntry;
+
+  } else {
+    this->loopsTableOperands[entry] = table->getNumOperands();
+    table->addOperand(node);
+  }
+  oldEntry = entry;
+
+  return;
+}
+
+bool MetadataManager::deleteLoopEntry(LoopStructure *loop,
+                                      const std::string &metadataName) {
+
+  /*
+   * Fetch the entry.
+   */
+  auto entry = this->getLoopEntry(loop, metadataName);
+  if (entry == nullptr) {
+    return false;
+  }
+
+  /*
+   * Delete the entry.
+   */
+  uint64_t loopID;
+  this->getLoopID(loop, loopID);
+  auto &loopEntries = this->loopsTable.at(loopID);
+  loopEntries.erase(metadataName);
+  if (loopEntries.size() == 0) {
+    this->loopsTable.erase(loopID);
+  }
+  this->loopsTableOperands.erase(entry);
+  delete entry;
+
+  /*
+   * Named metadata cannot drop single operands.
+   * Hence, we serialize the table again.
+   */
+  this->serializeLoopsTable();
+
+  return true;
+}
+
+MDNode *MetadataManager::serializeLoopEntry(uint64_t loopID,
+                                            MetadataEntry *entry) {
+  auto &cxt = this->program.getContext();
+  auto int64Type = IntegerType::get(cxt, 64);
+
+  /*
+   * Serialize the value.
+   */
+  Metadata *value = nullptr;
+  switch (entry->getKind()) {
+    case STRING_METADATA:
+      value = MDString::get(cxt, entry->getValue());
+      break;
+    case INTEGER_METADATA:
+    case ENUM_METADATA:
+      value = ConstantAsMetadata::get(
+          ConstantInt::get(int64Type, entry->getValueAsInteger(), true));
+      break;
+    case DOUBLE_METADATA:
+      value = ConstantAsMetadata::get(
+          ConstantFP::get(Type::getDoubleTy(cxt), entry->getValueAsDouble()));
+      break;
+  }
+
+  /*
+   * Create the tuple.
+   */
+  Metadata *fields[] = {
+    ConstantAsMetadata::get(ConstantInt::get(int64Type, loopID)),
+    MDString::get(cxt, entry->getName()),
+    ConstantAsMetadata::get(ConstantInt::get(int64Type, entry->getKind())),
+    value
+  };
+
+  return MDTuple::get(cxt, fields);
+}
+
+void MetadataManager::serializeLoopsTable(void) {
+
+  /*
+   * Remove the old table.
+   */
+  auto table = this->program.getNamedMetadata("noelle.loops.metadata");
+  if (table) {
+    this->program.eraseNamedMetadata(table);
+  }
+  this->loopsTableOperands.clear();
+  if (this->loopsTable.size() == 0) {
+    return;
+  }
+
+  /*
+   * Serialize the entries.
+   */
+  table = this->program.getOrInsertNamedMetadata("noelle.loops.metadata");
+  for (auto &loopEntriesPair : this->loopsTable) {
+    auto loopID = loopEntriesPair.first;
+    for (auto &entryPair : loopEntriesPair.second) {
+      auto entry = entryPair.second;
+      this->loopsTableOperands[entry] = table->getNumOperands();
+      table->addOperand(this->serializeLoopEntry(loopID, entry));
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
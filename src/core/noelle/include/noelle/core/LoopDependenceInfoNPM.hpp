@@ -0,0 +1,102 @@
+/*
+ * Copyright 2016 - 2021  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "llvm/IR/PassManager.h"
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysisNPM.hpp"
+#include "noelle/core/StayConnectedNestedLoopForest.hpp"
+#include "noelle/core/LoopDependenceInfo.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * The loops of a function for the new pass manager (require<noelle-ldi>).
+ *
+ * The LoopDependenceInfo of every loop of the function is computed from the
+ * dependence graph of the function, so the PDG of the module must have been
+ * computed before (e.g., by require<noelle-pdg>).
+ */
+class LoopDependenceInfoNPM : public AnalysisInfoMixin<LoopDependenceInfoNPM> {
+public:
+  class Result {
+  public:
+    Result(std::unique_ptr<DominatorSummary> dominators,
+           std::vector<std::unique_ptr<LoopStructure>> loopStructures,
+           std::unique_ptr<StayConnectedNestedLoopForest> forest,
+           std::vector<std::unique_ptr<LoopDependenceInfo>> loops);
+
+    /*
+     * The loops are ordered by nesting forest: a loop comes after the loops
+     * that contain it.
+     */
+    std::vector<LoopDependenceInfo *> getLoops(void) const;
+
+    StayConnectedNestedLoopForest *getLoopNestingForest(void) const;
+
+    /*
+     * The loops are kept only if the analyses they are computed from are.
+     */
+    bool invalidate(Function &F,
+                    const PreservedAnalyses &PA,
+                    FunctionAnalysisManager::Invalidator &Inv);
+
+  private:
+    std::unique_ptr<DominatorSummary> dominators;
+    std::vector<std::unique_ptr<LoopStructure>> loopStructures;
+    std::unique_ptr<StayConnectedNestedLoopForest> forest;
+    std::vector<std::unique_ptr<LoopDependenceInfo>> loops;
+  };
+
+  Result run(Function &F, FunctionAnalysisManager &FAM);
+
+private:
+  friend AnalysisInfoMixin<LoopDependenceInfoNPM>;
+  static AnalysisKey Key;
+};
+
+/*
+ * Print the loops of every function and the number of SCCs of their
+ * SCCDAGs (print<noelle-ldi>).
+ */
+class LoopDependenceInfoPrinterPassNPM
+  : public PassInfoMixin<LoopDependenceInfoPrinterPassNPM> {
+public:
+  explicit LoopDependenceInfoPrinterPassNPM(raw_ostream &OS);
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &FAM);
+
+private:
+  raw_ostream &OS;
+};
+
+/*
+ * Append to @MPM the analyses shared by the NOELLE tools (noelle-analyses):
+ * the PDG of the module and, for every function with a body, its dependence
+ * graph and its loops.
+ * Tools that run within the new pass manager start their pipelines with it,
+ * so their passes find these analyses computed and cached.
+ */
+void addNoelleAnalysesNPM(ModulePassManager &MPM);
+
+} // namespace llvm::noelle
@@ -28,6 +28,7 @@
 #include "noelle/core/DataFlow.hpp"
 #include "noelle/core/LoopDependenceInfo.hpp"
 #include "noelle/core/HotProfiler.hpp"
+#include "noelle/core/LoopValueProfiles.hpp"
 #include "noelle/core/Scheduler.hpp"
 #include "noelle/core/MetadataManager.hpp"
 #include "noelle/core/LoopTransformer.hpp"
@@ -89,12 +90,59 @@ public:
   std::vector<LoopStructure *> *getLoopStructures(Function *function,
                                                   double minimumHotness);
 
+  /*
+   * Return the summary of the loops of @function, which the loop structures
+   * of @function share.
+   * The summary is computed again only if the CFG of @function changed since
+   * the last time it has been returned.
+   */
+  std::shared_ptr<FunctionLoopSummary> getFunctionLoopSummary(
+      Function *function);
+
   LoopDependenceInfo *getLoop(LoopStructure *loop);
 
   LoopDependenceInfo *getLoop(
       LoopStructure *loop,
       std::unordered_set<LoopDependenceInfoOptimization> optimizations);
 
+  /*
+   * Compute the abstractions of @loops, which are returned in the same order.
+   * The dependence graph of each function with a loop of @loops is computed
+   * once, and these graphs are computed in parallel (see
+   * -noelle-loops-threads).
+   */
+  std::vector<LoopDependenceInfo *> getLoops(
+      const std::vector<LoopStructure *> &loops,
+      std::unordered_set<LoopDependenceInfoOptimization> optimizations);
+
+  /*
+   * Return the index that identifies @loop in the INDEX_FILE file.
+   * The index is known only for the loops returned by getLoopStructures.
+   *
+   * @return false if the index of @loop is unknown.
+   */
+  bool getLoopIndex(LoopStructure *loop, uint32_t &index) const;
+
+  /*
+   * Configure @ldi as the INDEX_FILE file does: @techniquesToDisable uses
+   * the encoding of that file, and the DOALL chunk size is
+   * @DOALLChunkSize + 1.
+   */
+  void configureLoop(LoopDependenceInfo *ldi,
+                     uint32_t techniquesToDisable,
+                     uint32_t DOALLChunkSize,
+                     uint32_t maxCores) const;
+
+  /*
+   * Choose the DOALL chunk size and scheduling of @ldi from the cycles of its
+   * chunks measured by a previous run (see -noelle-planner-doall-telemetry).
+   * The chunk size is kept if @keepChunkSize is true (e.g., it comes from
+   * INDEX_FILE), and the scheduling is kept if @keepScheduling is true.
+   */
+  void configureDOALLToChunkProfile(LoopDependenceInfo *ldi,
+                                    bool keepChunkSize,
+                                    bool keepScheduling);
+
   uint32_t getNumberOfProgramLoops(void);
 
   uint32_t getNumberOfProgramLoops(double minimumHotness);
@@ -126,16 +174,37 @@ public:
 
   Hot *getProfiles(void);
 
+  LoopValueProfiles *getLoopValueProfiles(void);
+
   PDG *getProgramDependenceGraph(void);
 
   PDG *getFunctionDependenceGraph(Function *f);
 
+  /*
+   * Recompute the dependences of @f after a transformation changed it.
+   * This must be invoked before asking for the dependences (e.g., the loops)
+   * of @f again; the other functions are not affected
+   * (see PDGAnalysis::refreshFunction).
+   */
+  void refreshDependences(Function *f);
+
+  LoopCarriedDependenceProfiles *getLoopCarriedDependenceProfiles(void);
+
+  /*
+   * Check if the memory dependences of @f are coarse because computing them
+   * precisely exceeded the budget of a function
+   * (see PDGAnalysis::hasCoarseMemoryDependences).
+   */
+  bool hasCoarseMemoryDependences(Function *f);
+
   DataFlowAnalysis getDataFlowAnalyses(void) const;
 
   CFGAnalysis getCFGAnalysis(void) const;
 
   DataFlowEngine getDataFlowEngine(void) const;
 
+  DataFlowBitVectorEngine getDataFlowBitVectorEngine(void) const;
+
   Scheduler getScheduler(void) const;
 
   LoopTransformer &getLoopTransformer(void);
@@ -163,6 +232,27 @@ public:
 
   bool canFloatsBeConsideredRealNumbers(void) const;
 
+  /*
+   * Return the number of fixed partitions of the iterations used to reduce
+   * floating point variables reproducibly (i.e., independently of the number
+   * of cores that run the loop).
+   * Return 0 if floating point variables can be reduced in any order.
+   */
+  uint32_t getNumberOfDeterministicReductionPartitions(void) const;
+
+  /*
+   * Return true if HELIX loops must forward their loop-carried values from a
+   * core to the next one through the cache lines used to signal their
+   * sequential segments rather than through a shared spill slot.
+   */
+  bool shouldHELIXForwardLoopCarriedValues(void) const;
+
+  /*
+   * Return true if parallelized loops can buffer the output they write to
+   * FILE streams (see LoopDependenceInfoOptimization::BUFFERED_OUTPUT_ID).
+   */
+  bool canLoopsBufferTheirOutput(void) const;
+
   void linkTransformedLoopToOriginalFunction(
       Module *module,
       BasicBlock *originalPreHeader,
@@ -179,20 +269,30 @@ public:
 private:
   Verbosity verbose;
   bool enableFloatAsReal;
+  uint32_t deterministicReductionPartitions;
   double minHot;
   Module *program;
   Hot *profiles;
+  LoopValueProfiles *valueProfiles;
   PDG *programDependenceGraph;
   std::unordered_set<Transformation> enabledTransformations;
   bool hoistLoopsToMain;
   bool loopAwareDependenceAnalysis;
+  bool lazyLoops;
+  uint32_t loopsThreads;
   PDGAnalysis *pdgAnalysis;
   char *filterFileName;
   bool hasReadFilterFile;
   std::vector<uint32_t> loopThreads;
   std::vector<uint32_t> techniquesToDisable;
   std::vector<uint32_t> DOALLChunkSize;
+  DOALLChunkScheduling doallScheduling;
+  HELIXSynchronization helixSynchronization;
+  bool helixForwardLoopCarriedValues;
+  bool bufferedOutput;
   std::unordered_map<BasicBlock *, uint32_t> loopHeaderToLoopIndexMap;
+  std::unordered_map<Function *, std::shared_ptr<FunctionLoopSummary>>
+      loopSummaries;
   FunctionsManager *fm;
   TypesManager *tm;
   ConstantsManager *cm;
@@ -212,6 +312,11 @@ private:
       uint32_t maxCores,
       std::unordered_set<LoopDependenceInfoOptimization> optimizations);
 
+  LoopDependenceInfo *getLoop(
+      LoopStructure *loop,
+      PDG *funcPDG,
+      std::unordered_set<LoopDependenceInfoOptimization> optimizations);
+
   LoopDependenceInfo *getLoopDependenceInfoForLoop(
       StayConnectedNestedLoopForestNode *loopNode,
       Loop *loop,
@@ -223,6 +328,22 @@ private:
       uint32_t maxCores,
       std::unordered_set<LoopDependenceInfoOptimization> optimizations);
 
+  std::unordered_map<StayConnectedNestedLoopForestNode *, PDG *>
+  computeLoopDGsInParallel(Function *function,
+                           PDG *functionPDG,
+                           StayConnectedNestedLoopForest *forest);
+
+  /*
+   * Compute the dependence graphs of @functions in parallel, one task per
+   * island of the program call graph.
+   */
+  std::unordered_map<Function *, PDG *> computeFunctionDGsInParallel(
+      const std::vector<Function *> &functions);
+
+  LoopDependenceInfo *getLazyLoopDependenceInfo(
+      StayConnectedNestedLoopForestNode *loopNode,
+      std::shared_ptr<PDG *> functionPDG);
+
   bool isLoopHot(LoopStructure *loopStructure, double minimumHotness);
   bool isFunctionHot(Function *function, double minimumHotness);
 
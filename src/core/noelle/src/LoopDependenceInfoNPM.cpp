@@ -0,0 +1,225 @@
+/*
+ * Copyright 2016 - 2021  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Config/llvm-config.h"
+
+#include "noelle/core/LoopDependenceInfoNPM.hpp"
+
+namespace llvm::noelle {
+
+AnalysisKey LoopDependenceInfoNPM::Key;
+
+LoopDependenceInfoNPM::Result::Result(
+    std::unique_ptr<DominatorSummary> dominators,
+    std::vector<std::unique_ptr<LoopStructure>> loopStructures,
+    std::unique_ptr<StayConnectedNestedLoopForest> forest,
+    std::vector<std::unique_ptr<LoopDependenceInfo>> loops)
+  : dominators{ std::move(dominators) },
+    loopStructures{ std::move(loopStructures) },
+    forest{ std::move(forest) },
+    loops{ std::move(loops) } {
+  return;
+}
+
+std::vector<LoopDependenceInfo *> LoopDependenceInfoNPM::Result::getLoops(
+    void) const {
+  std::vector<LoopDependenceInfo *> v;
+  for (auto &ldi : this->loops) {
+    v.push_back(ldi.get());
+  }
+
+  return v;
+}
+
+StayConnectedNestedLoopForest *LoopDependenceInfoNPM::Result::
+    getLoopNestingForest(void) const {
+  return this->forest.get();
+}
+
+bool LoopDependenceInfoNPM::Result::invalidate(
+    Function &F,
+    const PreservedAnalyses &PA,
+    FunctionAnalysisManager::Invalidator &Inv) {
+
+  /*
+   * Check the loops themselves.
+   */
+  auto checker = PA.getChecker<LoopDependenceInfoNPM>();
+  if (!(false || checker.preserved()
+        || checker.preservedSet<AllAnalysesOn<Function>>())) {
+    return true;
+  }
+
+  /*
+   * Check the analyses the loops have been computed from.
+   */
+  if (false || Inv.invalidate<FunctionPDGAnalysisNPM>(F, PA)
+      || Inv.invalidate<LoopAnalysis>(F, PA)
+      || Inv.invalidate<DominatorTreeAnalysis>(F, PA)
+      || Inv.invalidate<PostDominatorTreeAnalysis>(F, PA)
+      || Inv.invalidate<ScalarEvolutionAnalysis>(F, PA)) {
+    return true;
+  }
+
+  return false;
+}
+
+LoopDependenceInfoNPM::Result LoopDependenceInfoNPM::run(
+    Function &F,
+    FunctionAnalysisManager &FAM) {
+
+  /*
+   * Fetch the dependence graph of the function.
+   */
+  auto funcPDG = FAM.getResult<FunctionPDGAnalysisNPM>(F).getFunctionPDG();
+
+  /*
+   * Fetch the analyses of LLVM the loops are computed from.
+   */
+  auto &LI = FAM.getResult<LoopAnalysis>(F);
+  auto &DT = FAM.getResult<DominatorTreeAnalysis>(F);
+  auto &PDT = FAM.getResult<PostDominatorTreeAnalysis>(F);
+  auto &SE = FAM.getResult<ScalarEvolutionAnalysis>(F);
+  auto DS = std::make_unique<DominatorSummary>(DT, PDT);
+
+  /*
+   * Organize the loops of the function in their nesting forest.
+   */
+  std::vector<std::unique_ptr<LoopStructure>> loopStructures;
+  std::vector<LoopStructure *> loopStructurePointers;
+  for (auto loop : LI.getLoopsInPreorder()) {
+    auto ls = std::make_unique<LoopStructure>(loop);
+    loopStructurePointers.push_back(ls.get());
+    loopStructures.push_back(std::move(ls));
+  }
+  std::unordered_map<Function *, DominatorSummary *> doms;
+  doms[&F] = DS.get();
+  auto forest =
+      std::make_unique<StayConnectedNestedLoopForest>(loopStructurePointers,
+                                                      doms);
+
+  /*
+   * Compute the abstraction of every loop.
+   */
+  std::vector<std::unique_ptr<LoopDependenceInfo>> loops;
+  for (auto tree : forest->getTrees()) {
+    auto f = [&](StayConnectedNestedLoopForestNode *loopNode,
+                 uint32_t treeLevel) -> bool {
+      auto llvmLoop = LI.getLoopFor(loopNode->getLoop()->getHeader());
+      loops.push_back(std::make_unique<LoopDependenceInfo>(funcPDG,
+                                                           loopNode,
+                                                           llvmLoop,
+                                                           *DS,
+                                                           SE));
+      return false;
+    };
+    tree->visitPreOrder(f);
+  }
+
+  return Result(std::move(DS),
+                std::move(loopStructures),
+                std::move(forest),
+                std::move(loops));
+}
+
+LoopDependenceInfoPrinterPassNPM::LoopDependenceInfoPrinterPassNPM(
+    raw_ostream &OS)
+  : OS{ OS } {
+  return;
+}
+
+PreservedAnalyses LoopDependenceInfoPrinterPassNPM::run(
+    Function &F,
+    FunctionAnalysisManager &FAM) {
+  if (F.empty()) {
+    return PreservedAnalyses::all();
+  }
+
+  auto &result = FAM.getResult<LoopDependenceInfoNPM>(F);
+  for (auto ldi : result.getLoops()) {
+    auto ls = ldi->getLoopStructure();
+    auto sccdag = ldi->getSCCManager()->getSCCDAG();
+    this->OS << "Loop " << F.getName() << "::" << ls->getHeader()->getName()
+             << ": " << sccdag->numNodes() << " SCCs\n";
+  }
+
+  return PreservedAnalyses::all();
+}
+
+void addNoelleAnalysesNPM(ModulePassManager &MPM) {
+  MPM.addPass(RequireAnalysisPass<PDGAnalysisNPM, Module>());
+
+  FunctionPassManager FPM;
+  FPM.addPass(RequireAnalysisPass<FunctionPDGAnalysisNPM, Function>());
+  FPM.addPass(RequireAnalysisPass<LoopDependenceInfoNPM, Function>());
+  MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+using namespace llvm;
+using namespace llvm::noelle;
+
+// Next there is code to register the analyses to the new pass manager of
+// "opt" (-load-pass-plugin)
+// The analyses of the PDG are registered by the plugin of PDGAnalysis.so,
+// which must be loaded as well.
+extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
+  auto registerCallbacks = [](PassBuilder &PB) {
+    PB.registerAnalysisRegistrationCallback(
+        [](FunctionAnalysisManager &FAM) {
+          FAM.registerPass([] { return LoopDependenceInfoNPM(); });
+        });
+    PB.registerPipelineParsingCallback(
+        [](StringRef name,
+           ModulePassManager &MPM,
+           ArrayRef<PassBuilder::PipelineElement>) {
+          if (name == "noelle-analyses") {
+            addNoelleAnalysesNPM(MPM);
+            return true;
+          }
+          return false;
+        });
+    PB.registerPipelineParsingCallback(
+        [](StringRef name,
+           FunctionPassManager &FPM,
+           ArrayRef<PassBuilder::PipelineElement>) {
+          if (name == "require<noelle-ldi>") {
+            FPM.addPass(RequireAnalysisPass<LoopDependenceInfoNPM, Function>());
+            return true;
+          }
+          if (name == "print<noelle-ldi>") {
+            FPM.addPass(LoopDependenceInfoPrinterPassNPM(errs()));
+            return true;
+          }
+          return false;
+        });
+  };
+
+  return { LLVM_PLUGIN_API_VERSION,
+           "Noelle",
+           LLVM_VERSION_STRING,
+           registerCallbacks };
+}
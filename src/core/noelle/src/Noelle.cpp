@@ -29,12 +29,20 @@ Noelle::Noelle()
   : ModulePass{ ID },
     verbose{ Verbosity::Disabled },
     enableFloatAsReal{ true },
+    deterministicReductionPartitions{ 0 },
     minHot{ 0.0 },
     program{ nullptr },
     profiles{ nullptr },
+    valueProfiles{ nullptr },
     programDependenceGraph{ nullptr },
     hoistLoopsToMain{ false },
     loopAwareDependenceAnalysis{ false },
+    lazyLoops{ false },
+    loopsThreads{ 1 },
+    doallScheduling{ DOALL_STATIC_SCHEDULING },
+    helixSynchronization{ HELIX_SPINLOCK_SYNCHRONIZATION },
+    helixForwardLoopCarriedValues{ false },
+    bufferedOutput{ false },
     fm{ nullptr },
     tm{ nullptr },
     cm{ nullptr },
@@ -47,6 +55,18 @@ bool Noelle::canFloatsBeConsideredRealNumbers(void) const {
   return this->enableFloatAsReal;
 }
 
+uint32_t Noelle::getNumberOfDeterministicReductionPartitions(void) const {
+  return this->deterministicReductionPartitions;
+}
+
+bool Noelle::shouldHELIXForwardLoopCarriedValues(void) const {
+  return this->helixForwardLoopCarriedValues;
+}
+
+bool Noelle::canLoopsBufferTheirOutput(void) const {
+  return this->bufferedOutput;
+}
+
 Module *Noelle::getProgram(void) const {
   return this->program;
 }
@@ -169,6 +189,8 @@ void Noelle::linkTransformedLoopToOriginalFunction(
 
     /*
      * Compute how many values can fit in a cache line.
+     * The exit variable has its own cache line, which is
+     * @envIndexForExitVariable.
      */
     auto valuesInCacheLine =
         Architecture::getCacheLineBytes() / sizeof(int64_t);
@@ -196,11 +218,21 @@ void Noelle::linkTransformedLoopToOriginalFunction(
   for (auto bb : loopExitBlocks) {
     for (auto &I : *bb) {
       if (auto phi = dyn_cast<PHINode>(&I)) {
+
+        /*
+         * Exit blocks not reached from the header (e.g., the ones of a break
+         * statement) can be handled only if their PHIs have a single value.
+         */
         auto bbIndex = phi->getBasicBlockIndex(originalHeader);
+        Value *val = nullptr;
         if (bbIndex == -1) {
+          val = phi->hasConstantValue();
+        } else {
+          val = phi->getIncomingValue(bbIndex);
+        }
+        if (val == nullptr) {
           continue;
         }
-        auto val = phi->getIncomingValue(bbIndex);
         if (isa<Constant>(val)) {
           phi->addIncoming(val, endOfParLoopInOriginalFunc);
         }
@@ -270,6 +302,14 @@ Hot *Noelle::getProfiles(void) {
   return this->profiles;
 }
 
+LoopValueProfiles *Noelle::getLoopValueProfiles(void) {
+  if (this->valueProfiles == nullptr) {
+    this->valueProfiles = new LoopValueProfiles(*this->program);
+  }
+
+  return this->valueProfiles;
+}
+
 DataFlowAnalysis Noelle::getDataFlowAnalyses(void) const {
   return DataFlowAnalysis{};
 }
@@ -282,6 +322,10 @@ DataFlowEngine Noelle::getDataFlowEngine(void) const {
   return DataFlowEngine{};
 }
 
+DataFlowBitVectorEngine Noelle::getDataFlowBitVectorEngine(void) const {
+  return DataFlowBitVectorEngine{};
+}
+
 Scheduler Noelle::getScheduler(void) const {
   return Scheduler{};
 }
@@ -37,6 +37,27 @@ PDG *Noelle::getFunctionDependenceGraph(Function *f) {
   return fdg;
 }
 
+void Noelle::refreshDependences(Function *f) {
+  this->pdgAnalysis->refreshFunction(*f);
+
+  return;
+}
+
+LoopCarriedDependenceProfiles *Noelle::getLoopCarriedDependenceProfiles(
+    void) {
+  return this->pdgAnalysis->getLoopCarriedDependenceProfiles();
+}
+
+bool Noelle::hasCoarseMemoryDependences(Function *f) {
+
+  /*
+   * The functions past their budget are known once the PDG is available.
+   */
+  this->getProgramDependenceGraph();
+
+  return this->pdgAnalysis->hasCoarseMemoryDependences(*f);
+}
+
 std::vector<SCC *> Noelle::sortByHotness(const std::set<SCC *> &SCCs) {
   std::vector<SCC *> s;
 
@@ -19,14 +19,39 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <future>
+
 #include "noelle/core/Noelle.hpp"
 #include "noelle/core/PDGAnalysis.hpp"
 #include "noelle/core/Architecture.hpp"
 #include "noelle/core/StayConnectedNestedLoopForest.hpp"
 #include "noelle/core/HotProfiler.hpp"
+#include "noelle/core/PhaseTimer.hpp"
 
 namespace llvm::noelle {
 
+std::shared_ptr<FunctionLoopSummary> Noelle::getFunctionLoopSummary(
+    Function *function) {
+
+  /*
+   * Check if the summary of the loops is still valid.
+   */
+  auto summaryIt = this->loopSummaries.find(function);
+  if (true && (summaryIt != this->loopSummaries.end())
+      && summaryIt->second->isUpToDate()) {
+    return summaryIt->second;
+  }
+
+  /*
+   * Summarize the loops of the function.
+   */
+  auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
+  auto summary = std::make_shared<FunctionLoopSummary>(*function, LI);
+  this->loopSummaries[function] = summary;
+
+  return summary;
+}
+
 std::vector<LoopStructure *> *Noelle::getLoopStructures(Function *function) {
   return this->getLoopStructures(function, this->minHot);
 }
@@ -38,21 +63,20 @@ std::vector<LoopStructure *> *Noelle::getLoopStructures(Function *function,
    * Check if the function has loops.
    */
   auto allLoops = new std::vector<LoopStructure *>();
-  auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
-  if (std::distance(LI.begin(), LI.end()) == 0) {
+  auto summary = this->getFunctionLoopSummary(function);
+  if (summary->getNumberOfLoops() == 0) {
     return allLoops;
   }
 
   /*
    * Fetch all loops of the current function.
    */
-  auto loops = LI.getLoopsInPreorder();
-  for (auto loop : loops) {
+  for (uint32_t loop = 0; loop < summary->getNumberOfLoops(); loop++) {
 
     /*
      * Check if the loop is hot enough.
      */
-    auto loopStructure = new LoopStructure{ loop };
+    auto loopStructure = new LoopStructure{ summary, loop };
     if (minimumHotness > 0) {
       if (!isLoopHot(loopStructure, minimumHotness)) {
         delete loopStructure;
@@ -122,8 +146,8 @@ std::vector<LoopStructure *> *Noelle::getLoopStructures(double minimumHotness) {
     /*
      * Check if the function has loops.
      */
-    auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
-    if (std::distance(LI.begin(), LI.end()) == 0) {
+    auto summary = this->getFunctionLoopSummary(function);
+    if (summary->getNumberOfLoops() == 0) {
       if (this->verbose >= Verbosity::Maximal) {
         errs() << "Noelle:  Function \"" << function->getName()
                << "\" does not have loops\n";
@@ -134,14 +158,13 @@ std::vector<LoopStructure *> *Noelle::getLoopStructures(double minimumHotness) {
     /*
      * Consider all loops of the current function.
      */
-    auto loops = LI.getLoopsInPreorder();
-    for (auto loop : loops) {
+    for (uint32_t loop = 0; loop < summary->getNumberOfLoops(); loop++) {
       auto currentLoopIndex = nextLoopIndex++;
 
       /*
        * Check if the loop is hot enough.
        */
-      auto loopStructure = new LoopStructure{ loop };
+      auto loopStructure = new LoopStructure{ summary, loop };
       auto loopHeader = loopStructure->getHeader();
       if (!isLoopHot(loopStructure, minimumHotness)) {
         errs() << "Noelle:  Disable loop \"" << currentLoopIndex
@@ -234,12 +257,75 @@ LoopDependenceInfo *Noelle::getLoop(
     std::unordered_set<LoopDependenceInfoOptimization> optimizations) {
 
   /*
-   * Fetch the the function dependence graph, post dominators, and scalar
-   * evolution
+   * Fetch the the function dependence graph.
+   */
+  auto function = loop->getFunction();
+  auto funcPDG = this->getFunctionDependenceGraph(function);
+
+  /*
+   * Compute the LDI abstraction.
+   */
+  auto ldi = this->getLoop(loop, funcPDG, optimizations);
+
+  return ldi;
+}
+
+std::vector<LoopDependenceInfo *> Noelle::getLoops(
+    const std::vector<LoopStructure *> &loops,
+    std::unordered_set<LoopDependenceInfoOptimization> optimizations) {
+  PhaseTimer timer("get-loops", "Noelle::getLoops");
+
+  /*
+   * Fetch the functions of the loops.
+   * They are kept in the order of @loops, so the parallel tasks do not depend
+   * on the order of the hash tables.
+   */
+  std::vector<Function *> functions;
+  std::unordered_set<Function *> functionsSet;
+  for (auto loop : loops) {
+    auto function = loop->getFunction();
+    if (functionsSet.insert(function).second) {
+      functions.push_back(function);
+    }
+  }
+
+  /*
+   * Compute the dependence graphs of the functions.
+   */
+  std::unordered_map<Function *, PDG *> functionDGs;
+  if (this->loopsThreads > 1) {
+    functionDGs = this->computeFunctionDGsInParallel(functions);
+  } else {
+    for (auto function : functions) {
+      functionDGs[function] = this->getFunctionDependenceGraph(function);
+    }
+  }
+
+  /*
+   * Compute the LDI abstractions.
+   * The LLVM analyses they need are not thread-safe, so this is done
+   * sequentially.
+   */
+  std::vector<LoopDependenceInfo *> ldis;
+  for (auto loop : loops) {
+    auto funcPDG = functionDGs.at(loop->getFunction());
+    auto ldi = this->getLoop(loop, funcPDG, optimizations);
+    ldis.push_back(ldi);
+  }
+
+  return ldis;
+}
+
+LoopDependenceInfo *Noelle::getLoop(
+    LoopStructure *loop,
+    PDG *funcPDG,
+    std::unordered_set<LoopDependenceInfoOptimization> optimizations) {
+
+  /*
+   * Fetch the post dominators.
    */
   auto header = loop->getHeader();
   auto function = header->getParent();
-  auto funcPDG = this->getFunctionDependenceGraph(function);
   auto DS = this->getDominators(function);
 
   /*
@@ -320,6 +406,7 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(Function *function) {
 
 std::vector<LoopDependenceInfo *> *Noelle::getLoops(Function *function,
                                                     double minimumHotness) {
+  PhaseTimer timer("get-loops", "Noelle::getLoops");
 
   /*
    * Fetch the profiles.
@@ -339,44 +426,42 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(Function *function,
   }
 
   /*
-   * Fetch the loop analysis.
+   * Fetch the summary of the loops.
    */
-  auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
+  auto summary = this->getFunctionLoopSummary(function);
 
   /*
    * Check if the function has loops.
    */
-  if (std::distance(LI.begin(), LI.end()) == 0) {
+  if (summary->getNumberOfLoops() == 0) {
     return allLoops;
   }
 
   /*
-   * Fetch the function dependence graph.
-   */
-  auto funcPDG = this->getFunctionDependenceGraph(function);
-
-  /*
-   * Fetch the post dominators
+   * Fetch the function dependence graph and the post dominators.
+   * If loops are computed lazily, then they are fetched only when the analyses
+   * of a loop are requested.
    */
-  auto DS = this->getDominators(function);
-
-  /*
-   * Fetch all loops of the current function.
-   */
-  auto loops = LI.getLoopsInPreorder();
+  PDG *funcPDG = nullptr;
+  DominatorSummary *DS = nullptr;
+  auto lazyFunctionPDG = std::make_shared<PDG *>(nullptr);
+  if (!this->lazyLoops) {
+    funcPDG = this->getFunctionDependenceGraph(function);
+    DS = this->getDominators(function);
+  }
 
   /*
-   * Consider these loops.
+   * Consider the loops of the current function.
    *
    * Collect the loop structures.
    */
   std::vector<LoopStructure *> loopStructures;
-  for (auto loop : loops) {
+  for (uint32_t loop = 0; loop < summary->getNumberOfLoops(); loop++) {
 
     /*
      * Check if the loop is hot enough.
      */
-    auto loopS = new LoopStructure(loop);
+    auto loopS = new LoopStructure(summary, loop);
     if (!isLoopHot(loopS, minimumHotness)) {
       delete loopS;
       continue;
@@ -385,8 +470,10 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(Function *function,
     /*
      * Append the loop
      */
-    for (auto edge : funcPDG->getEdges()) {
-      assert(!edge->isLoopCarriedDependence() && "Flag set");
+    if (funcPDG != nullptr) {
+      for (auto edge : funcPDG->getEdges()) {
+        assert(!edge->isLoopCarriedDependence() && "Flag set");
+      }
     }
     loopStructures.push_back(loopS);
   }
@@ -404,6 +491,11 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(Function *function,
       auto ls = loopNode->getLoop();
       assert(ls != nullptr);
       assert(ls->getFunction() == function);
+      if (this->lazyLoops) {
+        auto ldi = this->getLazyLoopDependenceInfo(loopNode, lazyFunctionPDG);
+        allLoops->push_back(ldi);
+        continue;
+      }
 
       /*
        * Forest generation invalids the previous generated LoopInfo, we need to
@@ -439,6 +531,7 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(void) {
 }
 
 std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
+  PhaseTimer timer("get-loops", "Noelle::getLoops");
 
   /*
    * Fetch the profiles.
@@ -471,6 +564,30 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
     errs() << "Noelle: Filter out cold code\n";
   }
   auto nextLoopIndex = 0;
+
+  /*
+   * Compute the dependence graphs of the hot functions with loops in
+   * parallel.
+   * Only the dependence graphs are computed in parallel: they only read the
+   * PDG, while the LLVM analyses the loop abstractions need are not
+   * thread-safe.
+   */
+  std::unordered_map<Function *, PDG *> functionDGs;
+  if (true && (!this->lazyLoops || filterLoops) && (this->loopsThreads > 1)) {
+    std::vector<Function *> functionsWithLoops;
+    for (auto function : *functions) {
+      if (false || function->empty()
+          || (!isFunctionHot(function, minimumHotness))) {
+        continue;
+      }
+      if (this->getFunctionLoopSummary(function)->getNumberOfLoops() == 0) {
+        continue;
+      }
+      functionsWithLoops.push_back(function);
+    }
+    functionDGs = this->computeFunctionDGsInParallel(functionsWithLoops);
+  }
+
   for (auto function : *functions) {
 
     /*
@@ -490,32 +607,35 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
     }
 
     /*
-     * Fetch the loop analysis.
+     * Fetch the summary of the loops.
      */
-    auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
+    auto summary = this->getFunctionLoopSummary(function);
 
     /*
      * Check if the function has loops.
      */
-    if (std::distance(LI.begin(), LI.end()) == 0) {
+    if (summary->getNumberOfLoops() == 0) {
       continue;
     }
 
     /*
-     * Fetch the function dependence graph.
-     */
-    auto funcPDG = this->getFunctionDependenceGraph(function);
-
-    /*
-     * Fetch the post dominators and scalar evolutions
-     */
-    auto DS = this->getDominators(function);
-    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*function).getSE();
-
-    /*
-     * Fetch all loops of the current function.
+     * Fetch the function dependence graph, the post dominators, and the scalar
+     * evolutions.
+     * If loops are computed lazily, then they are fetched only when the
+     * analyses of a loop are requested.
      */
-    auto loops = LI.getLoopsInPreorder();
+    auto computeLoopsLazily = (true && this->lazyLoops && !filterLoops);
+    PDG *funcPDG = nullptr;
+    DominatorSummary *DS = nullptr;
+    ScalarEvolution *SE = nullptr;
+    auto lazyFunctionPDG = std::make_shared<PDG *>(nullptr);
+    if (!computeLoopsLazily) {
+      funcPDG = (functionDGs.find(function) != functionDGs.end())
+                    ? functionDGs.at(function)
+                    : this->getFunctionDependenceGraph(function);
+      DS = this->getDominators(function);
+      SE = &getAnalysis<ScalarEvolutionWrapperPass>(*function).getSE();
+    }
 
     /*
      * Consider these loops.
@@ -524,13 +644,13 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
      */
     std::vector<LoopStructure *> loopStructures;
     std::map<LoopStructure *, uint32_t> loopIDs;
-    for (auto loop : loops) {
+    for (uint32_t loop = 0; loop < summary->getNumberOfLoops(); loop++) {
       auto currentLoopIndex = nextLoopIndex++;
 
       /*
        * Check if the loop is hot enough.
        */
-      auto loopS = new LoopStructure(loop);
+      auto loopS = new LoopStructure(summary, loop);
       if (!isLoopHot(loopS, minimumHotness)) {
         errs() << "Noelle:  Disable loop \"" << currentLoopIndex
                << "\" as cold code\n";
@@ -603,6 +723,15 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
      */
     auto forest = this->organizeLoopsInTheirNestingForest(loopStructures);
 
+    /*
+     * Compute the dependence graphs of the loops in parallel.
+     */
+    std::unordered_map<StayConnectedNestedLoopForestNode *, PDG *> loopDGs;
+    if (true && (!computeLoopsLazily) && (!filterLoops)
+        && (this->loopsThreads > 1)) {
+      loopDGs = this->computeLoopDGsInParallel(function, funcPDG, forest);
+    }
+
     /*
      * Compute the LoopDependeceInfo abstractions.
      */
@@ -615,6 +744,11 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
         auto ls = loopNode->getLoop();
         assert(loopIDs.find(ls) != loopIDs.end());
         auto currentLoopIndex = loopIDs[ls];
+        if (computeLoopsLazily) {
+          auto ldi = this->getLazyLoopDependenceInfo(loopNode, lazyFunctionPDG);
+          allLoops->push_back(ldi);
+          continue;
+        }
 
         /*
          * Fetch the LLVM loop
@@ -627,12 +761,23 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
          * Check if we have to filter loops.
          */
         LoopDependenceInfo *ldi = nullptr;
-        if (!filterLoops) {
+        if (loopDGs.find(loopNode) != loopDGs.end()) {
+          ldi = new LoopDependenceInfo(funcPDG,
+                                       loopDGs[loopNode],
+                                       loopNode,
+                                       LLVMLoop,
+                                       *DS,
+                                       *SE,
+                                       this->om->getMaximumNumberOfCores(),
+                                       this->enableFloatAsReal,
+                                       this->loopAwareDependenceAnalysis);
+
+        } else if (!filterLoops) {
           ldi = new LoopDependenceInfo(funcPDG,
                                        loopNode,
                                        LLVMLoop,
                                        *DS,
-                                       SE,
+                                       *SE,
                                        this->om->getMaximumNumberOfCores(),
                                        this->enableFloatAsReal,
                                        this->loopAwareDependenceAnalysis);
@@ -646,7 +791,7 @@ std::vector<LoopDependenceInfo *> *Noelle::getLoops(double minimumHotness) {
               LLVMLoop,
               funcPDG,
               DS,
-              &SE,
+              SE,
               this->techniquesToDisable[currentLoopIndex],
               this->DOALLChunkSize[currentLoopIndex],
               maximumNumberOfCoresForTheParallelization,
@@ -703,14 +848,14 @@ uint32_t Noelle::getNumberOfProgramLoops(double minimumHotness) {
   for (auto function : *functions) {
 
     /*
-     * Fetch the loop analysis.
+     * Fetch the summary of the loops.
      */
-    auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
+    auto summary = this->getFunctionLoopSummary(function);
 
     /*
      * Check if the function has loops.
      */
-    if (std::distance(LI.begin(), LI.end()) == 0) {
+    if (summary->getNumberOfLoops() == 0) {
       continue;
     }
 
@@ -721,20 +866,15 @@ uint32_t Noelle::getNumberOfProgramLoops(double minimumHotness) {
       continue;
     }
 
-    /*
-     * Fetch all loops of the current function.
-     */
-    auto loops = LI.getLoopsInPreorder();
-
     /*
      * Consider these loops.
      */
-    for (auto loop : loops) {
+    for (uint32_t loop = 0; loop < summary->getNumberOfLoops(); loop++) {
 
       /*
        * Check if the loop is hot enough.
        */
-      LoopStructure loopStructure{ loop };
+      LoopStructure loopStructure{ summary, loop };
       if (!isLoopHot(&loopStructure, minimumHotness)) {
         currentLoopIndex++;
         continue;
@@ -1066,6 +1206,179 @@ LoopDependenceInfo *Noelle::getLoopDependenceInfoForLoop(
   return ldi;
 }
 
+std::unordered_map<StayConnectedNestedLoopForestNode *, PDG *> Noelle::
+    computeLoopDGsInParallel(Function *function,
+                             PDG *functionPDG,
+                             StayConnectedNestedLoopForest *forest) {
+  std::unordered_map<StayConnectedNestedLoopForestNode *, PDG *> loopDGs;
+
+  /*
+   * Fetch the LLVM loops.
+   * LLVM analyses are not thread-safe, so they are queried before starting the
+   * parallel tasks.
+   */
+  auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
+  std::vector<
+      std::vector<std::pair<StayConnectedNestedLoopForestNode *, Loop *>>>
+      jobs;
+  for (auto tree : forest->getTrees()) {
+    std::vector<std::pair<StayConnectedNestedLoopForestNode *, Loop *>> job;
+    for (auto loopNode : tree->getNodes()) {
+      auto llvmLoop = LI.getLoopFor(loopNode->getLoop()->getHeader());
+      job.push_back(std::make_pair(loopNode, llvmLoop));
+    }
+    jobs.push_back(job);
+  }
+
+  /*
+   * Compute the dependence graphs, one task per tree of loops.
+   * Computing the dependence graph of a loop only reads the function
+   * dependence graph and the IR, and each task allocates its own graphs.
+   * At most one task per thread is in flight.
+   */
+  typedef std::vector<std::pair<StayConnectedNestedLoopForestNode *, PDG *>>
+      JobResult;
+  std::deque<std::future<JobResult>> tasks;
+  uint64_t nextJob = 0;
+  for (auto i = 0u; i < jobs.size(); i++) {
+    while (true && (nextJob < jobs.size())
+           && (tasks.size() < this->loopsThreads)) {
+      auto &job = jobs[nextJob];
+      auto computeTask = [&job, functionPDG]() -> JobResult {
+        JobResult result;
+        for (auto &pair : job) {
+          auto loopDG = functionPDG->createLoopsSubgraph(pair.second);
+          result.push_back(std::make_pair(pair.first, loopDG));
+        }
+        return result;
+      };
+      tasks.push_back(std::async(std::launch::async, computeTask));
+      nextJob++;
+    }
+
+    /*
+     * Collect the dependence graphs of the oldest task.
+     */
+    for (auto &pair : tasks.front().get()) {
+      loopDGs[pair.first] = pair.second;
+    }
+    tasks.pop_front();
+  }
+
+  return loopDGs;
+}
+
+std::unordered_map<Function *, PDG *> Noelle::computeFunctionDGsInParallel(
+    const std::vector<Function *> &functions) {
+  std::unordered_map<Function *, PDG *> functionDGs;
+
+  /*
+   * Fetch the PDG and the islands of the program call graph before starting
+   * the parallel tasks.
+   */
+  auto pdg = this->getProgramDependenceGraph();
+  auto callGraph = this->getFunctionsManager()->getProgramCallGraph();
+  auto islands = callGraph->getIslands();
+
+  /*
+   * Group the functions by island.
+   * Islands are ordered by their first function in @functions, so the jobs do
+   * not depend on the order of the hash tables.
+   */
+  std::vector<std::vector<Function *>> jobs;
+  std::unordered_map<noelle::CallGraph *, uint64_t> islandToJob;
+  for (auto function : functions) {
+    auto island = islands[function];
+    if (islandToJob.find(island) == islandToJob.end()) {
+      islandToJob[island] = jobs.size();
+      jobs.push_back({});
+    }
+    jobs[islandToJob[island]].push_back(function);
+  }
+
+  /*
+   * Compute the dependence graphs, one task per island.
+   * Computing the dependence graph of a function only reads the PDG and the
+   * IR, and each task allocates its own graphs.
+   * At most one task per thread is in flight.
+   */
+  typedef std::vector<std::pair<Function *, PDG *>> JobResult;
+  std::deque<std::future<JobResult>> tasks;
+  uint64_t nextJob = 0;
+  for (auto i = 0u; i < jobs.size(); i++) {
+    while (true && (nextJob < jobs.size())
+           && (tasks.size() < this->loopsThreads)) {
+      auto &job = jobs[nextJob];
+      auto computeTask = [&job, pdg]() -> JobResult {
+        JobResult result;
+        for (auto function : job) {
+          auto functionDG = pdg->createFunctionSubgraph(*function);
+          result.push_back(std::make_pair(function, functionDG));
+        }
+        return result;
+      };
+      tasks.push_back(std::async(std::launch::async, computeTask));
+      nextJob++;
+    }
+
+    /*
+     * Collect the dependence graphs of the oldest task.
+     */
+    for (auto &pair : tasks.front().get()) {
+      functionDGs[pair.first] = pair.second;
+    }
+    tasks.pop_front();
+  }
+
+  return functionDGs;
+}
+
+LoopDependenceInfo *Noelle::getLazyLoopDependenceInfo(
+    StayConnectedNestedLoopForestNode *loopNode,
+    std::shared_ptr<PDG *> functionPDG) {
+  auto ls = loopNode->getLoop();
+  auto function = ls->getFunction();
+  auto header = ls->getHeader();
+
+  /*
+   * Define how to fetch the analyses of the loop.
+   * The function dependence graph is shared among the loops of the same
+   * function, and it is computed when the first of them needs it.
+   * The LLVM analyses are fetched again because the ones available when the
+   * LDI has been created could have been invalidated since then.
+   */
+  auto fetchAnalyses =
+      [this, function, header, functionPDG](
+          LoopDependenceInfo::AnalysesConsumer computeAnalyses) {
+        if (*functionPDG == nullptr) {
+          *functionPDG = this->getFunctionDependenceGraph(function);
+        }
+        auto DS = this->getDominators(function);
+        auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
+        auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*function).getSE();
+        auto llvmLoop = LI.getLoopFor(header);
+        computeAnalyses(*functionPDG, llvmLoop, *DS, SE);
+
+        /*
+         * Free the memory.
+         */
+        delete DS;
+      };
+
+  /*
+   * Allocate the LDI.
+   */
+  auto ldi = new LoopDependenceInfo(loopNode,
+                                    this->om->getMaximumNumberOfCores(),
+                                    this->enableFloatAsReal,
+                                    {},
+                                    this->loopAwareDependenceAnalysis,
+                                    8,
+                                    fetchAnalyses);
+
+  return ldi;
+}
+
 LoopDependenceInfo *Noelle::getLoopDependenceInfoForLoop(
     StayConnectedNestedLoopForestNode *loopNode,
     Loop *loop,
@@ -1099,9 +1412,185 @@ LoopDependenceInfo *Noelle::getLoopDependenceInfoForLoop(
   /*
    * Set the techniques that are enabled.
    */
+  this->configureLoop(ldi,
+                      techniquesToDisableForLoop,
+                      DOALLChunkSizeForLoop,
+                      maxCores);
+
+  /*
+   * Set the policy to distribute DOALL chunks among cores.
+   * The loop can override the default policy with the metadata
+   * "noelle.doall.scheduling".
+   */
+  auto ltm = ldi->getLoopTransformationsManager();
+  auto scheduling = this->doallScheduling;
+  auto mm = this->getMetadataManager();
+  auto ls = loopNode->getLoop();
+  if (true && mm->doesHaveMetadata(ls, "noelle.doall.scheduling")
+      && (mm->getMetadataKind(ls, "noelle.doall.scheduling")
+          == ENUM_METADATA)) {
+    scheduling = mm->getEnumMetadata<DOALLChunkScheduling>(
+        ls,
+        "noelle.doall.scheduling");
+  } else if (mm->doesHaveMetadata(ls, "noelle.doall.scheduling")) {
+    auto schedulingName = mm->getMetadata(ls, "noelle.doall.scheduling");
+    if (schedulingName == "static") {
+      scheduling = DOALL_STATIC_SCHEDULING;
+    } else if (schedulingName == "dynamic") {
+      scheduling = DOALL_DYNAMIC_SCHEDULING;
+    } else if (schedulingName == "guided") {
+      scheduling = DOALL_GUIDED_SCHEDULING;
+    } else {
+      errs() << "NOELLE: ERROR = DOALL scheduling \"" << schedulingName
+             << "\" does not exist\n";
+      abort();
+    }
+  }
+  ltm->setDOALLChunkScheduling(scheduling);
+
+  /*
+   * Tune the DOALL chunks to the profile of the loop, if any.
+   */
+  if (mm->doesHaveMetadata(ls, "noelle.doall.profile.chunk_cycles_mean")) {
+    this->configureDOALLToChunkProfile(
+        ldi,
+        DOALLChunkSizeForLoop > 0,
+        mm->doesHaveMetadata(ls, "noelle.doall.scheduling"));
+  }
+
+  /*
+   * Set the mechanism to synchronize HELIX sequential segments.
+   * The loop can override the default mechanism with the metadata
+   * "noelle.helix.synchronization".
+   */
+  auto synchronization = this->helixSynchronization;
+  if (true && mm->doesHaveMetadata(ls, "noelle.helix.synchronization")
+      && (mm->getMetadataKind(ls, "noelle.helix.synchronization")
+          == ENUM_METADATA)) {
+    synchronization = mm->getEnumMetadata<HELIXSynchronization>(
+        ls,
+        "noelle.helix.synchronization");
+  } else if (mm->doesHaveMetadata(ls, "noelle.helix.synchronization")) {
+    auto synchronizationName =
+        mm->getMetadata(ls, "noelle.helix.synchronization");
+    if (synchronizationName == "spinlock") {
+      synchronization = HELIX_SPINLOCK_SYNCHRONIZATION;
+    } else if (synchronizationName == "adaptive") {
+      synchronization = HELIX_ADAPTIVE_SYNCHRONIZATION;
+    } else if (synchronizationName == "dynamic") {
+      synchronization = HELIX_DYNAMIC_SYNCHRONIZATION;
+    } else {
+      errs() << "NOELLE: ERROR = HELIX synchronization \""
+             << synchronizationName << "\" does not exist\n";
+      abort();
+    }
+  }
+  ltm->setHELIXSynchronization(synchronization);
+
+  /*
+   * Set the factor to unroll the loop by before parallelizing it.
+   * The loop can select it with the metadata "noelle.unroll.factor".
+   */
+  if (mm->doesHaveMetadata(ls, "noelle.unroll.factor")) {
+    auto unrollFactor = mm->getIntegerMetadata(ls, "noelle.unroll.factor");
+    if (unrollFactor < 1) {
+      errs() << "NOELLE: ERROR = the unroll factor " << unrollFactor
+             << " is not valid\n";
+      abort();
+    }
+    ltm->setUnrollFactor(unrollFactor);
+  }
+
+  return ldi;
+}
+
+void Noelle::configureDOALLToChunkProfile(LoopDependenceInfo *ldi,
+                                          bool keepChunkSize,
+                                          bool keepScheduling) {
+  auto ltm = ldi->getLoopTransformationsManager();
+  auto ls = ldi->getLoopStructure();
+  auto mm = this->getMetadataManager();
+
+  /*
+   * Fetch the profile.
+   */
+  for (auto name : { "noelle.doall.profile.chunk_size",
+                     "noelle.doall.profile.chunks_per_invocation",
+                     "noelle.doall.profile.chunk_cycles_mean",
+                     "noelle.doall.profile.chunk_cycles_variance" }) {
+    if (!mm->doesHaveMetadata(ls, name)) {
+      return;
+    }
+  }
+  auto profiledChunkSize =
+      mm->getIntegerMetadata(ls, "noelle.doall.profile.chunk_size");
+  auto chunksPerInvocation =
+      mm->getDoubleMetadata(ls, "noelle.doall.profile.chunks_per_invocation");
+  auto chunkMean =
+      mm->getDoubleMetadata(ls, "noelle.doall.profile.chunk_cycles_mean");
+  auto chunkVariance =
+      mm->getDoubleMetadata(ls, "noelle.doall.profile.chunk_cycles_variance");
+  if (false || (profiledChunkSize < 1) || (chunkMean <= 0)) {
+    return;
+  }
+
+  /*
+   * Chunks whose cycles vary a lot relative to their mean leave the cores
+   * that got the short ones idle when chunks are assigned statically.
+   * These are distributed dynamically instead.
+   */
+  auto isImbalanced = (std::sqrt(std::max(chunkVariance, 0.0))
+                       > (0.25 * chunkMean));
+  auto scheduling = ltm->getDOALLChunkScheduling();
+  if (!keepScheduling) {
+    scheduling =
+        isImbalanced ? DOALL_DYNAMIC_SCHEDULING : DOALL_STATIC_SCHEDULING;
+    ltm->setDOALLChunkScheduling(scheduling);
+  }
+  if (keepChunkSize) {
+    return;
+  }
+
+  /*
+   * Size the chunks to last about 10000 cycles, which amortizes fetching
+   * them dynamically and the code that starts each chunk.
+   */
+  auto iterationCycles = chunkMean / (double)profiledChunkSize;
+  auto chunkSize = std::max(std::ceil(10000.0 / iterationCycles), 1.0);
+
+  /*
+   * Every core must get chunks, and cores running imbalanced chunks
+   * dynamically must get several of them to compensate each other.
+   */
+  auto iterationsPerInvocation = chunksPerInvocation * profiledChunkSize;
+  auto cores = std::max(ltm->getMaximumNumberOfCores(), 1u);
+  auto chunksPerCore = (scheduling == DOALL_STATIC_SCHEDULING) ? 1.0 : 8.0;
+  auto maximumChunkSize = std::floor(iterationsPerInvocation
+                                     / ((double)cores * chunksPerCore));
+  chunkSize = std::max(std::min(chunkSize, maximumChunkSize), 1.0);
+  ltm->setChunkSize((uint32_t)std::min(chunkSize, 1000000.0));
+
+  return;
+}
+
+void Noelle::configureLoop(LoopDependenceInfo *ldi,
+                           uint32_t techniquesToDisable,
+                           uint32_t DOALLChunkSize,
+                           uint32_t maxCores) const {
   auto ltm = ldi->getLoopTransformationsManager();
-  auto disableTransformations = techniquesToDisableForLoop;
-  switch (disableTransformations) {
+
+  /*
+   * Set the resources.
+   * DOALL chunk size is the one defined by INDEX_FILE + 1. This is because
+   * chunk size must start from 1.
+   */
+  ltm->setMaximumNumberOfCores(maxCores);
+  ltm->setChunkSize(DOALLChunkSize + 1);
+
+  /*
+   * Set the techniques that are enabled.
+   */
+  switch (techniquesToDisable) {
 
     case 0:
       ltm->enableAllTransformations();
@@ -1138,7 +1627,17 @@ LoopDependenceInfo *Noelle::getLoopDependenceInfoForLoop(
       abort();
   }
 
-  return ldi;
+  return;
+}
+
+bool Noelle::getLoopIndex(LoopStructure *loop, uint32_t &index) const {
+  auto indexIter = this->loopHeaderToLoopIndexMap.find(loop->getHeader());
+  if (indexIter == this->loopHeaderToLoopIndexMap.end()) {
+    return false;
+  }
+  index = indexIter->second;
+
+  return true;
 }
 
 bool Noelle::isLoopHot(LoopStructure *loopStructure, double minimumHotness) {
@@ -41,11 +41,44 @@ static cl::opt<int> MaximumCores(
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Maximum number of logical cores that Noelle can use"));
+static cl::opt<int> DOALLChunkSchedulingPolicy(
+    "noelle-doall-scheduling",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Default DOALL chunk scheduling (0: static, 1: dynamic, 2: guided)"));
+static cl::opt<int> HELIXSynchronizationMechanism(
+    "noelle-helix-synchronization",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Default HELIX sync (0: spinlock, 1: adaptive, 2: dynamic). "
+             "A loop uses one mechanism: dynamic claims iterations from a "
+             "shared ticket and its waits spin then yield as adaptive ones "
+             "do, so it takes the place of adaptive"));
+static cl::opt<bool> HELIXForwardLoopCarriedValues(
+    "noelle-helix-forward-loop-carried-values",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Forward loop-carried values of HELIX loops from core to core "
+             "with the signals of their sequential segments"));
+static cl::opt<bool> BufferedOutput(
+    "noelle-buffered-output",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Let parallelized loops buffer the output they write to FILE "
+             "streams per iteration, which the runtime writes in the order of "
+             "the iterations when the loop ends"));
 static cl::opt<bool> DisableFloatAsReal(
     "noelle-disable-float-as-real",
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Do not consider floating point variables as real numbers"));
+static cl::opt<int> DeterministicFloatReductions(
+    "noelle-deterministic-float-reductions",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Reduce floating point variables reproducibly by splitting the "
+             "iterations in the given number of fixed partitions"));
 static cl::opt<bool> DisableDSWP("noelle-disable-dswp",
                                  cl::ZeroOrMore,
                                  cl::Hidden,
@@ -58,11 +91,87 @@ static cl::opt<bool> DisableDOALL("noelle-disable-doall",
                                   cl::ZeroOrMore,
                                   cl::Hidden,
                                   cl::desc("Disable DOALL"));
+static cl::opt<bool> DisableWavefront(
+    "noelle-disable-wavefront",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the wavefront parallelization of 2-D loop nests"));
+static cl::opt<bool> EnableSpeculativeDOALL(
+    "noelle-enable-speculative-doall",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Enable DOALL loops that check their dependences at run time"));
+static cl::opt<bool> DisableInspectorExecutorDOALL(
+    "noelle-disable-inspector-executor",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable DOALL loops that inspect their subscripts at run time"));
+static cl::opt<bool> DisableArrayReductions(
+    "noelle-disable-array-reductions",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the privatization of arrays reduced by DOALL loops"));
+static cl::opt<bool> DisableScans(
+    "noelle-disable-scans",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the parallel prefix of recurrences in DOALL loops"));
 static cl::opt<bool> DisableDistribution(
     "noelle-disable-loop-distribution",
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Disable the loop distribution"));
+static cl::opt<bool> DisableVersioning(
+    "noelle-disable-loop-versioning",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the loop versioning based on runtime alias checks"));
+static cl::opt<bool> DisableSpecialization(
+    "noelle-disable-loop-specialization",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the loop specialization based on profiled values"));
+static cl::opt<bool> DisableLoopCollapse(
+    "noelle-disable-loop-collapse",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the collapse of perfectly nested loops"));
+static cl::opt<bool> DisableLoopFusion(
+    "noelle-disable-loop-fusion",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the fusion of adjacent loops"));
+static cl::opt<bool> DisableLoopTiling(
+    "noelle-disable-loop-tiling",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the cache-aware tiling of loop nests"));
+static cl::opt<bool> DisableLoopInterchange(
+    "noelle-disable-loop-interchange",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the interchange of loop nests for locality"));
+static cl::opt<bool> DisableStructureSplitting(
+    "noelle-disable-structure-splitting",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the splitting of arrays of structures into arrays of "
+             "fields"));
+static cl::opt<bool> DisablePointerChasingChunking(
+    "noelle-disable-pointer-chasing-chunking",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the traversal of linked lists in chunks of nodes"));
+static cl::opt<bool> DisableScalarExpansion(
+    "noelle-disable-scalar-expansion",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the expansion of temporaries into per-iteration copies"));
+static cl::opt<bool> DisableIterationPeeling(
+    "noelle-disable-iteration-peeling",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Disable the peeling of iterations that take conditional paths"));
 static cl::opt<bool> DisableInvCM(
     "noelle-disable-loop-invariant-code-motion",
     cl::ZeroOrMore,
@@ -82,6 +191,18 @@ static cl::opt<bool> DisableLoopAwareDependenceAnalyses(
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Disable loop aware dependence analyses"));
+static cl::opt<bool> LazyLoops(
+    "noelle-lazy-loops",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Compute the dependence graph and the analyses of a loop only "
+             "when they are requested"));
+static cl::opt<int> LoopsThreads(
+    "noelle-loops-threads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Number of threads used to compute the dependence graphs of "
+             "functions and loops (0: all cores)"));
 static cl::opt<bool> DisableInliner("noelle-disable-inliner",
                                     cl::ZeroOrMore,
                                     cl::Hidden,
@@ -115,9 +236,47 @@ bool Noelle::doInitialization(Module &M) {
   if (optMaxCores == 0) {
     optMaxCores = Architecture::getNumberOfPhysicalCores();
   }
+  auto optDOALLScheduling = DOALLChunkSchedulingPolicy.getValue();
+  if ((optDOALLScheduling < DOALL_STATIC_SCHEDULING)
+      || (optDOALLScheduling > DOALL_GUIDED_SCHEDULING)) {
+    errs() << "NOELLE: ERROR = DOALL scheduling " << optDOALLScheduling
+           << " does not exist\n";
+    abort();
+  }
+  this->doallScheduling = static_cast<DOALLChunkScheduling>(optDOALLScheduling);
+  auto optHELIXSynchronization = HELIXSynchronizationMechanism.getValue();
+  if ((optHELIXSynchronization < HELIX_SPINLOCK_SYNCHRONIZATION)
+      || (optHELIXSynchronization > HELIX_DYNAMIC_SYNCHRONIZATION)) {
+    errs() << "NOELLE: ERROR = HELIX synchronization "
+           << optHELIXSynchronization << " does not exist\n";
+    abort();
+  }
+  this->helixSynchronization =
+      static_cast<HELIXSynchronization>(optHELIXSynchronization);
+  if (HELIXForwardLoopCarriedValues.getNumOccurrences() > 0) {
+    this->helixForwardLoopCarriedValues = true;
+  }
+  if (BufferedOutput.getNumOccurrences() > 0) {
+    this->bufferedOutput = true;
+  }
   if (DisableDOALL.getNumOccurrences() > 0) {
     this->enabledTransformations.erase(DOALL_ID);
   }
+  if (DisableWavefront.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(WAVEFRONT_ID);
+  }
+  if (EnableSpeculativeDOALL.getNumOccurrences() == 0) {
+    this->enabledTransformations.erase(SPECULATIVE_DOALL_ID);
+  }
+  if (DisableInspectorExecutorDOALL.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(INSPECTOR_EXECUTOR_DOALL_ID);
+  }
+  if (DisableArrayReductions.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(ARRAY_REDUCTION_ID);
+  }
+  if (DisableScans.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(SCAN_ID);
+  }
   if (DisableDSWP.getNumOccurrences() > 0) {
     this->enabledTransformations.erase(DSWP_ID);
   }
@@ -127,6 +286,36 @@ bool Noelle::doInitialization(Module &M) {
   if (DisableDistribution.getNumOccurrences() > 0) {
     this->enabledTransformations.erase(LOOP_DISTRIBUTION_ID);
   }
+  if (DisableVersioning.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(LOOP_VERSIONING_ID);
+  }
+  if (DisableSpecialization.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(LOOP_SPECIALIZATION_ID);
+  }
+  if (DisableLoopCollapse.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(LOOP_COLLAPSE_ID);
+  }
+  if (DisableLoopFusion.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(LOOP_FUSION_ID);
+  }
+  if (DisableLoopTiling.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(LOOP_TILING_ID);
+  }
+  if (DisableLoopInterchange.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(LOOP_INTERCHANGE_ID);
+  }
+  if (DisableStructureSplitting.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(STRUCTURE_SPLITTING_ID);
+  }
+  if (DisablePointerChasingChunking.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(POINTER_CHASING_CHUNKING_ID);
+  }
+  if (DisableScalarExpansion.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(SCALAR_EXPANSION_ID);
+  }
+  if (DisableIterationPeeling.getNumOccurrences() > 0) {
+    this->enabledTransformations.erase(ITERATION_PEELING_ID);
+  }
   if (DisableInvCM.getNumOccurrences() > 0) {
     this->enabledTransformations.erase(LOOP_INVARIANT_CODE_MOTION_ID);
   }
@@ -142,12 +331,25 @@ bool Noelle::doInitialization(Module &M) {
   if (InlinerDisableHoistToMain.getNumOccurrences() == 0) {
     this->hoistLoopsToMain = true;
   }
-  if (DisableLoopAwareDependenceAnalyses.getNumOccurrences() == 0) {
+  if (true && (DisableLoopAwareDependenceAnalyses.getNumOccurrences() == 0)
+      && (PDGAnalysis::getPrecision() == PDGPrecision::Full)) {
     this->loopAwareDependenceAnalysis = true;
   }
+  if (LazyLoops.getNumOccurrences() > 0) {
+    this->lazyLoops = true;
+  }
+  if (LoopsThreads.getNumOccurrences() > 0) {
+    this->loopsThreads = (LoopsThreads.getValue() > 0)
+                             ? LoopsThreads.getValue()
+                             : Architecture::getNumberOfLogicalCores();
+  }
   if (DisableFloatAsReal.getNumOccurrences() > 0) {
     this->enableFloatAsReal = false;
   }
+  if (DeterministicFloatReductions.getNumOccurrences() > 0) {
+    this->deterministicReductionPartitions =
+        std::max(DeterministicFloatReductions.getValue(), 0);
+  }
 
   /*
    * Allocate the managers.
@@ -29,6 +29,17 @@ class Outliner {
 public:
   Outliner();
 
+  /*
+   * Move @instructionsToOutline to a new function, and call it just before
+   * @injectCallJustBeforeThis.
+   * The arguments of the new function are the values the instructions use that
+   * are defined outside them, in the order they are first used.
+   * The instructions must run whenever @injectCallJustBeforeThis does (e.g.,
+   * they belong to its basic block), and none of them can be a PHI or a
+   * terminator, or be used outside @instructionsToOutline.
+   * The new function is returned, or nullptr if the instructions cannot be
+   * outlined.
+   */
   Function *outline(
       std::unordered_set<Instruction *> const &instructionsToOutline,
       Instruction *injectCallJustBeforeThis);
@@ -28,15 +28,118 @@ Outliner::Outliner() {
   return;
 }
 
-Function *outline(
+Function *Outliner::outline(
     std::unordered_set<Instruction *> const &instructionsToOutline,
     Instruction *injectCallJustBeforeThis) {
-  // TODO
-  return nullptr;
+  assert(injectCallJustBeforeThis != nullptr);
+
+  /*
+   * Check the instructions.
+   */
+  if (instructionsToOutline.size() == 0) {
+    return nullptr;
+  }
+  if (instructionsToOutline.count(injectCallJustBeforeThis) > 0) {
+    return nullptr;
+  }
+  auto F = injectCallJustBeforeThis->getFunction();
+  for (auto inst : instructionsToOutline) {
+    if (false || (inst->getFunction() != F) || isa<PHINode>(inst)
+        || inst->isTerminator()) {
+      return nullptr;
+    }
+    for (auto user : inst->users()) {
+      auto userInst = dyn_cast<Instruction>(user);
+      if (false || (userInst == nullptr)
+          || (instructionsToOutline.count(userInst) == 0)) {
+        return nullptr;
+      }
+    }
+  }
+
+  /*
+   * Sort the instructions in program order, and collect the values they use
+   * that are defined outside them.
+   */
+  std::vector<Instruction *> sortedInstructions;
+  std::vector<Value *> liveIns;
+  std::unordered_set<Value *> liveInsSet;
+  for (auto &inst : instructions(*F)) {
+    if (instructionsToOutline.count(&inst) == 0) {
+      continue;
+    }
+    sortedInstructions.push_back(&inst);
+    for (auto &op : inst.operands()) {
+      auto value = op.get();
+      if (true && (!isa<Instruction>(value)) && (!isa<Argument>(value))) {
+        continue;
+      }
+      auto valueInst = dyn_cast<Instruction>(value);
+      if (false || (instructionsToOutline.count(valueInst) > 0)
+          || (liveInsSet.count(value) > 0)) {
+        continue;
+      }
+      liveIns.push_back(value);
+      liveInsSet.insert(value);
+    }
+  }
+
+  /*
+   * Create the new function.
+   */
+  auto M = F->getParent();
+  auto &cxt = M->getContext();
+  std::vector<Type *> argTypes;
+  for (auto liveIn : liveIns) {
+    argTypes.push_back(liveIn->getType());
+  }
+  auto functionType =
+      FunctionType::get(Type::getVoidTy(cxt), argTypes, false);
+  auto outlinedF = Function::Create(functionType,
+                                    GlobalValue::InternalLinkage,
+                                    F->getName() + ".outlined",
+                                    M);
+  auto entryBB = BasicBlock::Create(cxt, "", outlinedF);
+
+  /*
+   * Clone the instructions into the new function.
+   * Their debug locations belong to the scope of @F; hence, they are dropped.
+   */
+  ValueToValueMapTy vMap;
+  auto argIndex = 0;
+  for (auto &arg : outlinedF->args()) {
+    vMap[liveIns[argIndex++]] = &arg;
+  }
+  IRBuilder<> builder(entryBB);
+  for (auto inst : sortedInstructions) {
+    auto clone = inst->clone();
+    clone->setDebugLoc(DebugLoc());
+    builder.Insert(clone);
+    vMap[inst] = clone;
+  }
+  for (auto &inst : *entryBB) {
+    RemapInstruction(&inst,
+                     vMap,
+                     RF_NoModuleLevelChanges | RF_IgnoreMissingLocals);
+  }
+  builder.CreateRetVoid();
+
+  /*
+   * Replace the instructions with a call to the new function.
+   */
+  IRBuilder<> callBuilder(injectCallJustBeforeThis);
+  callBuilder.CreateCall(outlinedF, ArrayRef<Value *>(liveIns));
+  for (auto it = sortedInstructions.rbegin(); it != sortedInstructions.rend();
+       ++it) {
+    (*it)->eraseFromParent();
+  }
+
+  return outlinedF;
 }
 
-Function *outline(std::unordered_set<BasicBlock *> const &basicBlocksToOutline,
-                  Instruction *injectCallJustBeforeThis) {
+Function *Outliner::outline(
+    std::unordered_set<BasicBlock *> const &basicBlocksToOutline,
+    Instruction *injectCallJustBeforeThis) {
   // TODO
   return nullptr;
 }
@@ -112,7 +112,7 @@ struct RemediesCompare {
 };
 
 typedef std::set<Remedies_ptr, RemediesCompare> SetOfRemedies;
-typedef std::unique_ptr<SetOfRemedies> SetOfRemedies_ptr;
+typedef std::shared_ptr<SetOfRemedies> SetOfRemedies_ptr;
 
 } // namespace noelle
 } // namespace llvm
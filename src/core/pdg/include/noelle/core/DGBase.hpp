@@ -23,6 +23,7 @@
 
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/Allocator.h"
 #include <climits>
 #include <unordered_map>
 #include <queue>
@@ -48,6 +49,15 @@ class DGEdge;
 
 enum DataDependenceType { DG_DATA_NONE, DG_DATA_RAW, DG_DATA_WAR, DG_DATA_WAW };
 
+/*
+ * Dependence graph.
+ *
+ * Thread safety: the const methods of a graph never change it, not even
+ * lazily, and they can therefore be invoked by multiple threads at the same
+ * time through a const reference (the reader handle of the graph).
+ * No method can be invoked while another thread changes the graph (e.g.,
+ * adding or removing nodes and edges).
+ */
 template <class T>
 class DG {
 public:
@@ -61,6 +71,8 @@ public:
   typedef map<DGEdge<T> *, uint32_t> DepIdReverseMap_t;
 
   typedef typename std::map<T *, DGNode<T> *>::iterator node_map_iterator;
+  typedef typename std::map<T *, DGNode<T> *>::const_iterator
+      node_map_const_iterator;
 
   /*
    * Node and Edge Iterators
@@ -167,6 +179,12 @@ public:
   iterator_range<edges_iterator> getEdges() {
     return make_range(allEdges.begin(), allEdges.end());
   }
+  iterator_range<nodes_const_iterator> getNodes() const {
+    return make_range(allNodes.begin(), allNodes.end());
+  }
+  iterator_range<edges_const_iterator> getEdges() const {
+    return make_range(allEdges.begin(), allEdges.end());
+  }
 
   iterator_range<node_map_iterator> internalNodePairs() {
     return make_range(internalNodeMap.begin(), internalNodeMap.end());
@@ -174,9 +192,17 @@ public:
   iterator_range<node_map_iterator> externalNodePairs() {
     return make_range(externalNodeMap.begin(), externalNodeMap.end());
   }
+  iterator_range<node_map_const_iterator> internalNodePairs() const {
+    return make_range(internalNodeMap.begin(), internalNodeMap.end());
+  }
+  iterator_range<node_map_const_iterator> externalNodePairs() const {
+    return make_range(externalNodeMap.begin(), externalNodeMap.end());
+  }
 
   /*
    * Fetching/Creating Nodes and Edges
+   *
+   * Fetching a node of a value that is not in the graph returns nullptr.
    */
   DGNode<T> *addNode(T *theT, bool inclusion);
   DGNode<T> *fetchOrAddNode(T *theT, bool inclusion);
@@ -184,13 +210,14 @@ public:
   const DGNode<T> *fetchConstNode(T *theT) const;
 
   DGEdge<T> *addEdge(T *from, T *to);
-  std::unordered_set<DGEdge<T> *> fetchEdges(DGNode<T> *From, DGNode<T> *To);
+  std::unordered_set<DGEdge<T> *> fetchEdges(const DGNode<T> *From,
+                                             const DGNode<T> *To) const;
   DGEdge<T> *copyAddEdge(DGEdge<T> &edgeToCopy);
 
   /*
    * Deal with the id for each edge and the corresponding map for debugging
    */
-  optional<uint32_t> getEdgeID(DGEdge<T> *edge) {
+  optional<uint32_t> getEdgeID(DGEdge<T> *edge) const {
     if (depLookupMap && depLookupMap->find(edge) != depLookupMap->end())
       return depLookupMap->at(edge);
     else
@@ -204,8 +231,9 @@ public:
   /*
    * Merging/Extracting Graphs
    */
-  std::unordered_set<DGNode<T> *> getTopLevelNodes(bool onlyInternal = false);
-  std::unordered_set<DGNode<T> *> getLeafNodes(bool onlyInternal = false);
+  std::unordered_set<DGNode<T> *> getTopLevelNodes(
+      bool onlyInternal = false) const;
+  std::unordered_set<DGNode<T> *> getLeafNodes(bool onlyInternal = false) const;
   std::vector<std::unordered_set<DGNode<T> *> *> getDisconnectedSubgraphs();
   std::unordered_set<DGNode<T> *> getNextDepthNodes(DGNode<T> *node);
   std::unordered_set<DGNode<T> *> getPreviousDepthNodes(DGNode<T> *node);
@@ -216,9 +244,26 @@ public:
                              DGNode<T> *entryNode);
   void clear();
 
+  /*
+   * Allocate the nodes and edges added from now on in an arena owned by the
+   * graph, which is released at once when the graph is destroyed.
+   * Removing a node or an edge does not release its memory.
+   * This must be invoked while the graph is empty.
+   */
+  void enableArenaAllocation(void);
+  bool isArenaAllocationEnabled(void) const {
+    return this->arena != nullptr;
+  }
+
   raw_ostream &print(raw_ostream &stream);
 
 protected:
+  DGNode<T> *allocateNode(T *theT);
+  DGEdge<T> *allocateEdge(DGNode<T> *from, DGNode<T> *to);
+  DGEdge<T> *allocateEdge(DGEdge<T> &edgeToCopy);
+  void deallocateNode(DGNode<T> *node);
+  void deallocateEdge(DGEdge<T> *edge);
+
   int32_t nodeIdCounter;
   std::set<DGNode<T> *> allNodes;
   std::set<DGEdge<T> *> allEdges;
@@ -226,6 +271,7 @@ protected:
   std::map<T *, DGNode<T> *> internalNodeMap;
   std::map<T *, DGNode<T> *> externalNodeMap;
   shared_ptr<DepIdReverseMap_t> depLookupMap = nullptr;
+  shared_ptr<BumpPtrAllocator> arena = nullptr;
 };
 
 template <class T>
@@ -275,18 +321,24 @@ public:
   inline iterator_range<edges_iterator> getIncomingEdges() {
     return make_range(incomingEdges.begin(), incomingEdges.end());
   }
+  inline iterator_range<edges_const_iterator> getOutgoingEdges() const {
+    return make_range(outgoingEdges.begin(), outgoingEdges.end());
+  }
+  inline iterator_range<edges_const_iterator> getIncomingEdges() const {
+    return make_range(incomingEdges.begin(), incomingEdges.end());
+  }
 
   T *getT() const {
     return theT;
   }
 
-  unsigned numConnectedEdges() {
+  unsigned numConnectedEdges() const {
     return outgoingEdges.size() + incomingEdges.size();
   }
-  unsigned numOutgoingEdges() {
+  unsigned numOutgoingEdges() const {
     return outgoingEdges.size();
   }
-  unsigned numIncomingEdges() {
+  unsigned numIncomingEdges() const {
     return incomingEdges.size();
   }
 
@@ -323,13 +375,14 @@ public:
   DGEdgeBase(DGNode<T> *src, DGNode<T> *dst)
     : from(src),
       to(dst),
-      subEdges{},
+      subEdges{ nullptr },
       memory{ false },
       must{ false },
       isControl(false),
       isLoopCarried(false),
       isRemovable(false),
       dataDepType{ DG_DATA_NONE },
+      loopCarriedDistance{ 0 },
       remeds(nullptr) {
     return;
   }
@@ -340,20 +393,23 @@ public:
       edges_const_iterator;
 
   edges_iterator begin_sub_edges() {
-    return subEdges.begin();
+    return fetchSubEdges().begin();
   }
   edges_iterator end_sub_edges() {
-    return subEdges.end();
+    return fetchSubEdges().end();
   }
   edges_const_iterator begin_sub_edges() const {
-    return subEdges.begin();
+    return fetchSubEdges().begin();
   }
   edges_const_iterator end_sub_edges() const {
-    return subEdges.end();
+    return fetchSubEdges().end();
   }
 
   inline iterator_range<edges_iterator> getSubEdges() {
-    return make_range(subEdges.begin(), subEdges.end());
+    return make_range(begin_sub_edges(), end_sub_edges());
+  }
+  uint64_t numberOfSubEdges(void) const {
+    return (subEdges) ? subEdges->size() : 0;
   }
 
   std::pair<DGNode<T> *, DGNode<T> *> getNodePair() const {
@@ -400,6 +456,19 @@ public:
   bool isLoopCarriedDependence() const {
     return isLoopCarried;
   }
+
+  /*
+   * Return the number of iterations of the loop of the graph between the
+   * instances of the source and the destination of this loop-carried
+   * dependence that depend on each other.
+   * A loop-carried dependence only exists between iterations that are at least
+   * this distance apart.
+   *
+   * @return 0 if the distance is unknown.
+   */
+  uint32_t getLoopCarriedDistance() const {
+    return loopCarriedDistance;
+  }
   DataDependenceType dataDependenceType() const {
     return dataDepType;
   }
@@ -416,17 +485,29 @@ public:
   void setMemMustType(bool mem, bool must, DataDependenceType dataDepType);
   void setLoopCarried(bool lc) {
     isLoopCarried = lc;
+    if (!lc) {
+      loopCarriedDistance = 0;
+    }
+  }
+  void setLoopCarriedDistance(uint32_t distance) {
+    loopCarriedDistance = distance;
   }
   void setRemedies(std::optional<SetOfRemedies> R) {
     if (R) {
-      remeds = std::make_unique<SetOfRemedies>(*R);
+      remeds = std::make_shared<SetOfRemedies>(*R);
       isRemovable = true;
     }
   }
   void addRemedies(const Remedies_ptr &R) {
     if (!remeds) {
-      remeds = std::make_unique<SetOfRemedies>();
+      remeds = std::make_shared<SetOfRemedies>();
       isRemovable = true;
+    } else if (remeds.use_count() > 1) {
+
+      /*
+       * The remedies are shared with other edges: copy them before the change.
+       */
+      remeds = std::make_shared<SetOfRemedies>(*remeds);
     }
     remeds->insert(R);
   }
@@ -449,13 +530,37 @@ public:
   }
 
   void addSubEdge(DGEdge<SubT> *edge) {
-    subEdges.insert(edge);
+
+    /*
+     * The distance of the loop-carried dependences is the minimum of the ones
+     * of the loop-carried sub-edges; it is unknown if one of them is.
+     */
+    if (edge->isLoopCarriedDependence()) {
+      auto subDistance = edge->getLoopCarriedDistance();
+      if (!isLoopCarried) {
+        loopCarriedDistance = subDistance;
+      } else if (true && (loopCarriedDistance != 0) && (subDistance != 0)) {
+        loopCarriedDistance = std::min(loopCarriedDistance, subDistance);
+      } else {
+        loopCarriedDistance = 0;
+      }
+    }
+    if (!subEdges) {
+      subEdges = std::make_unique<std::unordered_set<DGEdge<SubT> *>>();
+    }
+    subEdges->insert(edge);
     isLoopCarried |= edge->isLoopCarriedDependence();
     if (edge->isRemovableDependence()
-        && (subEdges.size() == 1 || this->isRemovableDependence())) {
+        && (subEdges->size() == 1 || this->isRemovableDependence())) {
       isRemovable = true;
-      if (auto optional_remeds = edge->getRemedies()) {
-        for (auto &r : *(optional_remeds))
+      if (!remeds) {
+
+        /*
+         * The remedies of the first sub-edge are shared rather than copied.
+         */
+        remeds = edge->remeds;
+      } else if (edge->remeds) {
+        for (auto &r : *(edge->remeds))
           this->addRemedies(r);
       }
     } else {
@@ -465,11 +570,17 @@ public:
   }
 
   void removeSubEdge(DGEdge<SubT> *edge) {
-    subEdges.erase(edge);
+    if (!subEdges) {
+      return;
+    }
+    subEdges->erase(edge);
+    if (subEdges->empty()) {
+      subEdges = nullptr;
+    }
   }
 
   void clearSubEdges() {
-    subEdges.clear();
+    subEdges = nullptr;
     setLoopCarried(false);
     remeds = nullptr;
     setRemovable(false);
@@ -490,20 +601,39 @@ public:
   }
 
 protected:
+  std::unordered_set<DGEdge<SubT> *> &fetchSubEdges(void) const {
+    static std::unordered_set<DGEdge<SubT> *> noSubEdges{};
+    return (subEdges) ? *subEdges : noSubEdges;
+  }
+
   DGNode<T> *from;
   DGNode<T> *to;
-  std::unordered_set<DGEdge<SubT> *> subEdges;
 
-  // TODO: Use LLVM's bit set (keep getters the same)
-  bool memory;
-  bool must;
-  bool isControl;
-  bool isLoopCarried;
-  bool isRemovable;
+  /*
+   * Most edges have no sub-edges, so their set is allocated only when the
+   * first sub-edge is added.
+   */
+  std::unique_ptr<std::unordered_set<DGEdge<SubT> *>> subEdges;
 
-  DataDependenceType dataDepType;
+  /*
+   * The attributes are packed together with the loop-carried distance.
+   */
+  bool memory : 1;
+  bool must : 1;
+  bool isControl : 1;
+  bool isLoopCarried : 1;
+  bool isRemovable : 1;
+  DataDependenceType dataDepType : 2;
+  uint32_t loopCarriedDistance;
 
+  /*
+   * The remedies are shared between the copies of an edge and the edges that
+   * inherit them from their only sub-edge; they are copied on write.
+   */
   SetOfRemedies_ptr remeds;
+
+  template <class, class>
+  friend class DGEdgeBase;
 };
 
 /*
@@ -511,7 +641,7 @@ protected:
  */
 template <class T>
 DGNode<T> *DG<T>::addNode(T *theT, bool inclusion) {
-  auto node = new DGNode<T>(nodeIdCounter++, theT);
+  auto node = this->allocateNode(theT);
   allNodes.insert(node);
   auto &map = inclusion ? internalNodeMap : externalNodeMap;
   map[theT] = node;
@@ -527,23 +657,33 @@ DGNode<T> *DG<T>::fetchOrAddNode(T *theT, bool inclusion) {
 
 template <class T>
 DGNode<T> *DG<T>::fetchNode(T *theT) {
-  auto nodeI = internalNodeMap.find(theT);
-  return (nodeI != internalNodeMap.end()) ? nodeI->second
-                                          : externalNodeMap[theT];
+
+  /*
+   * The node is fetched without adding entries to the maps for the values
+   * that are not in the graph.
+   */
+  return const_cast<DGNode<T> *>(this->fetchConstNode(theT));
 }
 
 template <class T>
 const DGNode<T> *DG<T>::fetchConstNode(T *theT) const {
   auto nodeI = internalNodeMap.find(theT);
-  return (nodeI != internalNodeMap.end()) ? nodeI->second
-                                          : externalNodeMap.find(theT)->second;
+  if (nodeI != internalNodeMap.end()) {
+    return nodeI->second;
+  }
+  auto externalNodeI = externalNodeMap.find(theT);
+  if (externalNodeI != externalNodeMap.end()) {
+    return externalNodeI->second;
+  }
+
+  return nullptr;
 }
 
 template <class T>
 DGEdge<T> *DG<T>::addEdge(T *from, T *to) {
   auto fromNode = fetchNode(from);
   auto toNode = fetchNode(to);
-  auto edge = new DGEdge<T>(fromNode, toNode);
+  auto edge = this->allocateEdge(fromNode, toNode);
   allEdges.insert(edge);
   fromNode->addOutgoingEdge(edge);
   toNode->addIncomingEdge(edge);
@@ -551,8 +691,8 @@ DGEdge<T> *DG<T>::addEdge(T *from, T *to) {
 }
 
 template <class T>
-std::unordered_set<DGEdge<T> *> DG<T>::fetchEdges(DGNode<T> *From,
-                                                  DGNode<T> *To) {
+std::unordered_set<DGEdge<T> *> DG<T>::fetchEdges(const DGNode<T> *From,
+                                                  const DGNode<T> *To) const {
   std::unordered_set<DGEdge<T> *> edgeSet;
 
   for (auto &edge : From->getOutgoingEdges()) {
@@ -566,7 +706,7 @@ std::unordered_set<DGEdge<T> *> DG<T>::fetchEdges(DGNode<T> *From,
 
 template <class T>
 DGEdge<T> *DG<T>::copyAddEdge(DGEdge<T> &edgeToCopy) {
-  auto edge = new DGEdge<T>(edgeToCopy);
+  auto edge = this->allocateEdge(edgeToCopy);
   allEdges.insert(edge);
 
   /*
@@ -583,7 +723,8 @@ DGEdge<T> *DG<T>::copyAddEdge(DGEdge<T> &edgeToCopy) {
 }
 
 template <class T>
-std::unordered_set<DGNode<T> *> DG<T>::getTopLevelNodes(bool onlyInternal) {
+std::unordered_set<DGNode<T> *> DG<T>::getTopLevelNodes(
+    bool onlyInternal) const {
   std::unordered_set<DGNode<T> *> topLevelNodes;
 
   /*
@@ -609,7 +750,7 @@ std::unordered_set<DGNode<T> *> DG<T>::getTopLevelNodes(bool onlyInternal) {
 }
 
 template <class T>
-std::unordered_set<DGNode<T> *> DG<T>::getLeafNodes(bool onlyInternal) {
+std::unordered_set<DGNode<T> *> DG<T>::getLeafNodes(bool onlyInternal) const {
   std::unordered_set<DGNode<T> *> leafNodes;
   if (onlyInternal) {
     for (auto selfNode : allNodes) {
@@ -754,10 +895,10 @@ void DG<T>::removeNode(DGNode<T> *node) {
     edge->getIncomingNode()->removeConnectedNode(node);
   for (auto edge : allToAndFromNode) {
     allEdges.erase(edge);
-    delete edge;
+    this->deallocateEdge(edge);
   }
 
-  delete node;
+  this->deallocateNode(node);
 }
 
 template <class T>
@@ -765,7 +906,7 @@ void DG<T>::removeEdge(DGEdge<T> *edge) {
   edge->getOutgoingNode()->removeConnectedEdge(edge);
   edge->getIncomingNode()->removeConnectedEdge(edge);
   allEdges.erase(edge);
-  delete edge;
+  this->deallocateEdge(edge);
 }
 
 template <class T>
@@ -802,6 +943,63 @@ void DG<T>::clear() {
   externalNodeMap.clear();
 }
 
+template <class T>
+void DG<T>::enableArenaAllocation(void) {
+  assert(allNodes.empty() && allEdges.empty());
+  if (this->arena == nullptr) {
+    this->arena = std::make_shared<BumpPtrAllocator>();
+  }
+}
+
+template <class T>
+DGNode<T> *DG<T>::allocateNode(T *theT) {
+  if (this->arena == nullptr) {
+    return new DGNode<T>(nodeIdCounter++, theT);
+  }
+  auto memory = this->arena->Allocate<DGNode<T>>();
+  return new (memory) DGNode<T>(nodeIdCounter++, theT);
+}
+
+template <class T>
+DGEdge<T> *DG<T>::allocateEdge(DGNode<T> *from, DGNode<T> *to) {
+  if (this->arena == nullptr) {
+    return new DGEdge<T>(from, to);
+  }
+  auto memory = this->arena->Allocate<DGEdge<T>>();
+  return new (memory) DGEdge<T>(from, to);
+}
+
+template <class T>
+DGEdge<T> *DG<T>::allocateEdge(DGEdge<T> &edgeToCopy) {
+  if (this->arena == nullptr) {
+    return new DGEdge<T>(edgeToCopy);
+  }
+  auto memory = this->arena->Allocate<DGEdge<T>>();
+  return new (memory) DGEdge<T>(edgeToCopy);
+}
+
+template <class T>
+void DG<T>::deallocateNode(DGNode<T> *node) {
+  if (this->arena == nullptr) {
+    delete node;
+    return;
+  }
+
+  /*
+   * The memory of the node is released with the arena.
+   */
+  node->~DGNode<T>();
+}
+
+template <class T>
+void DG<T>::deallocateEdge(DGEdge<T> *edge) {
+  if (this->arena == nullptr) {
+    delete edge;
+    return;
+  }
+  edge->~DGEdge<T>();
+}
+
 template <class T>
 raw_ostream &DG<T>::print(raw_ostream &stream) {
   stream << "Total node count: " << allNodes.size() << "\n";
@@ -898,15 +1096,17 @@ DGEdgeBase<T, SubT>::DGEdgeBase(const DGEdgeBase<T, SubT> &oldEdge) {
   auto nodePair = oldEdge.getNodePair();
   from = nodePair.first;
   to = nodePair.second;
+  loopCarriedDistance = 0;
   setMemMustType(oldEdge.isMemoryDependence(),
                  oldEdge.isMustDependence(),
                  oldEdge.dataDependenceType());
   setControl(oldEdge.isControlDependence());
   setLoopCarried(oldEdge.isLoopCarriedDependence());
   setRemovable(oldEdge.isRemovableDependence());
-  setRemedies(oldEdge.getRemedies());
-  for (auto subEdge : oldEdge.subEdges)
+  remeds = oldEdge.remeds;
+  for (auto subEdge : oldEdge.fetchSubEdges())
     addSubEdge(subEdge);
+  setLoopCarriedDistance(oldEdge.getLoopCarriedDistance());
 }
 
 template <class T, class SubT>
@@ -932,10 +1132,10 @@ std::string DGEdgeBase<T, SubT>::dataDepToString() {
 
 template <class T, class SubT>
 std::string DGEdgeBase<T, SubT>::toString() {
-  if (this->subEdges.size() > 0) {
+  if (this->numberOfSubEdges() > 0) {
     std::string edgesStr;
     raw_string_ostream ros(edgesStr);
-    for (auto edge : this->subEdges)
+    for (auto edge : this->fetchSubEdges())
       ros << edge->toString();
     return ros.str();
   }
@@ -944,6 +1144,9 @@ std::string DGEdgeBase<T, SubT>::toString() {
   ros << "Attributes: ";
   if (this->isLoopCarried) {
     ros << "Loop-carried ";
+    if (this->loopCarriedDistance > 0) {
+      ros << "(distance " << this->loopCarriedDistance << ") ";
+    }
   }
   if (this->isControlDependence()) {
     ros << "Control ";
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDG.hpp"
+#include "noelle/core/SCCDAG.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Exporter of dependence graphs that writes their nodes and edges to a file
+ * while it visits them, rather than building the whole graph in memory like
+ * DGPrinter does.
+ *
+ * Graphs are written either as a single DOT file, where each graph is a
+ * cluster, or as JSON lines, where each line is a node or an edge of a graph.
+ * Only the dependences selected by the filter are written, together with the
+ * nodes they connect.
+ */
+class DGExporter {
+public:
+  enum class Format { DOT, JSON };
+
+  /*
+   * Dependences to export.
+   */
+  struct Filter {
+    bool variableDependences = true;
+    bool memoryDependences = true;
+    bool controlDependences = true;
+    bool onlyLoopCarried = false;
+
+    bool isSelected(DGEdge<Value> *edge) const;
+
+    bool selectsAllDependences(void) const;
+  };
+
+  /*
+   * Set the kinds of the dependences of @filter from the comma separated list
+   * @kinds of "variable", "memory", and "control".
+   *
+   * @return false if a kind does not exist.
+   */
+  static bool parseDependenceKinds(const std::string &kinds, Filter &filter);
+
+  /*
+   * Set @format from @name, which is either "dot" or "json".
+   *
+   * @return false if the format does not exist.
+   */
+  static bool parseFormat(const std::string &name, Format &format);
+
+  DGExporter(const std::string &fileName, Format format, const Filter &filter);
+
+  DGExporter(const DGExporter &) = delete;
+
+  DGExporter &operator=(const DGExporter &) = delete;
+
+  bool isOpen(void) const;
+
+  /*
+   * Write the nodes and the selected dependences of @graph, which is named
+   * @name in the file.
+   */
+  void exportGraph(const std::string &name, PDG *graph);
+
+  /*
+   * Write @sccdag with a node per SCC.
+   * Two SCCs are connected if a selected dependence connects their
+   * instructions.
+   */
+  void exportSCCDAG(const std::string &name, SCCDAG *sccdag);
+
+  ~DGExporter();
+
+private:
+  std::unique_ptr<raw_fd_ostream> file;
+  Format format;
+  Filter filter;
+  std::string graphName;
+  uint64_t numberOfGraphs;
+
+  void beginGraph(const std::string &name);
+
+  void endGraph(void);
+
+  void writeNode(uint64_t node, const std::string &label, bool isExternal);
+
+  void writeEdge(uint64_t from,
+                 uint64_t to,
+                 const std::string &kind,
+                 DataDependenceType dataType,
+                 bool isMust,
+                 bool isLoopCarried,
+                 bool isExternal,
+                 uint64_t dependences);
+
+  static std::string getLabel(Value *value);
+};
+
+} // namespace llvm::noelle
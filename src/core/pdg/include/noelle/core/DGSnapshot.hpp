@@ -0,0 +1,418 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/DGBase.hpp"
+#include "llvm/ADT/Sequence.h"
+
+namespace llvm::noelle {
+
+/*
+ * Immutable snapshot of a dependence graph.
+ *
+ * Nodes are identified by dense indices and edges are stored in compressed
+ * sparse row form: the outgoing edges of a node are contiguous (sorted by
+ * their destination), and so are the indices of its incoming edges.
+ * The attributes of an edge are packed in a single byte.
+ *
+ * A snapshot can be a filtered view of its graph: it can include only the
+ * nodes and the edges that satisfy given predicates. Edges are referenced,
+ * not copied, so filtering a graph does not duplicate it.
+ *
+ * The snapshot is not updated when the graph it has been taken from changes.
+ */
+template <class T>
+class DGSnapshot {
+public:
+  typedef decltype(llvm::seq<uint32_t>(0, 0)) edge_range;
+  typedef iterator_range<const uint32_t *> index_range;
+  typedef std::function<bool(DGNode<T> *)> NodeFilter;
+  typedef std::function<bool(DGEdge<T> *)> EdgeFilter;
+
+  /*
+   * Take a snapshot of @graph.
+   */
+  DGSnapshot(DG<T> &graph);
+
+  /*
+   * Take a snapshot of the part of @graph that includes the nodes for which
+   * @includeNode returns true, and the edges between them for which
+   * @includeEdge returns true.
+   * A filter set to nullptr includes everything.
+   */
+  DGSnapshot(DG<T> &graph, NodeFilter includeNode, EdgeFilter includeEdge);
+
+  /*
+   * Filters of the common views of a graph.
+   */
+  static bool isMemoryEdge(DGEdge<T> *edge) {
+    return edge->isMemoryDependence();
+  }
+  static bool isControlEdge(DGEdge<T> *edge) {
+    return edge->isControlDependence();
+  }
+  static bool isNotMemoryEdge(DGEdge<T> *edge) {
+    return !edge->isMemoryDependence();
+  }
+  static bool isNotLoopCarriedEdge(DGEdge<T> *edge) {
+    return !edge->isLoopCarriedDependence();
+  }
+
+  /*
+   * Return the number of nodes and edges of the snapshot.
+   */
+  uint32_t numNodes(void) const {
+    return this->nodes.size();
+  }
+  uint32_t numEdges(void) const {
+    return this->edges.size();
+  }
+
+  /*
+   * Return true if @theT is a node of the snapshot.
+   */
+  bool isInGraph(T *theT) const {
+    return this->nodeIndices.find(theT) != this->nodeIndices.end();
+  }
+
+  /*
+   * Return the index of the node of @theT, which must be in the snapshot.
+   */
+  uint32_t getNodeIndex(T *theT) const;
+
+  /*
+   * Return the node with index @node.
+   */
+  DGNode<T> *getNode(uint32_t node) const {
+    return this->nodes[node];
+  }
+  T *getT(uint32_t node) const {
+    return this->nodes[node]->getT();
+  }
+  bool isInternal(uint32_t node) const {
+    return this->internalNodes[node];
+  }
+
+  /*
+   * Return the indices of the outgoing and incoming edges of @node.
+   */
+  edge_range getOutgoingEdges(uint32_t node) const {
+    return llvm::seq<uint32_t>(this->outgoingOffsets[node],
+                               this->outgoingOffsets[node + 1]);
+  }
+  index_range getIncomingEdges(uint32_t node) const {
+    return this->rangeOf(this->incomingEdges, this->incomingOffsets, node);
+  }
+
+  /*
+   * Return the nodes that depend on @node and the nodes @node depends on.
+   */
+  index_range getSuccessors(uint32_t node) const {
+    return this->rangeOf(this->edgeTo, this->outgoingOffsets, node);
+  }
+  index_range getPredecessors(uint32_t node) const {
+    return this->rangeOf(this->predecessors, this->incomingOffsets, node);
+  }
+
+  /*
+   * Return the indices of the edges from @from to @to.
+   */
+  edge_range fetchEdges(uint32_t from, uint32_t to) const;
+
+  /*
+   * Return the attributes of the edge with index @edge.
+   */
+  DGEdge<T> *getEdge(uint32_t edge) const {
+    return this->edges[edge];
+  }
+  uint32_t getOutgoingNode(uint32_t edge) const {
+    return this->edgeFrom[edge];
+  }
+  uint32_t getIncomingNode(uint32_t edge) const {
+    return this->edgeTo[edge];
+  }
+  bool isMemoryDependence(uint32_t edge) const {
+    return this->hasAttribute(edge, MEMORY);
+  }
+  bool isMustDependence(uint32_t edge) const {
+    return this->hasAttribute(edge, MUST);
+  }
+  bool isControlDependence(uint32_t edge) const {
+    return this->hasAttribute(edge, CONTROL);
+  }
+  bool isDataDependence(uint32_t edge) const {
+    return !this->hasAttribute(edge, CONTROL);
+  }
+  bool isLoopCarriedDependence(uint32_t edge) const {
+    return this->hasAttribute(edge, LOOP_CARRIED);
+  }
+  bool isRemovableDependence(uint32_t edge) const {
+    return this->hasAttribute(edge, REMOVABLE);
+  }
+  DataDependenceType dataDependenceType(uint32_t edge) const {
+    return static_cast<DataDependenceType>(this->attributes[edge]
+                                           >> DATA_TYPE_SHIFT);
+  }
+
+  /*
+   * Compute the strongly connected components of the snapshot (Tarjan's
+   * algorithm).
+   * Components are returned in reverse topological order: a component is
+   * returned before the components that it depends on.
+   */
+  std::vector<std::vector<uint32_t>> getStronglyConnectedComponents(
+      void) const;
+
+private:
+  enum EdgeAttribute : uint8_t {
+    MEMORY = 1,
+    MUST = 2,
+    CONTROL = 4,
+    LOOP_CARRIED = 8,
+    REMOVABLE = 16,
+    DATA_TYPE_SHIFT = 5
+  };
+
+  std::vector<DGNode<T> *> nodes;
+  std::vector<bool> internalNodes;
+  std::unordered_map<T *, uint32_t> nodeIndices;
+
+  std::vector<uint32_t> outgoingOffsets;
+  std::vector<uint32_t> edgeFrom;
+  std::vector<uint32_t> edgeTo;
+  std::vector<uint8_t> attributes;
+  std::vector<DGEdge<T> *> edges;
+
+  std::vector<uint32_t> incomingOffsets;
+  std::vector<uint32_t> incomingEdges;
+  std::vector<uint32_t> predecessors;
+
+  bool hasAttribute(uint32_t edge, EdgeAttribute attribute) const {
+    return (this->attributes[edge] & attribute) != 0;
+  }
+
+  index_range rangeOf(const std::vector<uint32_t> &elements,
+                      const std::vector<uint32_t> &offsets,
+                      uint32_t node) const {
+    auto first = elements.data();
+    return make_range(first + offsets[node], first + offsets[node + 1]);
+  }
+};
+
+/*
+ * DGSnapshot<T> class method implementations
+ */
+template <class T>
+DGSnapshot<T>::DGSnapshot(DG<T> &graph)
+  : DGSnapshot(graph, nullptr, nullptr) {
+  return;
+}
+
+template <class T>
+DGSnapshot<T>::DGSnapshot(DG<T> &graph,
+                          NodeFilter includeNode,
+                          EdgeFilter includeEdge) {
+
+  /*
+   * Number the nodes.
+   */
+  for (auto node : graph.getNodes()) {
+    if ((includeNode != nullptr) && !includeNode(node)) {
+      continue;
+    }
+    auto theT = node->getT();
+    this->nodeIndices[theT] = this->nodes.size();
+    this->nodes.push_back(node);
+    this->internalNodes.push_back(graph.isInternal(theT));
+  }
+  auto totalNodes = this->nodes.size();
+
+  /*
+   * Collect the edges sorted by source and destination.
+   */
+  std::vector<std::tuple<uint32_t, uint32_t, DGEdge<T> *>> sortedEdges;
+  sortedEdges.reserve(graph.numEdges());
+  for (auto edge : graph.getEdges()) {
+    if (false || !this->isInGraph(edge->getOutgoingT())
+        || !this->isInGraph(edge->getIncomingT())
+        || ((includeEdge != nullptr) && !includeEdge(edge))) {
+      continue;
+    }
+    auto from = this->getNodeIndex(edge->getOutgoingT());
+    auto to = this->getNodeIndex(edge->getIncomingT());
+    sortedEdges.push_back(std::make_tuple(from, to, edge));
+  }
+  std::stable_sort(sortedEdges.begin(),
+                   sortedEdges.end(),
+                   [](const std::tuple<uint32_t, uint32_t, DGEdge<T> *> &e1,
+                      const std::tuple<uint32_t, uint32_t, DGEdge<T> *> &e2)
+                       -> bool {
+                     return std::make_pair(std::get<0>(e1), std::get<1>(e1))
+                            < std::make_pair(std::get<0>(e2), std::get<1>(e2));
+                   });
+
+  /*
+   * Store the edges and their attributes.
+   */
+  auto totalEdges = sortedEdges.size();
+  this->outgoingOffsets.assign(totalNodes + 1, 0);
+  this->incomingOffsets.assign(totalNodes + 1, 0);
+  this->edgeFrom.reserve(totalEdges);
+  this->edgeTo.reserve(totalEdges);
+  this->attributes.reserve(totalEdges);
+  this->edges.reserve(totalEdges);
+  for (auto &sortedEdge : sortedEdges) {
+    auto from = std::get<0>(sortedEdge);
+    auto to = std::get<1>(sortedEdge);
+    auto edge = std::get<2>(sortedEdge);
+    uint8_t bits = 0;
+    bits |= edge->isMemoryDependence() ? MEMORY : 0;
+    bits |= edge->isMustDependence() ? MUST : 0;
+    bits |= edge->isControlDependence() ? CONTROL : 0;
+    bits |= edge->isLoopCarriedDependence() ? LOOP_CARRIED : 0;
+    bits |= edge->isRemovableDependence() ? REMOVABLE : 0;
+    bits |= static_cast<uint8_t>(edge->dataDependenceType()) << DATA_TYPE_SHIFT;
+    this->edgeFrom.push_back(from);
+    this->edgeTo.push_back(to);
+    this->attributes.push_back(bits);
+    this->edges.push_back(edge);
+    this->outgoingOffsets[from + 1]++;
+    this->incomingOffsets[to + 1]++;
+  }
+  for (auto i = 0u; i < totalNodes; i++) {
+    this->outgoingOffsets[i + 1] += this->outgoingOffsets[i];
+    this->incomingOffsets[i + 1] += this->incomingOffsets[i];
+  }
+
+  /*
+   * Group the incoming edges by destination.
+   */
+  this->incomingEdges.resize(totalEdges);
+  this->predecessors.resize(totalEdges);
+  std::vector<uint32_t> nextIncoming(this->incomingOffsets.begin(),
+                                     this->incomingOffsets.end() - 1);
+  for (auto edge = 0u; edge < totalEdges; edge++) {
+    auto position = nextIncoming[this->edgeTo[edge]]++;
+    this->incomingEdges[position] = edge;
+    this->predecessors[position] = this->edgeFrom[edge];
+  }
+
+  return;
+}
+
+template <class T>
+uint32_t DGSnapshot<T>::getNodeIndex(T *theT) const {
+  auto nodeI = this->nodeIndices.find(theT);
+  assert(nodeI != this->nodeIndices.end());
+  return nodeI->second;
+}
+
+template <class T>
+typename DGSnapshot<T>::edge_range DGSnapshot<T>::fetchEdges(
+    uint32_t from,
+    uint32_t to) const {
+  auto first = this->edgeTo.begin() + this->outgoingOffsets[from];
+  auto last = this->edgeTo.begin() + this->outgoingOffsets[from + 1];
+  auto range = std::equal_range(first, last, to);
+  uint32_t begin = range.first - this->edgeTo.begin();
+  uint32_t end = range.second - this->edgeTo.begin();
+  return llvm::seq<uint32_t>(begin, end);
+}
+
+template <class T>
+std::vector<std::vector<uint32_t>> DGSnapshot<T>::
+    getStronglyConnectedComponents(void) const {
+  std::vector<std::vector<uint32_t>> components;
+
+  /*
+   * Run Tarjan's algorithm without recursion to support large graphs.
+   * Each frame of the DFS stack holds a node and the position of the next
+   * successor to visit.
+   */
+  auto totalNodes = this->numNodes();
+  auto unvisited = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> dfsIndex(totalNodes, unvisited);
+  std::vector<uint32_t> lowLink(totalNodes, 0);
+  std::vector<bool> isOnStack(totalNodes, false);
+  std::vector<uint32_t> stack;
+  std::vector<std::pair<uint32_t, uint32_t>> dfsStack;
+  uint32_t nextIndex = 0;
+  auto visit = [&](uint32_t node) {
+    dfsIndex[node] = nextIndex;
+    lowLink[node] = nextIndex;
+    nextIndex++;
+    stack.push_back(node);
+    isOnStack[node] = true;
+    dfsStack.push_back(std::make_pair(node, this->outgoingOffsets[node]));
+  };
+  for (auto root = 0u; root < totalNodes; root++) {
+    if (dfsIndex[root] != unvisited) {
+      continue;
+    }
+    visit(root);
+    while (!dfsStack.empty()) {
+      auto node = dfsStack.back().first;
+      auto &position = dfsStack.back().second;
+
+      /*
+       * Visit the next successor of the current node.
+       */
+      if (position < this->outgoingOffsets[node + 1]) {
+        auto successor = this->edgeTo[position];
+        position++;
+        if (dfsIndex[successor] == unvisited) {
+          visit(successor);
+        } else if (isOnStack[successor]) {
+          lowLink[node] = std::min(lowLink[node], dfsIndex[successor]);
+        }
+        continue;
+      }
+
+      /*
+       * All successors have been visited.
+       * Check if the current node is the root of a component.
+       */
+      dfsStack.pop_back();
+      if (!dfsStack.empty()) {
+        auto parent = dfsStack.back().first;
+        lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+      }
+      if (lowLink[node] != dfsIndex[node]) {
+        continue;
+      }
+      std::vector<uint32_t> component;
+      uint32_t member;
+      do {
+        member = stack.back();
+        stack.pop_back();
+        isOnStack[member] = false;
+        component.push_back(member);
+      } while (member != node);
+      components.push_back(std::move(component));
+    }
+  }
+
+  return components;
+}
+
+} // namespace llvm::noelle
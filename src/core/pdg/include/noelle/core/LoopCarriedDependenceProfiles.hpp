@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/DGBase.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * How often the memory dependences of loops manifest at run time.
+ *
+ * The profiles are embedded by the dependence profiler (see
+ * noelle-prof-dependences). For each profiled dependence from @from to @to
+ * that is carried by a loop (the outermost one if several loops carry it),
+ * they count how many times @to executed within that loop (checks) and how many of these times @to accessed memory that
+ * @from accessed in a previous iteration of the same invocation of the loop
+ * (manifestations). Only the last access of @from is tracked, so the
+ * manifestations of dependences with a distance greater than one iteration
+ * can be underestimated.
+ *
+ * The source of a dependence is tagged by LoopCarriedDependenceProfiles::
+ * sourceMetadataName, and its destination lists its profiles with
+ * LoopCarriedDependenceProfiles::metadataName.
+ */
+class LoopCarriedDependenceProfiles {
+public:
+  static constexpr const char *sourceMetadataName =
+      "noelle.dependence_profile.source";
+
+  static constexpr const char *metadataName = "noelle.dependence_profile";
+
+  LoopCarriedDependenceProfiles(Module &M);
+
+  LoopCarriedDependenceProfiles() = delete;
+
+  /*
+   * Check if the module includes profiles of dependences.
+   */
+  bool isAvailable(void) const;
+
+  /*
+   * Check if the dependence from @from to @to has been profiled.
+   */
+  bool isProfiled(Value *from, Value *to) const;
+
+  bool isProfiled(DGEdge<Value> *dependence) const;
+
+  uint64_t getChecks(Value *from, Value *to) const;
+
+  uint64_t getManifestations(Value *from, Value *to) const;
+
+  /*
+   * Return the fraction of the checks where the dependence manifested.
+   *
+   * @return Between 0 and 1 (0 if the dependence has not been profiled or if
+   * its destination never executed).
+   */
+  double getManifestationFrequency(Value *from, Value *to) const;
+
+  double getManifestationFrequency(DGEdge<Value> *dependence) const;
+
+private:
+  std::map<std::pair<Value *, Value *>, std::pair<uint64_t, uint64_t>>
+      profiles;
+};
+
+} // namespace llvm::noelle
@@ -28,6 +28,9 @@ namespace llvm::noelle {
 
 /*
  * Program Dependence Graph.
+ *
+ * The queries of the graph are const (see DG), so a const PDG is a reader
+ * handle that multiple threads can query at the same time without locks.
  */
 class PDG : public DG<Value> {
 public:
@@ -75,7 +78,8 @@ public:
   /*
    * Fetch dependences between two values/instructions.
    */
-  std::unordered_set<DGEdge<Value> *> getDependences(Value *v1, Value *v2);
+  std::unordered_set<DGEdge<Value> *> getDependences(Value *v1,
+                                                    Value *v2) const;
 
   /*
    * Iterator: iterate over the instructions that depend on @param fromValue
@@ -95,7 +99,7 @@ public:
       bool includeMemoryDataDependences,
       bool includeRegisterDataDependences,
       std::function<bool(Value *to, DGEdge<Value> *dependence)>
-          functionToInvokePerDependence);
+          functionToInvokePerDependence) const;
 
   /*
    * Iterator: iterate over the instructions that @param toValue depends from
@@ -115,7 +119,7 @@ public:
       bool includeMemoryDataDependences,
       bool includeRegisterDataDependences,
       std::function<bool(Value *fromValue, DGEdge<Value> *dependence)>
-          functionToInvokePerDependence);
+          functionToInvokePerDependence) const;
 
   /*
    * Add the edge from "from" to "to" to the PDG.
@@ -135,9 +139,9 @@ public:
       bool linkToExternal,
       std::unordered_set<DGEdge<Value> *> edgesToIgnore);
 
-  std::vector<Value *> getSortedValues(void);
+  std::vector<Value *> getSortedValues(void) const;
 
-  std::vector<DGEdge<Value> *> getSortedDependences(void);
+  std::vector<DGEdge<Value> *> getSortedDependences(void) const;
 
   /*
    * Destructor
@@ -21,6 +21,8 @@
  */
 #pragma once
 
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/TalkDown.hpp"
 #include "noelle/core/AllocAA.hpp"
@@ -28,10 +30,27 @@
 #include "noelle/core/DataFlow.hpp"
 #include "noelle/core/PDG.hpp"
 #include "noelle/core/CallGraph.hpp"
+#include "noelle/core/ControlDependenceSummary.hpp"
+#include "noelle/core/LoopCarriedDependenceProfiles.hpp"
 
 namespace llvm::noelle {
 enum class PDGVerbosity { Disabled, Minimal, Maximal, MaximalAndPDG };
 
+/*
+ * Precision of the memory dependences of the PDG, from the cheapest to the
+ * most precise one.
+ * Each tier adds analyses to the one before it:
+ *   LLVMAliasAnalyses: only the alias analyses of LLVM
+ *   SVF: plus the whole-program pointer analysis of SVF
+ *   Full: plus our custom alias analysis and the loop-aware dependence
+ *         analyses (e.g., SCAF and LIDS) used to refine the loop DGs
+ */
+enum class PDGPrecision { LLVMAliasAnalyses, SVF, Full };
+
+class PDGCache;
+class PDGBinaryFormat;
+class PDGAnalysisNPM;
+
 class PDGAnalysis : public ModulePass {
 public:
   static char ID;
@@ -48,20 +67,130 @@ public:
 
   bool runOnModule(Module &M) override;
 
+  /*
+   * Return the dependence graph of @F, which is owned by the PDGAnalysis.
+   * If a memory budget is set (see -noelle-pdg-memory-budget), the graph is
+   * valid only until the dependence graph of another function is requested:
+   * the least recently used graphs are evicted to stay within the budget, and
+   * they are rebuilt when requested again.
+   */
   PDG *getFunctionPDG(Function &F);
 
+  /*
+   * Statistics of the cache of the function dependence graphs.
+   * Misses include the rebuilds of the graphs evicted before.
+   */
+  uint64_t getNumberOfFunctionDGCacheHits(void) const;
+
+  uint64_t getNumberOfFunctionDGCacheMisses(void) const;
+
+  uint64_t getNumberOfFunctionDGRebuilds(void) const;
+
+  uint64_t getNumberOfFunctionDGEvictions(void) const;
+
   PDG *getPDG(void);
 
   noelle::CallGraph *getProgramCallGraph(void);
 
+  /*
+   * Return the profiles of the loop-carried memory dependences embedded in
+   * the module (see LoopCarriedDependenceProfiles::isAvailable).
+   */
+  LoopCarriedDependenceProfiles *getLoopCarriedDependenceProfiles(void);
+
+  /*
+   * Remove @instructions from the PDG and from the function DGs computed so
+   * far.
+   * This must be invoked before the instructions are erased from the IR.
+   */
+  void removeInstructions(std::unordered_set<Instruction *> &instructions);
+
+  /*
+   * Update the PDG and the DG of @F after a transformation added the
+   * instructions @changedInstructions to @F or moved them within @F.
+   * The variable dependences of these instructions, the control dependences
+   * of @F, and (if needed) the memory dependences of @F are recomputed.
+   */
+  void updateFunction(Function &F,
+                      std::unordered_set<Instruction *> &changedInstructions);
+
+  /*
+   * Recompute the dependences of @F after a transformation changed it
+   * arbitrarily (e.g., by erasing instructions or basic blocks).
+   * The nodes of the erased instructions are removed from the PDG, and the
+   * dependences of the instructions of @F are recomputed.
+   * The dependences of the other functions are left untouched, so @F must be
+   * the only function changed since the PDG has been computed (or refreshed).
+   */
+  void refreshFunction(Function &F);
+
+  /*
+   * The answers of the alias and mod/ref queries are cached module-wide and
+   * shared by every dependence graph computed.
+   * The cache is invalidated when instructions are removed.
+   */
+  static uint64_t getNumberOfAliasQueryCacheHits(void);
+
+  static uint64_t getNumberOfAliasQueryCacheMisses(void);
+
+  static void invalidateAliasQueryCache(void);
+
+  /*
+   * Return the precision tier of the PDG requested by the user.
+   * Options that disable single analyses (e.g., -noelle-disable-pdg-svf) are
+   * applied on top of it.
+   */
+  static PDGPrecision getPrecision(void);
+
+  static std::string getPrecisionName(PDGPrecision precision);
+
+  /*
+   * Check if the memory dependences of @F are coarse because computing them
+   * precisely exceeded the budget of a function (see
+   * -noelle-pdg-function-budget-queries and -noelle-pdg-function-budget-ms).
+   * This is known only after the PDG has been computed or loaded from the IR.
+   */
+  bool hasCoarseMemoryDependences(Function &F) const;
+
   static bool isTheLibraryFunctionPure(Function *libraryFunction);
 
   static bool isTheLibraryFunctionThreadSafe(Function *libraryFunction);
 
+  /*
+   * Check if the invocations of @libraryFunction can run in any order.
+   * Only the functions described by -noelle-library-spec files can be.
+   */
+  static bool isTheLibraryFunctionCommutative(Function *libraryFunction);
+
+  /*
+   * Check if @libraryFunction only writes its arguments to a FILE stream
+   * (e.g., printf), so its output can be buffered by the runtime and written
+   * later in the same order.
+   */
+  static bool isTheLibraryFunctionAStreamWriter(Function *libraryFunction);
+
 private:
   Module *M;
   PDG *programDependenceGraph;
   std::unordered_map<Function *, PDG *> functionToFDGMap;
+
+  /*
+   * Cache of the function dependence graphs.
+   * The most recently used graphs are at the front of @functionDGsLRU.
+   * The sizes of the graphs are estimated when they are cached.
+   */
+  uint64_t memoryBudget;
+  uint64_t functionDGsBytes;
+  uint64_t functionDGsPeakBytes;
+  std::list<Function *> functionDGsLRU;
+  std::unordered_map<Function *, std::list<Function *>::iterator>
+      functionDGsLRUPositions;
+  std::unordered_map<Function *, uint64_t> functionDGBytes;
+  std::unordered_set<Function *> evictedFunctionDGs;
+  uint64_t functionDGCacheHits;
+  uint64_t functionDGCacheMisses;
+  uint64_t functionDGRebuilds;
+  uint64_t functionDGEvictions;
   AllocAA *allocAA;
   std::set<Function *> CGUnderMain;
   TalkDown *talkdown;
@@ -73,8 +202,64 @@ private:
   bool disableSVF;
   bool disableAllocAA;
   bool disableRA;
+  bool analyzeOnlyHotCode;
+  double minimumHotness;
+  uint32_t numberOfThreads;
+  std::string cacheFileName;
+  PDGCache *cache;
+  PDGBinaryFormat *embeddedPDG;
   PDGPrinter printer;
   noelle::CallGraph *noelleCG;
+  LoopCarriedDependenceProfiles *dependenceProfiles;
+
+  /*
+   * Order of the basic blocks of the functions within an iteration of their
+   * loops (see canPrecedeInCurrentIteration).
+   * For each header of a loop (nullptr for the code outside loops) and each
+   * destination block, @reachingBlocks has the blocks that reach the
+   * destination without going through the header; the ones of the header are
+   * indexed by @blockIDs.
+   * This is only kept while the PDG is being refined.
+   */
+  struct IntraIterationOrder {
+    std::unordered_map<BasicBlock *, uint32_t> blockIDs;
+    std::unordered_map<BasicBlock *, BasicBlock *> headers;
+    std::map<std::pair<BasicBlock *, BasicBlock *>, BitVector> reachingBlocks;
+  };
+  std::unordered_map<Function *, IntraIterationOrder> intraIterationOrders;
+
+  /*
+   * Analyses of LLVM the dependences are computed from.
+   * They are fetched from the legacy pass manager unless PDGAnalysisNPM set
+   * these providers to fetch them from the analysis managers of the new pass
+   * manager.
+   */
+  std::function<LoopInfo &(Function &F)> loopInfoProvider;
+  std::function<AAResults &(Function &F)> aliasAnalysisProvider;
+  std::function<BlockFrequencyInfo &(Function &F)> blockFrequencyProvider;
+  std::function<llvm::CallGraph &(void)> callGraphProvider;
+
+  LoopInfo &getLoopInfo(Function &F);
+  AAResults &getAAResults(Function &F);
+  BlockFrequencyInfo &getBlockFrequencyInfo(Function &F);
+  llvm::CallGraph &getLLVMCallGraph(void);
+
+  friend class PDGAnalysisNPM;
+
+  /*
+   * Summary of the memory that a function may read or write.
+   * Global variables are tracked individually. Any other memory that is not
+   * local to the invocation of the function is represented by one abstract
+   * object.
+   */
+  struct ModRefSummary {
+    std::unordered_set<const GlobalVariable *> readGlobals;
+    std::unordered_set<const GlobalVariable *> writtenGlobals;
+    bool mayReadOtherMemory = false;
+    bool mayWriteOtherMemory = false;
+  };
+  std::unordered_map<const Function *, ModRefSummary> modRefSummaries;
+  bool modRefSummariesComputed;
 
   std::unordered_set<const Function *> internalFuncs;
   std::unordered_set<const Function *> unhandledExternalFuncs;
@@ -90,6 +275,60 @@ private:
   bool cannotReachUnhandledExternalFunction(CallBase *call);
   bool hasNoMemoryOperations(CallBase *call);
 
+  /*
+   * Functions whose memory dependences are computed precisely when only the
+   * hot code is analyzed precisely (see -noelle-pdg-min-hot).
+   * These are the functions that include a loop at least as hot as
+   * @minimumHotness, and the functions that such loops can invoke.
+   * The memory dependences of the other functions are computed conservatively
+   * without querying the alias analyses.
+   */
+  std::unordered_set<Function *> hotFunctions;
+  bool hotFunctionsIdentified;
+
+  void cacheFunctionDG(Function &F, PDG *pdg);
+  void touchFunctionDG(Function &F);
+  void forgetFunctionDG(Function &F);
+  void forgetFunctionDGs(void);
+  void printFunctionDGCacheStatistics(void) const;
+  static uint64_t estimateBytesOf(PDG *pdg);
+
+  void identifyHotFunctions(Module &M);
+  bool isAnalyzedPrecisely(Function &F);
+  void constructConservativeMemoryEdgesForFunction(PDG *pdg,
+                                                   Function &F,
+                                                   DataFlowResult *dfr);
+
+  /*
+   * Budget to compute the memory dependences of a function precisely: the
+   * pairs of memory instructions that can reach each other (i.e., the alias
+   * queries) and the milliseconds spent (0: no limit).
+   * The memory dependences of the functions past the budget are coarse: they
+   * are the ones between the instructions that can access the same underlying
+   * object (see getCoarseMemoryObject).
+   * The functions with coarse dependences are kept in @coarseFunctions, and
+   * they are tagged when the PDG is embedded in the IR.
+   */
+  uint64_t functionQueryBudget;
+  uint64_t functionTimeBudget;
+  std::unordered_set<Function *> coarseFunctions;
+
+  uint64_t countAliasQueries(Function &F, DataFlowResult *dfr);
+  void removeMemoryEdgesOfFunction(PDG *pdg, Function &F);
+  void constructCoarseMemoryEdgesForFunction(PDG *pdg,
+                                             Function &F,
+                                             DataFlowResult *dfr);
+  Value *getCoarseMemoryObject(Instruction *I, bool &isPrimitiveArray);
+
+  void computeModRefSummaries(Module &M);
+  void addToModRefSummary(ModRefSummary &summary,
+                          Instruction *I,
+                          Function *localFunction);
+  static bool canSummariesConflict(const ModRefSummary &writer,
+                                   const ModRefSummary &accessor);
+  bool canBeDependentBasedOnModRefSummaries(Instruction *i, Instruction *j);
+  void invalidateModRefSummaries(void);
+
   bool comparePDGs(PDG *pdg1, PDG *pdg2);
   bool compareNodes(PDG *pdg1, PDG *pdg2);
   bool compareEdges(PDG *pdg1, PDG *pdg2);
@@ -113,18 +352,7 @@ private:
                                            unordered_map<MDNode *, Value *> &);
 
   void embedPDGAsMetadata(PDG *);
-  void embedNodesAsMetadata(PDG *,
-                            LLVMContext &,
-                            unordered_map<Value *, MDNode *> &);
-  void embedEdgesAsMetadata(PDG *,
-                            LLVMContext &,
-                            unordered_map<Value *, MDNode *> &);
-  MDNode *getEdgeMetadata(DGEdge<Value> *,
-                          LLVMContext &,
-                          unordered_map<Value *, MDNode *> &);
-  MDNode *getSubEdgesMetadata(DGEdge<Value> *,
-                              LLVMContext &,
-                              unordered_map<Value *, MDNode *> &);
+  PDGBinaryFormat *fetchEmbeddedPDG(Module &M);
 
   void trimDGUsingCustomAliasAnalysis(PDG *pdg);
 
@@ -139,6 +367,20 @@ private:
   void constructEdgesFromControl(PDG *pdg, Module &M);
   void constructEdgesFromAliasesForFunction(PDG *pdg, Function &F);
   void constructEdgesFromControlForFunction(PDG *pdg, Function &F);
+  void constructEdgesFromAliasesForFunction(PDG *pdg,
+                                            Function &F,
+                                            DataFlowResult *dfr);
+  DataFlowResult *computeReachableMemoryInstructions(Function &F);
+  static std::vector<std::pair<Value *, Value *>> computeControlDependences(
+      Function &F,
+      const ControlDependenceSummary &summary);
+  static void addControlDependences(
+      PDG *pdg,
+      std::vector<std::pair<Value *, Value *>> &dependences);
+  void iterateOverFunctionsInParallel(
+      Module &M,
+      std::function<void(Function &F)> computeInParallel,
+      std::function<void(Function &F)> mergeInOrder);
 
   void iterateInstForStore(PDG *,
                            Function &,
@@ -182,6 +424,13 @@ private:
                                  CallBase *);
 
   void removeEdgesNotUsedByParSchemes(PDG *pdg);
+  void removeEdgesNotUsedByParSchemes(PDG *pdg, Function &F);
+  bool isEdgeNotUsedByParSchemes(DGEdge<Value> *edge);
+  void updateDG(PDG *pdg,
+                Function &F,
+                std::unordered_set<Instruction *> &changedInstructions,
+                bool updateMemoryDependences);
+  void invalidateEmbeddedPDG(void);
 
   AliasResult doTheyAlias(PDG *pdg,
                           Function &F,
@@ -197,6 +446,7 @@ private:
   bool isMemoryAccessIntoDifferentArrays(DGEdge<Value> *edge);
 
   bool canPrecedeInCurrentIteration(Instruction *from, Instruction *to);
+  IntraIterationOrder &getIntraIterationOrder(Function &F);
 
   bool edgeIsAlongNonMemoryWritingFunctions(DGEdge<Value> *edge);
 
@@ -205,6 +455,8 @@ private:
   static const StringSet<> externalFuncsHaveNoSideEffectOrHandledBySVF;
 
   static const StringSet<> externalThreadSafeFunctions;
+
+  static const StringSet<> externalStreamWriterFunctions;
 };
 
 } // namespace llvm::noelle
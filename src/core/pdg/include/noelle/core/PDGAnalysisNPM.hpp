@@ -0,0 +1,125 @@
+/*
+ * Copyright 2016 - 2020  Angelo Matni, Yian Su, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "llvm/IR/PassManager.h"
+
+#include "noelle/core/PDGAnalysis.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * The PDG for the new pass manager.
+ *
+ * The PDG of the program is computed once per module and it is cached by the
+ * module analysis manager, so every pass of an opt pipeline shares it until a
+ * pass that does not preserve it invalidates it.
+ * The analyses of LLVM it is computed from are fetched from the analysis
+ * managers of the new pass manager.
+ * AllocAA and TalkDown are legacy passes, so the custom alias analysis is not
+ * used to refine the PDG computed here (see PDGPrecision::SVF).
+ */
+class PDGAnalysisNPM : public AnalysisInfoMixin<PDGAnalysisNPM> {
+public:
+  class Result {
+  public:
+    Result(std::unique_ptr<PDGAnalysis> pdgAnalysis, Module &M);
+
+    Result(Result &&other) = default;
+
+    ~Result();
+
+    PDGAnalysis &getPDGAnalysis(void);
+
+    PDG *getPDG(void);
+
+    /*
+     * The PDG is kept only if the passes that ran after it was computed
+     * preserved it or all the analyses of the module.
+     */
+    bool invalidate(Module &M,
+                    const PreservedAnalyses &PA,
+                    ModuleAnalysisManager::Invalidator &Inv);
+
+  private:
+    std::unique_ptr<PDGAnalysis> pdgAnalysis;
+    Module *module;
+  };
+
+  Result run(Module &M, ModuleAnalysisManager &MAM);
+
+private:
+  friend AnalysisInfoMixin<PDGAnalysisNPM>;
+  static AnalysisKey Key;
+};
+
+/*
+ * The dependence graph of a function for the new pass manager.
+ *
+ * It is a view of the PDG of the module, which must have been computed
+ * before (e.g., by require<noelle-pdg>).
+ * Hence, it is invalidated together with the PDG of the module as well.
+ */
+class FunctionPDGAnalysisNPM
+  : public AnalysisInfoMixin<FunctionPDGAnalysisNPM> {
+public:
+  class Result {
+  public:
+    Result(PDGAnalysis &pdgAnalysis, Function &F);
+
+    /*
+     * The graph is fetched from the PDGAnalysis every time, so it is rebuilt
+     * if the cache of the function graphs evicted it (see
+     * PDGAnalysis::getFunctionPDG).
+     */
+    PDG *getFunctionPDG(void);
+
+    bool invalidate(Function &F,
+                    const PreservedAnalyses &PA,
+                    FunctionAnalysisManager::Invalidator &Inv);
+
+  private:
+    PDGAnalysis *pdgAnalysis;
+    Function *function;
+  };
+
+  Result run(Function &F, FunctionAnalysisManager &FAM);
+
+private:
+  friend AnalysisInfoMixin<FunctionPDGAnalysisNPM>;
+  static AnalysisKey Key;
+};
+
+/*
+ * Print the number of nodes and edges of the PDG (print<noelle-pdg>).
+ */
+class PDGPrinterPassNPM : public PassInfoMixin<PDGPrinterPassNPM> {
+public:
+  explicit PDGPrinterPassNPM(raw_ostream &OS);
+
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &MAM);
+
+private:
+  raw_ostream &OS;
+};
+
+} // namespace llvm::noelle
@@ -38,6 +38,13 @@ public:
   SCC(std::set<DGNode<Value> *> internalNodes,
       std::set<DGNode<Value> *> externalNodes);
 
+  /*
+   * Build the SCC of @internalNodes including only the dependences for which
+   * @includeEdge returns true.
+   */
+  SCC(std::set<DGNode<Value> *> internalNodes,
+      std::function<bool(DGEdge<Value> *)> includeEdge);
+
   /*
    * Iterate over values inside the SCC until @funcToInvoke returns true or no
    * other one exists.
@@ -94,7 +101,8 @@ public:
 
 private:
   void copyNodesAndEdges(std::set<DGNode<Value> *> internalNodes,
-                         std::set<DGNode<Value> *> externalNodes);
+                         std::set<DGNode<Value> *> externalNodes,
+                         std::function<bool(DGEdge<Value> *)> includeEdge);
 };
 
 template <>
@@ -26,11 +26,16 @@
 #include "noelle/core/DGBase.hpp"
 #include "noelle/core/SCC.hpp"
 #include "noelle/core/PDG.hpp"
+#include "noelle/core/DGSnapshot.hpp"
 
 namespace llvm::noelle {
 
 /*
  * SCCDAG of a loop.
+ *
+ * The ordering among SCCs is computed when the SCCDAG is built or changed,
+ * so the const queries below can be invoked by multiple threads at the same
+ * time (see DG).
  */
 class SCCDAG : public DG<SCC> {
 public:
@@ -39,6 +44,15 @@ public:
    */
   SCCDAG(PDG *loopDependenceGraph);
 
+  /*
+   * Constructor of the SCCDAG of the view of @loopDependenceGraph that
+   * includes only the nodes and the dependences selected by the filters.
+   * No copy of @loopDependenceGraph is made.
+   */
+  SCCDAG(PDG *loopDependenceGraph,
+         DGSnapshot<Value>::NodeFilter includeNode,
+         DGSnapshot<Value>::EdgeFilter includeEdge);
+
   /*
    * Check if @inst is included in the SCCDAG.
    */
@@ -47,29 +61,31 @@ public:
   /*
    * Return the number of instructions that compose the SCCDAG.
    */
-  int64_t numberOfInstructions(void);
+  int64_t numberOfInstructions(void) const;
 
   /*
    * Iterate over SCCs until @funcToInvoke returns true or no other SCC exists.
    */
-  bool iterateOverSCCs(std::function<bool(SCC *)> funcToInvoke);
+  bool iterateOverSCCs(std::function<bool(SCC *)> funcToInvoke) const;
 
   /*
    * Return the range that includes all SCCs.
    */
-  std::unordered_set<SCC *> getSCCs(void);
+  std::unordered_set<SCC *> getSCCs(void) const;
 
   /*
    * Iterate over instructions inside the SCCDAG until @funcToInvoke returns
    * true or no other instruction exists.
    */
-  bool iterateOverInstructions(std::function<bool(Instruction *)> funcToInvoke);
+  bool iterateOverInstructions(
+      std::function<bool(Instruction *)> funcToInvoke) const;
 
   /*
    * Iterate over live-ins and live-outs of the loop represented by the SCCDAG
    * until @funcToInvoke returns true or no other live-in and live-out exist.
    */
-  bool iterateOverLiveInAndLiveOut(std::function<bool(Value *)> funcToInvoke);
+  bool iterateOverLiveInAndLiveOut(
+      std::function<bool(Value *)> funcToInvoke) const;
 
   /*
    * Iterate over all instructions (internal and external) until @funcToInvoke
@@ -77,20 +93,34 @@ public:
    * live-ins and live-outs of the loop represented by the SCCDAG.
    */
   bool iterateOverAllInstructions(
-      std::function<bool(Instruction *)> funcToInvoke);
+      std::function<bool(Instruction *)> funcToInvoke) const;
 
   /*
    * Iterate over all values (internal and external) until @funcToInvoke returns
    * true or no other value exists. External values represent live-ins and
    * live-outs of the loop represented by the SCCDAG.
    */
-  bool iterateOverAllValues(std::function<bool(Value *)> funcToInvoke);
+  bool iterateOverAllValues(std::function<bool(Value *)> funcToInvoke) const;
 
   /*
    * Merge SCCs of @sccSet to become a single node of the SCCDAG.
    */
   void mergeSCCs(std::set<DGNode<SCC> *> &sccSet);
 
+  /*
+   * Split @scc into the SCCs of its values after dependences among them have
+   * been removed from @pdg, which is the graph the SCCDAG has been built from
+   * (without filters).
+   * Only the values of @scc and the dependences between them are visited: the
+   * rest of the SCCDAG is kept.
+   */
+  void splitSCC(SCC *scc, PDG *pdg);
+
+  /*
+   * Split every SCC of @sccs as splitSCC does.
+   */
+  void splitSCCs(std::unordered_set<SCC *> &sccs, PDG *pdg);
+
   /*
    * Return the SCC that contains @val
    */
@@ -121,6 +151,9 @@ public:
 protected:
   void markValuesInSCC(void);
   void markEdgesAndSubEdges(void);
+  void markEdgesAndSubEdgesOf(DGNode<SCC> *outgoingSCCNode,
+                              std::set<DGEdge<SCC> *> &clearedEdges);
+  void markNewSCCs(std::unordered_set<DGNode<SCC> *> &newSCCNodes);
 
   unordered_map<Value *, DGNode<SCC> *> valueToSCCNode;
 
@@ -142,5 +175,12 @@ private:
    * Compute transitive dependences between nodes of the SCCDAG.
    */
   void computeReachabilityAmongSCCs(void);
+
+  /*
+   * Compute the SCCs of the subgraph of @pdg that includes only @values.
+   */
+  static std::vector<std::set<DGNode<Value> *>> computeSCCsOfValues(
+      std::unordered_set<Value *> &values,
+      PDG *pdg);
 };
 } // namespace llvm::noelle
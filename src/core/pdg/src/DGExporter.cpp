@@ -0,0 +1,406 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/JSON.h"
+
+#include "noelle/core/DGExporter.hpp"
+
+namespace llvm::noelle {
+
+bool DGExporter::Filter::isSelected(DGEdge<Value> *edge) const {
+  if (true && this->onlyLoopCarried && !edge->isLoopCarriedDependence()) {
+    return false;
+  }
+  if (edge->isControlDependence()) {
+    return this->controlDependences;
+  }
+  if (edge->isMemoryDependence()) {
+    return this->memoryDependences;
+  }
+
+  return this->variableDependences;
+}
+
+bool DGExporter::Filter::selectsAllDependences(void) const {
+  return true && this->variableDependences && this->memoryDependences
+         && this->controlDependences && !this->onlyLoopCarried;
+}
+
+bool DGExporter::parseDependenceKinds(const std::string &kinds,
+                                      Filter &filter) {
+  filter.variableDependences = false;
+  filter.memoryDependences = false;
+  filter.controlDependences = false;
+  SmallVector<StringRef, 3> names;
+  StringRef(kinds).split(names, ',', -1, false);
+  for (auto name : names) {
+    name = name.trim();
+    if (name == "variable") {
+      filter.variableDependences = true;
+    } else if (name == "memory") {
+      filter.memoryDependences = true;
+    } else if (name == "control") {
+      filter.controlDependences = true;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool DGExporter::parseFormat(const std::string &name, Format &format) {
+  if (name == "dot") {
+    format = Format::DOT;
+    return true;
+  }
+  if (name == "json") {
+    format = Format::JSON;
+    return true;
+  }
+
+  return false;
+}
+
+DGExporter::DGExporter(const std::string &fileName,
+                       Format format,
+                       const Filter &filter)
+  : format{ format },
+    filter{ filter },
+    numberOfGraphs{ 0 } {
+
+  /*
+   * Open the file.
+   */
+  std::error_code EC;
+  this->file = std::make_unique<raw_fd_ostream>(fileName, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << "DGExporter: ERROR = file " << fileName
+           << " cannot be written\n";
+    this->file = nullptr;
+    return;
+  }
+
+  /*
+   * The graphs of a DOT file are clusters of a single graph.
+   */
+  if (this->format == Format::DOT) {
+    *this->file << "digraph \"" << DOT::EscapeString(fileName) << "\" {\n";
+  }
+
+  return;
+}
+
+bool DGExporter::isOpen(void) const {
+  return this->file != nullptr;
+}
+
+void DGExporter::exportGraph(const std::string &name, PDG *graph) {
+  if (!this->isOpen()) {
+    return;
+  }
+  this->beginGraph(name);
+
+  /*
+   * Nodes are numbered and written the first time they are met.
+   */
+  std::unordered_map<Value *, uint64_t> nodeIDs;
+  auto fetchNodeID = [this, graph, &nodeIDs](Value *value) -> uint64_t {
+    auto nodeIt = nodeIDs.find(value);
+    if (nodeIt != nodeIDs.end()) {
+      return nodeIt->second;
+    }
+    auto nodeID = nodeIDs.size();
+    nodeIDs[value] = nodeID;
+    this->writeNode(nodeID,
+                    DGExporter::getLabel(value),
+                    graph->isExternal(value));
+    return nodeID;
+  };
+
+  /*
+   * Write the selected dependences.
+   */
+  for (auto edge : graph->getEdges()) {
+    if (!this->filter.isSelected(edge)) {
+      continue;
+    }
+    auto src = edge->getOutgoingT();
+    auto dst = edge->getIncomingT();
+    auto srcID = fetchNodeID(src);
+    auto dstID = fetchNodeID(dst);
+    auto kind = edge->isControlDependence()
+                    ? "control"
+                    : (edge->isMemoryDependence() ? "memory" : "variable");
+    this->writeEdge(srcID,
+                    dstID,
+                    kind,
+                    edge->dataDependenceType(),
+                    edge->isMustDependence(),
+                    edge->isLoopCarriedDependence(),
+                    graph->isExternal(src) || graph->isExternal(dst),
+                    1);
+  }
+
+  /*
+   * Write the nodes without dependences if the whole graph is exported.
+   */
+  if (this->filter.selectsAllDependences()) {
+    for (auto node : graph->getNodes()) {
+      fetchNodeID(node->getT());
+    }
+  }
+
+  this->endGraph();
+
+  return;
+}
+
+void DGExporter::exportSCCDAG(const std::string &name, SCCDAG *sccdag) {
+  if (!this->isOpen()) {
+    return;
+  }
+  this->beginGraph(name);
+
+  /*
+   * Write the SCCs with selected dependences among their instructions (all of
+   * them if the whole graph is exported).
+   * The other SCCs are written the first time a dependence connects them.
+   */
+  std::unordered_map<SCC *, uint64_t> nodeIDs;
+  auto writeSCC = [this, &nodeIDs](SCC *scc, uint64_t internalDependences) {
+    auto nodeID = nodeIDs.size();
+    nodeIDs[scc] = nodeID;
+    std::string label;
+    raw_string_ostream ros(label);
+    ros << "SCC " << nodeID << ": " << scc->numberOfInstructions()
+        << " instructions";
+    if (internalDependences > 0) {
+      ros << ", " << internalDependences << " dependences";
+    }
+    this->writeNode(nodeID, ros.str(), false);
+    return nodeID;
+  };
+  for (auto node : sccdag->getNodes()) {
+    auto scc = node->getT();
+    uint64_t internalDependences = 0;
+    for (auto edge : scc->getEdges()) {
+      if (true && this->filter.isSelected(edge)
+          && scc->isInternal(edge->getOutgoingT())
+          && scc->isInternal(edge->getIncomingT())) {
+        internalDependences++;
+      }
+    }
+    if (false || (internalDependences > 0)
+        || this->filter.selectsAllDependences()) {
+      writeSCC(scc, internalDependences);
+    }
+  }
+  auto fetchNodeID = [&nodeIDs, &writeSCC](SCC *scc) -> uint64_t {
+    auto nodeIt = nodeIDs.find(scc);
+    if (nodeIt != nodeIDs.end()) {
+      return nodeIt->second;
+    }
+    return writeSCC(scc, 0);
+  };
+
+  /*
+   * Write an edge per pair of SCCs connected by selected dependences.
+   */
+  for (auto edge : sccdag->getEdges()) {
+    uint64_t dependences = 0;
+    auto isMust = true;
+    auto isLoopCarried = false;
+    std::set<std::string> kinds;
+    for (auto subEdge : edge->getSubEdges()) {
+      if (!this->filter.isSelected(subEdge)) {
+        continue;
+      }
+      dependences++;
+      isMust &= subEdge->isMustDependence();
+      isLoopCarried |= subEdge->isLoopCarriedDependence();
+      kinds.insert(subEdge->isControlDependence()
+                       ? "control"
+                       : (subEdge->isMemoryDependence() ? "memory"
+                                                        : "variable"));
+    }
+    if (dependences == 0) {
+      continue;
+    }
+    std::string kind;
+    for (auto &k : kinds) {
+      kind += (kind.empty() ? "" : ",") + k;
+    }
+    auto srcID = fetchNodeID(edge->getOutgoingT());
+    auto dstID = fetchNodeID(edge->getIncomingT());
+    this->writeEdge(srcID,
+                    dstID,
+                    kind,
+                    DG_DATA_NONE,
+                    isMust,
+                    isLoopCarried,
+                    false,
+                    dependences);
+  }
+
+  this->endGraph();
+
+  return;
+}
+
+void DGExporter::beginGraph(const std::string &name) {
+  this->graphName = name;
+  if (this->format == Format::DOT) {
+    *this->file << "  subgraph \"cluster_" << this->numberOfGraphs << "\" {\n"
+                << "    label=\"" << DOT::EscapeString(name) << "\";\n";
+  }
+
+  return;
+}
+
+void DGExporter::endGraph(void) {
+  if (this->format == Format::DOT) {
+    *this->file << "  }\n";
+  }
+  this->numberOfGraphs++;
+
+  /*
+   * Make the graph visible to the readers of the file while the next ones are
+   * computed.
+   */
+  this->file->flush();
+
+  return;
+}
+
+void DGExporter::writeNode(uint64_t node,
+                           const std::string &label,
+                           bool isExternal) {
+  auto &stream = *this->file;
+  if (this->format == Format::DOT) {
+    stream << "    g" << this->numberOfGraphs << "n" << node << " [label=\""
+           << DOT::EscapeString(label) << "\""
+           << (isExternal ? ",color=gray" : "") << "];\n";
+    return;
+  }
+
+  json::OStream J(stream);
+  J.object([&] {
+    J.attribute("graph", this->graphName);
+    J.attribute("node", (int64_t)node);
+    J.attribute("value", label);
+    J.attribute("external", isExternal);
+  });
+  stream << "\n";
+
+  return;
+}
+
+void DGExporter::writeEdge(uint64_t from,
+                           uint64_t to,
+                           const std::string &kind,
+                           DataDependenceType dataType,
+                           bool isMust,
+                           bool isLoopCarried,
+                           bool isExternal,
+                           uint64_t dependences) {
+  std::string type = (dataType == DG_DATA_RAW)
+                         ? "RAW"
+                         : ((dataType == DG_DATA_WAR)
+                                ? "WAR"
+                                : ((dataType == DG_DATA_WAW) ? "WAW" : ""));
+  auto &stream = *this->file;
+
+  /*
+   * Edges follow the colors of DGPrinter.
+   */
+  if (this->format == Format::DOT) {
+    auto color = (kind == "control")
+                     ? "blue"
+                     : ((kind == "variable") ? "black" : "red");
+    stream << "    g" << this->numberOfGraphs << "n" << from << " -> g"
+           << this->numberOfGraphs << "n" << to << " [color=" << color;
+    if (isLoopCarried) {
+      stream << ",penwidth=2";
+    }
+    if (isExternal) {
+      stream << ",style=dotted";
+    }
+    if (dependences > 1) {
+      stream << ",label=\"" << dependences << "\"";
+    } else if ((kind == "memory") && (type != "")) {
+      stream << ",label=\"" << type << (isMust ? " must" : " may") << "\"";
+    }
+    stream << "];\n";
+    return;
+  }
+
+  json::OStream J(stream);
+  J.object([&] {
+    J.attribute("graph", this->graphName);
+    J.attribute("from", (int64_t)from);
+    J.attribute("to", (int64_t)to);
+    J.attribute("kind", kind);
+    if (type != "") {
+      J.attribute("type", type);
+    }
+    J.attribute("must", isMust);
+    J.attribute("loop_carried", isLoopCarried);
+    if (dependences > 1) {
+      J.attribute("dependences", (int64_t)dependences);
+    }
+  });
+  stream << "\n";
+
+  return;
+}
+
+std::string DGExporter::getLabel(Value *value) {
+  std::string label;
+  raw_string_ostream ros(label);
+
+  /*
+   * Only instructions are printed entirely: the initializers of globals can be
+   * arbitrarily large.
+   */
+  if (isa<Instruction>(value)) {
+    value->print(ros);
+  } else {
+    value->printAsOperand(ros, false);
+  }
+
+  return StringRef(ros.str()).trim().str();
+}
+
+DGExporter::~DGExporter() {
+  if (!this->isOpen()) {
+    return;
+  }
+  if (this->format == Format::DOT) {
+    *this->file << "}\n";
+  }
+  this->file->close();
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -19,7 +19,12 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <cstring>
+#include <fstream>
+
+#include "llvm/Support/MD5.h"
 #include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PhaseTimer.hpp"
 #include "IntegrationWithSVF.hpp"
 
 /*
@@ -37,13 +42,370 @@
 
 namespace llvm::noelle {
 
+/*
+ * Options of the pass.
+ */
+static cl::opt<std::string> SVFCacheFile(
+    "noelle-svf-cache",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File used to reuse the answers of SVF across runs on the same "
+             "module"));
+
 #ifdef ENABLE_SVF
+static Module *program = nullptr;
 static WPAPass *wpa = nullptr;
 static MemSSA *mssa = nullptr;
 static PointerAnalysis *pta = nullptr;
 static PTACallGraph *svfCallGraph = nullptr;
 #endif
 
+/*
+ * Cache of the answers of SVF.
+ * Alias queries are symmetric, so their keys are ordered by pointer.
+ */
+static DenseMap<std::pair<MemoryLocation, MemoryLocation>, AliasResult>
+    locationAliases;
+static DenseMap<std::pair<const Value *, const Value *>, AliasResult>
+    valueAliases;
+static DenseMap<CallBase *, ModRefInfo> callModRefs;
+static DenseMap<std::pair<CallBase *, MemoryLocation>, ModRefInfo>
+    callLocationModRefs;
+static DenseMap<std::pair<CallBase *, CallBase *>, ModRefInfo> callCallModRefs;
+static uint64_t queryCacheHits = 0;
+static uint64_t queryCacheMisses = 0;
+
+template <class Key, class Result>
+static Result fetchOrCompute(DenseMap<Key, Result> &cache,
+                             const Key &key,
+                             std::function<Result(void)> compute) {
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    queryCacheHits++;
+    return it->second;
+  }
+  queryCacheMisses++;
+  auto result = compute();
+  cache[key] = result;
+  return result;
+}
+
+/*
+ * Answers of SVF stored on disk.
+ *
+ * Values are identified by their position in the module, and the answers are
+ * reused only if the module has the same hash. The answers of SVF depend only
+ * on the pointers involved (not on the sizes of the memory locations), so
+ * they are keyed on them.
+ * Answers are recorded only while the module is the one that has been hashed:
+ * invalidating the query cache stops the recording.
+ */
+enum PersistentQuery : uint8_t {
+  QUERY_ALIAS = 0,
+  QUERY_MODREF_CALL = 1,
+  QUERY_MODREF_CALL_LOCATION = 2,
+  QUERY_MODREF_CALL_CALL = 3,
+  QUERY_HAS_INDIRECT_CALLEES = 4,
+  QUERY_REACHABLE_FUNCTIONS = 5
+};
+typedef std::tuple<uint8_t, uint32_t, uint32_t> PersistentKey;
+static const char svfCacheMagic[8] = { 'N', 'S', 'V', 'F', 'C', '0', '0', '1' };
+static std::string moduleHash;
+static bool isRecordingAnswers = false;
+static bool hasNewAnswers = false;
+static std::vector<Value *> persistentValues;
+static std::unordered_map<const Value *, uint32_t> persistentIndices;
+static std::map<PersistentKey, uint32_t> persistentAnswers;
+static std::map<uint32_t, std::vector<uint32_t>> persistentIndirectCallees;
+
+static std::string computeModuleHash(Module &M) {
+  MD5 hasher;
+  auto hashString = [&hasher](const std::string &s) {
+    hasher.update(s);
+    hasher.update(StringRef("\0", 1));
+  };
+  auto printToString = [](auto *printable) -> std::string {
+    std::string s;
+    raw_string_ostream os(s);
+    printable->print(os);
+    return os.str();
+  };
+
+  /*
+   * Hash the structure of the globals and of the functions.
+   * Neither metadata nor the identifier of the module (i.e., its file name)
+   * are hashed: tools that only attach metadata (e.g., the parallelization
+   * planner) keep the answers of SVF valid.
+   */
+  for (auto &G : M.globals()) {
+    hashString("@" + G.getName().str());
+    hashString(printToString(G.getValueType()));
+    hashString(std::to_string(G.isConstant()));
+    if (G.hasInitializer()) {
+      hashString(printToString(G.getInitializer()));
+    }
+  }
+  for (auto &F : M) {
+    hashString("@" + F.getName().str());
+    hashString(printToString(F.getFunctionType()));
+
+    /*
+     * Local values are identified by their position in the function.
+     */
+    std::unordered_map<Value *, uint64_t> localIDs;
+    for (auto &arg : F.args()) {
+      localIDs[&arg] = localIDs.size();
+    }
+    for (auto &BB : F) {
+      localIDs[&BB] = localIDs.size();
+      for (auto &I : BB) {
+        localIDs[&I] = localIDs.size();
+      }
+    }
+    for (auto &I : instructions(F)) {
+      hashString(I.getOpcodeName());
+      hashString(printToString(I.getType()));
+      if (auto cmp = dyn_cast<CmpInst>(&I)) {
+        hashString(std::to_string(cmp->getPredicate()));
+      }
+      for (auto &op : I.operands()) {
+        auto v = op.get();
+        auto localIt = localIDs.find(v);
+        if (localIt != localIDs.end()) {
+          hashString("%" + std::to_string(localIt->second));
+        } else if (auto global = dyn_cast<GlobalValue>(v)) {
+          hashString("@" + global->getName().str());
+        } else if (auto constant = dyn_cast<Constant>(v)) {
+          hashString(printToString(constant));
+        } else {
+          hashString("?");
+        }
+      }
+    }
+  }
+
+  MD5::MD5Result result;
+  hasher.final(result);
+
+  return result.digest().str();
+}
+
+static void numberPersistentValues(Module &M) {
+  persistentValues.clear();
+  persistentIndices.clear();
+  auto addValue = [](Value *v) {
+    persistentIndices[v] = persistentValues.size();
+    persistentValues.push_back(v);
+  };
+  for (auto &G : M.globals()) {
+    addValue(&G);
+  }
+  for (auto &F : M) {
+    addValue(&F);
+    for (auto &arg : F.args()) {
+      addValue(&arg);
+    }
+    for (auto &I : instructions(F)) {
+      addValue(&I);
+    }
+  }
+
+  return;
+}
+
+static bool fetchPersistentIndex(const Value *v, uint32_t &index) {
+  auto it = persistentIndices.find(v);
+  if (it == persistentIndices.end()) {
+    return false;
+  }
+  index = it->second;
+  return true;
+}
+
+static bool fetchPersistentKey(PersistentQuery query,
+                               const Value *v1,
+                               const Value *v2,
+                               PersistentKey &key) {
+  uint32_t index1 = 0;
+  uint32_t index2 = 0;
+  if (!fetchPersistentIndex(v1, index1)) {
+    return false;
+  }
+  if (true && (v2 != nullptr) && (!fetchPersistentIndex(v2, index2))) {
+    return false;
+  }
+
+  /*
+   * Alias queries are symmetric, so their values are ordered by index (their
+   * addresses change across runs).
+   */
+  if (true && (query == QUERY_ALIAS) && (index2 < index1)) {
+    std::swap(index1, index2);
+  }
+  key = std::make_tuple(static_cast<uint8_t>(query), index1, index2);
+  return true;
+}
+
+/*
+ * Return the answer of SVF to @query about @v1 and @v2 (which can be nullptr).
+ * The answer is fetched from disk if it has been stored, and it is computed
+ * by @compute otherwise.
+ */
+static uint32_t fetchOrComputePersistent(
+    PersistentQuery query,
+    const Value *v1,
+    const Value *v2,
+    std::function<uint32_t(void)> compute) {
+  PersistentKey key;
+  auto isPersistent = fetchPersistentKey(query, v1, v2, key);
+  if (isPersistent) {
+    auto it = persistentAnswers.find(key);
+    if (it != persistentAnswers.end()) {
+      return it->second;
+    }
+  }
+  auto answer = compute();
+  if (true && isPersistent && isRecordingAnswers) {
+    persistentAnswers[key] = answer;
+    hasNewAnswers = true;
+  }
+  return answer;
+}
+
+static bool loadPersistentAnswers(const std::string &fileName) {
+
+  /*
+   * Open the file and check its format and the module it refers to.
+   */
+  std::ifstream file(fileName, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  char magic[sizeof(svfCacheMagic)];
+  if (false || (!file.read(magic, sizeof(magic)))
+      || (std::memcmp(magic, svfCacheMagic, sizeof(svfCacheMagic)) != 0)) {
+    return false;
+  }
+  auto readInteger = [&file](uint32_t &value) -> bool {
+    return !!file.read(reinterpret_cast<char *>(&value), sizeof(value));
+  };
+  uint32_t hashSize;
+  if (!readInteger(hashSize)) {
+    return false;
+  }
+  std::string hash(hashSize, '\0');
+  if (false || (!file.read(&hash[0], hashSize)) || (hash != moduleHash)) {
+    return false;
+  }
+
+  /*
+   * Read the answers.
+   */
+  std::map<PersistentKey, uint32_t> answersRead;
+  std::map<uint32_t, std::vector<uint32_t>> indirectCalleesRead;
+  uint32_t numberOfAnswers;
+  if (!readInteger(numberOfAnswers)) {
+    return false;
+  }
+  for (auto i = 0u; i < numberOfAnswers; i++) {
+    uint8_t query;
+    uint32_t index1, index2, answer;
+    if (false || (!file.read(reinterpret_cast<char *>(&query), 1))
+        || (!readInteger(index1)) || (!readInteger(index2))
+        || (!readInteger(answer))) {
+      return false;
+    }
+    answersRead[std::make_tuple(query, index1, index2)] = answer;
+  }
+  uint32_t numberOfCalls;
+  if (!readInteger(numberOfCalls)) {
+    return false;
+  }
+  for (auto i = 0u; i < numberOfCalls; i++) {
+    uint32_t call, numberOfCallees;
+    if (false || (!readInteger(call)) || (!readInteger(numberOfCallees))) {
+      return false;
+    }
+    auto &callees = indirectCalleesRead[call];
+    for (auto j = 0u; j < numberOfCallees; j++) {
+      uint32_t callee;
+      if (false || (!readInteger(callee))
+          || (callee >= persistentValues.size())
+          || (!isa<Function>(persistentValues[callee]))) {
+        return false;
+      }
+      callees.push_back(callee);
+    }
+  }
+
+  /*
+   * The answers are valid.
+   */
+  persistentAnswers = std::move(answersRead);
+  persistentIndirectCallees = std::move(indirectCalleesRead);
+
+  return true;
+}
+
+static void savePersistentAnswers(const std::string &fileName) {
+  std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    errs() << "NoelleSVFIntegration: WARNING = cannot write the SVF cache "
+           << fileName << "\n";
+    return;
+  }
+  auto writeInteger = [&file](uint32_t value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  };
+  file.write(svfCacheMagic, sizeof(svfCacheMagic));
+  writeInteger(moduleHash.size());
+  file.write(moduleHash.data(), moduleHash.size());
+  writeInteger(persistentAnswers.size());
+  for (auto &pair : persistentAnswers) {
+    file.put(std::get<0>(pair.first));
+    writeInteger(std::get<1>(pair.first));
+    writeInteger(std::get<2>(pair.first));
+    writeInteger(pair.second);
+  }
+  writeInteger(persistentIndirectCallees.size());
+  for (auto &pair : persistentIndirectCallees) {
+    writeInteger(pair.first);
+    writeInteger(pair.second.size());
+    for (auto callee : pair.second) {
+      writeInteger(callee);
+    }
+  }
+
+  return;
+}
+
+#ifdef ENABLE_SVF
+/*
+ * Run the pointer analyses of SVF if they have not run yet.
+ */
+static void computeSVFAnalyses(void) {
+  if (wpa != nullptr) {
+    return;
+  }
+  assert(program != nullptr);
+  PhaseTimer timer("svf", "SVF");
+
+  // run SVF's WPAPass for all applicable pointer analysis
+  wpa = new WPAPass();
+  wpa->runOnModule(*program);
+
+  // run a single AndersenWaveDiff pointer analysis manually for querying ModRef
+  // info
+  SVFModule svfModule{ *program };
+  pta = new AndersenWaveDiff();
+  pta->analyze(svfModule);
+  svfCallGraph = pta->getPTACallGraph();
+  mssa = new MemSSA((BVDataPTAImpl *)pta, false);
+
+  return;
+}
+#endif
+
 // Next there is code to register your pass to "opt"
 char NoelleSVFIntegration::ID = 0;
 static RegisterPass<NoelleSVFIntegration> X("noellesvf",
@@ -75,29 +437,81 @@ bool NoelleSVFIntegration::doInitialization(Module &M) {
 }
 
 void NoelleSVFIntegration::getAnalysisUsage(AnalysisUsage &AU) const {
-#ifdef ENABLE_SVF
-  AU.addRequired<WPAPass>();
-#endif
+  AU.setPreservesAll();
   return;
 }
 
 bool NoelleSVFIntegration::runOnModule(Module &M) {
-#ifdef ENABLE_SVF
-  // get SVF's WPAPass analysis for all applicable pointer analysis
-  wpa = &getAnalysis<WPAPass>();
+  NoelleSVFIntegration::initializeForModule(M);
 
-  // run a single AndersenWaveDiff pointer analysis manually for querying ModRef
-  // info
-  SVFModule svfModule{ M };
-  pta = new AndersenWaveDiff();
-  pta->analyze(svfModule);
-  svfCallGraph = pta->getPTACallGraph();
-  mssa = new MemSSA((BVDataPTAImpl *)pta, false);
-#endif
+  return false;
+}
+
+bool NoelleSVFIntegration::doFinalization(Module &M) {
+  NoelleSVFIntegration::finalizeForModule(M);
 
   return false;
 }
 
+void NoelleSVFIntegration::initializeForModule(Module &M) {
+
+  /*
+   * Forget the answers of a previous run.
+   */
+  NoelleSVFIntegration::invalidateQueryCache();
+
+  /*
+   * Check if the answers of SVF about this module are stored on disk.
+   * If they are, then SVF runs only if a query is not answered by them.
+   */
+  auto loadedAnswers = false;
+  if (SVFCacheFile.getNumOccurrences() > 0) {
+    moduleHash = computeModuleHash(M);
+    numberPersistentValues(M);
+    loadedAnswers = loadPersistentAnswers(SVFCacheFile.getValue());
+    isRecordingAnswers = true;
+    hasNewAnswers = false;
+  }
+
+#ifdef ENABLE_SVF
+  /*
+   * The pointer analyses computed for another module cannot answer the
+   * queries about this one.
+   */
+  if (true && (program != nullptr) && (program != &M)) {
+    delete mssa;
+    delete pta;
+    delete wpa;
+    mssa = nullptr;
+    pta = nullptr;
+    wpa = nullptr;
+    svfCallGraph = nullptr;
+  }
+  program = &M;
+  if (!loadedAnswers) {
+    computeSVFAnalyses();
+  }
+#endif
+
+  return;
+}
+
+void NoelleSVFIntegration::finalizeForModule(Module &M) {
+
+  /*
+   * Store the answers of SVF if new ones have been computed for the module
+   * that has been hashed.
+   */
+  if (true && isRecordingAnswers && hasNewAnswers
+      && (computeModuleHash(M) == moduleHash)) {
+    savePersistentAnswers(SVFCacheFile.getValue());
+  }
+  isRecordingAnswers = false;
+  hasNewAnswers = false;
+
+  return;
+}
+
 noelle::CallGraph *NoelleSVFIntegration::getProgramCallGraph(Module &M) {
 
   /*
@@ -113,7 +527,14 @@ noelle::CallGraph *NoelleSVFIntegration::getProgramCallGraph(Module &M) {
 bool NoelleSVFIntegration::hasIndCSCallees(CallBase *call) {
 #ifdef ENABLE_SVF
   if (auto callInst = dyn_cast<CallInst>(call)) {
-    return svfCallGraph->hasIndCSCallees(callInst);
+    return fetchOrComputePersistent(
+        QUERY_HAS_INDIRECT_CALLEES,
+        callInst,
+        nullptr,
+        [callInst]() -> uint32_t {
+          computeSVFAnalyses();
+          return svfCallGraph->hasIndCSCallees(callInst);
+        });
   }
   return true;
 #else
@@ -128,7 +549,42 @@ const std::set<const Function *> NoelleSVFIntegration::getIndCSCallees(
     CallBase *call) {
 #ifdef ENABLE_SVF
   if (auto callInst = dyn_cast<CallInst>(call)) {
-    return svfCallGraph->getIndCSCallees(callInst);
+
+    /*
+     * Check if the callees are stored on disk.
+     */
+    uint32_t callIndex = 0;
+    auto isPersistent = fetchPersistentIndex(callInst, callIndex);
+    if (isPersistent) {
+      auto it = persistentIndirectCallees.find(callIndex);
+      if (it != persistentIndirectCallees.end()) {
+        std::set<const Function *> callees;
+        for (auto callee : it->second) {
+          callees.insert(cast<Function>(persistentValues[callee]));
+        }
+        return callees;
+      }
+    }
+
+    /*
+     * Compute the callees.
+     * They are stored only if they are all functions of the module.
+     */
+    computeSVFAnalyses();
+    auto callees = svfCallGraph->getIndCSCallees(callInst);
+    if (true && isPersistent && isRecordingAnswers) {
+      std::vector<uint32_t> calleeIndices;
+      for (auto callee : callees) {
+        uint32_t calleeIndex = 0;
+        if (!fetchPersistentIndex(callee, calleeIndex)) {
+          return callees;
+        }
+        calleeIndices.push_back(calleeIndex);
+      }
+      persistentIndirectCallees[callIndex] = calleeIndices;
+      hasNewAnswers = true;
+    }
+    return callees;
   }
   // TODO
   return {};
@@ -141,7 +597,14 @@ const std::set<const Function *> NoelleSVFIntegration::getIndCSCallees(
 bool NoelleSVFIntegration::isReachableBetweenFunctions(const Function *from,
                                                        const Function *to) {
 #ifdef ENABLE_SVF
-  return svfCallGraph->isReachableBetweenFunctions(from, to);
+  return fetchOrComputePersistent(
+      QUERY_REACHABLE_FUNCTIONS,
+      from,
+      to,
+      [from, to]() -> uint32_t {
+        computeSVFAnalyses();
+        return svfCallGraph->isReachableBetweenFunctions(from, to);
+      });
 #else
   return true;
 #endif
@@ -150,7 +613,20 @@ bool NoelleSVFIntegration::isReachableBetweenFunctions(const Function *from,
 ModRefInfo NoelleSVFIntegration::getModRefInfo(CallBase *i) {
 #ifdef ENABLE_SVF
   if (auto callInst = dyn_cast<CallInst>(i)) {
-    return mssa->getMRGenerator()->getModRefInfo(callInst);
+    return fetchOrCompute<CallBase *, ModRefInfo>(
+        callModRefs,
+        i,
+        [callInst]() -> ModRefInfo {
+          return static_cast<ModRefInfo>(fetchOrComputePersistent(
+              QUERY_MODREF_CALL,
+              callInst,
+              nullptr,
+              [callInst]() -> uint32_t {
+                computeSVFAnalyses();
+                return static_cast<uint32_t>(
+                    mssa->getMRGenerator()->getModRefInfo(callInst));
+              }));
+        });
   }
   return ModRefInfo::ModRef;
 #else
@@ -162,7 +638,20 @@ ModRefInfo NoelleSVFIntegration::getModRefInfo(CallBase *i,
                                                const MemoryLocation &loc) {
 #ifdef ENABLE_SVF
   if (auto callInst = dyn_cast<CallInst>(i)) {
-    return mssa->getMRGenerator()->getModRefInfo(callInst, loc);
+    return fetchOrCompute<std::pair<CallBase *, MemoryLocation>, ModRefInfo>(
+        callLocationModRefs,
+        std::make_pair(i, loc),
+        [callInst, &loc]() -> ModRefInfo {
+          return static_cast<ModRefInfo>(fetchOrComputePersistent(
+              QUERY_MODREF_CALL_LOCATION,
+              callInst,
+              loc.Ptr,
+              [callInst, &loc]() -> uint32_t {
+                computeSVFAnalyses();
+                return static_cast<uint32_t>(
+                    mssa->getMRGenerator()->getModRefInfo(callInst, loc));
+              }));
+        });
   }
   return ModRefInfo::ModRef;
 #else
@@ -175,7 +664,21 @@ ModRefInfo NoelleSVFIntegration::getModRefInfo(CallBase *i, CallBase *j) {
   auto callInstI = dyn_cast<CallInst>(i);
   auto callInstJ = dyn_cast<CallInst>(j);
   if (true && (callInstI != nullptr) && (callInstJ != nullptr)) {
-    return mssa->getMRGenerator()->getModRefInfo(callInstI, callInstJ);
+    return fetchOrCompute<std::pair<CallBase *, CallBase *>, ModRefInfo>(
+        callCallModRefs,
+        std::make_pair(i, j),
+        [callInstI, callInstJ]() -> ModRefInfo {
+          return static_cast<ModRefInfo>(fetchOrComputePersistent(
+              QUERY_MODREF_CALL_CALL,
+              callInstI,
+              callInstJ,
+              [callInstI, callInstJ]() -> uint32_t {
+                computeSVFAnalyses();
+                return static_cast<uint32_t>(
+                    mssa->getMRGenerator()->getModRefInfo(callInstI,
+                                                          callInstJ));
+              }));
+        });
   }
   return ModRefInfo::ModRef;
 #else
@@ -186,7 +689,21 @@ ModRefInfo NoelleSVFIntegration::getModRefInfo(CallBase *i, CallBase *j) {
 AliasResult NoelleSVFIntegration::alias(const MemoryLocation &loc1,
                                         const MemoryLocation &loc2) {
 #ifdef ENABLE_SVF
-  return wpa->alias(loc1, loc2);
+  auto key = (loc1.Ptr <= loc2.Ptr) ? std::make_pair(loc1, loc2)
+                                    : std::make_pair(loc2, loc1);
+  return fetchOrCompute<std::pair<MemoryLocation, MemoryLocation>, AliasResult>(
+      locationAliases,
+      key,
+      [&key]() -> AliasResult {
+        return static_cast<AliasResult>(fetchOrComputePersistent(
+            QUERY_ALIAS,
+            key.first.Ptr,
+            key.second.Ptr,
+            [&key]() -> uint32_t {
+              computeSVFAnalyses();
+              return wpa->alias(key.first, key.second);
+            }));
+      });
 #else
   return AliasResult::MayAlias;
 #endif
@@ -194,10 +711,47 @@ AliasResult NoelleSVFIntegration::alias(const MemoryLocation &loc1,
 
 AliasResult NoelleSVFIntegration::alias(const Value *v1, const Value *v2) {
 #ifdef ENABLE_SVF
-  return wpa->alias(v1, v2);
+  auto key = (v1 <= v2) ? std::make_pair(v1, v2) : std::make_pair(v2, v1);
+  return fetchOrCompute<std::pair<const Value *, const Value *>, AliasResult>(
+      valueAliases,
+      key,
+      [&key]() -> AliasResult {
+        return static_cast<AliasResult>(fetchOrComputePersistent(
+            QUERY_ALIAS,
+            key.first,
+            key.second,
+            [&key]() -> uint32_t {
+              computeSVFAnalyses();
+              return wpa->alias(key.first, key.second);
+            }));
+      });
 #else
   return AliasResult::MayAlias;
 #endif
 }
 
+void NoelleSVFIntegration::invalidateQueryCache(void) {
+  locationAliases.clear();
+  valueAliases.clear();
+  callModRefs.clear();
+  callLocationModRefs.clear();
+  callCallModRefs.clear();
+
+  /*
+   * The module could have changed, so the answers computed from now on cannot
+   * be stored on disk.
+   */
+  isRecordingAnswers = false;
+
+  return;
+}
+
+uint64_t NoelleSVFIntegration::getNumberOfQueryCacheHits(void) {
+  return queryCacheHits;
+}
+
+uint64_t NoelleSVFIntegration::getNumberOfQueryCacheMisses(void) {
+  return queryCacheMisses;
+}
+
 } // namespace llvm::noelle
@@ -34,6 +34,20 @@ public:
   bool doInitialization(Module &M) override;
   void getAnalysisUsage(AnalysisUsage &AU) const override;
   bool runOnModule(Module &M) override;
+  bool doFinalization(Module &M) override;
+
+  /*
+   * Prepare SVF to answer the queries about @M and forget the answers about
+   * the module it has been prepared for before, if any.
+   * This is what runOnModule does; it is exposed for the analyses that do not
+   * run within the legacy pass manager (e.g., PDGAnalysisNPM).
+   */
+  static void initializeForModule(Module &M);
+
+  /*
+   * Store the new answers about @M on disk (see -noelle-svf-cache).
+   */
+  static void finalizeForModule(Module &M);
 
   static noelle::CallGraph *getProgramCallGraph(Module &M);
   static bool hasIndCSCallees(CallBase *call);
@@ -46,6 +60,14 @@ public:
   static AliasResult alias(const MemoryLocation &loc1,
                            const MemoryLocation &loc2);
   static AliasResult alias(const Value *v1, const Value *v2);
+
+  /*
+   * The answers of SVF are cached module-wide.
+   * The cache must be invalidated when the IR changes.
+   */
+  static void invalidateQueryCache(void);
+  static uint64_t getNumberOfQueryCacheHits(void);
+  static uint64_t getNumberOfQueryCacheMisses(void);
 };
 
 } // namespace llvm::noelle
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/LoopCarriedDependenceProfiles.hpp"
+
+namespace llvm::noelle {
+
+LoopCarriedDependenceProfiles::LoopCarriedDependenceProfiles(Module &M) {
+
+  /*
+   * Fetch the sources of the profiled dependences.
+   */
+  std::unordered_map<MDNode *, Instruction *> sources;
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      if (auto sourceID = I.getMetadata(sourceMetadataName)) {
+        sources[sourceID] = &I;
+      }
+    }
+  }
+  if (sources.size() == 0) {
+    return;
+  }
+
+  /*
+   * Fetch the profiles.
+   * Each one is "!{SOURCE_ID, CHECKS, MANIFESTATIONS}".
+   */
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      auto profilesOfI = I.getMetadata(metadataName);
+      if (profilesOfI == nullptr) {
+        continue;
+      }
+      for (auto &operand : profilesOfI->operands()) {
+        auto profile = dyn_cast<MDNode>(operand);
+        if (false || (profile == nullptr) || (profile->getNumOperands() != 3)) {
+          continue;
+        }
+        auto sourceID = dyn_cast<MDNode>(profile->getOperand(0));
+        auto found = sources.find(sourceID);
+        if (found == sources.end()) {
+          continue;
+        }
+        auto checks = mdconst::extract<ConstantInt>(profile->getOperand(1));
+        auto manifestations =
+            mdconst::extract<ConstantInt>(profile->getOperand(2));
+        this->profiles[{ found->second, &I }] = {
+          checks->getZExtValue(),
+          manifestations->getZExtValue()
+        };
+      }
+    }
+  }
+
+  return;
+}
+
+bool LoopCarriedDependenceProfiles::isAvailable(void) const {
+  return (this->profiles.size() > 0);
+}
+
+bool LoopCarriedDependenceProfiles::isProfiled(Value *from, Value *to) const {
+  return (this->profiles.find({ from, to }) != this->profiles.end());
+}
+
+bool LoopCarriedDependenceProfiles::isProfiled(
+    DGEdge<Value> *dependence) const {
+  return this->isProfiled(dependence->getOutgoingT(),
+                          dependence->getIncomingT());
+}
+
+uint64_t LoopCarriedDependenceProfiles::getChecks(Value *from,
+                                                  Value *to) const {
+  auto found = this->profiles.find({ from, to });
+  if (found == this->profiles.end()) {
+    return 0;
+  }
+
+  return found->second.first;
+}
+
+uint64_t LoopCarriedDependenceProfiles::getManifestations(Value *from,
+                                                          Value *to) const {
+  auto found = this->profiles.find({ from, to });
+  if (found == this->profiles.end()) {
+    return 0;
+  }
+
+  return found->second.second;
+}
+
+double LoopCarriedDependenceProfiles::getManifestationFrequency(
+    Value *from,
+    Value *to) const {
+  auto checks = this->getChecks(from, to);
+  if (checks == 0) {
+    return 0;
+  }
+  auto manifestations = this->getManifestations(from, to);
+
+  return ((double)manifestations) / ((double)checks);
+}
+
+double LoopCarriedDependenceProfiles::getManifestationFrequency(
+    DGEdge<Value> *dependence) const {
+  return this->getManifestationFrequency(dependence->getOutgoingT(),
+                                         dependence->getIncomingT());
+}
+
+} // namespace llvm::noelle
@@ -60,6 +60,13 @@ PDG::PDG(Module &M) {
 }
 
 PDG::PDG(Function &F) {
+
+  /*
+   * Function and loop graphs are created and destroyed often (e.g., one per
+   * loop), so their nodes and edges are allocated in bulk.
+   */
+  this->enableArenaAllocation();
+
   addNodesOf(F);
   setEntryPointAt(F);
 
@@ -67,6 +74,7 @@ PDG::PDG(Function &F) {
 }
 
 PDG::PDG(Loop *loop) {
+  this->enableArenaAllocation();
 
   /*
    * Create a node per instruction within loops of LI only
@@ -89,6 +97,7 @@ PDG::PDG(Loop *loop) {
 }
 
 PDG::PDG(std::vector<Value *> &values) {
+  this->enableArenaAllocation();
   for (auto &V : values) {
     this->addNode(V, /*inclusion=*/true);
   }
@@ -241,12 +250,12 @@ bool PDG::iterateOverDependencesFrom(
     bool includeMemoryDataDependences,
     bool includeRegisterDataDependences,
     std::function<bool(Value *to, DGEdge<Value> *dependence)>
-        functionToInvokePerDependence) {
+        functionToInvokePerDependence) const {
 
   /*
    * Fetch the node in the PDG.
    */
-  auto pdgNode = this->fetchNode(from);
+  auto pdgNode = this->fetchConstNode(from);
   if (pdgNode == nullptr) {
     return false;
   }
@@ -306,12 +315,12 @@ bool PDG::iterateOverDependencesTo(
     bool includeMemoryDataDependences,
     bool includeRegisterDataDependences,
     std::function<bool(Value *fromValue, DGEdge<Value> *dependence)>
-        functionToInvokePerDependence) {
+        functionToInvokePerDependence) const {
 
   /*
    * Fetch the node in the PDG.
    */
-  auto pdgNode = this->fetchNode(toValue);
+  auto pdgNode = this->fetchConstNode(toValue);
   if (pdgNode == nullptr) {
     return false;
   }
@@ -365,7 +374,7 @@ bool PDG::iterateOverDependencesTo(
   return false;
 }
 
-std::vector<Value *> PDG::getSortedValues(void) {
+std::vector<Value *> PDG::getSortedValues(void) const {
   std::vector<Value *> s;
 
   /*
@@ -384,7 +393,7 @@ std::vector<Value *> PDG::getSortedValues(void) {
   return s;
 }
 
-std::vector<DGEdge<Value> *> PDG::getSortedDependences(void) {
+std::vector<DGEdge<Value> *> PDG::getSortedDependences(void) const {
   std::vector<DGEdge<Value> *> v;
 
   /*
@@ -435,13 +444,13 @@ std::vector<DGEdge<Value> *> PDG::getSortedDependences(void) {
 }
 
 std::unordered_set<DGEdge<Value> *> PDG::getDependences(Value *from,
-                                                        Value *to) {
+                                                        Value *to) const {
 
   /*
    * Fetch the nodes.
    */
-  auto srcNode = this->fetchNode(from);
-  auto dstNode = this->fetchNode(to);
+  auto srcNode = this->fetchConstNode(from);
+  auto dstNode = this->fetchConstNode(to);
   if (!srcNode || !dstNode) {
     return {};
   }
@@ -457,8 +466,8 @@ std::unordered_set<DGEdge<Value> *> PDG::getDependences(Value *from,
 PDG::~PDG() {
   for (auto *edge : allEdges)
     if (edge)
-      delete edge;
+      this->deallocateEdge(edge);
   for (auto *node : allNodes)
     if (node)
-      delete node;
+      this->deallocateNode(node);
 }
@@ -19,11 +19,16 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <chrono>
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/TalkDown.hpp"
 #include "noelle/core/PDGPrinter.hpp"
 #include "noelle/core/PDGAnalysis.hpp"
 #include "noelle/core/Utils.hpp"
+#include "noelle/core/PhaseTimer.hpp"
+#include "noelle/core/LibraryFunctions.hpp"
+#include "PDGCache.hpp"
+#include "PDGBinaryFormat.hpp"
 
 namespace llvm::noelle {
 
@@ -39,8 +44,26 @@ PDGAnalysis::PDGAnalysis()
     disableSVF{ false },
     disableAllocAA{ false },
     disableRA{ false },
+    analyzeOnlyHotCode{ false },
+    minimumHotness{ 0.0 },
+    numberOfThreads{ 1 },
+    cache{ nullptr },
+    embeddedPDG{ nullptr },
     printer{},
-    noelleCG{ nullptr } {
+    noelleCG{ nullptr },
+    dependenceProfiles{ nullptr },
+    memoryBudget{ 0 },
+    functionDGsBytes{ 0 },
+    functionDGsPeakBytes{ 0 },
+    functionDGCacheHits{ 0 },
+    functionDGCacheMisses{ 0 },
+    functionDGRebuilds{ 0 },
+    functionDGEvictions{ 0 },
+    allocAA{ nullptr },
+    functionQueryBudget{ 0 },
+    functionTimeBudget{ 0 },
+    modRefSummariesComputed{ false },
+    hotFunctionsIdentified{ false } {
 
   return;
 }
@@ -50,15 +73,15 @@ void PDGAnalysis::initializeSVF(Module &M) {
 }
 
 void PDGAnalysis::releaseMemory() {
+  if (this->cache != nullptr) {
+    this->cache->save();
+  }
   if (this->programDependenceGraph)
     delete this->programDependenceGraph;
   this->programDependenceGraph = nullptr;
 
-  for (auto functionFDGPair : this->functionToFDGMap) {
-    auto fdg = functionFDGPair.second;
-    delete fdg;
-  }
-  this->functionToFDGMap.clear();
+  this->forgetFunctionDGs();
+  this->hotFunctionsIdentified = false;
 
   return;
 }
@@ -108,9 +131,10 @@ PDG *PDGAnalysis::getFunctionPDG(Function &F) {
       for (auto edge : pdg->getEdges()) {
         assert(!edge->isLoopCarriedDependence() && "Flag was already set");
       }
-      this->functionToFDGMap.insert(std::make_pair(&F, pdg));
+      this->cacheFunctionDG(F, pdg);
     } else {
       pdg = this->functionToFDGMap.at(&F);
+      this->touchFunctionDG(F);
       for (auto edge : pdg->getEdges()) {
         assert(!edge->isLoopCarriedDependence() && "Flag was already set");
       }
@@ -132,15 +156,35 @@ PDG *PDGAnalysis::getFunctionPDG(Function &F) {
           assert(!edge->isLoopCarriedDependence() && "Flag was already set");
         }
       } else {
-        pdg = constructFunctionDGFromAnalysis(F);
+
+        /*
+         * Reuse the dependences cached on disk if the function and its
+         * callees did not change.
+         */
+        if (this->cache != nullptr) {
+          pdg = this->cache->fetchFunctionDG(F);
+        }
+        if (pdg == nullptr) {
+          pdg = constructFunctionDGFromAnalysis(F);
+
+          /*
+           * Coarse dependences are not cached, so they are computed precisely
+           * again when the budget allows it.
+           */
+          if (true && (this->cache != nullptr)
+              && (!this->hasCoarseMemoryDependences(F))) {
+            this->cache->storeFunctionDG(F, pdg);
+          }
+        }
         for (auto edge : pdg->getEdges()) {
           assert(!edge->isLoopCarriedDependence() && "Flag was already set");
         }
       }
-      this->functionToFDGMap.insert(std::make_pair(&F, pdg));
+      this->cacheFunctionDG(F, pdg);
 
     } else {
       pdg = this->functionToFDGMap.at(&F);
+      this->touchFunctionDG(F);
       for (auto edge : pdg->getEdges()) {
         assert(!edge->isLoopCarriedDependence() && "Flag was already set");
       }
@@ -154,7 +198,7 @@ PDG *PDGAnalysis::getFunctionPDG(Function &F) {
     this->printer.printGraphsForFunction(
         F,
         pdg,
-        getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo());
+        this->getLoopInfo(F));
   }
 
   return pdg;
@@ -227,6 +271,15 @@ bool PDGAnalysis::hasPDGAsMetadata(Module &M) {
   if (auto n = M.getNamedMetadata("noelle.module.pdg")) {
     if (auto m = dyn_cast<MDNode>(n->getOperand(0))) {
       if (cast<MDString>(m->getOperand(0))->getString() == "true") {
+
+        /*
+         * The binary encoding is usable only if the module did not change
+         * since the PDG has been embedded.
+         */
+        auto embeddedPDG = this->fetchEmbeddedPDG(M);
+        if (true && (embeddedPDG != nullptr) && (!embeddedPDG->isValid())) {
+          return false;
+        }
         return true;
       }
     }
@@ -242,11 +295,22 @@ PDG *PDGAnalysis::constructPDGFromAnalysis(Module &M) {
 
   auto pdg = new PDG(M);
 
-  constructEdgesFromUseDefs(pdg);
-  constructEdgesFromAliases(pdg, M);
-  constructEdgesFromControl(pdg, M);
-
-  trimDGUsingCustomAliasAnalysis(pdg);
+  {
+    PhaseTimer timer("pdg-use-defs", "PDG use-def edges");
+    constructEdgesFromUseDefs(pdg);
+  }
+  {
+    PhaseTimer timer("pdg-memory", "PDG memory edges");
+    constructEdgesFromAliases(pdg, M);
+  }
+  {
+    PhaseTimer timer("pdg-control", "PDG control edges");
+    constructEdgesFromControl(pdg, M);
+  }
+  {
+    PhaseTimer timer("pdg-trim", "PDG trimming");
+    trimDGUsingCustomAliasAnalysis(pdg);
+  }
 
   return pdg;
 }
@@ -257,9 +321,18 @@ PDG *PDGAnalysis::constructFunctionDGFromAnalysis(Function &F) {
   }
 
   auto pdg = new PDG(F);
-  constructEdgesFromUseDefs(pdg);
-  constructEdgesFromAliasesForFunction(pdg, F);
-  constructEdgesFromControlForFunction(pdg, F);
+  {
+    PhaseTimer timer("pdg-use-defs", "PDG use-def edges");
+    constructEdgesFromUseDefs(pdg);
+  }
+  {
+    PhaseTimer timer("pdg-memory", "PDG memory edges");
+    constructEdgesFromAliasesForFunction(pdg, F);
+  }
+  {
+    PhaseTimer timer("pdg-control", "PDG control edges");
+    constructEdgesFromControlForFunction(pdg, F);
+  }
 
   return pdg;
 }
@@ -268,6 +341,7 @@ PDG *PDGAnalysis::constructPDGFromMetadata(Module &M) {
   if (verbose >= PDGVerbosity::Maximal) {
     errs() << "PDGAnalysis: Construct PDG from Metadata\n";
   }
+  PhaseTimer timer("pdg-decoding", "PDG decoding from metadata");
 
   /*
    * Create the PDG.
@@ -276,7 +350,16 @@ PDG *PDGAnalysis::constructPDGFromMetadata(Module &M) {
 
   /*
    * Fill up the PDG.
+   *
+   * Check if the PDG has been embedded with the binary encoding.
    */
+  if (auto embeddedPDG = this->fetchEmbeddedPDG(M)) {
+    assert(embeddedPDG->isValid());
+    for (auto &F : M) {
+      embeddedPDG->decodeFunction(F, pdg);
+    }
+    return pdg;
+  }
   std::unordered_map<MDNode *, Value *> IDNodeMap;
   for (auto &F : M) {
     constructNodesFromMetadata(pdg, F, IDNodeMap);
@@ -290,8 +373,19 @@ PDG *PDGAnalysis::constructFunctionDGFromMetadata(Function &F) {
   if (verbose >= PDGVerbosity::Maximal) {
     errs() << "PDGAnalysis: Construct function DG from Metadata\n";
   }
+  PhaseTimer timer("pdg-decoding", "PDG decoding from metadata");
 
   auto pdg = new PDG(F);
+
+  /*
+   * Check if the PDG has been embedded with the binary encoding.
+   * Only the dependences of @F are decoded.
+   */
+  if (auto embeddedPDG = this->fetchEmbeddedPDG(*F.getParent())) {
+    assert(embeddedPDG->isValid());
+    embeddedPDG->decodeFunction(F, pdg);
+    return pdg;
+  }
   std::unordered_map<MDNode *, Value *> IDNodeMap;
   constructNodesFromMetadata(pdg, F, IDNodeMap);
   constructEdgesFromMetadata(pdg, F, IDNodeMap);
@@ -406,78 +500,16 @@ DGEdge<Value> *PDGAnalysis::constructEdgeFromMetadata(
   return edge;
 }
 
-MDNode *PDGAnalysis::getEdgeMetadata(
-    DGEdge<Value> *edge,
-    LLVMContext &C,
-    unordered_map<Value *, MDNode *> &nodeIDMap) {
-  assert(edge != nullptr);
-  Metadata *edgeM[] = {
-    nodeIDMap[edge->getOutgoingT()],
-    nodeIDMap[edge->getIncomingT()],
-    MDNode::get(
-        C,
-        MDString::get(C, edge->isMemoryDependence() ? "true" : "false")),
-    MDNode::get(C,
-                MDString::get(C, edge->isMustDependence() ? "true" : "false")),
-    MDNode::get(C, MDString::get(C, edge->dataDepToString())),
-    MDNode::get(
-        C,
-        MDString::get(C, edge->isControlDependence() ? "true" : "false")),
-    MDNode::get(
-        C,
-        MDString::get(C, edge->isLoopCarriedDependence() ? "true" : "false")),
-    MDNode::get(
-        C,
-        MDString::get(C, edge->isRemovableDependence() ? "true" : "false")),
-    getSubEdgesMetadata(edge, C, nodeIDMap)
-  };
-
-  return MDNode::get(C, edgeM);
-}
-
-MDNode *PDGAnalysis::getSubEdgesMetadata(
-    DGEdge<Value> *edge,
-    LLVMContext &C,
-    unordered_map<Value *, MDNode *> &nodeIDMap) {
-  vector<Metadata *> subEdgesVec;
-
-  for (auto &subEdge : edge->getSubEdges()) {
-    Metadata *subEdgeM[] = {
-      nodeIDMap[subEdge->getOutgoingT()],
-      nodeIDMap[subEdge->getIncomingT()],
-      MDNode::get(
-          C,
-          MDString::get(C, edge->isMemoryDependence() ? "true" : "false")),
-      MDNode::get(
-          C,
-          MDString::get(C, edge->isMustDependence() ? "true" : "false")),
-      MDNode::get(C, MDString::get(C, edge->dataDepToString())),
-      MDNode::get(
-          C,
-          MDString::get(C, edge->isControlDependence() ? "true" : "false")),
-      MDNode::get(
-          C,
-          MDString::get(C, edge->isLoopCarriedDependence() ? "true" : "false")),
-      MDNode::get(
-          C,
-          MDString::get(C, edge->isRemovableDependence() ? "true" : "false")),
-    };
-    subEdgesVec.push_back(MDNode::get(C, subEdgeM));
-  }
-
-  return MDTuple::get(C, subEdgesVec);
-}
-
 void PDGAnalysis::trimDGUsingCustomAliasAnalysis(PDG *pdg) {
 
   /*
    * Fetch AllocAA
    */
   collectCGUnderFunctionMain(*this->M);
-  this->allocAA = &getAnalysis<AllocAA>();
   if (this->disableAllocAA) {
     return;
   }
+  this->allocAA = &getAnalysis<AllocAA>();
 
   /*
    * Invoke AllocAA
@@ -495,7 +527,7 @@ void PDGAnalysis::trimDGUsingCustomAliasAnalysis(PDG *pdg) {
 
 void PDGAnalysis::collectCGUnderFunctionMain(Module &M) {
   auto main = M.getFunction("main");
-  auto &callGraph = getAnalysis<CallGraphWrapperPass>().getCallGraph();
+  auto &callGraph = this->getLLVMCallGraph();
   std::queue<Function *> funcToTraverse;
   std::set<Function *> reached;
   funcToTraverse.push(main);
@@ -562,20 +594,33 @@ void PDGAnalysis::constructEdgesFromAliases(PDG *pdg, Module &M) {
   /*
    * Use alias analysis on stores, loads, and function calls to construct PDG
    * edges
+   *
+   * The reachable analyses of the functions run in parallel. The alias
+   * analyses are queried and the edges are added to the PDG by this thread
+   * following the order of the functions in the module, which keeps the PDG
+   * identical to the one built sequentially.
    */
+  std::unordered_map<Function *, DataFlowResult *> reachabilities;
   for (auto &F : M) {
-
-    /*
-     * Check if the function has a body.
-     */
-    if (F.empty())
-      continue;
-
-    /*
-     * Add the edges to the PDG.
-     */
-    constructEdgesFromAliasesForFunction(pdg, F);
+    reachabilities[&F] = nullptr;
+  }
+  if (this->analyzeOnlyHotCode) {
+    this->identifyHotFunctions(M);
   }
+  this->iterateOverFunctionsInParallel(
+      M,
+      [this, &reachabilities](Function &F) {
+        reachabilities.at(&F) = this->computeReachableMemoryInstructions(F);
+      },
+      [this, pdg, &reachabilities](Function &F) {
+        auto dfr = reachabilities.at(&F);
+        if (this->isAnalyzedPrecisely(F)) {
+          this->constructEdgesFromAliasesForFunction(pdg, F, dfr);
+        } else {
+          this->constructConservativeMemoryEdgesForFunction(pdg, F, dfr);
+        }
+        delete dfr;
+      });
 
   return;
 }
@@ -583,12 +628,35 @@ void PDGAnalysis::constructEdgesFromAliases(PDG *pdg, Module &M) {
 void PDGAnalysis::constructEdgesFromAliasesForFunction(PDG *pdg, Function &F) {
 
   /*
-   * Fetch the alias analysis.
+   * Run the reachable analysis.
+   */
+  auto dfr = this->computeReachableMemoryInstructions(F);
+
+  /*
+   * Add the edges to the PDG.
+   * Cold functions do not query the alias analyses when only the hot code is
+   * analyzed precisely.
+   */
+  if (this->isAnalyzedPrecisely(F)) {
+    this->constructEdgesFromAliasesForFunction(pdg, F, dfr);
+  } else {
+    this->constructConservativeMemoryEdgesForFunction(pdg, F, dfr);
+  }
+
+  /*
+   * Free the memory.
    */
-  auto &AA = getAnalysis<AAResultsWrapperPass>(F).getAAResults();
+  delete dfr;
+
+  return;
+}
+
+DataFlowResult *PDGAnalysis::computeReachableMemoryInstructions(Function &F) {
 
   /*
    * Run the reachable analysis.
+   * This function only reads the IR of @F, so it can run for different
+   * functions in parallel.
    */
   auto onlyMemoryInstructionFilter = [](Instruction *i) -> bool {
     if (isa<LoadInst>(i)) {
@@ -607,8 +675,46 @@ void PDGAnalysis::constructEdgesFromAliasesForFunction(PDG *pdg, Function &F) {
           ? this->dfa.getFullSets(&F)
           : this->dfa.runReachableAnalysis(&F, onlyMemoryInstructionFilter);
 
+  return dfr;
+}
+
+void PDGAnalysis::constructEdgesFromAliasesForFunction(PDG *pdg,
+                                                       Function &F,
+                                                       DataFlowResult *dfr) {
+
+  /*
+   * Check if the alias queries needed fit the budget of the function.
+   */
+  this->coarseFunctions.erase(&F);
+  if (true && (this->functionQueryBudget > 0)
+      && (this->countAliasQueries(F, dfr) > this->functionQueryBudget)) {
+    this->constructCoarseMemoryEdgesForFunction(pdg, F, dfr);
+    return;
+  }
+
+  /*
+   * Fetch the alias analysis.
+   */
+  auto &AA = this->getAAResults(F);
+
+  /*
+   * Identify the memory dependences.
+   * The dependences found so far are replaced by the coarse ones if the time
+   * budget of the function runs out.
+   */
+  auto start = std::chrono::steady_clock::now();
   for (auto &B : F) {
     for (auto &I : B) {
+      if (this->functionTimeBudget > 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+        if ((uint64_t)elapsed > this->functionTimeBudget) {
+          this->removeMemoryEdgesOfFunction(pdg, F);
+          this->constructCoarseMemoryEdgesForFunction(pdg, F, dfr);
+          return;
+        }
+      }
       if (auto store = dyn_cast<StoreInst>(&I)) {
         iterateInstForStore(pdg, F, AA, dfr, store);
       } else if (auto load = dyn_cast<LoadInst>(&I)) {
@@ -619,10 +725,7 @@ void PDGAnalysis::constructEdgesFromAliasesForFunction(PDG *pdg, Function &F) {
     }
   }
 
-  /*
-   * Free the memory.
-   */
-  delete dfr;
+  return;
 }
 
 void PDGAnalysis::iterateInstForCall(PDG *pdg,
@@ -687,25 +790,41 @@ void PDGAnalysis::removeEdgesNotUsedByParSchemes(PDG *pdg) {
    * Collect the edges in the PDG that can be safely removed.
    */
   for (auto edge : pdg->getEdges()) {
+    if (this->isEdgeNotUsedByParSchemes(edge)) {
+      removeEdges.insert(edge);
+    }
+  }
 
-    /*
-     * Fetch the source of the dependence.
-     */
-    auto source = edge->getOutgoingT();
-    if (!isa<Instruction>(source))
-      continue;
+  /*
+   * Remove the tagged edges.
+   */
+  for (auto edge : removeEdges) {
+    pdg->removeEdge(edge);
+  }
 
-    /*
-     * Check if the function of the dependence destiation cannot be reached from
-     * main.
-     */
-    auto F = cast<Instruction>(source)->getFunction();
-    if (CGUnderMain.find(F) == CGUnderMain.end())
-      continue;
+  /*
+   * The order of the basic blocks is only valid until the code changes.
+   */
+  this->intraIterationOrders.clear();
 
-    if (false || edgeIsNotLoopCarriedMemoryDependency(edge)
-        || edgeIsAlongNonMemoryWritingFunctions(edge)) {
-      removeEdges.insert(edge);
+  return;
+}
+
+void PDGAnalysis::removeEdgesNotUsedByParSchemes(PDG *pdg, Function &F) {
+  std::set<DGEdge<Value> *> removeEdges;
+
+  /*
+   * Collect the edges that start from an instruction of @F and that can be
+   * safely removed.
+   */
+  for (auto &I : instructions(F)) {
+    if (!pdg->isInGraph(&I)) {
+      continue;
+    }
+    for (auto edge : pdg->fetchNode(&I)->getOutgoingEdges()) {
+      if (this->isEdgeNotUsedByParSchemes(edge)) {
+        removeEdges.insert(edge);
+      }
     }
   }
 
@@ -715,10 +834,32 @@ void PDGAnalysis::removeEdgesNotUsedByParSchemes(PDG *pdg) {
   for (auto edge : removeEdges) {
     pdg->removeEdge(edge);
   }
+  this->intraIterationOrders.erase(&F);
 
   return;
 }
 
+bool PDGAnalysis::isEdgeNotUsedByParSchemes(DGEdge<Value> *edge) {
+
+  /*
+   * Fetch the source of the dependence.
+   */
+  auto source = edge->getOutgoingT();
+  if (!isa<Instruction>(source))
+    return false;
+
+  /*
+   * Check if the function of the dependence destiation cannot be reached from
+   * main.
+   */
+  auto F = cast<Instruction>(source)->getFunction();
+  if (CGUnderMain.find(F) == CGUnderMain.end())
+    return false;
+
+  return (false || edgeIsNotLoopCarriedMemoryDependency(edge)
+          || edgeIsAlongNonMemoryWritingFunctions(edge));
+}
+
 // NOTE: Loads between random parts of separate GVs and both edges between GVs
 // should be removed
 bool PDGAnalysis::edgeIsNotLoopCarriedMemoryDependency(DGEdge<Value> *edge) {
@@ -863,14 +1004,8 @@ bool PDGAnalysis::isMemoryAccessIntoDifferentArrays(DGEdge<Value> *edge) {
 
 bool PDGAnalysis::canPrecedeInCurrentIteration(Instruction *from,
                                                Instruction *to) {
-  auto &LI =
-      getAnalysis<LoopInfoWrapperPass>(*from->getFunction()).getLoopInfo();
   BasicBlock *fromBB = from->getParent();
   BasicBlock *toBB = to->getParent();
-  auto loop = LI.getLoopFor(fromBB);
-  BasicBlock *headerBB = nullptr;
-  if (loop)
-    headerBB = loop->getHeader();
 
   if (fromBB == toBB) {
     for (auto &I : *fromBB) {
@@ -880,31 +1015,71 @@ bool PDGAnalysis::canPrecedeInCurrentIteration(Instruction *from,
         return false;
     }
   }
+  if (fromBB->getParent() != toBB->getParent()) {
+    return false;
+  }
 
-  std::queue<BasicBlock *> bbToTraverse;
-  std::set<BasicBlock *> bbReached;
-  auto traverseOn = [&](BasicBlock *bb) -> void {
-    bbToTraverse.push(bb);
-    bbReached.insert(bb);
-  };
-  traverseOn(toBB);
+  /*
+   * Fetch the blocks that reach the destination within the current iteration
+   * of the loop of the source.
+   */
+  auto &order = this->getIntraIterationOrder(*from->getFunction());
+  auto headerBB = order.headers.at(fromBB);
+  auto key = std::make_pair(headerBB, toBB);
+  auto reachingBlocksIt = order.reachingBlocks.find(key);
+  if (reachingBlocksIt == order.reachingBlocks.end()) {
 
-  while (!bbToTraverse.empty()) {
-    auto bb = bbToTraverse.front();
-    bbToTraverse.pop();
-    if (bb == fromBB)
-      return true;
-    if (bb == headerBB)
-      continue;
+    /*
+     * Traverse the predecessors of the destination without going through the
+     * header.
+     */
+    BitVector reached(order.blockIDs.size());
+    std::queue<BasicBlock *> bbToTraverse;
+    auto traverseOn = [&](BasicBlock *bb) -> void {
+      bbToTraverse.push(bb);
+      reached.set(order.blockIDs.at(bb));
+    };
+    traverseOn(toBB);
+    while (!bbToTraverse.empty()) {
+      auto bb = bbToTraverse.front();
+      bbToTraverse.pop();
+      if (bb == headerBB)
+        continue;
 
-    for (auto predBB : make_range(pred_begin(bb), pred_end(bb))) {
-      if (bbReached.find(predBB) == bbReached.end()) {
-        traverseOn(predBB);
+      for (auto predBB : make_range(pred_begin(bb), pred_end(bb))) {
+        if (!reached.test(order.blockIDs.at(predBB))) {
+          traverseOn(predBB);
+        }
       }
     }
+    reachingBlocksIt =
+        order.reachingBlocks.insert(std::make_pair(key, std::move(reached)))
+            .first;
   }
 
-  return false;
+  return reachingBlocksIt->second.test(order.blockIDs.at(fromBB));
+}
+
+PDGAnalysis::IntraIterationOrder &PDGAnalysis::getIntraIterationOrder(
+    Function &F) {
+  auto orderIt = this->intraIterationOrders.find(&F);
+  if (orderIt != this->intraIterationOrders.end()) {
+    return orderIt->second;
+  }
+
+  /*
+   * Index the basic blocks and fetch the header of their innermost loop.
+   */
+  auto &order = this->intraIterationOrders[&F];
+  auto &LI = this->getLoopInfo(F);
+  for (auto &bb : F) {
+    auto id = order.blockIDs.size();
+    order.blockIDs[&bb] = id;
+    auto loop = LI.getLoopFor(&bb);
+    order.headers[&bb] = (loop != nullptr) ? loop->getHeader() : nullptr;
+  }
+
+  return order;
 }
 
 bool PDGAnalysis::edgeIsAlongNonMemoryWritingFunctions(DGEdge<Value> *edge) {
@@ -1005,6 +1180,9 @@ bool PDGAnalysis::isTheLibraryFunctionPure(Function *libraryFunction) {
           libraryFunction->getName())) {
     return true;
   }
+  if (LibraryFunctions::isPure(libraryFunction->getName())) {
+    return true;
+  }
   return false;
 }
 
@@ -1013,18 +1191,44 @@ bool PDGAnalysis::isTheLibraryFunctionThreadSafe(Function *libraryFunction) {
           libraryFunction->getName())) {
     return true;
   }
+  if (LibraryFunctions::isThreadSafe(libraryFunction->getName())) {
+    return true;
+  }
   return false;
 }
 
+bool PDGAnalysis::isTheLibraryFunctionCommutative(Function *libraryFunction) {
+  return LibraryFunctions::isCommutative(libraryFunction->getName());
+}
+
+bool PDGAnalysis::isTheLibraryFunctionAStreamWriter(Function *libraryFunction) {
+  return PDGAnalysis::externalStreamWriterFunctions.count(
+      libraryFunction->getName());
+}
+
+LoopCarriedDependenceProfiles *PDGAnalysis::
+    getLoopCarriedDependenceProfiles(void) {
+  if (this->dependenceProfiles == nullptr) {
+    this->dependenceProfiles = new LoopCarriedDependenceProfiles(*this->M);
+  }
+
+  return this->dependenceProfiles;
+}
+
 PDGAnalysis::~PDGAnalysis() {
+  if (this->memoryBudget > 0) {
+    this->printFunctionDGCacheStatistics();
+  }
+  if (this->cache != nullptr) {
+    this->cache->save();
+    delete this->cache;
+  }
+  delete this->embeddedPDG;
+  delete this->dependenceProfiles;
   if (this->programDependenceGraph)
     delete this->programDependenceGraph;
 
-  for (auto functionFDGPair : this->functionToFDGMap) {
-    auto fdg = functionFDGPair.second;
-    delete fdg;
-  }
-  this->functionToFDGMap.clear();
+  this->forgetFunctionDGs();
 }
 
 // http://www.cplusplus.com/reference/clibrary/ and
@@ -1153,4 +1357,17 @@ const StringSet<> PDGAnalysis::externalThreadSafeFunctions{
 
 };
 
+const StringSet<> PDGAnalysis::externalStreamWriterFunctions{
+
+  "printf",
+  "fprintf",
+  "puts",
+  "putchar",
+  "fputs",
+  "fputc",
+  "putc",
+  "fwrite"
+
+};
+
 } // namespace llvm::noelle
@@ -0,0 +1,240 @@
+/*
+ * Copyright 2016 - 2020  Angelo Matni, Yian Su, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Config/llvm-config.h"
+
+#include "noelle/core/PDGAnalysisNPM.hpp"
+#include "IntegrationWithSVF.hpp"
+
+namespace llvm::noelle {
+
+AnalysisKey PDGAnalysisNPM::Key;
+
+AnalysisKey FunctionPDGAnalysisNPM::Key;
+
+PDGAnalysisNPM::Result::Result(std::unique_ptr<PDGAnalysis> pdgAnalysis,
+                               Module &M)
+  : pdgAnalysis{ std::move(pdgAnalysis) },
+    module{ &M } {
+  return;
+}
+
+PDGAnalysisNPM::Result::~Result() {
+
+  /*
+   * Only the result that owns the PDG stores the answers of SVF that have
+   * been computed while it has been used.
+   */
+  if (this->pdgAnalysis != nullptr) {
+    NoelleSVFIntegration::finalizeForModule(*this->module);
+  }
+
+  return;
+}
+
+PDGAnalysis &PDGAnalysisNPM::Result::getPDGAnalysis(void) {
+  return *this->pdgAnalysis;
+}
+
+PDG *PDGAnalysisNPM::Result::getPDG(void) {
+  return this->pdgAnalysis->getPDG();
+}
+
+bool PDGAnalysisNPM::Result::invalidate(
+    Module &M,
+    const PreservedAnalyses &PA,
+    ModuleAnalysisManager::Invalidator &Inv) {
+  auto checker = PA.getChecker<PDGAnalysisNPM>();
+  if (false || checker.preserved()
+      || checker.preservedSet<AllAnalysesOn<Module>>()) {
+    return false;
+  }
+
+  return true;
+}
+
+PDGAnalysisNPM::Result PDGAnalysisNPM::run(Module &M,
+                                           ModuleAnalysisManager &MAM) {
+
+  /*
+   * Fetch the analysis managers of the analyses the PDG is computed from.
+   */
+  auto &FAM = MAM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+
+  /*
+   * Redirect the analyses of LLVM used by the PDG to the new pass manager.
+   * The function analyses are fetched when they are needed, so they are
+   * recomputed if a pass invalidated them since the PDG has been computed.
+   */
+  auto pdgAnalysis = std::make_unique<PDGAnalysis>();
+  pdgAnalysis->loopInfoProvider = [&FAM](Function &F) -> LoopInfo & {
+    return FAM.getResult<LoopAnalysis>(F);
+  };
+  pdgAnalysis->aliasAnalysisProvider = [&FAM](Function &F) -> AAResults & {
+    return FAM.getResult<AAManager>(F);
+  };
+  pdgAnalysis->blockFrequencyProvider =
+      [&FAM](Function &F) -> BlockFrequencyInfo & {
+    return FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+  auto module = &M;
+  auto moduleManager = &MAM;
+  pdgAnalysis->callGraphProvider = [module,
+                                    moduleManager]() -> llvm::CallGraph & {
+    return moduleManager->getResult<CallGraphAnalysis>(*module);
+  };
+
+  /*
+   * Prepare SVF for the module.
+   * The legacy pass manager does it by running NoelleSVFIntegration before the
+   * PDG; here no legacy pass runs, so the PDG must do it.
+   */
+  NoelleSVFIntegration::initializeForModule(M);
+
+  /*
+   * Compute the PDG.
+   * AllocAA is a legacy pass, so it cannot be fetched here.
+   */
+  pdgAnalysis->doInitialization(M);
+  pdgAnalysis->disableAllocAA = true;
+  pdgAnalysis->runOnModule(M);
+
+  return Result(std::move(pdgAnalysis), M);
+}
+
+FunctionPDGAnalysisNPM::Result::Result(PDGAnalysis &pdgAnalysis, Function &F)
+  : pdgAnalysis{ &pdgAnalysis },
+    function{ &F } {
+  return;
+}
+
+PDG *FunctionPDGAnalysisNPM::Result::getFunctionPDG(void) {
+  return this->pdgAnalysis->getFunctionPDG(*this->function);
+}
+
+bool FunctionPDGAnalysisNPM::Result::invalidate(
+    Function &F,
+    const PreservedAnalyses &PA,
+    FunctionAnalysisManager::Invalidator &Inv) {
+  auto checker = PA.getChecker<FunctionPDGAnalysisNPM>();
+  if (false || checker.preserved()
+      || checker.preservedSet<AllAnalysesOn<Function>>()) {
+    return false;
+  }
+
+  return true;
+}
+
+FunctionPDGAnalysisNPM::Result FunctionPDGAnalysisNPM::run(
+    Function &F,
+    FunctionAnalysisManager &FAM) {
+
+  /*
+   * Fetch the PDG of the module.
+   * Function analyses cannot compute module analyses, so the PDG must have
+   * been computed already.
+   */
+  auto &proxy = FAM.getResult<ModuleAnalysisManagerFunctionProxy>(F);
+  auto module = F.getParent();
+  auto pdgResult = proxy.getCachedResult<PDGAnalysisNPM>(*module);
+  if (pdgResult == nullptr) {
+    report_fatal_error("FunctionPDGAnalysisNPM: the PDG of the module must "
+                       "be computed before (e.g., by require<noelle-pdg>)");
+  }
+
+  /*
+   * The dependence graph of the function belongs to the PDG of the module.
+   * Hence, it must be invalidated when the PDG of the module is.
+   */
+  proxy.registerOuterAnalysisInvalidation<PDGAnalysisNPM,
+                                          FunctionPDGAnalysisNPM>();
+
+  return Result(pdgResult->getPDGAnalysis(), F);
+}
+
+PDGPrinterPassNPM::PDGPrinterPassNPM(raw_ostream &OS) : OS{ OS } {
+  return;
+}
+
+PreservedAnalyses PDGPrinterPassNPM::run(Module &M,
+                                         ModuleAnalysisManager &MAM) {
+  auto pdg = MAM.getResult<PDGAnalysisNPM>(M).getPDG();
+  this->OS << "PDG of " << M.getName() << ": " << pdg->numNodes()
+           << " nodes, " << pdg->numEdges() << " edges\n";
+
+  return PreservedAnalyses::all();
+}
+
+} // namespace llvm::noelle
+
+using namespace llvm;
+using namespace llvm::noelle;
+
+// Next there is code to register the analyses to the new pass manager of
+// "opt" (-load-pass-plugin)
+extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
+  auto registerCallbacks = [](PassBuilder &PB) {
+    PB.registerAnalysisRegistrationCallback(
+        [](ModuleAnalysisManager &MAM) {
+          MAM.registerPass([] { return PDGAnalysisNPM(); });
+        });
+    PB.registerAnalysisRegistrationCallback(
+        [](FunctionAnalysisManager &FAM) {
+          FAM.registerPass([] { return FunctionPDGAnalysisNPM(); });
+        });
+    PB.registerPipelineParsingCallback(
+        [](StringRef name,
+           ModulePassManager &MPM,
+           ArrayRef<PassBuilder::PipelineElement>) {
+          if (name == "require<noelle-pdg>") {
+            MPM.addPass(RequireAnalysisPass<PDGAnalysisNPM, Module>());
+            return true;
+          }
+          if (name == "invalidate<noelle-pdg>") {
+            MPM.addPass(InvalidateAnalysisPass<PDGAnalysisNPM>());
+            return true;
+          }
+          if (name == "print<noelle-pdg>") {
+            MPM.addPass(PDGPrinterPassNPM(errs()));
+            return true;
+          }
+          return false;
+        });
+    PB.registerPipelineParsingCallback(
+        [](StringRef name,
+           FunctionPassManager &FPM,
+           ArrayRef<PassBuilder::PipelineElement>) {
+          if (name == "require<noelle-function-pdg>") {
+            FPM.addPass(
+                RequireAnalysisPass<FunctionPDGAnalysisNPM, Function>());
+            return true;
+          }
+          return false;
+        });
+  };
+
+  return { LLVM_PLUGIN_API_VERSION,
+           "PDGAnalysis",
+           LLVM_VERSION_STRING,
+           registerCallbacks };
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+#include "noelle/core/Utils.hpp"
+
+namespace llvm::noelle {
+
+bool PDGAnalysis::hasCoarseMemoryDependences(Function &F) const {
+  if (this->coarseFunctions.find(&F) != this->coarseFunctions.end()) {
+    return true;
+  }
+
+  /*
+   * Check the tag of the function added when the PDG has been embedded.
+   */
+  return F.hasMetadata("noelle.pdg.coarse");
+}
+
+uint64_t PDGAnalysis::countAliasQueries(Function &F, DataFlowResult *dfr) {
+
+  /*
+   * Each memory instruction is queried against each memory instruction it
+   * can reach.
+   */
+  uint64_t queries = 0;
+  for (auto &I : instructions(F)) {
+    if (!isa<LoadInst>(&I) && !isa<StoreInst>(&I) && !isa<CallBase>(&I)) {
+      continue;
+    }
+    queries += dfr->OUT(&I).size();
+  }
+
+  return queries;
+}
+
+void PDGAnalysis::removeMemoryEdgesOfFunction(PDG *pdg, Function &F) {
+  std::unordered_set<DGEdge<Value> *> edgesToRemove;
+  for (auto &I : instructions(F)) {
+    if (!pdg->isInGraph(&I)) {
+      continue;
+    }
+    for (auto edge : pdg->fetchNode(&I)->getOutgoingEdges()) {
+      auto dst = dyn_cast<Instruction>(edge->getIncomingT());
+      if (true && edge->isMemoryDependence() && (dst != nullptr)
+          && (dst->getFunction() == &F)) {
+        edgesToRemove.insert(edge);
+      }
+    }
+  }
+  for (auto edge : edgesToRemove) {
+    pdg->removeEdge(edge);
+  }
+
+  return;
+}
+
+Value *PDGAnalysis::getCoarseMemoryObject(Instruction *I,
+                                          bool &isPrimitiveArray) {
+  isPrimitiveArray = false;
+
+  /*
+   * Fetch the pointer accessed.
+   * Calls can access any object.
+   */
+  Value *pointer = nullptr;
+  if (auto load = dyn_cast<LoadInst>(I)) {
+    pointer = load->getPointerOperand();
+  } else if (auto store = dyn_cast<StoreInst>(I)) {
+    pointer = store->getPointerOperand();
+  } else {
+    return nullptr;
+  }
+
+  /*
+   * Identified objects (e.g., stack and global variables) cannot alias each
+   * other.
+   */
+  auto &DL = I->getModule()->getDataLayout();
+  auto object = GetUnderlyingObject(pointer, DL);
+  if (isIdentifiedObject(object)) {
+    return object;
+  }
+
+  /*
+   * Check if AllocAA knows the array accessed (e.g., an array allocated
+   * dynamically and only reachable from a global variable).
+   * Such arrays cannot alias each other.
+   */
+  if (this->allocAA != nullptr) {
+    auto array = this->allocAA->getPrimitiveArrayAccess(I).first;
+    if (array != nullptr) {
+      isPrimitiveArray = true;
+      return array;
+    }
+  }
+
+  return nullptr;
+}
+
+void PDGAnalysis::constructCoarseMemoryEdgesForFunction(PDG *pdg,
+                                                        Function &F,
+                                                        DataFlowResult *dfr) {
+  if (this->verbose >= PDGVerbosity::Minimal) {
+    errs() << "PDGAnalysis: the memory dependences of " << F.getName()
+           << " are coarse because they exceed the budget of a function\n";
+  }
+  this->coarseFunctions.insert(&F);
+
+  /*
+   * Group the memory instructions by the object they access.
+   */
+  std::unordered_map<Instruction *, std::pair<Value *, bool>> objects;
+  for (auto &I : instructions(F)) {
+    if (isa<LoadInst>(&I) || isa<StoreInst>(&I)) {
+      bool isPrimitiveArray;
+      auto object = this->getCoarseMemoryObject(&I, isPrimitiveArray);
+      objects[&I] = std::make_pair(object, isPrimitiveArray);
+    }
+  }
+
+  /*
+   * Add a may dependence between every pair of memory instructions of @F that
+   * can reach each other, unless both of them can only read memory or they
+   * access objects known to be different.
+   */
+  for (auto &I : instructions(F)) {
+    if (!isa<LoadInst>(&I) && !isa<StoreInst>(&I) && !isa<CallBase>(&I)) {
+      continue;
+    }
+    if (auto call = dyn_cast<CallBase>(&I)) {
+      if (!Utils::isActualCode(call)) {
+        continue;
+      }
+    }
+    auto iReads = I.mayReadFromMemory();
+    auto iWrites = I.mayWriteToMemory();
+    if (!iReads && !iWrites) {
+      continue;
+    }
+    auto iObject = objects.find(&I);
+    for (auto value : dfr->OUT(&I)) {
+      auto J = dyn_cast<Instruction>(value);
+      if (false || (J == nullptr) || (J == &I)) {
+        continue;
+      }
+      if (auto otherCall = dyn_cast<CallBase>(J)) {
+        if (!Utils::isActualCode(otherCall)) {
+          continue;
+        }
+      }
+      auto jReads = J->mayReadFromMemory();
+      auto jWrites = J->mayWriteToMemory();
+      if (!(iWrites || jWrites)) {
+        continue;
+      }
+
+      /*
+       * Check if the instructions access different objects.
+       * Objects are compared only if they have been identified the same way.
+       */
+      auto jObject = objects.find(J);
+      if (true && (iObject != objects.end()) && (jObject != objects.end())
+          && (iObject->second.first != nullptr)
+          && (jObject->second.first != nullptr)
+          && (iObject->second.second == jObject->second.second)
+          && (iObject->second.first != jObject->second.first)) {
+        continue;
+      }
+
+      /*
+       * There may be a dependence.
+       */
+      if (iWrites && jReads) {
+        pdg->addEdge(&I, J)->setMemMustType(true, false, DG_DATA_RAW);
+      }
+      if (iReads && jWrites) {
+        pdg->addEdge(&I, J)->setMemMustType(true, false, DG_DATA_WAR);
+      }
+      if (iWrites && jWrites) {
+        pdg->addEdge(&I, J)->setMemMustType(true, false, DG_DATA_WAW);
+      }
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -23,6 +23,7 @@
 #include "noelle/core/TalkDown.hpp"
 #include "noelle/core/PDGPrinter.hpp"
 #include "noelle/core/PDGAnalysis.hpp"
+#include "noelle/core/LibraryFunctions.hpp"
 #include "IntegrationWithSVF.hpp"
 
 namespace llvm::noelle {
@@ -46,6 +47,9 @@ void PDGAnalysis::identifyFunctionsThatInvokeUnhandledLibrary(Module &M) {
               F.getName())) {
         continue;
       }
+      if (LibraryFunctions::isPure(F.getName())) {
+        continue;
+      }
       this->unhandledExternalFuncs.insert(&F);
     } else {
       this->internalFuncs.insert(&F);
@@ -89,7 +93,8 @@ bool PDGAnalysis::cannotReachUnhandledExternalFunction(CallBase *call) {
 bool PDGAnalysis::isUnhandledExternalFunction(const Function *F) {
   return F->empty()
          && !this->externalFuncsHaveNoSideEffectOrHandledBySVF.count(
-             F->getName());
+             F->getName())
+         && !LibraryFunctions::isPure(F->getName());
 }
 
 bool PDGAnalysis::isInternalFunctionThatReachUnhandledExternalFunction(
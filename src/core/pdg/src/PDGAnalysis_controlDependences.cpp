@@ -30,21 +30,33 @@ using namespace llvm::noelle;
 void PDGAnalysis::constructEdgesFromControl(PDG *pdg, Module &M) {
   assert(pdg != nullptr);
 
+  /*
+   * Compute the control dependences of the functions based on their control
+   * dependence summaries.
+   *
+   * The dependences of the functions are computed in parallel, each one using
+   * the summary fetched by its task (summaries of functions whose CFG did not
+   * change are reused). They are then added to the PDG by this thread
+   * following the order of the functions in the module, which keeps the PDG
+   * identical to the one built sequentially.
+   */
+  std::unordered_map<Function *, std::vector<std::pair<Value *, Value *>>>
+      dependences;
   for (auto &F : M) {
-
-    /*
-     * Fetch the next function with a body.
-     */
-    if (F.empty()) {
-      continue;
-    }
-
-    /*
-     * Compute the control dependences of the function based on its
-     * post-dominator tree.
-     */
-    this->constructEdgesFromControlForFunction(pdg, F);
+    dependences[&F];
   }
+  this->iterateOverFunctionsInParallel(
+      M,
+      [&dependences](Function &F) {
+        auto summary = ControlDependenceSummary::fetch(F);
+        dependences.at(&F) =
+            PDGAnalysis::computeControlDependences(F, *summary);
+      },
+      [pdg, &dependences](Function &F) {
+        auto &deps = dependences.at(&F);
+        PDGAnalysis::addControlDependences(pdg, deps);
+        deps.clear();
+      });
 
   return;
 }
@@ -53,95 +65,63 @@ void PDGAnalysis::constructEdgesFromControlForFunction(PDG *pdg, Function &F) {
   assert(pdg != nullptr);
 
   /*
-   * There is a control dependence from a basic block A to a basic block B iff
-   * 1) there is E such that E is a successor of A, and
-   * 2) B post-dominates E, and
-   * 3) B doesn't strictly post-dominate A
+   * Fetch the control dependence summary of the function.
    */
+  auto summary = ControlDependenceSummary::fetch(F);
 
   /*
-   * Fetch the post-dominator tree of the function.
+   * Add the control dependences of the function.
    */
-  auto &postDomTree =
-      getAnalysis<PostDominatorTreeWrapperPass>(F).getPostDomTree();
+  auto deps = PDGAnalysis::computeControlDependences(F, *summary);
+  PDGAnalysis::addControlDependences(pdg, deps);
 
-  for (auto &B : F) {
+  return;
+}
 
-    /*
-     * Fetch the basic blocks post-dominated by the current one.
-     */
-    SmallVector<BasicBlock *, 10> dominatedBBs;
-    postDomTree.getDescendants(&B, dominatedBBs);
-
-    /*
-     * For each basic block that B post dominates, check if B doesn't stricly
-     * post dominate its predecessor If it does not, then there is a control
-     * dependency from the predecessor to B
-     */
-    for (auto dominatedBB : dominatedBBs) {
-      for (auto predBB :
-           make_range(pred_begin(dominatedBB), pred_end(dominatedBB))) {
-
-        /*
-         * Fetch the terminator of the predecessor.
-         */
-        auto controlTerminator = predBB->getTerminator();
-
-        /*
-         * Check if the predecessor terminator is a conditional branch.
-         * This is necessary to avoid adding incorrect control dependences
-         * between basic blocks of a loop that has no exit blocks. For example:
-         *
-         * predBB:
-         *  branch B
-         *
-         * B:
-         *  i
-         *  branch %B
-         *
-         * In this case, if we don't check that the terminator of predBB is a
-         * conditional branch, we would add a control dependence from branch %B
-         * to i
-         */
-        if (controlTerminator->getNumSuccessors() == 1) {
-          continue;
-        }
+void PDGAnalysis::addControlDependences(
+    PDG *pdg,
+    std::vector<std::pair<Value *, Value *>> &dependences) {
+  for (auto &dep : dependences) {
+    auto edge = pdg->addEdge(dep.first, dep.second);
+    edge->setControl(true);
+  }
+
+  return;
+}
 
-        /*
-         * Check if B strictly post-dominates predBB.
-         */
-        if (postDomTree.properlyDominates(&B, predBB)) {
+std::vector<std::pair<Value *, Value *>> PDGAnalysis::computeControlDependences(
+    Function &F,
+    const ControlDependenceSummary &summary) {
 
-          /*
-           * B strictly post-dominates predBB.
-           * Therefore, there is no control dependence from predBB to B
-           */
-          continue;
-        }
-
-        /*
-         * There is a control dependence from predBB to B
-         *
-         * Add the control dependences.
-         */
-        for (auto &I : B) {
-          auto edge = pdg->addEdge((Value *)controlTerminator, (Value *)&I);
-          edge->setControl(true);
-        }
+  /*
+   * The dependences are returned in the order they need to be added to the
+   * PDG.
+   * This function only reads the IR of @F, so it can run for different
+   * functions in parallel.
+   */
+  std::vector<std::pair<Value *, Value *>> dependences;
+  std::unordered_map<Value *, std::unordered_set<Value *>> controlProducers;
+
+  /*
+   * Add the control dependences from the terminators of the controlling basic
+   * blocks to the instructions of the controlled ones.
+   */
+  for (auto &B : F) {
+    for (auto predBB : summary.getControllingBasicBlocks(&B)) {
+      auto controlTerminator = predBB->getTerminator();
+      for (auto &I : B) {
+        dependences.push_back({ controlTerminator, &I });
+        controlProducers[&I].insert(controlTerminator);
       }
     }
   }
 
   auto getControlProducers = [&](Value *V) -> std::unordered_set<Value *> {
-    std::unordered_set<Value *> controlProducers;
-    auto node = pdg->fetchNode(V);
-    for (auto edge : node->getIncomingEdges()) {
-      if (!edge->isControlDependence())
-        continue;
-      auto controlProducer = edge->getOutgoingT();
-      controlProducers.insert(controlProducer);
+    auto it = controlProducers.find(V);
+    if (it == controlProducers.end()) {
+      return {};
     }
-    return controlProducers;
+    return it->second;
   };
 
   /*
@@ -186,11 +166,10 @@ void PDGAnalysis::constructEdgesFromControlForFunction(PDG *pdg, Function &F) {
             != currentControlProducersOnPHI.end())
           continue;
 
-        auto edge = pdg->addEdge(producer, &phi);
-        edge->setControl(true);
+        dependences.push_back({ producer, &phi });
       }
     }
   }
 
-  return;
+  return dependences;
 }
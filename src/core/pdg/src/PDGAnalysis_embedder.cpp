@@ -23,111 +23,85 @@
 #include "noelle/core/TalkDown.hpp"
 #include "noelle/core/PDGPrinter.hpp"
 #include "noelle/core/PDGAnalysis.hpp"
+#include "noelle/core/PhaseTimer.hpp"
+#include "PDGBinaryFormat.hpp"
 
 namespace llvm::noelle {
 
 void PDGAnalysis::embedPDGAsMetadata(PDG *pdg) {
   errs() << "Embed PDG as metadata\n";
+  PhaseTimer timer("pdg-embedding", "PDG embedding");
 
+  /*
+   * Encode the PDG and store it in the module as a single string.
+   */
   auto &C = this->M->getContext();
-  std::unordered_map<Value *, MDNode *> nodeIDMap;
-
-  embedNodesAsMetadata(pdg, C, nodeIDMap);
-  embedEdgesAsMetadata(pdg, C, nodeIDMap);
+  auto encoding = PDGBinaryFormat::encode(*this->M, pdg);
+  if (auto n = this->M->getNamedMetadata("noelle.module.pdg.binary")) {
+    this->M->eraseNamedMetadata(n);
+  }
+  auto binary = this->M->getOrInsertNamedMetadata("noelle.module.pdg.binary");
+  binary->addOperand(MDNode::get(C, MDString::get(C, encoding)));
 
+  /*
+   * Tag the module.
+   */
+  if (auto n = this->M->getNamedMetadata("noelle.module.pdg")) {
+    this->M->eraseNamedMetadata(n);
+  }
   auto n = this->M->getOrInsertNamedMetadata("noelle.module.pdg");
   n->addOperand(MDNode::get(C, MDString::get(C, "true")));
 
-  return;
-}
-
-void PDGAnalysis::embedNodesAsMetadata(
-    PDG *pdg,
-    LLVMContext &C,
-    unordered_map<Value *, MDNode *> &nodeIDMap) {
-  uint64_t i = 0;
-  unordered_map<Function *, unordered_map<uint64_t, Metadata *>>
-      functionArgsIDMap;
-
   /*
-   * Construct node to id map and embed metadata of instruction nodes to
-   * instruction
+   * Tag the functions whose memory dependences are coarse.
    */
-  for (auto v : pdg->getSortedValues()) {
-
-    /*
-     * Compute its ID.
-     */
-    auto id = ConstantInt::get(Type::getInt64Ty(C), i++);
-
-    /*
-     * Wrap its ID into a metadata node.
-     */
-    auto m = MDNode::get(C, ConstantAsMetadata::get(id));
-
-    /*
-     * Check if the current PDG node is an argument.
-     */
-    if (auto arg = dyn_cast<Argument>(v)) {
-
-      /*
-       * Register the current value as an argument in the metadata.
-       */
-      functionArgsIDMap[arg->getParent()][arg->getArgNo()] = m;
-
-    } else if (auto inst = dyn_cast<Instruction>(v)) {
-
-      /*
-       * Attach the ID to the instruction.
-       */
-      inst->setMetadata("noelle.pdg.inst.id", m);
+  for (auto &F : *this->M) {
+    if (this->coarseFunctions.find(&F) != this->coarseFunctions.end()) {
+      F.setMetadata("noelle.pdg.coarse",
+                    MDNode::get(C, MDString::get(C, "true")));
+    } else if (F.hasMetadata("noelle.pdg.coarse")) {
+      F.setMetadata("noelle.pdg.coarse", nullptr);
     }
-    nodeIDMap[v] = m;
   }
 
   /*
-   * Embed metadta of argument nodes to function
+   * Forget the encoding decoded before, if any.
    */
-  for (auto &funArgs : functionArgsIDMap) {
-    vector<Metadata *> argsVec;
-    for (uint64_t i = 0; i < funArgs.second.size(); i++) {
-      argsVec.push_back(funArgs.second[i]);
-    }
-
-    auto m = MDTuple::get(C, argsVec);
-    funArgs.first->setMetadata("noelle.pdg.args.id", m);
-  }
+  delete this->embeddedPDG;
+  this->embeddedPDG = nullptr;
 
   return;
 }
 
-void PDGAnalysis::embedEdgesAsMetadata(
-    PDG *pdg,
-    LLVMContext &C,
-    unordered_map<Value *, MDNode *> &nodeIDMap) {
-  std::unordered_map<Function *, vector<Metadata *>> functionEdgesMap;
+PDGBinaryFormat *PDGAnalysis::fetchEmbeddedPDG(Module &M) {
 
   /*
-   * Construct edge metadata
+   * Check if we have already decoded the header of the encoding.
    */
-  for (auto &edge : pdg->getSortedDependences()) {
-    auto edgeM = this->getEdgeMetadata(edge, C, nodeIDMap);
-    if (auto arg = dyn_cast<Argument>(edge->getOutgoingT())) {
-      functionEdgesMap[arg->getParent()].push_back(edgeM);
-    } else if (auto inst = dyn_cast<Instruction>(edge->getOutgoingT())) {
-      functionEdgesMap[inst->getFunction()].push_back(edgeM);
-    }
+  if (this->embeddedPDG != nullptr) {
+    return this->embeddedPDG;
   }
 
   /*
-   * Embed metadata of edges to function
+   * Fetch the encoding.
+   * Modules embedded by older versions of NOELLE only have the PDG as
+   * metadata attached to the instructions.
    */
-  for (auto &funEdge : functionEdgesMap) {
-    auto m = MDTuple::get(C, funEdge.second);
-    funEdge.first->setMetadata("noelle.pdg.edges", m);
+  auto n = M.getNamedMetadata("noelle.module.pdg.binary");
+  if (n == nullptr) {
+    return nullptr;
   }
+  auto m = dyn_cast<MDNode>(n->getOperand(0));
+  if (m == nullptr) {
+    return nullptr;
+  }
+  auto encoding = dyn_cast<MDString>(m->getOperand(0));
+  if (encoding == nullptr) {
+    return nullptr;
+  }
+  this->embeddedPDG = new PDGBinaryFormat(M, encoding->getString());
 
-  return;
+  return this->embeddedPDG;
 }
 
 } // namespace llvm::noelle
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+
+namespace llvm::noelle {
+
+void PDGAnalysis::cacheFunctionDG(Function &F, PDG *pdg) {
+
+  /*
+   * Cache the graph as the most recently used one.
+   */
+  this->functionDGCacheMisses++;
+  if (this->evictedFunctionDGs.erase(&F) > 0) {
+    this->functionDGRebuilds++;
+  }
+  this->functionToFDGMap[&F] = pdg;
+  this->functionDGsLRU.push_front(&F);
+  this->functionDGsLRUPositions[&F] = this->functionDGsLRU.begin();
+  auto bytes = PDGAnalysis::estimateBytesOf(pdg);
+  this->functionDGBytes[&F] = bytes;
+  this->functionDGsBytes += bytes;
+  this->functionDGsPeakBytes =
+      std::max(this->functionDGsPeakBytes, this->functionDGsBytes);
+
+  /*
+   * Evict the least recently used graphs until the cache fits the budget.
+   * The graph just cached is kept even if it does not fit on its own.
+   */
+  if (this->memoryBudget == 0) {
+    return;
+  }
+  while (true && (this->functionDGsBytes > this->memoryBudget)
+         && (this->functionDGsLRU.size() > 1)) {
+    auto victim = this->functionDGsLRU.back();
+    this->forgetFunctionDG(*victim);
+    this->evictedFunctionDGs.insert(victim);
+    this->functionDGEvictions++;
+  }
+
+  return;
+}
+
+void PDGAnalysis::touchFunctionDG(Function &F) {
+  this->functionDGCacheHits++;
+  auto position = this->functionDGsLRUPositions.at(&F);
+  this->functionDGsLRU.splice(this->functionDGsLRU.begin(),
+                              this->functionDGsLRU,
+                              position);
+
+  return;
+}
+
+void PDGAnalysis::forgetFunctionDG(Function &F) {
+  if (this->functionToFDGMap.find(&F) == this->functionToFDGMap.end()) {
+    return;
+  }
+  delete this->functionToFDGMap.at(&F);
+  this->functionToFDGMap.erase(&F);
+  this->functionDGsLRU.erase(this->functionDGsLRUPositions.at(&F));
+  this->functionDGsLRUPositions.erase(&F);
+  this->functionDGsBytes -= this->functionDGBytes.at(&F);
+  this->functionDGBytes.erase(&F);
+
+  return;
+}
+
+void PDGAnalysis::forgetFunctionDGs(void) {
+  for (auto functionFDGPair : this->functionToFDGMap) {
+    auto fdg = functionFDGPair.second;
+    delete fdg;
+  }
+  this->functionToFDGMap.clear();
+  this->functionDGsLRU.clear();
+  this->functionDGsLRUPositions.clear();
+  this->functionDGBytes.clear();
+  this->functionDGsBytes = 0;
+
+  return;
+}
+
+uint64_t PDGAnalysis::estimateBytesOf(PDG *pdg) {
+
+  /*
+   * Each node and edge is also referenced by the hash tables and the sets of
+   * the graph, which roughly cost a few pointers each.
+   */
+  const uint64_t bytesPerReference = 4 * sizeof(void *);
+  auto nodeBytes = sizeof(DGNode<Value>) + 2 * bytesPerReference;
+  auto edgeBytes = sizeof(DGEdge<Value>) + 3 * bytesPerReference;
+
+  return (pdg->numNodes() * nodeBytes) + (pdg->numEdges() * edgeBytes);
+}
+
+void PDGAnalysis::printFunctionDGCacheStatistics(void) const {
+  auto toMB = [](uint64_t bytes) -> uint64_t { return bytes >> 20; };
+  errs() << "PDGAnalysis: function DG cache with a budget of "
+         << toMB(this->memoryBudget) << " MB\n";
+  errs() << "PDGAnalysis:   Hits: " << this->functionDGCacheHits << "\n";
+  errs() << "PDGAnalysis:   Misses: " << this->functionDGCacheMisses << " ("
+         << this->functionDGRebuilds << " rebuilds of evicted DGs)\n";
+  errs() << "PDGAnalysis:   Evictions: " << this->functionDGEvictions << "\n";
+  errs() << "PDGAnalysis:   Peak: " << toMB(this->functionDGsPeakBytes)
+         << " MB\n";
+
+  return;
+}
+
+uint64_t PDGAnalysis::getNumberOfFunctionDGCacheHits(void) const {
+  return this->functionDGCacheHits;
+}
+
+uint64_t PDGAnalysis::getNumberOfFunctionDGCacheMisses(void) const {
+  return this->functionDGCacheMisses;
+}
+
+uint64_t PDGAnalysis::getNumberOfFunctionDGRebuilds(void) const {
+  return this->functionDGRebuilds;
+}
+
+uint64_t PDGAnalysis::getNumberOfFunctionDGEvictions(void) const {
+  return this->functionDGEvictions;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+#include "noelle/core/Utils.hpp"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+
+namespace llvm::noelle {
+
+void PDGAnalysis::identifyHotFunctions(Module &M) {
+
+  /*
+   * Check if the hot functions have already been identified.
+   */
+  if (this->hotFunctionsIdentified) {
+    return;
+  }
+  this->hotFunctionsIdentified = true;
+  this->hotFunctions.clear();
+
+  /*
+   * Fetch the number of times each basic block has been executed.
+   * If the module has not been profiled, then every function is hot.
+   */
+  std::unordered_map<BasicBlock *, uint64_t> invocations;
+  uint64_t programInstructions = 0;
+  auto profiled = false;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    if (!F.getEntryCount().hasValue()) {
+      continue;
+    }
+    profiled = true;
+    auto &bfi = this->getBlockFrequencyInfo(F);
+    for (auto &bb : F) {
+      auto count = bfi.getBlockProfileCount(&bb);
+      auto v = count.hasValue() ? count.getValue() : 0;
+      invocations[&bb] = v;
+      programInstructions += v * bb.size();
+    }
+  }
+  if ((!profiled) || (programInstructions == 0)) {
+    if (this->verbose >= PDGVerbosity::Minimal) {
+      errs() << "PDGAnalysis: the module has no profiles, so all functions "
+                "are analyzed precisely\n";
+    }
+    for (auto &F : M) {
+      this->hotFunctions.insert(&F);
+    }
+    return;
+  }
+
+  /*
+   * Compute the instructions executed by each function, including the ones
+   * executed by its callees.
+   * The instructions of a callee are split among its call sites based on how
+   * many times each call site invoked it.
+   * Recursive calls are ignored.
+   */
+  std::unordered_map<Function *, double> totalInstructions;
+  std::unordered_set<Function *> inProgress;
+  std::function<double(Function *)> computeTotalInstructions;
+  auto computeInstructionsOfBlock =
+      [&invocations, &computeTotalInstructions](BasicBlock *bb) -> double {
+    auto executions = invocations[bb];
+    double instructions = executions * bb->size();
+    if (executions == 0) {
+      return instructions;
+    }
+    for (auto &I : *bb) {
+      auto call = dyn_cast<CallBase>(&I);
+      if (call == nullptr) {
+        continue;
+      }
+      auto callee = call->getCalledFunction();
+      if (false || (callee == nullptr) || callee->empty()
+          || (!callee->getEntryCount().hasValue())) {
+        continue;
+      }
+      auto calleeInvocations = callee->getEntryCount()->getCount();
+      if (calleeInvocations == 0) {
+        continue;
+      }
+      auto fraction = std::min(1.0, ((double)executions) / calleeInvocations);
+      instructions += fraction * computeTotalInstructions(callee);
+    }
+    return instructions;
+  };
+  computeTotalInstructions =
+      [&totalInstructions, &inProgress, &computeInstructionsOfBlock](
+          Function *F) -> double {
+    auto found = totalInstructions.find(F);
+    if (found != totalInstructions.end()) {
+      return found->second;
+    }
+    if (inProgress.find(F) != inProgress.end()) {
+      return 0;
+    }
+    inProgress.insert(F);
+    double instructions = 0;
+    for (auto &bb : *F) {
+      instructions += computeInstructionsOfBlock(&bb);
+    }
+    inProgress.erase(F);
+    totalInstructions[F] = instructions;
+    return instructions;
+  };
+
+  /*
+   * Identify the hot loops.
+   * A function is hot if it includes a hot loop or if it can be invoked by
+   * one.
+   * Indirect calls can invoke any function whose address has been taken.
+   */
+  std::vector<Function *> worklist;
+  std::unordered_set<Function *> callees;
+  auto tagFunction = [this, &worklist, &callees](Function *F) {
+    this->hotFunctions.insert(F);
+    if (callees.insert(F).second) {
+      worklist.push_back(F);
+    }
+  };
+  auto indirectCalleesTagged = false;
+  auto tagCallees = [&M, &tagFunction, &indirectCalleesTagged](
+                        Instruction *I) {
+    auto call = dyn_cast<CallBase>(I);
+    if (false || (call == nullptr) || call->isInlineAsm()) {
+      return;
+    }
+    auto callee = call->getCalledFunction();
+    if (callee != nullptr) {
+      tagFunction(callee);
+      return;
+    }
+    if (indirectCalleesTagged) {
+      return;
+    }
+    indirectCalleesTagged = true;
+    for (auto &F : M) {
+      if (F.hasAddressTaken()) {
+        tagFunction(&F);
+      }
+    }
+  };
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto &LI = this->getLoopInfo(F);
+    for (auto loop : LI) {
+      double instructions = 0;
+      for (auto bb : loop->blocks()) {
+        instructions += computeInstructionsOfBlock(bb);
+      }
+      auto hotness = instructions / programInstructions;
+      if (hotness < this->minimumHotness) {
+        continue;
+      }
+      this->hotFunctions.insert(&F);
+      for (auto bb : loop->blocks()) {
+        for (auto &I : *bb) {
+          tagCallees(&I);
+        }
+      }
+    }
+  }
+
+  /*
+   * Tag the callees of the hot functions transitively.
+   */
+  while (!worklist.empty()) {
+    auto F = worklist.back();
+    worklist.pop_back();
+    for (auto &I : instructions(*F)) {
+      tagCallees(&I);
+    }
+  }
+
+  if (this->verbose >= PDGVerbosity::Minimal) {
+    uint64_t functions = 0;
+    for (auto &F : M) {
+      if (!F.empty()) {
+        functions++;
+      }
+    }
+    uint64_t hotFunctionsWithBody = 0;
+    for (auto F : this->hotFunctions) {
+      if (!F->empty()) {
+        hotFunctionsWithBody++;
+      }
+    }
+    errs() << "PDGAnalysis: " << hotFunctionsWithBody << " out of " << functions
+           << " functions are analyzed precisely\n";
+  }
+
+  return;
+}
+
+bool PDGAnalysis::isAnalyzedPrecisely(Function &F) {
+
+  /*
+   * Check if only the hot code is analyzed precisely.
+   */
+  if (!this->analyzeOnlyHotCode) {
+    return true;
+  }
+  this->identifyHotFunctions(*F.getParent());
+
+  return (this->hotFunctions.find(&F) != this->hotFunctions.end());
+}
+
+void PDGAnalysis::constructConservativeMemoryEdgesForFunction(
+    PDG *pdg,
+    Function &F,
+    DataFlowResult *dfr) {
+
+  /*
+   * Add a may dependence between every pair of memory instructions of @F that
+   * can reach each other, unless both of them can only read memory.
+   * No alias analysis is queried.
+   */
+  for (auto &I : instructions(F)) {
+    if (!isa<LoadInst>(&I) && !isa<StoreInst>(&I) && !isa<CallBase>(&I)) {
+      continue;
+    }
+    if (auto call = dyn_cast<CallBase>(&I)) {
+      if (!Utils::isActualCode(call)) {
+        continue;
+      }
+    }
+    auto iReads = I.mayReadFromMemory();
+    auto iWrites = I.mayWriteToMemory();
+    if (!iReads && !iWrites) {
+      continue;
+    }
+    for (auto value : dfr->OUT(&I)) {
+      auto J = dyn_cast<Instruction>(value);
+      if (false || (J == nullptr) || (J == &I)) {
+        continue;
+      }
+      if (auto otherCall = dyn_cast<CallBase>(J)) {
+        if (!Utils::isActualCode(otherCall)) {
+          continue;
+        }
+      }
+      auto jReads = J->mayReadFromMemory();
+      auto jWrites = J->mayWriteToMemory();
+      if (iWrites && jReads) {
+        pdg->addEdge(&I, J)->setMemMustType(true, false, DG_DATA_RAW);
+      }
+      if (iReads && jWrites) {
+        pdg->addEdge(&I, J)->setMemMustType(true, false, DG_DATA_WAR);
+      }
+      if (iWrites && jWrites) {
+        pdg->addEdge(&I, J)->setMemMustType(true, false, DG_DATA_WAW);
+      }
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -163,6 +163,13 @@ void PDGAnalysis::addEdgeFromFunctionModRef(PDG *pdg,
     return;
   }
 
+  /*
+   * Check the summaries of the memory accessed by the callees.
+   */
+  if (!this->canBeDependentBasedOnModRefSummaries(call, store)) {
+    return;
+  }
+
   /*
    * Query the LLVM alias analyses.
    */
@@ -291,6 +298,13 @@ void PDGAnalysis::addEdgeFromFunctionModRef(PDG *pdg,
     return;
   }
 
+  /*
+   * Check the summaries of the memory accessed by the callees.
+   */
+  if (!this->canBeDependentBasedOnModRefSummaries(call, load)) {
+    return;
+  }
+
   /*
    * Query the LLVM alias analyses.
    */
@@ -417,6 +431,13 @@ void PDGAnalysis::addEdgeFromFunctionModRef(PDG *pdg,
     }
   }
 
+  /*
+   * Check the summaries of the memory accessed by the callees.
+   */
+  if (!this->canBeDependentBasedOnModRefSummaries(call, otherCall)) {
+    return;
+  }
+
   /*
    * Query the LLVM alias analyses.
    */
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 - 2020  Angelo Matni, Yian Su, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <future>
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+
+namespace llvm::noelle {
+
+void PDGAnalysis::iterateOverFunctionsInParallel(
+    Module &M,
+    std::function<void(Function &F)> computeInParallel,
+    std::function<void(Function &F)> mergeInOrder) {
+
+  /*
+   * Fetch the functions with a body.
+   */
+  std::vector<Function *> functions;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    functions.push_back(&F);
+  }
+
+  /*
+   * Check if we can use more than one thread.
+   */
+  if (this->numberOfThreads <= 1) {
+    for (auto F : functions) {
+      computeInParallel(*F);
+      mergeInOrder(*F);
+    }
+    return;
+  }
+
+  /*
+   * Compute the functions in parallel, one function per task, while merging
+   * their results following the order of the module.
+   * At most one task per thread is in flight, which bounds the memory used by
+   * results that have not been merged yet.
+   */
+  std::deque<std::future<void>> tasks;
+  uint64_t nextFunctionToCompute = 0;
+  for (auto F : functions) {
+
+    /*
+     * Submit new tasks.
+     */
+    while (true && (nextFunctionToCompute < functions.size())
+           && (tasks.size() < this->numberOfThreads)) {
+      auto functionToCompute = functions[nextFunctionToCompute];
+      auto computeTask = [functionToCompute, &computeInParallel]() {
+        computeInParallel(*functionToCompute);
+      };
+      tasks.push_back(std::async(std::launch::async, computeTask));
+      nextFunctionToCompute++;
+    }
+
+    /*
+     * Wait for the oldest task, which is the one of the current function.
+     */
+    tasks.front().get();
+    tasks.pop_front();
+
+    /*
+     * Merge the result of the current function.
+     */
+    mergeInOrder(*F);
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
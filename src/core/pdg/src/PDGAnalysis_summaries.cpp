@@ -0,0 +1,272 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+#include "llvm/Analysis/ValueTracking.h"
+
+namespace llvm::noelle {
+
+void PDGAnalysis::computeModRefSummaries(Module &M) {
+
+  /*
+   * Check if the summaries have already been computed.
+   */
+  if (this->modRefSummariesComputed) {
+    return;
+  }
+  this->modRefSummariesComputed = true;
+  this->modRefSummaries.clear();
+
+  /*
+   * Collect the direct callers of each function.
+   * Indirect calls are summarized as accessing any memory, so they do not
+   * need to be tracked.
+   */
+  std::unordered_map<Function *, std::unordered_set<Function *>> callers;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    this->modRefSummaries[&F];
+    for (auto &I : instructions(F)) {
+      auto call = dyn_cast<CallBase>(&I);
+      if (call == nullptr) {
+        continue;
+      }
+      auto callee = call->getCalledFunction();
+      if (true && (callee != nullptr) && (!callee->empty())) {
+        callers[callee].insert(&F);
+      }
+    }
+  }
+
+  /*
+   * Compute the summaries bottom-up on the call graph.
+   * The summary of a function changes only when the summary of one of its
+   * callees does, so recursive functions reach a fixed point.
+   */
+  std::queue<Function *> worklist;
+  std::unordered_set<Function *> inWorklist;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    worklist.push(&F);
+    inWorklist.insert(&F);
+  }
+  while (!worklist.empty()) {
+    auto F = worklist.front();
+    worklist.pop();
+    inWorklist.erase(F);
+
+    /*
+     * Summarize the memory accesses of @F.
+     * Accesses to the stack of @F are not visible to its callers.
+     */
+    ModRefSummary summary;
+    for (auto &I : instructions(*F)) {
+      this->addToModRefSummary(summary, &I, F);
+    }
+
+    /*
+     * Check if the summary changed.
+     * Summaries only grow, so comparing their sizes is enough.
+     */
+    auto &oldSummary = this->modRefSummaries[F];
+    if (true && (summary.readGlobals.size() == oldSummary.readGlobals.size())
+        && (summary.writtenGlobals.size() == oldSummary.writtenGlobals.size())
+        && (summary.mayReadOtherMemory == oldSummary.mayReadOtherMemory)
+        && (summary.mayWriteOtherMemory == oldSummary.mayWriteOtherMemory)) {
+      continue;
+    }
+    oldSummary = summary;
+
+    /*
+     * The callers of @F need to be summarized again.
+     */
+    for (auto caller : callers[F]) {
+      if (inWorklist.find(caller) != inWorklist.end()) {
+        continue;
+      }
+      worklist.push(caller);
+      inWorklist.insert(caller);
+    }
+  }
+
+  return;
+}
+
+void PDGAnalysis::addToModRefSummary(ModRefSummary &summary,
+                                     Instruction *I,
+                                     Function *localFunction) {
+
+  /*
+   * Fetch the abstract memory object accessed through @pointer.
+   */
+  auto &DL = I->getModule()->getDataLayout();
+  auto addAccess = [&summary, &DL, localFunction](Value *pointer,
+                                                  bool isWrite) {
+    auto object = GetUnderlyingObject(pointer, DL);
+    if (auto alloca = dyn_cast<AllocaInst>(object)) {
+      if (alloca->getFunction() == localFunction) {
+        return;
+      }
+    }
+    if (auto global = dyn_cast<GlobalVariable>(object)) {
+      if (isWrite) {
+        summary.writtenGlobals.insert(global);
+      } else {
+        summary.readGlobals.insert(global);
+      }
+      return;
+    }
+    if (isWrite) {
+      summary.mayWriteOtherMemory = true;
+    } else {
+      summary.mayReadOtherMemory = true;
+    }
+  };
+
+  /*
+   * Loads and stores.
+   */
+  if (auto load = dyn_cast<LoadInst>(I)) {
+    addAccess(load->getPointerOperand(), false);
+    return;
+  }
+  if (auto store = dyn_cast<StoreInst>(I)) {
+    addAccess(store->getPointerOperand(), true);
+    return;
+  }
+
+  /*
+   * Calls.
+   */
+  if (auto call = dyn_cast<CallBase>(I)) {
+    if (false || isa<DbgInfoIntrinsic>(call) || call->isLifetimeStartOrEnd()
+        || call->doesNotAccessMemory()) {
+      return;
+    }
+
+    /*
+     * Internal callees are described by their summaries.
+     */
+    auto callee = call->getCalledFunction();
+    if (true && (callee != nullptr) && (!callee->empty())) {
+      auto calleeSummaryIt = this->modRefSummaries.find(callee);
+      if (calleeSummaryIt != this->modRefSummaries.end()) {
+        auto &calleeSummary = calleeSummaryIt->second;
+        summary.readGlobals.insert(calleeSummary.readGlobals.begin(),
+                                   calleeSummary.readGlobals.end());
+        summary.writtenGlobals.insert(calleeSummary.writtenGlobals.begin(),
+                                      calleeSummary.writtenGlobals.end());
+        summary.mayReadOtherMemory |= calleeSummary.mayReadOtherMemory;
+        summary.mayWriteOtherMemory |= calleeSummary.mayWriteOtherMemory;
+        return;
+      }
+    }
+
+    /*
+     * Library functions and indirect calls can access any memory.
+     */
+    summary.mayReadOtherMemory = true;
+    if (!call->onlyReadsMemory()) {
+      summary.mayWriteOtherMemory = true;
+    }
+    return;
+  }
+
+  /*
+   * Any other instruction that accesses memory (e.g., atomics) can access any
+   * memory.
+   */
+  if (I->mayReadFromMemory()) {
+    summary.mayReadOtherMemory = true;
+  }
+  if (I->mayWriteToMemory()) {
+    summary.mayWriteOtherMemory = true;
+  }
+
+  return;
+}
+
+bool PDGAnalysis::canSummariesConflict(const ModRefSummary &writer,
+                                       const ModRefSummary &accessor) {
+
+  /*
+   * Check the memory written by @writer against the memory read or written by
+   * @accessor.
+   */
+  auto accessorUsesGlobals = (false || (!accessor.readGlobals.empty())
+                              || (!accessor.writtenGlobals.empty()));
+  auto accessorUsesOtherMemory = (false || accessor.mayReadOtherMemory
+                                  || accessor.mayWriteOtherMemory);
+  if (true && writer.mayWriteOtherMemory
+      && (accessorUsesGlobals || accessorUsesOtherMemory)) {
+    return true;
+  }
+  if (true && (!writer.writtenGlobals.empty()) && accessorUsesOtherMemory) {
+    return true;
+  }
+  for (auto global : writer.writtenGlobals) {
+    if (false || (accessor.readGlobals.count(global) > 0)
+        || (accessor.writtenGlobals.count(global) > 0)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool PDGAnalysis::canBeDependentBasedOnModRefSummaries(Instruction *i,
+                                                       Instruction *j) {
+
+  /*
+   * Summarize the memory accessed by the two instructions.
+   * Their function is not excluded: stack locations of the function can be
+   * accessed by both.
+   */
+  this->computeModRefSummaries(*this->M);
+  ModRefSummary summaryI;
+  ModRefSummary summaryJ;
+  this->addToModRefSummary(summaryI, i, nullptr);
+  this->addToModRefSummary(summaryJ, j, nullptr);
+
+  /*
+   * Check whether one instruction can write memory accessed by the other.
+   */
+  if (false || PDGAnalysis::canSummariesConflict(summaryI, summaryJ)
+      || PDGAnalysis::canSummariesConflict(summaryJ, summaryI)) {
+    return true;
+  }
+
+  return false;
+}
+
+void PDGAnalysis::invalidateModRefSummaries(void) {
+  this->modRefSummariesComputed = false;
+  this->modRefSummaries.clear();
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,291 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
+#include "PDGBinaryFormat.hpp"
+#include "IntegrationWithSVF.hpp"
+
+namespace llvm::noelle {
+
+void PDGAnalysis::removeInstructions(
+    std::unordered_set<Instruction *> &instructions) {
+
+  /*
+   * Remove the nodes from the graphs that include them.
+   */
+  for (auto inst : instructions) {
+    auto F = inst->getFunction();
+    std::vector<PDG *> graphs{ this->programDependenceGraph };
+    if (this->functionToFDGMap.find(F) != this->functionToFDGMap.end()) {
+      graphs.push_back(this->functionToFDGMap.at(F));
+    }
+    for (auto pdg : graphs) {
+      if (true && (pdg != nullptr) && pdg->isInGraph(inst)) {
+        pdg->removeNode(pdg->fetchNode(inst));
+      }
+    }
+  }
+
+  /*
+   * The cached answers of the alias queries could refer to the code changed,
+   * and the PDG embedded in the IR (if any) does not describe it anymore.
+   */
+  PDGAnalysis::invalidateAliasQueryCache();
+  this->invalidateModRefSummaries();
+  this->invalidateEmbeddedPDG();
+
+  return;
+}
+
+uint64_t PDGAnalysis::getNumberOfAliasQueryCacheHits(void) {
+  return NoelleSVFIntegration::getNumberOfQueryCacheHits();
+}
+
+uint64_t PDGAnalysis::getNumberOfAliasQueryCacheMisses(void) {
+  return NoelleSVFIntegration::getNumberOfQueryCacheMisses();
+}
+
+void PDGAnalysis::invalidateAliasQueryCache(void) {
+  NoelleSVFIntegration::invalidateQueryCache();
+
+  return;
+}
+
+void PDGAnalysis::updateFunction(
+    Function &F,
+    std::unordered_set<Instruction *> &changedInstructions) {
+
+  /*
+   * Check if the memory dependences can have changed.
+   * This is the case if a memory instruction, or the control flow between
+   * them, has been added or moved.
+   */
+  auto updateMemoryDependences = false;
+  for (auto inst : changedInstructions) {
+    if (false || isa<LoadInst>(inst) || isa<StoreInst>(inst)
+        || isa<CallBase>(inst) || inst->isTerminator()) {
+      updateMemoryDependences = true;
+      break;
+    }
+  }
+
+  /*
+   * Update the graphs that include @F.
+   */
+  if (this->programDependenceGraph != nullptr) {
+    this->updateDG(this->programDependenceGraph,
+                   F,
+                   changedInstructions,
+                   updateMemoryDependences);
+  }
+  if (this->functionToFDGMap.find(&F) != this->functionToFDGMap.end()) {
+    this->updateDG(this->functionToFDGMap.at(&F),
+                   F,
+                   changedInstructions,
+                   updateMemoryDependences);
+  }
+
+  /*
+   * The cached answers of the alias queries could refer to the code changed,
+   * and the PDG embedded in the IR (if any) does not describe it anymore.
+   */
+  PDGAnalysis::invalidateAliasQueryCache();
+  this->invalidateModRefSummaries();
+  this->invalidateEmbeddedPDG();
+
+  return;
+}
+
+void PDGAnalysis::refreshFunction(Function &F) {
+
+  /*
+   * The DG of @F computed so far describes the code before the
+   * transformation.
+   */
+  this->forgetFunctionDG(F);
+
+  /*
+   * Check if the PDG has been computed.
+   * If it has not, then it will be computed from the current code.
+   */
+  if (this->programDependenceGraph == nullptr) {
+    PDGAnalysis::invalidateAliasQueryCache();
+    this->invalidateModRefSummaries();
+    this->invalidateEmbeddedPDG();
+    return;
+  }
+
+  /*
+   * Remove the nodes of the instructions that have been erased.
+   * These are the internal nodes that no longer belong to the module. Their
+   * values are not accessed as they have been freed.
+   */
+  std::unordered_set<Value *> values;
+  for (auto &otherF : *this->M) {
+    for (auto &arg : otherF.args()) {
+      values.insert(&arg);
+    }
+    for (auto &I : instructions(otherF)) {
+      values.insert(&I);
+    }
+  }
+  std::vector<DGNode<Value> *> erasedNodes;
+  for (auto pair : this->programDependenceGraph->internalNodePairs()) {
+    if (values.find(pair.first) == values.end()) {
+      erasedNodes.push_back(pair.second);
+    }
+  }
+  for (auto node : erasedNodes) {
+    this->programDependenceGraph->removeNode(node);
+  }
+
+  /*
+   * Recompute the dependences of all instructions of @F.
+   */
+  std::unordered_set<Instruction *> changedInstructions;
+  for (auto &I : instructions(F)) {
+    changedInstructions.insert(&I);
+  }
+  this->updateFunction(F, changedInstructions);
+
+  return;
+}
+
+void PDGAnalysis::updateDG(
+    PDG *pdg,
+    Function &F,
+    std::unordered_set<Instruction *> &changedInstructions,
+    bool updateMemoryDependences) {
+
+  /*
+   * Add the nodes of the new instructions.
+   */
+  for (auto inst : changedInstructions) {
+    assert(inst->getFunction() == &F);
+    pdg->fetchOrAddNode(inst, /*inclusion=*/true);
+  }
+
+  /*
+   * Collect the dependences to recompute:
+   * - the variable dependences of the changed instructions,
+   * - the control dependences of @F,
+   * - the memory dependences between instructions of @F (if needed).
+   */
+  std::unordered_set<DGEdge<Value> *> edgesToRemove;
+  for (auto inst : changedInstructions) {
+    for (auto edge : pdg->fetchNode(inst)->getAllConnectedEdges()) {
+      if (true && (!edge->isControlDependence())
+          && (!edge->isMemoryDependence())) {
+        edgesToRemove.insert(edge);
+      }
+    }
+  }
+  for (auto &I : instructions(F)) {
+    if (!pdg->isInGraph(&I)) {
+      continue;
+    }
+    for (auto edge : pdg->fetchNode(&I)->getOutgoingEdges()) {
+      if (edge->isControlDependence()) {
+        edgesToRemove.insert(edge);
+        continue;
+      }
+      if (!updateMemoryDependences) {
+        continue;
+      }
+      auto dst = dyn_cast<Instruction>(edge->getIncomingT());
+      if (true && edge->isMemoryDependence() && (dst != nullptr)
+          && (dst->getFunction() == &F)) {
+        edgesToRemove.insert(edge);
+      }
+    }
+  }
+  for (auto edge : edgesToRemove) {
+    pdg->removeEdge(edge);
+  }
+
+  /*
+   * Add the variable dependences of the changed instructions.
+   */
+  for (auto inst : changedInstructions) {
+    for (auto &U : inst->uses()) {
+      auto user = U.getUser();
+      if (true && (isa<Instruction>(user) || isa<Argument>(user))
+          && pdg->isInGraph(user)) {
+        auto edge = pdg->addEdge(inst, user);
+        edge->setMemMustType(false, true, DG_DATA_RAW);
+      }
+    }
+    for (auto &op : inst->operands()) {
+      auto definition = op.get();
+      if (false || (changedInstructions.find(dyn_cast<Instruction>(definition))
+                    != changedInstructions.end())
+          || (!pdg->isInGraph(definition))) {
+        continue;
+      }
+      auto edge = pdg->addEdge(definition, inst);
+      edge->setMemMustType(false, true, DG_DATA_RAW);
+    }
+  }
+
+  /*
+   * Add the control dependences of @F.
+   */
+  this->constructEdgesFromControlForFunction(pdg, F);
+
+  /*
+   * Add the memory dependences of @F.
+   *
+   * The points-to graph of SVF has been computed for the code before the
+   * transformation. Hence, only the LLVM alias analyses are used.
+   */
+  if (updateMemoryDependences) {
+    auto disableSVF = this->disableSVF;
+    this->disableSVF = true;
+    this->constructEdgesFromAliasesForFunction(pdg, F);
+    this->disableSVF = disableSVF;
+    if (true && (pdg == this->programDependenceGraph)
+        && (!this->disableAllocAA)) {
+      this->removeEdgesNotUsedByParSchemes(pdg, F);
+    }
+  }
+
+  return;
+}
+
+void PDGAnalysis::invalidateEmbeddedPDG(void) {
+  for (auto name : { "noelle.module.pdg", "noelle.module.pdg.binary" }) {
+    if (auto n = this->M->getNamedMetadata(name)) {
+      this->M->eraseNamedMetadata(n);
+    }
+  }
+  for (auto &F : *this->M) {
+    if (F.hasMetadata("noelle.pdg.coarse")) {
+      F.setMetadata("noelle.pdg.coarse", nullptr);
+    }
+  }
+  delete this->embeddedPDG;
+  this->embeddedPDG = nullptr;
+
+  return;
+}
+
+} // namespace llvm::noelle
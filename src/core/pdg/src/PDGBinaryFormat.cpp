@@ -0,0 +1,393 @@
+/*
+ * Copyright 2020 - 2021  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cstring>
+
+#include "llvm/Support/LEB128.h"
+#include "PDGBinaryFormat.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Header of the encoding, which includes the version of the format.
+ */
+static const char formatMagic[4] = { 'N', 'P', 'D', 'G' };
+static const uint64_t formatVersion = 1;
+
+/*
+ * Attributes of a dependence, packed in one byte.
+ * The type of data dependence uses two bits.
+ */
+enum EncodedAttribute : uint8_t {
+  ENCODED_MEMORY = 1,
+  ENCODED_MUST = 2,
+  ENCODED_CONTROL = 4,
+  ENCODED_LOOP_CARRIED = 8,
+  ENCODED_REMOVABLE = 16,
+  ENCODED_DATA_TYPE_SHIFT = 5,
+  ENCODED_DATA_TYPE_MASK = 96,
+  ENCODED_HAS_SUB_EDGES = 128
+};
+
+std::string PDGBinaryFormat::encode(Module &M, PDG *pdg) {
+
+  /*
+   * Number the nodes of the PDG.
+   */
+  auto functions = PDGBinaryFormat::getFunctionsWithBody(M);
+  std::unordered_map<Value *, std::pair<uint64_t, uint64_t>> nodeIDs;
+  for (uint64_t functionIndex = 0; functionIndex < functions.size();
+       functionIndex++) {
+    auto F = functions[functionIndex];
+    uint64_t localID = 0;
+    for (auto &arg : F->args()) {
+      nodeIDs[&arg] = { functionIndex, localID++ };
+    }
+    for (auto &I : instructions(F)) {
+      nodeIDs[&I] = { functionIndex, localID++ };
+    }
+  }
+
+  /*
+   * Encode the dependences, grouped by the function of their source.
+   */
+  std::vector<std::string> sections(functions.size());
+  std::vector<uint64_t> numberOfDependences(functions.size(), 0);
+  for (auto edge : pdg->getSortedDependences()) {
+    auto fromIt = nodeIDs.find(edge->getOutgoingT());
+    auto toIt = nodeIDs.find(edge->getIncomingT());
+    if (false || (fromIt == nodeIDs.end()) || (toIt == nodeIDs.end())) {
+      continue;
+    }
+    auto functionIndex = fromIt->second.first;
+    raw_string_ostream section(sections[functionIndex]);
+    numberOfDependences[functionIndex]++;
+
+    auto encodeDependence = [&nodeIDs, &section, functionIndex](
+                                DGEdge<Value> *dep,
+                                bool hasSubEdges) {
+      auto &from = nodeIDs[dep->getOutgoingT()];
+      auto &to = nodeIDs[dep->getIncomingT()];
+      auto isInAnotherFunction = (to.first != functionIndex);
+      encodeULEB128(from.second, section);
+      encodeULEB128((to.second << 1) | (isInAnotherFunction ? 1 : 0), section);
+      if (isInAnotherFunction) {
+        encodeULEB128(to.first, section);
+      }
+      uint8_t attributes = dep->dataDependenceType() << ENCODED_DATA_TYPE_SHIFT;
+      if (dep->isMemoryDependence()) {
+        attributes |= ENCODED_MEMORY;
+      }
+      if (dep->isMustDependence()) {
+        attributes |= ENCODED_MUST;
+      }
+      if (dep->isControlDependence()) {
+        attributes |= ENCODED_CONTROL;
+      }
+      if (dep->isLoopCarriedDependence()) {
+        attributes |= ENCODED_LOOP_CARRIED;
+      }
+      if (dep->isRemovableDependence()) {
+        attributes |= ENCODED_REMOVABLE;
+      }
+      if (hasSubEdges) {
+        attributes |= ENCODED_HAS_SUB_EDGES;
+      }
+      section << (char)attributes;
+    };
+
+    /*
+     * Encode the dependence and its sub-dependences.
+     * Sub-dependences whose nodes are not in the PDG are dropped.
+     */
+    std::vector<DGEdge<Value> *> subEdges;
+    for (auto subEdge : edge->getSubEdges()) {
+      if (true && (nodeIDs.find(subEdge->getOutgoingT()) != nodeIDs.end())
+          && (nodeIDs.find(subEdge->getIncomingT()) != nodeIDs.end())) {
+        subEdges.push_back(subEdge);
+      }
+    }
+    encodeDependence(edge, subEdges.size() > 0);
+    if (subEdges.size() > 0) {
+      encodeULEB128(subEdges.size(), section);
+      for (auto subEdge : subEdges) {
+        encodeDependence(subEdge, false);
+      }
+    }
+    section.flush();
+  }
+
+  /*
+   * Encode the header and the table of functions, followed by the sections.
+   */
+  std::string encoding;
+  raw_string_ostream stream(encoding);
+  stream.write(formatMagic, sizeof(formatMagic));
+  encodeULEB128(formatVersion, stream);
+  encodeULEB128(functions.size(), stream);
+  for (uint64_t functionIndex = 0; functionIndex < functions.size();
+       functionIndex++) {
+    auto F = functions[functionIndex];
+    auto name = F->getName();
+    encodeULEB128(name.size(), stream);
+    stream << name;
+    encodeULEB128(F->arg_size() + F->getInstructionCount(), stream);
+
+    std::string header;
+    raw_string_ostream headerStream(header);
+    encodeULEB128(numberOfDependences[functionIndex], headerStream);
+    headerStream.flush();
+    sections[functionIndex] = header + sections[functionIndex];
+    encodeULEB128(sections[functionIndex].size(), stream);
+  }
+  for (auto &section : sections) {
+    stream << section;
+  }
+  stream.flush();
+
+  return encoding;
+}
+
+PDGBinaryFormat::PDGBinaryFormat(Module &M, StringRef encoding)
+  : encoding{ encoding },
+    valid{ false } {
+
+  /*
+   * Decode the ULEB128 integers of the header, checking the bounds.
+   */
+  auto data = reinterpret_cast<const uint8_t *>(encoding.data());
+  auto end = data + encoding.size();
+  auto current = data;
+  auto decodeInteger = [&current, end](uint64_t &value) -> bool {
+    const char *error = nullptr;
+    unsigned bytes = 0;
+    value = decodeULEB128(current, &bytes, end, &error);
+    if (error != nullptr) {
+      return false;
+    }
+    current += bytes;
+    return true;
+  };
+
+  /*
+   * Check the header.
+   */
+  uint64_t version;
+  if (false || (encoding.size() < sizeof(formatMagic))
+      || (std::memcmp(data, formatMagic, sizeof(formatMagic)) != 0)) {
+    return;
+  }
+  current += sizeof(formatMagic);
+  if (false || (!decodeInteger(version)) || (version != formatVersion)) {
+    return;
+  }
+
+  /*
+   * Check the table of functions matches the module.
+   * The encoding is not valid anymore if a function has been added, removed,
+   * or modified.
+   */
+  this->functions = PDGBinaryFormat::getFunctionsWithBody(M);
+  uint64_t numberOfFunctions;
+  if (false || (!decodeInteger(numberOfFunctions))
+      || (numberOfFunctions != this->functions.size())) {
+    return;
+  }
+  std::vector<uint64_t> sizes;
+  for (auto F : this->functions) {
+    uint64_t nameSize, numberOfValues, sectionSize;
+    if (false || (!decodeInteger(nameSize))
+        || (nameSize > (uint64_t)(end - current))) {
+      return;
+    }
+    StringRef name(reinterpret_cast<const char *>(current), nameSize);
+    current += nameSize;
+    if (false || (name != F->getName()) || (!decodeInteger(numberOfValues))
+        || (numberOfValues != (F->arg_size() + F->getInstructionCount()))
+        || (!decodeInteger(sectionSize))) {
+      return;
+    }
+    sizes.push_back(sectionSize);
+  }
+
+  /*
+   * Locate the sections.
+   */
+  uint64_t offset = current - data;
+  for (uint64_t i = 0; i < this->functions.size(); i++) {
+    if (sizes[i] > (encoding.size() - offset)) {
+      return;
+    }
+    this->records[this->functions[i]] = { offset, sizes[i] };
+    offset += sizes[i];
+  }
+  this->valid = true;
+
+  return;
+}
+
+bool PDGBinaryFormat::isValid(void) const {
+  return this->valid;
+}
+
+void PDGBinaryFormat::decodeFunction(Function &F, PDG *pdg) {
+  assert(this->valid);
+
+  /*
+   * Fetch the section of the function.
+   */
+  auto recordIt = this->records.find(&F);
+  if (recordIt == this->records.end()) {
+    return;
+  }
+  auto &record = recordIt->second;
+  auto data = reinterpret_cast<const uint8_t *>(this->encoding.data());
+  auto current = data + record.offset;
+  auto end = current + record.size;
+  auto decodeInteger = [&current, end]() -> uint64_t {
+    const char *error = nullptr;
+    unsigned bytes = 0;
+    auto value = decodeULEB128(current, &bytes, end, &error);
+    if (error != nullptr) {
+      errs() << "PDGAnalysis: Error = the PDG embedded is corrupted\n";
+      abort();
+    }
+    current += bytes;
+    return value;
+  };
+
+  /*
+   * Decode a dependence of the function.
+   * Dependences with nodes that are not in the PDG are decoded, but not
+   * added.
+   */
+  auto &localValues = this->getValuesOf(&F);
+  auto decodeDependence =
+      [this, &localValues, &current, end, &decodeInteger](
+          uint8_t &attributes) -> std::pair<Value *, Value *> {
+        auto fromID = decodeInteger();
+        auto toID = decodeInteger();
+        auto toValues = &localValues;
+        if (toID & 1) {
+          auto functionIndex = decodeInteger();
+          if (functionIndex >= this->functions.size()) {
+            errs() << "PDGAnalysis: Error = the PDG embedded is corrupted\n";
+            abort();
+          }
+          toValues = &this->getValuesOf(this->functions[functionIndex]);
+        }
+        toID >>= 1;
+        if (false || (current >= end) || (fromID >= localValues.size())
+            || (toID >= toValues->size())) {
+          errs() << "PDGAnalysis: Error = the PDG embedded is corrupted\n";
+          abort();
+        }
+        attributes = *current;
+        current++;
+        return { localValues[fromID], (*toValues)[toID] };
+      };
+  auto setAttributes = [](DGEdge<Value> *edge, uint8_t attributes) {
+    auto dataDependenceType = static_cast<DataDependenceType>(
+        (attributes & ENCODED_DATA_TYPE_MASK) >> ENCODED_DATA_TYPE_SHIFT);
+    edge->setMemMustType((attributes & ENCODED_MEMORY) != 0,
+                         (attributes & ENCODED_MUST) != 0,
+                         dataDependenceType);
+    edge->setControl((attributes & ENCODED_CONTROL) != 0);
+    edge->setLoopCarried((attributes & ENCODED_LOOP_CARRIED) != 0);
+    edge->setRemovable((attributes & ENCODED_REMOVABLE) != 0);
+  };
+
+  /*
+   * Add the dependences straight to the PDG.
+   */
+  auto numberOfDependences = decodeInteger();
+  for (uint64_t i = 0; i < numberOfDependences; i++) {
+    uint8_t attributes;
+    auto nodes = decodeDependence(attributes);
+    auto isIncluded = (true && pdg->isInGraph(nodes.first)
+                       && pdg->isInGraph(nodes.second));
+    DGEdge<Value> *edge = nullptr;
+    if (isIncluded) {
+      edge = pdg->addEdge(nodes.first, nodes.second);
+      setAttributes(edge, attributes);
+    }
+
+    /*
+     * Decode the sub-dependences.
+     */
+    if ((attributes & ENCODED_HAS_SUB_EDGES) == 0) {
+      continue;
+    }
+    auto numberOfSubEdges = decodeInteger();
+    for (uint64_t j = 0; j < numberOfSubEdges; j++) {
+      uint8_t subAttributes;
+      auto subNodes = decodeDependence(subAttributes);
+      if (false || (!isIncluded) || (!pdg->isInGraph(subNodes.first))
+          || (!pdg->isInGraph(subNodes.second))) {
+        continue;
+      }
+      auto subEdge = new DGEdge<Value>(pdg->fetchNode(subNodes.first),
+                                       pdg->fetchNode(subNodes.second));
+      setAttributes(subEdge, subAttributes);
+      edge->addSubEdge(subEdge);
+    }
+  }
+
+  return;
+}
+
+std::vector<Value *> &PDGBinaryFormat::getValuesOf(Function *F) {
+
+  /*
+   * Check if we have already numbered the values of the function.
+   */
+  auto it = this->values.find(F);
+  if (it != this->values.end()) {
+    return it->second;
+  }
+
+  /*
+   * The values are ordered as the nodes of PDG(F).
+   */
+  auto &v = this->values[F];
+  for (auto &arg : F->args()) {
+    v.push_back(&arg);
+  }
+  for (auto &I : instructions(F)) {
+    v.push_back(&I);
+  }
+
+  return v;
+}
+
+std::vector<Function *> PDGBinaryFormat::getFunctionsWithBody(Module &M) {
+  std::vector<Function *> functions;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    functions.push_back(&F);
+  }
+
+  return functions;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2020 - 2021  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDG.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Compact binary encoding of a PDG.
+ *
+ * Nodes are identified by their position in their function (arguments first,
+ * then instructions), encoded as ULEB128 integers. The dependences are grouped
+ * by the function of their source, and each group can be decoded on its own,
+ * so the dependences of a function are materialized only when it is queried.
+ * The encoding is decoded in place, without copying it.
+ */
+class PDGBinaryFormat {
+public:
+  static std::string encode(Module &M, PDG *pdg);
+
+  PDGBinaryFormat(Module &M, StringRef encoding);
+
+  bool isValid(void) const;
+
+  void decodeFunction(Function &F, PDG *pdg);
+
+private:
+  struct FunctionRecord {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  StringRef encoding;
+  bool valid;
+  std::vector<Function *> functions;
+  std::unordered_map<Function *, FunctionRecord> records;
+  std::unordered_map<Function *, std::vector<Value *>> values;
+
+  std::vector<Value *> &getValuesOf(Function *F);
+  static std::vector<Function *> getFunctionsWithBody(Module &M);
+};
+
+} // namespace llvm::noelle
@@ -0,0 +1,469 @@
+/*
+ * Copyright 2020 - 2021  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <tuple>
+
+#include "llvm/Support/MD5.h"
+#include "PDGCache.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Version of the format of the cache file.
+ * Files with a different version are ignored.
+ */
+static const char cacheMagic[8] = { 'N', 'P', 'D', 'G', 'C', '0', '0', '1' };
+
+enum CachedAttribute : uint8_t {
+  CACHED_MEMORY = 1,
+  CACHED_MUST = 2,
+  CACHED_CONTROL = 4,
+  CACHED_LOOP_CARRIED = 8,
+  CACHED_REMOVABLE = 16
+};
+
+PDGCache::PDGCache(const std::string &fileName,
+                   const std::string &configuration)
+  : fileName{ fileName },
+    configuration{ configuration },
+    modified{ false } {
+  this->load();
+
+  return;
+}
+
+PDG *PDGCache::fetchFunctionDG(Function &F) {
+
+  /*
+   * Check if the function has been cached with the same key.
+   */
+  auto it = this->functions.find(F.getName().str());
+  if (it == this->functions.end()) {
+    return nullptr;
+  }
+  auto &cachedFunction = it->second;
+  if (cachedFunction.key != this->computeKey(F)) {
+    return nullptr;
+  }
+
+  /*
+   * Check the dependences refer to values of the function.
+   */
+  auto values = PDGCache::getValuesOf(F);
+  for (auto &dep : cachedFunction.dependences) {
+    if (false || (dep.from >= values.size()) || (dep.to >= values.size())) {
+      return nullptr;
+    }
+  }
+
+  /*
+   * Build the dependence graph.
+   */
+  auto fdg = new PDG(F);
+  for (auto &dep : cachedFunction.dependences) {
+    auto edge = fdg->addEdge(values[dep.from], values[dep.to]);
+    auto dataDependenceType =
+        static_cast<DataDependenceType>(dep.dataDependenceType);
+    edge->setMemMustType((dep.attributes & CACHED_MEMORY) != 0,
+                         (dep.attributes & CACHED_MUST) != 0,
+                         dataDependenceType);
+    edge->setControl((dep.attributes & CACHED_CONTROL) != 0);
+    edge->setLoopCarried((dep.attributes & CACHED_LOOP_CARRIED) != 0);
+    edge->setRemovable((dep.attributes & CACHED_REMOVABLE) != 0);
+  }
+
+  return fdg;
+}
+
+void PDGCache::storeFunctionDG(Function &F, PDG *fdg) {
+
+  /*
+   * Number the values of the function.
+   */
+  std::unordered_map<Value *, uint32_t> indices;
+  for (auto v : PDGCache::getValuesOf(F)) {
+    uint32_t index = indices.size();
+    indices[v] = index;
+  }
+
+  /*
+   * Encode the dependences.
+   * Functions with dependences that cannot be encoded are not cached.
+   */
+  CachedFunction cachedFunction;
+  for (auto edge : fdg->getEdges()) {
+    auto fromIt = indices.find(edge->getOutgoingT());
+    auto toIt = indices.find(edge->getIncomingT());
+    if (false || (fromIt == indices.end()) || (toIt == indices.end())
+        || (!edge->getSubEdges().empty())) {
+      return;
+    }
+    CachedDependence dep;
+    dep.from = fromIt->second;
+    dep.to = toIt->second;
+    dep.attributes = 0;
+    if (edge->isMemoryDependence()) {
+      dep.attributes |= CACHED_MEMORY;
+    }
+    if (edge->isMustDependence()) {
+      dep.attributes |= CACHED_MUST;
+    }
+    if (edge->isControlDependence()) {
+      dep.attributes |= CACHED_CONTROL;
+    }
+    if (edge->isLoopCarriedDependence()) {
+      dep.attributes |= CACHED_LOOP_CARRIED;
+    }
+    if (edge->isRemovableDependence()) {
+      dep.attributes |= CACHED_REMOVABLE;
+    }
+    dep.dataDependenceType = edge->dataDependenceType();
+    cachedFunction.dependences.push_back(dep);
+  }
+
+  /*
+   * Sort the dependences to keep the file stable across runs.
+   */
+  std::sort(cachedFunction.dependences.begin(),
+            cachedFunction.dependences.end(),
+            [](const CachedDependence &d1, const CachedDependence &d2) {
+              return std::tie(d1.from,
+                              d1.to,
+                              d1.attributes,
+                              d1.dataDependenceType)
+                     < std::tie(d2.from,
+                                d2.to,
+                                d2.attributes,
+                                d2.dataDependenceType);
+            });
+
+  /*
+   * Cache the dependences.
+   */
+  cachedFunction.key = this->computeKey(F);
+  this->functions[F.getName().str()] = std::move(cachedFunction);
+  this->modified = true;
+
+  return;
+}
+
+void PDGCache::save(void) {
+
+  /*
+   * Check if there is something new to save.
+   */
+  if (!this->modified) {
+    return;
+  }
+
+  /*
+   * Write the cache.
+   */
+  std::ofstream file(this->fileName, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    errs() << "PDGAnalysis: WARNING = cannot write the PDG cache "
+           << this->fileName << "\n";
+    return;
+  }
+  auto writeInteger = [&file](uint32_t value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  };
+  auto writeString = [&file, &writeInteger](const std::string &s) {
+    writeInteger(s.size());
+    file.write(s.data(), s.size());
+  };
+  file.write(cacheMagic, sizeof(cacheMagic));
+  writeInteger(this->functions.size());
+  for (auto &pair : this->functions) {
+    writeString(pair.first);
+    writeString(pair.second.key);
+    writeInteger(pair.second.dependences.size());
+    for (auto &dep : pair.second.dependences) {
+      writeInteger(dep.from);
+      writeInteger(dep.to);
+      file.put(dep.attributes);
+      file.put(dep.dataDependenceType);
+    }
+  }
+  this->modified = false;
+
+  return;
+}
+
+void PDGCache::load(void) {
+
+  /*
+   * Open the cache.
+   * A missing cache is not an error: it will be created.
+   */
+  std::ifstream file(this->fileName, std::ios::binary);
+  if (!file.is_open()) {
+    return;
+  }
+
+  /*
+   * Check the format.
+   */
+  char magic[sizeof(cacheMagic)];
+  if (false || (!file.read(magic, sizeof(magic)))
+      || (std::memcmp(magic, cacheMagic, sizeof(cacheMagic)) != 0)) {
+    return;
+  }
+
+  /*
+   * Read the cached functions.
+   */
+  auto readInteger = [&file](uint32_t &value) -> bool {
+    return !!file.read(reinterpret_cast<char *>(&value), sizeof(value));
+  };
+  auto readString = [&file, &readInteger](std::string &s) -> bool {
+    uint32_t size;
+    if (!readInteger(size)) {
+      return false;
+    }
+    s.resize(size);
+    return !!file.read(&s[0], size);
+  };
+  uint32_t numberOfFunctions;
+  if (!readInteger(numberOfFunctions)) {
+    return;
+  }
+  std::unordered_map<std::string, CachedFunction> functionsRead;
+  for (uint32_t i = 0; i < numberOfFunctions; i++) {
+    std::string name;
+    CachedFunction cachedFunction;
+    uint32_t numberOfDependences;
+    if (false || (!readString(name)) || (!readString(cachedFunction.key))
+        || (!readInteger(numberOfDependences))) {
+      return;
+    }
+    for (uint32_t j = 0; j < numberOfDependences; j++) {
+      CachedDependence dep;
+      if (false || (!readInteger(dep.from)) || (!readInteger(dep.to))
+          || (!file.read(reinterpret_cast<char *>(&dep.attributes), 1))
+          || (!file.read(reinterpret_cast<char *>(&dep.dataDependenceType),
+                         1))) {
+        return;
+      }
+      cachedFunction.dependences.push_back(dep);
+    }
+    functionsRead[name] = std::move(cachedFunction);
+  }
+
+  /*
+   * The cache is valid.
+   */
+  this->functions = std::move(functionsRead);
+
+  return;
+}
+
+std::string PDGCache::computeKey(Function &F) {
+
+  /*
+   * Check if we have already computed the key of the function.
+   */
+  auto it = this->keys.find(&F);
+  if (it != this->keys.end()) {
+    return it->second;
+  }
+  MD5 hasher;
+
+  /*
+   * Hash the configuration of the PDG analysis and the body of the function.
+   */
+  hasher.update(this->configuration);
+  hasher.update(this->computeBodyHash(F));
+
+  /*
+   * Hash the mod/ref summaries of the callees.
+   * The summary of a callee depends on the callees it reaches transitively
+   * through direct calls (indirect calls are summarized as accessing any
+   * memory).
+   * Hence, the key includes the attributes of every reachable callee and,
+   * if it has a body, the hash of its body.
+   */
+  std::set<std::string> reachableCallees;
+  std::unordered_set<Function *> visited{ &F };
+  std::vector<Function *> worklist{ &F };
+  while (!worklist.empty()) {
+    auto caller = worklist.back();
+    worklist.pop_back();
+    for (auto &I : instructions(*caller)) {
+      auto call = dyn_cast<CallBase>(&I);
+      if (call == nullptr) {
+        continue;
+      }
+      auto callee = call->getCalledFunction();
+      if (callee == nullptr) {
+        continue;
+      }
+      if (!visited.insert(callee).second) {
+        continue;
+      }
+      auto summary = callee->getName().str() + ":"
+                     + callee->getAttributes().getAsString(
+                         AttributeList::FunctionIndex);
+      if (!callee->empty()) {
+        summary += ":" + this->computeBodyHash(*callee);
+        worklist.push_back(callee);
+      }
+      reachableCallees.insert(summary);
+    }
+  }
+
+  /*
+   * Hash the callees in a stable order.
+   */
+  for (auto &summary : reachableCallees) {
+    hasher.update(summary);
+    hasher.update(StringRef("\0", 1));
+  }
+
+  MD5::MD5Result result;
+  hasher.final(result);
+  std::string key = result.digest().str();
+  this->keys[&F] = key;
+
+  return key;
+}
+
+std::string PDGCache::computeBodyHash(Function &F) {
+
+  /*
+   * Check if we have already hashed the function.
+   */
+  auto it = this->bodyHashes.find(&F);
+  if (it != this->bodyHashes.end()) {
+    return it->second;
+  }
+
+  /*
+   * Number the values local to the function.
+   */
+  std::unordered_map<Value *, uint64_t> localIDs;
+  for (auto v : PDGCache::getValuesOf(F)) {
+    uint64_t localID = localIDs.size();
+    localIDs[v] = localID;
+  }
+  for (auto &bb : F) {
+    uint64_t localID = localIDs.size();
+    localIDs[&bb] = localID;
+  }
+
+  /*
+   * Hash the signature of the function.
+   */
+  MD5 hasher;
+  auto hashString = [&hasher](const std::string &s) {
+    hasher.update(s);
+    hasher.update(StringRef("\0", 1));
+  };
+  auto printType = [](Type *type) -> std::string {
+    std::string s;
+    raw_string_ostream os(s);
+    type->print(os);
+    return os.str();
+  };
+  hashString(F.getName().str());
+  hashString(printType(F.getFunctionType()));
+  auto attributes = F.getAttributes();
+  for (auto index = attributes.index_begin(); index != attributes.index_end();
+       index++) {
+    hashString(attributes.getAsString(index));
+  }
+
+  /*
+   * Hash the instructions.
+   * Local values are identified by their position in the function, which
+   * makes the hash independent of their names.
+   */
+  for (auto &I : instructions(F)) {
+    hashString(I.getOpcodeName());
+    hashString(printType(I.getType()));
+    if (auto cmp = dyn_cast<CmpInst>(&I)) {
+      hashString(std::to_string(cmp->getPredicate()));
+    }
+    if (auto load = dyn_cast<LoadInst>(&I)) {
+      hashString(std::to_string(load->isVolatile()) + "."
+                 + std::to_string((unsigned)load->getOrdering()));
+    }
+    if (auto store = dyn_cast<StoreInst>(&I)) {
+      hashString(std::to_string(store->isVolatile()) + "."
+                 + std::to_string((unsigned)store->getOrdering()));
+    }
+    if (auto call = dyn_cast<CallBase>(&I)) {
+      auto callAttributes = call->getAttributes();
+      for (auto index = callAttributes.index_begin();
+           index != callAttributes.index_end();
+           index++) {
+        hashString(callAttributes.getAsString(index));
+      }
+    }
+    for (auto &op : I.operands()) {
+      auto v = op.get();
+      auto localIt = localIDs.find(v);
+      if (localIt != localIDs.end()) {
+        hashString("%" + std::to_string(localIt->second));
+      } else if (auto global = dyn_cast<GlobalValue>(v)) {
+        hashString("@" + global->getName().str());
+        if (auto globalVariable = dyn_cast<GlobalVariable>(global)) {
+          hashString(std::to_string(globalVariable->isConstant()));
+        }
+      } else if (isa<Constant>(v)) {
+        std::string s;
+        raw_string_ostream os(s);
+        v->print(os);
+        hashString(os.str());
+      } else {
+        hashString("?");
+      }
+    }
+  }
+
+  MD5::MD5Result result;
+  hasher.final(result);
+  auto hash = result.digest().str();
+  this->bodyHashes[&F] = hash;
+
+  return hash;
+}
+
+std::vector<Value *> PDGCache::getValuesOf(Function &F) {
+
+  /*
+   * The values are ordered as the nodes of PDG(F).
+   */
+  std::vector<Value *> values;
+  for (auto &arg : F.args()) {
+    values.push_back(&arg);
+  }
+  for (auto &I : instructions(F)) {
+    values.push_back(&I);
+  }
+
+  return values;
+}
+
+} // namespace llvm::noelle
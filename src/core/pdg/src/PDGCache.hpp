@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020 - 2021  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/PDG.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * On-disk cache of the dependence graphs of functions.
+ *
+ * The dependences of a function are reused only if its key did not change.
+ * The key hashes the structure of the function body together with the
+ * attributes and the body of the callees it reaches transitively (their
+ * mod/ref summaries), so editing a function invalidates its entry and the
+ * ones of all functions that can reach it.
+ */
+class PDGCache {
+public:
+  PDGCache(const std::string &fileName, const std::string &configuration);
+
+  PDG *fetchFunctionDG(Function &F);
+
+  void storeFunctionDG(Function &F, PDG *fdg);
+
+  void save(void);
+
+private:
+  struct CachedDependence {
+    uint32_t from;
+    uint32_t to;
+    uint8_t attributes;
+    uint8_t dataDependenceType;
+  };
+  struct CachedFunction {
+    std::string key;
+    std::vector<CachedDependence> dependences;
+  };
+
+  std::string fileName;
+  std::string configuration;
+  bool modified;
+  std::unordered_map<std::string, CachedFunction> functions;
+  std::unordered_map<Function *, std::string> bodyHashes;
+  std::unordered_map<Function *, std::string> keys;
+
+  void load(void);
+  std::string computeKey(Function &F);
+  std::string computeBodyHash(Function &F);
+  static std::vector<Value *> getValuesOf(Function &F);
+};
+
+} // namespace llvm::noelle
@@ -19,9 +19,14 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "llvm/Analysis/ScopedNoAliasAA.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/PDGAnalysis.hpp"
 #include "noelle/core/PDGPrinter.hpp"
+#include "noelle/core/LibraryFunctions.hpp"
+#include "PDGCache.hpp"
 
 namespace llvm::noelle {
 
@@ -60,6 +65,48 @@ static cl::opt<bool> PDGRADisable(
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Disable the use of reaching analysis to compute the PDG"));
+static cl::opt<int> PDGPrecisionTier(
+    "noelle-pdg-precision",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Precision of the memory dependences (0: LLVM alias analyses only, 1: plus SVF, 2: plus our custom and loop-aware analyses (default))"));
+static cl::opt<int> PDGMinimumHotness(
+    "noelle-pdg-min-hot",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Compute the memory dependences precisely only for the functions with loops at least this hot (in thousandths of the profiled instructions, like -noelle-min-hot) and their callees"));
+static cl::opt<int> PDGThreads(
+    "noelle-pdg-threads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Number of threads used to compute the PDG (0: all cores)"));
+static cl::opt<int> PDGMemoryBudget(
+    "noelle-pdg-memory-budget",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Megabytes of function dependence graphs to keep in memory "
+             "(0: no limit)"));
+static cl::opt<int> PDGFunctionQueryBudget(
+    "noelle-pdg-function-budget-queries",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Alias queries allowed to compute the memory dependences of a "
+             "function precisely before falling back to coarse ones "
+             "(0: no limit)"));
+static cl::opt<int> PDGFunctionTimeBudget(
+    "noelle-pdg-function-budget-ms",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Milliseconds allowed to compute the memory dependences of a "
+             "function precisely before falling back to coarse ones "
+             "(0: no limit)"));
+static cl::opt<std::string> PDGCacheFile(
+    "noelle-pdg-cache",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File used to cache the dependences of functions across runs"));
 
 bool PDGAnalysis::doInitialization(Module &M) {
   this->verbose = static_cast<PDGVerbosity>(PDGVerbose.getValue());
@@ -71,13 +118,73 @@ bool PDGAnalysis::doInitialization(Module &M) {
   this->disableAllocAA =
       (PDGAllocAADisable.getNumOccurrences() > 0) ? true : false;
   this->disableRA = (PDGRADisable.getNumOccurrences() > 0) ? true : false;
+  switch (PDGAnalysis::getPrecision()) {
+    case PDGPrecision::LLVMAliasAnalyses:
+      this->disableSVF = true;
+      this->disableAllocAA = true;
+      break;
+    case PDGPrecision::SVF:
+      this->disableAllocAA = true;
+      break;
+    case PDGPrecision::Full:
+      break;
+  }
+  if (PDGMinimumHotness.getNumOccurrences() > 0) {
+    this->analyzeOnlyHotCode = true;
+    this->minimumHotness = ((double)(PDGMinimumHotness.getValue())) / 1000;
+  }
+  this->numberOfThreads = (PDGThreads.getValue() > 0)
+                              ? PDGThreads.getValue()
+                              : std::thread::hardware_concurrency();
+  if (this->numberOfThreads == 0) {
+    this->numberOfThreads = 1;
+  }
+  this->cacheFileName = PDGCacheFile.getValue();
+  if (PDGMemoryBudget.getValue() > 0) {
+    this->memoryBudget = ((uint64_t)PDGMemoryBudget.getValue()) << 20;
+  }
+  if (PDGFunctionQueryBudget.getValue() > 0) {
+    this->functionQueryBudget = PDGFunctionQueryBudget.getValue();
+  }
+  if (PDGFunctionTimeBudget.getValue() > 0) {
+    this->functionTimeBudget = PDGFunctionTimeBudget.getValue();
+  }
 
   return false;
 }
 
+PDGPrecision PDGAnalysis::getPrecision(void) {
+  if (PDGPrecisionTier.getNumOccurrences() == 0) {
+    return PDGPrecision::Full;
+  }
+  switch (PDGPrecisionTier.getValue()) {
+    case 0:
+      return PDGPrecision::LLVMAliasAnalyses;
+    case 1:
+      return PDGPrecision::SVF;
+    default:
+      return PDGPrecision::Full;
+  }
+}
+
+std::string PDGAnalysis::getPrecisionName(PDGPrecision precision) {
+  switch (precision) {
+    case PDGPrecision::LLVMAliasAnalyses:
+      return "LLVM-AA only";
+    case PDGPrecision::SVF:
+      return "+SVF";
+    case PDGPrecision::Full:
+      return "+custom AA and loop-aware analyses";
+  }
+
+  return "";
+}
+
 void PDGAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<LoopInfoWrapperPass>();
+  AU.addRequired<BlockFrequencyInfoWrapperPass>();
   AU.addRequired<AAResultsWrapperPass>();
+  AU.addRequired<ScopedNoAliasAAWrapperPass>();
   AU.addRequired<DominatorTreeWrapperPass>();
   AU.addRequired<PostDominatorTreeWrapperPass>();
   AU.addRequired<ScalarEvolutionWrapperPass>();
@@ -104,11 +211,56 @@ bool PDGAnalysis::runOnModule(Module &M) {
    */
   this->M = &M;
 
+  /*
+   * Fetch AllocAA, which groups the memory instructions of the functions
+   * whose dependences exceed their budget.
+   */
+  if (true && (!this->disableAllocAA)
+      && ((this->functionQueryBudget > 0) || (this->functionTimeBudget > 0))) {
+    this->allocAA = &getAnalysis<AllocAA>();
+  }
+
+  /*
+   * Let the LLVM alias analyses know the library functions the user
+   * described.
+   */
+  LibraryFunctions::addAttributesToDeclarations(M);
+
   /*
    * Initialize SVF.
    */
   initializeSVF(M);
 
+  /*
+   * Load the cache of the function dependence graphs.
+   * SVF computes the aliases of the whole program, so the dependences of a
+   * function can change even if neither the function nor its callees did.
+   * Hence, the cache is used only when SVF is disabled.
+   */
+  if (this->cacheFileName != "") {
+    if (this->disableSVF) {
+      auto configuration =
+          std::string("ra=") + (this->disableRA ? "disabled" : "enabled");
+      if (this->analyzeOnlyHotCode) {
+        configuration +=
+            ",hot=" + std::to_string(PDGMinimumHotness.getValue());
+      }
+      configuration += ",libraries="
+                       + std::to_string(
+                           LibraryFunctions::getHashOfSpecifications());
+      configuration +=
+          std::string(",allocaa=")
+          + (this->disableAllocAA ? "disabled" : "enabled")
+          + ",budget-queries=" + std::to_string(this->functionQueryBudget)
+          + ",budget-ms=" + std::to_string(this->functionTimeBudget);
+      configuration += ",summaries=modref-transitive";
+      this->cache = new PDGCache(this->cacheFileName, configuration);
+    } else {
+      errs() << "PDGAnalysis: WARNING = the PDG cache is not used because SVF "
+                "is enabled\n";
+    }
+  }
+
   /*
    * Function reachability analysis.
    */
@@ -135,9 +287,9 @@ bool PDGAnalysis::runOnModule(Module &M) {
      * Dump the PDG
      */
     auto localPDGPrinter = new PDGPrinter();
-    auto &callGraph = getAnalysis<CallGraphWrapperPass>().getCallGraph();
+    auto &callGraph = this->getLLVMCallGraph();
     auto getLoopInfo = [this](Function *f) -> LoopInfo & {
-      auto &LI = getAnalysis<LoopInfoWrapperPass>(*f).getLoopInfo();
+      auto &LI = this->getLoopInfo(*f);
       return LI;
     };
     auto currentPDG = this->getPDG();
@@ -147,4 +299,36 @@ bool PDGAnalysis::runOnModule(Module &M) {
   return false;
 }
 
+LoopInfo &PDGAnalysis::getLoopInfo(Function &F) {
+  if (this->loopInfoProvider) {
+    return this->loopInfoProvider(F);
+  }
+
+  return getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+}
+
+AAResults &PDGAnalysis::getAAResults(Function &F) {
+  if (this->aliasAnalysisProvider) {
+    return this->aliasAnalysisProvider(F);
+  }
+
+  return getAnalysis<AAResultsWrapperPass>(F).getAAResults();
+}
+
+BlockFrequencyInfo &PDGAnalysis::getBlockFrequencyInfo(Function &F) {
+  if (this->blockFrequencyProvider) {
+    return this->blockFrequencyProvider(F);
+  }
+
+  return getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+}
+
+llvm::CallGraph &PDGAnalysis::getLLVMCallGraph(void) {
+  if (this->callGraphProvider) {
+    return this->callGraphProvider();
+  }
+
+  return getAnalysis<CallGraphWrapperPass>().getCallGraph();
+}
+
 } // namespace llvm::noelle
@@ -25,7 +25,13 @@
 using namespace llvm;
 using namespace llvm::noelle;
 
-SCC::SCC(std::set<DGNode<Value> *> internalNodes) {
+SCC::SCC(std::set<DGNode<Value> *> internalNodes)
+  : SCC(internalNodes, std::function<bool(DGEdge<Value> *)>(nullptr)) {
+  return;
+}
+
+SCC::SCC(std::set<DGNode<Value> *> internalNodes,
+         std::function<bool(DGEdge<Value> *)> includeEdge) {
 
   /*
    * Collect all internal values
@@ -43,27 +49,35 @@ SCC::SCC(std::set<DGNode<Value> *> internalNodes) {
   std::set<DGNode<Value> *> externalNodes;
   for (auto node : internalNodes) {
     for (auto edge : node->getOutgoingEdges()) {
+      if ((includeEdge != nullptr) && !includeEdge(edge)) {
+        continue;
+      }
       if (internalValues.find(edge->getIncomingT()) == internalValues.end()) {
         externalNodes.insert(edge->getIncomingNode());
       }
     }
     for (auto edge : node->getIncomingEdges()) {
+      if ((includeEdge != nullptr) && !includeEdge(edge)) {
+        continue;
+      }
       if (internalValues.find(edge->getOutgoingT()) == internalValues.end()) {
         externalNodes.insert(edge->getOutgoingNode());
       }
     }
   }
 
-  copyNodesAndEdges(internalNodes, externalNodes);
+  copyNodesAndEdges(internalNodes, externalNodes, includeEdge);
 }
 
 SCC::SCC(std::set<DGNode<Value> *> internalNodes,
          std::set<DGNode<Value> *> externalNodes) {
-  copyNodesAndEdges(internalNodes, externalNodes);
+  copyNodesAndEdges(internalNodes, externalNodes, nullptr);
 }
 
-void SCC::copyNodesAndEdges(std::set<DGNode<Value> *> internalNodes,
-                            std::set<DGNode<Value> *> externalNodes) {
+void SCC::copyNodesAndEdges(
+    std::set<DGNode<Value> *> internalNodes,
+    std::set<DGNode<Value> *> externalNodes,
+    std::function<bool(DGEdge<Value> *)> includeEdge) {
 
   /*
    * Add all nodes by classification. Arbitrarily choose entry node from all
@@ -87,6 +101,8 @@ void SCC::copyNodesAndEdges(std::set<DGNode<Value> *> internalNodes,
       auto incomingT = edge->getIncomingT();
       if (isExternal(incomingT))
         continue;
+      if ((includeEdge != nullptr) && !includeEdge(edge))
+        continue;
       copyAddEdge(*edge);
     }
   }
@@ -99,12 +115,16 @@ void SCC::copyNodesAndEdges(std::set<DGNode<Value> *> internalNodes,
       auto incomingT = edge->getIncomingNode()->getT();
       if (isInternal(incomingT))
         continue;
+      if ((includeEdge != nullptr) && !includeEdge(edge))
+        continue;
       copyAddEdge(*edge);
     }
     for (auto edge : node->getIncomingEdges()) {
       auto outgoingT = edge->getOutgoingNode()->getT();
       if (isInternal(outgoingT))
         continue;
+      if ((includeEdge != nullptr) && !includeEdge(edge))
+        continue;
       copyAddEdge(*edge);
     }
   }
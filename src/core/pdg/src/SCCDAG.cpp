@@ -20,65 +20,54 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/SystemHeaders.hpp"
-#include "noelle/core/DGGraphTraits.hpp"
+#include "noelle/core/DGSnapshot.hpp"
 #include "noelle/core/SCCDAG.hpp"
 #include "llvm/InitializePasses.h"
 
 using namespace llvm;
 using namespace llvm::noelle;
 
-SCCDAG::SCCDAG(PDG *pdg) {
+SCCDAG::SCCDAG(PDG *pdg) : SCCDAG(pdg, nullptr, nullptr) {
+  return;
+}
+
+SCCDAG::SCCDAG(PDG *pdg,
+               DGSnapshot<Value>::NodeFilter includeNode,
+               DGSnapshot<Value>::EdgeFilter includeEdge) {
+  this->enableArenaAllocation();
 
   /*
    * Create nodes of the SCCDAG.
    *
-   * Iterate over all nodes in the PDG to calculate strongly connected
-   * components (see Tarjan's DFS algo).
+   * Calculate the strongly connected components of the PDG (see Tarjan's DFS
+   * algo) over a compact snapshot of it.
    */
-  std::set<DGNode<Value> *> visited;
-  DGNode<Value> *originalEntryNode = pdg->getEntryNode();
-
-  for (auto nodeToVisit : pdg->getNodes()) {
-    if (visited.find(nodeToVisit) != visited.end())
-      continue;
-
-    pdg->setEntryNode(nodeToVisit);
-
-    DGGraphWrapper<PDG, Value> pdgWrapper(pdg);
-
-    for (auto pdgI = scc_begin(&pdgWrapper); pdgI != scc_end(&pdgWrapper);
-         ++pdgI) {
+  DGSnapshot<Value> snapshot(*pdg, includeNode, includeEdge);
+  auto isInView = [&snapshot, &includeEdge](DGEdge<Value> *edge) -> bool {
+    return true && snapshot.isInGraph(edge->getOutgoingT())
+           && snapshot.isInGraph(edge->getIncomingT())
+           && ((includeEdge == nullptr) || includeEdge(edge));
+  };
+  for (auto &sccNodes : snapshot.getStronglyConnectedComponents()) {
 
-      /*
-       * Identify a new SCC.
-       */
-      const std::vector<DGNodeWrapper<Value> *> &sccNodes = *pdgI;
-      auto firstNodeWrapper = *sccNodes.begin();
-      auto firstNode = firstNodeWrapper->wrappedNode;
-      if (visited.find(firstNode) != visited.end()) {
-        continue;
-      }
-
-      std::set<DGNode<Value> *> unwrappedNodes{};
-      for (auto sccNode : sccNodes) {
-        unwrappedNodes.insert(sccNode->wrappedNode);
-      }
-
-      /*
-       * Add a new SCC to the SCCDAG.
-       */
-      visited.insert(unwrappedNodes.begin(), unwrappedNodes.end());
-      auto scc = new SCC(unwrappedNodes);
-      auto isInternal = false;
-      for (auto node : unwrappedNodes) {
-        isInternal |= pdg->isInternal(node->getT());
-      }
-
-      this->addNode(scc, /*inclusion=*/isInternal);
+    /*
+     * Identify a new SCC.
+     */
+    std::set<DGNode<Value> *> nodes{};
+    auto isInternal = false;
+    for (auto sccNode : sccNodes) {
+      nodes.insert(snapshot.getNode(sccNode));
+      isInternal |= snapshot.isInternal(sccNode);
     }
-  }
 
-  pdg->setEntryNode(originalEntryNode);
+    /*
+     * Add a new SCC to the SCCDAG.
+     */
+    auto scc = (false || (includeNode != nullptr) || (includeEdge != nullptr))
+                   ? new SCC(nodes, isInView)
+                   : new SCC(nodes);
+    this->addNode(scc, /*inclusion=*/isInternal);
+  }
 
   /*
    * Create the map from a Value to an SCC included in the SCCDAG.
@@ -132,52 +121,95 @@ void SCCDAG::markEdgesAndSubEdges(void) {
    */
   std::set<DGEdge<SCC> *> clearedEdges;
   for (auto outgoingSCCNode : this->getNodes()) {
+    this->markEdgesAndSubEdgesOf(outgoingSCCNode, clearedEdges);
+  }
+}
+
+void SCCDAG::markEdgesAndSubEdgesOf(DGNode<SCC> *outgoingSCCNode,
+                                    std::set<DGEdge<SCC> *> &clearedEdges) {
+
+  /*
+   * Fetch the current SCC.
+   */
+  auto outgoingSCC = outgoingSCCNode->getT();
+
+  /*
+   * Check dependences that go outside the current SCC.
+   */
+  for (auto externalNodePair : outgoingSCC->externalNodePairs()) {
+    auto incomingNode = externalNodePair.second;
+    if (incomingNode->numIncomingEdges() == 0)
+      continue;
+
+    auto incomingSCCNode = this->valueToSCCNode[externalNodePair.first];
+    auto incomingSCC = incomingSCCNode->getT();
 
     /*
-     * Fetch the current SCC.
+     * Find or create unique edge between the two connected SCC
      */
-    auto outgoingSCC = outgoingSCCNode->getT();
+    std::unordered_set<DGEdge<SCC> *> edgeSet;
+    for (auto edge : outgoingSCCNode->getOutgoingEdges()) {
+      if (edge->getIncomingNode() != incomingSCCNode)
+        continue;
+      edgeSet.insert(edge);
+    }
+    for (auto edge : outgoingSCCNode->getIncomingEdges()) {
+      if (edge->getOutgoingNode() != incomingSCCNode)
+        continue;
+      edgeSet.insert(edge);
+    }
+    auto sccEdge = edgeSet.empty() ? this->addEdge(outgoingSCC, incomingSCC)
+                                   : (*edgeSet.begin());
 
     /*
-     * Check dependences that go outside the current SCC.
+     * Clear out subedges if not already done once; add all currently existing
+     * subedges
      */
-    for (auto externalNodePair : outgoingSCC->externalNodePairs()) {
-      auto incomingNode = externalNodePair.second;
-      if (incomingNode->numIncomingEdges() == 0)
-        continue;
+    if (clearedEdges.find(sccEdge) == clearedEdges.end()) {
+      sccEdge->clearSubEdges();
+      clearedEdges.insert(sccEdge);
+    }
+    for (auto edge : incomingNode->getIncomingEdges())
+      sccEdge->addSubEdge(edge);
+  }
+}
 
-      auto incomingSCCNode = this->valueToSCCNode[externalNodePair.first];
-      auto incomingSCC = incomingSCCNode->getT();
+void SCCDAG::markNewSCCs(std::unordered_set<DGNode<SCC> *> &newSCCNodes) {
 
-      /*
-       * Find or create unique edge between the two connected SCC
-       */
-      std::unordered_set<DGEdge<SCC> *> edgeSet;
-      for (auto edge : outgoingSCCNode->getOutgoingEdges()) {
-        if (edge->getIncomingNode() != incomingSCCNode)
-          continue;
-        edgeSet.insert(edge);
-      }
-      for (auto edge : outgoingSCCNode->getIncomingEdges()) {
-        if (edge->getOutgoingNode() != incomingSCCNode)
-          continue;
-        edgeSet.insert(edge);
-      }
-      auto sccEdge = edgeSet.empty() ? this->addEdge(outgoingSCC, incomingSCC)
-                                     : (*edgeSet.begin());
+  /*
+   * Map the values of the new SCCs to them.
+   */
+  for (auto sccNode : newSCCNodes) {
+    for (auto instPair : sccNode->getT()->internalNodePairs()) {
+      this->valueToSCCNode[instPair.first] = sccNode;
+    }
+  }
 
-      /*
-       * Clear out subedges if not already done once; add all currently existing
-       * subedges
-       */
-      if (clearedEdges.find(sccEdge) == clearedEdges.end()) {
-        sccEdge->clearSubEdges();
-        clearedEdges.insert(sccEdge);
+  /*
+   * Identify the SCCs that depend on the new ones, and the ones the new SCCs
+   * depend on.
+   * The edges from the latter were removed together with the old SCCs.
+   */
+  std::unordered_set<DGNode<SCC> *> sccNodesToMark{ newSCCNodes };
+  for (auto sccNode : newSCCNodes) {
+    for (auto externalNodePair : sccNode->getT()->externalNodePairs()) {
+      auto externalNode = externalNodePair.second;
+      if (externalNode->numOutgoingEdges() == 0) {
+        continue;
       }
-      for (auto edge : incomingNode->getIncomingEdges())
-        sccEdge->addSubEdge(edge);
+      sccNodesToMark.insert(this->valueToSCCNode.at(externalNodePair.first));
     }
   }
+
+  /*
+   * Create the dependences of the SCCs identified.
+   */
+  std::set<DGEdge<SCC> *> clearedEdges;
+  for (auto sccNode : sccNodesToMark) {
+    this->markEdgesAndSubEdgesOf(sccNode, clearedEdges);
+  }
+
+  return;
 }
 
 void SCCDAG::mergeSCCs(std::set<DGNode<SCC> *> &sccSet) {
@@ -208,8 +240,149 @@ void SCCDAG::mergeSCCs(std::set<DGNode<SCC> *> &sccSet) {
   auto mergeSCCNode = this->addNode(mergeSCC, /*inclusion=*/true);
   for (auto sccNode : sccSet)
     this->removeNode(sccNode);
-  this->markValuesInSCC();
-  this->markEdgesAndSubEdges();
+  std::unordered_set<DGNode<SCC> *> newSCCNodes{ mergeSCCNode };
+  this->markNewSCCs(newSCCNodes);
+}
+
+void SCCDAG::splitSCC(SCC *scc, PDG *pdg) {
+  std::unordered_set<SCC *> sccs{ scc };
+  this->splitSCCs(sccs, pdg);
+
+  return;
+}
+
+void SCCDAG::splitSCCs(std::unordered_set<SCC *> &sccs, PDG *pdg) {
+  if (sccs.size() == 0) {
+    return;
+  }
+
+  std::unordered_set<DGNode<SCC> *> newSCCNodes;
+  for (auto scc : sccs) {
+    auto oldSCCNode = this->fetchNode(scc);
+    auto isInternal = this->isInternal(scc);
+
+    /*
+     * Compute the SCCs of the values of @scc (see Tarjan's DFS algo).
+     * Only the nodes of @pdg that belong to @scc and the dependences between
+     * them are visited.
+     */
+    std::unordered_set<Value *> values;
+    for (auto instPair : scc->internalNodePairs()) {
+      values.insert(instPair.first);
+    }
+    auto components = SCCDAG::computeSCCsOfValues(values, pdg);
+
+    /*
+     * Add the new SCCs.
+     * They are built from the nodes of @pdg to include the dependences that
+     * connect them to the rest of the SCCDAG.
+     */
+    for (auto &nodes : components) {
+      auto newSCC = new SCC(nodes);
+      newSCCNodes.insert(this->addNode(newSCC, /*inclusion=*/isInternal));
+    }
+
+    /*
+     * Remove the old SCC together with its dependences.
+     */
+    this->removeNode(oldSCCNode);
+  }
+
+  /*
+   * Connect the new SCCs to the rest of the SCCDAG.
+   */
+  this->markNewSCCs(newSCCNodes);
+
+  /*
+   * Compute transitive dependences between nodes of the SCCDAG.
+   */
+  this->computeReachabilityAmongSCCs();
+
+  return;
+}
+
+std::vector<std::set<DGNode<Value> *>> SCCDAG::computeSCCsOfValues(
+    std::unordered_set<Value *> &values,
+    PDG *pdg) {
+  std::vector<std::set<DGNode<Value> *>> components;
+
+  /*
+   * Iterative version of Tarjan's algorithm.
+   */
+  struct Frame {
+    DGNode<Value> *node;
+    std::vector<DGNode<Value> *> successors;
+    uint32_t nextSuccessor;
+  };
+  std::unordered_map<DGNode<Value> *, uint32_t> indices;
+  std::unordered_map<DGNode<Value> *, uint32_t> lowLinks;
+  std::unordered_set<DGNode<Value> *> onStack;
+  std::vector<DGNode<Value> *> stack;
+  auto visit = [&](DGNode<Value> *node) -> Frame {
+    auto index = indices.size();
+    indices[node] = index;
+    lowLinks[node] = index;
+    stack.push_back(node);
+    onStack.insert(node);
+
+    Frame frame{ node, {}, 0 };
+    for (auto edge : node->getOutgoingEdges()) {
+      auto successor = edge->getIncomingNode();
+      if (values.find(successor->getT()) != values.end()) {
+        frame.successors.push_back(successor);
+      }
+    }
+    return frame;
+  };
+  for (auto value : values) {
+    auto root = pdg->fetchNode(value);
+    if (indices.find(root) != indices.end()) {
+      continue;
+    }
+
+    std::vector<Frame> frames{ visit(root) };
+    while (!frames.empty()) {
+      auto &frame = frames.back();
+      auto node = frame.node;
+
+      /*
+       * Visit the next successor of the current node.
+       */
+      if (frame.nextSuccessor < frame.successors.size()) {
+        auto successor = frame.successors[frame.nextSuccessor];
+        frame.nextSuccessor++;
+        if (indices.find(successor) == indices.end()) {
+          frames.push_back(visit(successor));
+        } else if (onStack.find(successor) != onStack.end()) {
+          lowLinks[node] = std::min(lowLinks[node], indices[successor]);
+        }
+        continue;
+      }
+
+      /*
+       * All successors have been visited.
+       * Check if the current node is the root of an SCC.
+       */
+      if (lowLinks[node] == indices[node]) {
+        std::set<DGNode<Value> *> component;
+        DGNode<Value> *member = nullptr;
+        do {
+          member = stack.back();
+          stack.pop_back();
+          onStack.erase(member);
+          component.insert(member);
+        } while (member != node);
+        components.push_back(component);
+      }
+      frames.pop_back();
+      if (!frames.empty()) {
+        auto parent = frames.back().node;
+        lowLinks[parent] = std::min(lowLinks[parent], lowLinks[node]);
+      }
+    }
+  }
+
+  return components;
 }
 
 SCC *SCCDAG::sccOfValue(Value *val) const {
@@ -217,7 +390,7 @@ SCC *SCCDAG::sccOfValue(Value *val) const {
   return sccIter == valueToSCCNode.end() ? nullptr : sccIter->second->getT();
 }
 
-int64_t SCCDAG::numberOfInstructions(void) {
+int64_t SCCDAG::numberOfInstructions(void) const {
 
   /*
    * Iterate over SCCs.
@@ -232,7 +405,7 @@ int64_t SCCDAG::numberOfInstructions(void) {
 }
 
 bool SCCDAG::iterateOverInstructions(
-    std::function<bool(Instruction *)> funcToInvoke) {
+    std::function<bool(Instruction *)> funcToInvoke) const {
 
   /*
    * Iterate over SCC.
@@ -252,7 +425,7 @@ bool SCCDAG::iterateOverInstructions(
 }
 
 bool SCCDAG::iterateOverLiveInAndLiveOut(
-    std::function<bool(Value *)> funcToInvoke) {
+    std::function<bool(Value *)> funcToInvoke) const {
 
   /*
    * Iterate over live-ins and live-outs of SCCs.
@@ -274,7 +447,7 @@ bool SCCDAG::iterateOverLiveInAndLiveOut(
 }
 
 bool SCCDAG::iterateOverAllInstructions(
-    std::function<bool(Instruction *)> funcToInvoke) {
+    std::function<bool(Instruction *)> funcToInvoke) const {
 
   /*
    * Iterate over SCC.
@@ -293,7 +466,8 @@ bool SCCDAG::iterateOverAllInstructions(
   return false;
 }
 
-bool SCCDAG::iterateOverAllValues(std::function<bool(Value *)> funcToInvoke) {
+bool SCCDAG::iterateOverAllValues(
+    std::function<bool(Value *)> funcToInvoke) const {
 
   /*
    * Iterate over SCC.
@@ -312,7 +486,8 @@ bool SCCDAG::iterateOverAllValues(std::function<bool(Value *)> funcToInvoke) {
   return false;
 }
 
-bool SCCDAG::iterateOverSCCs(std::function<bool(SCC *)> funcToInvoke) {
+bool SCCDAG::iterateOverSCCs(
+    std::function<bool(SCC *)> funcToInvoke) const {
 
   /*
    * Iterate over SCC.
@@ -326,7 +501,7 @@ bool SCCDAG::iterateOverSCCs(std::function<bool(SCC *)> funcToInvoke) {
   return false;
 }
 
-std::unordered_set<SCC *> SCCDAG::getSCCs(void) {
+std::unordered_set<SCC *> SCCDAG::getSCCs(void) const {
   std::unordered_set<SCC *> s;
   for (auto sccNode : this->getNodes()) {
     s.insert(sccNode->getT());
@@ -338,13 +513,13 @@ std::unordered_set<SCC *> SCCDAG::getSCCs(void) {
 SCCDAG::~SCCDAG() {
   for (auto *edge : allEdges) {
     if (edge) {
-      delete edge;
+      this->deallocateEdge(edge);
     }
   }
 
   for (auto *node : allNodes) {
     if (node) {
-      delete node;
+      this->deallocateNode(node);
     }
   }
 
@@ -389,6 +564,7 @@ void SCCDAG::computeReachabilityAmongSCCs(void) {
   /*
    * Compute indices for all SCC nodes.
    */
+  sccIndexes.clear();
   uint32_t index = 0;
   for (const auto *SCCNode : this->getNodes()) {
     sccIndexes[SCCNode->getT()] = index;
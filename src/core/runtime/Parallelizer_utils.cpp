@@ -1,1106 +1,12013 @@
 #include <future>
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <pthread.h>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include <assert.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
 
 #include <ThreadSafeQueue.hpp>
 #include <ThreadSafeLockFreeQueue.hpp>
-#include <ThreadPools.hpp>
 
 #include <condition_variable>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <cstring>
 #include <utility>
 #include <iostream>
 
 /*
  * OPTIONS
  */
-//#define RUNTIME_PROFILE
 //#define RUNTIME_PRINT
-//#define DSWP_STATS
+
+/*
+ * Define NOELLE_MPI (e.g., -DNOELLE_MPI) to let
+ * NOELLE_DOALLDispatcherDistributed split DOALL loops across MPI ranks.
+ */
+#ifdef NOELLE_MPI
+#include <mpi.h>
+#endif
 
 using namespace MARC;
 
 #define CACHE_LINE_SIZE 64
 
-#ifdef DSWP_STATS
-static int64_t numberOfPushes8 = 0;
-static int64_t numberOfPushes16 = 0;
-static int64_t numberOfPushes32 = 0;
-static int64_t numberOfPushes64 = 0;
-#endif
+/*
+ * Default number of times a thread checks a condition before parking.
+ * This can be overridden by the environment variable NOELLE_SPIN_BUDGET.
+ */
+#define NOELLE_DEFAULT_SPIN_BUDGET 4096
 
-typedef struct {
-  void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t);
-  void *env;
-  int64_t coreID;
-  int64_t numCores;
-  int64_t chunkSize;
-  pthread_spinlock_t endLock;
-} DOALL_args_t;
+/*
+ * Default number of HELIX invocations per invocation that runs without helper
+ * threads. This can be overridden by the environment variable
+ * NOELLE_HELIX_HELPER_SAMPLING.
+ */
+#define NOELLE_HELIX_HELPER_DEFAULT_SAMPLING_PERIOD 8
 
-class NoelleRuntime {
-public:
-  NoelleRuntime();
+/*
+ * Number of iterations the producer of a decoupled HELIX prologue can run
+ * ahead of the workers that consume its values.
+ */
+#define NOELLE_HELIX_PROLOGUE_SLOTS 256
 
-  uint32_t reserveCores(uint32_t coresRequested);
+/*
+ * Number of times a HELIX critical section tries to run as a hardware
+ * transaction before it takes its lock (see NOELLE_HELIX_HTM).
+ */
+#define NOELLE_HELIX_TRANSACTION_ATTEMPTS 3
 
-  void releaseCores(uint32_t coresReleased);
+/*
+ * Default number of iterations a helper prefetcher can run ahead of its loop.
+ * This can be overridden by the environment variable
+ * NOELLE_PREFETCHER_DISTANCE.
+ */
+#define NOELLE_PREFETCHER_DEFAULT_DISTANCE 64
 
-  DOALL_args_t *getDOALLArgs(uint32_t cores, uint32_t *index);
+/*
+ * Number of levels of tasks of recursive functions that can be spawned beyond
+ * the ones needed to give a task to every core. The extra levels let idle cores
+ * steal work from unbalanced recursions.
+ * The maximum nesting of spawned tasks can be overridden by the environment
+ * variable NOELLE_TASK_SPAWN_DEPTH.
+ */
+#define NOELLE_TASK_SPAWN_DEPTH_SLACK 3
 
-  void releaseDOALLArgs(uint32_t index);
+/*
+ * Number of empty DOALL invocations used to calibrate the cost of dispatching
+ * a DOALL loop. The calibrated cost can be overridden by the environment
+ * variable NOELLE_DOALL_DISPATCH_COST (in cycles).
+ */
+#define NOELLE_DOALL_DISPATCH_CALIBRATION_RUNS 8
 
-  ThreadPoolForCSingleQueue *virgil;
+/*
+ * Online selection of the number of cores of parallelized loops (enabled by
+ * the environment variable NOELLE_CORE_TUNING).
+ * Each number of cores tried is measured by this many invocations, which can
+ * be overridden by NOELLE_CORE_TUNING_SAMPLES.
+ * The selection restarts after this many invocations with the cores chosen,
+ * which can be overridden by NOELLE_CORE_TUNING_PERIOD.
+ * Fewer cores are chosen if they are at most this much slower (in percent).
+ */
+#define NOELLE_CORE_TUNING_DEFAULT_SAMPLES 3
+#define NOELLE_CORE_TUNING_DEFAULT_PERIOD 256
+#define NOELLE_CORE_TUNING_TOLERANCE 5
 
-  ~NoelleRuntime(void);
+/*
+ * Costs minimized by the online selection of the cores (selected by the
+ * environment variable NOELLE_CORE_TUNING_OBJECTIVE).
+ *
+ * TIME: cycles per unit of work.
+ * ENERGY_DELAY: product of the cycles and of the energy per unit of work.
+ */
+#define NOELLE_CORE_TUNING_TIME 0
+#define NOELLE_CORE_TUNING_ENERGY_DELAY 1
 
-private:
-  mutable pthread_spinlock_t doallMemoryLock;
-  std::vector<uint32_t> doallMemorySizes;
-  std::vector<bool> doallMemoryAvailability;
-  std::vector<DOALL_args_t *> doallMemory;
+/*
+ * Policies to assign cores to a parallelized loop invoked by a task of
+ * another parallelized loop (i.e., a nested parallel region).
+ * The policy is selected by the environment variable NOELLE_NESTING_POLICY.
+ *
+ * SERIALIZE: nested regions run on the core of their caller.
+ * SPLIT: each task of a region can give at most its share of the cores of the
+ *        region to the regions it invokes.
+ * HIERARCHICAL: nested regions form a team with their caller and the cores
+ *               that are idle.
+ */
+#define NOELLE_NESTING_SERIALIZE 0
+#define NOELLE_NESTING_SPLIT 1
+#define NOELLE_NESTING_HIERARCHICAL 2
 
-  uint32_t getMaximumNumberOfCores(void);
+/*
+ * Hint the processor that the current thread is spinning.
+ */
+static inline void NOELLE_cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
 
-  /*
-   * Current number of idle cores.
-   */
-  int32_t NOELLE_idleCores;
+/*
+ * Latch that releases a waiting thread once it has been counted down a given
+ * number of times.
+ *
+ * The waiting thread first spins for a bounded number of times and then it
+ * parks on a condition variable.
+ */
+class NoelleCountdownLatch {
+public:
+  NoelleCountdownLatch(uint32_t count);
+
+  void countDown(void);
+
+  void wait(uint64_t spinBudget);
+
+private:
+  std::atomic<uint32_t> count;
+  char countPadding[CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
 
   /*
-   * Maximum number of cores.
+   * @released is written only while holding @lock.
+   * This guarantees that, once the waiting thread returns from "wait" (which
+   * always acquires @lock), no other thread will access the latch again.
    */
-  uint32_t maxCores;
-
-  mutable pthread_spinlock_t spinLock;
+  std::atomic<bool> released;
+  std::mutex lock;
+  std::condition_variable condition;
 };
 
-#ifdef RUNTIME_PROFILE
-pthread_spinlock_t printLock;
-uint64_t clocks_starts[64];
-uint64_t clocks_ends[64];
-uint64_t clocks_dispatch_starts[64];
-uint64_t clocks_dispatch_ends[64];
+/**********************************************************************
+ *                Telemetry
+ **********************************************************************/
+
+/*
+ * Read the cycle counter of the current core.
+ * Nanoseconds are returned on architectures without such a counter.
+ */
+static inline uint64_t NOELLE_getCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
 #endif
+}
 
-static NoelleRuntime runtime{};
+/*
+ * Counters of a task of a single invocation of a parallelized loop.
+ * Tasks fill them in only when the telemetry is enabled.
+ *
+ * @segmentWaitCycles has one entry per sequential segment (HELIX only).
+ * So do @segmentTransactions and @segmentAborts, which count the hardware
+ * transactions started and aborted by HELIX critical sections; they are
+ * nullptr if critical sections do not run as transactions.
+ * The chunks of DOALL tasks are measured only if their loop has been compiled
+ * to record them (see NOELLE_DOALL_startChunk): @chunkCycles and
+ * @chunkSquaredCycles are the sums of the cycles of the chunks of the task and
+ * of their squares.
+ */
+typedef struct {
+  uint64_t busyCycles;
+  uint64_t queuePushes;
+  uint64_t queuePops;
+  uint64_t *segmentWaitCycles;
+  int64_t loopID;
+  int64_t chunkSize;
+  uint64_t chunks;
+  uint64_t chunkCycles;
+  double chunkSquaredCycles;
+  uint64_t *segmentTransactions;
+  uint64_t *segmentAborts;
+} NOELLE_taskTelemetry_t;
 
-extern "C" {
+/*
+ * Cycles of a single invocation of a parallelized loop spent by the thread
+ * that invoked it.
+ * @setupCycles go from the invocation to the submission of the first task,
+ * @dispatchCycles are spent submitting the tasks, and @joinCycles go from the
+ * end of the tasks of the invoking thread (or of the slowest task if the
+ * invoking thread runs none) to the end of the invocation.
+ */
+typedef struct {
+  uint64_t cycles;
+  uint64_t setupCycles;
+  uint64_t dispatchCycles;
+  uint64_t joinCycles;
+} NOELLE_invocationTelemetry_t;
 
-/******************************************** NOELLE APIs
- * ***********************************************/
+/*
+ * Counters of a parallelized loop aggregated across its invocations.
+ * Per-task counters are indexed by the ID of the task (core or stage).
+ */
+typedef struct {
+  const char *technique;
+  uint64_t invocations;
+  uint64_t threadsUsed;
+  uint64_t cycles;
+  uint64_t setupCycles;
+  uint64_t dispatchCycles;
+  uint64_t joinCycles;
+  uint64_t imbalanceCycles;
+  uint64_t queuePushes;
+  uint64_t queuePops;
+  std::vector<uint64_t> busyCycles;
+  std::vector<uint64_t> idleCycles;
+  std::vector<uint64_t> segmentWaitCycles;
+  std::vector<uint64_t> segmentTransactions;
+  std::vector<uint64_t> segmentAborts;
+  int64_t loopID;
+  std::vector<uint64_t> queueCapacities;
+  std::vector<uint64_t> queueFullStalls;
+  std::vector<uint64_t> queueEmptyStalls;
+  int64_t chunkSize;
+  uint64_t chunks;
+  uint64_t chunkCycles;
+  double chunkSquaredCycles;
+} NOELLE_loopTelemetry_t;
 
-class DispatcherInfo {
+/*
+ * Counters recorded by a single thread.
+ * Parallelized loops are identified by the function that implements their
+ * tasks.
+ */
+typedef struct {
+  std::unordered_map<void *, NOELLE_loopTelemetry_t> loops;
+} NOELLE_telemetryBuffer_t;
+
+static thread_local NOELLE_telemetryBuffer_t *currentTelemetryBuffer =
+    nullptr;
+
+/*
+ * Start of the executable, which is defined by the linker.
+ * It is weak so programs linked without it dump absolute addresses.
+ */
+extern "C" char __executable_start __attribute__((weak));
+
+/*
+ * Number of values pushed to and popped from DSWP queues by the current
+ * thread.
+ */
+static thread_local uint64_t currentQueuePushes = 0;
+static thread_local uint64_t currentQueuePops = 0;
+
+/*
+ * Telemetry of the parallelized loops.
+ *
+ * It is enabled by setting the environment variable NOELLE_TELEMETRY to the
+ * name of the file to write ("-" for the standard error). Counters are
+ * accumulated in per-thread buffers, and they are merged and dumped as JSON
+ * when the program exits.
+ * Loops are dumped with the offset of their function from the start of the
+ * executable, which does not change across runs of the same binary (see
+ * tests/scripts/runtime_profiler.sh).
+ */
+class NoelleTelemetry {
 public:
-  int32_t numberOfThreadsUsed;
-  int64_t unusedVariableToPreventOptIfStructHasOnlyOneVariable;
+  NoelleTelemetry();
+
+  bool isEnabled(void) const;
+
+  void recordInvocation(void *loop,
+                        const char *technique,
+                        const NOELLE_invocationTelemetry_t &invocation,
+                        NOELLE_taskTelemetry_t **tasks,
+                        uint32_t numberOfTasks,
+                        uint32_t numberOfSegments);
+
+  void recordQueues(void *loop,
+                    int64_t loopID,
+                    uint64_t *capacities,
+                    uint64_t *fullStalls,
+                    uint64_t *emptyStalls,
+                    uint32_t numberOfQueues);
+
+  void dump(void);
+
+private:
+  bool enabled;
+  std::string outputFileName;
+  uint64_t startCycles;
+  std::chrono::steady_clock::time_point startTime;
+  std::mutex buffersLock;
+  std::vector<NOELLE_telemetryBuffer_t *> buffers;
+
+  NOELLE_telemetryBuffer_t *getBuffer(void);
 };
 
 /*
- * Dispatch threads to run a DOALL loop.
+ * Event of the execution trace.
+ * @object is what the event refers to (e.g., the task of a parallelized loop
+ * or a sequential segment), and @argument depends on the event (e.g., the ID
+ * of the task).
+ * Events that end when they start are instants (e.g., HELIX signals).
  */
-DispatcherInfo NOELLE_DOALLDispatcher(
-    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
-    void *env,
-    int64_t maxNumberOfCores,
-    int64_t chunkSize);
+typedef struct {
+  const char *name;
+  const void *object;
+  int64_t argument;
+  uint64_t startCycles;
+  uint64_t endCycles;
+} NOELLE_traceEvent_t;
 
-#ifdef RUNTIME_PROFILE
-static __inline__ int64_t rdtsc_s(void) {
-  unsigned a, d;
-  asm volatile("cpuid" ::: "%rax", "%rbx", "%rcx", "%rdx");
-  asm volatile("rdtsc" : "=a"(a), "=d"(d));
-  return ((unsigned long)a) | (((unsigned long)d) << 32);
-}
-static __inline__ int64_t rdtsc_e(void) {
-  unsigned a, d;
-  asm volatile("rdtscp" : "=a"(a), "=d"(d));
-  asm volatile("cpuid" ::: "%rax", "%rbx", "%rcx", "%rdx");
-  return ((unsigned long)a) | (((unsigned long)d) << 32);
-}
-#endif
+/*
+ * Events recorded by a single thread.
+ * The buffer is a ring: once it is full, new events overwrite the oldest ones.
+ * Only its thread writes it, so recording an event needs no synchronization.
+ */
+typedef struct {
+  uint32_t threadID;
+  int64_t workerID;
+  uint64_t numberOfEvents;
+  std::vector<NOELLE_traceEvent_t> events;
+} NOELLE_traceBuffer_t;
 
-/******************************************** NOELLE API implementations
- * ***********************************************/
+static thread_local NOELLE_traceBuffer_t *currentTraceBuffer = nullptr;
 
-typedef void (*stageFunctionPtr_t)(void *, void *);
+/*
+ * Execution trace of the parallelized loops.
+ *
+ * It is enabled by setting the environment variable NOELLE_TRACE to the name
+ * of the file to write ("-" for the standard error). The number of events
+ * kept per thread can be set with NOELLE_TRACE_EVENTS. Events are dumped in
+ * the Chrome trace format (readable by chrome://tracing and Perfetto) when
+ * the program exits.
+ */
+class NoelleTracer {
+public:
+  NoelleTracer();
 
-void printReachedS(std::string s) {
-  auto outS = "Reached: " + s;
-  printf("%s\n", outS.c_str());
-}
+  bool isEnabled(void) const;
 
-void printReachedI(int i) {
-  printf("Reached: %d\n", i);
-}
+  void recordEvent(const char *name,
+                   const void *object,
+                   int64_t argument,
+                   uint64_t startCycles,
+                   uint64_t endCycles);
 
-void printPushedP(int32_t *p) {
-  printf("Pushed: %p\n", p);
-}
+  void dump(void);
 
-void printPulledP(int32_t *p) {
-  printf("Pulled: %p\n", p);
-}
+private:
+  bool enabled;
+  std::string outputFileName;
+  uint64_t eventsPerThread;
+  uint64_t startCycles;
+  std::chrono::steady_clock::time_point startTime;
+  std::mutex buffersLock;
+  std::vector<NOELLE_traceBuffer_t *> buffers;
+
+  NOELLE_traceBuffer_t *getBuffer(void);
+};
 
-void queuePush8(ThreadSafeQueue<int8_t> *queue, int8_t *val) {
-  queue->push(*val);
+/*
+ * Record an event that lasts as long as the scope that declares it.
+ */
+class NoelleTraceScope {
+public:
+  NoelleTraceScope(const char *name, const void *object, int64_t argument);
 
-#ifdef DSWP_STATS
-  numberOfPushes8++;
-#endif
+  ~NoelleTraceScope();
 
-  return;
-}
+private:
+  const char *name;
+  const void *object;
+  int64_t argument;
+  uint64_t startCycles;
+  bool enabled;
+};
 
-void queuePop8(ThreadSafeQueue<int8_t> *queue, int8_t *val) {
-  queue->waitPop(*val);
-  return;
-}
+/*
+ * Writers of the memory that holds an environment variable of a parallelized
+ * loop. Private copies of reduced variables are written by the task whose ID
+ * is the writer instead.
+ */
+#define NOELLE_ENVIRONMENT_READ -1
+#define NOELLE_ENVIRONMENT_WRITTEN -2
 
-void queuePush16(ThreadSafeQueue<int16_t> *queue, int16_t *val) {
-  queue->push(*val);
+/*
+ * Maximum number of placements of environments that are reported.
+ */
+#define NOELLE_ENVIRONMENT_REPORT_PLACEMENTS 1024
 
-#ifdef DSWP_STATS
-  numberOfPushes16++;
-#endif
+/*
+ * Memory that holds an environment variable of a parallelized loop, or a
+ * private copy of a reduced variable.
+ */
+typedef struct {
+  uint32_t envIndex;
+  int64_t writer;
+  uint64_t address;
+  uint64_t bytes;
+} NOELLE_environmentRegion_t;
 
-  return;
-}
+/*
+ * Placement of the environment of a parallelized loop, which is the same for
+ * every invocation that allocates the environment at the same address.
+ */
+typedef struct {
+  int64_t loopID;
+  uint64_t invocations;
+  std::vector<NOELLE_environmentRegion_t> regions;
+} NOELLE_environmentPlacement_t;
 
-void queuePop16(ThreadSafeQueue<int16_t> *queue, int16_t *val) {
-  queue->waitPop(*val);
-}
+/*
+ * Report of where the environments of the parallelized loops are.
+ *
+ * It is enabled by setting the environment variable NOELLE_ENVIRONMENT_REPORT
+ * to the name of the file to write ("-" for the standard error), and it covers
+ * the loops compiled with -noelle-environment-layout-report.
+ * Every cache line of the environments and of the private copies of their
+ * reduced variables is reported with the variables it holds. A cache line is
+ * falsely shared if a variable it holds is written by a core while another
+ * variable of that line is accessed by other cores.
+ * The addresses of the cache lines match the ones of the HITM samples of
+ * "perf c2c" (see noelle-false-sharing).
+ */
+class NoelleEnvironmentReport {
+public:
+  NoelleEnvironmentReport();
 
-void queuePush32(ThreadSafeQueue<int32_t> *queue, int32_t *val) {
-  queue->push(*val);
+  bool isEnabled(void) const;
 
-#ifdef DSWP_STATS
-  numberOfPushes32++;
-#endif
+  void recordEnvironment(int64_t loopID, void *env, const char *layout);
 
-  return;
-}
+  void dump(void);
 
-void queuePop32(ThreadSafeQueue<int32_t> *queue, int32_t *val) {
-  queue->waitPop(*val);
-}
+private:
+  bool enabled;
+  std::string outputFileName;
+  std::mutex placementsLock;
+  std::map<std::pair<const char *, uint64_t>, NOELLE_environmentPlacement_t>
+      placements;
+};
 
-void queuePush64(ThreadSafeQueue<int64_t> *queue, int64_t *val) {
-  queue->push(*val);
+/*
+ * Profile of a sequential segment of a HELIX loop recorded by a thread.
+ * @waitStartCycles and @enterCycles are when the thread started waiting for
+ * the segment and when it entered it; they are 0 when it is not doing so.
+ */
+typedef struct {
+  uint64_t entries;
+  uint64_t waitCycles;
+  uint64_t holdCycles;
+  uint64_t waitStartCycles;
+  uint64_t enterCycles;
+} HELIX_segmentProfile_t;
 
-#ifdef DSWP_STATS
-  numberOfPushes64++;
-#endif
+/*
+ * Sequential segments profiled by a single thread, which are identified by the
+ * ID of their loop and their own ID.
+ */
+typedef struct {
+  std::map<std::pair<int64_t, int64_t>, HELIX_segmentProfile_t> segments;
+  std::pair<int64_t, int64_t> lastSegmentKey;
+  HELIX_segmentProfile_t *lastSegment;
+} HELIX_segmentProfileBuffer_t;
 
-  return;
-}
+static thread_local HELIX_segmentProfileBuffer_t *currentSegmentProfileBuffer =
+    nullptr;
 
-void queuePop64(ThreadSafeQueue<int64_t> *queue, int64_t *val) {
-  queue->waitPop(*val);
+/*
+ * Profiler of the sequential segments of HELIX loops.
+ *
+ * It is enabled by setting the environment variable NOELLE_HELIX_SEGMENTS to
+ * the name of the file to write ("-" for the standard error), and it covers
+ * the loops compiled with -helix-segment-profile.
+ * For every sequential segment, the profile has the number of times cores
+ * entered it, the cycles they waited to enter it, and the cycles they held it.
+ * The segments can be mapped back to their instructions with
+ * noelle-helix-segments.
+ */
+class NoelleSegmentProfiler {
+public:
+  NoelleSegmentProfiler();
 
-  return;
-}
+  bool isEnabled(void) const;
 
-/**********************************************************************
- *                DOALL
- **********************************************************************/
-static void NOELLE_DOALLTrampoline(void *args) {
-#ifdef RUNTIME_PROFILE
-  auto clocks_start = rdtsc_s();
-#endif
+  HELIX_segmentProfile_t *getSegment(int64_t loopID, int64_t segmentID);
 
-  /*
-   * Fetch the arguments.
-   */
-  auto DOALLArgs = (DOALL_args_t *)args;
+  void dump(void);
 
-  /*
-   * Invoke
-   */
-  DOALLArgs->parallelizedLoop(DOALLArgs->env,
-                              DOALLArgs->coreID,
-                              DOALLArgs->numCores,
-                              DOALLArgs->chunkSize);
-#ifdef RUNTIME_PROFILE
-  auto clocks_end = rdtsc_e();
-  clocks_starts[DOALLArgs->coreID] = clocks_start;
-  clocks_ends[DOALLArgs->coreID] = clocks_end;
-#endif
+private:
+  bool enabled;
+  std::string outputFileName;
+  std::mutex buffersLock;
+  std::vector<HELIX_segmentProfileBuffer_t *> buffers;
 
-  pthread_spin_unlock(&(DOALLArgs->endLock));
-  return;
-}
+  HELIX_segmentProfileBuffer_t *getBuffer(void);
+};
 
-DispatcherInfo NOELLE_DOALLDispatcher(
-    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
-    void *env,
-    int64_t maxNumberOfCores,
-    int64_t chunkSize) {
-#ifdef RUNTIME_PROFILE
-  auto clocks_start = rdtsc_s();
-#endif
+/*
+ * Output written to a FILE stream by an iteration of a parallelized loop
+ * (see -noelle-buffered-output).
+ * The invocation of the loop is identified by its environment, and the
+ * iteration by the value of its loop-governing IV (negated if the IV
+ * decreases).
+ */
+typedef struct {
+  void *env;
+  int64_t iteration;
+  FILE *stream;
+  std::string bytes;
+} NOELLE_bufferedOutputChunk_t;
 
-  /*
-   * Fetch VIRGIL
-   */
-  auto virgil = runtime.virgil;
+/*
+ * Output buffered by a single thread.
+ * The lock is taken by the thread that appends to it and, when an invocation
+ * ends, by the thread that writes the output of the invocation.
+ */
+typedef struct {
+  std::mutex lock;
+  std::vector<NOELLE_bufferedOutputChunk_t> chunks;
+} NOELLE_bufferedOutputBuffer_t;
 
-  /*
-   * Set the number of cores to use.
-   */
-  auto numCores = runtime.reserveCores(maxNumberOfCores);
-#ifdef RUNTIME_PRINT
-  std::cerr << "Starting dispatcher: num cores " << numCores
-            << ", chunk size: " << chunkSize << std::endl;
-#endif
+static thread_local NOELLE_bufferedOutputBuffer_t *currentBufferedOutput =
+    nullptr;
+static thread_local void *currentBufferedOutputEnv = nullptr;
+static thread_local int64_t currentBufferedOutputIteration = 0;
+
+/*
+ * Output that the tasks of parallelized loops write to FILE streams (see
+ * -noelle-buffered-output).
+ *
+ * The calls that write it run in parallel: each core formats the output of
+ * the iterations it runs into its own buffer. When an invocation of the loop
+ * ends, its output is collected from the buffers of all cores and written
+ * to the streams in the order of the iterations. The output of an iteration
+ * keeps the order of its calls, as a single core runs it.
+ */
+class NoelleBufferedOutput {
+public:
+  NoelleBufferedOutput();
+
+  void append(FILE *stream, const char *bytes, uint64_t length);
 
   /*
-   * Allocate the memory to store the arguments.
+   * Write the output of the invocation of a loop with the environment @env.
    */
-  uint32_t doallMemoryIndex;
-  auto argsForAllCores = runtime.getDOALLArgs(numCores - 1, &doallMemoryIndex);
+  void write(void *env);
 
   /*
-   * Submit DOALL tasks.
+   * Write the output left (e.g., of invocations still running at exit).
    */
-  for (auto i = 0; i < (numCores - 1); ++i) {
+  void writeAll(void);
 
-    /*
-     * Prepare the arguments.
-     */
-    auto argsPerCore = &argsForAllCores[i];
-    argsPerCore->parallelizedLoop = parallelizedLoop;
+private:
+  std::mutex buffersLock;
+  std::vector<NOELLE_bufferedOutputBuffer_t *> buffers;
+
+  NOELLE_bufferedOutputBuffer_t *getBuffer(void);
+
+  void writeChunks(std::vector<NOELLE_bufferedOutputChunk_t> &chunks);
+};
+
+/*
+ * Policies to distribute DOALL chunks among cores.
+ * These values must match DOALLChunkScheduling of the compiler.
+ */
+#define NOELLE_DOALL_STATIC_SCHEDULING 0
+#define NOELLE_DOALL_DYNAMIC_SCHEDULING 1
+#define NOELLE_DOALL_GUIDED_SCHEDULING 2
+
+/*
+ * Types of the elements of the arrays reduced by DOALL loops, and operations
+ * that reduce them. Minimums and maximums are used only by scans.
+ * These values must match DOALLArrayReductionType and
+ * DOALLArrayReductionOperation of the compiler.
+ */
+#define NOELLE_REDUCTION_INT8 0
+#define NOELLE_REDUCTION_INT16 1
+#define NOELLE_REDUCTION_INT32 2
+#define NOELLE_REDUCTION_INT64 3
+#define NOELLE_REDUCTION_FLOAT 4
+#define NOELLE_REDUCTION_DOUBLE 5
+#define NOELLE_REDUCTION_ADD 0
+#define NOELLE_REDUCTION_MUL 1
+#define NOELLE_REDUCTION_AND 2
+#define NOELLE_REDUCTION_OR 3
+#define NOELLE_REDUCTION_XOR 4
+#define NOELLE_REDUCTION_MIN 5
+#define NOELLE_REDUCTION_MAX 6
+#define NOELLE_REDUCTION_UMIN 7
+#define NOELLE_REDUCTION_UMAX 8
+
+/*
+ * Arrays with fewer elements to combine than this are reduced by the caller
+ * alone.
+ */
+#define NOELLE_REDUCTION_PARALLEL_ELEMENTS (1 << 16)
+
+/*
+ * Scans with fewer iterations per task than this run sequentially on the
+ * caller: each task runs its iterations twice.
+ */
+#define NOELLE_SCAN_MINIMUM_ITERATIONS_PER_TASK 1024
+
+/*
+ * Private copies of an array reduced by a DOALL loop to combine with the
+ * original one.
+ * The copy of task i starts @stride bytes after the one of task i - 1.
+ */
+typedef struct {
+  void *array;
+  uint8_t *copies;
+  int64_t elements;
+  int64_t stride;
+  int64_t numberOfCopies;
+  int64_t elementType;
+  int64_t operation;
+} NOELLE_arrayReduction_t;
+
+/*
+ * Invoke @f with a value of the C++ type of the elements of type
+ * @elementType.
+ * Integers are unsigned so their operations wrap around like in the program.
+ */
+template <typename F>
+static void NOELLE_forReductionType(int64_t elementType, F f) {
+  switch (elementType) {
+    case NOELLE_REDUCTION_INT8:
+      f((uint8_t)0);
+      break;
+    case NOELLE_REDUCTION_INT16:
+      f((uint16_t)0);
+      break;
+    case NOELLE_REDUCTION_INT32:
+      f((uint32_t)0);
+      break;
+    case NOELLE_REDUCTION_INT64:
+      f((uint64_t)0);
+      break;
+    case NOELLE_REDUCTION_FLOAT:
+      f((float)0);
+      break;
+    case NOELLE_REDUCTION_DOUBLE:
+      f((double)0);
+      break;
+    default:
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = unknown type of reduced array %ld\n",
+              elementType);
+      abort();
+  }
+
+  return;
+}
+
+/*
+ * Invoke @f with the function that reduces two elements of type T with
+ * @operation.
+ */
+template <typename T, typename F>
+static void NOELLE_forReductionOperation(int64_t operation, F f) {
+  switch (operation) {
+    case NOELLE_REDUCTION_ADD:
+      f([](T a, T b) -> T { return a + b; });
+      return;
+    case NOELLE_REDUCTION_MUL:
+      f([](T a, T b) -> T { return a * b; });
+      return;
+  }
+  if constexpr (std::is_integral<T>::value) {
+    using S = typename std::make_signed<T>::type;
+    switch (operation) {
+      case NOELLE_REDUCTION_AND:
+        f([](T a, T b) -> T { return a & b; });
+        return;
+      case NOELLE_REDUCTION_OR:
+        f([](T a, T b) -> T { return a | b; });
+        return;
+      case NOELLE_REDUCTION_XOR:
+        f([](T a, T b) -> T { return a ^ b; });
+        return;
+      case NOELLE_REDUCTION_MIN:
+        f([](T a, T b) -> T { return ((S)b < (S)a) ? b : a; });
+        return;
+      case NOELLE_REDUCTION_MAX:
+        f([](T a, T b) -> T { return ((S)b > (S)a) ? b : a; });
+        return;
+      case NOELLE_REDUCTION_UMIN:
+        f([](T a, T b) -> T { return (b < a) ? b : a; });
+        return;
+      case NOELLE_REDUCTION_UMAX:
+        f([](T a, T b) -> T { return (b > a) ? b : a; });
+        return;
+    }
+  } else {
+    switch (operation) {
+      case NOELLE_REDUCTION_MIN:
+        f([](T a, T b) -> T { return (b < a) ? b : a; });
+        return;
+      case NOELLE_REDUCTION_MAX:
+        f([](T a, T b) -> T { return (b > a) ? b : a; });
+        return;
+    }
+  }
+  fprintf(stderr,
+          "NOELLE: Runtime: ERROR = unknown operation of reduced array %ld\n",
+          operation);
+  abort();
+}
+
+/*
+ * Return the identity of @operation for values of type T.
+ */
+template <typename T>
+static T NOELLE_getReductionIdentity(int64_t operation) {
+  switch (operation) {
+    case NOELLE_REDUCTION_MUL:
+      return 1;
+    case NOELLE_REDUCTION_AND:
+    case NOELLE_REDUCTION_UMIN:
+      return (T)-1;
+    case NOELLE_REDUCTION_MIN:
+      if constexpr (std::is_integral<T>::value) {
+        return (T)std::numeric_limits<
+            typename std::make_signed<T>::type>::max();
+      } else {
+        return std::numeric_limits<T>::infinity();
+      }
+    case NOELLE_REDUCTION_MAX:
+      if constexpr (std::is_integral<T>::value) {
+        return (T)std::numeric_limits<
+            typename std::make_signed<T>::type>::min();
+      } else {
+        return -std::numeric_limits<T>::infinity();
+      }
+  }
+
+  return 0;
+}
+
+/*
+ * State shared among the cores that execute the same DOALL loop invocation
+ * when chunks are distributed dynamically.
+ */
+typedef struct {
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> nextChunk;
+  int64_t numberOfChunks;
+  int64_t numCores;
+  int64_t scheduling;
+} DOALL_schedule_t;
+
+/*
+ * State shared among the cores that execute the same invocation of a DOALL
+ * loop that can leave before its last iteration (e.g., a search loop).
+ * The core that takes an early exit records its iteration, and only the
+ * earliest one is kept: this is the exit the sequential loop would have taken.
+ * Cores poll @firstExitIteration at chunk boundaries to skip the chunks that
+ * start after it.
+ */
+typedef struct {
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> firstExitIteration;
+  int64_t exitBlockIndex;
+  pthread_spinlock_t lock;
+} DOALL_cancellation_t;
+
+/*
+ * Chunks reserved by a core.
+ * These are the chunks [nextReservedChunk, endOfReservedChunks).
+ */
+typedef struct {
+  DOALL_schedule_t *schedule;
+  int64_t nextReservedChunk;
+  int64_t endOfReservedChunks;
+  DOALL_cancellation_t *cancellation;
+} DOALL_chunkReservation_t;
+
+typedef struct {
+  void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t);
+  void *env;
+  int64_t coreID;
+  int64_t numCores;
+  int64_t chunkSize;
+  DOALL_chunkReservation_t reservation;
+  NoelleCountdownLatch *endLatch;
+  uint32_t nestedCoreBudget;
+  NOELLE_taskTelemetry_t telemetry;
+} DOALL_args_t;
+
+/*
+ * Chunk reservation of the DOALL task that is running on the current thread.
+ */
+static thread_local DOALL_chunkReservation_t *currentDOALLReservation =
+    nullptr;
+
+/*
+ * Counters of the DOALL task that is running on the current thread, and the
+ * cycle its current chunk started at (0 if no chunk is running).
+ * They are set only when the telemetry is enabled.
+ */
+static thread_local NOELLE_taskTelemetry_t *currentDOALLTelemetry = nullptr;
+static thread_local uint64_t currentDOALLChunkStartCycles = 0;
+
+/*
+ * Number of bits of the signatures used to filter the memory accesses of
+ * speculative DOALL tasks.
+ */
+#define NOELLE_SPECULATION_SIGNATURE_BITS 4096
+
+/*
+ * Bytes of an aligned 8-byte word written by a speculative DOALL task.
+ * The bit i of @mask is set if the byte i of @value has been written.
+ */
+typedef struct {
+  uint64_t value;
+  uint8_t mask;
+} NOELLE_speculativeWord_t;
+
+/*
+ * Memory accesses of a DOALL task that runs speculatively.
+ * Stores are buffered (per aligned 8-byte word) until the invocation is known
+ * to be free of conflicts; loads see the buffered stores of the same task.
+ * Accesses are tracked at the granularity of bytes (as a mask per word) so
+ * that tasks writing adjacent elements of an array do not conflict.
+ * The signatures are a cheap filter of the exact sets of words accessed.
+ */
+class NoelleSpeculativeTask {
+public:
+  NoelleSpeculativeTask();
+
+  int64_t load(void *address, int64_t size);
+
+  void store(void *address, int64_t value, int64_t size);
+
+  /*
+   * Return true if a word written by this task has been accessed by @other.
+   */
+  bool conflictsWith(const NoelleSpeculativeTask &other) const;
+
+  /*
+   * Write the buffered stores to memory.
+   */
+  void commit(void) const;
+
+private:
+  uint64_t readSignature[NOELLE_SPECULATION_SIGNATURE_BITS / 64];
+  uint64_t writeSignature[NOELLE_SPECULATION_SIGNATURE_BITS / 64];
+  std::unordered_map<uintptr_t, uint8_t> wordsRead;
+  std::unordered_map<uintptr_t, NOELLE_speculativeWord_t> wordsWritten;
+
+  static uint64_t getSignatureBit(uintptr_t word);
+};
+
+/*
+ * Speculative DOALL task that is running on the current thread.
+ */
+static thread_local NoelleSpeculativeTask *currentSpeculativeTask = nullptr;
+
+/**********************************************************************
+ *                Topology of the machine
+ **********************************************************************/
+
+/*
+ * Read the list of integers of the file @fileName (e.g., "0-3,8,10-11").
+ * Return false if the file cannot be read.
+ */
+static bool NOELLE_readList(const char *fileName,
+                            std::vector<uint32_t> &elements) {
+  auto file = fopen(fileName, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  uint32_t first, last;
+  while (fscanf(file, "%u", &first) == 1) {
+    last = first;
+    auto separator = fgetc(file);
+    if (separator == '-') {
+      if (fscanf(file, "%u", &last) != 1) {
+        break;
+      }
+      separator = fgetc(file);
+    }
+    for (auto element = first; element <= last; element++) {
+      elements.push_back(element);
+    }
+    if (separator != ',') {
+      break;
+    }
+  }
+  fclose(file);
+
+  return true;
+}
+
+/*
+ * Read the unsigned integer at the beginning of the file @fileName.
+ * Return false if the file cannot be read.
+ */
+static bool NOELLE_readUnsigned(const char *fileName, uint64_t *value) {
+  auto file = fopen(fileName, "r");
+  if (file == nullptr) {
+    return false;
+  }
+  unsigned long long fileValue;
+  auto read = (fscanf(file, "%llu", &fileValue) == 1);
+  fclose(file);
+  if (read) {
+    *value = fileValue;
+  }
+
+  return read;
+}
+
+/*
+ * Topology of the logical cores the program is allowed to run on.
+ *
+ * The allowed cores are the ones of the affinity mask of the program when it
+ * starts. The CPU quota of its control group (cgroup v2 or v1), if any, caps
+ * the number of cores the runtime reserves.
+ * Logical cores are grouped by physical core (i.e., SMT siblings), by last
+ * level cache, and by NUMA node as exposed by sysfs. If sysfs does not expose
+ * the topology, then every physical core is assumed to have two logical cores
+ * numbered N cores apart, where N is the number of physical cores.
+ *
+ * The topology is discovered the first time it is used. Setting the
+ * environment variable NOELLE_TOPOLOGY_REPORT to 1 prints it.
+ */
+class NoelleTopology {
+public:
+  NoelleTopology();
+
+  /*
+   * Number of physical cores the runtime can use, capped by the CPU quota.
+   */
+  uint32_t getNumberOfUsablePhysicalCores(void);
+
+  /*
+   * Allowed logical cores of each allowed physical core, sorted by their
+   * first logical core.
+   */
+  const std::vector<std::vector<uint32_t>> &getPhysicalCores(void);
+
+  /*
+   * Identifier of the last level cache of @logicalCore, which is the lowest
+   * logical core that shares it.
+   */
+  uint32_t getLastLevelCache(uint32_t logicalCore);
+
+  /*
+   * NUMA nodes that are online.
+   */
+  const std::vector<uint32_t> &getNUMANodes(void);
+
+private:
+  std::once_flag discovery;
+  std::vector<uint32_t> allowedCores;
+  std::vector<std::vector<uint32_t>> physicalCores;
+  std::unordered_map<uint32_t, uint32_t> lastLevelCaches;
+  std::vector<uint32_t> nodes;
+  uint64_t quotaCores;
+
+  void discover(void);
+
+  void computeAllowedCores(void);
+
+  void computePhysicalCores(void);
+
+  void computeLastLevelCaches(void);
+
+  void computeNodes(void);
+
+  void computeQuota(void);
+
+  void printReport(void) const;
+};
+
+NoelleTopology::NoelleTopology() : quotaCores{ 0 } {
+  return;
+}
+
+uint32_t NoelleTopology::getNumberOfUsablePhysicalCores(void) {
+  std::call_once(this->discovery, [this]() { this->discover(); });
+  uint64_t cores = this->physicalCores.size();
+  if (true && (this->quotaCores > 0) && (this->quotaCores < cores)) {
+    cores = this->quotaCores;
+  }
+
+  return cores;
+}
+
+const std::vector<std::vector<uint32_t>> &NoelleTopology::getPhysicalCores(
+    void) {
+  std::call_once(this->discovery, [this]() { this->discover(); });
+
+  return this->physicalCores;
+}
+
+uint32_t NoelleTopology::getLastLevelCache(uint32_t logicalCore) {
+  std::call_once(this->discovery, [this]() { this->discover(); });
+  auto it = this->lastLevelCaches.find(logicalCore);
+  if (it == this->lastLevelCaches.end()) {
+    return 0;
+  }
+
+  return it->second;
+}
+
+const std::vector<uint32_t> &NoelleTopology::getNUMANodes(void) {
+  std::call_once(this->discovery, [this]() { this->discover(); });
+
+  return this->nodes;
+}
+
+void NoelleTopology::discover(void) {
+  this->computeAllowedCores();
+  this->computePhysicalCores();
+  this->computeLastLevelCaches();
+  this->computeNodes();
+  this->computeQuota();
+
+  /*
+   * Print the topology if requested.
+   */
+  auto reportEnvVar = getenv("NOELLE_TOPOLOGY_REPORT");
+  if (true && (reportEnvVar != nullptr) && (atoi(reportEnvVar) != 0)) {
+    this->printReport();
+  }
+
+  return;
+}
+
+void NoelleTopology::computeAllowedCores(void) {
+  cpu_set_t allowedSet;
+  CPU_ZERO(&allowedSet);
+  if (sched_getaffinity(0, sizeof(allowedSet), &allowedSet) == 0) {
+    for (auto core = 0; core < CPU_SETSIZE; core++) {
+      if (CPU_ISSET(core, &allowedSet)) {
+        this->allowedCores.push_back(core);
+      }
+    }
+  }
+  if (this->allowedCores.size() == 0) {
+    auto cores = std::max(std::thread::hardware_concurrency(), 1u);
+    for (auto core = 0u; core < cores; core++) {
+      this->allowedCores.push_back(core);
+    }
+  }
+
+  return;
+}
+
+void NoelleTopology::computePhysicalCores(void) {
+
+  /*
+   * Identify the physical core of each allowed logical core by its package
+   * and its core ID.
+   */
+  auto logicalCores = std::max(std::thread::hardware_concurrency(), 1u);
+  auto assumedPhysicalCores = std::max(logicalCores / 2, 1u);
+  std::map<std::pair<uint64_t, uint64_t>, std::vector<uint32_t>> coresByID;
+  for (auto core : this->allowedCores) {
+    char fileName[128];
+    uint64_t package, coreID;
+    snprintf(fileName,
+             sizeof(fileName),
+             "/sys/devices/system/cpu/cpu%u/topology/physical_package_id",
+             core);
+    auto known = NOELLE_readUnsigned(fileName, &package);
+    snprintf(fileName,
+             sizeof(fileName),
+             "/sys/devices/system/cpu/cpu%u/topology/core_id",
+             core);
+    known &= NOELLE_readUnsigned(fileName, &coreID);
+    if (!known) {
+      package = 0;
+      coreID = core % assumedPhysicalCores;
+    }
+    coresByID[std::make_pair(package, coreID)].push_back(core);
+  }
+
+  /*
+   * Sort the physical cores by their first logical core.
+   */
+  for (auto &idAndCores : coresByID) {
+    this->physicalCores.push_back(idAndCores.second);
+  }
+  std::sort(this->physicalCores.begin(),
+            this->physicalCores.end(),
+            [](const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) {
+              return a[0] < b[0];
+            });
+
+  return;
+}
+
+void NoelleTopology::computeLastLevelCaches(void) {
+
+  /*
+   * The last level cache of a logical core is its cache with the highest
+   * level. If the caches are not exposed, then we fall back to the package.
+   */
+  for (auto core : this->allowedCores) {
+    uint64_t highestLevel = 0;
+    uint64_t cacheID = 0;
+    auto found = false;
+    for (auto index = 0;; index++) {
+      char fileName[128];
+      uint64_t level;
+      snprintf(fileName,
+               sizeof(fileName),
+               "/sys/devices/system/cpu/cpu%u/cache/index%d/level",
+               core,
+               index);
+      if (!NOELLE_readUnsigned(fileName, &level)) {
+        break;
+      }
+      if (level < highestLevel) {
+        continue;
+      }
+      snprintf(fileName,
+               sizeof(fileName),
+               "/sys/devices/system/cpu/cpu%u/cache/index%d/shared_cpu_list",
+               core,
+               index);
+      std::vector<uint32_t> sharingCores;
+      if (true && NOELLE_readList(fileName, sharingCores)
+          && (sharingCores.size() > 0)) {
+        highestLevel = level;
+        cacheID = sharingCores[0];
+        found = true;
+      }
+    }
+    if (!found) {
+      char fileName[128];
+      snprintf(fileName,
+               sizeof(fileName),
+               "/sys/devices/system/cpu/cpu%u/topology/physical_package_id",
+               core);
+      NOELLE_readUnsigned(fileName, &cacheID);
+    }
+    this->lastLevelCaches[core] = cacheID;
+  }
+
+  return;
+}
+
+void NoelleTopology::computeNodes(void) {
+  if (!NOELLE_readList("/sys/devices/system/node/online", this->nodes)) {
+    this->nodes.clear();
+  }
+  if (this->nodes.size() == 0) {
+    this->nodes.push_back(0);
+  }
+
+  return;
+}
+
+void NoelleTopology::computeQuota(void) {
+
+  /*
+   * Check the quota of cgroup v2 (e.g., "200000 100000" or "max 100000").
+   */
+  auto file = fopen("/sys/fs/cgroup/cpu.max", "r");
+  if (file != nullptr) {
+    unsigned long long quota, period;
+    if (true && (fscanf(file, "%llu %llu", &quota, &period) == 2)
+        && (period > 0)) {
+      this->quotaCores = std::max((quota + period - 1) / period, 1ULL);
+    }
+    fclose(file);
+    return;
+  }
+
+  /*
+   * Check the quota of cgroup v1, where -1 means no quota.
+   */
+  for (auto cgroupDirectory :
+       { "/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct" }) {
+    char fileName[128];
+    snprintf(fileName,
+             sizeof(fileName),
+             "%s/cpu.cfs_quota_us",
+             cgroupDirectory);
+    file = fopen(fileName, "r");
+    if (file == nullptr) {
+      continue;
+    }
+    long long quota = -1;
+    auto read = (fscanf(file, "%lld", &quota) == 1);
+    fclose(file);
+    snprintf(fileName,
+             sizeof(fileName),
+             "%s/cpu.cfs_period_us",
+             cgroupDirectory);
+    uint64_t period = 0;
+    if (true && read && (quota > 0) && NOELLE_readUnsigned(fileName, &period)
+        && (period > 0)) {
+      this->quotaCores =
+          std::max((((uint64_t)quota) + period - 1) / period, (uint64_t)1);
+    }
+    return;
+  }
+
+  return;
+}
+
+void NoelleTopology::printReport(void) const {
+  std::unordered_set<uint32_t> caches;
+  for (auto &coreAndCache : this->lastLevelCaches) {
+    caches.insert(coreAndCache.second);
+  }
+  fprintf(stderr,
+          "NOELLE: Topology: %llu allowed logical cores, %llu physical cores, "
+          "%llu last level caches, %llu NUMA nodes\n",
+          (unsigned long long)this->allowedCores.size(),
+          (unsigned long long)this->physicalCores.size(),
+          (unsigned long long)caches.size(),
+          (unsigned long long)this->nodes.size());
+  if (this->quotaCores > 0) {
+    fprintf(stderr,
+            "NOELLE: Topology: CPU quota of %llu cores\n",
+            (unsigned long long)this->quotaCores);
+  }
+
+  return;
+}
+
+static NoelleTopology topology{};
+
+/**********************************************************************
+ *                Core arbiter of the node
+ **********************************************************************/
+
+/*
+ * Maximum number of processes that can share an arbiter at once.
+ */
+#define NOELLE_CORE_ARBITER_PROCESSES 256
+
+/*
+ * Default name of the shared memory segment of the arbiter (in /dev/shm).
+ */
+#define NOELLE_CORE_ARBITER_DEFAULT_NAME "noelle_core_arbiter"
+
+/*
+ * States of the segment of an arbiter.
+ */
+#define NOELLE_CORE_ARBITER_UNINITIALIZED 0
+#define NOELLE_CORE_ARBITER_INITIALIZING 1
+#define NOELLE_CORE_ARBITER_READY 2
+
+/*
+ * Process registered with an arbiter.
+ * The PID is 0 for free entries and -1 for entries being reclaimed.
+ */
+typedef struct {
+  std::atomic<int32_t> pid;
+  std::atomic<int64_t> leasedCores;
+} NoelleCoreArbiterProcess_t;
+
+/*
+ * Shared memory segment of an arbiter.
+ */
+typedef struct {
+  std::atomic<uint32_t> state;
+  std::atomic<int64_t> idleCores;
+  int64_t capacity;
+  NoelleCoreArbiterProcess_t processes[NOELLE_CORE_ARBITER_PROCESSES];
+} NoelleCoreArbiterSegment_t;
+
+static_assert(std::atomic<int64_t>::is_always_lock_free,
+              "The core arbiter needs address-free 64-bit atomics");
+
+/*
+ * Arbiter of the cores of the node among the processes that run NOELLE
+ * parallelized code.
+ *
+ * Processes that set the environment variable NOELLE_CORE_ARBITER share a
+ * pool of cores through a segment in /dev/shm. Setting the variable to 1 uses
+ * the default segment; any other value is the name of the segment to use.
+ * The first process that maps the segment initializes the pool with
+ * NOELLE_CORE_ARBITER_CORES cores, or with the usable physical cores by
+ * default.
+ *
+ * A process leases cores when it reserves them for a parallel region (the
+ * core of the caller included), and it returns them when the region ends.
+ * Hence, the cores running parallel regions across the node never exceed the
+ * pool, except for the callers that run their region sequentially.
+ * The cores leased by processes that died are reclaimed when a new process
+ * registers.
+ */
+class NoelleCoreArbiter {
+public:
+  NoelleCoreArbiter();
+
+  bool isEnabled(void) const;
+
+  /*
+   * Lease up to @coresRequested cores, and at least @minimumCores.
+   * Return the number of cores leased.
+   */
+  uint32_t lease(uint32_t coresRequested, uint32_t minimumCores);
+
+  void release(uint32_t cores);
+
+  ~NoelleCoreArbiter();
+
+private:
+  NoelleCoreArbiterSegment_t *segment;
+  NoelleCoreArbiterProcess_t *process;
+
+  bool mapSegment(const char *name);
+
+  void reclaimCoresOfDeadProcesses(void);
+
+  bool registerProcess(void);
+};
+
+NoelleCoreArbiter::NoelleCoreArbiter()
+  : segment{ nullptr },
+    process{ nullptr } {
+
+  /*
+   * Check whether the arbiter is enabled.
+   */
+  auto arbiterEnvVar = getenv("NOELLE_CORE_ARBITER");
+  if (false || (arbiterEnvVar == nullptr) || (arbiterEnvVar[0] == '\0')
+      || (strcmp(arbiterEnvVar, "0") == 0)) {
+    return;
+  }
+  auto name = (strcmp(arbiterEnvVar, "1") == 0)
+                  ? NOELLE_CORE_ARBITER_DEFAULT_NAME
+                  : arbiterEnvVar;
+  if (!this->mapSegment(name)) {
+    fprintf(stderr,
+            "NOELLE: Runtime: WARNING = the core arbiter \"%s\" cannot be "
+            "used\n",
+            name);
+    this->segment = nullptr;
+    return;
+  }
+
+  /*
+   * Register the process.
+   */
+  this->reclaimCoresOfDeadProcesses();
+  if (!this->registerProcess()) {
+    fprintf(stderr,
+            "NOELLE: Runtime: WARNING = the core arbiter \"%s\" has too many "
+            "processes\n",
+            name);
+    munmap(this->segment, sizeof(NoelleCoreArbiterSegment_t));
+    this->segment = nullptr;
+  }
+
+  return;
+}
+
+bool NoelleCoreArbiter::isEnabled(void) const {
+  return this->segment != nullptr;
+}
+
+bool NoelleCoreArbiter::mapSegment(const char *name) {
+
+  /*
+   * Open the segment.
+   * Every process sizes it, which does not change the content of a segment
+   * that already exists.
+   */
+  std::string fileName{ "/dev/shm/" };
+  fileName.append((name[0] == '/') ? (name + 1) : name);
+  auto fd = open(fileName.c_str(), O_RDWR | O_CREAT, 0600);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, sizeof(NoelleCoreArbiterSegment_t)) != 0) {
+    close(fd);
+    return false;
+  }
+  auto memory = mmap(nullptr,
+                     sizeof(NoelleCoreArbiterSegment_t),
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED,
+                     fd,
+                     0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+  this->segment = (NoelleCoreArbiterSegment_t *)memory;
+
+  /*
+   * Initialize the segment if we are the first process that maps it.
+   */
+  uint32_t state = NOELLE_CORE_ARBITER_UNINITIALIZED;
+  if (this->segment->state.compare_exchange_strong(
+          state,
+          NOELLE_CORE_ARBITER_INITIALIZING)) {
+    int64_t capacity = topology.getNumberOfUsablePhysicalCores();
+    auto coresEnvVar = getenv("NOELLE_CORE_ARBITER_CORES");
+    if (coresEnvVar != nullptr) {
+      capacity = std::max(atoll(coresEnvVar), 1LL);
+    }
+    this->segment->capacity = capacity;
+    this->segment->idleCores.store(capacity);
+    this->segment->state.store(NOELLE_CORE_ARBITER_READY,
+                               std::memory_order_release);
+    return true;
+  }
+
+  /*
+   * Wait for the process that initializes the segment.
+   * We give up if it does not complete (e.g., because it died).
+   */
+  for (auto attempt = 0; attempt < 1000; attempt++) {
+    if (this->segment->state.load(std::memory_order_acquire)
+        == NOELLE_CORE_ARBITER_READY) {
+      return true;
+    }
+    usleep(1000);
+  }
+  munmap(this->segment, sizeof(NoelleCoreArbiterSegment_t));
+
+  return false;
+}
+
+void NoelleCoreArbiter::reclaimCoresOfDeadProcesses(void) {
+  for (auto &entry : this->segment->processes) {
+    auto pid = entry.pid.load();
+    if (false || (pid <= 0) || (kill(pid, 0) == 0) || (errno != ESRCH)) {
+      continue;
+    }
+
+    /*
+     * Take the entry so that no other process reclaims it too.
+     */
+    if (!entry.pid.compare_exchange_strong(pid, -1)) {
+      continue;
+    }
+    auto leasedCores = entry.leasedCores.exchange(0);
+    this->segment->idleCores.fetch_add(leasedCores);
+    entry.pid.store(0);
+  }
+
+  return;
+}
+
+bool NoelleCoreArbiter::registerProcess(void) {
+  int32_t pid = getpid();
+  for (auto &entry : this->segment->processes) {
+    int32_t freePID = 0;
+    if (entry.pid.compare_exchange_strong(freePID, pid)) {
+      entry.leasedCores.store(0);
+      this->process = &entry;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint32_t NoelleCoreArbiter::lease(uint32_t coresRequested,
+                                  uint32_t minimumCores) {
+
+  /*
+   * Take the idle cores of the pool we need.
+   * The minimum is leased even if the pool is empty.
+   */
+  int64_t cores;
+  auto idleCores = this->segment->idleCores.load();
+  do {
+    cores = std::min((int64_t)coresRequested, std::max(idleCores, (int64_t)0));
+    cores = std::max(cores, (int64_t)minimumCores);
+  } while (!this->segment->idleCores.compare_exchange_weak(idleCores,
+                                                           idleCores - cores));
+  this->process->leasedCores.fetch_add(cores);
+
+  return cores;
+}
+
+void NoelleCoreArbiter::release(uint32_t cores) {
+  this->process->leasedCores.fetch_sub(cores);
+  this->segment->idleCores.fetch_add(cores);
+
+  return;
+}
+
+NoelleCoreArbiter::~NoelleCoreArbiter() {
+  if (!this->isEnabled()) {
+    return;
+  }
+
+  /*
+   * Return the cores still leased and unregister the process.
+   */
+  auto leasedCores = this->process->leasedCores.exchange(0);
+  this->segment->idleCores.fetch_add(leasedCores);
+  this->process->pid.store(0);
+  munmap(this->segment, sizeof(NoelleCoreArbiterSegment_t));
+
+  return;
+}
+
+static NoelleCoreArbiter coreArbiter{};
+
+/**********************************************************************
+ *                Energy counters of the machine
+ **********************************************************************/
+
+/*
+ * Energy consumed by the packages of the machine, as reported by the RAPL
+ * counters of the powercap interface of Linux.
+ *
+ * Counters are sampled by "read" and their difference is computed by
+ * "getJoules", which accounts for counters that wrapped around. Reading them
+ * might need privileges (see /sys/class/powercap/intel-rapl:N/energy_uj).
+ */
+class NoelleEnergyMeter {
+public:
+  NoelleEnergyMeter();
+
+  bool isAvailable(void);
+
+  bool read(std::vector<uint64_t> *sample);
+
+  double getJoules(std::vector<uint64_t> const &start,
+                   std::vector<uint64_t> const &end);
+
+private:
+  std::once_flag discovery;
+  std::vector<std::string> counters;
+  std::vector<uint64_t> ranges;
+
+  void discover(void);
+};
+
+NoelleEnergyMeter::NoelleEnergyMeter() {
+  return;
+}
+
+void NoelleEnergyMeter::discover(void) {
+
+  /*
+   * Fetch the counters of the packages that can be read.
+   * Sub-domains (e.g., intel-rapl:0:0) are already included in their package.
+   */
+  for (auto package = 0;; package++) {
+    char directory[128];
+    snprintf(directory,
+             sizeof(directory),
+             "/sys/class/powercap/intel-rapl:%d",
+             package);
+    std::string counter{ directory };
+    counter.append("/energy_uj");
+    std::string range{ directory };
+    range.append("/max_energy_range_uj");
+    uint64_t energy, maxEnergy;
+    if (!NOELLE_readUnsigned(range.c_str(), &maxEnergy)) {
+      break;
+    }
+    if (!NOELLE_readUnsigned(counter.c_str(), &energy)) {
+      continue;
+    }
+    this->counters.push_back(counter);
+    this->ranges.push_back(maxEnergy);
+  }
+
+  return;
+}
+
+bool NoelleEnergyMeter::isAvailable(void) {
+  std::call_once(this->discovery, [this]() { this->discover(); });
+
+  return this->counters.size() > 0;
+}
+
+bool NoelleEnergyMeter::read(std::vector<uint64_t> *sample) {
+  if (!this->isAvailable()) {
+    return false;
+  }
+  sample->resize(this->counters.size());
+  for (auto i = 0u; i < this->counters.size(); i++) {
+    if (!NOELLE_readUnsigned(this->counters[i].c_str(), &(*sample)[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+double NoelleEnergyMeter::getJoules(std::vector<uint64_t> const &start,
+                                    std::vector<uint64_t> const &end) {
+  uint64_t microjoules = 0;
+  for (auto i = 0u; i < std::min(start.size(), end.size()); i++) {
+    if (end[i] >= start[i]) {
+      microjoules += end[i] - start[i];
+    } else {
+      microjoules += (this->ranges[i] - start[i]) + end[i];
+    }
+  }
+
+  return ((double)microjoules) / 1000000;
+}
+
+static NoelleEnergyMeter energyMeter{};
+
+/**********************************************************************
+ *                Memory of the runtime
+ **********************************************************************/
+
+/*
+ * Policies to place the memory shared by the tasks of parallelized loops.
+ *
+ * The page size is selected by the environment variable NOELLE_HUGE_PAGES:
+ * "none" (the default), "transparent" (the kernel is asked to back the
+ * blocks with huge pages when it can), or "explicit" (the blocks are mapped
+ * from the pool of huge pages of the system, or with transparent huge pages
+ * when the pool is empty).
+ *
+ * The memory node is selected by the environment variable
+ * NOELLE_NUMA_POLICY: "default" (the policy of the thread that touches the
+ * page first), "local" (the node of the thread that allocates the block), or
+ * "interleave" (the pages are spread across all nodes).
+ */
+#define NOELLE_HUGE_PAGES_NONE 0
+#define NOELLE_HUGE_PAGES_TRANSPARENT 1
+#define NOELLE_HUGE_PAGES_EXPLICIT 2
+
+#define NOELLE_NUMA_DEFAULT 0
+#define NOELLE_NUMA_LOCAL 1
+#define NOELLE_NUMA_INTERLEAVE 2
+
+/*
+ * Bytes of a huge page.
+ * Only blocks of at least this size are backed by huge pages.
+ */
+#define NOELLE_HUGE_PAGE_BYTES (2ULL * 1024 * 1024)
+
+/*
+ * Modes of the mbind system call (see linux/mempolicy.h).
+ */
+#define NOELLE_MPOL_PREFERRED 1
+#define NOELLE_MPOL_INTERLEAVE 3
+
+/*
+ * Allocator of the memory shared by the tasks of parallelized loops (e.g.,
+ * the arrays of the HELIX sequential segments, the slots of the DSWP queues,
+ * and the private copies of memory objects).
+ *
+ * Blocks of at least a page are mapped directly when huge pages or a NUMA
+ * policy are requested. All other blocks come from posix_memalign.
+ * Blocks are aligned to the cache line.
+ *
+ * Setting the environment variable NOELLE_MEMORY_REPORT to 1 prints at exit
+ * how many bytes have been placed with each page size and NUMA policy.
+ */
+class NoelleMemoryAllocator {
+public:
+  NoelleMemoryAllocator();
+
+  void *allocate(uint64_t bytes);
+
+  void release(void *memory, uint64_t bytes);
+
+  ~NoelleMemoryAllocator();
+
+private:
+  uint32_t hugePages;
+  uint32_t numaPolicy;
+  bool reportEnabled;
+  uint64_t pageBytes;
+
+  /*
+   * Nodes to interleave the pages across.
+   */
+  std::vector<unsigned long> interleavedNodes;
+  uint64_t numberOfNodes;
+
+  /*
+   * Bytes placed since the start of the program.
+   */
+  std::atomic<uint64_t> heapBytes;
+  std::atomic<uint64_t> regularPageBytes;
+  std::atomic<uint64_t> transparentHugePageBytes;
+  std::atomic<uint64_t> explicitHugePageBytes;
+  std::atomic<uint64_t> explicitHugePageFallbacks;
+  std::atomic<uint64_t> localBytes;
+  std::atomic<uint64_t> interleavedBytes;
+  std::atomic<uint64_t> policyFailures;
+
+  bool isMapped(uint64_t bytes) const;
+
+  bool isBackedByHugePages(uint64_t bytes) const;
+
+  uint64_t getMappedBytes(uint64_t bytes) const;
+
+  void *map(uint64_t bytes, bool explicitHugePages);
+
+  void applyNUMAPolicy(void *memory, uint64_t bytes);
+
+  void computeNodes(void);
+};
+
+NoelleMemoryAllocator::NoelleMemoryAllocator()
+  : hugePages{ NOELLE_HUGE_PAGES_NONE },
+    numaPolicy{ NOELLE_NUMA_DEFAULT },
+    reportEnabled{ false },
+    pageBytes{ 4096 },
+    numberOfNodes{ 1 },
+    heapBytes{ 0 },
+    regularPageBytes{ 0 },
+    transparentHugePageBytes{ 0 },
+    explicitHugePageBytes{ 0 },
+    explicitHugePageFallbacks{ 0 },
+    localBytes{ 0 },
+    interleavedBytes{ 0 },
+    policyFailures{ 0 } {
+  auto systemPageBytes = sysconf(_SC_PAGESIZE);
+  if (systemPageBytes > 0) {
+    this->pageBytes = systemPageBytes;
+  }
+
+  /*
+   * Fetch the page size.
+   */
+  auto hugePagesEnvVar = getenv("NOELLE_HUGE_PAGES");
+  if (hugePagesEnvVar != nullptr) {
+    std::string hugePages{ hugePagesEnvVar };
+    if (hugePages == "none") {
+      this->hugePages = NOELLE_HUGE_PAGES_NONE;
+    } else if (hugePages == "transparent") {
+      this->hugePages = NOELLE_HUGE_PAGES_TRANSPARENT;
+    } else if (hugePages == "explicit") {
+      this->hugePages = NOELLE_HUGE_PAGES_EXPLICIT;
+    } else {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = huge pages \"%s\" do not exist\n",
+              hugePagesEnvVar);
+      abort();
+    }
+  }
+
+  /*
+   * Fetch the NUMA policy.
+   */
+  auto numaPolicyEnvVar = getenv("NOELLE_NUMA_POLICY");
+  if (numaPolicyEnvVar != nullptr) {
+    std::string policy{ numaPolicyEnvVar };
+    if (policy == "default") {
+      this->numaPolicy = NOELLE_NUMA_DEFAULT;
+    } else if (policy == "local") {
+      this->numaPolicy = NOELLE_NUMA_LOCAL;
+    } else if (policy == "interleave") {
+      this->numaPolicy = NOELLE_NUMA_INTERLEAVE;
+      this->computeNodes();
+    } else {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = NUMA policy \"%s\" does not exist\n",
+              numaPolicyEnvVar);
+      abort();
+    }
+  }
+
+  /*
+   * Check whether the placement must be reported.
+   */
+  auto reportEnvVar = getenv("NOELLE_MEMORY_REPORT");
+  if (reportEnvVar != nullptr) {
+    this->reportEnabled = (atoi(reportEnvVar) != 0);
+  }
+
+  return;
+}
+
+void *NoelleMemoryAllocator::allocate(uint64_t bytes) {
+
+  /*
+   * Small blocks and blocks without a placement come from the heap.
+   */
+  if (!this->isMapped(bytes)) {
+    void *memory = nullptr;
+    if (posix_memalign(&memory, CACHE_LINE_SIZE, bytes) != 0) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = not enough memory to allocate %llu "
+              "bytes\n",
+              (unsigned long long)bytes);
+      abort();
+    }
+    this->heapBytes += bytes;
+
+    return memory;
+  }
+
+  /*
+   * Map the pages.
+   * Explicit huge pages might be exhausted. In this case, we fall back to
+   * transparent ones.
+   */
+  auto mappedBytes = this->getMappedBytes(bytes);
+  void *memory = nullptr;
+  auto hugePages = this->isBackedByHugePages(bytes);
+  if (hugePages && (this->hugePages == NOELLE_HUGE_PAGES_EXPLICIT)) {
+    memory = this->map(mappedBytes, true);
+    if (memory != nullptr) {
+      this->explicitHugePageBytes += mappedBytes;
+    } else {
+      this->explicitHugePageFallbacks++;
+    }
+  }
+  if (memory == nullptr) {
+    memory = this->map(mappedBytes, false);
+    if (memory == nullptr) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = not enough memory to allocate %llu "
+              "bytes\n",
+              (unsigned long long)bytes);
+      abort();
+    }
+    if (hugePages) {
+#ifdef MADV_HUGEPAGE
+      madvise(memory, mappedBytes, MADV_HUGEPAGE);
+#endif
+      this->transparentHugePageBytes += mappedBytes;
+    } else {
+      this->regularPageBytes += mappedBytes;
+    }
+  }
+
+  /*
+   * Place the pages.
+   * This must happen before the pages are touched.
+   */
+  this->applyNUMAPolicy(memory, mappedBytes);
+
+  return memory;
+}
+
+void NoelleMemoryAllocator::release(void *memory, uint64_t bytes) {
+  if (memory == nullptr) {
+    return;
+  }
+  if (!this->isMapped(bytes)) {
+    free(memory);
+    return;
+  }
+  munmap(memory, this->getMappedBytes(bytes));
+
+  return;
+}
+
+bool NoelleMemoryAllocator::isMapped(uint64_t bytes) const {
+  if (true && (this->hugePages == NOELLE_HUGE_PAGES_NONE)
+      && (this->numaPolicy == NOELLE_NUMA_DEFAULT)) {
+    return false;
+  }
+
+  return bytes >= this->pageBytes;
+}
+
+bool NoelleMemoryAllocator::isBackedByHugePages(uint64_t bytes) const {
+  return (this->hugePages != NOELLE_HUGE_PAGES_NONE)
+         && (bytes >= NOELLE_HUGE_PAGE_BYTES);
+}
+
+uint64_t NoelleMemoryAllocator::getMappedBytes(uint64_t bytes) const {
+  auto unit = this->isBackedByHugePages(bytes) ? NOELLE_HUGE_PAGE_BYTES
+                                               : this->pageBytes;
+
+  return ((bytes + unit - 1) / unit) * unit;
+}
+
+void *NoelleMemoryAllocator::map(uint64_t bytes, bool explicitHugePages) {
+
+  /*
+   * Map from the pool of huge pages.
+   */
+  if (explicitHugePages) {
+#ifdef MAP_HUGETLB
+    auto memory = mmap(nullptr,
+                       bytes,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                       -1,
+                       0);
+    if (memory != MAP_FAILED) {
+      return memory;
+    }
+#endif
+    return nullptr;
+  }
+
+  /*
+   * Map regular pages.
+   * Transparent huge pages need regions aligned to a huge page, so we map a
+   * larger region and we unmap what is outside the aligned one.
+   */
+  auto alignment = this->isBackedByHugePages(bytes) ? NOELLE_HUGE_PAGE_BYTES
+                                                    : this->pageBytes;
+  auto paddedBytes = bytes + alignment - this->pageBytes;
+  auto region = mmap(nullptr,
+                     paddedBytes,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1,
+                     0);
+  if (region == MAP_FAILED) {
+    return nullptr;
+  }
+  auto start = (uintptr_t)region;
+  auto alignedStart = ((start + alignment - 1) / alignment) * alignment;
+  auto end = start + paddedBytes;
+  auto alignedEnd = alignedStart + bytes;
+  if (alignedStart > start) {
+    munmap(region, alignedStart - start);
+  }
+  if (end > alignedEnd) {
+    munmap((void *)alignedEnd, end - alignedEnd);
+  }
+
+  return (void *)alignedStart;
+}
+
+void NoelleMemoryAllocator::applyNUMAPolicy(void *memory, uint64_t bytes) {
+#ifdef SYS_mbind
+
+  /*
+   * The kernel reads one bit less than the size given for a node mask, hence
+   * the extra bit passed to mbind.
+   */
+  switch (this->numaPolicy) {
+    case NOELLE_NUMA_LOCAL: {
+
+      /*
+       * Prefer the node of the current thread.
+       */
+      unsigned cpu = 0;
+      unsigned node = 0;
+      if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        this->policyFailures++;
+        return;
+      }
+      auto bitsPerWord = sizeof(unsigned long) * 8;
+      std::vector<unsigned long> nodes((node / bitsPerWord) + 1, 0);
+      nodes[node / bitsPerWord] |= 1UL << (node % bitsPerWord);
+      if (syscall(SYS_mbind,
+                  memory,
+                  bytes,
+                  NOELLE_MPOL_PREFERRED,
+                  nodes.data(),
+                  nodes.size() * bitsPerWord + 1,
+                  0)
+          != 0) {
+        this->policyFailures++;
+        return;
+      }
+      this->localBytes += bytes;
+      break;
+    }
+
+    case NOELLE_NUMA_INTERLEAVE: {
+      auto bitsPerWord = sizeof(unsigned long) * 8;
+      if (syscall(SYS_mbind,
+                  memory,
+                  bytes,
+                  NOELLE_MPOL_INTERLEAVE,
+                  this->interleavedNodes.data(),
+                  this->interleavedNodes.size() * bitsPerWord + 1,
+                  0)
+          != 0) {
+        this->policyFailures++;
+        return;
+      }
+      this->interleavedBytes += bytes;
+      break;
+    }
+  }
+#else
+  if (this->numaPolicy != NOELLE_NUMA_DEFAULT) {
+    this->policyFailures++;
+  }
+#endif
+
+  return;
+}
+
+void NoelleMemoryAllocator::computeNodes(void) {
+
+  /*
+   * Build the mask of the nodes that are online.
+   */
+  auto bitsPerWord = sizeof(unsigned long) * 8;
+  auto &nodes = topology.getNUMANodes();
+  this->interleavedNodes.clear();
+  for (auto node : nodes) {
+    if (this->interleavedNodes.size() <= (node / bitsPerWord)) {
+      this->interleavedNodes.resize((node / bitsPerWord) + 1, 0);
+    }
+    this->interleavedNodes[node / bitsPerWord] |= 1UL << (node % bitsPerWord);
+  }
+  this->numberOfNodes = nodes.size();
+
+  return;
+}
+
+NoelleMemoryAllocator::~NoelleMemoryAllocator() {
+  if (!this->reportEnabled) {
+    return;
+  }
+  fprintf(stderr,
+          "NOELLE: Memory: %llu bytes from the heap, %llu bytes in pages of "
+          "%llu bytes\n",
+          (unsigned long long)this->heapBytes.load(),
+          (unsigned long long)this->regularPageBytes.load(),
+          (unsigned long long)this->pageBytes);
+  fprintf(stderr,
+          "NOELLE: Memory: %llu bytes in transparent huge pages, %llu bytes "
+          "in explicit huge pages, %llu fallbacks from explicit to "
+          "transparent huge pages\n",
+          (unsigned long long)this->transparentHugePageBytes.load(),
+          (unsigned long long)this->explicitHugePageBytes.load(),
+          (unsigned long long)this->explicitHugePageFallbacks.load());
+  fprintf(stderr,
+          "NOELLE: Memory: %llu bytes on the node of their allocator, %llu "
+          "bytes interleaved across %llu nodes, %llu placement failures\n",
+          (unsigned long long)this->localBytes.load(),
+          (unsigned long long)this->interleavedBytes.load(),
+          (unsigned long long)this->numberOfNodes,
+          (unsigned long long)this->policyFailures.load());
+
+  return;
+}
+
+/*
+ * The allocator must be constructed before, and destroyed after, the
+ * structures of the runtime that use it.
+ */
+static NoelleMemoryAllocator runtimeMemory{};
+
+/**********************************************************************
+ *                Thread-caching allocator of the tasks
+ **********************************************************************/
+
+/*
+ * Blocks of the thread-caching allocator are grouped in classes of sizes that
+ * are powers of 2, from 2^NOELLE_TASK_ALLOCATOR_MIN_CLASS_SHIFT bytes to
+ * 2^(NOELLE_TASK_ALLOCATOR_MIN_CLASS_SHIFT + NOELLE_TASK_ALLOCATOR_CLASSES - 1)
+ * bytes (header included). Larger blocks come from malloc.
+ */
+#define NOELLE_TASK_ALLOCATOR_MIN_CLASS_SHIFT 5
+#define NOELLE_TASK_ALLOCATOR_CLASSES 12
+
+/*
+ * Blocks are carved from chunks of 2^NOELLE_TASK_ALLOCATOR_CHUNK_SHIFT bytes,
+ * which are aligned to their size.
+ */
+#define NOELLE_TASK_ALLOCATOR_CHUNK_SHIFT 20
+#define NOELLE_TASK_ALLOCATOR_CHUNK_BYTES                                      \
+  (1ULL << NOELLE_TASK_ALLOCATOR_CHUNK_SHIFT)
+
+/*
+ * Bits of the addresses of the chunks used by each of the two levels of the
+ * map of the chunks (user-space addresses have 48 bits).
+ */
+#define NOELLE_TASK_ALLOCATOR_MAP_BITS                                         \
+  ((48 - NOELLE_TASK_ALLOCATOR_CHUNK_SHIFT) / 2)
+#define NOELLE_TASK_ALLOCATOR_MAP_ENTRIES                                      \
+  (1ULL << NOELLE_TASK_ALLOCATOR_MAP_BITS)
+
+class NoelleThreadCache;
+
+/*
+ * Header of a block of the thread-caching allocator.
+ * It keeps the 16-byte alignment malloc guarantees.
+ */
+typedef struct {
+  NoelleThreadCache *owner;
+  uint64_t sizeClass;
+} NOELLE_taskBlockHeader_t;
+
+/*
+ * Free block of the thread-caching allocator.
+ */
+typedef struct NOELLE_taskFreeBlock {
+  struct NOELLE_taskFreeBlock *next;
+} NOELLE_taskFreeBlock_t;
+
+/*
+ * Cache of the free blocks of a thread.
+ *
+ * Only the thread of the cache allocates from it, so its free lists need no
+ * synchronization. Blocks freed by other threads are pushed to the list of
+ * remote frees of the cache, which its thread moves to its free lists once
+ * they run out of blocks.
+ *
+ * Caches are never destroyed, as their blocks can outlive their threads.
+ */
+class NoelleThreadCache {
+public:
+  NoelleThreadCache();
+
+  void *allocate(uint64_t sizeClass);
+
+  void release(NOELLE_taskBlockHeader_t *header);
+
+  void releaseRemotely(NOELLE_taskBlockHeader_t *header);
+
+private:
+  NOELLE_taskFreeBlock_t *freeLists[NOELLE_TASK_ALLOCATOR_CLASSES];
+  uint8_t *chunkCursor;
+  uint8_t *chunkEnd;
+  alignas(CACHE_LINE_SIZE) std::atomic<NOELLE_taskFreeBlock_t *> remoteFrees;
+
+  void moveRemoteFrees(void);
+
+  bool addChunk(uint64_t blockBytes);
+};
+
+/*
+ * Map of the chunks of the thread-caching allocator.
+ * It tells which blocks have been allocated by the runtime. All other blocks
+ * (e.g., the ones allocated before the tasks started) are handed back to the
+ * C library when they are freed.
+ * The second level of the map is allocated on demand and never released.
+ */
+static std::atomic<std::atomic<uint8_t> *>
+    taskChunksMap[NOELLE_TASK_ALLOCATOR_MAP_ENTRIES];
+
+static thread_local NoelleThreadCache *currentThreadCache = nullptr;
+
+static void NOELLE_registerTaskChunk(void *chunk) {
+  auto chunkID = ((uint64_t)chunk) >> NOELLE_TASK_ALLOCATOR_CHUNK_SHIFT;
+  auto firstLevel = chunkID >> NOELLE_TASK_ALLOCATOR_MAP_BITS;
+  auto secondLevel = chunkID & (NOELLE_TASK_ALLOCATOR_MAP_ENTRIES - 1);
+  assert(firstLevel < NOELLE_TASK_ALLOCATOR_MAP_ENTRIES);
+
+  /*
+   * Allocate the second level of the map if no other thread did it.
+   */
+  auto entries = taskChunksMap[firstLevel].load(std::memory_order_acquire);
+  if (entries == nullptr) {
+    auto newEntries =
+        (std::atomic<uint8_t> *)calloc(NOELLE_TASK_ALLOCATOR_MAP_ENTRIES,
+                                       sizeof(std::atomic<uint8_t>));
+    if (newEntries == nullptr) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = the map of the chunks of the tasks "
+              "could not be allocated\n");
+      abort();
+    }
+    if (taskChunksMap[firstLevel].compare_exchange_strong(
+            entries,
+            newEntries,
+            std::memory_order_acq_rel)) {
+      entries = newEntries;
+    } else {
+      free(newEntries);
+    }
+  }
+  entries[secondLevel].store(1, std::memory_order_release);
+
+  return;
+}
+
+static bool NOELLE_isTaskBlock(void *block) {
+  auto chunkID = ((uint64_t)block) >> NOELLE_TASK_ALLOCATOR_CHUNK_SHIFT;
+  auto firstLevel = chunkID >> NOELLE_TASK_ALLOCATOR_MAP_BITS;
+  if (firstLevel >= NOELLE_TASK_ALLOCATOR_MAP_ENTRIES) {
+    return false;
+  }
+  auto entries = taskChunksMap[firstLevel].load(std::memory_order_acquire);
+  if (entries == nullptr) {
+    return false;
+  }
+  auto secondLevel = chunkID & (NOELLE_TASK_ALLOCATOR_MAP_ENTRIES - 1);
+
+  return entries[secondLevel].load(std::memory_order_acquire) != 0;
+}
+
+/*
+ * Return the class of the blocks that hold @bytes bytes, or
+ * NOELLE_TASK_ALLOCATOR_CLASSES if they are too big for the thread caches.
+ */
+static uint64_t NOELLE_getTaskBlockClass(uint64_t bytes) {
+  if (bytes >= NOELLE_TASK_ALLOCATOR_CHUNK_BYTES) {
+    return NOELLE_TASK_ALLOCATOR_CLASSES;
+  }
+  auto blockBytes = bytes + sizeof(NOELLE_taskBlockHeader_t);
+  uint64_t sizeClass = 0;
+  while (true && (sizeClass < NOELLE_TASK_ALLOCATOR_CLASSES)
+         && ((1ULL << (sizeClass + NOELLE_TASK_ALLOCATOR_MIN_CLASS_SHIFT))
+             < blockBytes)) {
+    sizeClass++;
+  }
+
+  return sizeClass;
+}
+
+static NoelleThreadCache *NOELLE_getThreadCache(void) {
+  if (currentThreadCache == nullptr) {
+    currentThreadCache = new NoelleThreadCache();
+  }
+
+  return currentThreadCache;
+}
+
+NoelleThreadCache::NoelleThreadCache()
+  : chunkCursor{ nullptr },
+    chunkEnd{ nullptr },
+    remoteFrees{ nullptr } {
+  for (auto sizeClass = 0; sizeClass < NOELLE_TASK_ALLOCATOR_CLASSES;
+       sizeClass++) {
+    this->freeLists[sizeClass] = nullptr;
+  }
+
+  return;
+}
+
+void *NoelleThreadCache::allocate(uint64_t sizeClass) {
+  assert(sizeClass < NOELLE_TASK_ALLOCATOR_CLASSES);
+
+  /*
+   * Fetch the blocks freed by the other threads if the cache has none.
+   */
+  if (this->freeLists[sizeClass] == nullptr) {
+    this->moveRemoteFrees();
+  }
+
+  /*
+   * Reuse a free block.
+   */
+  NOELLE_taskBlockHeader_t *header = nullptr;
+  auto freeBlock = this->freeLists[sizeClass];
+  if (freeBlock != nullptr) {
+    this->freeLists[sizeClass] = freeBlock->next;
+    header = (NOELLE_taskBlockHeader_t *)freeBlock;
+
+  } else {
+
+    /*
+     * Carve a new block from the current chunk.
+     */
+    auto blockBytes =
+        1ULL << (sizeClass + NOELLE_TASK_ALLOCATOR_MIN_CLASS_SHIFT);
+    if (true && ((uint64_t)(this->chunkEnd - this->chunkCursor) < blockBytes)
+        && (!this->addChunk(blockBytes))) {
+      return nullptr;
+    }
+    header = (NOELLE_taskBlockHeader_t *)this->chunkCursor;
+    this->chunkCursor += blockBytes;
+  }
+  header->owner = this;
+  header->sizeClass = sizeClass;
+
+  return (void *)(header + 1);
+}
+
+void NoelleThreadCache::release(NOELLE_taskBlockHeader_t *header) {
+  auto sizeClass = header->sizeClass;
+  auto freeBlock = (NOELLE_taskFreeBlock_t *)header;
+  freeBlock->next = this->freeLists[sizeClass];
+  this->freeLists[sizeClass] = freeBlock;
+
+  return;
+}
+
+void NoelleThreadCache::releaseRemotely(NOELLE_taskBlockHeader_t *header) {
+
+  /*
+   * The class of the block stays in its header, as only the first word of the
+   * header links the block to the list.
+   */
+  auto freeBlock = (NOELLE_taskFreeBlock_t *)header;
+  auto head = this->remoteFrees.load(std::memory_order_relaxed);
+  do {
+    freeBlock->next = head;
+  } while (!this->remoteFrees.compare_exchange_weak(head,
+                                                    freeBlock,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed));
+
+  return;
+}
+
+void NoelleThreadCache::moveRemoteFrees(void) {
+  if (this->remoteFrees.load(std::memory_order_relaxed) == nullptr) {
+    return;
+  }
+
+  /*
+   * Take all the blocks at once, so the threads that push new ones never race
+   * with the removal of a single block.
+   */
+  auto freeBlock =
+      this->remoteFrees.exchange(nullptr, std::memory_order_acquire);
+  while (freeBlock != nullptr) {
+    auto next = freeBlock->next;
+    this->release((NOELLE_taskBlockHeader_t *)freeBlock);
+    freeBlock = next;
+  }
+
+  return;
+}
+
+bool NoelleThreadCache::addChunk(uint64_t blockBytes) {
+  assert(blockBytes <= NOELLE_TASK_ALLOCATOR_CHUNK_BYTES);
+
+  /*
+   * The rest of the current chunk is left unused.
+   */
+  void *chunk = nullptr;
+  if (posix_memalign(&chunk,
+                     NOELLE_TASK_ALLOCATOR_CHUNK_BYTES,
+                     NOELLE_TASK_ALLOCATOR_CHUNK_BYTES)
+      != 0) {
+    return false;
+  }
+  NOELLE_registerTaskChunk(chunk);
+  this->chunkCursor = (uint8_t *)chunk;
+  this->chunkEnd = this->chunkCursor + NOELLE_TASK_ALLOCATOR_CHUNK_BYTES;
+
+  return true;
+}
+
+/**********************************************************************
+ *                DSWP queues
+ **********************************************************************/
+
+/*
+ * Flags added to the size of a queue to request a specific implementation.
+ * These values must match the ones used by the DSWP tool.
+ */
+#define NOELLE_DSWP_BATCHED_QUEUE 1024
+#define NOELLE_DSWP_SPSC_QUEUE 2048
+#define NOELLE_DSWP_SLOT_QUEUE (1LL << 40)
+
+/*
+ * Number of values a single-producer single-consumer queue can hold.
+ * This must be a power of 2.
+ */
+#define NOELLE_DSWP_SPSC_QUEUE_CAPACITY 1024
+
+/*
+ * Bytes of the stack of a DSWP stage that shares its thread with other stages
+ * (see NOELLE_DSWPFusedTrampoline).
+ * The stack is reserved, not committed, so only the pages it touches use
+ * memory.
+ */
+#define NOELLE_DSWP_FUSED_STAGE_STACK_SIZE (8ULL << 20)
+
+/*
+ * The compiler can request the number of slots of a queue by adding their
+ * log2, shifted by NOELLE_DSWP_QUEUE_CAPACITY_SHIFT, to the size of the queue.
+ * A slot of a batched queue holds a batch.
+ * Queues without a requested capacity have NOELLE_DSWP_SPSC_QUEUE_CAPACITY
+ * slots.
+ */
+#define NOELLE_DSWP_QUEUE_CAPACITY_SHIFT 48
+#define NOELLE_DSWP_QUEUE_CAPACITY_MASK \
+  (0x3FLL << NOELLE_DSWP_QUEUE_CAPACITY_SHIFT)
+
+static inline uint64_t NOELLE_getDSWPQueueCapacity(int64_t queueSize) {
+  auto log2Capacity = (queueSize & NOELLE_DSWP_QUEUE_CAPACITY_MASK)
+                      >> NOELLE_DSWP_QUEUE_CAPACITY_SHIFT;
+  if (log2Capacity == 0) {
+    return NOELLE_DSWP_SPSC_QUEUE_CAPACITY;
+  }
+
+  return 1ULL << log2Capacity;
+}
+
+/*
+ * Stages of a DSWP pipeline that share the current thread, or nullptr if the
+ * current thread runs at most one stage (see NOELLE_DSWPFusedTrampoline).
+ */
+static thread_local void *currentFusedStages = nullptr;
+
+extern "C" {
+static bool NOELLE_switchToFusedStage(void);
+}
+
+/*
+ * Wait a little before checking again the indices of a queue.
+ * Switch to another stage that shares the current thread if there is one.
+ * Otherwise, spin first, then yield the core to the other threads.
+ */
+static inline void NOELLE_queueBackOff(uint64_t &spins) {
+  if (true && (currentFusedStages != nullptr) && NOELLE_switchToFusedStage()) {
+    return;
+  }
+  if (spins < NOELLE_DEFAULT_SPIN_BUDGET) {
+    spins++;
+    NOELLE_cpuRelax();
+  } else {
+    sched_yield();
+  }
+
+  return;
+}
+
+/*
+ * Bounded ring buffer with exactly one producer and one consumer.
+ *
+ * Each side keeps a cached copy of the index owned by the other side, so the
+ * shared indices are read only when the cached copy says that the ring looks
+ * full (for the producer) or empty (for the consumer).
+ *
+ * Each side also counts the times it had to wait for the other one (i.e., the
+ * pushes that found the ring full and the pops that found it empty). These
+ * counters are read by fetchStalls once both sides are done.
+ */
+template <typename T>
+class NoelleSPSCQueue {
+public:
+  NoelleSPSCQueue(uint64_t capacity = NOELLE_DSWP_SPSC_QUEUE_CAPACITY);
+
+  void push(T value);
+
+  void waitPop(T &value);
+
+  void fetchStalls(uint64_t *fullStalls, uint64_t *emptyStalls);
+
+  ~NoelleSPSCQueue();
+
+private:
+
+  /*
+   * Fields owned by the producer.
+   */
+  std::atomic<uint64_t> tail;
+  uint64_t cachedHead;
+  uint64_t fullStalls;
+  char producerPadding[CACHE_LINE_SIZE - sizeof(uint64_t) * 3];
+
+  /*
+   * Fields owned by the consumer.
+   */
+  std::atomic<uint64_t> head;
+  uint64_t cachedTail;
+  uint64_t emptyStalls;
+  char consumerPadding[CACHE_LINE_SIZE - sizeof(uint64_t) * 3];
+
+  uint64_t capacity;
+  T *slots;
+};
+
+template <typename T>
+NoelleSPSCQueue<T>::NoelleSPSCQueue(uint64_t capacity)
+  : tail{ 0 },
+    cachedHead{ 0 },
+    fullStalls{ 0 },
+    head{ 0 },
+    cachedTail{ 0 },
+    emptyStalls{ 0 },
+    capacity{ capacity } {
+  assert((capacity > 0) && ((capacity & (capacity - 1)) == 0));
+  this->slots = (T *)runtimeMemory.allocate(sizeof(T) * capacity);
+
+  return;
+}
+
+template <typename T>
+void NoelleSPSCQueue<T>::push(T value) {
+  auto currentTail = this->tail.load(std::memory_order_relaxed);
+
+  /*
+   * Wait for a free slot.
+   */
+  if ((currentTail - this->cachedHead) == this->capacity) {
+    this->cachedHead = this->head.load(std::memory_order_acquire);
+    if ((currentTail - this->cachedHead) == this->capacity) {
+      this->fullStalls++;
+      uint64_t spins = 0;
+      do {
+        NOELLE_queueBackOff(spins);
+        this->cachedHead = this->head.load(std::memory_order_acquire);
+      } while ((currentTail - this->cachedHead) == this->capacity);
+    }
+  }
+
+  /*
+   * Publish the value.
+   */
+  this->slots[currentTail & (this->capacity - 1)] = value;
+  this->tail.store(currentTail + 1, std::memory_order_release);
+
+  return;
+}
+
+template <typename T>
+void NoelleSPSCQueue<T>::waitPop(T &value) {
+  auto currentHead = this->head.load(std::memory_order_relaxed);
+
+  /*
+   * Wait for a value.
+   */
+  if (currentHead == this->cachedTail) {
+    this->cachedTail = this->tail.load(std::memory_order_acquire);
+    if (currentHead == this->cachedTail) {
+      this->emptyStalls++;
+      uint64_t spins = 0;
+      do {
+        NOELLE_queueBackOff(spins);
+        this->cachedTail = this->tail.load(std::memory_order_acquire);
+      } while (currentHead == this->cachedTail);
+    }
+  }
+
+  /*
+   * Consume the value.
+   */
+  value = this->slots[currentHead & (this->capacity - 1)];
+  this->head.store(currentHead + 1, std::memory_order_release);
+
+  return;
+}
+
+template <typename T>
+void NoelleSPSCQueue<T>::fetchStalls(uint64_t *fullStalls,
+                                     uint64_t *emptyStalls) {
+  *fullStalls = this->fullStalls;
+  *emptyStalls = this->emptyStalls;
+  this->fullStalls = 0;
+  this->emptyStalls = 0;
+
+  return;
+}
+
+template <typename T>
+NoelleSPSCQueue<T>::~NoelleSPSCQueue() {
+  runtimeMemory.release(this->slots, sizeof(T) * this->capacity);
+
+  return;
+}
+
+/*
+ * Single-producer single-consumer ring buffer of slots of any size.
+ *
+ * It moves values that do not fit in a 64-bit integer (e.g., structs and
+ * vectors), as well as values of the same iteration packed together by the
+ * compiler. Values are copied in and out of their slot.
+ */
+class NoelleSlotQueue {
+public:
+  NoelleSlotQueue(uint64_t slotBytes,
+                  uint64_t capacity = NOELLE_DSWP_SPSC_QUEUE_CAPACITY);
+
+  void push(const void *value);
+
+  void waitPop(void *value);
+
+  void fetchStalls(uint64_t *fullStalls, uint64_t *emptyStalls);
+
+  ~NoelleSlotQueue();
+
+private:
+
+  /*
+   * Fields owned by the producer.
+   */
+  std::atomic<uint64_t> tail;
+  uint64_t cachedHead;
+  uint64_t fullStalls;
+  char producerPadding[CACHE_LINE_SIZE - sizeof(uint64_t) * 3];
+
+  /*
+   * Fields owned by the consumer.
+   */
+  std::atomic<uint64_t> head;
+  uint64_t cachedTail;
+  uint64_t emptyStalls;
+  char consumerPadding[CACHE_LINE_SIZE - sizeof(uint64_t) * 3];
+
+  uint64_t capacity;
+  uint64_t slotBytes;
+  char *slots;
+};
+
+NoelleSlotQueue::NoelleSlotQueue(uint64_t slotBytes, uint64_t capacity)
+  : tail{ 0 },
+    cachedHead{ 0 },
+    fullStalls{ 0 },
+    head{ 0 },
+    cachedTail{ 0 },
+    emptyStalls{ 0 },
+    capacity{ capacity },
+    slotBytes{ slotBytes } {
+  assert((capacity > 0) && ((capacity & (capacity - 1)) == 0));
+  this->slots = (char *)runtimeMemory.allocate(capacity * slotBytes);
+
+  return;
+}
+
+void NoelleSlotQueue::push(const void *value) {
+  auto currentTail = this->tail.load(std::memory_order_relaxed);
+
+  /*
+   * Wait for a free slot.
+   */
+  if ((currentTail - this->cachedHead) == this->capacity) {
+    this->cachedHead = this->head.load(std::memory_order_acquire);
+    if ((currentTail - this->cachedHead) == this->capacity) {
+      this->fullStalls++;
+      uint64_t spins = 0;
+      do {
+        NOELLE_queueBackOff(spins);
+        this->cachedHead = this->head.load(std::memory_order_acquire);
+      } while ((currentTail - this->cachedHead) == this->capacity);
+    }
+  }
+
+  /*
+   * Publish the value.
+   */
+  auto slot =
+      this->slots + (currentTail & (this->capacity - 1)) * this->slotBytes;
+  memcpy(slot, value, this->slotBytes);
+  this->tail.store(currentTail + 1, std::memory_order_release);
+
+  return;
+}
+
+void NoelleSlotQueue::waitPop(void *value) {
+  auto currentHead = this->head.load(std::memory_order_relaxed);
+
+  /*
+   * Wait for a value.
+   */
+  if (currentHead == this->cachedTail) {
+    this->cachedTail = this->tail.load(std::memory_order_acquire);
+    if (currentHead == this->cachedTail) {
+      this->emptyStalls++;
+      uint64_t spins = 0;
+      do {
+        NOELLE_queueBackOff(spins);
+        this->cachedTail = this->tail.load(std::memory_order_acquire);
+      } while (currentHead == this->cachedTail);
+    }
+  }
+
+  /*
+   * Consume the value.
+   */
+  auto slot =
+      this->slots + (currentHead & (this->capacity - 1)) * this->slotBytes;
+  memcpy(value, slot, this->slotBytes);
+  this->head.store(currentHead + 1, std::memory_order_release);
+
+  return;
+}
+
+void NoelleSlotQueue::fetchStalls(uint64_t *fullStalls,
+                                  uint64_t *emptyStalls) {
+  *fullStalls = this->fullStalls;
+  *emptyStalls = this->emptyStalls;
+  this->fullStalls = 0;
+  this->emptyStalls = 0;
+
+  return;
+}
+
+NoelleSlotQueue::~NoelleSlotQueue() {
+  runtimeMemory.release(this->slots, this->capacity * this->slotBytes);
+
+  return;
+}
+
+/*
+ * Queue that moves values between one producer and one consumer in batches.
+ *
+ * The producer fills a cache-line-sized batch locally and publishes it with a
+ * single push to the underlying ring buffer. The consumer pops a whole batch
+ * and then reads its values locally.
+ */
+template <typename T>
+class NoelleBatchedQueue {
+public:
+  NoelleBatchedQueue(uint64_t capacity = NOELLE_DSWP_SPSC_QUEUE_CAPACITY);
+
+  void push(T value);
+
+  void flush(void);
+
+  void waitPop(T &value);
+
+  void fetchStalls(uint64_t *fullStalls, uint64_t *emptyStalls);
+
+private:
+  static constexpr uint32_t batchCapacity =
+      (CACHE_LINE_SIZE - sizeof(uint64_t)) / sizeof(T);
+
+  typedef struct {
+    T values[batchCapacity];
+    uint64_t size;
+  } Batch_t;
+
+  /*
+   * The padding keeps the batches of the producer and the consumer on separate
+   * cache lines.
+   */
+  Batch_t producerBatch;
+  char producerPadding[CACHE_LINE_SIZE];
+  Batch_t consumerBatch;
+  uint64_t consumerIndex;
+  char consumerPadding[CACHE_LINE_SIZE];
+  NoelleSPSCQueue<Batch_t> batches;
+};
+
+template <typename T>
+NoelleBatchedQueue<T>::NoelleBatchedQueue(uint64_t capacity)
+  : consumerIndex{ 0 },
+    batches{ capacity } {
+  this->producerBatch.size = 0;
+  this->consumerBatch.size = 0;
+
+  return;
+}
+
+template <typename T>
+void NoelleBatchedQueue<T>::push(T value) {
+
+  /*
+   * Add the value to the local batch.
+   */
+  auto size = this->producerBatch.size;
+  this->producerBatch.values[size] = value;
+  this->producerBatch.size = size + 1;
+
+  /*
+   * Publish the batch if it is full.
+   */
+  if (this->producerBatch.size == batchCapacity) {
+    this->flush();
+  }
+
+  return;
+}
+
+template <typename T>
+void NoelleBatchedQueue<T>::flush(void) {
+  if (this->producerBatch.size == 0) {
+    return;
+  }
+  this->batches.push(this->producerBatch);
+  this->producerBatch.size = 0;
+
+  return;
+}
+
+template <typename T>
+void NoelleBatchedQueue<T>::waitPop(T &value) {
+
+  /*
+   * Fetch a new batch if we consumed the current one.
+   */
+  if (this->consumerIndex == this->consumerBatch.size) {
+    this->batches.waitPop(this->consumerBatch);
+    this->consumerIndex = 0;
+  }
+  assert(this->consumerIndex < this->consumerBatch.size);
+
+  /*
+   * Read the value.
+   */
+  value = this->consumerBatch.values[this->consumerIndex];
+  this->consumerIndex++;
+
+  return;
+}
+
+template <typename T>
+void NoelleBatchedQueue<T>::fetchStalls(uint64_t *fullStalls,
+                                        uint64_t *emptyStalls) {
+  this->batches.fetchStalls(fullStalls, emptyStalls);
+
+  return;
+}
+
+/**********************************************************************
+ *                Work-stealing thread pool
+ **********************************************************************/
+
+/*
+ * Number of times an idle worker looks for a task before parking.
+ */
+#define NOELLE_POOL_SPINS_BEFORE_PARKING 1024
+
+typedef struct {
+  void (*function)(void *);
+  void *args;
+} NoelleTask_t;
+
+/*
+ * Chase-Lev work-stealing deque.
+ *
+ * Only the worker that owns the deque pushes and pops tasks from its bottom.
+ * All other workers steal tasks from its top.
+ */
+class NoelleTaskDeque {
+public:
+  NoelleTaskDeque();
+
+  void push(NoelleTask_t task);
+
+  bool pop(NoelleTask_t *task);
+
+  bool steal(NoelleTask_t *task);
+
+  ~NoelleTaskDeque();
+
+private:
+  typedef struct {
+    std::atomic<void (*)(void *)> function;
+    std::atomic<void *> args;
+  } Slot_t;
+
+  typedef struct {
+    int64_t capacity;
+    Slot_t *slots;
+  } Buffer_t;
+
+  /*
+   * The top and the bottom of the deque are kept in different cache lines
+   * because the former is written by thieves and the latter by the owner.
+   */
+  std::atomic<int64_t> top;
+  char topPadding[CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  std::atomic<int64_t> bottom;
+  char bottomPadding[CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+  std::atomic<Buffer_t *> buffer;
+
+  /*
+   * Buffers replaced by bigger ones.
+   * A thief might still be reading them, so they are freed only when the deque
+   * is destroyed.
+   */
+  std::vector<Buffer_t *> retiredBuffers;
+
+  Buffer_t *allocateBuffer(int64_t capacity);
+
+  Buffer_t *grow(Buffer_t *currentBuffer, int64_t bottom, int64_t top);
+
+  static void storeTask(Buffer_t *buffer, int64_t index, NoelleTask_t task);
+
+  static NoelleTask_t loadTask(Buffer_t *buffer, int64_t index);
+};
+
+/*
+ * Thread pool where every worker owns a work-stealing deque.
+ *
+ * Tasks submitted by a worker are pushed to its own deque.
+ * Tasks submitted by other threads (e.g., the main thread) are pushed to a
+ * shared injection queue.
+ * Idle workers first drain their own deque, then the injection queue, and
+ * finally they steal from the other workers.
+ */
+/*
+ * Workers are started lazily: a submission starts a new worker only when all
+ * the workers started so far are busy. Hence, programs that never run a
+ * parallel region have no threads of the pool.
+ */
+class NoelleThreadPool {
+public:
+  NoelleThreadPool(uint32_t numberOfWorkers);
+
+  void submitAndDetach(void (*function)(void *), void *args);
+
+  /*
+   * Run a task on the worker @workerID.
+   * Other workers cannot steal it.
+   */
+  void submitToWorker(uint32_t workerID,
+                      void (*function)(void *),
+                      void *args);
+
+  /*
+   * Run @function(@args) on the current thread if it is the last task the
+   * current thread submitted and no worker started it yet.
+   * Return whether the task ran.
+   */
+  bool runLocalTask(void (*function)(void *), void *args);
+
+  uint32_t getNumberOfWorkers(void) const;
+
+  ~NoelleThreadPool();
+
+private:
+  uint32_t numberOfWorkers;
+  std::vector<std::thread> workers;
+  std::vector<NoelleTaskDeque *> deques;
+
+  /*
+   * Workers started so far.
+   * They run on the cores the program was allowed to run on when the pool was
+   * created, rather than on the ones of the thread that starts them.
+   */
+  std::mutex startLock;
+  std::atomic<uint32_t> startedWorkers;
+  cpu_set_t workerCores;
+  bool hasWorkerCores;
+
+  /*
+   * Tasks that only a given worker can run.
+   */
+  typedef struct {
+    pthread_spinlock_t lock;
+    std::deque<NoelleTask_t> tasks;
+    std::atomic<uint64_t> size;
+  } NoelleWorkerQueue_t;
+  std::vector<NoelleWorkerQueue_t *> workerQueues;
+
+  /*
+   * Tasks submitted by threads that are not workers of the pool.
+   */
+  mutable pthread_spinlock_t injectionLock;
+  std::deque<NoelleTask_t> injectionQueue;
+  std::atomic<uint64_t> injectionQueueSize;
+
+  /*
+   * Parking of idle workers.
+   */
+  std::mutex parkingLock;
+  std::condition_variable parkingCondition;
+  std::atomic<uint64_t> submissions;
+  std::atomic<uint32_t> parkedWorkers;
+  std::atomic<bool> isShuttingDown;
+
+  void workerLoop(uint32_t workerID);
+
+  bool fetchTask(uint32_t workerID, NoelleTask_t *task);
+
+  void wakeUpWorkers(bool wakeUpAll);
+
+  void startWorkers(uint32_t count);
+};
+
+/*
+ * ID of the worker of the pool that is running on the current thread.
+ * This is -1 if the current thread does not belong to the pool.
+ */
+static thread_local int64_t currentWorkerID = -1;
+
+/*
+ * Number of cores the parallel regions invoked by the task running on the
+ * current thread can use.
+ * This is 0 if the current thread is not running a task of a parallel region.
+ */
+static thread_local uint32_t currentNestedCoreBudget = 0;
+
+/*
+ * Number of tasks spawned by NOELLE_TaskSpawn that include the code running on
+ * the current thread.
+ */
+static thread_local uint32_t currentTaskSpawnDepth = 0;
+
+/*
+ * Whether the joins of the invocations dispatched by the current thread park
+ * right away instead of spinning first (see NoelleRuntime::getJoinSpinBudget).
+ */
+static thread_local bool currentJoinParks = false;
+
+/*
+ * Team of threads that persists across consecutive invocations of
+ * parallelized loops (i.e., a persistent region).
+ *
+ * The owner of the team (i.e., the thread that opened the region) publishes
+ * an invocation by setting the tasks to run and incrementing @generation.
+ * Workers spin on @generation between invocations, and they increment
+ * @arrivals once they are done with the current one.
+ * The owner publishes the next invocation only after all workers arrived.
+ */
+class NoelleTeam {
+public:
+  NoelleTeam(uint32_t numberOfWorkers,
+             uint32_t coresReserved,
+             uint32_t nestedCoreBudget,
+             uint64_t spinBudget);
+
+  uint32_t getNumberOfWorkers(void) const;
+
+  uint32_t getCoresReserved(void) const;
+
+  uint32_t getNestedCoreBudget(void) const;
+
+  /*
+   * Mark the team as used by an invocation of the owner.
+   * Return false if the team is already used (e.g., by the invocation that
+   * includes the current one).
+   */
+  bool acquire(void);
+
+  void release(void);
+
+  /*
+   * Run @task on the first @numberOfTasks workers.
+   * The worker i receives @args + (i * @argsBytes).
+   * This does not wait for the tasks to end.
+   */
+  void run(void (*task)(void *),
+           void *args,
+           uint64_t argsBytes,
+           uint32_t numberOfTasks);
+
+  /*
+   * Wait for all workers to be done with the last invocation.
+   */
+  void wait(void);
+
+  /*
+   * Make all workers exit.
+   * The team can be deleted once this returns.
+   */
+  void stop(void);
+
+  /*
+   * Submit the workers to @threadPool.
+   */
+  void start(NoelleThreadPool *threadPool);
+
+private:
+  typedef struct {
+    NoelleTeam *team;
+    uint32_t workerID;
+  } NoelleTeamWorker_t;
+
+  uint32_t numberOfWorkers;
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  uint64_t spinBudget;
+  bool isUsed;
+  std::vector<NoelleTeamWorker_t> workers;
+
+  /*
+   * Invocation.
+   * These are written by the owner only while all workers are waiting.
+   */
+  void (*task)(void *);
+  uint8_t *taskArgs;
+  uint64_t taskArgsBytes;
+  uint32_t numberOfTasks;
+  bool isStopping;
+
+  /*
+   * Barrier.
+   */
+  std::atomic<uint64_t> generation;
+  char generationPadding[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t> arrivals;
+  char arrivalsPadding[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+
+  void publish(void);
+
+  void runWorker(uint32_t workerID);
+
+  static void workerTrampoline(void *args);
+};
+
+/*
+ * Persistent region opened by the current thread.
+ * @currentTeam is nullptr if the region runs without a team (e.g., it is
+ * nested in another one).
+ */
+static thread_local NoelleTeam *currentTeam = nullptr;
+static thread_local uint32_t currentPersistentRegionDepth = 0;
+
+/*
+ * Versions of a loop that can be selected at run time.
+ * The first one is the sequential loop, while the others are the parallelized
+ * loop run with chunks of the size of the compiler multiplied by
+ * NOELLE_ADAPTIVE_CHUNK_FACTORS.
+ */
+#define NOELLE_ADAPTIVE_VERSIONS 4
+static const int64_t NOELLE_ADAPTIVE_CHUNK_FACTORS[NOELLE_ADAPTIVE_VERSIONS] = {
+  0,
+  1,
+  4,
+  16
+};
+
+/*
+ * Invocations of a version sampled before the best one is selected.
+ */
+#define NOELLE_ADAPTIVE_MINIMUM_SAMPLES 2
+
+/*
+ * The best version is not selected once every NOELLE_ADAPTIVE_EXPLORATION
+ * invocations on average, so the selection keeps up with changes of the
+ * inputs of the loop.
+ */
+#define NOELLE_ADAPTIVE_EXPLORATION 16
+
+/*
+ * Cycles taken by the versions of a loop that can be selected at run time.
+ * @averageCycles is a moving average that weights the last invocations more.
+ */
+typedef struct {
+  uint64_t samples[NOELLE_ADAPTIVE_VERSIONS];
+  double averageCycles[NOELLE_ADAPTIVE_VERSIONS];
+} NOELLE_adaptiveLoop_t;
+
+/*
+ * Invocation of a loop that can select its version at run time.
+ * @version is -1 if the invocation is not measured.
+ */
+typedef struct {
+  NOELLE_adaptiveLoop_t *loop;
+  int32_t version;
+  uint64_t startCycles;
+} NOELLE_adaptiveInvocation_t;
+
+/*
+ * Invocations of adaptive loops that are running on the current thread.
+ * Invocations can be nested (e.g., by recursion).
+ */
+static thread_local std::vector<NOELLE_adaptiveInvocation_t>
+    currentAdaptiveInvocations;
+static thread_local uint64_t currentAdaptiveRandomState = 0;
+
+/*
+ * OpenMP runtime of the program that links NOELLE's runtime, if any.
+ * Both libgomp and libomp define it.
+ */
+extern "C" int omp_in_parallel(void) __attribute__((weak));
+
+/*
+ * How an invocation of a parallelized loop runs when its number of cores is
+ * selected online (see NoelleRuntime::getTunedInvocation).
+ */
+typedef struct {
+  uint32_t cores;
+  bool parks;
+  bool measure;
+} NoelleTunedInvocation_t;
+
+/*
+ * Inspection of the indices used by the iterations of a DOALL loop (see
+ * NOELLE_DOALLDispatcherWithInspection).
+ * @values are the indices inspected, zero-extended to 64 bits.
+ */
+typedef struct {
+  void *indices;
+  int64_t indexBytes;
+  int64_t stride;
+  std::vector<uint64_t> values;
+  bool isConflictFree;
+} NoelleInspection_t;
+
+class NoelleRuntime {
+public:
+  NoelleRuntime();
+
+  uint32_t reserveCores(uint32_t coresRequested);
+
+  /*
+   * Reserve up to @coresRequested idle cores.
+   * Unlike "reserveCores", the core of the caller is not included.
+   */
+  uint32_t reserveIdleCores(uint32_t coresRequested);
+
+  void releaseCores(uint32_t coresReleased);
+
+  /*
+   * Parallel regions (i.e., invocations of parallelized loops).
+   *
+   * Return the number of tasks of the region, including the caller.
+   * The cores to give back to "exitParallelRegion" are stored in
+   * @coresReserved, and the budget of the tasks of the region for their
+   * nested regions is stored in @nestedCoreBudget.
+   */
+  uint32_t enterParallelRegion(uint32_t coresRequested,
+                               uint32_t *coresReserved,
+                               uint32_t *nestedCoreBudget);
+
+  void exitParallelRegion(uint32_t coresReserved);
+
+  DOALL_args_t *getDOALLArgs(uint32_t cores, uint32_t *index);
+
+  void releaseDOALLArgs(uint32_t index);
+
+  /*
+   * Memory blocks reused across invocations of parallelized loops.
+   * Blocks are aligned to the cache line.
+   */
+  void *getCachedMemory(uint64_t bytes, uint32_t *index);
+
+  void releaseCachedMemory(uint32_t index);
+
+  /*
+   * DSWP queues reused across invocations of parallelized loops.
+   * Queues must be empty when released.
+   */
+  void *getDSWPQueue(int64_t queueSize);
+
+  void releaseDSWPQueue(void *queue, int64_t queueSize);
+
+  /*
+   * Private copies of memory objects reused across tasks.
+   * Copies are aligned to the cache line.
+   */
+  void *getPrivateCopy(int64_t bytes);
+
+  void releasePrivateCopy(void *copy, int64_t bytes);
+
+  uint64_t getSpinBudget(void) const;
+
+  /*
+   * Cost model used to run DOALL invocations with few iterations sequentially.
+   *
+   * The dispatch cost is the number of cycles needed to run an empty DOALL
+   * loop on the cores available; it is calibrated the first time it is
+   * needed.
+   * The cycles per iteration of a DOALL loop are measured by its previous
+   * invocations; "getDOALLCyclesPerIteration" returns false if the loop has
+   * never been measured.
+   */
+  uint64_t getDOALLDispatchCost(void);
+
+  bool getDOALLCyclesPerIteration(void *loop, double *cycles);
+
+  void setDOALLCyclesPerIteration(void *loop, double cycles);
+
+  /*
+   * Last inspection of the indices of a DOALL loop whose memory accesses are
+   * indexed by an array, or nullptr if the loop has never been inspected.
+   * Inspections are immutable: a new inspection replaces the previous one.
+   */
+  std::shared_ptr<const NoelleInspection_t> getDOALLInspection(void *loop);
+
+  void setDOALLInspection(void *loop,
+                          std::shared_ptr<const NoelleInspection_t> inspection);
+
+  /*
+   * Online selection of the number of cores of each parallelized loop.
+   *
+   * "getTunedInvocation" returns how the next invocation of @loop must run:
+   * the number of cores it must request, which is at most @maxNumberOfCores,
+   * whether its join parks right away, and whether it must be measured.
+   * "recordTunedInvocation" gives back the cycles and the energy a measured
+   * invocation that used @threadsUsed threads took to run @work units of work
+   * (e.g., iterations).
+   * Starting from @maxNumberOfCores, the number of cores is halved as long as
+   * the cost per unit of work does not grow beyond the tolerance. Then, if
+   * NOELLE_CORE_TUNING_JOINS is set, joins that park are tried on the cores
+   * selected.
+   * If NOELLE_CORE_TUNING_FILE is set, the choices are loaded from that file
+   * when the program starts and saved there when it ends.
+   */
+  bool isCoreTuningEnabled(void) const;
+
+  bool isCoreTuningMeasuringEnergy(void) const;
+
+  void getTunedInvocation(void *loop,
+                          uint32_t maxNumberOfCores,
+                          NoelleTunedInvocation_t *invocation);
+
+  void recordTunedInvocation(void *loop,
+                             NoelleTunedInvocation_t const &invocation,
+                             uint32_t threadsUsed,
+                             uint64_t cycles,
+                             double joules,
+                             uint64_t work);
+
+  /*
+   * Number of times the invoker of a parallel region spins on its join
+   * before parking.
+   */
+  uint64_t getJoinSpinBudget(void) const;
+
+  /*
+   * HELIX helper threads.
+   */
+  bool isHELIXHelperEnabled(void) const;
+
+  bool shouldUseHELIXHelper(void);
+
+  /*
+   * Whether HELIX critical sections run as hardware transactions first.
+   */
+  bool isHELIXTransactionalMemoryEnabled(void) const;
+
+  int32_t getHyperthread(uint32_t physicalCoreIndex, uint32_t sibling) const;
+
+  void addHELIXWaitTime(bool helped, uint64_t waits, uint64_t cycles);
+
+  /*
+   * Helper prefetchers of sequential loops.
+   * They run on the SMT sibling of @logicalCore, or they do not run if
+   * @logicalCore has no allowed sibling (see getSiblingHyperthread).
+   */
+  bool isPrefetcherEnabled(void) const;
+
+  int64_t getPrefetcherDistance(void) const;
+
+  /*
+   * Maximum number of tasks of recursive functions spawned by
+   * NOELLE_TaskSpawn that can include a spawned task.
+   */
+  uint32_t getTaskSpawnDepth(void) const;
+
+  int32_t getSiblingHyperthread(int32_t logicalCore);
+
+  /*
+   * Placement of DSWP stages.
+   */
+  bool isDSWPPlacementEnabled(void) const;
+
+  int32_t getDSWPStageCore(uint32_t stageID) const;
+
+  /*
+   * Fusion of DSWP stages when fewer cores than stages are available.
+   */
+  bool isDSWPStageFusionEnabled(void) const;
+
+  /*
+   * Affinity of DOALL tasks.
+   * When enabled, the task with core ID k of a DOALL invocation always runs on
+   * the worker k of the pool, which is pinned to "getDOALLWorkerCore(k)".
+   */
+  bool isDOALLAffinityEnabled(void) const;
+
+  int32_t getDOALLWorkerCore(uint32_t workerID) const;
+
+  NoelleThreadPool *threadPool;
+
+  NoelleTelemetry telemetry;
+
+  NoelleTracer tracer;
+
+  NoelleEnvironmentReport environments;
+
+  NoelleSegmentProfiler segmentProfiler;
+
+  NoelleBufferedOutput bufferedOutput;
+
+  ~NoelleRuntime(void);
+
+private:
+  mutable pthread_spinlock_t cachedMemoryLock;
+  std::vector<uint64_t> cachedMemorySizes;
+  std::vector<bool> cachedMemoryAvailability;
+  std::vector<void *> cachedMemory;
+
+  mutable pthread_spinlock_t dswpQueuesLock;
+  std::unordered_map<int64_t, std::vector<void *>> dswpQueues;
+
+  mutable pthread_spinlock_t privateCopiesLock;
+  std::unordered_map<int64_t, std::vector<void *>> privateCopies;
+
+  /*
+   * DOALL cost model.
+   */
+  std::once_flag doallDispatchCostCalibration;
+  bool doallDispatchCostOverridden;
+  uint64_t doallDispatchCost;
+  mutable pthread_spinlock_t doallCostsLock;
+  std::unordered_map<void *, double> doallCyclesPerIteration;
+
+  /*
+   * Inspections of DOALL loops.
+   */
+  mutable pthread_spinlock_t doallInspectionsLock;
+  std::unordered_map<void *, std::shared_ptr<const NoelleInspection_t>>
+      doallInspections;
+
+  /*
+   * Online selection of the number of cores.
+   */
+  typedef struct {
+    uint32_t maxCores;
+    uint32_t candidateCores;
+    uint32_t bestCores;
+    double bestCost;
+    double candidateCost;
+    uint32_t samples;
+    uint64_t invocationsSinceSelection;
+    bool isSelected;
+    bool parks;
+    bool isTuningJoins;
+  } NoelleLoopCoreModel_t;
+  bool coreTuningEnabled;
+  uint32_t coreTuningSamples;
+  uint64_t coreTuningPeriod;
+  uint32_t coreTuningObjective;
+  bool coreTuningJoins;
+  std::string coreTuningFile;
+  mutable pthread_spinlock_t coreModelsLock;
+  std::unordered_map<void *, NoelleLoopCoreModel_t> coreModels;
+
+  uint32_t getMaximumNumberOfCores(void);
+
+  void loadCoreModels(void);
+
+  void saveCoreModels(void);
+
+  /*
+   * Current number of idle cores.
+   */
+  int32_t NOELLE_idleCores;
+
+  /*
+   * Maximum number of cores.
+   */
+  uint32_t maxCores;
+
+  /*
+   * Number of times a thread spins before parking.
+   */
+  uint64_t spinBudget;
+
+  /*
+   * Policy for nested parallel regions.
+   */
+  uint32_t nestingPolicy;
+
+  /*
+   * Whether the parallel regions of the OpenMP runtime of the program hold
+   * the cores. If so, regions invoked inside them run sequentially.
+   */
+  bool hostOpenMPEnabled;
+
+  /*
+   * HELIX helper threads.
+   *
+   * One invocation every @helixHelperSamplingPeriod runs without helper
+   * threads to estimate how much time they save.
+   * Index 0 of the statistics is for invocations without helper threads, and
+   * index 1 is for invocations with them.
+   */
+  bool helixHelperEnabled;
+  uint64_t helixHelperSamplingPeriod;
+
+  /*
+   * HELIX critical sections that run as hardware transactions.
+   * They are enabled by setting the environment variable NOELLE_HELIX_HTM to
+   * 1, and only if the CPU supports RTM.
+   */
+  bool helixTransactionsEnabled;
+  std::atomic<uint64_t> helixInvocations[2];
+  std::atomic<uint64_t> helixWaits[2];
+  std::atomic<uint64_t> helixWaitCycles[2];
+  std::vector<std::pair<uint32_t, uint32_t>> hyperthreads;
+
+  /*
+   * Helper prefetchers.
+   */
+  bool prefetcherEnabled;
+  int64_t prefetcherDistance;
+
+  /*
+   * Tasks of recursive functions.
+   */
+  uint32_t taskSpawnDepth;
+
+  /*
+   * Logical cores to run DSWP stages on.
+   * Consecutive entries share the last level cache when possible.
+   */
+  bool dswpPlacementEnabled;
+  std::vector<uint32_t> dswpStageCores;
+
+  /*
+   * Fusion of DSWP stages.
+   */
+  bool dswpStageFusionEnabled;
+
+  /*
+   * Affinity of DOALL tasks.
+   */
+  bool doallAffinityEnabled;
+
+  void computeHyperthreads(void);
+
+  void computeDSWPStageCores(void);
+
+  void printHELIXHelperReport(void) const;
+
+  mutable pthread_spinlock_t spinLock;
+};
+
+static NoelleRuntime runtime{};
+
+extern "C" {
+
+/******************************************** NOELLE APIs
+ * ***********************************************/
+
+class DispatcherInfo {
+public:
+  int32_t numberOfThreadsUsed;
+  int64_t unusedVariableToPreventOptIfStructHasOnlyOneVariable;
+};
+
+/*
+ * Dispatch threads to run a DOALL loop.
+ */
+DispatcherInfo NOELLE_DOALLDispatcher(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize);
+
+/*
+ * Dispatch threads to run a DOALL loop without waiting for them.
+ * The caller does not run any task: it keeps running the code after the loop
+ * while the other cores run the loop.
+ * Return the handle to pass to NOELLE_DOALLJoin, which must be invoked before
+ * any code that depends on the loop.
+ */
+void *NOELLE_DOALLDispatcherAsync(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize);
+
+/*
+ * Wait for the DOALL loop dispatched by the call to
+ * NOELLE_DOALLDispatcherAsync that returned @handle.
+ */
+DispatcherInfo NOELLE_DOALLJoin(void *handle);
+
+/*
+ * Run @task(@env) on an idle core without waiting for it.
+ * Return the handle to pass to NOELLE_TaskJoin, which must be invoked before
+ * any code that depends on the task.
+ * The task runs synchronously if there is no idle core.
+ */
+void *NOELLE_TaskDispatcherAsync(void (*task)(void *), void *env);
+
+/*
+ * Wait for the task dispatched by the call to NOELLE_TaskDispatcherAsync that
+ * returned @handle.
+ */
+void NOELLE_TaskJoin(void *handle);
+
+/*
+ * Spawn @task(@env), which is a call of a recursive function, and keep running
+ * the code after it.
+ * Return the handle to pass to NOELLE_TaskSync, which must be invoked before
+ * any code that depends on the task.
+ * The task runs synchronously if there is no idle core, or if it would be
+ * nested in more than NOELLE_TASK_SPAWN_DEPTH spawned tasks.
+ */
+void *NOELLE_TaskSpawn(void (*task)(void *), void *env);
+
+/*
+ * Wait for the task spawned by the call to NOELLE_TaskSpawn that returned
+ * @handle.
+ * If no idle core started the task yet, the current thread runs it.
+ */
+void NOELLE_TaskSync(void *handle);
+
+/*
+ * Dispatch threads to run a DOALL loop where chunks are assigned to cores
+ * following the policy @scheduling.
+ * @numberOfChunks is the total number of chunks of the loop, or 0 if it is not
+ * known.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithScheduling(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks);
+
+/*
+ * Dispatch threads to run a DOALL loop that executes @tripCount iterations.
+ * The loop runs sequentially on the caller if dispatching its iterations costs
+ * more than executing them.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithTripCount(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    int64_t tripCount);
+
+/*
+ * Dispatch threads to run a DOALL loop that can leave before its last
+ * iteration.
+ * @exitBlockTaken is updated with the index of the exit block taken by the
+ * earliest iteration that left the loop (see NOELLE_DOALL_cancel). It is left
+ * untouched if no iteration left the loop early.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithCancellation(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    int32_t *exitBlockTaken);
+
+/*
+ * Return the index of the next chunk the current DOALL task has to execute.
+ */
+int64_t NOELLE_DOALL_fetchNextChunk(void);
+
+/*
+ * Record that the current DOALL task left the loop at the iteration
+ * @iteration (counted from 0) through the exit block @exitBlockIndex.
+ */
+void NOELLE_DOALL_cancel(int64_t iteration, int64_t exitBlockIndex);
+
+/*
+ * Return 1 if an iteration before @iteration has left the loop, which means
+ * the current DOALL task can stop. Return 0 otherwise.
+ */
+int64_t NOELLE_DOALL_isCancelled(int64_t iteration);
+
+/*
+ * Record that the current DOALL task starts a new chunk of the loop @loopID,
+ * which ends the previous chunk of the task.
+ * This is invoked only by the tasks compiled with -doall-chunk-telemetry, and
+ * it does nothing if the telemetry is disabled.
+ */
+void NOELLE_DOALL_startChunk(int64_t loopID);
+
+/*
+ * Dispatch threads to run @numberOfTasks tasks of a DOALL loop, even if fewer
+ * cores are available.
+ * Each task executes the same iterations at every invocation, so the private
+ * copies of reduced variables accumulate the same values independently of
+ * the cores that run the loop.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithFixedTasks(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t numberOfTasks,
+    int64_t chunkSize);
+
+/*
+ * Dispatch threads to run a DOALL loop speculatively.
+ * The memory accesses of the tasks go through NOELLE_DOALL_speculativeLoad and
+ * NOELLE_DOALL_speculativeStore. Once all tasks are done, their stores are
+ * written to memory if no task accessed a word written by another one;
+ * otherwise, they are discarded and the loop runs again sequentially.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithSpeculation(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks);
+
+/*
+ * Load @size bytes (1, 2, 4, or 8) from @address on behalf of the current
+ * speculative DOALL task.
+ */
+int64_t NOELLE_DOALL_speculativeLoad(void *address, int64_t size);
+
+/*
+ * Store the lowest @size bytes (1, 2, 4, or 8) of @value to @address on
+ * behalf of the current speculative DOALL task.
+ */
+void NOELLE_DOALL_speculativeStore(void *address,
+                                   int64_t value,
+                                   int64_t size);
+
+/*
+ * Dispatch threads to run a DOALL loop whose memory accesses are indexed by an
+ * array of integers (e.g., y[idx[i]] += x[i]).
+ * @indices points to the index of the first iteration, which has @indexBytes
+ * bytes (1, 2, 4, or 8); the index of the next iteration is @stride indices
+ * after it. The loop runs in parallel only if its @tripCount iterations use
+ * distinct indices; otherwise, it runs sequentially on the caller.
+ * The outcome of the inspection is reused while the indices do not change.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithInspection(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    void *indices,
+    int64_t indexBytes,
+    int64_t stride,
+    int64_t tripCount);
+
+/*
+ * Dispatch threads to run a DOALL loop that computes the prefix (i.e., the
+ * scan) of an associative @operation (see NOELLE_REDUCTION_*) over values of
+ * type @elementType (e.g., s = s + a[i]; x[i] = s).
+ * @prefixes has a slot of 8 bytes per task. Each of the @numberOfTasks tasks
+ * runs one block of consecutive iterations out of @tripCount: it starts the
+ * variable from its slot, and it stores there the value the variable has
+ * after the block. Slot 0 holds the initial value of the variable.
+ * The tasks run twice: first to compute the value of each block, and then to
+ * compute the final values from the prefix of the blocks before them.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherWithScan(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t numberOfTasks,
+    int64_t tripCount,
+    void *prefixes,
+    int64_t elementType,
+    int64_t operation);
+
+/*
+ * Dispatch a DOALL loop across the MPI ranks of a batch job that runs the
+ * program once per rank (see NOELLE_MPI).
+ * Every rank runs @maxNumberOfCores tasks out of @maxNumberOfCores times the
+ * number of ranks, so the iterations a rank runs only depend on its rank.
+ * @distribution describes the variables of @env to move between ranks by
+ * "b:OFFSET:BYTES", for live-ins rank 0 broadcasts, and by
+ * "p:OFFSET:STRIDE:TYPE:OPERATION", for reduced live-outs (see
+ * NOELLE_REDUCTION_*) whose private copies are @STRIDE bytes apart.
+ * Once the tasks are done, the first private copy of every rank holds the
+ * reduction of all tasks. Without MPI, or with one rank, this is
+ * NOELLE_DOALLDispatcher.
+ */
+DispatcherInfo NOELLE_DOALLDispatcherDistributed(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    const char *distribution);
+
+/*
+ * Return @numberOfCopies private copies of an array of @bytes bytes reduced by
+ * the tasks of a DOALL loop with @operation (see NOELLE_REDUCTION_*).
+ * The copy of task i starts @stride bytes after the one of task i - 1, and
+ * each element is initialized with the identity of @operation for elements of
+ * type @elementType.
+ */
+void *NOELLE_allocateReductionArrays(int64_t bytes,
+                                     int64_t stride,
+                                     int64_t numberOfCopies,
+                                     int64_t elementType,
+                                     int64_t operation);
+
+/*
+ * Combine the first @numberOfCopiesUsed copies returned by
+ * NOELLE_allocateReductionArrays into @array, and release all copies.
+ * Large arrays are combined in parallel by chunks of elements.
+ */
+void NOELLE_reduceArrays(void *array,
+                         void *copies,
+                         int64_t bytes,
+                         int64_t stride,
+                         int64_t numberOfCopies,
+                         int64_t numberOfCopiesUsed,
+                         int64_t elementType,
+                         int64_t operation);
+
+/*
+ * Dispatch threads to run the rows of a wavefront loop nest.
+ * Row i runs on the task i % numCores, and @chunkSize must be 1.
+ * All tasks run at the same time because they wait for each other.
+ */
+DispatcherInfo NOELLE_WavefrontDispatcher(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize);
+
+/*
+ * Wait for the previous row to complete @iteration of its nested loop before
+ * running the same iteration of @row.
+ */
+void NOELLE_Wavefront_wait(int64_t row, int64_t iteration);
+
+/*
+ * Publish that @iterations iterations of the nested loop of @row are done.
+ * A negative @iterations means that the whole row is done.
+ */
+void NOELLE_Wavefront_signal(int64_t row, int64_t iterations);
+
+/*
+ * Start the helper prefetcher of an invocation of a sequential loop.
+ * @helper(@env, prefetcher) runs on the SMT sibling of the current core, and it
+ * calls NOELLE_prefetcherThrottle before prefetching the addresses of each
+ * iteration of the loop.
+ * Return the prefetcher, whose first 64 bits are the number of iterations the
+ * loop has completed. The loop updates them as it goes.
+ */
+void *NOELLE_prefetcherStart(void (*helper)(void *, void *), void *env);
+
+/*
+ * Return the iteration the helper of @prefetcher has to prefetch for, which
+ * is @iteration unless the loop already reached it, or -1 if the loop is over.
+ * The helper waits while @iteration is too far ahead of the loop.
+ */
+int64_t NOELLE_prefetcherThrottle(void *prefetcher, int64_t iteration);
+
+/*
+ * Stop the helper of @prefetcher as its loop is over, and free @prefetcher.
+ */
+void NOELLE_prefetcherStop(void *prefetcher);
+
+/*
+ * Open a region where consecutive DOALL loops invoked by the current thread
+ * run on the same team of at most @maxNumberOfCores cores.
+ * The team stays awake until the region is closed.
+ */
+void NOELLE_beginPersistentRegion(int64_t maxNumberOfCores);
+
+/*
+ * Close the region opened by the last call to NOELLE_beginPersistentRegion.
+ */
+void NOELLE_endPersistentRegion(void);
+
+/*
+ * Select the version to run for the current invocation of the adaptive loop
+ * @loopID.
+ * @canRunInParallel is 0 if the parallelized loop cannot run (e.g., because
+ * another invocation is running it), and @chunkSize is the chunk size selected
+ * by the compiler.
+ * Return 0 to run the sequential loop, or the chunk size to run the
+ * parallelized loop with otherwise.
+ */
+int64_t NOELLE_adaptiveLoopBegin(int64_t loopID,
+                                 int64_t canRunInParallel,
+                                 int64_t chunkSize);
+
+/*
+ * End the invocation started by the last call to NOELLE_adaptiveLoopBegin.
+ */
+void NOELLE_adaptiveLoopEnd(int64_t loopID);
+
+/*
+ * Record that the parallelized loop @loopID is about to run with the
+ * environment @env, whose variables are described by @layout (see
+ * LoopEnvironmentBuilder::getLayoutDescriptor).
+ * This is invoked only by the loops compiled with
+ * -noelle-environment-layout-report, and it does nothing if the report is
+ * disabled (see NOELLE_ENVIRONMENT_REPORT).
+ */
+void NOELLE_registerEnvironment(int64_t loopID, void *env, const char *layout);
+
+/*
+ * Return a private copy of @bytes bytes of a memory object privatized by a
+ * task.
+ * Copies are recycled across tasks and their content is undefined.
+ */
+void *NOELLE_allocatePrivateCopy(int64_t bytes);
+
+/*
+ * Give back the copy returned by NOELLE_allocatePrivateCopy.
+ */
+void NOELLE_releasePrivateCopy(void *copy, int64_t bytes);
+
+/*
+ * Allocators of the tasks of parallelized loops.
+ * They follow the semantics of the functions of the C library of the same
+ * name. Blocks are cached by the thread that allocated them, and freeing them
+ * from another thread gives them back to that cache.
+ * Blocks not allocated by these functions are handed to the C library.
+ */
+void *NOELLE_malloc(size_t bytes);
+
+void *NOELLE_calloc(size_t elements, size_t elementBytes);
+
+void *NOELLE_realloc(void *block, size_t bytes);
+
+void NOELLE_free(void *block);
+
+/******************************************** NOELLE API implementations
+ * ***********************************************/
+
+typedef void (*stageFunctionPtr_t)(void *, void *);
+
+void printReachedS(std::string s) {
+  auto outS = "Reached: " + s;
+  printf("%s\n", outS.c_str());
+}
+
+void printReachedI(int i) {
+  printf("Reached: %d\n", i);
+}
+
+void printPushedP(int32_t *p) {
+  printf("Pushed: %p\n", p);
+}
+
+void printPulledP(int32_t *p) {
+  printf("Pulled: %p\n", p);
+}
+
+void queuePush8(ThreadSafeQueue<int8_t> *queue, int8_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queuePop8(ThreadSafeQueue<int8_t> *queue, int8_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queuePush16(ThreadSafeQueue<int16_t> *queue, int16_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queuePop16(ThreadSafeQueue<int16_t> *queue, int16_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+}
+
+void queuePush32(ThreadSafeQueue<int32_t> *queue, int32_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queuePop32(ThreadSafeQueue<int32_t> *queue, int32_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+}
+
+void queuePush64(ThreadSafeQueue<int64_t> *queue, int64_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queuePop64(ThreadSafeQueue<int64_t> *queue, int64_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+
+  return;
+}
+
+void queueSPSCPush8(NoelleSPSCQueue<int8_t> *queue, int8_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueSPSCPop8(NoelleSPSCQueue<int8_t> *queue, int8_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueSPSCPush16(NoelleSPSCQueue<int16_t> *queue, int16_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueSPSCPop16(NoelleSPSCQueue<int16_t> *queue, int16_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueSPSCPush32(NoelleSPSCQueue<int32_t> *queue, int32_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueSPSCPop32(NoelleSPSCQueue<int32_t> *queue, int32_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueSPSCPush64(NoelleSPSCQueue<int64_t> *queue, int64_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueSPSCPop64(NoelleSPSCQueue<int64_t> *queue, int64_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueSlotPush(NoelleSlotQueue *queue, int8_t *val) {
+  queue->push(val);
+  currentQueuePushes++;
+  return;
+}
+
+void queueSlotPop(NoelleSlotQueue *queue, int8_t *val) {
+  queue->waitPop(val);
+  currentQueuePops++;
+  return;
+}
+
+void queueBatchedPush8(NoelleBatchedQueue<int8_t> *queue, int8_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueBatchedPop8(NoelleBatchedQueue<int8_t> *queue, int8_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueBatchedFlush8(NoelleBatchedQueue<int8_t> *queue) {
+  queue->flush();
+  return;
+}
+
+void queueBatchedPush16(NoelleBatchedQueue<int16_t> *queue, int16_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueBatchedPop16(NoelleBatchedQueue<int16_t> *queue, int16_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueBatchedFlush16(NoelleBatchedQueue<int16_t> *queue) {
+  queue->flush();
+  return;
+}
+
+void queueBatchedPush32(NoelleBatchedQueue<int32_t> *queue, int32_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueBatchedPop32(NoelleBatchedQueue<int32_t> *queue, int32_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueBatchedFlush32(NoelleBatchedQueue<int32_t> *queue) {
+  queue->flush();
+  return;
+}
+
+void queueBatchedPush64(NoelleBatchedQueue<int64_t> *queue, int64_t *val) {
+  queue->push(*val);
+  currentQueuePushes++;
+
+  return;
+}
+
+void queueBatchedPop64(NoelleBatchedQueue<int64_t> *queue, int64_t *val) {
+  queue->waitPop(*val);
+  currentQueuePops++;
+  return;
+}
+
+void queueBatchedFlush64(NoelleBatchedQueue<int64_t> *queue) {
+  queue->flush();
+  return;
+}
+
+/**********************************************************************
+ *                Thread affinity
+ **********************************************************************/
+/*
+ * Pin the current thread to a logical core.
+ * The previous affinity is stored in @previousCores.
+ */
+static bool NOELLE_pinCurrentThread(int32_t logicalCore,
+                                    cpu_set_t *previousCores) {
+  if (logicalCore < 0) {
+    return false;
+  }
+  auto self = pthread_self();
+  if (pthread_getaffinity_np(self, sizeof(cpu_set_t), previousCores) != 0) {
+    return false;
+  }
+  cpu_set_t cores;
+  CPU_ZERO(&cores);
+  CPU_SET(logicalCore, &cores);
+
+  return pthread_setaffinity_np(self, sizeof(cpu_set_t), &cores) == 0;
+}
+
+/*
+ * Whether the current thread has been pinned for good (see
+ * NOELLE_DOALLAffinityTrampoline).
+ */
+static thread_local bool isCurrentThreadPinned = false;
+
+/**********************************************************************
+ *                Persistent regions
+ **********************************************************************/
+void NOELLE_beginPersistentRegion(int64_t maxNumberOfCores) {
+
+  /*
+   * Regions nested in another one, or invoked by a task of a parallelized
+   * loop, run without a team of their own.
+   */
+  currentPersistentRegionDepth++;
+  if (false || (currentPersistentRegionDepth > 1)
+      || (currentNestedCoreBudget > 0)) {
+    return;
+  }
+
+  /*
+   * Reserve the cores of the team.
+   */
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  auto numCores = runtime.enterParallelRegion(maxNumberOfCores,
+                                              &coresReserved,
+                                              &nestedCoreBudget);
+  if (numCores == 1) {
+    runtime.exitParallelRegion(coresReserved);
+    return;
+  }
+
+  /*
+   * Start the team.
+   * The current thread is part of it.
+   */
+  auto team = new NoelleTeam(numCores - 1,
+                             coresReserved,
+                             nestedCoreBudget,
+                             runtime.getSpinBudget());
+  team->start(runtime.threadPool);
+  currentTeam = team;
+
+  return;
+}
+
+void NOELLE_endPersistentRegion(void) {
+  assert(currentPersistentRegionDepth > 0);
+
+  /*
+   * Check if we are closing the region that owns the team.
+   */
+  currentPersistentRegionDepth--;
+  if (false || (currentPersistentRegionDepth > 0) || (currentTeam == nullptr)) {
+    return;
+  }
+
+  /*
+   * Stop the team and free its cores.
+   */
+  auto team = currentTeam;
+  currentTeam = nullptr;
+  team->stop();
+  runtime.exitParallelRegion(team->getCoresReserved());
+  delete team;
+
+  return;
+}
+
+/**********************************************************************
+ *                Adaptive loops
+ **********************************************************************/
+static std::mutex adaptiveLoopsLock;
+static std::unordered_map<int64_t, NOELLE_adaptiveLoop_t *> adaptiveLoops;
+
+static uint64_t NOELLE_adaptiveNextRandom(void) {
+
+  /*
+   * Xorshift generator seeded by the cycle counter.
+   */
+  if (currentAdaptiveRandomState == 0) {
+    currentAdaptiveRandomState = NOELLE_getCycles() | 1;
+  }
+  currentAdaptiveRandomState ^= currentAdaptiveRandomState << 13;
+  currentAdaptiveRandomState ^= currentAdaptiveRandomState >> 7;
+  currentAdaptiveRandomState ^= currentAdaptiveRandomState << 17;
+
+  return currentAdaptiveRandomState;
+}
+
+int64_t NOELLE_adaptiveLoopBegin(int64_t loopID,
+                                 int64_t canRunInParallel,
+                                 int64_t chunkSize) {
+
+  /*
+   * Fetch the loop.
+   */
+  adaptiveLoopsLock.lock();
+  auto &loop = adaptiveLoops[loopID];
+  if (loop == nullptr) {
+    loop = (NOELLE_adaptiveLoop_t *)calloc(1, sizeof(NOELLE_adaptiveLoop_t));
+  }
+
+  /*
+   * Invocations that cannot run the parallelized loop run the sequential one
+   * without being measured: they would not represent the sequential version
+   * when nothing else runs in parallel.
+   */
+  NOELLE_adaptiveInvocation_t invocation;
+  invocation.loop = loop;
+  invocation.version = -1;
+  if (canRunInParallel) {
+
+    /*
+     * Sample the versions that have not been sampled enough yet.
+     */
+    for (auto i = 0; i < NOELLE_ADAPTIVE_VERSIONS; i++) {
+      if (loop->samples[i] < NOELLE_ADAPTIVE_MINIMUM_SAMPLES) {
+        invocation.version = i;
+        break;
+      }
+    }
+
+    /*
+     * Select the fastest version, except for a few invocations that explore
+     * a random one.
+     */
+    if (invocation.version == -1) {
+      auto random = NOELLE_adaptiveNextRandom();
+      if ((random % NOELLE_ADAPTIVE_EXPLORATION) == 0) {
+        invocation.version =
+            (random / NOELLE_ADAPTIVE_EXPLORATION) % NOELLE_ADAPTIVE_VERSIONS;
+      } else {
+        invocation.version = 0;
+        for (auto i = 1; i < NOELLE_ADAPTIVE_VERSIONS; i++) {
+          if (loop->averageCycles[i]
+              < loop->averageCycles[invocation.version]) {
+            invocation.version = i;
+          }
+        }
+      }
+    }
+  }
+  adaptiveLoopsLock.unlock();
+
+  /*
+   * Start measuring the invocation.
+   */
+  invocation.startCycles = NOELLE_getCycles();
+  currentAdaptiveInvocations.push_back(invocation);
+
+  if (invocation.version == -1) {
+    return 0;
+  }
+  return NOELLE_ADAPTIVE_CHUNK_FACTORS[invocation.version]
+         * std::max(chunkSize, (int64_t)1);
+}
+
+void NOELLE_adaptiveLoopEnd(int64_t loopID) {
+  assert(currentAdaptiveInvocations.size() > 0);
+
+  /*
+   * Fetch the invocation that ends.
+   */
+  auto endCycles = NOELLE_getCycles();
+  auto invocation = currentAdaptiveInvocations.back();
+  currentAdaptiveInvocations.pop_back();
+  if (invocation.version == -1) {
+    return;
+  }
+
+  /*
+   * Update the average cycles of the version executed.
+   * The first samples are weighted equally, while the later ones are
+   * averaged exponentially.
+   */
+  auto cycles = (double)(endCycles - invocation.startCycles);
+  auto loop = invocation.loop;
+  std::lock_guard<std::mutex> guard(adaptiveLoopsLock);
+  auto &samples = loop->samples[invocation.version];
+  auto &average = loop->averageCycles[invocation.version];
+  samples++;
+  auto weight = (double)std::min(samples, (uint64_t)16);
+  average += (cycles - average) / weight;
+
+  return;
+}
+
+void *NOELLE_allocatePrivateCopy(int64_t bytes) {
+  return runtime.getPrivateCopy(bytes);
+}
+
+void NOELLE_releasePrivateCopy(void *copy, int64_t bytes) {
+  runtime.releasePrivateCopy(copy, bytes);
+
+  return;
+}
+
+void *NOELLE_malloc(size_t bytes) {
+  auto sizeClass = NOELLE_getTaskBlockClass(bytes);
+  if (sizeClass == NOELLE_TASK_ALLOCATOR_CLASSES) {
+    return malloc(bytes);
+  }
+
+  return NOELLE_getThreadCache()->allocate(sizeClass);
+}
+
+void *NOELLE_calloc(size_t elements, size_t elementBytes) {
+  if (true && (elementBytes != 0) && (elements > (SIZE_MAX / elementBytes))) {
+    return nullptr;
+  }
+  auto bytes = elements * elementBytes;
+  auto block = NOELLE_malloc(bytes);
+  if (block != nullptr) {
+    memset(block, 0, bytes);
+  }
+
+  return block;
+}
+
+void *NOELLE_realloc(void *block, size_t bytes) {
+  if (block == nullptr) {
+    return NOELLE_malloc(bytes);
+  }
+  if (!NOELLE_isTaskBlock(block)) {
+    return realloc(block, bytes);
+  }
+  if (bytes == 0) {
+    NOELLE_free(block);
+    return nullptr;
+  }
+
+  /*
+   * Keep the block if it is big enough.
+   */
+  auto header = ((NOELLE_taskBlockHeader_t *)block) - 1;
+  auto blockBytes =
+      (1ULL << (header->sizeClass + NOELLE_TASK_ALLOCATOR_MIN_CLASS_SHIFT))
+      - sizeof(NOELLE_taskBlockHeader_t);
+  if (bytes <= blockBytes) {
+    return block;
+  }
+
+  /*
+   * Move the block.
+   */
+  auto newBlock = NOELLE_malloc(bytes);
+  if (newBlock == nullptr) {
+    return nullptr;
+  }
+  memcpy(newBlock, block, blockBytes);
+  NOELLE_free(block);
+
+  return newBlock;
+}
+
+void NOELLE_free(void *block) {
+  if (block == nullptr) {
+    return;
+  }
+  if (!NOELLE_isTaskBlock(block)) {
+    free(block);
+    return;
+  }
+
+  /*
+   * Give the block back to the cache of the thread that allocated it.
+   */
+  auto header = ((NOELLE_taskBlockHeader_t *)block) - 1;
+  auto owner = header->owner;
+  if (owner == currentThreadCache) {
+    owner->release(header);
+  } else {
+    owner->releaseRemotely(header);
+  }
+
+  return;
+}
+
+/**********************************************************************
+ *                DOALL
+ **********************************************************************/
+static void NOELLE_DOALLTrampoline(void *args) {
+
+  /*
+   * Fetch the arguments.
+   */
+  auto DOALLArgs = (DOALL_args_t *)args;
+
+  /*
+   * Measure the task if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Set the chunks the task will fetch from and the cores its nested regions
+   * can use.
+   */
+  auto prevReservation = currentDOALLReservation;
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentDOALLReservation = &DOALLArgs->reservation;
+  currentNestedCoreBudget = DOALLArgs->nestedCoreBudget;
+
+  /*
+   * Set the counters the chunks of the task are recorded to.
+   */
+  auto prevTelemetry = currentDOALLTelemetry;
+  auto prevChunkStartCycles = currentDOALLChunkStartCycles;
+  if (telemetryEnabled) {
+    DOALLArgs->telemetry.chunkSize = DOALLArgs->chunkSize;
+    currentDOALLTelemetry = &DOALLArgs->telemetry;
+    currentDOALLChunkStartCycles = 0;
+  }
+
+  /*
+   * Invoke
+   */
+  {
+    NoelleTraceScope traceScope{ "DOALL task",
+                                 (void *)DOALLArgs->parallelizedLoop,
+                                 DOALLArgs->coreID };
+    DOALLArgs->parallelizedLoop(DOALLArgs->env,
+                                DOALLArgs->coreID,
+                                DOALLArgs->numCores,
+                                DOALLArgs->chunkSize);
+  }
+  currentDOALLReservation = prevReservation;
+  currentNestedCoreBudget = prevNestedCoreBudget;
+  if (telemetryEnabled) {
+
+    /*
+     * End the last chunk of the task.
+     */
+    auto endCycles = NOELLE_getCycles();
+    if (currentDOALLChunkStartCycles != 0) {
+      auto chunkCycles = endCycles - currentDOALLChunkStartCycles;
+      DOALLArgs->telemetry.chunks++;
+      DOALLArgs->telemetry.chunkCycles += chunkCycles;
+      DOALLArgs->telemetry.chunkSquaredCycles +=
+          (double)chunkCycles * (double)chunkCycles;
+    }
+    currentDOALLTelemetry = prevTelemetry;
+    currentDOALLChunkStartCycles = prevChunkStartCycles;
+    DOALLArgs->telemetry.busyCycles = endCycles - startCycles;
+  }
+
+  DOALLArgs->endLatch->countDown();
+  return;
+}
+
+/*
+ * Run a DOALL task on a worker of the pool that is pinned to its core.
+ * The worker is pinned the first time it runs a DOALL task and it stays
+ * pinned afterwards.
+ */
+static void NOELLE_DOALLAffinityTrampoline(void *args) {
+  if (!isCurrentThreadPinned) {
+    cpu_set_t previousCores;
+    auto logicalCore = runtime.getDOALLWorkerCore(currentWorkerID);
+    NOELLE_pinCurrentThread(logicalCore, &previousCores);
+    isCurrentThreadPinned = true;
+  }
+  NOELLE_DOALLTrampoline(args);
+
+  return;
+}
+
+int64_t NOELLE_DOALL_fetchNextChunk(void) {
+
+  /*
+   * Fetch the chunks reserved by the current task.
+   */
+  auto reservation = currentDOALLReservation;
+  assert(reservation != nullptr);
+  auto schedule = reservation->schedule;
+  assert(schedule != nullptr);
+
+  /*
+   * Check if we have already reserved the next chunk.
+   */
+  if (reservation->nextReservedChunk < reservation->endOfReservedChunks) {
+    auto chunk = reservation->nextReservedChunk;
+    reservation->nextReservedChunk++;
+    return chunk;
+  }
+
+  /*
+   * Check if we can reserve more than one chunk.
+   * This is the case for the guided scheduling when the total number of chunks
+   * is known. The number of chunks to reserve is proportional to the
+   * remaining ones.
+   */
+  if (true && (schedule->scheduling == NOELLE_DOALL_GUIDED_SCHEDULING)
+      && (schedule->numberOfChunks > 0)) {
+    auto chunk = schedule->nextChunk.load(std::memory_order_relaxed);
+    int64_t chunksToReserve;
+    do {
+      auto remainingChunks = schedule->numberOfChunks - chunk;
+      chunksToReserve = remainingChunks / (2 * schedule->numCores);
+      if (chunksToReserve < 1) {
+        chunksToReserve = 1;
+      }
+    } while (!schedule->nextChunk.compare_exchange_weak(
+        chunk,
+        chunk + chunksToReserve,
+        std::memory_order_relaxed));
+    reservation->nextReservedChunk = chunk + 1;
+    reservation->endOfReservedChunks = chunk + chunksToReserve;
+
+    return chunk;
+  }
+
+  /*
+   * Reserve one chunk.
+   */
+  auto chunk = schedule->nextChunk.fetch_add(1, std::memory_order_relaxed);
+
+  return chunk;
+}
+
+void NOELLE_registerEnvironment(int64_t loopID, void *env, const char *layout) {
+  runtime.environments.recordEnvironment(loopID, env, layout);
+
+  return;
+}
+
+void NOELLE_DOALL_startChunk(int64_t loopID) {
+
+  /*
+   * Check if the chunks of the current task are measured.
+   */
+  auto telemetry = currentDOALLTelemetry;
+  if (telemetry == nullptr) {
+    return;
+  }
+
+  /*
+   * End the previous chunk, if any, and start the new one.
+   */
+  auto now = NOELLE_getCycles();
+  if (currentDOALLChunkStartCycles != 0) {
+    auto chunkCycles = now - currentDOALLChunkStartCycles;
+    telemetry->chunks++;
+    telemetry->chunkCycles += chunkCycles;
+    telemetry->chunkSquaredCycles += (double)chunkCycles * (double)chunkCycles;
+  }
+  telemetry->loopID = loopID;
+  currentDOALLChunkStartCycles = now;
+
+  return;
+}
+
+void NOELLE_DOALL_cancel(int64_t iteration, int64_t exitBlockIndex) {
+
+  /*
+   * Fetch the cancellation state of the current invocation.
+   */
+  auto reservation = currentDOALLReservation;
+  assert(reservation != nullptr);
+  auto cancellation = reservation->cancellation;
+  assert(cancellation != nullptr);
+
+  /*
+   * Keep the earliest iteration that left the loop.
+   * Other tasks might leave the loop at later iterations before noticing the
+   * cancellation; their exits must be ignored.
+   */
+  pthread_spin_lock(&cancellation->lock);
+  if (iteration
+      < cancellation->firstExitIteration.load(std::memory_order_relaxed)) {
+    cancellation->exitBlockIndex = exitBlockIndex;
+    cancellation->firstExitIteration.store(iteration,
+                                           std::memory_order_relaxed);
+  }
+  pthread_spin_unlock(&cancellation->lock);
+
+  return;
+}
+
+int64_t NOELLE_DOALL_isCancelled(int64_t iteration) {
+
+  /*
+   * Fetch the cancellation state of the current invocation.
+   */
+  auto reservation = currentDOALLReservation;
+  assert(reservation != nullptr);
+  auto cancellation = reservation->cancellation;
+  assert(cancellation != nullptr);
+
+  /*
+   * Iterations after an early exit are not executed by the sequential loop.
+   */
+  if (iteration
+      > cancellation->firstExitIteration.load(std::memory_order_relaxed)) {
+    return 1;
+  }
+
+  return 0;
+}
+
+static DispatcherInfo NOELLE_DOALLDispatcherImpl(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    DOALL_cancellation_t *cancellation) {
+  NoelleTraceScope traceScope{ "DOALL dispatch",
+                               (void *)parallelizedLoop,
+                               maxNumberOfCores };
+
+  /*
+   * Measure the invocation if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Fetch the thread pool
+   */
+  auto threadPool = runtime.threadPool;
+
+  /*
+   * Set the number of cores to use.
+   * If the current thread has opened a persistent region, then we use the
+   * cores of its team.
+   */
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  int64_t numCores;
+  auto team = currentTeam;
+  if (true && (team != nullptr) && team->acquire()) {
+    coresReserved = 0;
+    nestedCoreBudget = team->getNestedCoreBudget();
+    numCores = std::min((int64_t)team->getNumberOfWorkers() + 1,
+                        std::max(maxNumberOfCores, (int64_t)1));
+  } else {
+    team = nullptr;
+    numCores = runtime.enterParallelRegion(maxNumberOfCores,
+                                           &coresReserved,
+                                           &nestedCoreBudget);
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "Starting dispatcher: num cores " << numCores
+            << ", chunk size: " << chunkSize << std::endl;
+#endif
+
+  /*
+   * Prepare the chunks to hand out.
+   * The first chunk of each core is assigned statically (the chunk with the
+   * same index of the core ID). Hence, the chunks to hand out start from
+   * @numCores.
+   */
+  DOALL_schedule_t schedule;
+  DOALL_schedule_t *schedulePtr = nullptr;
+  if (scheduling != NOELLE_DOALL_STATIC_SCHEDULING) {
+    schedule.nextChunk.store(numCores, std::memory_order_relaxed);
+    schedule.numberOfChunks = numberOfChunks;
+    schedule.numCores = numCores;
+    schedule.scheduling = scheduling;
+    schedulePtr = &schedule;
+  }
+
+  /*
+   * Run the loop on the current thread if we got only one core.
+   * This avoids any interaction with the thread pool.
+   */
+  if (numCores == 1) {
+    DOALL_chunkReservation_t reservation{ schedulePtr, 0, 0, cancellation };
+    auto prevReservation = currentDOALLReservation;
+    auto prevNestedCoreBudget = currentNestedCoreBudget;
+    currentDOALLReservation = &reservation;
+    currentNestedCoreBudget = nestedCoreBudget;
+    parallelizedLoop(env, 0, 1, chunkSize);
+    currentDOALLReservation = prevReservation;
+    currentNestedCoreBudget = prevNestedCoreBudget;
+    if (team != nullptr) {
+      team->release();
+    }
+    runtime.exitParallelRegion(coresReserved);
+    if (telemetryEnabled) {
+      auto cycles = NOELLE_getCycles() - startCycles;
+      NOELLE_taskTelemetry_t mainTelemetry{ cycles, 0, 0, nullptr };
+      NOELLE_taskTelemetry_t *tasks[1] = { &mainTelemetry };
+      NOELLE_invocationTelemetry_t invocation{ cycles, 0, 0, 0 };
+      runtime.telemetry.recordInvocation((void *)parallelizedLoop,
+                                         "DOALL",
+                                         invocation,
+                                         tasks,
+                                         1,
+                                         0);
+    }
+
+    DispatcherInfo dispatcherInfo;
+    dispatcherInfo.numberOfThreadsUsed = 1;
+    return dispatcherInfo;
+  }
+
+  /*
+   * Check if tasks must run on the same workers as the previous invocations.
+   * This is not done for nested invocations because the workers they would
+   * target might be running the tasks that wait for them.
+   */
+  auto preserveAffinity =
+      (true && runtime.isDOALLAffinityEnabled() && (team == nullptr)
+       && (currentNestedCoreBudget == 0)
+       && (numCores <= threadPool->getNumberOfWorkers()));
+
+  /*
+   * Allocate the memory to store the arguments.
+   */
+  uint32_t doallMemoryIndex;
+  auto argsForAllCores = runtime.getDOALLArgs(numCores - 1, &doallMemoryIndex);
+  NoelleCountdownLatch endLatch(numCores - 1);
+
+  /*
+   * Submit DOALL tasks.
+   */
+  uint64_t dispatchStartCycles = 0;
+  if (telemetryEnabled) {
+    dispatchStartCycles = NOELLE_getCycles();
+  }
+  for (auto i = 0; i < (numCores - 1); ++i) {
+
+    /*
+     * Prepare the arguments.
+     */
+    auto argsPerCore = &argsForAllCores[i];
+    argsPerCore->parallelizedLoop = parallelizedLoop;
+    argsPerCore->env = env;
+    argsPerCore->numCores = numCores;
+    argsPerCore->chunkSize = chunkSize;
+    argsPerCore->reservation.schedule = schedulePtr;
+    argsPerCore->reservation.nextReservedChunk = 0;
+    argsPerCore->reservation.endOfReservedChunks = 0;
+    argsPerCore->reservation.cancellation = cancellation;
+    argsPerCore->endLatch = &endLatch;
+    argsPerCore->nestedCoreBudget = nestedCoreBudget;
+    argsPerCore->telemetry.busyCycles = 0;
+
+    /*
+     * Submit
+     */
+    if (preserveAffinity) {
+      threadPool->submitToWorker(i,
+                                 NOELLE_DOALLAffinityTrampoline,
+                                 argsPerCore);
+    } else if (team == nullptr) {
+      threadPool->submitAndDetach(NOELLE_DOALLTrampoline, argsPerCore);
+    }
+
+#ifdef RUNTIME_PRINT
+    std::cerr << "Submitted DOALL task on core " << i << std::endl;
+#endif
+  }
+  if (team != nullptr) {
+    team->run(NOELLE_DOALLTrampoline,
+              argsForAllCores,
+              sizeof(DOALL_args_t),
+              numCores - 1);
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "Submitted pool" << std::endl;
+#endif
+
+  /*
+   * Run a task.
+   */
+  NOELLE_taskTelemetry_t mainTelemetry{ 0, 0, 0, nullptr };
+  uint64_t mainStartCycles = 0;
+  if (telemetryEnabled) {
+    mainStartCycles = NOELLE_getCycles();
+  }
+  DOALL_chunkReservation_t reservation;
+  reservation.schedule = schedulePtr;
+  reservation.nextReservedChunk = 0;
+  reservation.endOfReservedChunks = 0;
+  reservation.cancellation = cancellation;
+  auto prevReservation = currentDOALLReservation;
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentDOALLReservation = &reservation;
+  currentNestedCoreBudget = nestedCoreBudget;
+  {
+    NoelleTraceScope traceScope{ "DOALL task",
+                                 (void *)parallelizedLoop,
+                                 numCores - 1 };
+    parallelizedLoop(env, numCores - 1, numCores, chunkSize);
+  }
+  currentDOALLReservation = prevReservation;
+  currentNestedCoreBudget = prevNestedCoreBudget;
+  uint64_t mainEndCycles = 0;
+  if (telemetryEnabled) {
+    mainEndCycles = NOELLE_getCycles();
+    mainTelemetry.busyCycles = mainEndCycles - mainStartCycles;
+  }
+
+  /*
+   * Wait for the remaining DOALL tasks.
+   * Workers of a team are done with the arguments only once they arrive at
+   * the barrier of the team.
+   */
+  if (team != nullptr) {
+    team->wait();
+  } else {
+    endLatch.wait(runtime.getJoinSpinBudget());
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "All tasks completed" << std::endl;
+#endif
+
+  /*
+   * Record the invocation.
+   */
+  if (telemetryEnabled) {
+    NOELLE_taskTelemetry_t *tasks[numCores];
+    for (auto i = 0; i < (numCores - 1); i++) {
+      tasks[i] = &argsForAllCores[i].telemetry;
+    }
+    tasks[numCores - 1] = &mainTelemetry;
+    auto endCycles = NOELLE_getCycles();
+    NOELLE_invocationTelemetry_t invocation{
+      endCycles - startCycles,
+      dispatchStartCycles - startCycles,
+      mainStartCycles - dispatchStartCycles,
+      endCycles - mainEndCycles
+    };
+    runtime.telemetry.recordInvocation((void *)parallelizedLoop,
+                                       "DOALL",
+                                       invocation,
+                                       tasks,
+                                       numCores,
+                                       0);
+  }
+
+  /*
+   * Free the cores and memory.
+   */
+  if (team != nullptr) {
+    team->release();
+  }
+  runtime.exitParallelRegion(coresReserved);
+  runtime.releaseDOALLArgs(doallMemoryIndex);
+
+  /*
+   * Prepare the return value.
+   */
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = numCores;
+
+  return dispatcherInfo;
+}
+
+/*
+ * Measurements of an invocation whose cores are selected online.
+ */
+typedef struct {
+  NoelleTunedInvocation_t tuning;
+  bool previousJoinParks;
+  uint64_t startCycles;
+  std::vector<uint64_t> startEnergy;
+} NOELLE_tuningMeasurement_t;
+
+/*
+ * Start an invocation of @loop whose cores are selected online.
+ * Return the number of cores the invocation must request.
+ */
+static uint32_t NOELLE_startTunedInvocation(
+    void *loop,
+    uint32_t maxNumberOfCores,
+    NOELLE_tuningMeasurement_t *invocation) {
+  runtime.getTunedInvocation(loop, maxNumberOfCores, &invocation->tuning);
+  invocation->previousJoinParks = currentJoinParks;
+  currentJoinParks = invocation->tuning.parks;
+  if (invocation->tuning.measure) {
+    if (runtime.isCoreTuningMeasuringEnergy()) {
+      energyMeter.read(&invocation->startEnergy);
+    }
+    invocation->startCycles = NOELLE_getCycles();
+  }
+
+  return invocation->tuning.cores;
+}
+
+/*
+ * End an invocation started by NOELLE_startTunedInvocation.
+ * @work is the work of the invocation (e.g., its iterations), or 1 if it is
+ * unknown.
+ */
+static void NOELLE_endTunedInvocation(void *loop,
+                                      NOELLE_tuningMeasurement_t *invocation,
+                                      uint32_t threadsUsed,
+                                      uint64_t work) {
+  currentJoinParks = invocation->previousJoinParks;
+  if (!invocation->tuning.measure) {
+    return;
+  }
+  auto cycles = NOELLE_getCycles() - invocation->startCycles;
+  double joules = 0;
+  if (runtime.isCoreTuningMeasuringEnergy()) {
+    std::vector<uint64_t> endEnergy;
+    if (!energyMeter.read(&endEnergy)) {
+      return;
+    }
+    joules = energyMeter.getJoules(invocation->startEnergy, endEnergy);
+  }
+  runtime.recordTunedInvocation(loop,
+                                invocation->tuning,
+                                threadsUsed,
+                                cycles,
+                                joules,
+                                work);
+
+  return;
+}
+
+/*
+ * Run a DOALL invocation with the number of cores selected online for the
+ * loop, if enabled (see NoelleRuntime::getTunedInvocation).
+ * @work is the work of the invocation (e.g., its iterations), or 1 if it is
+ * unknown.
+ */
+static DispatcherInfo NOELLE_DOALLDispatcherWithTuning(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    uint64_t work) {
+
+  /*
+   * Nested invocations and the ones of persistent regions run on the cores
+   * of their enclosing region, so we do not tune them.
+   */
+  if (false || !runtime.isCoreTuningEnabled() || (maxNumberOfCores <= 1)
+      || (currentNestedCoreBudget > 0) || (currentTeam != nullptr)) {
+    return NOELLE_DOALLDispatcherImpl(parallelizedLoop,
+                                      env,
+                                      maxNumberOfCores,
+                                      chunkSize,
+                                      scheduling,
+                                      numberOfChunks,
+                                      nullptr);
+  }
+
+  /*
+   * Run the invocation with the cores selected.
+   */
+  NOELLE_tuningMeasurement_t invocation;
+  auto cores = NOELLE_startTunedInvocation((void *)parallelizedLoop,
+                                           maxNumberOfCores,
+                                           &invocation);
+  auto dispatcherInfo = NOELLE_DOALLDispatcherImpl(parallelizedLoop,
+                                                   env,
+                                                   cores,
+                                                   chunkSize,
+                                                   scheduling,
+                                                   numberOfChunks,
+                                                   nullptr);
+  NOELLE_endTunedInvocation((void *)parallelizedLoop,
+                            &invocation,
+                            dispatcherInfo.numberOfThreadsUsed,
+                            work);
+
+  return dispatcherInfo;
+}
+
+DispatcherInfo NOELLE_DOALLDispatcher(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize) {
+  return NOELLE_DOALLDispatcherWithTuning(parallelizedLoop,
+                                          env,
+                                          maxNumberOfCores,
+                                          chunkSize,
+                                          NOELLE_DOALL_STATIC_SCHEDULING,
+                                          0,
+                                          1);
+}
+
+/*
+ * DOALL invocation dispatched by NOELLE_DOALLDispatcherAsync.
+ * @endLatch is nullptr if the invocation already completed at dispatch time.
+ */
+typedef struct {
+  NoelleCountdownLatch *endLatch;
+  DOALL_args_t *args;
+  uint32_t doallMemoryIndex;
+  uint32_t coresReserved;
+  int32_t numberOfThreadsUsed;
+} DOALL_asyncInvocation_t;
+
+void *NOELLE_DOALLDispatcherAsync(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize) {
+  NoelleTraceScope traceScope{ "DOALL async dispatch",
+                               (void *)parallelizedLoop,
+                               maxNumberOfCores };
+  auto invocation = new DOALL_asyncInvocation_t();
+  invocation->endLatch = nullptr;
+
+  /*
+   * The team of a persistent region waits for the calling thread to run a
+   * task. Hence, the invocation runs synchronously.
+   */
+  if (currentTeam != nullptr) {
+    auto dispatcherInfo = NOELLE_DOALLDispatcher(parallelizedLoop,
+                                                 env,
+                                                 maxNumberOfCores,
+                                                 chunkSize);
+    invocation->numberOfThreadsUsed = dispatcherInfo.numberOfThreadsUsed;
+    return invocation;
+  }
+
+  /*
+   * Set the number of cores to use.
+   * The calling thread keeps one of them to run the code after the loop.
+   */
+  uint32_t nestedCoreBudget;
+  auto numCores = runtime.enterParallelRegion(maxNumberOfCores,
+                                              &invocation->coresReserved,
+                                              &nestedCoreBudget);
+  int64_t numTasks = numCores - 1;
+
+  /*
+   * Run the loop synchronously if no other core is available.
+   */
+  if (numTasks == 0) {
+    runtime.exitParallelRegion(invocation->coresReserved);
+    auto dispatcherInfo = NOELLE_DOALLDispatcher(parallelizedLoop,
+                                                 env,
+                                                 maxNumberOfCores,
+                                                 chunkSize);
+    invocation->numberOfThreadsUsed = dispatcherInfo.numberOfThreadsUsed;
+    return invocation;
+  }
+
+  /*
+   * Allocate the memory to store the arguments.
+   * It stays in use until the invocation is joined.
+   */
+  invocation->args =
+      runtime.getDOALLArgs(numTasks, &invocation->doallMemoryIndex);
+  invocation->endLatch = new NoelleCountdownLatch(numTasks);
+  invocation->numberOfThreadsUsed = numTasks;
+
+  /*
+   * Submit DOALL tasks.
+   */
+  auto threadPool = runtime.threadPool;
+  for (auto i = 0; i < numTasks; ++i) {
+
+    /*
+     * Prepare the arguments.
+     */
+    auto argsPerCore = &invocation->args[i];
+    argsPerCore->parallelizedLoop = parallelizedLoop;
+    argsPerCore->env = env;
+    argsPerCore->numCores = numTasks;
+    argsPerCore->chunkSize = chunkSize;
+    argsPerCore->reservation.schedule = nullptr;
+    argsPerCore->reservation.nextReservedChunk = 0;
+    argsPerCore->reservation.endOfReservedChunks = 0;
+    argsPerCore->reservation.cancellation = nullptr;
+    argsPerCore->endLatch = invocation->endLatch;
+    argsPerCore->nestedCoreBudget = nestedCoreBudget;
+    argsPerCore->telemetry.busyCycles = 0;
+
+    /*
+     * Submit
+     */
+    threadPool->submitAndDetach(NOELLE_DOALLTrampoline, argsPerCore);
+  }
+
+  return invocation;
+}
+
+DispatcherInfo NOELLE_DOALLJoin(void *handle) {
+  auto invocation = (DOALL_asyncInvocation_t *)handle;
+  assert(invocation != nullptr);
+
+  /*
+   * Wait for the DOALL tasks.
+   * Then, free the cores and memory.
+   */
+  if (invocation->endLatch != nullptr) {
+    NoelleTraceScope traceScope{ "DOALL join",
+                                 (void *)invocation->args[0].parallelizedLoop,
+                                 invocation->numberOfThreadsUsed };
+    invocation->endLatch->wait(runtime.getSpinBudget());
+    delete invocation->endLatch;
+    runtime.exitParallelRegion(invocation->coresReserved);
+    runtime.releaseDOALLArgs(invocation->doallMemoryIndex);
+  }
+
+  /*
+   * Prepare the return value.
+   */
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = invocation->numberOfThreadsUsed;
+  delete invocation;
+
+  return dispatcherInfo;
+}
+
+/*
+ * Task dispatched by NOELLE_TaskDispatcherAsync or NOELLE_TaskSpawn.
+ * @endLatch is nullptr if the task already completed at dispatch time.
+ * @spawnDepth is the number of spawned tasks that include the task.
+ */
+typedef struct {
+  void (*task)(void *);
+  void *env;
+  NoelleCountdownLatch *endLatch;
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  uint32_t spawnDepth;
+} Task_asyncInvocation_t;
+
+static void NOELLE_TaskTrampoline(void *args) {
+  auto invocation = (Task_asyncInvocation_t *)args;
+
+  /*
+   * Set the cores the nested regions of the task can use.
+   */
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentNestedCoreBudget = invocation->nestedCoreBudget;
+
+  /*
+   * Invoke
+   */
+  {
+    NoelleTraceScope traceScope{ "Task", (void *)invocation->task, 0 };
+    invocation->task(invocation->env);
+  }
+  currentNestedCoreBudget = prevNestedCoreBudget;
+
+  invocation->endLatch->countDown();
+  return;
+}
+
+void *NOELLE_TaskDispatcherAsync(void (*task)(void *), void *env) {
+  NoelleTraceScope traceScope{ "Task async dispatch", (void *)task, 2 };
+  auto invocation = new Task_asyncInvocation_t();
+  invocation->task = task;
+  invocation->env = env;
+  invocation->endLatch = nullptr;
+
+  /*
+   * The team of a persistent region waits for the calling thread to run a
+   * task. Hence, the task runs synchronously.
+   */
+  if (currentTeam == nullptr) {
+
+    /*
+     * Reserve a core for the task.
+     * The calling thread keeps its own core to run the code after the task.
+     */
+    auto numCores = runtime.enterParallelRegion(2,
+                                                &invocation->coresReserved,
+                                                &invocation->nestedCoreBudget);
+    if (numCores > 1) {
+      invocation->endLatch = new NoelleCountdownLatch(1);
+      runtime.threadPool->submitAndDetach(NOELLE_TaskTrampoline, invocation);
+      return invocation;
+    }
+    runtime.exitParallelRegion(invocation->coresReserved);
+  }
+
+  /*
+   * Run the task synchronously.
+   */
+  task(env);
+
+  return invocation;
+}
+
+void NOELLE_TaskJoin(void *handle) {
+  auto invocation = (Task_asyncInvocation_t *)handle;
+  assert(invocation != nullptr);
+
+  /*
+   * Wait for the task.
+   * Then, free its core.
+   */
+  if (invocation->endLatch != nullptr) {
+    NoelleTraceScope traceScope{ "Task join", (void *)invocation->task, 0 };
+    invocation->endLatch->wait(runtime.getSpinBudget());
+    delete invocation->endLatch;
+    runtime.exitParallelRegion(invocation->coresReserved);
+  }
+  delete invocation;
+
+  return;
+}
+
+static void NOELLE_TaskSpawnTrampoline(void *args) {
+  auto invocation = (Task_asyncInvocation_t *)args;
+
+  /*
+   * Set the depth of the tasks the task spawns, and the cores its nested
+   * regions can use.
+   */
+  auto prevTaskSpawnDepth = currentTaskSpawnDepth;
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentTaskSpawnDepth = invocation->spawnDepth;
+  currentNestedCoreBudget = invocation->nestedCoreBudget;
+
+  /*
+   * Invoke
+   */
+  {
+    NoelleTraceScope traceScope{ "Task", (void *)invocation->task, 0 };
+    invocation->task(invocation->env);
+  }
+  currentTaskSpawnDepth = prevTaskSpawnDepth;
+  currentNestedCoreBudget = prevNestedCoreBudget;
+
+  invocation->endLatch->countDown();
+  return;
+}
+
+void *NOELLE_TaskSpawn(void (*task)(void *), void *env) {
+  auto invocation = new Task_asyncInvocation_t();
+  invocation->task = task;
+  invocation->env = env;
+  invocation->endLatch = nullptr;
+
+  /*
+   * Check whether the task can be spawned.
+   * Like for NOELLE_TaskDispatcherAsync, the team of a persistent region waits
+   * for the calling thread.
+   */
+  if (true && (currentTeam == nullptr)
+      && (currentTaskSpawnDepth < runtime.getTaskSpawnDepth())) {
+
+    /*
+     * Reserve a core for the task.
+     * The first task of a recursion is a parallel region, which follows the
+     * nesting policy. The tasks it spawns belong to the same region instead:
+     * they only need an idle core.
+     */
+    uint32_t numCores;
+    if (currentTaskSpawnDepth == 0) {
+      numCores = runtime.enterParallelRegion(2,
+                                             &invocation->coresReserved,
+                                             &invocation->nestedCoreBudget);
+    } else {
+      invocation->coresReserved = runtime.reserveIdleCores(1);
+      invocation->nestedCoreBudget = currentNestedCoreBudget;
+      numCores = invocation->coresReserved + 1;
+    }
+    if (numCores > 1) {
+      NoelleTraceScope traceScope{ "Task spawn", (void *)task, 2 };
+      invocation->spawnDepth = currentTaskSpawnDepth + 1;
+      invocation->endLatch = new NoelleCountdownLatch(1);
+      runtime.threadPool->submitAndDetach(NOELLE_TaskSpawnTrampoline,
+                                          invocation);
+      return invocation;
+    }
+    runtime.exitParallelRegion(invocation->coresReserved);
+  }
+
+  /*
+   * Run the task synchronously.
+   */
+  task(env);
+
+  return invocation;
+}
+
+void NOELLE_TaskSync(void *handle) {
+  auto invocation = (Task_asyncInvocation_t *)handle;
+  assert(invocation != nullptr);
+
+  /*
+   * Run the task if no idle core started it yet.
+   * Tasks are usually synchronized in the reverse order they are spawned, so
+   * this task is likely the last one the current thread submitted.
+   */
+  if (invocation->endLatch != nullptr) {
+    auto ranLocally =
+        runtime.threadPool->runLocalTask(NOELLE_TaskSpawnTrampoline,
+                                         invocation);
+
+    /*
+     * Wait for the task.
+     * Then, free its core.
+     */
+    NoelleTraceScope traceScope{ "Task sync", (void *)invocation->task, 0 };
+    invocation->endLatch->wait(ranLocally ? 0 : runtime.getSpinBudget());
+    delete invocation->endLatch;
+    runtime.exitParallelRegion(invocation->coresReserved);
+  }
+  delete invocation;
+
+  return;
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithScheduling(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks) {
+  return NOELLE_DOALLDispatcherWithTuning(parallelizedLoop,
+                                          env,
+                                          maxNumberOfCores,
+                                          chunkSize,
+                                          scheduling,
+                                          numberOfChunks,
+                                          1);
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithTripCount(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    int64_t tripCount) {
+
+  /*
+   * Check if the trip count is meaningful.
+   * It is not if the iterations are counted by an induction variable that
+   * wraps around.
+   */
+  if (tripCount <= 0) {
+    return NOELLE_DOALLDispatcherWithTuning(parallelizedLoop,
+                                            env,
+                                            maxNumberOfCores,
+                                            chunkSize,
+                                            scheduling,
+                                            numberOfChunks,
+                                            1);
+  }
+
+  /*
+   * Estimate whether executing the iterations costs less than dispatching
+   * them.
+   * Loops never measured before are dispatched to learn their cost.
+   */
+  auto dispatchCost = (double)runtime.getDOALLDispatchCost();
+  double cyclesPerIteration;
+  auto isSequential = false;
+  if (true
+      && runtime.getDOALLCyclesPerIteration((void *)parallelizedLoop,
+                                            &cyclesPerIteration)
+      && ((tripCount * cyclesPerIteration) < dispatchCost)) {
+    isSequential = true;
+  }
+
+  /*
+   * Run the loop.
+   * A single core makes the dispatcher run the loop on the current thread.
+   */
+  auto startCycles = NOELLE_getCycles();
+  auto dispatcherInfo =
+      NOELLE_DOALLDispatcherWithTuning(parallelizedLoop,
+                                       env,
+                                       isSequential ? 1 : maxNumberOfCores,
+                                       chunkSize,
+                                       scheduling,
+                                       numberOfChunks,
+                                       tripCount);
+  auto cycles = (double)(NOELLE_getCycles() - startCycles);
+
+  /*
+   * Update the cycles per iteration of the loop.
+   * For parallel invocations, we remove the dispatch cost and account for the
+   * iterations executed concurrently.
+   */
+  auto threadsUsed = dispatcherInfo.numberOfThreadsUsed;
+  if (threadsUsed > 1) {
+    cycles = std::max(cycles - dispatchCost, 0.0) * threadsUsed;
+  }
+  runtime.setDOALLCyclesPerIteration((void *)parallelizedLoop,
+                                     cycles / tripCount);
+
+  return dispatcherInfo;
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithCancellation(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    int32_t *exitBlockTaken) {
+
+  /*
+   * Allocate the state used by the tasks to stop each other.
+   */
+  DOALL_cancellation_t cancellation;
+  cancellation.firstExitIteration.store(INT64_MAX, std::memory_order_relaxed);
+  cancellation.exitBlockIndex = 0;
+  pthread_spin_init(&cancellation.lock, 0);
+
+  /*
+   * Run the loop.
+   */
+  auto dispatcherInfo = NOELLE_DOALLDispatcherImpl(parallelizedLoop,
+                                                   env,
+                                                   maxNumberOfCores,
+                                                   chunkSize,
+                                                   scheduling,
+                                                   numberOfChunks,
+                                                   &cancellation);
+
+  /*
+   * All tasks are done.
+   * Report the exit taken by the earliest iteration that left the loop.
+   */
+  if (cancellation.firstExitIteration.load(std::memory_order_relaxed)
+      != INT64_MAX) {
+    *exitBlockTaken = (int32_t)cancellation.exitBlockIndex;
+  }
+  pthread_spin_destroy(&cancellation.lock);
+
+  return dispatcherInfo;
+}
+
+/*
+ * Arguments of the tasks of a DOALL invocation with a fixed number of tasks.
+ */
+typedef struct {
+  void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t);
+  void *env;
+  int64_t numberOfTasks;
+} DOALL_fixedTasks_t;
+
+static void NOELLE_DOALLFixedTasksTrampoline(void *args,
+                                             int64_t coreID,
+                                             int64_t numCores,
+                                             int64_t chunkSize) {
+  auto fixedTasks = (DOALL_fixedTasks_t *)args;
+
+  /*
+   * Run the tasks of the current core one after the other.
+   */
+  for (auto taskID = coreID; taskID < fixedTasks->numberOfTasks;
+       taskID += numCores) {
+    fixedTasks->parallelizedLoop(fixedTasks->env,
+                                 taskID,
+                                 fixedTasks->numberOfTasks,
+                                 chunkSize);
+  }
+
+  return;
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithFixedTasks(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t numberOfTasks,
+    int64_t chunkSize) {
+
+  /*
+   * Run the tasks on the cores available.
+   */
+  DOALL_fixedTasks_t fixedTasks;
+  fixedTasks.parallelizedLoop = parallelizedLoop;
+  fixedTasks.env = env;
+  fixedTasks.numberOfTasks = std::max(numberOfTasks, (int64_t)1);
+  NOELLE_DOALLDispatcherImpl(NOELLE_DOALLFixedTasksTrampoline,
+                             &fixedTasks,
+                             fixedTasks.numberOfTasks,
+                             chunkSize,
+                             NOELLE_DOALL_STATIC_SCHEDULING,
+                             0,
+                             nullptr);
+
+  /*
+   * All tasks have run, whatever the number of cores used.
+   */
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = fixedTasks.numberOfTasks;
+
+  return dispatcherInfo;
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithScan(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t numberOfTasks,
+    int64_t tripCount,
+    void *prefixes,
+    int64_t elementType,
+    int64_t operation) {
+  DispatcherInfo dispatcherInfo;
+
+  /*
+   * Check if running the iterations twice in parallel is worth it.
+   * The trip count is not meaningful if the iterations are counted by an
+   * induction variable that wraps around.
+   */
+  auto minimumTripCount =
+      numberOfTasks * NOELLE_SCAN_MINIMUM_ITERATIONS_PER_TASK;
+  if (false || (numberOfTasks <= 1) || (tripCount <= 0)
+      || (tripCount < minimumTripCount)) {
+    parallelizedLoop(env, 0, 1, std::max(tripCount, (int64_t)1));
+    dispatcherInfo.numberOfThreadsUsed = 1;
+    return dispatcherInfo;
+  }
+
+  /*
+   * Each task runs one block of consecutive iterations.
+   */
+  auto chunkSize = (tripCount + numberOfTasks - 1) / numberOfTasks;
+  auto slots = (uint64_t *)prefixes;
+  NOELLE_forReductionType(elementType, [&](auto typeValue) {
+    using T = decltype(typeValue);
+    NOELLE_forReductionOperation<T>(operation, [&](auto reduce) {
+      auto slotOf = [slots](int64_t task) -> T * {
+        return (T *)(slots + task);
+      };
+
+      /*
+       * Compute the value of each block.
+       * The blocks after the first one start from the identity.
+       */
+      auto initialValue = *slotOf(0);
+      auto identity = NOELLE_getReductionIdentity<T>(operation);
+      for (auto task = 1; task < numberOfTasks; task++) {
+        *slotOf(task) = identity;
+      }
+      NOELLE_DOALLDispatcherWithFixedTasks(parallelizedLoop,
+                                           env,
+                                           numberOfTasks,
+                                           chunkSize);
+
+      /*
+       * Compute the value of the variable before each block.
+       */
+      auto prefix = *slotOf(0);
+      for (auto task = 1; task < numberOfTasks; task++) {
+        auto valueOfTheBlock = *slotOf(task);
+        *slotOf(task) = prefix;
+        prefix = reduce(prefix, valueOfTheBlock);
+      }
+      *slotOf(0) = initialValue;
+
+      /*
+       * Compute the final values.
+       * The first block computed them already, but running it again costs no
+       * time as it runs at the same time as the other ones.
+       */
+      NOELLE_DOALLDispatcherWithFixedTasks(parallelizedLoop,
+                                           env,
+                                           numberOfTasks,
+                                           chunkSize);
+    });
+  });
+  dispatcherInfo.numberOfThreadsUsed = numberOfTasks;
+
+  return dispatcherInfo;
+}
+
+#ifdef NOELLE_MPI
+/*
+ * Arguments of the tasks a rank runs of a DOALL invocation distributed across
+ * MPI ranks.
+ */
+typedef struct {
+  void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t);
+  void *env;
+  int64_t firstTask;
+  int64_t numberOfLocalTasks;
+  int64_t numberOfTasks;
+} DOALL_distributed_t;
+
+static void NOELLE_DOALLDistributedTrampoline(void *args,
+                                              int64_t coreID,
+                                              int64_t numCores,
+                                              int64_t chunkSize) {
+  auto distributed = (DOALL_distributed_t *)args;
+
+  /*
+   * Run the tasks of the rank assigned to the current core.
+   */
+  for (auto taskID = coreID; taskID < distributed->numberOfLocalTasks;
+       taskID += numCores) {
+    distributed->parallelizedLoop(distributed->env,
+                                  distributed->firstTask + taskID,
+                                  distributed->numberOfTasks,
+                                  chunkSize);
+  }
+
+  return;
+}
+
+static void NOELLE_finalizeMPI(void) {
+  auto finalized = 0;
+  MPI_Finalized(&finalized);
+  if (!finalized) {
+    MPI_Finalize();
+  }
+
+  return;
+}
+
+/*
+ * Fetch the rank of the program and the number of ranks.
+ * MPI is initialized here if the program does not use it.
+ */
+static void NOELLE_getMPIRanks(int &rank, int &ranks) {
+  static std::once_flag initialization;
+  std::call_once(initialization, []() {
+    auto initialized = 0;
+    MPI_Initialized(&initialized);
+    if (initialized) {
+      return;
+    }
+    auto provided = 0;
+    MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided);
+    atexit(NOELLE_finalizeMPI);
+  });
+
+  /*
+   * The program could have finalized MPI already.
+   */
+  rank = 0;
+  ranks = 1;
+  auto finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized) {
+    return;
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+
+  return;
+}
+#endif
+
+DispatcherInfo NOELLE_DOALLDispatcherDistributed(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    const char *distribution) {
+#ifndef NOELLE_MPI
+  return NOELLE_DOALLDispatcher(parallelizedLoop,
+                                env,
+                                maxNumberOfCores,
+                                chunkSize);
+#else
+
+  /*
+   * Check if there are other ranks to share the loop with.
+   */
+  int rank = 0;
+  int ranks = 1;
+  NOELLE_getMPIRanks(rank, ranks);
+  if (false || (ranks <= 1) || (distribution == nullptr)) {
+    return NOELLE_DOALLDispatcher(parallelizedLoop,
+                                  env,
+                                  maxNumberOfCores,
+                                  chunkSize);
+  }
+
+  /*
+   * Fetch the variables to move between ranks.
+   * Variables are described by "b:OFFSET:BYTES" or by
+   * "p:OFFSET:STRIDE:TYPE:OPERATION".
+   */
+  typedef struct {
+    uint8_t **copiesSlot;
+    uint8_t *originalCopies;
+    uint8_t *copies;
+    int64_t stride;
+    int64_t elementType;
+    int64_t operation;
+  } NOELLE_distributedReduction_t;
+  auto envBytes = (uint8_t *)env;
+  auto numberOfLocalTasks = std::max(maxNumberOfCores, (int64_t)1);
+  auto numberOfTasks = numberOfLocalTasks * ranks;
+  std::vector<NOELLE_distributedReduction_t> reductions;
+  std::string variables{ distribution };
+  size_t start = 0;
+  while (start < variables.size()) {
+    auto end = variables.find(',', start);
+    if (end == std::string::npos) {
+      end = variables.size();
+    }
+    auto variable = variables.substr(start, end - start);
+    start = end + 1;
+    char kind = 'b';
+    unsigned long long offset = 0;
+    unsigned long long bytes = 0;
+    long long elementType = 0;
+    long long operation = 0;
+    auto fields = sscanf(variable.c_str(),
+                         "%c:%llu:%llu:%lld:%lld",
+                         &kind,
+                         &offset,
+                         &bytes,
+                         &elementType,
+                         &operation);
+    if (fields < 3) {
+      continue;
+    }
+
+    /*
+     * The live-ins of rank 0 are the ones of every rank.
+     */
+    if (kind == 'b') {
+      MPI_Bcast(envBytes + offset, (int)bytes, MPI_BYTE, 0, MPI_COMM_WORLD);
+      continue;
+    }
+    if (fields < 5) {
+      continue;
+    }
+
+    /*
+     * The tasks of the rank write the private copies of their global ID,
+     * which are more than the ones allocated by the caller.
+     */
+    NOELLE_distributedReduction_t reduction;
+    reduction.copiesSlot = (uint8_t **)(envBytes + offset);
+    reduction.originalCopies = *reduction.copiesSlot;
+    reduction.stride = bytes;
+    reduction.elementType = elementType;
+    reduction.operation = operation;
+    reduction.copies = (uint8_t *)runtime.getPrivateCopy(reduction.stride
+                                                         * numberOfTasks);
+    *reduction.copiesSlot = reduction.copies;
+    reductions.push_back(reduction);
+  }
+
+  /*
+   * Run the tasks of the current rank on its cores.
+   */
+  DOALL_distributed_t distributed;
+  distributed.parallelizedLoop = parallelizedLoop;
+  distributed.env = env;
+  distributed.firstTask = rank * numberOfLocalTasks;
+  distributed.numberOfLocalTasks = numberOfLocalTasks;
+  distributed.numberOfTasks = numberOfTasks;
+  NOELLE_DOALLDispatcherImpl(NOELLE_DOALLDistributedTrampoline,
+                             &distributed,
+                             numberOfLocalTasks,
+                             chunkSize,
+                             NOELLE_DOALL_STATIC_SCHEDULING,
+                             0,
+                             nullptr);
+
+  /*
+   * Combine the private copies of the rank, and then the values of all ranks
+   * in the order of their rank.
+   * The result is stored in the first private copy of the caller.
+   */
+  for (auto &reduction : reductions) {
+    *reduction.copiesSlot = reduction.originalCopies;
+    NOELLE_forReductionType(reduction.elementType, [&](auto typeValue) {
+      using T = decltype(typeValue);
+      NOELLE_forReductionOperation<T>(reduction.operation, [&](auto reduce) {
+        auto copyOf = [&reduction](int64_t task) -> T * {
+          return (T *)(reduction.copies + (task * reduction.stride));
+        };
+        auto value = *copyOf(distributed.firstTask);
+        for (auto task = 1; task < numberOfLocalTasks; task++) {
+          value = reduce(value, *copyOf(distributed.firstTask + task));
+        }
+        std::vector<T> values(ranks);
+        MPI_Allgather(&value,
+                      sizeof(T),
+                      MPI_BYTE,
+                      values.data(),
+                      sizeof(T),
+                      MPI_BYTE,
+                      MPI_COMM_WORLD);
+        value = values[0];
+        for (auto r = 1; r < ranks; r++) {
+          value = reduce(value, values[r]);
+        }
+        *((T *)reduction.originalCopies) = value;
+      });
+    });
+    runtime.releasePrivateCopy(reduction.copies,
+                               reduction.stride * numberOfTasks);
+  }
+
+  /*
+   * Only the first private copy is meaningful.
+   */
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = 1;
+
+  return dispatcherInfo;
+#endif
+}
+
+/*
+ * Arguments of the tasks of a speculative DOALL invocation.
+ */
+typedef struct {
+  void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t);
+  void *env;
+  NoelleSpeculativeTask *tasks;
+} DOALL_speculation_t;
+
+static void NOELLE_DOALLSpeculativeTrampoline(void *args,
+                                              int64_t coreID,
+                                              int64_t numCores,
+                                              int64_t chunkSize) {
+  auto speculation = (DOALL_speculation_t *)args;
+
+  /*
+   * Run the task with its memory accesses tracked.
+   */
+  auto prevSpeculativeTask = currentSpeculativeTask;
+  currentSpeculativeTask = &speculation->tasks[coreID];
+  speculation->parallelizedLoop(speculation->env, coreID, numCores, chunkSize);
+  currentSpeculativeTask = prevSpeculativeTask;
+
+  return;
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithSpeculation(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks) {
+
+  /*
+   * Allocate the state of the tasks.
+   * The dispatcher never uses more cores than requested.
+   */
+  std::vector<NoelleSpeculativeTask> tasks(
+      std::max(maxNumberOfCores, (int64_t)1));
+  DOALL_speculation_t speculation{ parallelizedLoop, env, tasks.data() };
+
+  /*
+   * Run the loop speculatively.
+   */
+  auto dispatcherInfo =
+      NOELLE_DOALLDispatcherImpl(NOELLE_DOALLSpeculativeTrampoline,
+                                 &speculation,
+                                 maxNumberOfCores,
+                                 chunkSize,
+                                 scheduling,
+                                 numberOfChunks,
+                                 nullptr);
+
+  /*
+   * Validate the speculation.
+   */
+  auto numCores = dispatcherInfo.numberOfThreadsUsed;
+  auto hasConflicts = false;
+  for (auto i = 0; (i < numCores) && (!hasConflicts); i++) {
+    for (auto j = 0; j < numCores; j++) {
+      if (true && (i != j) && tasks[i].conflictsWith(tasks[j])) {
+        hasConflicts = true;
+        break;
+      }
+    }
+  }
+
+  /*
+   * Write the stores of the tasks to memory if the speculation succeeded.
+   * No two tasks wrote the same byte, so the order does not matter.
+   */
+  if (!hasConflicts) {
+    for (auto i = 0; i < numCores; i++) {
+      tasks[i].commit();
+    }
+    return dispatcherInfo;
+  }
+
+  /*
+   * The speculation failed: the stores of the tasks are discarded.
+   * Run the loop again on the current thread without speculation.
+   */
+#ifdef RUNTIME_PRINT
+  std::cerr << "Speculative DOALL: conflict detected" << std::endl;
+#endif
+  return NOELLE_DOALLDispatcherImpl(parallelizedLoop,
+                                    env,
+                                    1,
+                                    chunkSize,
+                                    scheduling,
+                                    numberOfChunks,
+                                    nullptr);
+}
+
+int64_t NOELLE_DOALL_speculativeLoad(void *address, int64_t size) {
+
+  /*
+   * Access memory directly if the current thread is not speculating (e.g.,
+   * the loop is running again after a failed speculation).
+   */
+  auto task = currentSpeculativeTask;
+  if (task == nullptr) {
+    int64_t value = 0;
+    std::memcpy(&value, address, size);
+    return value;
+  }
+
+  return task->load(address, size);
+}
+
+void NOELLE_DOALL_speculativeStore(void *address,
+                                   int64_t value,
+                                   int64_t size) {
+  auto task = currentSpeculativeTask;
+  if (task == nullptr) {
+    std::memcpy(address, &value, size);
+    return;
+  }
+
+  task->store(address, value, size);
+
+  return;
+}
+
+/*
+ * Return true if @values has no duplicates.
+ * A bitmap is used if the values span a small range; otherwise, the values are
+ * sorted.
+ */
+static bool NOELLE_DOALLAreIndicesDistinct(
+    std::vector<uint64_t> const &values) {
+  if (values.size() <= 1) {
+    return true;
+  }
+  auto minMax = std::minmax_element(values.begin(), values.end());
+  auto minValue = *minMax.first;
+  auto range = *minMax.second - minValue;
+  if (range < ((uint64_t)values.size() * 8)) {
+    std::vector<bool> seen(range + 1, false);
+    for (auto value : values) {
+      if (seen[value - minValue]) {
+        return false;
+      }
+      seen[value - minValue] = true;
+    }
+    return true;
+  }
+  auto sortedValues = values;
+  std::sort(sortedValues.begin(), sortedValues.end());
+  return std::adjacent_find(sortedValues.begin(), sortedValues.end())
+         == sortedValues.end();
+}
+
+DispatcherInfo NOELLE_DOALLDispatcherWithInspection(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize,
+    int64_t scheduling,
+    int64_t numberOfChunks,
+    void *indices,
+    int64_t indexBytes,
+    int64_t stride,
+    int64_t tripCount) {
+
+  /*
+   * The iterations cannot be inspected if their number is not meaningful
+   * (e.g., it is counted by an induction variable that wraps around).
+   */
+  auto isConflictFree = false;
+  if (true && (tripCount > 0)
+      && ((indexBytes == 1) || (indexBytes == 2) || (indexBytes == 4)
+          || (indexBytes == 8))) {
+
+    /*
+     * Fetch the indices of the iterations.
+     */
+    std::vector<uint64_t> values(tripCount, 0);
+    auto bytes = (uint8_t *)indices;
+    for (int64_t i = 0; i < tripCount; i++) {
+      std::memcpy(&values[i], bytes + (i * stride * indexBytes), indexBytes);
+    }
+
+    /*
+     * Reuse the last inspection of the loop if it inspected the same indices.
+     * The loop does not change its indices, so only the code executed
+     * between its invocations can.
+     */
+    auto inspection = runtime.getDOALLInspection((void *)parallelizedLoop);
+    if (true && (inspection != nullptr) && (inspection->indices == indices)
+        && (inspection->indexBytes == indexBytes)
+        && (inspection->stride == stride) && (inspection->values == values)) {
+      isConflictFree = inspection->isConflictFree;
+
+    } else {
+
+      /*
+       * Inspect the indices.
+       * No two iterations access the same memory if they use distinct
+       * indices.
+       */
+      isConflictFree = NOELLE_DOALLAreIndicesDistinct(values);
+      auto newInspection = std::make_shared<NoelleInspection_t>();
+      newInspection->indices = indices;
+      newInspection->indexBytes = indexBytes;
+      newInspection->stride = stride;
+      newInspection->values = std::move(values);
+      newInspection->isConflictFree = isConflictFree;
+      runtime.setDOALLInspection((void *)parallelizedLoop, newInspection);
+    }
+  }
+
+  /*
+   * Run the loop.
+   * Iterations that share indices run on the current thread in order.
+   */
+#ifdef RUNTIME_PRINT
+  if (!isConflictFree) {
+    std::cerr << "Inspected DOALL: conflict detected" << std::endl;
+  }
+#endif
+  return NOELLE_DOALLDispatcherWithTripCount(
+      parallelizedLoop,
+      env,
+      isConflictFree ? maxNumberOfCores : 1,
+      chunkSize,
+      scheduling,
+      numberOfChunks,
+      tripCount);
+}
+
+static void NOELLE_reduceArrayChunks(void *args,
+                                     int64_t coreID,
+                                     int64_t numCores,
+                                     int64_t chunkSize) {
+  auto reduction = (NOELLE_arrayReduction_t *)args;
+
+  /*
+   * Combine the chunks of elements of the current core.
+   * Each copy is combined in turn to access memory sequentially.
+   */
+  NOELLE_forReductionType(reduction->elementType, [&](auto typeValue) {
+    using T = decltype(typeValue);
+    NOELLE_forReductionOperation<T>(reduction->operation, [&](auto reduce) {
+      auto array = (T *)reduction->array;
+      for (auto first = coreID * chunkSize; first < reduction->elements;
+           first += numCores * chunkSize) {
+        auto last = std::min(first + chunkSize, reduction->elements);
+        for (auto c = 0; c < reduction->numberOfCopies; c++) {
+          auto copy = (T *)(reduction->copies + (c * reduction->stride));
+          for (auto i = first; i < last; i++) {
+            array[i] = reduce(array[i], copy[i]);
+          }
+        }
+      }
+    });
+  });
+
+  return;
+}
+
+void *NOELLE_allocateReductionArrays(int64_t bytes,
+                                     int64_t stride,
+                                     int64_t numberOfCopies,
+                                     int64_t elementType,
+                                     int64_t operation) {
+
+  /*
+   * Copies are recycled across invocations.
+   */
+  auto copies = (uint8_t *)runtime.getPrivateCopy(stride * numberOfCopies);
+
+  /*
+   * Initialize the copies with the identity of the operation.
+   */
+  NOELLE_forReductionType(elementType, [&](auto typeValue) {
+    using T = decltype(typeValue);
+    auto identity = NOELLE_getReductionIdentity<T>(operation);
+    auto elements = bytes / (int64_t)sizeof(T);
+    for (auto c = 0; c < numberOfCopies; c++) {
+      auto copy = (T *)(copies + (c * stride));
+      std::fill(copy, copy + elements, identity);
+    }
+  });
+
+  return copies;
+}
+
+void NOELLE_reduceArrays(void *array,
+                         void *copies,
+                         int64_t bytes,
+                         int64_t stride,
+                         int64_t numberOfCopies,
+                         int64_t numberOfCopiesUsed,
+                         int64_t elementType,
+                         int64_t operation) {
+
+  /*
+   * Fetch the number of elements.
+   */
+  int64_t elementBytes = 0;
+  NOELLE_forReductionType(elementType, [&elementBytes](auto typeValue) {
+    elementBytes = sizeof(typeValue);
+  });
+  NOELLE_arrayReduction_t reduction{ array,
+                                     (uint8_t *)copies,
+                                     bytes / elementBytes,
+                                     stride,
+                                     numberOfCopiesUsed,
+                                     elementType,
+                                     operation };
+
+  /*
+   * Combine the copies.
+   * Large arrays are split into a few chunks per core.
+   */
+  auto work = reduction.elements * numberOfCopiesUsed;
+  if (true && (numberOfCopiesUsed > 1)
+      && (work >= NOELLE_REDUCTION_PARALLEL_ELEMENTS)) {
+    auto chunkSize =
+        std::max(reduction.elements / (numberOfCopiesUsed * 4), (int64_t)1);
+    NOELLE_DOALLDispatcher(NOELLE_reduceArrayChunks,
+                           &reduction,
+                           numberOfCopiesUsed,
+                           chunkSize);
+  } else {
+    NOELLE_reduceArrayChunks(&reduction,
+                             0,
+                             1,
+                             std::max(reduction.elements, (int64_t)1));
+  }
+
+  /*
+   * Release the copies.
+   */
+  runtime.releasePrivateCopy(copies, stride * numberOfCopies);
+
+  return;
+}
+
+#ifdef RUNTIME_PRINT
+void *mySSGlobal = nullptr;
+#endif
+
+/**********************************************************************
+ *                HELIX
+ **********************************************************************/
+
+/*
+ * Entry of a sequential segment array.
+ *
+ * @lock is used by HELIX_wait and HELIX_signal.
+ * @token is used by HELIX_waitAdaptive and HELIX_signalAdaptive: the
+ * predecessor core sets it to 1 to let the current core enter the sequential
+ * segment, and the current core resets it to 0 when it enters.
+ * HELIX_waitDynamic and HELIX_signalDynamic use @token as the (truncated)
+ * ticket of the iteration that can enter the sequential segment instead.
+ * @mailbox is used by the compiler to forward loop-carried values to the next
+ * core: they are written before signaling, so they reach the next core with
+ * the cache line it is waiting on.
+ */
+typedef struct {
+  pthread_spinlock_t lock;
+  std::atomic<uint32_t> token;
+  uint8_t mailbox[CACHE_LINE_SIZE - 8];
+} HELIX_sequentialSegment_t;
+static_assert(sizeof(HELIX_sequentialSegment_t) <= CACHE_LINE_SIZE,
+              "A sequential segment entry must fit in a cache line");
+static_assert(offsetof(HELIX_sequentialSegment_t, mailbox) == 8,
+              "The compiler expects the mailbox after the first 8 bytes");
+
+/*
+ * Slot of the queue of a decoupled sequential prologue, which is the ring of
+ * NOELLE_HELIX_PROLOGUE_SLOTS cache lines after the loop-is-over flag.
+ *
+ * The slot of iteration i is free for the producer when @sequence is i, and it
+ * holds the values of the iteration for its consumer when @sequence is i + 1.
+ * @token tells the consumer whether to run the iteration (0), to run it and
+ * leave the loop (1), or to leave the task right away (2).
+ * @values are the values of the prologue used by the rest of the iteration,
+ * each one widened to 64 bits.
+ */
+typedef struct {
+  std::atomic<uint64_t> sequence;
+  uint64_t token;
+  uint64_t values[(CACHE_LINE_SIZE / 8) - 2];
+} HELIX_prologueSlot_t;
+static_assert(sizeof(HELIX_prologueSlot_t) == CACHE_LINE_SIZE,
+              "A slot of a prologue queue must fill a cache line");
+static_assert(offsetof(HELIX_prologueSlot_t, values) == 16,
+              "The compiler expects the values after the first 16 bytes");
+
+/*
+ * Cycles spent by the current thread waiting to enter sequential segments.
+ * This is tracked only when HELIX helper threads or the telemetry are enabled.
+ *
+ * When @segmentWaitCycles is not nullptr, the cycles are also accumulated per
+ * sequential segment of @ssArrayPast, which is the array the thread waits on.
+ */
+typedef struct {
+  uint64_t waits;
+  uint64_t cycles;
+  void *ssArrayPast;
+  uint64_t *segmentWaitCycles;
+} HELIX_waitStats_t;
+
+static thread_local HELIX_waitStats_t *currentHELIXWaitStats = nullptr;
+
+static inline void HELIX_recordWait(HELIX_waitStats_t *stats,
+                                    void *sequentialSegment,
+                                    uint64_t startCycles) {
+  auto cycles = NOELLE_getCycles() - startCycles;
+  stats->waits++;
+  stats->cycles += cycles;
+  if (stats->segmentWaitCycles != nullptr) {
+    auto segmentID =
+        (((uint64_t)sequentialSegment) - ((uint64_t)stats->ssArrayPast))
+        / CACHE_LINE_SIZE;
+    stats->segmentWaitCycles[segmentID] += cycles;
+  }
+
+  return;
+}
+
+/*
+ * Hardware transactions of the critical sections run by the current thread.
+ *
+ * Bit i of @activeSegments is set while sequential segment i of @ssArray runs
+ * as a transaction. Its signal ends the transaction rather than releasing the
+ * lock. Hence, there are at most 64 sequential segments.
+ * @segmentTransactions and @segmentAborts are the counters of the telemetry,
+ * if it is enabled.
+ */
+typedef struct {
+  void *ssArray;
+  uint64_t activeSegments;
+  uint64_t *segmentTransactions;
+  uint64_t *segmentAborts;
+} HELIX_transactionStats_t;
+
+static thread_local HELIX_transactionStats_t *currentHELIXTransactions =
+    nullptr;
+
+/*
+ * Number of critical sections of commutative sequential segments the current
+ * thread is in.
+ * A task must leave every critical section it entered before it returns.
+ */
+static thread_local uint32_t currentHELIXCriticalSections = 0;
+
+/*
+ * Try to run a critical section as a hardware transaction.
+ * The lock of the critical section is read inside the transaction: the
+ * transaction runs only if the lock is free, and it aborts if another core
+ * takes the lock before it ends.
+ * Return false if the transaction aborted NOELLE_HELIX_TRANSACTION_ATTEMPTS
+ * times, in which case the caller must take the lock.
+ */
+#if defined(__x86_64__)
+__attribute__((target("rtm"))) static bool HELIX_beginTransaction(
+    HELIX_transactionStats_t *stats,
+    HELIX_sequentialSegment_t *ss) {
+  auto segmentID =
+      (((uint64_t)ss) - ((uint64_t)stats->ssArray)) / CACHE_LINE_SIZE;
+  for (auto attempt = 0; attempt < NOELLE_HELIX_TRANSACTION_ATTEMPTS;
+       attempt++) {
+    if (stats->segmentTransactions != nullptr) {
+      stats->segmentTransactions[segmentID]++;
+    }
+    auto status = _xbegin();
+    if (status == _XBEGIN_STARTED) {
+      if (ss->lock != 0) {
+        _xabort(0xff);
+      }
+      stats->activeSegments |= (((uint64_t)1) << segmentID);
+      return true;
+    }
+    if (stats->segmentAborts != nullptr) {
+      stats->segmentAborts[segmentID]++;
+    }
+
+    /*
+     * Retry once the lock is free if the transaction found it taken.
+     * Give up if the hardware predicts that retrying will not help (e.g., the
+     * critical section does not fit in the cache or it performs a system
+     * call).
+     */
+    if (true && ((status & _XABORT_EXPLICIT) != 0)
+        && (_XABORT_CODE(status) == 0xff)) {
+      while (ss->lock != 0) {
+        _mm_pause();
+      }
+      continue;
+    }
+    if ((status & _XABORT_RETRY) == 0) {
+      break;
+    }
+  }
+
+  return false;
+}
+
+__attribute__((target("rtm"))) static bool HELIX_endTransaction(
+    HELIX_transactionStats_t *stats,
+    HELIX_sequentialSegment_t *ss) {
+  auto segmentID =
+      (((uint64_t)ss) - ((uint64_t)stats->ssArray)) / CACHE_LINE_SIZE;
+  auto segmentBit = (((uint64_t)1) << segmentID);
+  if ((stats->activeSegments & segmentBit) == 0) {
+    return false;
+  }
+  stats->activeSegments &= ~segmentBit;
+  _xend();
+
+  return true;
+}
+#else
+static bool HELIX_beginTransaction(HELIX_transactionStats_t *stats,
+                                   HELIX_sequentialSegment_t *ss) {
+  return false;
+}
+
+static bool HELIX_endTransaction(HELIX_transactionStats_t *stats,
+                                 HELIX_sequentialSegment_t *ss) {
+  return false;
+}
+#endif
+
+typedef struct {
+  void (*parallelizedLoop)(void *,
+                           void *,
+                           void *,
+                           void *,
+                           int64_t,
+                           int64_t,
+                           uint64_t *);
+  void *env;
+  void *loopCarriedArray;
+  void *ssArrayPast;
+  void *ssArrayFuture;
+  uint64_t coreID;
+  uint64_t numCores;
+  uint64_t *loopIsOverFlag;
+  NoelleCountdownLatch *endLatch;
+  bool trackWaits;
+  bool helped;
+  bool transactional;
+  int32_t logicalCore;
+  uint32_t nestedCoreBudget;
+  NOELLE_taskTelemetry_t telemetry;
+} NOELLE_HELIX_args_t;
+
+static void NOELLE_HELIXRunTask(NOELLE_HELIX_args_t *HELIX_args) {
+
+  /*
+   * Pin the thread and track the time it waits, if helper threads are enabled.
+   * The time is also tracked per sequential segment for the telemetry.
+   */
+  HELIX_waitStats_t waitStats{ 0,
+                               0,
+                               HELIX_args->ssArrayPast,
+                               HELIX_args->telemetry.segmentWaitCycles };
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  cpu_set_t previousCores;
+  auto pinned = false;
+  if (HELIX_args->trackWaits) {
+    pinned = NOELLE_pinCurrentThread(HELIX_args->logicalCore, &previousCores);
+  }
+  if (false || HELIX_args->trackWaits || telemetryEnabled) {
+    currentHELIXWaitStats = &waitStats;
+  }
+
+  /*
+   * Run the critical sections as hardware transactions if requested.
+   */
+  HELIX_transactionStats_t transactionStats{
+    HELIX_args->ssArrayPast,
+    0,
+    HELIX_args->telemetry.segmentTransactions,
+    HELIX_args->telemetry.segmentAborts
+  };
+  if (HELIX_args->transactional) {
+    currentHELIXTransactions = &transactionStats;
+  }
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Invoke
+   */
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentNestedCoreBudget = HELIX_args->nestedCoreBudget;
+  auto prevCriticalSections = currentHELIXCriticalSections;
+  {
+    NoelleTraceScope traceScope{ "HELIX task",
+                                 (void *)HELIX_args->parallelizedLoop,
+                                 (int64_t)HELIX_args->coreID };
+    HELIX_args->parallelizedLoop(HELIX_args->env,
+                                 HELIX_args->loopCarriedArray,
+                                 HELIX_args->ssArrayPast,
+                                 HELIX_args->ssArrayFuture,
+                                 HELIX_args->coreID,
+                                 HELIX_args->numCores,
+                                 HELIX_args->loopIsOverFlag);
+  }
+  currentNestedCoreBudget = prevNestedCoreBudget;
+
+  /*
+   * Check the task left the critical sections it entered.
+   * A task that keeps one would block the other cores forever.
+   */
+  assert(currentHELIXCriticalSections == prevCriticalSections
+         && "HELIX: a critical section has been entered but not left");
+
+  /*
+   * Restore the thread and report the time it waited.
+   */
+  if (telemetryEnabled) {
+    HELIX_args->telemetry.busyCycles = NOELLE_getCycles() - startCycles;
+  }
+  currentHELIXWaitStats = nullptr;
+  currentHELIXTransactions = nullptr;
+  if (HELIX_args->trackWaits) {
+    if (pinned) {
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previousCores);
+    }
+    runtime.addHELIXWaitTime(HELIX_args->helped,
+                             waitStats.waits,
+                             waitStats.cycles);
+  }
+
+  return;
+}
+
+static void NOELLE_HELIXTrampoline(void *args) {
+
+  /*
+   * Fetch the arguments.
+   */
+  auto HELIX_args = (NOELLE_HELIX_args_t *)args;
+
+  /*
+   * Invoke
+   */
+  NOELLE_HELIXRunTask(HELIX_args);
+
+  HELIX_args->endLatch->countDown();
+  return;
+}
+
+static void HELIX_helperThread(void *ssArray,
+                               uint32_t numOfsequentialSegments,
+                               uint64_t *theLoopIsOver,
+                               std::atomic<bool> *mustStop,
+                               int32_t logicalCore) {
+
+  /*
+   * Run on the sibling hyperthread of the worker we help.
+   */
+  cpu_set_t previousCores;
+  NOELLE_pinCurrentThread(logicalCore, &previousCores);
+
+  auto loopIsOver = (volatile uint64_t *)theLoopIsOver;
+  while (true && ((*loopIsOver) == 0)
+         && (!mustStop->load(std::memory_order_relaxed))) {
+
+    /*
+     * Prefetch the sequential segment cache lines the worker will wait on in
+     * its next iteration.
+     */
+    for (auto i = 0; i < numOfsequentialSegments; i++) {
+
+      /*
+       * Fetch the pointer.
+       */
+      auto ptr = (void *)(((uint64_t)ssArray) + (i * CACHE_LINE_SIZE));
+
+      /*
+       * Prefetch the cache line for the current sequential segment.
+       * We prefetch for reading to avoid stealing the line from the core that
+       * is about to signal.
+       */
+      __builtin_prefetch(ptr, 0, 3);
+    }
+    NOELLE_cpuRelax();
+  }
+
+  return;
+}
+
+static DispatcherInfo NOELLE_HELIX_dispatcher(
+    void (*parallelizedLoop)(void *,
+                             void *,
+                             void *,
+                             void *,
+                             int64_t,
+                             int64_t,
+                             uint64_t *),
+    void *env,
+    void *loopCarriedArray,
+    int64_t maxNumberOfCores,
+    int64_t numOfsequentialSegments,
+    bool LIO,
+    bool dynamicIterations,
+    bool decoupledPrologue) {
+  NoelleTraceScope traceScope{ "HELIX dispatch",
+                               (void *)parallelizedLoop,
+                               maxNumberOfCores };
+#ifdef RUNTIME_PRINT
+  std::cerr << "HELIX: dispatcher: Start" << std::endl;
+  std::cerr << "HELIX: dispatcher:  Number of sequential segments = "
+            << numOfsequentialSegments << std::endl;
+  std::cerr << "HELIX: dispatcher:  Number of cores = " << numCores
+            << std::endl;
+#endif
+
+  /*
+   * Assumptions.
+   */
+  assert(parallelizedLoop != NULL);
+  assert(env != NULL);
+  assert(maxNumberOfCores > 1);
+
+  /*
+   * Measure the invocation if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Fetch the thread pool
+   */
+  auto threadPool = runtime.threadPool;
+
+  /*
+   * Reserve the cores.
+   */
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  auto numCores = runtime.enterParallelRegion(maxNumberOfCores,
+                                              &coresReserved,
+                                              &nestedCoreBudget);
+  assert(numCores >= 1);
+
+  /*
+   * A decoupled sequential prologue runs on a core of its own, which is the
+   * current one, and the other cores run the iterations.
+   * Hence, the producer and a single worker share the core reserved if there
+   * is only one.
+   */
+  auto numWorkers = numCores;
+  if (decoupledPrologue) {
+    if (numCores == 1) {
+      numCores = 2;
+    }
+    numWorkers = numCores - 1;
+  }
+
+  /*
+   * Allocate the sequential segment arrays.
+   * We need numCores - 1 arrays.
+   *
+   * When the iterations are claimed dynamically, the cores share a single
+   * array, and the cache line before it holds the ticket of the next iteration
+   * to claim.
+   */
+  auto numOfSSArrays = numWorkers;
+  if (false || !LIO || dynamicIterations) {
+    numOfSSArrays = 1;
+  }
+  void *ssArrays = NULL;
+  uint32_t ssArraysIndex;
+  auto ssSize = CACHE_LINE_SIZE;
+  auto ssArraySize = ssSize * numOfsequentialSegments;
+  if (dynamicIterations) {
+    auto ticketLine = runtime.getCachedMemory(ssSize + ssArraySize,
+                                              &ssArraysIndex);
+    new (ticketLine) std::atomic<uint64_t>(0);
+    ssArrays = (void *)(((uint64_t)ticketLine) + ssSize);
+  }
+  if (numOfsequentialSegments > 0) {
+
+    /*
+     * Fetch the memory for the sequential segment arrays.
+     */
+    if (!dynamicIterations) {
+      ssArrays =
+          runtime.getCachedMemory(ssArraySize * numOfSSArrays, &ssArraysIndex);
+    }
+
+    /*
+     * Initialize the sequential segment arrays.
+     */
+    for (auto i = 0; i < numOfSSArrays; i++) {
+
+      /*
+       * Fetch the current sequential segment array.
+       */
+      auto ssArray = (void *)(((uint64_t)ssArrays) + (i * ssArraySize));
+
+      /*
+       * Initialize the sequential segment entries.
+       */
+      for (auto ssID = 0; ssID < numOfsequentialSegments; ssID++) {
+
+        /*
+         * Fetch the pointer to the current entry.
+         */
+        auto ss = (HELIX_sequentialSegment_t *)(((uint64_t)ssArray)
+                                                + (ssID * ssSize));
+
+        /*
+         * Initialize the lock and the token.
+         * With dynamic iterations, the token is the ticket of the first
+         * iteration.
+         */
+        pthread_spin_init(&ss->lock, PTHREAD_PROCESS_PRIVATE);
+        new (&ss->token) std::atomic<uint32_t>(dynamicIterations ? 0 : 1);
+
+        /*
+         * If the sequential segment is not for core 0, then we need to lock it.
+         */
+        if (i > 0) {
+          pthread_spin_lock(&ss->lock);
+          ss->token.store(0, std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+#ifdef RUNTIME_PRINT
+  mySSGlobal = ssArrays;
+#endif
+
+  /*
+   * Run the loop on the current thread if we got only one core.
+   * This avoids any interaction with the thread pool.
+   */
+  if (true && (numCores == 1) && (!decoupledPrologue)) {
+    uint64_t loopIsOverFlag = 0;
+    NOELLE_HELIX_args_t args;
+    args.parallelizedLoop = parallelizedLoop;
+    args.env = env;
+    args.loopCarriedArray = loopCarriedArray;
+    args.ssArrayPast = ssArrays;
+    args.ssArrayFuture = ssArrays;
+    args.coreID = 0;
+    args.numCores = 1;
+    args.loopIsOverFlag = &loopIsOverFlag;
+    args.endLatch = nullptr;
+    args.trackWaits = false;
+    args.helped = false;
+    args.transactional = false;
+    args.logicalCore = -1;
+    args.nestedCoreBudget = nestedCoreBudget;
+    args.telemetry = { 0, 0, 0, nullptr };
+    NOELLE_HELIXRunTask(&args);
+    runtime.exitParallelRegion(coresReserved);
+    if (ssArrays != NULL) {
+      runtime.releaseCachedMemory(ssArraysIndex);
+    }
+    if (telemetryEnabled) {
+      NOELLE_taskTelemetry_t *tasks[1] = { &args.telemetry };
+      NOELLE_invocationTelemetry_t invocation{ NOELLE_getCycles()
+                                                   - startCycles,
+                                               0,
+                                               0,
+                                               0 };
+      runtime.telemetry.recordInvocation((void *)parallelizedLoop,
+                                         "HELIX",
+                                         invocation,
+                                         tasks,
+                                         1,
+                                         0);
+    }
+
+    DispatcherInfo dispatcherInfo;
+    dispatcherInfo.numberOfThreadsUsed = 1;
+    return dispatcherInfo;
+  }
+
+  /*
+   * Allocate the arguments for the cores.
+   */
+  uint32_t argsIndex;
+  auto argsForAllCores = (NOELLE_HELIX_args_t *)runtime.getCachedMemory(
+      sizeof(NOELLE_HELIX_args_t) * (numCores - 1),
+      &argsIndex);
+
+  /*
+   * Decide whether helper threads prefetch the sequential segments for the
+   * workers.
+   * They do not when the iterations are claimed dynamically because a worker
+   * does not know which core runs the iteration it waits on.
+   */
+  auto trackWaits = runtime.isHELIXHelperEnabled();
+  auto useHelpers = false;
+  if (true && trackWaits && (numOfsequentialSegments > 0)
+      && (!dynamicIterations)) {
+    useHelpers = runtime.shouldUseHELIXHelper();
+  }
+  std::atomic<bool> helpersMustStop{ false };
+  std::vector<std::thread> helpers;
+
+  /*
+   * Each task accumulates the cycles it waits per sequential segment if the
+   * telemetry is enabled.
+   */
+  uint64_t *segmentWaitCycles = nullptr;
+  uint32_t segmentWaitCyclesIndex;
+  if (telemetryEnabled) {
+    if (numOfsequentialSegments > 0) {
+      auto bytes = sizeof(uint64_t) * numCores * numOfsequentialSegments;
+      segmentWaitCycles = (uint64_t *)runtime.getCachedMemory(
+          bytes,
+          &segmentWaitCyclesIndex);
+      memset(segmentWaitCycles, 0, bytes);
+    }
+  }
+  auto getSegmentWaitCycles = [&](uint64_t coreID) -> uint64_t * {
+    if (segmentWaitCycles == nullptr) {
+      return nullptr;
+    }
+    return segmentWaitCycles + (coreID * numOfsequentialSegments);
+  };
+
+  /*
+   * Critical sections (i.e., sequential segments of loops whose iterations
+   * can run them in any order) first try to run as hardware transactions if
+   * requested.
+   * Each task counts the transactions it starts and aborts per critical
+   * section if the telemetry is enabled.
+   */
+  auto transactional = true && (!LIO) && (numOfsequentialSegments > 0)
+                       && (numOfsequentialSegments <= 64)
+                       && runtime.isHELIXTransactionalMemoryEnabled();
+  uint64_t *segmentTransactions = nullptr;
+  uint32_t segmentTransactionsIndex;
+  if (true && transactional && telemetryEnabled) {
+    auto bytes = sizeof(uint64_t) * numCores * numOfsequentialSegments * 2;
+    segmentTransactions =
+        (uint64_t *)runtime.getCachedMemory(bytes, &segmentTransactionsIndex);
+    memset(segmentTransactions, 0, bytes);
+  }
+  auto setSegmentTransactions = [&](NOELLE_taskTelemetry_t &telemetry,
+                                    uint64_t coreID) {
+    if (segmentTransactions == nullptr) {
+      return;
+    }
+    auto counters =
+        segmentTransactions + (coreID * numOfsequentialSegments * 2);
+    telemetry.segmentTransactions = counters;
+    telemetry.segmentAborts = counters + numOfsequentialSegments;
+  };
+
+  /*
+   * Launch threads
+   */
+  uint64_t dispatchStartCycles = 0;
+  if (telemetryEnabled) {
+    dispatchStartCycles = NOELLE_getCycles();
+  }
+  uint64_t loopIsOverFlagOnStack = 0;
+  auto loopIsOverFlag = &loopIsOverFlagOnStack;
+  uint32_t prologueQueueIndex;
+  if (decoupledPrologue) {
+
+    /*
+     * The queue of the prologue is in the cache lines after the flag.
+     * The slot of iteration i starts free for it.
+     */
+    auto queueLines = runtime.getCachedMemory(
+        CACHE_LINE_SIZE * (NOELLE_HELIX_PROLOGUE_SLOTS + 1),
+        &prologueQueueIndex);
+    loopIsOverFlag = (uint64_t *)queueLines;
+    *loopIsOverFlag = 0;
+    auto slots =
+        (HELIX_prologueSlot_t *)(((uint64_t)queueLines) + CACHE_LINE_SIZE);
+    for (auto i = 0; i < NOELLE_HELIX_PROLOGUE_SLOTS; i++) {
+      new (&slots[i].sequence) std::atomic<uint64_t>(i);
+    }
+  }
+  NoelleCountdownLatch endLatch(numCores - 1);
+  for (auto i = 0; i < (numCores - 1); ++i) {
+#ifdef RUNTIME_PRINT
+    fprintf(stderr, "HelixDispatcher: Creating future for core %d\n", i);
+#endif
+
+    /*
+     * Identify the past and future sequential segment arrays.
+     */
+    auto pastID = i % numOfSSArrays;
+    auto futureID = (i + 1) % numOfSSArrays;
+
+    /*
+     * Fetch the sequential segment array for the current thread.
+     */
+    auto ssArrayPast = (void *)(((uint64_t)ssArrays) + (pastID * ssArraySize));
+    auto ssArrayFuture =
+        (void *)(((uint64_t)ssArrays) + (futureID * ssArraySize));
+#ifdef RUNTIME_PRINT
+    fprintf(stderr,
+            "HelixDispatcher: defined ss past and future arrays: %ld %ld\n",
+            (int *)ssArrayPast - (int *)mySSGlobal,
+            (int *)ssArrayFuture - (int *)mySSGlobal);
+#endif
+
+    /*
+     * Prepare the arguments.
+     */
+    auto argsPerCore = &argsForAllCores[i];
+    argsPerCore->parallelizedLoop = parallelizedLoop;
+    argsPerCore->env = env;
+    argsPerCore->loopCarriedArray = loopCarriedArray;
+    argsPerCore->ssArrayPast = ssArrayPast;
+    argsPerCore->ssArrayFuture = ssArrayFuture;
+    argsPerCore->coreID = i;
+    argsPerCore->numCores = numWorkers;
+    argsPerCore->loopIsOverFlag = loopIsOverFlag;
+    argsPerCore->endLatch = &endLatch;
+    argsPerCore->trackWaits = trackWaits;
+    argsPerCore->helped = useHelpers;
+    argsPerCore->transactional = transactional;
+    argsPerCore->logicalCore = trackWaits ? runtime.getHyperthread(i, 0) : -1;
+    argsPerCore->nestedCoreBudget = nestedCoreBudget;
+    argsPerCore->telemetry = { 0, 0, 0, getSegmentWaitCycles(i) };
+    setSegmentTransactions(argsPerCore->telemetry, i);
+
+    /*
+     * Launch the thread.
+     */
+    threadPool->submitAndDetach(NOELLE_HELIXTrampoline, argsPerCore);
+
+    /*
+     * Launch the helper thread on the sibling hyperthread.
+     */
+    if (useHelpers) {
+      helpers.emplace_back(HELIX_helperThread,
+                           ssArrayPast,
+                           numOfsequentialSegments,
+                           loopIsOverFlag,
+                           &helpersMustStop,
+                           runtime.getHyperthread(i, 1));
+    }
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "Submitted pool\n";
+  int futureGotten = 0;
+#endif
+
+  /*
+   * Run a task.
+   * With a decoupled prologue, the current thread runs the producer of the
+   * prologue, which is the task whose core ID is the number of workers.
+   */
+  auto pastID = (numCores - 1) % numOfSSArrays;
+  auto futureID = 0;
+  auto ssArrayPast = (void *)(((uint64_t)ssArrays) + (pastID * ssArraySize));
+  auto ssArrayFuture = ssArrays;
+  if (true && useHelpers && (!decoupledPrologue)) {
+    helpers.emplace_back(HELIX_helperThread,
+                         ssArrayPast,
+                         numOfsequentialSegments,
+                         loopIsOverFlag,
+                         &helpersMustStop,
+                         runtime.getHyperthread(numCores - 1, 1));
+  }
+  NOELLE_HELIX_args_t mainArgs;
+  mainArgs.parallelizedLoop = parallelizedLoop;
+  mainArgs.env = env;
+  mainArgs.loopCarriedArray = loopCarriedArray;
+  mainArgs.ssArrayPast = ssArrayPast;
+  mainArgs.ssArrayFuture = ssArrayFuture;
+  mainArgs.coreID = numCores - 1;
+  mainArgs.numCores = numWorkers;
+  mainArgs.loopIsOverFlag = loopIsOverFlag;
+  mainArgs.endLatch = nullptr;
+  mainArgs.trackWaits = trackWaits;
+  mainArgs.helped = useHelpers;
+  mainArgs.transactional = transactional;
+  mainArgs.logicalCore =
+      trackWaits ? runtime.getHyperthread(numCores - 1, 0) : -1;
+  mainArgs.nestedCoreBudget = nestedCoreBudget;
+  mainArgs.telemetry = { 0, 0, 0, getSegmentWaitCycles(numCores - 1) };
+  setSegmentTransactions(mainArgs.telemetry, numCores - 1);
+  uint64_t mainStartCycles = 0;
+  if (telemetryEnabled) {
+    mainStartCycles = NOELLE_getCycles();
+  }
+  NOELLE_HELIXRunTask(&mainArgs);
+  uint64_t mainEndCycles = 0;
+  if (telemetryEnabled) {
+    mainEndCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Wait for the remaining HELIX tasks.
+   */
+  endLatch.wait(runtime.getJoinSpinBudget());
+
+  /*
+   * Stop the helper threads.
+   */
+  helpersMustStop.store(true, std::memory_order_relaxed);
+  for (auto &helper : helpers) {
+    helper.join();
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "Got all futures\n";
+#endif
+
+  /*
+   * Free the cores and memory.
+   */
+  runtime.exitParallelRegion(coresReserved);
+
+  /*
+   * Record the invocation.
+   */
+  if (telemetryEnabled) {
+    NOELLE_taskTelemetry_t *tasks[numCores];
+    for (auto i = 0; i < (numCores - 1); i++) {
+      tasks[i] = &argsForAllCores[i].telemetry;
+    }
+    tasks[numCores - 1] = &mainArgs.telemetry;
+    auto endCycles = NOELLE_getCycles();
+    NOELLE_invocationTelemetry_t invocation{
+      endCycles - startCycles,
+      dispatchStartCycles - startCycles,
+      mainStartCycles - dispatchStartCycles,
+      endCycles - mainEndCycles
+    };
+    runtime.telemetry.recordInvocation((void *)parallelizedLoop,
+                                       "HELIX",
+                                       invocation,
+                                       tasks,
+                                       numCores,
+                                       numOfsequentialSegments);
+    if (segmentWaitCycles != nullptr) {
+      runtime.releaseCachedMemory(segmentWaitCyclesIndex);
+    }
+    if (segmentTransactions != nullptr) {
+      runtime.releaseCachedMemory(segmentTransactionsIndex);
+    }
+  }
+
+  /*
+   * Release the memory.
+   */
+  runtime.releaseCachedMemory(argsIndex);
+  if (ssArrays != NULL) {
+    runtime.releaseCachedMemory(ssArraysIndex);
+  }
+  if (decoupledPrologue) {
+    runtime.releaseCachedMemory(prologueQueueIndex);
+  }
+
+  /*
+   * Only the workers run iterations, so only they have partial results to
+   * reduce.
+   */
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = numWorkers;
+  return dispatcherInfo;
+}
+
+/*
+ * Run a HELIX invocation with the number of cores selected online for the
+ * loop, if enabled (see NoelleRuntime::getTunedInvocation).
+ */
+static DispatcherInfo NOELLE_HELIX_dispatcherWithTuning(
+    void (*parallelizedLoop)(void *,
+                             void *,
+                             void *,
+                             void *,
+                             int64_t,
+                             int64_t,
+                             uint64_t *),
+    void *env,
+    void *loopCarriedArray,
+    int64_t maxNumberOfCores,
+    int64_t numOfsequentialSegments,
+    bool LIO,
+    bool dynamicIterations,
+    bool decoupledPrologue) {
+
+  /*
+   * Nested invocations and the ones of persistent regions run on the cores
+   * of their enclosing region, so we do not tune them.
+   */
+  if (false || !runtime.isCoreTuningEnabled() || (maxNumberOfCores <= 1)
+      || (currentNestedCoreBudget > 0) || (currentTeam != nullptr)) {
+    return NOELLE_HELIX_dispatcher(parallelizedLoop,
+                                   env,
+                                   loopCarriedArray,
+                                   maxNumberOfCores,
+                                   numOfsequentialSegments,
+                                   LIO,
+                                   dynamicIterations,
+                                   decoupledPrologue);
+  }
+
+  /*
+   * Run the invocation with the cores selected.
+   * The iterations of HELIX loops are unknown to the dispatcher.
+   */
+  NOELLE_tuningMeasurement_t invocation;
+  auto cores = NOELLE_startTunedInvocation((void *)parallelizedLoop,
+                                           maxNumberOfCores,
+                                           &invocation);
+  auto dispatcherInfo = NOELLE_HELIX_dispatcher(parallelizedLoop,
+                                                env,
+                                                loopCarriedArray,
+                                                cores,
+                                                numOfsequentialSegments,
+                                                LIO,
+                                                dynamicIterations,
+                                                decoupledPrologue);
+  NOELLE_endTunedInvocation((void *)parallelizedLoop,
+                            &invocation,
+                            dispatcherInfo.numberOfThreadsUsed,
+                            1);
+
+  return dispatcherInfo;
+}
+
+DispatcherInfo NOELLE_HELIX_dispatcher_sequentialSegments(
+    void (*parallelizedLoop)(void *,
+                             void *,
+                             void *,
+                             void *,
+                             int64_t,
+                             int64_t,
+                             uint64_t *),
+    void *env,
+    void *loopCarriedArray,
+    int64_t numCores,
+    int64_t numOfsequentialSegments) {
+  return NOELLE_HELIX_dispatcherWithTuning(parallelizedLoop,
+                                           env,
+                                           loopCarriedArray,
+                                           numCores,
+                                           numOfsequentialSegments,
+                                           true,
+                                           false,
+                                           false);
+}
+
+DispatcherInfo NOELLE_HELIX_dispatcher_criticalSections(
+    void (*parallelizedLoop)(void *,
+                             void *,
+                             void *,
+                             void *,
+                             int64_t,
+                             int64_t,
+                             uint64_t *),
+    void *env,
+    void *loopCarriedArray,
+    int64_t numCores,
+    int64_t numOfsequentialSegments) {
+  return NOELLE_HELIX_dispatcherWithTuning(parallelizedLoop,
+                                           env,
+                                           loopCarriedArray,
+                                           numCores,
+                                           numOfsequentialSegments,
+                                           false,
+                                           false,
+                                           false);
+}
+
+/*
+ * Run a HELIX loop whose cores claim its iterations dynamically (see
+ * HELIX_claimIteration) rather than running every numCores-th one.
+ * A core that gets preempted then delays only the iterations that follow the
+ * one it claimed rather than all the iterations assigned to it.
+ */
+DispatcherInfo NOELLE_HELIX_dispatcher_dynamicSequentialSegments(
+    void (*parallelizedLoop)(void *,
+                             void *,
+                             void *,
+                             void *,
+                             int64_t,
+                             int64_t,
+                             uint64_t *),
+    void *env,
+    void *loopCarriedArray,
+    int64_t numCores,
+    int64_t numOfsequentialSegments) {
+  return NOELLE_HELIX_dispatcherWithTuning(parallelizedLoop,
+                                           env,
+                                           loopCarriedArray,
+                                           numCores,
+                                           numOfsequentialSegments,
+                                           true,
+                                           true,
+                                           false);
+}
+
+/*
+ * Run a HELIX loop whose sequential prologue (e.g., the traversal of a list)
+ * is decoupled from its iterations.
+ * The current core runs the prologue ahead of the iterations, and it sends the
+ * values they need through the queue after the loop-is-over flag (see
+ * HELIX_producePrologue and HELIX_consumePrologue).
+ * The other cores run the iterations round-robin.
+ */
+DispatcherInfo NOELLE_HELIX_dispatcher_decoupledPrologue(
+    void (*parallelizedLoop)(void *,
+                             void *,
+                             void *,
+                             void *,
+                             int64_t,
+                             int64_t,
+                             uint64_t *),
+    void *env,
+    void *loopCarriedArray,
+    int64_t numCores,
+    int64_t numOfsequentialSegments) {
+  return NOELLE_HELIX_dispatcherWithTuning(parallelizedLoop,
+                                           env,
+                                           loopCarriedArray,
+                                           numCores,
+                                           numOfsequentialSegments,
+                                           true,
+                                           false,
+                                           true);
+}
+
+void HELIX_wait(void *sequentialSegment) {
+
+  /*
+   * Fetch the spinlock
+   */
+  auto ss = &((HELIX_sequentialSegment_t *)sequentialSegment)->lock;
+
+#ifdef RUNTIME_PRINT
+  assert(ss != NULL);
+  fprintf(stderr,
+          "HelixDispatcher: Waiting on sequential segment: %ld\n",
+          (int *)sequentialSegment - (int *)mySSGlobal);
+#endif
+
+  /*
+   * Try to run critical sections as hardware transactions.
+   */
+  auto transactions = currentHELIXTransactions;
+  if (true && (transactions != nullptr)
+      && HELIX_beginTransaction(
+          transactions,
+          (HELIX_sequentialSegment_t *)sequentialSegment)) {
+    return;
+  }
+
+  /*
+   * Wait
+   */
+  auto stats = currentHELIXWaitStats;
+  auto traceEnabled = runtime.tracer.isEnabled();
+  uint64_t start = 0;
+  if (false || (stats != nullptr) || traceEnabled) {
+    start = NOELLE_getCycles();
+  }
+  pthread_spin_lock(ss);
+  if (stats != nullptr) {
+    HELIX_recordWait(stats, sequentialSegment, start);
+  }
+  if (traceEnabled) {
+    runtime.tracer.recordEvent("HELIX wait",
+                               sequentialSegment,
+                               0,
+                               start,
+                               NOELLE_getCycles());
+  }
+
+#ifdef RUNTIME_PRINT
+  fprintf(stderr,
+          "HelixDispatcher: Waited on sequential segment: %ld\n",
+          (int *)sequentialSegment - (int *)mySSGlobal);
+#endif
+
+  return;
+}
+
+void HELIX_signal(void *sequentialSegment) {
+
+  /*
+   * Fetch the spinlock
+   */
+  auto ss = &((HELIX_sequentialSegment_t *)sequentialSegment)->lock;
+
+#ifdef RUNTIME_PRINT
+  assert(ss != NULL);
+  fprintf(stderr,
+          "HelixDispatcher: Signaling on sequential segment: %ld\n",
+          (int *)sequentialSegment - (int *)mySSGlobal);
+#endif
+
+  /*
+   * End the transaction of the critical section, if it runs as one.
+   */
+  auto transactions = currentHELIXTransactions;
+  if (true && (transactions != nullptr)
+      && HELIX_endTransaction(
+          transactions,
+          (HELIX_sequentialSegment_t *)sequentialSegment)) {
+    return;
+  }
+
+  /*
+   * Signal
+   */
+  pthread_spin_unlock(ss);
+  if (runtime.tracer.isEnabled()) {
+    auto now = NOELLE_getCycles();
+    runtime.tracer.recordEvent("HELIX signal", sequentialSegment, 0, now, now);
+  }
+
+#ifdef RUNTIME_PRINT
+  fprintf(stderr,
+          "HelixDispatcher: Signaled on sequential segment: %ld\n",
+          (int *)sequentialSegment - (int *)mySSGlobal);
+#endif
+
+  return;
+}
+
+void HELIX_waitAdaptive(void *sequentialSegment) {
+
+  /*
+   * Fetch the token
+   */
+  auto ss = (HELIX_sequentialSegment_t *)sequentialSegment;
+  assert(ss != NULL);
+
+  /*
+   * Wait for the predecessor core to release the sequential segment.
+   *
+   * We first spin for a bounded number of times and then we yield the core to
+   * avoid stealing resources from the thread that is executing the sequential
+   * segment.
+   */
+  auto stats = currentHELIXWaitStats;
+  auto traceEnabled = runtime.tracer.isEnabled();
+  uint64_t start = 0;
+  if (false || (stats != nullptr) || traceEnabled) {
+    start = NOELLE_getCycles();
+  }
+  auto spinBudget = runtime.getSpinBudget();
+  uint64_t spins = 0;
+  while (true) {
+    uint32_t released = 1;
+    if (true && (ss->token.load(std::memory_order_relaxed) == released)
+        && ss->token.compare_exchange_weak(released,
+                                           0,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+      break;
+    }
+    if (spins < spinBudget) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+  if (stats != nullptr) {
+    HELIX_recordWait(stats, sequentialSegment, start);
+  }
+  if (traceEnabled) {
+    runtime.tracer.recordEvent("HELIX wait",
+                               sequentialSegment,
+                               0,
+                               start,
+                               NOELLE_getCycles());
+  }
+
+  return;
+}
+
+void HELIX_signalAdaptive(void *sequentialSegment) {
+
+  /*
+   * Fetch the token
+   */
+  auto ss = (HELIX_sequentialSegment_t *)sequentialSegment;
+  assert(ss != NULL);
+
+  /*
+   * Signal
+   */
+  ss->token.store(1, std::memory_order_release);
+  if (runtime.tracer.isEnabled()) {
+    auto now = NOELLE_getCycles();
+    runtime.tracer.recordEvent("HELIX signal", sequentialSegment, 0, now, now);
+  }
+
+  return;
+}
+
+int64_t HELIX_claimIteration(void *ssArray) {
+
+  /*
+   * Fetch the ticket of the next iteration, which is in the cache line before
+   * the sequential segment array.
+   */
+  auto nextTicket =
+      (std::atomic<uint64_t> *)(((uint64_t)ssArray) - CACHE_LINE_SIZE);
+
+  /*
+   * Claim the iteration.
+   */
+  auto ticket = nextTicket->fetch_add(1, std::memory_order_relaxed);
+
+  return (int64_t)ticket;
+}
+
+void HELIX_waitDynamic(void *sequentialSegment, int64_t iteration) {
+
+  /*
+   * Fetch the token
+   */
+  auto ss = (HELIX_sequentialSegment_t *)sequentialSegment;
+  assert(ss != NULL);
+
+  /*
+   * Wait for the iteration that precedes @iteration to leave the sequential
+   * segment.
+   * Like HELIX_waitAdaptive, we spin for a bounded number of times and then we
+   * yield the core.
+   */
+  auto stats = currentHELIXWaitStats;
+  auto traceEnabled = runtime.tracer.isEnabled();
+  uint64_t start = 0;
+  if (false || (stats != nullptr) || traceEnabled) {
+    start = NOELLE_getCycles();
+  }
+  auto ticket = (uint32_t)iteration;
+  auto spinBudget = runtime.getSpinBudget();
+  uint64_t spins = 0;
+  while (ss->token.load(std::memory_order_acquire) != ticket) {
+    if (spins < spinBudget) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+  if (stats != nullptr) {
+    HELIX_recordWait(stats, sequentialSegment, start);
+  }
+  if (traceEnabled) {
+    runtime.tracer.recordEvent("HELIX wait",
+                               sequentialSegment,
+                               iteration,
+                               start,
+                               NOELLE_getCycles());
+  }
+
+  return;
+}
+
+void HELIX_signalDynamic(void *sequentialSegment, int64_t iteration) {
+
+  /*
+   * Fetch the token
+   */
+  auto ss = (HELIX_sequentialSegment_t *)sequentialSegment;
+  assert(ss != NULL);
+
+  /*
+   * Some paths signal sequential segments they did not wait for (e.g., the
+   * ones that leave the loop).
+   * Hence, we first make sure the previous iteration left the sequential
+   * segment; this is immediate when the current thread waited for it.
+   */
+  auto ticket = (uint32_t)iteration;
+  auto spinBudget = runtime.getSpinBudget();
+  uint64_t spins = 0;
+  while (ss->token.load(std::memory_order_acquire) != ticket) {
+    if (spins < spinBudget) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+
+  /*
+   * Signal
+   */
+  ss->token.store(ticket + 1, std::memory_order_release);
+  if (runtime.tracer.isEnabled()) {
+    auto now = NOELLE_getCycles();
+    runtime.tracer.recordEvent("HELIX signal",
+                               sequentialSegment,
+                               iteration,
+                               now,
+                               now);
+  }
+
+  return;
+}
+
+/*
+ * Fetch the slot of the prologue queue of @iteration, and wait for it to have
+ * sequence number @sequence.
+ */
+static HELIX_prologueSlot_t *HELIX_waitPrologueSlot(uint64_t *loopIsOverFlag,
+                                                    int64_t iteration,
+                                                    uint64_t sequence) {
+
+  /*
+   * Fetch the slot.
+   */
+  auto slots =
+      (HELIX_prologueSlot_t *)(((uint64_t)loopIsOverFlag) + CACHE_LINE_SIZE);
+  auto slot = &slots[((uint64_t)iteration) % NOELLE_HELIX_PROLOGUE_SLOTS];
+
+  /*
+   * Wait for the slot.
+   * Like HELIX_waitDynamic, we spin for a bounded number of times and then we
+   * yield the core.
+   */
+  auto spinBudget = runtime.getSpinBudget();
+  uint64_t spins = 0;
+  while (slot->sequence.load(std::memory_order_acquire) != sequence) {
+    if (spins < spinBudget) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+
+  return slot;
+}
+
+/*
+ * Return the slot where the producer of a decoupled prologue writes the values
+ * of @iteration, once the consumer of the iteration that used it last is done.
+ */
+void *HELIX_producePrologue(uint64_t *loopIsOverFlag, int64_t iteration) {
+  return HELIX_waitPrologueSlot(loopIsOverFlag, iteration, iteration);
+}
+
+/*
+ * Hand the values written in @slot to its consumer.
+ */
+void HELIX_publishPrologue(void *slot) {
+  auto prologueSlot = (HELIX_prologueSlot_t *)slot;
+  auto sequence = prologueSlot->sequence.load(std::memory_order_relaxed);
+  prologueSlot->sequence.store(sequence + 1, std::memory_order_release);
+
+  return;
+}
+
+/*
+ * Return the slot with the values of @iteration once the producer published
+ * them.
+ */
+void *HELIX_consumePrologue(uint64_t *loopIsOverFlag, int64_t iteration) {
+  return HELIX_waitPrologueSlot(loopIsOverFlag, iteration, iteration + 1);
+}
+
+/*
+ * Free @slot for the iteration that will use it next.
+ */
+void HELIX_releasePrologue(void *slot) {
+  auto prologueSlot = (HELIX_prologueSlot_t *)slot;
+  auto sequence = prologueSlot->sequence.load(std::memory_order_relaxed);
+  prologueSlot->sequence.store(sequence - 1 + NOELLE_HELIX_PROLOGUE_SLOTS,
+                               std::memory_order_release);
+
+  return;
+}
+
+/*
+ * Tell the @numWorkers - 1 workers that did not run @iteration, which left the
+ * loop, to leave the task.
+ * The next iteration each of them waits for is one of the @numWorkers - 1
+ * iterations that follow @iteration.
+ */
+void HELIX_endPrologue(uint64_t *loopIsOverFlag,
+                       int64_t iteration,
+                       int64_t numWorkers) {
+  for (auto i = iteration + 1; i < (iteration + numWorkers); i++) {
+    auto slot = HELIX_producePrologue(loopIsOverFlag, i);
+    ((HELIX_prologueSlot_t *)slot)->token = 2;
+    HELIX_publishPrologue(slot);
+  }
+
+  return;
+}
+
+/*
+ * Identifier of the current thread as the owner of a critical section.
+ */
+static thread_local uint8_t HELIX_criticalSectionOwner;
+
+void HELIX_enterCriticalSection(void *criticalSection) {
+
+  /*
+   * Fetch the owner of the critical section.
+   * Critical sections protect commutative sequential segments: they are shared
+   * by all cores and the iterations enter them in any order.
+   */
+  auto owner = (std::atomic<uint64_t> *)criticalSection;
+  assert(owner != NULL);
+  auto me = (uint64_t)&HELIX_criticalSectionOwner;
+
+  /*
+   * Check if the current thread is already in the critical section (e.g., it
+   * is entered again at a loop exit).
+   */
+  if (owner->load(std::memory_order_relaxed) == me) {
+    return;
+  }
+
+  /*
+   * Wait for the critical section to be free.
+   */
+  auto traceEnabled = runtime.tracer.isEnabled();
+  uint64_t start = 0;
+  if (traceEnabled) {
+    start = NOELLE_getCycles();
+  }
+  auto spinBudget = runtime.getSpinBudget();
+  uint64_t spins = 0;
+  while (true) {
+    uint64_t free = 0;
+    if (true && (owner->load(std::memory_order_relaxed) == free)
+        && owner->compare_exchange_weak(free,
+                                        me,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      currentHELIXCriticalSections++;
+      break;
+    }
+    if (spins < spinBudget) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+  if (traceEnabled) {
+    runtime.tracer.recordEvent("HELIX critical section",
+                               criticalSection,
+                               0,
+                               start,
+                               NOELLE_getCycles());
+  }
+
+  return;
+}
+
+void HELIX_exitCriticalSection(void *criticalSection) {
+
+  /*
+   * Leave the critical section only if the current thread is in it: the
+   * exits of a sequential segment can be reached without going through its
+   * entries.
+   */
+  auto owner = (std::atomic<uint64_t> *)criticalSection;
+  assert(owner != NULL);
+  auto me = (uint64_t)&HELIX_criticalSectionOwner;
+  if (owner->load(std::memory_order_relaxed) != me) {
+    return;
+  }
+  assert(currentHELIXCriticalSections > 0);
+  currentHELIXCriticalSections--;
+  owner->store(0, std::memory_order_release);
+
+  return;
+}
+
+/*
+ * Record that the current thread starts waiting to enter the sequential
+ * segment @segmentID of the HELIX loop @loopID.
+ * This and the two functions below are invoked only by the loops compiled with
+ * -helix-segment-profile, and they do nothing if the profiler is disabled
+ * (see NOELLE_HELIX_SEGMENTS).
+ */
+void HELIX_segmentProfileWait(int64_t loopID, int64_t segmentID) {
+  auto segment = runtime.segmentProfiler.getSegment(loopID, segmentID);
+  if (segment == nullptr) {
+    return;
+  }
+  segment->waitStartCycles = NOELLE_getCycles();
+
+  return;
+}
+
+/*
+ * Record that the current thread entered the sequential segment @segmentID.
+ */
+void HELIX_segmentProfileEnter(int64_t loopID, int64_t segmentID) {
+  auto segment = runtime.segmentProfiler.getSegment(loopID, segmentID);
+  if (segment == nullptr) {
+    return;
+  }
+  auto now = NOELLE_getCycles();
+  if (segment->waitStartCycles != 0) {
+    segment->waitCycles += now - segment->waitStartCycles;
+    segment->waitStartCycles = 0;
+  }
+  segment->entries++;
+  segment->enterCycles = now;
+
+  return;
+}
+
+/*
+ * Record that the current thread is about to leave the sequential segment
+ * @segmentID.
+ * Exits reached without entering the segment (e.g., the ones that leave the
+ * loop) are ignored.
+ */
+void HELIX_segmentProfileExit(int64_t loopID, int64_t segmentID) {
+  auto segment = runtime.segmentProfiler.getSegment(loopID, segmentID);
+  if (false || (segment == nullptr) || (segment->enterCycles == 0)) {
+    return;
+  }
+  segment->holdCycles += NOELLE_getCycles() - segment->enterCycles;
+  segment->enterCycles = 0;
+
+  return;
+}
+
+/*
+ * Functions that the tasks of loops compiled with -noelle-buffered-output
+ * invoke.
+ *
+ * NOELLE_bufferedOutputIteration is invoked at the beginning of every
+ * iteration, and NOELLE_bufferedOutputWrite after the dispatcher of the loop
+ * returns.
+ */
+void NOELLE_bufferedOutputIteration(void *env, int64_t iteration) {
+  currentBufferedOutputEnv = env;
+  currentBufferedOutputIteration = iteration;
+
+  return;
+}
+
+void NOELLE_bufferedOutputWrite(void *env) {
+  runtime.bufferedOutput.write(env);
+
+  return;
+}
+
+/*
+ * Functions invoked instead of the stream functions of the C library.
+ * They return what the C library would return if the write succeeded.
+ */
+static int NOELLE_bufferFormattedOutput(FILE *stream,
+                                        const char *format,
+                                        va_list arguments) {
+  char localBuffer[256];
+  va_list argumentsCopy;
+  va_copy(argumentsCopy, arguments);
+  auto length =
+      vsnprintf(localBuffer, sizeof(localBuffer), format, argumentsCopy);
+  va_end(argumentsCopy);
+  if (length < 0) {
+    return length;
+  }
+  if (((uint64_t)length) < sizeof(localBuffer)) {
+    runtime.bufferedOutput.append(stream, localBuffer, length);
+    return length;
+  }
+  std::string bytes(length + 1, '\0');
+  vsnprintf(&bytes[0], bytes.size(), format, arguments);
+  runtime.bufferedOutput.append(stream, bytes.data(), length);
+
+  return length;
+}
+
+int NOELLE_bufferedPrintf(const char *format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  auto length = NOELLE_bufferFormattedOutput(stdout, format, arguments);
+  va_end(arguments);
+
+  return length;
+}
+
+int NOELLE_bufferedFprintf(FILE *stream, const char *format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  auto length = NOELLE_bufferFormattedOutput(stream, format, arguments);
+  va_end(arguments);
+
+  return length;
+}
+
+int NOELLE_bufferedPuts(const char *string) {
+  auto length = strlen(string);
+  runtime.bufferedOutput.append(stdout, string, length);
+  runtime.bufferedOutput.append(stdout, "\n", 1);
+
+  return (int)std::min(length + 1, (size_t)INT32_MAX);
+}
+
+int NOELLE_bufferedFputs(const char *string, FILE *stream) {
+  runtime.bufferedOutput.append(stream, string, strlen(string));
+
+  return 1;
+}
+
+int NOELLE_bufferedFputc(int character, FILE *stream) {
+  auto byte = (char)character;
+  runtime.bufferedOutput.append(stream, &byte, 1);
+
+  return (unsigned char)character;
+}
+
+int NOELLE_bufferedPutchar(int character) {
+  return NOELLE_bufferedFputc(character, stdout);
+}
+
+size_t NOELLE_bufferedFwrite(const void *data,
+                             size_t size,
+                             size_t elements,
+                             FILE *stream) {
+  runtime.bufferedOutput.append(stream, (const char *)data, size * elements);
+
+  return elements;
+}
+
+/**********************************************************************
+ *                Helper prefetchers
+ **********************************************************************/
+/*
+ * State shared by an invocation of a sequential loop and its helper.
+ * @progress must be the first field as the loop stores it directly.
+ */
+typedef struct {
+  alignas(CACHE_LINE_SIZE) std::atomic<int64_t> progress;
+  alignas(CACHE_LINE_SIZE) std::atomic<bool> loopIsOver;
+  int64_t distance;
+  std::thread helper;
+} NOELLE_prefetcher_t;
+
+static void NOELLE_prefetcherTrampoline(void (*helper)(void *, void *),
+                                        void *env,
+                                        NOELLE_prefetcher_t *prefetcher,
+                                        int32_t logicalCore) {
+  cpu_set_t previousCores;
+  NOELLE_pinCurrentThread(logicalCore, &previousCores);
+  helper(env, prefetcher);
+
+  return;
+}
+
+void *NOELLE_prefetcherStart(void (*helper)(void *, void *), void *env) {
+  auto prefetcher = new NOELLE_prefetcher_t();
+  prefetcher->progress.store(0, std::memory_order_relaxed);
+  prefetcher->loopIsOver.store(false, std::memory_order_relaxed);
+  prefetcher->distance = runtime.getPrefetcherDistance();
+
+  /*
+   * The helper shares the physical core of the loop so it fills the caches the
+   * loop reads from. Without an SMT sibling, the loop runs alone.
+   */
+  if (!runtime.isPrefetcherEnabled()) {
+    return prefetcher;
+  }
+  auto sibling = runtime.getSiblingHyperthread(sched_getcpu());
+  if (sibling < 0) {
+    return prefetcher;
+  }
+  prefetcher->helper = std::thread(NOELLE_prefetcherTrampoline,
+                                   helper,
+                                   env,
+                                   prefetcher,
+                                   sibling);
+
+  return prefetcher;
+}
+
+int64_t NOELLE_prefetcherThrottle(void *prefetcher, int64_t iteration) {
+  auto p = (NOELLE_prefetcher_t *)prefetcher;
+  uint64_t spins = 0;
+  while (!p->loopIsOver.load(std::memory_order_relaxed)) {
+
+    /*
+     * Prefetching for the iterations the loop already reached is too late, so
+     * the helper skips them.
+     */
+    auto progress = p->progress.load(std::memory_order_relaxed);
+    if (iteration <= progress) {
+      return progress + 1;
+    }
+    if (iteration <= (progress + p->distance)) {
+      return iteration;
+    }
+
+    /*
+     * Wait for the loop to catch up.
+     * The pause leaves the resources of the physical core to the loop.
+     */
+    if (spins < NOELLE_DEFAULT_SPIN_BUDGET) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+
+  return -1;
+}
+
+void NOELLE_prefetcherStop(void *prefetcher) {
+  auto p = (NOELLE_prefetcher_t *)prefetcher;
+  p->loopIsOver.store(true, std::memory_order_relaxed);
+  if (p->helper.joinable()) {
+    p->helper.join();
+  }
+  delete p;
+
+  return;
+}
+
+/**********************************************************************
+ *                Wavefront
+ **********************************************************************/
+
+/*
+ * Progress of the task that runs the rows preceding the ones of another task.
+ * The upper 32 bits are the row that runs, and the lower ones are the number
+ * of iterations of its nested loop that are done. These are set to
+ * NOELLE_WAVEFRONT_ROW_DONE once the row is over.
+ */
+#define NOELLE_WAVEFRONT_ROW_DONE ((uint64_t)0xFFFFFFFF)
+
+typedef struct {
+  std::atomic<uint64_t> progress;
+  char padding[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+} NOELLE_wavefrontProgress_t;
+
+typedef struct {
+  NOELLE_wavefrontProgress_t *own;
+  NOELLE_wavefrontProgress_t *predecessor;
+  uint64_t predecessorProgress;
+} NOELLE_wavefrontTask_t;
+
+static thread_local NOELLE_wavefrontTask_t *currentWavefrontTask = nullptr;
+
+typedef struct {
+  void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t);
+  void *env;
+  int64_t coreID;
+  int64_t numCores;
+  NOELLE_wavefrontTask_t wavefront;
+  NoelleCountdownLatch *endLatch;
+  uint32_t nestedCoreBudget;
+  NOELLE_taskTelemetry_t telemetry;
+} NOELLE_wavefront_args_t;
+
+static void NOELLE_WavefrontRunTask(NOELLE_wavefront_args_t *args) {
+
+  /*
+   * Measure the task if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Set the progress the task waits on and the cores its nested regions can
+   * use.
+   */
+  auto prevTask = currentWavefrontTask;
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentWavefrontTask = &args->wavefront;
+  currentNestedCoreBudget = args->nestedCoreBudget;
+
+  /*
+   * Invoke
+   * Rows are assigned to the tasks round-robin. Hence, the chunk size is 1.
+   */
+  {
+    NoelleTraceScope traceScope{ "Wavefront task",
+                                 (void *)args->parallelizedLoop,
+                                 args->coreID };
+    args->parallelizedLoop(args->env, args->coreID, args->numCores, 1);
+  }
+  currentWavefrontTask = prevTask;
+  currentNestedCoreBudget = prevNestedCoreBudget;
+  if (telemetryEnabled) {
+    args->telemetry.busyCycles = NOELLE_getCycles() - startCycles;
+  }
+
+  return;
+}
+
+static void NOELLE_WavefrontTrampoline(void *args) {
+  auto wavefrontArgs = (NOELLE_wavefront_args_t *)args;
+  NOELLE_WavefrontRunTask(wavefrontArgs);
+  wavefrontArgs->endLatch->countDown();
+
+  return;
+}
+
+DispatcherInfo NOELLE_WavefrontDispatcher(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize) {
+  NoelleTraceScope traceScope{ "Wavefront dispatch",
+                               (void *)parallelizedLoop,
+                               maxNumberOfCores };
+
+  /*
+   * Assumptions.
+   */
+  assert(parallelizedLoop != NULL);
+  assert(chunkSize == 1);
+
+  /*
+   * Measure the invocation if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Reserve the cores.
+   * Tasks wait for each other. Hence, they must all run at the same time,
+   * which is why they do not run on the team of a persistent region.
+   */
+  auto threadPool = runtime.threadPool;
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  auto numCores = runtime.enterParallelRegion(maxNumberOfCores,
+                                              &coresReserved,
+                                              &nestedCoreBudget);
+  assert(numCores >= 1);
+
+  /*
+   * Allocate the progress of the tasks and the arguments for the cores.
+   */
+  uint32_t progressIndex;
+  auto progress = (NOELLE_wavefrontProgress_t *)runtime.getCachedMemory(
+      sizeof(NOELLE_wavefrontProgress_t) * numCores,
+      &progressIndex);
+  for (auto i = 0; i < numCores; i++) {
+    new (&progress[i].progress) std::atomic<uint64_t>(0);
+  }
+  uint32_t argsIndex;
+  auto argsForAllCores = (NOELLE_wavefront_args_t *)runtime.getCachedMemory(
+      sizeof(NOELLE_wavefront_args_t) * numCores,
+      &argsIndex);
+  for (auto i = 0; i < numCores; i++) {
+    auto argsPerCore = &argsForAllCores[i];
+    argsPerCore->parallelizedLoop = parallelizedLoop;
     argsPerCore->env = env;
+    argsPerCore->coreID = i;
     argsPerCore->numCores = numCores;
-    argsPerCore->chunkSize = chunkSize;
+    auto predecessorID = (i + numCores - 1) % numCores;
+    argsPerCore->wavefront.own = &progress[i];
+    argsPerCore->wavefront.predecessor = &progress[predecessorID];
+    argsPerCore->wavefront.predecessorProgress = 0;
+    argsPerCore->endLatch = nullptr;
+    argsPerCore->nestedCoreBudget = nestedCoreBudget;
+    argsPerCore->telemetry = { 0, 0, 0, nullptr };
+  }
+
+  /*
+   * Submit the tasks.
+   */
+  uint64_t dispatchStartCycles = 0;
+  if (telemetryEnabled) {
+    dispatchStartCycles = NOELLE_getCycles();
+  }
+  NoelleCountdownLatch endLatch(numCores - 1);
+  for (auto i = 0; i < (numCores - 1); ++i) {
+    argsForAllCores[i].endLatch = &endLatch;
+    threadPool->submitAndDetach(NOELLE_WavefrontTrampoline,
+                                &argsForAllCores[i]);
+  }
+
+  /*
+   * Run a task.
+   */
+  uint64_t mainStartCycles = 0;
+  if (telemetryEnabled) {
+    mainStartCycles = NOELLE_getCycles();
+  }
+  NOELLE_WavefrontRunTask(&argsForAllCores[numCores - 1]);
+  uint64_t mainEndCycles = 0;
+  if (telemetryEnabled) {
+    mainEndCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Wait for the remaining tasks.
+   */
+  if (numCores > 1) {
+    endLatch.wait(runtime.getSpinBudget());
+  }
+
+  /*
+   * Record the invocation.
+   */
+  if (telemetryEnabled) {
+    NOELLE_taskTelemetry_t *tasks[numCores];
+    for (auto i = 0; i < numCores; i++) {
+      tasks[i] = &argsForAllCores[i].telemetry;
+    }
+    auto endCycles = NOELLE_getCycles();
+    NOELLE_invocationTelemetry_t invocation{
+      endCycles - startCycles,
+      dispatchStartCycles - startCycles,
+      mainStartCycles - dispatchStartCycles,
+      endCycles - mainEndCycles
+    };
+    runtime.telemetry.recordInvocation((void *)parallelizedLoop,
+                                       "Wavefront",
+                                       invocation,
+                                       tasks,
+                                       numCores,
+                                       0);
+  }
+
+  /*
+   * Free the cores and memory.
+   */
+  runtime.exitParallelRegion(coresReserved);
+  runtime.releaseCachedMemory(argsIndex);
+  runtime.releaseCachedMemory(progressIndex);
+
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = numCores;
+  return dispatcherInfo;
+}
+
+void NOELLE_Wavefront_wait(int64_t row, int64_t iteration) {
+
+  /*
+   * The first row does not wait.
+   */
+  if (row == 0) {
+    return;
+  }
+  auto task = currentWavefrontTask;
+  assert(task != nullptr);
+
+  /*
+   * Compute the progress the previous row must reach.
+   * Iterations that do not fit the counter wait for the whole row to be over.
+   */
+  auto iterationsDone = std::min((uint64_t)iteration + 1,
+                                 NOELLE_WAVEFRONT_ROW_DONE);
+  auto target = (((uint64_t)(row - 1)) << 32) | iterationsDone;
+
+  /*
+   * Check the progress seen the last time, which avoids reading the cache line
+   * the predecessor writes while it is ahead of us.
+   */
+  if (task->predecessorProgress >= target) {
+    return;
+  }
+
+  /*
+   * Wait for the task that runs the previous row.
+   */
+  auto spinBudget = runtime.getSpinBudget();
+  uint64_t spins = 0;
+  auto traceEnabled = runtime.tracer.isEnabled();
+  uint64_t start = 0;
+  if (traceEnabled) {
+    start = NOELLE_getCycles();
+  }
+  while (true) {
+    auto value = task->predecessor->progress.load(std::memory_order_acquire);
+    if (value >= target) {
+      task->predecessorProgress = value;
+      break;
+    }
+    if (spins < spinBudget) {
+      spins++;
+      NOELLE_cpuRelax();
+    } else {
+      sched_yield();
+    }
+  }
+  if (traceEnabled) {
+    runtime.tracer.recordEvent("Wavefront wait",
+                               task->predecessor,
+                               row,
+                               start,
+                               NOELLE_getCycles());
+  }
+
+  return;
+}
+
+void NOELLE_Wavefront_signal(int64_t row, int64_t iterations) {
+  auto task = currentWavefrontTask;
+  assert(task != nullptr);
+
+  /*
+   * A negative number of iterations means that the row is over.
+   * Otherwise, we publish fewer iterations than the ones done if they do not
+   * fit the counter, which only delays the next row.
+   */
+  uint64_t iterationsDone = NOELLE_WAVEFRONT_ROW_DONE;
+  if (iterations >= 0) {
+    iterationsDone = std::min((uint64_t)iterations,
+                              NOELLE_WAVEFRONT_ROW_DONE - 1);
+  }
+  auto value = (((uint64_t)row) << 32) | iterationsDone;
+  task->own->progress.store(value, std::memory_order_release);
+
+  return;
+}
+
+/**********************************************************************
+ *                DSWP
+ **********************************************************************/
+typedef struct {
+  stageFunctionPtr_t funcToInvoke;
+  void *env;
+  void *localQueues;
+  NoelleCountdownLatch *endLatch;
+  uint32_t stageID;
+  int32_t logicalCore;
+  int64_t *queueSizes;
+  int64_t *queueConsumers;
+  int64_t numberOfQueues;
+  NoelleCountdownLatch *queuesReady;
+  uint32_t nestedCoreBudget;
+  NOELLE_taskTelemetry_t telemetry;
+} NOELLE_DSWP_args_t;
+
+static void *NOELLE_allocateDSWPQueue(int64_t queueSize) {
+
+  /*
+   * Check if the values of the queue have been packed into another queue.
+   */
+  if (queueSize == 0) {
+    return nullptr;
+  }
+
+  /*
+   * Fetch the number of slots requested by the compiler.
+   */
+  auto capacity = NOELLE_getDSWPQueueCapacity(queueSize);
+  queueSize &= ~NOELLE_DSWP_QUEUE_CAPACITY_MASK;
+
+  /*
+   * Check if the queue moves slots of a given number of bytes.
+   */
+  if (queueSize & NOELLE_DSWP_SLOT_QUEUE) {
+    auto slotBytes = queueSize & (NOELLE_DSWP_SLOT_QUEUE - 1);
+    return new NoelleSlotQueue(slotBytes, capacity);
+  }
+
+  /*
+   * Check if the queue is batched.
+   */
+  if (queueSize & NOELLE_DSWP_BATCHED_QUEUE) {
+    switch (queueSize & ~((int64_t)NOELLE_DSWP_BATCHED_QUEUE)) {
+      case 1:
+        return new NoelleBatchedQueue<int8_t>(capacity);
+      case 8:
+        return new NoelleBatchedQueue<int8_t>(capacity);
+      case 16:
+        return new NoelleBatchedQueue<int16_t>(capacity);
+      case 32:
+        return new NoelleBatchedQueue<int32_t>(capacity);
+      case 64:
+        return new NoelleBatchedQueue<int64_t>(capacity);
+      default:
+        std::cerr << "NOELLE: Runtime: QUEUE SIZE INCORRECT" << std::endl;
+        abort();
+    }
+  }
+
+  /*
+   * Check if the queue has exactly one producer and one consumer.
+   */
+  if (queueSize & NOELLE_DSWP_SPSC_QUEUE) {
+    switch (queueSize & ~((int64_t)NOELLE_DSWP_SPSC_QUEUE)) {
+      case 1:
+        return new NoelleSPSCQueue<int8_t>(capacity);
+      case 8:
+        return new NoelleSPSCQueue<int8_t>(capacity);
+      case 16:
+        return new NoelleSPSCQueue<int16_t>(capacity);
+      case 32:
+        return new NoelleSPSCQueue<int32_t>(capacity);
+      case 64:
+        return new NoelleSPSCQueue<int64_t>(capacity);
+      default:
+        std::cerr << "NOELLE: Runtime: QUEUE SIZE INCORRECT" << std::endl;
+        abort();
+    }
+  }
+
+  switch (queueSize) {
+    case 1:
+      return new ThreadSafeLockFreeQueue<int8_t>();
+    case 8:
+      return new ThreadSafeLockFreeQueue<int8_t>();
+    case 16:
+      return new ThreadSafeLockFreeQueue<int16_t>();
+    case 32:
+      return new ThreadSafeLockFreeQueue<int32_t>();
+    case 64:
+      return new ThreadSafeLockFreeQueue<int64_t>();
+    default:
+      std::cerr << "NOELLE: Runtime: QUEUE SIZE INCORRECT" << std::endl;
+      abort();
+  }
+
+  return nullptr;
+}
+
+static void NOELLE_freeDSWPQueue(void *queue, int64_t queueSize) {
+
+  /*
+   * Check if the values of the queue have been packed into another queue.
+   */
+  if (queueSize == 0) {
+    return;
+  }
+  queueSize &= ~NOELLE_DSWP_QUEUE_CAPACITY_MASK;
+
+  /*
+   * Check if the queue moves slots of a given number of bytes.
+   */
+  if (queueSize & NOELLE_DSWP_SLOT_QUEUE) {
+    delete (NoelleSlotQueue *)(queue);
+    return;
+  }
+
+  /*
+   * Check if the queue is batched.
+   */
+  if (queueSize & NOELLE_DSWP_BATCHED_QUEUE) {
+    switch (queueSize & ~((int64_t)NOELLE_DSWP_BATCHED_QUEUE)) {
+      case 1:
+        delete (NoelleBatchedQueue<int8_t> *)(queue);
+        break;
+      case 8:
+        delete (NoelleBatchedQueue<int8_t> *)(queue);
+        break;
+      case 16:
+        delete (NoelleBatchedQueue<int16_t> *)(queue);
+        break;
+      case 32:
+        delete (NoelleBatchedQueue<int32_t> *)(queue);
+        break;
+      case 64:
+        delete (NoelleBatchedQueue<int64_t> *)(queue);
+        break;
+    }
+    return;
+  }
+
+  /*
+   * Check if the queue has exactly one producer and one consumer.
+   */
+  if (queueSize & NOELLE_DSWP_SPSC_QUEUE) {
+    switch (queueSize & ~((int64_t)NOELLE_DSWP_SPSC_QUEUE)) {
+      case 1:
+        delete (NoelleSPSCQueue<int8_t> *)(queue);
+        break;
+      case 8:
+        delete (NoelleSPSCQueue<int8_t> *)(queue);
+        break;
+      case 16:
+        delete (NoelleSPSCQueue<int16_t> *)(queue);
+        break;
+      case 32:
+        delete (NoelleSPSCQueue<int32_t> *)(queue);
+        break;
+      case 64:
+        delete (NoelleSPSCQueue<int64_t> *)(queue);
+        break;
+    }
+    return;
+  }
+
+  switch (queueSize) {
+    case 1:
+      delete (ThreadSafeLockFreeQueue<int8_t> *)(queue);
+      break;
+    case 8:
+      delete (ThreadSafeLockFreeQueue<int8_t> *)(queue);
+      break;
+    case 16:
+      delete (ThreadSafeLockFreeQueue<int16_t> *)(queue);
+      break;
+    case 32:
+      delete (ThreadSafeLockFreeQueue<int32_t> *)(queue);
+      break;
+    case 64:
+      delete (ThreadSafeLockFreeQueue<int64_t> *)(queue);
+      break;
+  }
+
+  return;
+}
+
+/*
+ * Fetch and reset the number of pushes that found the queue full and the
+ * number of pops that found it empty.
+ * Return false if the implementation of the queue does not count them.
+ */
+static bool NOELLE_fetchDSWPQueueStalls(void *queue,
+                                        int64_t queueSize,
+                                        uint64_t *fullStalls,
+                                        uint64_t *emptyStalls) {
+  if (queue == nullptr) {
+    return false;
+  }
+  queueSize &= ~NOELLE_DSWP_QUEUE_CAPACITY_MASK;
+
+  /*
+   * Check if the queue moves slots of a given number of bytes.
+   */
+  if (queueSize & NOELLE_DSWP_SLOT_QUEUE) {
+    ((NoelleSlotQueue *)queue)->fetchStalls(fullStalls, emptyStalls);
+    return true;
+  }
+
+  /*
+   * Check if the queue is batched.
+   */
+  if (queueSize & NOELLE_DSWP_BATCHED_QUEUE) {
+    switch (queueSize & ~((int64_t)NOELLE_DSWP_BATCHED_QUEUE)) {
+      case 1:
+      case 8:
+        ((NoelleBatchedQueue<int8_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+      case 16:
+        ((NoelleBatchedQueue<int16_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+      case 32:
+        ((NoelleBatchedQueue<int32_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+      case 64:
+        ((NoelleBatchedQueue<int64_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+    }
+    return false;
+  }
+
+  /*
+   * Check if the queue has exactly one producer and one consumer.
+   */
+  if (queueSize & NOELLE_DSWP_SPSC_QUEUE) {
+    switch (queueSize & ~((int64_t)NOELLE_DSWP_SPSC_QUEUE)) {
+      case 1:
+      case 8:
+        ((NoelleSPSCQueue<int8_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+      case 16:
+        ((NoelleSPSCQueue<int16_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+      case 32:
+        ((NoelleSPSCQueue<int32_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+      case 64:
+        ((NoelleSPSCQueue<int64_t> *)queue)
+            ->fetchStalls(fullStalls, emptyStalls);
+        return true;
+    }
+    return false;
+  }
+
+  /*
+   * The capacity of the other queues is fixed, and they do not count their
+   * stalls.
+   */
+  return false;
+}
+
+void stageExecuter(void (*stage)(void *, void *), void *env, void *queues) {
+  return stage(env, queues);
+}
+
+static void NOELLE_DSWPRunStage(NOELLE_DSWP_args_t *DSWPArgs) {
+
+  /*
+   * Allocate the queues this stage consumes from.
+   * This places them on the memory node of the consumer.
+   */
+  if (DSWPArgs->queuesReady != nullptr) {
+    auto localQueues = (void **)DSWPArgs->localQueues;
+    for (auto i = 0; i < DSWPArgs->numberOfQueues; i++) {
+      if (DSWPArgs->queueConsumers[i] != DSWPArgs->stageID) {
+        continue;
+      }
+      localQueues[i] = runtime.getDSWPQueue(DSWPArgs->queueSizes[i]);
+    }
+
+    /*
+     * Wait for all stages to allocate their queues.
+     */
+    DSWPArgs->queuesReady->countDown();
+    DSWPArgs->queuesReady->wait(runtime.getSpinBudget());
+  }
+
+  /*
+   * Invoke
+   *
+   * Measure the stage if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  auto startPushes = currentQueuePushes;
+  auto startPops = currentQueuePops;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+  auto prevNestedCoreBudget = currentNestedCoreBudget;
+  currentNestedCoreBudget = DSWPArgs->nestedCoreBudget;
+  {
+    NoelleTraceScope traceScope{ "DSWP stage",
+                                 (void *)DSWPArgs->funcToInvoke,
+                                 DSWPArgs->stageID };
+    DSWPArgs->funcToInvoke(DSWPArgs->env, DSWPArgs->localQueues);
+  }
+  currentNestedCoreBudget = prevNestedCoreBudget;
+  if (telemetryEnabled) {
+    DSWPArgs->telemetry.busyCycles = NOELLE_getCycles() - startCycles;
+    DSWPArgs->telemetry.queuePushes = currentQueuePushes - startPushes;
+    DSWPArgs->telemetry.queuePops = currentQueuePops - startPops;
+  }
+
+  return;
+}
+
+static void NOELLE_DSWPTrampoline(void *args) {
+
+  /*
+   * Fetch the arguments.
+   */
+  auto DSWPArgs = (NOELLE_DSWP_args_t *)args;
+
+  /*
+   * Pin the stage.
+   */
+  cpu_set_t previousCores;
+  auto pinned = NOELLE_pinCurrentThread(DSWPArgs->logicalCore, &previousCores);
+
+  /*
+   * Run the stage.
+   */
+  NOELLE_DSWPRunStage(DSWPArgs);
+
+  /*
+   * Restore the affinity of the thread.
+   */
+  if (pinned) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previousCores);
+  }
+
+  DSWPArgs->endLatch->countDown();
+  return;
+}
+
+/*
+ * Stages of a DSWP pipeline that run on the same thread because the pipeline
+ * got fewer cores than it has stages.
+ *
+ * The stages run as coroutines: a stage that has to wait on a queue switches
+ * to the next stage of the thread that has not finished yet (see
+ * NOELLE_queueBackOff) rather than letting the OS time-share the core among
+ * the stages.
+ * Since consecutive stages are fused together, the queues between them are
+ * filled and drained on the same core.
+ */
+typedef struct {
+  ucontext_t threadContext;
+  ucontext_t *stageContexts;
+  NOELLE_DSWP_args_t *stages;
+  uint8_t *done;
+  uint32_t numberOfStages;
+  uint32_t stagesLeft;
+  uint32_t currentStage;
+  int32_t logicalCore;
+  NoelleCountdownLatch *endLatch;
+} NOELLE_DSWP_fusedStages_t;
+
+/*
+ * Switch from the current stage to the next one of the thread that has not
+ * finished yet.
+ * Return false if the current stage is the only one left.
+ */
+static bool NOELLE_switchToFusedStage(void) {
+  auto fused = (NOELLE_DSWP_fusedStages_t *)currentFusedStages;
+  if (fused->stagesLeft <= 1) {
+    return false;
+  }
+
+  /*
+   * Fetch the next stage to run.
+   */
+  auto from = fused->currentStage;
+  auto next = from;
+  do {
+    next = (next + 1) % fused->numberOfStages;
+  } while (fused->done[next]);
+
+  /*
+   * Switch.
+   */
+  fused->currentStage = next;
+  swapcontext(&fused->stageContexts[from], &fused->stageContexts[next]);
+
+  return true;
+}
+
+static void NOELLE_DSWPFusedStage(void) {
+  auto fused = (NOELLE_DSWP_fusedStages_t *)currentFusedStages;
+
+  /*
+   * Run the stage.
+   */
+  auto stageIndex = fused->currentStage;
+  NOELLE_DSWPRunStage(&fused->stages[stageIndex]);
+  fused->done[stageIndex] = 1;
+  fused->stagesLeft--;
+
+  /*
+   * Go back to the thread if all its stages are done.
+   * Otherwise, run the next stage.
+   */
+  if (fused->stagesLeft == 0) {
+    setcontext(&fused->threadContext);
+  }
+  auto next = stageIndex;
+  do {
+    next = (next + 1) % fused->numberOfStages;
+  } while (fused->done[next]);
+  fused->currentStage = next;
+  setcontext(&fused->stageContexts[next]);
+
+  return;
+}
+
+static void NOELLE_DSWPFusedTrampoline(void *args) {
+
+  /*
+   * Fetch the arguments.
+   */
+  auto fused = (NOELLE_DSWP_fusedStages_t *)args;
+
+  /*
+   * Pin the thread.
+   */
+  cpu_set_t previousCores;
+  auto pinned = NOELLE_pinCurrentThread(fused->logicalCore, &previousCores);
+
+  /*
+   * Create the coroutines of the stages.
+   */
+  for (auto i = 0u; i < fused->numberOfStages; i++) {
+    auto stack = mmap(nullptr,
+                      NOELLE_DSWP_FUSED_STAGE_STACK_SIZE,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK,
+                      -1,
+                      0);
+    if (stack == MAP_FAILED) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = the stack of a DSWP stage cannot be "
+              "allocated\n");
+      abort();
+    }
+    auto context = &fused->stageContexts[i];
+    getcontext(context);
+    context->uc_stack.ss_sp = stack;
+    context->uc_stack.ss_size = NOELLE_DSWP_FUSED_STAGE_STACK_SIZE;
+    context->uc_link = nullptr;
+    makecontext(context, NOELLE_DSWPFusedStage, 0);
+  }
+
+  /*
+   * Run the stages.
+   */
+  fused->stagesLeft = fused->numberOfStages;
+  fused->currentStage = 0;
+  currentFusedStages = fused;
+  swapcontext(&fused->threadContext, &fused->stageContexts[0]);
+  currentFusedStages = nullptr;
+
+  /*
+   * Free the stacks.
+   */
+  for (auto i = 0u; i < fused->numberOfStages; i++) {
+    munmap(fused->stageContexts[i].uc_stack.ss_sp,
+           NOELLE_DSWP_FUSED_STAGE_STACK_SIZE);
+  }
+
+  /*
+   * Restore the affinity of the thread.
+   */
+  if (pinned) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &previousCores);
+  }
+
+  fused->endLatch->countDown();
+  return;
+}
+
+/*
+ * Check whether all the queues of a pipeline wait through
+ * NOELLE_queueBackOff, which is what lets stages share a thread.
+ */
+static bool NOELLE_canDSWPStagesBeFused(int64_t *queueSizes,
+                                        int64_t numberOfQueues) {
+  for (auto i = 0; i < numberOfQueues; i++) {
+    auto queueSize = queueSizes[i] & ~NOELLE_DSWP_QUEUE_CAPACITY_MASK;
+    if (queueSize == 0) {
+      continue;
+    }
+    if (false || (queueSize & NOELLE_DSWP_SLOT_QUEUE)
+        || (queueSize & NOELLE_DSWP_BATCHED_QUEUE)
+        || (queueSize & NOELLE_DSWP_SPSC_QUEUE)) {
+      continue;
+    }
+    return false;
+  }
+
+  return true;
+}
+
+static DispatcherInfo NOELLE_DSWPDispatcherImpl(void *env,
+                                                int64_t *queueSizes,
+                                                int64_t *queueConsumers,
+                                                void *stages,
+                                                int64_t *stageReplicas,
+                                                int64_t numberOfStages,
+                                                int64_t numberOfQueues) {
+  NoelleTraceScope traceScope{ "DSWP dispatch",
+                               ((void **)stages)[0],
+                               numberOfStages };
+#ifdef RUNTIME_PRINT
+  std::cerr << "Starting dispatcher: num stages " << numberOfStages
+            << ", num queues: " << numberOfQueues << std::endl;
+#endif
+
+  /*
+   * Measure the invocation if the telemetry is enabled.
+   */
+  auto telemetryEnabled = runtime.telemetry.isEnabled();
+  uint64_t startCycles = 0;
+  if (telemetryEnabled) {
+    startCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Fetch the thread pool
+   */
+  auto threadPool = runtime.threadPool;
+
+  /*
+   * Compute the number of threads to run.
+   * Each replica of a stage runs on its own thread.
+   */
+  int64_t numberOfThreads = 0;
+  for (auto i = 0; i < numberOfStages; ++i) {
+    numberOfThreads += (stageReplicas != nullptr) ? stageReplicas[i] : 1;
+  }
+
+  /*
+   * Reserve the cores.
+   *
+   * All stages run concurrently, even if we got fewer cores, because they
+   * communicate through bounded queues.
+   */
+  uint32_t coresReserved;
+  uint32_t nestedCoreBudget;
+  auto numCores = runtime.enterParallelRegion(numberOfThreads,
+                                              &coresReserved,
+                                              &nestedCoreBudget);
+  assert(numCores >= 1);
+
+  /*
+   * Check if consecutive stages must share a thread because we got fewer cores
+   * than the threads of the pipeline.
+   */
+  int64_t numberOfFusedThreads = 0;
+  if (true && (numCores < numberOfThreads)
+      && runtime.isDSWPStageFusionEnabled()
+      && NOELLE_canDSWPStagesBeFused(queueSizes, numberOfQueues)) {
+    numberOfFusedThreads = numCores;
+  }
+
+  /*
+   * Allocate the communication queues.
+   *
+   * When stages are placed, each stage allocates the queues it consumes from.
+   * Otherwise, we allocate all of them here. We also allocate them here when
+   * stages share threads because a stage cannot wait for the others of its
+   * thread to allocate their queues.
+   */
+  auto placeStages = runtime.isDSWPPlacementEnabled();
+  auto consumersAllocateQueues = true && placeStages
+                                 && (queueConsumers != nullptr)
+                                 && (numberOfFusedThreads == 0);
+  void *localQueues[numberOfQueues];
+  for (auto i = 0; i < numberOfQueues; ++i) {
+    localQueues[i] = nullptr;
+    if (consumersAllocateQueues) {
+      continue;
+    }
+    localQueues[i] = runtime.getDSWPQueue(queueSizes[i]);
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "Made queues" << std::endl;
+#endif
+
+  /*
+   * Give each replica of a replicated stage its own copy of the queue array.
+   * The copies differ only in their last slot, which holds the ID of the
+   * replica. This is how the replica finds the queues it owns.
+   */
+  std::vector<void *> replicaQueues;
+  if (stageReplicas != nullptr) {
+    replicaQueues.resize(numberOfThreads * numberOfQueues);
+  }
+
+  /*
+   * Allocate the memory to store the arguments.
+   */
+  uint32_t argsIndex;
+  auto argsForAllCores = (NOELLE_DSWP_args_t *)runtime.getCachedMemory(
+      sizeof(NOELLE_DSWP_args_t) * numberOfThreads,
+      &argsIndex);
+
+  /*
+   * Submit DSWP tasks
+   */
+  auto numberOfSubmittedThreads =
+      (numberOfFusedThreads > 0) ? numberOfFusedThreads : numberOfThreads;
+  NoelleCountdownLatch endLatch(numberOfSubmittedThreads);
+  NoelleCountdownLatch queuesReady(numberOfThreads);
+  auto allStages = (void **)stages;
+  auto threadID = 0;
+  uint64_t dispatchStartCycles = 0;
+  if (telemetryEnabled) {
+    dispatchStartCycles = NOELLE_getCycles();
+  }
+  for (auto i = 0; i < numberOfStages; ++i) {
+    auto replicas = (stageReplicas != nullptr) ? stageReplicas[i] : 1;
+    for (auto r = 0; r < replicas; ++r, ++threadID) {
+
+      /*
+       * Fetch the queues of the replica.
+       */
+      auto queuesOfThread = (void **)localQueues;
+      if (replicas > 1) {
+        queuesOfThread = &replicaQueues[threadID * numberOfQueues];
+        memcpy(queuesOfThread, localQueues, sizeof(void *) * numberOfQueues);
+        queuesOfThread[numberOfQueues - 1] = (void *)(intptr_t)r;
+      }
+
+      /*
+       * Prepare the arguments.
+       */
+      auto argsPerCore = &argsForAllCores[threadID];
+      argsPerCore->funcToInvoke = reinterpret_cast<stageFunctionPtr_t>(
+          reinterpret_cast<long long>(allStages[i]));
+      argsPerCore->env = env;
+      argsPerCore->localQueues = (void *)queuesOfThread;
+      argsPerCore->endLatch = &endLatch;
+      argsPerCore->stageID = i;
+      argsPerCore->logicalCore =
+          placeStages ? runtime.getDSWPStageCore(threadID) : -1;
+      argsPerCore->queueSizes = queueSizes;
+      argsPerCore->queueConsumers = queueConsumers;
+      argsPerCore->numberOfQueues = numberOfQueues;
+      argsPerCore->queuesReady =
+          consumersAllocateQueues ? &queuesReady : nullptr;
+      argsPerCore->nestedCoreBudget = nestedCoreBudget;
+      argsPerCore->telemetry = { 0, 0, 0, nullptr };
+
+      /*
+       * Submit
+       */
+      if (numberOfFusedThreads > 0) {
+        continue;
+      }
+      threadPool->submitAndDetach(NOELLE_DSWPTrampoline, argsPerCore);
+#ifdef RUNTIME_PRINT
+      std::cerr << "Submitted stage" << std::endl;
+#endif
+    }
+  }
+
+  /*
+   * Submit the threads that run several consecutive stages.
+   * Stages are split evenly among them in the order of the pipeline.
+   */
+  std::vector<NOELLE_DSWP_fusedStages_t> fusedThreads(numberOfFusedThreads);
+  std::vector<ucontext_t> fusedStageContexts;
+  std::vector<uint8_t> fusedStagesDone;
+  if (numberOfFusedThreads > 0) {
+    fusedStageContexts.resize(numberOfThreads);
+    fusedStagesDone.resize(numberOfThreads, 0);
+  }
+  for (auto i = 0; i < numberOfFusedThreads; i++) {
+    auto firstStage = (i * numberOfThreads) / numberOfFusedThreads;
+    auto lastStage = ((i + 1) * numberOfThreads) / numberOfFusedThreads;
+    auto fused = &fusedThreads[i];
+    fused->stageContexts = &fusedStageContexts[firstStage];
+    fused->stages = &argsForAllCores[firstStage];
+    fused->done = &fusedStagesDone[firstStage];
+    fused->numberOfStages = lastStage - firstStage;
+    fused->stagesLeft = fused->numberOfStages;
+    fused->currentStage = 0;
+    fused->logicalCore = placeStages ? runtime.getDSWPStageCore(i) : -1;
+    fused->endLatch = &endLatch;
+    threadPool->submitAndDetach(NOELLE_DSWPFusedTrampoline, fused);
+  }
+#ifdef RUNTIME_PRINT
+  std::cerr << "Submitted pool" << std::endl;
+#endif
+  uint64_t dispatchEndCycles = 0;
+  if (telemetryEnabled) {
+    dispatchEndCycles = NOELLE_getCycles();
+  }
+
+  /*
+   * Wait for the tasks to complete.
+   */
+  endLatch.wait(runtime.getSpinBudget());
+#ifdef RUNTIME_PRINT
+  std::cerr << "Got all futures" << std::endl;
+#endif
+
+  /*
+   * Record the invocation.
+   */
+  if (telemetryEnabled) {
+    NOELLE_taskTelemetry_t *tasks[numberOfThreads];
+    uint64_t slowestStageCycles = 0;
+    for (auto i = 0; i < numberOfThreads; i++) {
+      tasks[i] = &argsForAllCores[i].telemetry;
+      slowestStageCycles =
+          std::max(slowestStageCycles, tasks[i]->busyCycles);
+    }
+    auto endCycles = NOELLE_getCycles();
+    auto waitCycles = endCycles - dispatchEndCycles;
+    NOELLE_invocationTelemetry_t invocation{
+      endCycles - startCycles,
+      dispatchStartCycles - startCycles,
+      dispatchEndCycles - dispatchStartCycles,
+      (waitCycles > slowestStageCycles) ? (waitCycles - slowestStageCycles) : 0
+    };
+    runtime.telemetry.recordInvocation(allStages[0],
+                                       "DSWP",
+                                       invocation,
+                                       tasks,
+                                       numberOfThreads,
+                                       0);
+
+    /*
+     * Record the back pressure of the queues.
+     * The compiler stores the ID of the loop after the sizes of the queues.
+     */
+    uint64_t capacities[numberOfQueues];
+    uint64_t fullStalls[numberOfQueues];
+    uint64_t emptyStalls[numberOfQueues];
+    for (auto i = 0; i < numberOfQueues; i++) {
+      capacities[i] = 0;
+      fullStalls[i] = 0;
+      emptyStalls[i] = 0;
+      if (NOELLE_fetchDSWPQueueStalls(localQueues[i],
+                                      queueSizes[i],
+                                      &fullStalls[i],
+                                      &emptyStalls[i])) {
+        capacities[i] = NOELLE_getDSWPQueueCapacity(queueSizes[i]);
+      }
+    }
+    runtime.telemetry.recordQueues(allStages[0],
+                                   queueSizes[numberOfQueues],
+                                   capacities,
+                                   fullStalls,
+                                   emptyStalls,
+                                   numberOfQueues);
+  }
+
+  /*
+   * Free the cores and memory.
+   */
+  runtime.exitParallelRegion(coresReserved);
+  for (int i = 0; i < numberOfQueues; ++i) {
+    runtime.releaseDSWPQueue(localQueues[i], queueSizes[i]);
+  }
+  runtime.releaseCachedMemory(argsIndex);
+
+  DispatcherInfo dispatcherInfo;
+  dispatcherInfo.numberOfThreadsUsed = numberOfThreads;
+  return dispatcherInfo;
+}
+
+DispatcherInfo NOELLE_DSWPDispatcher(void *env,
+                                     int64_t *queueSizes,
+                                     void *stages,
+                                     int64_t numberOfStages,
+                                     int64_t numberOfQueues) {
+  return NOELLE_DSWPDispatcherImpl(env,
+                                   queueSizes,
+                                   nullptr,
+                                   stages,
+                                   nullptr,
+                                   numberOfStages,
+                                   numberOfQueues);
+}
+
+DispatcherInfo NOELLE_DSWPDispatcherWithPlacement(void *env,
+                                                  int64_t *queueSizes,
+                                                  int64_t *queueConsumers,
+                                                  void *stages,
+                                                  int64_t numberOfStages,
+                                                  int64_t numberOfQueues) {
+  return NOELLE_DSWPDispatcherImpl(env,
+                                   queueSizes,
+                                   queueConsumers,
+                                   stages,
+                                   nullptr,
+                                   numberOfStages,
+                                   numberOfQueues);
+}
+
+DispatcherInfo NOELLE_DSWPDispatcherWithReplicas(void *env,
+                                                 int64_t *queueSizes,
+                                                 void *stages,
+                                                 int64_t *stageReplicas,
+                                                 int64_t numberOfStages,
+                                                 int64_t numberOfQueues) {
+  return NOELLE_DSWPDispatcherImpl(env,
+                                   queueSizes,
+                                   nullptr,
+                                   stages,
+                                   stageReplicas,
+                                   numberOfStages,
+                                   numberOfQueues);
+}
+}
+
+NoelleTelemetry::NoelleTelemetry() : enabled{ false }, startCycles{ 0 } {
+
+  /*
+   * Check whether the telemetry is enabled.
+   */
+  auto telemetryEnvVar = getenv("NOELLE_TELEMETRY");
+  if (true && (telemetryEnvVar != nullptr) && (telemetryEnvVar[0] != '\0')) {
+    this->enabled = true;
+    this->outputFileName = telemetryEnvVar;
+  }
+
+  /*
+   * Remember when the program started to compute the frequency of the cycle
+   * counter when the telemetry is dumped.
+   */
+  if (this->enabled) {
+    this->startCycles = NOELLE_getCycles();
+    this->startTime = std::chrono::steady_clock::now();
+  }
+
+  return;
+}
+
+bool NoelleTelemetry::isEnabled(void) const {
+  return this->enabled;
+}
+
+NOELLE_telemetryBuffer_t *NoelleTelemetry::getBuffer(void) {
+
+  /*
+   * Check if the current thread already has a buffer.
+   */
+  if (currentTelemetryBuffer != nullptr) {
+    return currentTelemetryBuffer;
+  }
+
+  /*
+   * Allocate the buffer of the current thread.
+   * Buffers outlive their threads, so they can be dumped at exit.
+   */
+  auto buffer = new NOELLE_telemetryBuffer_t();
+  {
+    std::lock_guard<std::mutex> guard(this->buffersLock);
+    this->buffers.push_back(buffer);
+  }
+  currentTelemetryBuffer = buffer;
+
+  return buffer;
+}
+
+void NoelleTelemetry::recordInvocation(
+    void *loop,
+    const char *technique,
+    const NOELLE_invocationTelemetry_t &invocation,
+    NOELLE_taskTelemetry_t **tasks,
+                                       uint32_t numberOfTasks,
+                                       uint32_t numberOfSegments) {
+
+  /*
+   * Fetch the counters of the loop in the buffer of the current thread.
+   */
+  auto buffer = this->getBuffer();
+  auto &loopTelemetry = buffer->loops[loop];
+  loopTelemetry.technique = technique;
+  if (loopTelemetry.busyCycles.size() < numberOfTasks) {
+    loopTelemetry.busyCycles.resize(numberOfTasks, 0);
+    loopTelemetry.idleCycles.resize(numberOfTasks, 0);
+  }
+  if (loopTelemetry.segmentWaitCycles.size() < numberOfSegments) {
+    loopTelemetry.segmentWaitCycles.resize(numberOfSegments, 0);
+  }
+  if (true && (numberOfTasks > 0) && (tasks[0]->segmentTransactions != nullptr)
+      && (loopTelemetry.segmentTransactions.size() < numberOfSegments)) {
+    loopTelemetry.segmentTransactions.resize(numberOfSegments, 0);
+    loopTelemetry.segmentAborts.resize(numberOfSegments, 0);
+  }
+
+  /*
+   * Accumulate the counters of the invocation.
+   */
+  auto cycles = invocation.cycles;
+  loopTelemetry.invocations++;
+  loopTelemetry.threadsUsed += numberOfTasks;
+  loopTelemetry.cycles += cycles;
+  loopTelemetry.setupCycles += invocation.setupCycles;
+  loopTelemetry.dispatchCycles += invocation.dispatchCycles;
+  loopTelemetry.joinCycles += invocation.joinCycles;
+  uint64_t minBusyCycles = UINT64_MAX;
+  uint64_t maxBusyCycles = 0;
+  for (auto i = 0u; i < numberOfTasks; i++) {
+    auto task = tasks[i];
+    auto busyCycles = task->busyCycles;
+    loopTelemetry.busyCycles[i] += busyCycles;
+    if (cycles > busyCycles) {
+      loopTelemetry.idleCycles[i] += cycles - busyCycles;
+    }
+    minBusyCycles = std::min(minBusyCycles, busyCycles);
+    maxBusyCycles = std::max(maxBusyCycles, busyCycles);
+    loopTelemetry.queuePushes += task->queuePushes;
+    loopTelemetry.queuePops += task->queuePops;
+    if (task->chunks > 0) {
+      loopTelemetry.loopID = task->loopID;
+      loopTelemetry.chunkSize = task->chunkSize;
+      loopTelemetry.chunks += task->chunks;
+      loopTelemetry.chunkCycles += task->chunkCycles;
+      loopTelemetry.chunkSquaredCycles += task->chunkSquaredCycles;
+    }
+    if (task->segmentWaitCycles != nullptr) {
+      for (auto ssID = 0u; ssID < numberOfSegments; ssID++) {
+        loopTelemetry.segmentWaitCycles[ssID] += task->segmentWaitCycles[ssID];
+      }
+    }
+    if (true && (task->segmentTransactions != nullptr)
+        && (loopTelemetry.segmentTransactions.size() >= numberOfSegments)) {
+      for (auto ssID = 0u; ssID < numberOfSegments; ssID++) {
+        loopTelemetry.segmentTransactions[ssID] +=
+            task->segmentTransactions[ssID];
+        loopTelemetry.segmentAborts[ssID] += task->segmentAborts[ssID];
+      }
+    }
+  }
+  if (numberOfTasks > 0) {
+    loopTelemetry.imbalanceCycles += maxBusyCycles - minBusyCycles;
+  }
+
+  return;
+}
+
+void NoelleTelemetry::recordQueues(void *loop,
+                                   int64_t loopID,
+                                   uint64_t *capacities,
+                                   uint64_t *fullStalls,
+                                   uint64_t *emptyStalls,
+                                   uint32_t numberOfQueues) {
+
+  /*
+   * Fetch the counters of the loop in the buffer of the current thread.
+   */
+  auto buffer = this->getBuffer();
+  auto &loopTelemetry = buffer->loops[loop];
+  loopTelemetry.loopID = loopID;
+  if (loopTelemetry.queueCapacities.size() < numberOfQueues) {
+    loopTelemetry.queueCapacities.resize(numberOfQueues, 0);
+    loopTelemetry.queueFullStalls.resize(numberOfQueues, 0);
+    loopTelemetry.queueEmptyStalls.resize(numberOfQueues, 0);
+  }
+
+  /*
+   * Accumulate the stalls of the invocation.
+   */
+  for (auto i = 0u; i < numberOfQueues; i++) {
+    loopTelemetry.queueCapacities[i] = capacities[i];
+    loopTelemetry.queueFullStalls[i] += fullStalls[i];
+    loopTelemetry.queueEmptyStalls[i] += emptyStalls[i];
+  }
+
+  return;
+}
+
+void NoelleTelemetry::dump(void) {
+  if (!this->enabled) {
+    return;
+  }
+
+  /*
+   * Merge the buffers of all threads.
+   */
+  std::unordered_map<void *, NOELLE_loopTelemetry_t> loops;
+  {
+    std::lock_guard<std::mutex> guard(this->buffersLock);
+    for (auto buffer : this->buffers) {
+      for (auto &pair : buffer->loops) {
+        auto &from = pair.second;
+        auto &to = loops[pair.first];
+        to.technique = from.technique;
+        to.invocations += from.invocations;
+        to.threadsUsed += from.threadsUsed;
+        to.cycles += from.cycles;
+        to.setupCycles += from.setupCycles;
+        to.dispatchCycles += from.dispatchCycles;
+        to.joinCycles += from.joinCycles;
+        to.imbalanceCycles += from.imbalanceCycles;
+        to.queuePushes += from.queuePushes;
+        to.queuePops += from.queuePops;
+        auto merge = [](std::vector<uint64_t> &to,
+                        const std::vector<uint64_t> &from) {
+          if (to.size() < from.size()) {
+            to.resize(from.size(), 0);
+          }
+          for (auto i = 0u; i < from.size(); i++) {
+            to[i] += from[i];
+          }
+        };
+        merge(to.busyCycles, from.busyCycles);
+        merge(to.idleCycles, from.idleCycles);
+        merge(to.segmentWaitCycles, from.segmentWaitCycles);
+        merge(to.segmentTransactions, from.segmentTransactions);
+        merge(to.segmentAborts, from.segmentAborts);
+        if (from.queueCapacities.size() > 0) {
+          to.loopID = from.loopID;
+          to.queueCapacities = from.queueCapacities;
+        }
+        merge(to.queueFullStalls, from.queueFullStalls);
+        merge(to.queueEmptyStalls, from.queueEmptyStalls);
+      }
+      delete buffer;
+    }
+    this->buffers.clear();
+  }
+
+  /*
+   * Open the output.
+   */
+  auto output = stderr;
+  if (this->outputFileName != "-") {
+    output = fopen(this->outputFileName.c_str(), "w");
+    if (output == nullptr) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = cannot open the telemetry file "
+              "\"%s\"\n",
+              this->outputFileName.c_str());
+      return;
+    }
+  }
+
+  /*
+   * Dump the counters as JSON.
+   */
+  auto printArray = [output](const char *name,
+                             const std::vector<uint64_t> &values) {
+    fprintf(output, "      \"%s\": [", name);
+    for (auto i = 0u; i < values.size(); i++) {
+      fprintf(output,
+              "%s%llu",
+              (i > 0) ? ", " : "",
+              (unsigned long long)values[i]);
+    }
+    fprintf(output, "]");
+  };
+  auto elapsedTime = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - this->startTime)
+                         .count();
+  auto cyclesPerSecond =
+      (elapsedTime > 0)
+          ? ((double)(NOELLE_getCycles() - this->startCycles) / elapsedTime)
+          : 0;
+  fprintf(output, "{\n  \"cyclesPerSecond\": %.0f,\n", cyclesPerSecond);
+  fprintf(output, "  \"loops\": [");
+  auto firstLoop = true;
+  for (auto &pair : loops) {
+    auto &loopTelemetry = pair.second;
+    fprintf(output, "%s\n    {\n", firstLoop ? "" : ",");
+    firstLoop = false;
+    fprintf(output, "      \"loop\": \"%p\",\n", pair.first);
+    fprintf(output,
+            "      \"offset\": \"0x%llx\",\n",
+            (unsigned long long)((uintptr_t)pair.first
+                                 - (uintptr_t)&__executable_start));
+    fprintf(output,
+            "      \"technique\": \"%s\",\n",
+            loopTelemetry.technique);
+    fprintf(output,
+            "      \"invocations\": %llu,\n",
+            (unsigned long long)loopTelemetry.invocations);
+    fprintf(output,
+            "      \"threadsUsed\": %llu,\n",
+            (unsigned long long)loopTelemetry.threadsUsed);
+    fprintf(output,
+            "      \"cycles\": %llu,\n",
+            (unsigned long long)loopTelemetry.cycles);
+    fprintf(output,
+            "      \"setupCycles\": %llu,\n",
+            (unsigned long long)loopTelemetry.setupCycles);
+    fprintf(output,
+            "      \"dispatchCycles\": %llu,\n",
+            (unsigned long long)loopTelemetry.dispatchCycles);
+    fprintf(output,
+            "      \"joinCycles\": %llu,\n",
+            (unsigned long long)loopTelemetry.joinCycles);
+    fprintf(output,
+            "      \"imbalanceCycles\": %llu,\n",
+            (unsigned long long)loopTelemetry.imbalanceCycles);
+    fprintf(output,
+            "      \"queuePushes\": %llu,\n",
+            (unsigned long long)loopTelemetry.queuePushes);
+    fprintf(output,
+            "      \"queuePops\": %llu,\n",
+            (unsigned long long)loopTelemetry.queuePops);
+    printArray("busyCycles", loopTelemetry.busyCycles);
+    fprintf(output, ",\n");
+    printArray("idleCycles", loopTelemetry.idleCycles);
+    fprintf(output, ",\n");
+    printArray("segmentWaitCycles", loopTelemetry.segmentWaitCycles);
+
+    /*
+     * Dump the hardware transactions of the HELIX critical sections, whose
+     * abort rate tells which critical sections conflict at run time (see
+     * NOELLE_HELIX_HTM).
+     */
+    if (loopTelemetry.segmentTransactions.size() > 0) {
+      fprintf(output, ",\n");
+      printArray("segmentTransactions", loopTelemetry.segmentTransactions);
+      fprintf(output, ",\n");
+      printArray("segmentAborts", loopTelemetry.segmentAborts);
+    }
+
+    /*
+     * Dump the back pressure of the queues, which the compiler reads to size
+     * them (see -dswp-queue-telemetry).
+     */
+    if (loopTelemetry.queueCapacities.size() > 0) {
+      fprintf(output,
+              ",\n      \"loopID\": %lld,\n",
+              (long long)loopTelemetry.loopID);
+      printArray("queueCapacities", loopTelemetry.queueCapacities);
+      fprintf(output, ",\n");
+      printArray("queueFullStalls", loopTelemetry.queueFullStalls);
+      fprintf(output, ",\n");
+      printArray("queueEmptyStalls", loopTelemetry.queueEmptyStalls);
+    }
+
+    /*
+     * Dump the distribution of the cycles of the DOALL chunks, which the
+     * compiler reads to choose the chunk size and the scheduling of the loop
+     * (see -noelle-planner-doall-telemetry).
+     */
+    if (loopTelemetry.chunks > 0) {
+      auto chunks = (double)loopTelemetry.chunks;
+      auto mean = (double)loopTelemetry.chunkCycles / chunks;
+      auto variance =
+          (loopTelemetry.chunkSquaredCycles / chunks) - (mean * mean);
+      fprintf(output,
+              ",\n      \"loopID\": %lld,\n",
+              (long long)loopTelemetry.loopID);
+      fprintf(output,
+              "      \"chunkSize\": %lld,\n",
+              (long long)loopTelemetry.chunkSize);
+      fprintf(output,
+              "      \"chunks\": %llu,\n",
+              (unsigned long long)loopTelemetry.chunks);
+      fprintf(output, "      \"chunkCyclesMean\": %.2f,\n", mean);
+      fprintf(output,
+              "      \"chunkCyclesVariance\": %.2f",
+              std::max(variance, 0.0));
+    }
+    fprintf(output, "\n    }");
+  }
+  fprintf(output, "\n  ]\n}\n");
+
+  /*
+   * Close the output.
+   */
+  if (output != stderr) {
+    fclose(output);
+  }
+
+  return;
+}
+
+NoelleTracer::NoelleTracer()
+  : enabled{ false },
+    eventsPerThread{ 1 << 16 },
+    startCycles{ 0 } {
+
+  /*
+   * Check whether the trace is enabled.
+   */
+  auto traceEnvVar = getenv("NOELLE_TRACE");
+  if (false || (traceEnvVar == nullptr) || (traceEnvVar[0] == '\0')) {
+    return;
+  }
+  this->enabled = true;
+  this->outputFileName = traceEnvVar;
+
+  /*
+   * Fetch the number of events to keep per thread.
+   */
+  auto eventsEnvVar = getenv("NOELLE_TRACE_EVENTS");
+  if (eventsEnvVar != nullptr) {
+    auto events = atoll(eventsEnvVar);
+    if (events > 0) {
+      this->eventsPerThread = events;
+    }
+  }
+
+  /*
+   * Remember when the trace starts to convert cycles to time when dumping it.
+   */
+  this->startCycles = NOELLE_getCycles();
+  this->startTime = std::chrono::steady_clock::now();
+
+  return;
+}
+
+bool NoelleTracer::isEnabled(void) const {
+  return this->enabled;
+}
+
+NOELLE_traceBuffer_t *NoelleTracer::getBuffer(void) {
+
+  /*
+   * Check if the current thread already has a buffer.
+   */
+  if (currentTraceBuffer != nullptr) {
+    return currentTraceBuffer;
+  }
+
+  /*
+   * Allocate the buffer of the current thread.
+   * Buffers outlive their threads, so they can be dumped at exit.
+   */
+  auto buffer = new NOELLE_traceBuffer_t();
+  buffer->workerID = currentWorkerID;
+  buffer->numberOfEvents = 0;
+  buffer->events.resize(this->eventsPerThread);
+  {
+    std::lock_guard<std::mutex> guard(this->buffersLock);
+    buffer->threadID = this->buffers.size();
+    this->buffers.push_back(buffer);
+  }
+  currentTraceBuffer = buffer;
+
+  return buffer;
+}
+
+void NoelleTracer::recordEvent(const char *name,
+                               const void *object,
+                               int64_t argument,
+                               uint64_t startCycles,
+                               uint64_t endCycles) {
+  auto buffer = this->getBuffer();
+  auto &event =
+      buffer->events[buffer->numberOfEvents % buffer->events.size()];
+  event.name = name;
+  event.object = object;
+  event.argument = argument;
+  event.startCycles = startCycles;
+  event.endCycles = endCycles;
+  buffer->numberOfEvents++;
+
+  return;
+}
+
+void NoelleTracer::dump(void) {
+  if (!this->enabled) {
+    return;
+  }
+
+  /*
+   * Compute the cycles per microsecond.
+   */
+  auto elapsedTime = std::chrono::steady_clock::now() - this->startTime;
+  auto elapsedMicroseconds =
+      std::chrono::duration<double, std::micro>(elapsedTime).count();
+  auto elapsedCycles = NOELLE_getCycles() - this->startCycles;
+  auto cyclesPerMicrosecond = 1.0;
+  if (true && (elapsedMicroseconds > 0) && (elapsedCycles > 0)) {
+    cyclesPerMicrosecond = ((double)elapsedCycles) / elapsedMicroseconds;
+  }
+  auto toMicroseconds = [this, cyclesPerMicrosecond](uint64_t cycles) {
+    if (cycles < this->startCycles) {
+      return 0.0;
+    }
+    return ((double)(cycles - this->startCycles)) / cyclesPerMicrosecond;
+  };
+
+  /*
+   * Open the output.
+   */
+  auto output = stderr;
+  if (this->outputFileName != "-") {
+    output = fopen(this->outputFileName.c_str(), "w");
+    if (output == nullptr) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = cannot open the trace file \"%s\"\n",
+              this->outputFileName.c_str());
+      return;
+    }
+  }
+
+  /*
+   * Dump the events of all threads in the Chrome trace format.
+   * Threads are named after the worker of the pool they are, if any.
+   */
+  std::lock_guard<std::mutex> guard(this->buffersLock);
+  fprintf(output, "{\n  \"displayTimeUnit\": \"ns\",\n");
+  fprintf(output, "  \"traceEvents\": [");
+  auto firstEvent = true;
+  for (auto buffer : this->buffers) {
+    fprintf(output,
+            "%s\n    {\"name\": \"thread_name\", \"ph\": \"M\", "
+            "\"pid\": 0, \"tid\": %u, \"args\": {\"name\": ",
+            firstEvent ? "" : ",",
+            buffer->threadID);
+    firstEvent = false;
+    if (buffer->workerID >= 0) {
+      fprintf(output, "\"worker %lld\"}}", (long long)buffer->workerID);
+    } else {
+      fprintf(output, "\"thread %u\"}}", buffer->threadID);
+    }
+
+    /*
+     * Dump the events from the oldest one kept.
+     */
+    auto capacity = buffer->events.size();
+    uint64_t firstIndex = 0;
+    if (buffer->numberOfEvents > capacity) {
+      firstIndex = buffer->numberOfEvents - capacity;
+    }
+    for (auto i = firstIndex; i < buffer->numberOfEvents; i++) {
+      auto &event = buffer->events[i % capacity];
+      auto start = toMicroseconds(event.startCycles);
+      fprintf(output,
+              ",\n    {\"name\": \"%s\", \"cat\": \"noelle\", \"pid\": 0, "
+              "\"tid\": %u, \"ts\": %.3f, ",
+              event.name,
+              buffer->threadID,
+              start);
+      if (event.endCycles == event.startCycles) {
+        fprintf(output, "\"ph\": \"i\", \"s\": \"t\", ");
+      } else {
+        fprintf(output,
+                "\"ph\": \"X\", \"dur\": %.3f, ",
+                toMicroseconds(event.endCycles) - start);
+      }
+      fprintf(output,
+              "\"args\": {\"object\": \"%p\", \"argument\": %lld}}",
+              event.object,
+              (long long)event.argument);
+    }
+  }
+  fprintf(output, "\n  ]\n}\n");
+
+  /*
+   * Close the output.
+   */
+  if (output != stderr) {
+    fclose(output);
+  }
+
+  return;
+}
+
+NoelleTraceScope::NoelleTraceScope(const char *name,
+                                   const void *object,
+                                   int64_t argument)
+  : name{ name },
+    object{ object },
+    argument{ argument },
+    startCycles{ 0 },
+    enabled{ runtime.tracer.isEnabled() } {
+  if (this->enabled) {
+    this->startCycles = NOELLE_getCycles();
+  }
+
+  return;
+}
+
+NoelleTraceScope::~NoelleTraceScope() {
+  if (this->enabled) {
+    runtime.tracer.recordEvent(this->name,
+                               this->object,
+                               this->argument,
+                               this->startCycles,
+                               NOELLE_getCycles());
+  }
+
+  return;
+}
+
+NoelleEnvironmentReport::NoelleEnvironmentReport() : enabled{ false } {
+
+  /*
+   * Check whether the report is enabled.
+   */
+  auto reportEnvVar = getenv("NOELLE_ENVIRONMENT_REPORT");
+  if (true && (reportEnvVar != nullptr) && (reportEnvVar[0] != '\0')) {
+    this->enabled = true;
+    this->outputFileName = reportEnvVar;
+  }
+
+  return;
+}
+
+bool NoelleEnvironmentReport::isEnabled(void) const {
+  return this->enabled;
+}
+
+void NoelleEnvironmentReport::recordEnvironment(int64_t loopID,
+                                                void *env,
+                                                const char *layout) {
+  if (false || (!this->enabled) || (env == nullptr) || (layout == nullptr)) {
+    return;
+  }
+
+  /*
+   * Check if the environment has already been placed at the same address.
+   */
+  auto envAddress = (uint64_t)env;
+  auto key = std::make_pair(layout, envAddress);
+  std::lock_guard<std::mutex> guard(this->placementsLock);
+  auto placementIt = this->placements.find(key);
+  if (placementIt != this->placements.end()) {
+    placementIt->second.invocations++;
+    return;
+  }
+  if (this->placements.size() >= NOELLE_ENVIRONMENT_REPORT_PLACEMENTS) {
+    return;
+  }
+  auto &placement = this->placements[key];
+  placement.loopID = loopID;
+  placement.invocations = 1;
+
+  /*
+   * Compute the memory of the variables.
+   * Variables are described by "INDEX:KIND:OFFSET:BYTES", and reduced ones
+   * (whose kind is 'p') are followed by ":STRIDE:COPIES:COPY_BYTES".
+   */
+  std::string variables{ layout };
+  size_t start = 0;
+  while (start < variables.size()) {
+    auto end = variables.find(',', start);
+    if (end == std::string::npos) {
+      end = variables.size();
+    }
+    auto variable = variables.substr(start, end - start);
+    start = end + 1;
+    unsigned int envIndex = 0;
+    char kind = 'r';
+    unsigned long long offset = 0;
+    unsigned long long bytes = 0;
+    unsigned long long stride = 0;
+    unsigned long long copies = 0;
+    unsigned long long copyBytes = 0;
+    auto fields = sscanf(variable.c_str(),
+                         "%u:%c:%llu:%llu:%llu:%llu:%llu",
+                         &envIndex,
+                         &kind,
+                         &offset,
+                         &bytes,
+                         &stride,
+                         &copies,
+                         &copyBytes);
+    if (fields < 4) {
+      continue;
+    }
+    NOELLE_environmentRegion_t region;
+    region.envIndex = envIndex;
+    region.writer =
+        (kind == 'w') ? NOELLE_ENVIRONMENT_WRITTEN : NOELLE_ENVIRONMENT_READ;
+    region.address = envAddress + offset;
+    region.bytes = bytes;
+    placement.regions.push_back(region);
+    if (false || (kind != 'p') || (fields < 7)) {
+      continue;
+    }
+
+    /*
+     * The environment holds the pointer to the private copies of the tasks.
+     */
+    auto copiesAddress = *((uint64_t *)region.address);
+    for (auto copy = 0ull; copy < copies; copy++) {
+      NOELLE_environmentRegion_t copyRegion;
+      copyRegion.envIndex = envIndex;
+      copyRegion.writer = copy;
+      copyRegion.address = copiesAddress + (copy * stride);
+      copyRegion.bytes = copyBytes;
+      placement.regions.push_back(copyRegion);
+    }
+  }
+
+  return;
+}
+
+void NoelleEnvironmentReport::dump(void) {
+  if (!this->enabled) {
+    return;
+  }
+
+  /*
+   * Open the output.
+   */
+  auto output = stderr;
+  if (this->outputFileName != "-") {
+    output = fopen(this->outputFileName.c_str(), "w");
+    if (output == nullptr) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = cannot open the environment report "
+              "\"%s\"\n",
+              this->outputFileName.c_str());
+      return;
+    }
+  }
+
+  /*
+   * Dump the cache lines of every placement.
+   * Variables are INDEX:r if the tasks read them, INDEX:w if the tasks write
+   * them, and INDEX:pTASK for the private copy of the task TASK.
+   */
+  std::lock_guard<std::mutex> guard(this->placementsLock);
+  fprintf(output,
+          "# LOOP_ID CACHE_LINE VARIABLES FALSELY_SHARED INVOCATIONS\n");
+  for (auto &placementPair : this->placements) {
+    auto &placement = placementPair.second;
+
+    /*
+     * Map the cache lines to the regions they hold.
+     */
+    std::map<uint64_t, std::vector<NOELLE_environmentRegion_t *>> cacheLines;
+    for (auto &region : placement.regions) {
+      if (region.bytes == 0) {
+        continue;
+      }
+      auto firstLine = region.address / CACHE_LINE_SIZE;
+      auto lastLine = (region.address + region.bytes - 1) / CACHE_LINE_SIZE;
+      for (auto line = firstLine; line <= lastLine; line++) {
+        cacheLines[line].push_back(&region);
+      }
+    }
+
+    /*
+     * Dump the cache lines.
+     */
+    for (auto &cacheLinePair : cacheLines) {
+      auto &regions = cacheLinePair.second;
+      std::string variables;
+      auto isWritten = false;
+      for (auto region : regions) {
+        if (variables.size() > 0) {
+          variables += ",";
+        }
+        variables += std::to_string(region->envIndex);
+        if (region->writer == NOELLE_ENVIRONMENT_READ) {
+          variables += ":r";
+        } else if (region->writer == NOELLE_ENVIRONMENT_WRITTEN) {
+          variables += ":w";
+          isWritten = true;
+        } else {
+          variables += ":p" + std::to_string(region->writer);
+          isWritten = true;
+        }
+      }
+      auto isFalselyShared = isWritten && (regions.size() > 1);
+      fprintf(output,
+              "%lld 0x%llx %s %s %llu\n",
+              (long long)placement.loopID,
+              (unsigned long long)(cacheLinePair.first * CACHE_LINE_SIZE),
+              variables.c_str(),
+              isFalselyShared ? "yes" : "no",
+              (unsigned long long)placement.invocations);
+    }
+  }
+
+  /*
+   * Close the output.
+   */
+  if (output != stderr) {
+    fclose(output);
+  }
+
+  return;
+}
+
+NoelleSegmentProfiler::NoelleSegmentProfiler() : enabled{ false } {
+
+  /*
+   * Check whether the profiler is enabled.
+   */
+  auto profileEnvVar = getenv("NOELLE_HELIX_SEGMENTS");
+  if (true && (profileEnvVar != nullptr) && (profileEnvVar[0] != '\0')) {
+    this->enabled = true;
+    this->outputFileName = profileEnvVar;
+  }
+
+  return;
+}
+
+bool NoelleSegmentProfiler::isEnabled(void) const {
+  return this->enabled;
+}
+
+HELIX_segmentProfileBuffer_t *NoelleSegmentProfiler::getBuffer(void) {
+
+  /*
+   * Check if the current thread already has a buffer.
+   */
+  if (currentSegmentProfileBuffer != nullptr) {
+    return currentSegmentProfileBuffer;
+  }
+
+  /*
+   * Allocate the buffer of the current thread.
+   * Buffers outlive their threads, so they can be dumped at exit.
+   */
+  auto buffer = new HELIX_segmentProfileBuffer_t();
+  buffer->lastSegment = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(this->buffersLock);
+    this->buffers.push_back(buffer);
+  }
+  currentSegmentProfileBuffer = buffer;
+
+  return buffer;
+}
+
+HELIX_segmentProfile_t *NoelleSegmentProfiler::getSegment(int64_t loopID,
+                                                          int64_t segmentID) {
+  if (!this->enabled) {
+    return nullptr;
+  }
+
+  /*
+   * Fetch the profile of the segment in the buffer of the current thread.
+   * Threads usually wait on, enter, and leave the same segment in a row.
+   */
+  auto buffer = this->getBuffer();
+  auto key = std::make_pair(loopID, segmentID);
+  if (true && (buffer->lastSegment != nullptr)
+      && (buffer->lastSegmentKey == key)) {
+    return buffer->lastSegment;
+  }
+  auto segment = &buffer->segments[key];
+  buffer->lastSegmentKey = key;
+  buffer->lastSegment = segment;
+
+  return segment;
+}
+
+void NoelleSegmentProfiler::dump(void) {
+  if (!this->enabled) {
+    return;
+  }
+
+  /*
+   * Merge the profiles of all threads.
+   */
+  std::lock_guard<std::mutex> guard(this->buffersLock);
+  std::map<std::pair<int64_t, int64_t>, HELIX_segmentProfile_t> segments;
+  for (auto buffer : this->buffers) {
+    for (auto &segmentPair : buffer->segments) {
+      auto &to = segments[segmentPair.first];
+      auto &from = segmentPair.second;
+      to.entries += from.entries;
+      to.waitCycles += from.waitCycles;
+      to.holdCycles += from.holdCycles;
+    }
+  }
+
+  /*
+   * Open the output.
+   */
+  auto output = stderr;
+  if (this->outputFileName != "-") {
+    output = fopen(this->outputFileName.c_str(), "w");
+    if (output == nullptr) {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = cannot open the profile of the "
+              "sequential segments \"%s\"\n",
+              this->outputFileName.c_str());
+      return;
+    }
+  }
+
+  /*
+   * Dump the segments.
+   */
+  fprintf(output, "# LOOP_ID SEGMENT_ID ENTRIES WAIT_CYCLES HOLD_CYCLES\n");
+  for (auto &segmentPair : segments) {
+    auto &segment = segmentPair.second;
+    fprintf(output,
+            "%lld %lld %llu %llu %llu\n",
+            (long long)segmentPair.first.first,
+            (long long)segmentPair.first.second,
+            (unsigned long long)segment.entries,
+            (unsigned long long)segment.waitCycles,
+            (unsigned long long)segment.holdCycles);
+  }
+
+  /*
+   * Close the output.
+   */
+  if (output != stderr) {
+    fclose(output);
+  }
+
+  return;
+}
+
+NoelleBufferedOutput::NoelleBufferedOutput() {
+  return;
+}
+
+NOELLE_bufferedOutputBuffer_t *NoelleBufferedOutput::getBuffer(void) {
+
+  /*
+   * Check if the current thread already has a buffer.
+   */
+  if (currentBufferedOutput != nullptr) {
+    return currentBufferedOutput;
+  }
+
+  /*
+   * Allocate the buffer of the current thread.
+   * Buffers outlive their threads, so their output can be written at exit.
+   */
+  auto buffer = new NOELLE_bufferedOutputBuffer_t();
+  {
+    std::lock_guard<std::mutex> guard(this->buffersLock);
+    this->buffers.push_back(buffer);
+  }
+  currentBufferedOutput = buffer;
+
+  return buffer;
+}
+
+void NoelleBufferedOutput::append(FILE *stream,
+                                  const char *bytes,
+                                  uint64_t length) {
+  auto buffer = this->getBuffer();
+  std::lock_guard<std::mutex> guard(buffer->lock);
+
+  /*
+   * Consecutive writes of an iteration to the same stream share their chunk.
+   */
+  auto &chunks = buffer->chunks;
+  if (true && (chunks.size() > 0)
+      && (chunks.back().env == currentBufferedOutputEnv)
+      && (chunks.back().iteration == currentBufferedOutputIteration)
+      && (chunks.back().stream == stream)) {
+    chunks.back().bytes.append(bytes, length);
+  } else {
+    chunks.push_back(
+        NOELLE_bufferedOutputChunk_t{ currentBufferedOutputEnv,
+                                      currentBufferedOutputIteration,
+                                      stream,
+                                      std::string(bytes, length) });
+  }
+
+  return;
+}
+
+void NoelleBufferedOutput::write(void *env) {
+
+  /*
+   * Collect the output of the invocation from the buffers of all threads.
+   * Other invocations (e.g., of the same loop nested in another parallelized
+   * loop) can be running, so their output is left in the buffers.
+   */
+  std::vector<NOELLE_bufferedOutputChunk_t> chunks;
+  {
+    std::lock_guard<std::mutex> buffersGuard(this->buffersLock);
+    for (auto buffer : this->buffers) {
+      std::lock_guard<std::mutex> guard(buffer->lock);
+      auto &threadChunks = buffer->chunks;
+      auto firstToKeep = std::stable_partition(
+          threadChunks.begin(),
+          threadChunks.end(),
+          [env](const NOELLE_bufferedOutputChunk_t &chunk) -> bool {
+            return chunk.env != env;
+          });
+      std::move(firstToKeep, threadChunks.end(), std::back_inserter(chunks));
+      threadChunks.erase(firstToKeep, threadChunks.end());
+    }
+  }
+
+  /*
+   * Write the output in the order of the iterations.
+   */
+  this->writeChunks(chunks);
+
+  return;
+}
+
+void NoelleBufferedOutput::writeAll(void) {
+  std::vector<NOELLE_bufferedOutputChunk_t> chunks;
+  {
+    std::lock_guard<std::mutex> buffersGuard(this->buffersLock);
+    for (auto buffer : this->buffers) {
+      std::lock_guard<std::mutex> guard(buffer->lock);
+      std::move(buffer->chunks.begin(),
+                buffer->chunks.end(),
+                std::back_inserter(chunks));
+      buffer->chunks.clear();
+    }
+  }
+  this->writeChunks(chunks);
+
+  return;
+}
+
+void NoelleBufferedOutput::writeChunks(
+    std::vector<NOELLE_bufferedOutputChunk_t> &chunks) {
+
+  /*
+   * Sort the chunks by iteration.
+   * The chunks of an iteration come from the thread that ran it, in the order
+   * they were written, and the sorting is stable.
+   */
+  std::stable_sort(chunks.begin(),
+                   chunks.end(),
+                   [](const NOELLE_bufferedOutputChunk_t &a,
+                      const NOELLE_bufferedOutputChunk_t &b) -> bool {
+                     if (a.env != b.env) {
+                       return std::less<void *>()(a.env, b.env);
+                     }
+                     return a.iteration < b.iteration;
+                   });
+  for (auto &chunk : chunks) {
+    fwrite(chunk.bytes.data(), 1, chunk.bytes.size(), chunk.stream);
+  }
+
+  return;
+}
+
+NoelleRuntime::NoelleRuntime() {
+  this->maxCores = this->getMaximumNumberOfCores();
+  this->NOELLE_idleCores = maxCores;
+
+  /*
+   * Fetch the number of times threads spin before parking.
+   */
+  this->spinBudget = NOELLE_DEFAULT_SPIN_BUDGET;
+  auto spinBudgetEnvVar = getenv("NOELLE_SPIN_BUDGET");
+  if (spinBudgetEnvVar != nullptr) {
+    this->spinBudget = strtoull(spinBudgetEnvVar, nullptr, 10);
+  }
+
+  /*
+   * Fetch the cost of dispatching DOALL loops if it has been provided.
+   */
+  this->doallDispatchCostOverridden = false;
+  this->doallDispatchCost = 0;
+  auto doallDispatchCostEnvVar = getenv("NOELLE_DOALL_DISPATCH_COST");
+  if (doallDispatchCostEnvVar != nullptr) {
+    this->doallDispatchCostOverridden = true;
+    this->doallDispatchCost = strtoull(doallDispatchCostEnvVar, nullptr, 10);
+  }
+
+  /*
+   * Check whether the number of cores of loops must be selected online.
+   */
+  this->coreTuningEnabled = false;
+  this->coreTuningSamples = NOELLE_CORE_TUNING_DEFAULT_SAMPLES;
+  this->coreTuningPeriod = NOELLE_CORE_TUNING_DEFAULT_PERIOD;
+  auto coreTuningEnvVar = getenv("NOELLE_CORE_TUNING");
+  if (coreTuningEnvVar != nullptr) {
+    this->coreTuningEnabled = (atoi(coreTuningEnvVar) != 0);
+  }
+  auto coreTuningSamplesEnvVar = getenv("NOELLE_CORE_TUNING_SAMPLES");
+  if (coreTuningSamplesEnvVar != nullptr) {
+    this->coreTuningSamples = std::max(atoi(coreTuningSamplesEnvVar), 1);
+  }
+  auto coreTuningPeriodEnvVar = getenv("NOELLE_CORE_TUNING_PERIOD");
+  if (coreTuningPeriodEnvVar != nullptr) {
+    this->coreTuningPeriod = strtoull(coreTuningPeriodEnvVar, nullptr, 10);
+  }
+  this->coreTuningObjective = NOELLE_CORE_TUNING_TIME;
+  auto coreTuningObjectiveEnvVar = getenv("NOELLE_CORE_TUNING_OBJECTIVE");
+  if (coreTuningObjectiveEnvVar != nullptr) {
+    std::string objective{ coreTuningObjectiveEnvVar };
+    if (objective == "edp") {
+      this->coreTuningObjective = NOELLE_CORE_TUNING_ENERGY_DELAY;
+    } else if (objective != "time") {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = core tuning objective \"%s\" does "
+              "not exist\n",
+              coreTuningObjectiveEnvVar);
+      abort();
+    }
+  }
+  if (true && this->coreTuningEnabled
+      && (this->coreTuningObjective == NOELLE_CORE_TUNING_ENERGY_DELAY)
+      && !energyMeter.isAvailable()) {
+    fprintf(stderr,
+            "NOELLE: Runtime: WARNING = the energy counters cannot be read, "
+            "so the cores are selected on time only\n");
+    this->coreTuningObjective = NOELLE_CORE_TUNING_TIME;
+  }
+  this->coreTuningJoins = false;
+  auto coreTuningJoinsEnvVar = getenv("NOELLE_CORE_TUNING_JOINS");
+  if (coreTuningJoinsEnvVar != nullptr) {
+    this->coreTuningJoins = (atoi(coreTuningJoinsEnvVar) != 0);
+  }
+  auto coreTuningFileEnvVar = getenv("NOELLE_CORE_TUNING_FILE");
+  if (true && this->coreTuningEnabled && (coreTuningFileEnvVar != nullptr)) {
+    this->coreTuningFile = coreTuningFileEnvVar;
+    this->loadCoreModels();
+  }
+
+  /*
+   * Fetch the policy for nested parallel regions.
+   */
+  this->nestingPolicy = NOELLE_NESTING_HIERARCHICAL;
+  auto nestingPolicyEnvVar = getenv("NOELLE_NESTING_POLICY");
+  if (nestingPolicyEnvVar != nullptr) {
+    std::string policy{ nestingPolicyEnvVar };
+    if (policy == "serialize") {
+      this->nestingPolicy = NOELLE_NESTING_SERIALIZE;
+    } else if (policy == "split") {
+      this->nestingPolicy = NOELLE_NESTING_SPLIT;
+    } else if (policy == "hierarchical") {
+      this->nestingPolicy = NOELLE_NESTING_HIERARCHICAL;
+    } else {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = nesting policy \"%s\" does not "
+              "exist\n",
+              nestingPolicyEnvVar);
+      abort();
+    }
+  }
+
+  /*
+   * Fetch the threading runtime of the program NOELLE must share the cores
+   * with.
+   */
+  this->hostOpenMPEnabled = false;
+  auto hostRuntimeEnvVar = getenv("NOELLE_HOST_RUNTIME");
+  if (hostRuntimeEnvVar != nullptr) {
+    std::string hostRuntime{ hostRuntimeEnvVar };
+    if (hostRuntime == "openmp") {
+      this->hostOpenMPEnabled = true;
+      if (omp_in_parallel == nullptr) {
+        fprintf(stderr,
+                "NOELLE: Runtime: WARNING = the program does not link an "
+                "OpenMP runtime\n");
+        this->hostOpenMPEnabled = false;
+      }
+    } else if (hostRuntime != "none") {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = host runtime \"%s\" does not "
+              "exist\n",
+              hostRuntimeEnvVar);
+      abort();
+    }
+  }
+
+  /*
+   * Check whether HELIX helper threads are enabled.
+   */
+  this->helixHelperEnabled = false;
+  this->helixHelperSamplingPeriod = NOELLE_HELIX_HELPER_DEFAULT_SAMPLING_PERIOD;
+  auto helixHelperEnvVar = getenv("NOELLE_HELIX_HELPER");
+  if (helixHelperEnvVar != nullptr) {
+    this->helixHelperEnabled = (atoi(helixHelperEnvVar) != 0);
+  }
+  auto helixHelperSamplingEnvVar = getenv("NOELLE_HELIX_HELPER_SAMPLING");
+  if (helixHelperSamplingEnvVar != nullptr) {
+    this->helixHelperSamplingPeriod =
+        strtoull(helixHelperSamplingEnvVar, nullptr, 10);
+  }
+  for (auto i = 0; i < 2; i++) {
+    this->helixInvocations[i] = 0;
+    this->helixWaits[i] = 0;
+    this->helixWaitCycles[i] = 0;
+  }
+
+  /*
+   * Check whether HELIX critical sections run as hardware transactions.
+   */
+  this->helixTransactionsEnabled = false;
+  auto helixTransactionsEnvVar = getenv("NOELLE_HELIX_HTM");
+  if (true && (helixTransactionsEnvVar != nullptr)
+      && (atoi(helixTransactionsEnvVar) != 0)) {
+#if defined(__x86_64__)
+    uint32_t eax, ebx, ecx, edx;
+    if (true && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)
+        && ((ebx & (1 << 11)) != 0)) {
+      this->helixTransactionsEnabled = true;
+    }
+#endif
+    if (!this->helixTransactionsEnabled) {
+      fprintf(stderr,
+              "NOELLE: Runtime: WARNING = the CPU does not support hardware "
+              "transactions, so HELIX critical sections use their locks\n");
+    }
+  }
+
+  /*
+   * Check whether sequential loops run with their helper prefetchers.
+   */
+  this->prefetcherEnabled = true;
+  this->prefetcherDistance = NOELLE_PREFETCHER_DEFAULT_DISTANCE;
+  auto prefetcherEnvVar = getenv("NOELLE_PREFETCHER");
+  if (prefetcherEnvVar != nullptr) {
+    this->prefetcherEnabled = (atoi(prefetcherEnvVar) != 0);
+  }
+  auto prefetcherDistanceEnvVar = getenv("NOELLE_PREFETCHER_DISTANCE");
+  if (prefetcherDistanceEnvVar != nullptr) {
+    this->prefetcherDistance = atoll(prefetcherDistanceEnvVar);
+    if (this->prefetcherDistance < 1) {
+      this->prefetcherDistance = 1;
+    }
+  }
+
+  /*
+   * Fetch how deep tasks of recursive functions can be spawned.
+   * By default, this is enough to give a task to every core, plus a few levels
+   * to balance the load.
+   */
+  this->taskSpawnDepth = NOELLE_TASK_SPAWN_DEPTH_SLACK;
+  for (auto cores = 1u; cores < this->maxCores; cores *= 2) {
+    this->taskSpawnDepth++;
+  }
+  auto taskSpawnDepthEnvVar = getenv("NOELLE_TASK_SPAWN_DEPTH");
+  if (taskSpawnDepthEnvVar != nullptr) {
+    this->taskSpawnDepth = strtoul(taskSpawnDepthEnvVar, nullptr, 10);
+  }
+
+  /*
+   * Check whether DSWP stages must be placed on cores that share caches.
+   */
+  this->dswpPlacementEnabled = false;
+  auto dswpPlacementEnvVar = getenv("NOELLE_DSWP_PLACEMENT");
+  if (dswpPlacementEnvVar != nullptr) {
+    std::string placement{ dswpPlacementEnvVar };
+    if (placement == "compact") {
+      this->dswpPlacementEnabled = true;
+    } else if (placement != "none") {
+      fprintf(stderr,
+              "NOELLE: Runtime: ERROR = DSWP placement \"%s\" does not "
+              "exist\n",
+              dswpPlacementEnvVar);
+      abort();
+    }
+  }
+
+  /*
+   * Check whether consecutive DSWP stages can share a thread when the region
+   * gets fewer cores than stages.
+   */
+  this->dswpStageFusionEnabled = true;
+  auto dswpStageFusionEnvVar = getenv("NOELLE_DSWP_STAGE_FUSION");
+  if (dswpStageFusionEnvVar != nullptr) {
+    this->dswpStageFusionEnabled = (atoi(dswpStageFusionEnvVar) != 0);
+  }
+
+  /*
+   * Check whether DOALL tasks must run on the same pinned threads across
+   * invocations.
+   */
+  this->doallAffinityEnabled = false;
+  auto doallAffinityEnvVar = getenv("NOELLE_DOALL_AFFINITY");
+  if (doallAffinityEnvVar != nullptr) {
+    this->doallAffinityEnabled = (atoi(doallAffinityEnvVar) != 0);
+  }
+
+  /*
+   * Compute the topology of the machine if needed.
+   */
+  if (false || this->helixHelperEnabled || this->dswpPlacementEnabled
+      || this->doallAffinityEnabled) {
+    this->computeHyperthreads();
+  }
+  if (this->dswpPlacementEnabled) {
+    this->computeDSWPStageCores();
+  }
+
+  pthread_spin_init(&this->spinLock, 0);
+  pthread_spin_init(&this->cachedMemoryLock, 0);
+  pthread_spin_init(&this->dswpQueuesLock, 0);
+  pthread_spin_init(&this->privateCopiesLock, 0);
+  pthread_spin_init(&this->doallCostsLock, 0);
+  pthread_spin_init(&this->doallInspectionsLock, 0);
+  pthread_spin_init(&this->coreModelsLock, 0);
+
+  /*
+   * Allocate the thread pool
+   */
+  this->threadPool = new NoelleThreadPool(maxCores);
+
+  return;
+}
+
+DOALL_args_t *NoelleRuntime::getDOALLArgs(uint32_t cores, uint32_t *index) {
+
+  /*
+   * Fetch the memory.
+   */
+  auto argsForAllCores = (DOALL_args_t *)this->getCachedMemory(
+      sizeof(DOALL_args_t) * cores,
+      index);
+
+  /*
+   * Initialize the memory.
+   * The block might have been used by a different parallelized loop.
+   */
+  for (auto i = 0; i < cores; ++i) {
+    auto argsPerCore = &argsForAllCores[i];
+    argsPerCore->coreID = i;
+  }
+
+  return argsForAllCores;
+}
+
+void NoelleRuntime::releaseDOALLArgs(uint32_t index) {
+  this->releaseCachedMemory(index);
+  return;
+}
+
+void *NoelleRuntime::getCachedMemory(uint64_t bytes, uint32_t *index) {
+  void *memory = nullptr;
+
+  /*
+   * Check if we can reuse a previously-allocated memory region.
+   */
+  pthread_spin_lock(&this->cachedMemoryLock);
+  auto cachedMemoryNumberOfChunks = this->cachedMemoryAvailability.size();
+  for (auto i = 0; i < cachedMemoryNumberOfChunks; i++) {
+    auto currentSize = this->cachedMemorySizes[i];
+    if (true && (this->cachedMemoryAvailability[i]) && (currentSize >= bytes)) {
+
+      /*
+       * Found a memory block that can be reused.
+       */
+      memory = this->cachedMemory[i];
+
+      /*
+       * Set the block as in use.
+       */
+      this->cachedMemoryAvailability[i] = false;
+      (*index) = i;
+      pthread_spin_unlock(&this->cachedMemoryLock);
+
+      return memory;
+    }
+  }
+
+  /*
+   * We couldn't find anything available.
+   *
+   * Allocate a new memory region.
+   */
+  memory = runtimeMemory.allocate(bytes);
+  this->cachedMemorySizes.push_back(bytes);
+  this->cachedMemoryAvailability.push_back(false);
+  this->cachedMemory.push_back(memory);
+  pthread_spin_unlock(&this->cachedMemoryLock);
+
+  /*
+   * Set the index.
+   */
+  (*index) = cachedMemoryNumberOfChunks;
+
+  return memory;
+}
+
+void NoelleRuntime::releaseCachedMemory(uint32_t index) {
+  pthread_spin_lock(&this->cachedMemoryLock);
+  this->cachedMemoryAvailability[index] = true;
+  pthread_spin_unlock(&this->cachedMemoryLock);
+  return;
+}
+
+void *NoelleRuntime::getDSWPQueue(int64_t queueSize) {
+
+  /*
+   * Check if the values of the queue have been packed into another queue.
+   */
+  if (queueSize == 0) {
+    return nullptr;
+  }
+
+  /*
+   * Check if we can reuse a queue released by a previous invocation.
+   */
+  pthread_spin_lock(&this->dswpQueuesLock);
+  auto &queues = this->dswpQueues[queueSize];
+  if (queues.size() > 0) {
+    auto queue = queues.back();
+    queues.pop_back();
+    pthread_spin_unlock(&this->dswpQueuesLock);
+
+    return queue;
+  }
+  pthread_spin_unlock(&this->dswpQueuesLock);
+
+  /*
+   * Allocate a new queue.
+   */
+  return NOELLE_allocateDSWPQueue(queueSize);
+}
+
+void NoelleRuntime::releaseDSWPQueue(void *queue, int64_t queueSize) {
+  if (queue == nullptr) {
+    return;
+  }
+
+  pthread_spin_lock(&this->dswpQueuesLock);
+  this->dswpQueues[queueSize].push_back(queue);
+  pthread_spin_unlock(&this->dswpQueuesLock);
+
+  return;
+}
+
+void *NoelleRuntime::getPrivateCopy(int64_t bytes) {
+
+  /*
+   * Check if we can reuse a copy released by a previous task.
+   */
+  pthread_spin_lock(&this->privateCopiesLock);
+  auto &copies = this->privateCopies[bytes];
+  if (copies.size() > 0) {
+    auto copy = copies.back();
+    copies.pop_back();
+    pthread_spin_unlock(&this->privateCopiesLock);
+
+    return copy;
+  }
+  pthread_spin_unlock(&this->privateCopiesLock);
+
+  /*
+   * Allocate a new copy.
+   */
+  return runtimeMemory.allocate(bytes);
+}
+
+void NoelleRuntime::releasePrivateCopy(void *copy, int64_t bytes) {
+  pthread_spin_lock(&this->privateCopiesLock);
+  this->privateCopies[bytes].push_back(copy);
+  pthread_spin_unlock(&this->privateCopiesLock);
+
+  return;
+}
+
+static void NOELLE_emptyDOALLTask(void *env,
+                                  int64_t coreID,
+                                  int64_t numCores,
+                                  int64_t chunkSize) {
+  return;
+}
+
+uint64_t NoelleRuntime::getDOALLDispatchCost(void) {
+
+  /*
+   * Calibrate the cost the first time it is needed.
+   * We keep the cheapest dispatch to filter out noise (e.g., page faults).
+   */
+  std::call_once(this->doallDispatchCostCalibration, [this]() {
+    if (this->doallDispatchCostOverridden) {
+      return;
+    }
+    auto cheapestDispatch = UINT64_MAX;
+    for (auto i = 0; i < NOELLE_DOALL_DISPATCH_CALIBRATION_RUNS; i++) {
+      auto startCycles = NOELLE_getCycles();
+      NOELLE_DOALLDispatcherImpl(NOELLE_emptyDOALLTask,
+                                 nullptr,
+                                 this->maxCores,
+                                 1,
+                                 NOELLE_DOALL_STATIC_SCHEDULING,
+                                 0,
+                                 nullptr);
+      auto cycles = NOELLE_getCycles() - startCycles;
+      cheapestDispatch = std::min(cheapestDispatch, cycles);
+    }
+    this->doallDispatchCost = cheapestDispatch;
+  });
+
+  return this->doallDispatchCost;
+}
+
+bool NoelleRuntime::getDOALLCyclesPerIteration(void *loop, double *cycles) {
+  auto found = false;
+
+  pthread_spin_lock(&this->doallCostsLock);
+  auto loopIt = this->doallCyclesPerIteration.find(loop);
+  if (loopIt != this->doallCyclesPerIteration.end()) {
+    (*cycles) = loopIt->second;
+    found = true;
+  }
+  pthread_spin_unlock(&this->doallCostsLock);
+
+  return found;
+}
+
+void NoelleRuntime::setDOALLCyclesPerIteration(void *loop, double cycles) {
+  pthread_spin_lock(&this->doallCostsLock);
+  this->doallCyclesPerIteration[loop] = cycles;
+  pthread_spin_unlock(&this->doallCostsLock);
+  return;
+}
+
+std::shared_ptr<const NoelleInspection_t> NoelleRuntime::getDOALLInspection(
+    void *loop) {
+  std::shared_ptr<const NoelleInspection_t> inspection;
+
+  pthread_spin_lock(&this->doallInspectionsLock);
+  auto loopIt = this->doallInspections.find(loop);
+  if (loopIt != this->doallInspections.end()) {
+    inspection = loopIt->second;
+  }
+  pthread_spin_unlock(&this->doallInspectionsLock);
+
+  return inspection;
+}
+
+void NoelleRuntime::setDOALLInspection(
+    void *loop,
+    std::shared_ptr<const NoelleInspection_t> inspection) {
+  pthread_spin_lock(&this->doallInspectionsLock);
+  this->doallInspections[loop] = std::move(inspection);
+  pthread_spin_unlock(&this->doallInspectionsLock);
+  return;
+}
+
+bool NoelleRuntime::isCoreTuningEnabled(void) const {
+  return this->coreTuningEnabled;
+}
+
+void NoelleRuntime::getTunedInvocation(void *loop,
+                                       uint32_t maxNumberOfCores,
+                                       NoelleTunedInvocation_t *invocation) {
+  pthread_spin_lock(&this->coreModelsLock);
+  auto &model = this->coreModels[loop];
+
+  /*
+   * Start the selection if the loop has never been invoked with the current
+   * maximum number of cores, or if the choices are too old.
+   */
+  if (false || (model.maxCores != maxNumberOfCores)
+      || (true && model.isSelected
+          && (model.invocationsSinceSelection >= this->coreTuningPeriod))) {
+    model.maxCores = maxNumberOfCores;
+    model.candidateCores = maxNumberOfCores;
+    model.bestCores = maxNumberOfCores;
+    model.bestCost = 0;
+    model.candidateCost = 0;
+    model.samples = 0;
+    model.invocationsSinceSelection = 0;
+    model.isSelected = false;
+    model.parks = false;
+    model.isTuningJoins = false;
+  }
+
+  /*
+   * Fetch the choices to use.
+   */
+  if (model.isSelected) {
+    model.invocationsSinceSelection++;
+    invocation->cores = model.bestCores;
+    invocation->parks = model.parks;
+    invocation->measure = false;
+  } else {
+    invocation->cores = model.candidateCores;
+    invocation->parks = model.isTuningJoins;
+    invocation->measure = true;
+  }
+  pthread_spin_unlock(&this->coreModelsLock);
+
+  return;
+}
+
+void NoelleRuntime::recordTunedInvocation(
+    void *loop,
+    NoelleTunedInvocation_t const &invocation,
+    uint32_t threadsUsed,
+    uint64_t cycles,
+    double joules,
+    uint64_t work) {
+  pthread_spin_lock(&this->coreModelsLock);
+  auto &model = this->coreModels[loop];
+
+  /*
+   * Only invocations that ran with the candidate choices measure them.
+   * Invocations might get fewer cores than requested when other parallel
+   * regions are running.
+   */
+  if (false || model.isSelected || (invocation.cores != model.candidateCores)
+      || (invocation.parks != model.isTuningJoins)
+      || (threadsUsed != invocation.cores)) {
+    pthread_spin_unlock(&this->coreModelsLock);
+    return;
+  }
+
+  /*
+   * Compute the cost of the invocation per unit of work.
+   * Keep the cheapest invocation as it is the least perturbed by noise.
+   */
+  auto units = (double)std::max(work, (uint64_t)1);
+  auto cost = ((double)cycles) / units;
+  if (this->coreTuningObjective == NOELLE_CORE_TUNING_ENERGY_DELAY) {
+    cost *= joules / units;
+  }
+  if (false || (model.samples == 0) || (cost < model.candidateCost)) {
+    model.candidateCost = cost;
+  }
+  model.samples++;
+  if (model.samples < this->coreTuningSamples) {
+    pthread_spin_unlock(&this->coreModelsLock);
+    return;
+  }
+
+  /*
+   * The candidate has been measured.
+   * Check whether it is not worse than the best choices found so far.
+   */
+  auto isFirst = (true && (model.candidateCores == model.maxCores)
+                  && !model.isTuningJoins);
+  auto isBetter =
+      (false || isFirst
+       || (model.candidateCost
+           <= (model.bestCost * (100 + NOELLE_CORE_TUNING_TOLERANCE) / 100)));
+  if (model.isTuningJoins) {
+
+    /*
+     * Select whether joins park.
+     */
+    model.parks = isBetter;
+    model.isSelected = true;
+    model.invocationsSinceSelection = 0;
+    pthread_spin_unlock(&this->coreModelsLock);
+    return;
+  }
+  if (isBetter) {
+    model.bestCores = model.candidateCores;
+    if (isFirst || (model.candidateCost < model.bestCost)) {
+      model.bestCost = model.candidateCost;
+    }
+  }
+
+  /*
+   * Try half the cores.
+   * Otherwise, try joins that park on the best cores, or select them.
+   */
+  model.candidateCost = 0;
+  model.samples = 0;
+  if (true && isBetter && (model.candidateCores > 1)) {
+    model.candidateCores /= 2;
+  } else if (this->coreTuningJoins) {
+    model.candidateCores = model.bestCores;
+    model.isTuningJoins = true;
+  } else {
+    model.isSelected = true;
+    model.invocationsSinceSelection = 0;
+  }
+  pthread_spin_unlock(&this->coreModelsLock);
+
+  return;
+}
+
+bool NoelleRuntime::isCoreTuningMeasuringEnergy(void) const {
+  return this->coreTuningObjective == NOELLE_CORE_TUNING_ENERGY_DELAY;
+}
+
+uint64_t NoelleRuntime::getJoinSpinBudget(void) const {
+  if (currentJoinParks) {
+    return 0;
+  }
+
+  return this->spinBudget;
+}
+
+/*
+ * Loops are identified in the file of the choices of the cores by their
+ * offset from the runtime, which is linked in the same binary. The file
+ * starts with the executable that generated it, its size, and its time of
+ * modification; files of other executables (or of other builds of the same
+ * one) are ignored.
+ */
+static bool NOELLE_getExecutableIdentity(std::string *identity) {
+  char path[4096];
+  auto length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (length <= 0) {
+    return false;
+  }
+  path[length] = '\0';
+  struct stat executable;
+  if (stat(path, &executable) != 0) {
+    return false;
+  }
+  char sizeAndTime[64];
+  snprintf(sizeAndTime,
+           sizeof(sizeAndTime),
+           " %lld %lld",
+           (long long)executable.st_size,
+           (long long)executable.st_mtime);
+  identity->assign(path);
+  identity->append(sizeAndTime);
+
+  return true;
+}
+
+void NoelleRuntime::loadCoreModels(void) {
+  auto file = fopen(this->coreTuningFile.c_str(), "r");
+  if (file == nullptr) {
+    return;
+  }
+
+  /*
+   * Check the file has been generated by this executable.
+   */
+  std::string identity;
+  char header[4200];
+  if (false || !NOELLE_getExecutableIdentity(&identity)
+      || (fgets(header, sizeof(header), file) == nullptr)
+      || (identity.compare(0, std::string::npos, header, strcspn(header, "\n"))
+          != 0)) {
+    fclose(file);
+    return;
+  }
+
+  /*
+   * Load the choices of the loops.
+   */
+  auto base = (uint8_t *)&NOELLE_DOALLDispatcher;
+  long long offset;
+  unsigned maxCores, cores;
+  int parks;
+  while (fscanf(file, "%lld %u %u %d", &offset, &maxCores, &cores, &parks)
+         == 4) {
+    auto &model = this->coreModels[(void *)(base + offset)];
+    model.maxCores = maxCores;
+    model.candidateCores = cores;
+    model.bestCores = cores;
+    model.parks = (parks != 0);
+    model.isTuningJoins = false;
+    model.isSelected = true;
+    model.invocationsSinceSelection = 0;
+  }
+  fclose(file);
+
+  return;
+}
+
+void NoelleRuntime::saveCoreModels(void) {
+  std::string identity;
+  if (!NOELLE_getExecutableIdentity(&identity)) {
+    return;
+  }
+  auto file = fopen(this->coreTuningFile.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr,
+            "NOELLE: Runtime: WARNING = the choices of the cores cannot be "
+            "saved in \"%s\"\n",
+            this->coreTuningFile.c_str());
+    return;
+  }
+  fprintf(file, "%s\n", identity.c_str());
+  auto base = (uint8_t *)&NOELLE_DOALLDispatcher;
+  pthread_spin_lock(&this->coreModelsLock);
+  for (auto &loopAndModel : this->coreModels) {
+    auto &model = loopAndModel.second;
+    if (!model.isSelected) {
+      continue;
+    }
+    fprintf(file,
+            "%lld %u %u %d\n",
+            (long long)(((uint8_t *)loopAndModel.first) - base),
+            model.maxCores,
+            model.bestCores,
+            model.parks ? 1 : 0);
+  }
+  pthread_spin_unlock(&this->coreModelsLock);
+  fclose(file);
 
-#ifdef RUNTIME_PROFILE
-    clocks_dispatch_starts[i] = rdtsc_s();
-#endif
+  return;
+}
+
+uint64_t NoelleRuntime::getSpinBudget(void) const {
+  return this->spinBudget;
+}
+
+uint32_t NoelleRuntime::reserveCores(uint32_t coresRequested) {
+
+  /*
+   * Reserve the number of cores available.
+   */
+  pthread_spin_lock(&this->spinLock);
+  auto numCores = (this->NOELLE_idleCores >= coresRequested) ? coresRequested
+                                                             : NOELLE_idleCores;
+  if (numCores < 1) {
+    numCores = 1;
+  }
+
+  /*
+   * Lease the cores from the arbiter of the node if there is one.
+   * The core of the caller is always leased.
+   */
+  if (coreArbiter.isEnabled()) {
+    numCores = coreArbiter.lease(numCores, 1);
+  }
+  this->NOELLE_idleCores -= numCores;
+  pthread_spin_unlock(&this->spinLock);
+
+  return numCores;
+}
+
+uint32_t NoelleRuntime::reserveIdleCores(uint32_t coresRequested) {
+
+  /*
+   * Reserve the cores that are idle, if any.
+   */
+  pthread_spin_lock(&this->spinLock);
+  uint32_t numCores = 0;
+  if (this->NOELLE_idleCores > 0) {
+    numCores = std::min(coresRequested, (uint32_t)this->NOELLE_idleCores);
+  }
+  if (true && (numCores > 0) && coreArbiter.isEnabled()) {
+    numCores = coreArbiter.lease(numCores, 0);
+  }
+  this->NOELLE_idleCores -= numCores;
+  pthread_spin_unlock(&this->spinLock);
+
+  return numCores;
+}
+
+uint32_t NoelleRuntime::enterParallelRegion(uint32_t coresRequested,
+                                            uint32_t *coresReserved,
+                                            uint32_t *nestedCoreBudget) {
+
+  /*
+   * Check if the region is nested in a task of another region.
+   */
+  uint32_t numCores;
+  uint32_t coreBudget;
+  if (currentNestedCoreBudget == 0) {
 
     /*
-     * Submit
+     * The region is not nested.
+     * If it is invoked by a parallel region of the OpenMP runtime of the
+     * program, then the cores belong to the threads of the latter.
      */
-    virgil->submitAndDetach(NOELLE_DOALLTrampoline, argsPerCore);
+    if (true && this->hostOpenMPEnabled && omp_in_parallel()) {
+      coresRequested = 1;
+    }
+    numCores = this->reserveCores(coresRequested);
+    (*coresReserved) = numCores;
+    coreBudget = this->maxCores;
 
-#ifdef RUNTIME_PROFILE
-    clocks_dispatch_ends[i] = rdtsc_s();
-#endif
-#ifdef RUNTIME_PRINT
-    std::cerr << "Submitted DOALL task on core " << i << std::endl;
-#endif
+  } else {
+
+    /*
+     * Apply the nesting policy.
+     */
+    coreBudget = currentNestedCoreBudget;
+    switch (this->nestingPolicy) {
+      case NOELLE_NESTING_SERIALIZE:
+        coresRequested = 1;
+        break;
+      case NOELLE_NESTING_SPLIT:
+        coresRequested = std::min(coresRequested, coreBudget);
+        break;
+    }
+
+    /*
+     * The core of the caller already belongs to the enclosing region.
+     * Hence, we only reserve the additional cores.
+     */
+    uint32_t additionalCores = 0;
+    if (coresRequested > 1) {
+      additionalCores = this->reserveIdleCores(coresRequested - 1);
+    }
+    (*coresReserved) = additionalCores;
+    numCores = additionalCores + 1;
   }
-#ifdef RUNTIME_PRINT
-  std::cerr << "Submitted pool" << std::endl;
-#endif
-#ifdef RUNTIME_PROFILE
-  auto clocks_after_fork = rdtsc_e();
-#endif
 
   /*
-   * Run a task.
+   * Compute the budget of the tasks of the region for their nested regions.
    */
-  parallelizedLoop(env, numCores - 1, numCores, chunkSize);
+  if (this->nestingPolicy == NOELLE_NESTING_SPLIT) {
+    coreBudget = std::max(coreBudget / numCores, (uint32_t)1);
+  }
+  (*nestedCoreBudget) = std::max(coreBudget, (uint32_t)1);
 
-/*
- * Wait for the remaining DOALL tasks.
- */
-#ifdef RUNTIME_PROFILE
-  auto clocks_before_join = rdtsc_s();
-#endif
-  for (auto i = 0; i < (numCores - 1); ++i) {
-    pthread_spin_lock(&(argsForAllCores[i].endLock));
+  return numCores;
+}
+
+void NoelleRuntime::exitParallelRegion(uint32_t coresReserved) {
+  if (coresReserved > 0) {
+    this->releaseCores(coresReserved);
+  }
+
+  return;
+}
+
+void NoelleRuntime::releaseCores(uint32_t coresReleased) {
+  assert(coresReleased > 0);
+
+  pthread_spin_lock(&this->spinLock);
+  this->NOELLE_idleCores += coresReleased;
+  if (coreArbiter.isEnabled()) {
+    coreArbiter.release(coresReleased);
+  }
+#ifdef DEBUG
+  if (this->NOELLE_idleCores >= 0) {
+    assert(this->NOELLE_idleCores <= ((uint32_t)this->maxCores));
   }
-#ifdef RUNTIME_PRINT
-  std::cerr << "All tasks completed" << std::endl;
-#endif
-#ifdef RUNTIME_PROFILE
-  auto clocks_after_join = rdtsc_e();
-  auto clocks_before_cleanup = rdtsc_s();
 #endif
+  pthread_spin_unlock(&this->spinLock);
+
+  return;
+}
+
+uint32_t NoelleRuntime::getMaximumNumberOfCores(void) {
+  static int cores = 0;
 
   /*
-   * Free the cores and memory.
+   * Check if we have already computed the number of cores.
    */
-  runtime.releaseCores(numCores);
-  runtime.releaseDOALLArgs(doallMemoryIndex);
+  if (cores == 0) {
+
+    /*
+     * Compute the number of cores.
+     */
+    auto envVar = getenv("NOELLE_CORES");
+    if (envVar == nullptr) {
+
+      /*
+       * The thread that invokes a parallelized loop takes a physical core.
+       */
+      auto physicalCores = topology.getNumberOfUsablePhysicalCores();
+      cores = (physicalCores > 1) ? (physicalCores - 1) : 1;
+    } else {
+      cores = atoi(envVar);
+    }
+  }
+
+  return cores;
+}
+
+bool NoelleRuntime::isHELIXHelperEnabled(void) const {
+  return this->helixHelperEnabled;
+}
+
+bool NoelleRuntime::isHELIXTransactionalMemoryEnabled(void) const {
+  return this->helixTransactionsEnabled;
+}
+
+bool NoelleRuntime::shouldUseHELIXHelper(void) {
 
   /*
-   * Prepare the return value.
+   * Check if the current invocation is a sample without helper threads.
    */
-  DispatcherInfo dispatcherInfo;
-  dispatcherInfo.numberOfThreadsUsed = numCores;
-#ifdef RUNTIME_PROFILE
-  auto clocks_after_cleanup = rdtsc_s();
-  pthread_spin_lock(&printLock);
-  std::cerr << "XAN: Start         = " << clocks_start << "\n";
-  std::cerr
-      << "XAN: Setup overhead         = " << clocks_after_fork - clocks_start
-      << " clocks\n";
-  uint64_t totalDispatch = 0;
-  for (auto i = 0; i < (numCores - 1); i++) {
-    totalDispatch += (clocks_dispatch_ends[i] - clocks_dispatch_starts[i]);
-  }
-  std::cerr << "XAN:    Dispatch overhead         = " << totalDispatch
-            << " clocks\n";
-  std::cerr << "XAN: Start joining = " << clocks_after_fork << "\n";
-  for (auto i = 0; i < (numCores - 1); i++) {
-    std::cerr << "Thread " << i << ": Start = " << clocks_starts[i] << "\n";
-    std::cerr << "Thread " << i << ": End   = " << clocks_ends[i] << "\n";
-    std::cerr << "Thread " << i
-              << ": Delta = " << clocks_ends[i] - clocks_starts[i] << "\n";
-  }
-  std::cerr << "XAN: Joined        = " << clocks_after_join << "\n";
-  std::cerr << "XAN: Joining delta = " << clocks_after_join - clocks_before_join
-            << "\n";
-
-  uint64_t start_min = 0;
-  uint64_t start_max = 0;
-  for (auto i = 0; i < (numCores - 1); i++) {
-    if (false || (start_min == 0) || (clocks_starts[i] < start_min)) {
-      start_min = clocks_starts[i];
-    }
-    if (clocks_starts[i] > start_max) {
-      start_max = clocks_starts[i];
-    }
-  }
-  std::cerr << "XAN: Thread starts min = " << start_min << "\n";
-  std::cerr << "XAN: Thread starts max = " << start_max << "\n";
-  std::cerr << "XAN: Task starting overhead = " << start_max - start_min
-            << "\n";
-
-  uint64_t end_max = 0;
-  uint64_t lastThreadID = 0;
-  for (auto i = 0; i < (numCores - 1); i++) {
-    if (clocks_ends[i] > end_max) {
-      lastThreadID = i;
-      end_max = clocks_ends[i];
-    }
-  }
-  std::cerr << "XAN: Last thread ended = " << end_max << " (thread "
-            << lastThreadID << ")\n";
-  std::cerr << "XAN: Joining overhead       = " << clocks_after_join - end_max
-            << "\n";
-
-  pthread_spin_unlock(&printLock);
-#endif
+  auto invocations = this->helixInvocations[0].load()
+                     + this->helixInvocations[1].load();
+  auto useHelper = true;
+  if (true && (this->helixHelperSamplingPeriod > 0)
+      && (((invocations + 1) % this->helixHelperSamplingPeriod) == 0)) {
+    useHelper = false;
+  }
+  this->helixInvocations[useHelper ? 1 : 0]++;
 
-  return dispatcherInfo;
+  return useHelper;
 }
 
-#ifdef RUNTIME_PRINT
-void *mySSGlobal = nullptr;
-#endif
+int32_t NoelleRuntime::getHyperthread(uint32_t physicalCoreIndex,
+                                      uint32_t sibling) const {
+  if (this->hyperthreads.size() == 0) {
+    return -1;
+  }
+  auto &physicalCore =
+      this->hyperthreads[physicalCoreIndex % this->hyperthreads.size()];
 
-/**********************************************************************
- *                HELIX
- **********************************************************************/
-typedef struct {
-  void (*parallelizedLoop)(void *,
-                           void *,
-                           void *,
-                           void *,
-                           int64_t,
-                           int64_t,
-                           uint64_t *);
-  void *env;
-  void *loopCarriedArray;
-  void *ssArrayPast;
-  void *ssArrayFuture;
-  uint64_t coreID;
-  uint64_t numCores;
-  uint64_t *loopIsOverFlag;
-  pthread_spinlock_t endLock;
-} NOELLE_HELIX_args_t;
+  return (sibling == 0) ? physicalCore.first : physicalCore.second;
+}
 
-static void NOELLE_HELIXTrampoline(void *args) {
+void NoelleRuntime::addHELIXWaitTime(bool helped,
+                                     uint64_t waits,
+                                     uint64_t cycles) {
+  auto index = helped ? 1 : 0;
+  this->helixWaits[index] += waits;
+  this->helixWaitCycles[index] += cycles;
+
+  return;
+}
+
+void NoelleRuntime::computeHyperthreads(void) {
 
   /*
-   * Fetch the arguments.
+   * Pair the first two allowed logical cores of each physical core.
+   * Physical cores without SMT, or with a single allowed logical core, are
+   * paired with themselves.
+   */
+  for (auto &logicalCores : topology.getPhysicalCores()) {
+    auto core = logicalCores[0];
+    auto sibling = (logicalCores.size() > 1) ? logicalCores[1] : core;
+    this->hyperthreads.push_back(std::make_pair(core, sibling));
+  }
+
+  return;
+}
+
+bool NoelleRuntime::isPrefetcherEnabled(void) const {
+  return this->prefetcherEnabled;
+}
+
+int64_t NoelleRuntime::getPrefetcherDistance(void) const {
+  return this->prefetcherDistance;
+}
+
+uint32_t NoelleRuntime::getTaskSpawnDepth(void) const {
+  return this->taskSpawnDepth;
+}
+
+int32_t NoelleRuntime::getSiblingHyperthread(int32_t logicalCore) {
+  if (logicalCore < 0) {
+    return -1;
+  }
+  for (auto &logicalCores : topology.getPhysicalCores()) {
+    if (std::find(logicalCores.begin(), logicalCores.end(), logicalCore)
+        == logicalCores.end()) {
+      continue;
+    }
+    for (auto sibling : logicalCores) {
+      if (sibling != (uint32_t)logicalCore) {
+        return sibling;
+      }
+    }
+    break;
+  }
+
+  return -1;
+}
+
+bool NoelleRuntime::isDSWPPlacementEnabled(void) const {
+  return this->dswpPlacementEnabled;
+}
+
+int32_t NoelleRuntime::getDSWPStageCore(uint32_t stageID) const {
+  if (this->dswpStageCores.size() == 0) {
+    return -1;
+  }
+
+  return this->dswpStageCores[stageID % this->dswpStageCores.size()];
+}
+
+bool NoelleRuntime::isDSWPStageFusionEnabled(void) const {
+  return this->dswpStageFusionEnabled;
+}
+
+bool NoelleRuntime::isDOALLAffinityEnabled(void) const {
+  return this->doallAffinityEnabled;
+}
+
+int32_t NoelleRuntime::getDOALLWorkerCore(uint32_t workerID) const {
+
+  /*
+   * The thread that invokes a DOALL loop runs its last task, so workers start
+   * from the second physical core.
+   * Workers use the sibling hyperthreads only once every physical core has a
+   * worker.
+   */
+  auto physicalCores = this->hyperthreads.size();
+  if (physicalCores == 0) {
+    return -1;
+  }
+  auto coreIndex = workerID + 1;
+  auto sibling = (coreIndex / physicalCores) % 2;
+
+  return this->getHyperthread(coreIndex % physicalCores, sibling);
+}
+
+void NoelleRuntime::computeDSWPStageCores(void) {
+
+  /*
+   * Identify the last level cache of each physical core.
+   */
+  std::vector<std::pair<uint32_t, uint32_t>> coresByCache;
+  for (auto &physicalCore : this->hyperthreads) {
+    auto core = physicalCore.first;
+    coresByCache.push_back(
+        std::make_pair(topology.getLastLevelCache(core), core));
+  }
+
+  /*
+   * Consecutive stages run on physical cores that share the last level cache.
+   */
+  std::stable_sort(coresByCache.begin(), coresByCache.end());
+  for (auto &cacheAndCore : coresByCache) {
+    this->dswpStageCores.push_back(cacheAndCore.second);
+  }
+
+  return;
+}
+
+void NoelleRuntime::printHELIXHelperReport(void) const {
+  auto withoutHelper = this->helixInvocations[0].load();
+  auto withHelper = this->helixInvocations[1].load();
+  if ((withoutHelper + withHelper) == 0) {
+    return;
+  }
+  fprintf(stderr,
+          "NOELLE: HELIX helper: %llu invocations with helper threads, %llu "
+          "without\n",
+          (unsigned long long)withHelper,
+          (unsigned long long)withoutHelper);
+
+  /*
+   * Estimate the time saved by comparing the average time spent entering a
+   * sequential segment with and without helper threads.
+   */
+  auto waitsWithout = this->helixWaits[0].load();
+  auto waitsWith = this->helixWaits[1].load();
+  if ((waitsWithout == 0) || (waitsWith == 0)) {
+    fprintf(stderr,
+            "NOELLE: HELIX helper: not enough samples to estimate the time "
+            "saved\n");
+    return;
+  }
+  auto averageWithout =
+      ((double)this->helixWaitCycles[0].load()) / waitsWithout;
+  auto averageWith = ((double)this->helixWaitCycles[1].load()) / waitsWith;
+  auto savedCycles = (averageWithout - averageWith) * waitsWith;
+  fprintf(stderr,
+          "NOELLE: HELIX helper: average wait to enter a sequential segment = "
+          "%.1f cycles with helper threads, %.1f cycles without\n",
+          averageWith,
+          averageWithout);
+  fprintf(stderr,
+          "NOELLE: HELIX helper: estimated time saved = %.0f cycles\n",
+          savedCycles);
+
+  return;
+}
+
+NoelleRuntime::~NoelleRuntime(void) {
+  if (this->helixHelperEnabled) {
+    this->printHELIXHelperReport();
+  }
+  if (this->coreTuningFile.size() > 0) {
+    this->saveCoreModels();
+  }
+  delete this->threadPool;
+
+  /*
+   * Dump the telemetry and the trace.
+   * The threads of the pool have terminated, so their buffers are complete.
+   */
+  this->telemetry.dump();
+  this->tracer.dump();
+  this->environments.dump();
+  this->segmentProfiler.dump();
+  this->bufferedOutput.writeAll();
+
+  /*
+   * Free the memory reused across invocations.
+   */
+  for (auto i = 0u; i < this->cachedMemory.size(); i++) {
+    runtimeMemory.release(this->cachedMemory[i], this->cachedMemorySizes[i]);
+  }
+  for (auto &queues : this->dswpQueues) {
+    for (auto queue : queues.second) {
+      NOELLE_freeDSWPQueue(queue, queues.first);
+    }
+  }
+  for (auto &copies : this->privateCopies) {
+    for (auto copy : copies.second) {
+      runtimeMemory.release(copy, copies.first);
+    }
+  }
+}
+
+NoelleCountdownLatch::NoelleCountdownLatch(uint32_t count)
+  : count{ count },
+    released{ count == 0 } {
+
+  return;
+}
+
+void NoelleCountdownLatch::countDown(void) {
+
+  /*
+   * Check if we are the last one.
+   */
+  auto previousCount = this->count.fetch_sub(1, std::memory_order_acq_rel);
+  assert(previousCount > 0);
+  if (previousCount != 1) {
+    return;
+  }
+
+  /*
+   * Release the waiting thread.
+   */
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->released.store(true, std::memory_order_release);
+  this->condition.notify_all();
+
+  return;
+}
+
+void NoelleCountdownLatch::wait(uint64_t spinBudget) {
+
+  /*
+   * Spin.
    */
-  auto HELIX_args = (NOELLE_HELIX_args_t *)args;
+  for (auto i = 0; i < spinBudget; i++) {
+    if (this->released.load(std::memory_order_acquire)) {
+      break;
+    }
+    NOELLE_cpuRelax();
+  }
 
   /*
-   * Invoke
+   * Park.
+   *
+   * Notice that we need to acquire the lock even if the latch has already been
+   * released while spinning. This is because the thread that released it
+   * might still be holding the lock.
    */
-  HELIX_args->parallelizedLoop(HELIX_args->env,
-                               HELIX_args->loopCarriedArray,
-                               HELIX_args->ssArrayPast,
-                               HELIX_args->ssArrayFuture,
-                               HELIX_args->coreID,
-                               HELIX_args->numCores,
-                               HELIX_args->loopIsOverFlag);
+  std::unique_lock<std::mutex> guard(this->lock);
+  this->condition.wait(guard, [this]() -> bool {
+    return this->released.load(std::memory_order_acquire);
+  });
 
-  pthread_spin_unlock(&(HELIX_args->endLock));
   return;
 }
 
-static void HELIX_helperThread(void *ssArray,
-                               uint32_t numOfsequentialSegments,
-                               uint64_t *theLoopIsOver) {
+NoelleTeam::NoelleTeam(uint32_t numberOfWorkers,
+                       uint32_t coresReserved,
+                       uint32_t nestedCoreBudget,
+                       uint64_t spinBudget)
+  : numberOfWorkers{ numberOfWorkers },
+    coresReserved{ coresReserved },
+    nestedCoreBudget{ nestedCoreBudget },
+    spinBudget{ spinBudget },
+    isUsed{ false },
+    task{ nullptr },
+    taskArgs{ nullptr },
+    taskArgsBytes{ 0 },
+    numberOfTasks{ 0 },
+    isStopping{ false },
+    generation{ 0 },
+    arrivals{ 0 } {
+
+  for (auto i = 0; i < numberOfWorkers; i++) {
+    this->workers.push_back({ this, (uint32_t)i });
+  }
 
-  while ((*theLoopIsOver) == 0) {
+  return;
+}
 
-    /*
-     * Prefetch all sequential segment cache lines of the current loop
-     * iteration.
-     */
-    for (auto i = 0; ((*theLoopIsOver) == 0) && (i < numOfsequentialSegments);
-         i++) {
+uint32_t NoelleTeam::getNumberOfWorkers(void) const {
+  return this->numberOfWorkers;
+}
 
-      /*
-       * Fetch the pointer.
-       */
-      auto ptr = (uint64_t *)(((uint64_t)ssArray) + (i * CACHE_LINE_SIZE));
+uint32_t NoelleTeam::getCoresReserved(void) const {
+  return this->coresReserved;
+}
 
-      /*
-       * Prefetch the cache line for the current sequential segment.
-       */
-      while (((*theLoopIsOver) == 0) && ((*ptr) == 0))
-        ;
-    }
+uint32_t NoelleTeam::getNestedCoreBudget(void) const {
+  return this->nestedCoreBudget;
+}
+
+bool NoelleTeam::acquire(void) {
+  if (this->isUsed) {
+    return false;
   }
+  this->isUsed = true;
 
+  return true;
+}
+
+void NoelleTeam::release(void) {
+  this->isUsed = false;
   return;
 }
 
-static DispatcherInfo NOELLE_HELIX_dispatcher(
-    void (*parallelizedLoop)(void *,
-                             void *,
-                             void *,
-                             void *,
-                             int64_t,
-                             int64_t,
-                             uint64_t *),
-    void *env,
-    void *loopCarriedArray,
-    int64_t maxNumberOfCores,
-    int64_t numOfsequentialSegments,
-    bool LIO) {
-#ifdef RUNTIME_PRINT
-  std::cerr << "HELIX: dispatcher: Start" << std::endl;
-  std::cerr << "HELIX: dispatcher:  Number of sequential segments = "
-            << numOfsequentialSegments << std::endl;
-  std::cerr << "HELIX: dispatcher:  Number of cores = " << numCores
-            << std::endl;
-#endif
+void NoelleTeam::start(NoelleThreadPool *threadPool) {
+  for (auto &worker : this->workers) {
+    threadPool->submitAndDetach(NoelleTeam::workerTrampoline, &worker);
+  }
 
-  /*
-   * Assumptions.
-   */
-  assert(parallelizedLoop != NULL);
-  assert(env != NULL);
-  assert(maxNumberOfCores > 1);
+  return;
+}
 
-  /*
-   * Fetch VIRGIL
-   */
-  auto virgil = runtime.virgil;
+void NoelleTeam::run(void (*task)(void *),
+                     void *args,
+                     uint64_t argsBytes,
+                     uint32_t numberOfTasks) {
+  assert(numberOfTasks <= this->numberOfWorkers);
 
   /*
-   * Reserve the cores.
+   * Set the invocation.
+   * All workers are waiting for the next generation, so none of them is
+   * reading these fields.
    */
-  auto numCores = runtime.reserveCores(maxNumberOfCores);
-  assert(numCores >= 1);
+  this->task = task;
+  this->taskArgs = (uint8_t *)args;
+  this->taskArgsBytes = argsBytes;
+  this->numberOfTasks = numberOfTasks;
+
+  this->publish();
+
+  return;
+}
+
+void NoelleTeam::wait(void) {
 
   /*
-   * Allocate the sequential segment arrays.
-   * We need numCores - 1 arrays.
+   * Wait for all workers to arrive at the barrier of the current generation.
    */
-  auto numOfSSArrays = numCores;
-  if (!LIO) {
-    numOfSSArrays = 1;
+  auto expectedArrivals =
+      this->generation.load(std::memory_order_relaxed) * this->numberOfWorkers;
+  uint64_t spins = 0;
+  while (this->arrivals.load(std::memory_order_acquire) != expectedArrivals) {
+    if (spins < this->spinBudget) {
+      NOELLE_cpuRelax();
+      spins++;
+    } else {
+      std::this_thread::yield();
+    }
   }
-  void *ssArrays = NULL;
-  auto ssSize = CACHE_LINE_SIZE;
-  auto ssArraySize = ssSize * numOfsequentialSegments;
-  if (numOfsequentialSegments > 0) {
+
+  return;
+}
+
+void NoelleTeam::stop(void) {
+  this->isStopping = true;
+  this->publish();
+  this->wait();
+
+  return;
+}
+
+void NoelleTeam::publish(void) {
+  this->generation.fetch_add(1, std::memory_order_release);
+  return;
+}
+
+void NoelleTeam::workerTrampoline(void *args) {
+  auto worker = (NoelleTeamWorker_t *)args;
+  worker->team->runWorker(worker->workerID);
+  return;
+}
+
+void NoelleTeam::runWorker(uint32_t workerID) {
+  uint64_t lastGeneration = 0;
+  while (true) {
 
     /*
-     * Allocate the sequential segment arrays.
+     * Wait for the next generation.
+     * Workers yield their core rather than park once they are done spinning.
+     * This keeps the latency of the next invocation low.
      */
-    posix_memalign(&ssArrays, CACHE_LINE_SIZE, ssArraySize * numOfSSArrays);
-    if (ssArrays == NULL) {
-      fprintf(
-          stderr,
-          "HELIX: dispatcher: ERROR = not enough memory to allocate %lld sequential segment arrays\n",
-          (long long)numCores);
-      abort();
+    uint64_t currentGeneration;
+    uint64_t spins = 0;
+    while ((currentGeneration =
+                this->generation.load(std::memory_order_acquire))
+           == lastGeneration) {
+      if (spins < this->spinBudget) {
+        NOELLE_cpuRelax();
+        spins++;
+      } else {
+        std::this_thread::yield();
+      }
     }
+    assert(currentGeneration == (lastGeneration + 1));
+    lastGeneration = currentGeneration;
 
     /*
-     * Initialize the sequential segment arrays.
+     * Check if the team is being destroyed.
+     * The arrival must be the last access to the team.
      */
-    for (auto i = 0; i < numOfSSArrays; i++) {
+    if (this->isStopping) {
+      this->arrivals.fetch_add(1, std::memory_order_release);
+      break;
+    }
 
-      /*
-       * Fetch the current sequential segment array.
-       */
-      auto ssArray = (void *)(((uint64_t)ssArrays) + (i * ssArraySize));
+    /*
+     * Run the task assigned to the current worker, if any.
+     */
+    if (workerID < this->numberOfTasks) {
+      this->task(this->taskArgs + (workerID * this->taskArgsBytes));
+    }
 
-      /*
-       * Initialize the locks.
-       */
-      for (auto lockID = 0; lockID < numOfsequentialSegments; lockID++) {
+    /*
+     * Arrive at the barrier.
+     */
+    this->arrivals.fetch_add(1, std::memory_order_release);
+  }
 
-        /*
-         * Fetch the pointer to the current lock.
-         */
-        auto lock =
-            (pthread_spinlock_t *)(((uint64_t)ssArray) + (lockID * ssSize));
+  return;
+}
 
-        /*
-         * Initialize the lock.
-         */
-        pthread_spin_init(lock, PTHREAD_PROCESS_PRIVATE);
+NoelleTaskDeque::NoelleTaskDeque() : top{ 0 }, bottom{ 0 } {
+  auto initialBuffer = this->allocateBuffer(64);
+  this->buffer.store(initialBuffer, std::memory_order_relaxed);
 
-        /*
-         * If the sequential segment is not for core 0, then we need to lock it.
-         */
-        if (i > 0) {
-          pthread_spin_lock(lock);
-        }
-      }
-    }
-  }
+  return;
+}
 
-#ifdef RUNTIME_PRINT
-  mySSGlobal = ssArrays;
-#endif
+void NoelleTaskDeque::push(NoelleTask_t task) {
+  auto b = this->bottom.load(std::memory_order_relaxed);
+  auto t = this->top.load(std::memory_order_acquire);
+  auto currentBuffer = this->buffer.load(std::memory_order_relaxed);
 
   /*
-   * Allocate the arguments for the cores.
+   * Check if the deque is full.
    */
-  NOELLE_HELIX_args_t *argsForAllCores;
-  posix_memalign((void **)&argsForAllCores,
-                 CACHE_LINE_SIZE,
-                 sizeof(NOELLE_HELIX_args_t) * (numCores - 1));
+  if ((b - t) > (currentBuffer->capacity - 1)) {
+    currentBuffer = this->grow(currentBuffer, b, t);
+  }
 
   /*
-   * Launch threads
+   * Publish the task.
    */
-  uint64_t loopIsOverFlag = 0;
-  cpu_set_t cores;
-  for (auto i = 0; i < (numCores - 1); ++i) {
-#ifdef RUNTIME_PRINT
-    fprintf(stderr, "HelixDispatcher: Creating future for core %d\n", i);
-#endif
+  NoelleTaskDeque::storeTask(currentBuffer, b, task);
+  std::atomic_thread_fence(std::memory_order_release);
+  this->bottom.store(b + 1, std::memory_order_relaxed);
 
-    /*
-     * Identify the past and future sequential segment arrays.
-     */
-    auto pastID = i % numOfSSArrays;
-    auto futureID = (i + 1) % numOfSSArrays;
+  return;
+}
 
-    /*
-     * Fetch the sequential segment array for the current thread.
-     */
-    auto ssArrayPast = (void *)(((uint64_t)ssArrays) + (pastID * ssArraySize));
-    auto ssArrayFuture =
-        (void *)(((uint64_t)ssArrays) + (futureID * ssArraySize));
-#ifdef RUNTIME_PRINT
-    fprintf(stderr,
-            "HelixDispatcher: defined ss past and future arrays: %ld %ld\n",
-            (int *)ssArrayPast - (int *)mySSGlobal,
-            (int *)ssArrayFuture - (int *)mySSGlobal);
-#endif
+bool NoelleTaskDeque::pop(NoelleTask_t *task) {
+  auto b = this->bottom.load(std::memory_order_relaxed) - 1;
+  auto currentBuffer = this->buffer.load(std::memory_order_relaxed);
+  this->bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto t = this->top.load(std::memory_order_relaxed);
 
-    /*
-     * Prepare the arguments.
-     */
-    auto argsPerCore = &argsForAllCores[i];
-    argsPerCore->parallelizedLoop = parallelizedLoop;
-    argsPerCore->env = env;
-    argsPerCore->loopCarriedArray = loopCarriedArray;
-    argsPerCore->ssArrayPast = ssArrayPast;
-    argsPerCore->ssArrayFuture = ssArrayFuture;
-    argsPerCore->coreID = i;
-    argsPerCore->numCores = numCores;
-    argsPerCore->loopIsOverFlag = &loopIsOverFlag;
-    pthread_spin_init(&(argsPerCore->endLock), PTHREAD_PROCESS_PRIVATE);
-    pthread_spin_lock(&(argsPerCore->endLock));
+  /*
+   * Check if the deque is empty.
+   */
+  if (t > b) {
+    this->bottom.store(b + 1, std::memory_order_relaxed);
+    return false;
+  }
 
-    /*
-     * Set the affinity for both the thread and its helper.
-     */
-    /*CPU_ZERO(&cores);
-    auto physicalCore = i * 2;
-    CPU_SET(physicalCore, &cores);
-    CPU_SET(physicalCore + 1, &cores);
-    */
+  /*
+   * Fetch the task.
+   */
+  (*task) = NoelleTaskDeque::loadTask(currentBuffer, b);
+  if (t < b) {
+    return true;
+  }
 
-    /*
-     * Launch the thread.
-     */
-    virgil->submitAndDetach(NOELLE_HELIXTrampoline, argsPerCore);
+  /*
+   * This is the last task of the deque.
+   * Thieves could be trying to steal it.
+   */
+  auto gotTask = this->top.compare_exchange_strong(t,
+                                                   t + 1,
+                                                   std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+  this->bottom.store(b + 1, std::memory_order_relaxed);
 
-    /*
-     * Launch the helper thread.
-     */
-    continue;
-    /*localFutures.push_back(pool.submitToCores(
-      cores,
-      HELIX_helperThread,
-      ssArrayPast,
-      numOfsequentialSegments,
-      &loopIsOverFlag
-    ));*/
+  return gotTask;
+}
+
+bool NoelleTaskDeque::steal(NoelleTask_t *task) {
+  auto t = this->top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto b = this->bottom.load(std::memory_order_acquire);
+
+  /*
+   * Check if the deque is empty.
+   */
+  if (t >= b) {
+    return false;
   }
-#ifdef RUNTIME_PRINT
-  std::cerr << "Submitted pool\n";
-  int futureGotten = 0;
-#endif
 
   /*
-   * Run a task.
+   * Fetch the task and try to claim it.
    */
-  auto pastID = (numCores - 1) % numOfSSArrays;
-  auto futureID = 0;
-  auto ssArrayPast = (void *)(((uint64_t)ssArrays) + (pastID * ssArraySize));
-  auto ssArrayFuture = ssArrays;
-  parallelizedLoop(env,
-                   loopCarriedArray,
-                   ssArrayPast,
-                   ssArrayFuture,
-                   numCores - 1,
-                   numCores,
-                   &loopIsOverFlag);
+  auto currentBuffer = this->buffer.load(std::memory_order_acquire);
+  (*task) = NoelleTaskDeque::loadTask(currentBuffer, t);
+  auto gotTask = this->top.compare_exchange_strong(t,
+                                                   t + 1,
+                                                   std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+
+  return gotTask;
+}
+
+NoelleTaskDeque::Buffer_t *NoelleTaskDeque::allocateBuffer(int64_t capacity) {
+  auto newBuffer = new Buffer_t();
+  newBuffer->capacity = capacity;
+  newBuffer->slots = new Slot_t[capacity];
+
+  return newBuffer;
+}
+
+NoelleTaskDeque::Buffer_t *NoelleTaskDeque::grow(Buffer_t *currentBuffer,
+                                                 int64_t b,
+                                                 int64_t t) {
 
   /*
-   * Wait for the remaining HELIX tasks.
+   * Allocate a buffer twice as big.
    */
-  for (auto i = 0; i < (numCores - 1); ++i) {
-    pthread_spin_lock(&(argsForAllCores[i].endLock));
-  }
-#ifdef RUNTIME_PRINT
-  std::cerr << "Got all futures\n";
-#endif
+  auto newBuffer = this->allocateBuffer(currentBuffer->capacity * 2);
 
   /*
-   * Free the cores and memory.
+   * Copy the tasks that are still in the deque.
    */
-  runtime.releaseCores(numCores);
+  for (auto i = t; i < b; i++) {
+    auto task = NoelleTaskDeque::loadTask(currentBuffer, i);
+    NoelleTaskDeque::storeTask(newBuffer, i, task);
+  }
 
   /*
-   * Free the memory.
+   * Publish the new buffer.
    */
-  free(argsForAllCores);
-  free(ssArrays);
+  this->buffer.store(newBuffer, std::memory_order_release);
+  this->retiredBuffers.push_back(currentBuffer);
 
-  DispatcherInfo dispatcherInfo;
-  dispatcherInfo.numberOfThreadsUsed = numCores;
-  return dispatcherInfo;
+  return newBuffer;
 }
 
-DispatcherInfo NOELLE_HELIX_dispatcher_sequentialSegments(
-    void (*parallelizedLoop)(void *,
-                             void *,
-                             void *,
-                             void *,
-                             int64_t,
-                             int64_t,
-                             uint64_t *),
-    void *env,
-    void *loopCarriedArray,
-    int64_t numCores,
-    int64_t numOfsequentialSegments) {
-  return NOELLE_HELIX_dispatcher(parallelizedLoop,
-                                 env,
-                                 loopCarriedArray,
-                                 numCores,
-                                 numOfsequentialSegments,
-                                 true);
+void NoelleTaskDeque::storeTask(Buffer_t *buffer,
+                                int64_t index,
+                                NoelleTask_t task) {
+  auto slot = &buffer->slots[index % buffer->capacity];
+  slot->function.store(task.function, std::memory_order_relaxed);
+  slot->args.store(task.args, std::memory_order_relaxed);
+
+  return;
 }
 
-DispatcherInfo NOELLE_HELIX_dispatcher_criticalSections(
-    void (*parallelizedLoop)(void *,
-                             void *,
-                             void *,
-                             void *,
-                             int64_t,
-                             int64_t,
-                             uint64_t *),
-    void *env,
-    void *loopCarriedArray,
-    int64_t numCores,
-    int64_t numOfsequentialSegments) {
-  return NOELLE_HELIX_dispatcher(parallelizedLoop,
-                                 env,
-                                 loopCarriedArray,
-                                 numCores,
-                                 numOfsequentialSegments,
-                                 false);
+NoelleTask_t NoelleTaskDeque::loadTask(Buffer_t *buffer, int64_t index) {
+  auto slot = &buffer->slots[index % buffer->capacity];
+  NoelleTask_t task;
+  task.function = slot->function.load(std::memory_order_relaxed);
+  task.args = slot->args.load(std::memory_order_relaxed);
+
+  return task;
 }
 
-void HELIX_wait(void *sequentialSegment) {
+NoelleTaskDeque::~NoelleTaskDeque() {
+  auto currentBuffer = this->buffer.load(std::memory_order_relaxed);
+  this->retiredBuffers.push_back(currentBuffer);
+  for (auto oldBuffer : this->retiredBuffers) {
+    delete[] oldBuffer->slots;
+    delete oldBuffer;
+  }
+
+  return;
+}
+
+NoelleThreadPool::NoelleThreadPool(uint32_t numberOfWorkers)
+  : numberOfWorkers{ numberOfWorkers },
+    startedWorkers{ 0 },
+    injectionQueueSize{ 0 },
+    submissions{ 0 },
+    parkedWorkers{ 0 },
+    isShuttingDown{ false } {
+  pthread_spin_init(&this->injectionLock, 0);
+  CPU_ZERO(&this->workerCores);
+  this->hasWorkerCores = (pthread_getaffinity_np(pthread_self(),
+                                                 sizeof(cpu_set_t),
+                                                 &this->workerCores)
+                          == 0);
+
+  /*
+   * Allocate the deques.
+   * This must be done before starting any worker as workers steal from each
+   * other.
+   */
+  for (auto i = 0; i < numberOfWorkers; i++) {
+    this->deques.push_back(new NoelleTaskDeque());
+    auto workerQueue = new NoelleWorkerQueue_t();
+    pthread_spin_init(&workerQueue->lock, 0);
+    workerQueue->size.store(0, std::memory_order_relaxed);
+    this->workerQueues.push_back(workerQueue);
+  }
+
+  return;
+}
+
+void NoelleThreadPool::startWorkers(uint32_t count) {
+  count = std::min(count, this->numberOfWorkers);
+  if (this->startedWorkers.load(std::memory_order_acquire) >= count) {
+    return;
+  }
+
+  /*
+   * Start the missing workers.
+   */
+  std::lock_guard<std::mutex> guard(this->startLock);
+  while (this->workers.size() < count) {
+    auto worker = std::thread(&NoelleThreadPool::workerLoop,
+                              this,
+                              this->workers.size());
+    this->workers.push_back(std::move(worker));
+  }
+  this->startedWorkers.store(count, std::memory_order_release);
+
+  return;
+}
+
+void NoelleThreadPool::submitAndDetach(void (*function)(void *), void *args) {
+  NoelleTask_t task;
+  task.function = function;
+  task.args = args;
 
   /*
-   * Fetch the spinlock
+   * Check if the current thread is a worker of the pool.
    */
-  auto ss = (pthread_spinlock_t *)sequentialSegment;
+  if (currentWorkerID >= 0) {
 
-#ifdef RUNTIME_PRINT
-  assert(ss != NULL);
-  fprintf(stderr,
-          "HelixDispatcher: Waiting on sequential segment: %ld\n",
-          (int *)sequentialSegment - (int *)mySSGlobal);
-#endif
+    /*
+     * Push the task to the deque of the current worker.
+     */
+    auto localDeque = this->deques[currentWorkerID];
+    localDeque->push(task);
+
+  } else {
+
+    /*
+     * Push the task to the injection queue.
+     */
+    pthread_spin_lock(&this->injectionLock);
+    this->injectionQueue.push_back(task);
+    this->injectionQueueSize.fetch_add(1, std::memory_order_release);
+    pthread_spin_unlock(&this->injectionLock);
+  }
 
   /*
-   * Wait
+   * Wake up workers that are parked.
+   * If none is parked, then we start a new one.
    */
-  pthread_spin_lock(ss);
-
-#ifdef RUNTIME_PRINT
-  fprintf(stderr,
-          "HelixDispatcher: Waited on sequential segment: %ld\n",
-          (int *)sequentialSegment - (int *)mySSGlobal);
-#endif
+  this->wakeUpWorkers(false);
+  if (this->parkedWorkers.load(std::memory_order_seq_cst) == 0) {
+    auto started = this->startedWorkers.load(std::memory_order_acquire);
+    this->startWorkers(started + 1);
+  }
 
   return;
 }
 
-void HELIX_signal(void *sequentialSegment) {
+void NoelleThreadPool::submitToWorker(uint32_t workerID,
+                                      void (*function)(void *),
+                                      void *args) {
+  assert(workerID < this->numberOfWorkers);
+  this->startWorkers(workerID + 1);
+  NoelleTask_t task;
+  task.function = function;
+  task.args = args;
 
   /*
-   * Fetch the spinlock
+   * Push the task to the queue of the worker.
    */
-  auto ss = (pthread_spinlock_t *)sequentialSegment;
-
-#ifdef RUNTIME_PRINT
-  assert(ss != NULL);
-  fprintf(stderr,
-          "HelixDispatcher: Signaling on sequential segment: %ld\n",
-          (int *)sequentialSegment - (int *)mySSGlobal);
-#endif
+  auto workerQueue = this->workerQueues[workerID];
+  pthread_spin_lock(&workerQueue->lock);
+  workerQueue->tasks.push_back(task);
+  workerQueue->size.fetch_add(1, std::memory_order_release);
+  pthread_spin_unlock(&workerQueue->lock);
 
   /*
-   * Signal
+   * Wake up the worker if it is parked.
+   * We cannot select which parked worker wakes up, so we wake up all of them.
    */
-  pthread_spin_unlock(ss);
-
-#ifdef RUNTIME_PRINT
-  fprintf(stderr,
-          "HelixDispatcher: Signaled on sequential segment: %ld\n",
-          (int *)sequentialSegment - (int *)mySSGlobal);
-#endif
+  this->wakeUpWorkers(true);
 
   return;
 }
 
-/**********************************************************************
- *                DSWP
- **********************************************************************/
-typedef struct {
-  stageFunctionPtr_t funcToInvoke;
-  void *env;
-  void *localQueues;
-  pthread_mutex_t endLock;
-} NOELLE_DSWP_args_t;
+bool NoelleThreadPool::runLocalTask(void (*function)(void *), void *args) {
+  NoelleTask_t task;
 
-void stageExecuter(void (*stage)(void *, void *), void *env, void *queues) {
-  return stage(env, queues);
+  /*
+   * Fetch the last task submitted by the current thread.
+   */
+  auto gotTask = false;
+  if (currentWorkerID >= 0) {
+    auto localDeque = this->deques[currentWorkerID];
+    if (!localDeque->pop(&task)) {
+      return false;
+    }
+    if (false || (task.function != function) || (task.args != args)) {
+      localDeque->push(task);
+      return false;
+    }
+    gotTask = true;
+
+  } else if (this->injectionQueueSize.load(std::memory_order_acquire) > 0) {
+    pthread_spin_lock(&this->injectionLock);
+    if (true && (this->injectionQueue.size() > 0)
+        && (this->injectionQueue.back().function == function)
+        && (this->injectionQueue.back().args == args)) {
+      task = this->injectionQueue.back();
+      this->injectionQueue.pop_back();
+      this->injectionQueueSize.fetch_sub(1, std::memory_order_release);
+      gotTask = true;
+    }
+    pthread_spin_unlock(&this->injectionLock);
+  }
+  if (!gotTask) {
+    return false;
+  }
+
+  /*
+   * Run the task.
+   */
+  task.function(task.args);
+
+  return true;
 }
 
-static void NOELLE_DSWPTrampoline(void *args) {
+uint32_t NoelleThreadPool::getNumberOfWorkers(void) const {
+  return this->numberOfWorkers;
+}
+
+void NoelleThreadPool::wakeUpWorkers(bool wakeUpAll) {
 
   /*
-   * Fetch the arguments.
+   * Signal there is new work.
+   * This must happen before checking whether there are parked workers (see
+   * workerLoop).
    */
-  auto DSWPArgs = (NOELLE_DSWP_args_t *)args;
+  this->submissions.fetch_add(1, std::memory_order_seq_cst);
+  if (this->parkedWorkers.load(std::memory_order_seq_cst) == 0) {
+    return;
+  }
 
   /*
-   * Invoke
+   * Wake up the workers.
    */
-  DSWPArgs->funcToInvoke(DSWPArgs->env, DSWPArgs->localQueues);
+  std::lock_guard<std::mutex> guard(this->parkingLock);
+  if (wakeUpAll) {
+    this->parkingCondition.notify_all();
+  } else {
+    this->parkingCondition.notify_one();
+  }
 
-  pthread_mutex_unlock(&(DSWPArgs->endLock));
   return;
 }
 
-DispatcherInfo NOELLE_DSWPDispatcher(void *env,
-                                     int64_t *queueSizes,
-                                     void *stages,
-                                     int64_t numberOfStages,
-                                     int64_t numberOfQueues) {
-#ifdef RUNTIME_PRINT
-  std::cerr << "Starting dispatcher: num stages " << numberOfStages
-            << ", num queues: " << numberOfQueues << std::endl;
-#endif
+bool NoelleThreadPool::fetchTask(uint32_t workerID, NoelleTask_t *task) {
 
   /*
-   * Fetch VIRGIL
+   * Check the tasks submitted to this worker only.
    */
-  auto virgil = runtime.virgil;
+  auto workerQueue = this->workerQueues[workerID];
+  if (workerQueue->size.load(std::memory_order_acquire) > 0) {
+    auto gotTask = false;
+    pthread_spin_lock(&workerQueue->lock);
+    if (workerQueue->tasks.size() > 0) {
+      (*task) = workerQueue->tasks.front();
+      workerQueue->tasks.pop_front();
+      workerQueue->size.fetch_sub(1, std::memory_order_release);
+      gotTask = true;
+    }
+    pthread_spin_unlock(&workerQueue->lock);
+    if (gotTask) {
+      return true;
+    }
+  }
 
   /*
-   * Reserve the cores.
+   * Check the local deque.
    */
-  auto numCores = runtime.reserveCores(numberOfStages);
-  assert(numCores >= 1);
+  auto localDeque = this->deques[workerID];
+  if (localDeque->pop(task)) {
+    return true;
+  }
 
   /*
-   * Allocate the communication queues.
+   * Check the injection queue.
    */
-  void *localQueues[numberOfQueues];
-  for (auto i = 0; i < numberOfQueues; ++i) {
-    switch (queueSizes[i]) {
-      case 1:
-        localQueues[i] = new ThreadSafeLockFreeQueue<int8_t>();
-        break;
-      case 8:
-        localQueues[i] = new ThreadSafeLockFreeQueue<int8_t>();
-        break;
-      case 16:
-        localQueues[i] = new ThreadSafeLockFreeQueue<int16_t>();
-        break;
-      case 32:
-        localQueues[i] = new ThreadSafeLockFreeQueue<int32_t>();
-        break;
-      case 64:
-        localQueues[i] = new ThreadSafeLockFreeQueue<int64_t>();
-        break;
-      default:
-        std::cerr << "NOELLE: Runtime: QUEUE SIZE INCORRECT" << std::endl;
-        abort();
-        break;
+  if (this->injectionQueueSize.load(std::memory_order_acquire) > 0) {
+    auto gotTask = false;
+    pthread_spin_lock(&this->injectionLock);
+    if (this->injectionQueue.size() > 0) {
+      (*task) = this->injectionQueue.front();
+      this->injectionQueue.pop_front();
+      this->injectionQueueSize.fetch_sub(1, std::memory_order_release);
+      gotTask = true;
+    }
+    pthread_spin_unlock(&this->injectionLock);
+    if (gotTask) {
+      return true;
     }
   }
-#ifdef RUNTIME_PRINT
-  std::cerr << "Made queues" << std::endl;
-#endif
 
   /*
-   * Allocate the memory to store the arguments.
+   * Steal from the other workers.
+   * Start from the next worker to spread thieves among victims.
    */
-  auto argsForAllCores =
-      (NOELLE_DSWP_args_t *)malloc(sizeof(NOELLE_DSWP_args_t) * numberOfStages);
+  for (auto i = 1; i < this->numberOfWorkers; i++) {
+    auto victimID = (workerID + i) % this->numberOfWorkers;
+    auto victimDeque = this->deques[victimID];
+    if (victimDeque->steal(task)) {
+      return true;
+    }
+  }
 
-  /*
-   * Submit DSWP tasks
-   */
-  auto allStages = (void **)stages;
-  for (auto i = 0; i < numberOfStages; ++i) {
+  return false;
+}
+
+void NoelleThreadPool::workerLoop(uint32_t workerID) {
+  currentWorkerID = workerID;
+  if (this->hasWorkerCores) {
+    pthread_setaffinity_np(pthread_self(),
+                           sizeof(cpu_set_t),
+                           &this->workerCores);
+  }
+
+  while (!this->isShuttingDown.load(std::memory_order_acquire)) {
 
     /*
-     * Prepare the arguments.
+     * Look for a task.
      */
-    auto argsPerCore = &argsForAllCores[i];
-    argsPerCore->funcToInvoke = reinterpret_cast<stageFunctionPtr_t>(
-        reinterpret_cast<long long>(allStages[i]));
-    argsPerCore->env = env;
-    argsPerCore->localQueues = (void *)localQueues;
-    pthread_mutex_init(&(argsPerCore->endLock), NULL);
-    pthread_mutex_lock(&(argsPerCore->endLock));
+    auto observedSubmissions =
+        this->submissions.load(std::memory_order_seq_cst);
+    NoelleTask_t task;
+    auto gotTask = false;
+    for (auto i = 0; i < NOELLE_POOL_SPINS_BEFORE_PARKING; i++) {
+      if (this->fetchTask(workerID, &task)) {
+        gotTask = true;
+        break;
+      }
+    }
 
     /*
-     * Submit
+     * Run the task.
      */
-    virgil->submitAndDetach(NOELLE_DSWPTrampoline, argsPerCore);
-#ifdef RUNTIME_PRINT
-    std::cerr << "Submitted stage" << std::endl;
-#endif
+    if (gotTask) {
+      task.function(task.args);
+      continue;
+    }
+
+    /*
+     * There is nothing to run.
+     * Park until new tasks are submitted.
+     */
+    std::unique_lock<std::mutex> guard(this->parkingLock);
+    this->parkedWorkers.fetch_add(1, std::memory_order_seq_cst);
+    this->parkingCondition.wait(guard, [this, observedSubmissions]() -> bool {
+      auto currentSubmissions =
+          this->submissions.load(std::memory_order_seq_cst);
+      return (currentSubmissions != observedSubmissions)
+             || this->isShuttingDown.load(std::memory_order_acquire);
+    });
+    this->parkedWorkers.fetch_sub(1, std::memory_order_seq_cst);
   }
-#ifdef RUNTIME_PRINT
-  std::cerr << "Submitted pool" << std::endl;
-#endif
+
+  return;
+}
+
+NoelleThreadPool::~NoelleThreadPool() {
 
   /*
-   * Wait for the tasks to complete.
+   * Stop the workers.
    */
-  for (auto i = 0; i < numberOfStages; ++i) {
-    pthread_mutex_lock(&(argsForAllCores[i].endLock));
+  {
+    std::lock_guard<std::mutex> guard(this->parkingLock);
+    this->isShuttingDown.store(true, std::memory_order_release);
+    this->parkingCondition.notify_all();
+  }
+  for (auto &worker : this->workers) {
+    worker.join();
   }
-#ifdef RUNTIME_PRINT
-  std::cerr << "Got all futures" << std::endl;
-#endif
 
   /*
-   * Free the cores and memory.
+   * Free the memory.
    */
-  runtime.releaseCores(numCores);
-  for (int i = 0; i < numberOfQueues; ++i) {
-    switch (queueSizes[i]) {
-      case 1:
-        delete (ThreadSafeLockFreeQueue<int8_t> *)(localQueues[i]);
-        break;
-      case 8:
-        delete (ThreadSafeLockFreeQueue<int8_t> *)(localQueues[i]);
-        break;
-      case 16:
-        delete (ThreadSafeLockFreeQueue<int16_t> *)(localQueues[i]);
-        break;
-      case 32:
-        delete (ThreadSafeLockFreeQueue<int32_t> *)(localQueues[i]);
-        break;
-      case 64:
-        delete (ThreadSafeLockFreeQueue<int64_t> *)(localQueues[i]);
-        break;
-    }
+  for (auto deque : this->deques) {
+    delete deque;
+  }
+  for (auto workerQueue : this->workerQueues) {
+    delete workerQueue;
   }
-  free(argsForAllCores);
-
-#ifdef DSWP_STATS
-  std::cout << "DSWP: 1 Byte pushes = " << numberOfPushes8 << std::endl;
-  std::cout << "DSWP: 2 Bytes pushes = " << numberOfPushes16 << std::endl;
-  std::cout << "DSWP: 4 Bytes pushes = " << numberOfPushes32 << std::endl;
-  std::cout << "DSWP: 8 Bytes pushes = " << numberOfPushes64 << std::endl;
-#endif
 
-  DispatcherInfo dispatcherInfo;
-  dispatcherInfo.numberOfThreadsUsed = numberOfStages;
-  return dispatcherInfo;
-}
+  return;
 }
 
-NoelleRuntime::NoelleRuntime() {
-  this->maxCores = this->getMaximumNumberOfCores();
-  this->NOELLE_idleCores = maxCores;
-
-  pthread_spin_init(&this->spinLock, 0);
-  pthread_spin_init(&this->doallMemoryLock, 0);
-#ifdef RUNTIME_PROFILE
-  pthread_spin_init(&printLock, 0);
-#endif
-
-  /*
-   * Allocate VIRGIL
-   */
-  this->virgil = new ThreadPoolForCSingleQueue(false, maxCores);
+NoelleSpeculativeTask::NoelleSpeculativeTask() {
+  std::memset(this->readSignature, 0, sizeof(this->readSignature));
+  std::memset(this->writeSignature, 0, sizeof(this->writeSignature));
 
   return;
 }
 
-DOALL_args_t *NoelleRuntime::getDOALLArgs(uint32_t cores, uint32_t *index) {
-  DOALL_args_t *argsForAllCores = nullptr;
+uint64_t NoelleSpeculativeTask::getSignatureBit(uintptr_t word) {
 
   /*
-   * Check if we can reuse a previously-allocated memory region.
+   * Words are 8-byte aligned: drop the bits that are always zero and spread
+   * the remaining ones with a multiplicative hash.
    */
-  pthread_spin_lock(&this->doallMemoryLock);
-  auto doallMemoryNumberOfChunks = this->doallMemoryAvailability.size();
-  for (auto i = 0; i < doallMemoryNumberOfChunks; i++) {
-    auto currentSize = this->doallMemorySizes[i];
-    if (true && (this->doallMemoryAvailability[i]) && (currentSize >= cores)) {
-
-      /*
-       * Found a memory block that can be reused.
-       */
-      argsForAllCores = this->doallMemory[i];
-
-      /*
-       * Set the block as in use.
-       */
-      this->doallMemoryAvailability[i] = false;
-      (*index) = i;
-      pthread_spin_unlock(&this->doallMemoryLock);
+  auto hash = (uint64_t)(word >> 3) * 0x9E3779B97F4A7C15ULL;
 
-      return argsForAllCores;
-    }
-  }
+  return hash % NOELLE_SPECULATION_SIGNATURE_BITS;
+}
 
-  /*
-   * We couldn't find anything available.
-   *
-   * Allocate a new memory region.
-   */
-  this->doallMemorySizes.push_back(cores);
-  this->doallMemoryAvailability.push_back(false);
-  posix_memalign((void **)&argsForAllCores,
-                 CACHE_LINE_SIZE,
-                 sizeof(DOALL_args_t) * cores);
-  this->doallMemory.push_back(argsForAllCores);
-  pthread_spin_unlock(&this->doallMemoryLock);
+int64_t NoelleSpeculativeTask::load(void *address, int64_t size) {
 
   /*
-   * Set the index.
+   * Read the value from memory.
    */
-  (*index) = doallMemoryNumberOfChunks;
+  int64_t value = 0;
+  std::memcpy(&value, address, size);
+  auto valueBytes = (uint8_t *)&value;
 
   /*
-   * Initialize the memory.
+   * Record the bytes read and apply the stores of this task to them.
+   * An access spans at most two words.
    */
-  for (auto i = 0; i < cores; ++i) {
-    auto argsPerCore = &argsForAllCores[i];
-    argsPerCore->coreID = i;
-    pthread_spin_init(&(argsPerCore->endLock), 0);
-    pthread_spin_lock(&(argsPerCore->endLock));
+  auto start = (uintptr_t)address;
+  auto end = start + size;
+  for (auto word = start & ~((uintptr_t)7); word < end; word += 8) {
+    auto bit = NoelleSpeculativeTask::getSignatureBit(word);
+    this->readSignature[bit / 64] |= ((uint64_t)1) << (bit % 64);
+    auto &readMask = this->wordsRead[word];
+    auto firstByte = std::max(word, start);
+    auto lastByte = std::min(word + 8, end);
+    for (auto byte = firstByte; byte < lastByte; byte++) {
+      readMask |= (1 << (byte - word));
+    }
+    if ((this->writeSignature[bit / 64] & (((uint64_t)1) << (bit % 64)))
+        == 0) {
+      continue;
+    }
+    auto wordIt = this->wordsWritten.find(word);
+    if (wordIt == this->wordsWritten.end()) {
+      continue;
+    }
+    auto &writtenWord = wordIt->second;
+    auto writtenBytes = (uint8_t *)&writtenWord.value;
+    for (auto byte = firstByte; byte < lastByte; byte++) {
+      auto byteInWord = byte - word;
+      if (writtenWord.mask & (1 << byteInWord)) {
+        valueBytes[byte - start] = writtenBytes[byteInWord];
+      }
+    }
   }
 
-  return argsForAllCores;
-}
-
-void NoelleRuntime::releaseDOALLArgs(uint32_t index) {
-  pthread_spin_lock(&this->doallMemoryLock);
-  this->doallMemoryAvailability[index] = true;
-  pthread_spin_unlock(&this->doallMemoryLock);
-  return;
+  return value;
 }
 
-uint32_t NoelleRuntime::reserveCores(uint32_t coresRequested) {
+void NoelleSpeculativeTask::store(void *address, int64_t value, int64_t size) {
+  auto valueBytes = (uint8_t *)&value;
 
   /*
-   * Reserve the number of cores available.
+   * Buffer the bytes written.
    */
-  pthread_spin_lock(&this->spinLock);
-  auto numCores = (this->NOELLE_idleCores >= coresRequested) ? coresRequested
-                                                             : NOELLE_idleCores;
-  if (numCores < 1) {
-    numCores = 1;
-  }
-  this->NOELLE_idleCores -= numCores;
-  pthread_spin_unlock(&this->spinLock);
-
-  return numCores;
-}
-
-void NoelleRuntime::releaseCores(uint32_t coresReleased) {
-  assert(coresReleased > 0);
-
-  pthread_spin_lock(&this->spinLock);
-  this->NOELLE_idleCores += coresReleased;
-#ifdef DEBUG
-  if (this->NOELLE_idleCores >= 0) {
-    assert(this->NOELLE_idleCores <= ((uint32_t)this->maxCores));
+  auto start = (uintptr_t)address;
+  auto end = start + size;
+  for (auto word = start & ~((uintptr_t)7); word < end; word += 8) {
+    auto bit = NoelleSpeculativeTask::getSignatureBit(word);
+    this->writeSignature[bit / 64] |= ((uint64_t)1) << (bit % 64);
+    auto &writtenWord = this->wordsWritten[word];
+    auto writtenBytes = (uint8_t *)&writtenWord.value;
+    for (auto byte = std::max(word, start); byte < std::min(word + 8, end);
+         byte++) {
+      auto byteInWord = byte - word;
+      writtenBytes[byteInWord] = valueBytes[byte - start];
+      writtenWord.mask |= (1 << byteInWord);
+    }
   }
-#endif
-  pthread_spin_unlock(&this->spinLock);
 
   return;
 }
 
-uint32_t NoelleRuntime::getMaximumNumberOfCores(void) {
-  static int cores = 0;
+bool NoelleSpeculativeTask::conflictsWith(
+    const NoelleSpeculativeTask &other) const {
 
   /*
-   * Check if we have already computed the number of cores.
+   * Check the signatures first: if they do not intersect, then the tasks did
+   * not access the same words.
    */
-  if (cores == 0) {
+  auto mayConflict = false;
+  for (auto i = 0; i < (NOELLE_SPECULATION_SIGNATURE_BITS / 64); i++) {
+    if (this->writeSignature[i]
+        & (other.readSignature[i] | other.writeSignature[i])) {
+      mayConflict = true;
+      break;
+    }
+  }
+  if (!mayConflict) {
+    return false;
+  }
 
-    /*
-     * Compute the number of cores.
-     */
-    auto envVar = getenv("NOELLE_CORES");
-    if (envVar == nullptr) {
-      cores = (std::thread::hardware_concurrency() / 2) - 1;
-    } else {
-      cores = atoi(envVar);
+  /*
+   * Check the exact bytes accessed.
+   */
+  for (auto &wordPair : this->wordsWritten) {
+    auto word = wordPair.first;
+    auto writtenMask = wordPair.second.mask;
+    auto readIt = other.wordsRead.find(word);
+    if (true && (readIt != other.wordsRead.end())
+        && ((readIt->second & writtenMask) != 0)) {
+      return true;
+    }
+    auto writtenIt = other.wordsWritten.find(word);
+    if (true && (writtenIt != other.wordsWritten.end())
+        && ((writtenIt->second.mask & writtenMask) != 0)) {
+      return true;
     }
   }
 
-  return cores;
+  return false;
 }
 
-NoelleRuntime::~NoelleRuntime(void) {
-  delete this->virgil;
+void NoelleSpeculativeTask::commit(void) const {
+  for (auto &wordPair : this->wordsWritten) {
+    auto wordBytes = (uint8_t *)wordPair.first;
+    auto &writtenWord = wordPair.second;
+    auto writtenBytes = (uint8_t *)&writtenWord.value;
+    for (auto byteInWord = 0; byteInWord < 8; byteInWord++) {
+      if (writtenWord.mask & (1 << byteInWord)) {
+        wordBytes[byteInWord] = writtenBytes[byteInWord];
+      }
+    }
+  }
+
+  return;
 }
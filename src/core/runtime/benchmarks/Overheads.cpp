@@ -0,0 +1,259 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Micro-benchmarks that measure the costs of running loops in parallel with
+ * the NOELLE runtime (see ParallelizationOverheads).
+ * They must be linked with Parallelizer_utils.cpp, and they print the model
+ * file to the standard output.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#include <ThreadSafeLockFreeQueue.hpp>
+
+extern "C" {
+
+class DispatcherInfo {
+public:
+  int32_t numberOfThreadsUsed;
+  int64_t unusedVariableToPreventOptIfStructHasOnlyOneVariable;
+};
+
+DispatcherInfo NOELLE_DOALLDispatcher(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize);
+
+void queuePush64(void *queue, int64_t *val);
+
+void queuePop64(void *queue, int64_t *val);
+}
+
+/*
+ * The cycles are measured as the runtime does.
+ */
+static inline uint64_t getCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+#endif
+}
+
+/*
+ * Each variable of the environment has its own cache line, as in the code
+ * generated by NOELLE.
+ */
+static const int64_t valuesPerCacheLine = 64 / sizeof(int64_t);
+static const int64_t variables = 64;
+static const int64_t repetitions = 1000;
+static const int64_t handOffs = 100000;
+static const int64_t queueValues = 1000000;
+static volatile int64_t sink = 0;
+
+static void emptyTask(void *env,
+                      int64_t coreID,
+                      int64_t cores,
+                      int64_t chunk) {
+  return;
+}
+
+static void liveInTask(void *env,
+                       int64_t coreID,
+                       int64_t cores,
+                       int64_t chunk) {
+  auto values = (volatile int64_t *)env;
+  int64_t sum = 0;
+  for (auto i = 0; i < variables; i++) {
+    sum += values[i * valuesPerCacheLine];
+  }
+  sink = sum;
+
+  return;
+}
+
+static void liveOutTask(void *env,
+                        int64_t coreID,
+                        int64_t cores,
+                        int64_t chunk) {
+  auto values = (volatile int64_t *)env;
+  for (auto i = 0; i < variables; i++) {
+    values[(coreID * variables + i) * valuesPerCacheLine] = i;
+  }
+
+  return;
+}
+
+/*
+ * Return the average cycles of an invocation of @task with @cores cores.
+ * When @liveOuts is set, the invocation includes reading the live-outs of all
+ * tasks back.
+ */
+static double measureDispatch(void (*task)(void *, int64_t, int64_t, int64_t),
+                              int64_t *env,
+                              int64_t cores,
+                              bool liveOuts) {
+  for (auto i = 0; i < 10; i++) {
+    NOELLE_DOALLDispatcher(task, env, cores, 1);
+  }
+  auto start = getCycles();
+  for (auto i = 0; i < repetitions; i++) {
+    NOELLE_DOALLDispatcher(task, env, cores, 1);
+    if (liveOuts) {
+      int64_t sum = 0;
+      for (auto v = 0; v < cores * variables; v++) {
+        sum += env[v * valuesPerCacheLine];
+      }
+      sink = sum;
+    }
+  }
+  auto end = getCycles();
+
+  return ((double)(end - start)) / repetitions;
+}
+
+/*
+ * Return the average cycles to hand a sequential segment from a core to
+ * another one.
+ */
+static double measureSequentialSegment(void) {
+  std::atomic<int64_t> turn{ 0 };
+  std::thread other([&turn]() {
+    for (int64_t i = 0; i < handOffs; i++) {
+      while (turn.load(std::memory_order_acquire) != (2 * i + 1)) {
+      }
+      turn.store(2 * i + 2, std::memory_order_release);
+    }
+  });
+  auto start = getCycles();
+  for (int64_t i = 0; i < handOffs; i++) {
+    turn.store(2 * i + 1, std::memory_order_release);
+    while (turn.load(std::memory_order_acquire) != (2 * i + 2)) {
+    }
+  }
+  auto end = getCycles();
+  other.join();
+
+  return ((double)(end - start)) / (2 * handOffs);
+}
+
+/*
+ * Measure the average cycles to push a value to a queue used by DSWP and to
+ * pop a value from it, while a producer and a consumer stream values through
+ * it.
+ */
+static void measureQueue(double &pushCycles, double &popCycles) {
+  auto queue = new MARC::ThreadSafeLockFreeQueue<int64_t>();
+  uint64_t consumerCycles = 0;
+  std::thread consumer([queue, &consumerCycles]() {
+    int64_t value = 0;
+    int64_t sum = 0;
+    auto start = getCycles();
+    for (int64_t i = 0; i < queueValues; i++) {
+      queuePop64(queue, &value);
+      sum += value;
+    }
+    consumerCycles = getCycles() - start;
+    sink = sum;
+  });
+  auto start = getCycles();
+  for (int64_t i = 0; i < queueValues; i++) {
+    queuePush64(queue, &i);
+  }
+  auto producerCycles = getCycles() - start;
+  consumer.join();
+  delete queue;
+
+  pushCycles = ((double)producerCycles) / queueValues;
+  popCycles = ((double)consumerCycles) / queueValues;
+
+  return;
+}
+
+/*
+ * Return the average cycles per instruction of a chain of dependent
+ * arithmetic instructions.
+ * Each iteration executes 5 instructions: a multiplication, an addition, the
+ * increment of the counter, the comparison, and the branch.
+ */
+static double measureCyclesPerInstruction(void) {
+  int64_t iterations = 100000000;
+  int64_t x = sink;
+  auto start = getCycles();
+  for (int64_t i = 0; i < iterations; i++) {
+    x = x * 3 + i;
+    asm volatile("" : "+r"(x));
+  }
+  auto end = getCycles();
+  sink = x;
+
+  return ((double)(end - start)) / (iterations * 5);
+}
+
+int main(int argc, char *argv[]) {
+
+  /*
+   * Use the cores that NOELLE uses by default.
+   */
+  int64_t cores = std::thread::hardware_concurrency() / 2;
+  if (cores < 2) {
+    cores = 2;
+  }
+  std::vector<int64_t> env(cores * variables * valuesPerCacheLine, 1);
+
+  /*
+   * Measure the costs.
+   */
+  auto dispatch = measureDispatch(emptyTask, env.data(), cores, false);
+  auto liveIns = measureDispatch(liveInTask, env.data(), cores, false);
+  auto liveOuts = measureDispatch(liveOutTask, env.data(), cores, true);
+  auto liveIn = (liveIns > dispatch) ? (liveIns - dispatch) / variables : 0;
+  auto liveOut = (liveOuts > dispatch) ? (liveOuts - dispatch) / variables : 0;
+  auto sequentialSegment = measureSequentialSegment();
+  double queuePush = 0;
+  double queuePop = 0;
+  measureQueue(queuePush, queuePop);
+  auto cyclesPerInstruction = measureCyclesPerInstruction();
+
+  /*
+   * Print the model.
+   */
+  printf("# Measured with %ld cores\n", cores);
+  printf("dispatch_cycles %f\n", dispatch);
+  printf("live_in_cycles %f\n", liveIn);
+  printf("live_out_cycles %f\n", liveOut);
+  printf("sequential_segment_cycles %f\n", sequentialSegment);
+  printf("queue_push_cycles %f\n", queuePush);
+  printf("queue_pop_cycles %f\n", queuePop);
+  printf("cycles_per_instruction %f\n", cyclesPerInstruction);
+
+  return 0;
+}
@@ -24,6 +24,7 @@
 #include "noelle/core/SystemHeaders.hpp"
 #include "noelle/core/LoopDependenceInfo.hpp"
 #include "noelle/core/DominatorSummary.hpp"
+#include "noelle/core/ControlDependenceSummary.hpp"
 
 namespace llvm::noelle {
 
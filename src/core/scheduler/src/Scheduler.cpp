@@ -406,23 +406,16 @@ bool Scheduler::isControlEquivalent(BasicBlock *const First,
                                     BasicBlock *const Second,
                                     DominatorSummary const &DS) const {
 
-  bool IsControlEquivalent = true;
-
-  /*
-   * Get dominator and post-dominator trees, set up
-   */
-  auto DT = DS.DT;
-  auto PDT = DS.PDT;
-
   /*
-   * Check if @First dominates @Second
+   * Fetch the control dependence summary of the function, which is shared
+   * with the PDG builder and the other schedulers.
    */
-  IsControlEquivalent &= DT.dominates(First, Second);
+  auto summary = ControlDependenceSummary::fetch(*First->getParent());
 
   /*
-   * Check if @Second post-dominates @First
+   * Check if @First dominates @Second and @Second post-dominates @First
    */
-  IsControlEquivalent &= PDT.dominates(Second, First);
+  auto IsControlEquivalent = summary->areControlEquivalent(First, Second);
 
   /*
    * Debugging
@@ -874,9 +867,10 @@ void LoopScheduler::gatherNecessaryLoopState(void) {
 void LoopScheduler::calculateLoopPrologue(void) {
 
   /*
-   * Get the post-dominator tree
+   * Fetch the control dependence summary of the function
    */
-  auto PDT = this->DS->PDT;
+  auto loopFunction = this->TheLoop->getFunction();
+  auto summary = ControlDependenceSummary::fetch(*loopFunction);
 
   /*
    * Prologue is calculated by finding all loop blocks NOT
@@ -884,7 +878,7 @@ void LoopScheduler::calculateLoopPrologue(void) {
    */
   for (auto Block : this->Blocks) {
 
-    auto DoesPostDominate = PDT.dominates(this->OriginalLatch, Block);
+    auto DoesPostDominate = summary->postDominates(this->OriginalLatch, Block);
 
     if (!DoesPostDominate) {
       this->Prologue.insert(Block);
@@ -26,6 +26,7 @@ mkdir -p ${installDir}/bin ;
 
 patchInstallDir "noelle-norm" ;
 patchInstallDir "noelle-load" ;
+patchInstallDir "noelle-load-npm" ;
 patchInstallDir "noelle-pdg" ;
 patchInstallDir "noelle-meta-clean" ;
 patchInstallDir "noelle-meta-pdg-clean " ;
@@ -36,3 +37,10 @@ patchInstallDir "noelle-prof-coverage" ;
 patchInstallDir "noelle-config" ;
 patchInstallDir "noelle-simplification" ;
 patchInstallDir "loopaa" ;
+patchInstallDir "noelle-overheads" ;
+patchInstallDir "noelle-false-sharing" ;
+patchInstallDir "noelle-helix-segments" ;
+
+# Install the micro-benchmarks that measure the overheads of the runtime
+mkdir -p ${installDir}/share/noelle/runtime ;
+cp runtime/Parallelizer_utils.cpp runtime/benchmarks/Overheads.cpp ${installDir}/share/noelle/runtime/ ;
@@ -25,6 +25,22 @@
 
 namespace llvm::noelle {
 
+/*
+ * TalkDown brings the annotations of the source code to the IR.
+ *
+ * Functions and global variables annotated as commutative (i.e.,
+ * __attribute__((annotate("noelle.commutative")))) can be accessed in any
+ * order: the calls to such functions and the loads and stores of such
+ * variables are tagged with the "noelle.commutative" metadata.
+ * For example, this is the case of counters, hash-set inserts, and
+ * allocators.
+ *
+ * Loops whose iterations have been declared independent (e.g., by
+ * "#pragma omp simd" or "#pragma clang loop vectorize(assume_safety)", which
+ * clang lowers to llvm.loop.parallel_accesses) are tagged with the
+ * "noelle.parallel" property of their loop ID.
+ * Other tools can tag loops with this property directly.
+ */
 class TalkDown : public ModulePass {
 public:
   static char ID;
@@ -37,7 +53,25 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &AU) const override;
 
+  /*
+   * Check if @inst has been tagged as commutative with the other instructions
+   * tagged this way.
+   */
+  static bool isCommutative(Instruction *inst);
+
+  /*
+   * Check if the source code declared the iterations of @loop independent
+   * (i.e., @loop has no loop-carried memory dependence).
+   */
+  static bool isParallel(Loop *loop);
+
 private:
   bool enabled;
+
+  std::set<GlobalValue *> getAnnotatedValues(Module &M, StringRef annotation);
+
+  bool tagAsCommutative(GlobalValue *value);
+
+  bool tagAsParallel(Loop *loop);
 };
 } // namespace llvm::noelle
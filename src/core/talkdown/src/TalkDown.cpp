@@ -37,15 +37,201 @@ bool TalkDown::doInitialization(Module &M) {
   return false;
 }
 
+/*
+ * Annotations and metadata for commutative operations.
+ */
+static const std::string commutativeAnnotation = "noelle.commutative";
+
+/*
+ * Property of the loop IDs for loops with independent iterations.
+ */
+static const std::string parallelLoopProperty = "noelle.parallel";
+
 bool TalkDown::runOnModule(Module &M) {
   if (!this->enabled) {
     return false;
   }
 
+  /*
+   * Tag the accesses to the values annotated as commutative.
+   */
+  auto modified = false;
+  for (auto value : this->getAnnotatedValues(M, commutativeAnnotation)) {
+    modified |= this->tagAsCommutative(value);
+  }
+
+  /*
+   * Tag the loops declared parallel.
+   */
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    for (auto loop : LI.getLoopsInPreorder()) {
+      if (true && loop->isAnnotatedParallel()
+          && (!TalkDown::isParallel(loop))) {
+        modified |= this->tagAsParallel(loop);
+      }
+    }
+  }
+
+  return modified;
+}
+
+bool TalkDown::isCommutative(Instruction *inst) {
+  return inst->getMetadata(commutativeAnnotation) != nullptr;
+}
+
+bool TalkDown::isParallel(Loop *loop) {
+  auto loopID = loop->getLoopID();
+  if (loopID == nullptr) {
+    return false;
+  }
+  for (auto i = 1u; i < loopID->getNumOperands(); i++) {
+    auto property = dyn_cast<MDNode>(loopID->getOperand(i));
+    if (false || (property == nullptr) || (property->getNumOperands() == 0)) {
+      continue;
+    }
+    auto name = dyn_cast<MDString>(property->getOperand(0));
+    if (true && (name != nullptr)
+        && (name->getString() == parallelLoopProperty)) {
+      return true;
+    }
+  }
+
   return false;
 }
 
+bool TalkDown::tagAsParallel(Loop *loop) {
+
+  /*
+   * Create a new loop ID with the properties of the current one (if any) and
+   * the parallel one.
+   * The first operand of a loop ID is the loop ID itself.
+   */
+  auto &context = loop->getHeader()->getContext();
+  SmallVector<Metadata *, 4> properties;
+  properties.push_back(nullptr);
+  if (auto loopID = loop->getLoopID()) {
+    for (auto i = 1u; i < loopID->getNumOperands(); i++) {
+      properties.push_back(loopID->getOperand(i));
+    }
+  }
+  properties.push_back(
+      MDNode::get(context, MDString::get(context, parallelLoopProperty)));
+  auto newLoopID = MDNode::getDistinct(context, properties);
+  newLoopID->replaceOperandWith(0, newLoopID);
+  loop->setLoopID(newLoopID);
+
+  return true;
+}
+
+std::set<GlobalValue *> TalkDown::getAnnotatedValues(Module &M,
+                                                     StringRef annotation) {
+  std::set<GlobalValue *> values;
+
+  /*
+   * Fetch the annotations of the source code.
+   * Each one is a struct whose first two fields are the value annotated and
+   * the annotation string.
+   */
+  auto annotations = M.getNamedGlobal("llvm.global.annotations");
+  if (false || (annotations == nullptr)
+      || (!annotations->hasInitializer())) {
+    return values;
+  }
+  auto annotationArray = dyn_cast<ConstantArray>(annotations->getInitializer());
+  if (annotationArray == nullptr) {
+    return values;
+  }
+  for (auto &op : annotationArray->operands()) {
+    auto entry = dyn_cast<ConstantStruct>(op.get());
+    if (false || (entry == nullptr) || (entry->getNumOperands() < 2)) {
+      continue;
+    }
+
+    /*
+     * Fetch the annotation string.
+     */
+    auto stringGlobal =
+        dyn_cast<GlobalVariable>(entry->getOperand(1)->stripPointerCasts());
+    if (false || (stringGlobal == nullptr)
+        || (!stringGlobal->hasInitializer())) {
+      continue;
+    }
+    auto string = dyn_cast<ConstantDataSequential>(
+        stringGlobal->getInitializer());
+    if (false || (string == nullptr) || (!string->isCString())
+        || (string->getAsCString() != annotation)) {
+      continue;
+    }
+
+    /*
+     * Fetch the value annotated.
+     */
+    auto value =
+        dyn_cast<GlobalValue>(entry->getOperand(0)->stripPointerCasts());
+    if (value != nullptr) {
+      values.insert(value);
+    }
+  }
+
+  return values;
+}
+
+bool TalkDown::tagAsCommutative(GlobalValue *value) {
+
+  /*
+   * Collect the instructions that use @value either directly or through
+   * constant expressions (e.g., casts and GEPs of arrays).
+   */
+  std::vector<Instruction *> users;
+  std::vector<User *> toVisit(value->user_begin(), value->user_end());
+  std::set<User *> visited;
+  while (!toVisit.empty()) {
+    auto user = toVisit.back();
+    toVisit.pop_back();
+    if (!visited.insert(user).second) {
+      continue;
+    }
+    if (auto inst = dyn_cast<Instruction>(user)) {
+      users.push_back(inst);
+      continue;
+    }
+    if (isa<ConstantExpr>(user)) {
+      toVisit.insert(toVisit.end(), user->user_begin(), user->user_end());
+    }
+  }
+
+  /*
+   * Tag the calls of the function and the accesses to the variable.
+   */
+  auto &context = value->getContext();
+  auto tag = MDNode::get(context, MDString::get(context, "true"));
+  auto modified = false;
+  for (auto inst : users) {
+    Value *accessed = nullptr;
+    if (auto call = dyn_cast<CallBase>(inst)) {
+      accessed = call->getCalledOperand();
+    } else if (auto load = dyn_cast<LoadInst>(inst)) {
+      accessed = load->getPointerOperand();
+    } else if (auto store = dyn_cast<StoreInst>(inst)) {
+      accessed = store->getPointerOperand();
+    }
+    if (false || (accessed == nullptr)
+        || (accessed->stripInBoundsOffsets() != value)) {
+      continue;
+    }
+    inst->setMetadata(commutativeAnnotation, tag);
+    modified = true;
+  }
+
+  return modified;
+}
+
 void TalkDown::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
   AU.setPreservesAll();
   return;
 }
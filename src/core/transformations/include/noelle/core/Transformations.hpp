@@ -37,14 +37,30 @@ enum Transformation {
   LOOP_WHILIFIER_ID,
   SCEV_SIMPLIFICATION_ID,
   DEVIRTUALIZER_ID,
+  LOOP_VERSIONING_ID,
+  SPECULATIVE_DOALL_ID,
+  LOOP_SPECIALIZATION_ID,
+  LOOP_COLLAPSE_ID,
+  LOOP_FUSION_ID,
+  LOOP_TILING_ID,
+  WAVEFRONT_ID,
+  INSPECTOR_EXECUTOR_DOALL_ID,
+  ARRAY_REDUCTION_ID,
+  SCAN_ID,
+  LOOP_INTERCHANGE_ID,
+  STRUCTURE_SPLITTING_ID,
+  POINTER_CHASING_CHUNKING_ID,
+  SCALAR_EXPANSION_ID,
+  ITERATION_PEELING_ID,
 
   First = DOALL_ID,
-  Last = DEVIRTUALIZER_ID
+  Last = ITERATION_PEELING_ID
 };
 
 enum LoopDependenceInfoOptimization {
   MEMORY_CLONING_ID,
-  THREAD_SAFE_LIBRARY_ID
+  THREAD_SAFE_LIBRARY_ID,
+  BUFFERED_OUTPUT_ID
 };
 
 } // namespace llvm::noelle
@@ -6,6 +6,52 @@
 
 namespace llvm::noelle {
 
+/*
+ * Dense index from the IDs of the instructions and functions of a module to
+ * them, and back.
+ *
+ * The index of a module is built lazily by its first query, and it is shared
+ * by all the queries that follow. Values that are deleted from the module drop
+ * out of the index, and a query of such value rebuilds it.
+ * Passes that assign IDs must invalidate the index of the module.
+ */
+class IDToValueIndex {
+public:
+  static IDToValueIndex &getIndex(Module &);
+
+  static void invalidate(Module &);
+
+  Instruction *getInstruction(IDType);
+
+  Function *getFunction(IDType);
+
+  optional<IDType> getInstructionID(Instruction *);
+
+  optional<IDType> getFunctionID(Function *);
+
+private:
+  explicit IDToValueIndex(Module &);
+
+  void build(void);
+
+  template <typename T>
+  T *lookup(std::vector<optional<WeakVH>> &, IDType);
+
+  optional<IDType> lookupID(std::vector<optional<WeakVH>> &, Value *);
+
+  /*
+   * IDs without a value have no handle, and values deleted from the module
+   * leave a null handle behind.
+   */
+  Module &Mod;
+  bool isBuilt;
+  std::vector<optional<WeakVH>> instructionSlots;
+  std::vector<optional<WeakVH>> functionSlots;
+  std::unordered_map<Value *, IDType> valueToID;
+
+  static std::unordered_map<Module *, std::unique_ptr<IDToValueIndex>> indexes;
+};
+
 class IDToInstructionMapper : public InstVisitor<IDToInstructionMapper> {
 public:
   explicit IDToInstructionMapper(Module &);
@@ -8,6 +8,115 @@ using namespace llvm;
 
 namespace llvm::noelle {
 
+std::unordered_map<Module *, std::unique_ptr<IDToValueIndex>>
+    IDToValueIndex::indexes;
+
+IDToValueIndex::IDToValueIndex(Module &M) : Mod(M), isBuilt(false) {}
+
+IDToValueIndex &IDToValueIndex::getIndex(Module &M) {
+  auto &index = indexes[&M];
+  if (!index) {
+    index.reset(new IDToValueIndex(M));
+  }
+  return *index;
+}
+
+void IDToValueIndex::invalidate(Module &M) {
+  auto indexIt = indexes.find(&M);
+  if (indexIt != indexes.end()) {
+    indexIt->second->isBuilt = false;
+  }
+}
+
+void IDToValueIndex::build(void) {
+  instructionSlots.clear();
+  functionSlots.clear();
+  valueToID.clear();
+
+  auto record =
+      [this](std::vector<optional<WeakVH>> &slots, Value *V, IDType ID) {
+        if (ID >= slots.size()) {
+          slots.resize(ID + 1);
+        }
+        slots[ID] = WeakVH(V);
+        valueToID[V] = ID;
+      };
+  for (auto &F : Mod) {
+    if (auto FID = UniqueIRMarkerReader::getFunctionID(&F)) {
+      record(functionSlots, &F, FID.value());
+    }
+    for (auto &I : instructions(F)) {
+      if (auto IID = UniqueIRMarkerReader::getInstructionID(&I)) {
+        record(instructionSlots, &I, IID.value());
+      }
+    }
+  }
+  isBuilt = true;
+}
+
+template <typename T>
+T *IDToValueIndex::lookup(std::vector<optional<WeakVH>> &slots, IDType ID) {
+  if (!isBuilt) {
+    build();
+  }
+
+  /*
+   * A deleted value means the module changed since the index was built.
+   */
+  if ((ID < slots.size()) && slots[ID] && (*slots[ID] == nullptr)) {
+    build();
+  }
+  if ((ID >= slots.size()) || !slots[ID]) {
+    return nullptr;
+  }
+  return cast_or_null<T>(static_cast<Value *>(*slots[ID]));
+}
+
+optional<IDType> IDToValueIndex::lookupID(
+    std::vector<optional<WeakVH>> &slots,
+    Value *V) {
+  if (!isBuilt) {
+    build();
+  }
+
+  /*
+   * The handle of the ID confirms the entry belongs to the value, rather than
+   * to a deleted one that had the same address.
+   */
+  auto IDIt = valueToID.find(V);
+  if (IDIt == valueToID.end()) {
+    return nullopt;
+  }
+  auto ID = IDIt->second;
+  if ((ID >= slots.size()) || !slots[ID]
+      || (static_cast<Value *>(*slots[ID]) != V)) {
+    return nullopt;
+  }
+  return ID;
+}
+
+Instruction *IDToValueIndex::getInstruction(IDType ID) {
+  return lookup<Instruction>(instructionSlots, ID);
+}
+
+Function *IDToValueIndex::getFunction(IDType ID) {
+  return lookup<Function>(functionSlots, ID);
+}
+
+optional<IDType> IDToValueIndex::getInstructionID(Instruction *I) {
+  if (auto ID = lookupID(instructionSlots, I)) {
+    return ID;
+  }
+  return UniqueIRMarkerReader::getInstructionID(I);
+}
+
+optional<IDType> IDToValueIndex::getFunctionID(Function *F) {
+  if (auto ID = lookupID(functionSlots, F)) {
+    return ID;
+  }
+  return UniqueIRMarkerReader::getFunctionID(F);
+}
+
 IDToInstructionMapper::IDToInstructionMapper(Module &M)
   : InstVisitor<IDToInstructionMapper>(),
     Mod(M),
@@ -15,10 +124,13 @@ IDToInstructionMapper::IDToInstructionMapper(Module &M)
 
 std::unique_ptr<std::map<IDType, Instruction *>> IDToInstructionMapper::
     idToValueMap(std::set<IDType> &IDs) {
-  relevantIDs = &IDs;
+  auto &index = IDToValueIndex::getIndex(Mod);
   auto map = std::make_unique<std::map<IDType, Instruction *>>();
-  mapping = map.get();
-  this->visit(Mod);
+  for (auto IID : IDs) {
+    if (auto I = index.getInstruction(IID)) {
+      map->insert(std::pair<IDType, Instruction *>(IID, I));
+    }
+  }
   return map;
 }
 
@@ -39,10 +151,13 @@ IDToFunctionMapper::IDToFunctionMapper(Module &M)
 
 std::unique_ptr<std::map<IDType, Function *>> IDToFunctionMapper::idToValueMap(
     std::set<IDType> &IDs) {
-  relevantIDs = &IDs;
+  auto &index = IDToValueIndex::getIndex(Mod);
   auto map = std::make_unique<std::map<IDType, Function *>>();
-  mapping = map.get();
-  this->visit(Mod);
+  for (auto FID : IDs) {
+    if (auto F = index.getFunction(FID)) {
+      map->insert(std::pair<IDType, Function *>(FID, F));
+    }
+  }
   return map;
 }
 
@@ -1,6 +1,7 @@
 #include "noelle/core/UniqueIRMarker.hpp"
 #include "noelle/core/UniqueIRVerifier.hpp"
 #include "noelle/core/UniqueIRMarkerPass.hpp"
+#include "noelle/core/IDToValueMapper.hpp"
 
 using namespace llvm;
 
@@ -38,6 +39,7 @@ bool UniqueIRMarkerPass::runOnModule(Module &M) {
   if (InstrumentModule || ReinstrumentModule || RenumberModule) {
     UniqueIRMarker walker{ *this, mode };
     walker.visit(M);
+    IDToValueIndex::invalidate(M);
     return false;
   } else if (VerifyModule) {
     UniqueIRVerifier walker{ *this };
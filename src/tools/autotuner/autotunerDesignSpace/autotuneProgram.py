@@ -35,6 +35,102 @@ class autotuneProgram(MeasurementInterface):
   designSpace = array.array('i')
   configurationsExplored = 0
   configurationsRun = 0
+  parametersPerLoop = 9
+
+  # Loops described by the parallelization planner (see DESIGN_SPACE_FILE)
+  # Each loop index is mapped to the pair (index of its parent, savings)
+  designSpaceLoops = None
+  minimumSavings = 0.0
+  tunedTree = None
+  baseConfiguration = None
+
+  def loadDesignSpace(self):
+    """
+    Read the loops that are worth tuning.
+    The file DESIGN_SPACE_FILE is generated by the parallelization planner
+    (option -noelle-planner-design-space).
+    If AUTOTUNER_TREE is set, only the loops of the nesting tree with that root
+    are tuned, while the other loops keep the values of
+    AUTOTUNER_BASE_CONFIGURATION (or 0 if it is not set).
+    """
+    if (self.designSpaceLoops is not None):
+      return
+    self.designSpaceLoops = {}
+    if ('DESIGN_SPACE_FILE' not in os.environ):
+      return
+
+    with open(os.environ['DESIGN_SPACE_FILE'], 'r') as f:
+      for line in f:
+        elems = line.split()
+        if (len(elems) != 3):
+          continue
+        self.designSpaceLoops[int(elems[0])] = (int(elems[1]), float(elems[2]))
+
+    if ('AUTOTUNER_MINIMUM_SAVINGS' in os.environ):
+      self.minimumSavings = float(os.environ['AUTOTUNER_MINIMUM_SAVINGS'])
+    if ('AUTOTUNER_TREE' in os.environ):
+      self.tunedTree = int(os.environ['AUTOTUNER_TREE'])
+    if ('AUTOTUNER_BASE_CONFIGURATION' in os.environ):
+      self.baseConfiguration = utils.readFile(os.environ['AUTOTUNER_BASE_CONFIGURATION'])
+
+    return
+
+
+  def getRootOfLoop(self, loop):
+    parent = self.designSpaceLoops[loop][0]
+    while (parent in self.designSpaceLoops):
+      loop = parent
+      parent = self.designSpaceLoops[loop][0]
+
+    return loop
+
+
+  def isLoopWorthTuning(self, loop):
+    """
+    Loops not described by the planner cannot be parallelized, and loops that
+    do not save enough time stay sequential.
+    """
+    if (not self.designSpaceLoops):
+      return True
+    if (loop not in self.designSpaceLoops):
+      return False
+    if (self.designSpaceLoops[loop][1] <= self.minimumSavings):
+      return False
+
+    return True
+
+
+  def isDimensionTuned(self, param):
+    loop = param // self.parametersPerLoop
+    if (not self.isLoopWorthTuning(loop)):
+      return False
+    if (self.designSpaceLoops and (self.tunedTree is not None)):
+      if (self.getRootOfLoop(loop) != self.tunedTree):
+        return False
+
+    return True
+
+
+  def fixUntunedParameters(self, indexes):
+    """
+    Set the dimensions not tuned to the values they keep during the tuning.
+    """
+    if (not self.designSpaceLoops):
+      return
+
+    param = 0
+    for index in indexes:
+      loop = param // self.parametersPerLoop
+      if (not self.isLoopWorthTuning(loop)):
+        indexes[int(param)] = 0
+      elif (not self.isDimensionTuned(param)):
+        value = 0
+        if ((self.baseConfiguration is not None) and (param < len(self.baseConfiguration))):
+          value = self.baseConfiguration[param]
+        indexes[int(param)] = value
+      param += 1
+
+    return
 
   def manipulator(self):
     """
@@ -50,6 +146,10 @@ class autotuneProgram(MeasurementInterface):
     inputFile = os.environ['RANGE_FILE']
     ranges = utils.readFile(inputFile)
 
+    # Read the loops worth tuning
+    self.loadDesignSpace()
+    tunedPoints = 1
+
     # Describe the design space to opentuner
     param = 0
     manipulator = ConfigurationManipulator()
@@ -59,11 +159,12 @@ class autotuneProgram(MeasurementInterface):
       if defineDesignSpace:
         self.designSpace.append(elem)
 
-      # Check if the current dimension has a cardinality higher than 1
-      if elem > 1:
+      # Check if the current dimension has a cardinality higher than 1 and it needs to be tuned
+      if elem > 1 and self.isDimensionTuned(param):
+        tunedPoints *= elem
 
         # Check the type of the parameter
-        paramType = param % 9
+        paramType = param % self.parametersPerLoop
 
         # Create the parameter
         if paramType == 0:
@@ -127,6 +228,7 @@ class autotuneProgram(MeasurementInterface):
 
     if defineDesignSpace:
       sys.stderr.write('AUTOTUNER:     Whole design space (' + str(len(self.designSpace))+ ') = ' + str(self.designSpace) + '\n')
+      sys.stderr.write('AUTOTUNER:     Points of the design space to tune = ' + str(tunedPoints) + '\n')
 
     return manipulator
 
@@ -293,6 +395,7 @@ class autotuneProgram(MeasurementInterface):
 
     # Fetch the configuration
     indexes = utils.getIndexesOfLength(cfg, len(self.designSpace) - 1)
+    self.fixUntunedParameters(indexes)
 
     # Erase parameters that do not make sense
     self.eraseUselessParameters(indexes)
@@ -372,6 +475,7 @@ class autotuneProgram(MeasurementInterface):
 
     # Fetch the configuration
     indexes = utils.getIndexesOfLength(cfg, len(self.designSpace) - 1)
+    self.fixUntunedParameters(indexes)
 
     # Erase parameters that do not make sense
     self.eraseUselessParameters(indexes)
@@ -424,6 +528,23 @@ class autotuneProgram(MeasurementInterface):
 
       param += 1
 
+    # Erase the parameters of loops included in a parallelized loop: parallelizing a loop disables the parallelization of the loops it includes
+    # Configurations that differ only in these parameters are therefore equivalent, and they are evaluated only once
+    if self.designSpaceLoops:
+      for loop in self.designSpaceLoops:
+        parent = self.designSpaceLoops[loop][0]
+        isIncludedInParallelizedLoop = False
+        while (parent in self.designSpaceLoops):
+          parentParam = parent * self.parametersPerLoop
+          if ((parentParam < len(indexes)) and (indexes[parentParam] != 0)):
+            isIncludedInParallelizedLoop = True
+            break
+          parent = self.designSpaceLoops[parent][0]
+        if not isIncludedInParallelizedLoop:
+          continue
+        for param in range(loop * self.parametersPerLoop, min((loop + 1) * self.parametersPerLoop, len(indexes))):
+          indexes[param] = 0
+
     # Erase parameters currently not used
     param = 0
     for index in indexes:
@@ -0,0 +1,363 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "BlockerReport.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<uint32_t> MaximumBlockers(
+    "noelle-blocker-report-max",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init(20),
+    cl::desc("Number of blocking SCCs and of loop-carried dependences to "
+             "print"));
+
+void BlockerReport::collectBlockers(Noelle &noelle,
+                                    Hot *profiles,
+                                    LoopStructure *ls) {
+
+  /*
+   * Check if the loop has been executed.
+   */
+  auto loopInsts = (double)profiles->getTotalInstructions(ls);
+  if (false || (loopInsts == 0) || (profiles->getIterations(ls) == 0)) {
+    return;
+  }
+
+  /*
+   * Some loops cannot be DOALL whatever their dependences are.
+   */
+  std::string reason;
+  if (!DOALL::canBeAppliedToLoopStructure(ls, reason)) {
+    this->structuralBlockers.push_back(std::make_pair(ls, reason));
+    return;
+  }
+
+  /*
+   * Fetch the SCCs that block DOALL.
+   */
+  auto optimizations = {
+    LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+    LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID
+  };
+  auto ldi = noelle.getLoop(ls, optimizations);
+  auto blockingSCCs = DOALL::getSCCsThatBlockDOALLToBeApplicable(ldi, noelle);
+  if (blockingSCCs.empty()) {
+    delete ldi;
+    return;
+  }
+
+  /*
+   * The planner saves the instructions of the loop that are not in its biggest
+   * blocking SCC (see Planner). Hence, removing a blocker saves time only if
+   * it shrinks the biggest blocking SCC, and down to the next biggest one at
+   * most.
+   */
+  std::unordered_map<SCC *, uint64_t> blockingInsts;
+  uint64_t biggestInsts = 0;
+  for (auto scc : blockingSCCs) {
+    auto sccInsts = profiles->getTotalInstructions(scc);
+    blockingInsts[scc] = sccInsts;
+    biggestInsts = std::max(biggestInsts, sccInsts);
+  }
+  auto coverage = profiles->getDynamicTotalInstructionCoverage(ls);
+  auto computeSavedTime = [&](SCC *scc, uint64_t remainingInsts) -> double {
+    auto newBiggestInsts = remainingInsts;
+    for (auto &pair : blockingInsts) {
+      if (pair.first != scc) {
+        newBiggestInsts = std::max(newBiggestInsts, pair.second);
+      }
+    }
+    return (((double)(biggestInsts - newBiggestInsts)) / loopInsts) * coverage;
+  };
+
+  /*
+   * Attribute the time lost to the SCCs and to their loop-carried data
+   * dependences.
+   */
+  auto sccManager = ldi->getSCCManager();
+  for (auto scc : blockingSCCs) {
+
+    /*
+     * Collect the loop-carried data dependences of the SCC by the
+     * instructions they connect: all of them must be removed to remove the
+     * dependence between these instructions.
+     */
+    std::vector<std::pair<Value *, Value *>> pairs;
+    std::map<std::pair<Value *, Value *>, std::vector<DGEdge<Value> *>>
+        pairDependences;
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [&pairs, &pairDependences](DGEdge<Value> *dep) -> bool {
+          if (dep->isControlDependence()) {
+            return false;
+          }
+          auto pair = std::make_pair(dep->getOutgoingT(), dep->getIncomingT());
+          auto &deps = pairDependences[pair];
+          if (deps.empty()) {
+            pairs.push_back(pair);
+          }
+          deps.push_back(dep);
+          return false;
+        });
+
+    /*
+     * The SCC is identified by its heaviest instruction.
+     */
+    Instruction *heaviestInst = nullptr;
+    uint64_t heaviestInstInsts = 0;
+    scc->iterateOverInstructions([&](Instruction *inst) -> bool {
+      auto instInsts = profiles->getTotalInstructions(inst);
+      if (false || (heaviestInst == nullptr)
+          || (instInsts > heaviestInstInsts)) {
+        heaviestInst = inst;
+        heaviestInstInsts = instInsts;
+      }
+      return false;
+    });
+    Blocker sccBlocker;
+    sccBlocker.loop = ls;
+    sccBlocker.savedTime = computeSavedTime(scc, 0);
+    sccBlocker.description = std::to_string(scc->numberOfInstructions())
+                             + " instructions, "
+                             + std::to_string(pairs.size())
+                             + " loop-carried data dependences";
+    sccBlocker.from = heaviestInst;
+    sccBlocker.to = nullptr;
+    this->sccs.push_back(sccBlocker);
+
+    /*
+     * Attribute the time of the SCC to its dependences.
+     */
+    for (auto &pair : pairs) {
+      auto remainingInsts =
+          this->computeBlockingInstructionsWithout(profiles,
+                                                   ldi,
+                                                   scc,
+                                                   pair.first,
+                                                   pair.second);
+      Blocker depBlocker;
+      depBlocker.loop = ls;
+      depBlocker.savedTime = computeSavedTime(scc, remainingInsts);
+      depBlocker.description = "";
+      for (auto dep : pairDependences[pair]) {
+        if (depBlocker.description != "") {
+          depBlocker.description += "; ";
+        }
+        depBlocker.description += this->describeDependence(dep);
+      }
+      depBlocker.from = dyn_cast<Instruction>(pair.first);
+      depBlocker.to = dyn_cast<Instruction>(pair.second);
+      this->dependences.push_back(depBlocker);
+    }
+  }
+
+  /*
+   * Free the memory.
+   */
+  delete ldi;
+
+  return;
+}
+
+uint64_t BlockerReport::computeBlockingInstructionsWithout(
+    Hot *profiles,
+    LoopDependenceInfo *ldi,
+    SCC *scc,
+    Value *from,
+    Value *to) const {
+  auto loopDG = ldi->getLoopDG();
+  auto isRemoved = [from, to](DGEdge<Value> *edge) -> bool {
+    return true && edge->isLoopCarriedDependence()
+           && (!edge->isControlDependence()) && (edge->getOutgoingT() == from)
+           && (edge->getIncomingT() == to);
+  };
+
+  /*
+   * The SCC does not split if @from still reaches @to within it.
+   */
+  std::unordered_set<Value *> reached;
+  std::queue<DGNode<Value> *> nodesToVisit;
+  nodesToVisit.push(loopDG->fetchNode(from));
+  while (!nodesToVisit.empty()) {
+    auto node = nodesToVisit.front();
+    nodesToVisit.pop();
+    for (auto edge : node->getOutgoingEdges()) {
+      auto next = edge->getIncomingT();
+      if (false || isRemoved(edge) || (!scc->isInternal(next))) {
+        continue;
+      }
+      if (next == to) {
+        return profiles->getTotalInstructions(scc);
+      }
+      if (reached.insert(next).second) {
+        nodesToVisit.push(edge->getIncomingNode());
+      }
+    }
+  }
+
+  /*
+   * The SCC splits.
+   * Its parts that still have a cycle with a loop-carried data dependence
+   * keep blocking DOALL.
+   */
+  auto includeNode = [scc](DGNode<Value> *node) -> bool {
+    return scc->isInternal(node->getT());
+  };
+  auto includeEdge = [&isRemoved](DGEdge<Value> *edge) -> bool {
+    return !isRemoved(edge);
+  };
+  SCCDAG parts(loopDG, includeNode, includeEdge);
+  uint64_t blockingInsts = 0;
+  for (auto part : parts.getSCCs()) {
+    if (!part->hasCycle()) {
+      continue;
+    }
+    auto hasLoopCarriedDataDependence = false;
+    for (auto edge : part->getEdges()) {
+      if (true && edge->isLoopCarriedDependence()
+          && (!edge->isControlDependence())
+          && part->isInternal(edge->getOutgoingT())
+          && part->isInternal(edge->getIncomingT())) {
+        hasLoopCarriedDataDependence = true;
+        break;
+      }
+    }
+    if (hasLoopCarriedDataDependence) {
+      blockingInsts =
+          std::max(blockingInsts, profiles->getTotalInstructions(part));
+    }
+  }
+
+  return blockingInsts;
+}
+
+std::string BlockerReport::describeDependence(DGEdge<Value> *dependence) const {
+  auto description = dependence->dataDepToString();
+  if (!dependence->isMemoryDependence()) {
+    return description + " register";
+  }
+  description +=
+      dependence->isMustDependence() ? " must memory" : " may memory";
+
+  /*
+   * Calls whose accesses are unknown depend on every memory access of the
+   * loop. Library specifications (see -noelle-library-spec) can remove them.
+   */
+  if (false || isa<CallBase>(dependence->getOutgoingT())
+      || isa<CallBase>(dependence->getIncomingT())) {
+    return description + " (conservative call edge)";
+  }
+
+  /*
+   * The analyses of the precision tier of the PDG could not disprove the
+   * dependence.
+   */
+  description += " (LLVM AA";
+  if (this->precision != PDGPrecision::LLVMAliasAnalyses) {
+    description += ", SVF";
+  }
+  if (this->precision == PDGPrecision::Full) {
+    description += ", SCAF";
+  }
+  description += ")";
+
+  return description;
+}
+
+void BlockerReport::printReport(void) const {
+
+  /*
+   * Rank the blockers by the time saved without them.
+   */
+  auto compareOperator = [](const Blocker *b1, const Blocker *b2) {
+    if (b1->savedTime != b2->savedTime) {
+      return b1->savedTime > b2->savedTime;
+    }
+    return b1->loop->getID() < b2->loop->getID();
+  };
+  auto rank = [&compareOperator](const std::vector<Blocker> &blockers) {
+    std::vector<const Blocker *> ranking;
+    for (auto &blocker : blockers) {
+      ranking.push_back(&blocker);
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), compareOperator);
+    if (ranking.size() > MaximumBlockers) {
+      ranking.resize(MaximumBlockers);
+    }
+    return ranking;
+  };
+
+  /*
+   * Print the loops blocked by their structure.
+   */
+  errs() << "Blockers of the hot loops that are not DOALL\n";
+  if (this->structuralBlockers.size() > 0) {
+    errs() << "Loops blocked by their structure\n";
+    for (auto &pair : this->structuralBlockers) {
+      errs() << "  Loop " << pair.first->getID() << " \""
+             << pair.first->getFunction()->getName() << "\": " << pair.second
+             << "\n";
+    }
+  }
+
+  /*
+   * Print the SCCs.
+   */
+  errs() << "Blocking SCCs ranked by the time saved without them\n";
+  errs() << "  Rank  Loop    Saved  SCC\n";
+  auto position = 1;
+  for (auto blocker : rank(this->sccs)) {
+    errs() << format("  %4d  %4lu  %6.2f%%  ",
+                     position++,
+                     (uint64_t)blocker->loop->getID(),
+                     blocker->savedTime * 100);
+    errs() << blocker->description << " in \""
+           << blocker->loop->getFunction()->getName() << "\"\n";
+    errs() << "                       Heaviest: " << *blocker->from << "\n";
+  }
+
+  /*
+   * Print the dependences.
+   */
+  errs() << "Loop-carried data dependences ranked by the time saved without "
+            "them\n";
+  errs() << "  Rank  Loop    Saved  Dependences\n";
+  position = 1;
+  for (auto blocker : rank(this->dependences)) {
+    errs() << format("  %4d  %4lu  %6.2f%%  ",
+                     position++,
+                     (uint64_t)blocker->loop->getID(),
+                     blocker->savedTime * 100);
+    errs() << blocker->description << "\n";
+    if (blocker->from != nullptr) {
+      errs() << "                       From: " << *blocker->from << "\n";
+    }
+    if (blocker->to != nullptr) {
+      errs() << "                       To:   " << *blocker->to << "\n";
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/LoopDependenceInfo.hpp"
+#include "noelle/core/SCCDAG.hpp"
+#include "noelle/core/Noelle.hpp"
+#include "DOALL.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Attribution of the time lost by the hot loops that are not DOALL to what
+ * blocks them: their sequential SCCs (see
+ * DOALL::getSCCsThatBlockDOALLToBeApplicable) and the loop-carried data
+ * dependences within these SCCs.
+ * Blockers are ranked by the time the planner would save if they did not
+ * exist, so the report tells where annotations, library specifications, or
+ * more precise analyses pay off most.
+ */
+class BlockerReport : public ModulePass {
+public:
+  BlockerReport();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /*
+   * Class fields
+   */
+  static char ID;
+
+private:
+  /*
+   * A blocking SCC, or the loop-carried data dependences from an instruction
+   * to another one of a blocking SCC.
+   * @savedTime is the fraction of the execution time of the program that
+   * the planner would save without the blocker.
+   * SCCs are identified by their heaviest instruction (@from).
+   */
+  class Blocker {
+  public:
+    LoopStructure *loop;
+    double savedTime;
+    std::string description;
+    Instruction *from;
+    Instruction *to;
+  };
+
+  /*
+   * Fields
+   */
+  std::vector<Blocker> sccs;
+  std::vector<Blocker> dependences;
+  std::vector<std::pair<LoopStructure *, std::string>> structuralBlockers;
+  PDGPrecision precision;
+
+  /*
+   * Methods
+   */
+  void collectBlockers(Noelle &noelle, Hot *profiles, LoopStructure *ls);
+
+  /*
+   * Return the dynamic instructions of the biggest part of @scc that still
+   * blocks DOALL once the loop-carried data dependences from @from to @to are
+   * removed: a cycle with a loop-carried data dependence.
+   */
+  uint64_t computeBlockingInstructionsWithout(Hot *profiles,
+                                              LoopDependenceInfo *ldi,
+                                              SCC *scc,
+                                              Value *from,
+                                              Value *to) const;
+
+  /*
+   * Describe a loop-carried dependence and the analyses that failed to
+   * disprove it.
+   */
+  std::string describeDependence(DGEdge<Value> *dependence) const;
+
+  void printReport(void) const;
+};
+
+} // namespace llvm::noelle
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "BlockerReport.hpp"
+
+namespace llvm::noelle {
+
+BlockerReport::BlockerReport()
+  : ModulePass{ ID },
+    precision{ PDGPrecision::Full } {
+
+  return;
+}
+
+bool BlockerReport::doInitialization(Module &M) {
+  return false;
+}
+
+bool BlockerReport::runOnModule(Module &M) {
+
+  /*
+   * Fetch NOELLE.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+
+  /*
+   * Fetch the profiles.
+   */
+  auto profiles = noelle.getProfiles();
+  if (!profiles->isAvailable()) {
+    errs() << "BlockerReport: the module has no profiles (see "
+              "noelle-meta-prof-embed)\n";
+    return false;
+  }
+
+  /*
+   * Fetch the hot loops.
+   */
+  auto programLoops = noelle.getLoopStructures();
+  if (programLoops->size() == 0) {
+    errs() << "BlockerReport: there is no hot loop\n";
+    delete programLoops;
+    return false;
+  }
+
+  /*
+   * Collect what blocks every loop.
+   * The analyses that could have disproved the memory dependences are the ones
+   * of the precision tier of the PDG.
+   */
+  this->precision = PDGAnalysis::getPrecision();
+  for (auto ls : *programLoops) {
+    this->collectBlockers(noelle, profiles, ls);
+  }
+  delete programLoops;
+
+  /*
+   * Print the report.
+   */
+  this->printReport();
+
+  return false;
+}
+
+void BlockerReport::getAnalysisUsage(AnalysisUsage &AU) const {
+
+  /*
+   * Analyses.
+   */
+  AU.addRequired<LoopInfoWrapperPass>();
+  AU.addRequired<ScalarEvolutionWrapperPass>();
+  AU.addRequired<DominatorTreeWrapperPass>();
+  AU.addRequired<PostDominatorTreeWrapperPass>();
+
+  /*
+   * Noelle.
+   */
+  AU.addRequired<Noelle>();
+
+  /*
+   * The report does not modify the code.
+   */
+  AU.setPreservesAll();
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+// Next there is code to register your pass to "opt"
+char llvm::noelle::BlockerReport::ID = 0;
+static RegisterPass<BlockerReport> X(
+    "BlockerReport",
+    "Rank what blocks the parallelization of the hot loops");
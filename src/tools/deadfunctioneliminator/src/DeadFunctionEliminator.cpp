@@ -144,8 +144,12 @@ bool DeadFunctionEliminator::runOnModule(Module &M) {
     assert(callInst->getCalledFunction() == nodeFunction);
     errs() << "DeadFunctionEliminator: Inline " << *callInst << " into "
            << callInst->getFunction()->getName() << "\n";
+    auto callerFunction = callInst->getFunction();
     InlineFunctionInfo IFI;
-    modified |= InlineFunction(callInst, IFI);
+    if (InlineFunction(callInst, IFI)) {
+      pcg->refreshFunction(callerFunction);
+      modified = true;
+    }
   }
   if (modified) {
     return true;
@@ -200,6 +204,15 @@ bool DeadFunctionEliminator::runOnModule(Module &M) {
         << "DeadFunctionEliminator: Function " << F.getName() << " is dead\n";
     toDelete.push_back(&F);
   }
+  for (auto f : toDelete) {
+
+    /*
+     * Dead functions can invoke each other.
+     * Hence, drop their bodies first.
+     */
+    pcg->removeFunction(f);
+    f->dropAllReferences();
+  }
   for (auto f : toDelete) {
     f->eraseFromParent();
     modified = true;
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "EarlyDeadFunctionEliminator.hpp"
+
+namespace llvm::noelle {
+
+EarlyDeadFunctionEliminator::EarlyDeadFunctionEliminator()
+  : ModulePass{ ID },
+    enableTransformation{ true } {
+
+  return;
+}
+
+bool EarlyDeadFunctionEliminator::runOnModule(Module &M) {
+
+  /*
+   * Check if the transformation is enabled.
+   */
+  if (!this->enableTransformation) {
+    return false;
+  }
+
+  /*
+   * Check the module is a whole program.
+   */
+  if (M.getFunction("main") == nullptr) {
+    return false;
+  }
+  errs() << "EarlyDeadFunctionEliminator: Start\n";
+
+  /*
+   * Build the call graph of the direct calls.
+   *
+   * Indirect calls do not add edges: they can only invoke functions whose
+   * address escapes, and the islands of such functions are kept alive.
+   */
+  auto hasIndCSCallees = [](CallInst *) -> bool { return false; };
+  auto getIndCSCallees =
+      [](CallInst *) -> const std::set<const Function *> { return {}; };
+  CallGraph cg(M, hasIndCSCallees, getIndCSCallees);
+
+  /*
+   * Delete dead functions and then the globals only they used.
+   */
+  auto modified = this->deleteDeadFunctions(M, cg);
+  modified |= this->deleteDeadGlobals(M);
+
+  errs() << "EarlyDeadFunctionEliminator: Exit\n";
+
+  return modified;
+}
+
+bool EarlyDeadFunctionEliminator::deleteDeadFunctions(Module &M,
+                                                      CallGraph &cg) {
+
+  /*
+   * Fetch the islands.
+   */
+  auto islands = cg.getIslands();
+
+  /*
+   * The island of the entry method of the program is alive.
+   */
+  auto entryF = M.getFunction("main");
+  std::unordered_set<CallGraph *> liveIslands{ islands[entryF] };
+
+  /*
+   * The islands of the functions that can escape are alive too.
+   * This includes the constructors, the destructors, and the functions
+   * invoked indirectly.
+   */
+  for (auto &F : M) {
+    if (F.isIntrinsic()) {
+      continue;
+    }
+    if (!cg.canFunctionEscape(&F)) {
+      continue;
+    }
+    liveIslands.insert(islands[&F]);
+  }
+
+  /*
+   * Collect the dead functions.
+   */
+  std::vector<Function *> toDelete;
+  for (auto &F : M) {
+    if (F.isIntrinsic()) {
+      continue;
+    }
+    if (F.empty()) {
+      continue;
+    }
+    if (liveIslands.find(islands[&F]) != liveIslands.end()) {
+      continue;
+    }
+
+    errs() << "EarlyDeadFunctionEliminator: Function " << F.getName()
+           << " is dead\n";
+    toDelete.push_back(&F);
+  }
+
+  /*
+   * Delete the dead functions.
+   * Dead functions can invoke each other, so we drop their bodies first.
+   */
+  for (auto f : toDelete) {
+    f->dropAllReferences();
+  }
+  for (auto f : toDelete) {
+    f->eraseFromParent();
+  }
+
+  return !toDelete.empty();
+}
+
+bool EarlyDeadFunctionEliminator::deleteDeadGlobals(Module &M) {
+
+  /*
+   * Deleting a global can leave unused the globals its initializer refers to.
+   * Hence, iterate until a fixed point is reached.
+   */
+  auto modified = false;
+  auto deleted = true;
+  while (deleted) {
+    deleted = false;
+
+    /*
+     * Collect the internal globals that are not used anymore.
+     */
+    std::vector<GlobalVariable *> toDelete;
+    for (auto &G : M.globals()) {
+      if (!G.hasLocalLinkage()) {
+        continue;
+      }
+      G.removeDeadConstantUsers();
+      if (!G.use_empty()) {
+        continue;
+      }
+      toDelete.push_back(&G);
+    }
+
+    /*
+     * Delete them.
+     */
+    for (auto g : toDelete) {
+      errs() << "EarlyDeadFunctionEliminator: Global " << g->getName()
+             << " is dead\n";
+      g->eraseFromParent();
+      deleted = true;
+      modified = true;
+    }
+  }
+
+  return modified;
+}
+
+} // namespace llvm::noelle
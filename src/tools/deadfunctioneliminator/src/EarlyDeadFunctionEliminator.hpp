@@ -0,0 +1,69 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "llvm/Pass.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "noelle/core/CallGraph.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Delete the functions and the globals that cannot be reached from the entry
+ * point of the program.
+ *
+ * This pass does not depend on the PDG: it relies on a call graph built from
+ * the direct calls of the module only. Hence, it can run before the PDG and
+ * SVF are computed, which reduces the code they need to analyze.
+ */
+class EarlyDeadFunctionEliminator : public ModulePass {
+public:
+  EarlyDeadFunctionEliminator();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /*
+   * Class fields
+   */
+  static char ID;
+
+private:
+  /*
+   * Fields
+   */
+  bool enableTransformation;
+
+  /*
+   * Methods
+   */
+  bool deleteDeadFunctions(Module &M, CallGraph &cg);
+
+  bool deleteDeadGlobals(Module &M);
+};
+
+} // namespace llvm::noelle
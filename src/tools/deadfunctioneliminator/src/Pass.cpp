@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "DeadFunctionEliminator.hpp"
+#include "EarlyDeadFunctionEliminator.hpp"
 
 static cl::opt<bool> DisableDead("noelle-disable-dead",
                                  cl::ZeroOrMore,
@@ -40,10 +41,25 @@ void DeadFunctionEliminator::getAnalysisUsage(AnalysisUsage &AU) const {
   return;
 }
 
+bool EarlyDeadFunctionEliminator::doInitialization(Module &M) {
+  if (DisableDead.getNumOccurrences() > 0) {
+    this->enableTransformation = false;
+  }
+  return false;
+}
+
+void EarlyDeadFunctionEliminator::getAnalysisUsage(AnalysisUsage &AU) const {
+  return;
+}
+
 // Next there is code to register your pass to "opt"
 char DeadFunctionEliminator::ID = 0;
 static RegisterPass<DeadFunctionEliminator> X("noelle-dfe",
                                               "Dead function eliminator");
+char EarlyDeadFunctionEliminator::ID = 0;
+static RegisterPass<EarlyDeadFunctionEliminator> Y(
+    "noelle-dfe-early",
+    "Dead function eliminator that runs before the PDG is computed");
 
 // Next there is code to register your pass to "clang"
 static DeadFunctionEliminator *_PassMaker = NULL;
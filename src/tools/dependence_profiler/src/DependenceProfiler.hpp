@@ -0,0 +1,94 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Noelle.hpp"
+#include "noelle/core/LoopCarriedDependenceProfiles.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Profiler of the loop-carried memory dependences of the hot loops.
+ *
+ * The instrumented binary appends to DependenceProfilerInstrumenter::
+ * defaultFileName one line per profiled dependence as
+ * "CHECKS MANIFESTATIONS SOURCE_INDEX DESTINATION_INDEX FUNCTION", where the
+ * indices are the positions of the instructions within their function.
+ * Hence, the profiles can be embedded only into the bitcode that has been
+ * instrumented.
+ */
+class DependenceProfilerInstrumenter : public ModulePass {
+public:
+  static char ID;
+
+  static constexpr const char *defaultFileName =
+      "noelle_dependence_profiles.txt";
+
+  /*
+   * Values tracked for each dependence.
+   */
+  enum State : uint64_t {
+    LAST_ITERATION = 0,
+    LAST_START,
+    LAST_END,
+    CHECKS,
+    MANIFESTATIONS,
+    STATE_SIZE
+  };
+
+  DependenceProfilerInstrumenter();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+private:
+  struct ProfiledDependence {
+    Instruction *from;
+    Instruction *to;
+    LoopStructure *loop;
+  };
+
+  std::vector<ProfiledDependence> fetchDependences(Noelle &noelle);
+
+  Function *createDumpFunction(Module &M,
+                               GlobalVariable *states,
+                               std::vector<std::string> &names);
+};
+
+class DependenceProfilerEmbedder : public ModulePass {
+public:
+  static char ID;
+
+  DependenceProfilerEmbedder();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+};
+
+} // namespace llvm::noelle
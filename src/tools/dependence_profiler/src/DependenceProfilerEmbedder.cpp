@@ -0,0 +1,171 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include "DependenceProfiler.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<std::string> ProfilesFile(
+    "noelle-dependence-profiles-file",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File with the profiles dumped by the dependences "
+             "instrumented by noelle-dependence-profiler-instr"));
+
+DependenceProfilerEmbedder::DependenceProfilerEmbedder() : ModulePass(ID) {
+  return;
+}
+
+bool DependenceProfilerEmbedder::doInitialization(Module &M) {
+  return false;
+}
+
+bool DependenceProfilerEmbedder::runOnModule(Module &M) {
+
+  /*
+   * Open the file with the profiles.
+   */
+  std::string fileName = DependenceProfilerInstrumenter::defaultFileName;
+  if (ProfilesFile.getNumOccurrences() > 0) {
+    fileName = ProfilesFile.getValue();
+  }
+  std::ifstream file(fileName);
+  if (!file.good()) {
+    errs() << "DependenceProfilerEmbedder: Warning = file " << fileName
+           << " cannot be read\n";
+    return false;
+  }
+
+  /*
+   * Read the profiles.
+   * Each line is "CHECKS MANIFESTATIONS SOURCE_INDEX DESTINATION_INDEX
+   * FUNCTION_NAME". Several runs of the program append to the same file, so
+   * the values of a dependence are summed.
+   */
+  std::map<std::string,
+           std::map<std::pair<uint64_t, uint64_t>,
+                    std::pair<uint64_t, uint64_t>>>
+      profiles;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream lineStream(line);
+    uint64_t checks = 0;
+    uint64_t manifestations = 0;
+    uint64_t sourceIndex = 0;
+    uint64_t destinationIndex = 0;
+    std::string functionName;
+    if (!(lineStream >> checks >> manifestations >> sourceIndex
+          >> destinationIndex)) {
+      continue;
+    }
+    lineStream >> std::ws;
+    std::getline(lineStream, functionName);
+    auto &profile = profiles[functionName][{ sourceIndex, destinationIndex }];
+    profile.first += checks;
+    profile.second += manifestations;
+  }
+  if (profiles.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Remove the profiles embedded before.
+   */
+  auto sourceMetadataName = LoopCarriedDependenceProfiles::sourceMetadataName;
+  auto metadataName = LoopCarriedDependenceProfiles::metadataName;
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      I.setMetadata(sourceMetadataName, nullptr);
+      I.setMetadata(metadataName, nullptr);
+    }
+  }
+
+  /*
+   * Embed the profiles.
+   */
+  auto &context = M.getContext();
+  auto int64 = IntegerType::get(context, 64);
+  auto getValueMetadata = [int64](uint64_t value) -> Metadata * {
+    return ConstantAsMetadata::get(ConstantInt::get(int64, value));
+  };
+  for (auto &F : M) {
+    auto found = profiles.find(F.getName().str());
+    if (found == profiles.end()) {
+      continue;
+    }
+
+    /*
+     * Map the indices to the instructions of the function.
+     */
+    std::vector<Instruction *> instructionsOfF;
+    for (auto &I : instructions(F)) {
+      instructionsOfF.push_back(&I);
+    }
+
+    /*
+     * Tag the sources and append the profiles to the destinations.
+     */
+    std::unordered_map<Instruction *, std::vector<Metadata *>> destinations;
+    for (auto &pair : found->second) {
+      auto sourceIndex = pair.first.first;
+      auto destinationIndex = pair.first.second;
+      if (false || (sourceIndex >= instructionsOfF.size())
+          || (destinationIndex >= instructionsOfF.size())) {
+        errs() << "DependenceProfilerEmbedder: Warning = the profiles of "
+               << F.getName() << " do not match its code\n";
+        break;
+      }
+      auto source = instructionsOfF[sourceIndex];
+      auto sourceID = source->getMetadata(sourceMetadataName);
+      if (sourceID == nullptr) {
+        sourceID = MDNode::getDistinct(context, {});
+        source->setMetadata(sourceMetadataName, sourceID);
+      }
+      auto destination = instructionsOfF[destinationIndex];
+      auto profile = MDNode::get(context,
+                                 { sourceID,
+                                   getValueMetadata(pair.second.first),
+                                   getValueMetadata(pair.second.second) });
+      destinations[destination].push_back(profile);
+    }
+    for (auto &pair : destinations) {
+      pair.first->setMetadata(metadataName, MDNode::get(context, pair.second));
+    }
+  }
+
+  return true;
+}
+
+void DependenceProfilerEmbedder::getAnalysisUsage(AnalysisUsage &AU) const {
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char DependenceProfilerEmbedder::ID = 0;
+static RegisterPass<DependenceProfilerEmbedder> X(
+    "noelle-dependence-profiler-embed",
+    "Embed the profiles of loop-carried memory dependences");
+
+} // namespace llvm::noelle
@@ -0,0 +1,424 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+#include "DependenceProfiler.hpp"
+
+namespace llvm::noelle {
+
+DependenceProfilerInstrumenter::DependenceProfilerInstrumenter()
+  : ModulePass(ID) {
+  return;
+}
+
+bool DependenceProfilerInstrumenter::doInitialization(Module &M) {
+  return false;
+}
+
+bool DependenceProfilerInstrumenter::runOnModule(Module &M) {
+
+  /*
+   * Fetch the dependences to profile.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+  auto dependences = this->fetchDependences(noelle);
+  if (dependences.size() == 0) {
+    return false;
+  }
+  errs() << "DependenceProfiler: Profile " << dependences.size()
+         << " loop-carried memory dependences\n";
+
+  /*
+   * Name the dependences by the positions of their instructions within their
+   * function.
+   * This must be done before the code is instrumented.
+   */
+  std::unordered_map<Instruction *, uint64_t> indices;
+  for (auto &dependence : dependences) {
+    auto F = dependence.to->getFunction();
+    if (indices.find(dependence.to) != indices.end()) {
+      continue;
+    }
+    uint64_t index = 0;
+    for (auto &I : instructions(F)) {
+      indices[&I] = index;
+      index++;
+    }
+  }
+  std::vector<std::string> names;
+  for (auto &dependence : dependences) {
+    names.push_back(std::to_string(indices[dependence.from]) + " "
+                    + std::to_string(indices[dependence.to]) + " "
+                    + dependence.to->getFunction()->getName().str());
+  }
+
+  /*
+   * Allocate the states of the dependences.
+   */
+  auto &DL = M.getDataLayout();
+  auto int64 = IntegerType::get(M.getContext(), 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto one = ConstantInt::get(int64, 1);
+  auto statesType =
+      ArrayType::get(int64, dependences.size() * State::STATE_SIZE);
+  auto states = new GlobalVariable(M,
+                                   statesType,
+                                   /*isConstant=*/false,
+                                   GlobalValue::InternalLinkage,
+                                   Constant::getNullValue(statesType),
+                                   "noelle.dependence_profiles.states");
+  auto getState = [states, int64, zero](IRBuilder<> &builder,
+                                         uint64_t dependenceIndex,
+                                         State state) -> Value * {
+    auto index = dependenceIndex * State::STATE_SIZE + state;
+    return builder.CreateInBoundsGEP(
+        states,
+        ArrayRef<Value *>({ zero, ConstantInt::get(int64, index) }));
+  };
+
+  /*
+   * Count the iterations of the loops.
+   * The first iteration of an invocation of a loop is the one after the last
+   * iteration of its previous invocation. Hence, two accesses belong to the
+   * same invocation if their iterations are not before the first one of the
+   * current invocation.
+   */
+  std::unordered_map<LoopStructure *, std::pair<Value *, Value *>> counters;
+  for (auto &dependence : dependences) {
+    auto loop = dependence.loop;
+    if (counters.find(loop) != counters.end()) {
+      continue;
+    }
+    auto iteration = new GlobalVariable(M,
+                                        int64,
+                                        /*isConstant=*/false,
+                                        GlobalValue::InternalLinkage,
+                                        zero,
+                                        "noelle.dependence_profiles.iteration");
+    auto firstIteration =
+        new GlobalVariable(M,
+                           int64,
+                           /*isConstant=*/false,
+                           GlobalValue::InternalLinkage,
+                           zero,
+                           "noelle.dependence_profiles.first_iteration");
+    counters[loop] = { iteration, firstIteration };
+
+    IRBuilder<> preHeaderBuilder{ loop->getPreHeader()->getTerminator() };
+    preHeaderBuilder.CreateStore(
+        preHeaderBuilder.CreateAdd(preHeaderBuilder.CreateLoad(iteration),
+                                   one),
+        firstIteration);
+
+    auto header = loop->getHeader();
+    IRBuilder<> headerBuilder{ &*header->getFirstInsertionPt() };
+    headerBuilder.CreateStore(
+        headerBuilder.CreateAdd(headerBuilder.CreateLoad(iteration), one),
+        iteration);
+  }
+
+  /*
+   * Group the dependences by their instructions.
+   */
+  std::vector<Instruction *> memoryAccesses;
+  std::unordered_map<Instruction *, std::vector<uint64_t>> dependencesFrom;
+  std::unordered_map<Instruction *, std::vector<uint64_t>> dependencesTo;
+  for (uint64_t index = 0; index < dependences.size(); index++) {
+    auto &dependence = dependences[index];
+    for (auto I : { dependence.from, dependence.to }) {
+      if (true && (dependencesFrom.find(I) == dependencesFrom.end())
+          && (dependencesTo.find(I) == dependencesTo.end())) {
+        memoryAccesses.push_back(I);
+      }
+    }
+    dependencesFrom[dependence.from].push_back(index);
+    dependencesTo[dependence.to].push_back(index);
+  }
+
+  /*
+   * Instrument the memory accesses.
+   * The destination of a dependence is checked before its source is recorded
+   * because an instruction can depend on itself.
+   */
+  for (auto I : memoryAccesses) {
+    IRBuilder<> builder{ I };
+    auto pointer = getLoadStorePointerOperand(I);
+    auto accessedType = cast<PointerType>(pointer->getType())->getElementType();
+    auto size = DL.getTypeStoreSize(accessedType);
+    auto start = builder.CreatePtrToInt(pointer, int64);
+    auto end = builder.CreateAdd(start, ConstantInt::get(int64, size));
+
+    /*
+     * Check if the last access of the source of a dependence happened in a
+     * previous iteration of the current invocation of the loop, and if it
+     * overlaps with the current one.
+     */
+    for (auto index : dependencesTo[I]) {
+      auto &loopCounters = counters[dependences[index].loop];
+      auto iteration = builder.CreateLoad(loopCounters.first);
+      auto firstIteration = builder.CreateLoad(loopCounters.second);
+      auto lastIteration =
+          builder.CreateLoad(getState(builder, index, LAST_ITERATION));
+      auto lastStart = builder.CreateLoad(getState(builder, index, LAST_START));
+      auto lastEnd = builder.CreateLoad(getState(builder, index, LAST_END));
+      auto isPreviousIteration = builder.CreateAnd(
+          builder.CreateICmpUGE(lastIteration, firstIteration),
+          builder.CreateICmpULT(lastIteration, iteration));
+      auto overlaps = builder.CreateAnd(builder.CreateICmpULT(lastStart, end),
+                                        builder.CreateICmpULT(start, lastEnd));
+      auto manifests = builder.CreateAnd(isPreviousIteration, overlaps);
+
+      auto checksPtr = getState(builder, index, CHECKS);
+      builder.CreateStore(builder.CreateAdd(builder.CreateLoad(checksPtr), one),
+                          checksPtr);
+      auto manifestationsPtr = getState(builder, index, MANIFESTATIONS);
+      builder.CreateStore(
+          builder.CreateAdd(builder.CreateLoad(manifestationsPtr),
+                            builder.CreateZExt(manifests, int64)),
+          manifestationsPtr);
+    }
+
+    /*
+     * Record the access of the source of a dependence.
+     */
+    for (auto index : dependencesFrom[I]) {
+      auto &loopCounters = counters[dependences[index].loop];
+      builder.CreateStore(builder.CreateLoad(loopCounters.first),
+                          getState(builder, index, LAST_ITERATION));
+      builder.CreateStore(start, getState(builder, index, LAST_START));
+      builder.CreateStore(end, getState(builder, index, LAST_END));
+    }
+  }
+
+  /*
+   * Dump the profiles when the program exits.
+   */
+  auto dumpFunction = this->createDumpFunction(M, states, names);
+  appendToGlobalDtors(M, dumpFunction, 0);
+
+  return true;
+}
+
+std::vector<DependenceProfilerInstrumenter::ProfiledDependence>
+DependenceProfilerInstrumenter::fetchDependences(Noelle &noelle) {
+  std::vector<ProfiledDependence> dependences;
+
+  /*
+   * Only plain loads and stores are instrumented.
+   */
+  auto canBeProfiled = [](Value *v) -> bool {
+    if (auto loadInst = dyn_cast<LoadInst>(v)) {
+      return loadInst->isSimple();
+    }
+    if (auto storeInst = dyn_cast<StoreInst>(v)) {
+      return storeInst->isSimple();
+    }
+    return false;
+  };
+
+  /*
+   * Fetch the loop-carried memory dependences of the hot loops.
+   * A dependence carried by several loops is profiled for the outermost one.
+   */
+  std::map<std::pair<Instruction *, Instruction *>, uint64_t> indices;
+  auto loops = noelle.getLoopStructures();
+  for (auto loop : *loops) {
+    if (loop->getPreHeader() == nullptr) {
+      continue;
+    }
+    auto LDI = noelle.getLoop(loop);
+    auto loopDG = LDI->getLoopDG();
+    for (auto dependence : loopDG->getEdges()) {
+      if (false || (!dependence->isLoopCarriedDependence())
+          || (!dependence->isMemoryDependence())) {
+        continue;
+      }
+      auto from = dependence->getOutgoingT();
+      auto to = dependence->getIncomingT();
+      if (false || (!canBeProfiled(from)) || (!canBeProfiled(to))) {
+        continue;
+      }
+      auto fromInst = cast<Instruction>(from);
+      auto toInst = cast<Instruction>(to);
+      if (false || (!loop->isIncluded(fromInst))
+          || (!loop->isIncluded(toInst))) {
+        continue;
+      }
+      auto found = indices.find({ fromInst, toInst });
+      if (found == indices.end()) {
+        indices[{ fromInst, toInst }] = dependences.size();
+        dependences.push_back({ fromInst, toInst, loop });
+        continue;
+      }
+      auto &profiledDependence = dependences[found->second];
+      if (loop->getNestingLevel()
+          < profiledDependence.loop->getNestingLevel()) {
+        profiledDependence.loop = loop;
+      }
+    }
+  }
+  delete loops;
+
+  return dependences;
+}
+
+Function *DependenceProfilerInstrumenter::createDumpFunction(
+    Module &M,
+    GlobalVariable *states,
+    std::vector<std::string> &names) {
+  auto &context = M.getContext();
+  auto voidType = Type::getVoidTy(context);
+  auto int32 = IntegerType::get(context, 32);
+  auto int64 = IntegerType::get(context, 64);
+  auto ptrType = PointerType::getUnqual(IntegerType::get(context, 8));
+
+  /*
+   * Fetch the functions of the C library used to dump the profiles.
+   * Files are represented as opaque pointers.
+   */
+  auto fopenFunction = M.getOrInsertFunction(
+      "fopen",
+      FunctionType::get(ptrType, { ptrType, ptrType }, false));
+  auto fprintfFunction = M.getOrInsertFunction(
+      "fprintf",
+      FunctionType::get(int32, { ptrType, ptrType }, true));
+  auto fcloseFunction =
+      M.getOrInsertFunction("fclose",
+                            FunctionType::get(int32, { ptrType }, false));
+
+  /*
+   * Create the function.
+   */
+  auto dumpFunction = Function::Create(FunctionType::get(voidType, false),
+                                       GlobalValue::InternalLinkage,
+                                       "noelle.dependence_profiles.dump",
+                                       M);
+  auto entryBB = BasicBlock::Create(context, "entry", dumpFunction);
+  auto dependenceBB = BasicBlock::Create(context, "dependence", dumpFunction);
+  auto printBB = BasicBlock::Create(context, "print", dumpFunction);
+  auto nextDependenceBB =
+      BasicBlock::Create(context, "nextDependence", dumpFunction);
+  auto closeBB = BasicBlock::Create(context, "close", dumpFunction);
+  auto exitBB = BasicBlock::Create(context, "exit", dumpFunction);
+
+  /*
+   * Open the file.
+   */
+  IRBuilder<> builder{ entryBB };
+  std::vector<Constant *> nameConstants;
+  for (auto &name : names) {
+    nameConstants.push_back(
+        cast<Constant>(builder.CreateGlobalStringPtr(name)));
+  }
+  auto namesType = ArrayType::get(ptrType, nameConstants.size());
+  auto namesArray =
+      new GlobalVariable(M,
+                         namesType,
+                         /*isConstant=*/true,
+                         GlobalValue::InternalLinkage,
+                         ConstantArray::get(namesType, nameConstants),
+                         "noelle.dependence_profiles.names");
+  auto file = builder.CreateCall(
+      fopenFunction,
+      ArrayRef<Value *>({ builder.CreateGlobalStringPtr(defaultFileName),
+                          builder.CreateGlobalStringPtr("a") }));
+  auto isFileOpen =
+      builder.CreateICmpNE(file, ConstantPointerNull::get(ptrType));
+  auto format = builder.CreateGlobalStringPtr("%llu %llu %s\n");
+  builder.CreateCondBr(isFileOpen, dependenceBB, exitBB);
+
+  /*
+   * Iterate over the dependences.
+   */
+  auto zero = ConstantInt::get(int64, 0);
+  builder.SetInsertPoint(dependenceBB);
+  auto dependenceIndex = builder.CreatePHI(int64, 2);
+  dependenceIndex->addIncoming(zero, entryBB);
+  auto firstState = builder.CreateMul(
+      dependenceIndex,
+      ConstantInt::get(int64, State::STATE_SIZE));
+  auto checks = builder.CreateLoad(builder.CreateInBoundsGEP(
+      states,
+      ArrayRef<Value *>(
+          { zero,
+            builder.CreateAdd(firstState,
+                              ConstantInt::get(int64, State::CHECKS)) })));
+  auto manifestations = builder.CreateLoad(builder.CreateInBoundsGEP(
+      states,
+      ArrayRef<Value *>(
+          { zero,
+            builder.CreateAdd(
+                firstState,
+                ConstantInt::get(int64, State::MANIFESTATIONS)) })));
+  builder.CreateCondBr(builder.CreateICmpEQ(checks, zero),
+                       nextDependenceBB,
+                       printBB);
+
+  /*
+   * Dump the dependences that have been checked as
+   * "CHECKS MANIFESTATIONS SOURCE_INDEX DESTINATION_INDEX FUNCTION_NAME"
+   */
+  builder.SetInsertPoint(printBB);
+  auto name = builder.CreateLoad(
+      builder.CreateInBoundsGEP(namesArray,
+                                ArrayRef<Value *>({ zero, dependenceIndex })));
+  builder.CreateCall(
+      fprintfFunction,
+      ArrayRef<Value *>({ file, format, checks, manifestations, name }));
+  builder.CreateBr(nextDependenceBB);
+
+  builder.SetInsertPoint(nextDependenceBB);
+  auto nextDependenceIndex =
+      builder.CreateAdd(dependenceIndex, ConstantInt::get(int64, 1));
+  dependenceIndex->addIncoming(nextDependenceIndex, nextDependenceBB);
+  auto isLastDependence = builder.CreateICmpEQ(
+      nextDependenceIndex,
+      ConstantInt::get(int64, names.size()));
+  builder.CreateCondBr(isLastDependence, closeBB, dependenceBB);
+
+  /*
+   * Close the file.
+   */
+  builder.SetInsertPoint(closeBB);
+  builder.CreateCall(fcloseFunction, ArrayRef<Value *>({ file }));
+  builder.CreateBr(exitBB);
+
+  builder.SetInsertPoint(exitBB);
+  builder.CreateRetVoid();
+
+  return dumpFunction;
+}
+
+void DependenceProfilerInstrumenter::getAnalysisUsage(
+    AnalysisUsage &AU) const {
+  AU.addRequired<Noelle>();
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char DependenceProfilerInstrumenter::ID = 0;
+static RegisterPass<DependenceProfilerInstrumenter> X(
+    "noelle-dependence-profiler-instr",
+    "Instrument the hot loops to profile their loop-carried memory "
+    "dependences");
+
+} // namespace llvm::noelle
@@ -34,6 +34,49 @@
 
 namespace llvm::noelle {
 
+/*
+ * Types of the elements of the arrays reduced by DOALL loops, and operations
+ * that reduce them. Minimums and maximums are used only by scans.
+ * These values must match NOELLE_REDUCTION_* of the runtime.
+ */
+enum DOALLArrayReductionType {
+  DOALL_REDUCTION_INT8 = 0,
+  DOALL_REDUCTION_INT16 = 1,
+  DOALL_REDUCTION_INT32 = 2,
+  DOALL_REDUCTION_INT64 = 3,
+  DOALL_REDUCTION_FLOAT = 4,
+  DOALL_REDUCTION_DOUBLE = 5
+};
+
+enum DOALLArrayReductionOperation {
+  DOALL_REDUCTION_ADD = 0,
+  DOALL_REDUCTION_MUL = 1,
+  DOALL_REDUCTION_AND = 2,
+  DOALL_REDUCTION_OR = 3,
+  DOALL_REDUCTION_XOR = 4,
+  DOALL_REDUCTION_MIN = 5,
+  DOALL_REDUCTION_MAX = 6,
+  DOALL_REDUCTION_UMIN = 7,
+  DOALL_REDUCTION_UMAX = 8
+};
+
+/*
+ * Memory object (a global variable or a stack array) that the iterations of a
+ * loop update only with an associative and commutative operation (e.g.,
+ * hist[bin(x[i])]++).
+ * @accesses are the loads and the stores of these updates.
+ * @copies is the call that allocates the private copies of the tasks, or
+ * nullptr if the loop has not been parallelized yet.
+ */
+struct DOALLArrayReduction {
+  Value *array;
+  uint64_t bytes;
+  DOALLArrayReductionType elementType;
+  DOALLArrayReductionOperation operation;
+  std::vector<Instruction *> accesses;
+  Value *copies;
+};
+
 class DOALL : public ParallelizationTechnique {
 public:
   /*
@@ -50,9 +93,62 @@ public:
       LoopDependenceInfo *LDI,
       Noelle &par);
 
+  /*
+   * Check the conditions that only depend on the loop structure.
+   * They can be checked before computing the dependences of the loop.
+   * If they do not hold, then the reason is stored in @reason.
+   */
+  static bool canBeAppliedToLoopStructure(LoopStructure *loopStructure,
+                                          std::string &reason);
+
+  /*
+   * Return the call to the dispatcher of the last loop parallelized.
+   * Its fourth argument is the chunk size, which the tasks receive at run
+   * time.
+   */
+  CallInst *getDispatcherCall(void) const;
+
+  /*
+   * Return the function of the tasks that run the iterations of the last loop
+   * parallelized.
+   */
+  Function *getTaskFunction(void) const;
+
+  /*
+   * Check if the last loop parallelized reduces its floating point variables
+   * reproducibly. If so, its chunk size must not change at run time.
+   */
+  bool doesReduceDeterministically(void) const;
+
+  /*
+   * Check if the last loop parallelized computes a scan. If so, the runtime
+   * chooses its chunk size.
+   */
+  bool doesScan(void) const;
+
 protected:
   bool enabled;
   Function *taskDispatcher;
+  Function *taskDispatcherWithScheduling;
+  Function *taskDispatcherWithTripCount;
+  Function *taskDispatcherWithCancellation;
+  Function *taskDispatcherWithSpeculation;
+  Function *taskDispatcherWithFixedTasks;
+  Function *taskDispatcherWithInspection;
+  Function *taskDispatcherWithScan;
+  Function *taskDispatcherDistributed;
+  Function *allocateReductionArrays;
+  Function *reduceArrays;
+  Function *fetchNextChunk;
+  Function *cancelLoop;
+  Function *isLoopCancelled;
+  Function *startChunk;
+  Function *speculativeLoad;
+  Function *speculativeStore;
+  CallInst *dispatcherCall;
+  std::vector<DOALLArrayReduction> arrayReductions;
+  SCCAttrs *scan;
+  Value *scanPrefixes;
   Noelle &n;
 
   /*
@@ -60,6 +156,34 @@ protected:
    */
   void rewireLoopToIterateChunks(LoopDependenceInfo *LDI);
 
+  void rewireLoopToFetchChunksDynamically(LoopDependenceInfo *LDI);
+
+  void rewireLoopToLeaveEarly(LoopDependenceInfo *LDI);
+
+  void rewireLoopToRunSpeculatively(LoopDependenceInfo *LDI);
+
+  void rewireLoopToReduceArrays(LoopDependenceInfo *LDI);
+
+  void rewireLoopToScan(LoopDependenceInfo *LDI);
+
+  /*
+   * Make the task record the cycles of its chunks in the telemetry of the
+   * runtime (see -doall-chunk-telemetry).
+   */
+  bool mustRecordChunks(LoopDependenceInfo *LDI) const;
+
+  void rewireLoopToRecordChunks(LoopDependenceInfo *LDI);
+
+  /*
+   * Split the iterations of the loop across the MPI ranks of a batch job (see
+   * -doall-distributed).
+   * If so, @distribution describes the variables of the environment that the
+   * ranks exchange (see NOELLE_DOALLDispatcherDistributed).
+   */
+  bool mustDistribute(LoopDependenceInfo *LDI, std::string &distribution) const;
+
+  void addVectorizationHintsToChunkLoop(LoopDependenceInfo *LDI);
+
   void addChunkFunctionExecutionAsideOriginalLoop(LoopDependenceInfo *LDI,
                                                   Function *loopFunction,
                                                   Noelle &par);
@@ -71,6 +195,101 @@ protected:
    */
   Value *fetchClone(Value *original) const;
 
+  DOALLChunkScheduling getChunkScheduling(LoopDependenceInfo *LDI) const;
+
+  bool canComputeTheTripCount(LoopDependenceInfo *LDI) const;
+
+  Value *generateCodeToComputeTheTripCount(LoopDependenceInfo *LDI,
+                                           IRBuilder<> &builder);
+
+  bool canLeaveEarly(LoopDependenceInfo *LDI) const;
+
+  bool mustRunSpeculatively(LoopDependenceInfo *LDI) const;
+
+  /*
+   * Inspector-executor DOALL.
+   * The only loop-carried dependences of these loops are between accesses to
+   * the same array indexed by another array that the loop does not write
+   * (e.g., y[idx[i]] += x[i]). Hence, the runtime can check whether the
+   * iterations use distinct indices before running the loop.
+   * "getIndicesToInspect" returns the load of the index of an iteration
+   * (e.g., idx[i]), or nullptr if the loop does not need to be inspected.
+   */
+  bool mustBeInspected(LoopDependenceInfo *LDI) const;
+
+  LoadInst *getIndicesToInspect(LoopDependenceInfo *LDI) const;
+
+  Value *generateCodeToComputeTheFirstIndex(LoopDependenceInfo *LDI,
+                                            LoadInst *indices,
+                                            IRBuilder<> &builder);
+
+  /*
+   * Array reductions.
+   * The only loop-carried dependences of these loops are between the updates
+   * of arrays reduced by the loop (see DOALLArrayReduction). Each task updates
+   * a private copy of these arrays, which are combined with the original ones
+   * after the tasks end.
+   * "getArraysToReduce" returns an empty vector if the loop cannot be
+   * parallelized this way.
+   */
+  bool mustReduceArrays(LoopDependenceInfo *LDI) const;
+
+  std::vector<DOALLArrayReduction> getArraysToReduce(
+      LoopDependenceInfo *LDI) const;
+
+  bool isArrayReduction(LoopDependenceInfo *LDI,
+                        Value *array,
+                        DOALLArrayReduction &reduction) const;
+
+  void generateCodeToAllocatePrivateArrays(LoopDependenceInfo *LDI);
+
+  void generateCodeToReduceArrays(Value *numberOfThreadsUsed,
+                                  IRBuilder<> &builder);
+
+  uint64_t getStrideOfPrivateArrays(DOALLArrayReduction const &reduction) const;
+
+  /*
+   * Scans.
+   * The only loop-carried dependences of these loops are the ones of a
+   * variable that computes the prefix of an associative operation, and whose
+   * intermediate values are used by the loop (e.g., s = s + a[i]; x[i] = s).
+   * Each task runs a block of consecutive iterations twice: first from the
+   * identity of the operation to compute the value of its block, and then from
+   * the prefix of the values of the blocks before it.
+   * "getScan" returns the SCC of the variable, or nullptr if the loop cannot
+   * be parallelized this way.
+   */
+  bool mustScan(LoopDependenceInfo *LDI) const;
+
+  SCCAttrs *getScan(LoopDependenceInfo *LDI) const;
+
+  bool getTypeAndOperationOfScan(
+      Instruction *operation,
+      DOALLArrayReductionType &elementType,
+      DOALLArrayReductionOperation &operationCode) const;
+
+  void generateCodeToAllocatePrefixes(LoopDependenceInfo *LDI);
+
+  CallInst *generateCodeToDispatchScan(LoopDependenceInfo *LDI,
+                                       Value *envPtr,
+                                       Value *numCores,
+                                       Value *tripCount,
+                                       IRBuilder<> &builder);
+
+  bool mustReduceDeterministically(LoopDependenceInfo *LDI) const;
+
+  bool canVectorizeChunkLoop(LoopDependenceInfo *LDI) const;
+
+  /*
+   * Return the SCCs with loop-carried data dependences that the tasks cannot
+   * honor.
+   */
+  virtual std::set<SCC *> getSCCsThatBlockTheParallelization(
+      LoopDependenceInfo *LDI) const;
+
+  uint32_t getIndexOfTheExitBlockOfTheLoopGoverningIV(
+      LoopDependenceInfo *LDI) const;
+
   /*
    * Interface
    */
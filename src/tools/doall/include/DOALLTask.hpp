@@ -40,6 +40,11 @@ public:
    */
   Value *coreArg, *numCoresArg, *chunkSizeArg;
 
+  /*
+   * PHI that tracks the progress within the current chunk
+   */
+  PHINode *chunkPHI;
+
   /*
    * Clone of original IV loop, new outer loop
    */
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "DOALL.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Wavefront parallelizes 2-D loop nests whose nested loop depends on the one
+ * of the previous iteration of the outer loop (e.g., A[i][j] = A[i-1][j] +
+ * A[i][j-1]).
+ *
+ * The iterations of the outer loop (i.e., the rows) are assigned to the tasks
+ * round-robin as DOALL does with chunks of one iteration. Before running an
+ * iteration of its nested loop, the task of a row waits for the task of the
+ * previous row to complete the same iteration. Hence, the anti-diagonals of
+ * the nest run in parallel.
+ */
+class Wavefront : public DOALL {
+public:
+  /*
+   * Methods
+   */
+  Wavefront(Noelle &noelle);
+
+  bool apply(LoopDependenceInfo *LDI, Heuristics *h) override;
+
+  bool canBeAppliedToLoop(LoopDependenceInfo *LDI,
+                          Heuristics *h) const override;
+
+protected:
+  Function *waitForPreviousRow;
+  Function *signalNextRow;
+
+  std::set<SCC *> getSCCsThatBlockTheParallelization(
+      LoopDependenceInfo *LDI) const override;
+
+  /*
+   * Return the loop nested in the one of @LDI if this is the only one.
+   * Otherwise, return nullptr.
+   */
+  LoopStructure *getNestedLoop(LoopDependenceInfo *LDI) const;
+
+  /*
+   * Check if the loop-carried data dependences of @scc only go from an
+   * iteration of @nestedLoop to the same iteration of it in a later row.
+   */
+  bool canBeSynchronizedByRows(LoopDependenceInfo *LDI,
+                               LoopStructure *nestedLoop,
+                               SCC *scc) const;
+
+  /*
+   * Add the code to the task to wait for the previous row before each
+   * iteration of @nestedLoop, and to signal the next row after them.
+   */
+  void synchronizeRows(LoopDependenceInfo *LDI, LoopStructure *nestedLoop);
+};
+
+} // namespace llvm::noelle
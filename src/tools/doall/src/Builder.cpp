@@ -54,6 +54,7 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
                                             headerClone,
                                             chunkCounterType,
                                             task->chunkSizeArg);
+  task->chunkPHI = chunkPHI;
 
   /*
    * Collect clones of step size deriving values for all induction variables
@@ -89,8 +90,17 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
    * Determine additional step size from the beginning of the next core's chunk
    * to the start of this core's next chunk
    * chunk_step_size: original_step_size * (num_cores - 1) * chunk_size
+   *
+   * This is only needed when chunks are assigned statically. Otherwise, the
+   * start of the next chunk is fetched from the runtime (see
+   * rewireLoopToFetchChunksDynamically).
    */
+  auto isStaticallyScheduled =
+      (this->getChunkScheduling(LDI) == DOALL_STATIC_SCHEDULING);
   for (auto ivInfo : allIVInfo->getInductionVariables(*loopSummary)) {
+    if (!isStaticallyScheduled) {
+      break;
+    }
     auto stepOfIV = clonedStepSizeMap.at(ivInfo);
     auto ivPHI = cast<PHINode>(fetchClone(ivInfo->getLoopEntryPHI()));
     auto onesValueForChunking = ConstantInt::get(chunkCounterType, 1);
@@ -122,7 +132,8 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
           ->getHeaderCompareInstructionToComputeExitCondition()));
   auto brInst = cast<BranchInst>(task->getCloneOfOriginalInstruction(
       loopGoverningIVAttr->getHeaderBrInst()));
-  auto basicBlockToJumpToWhenTheLoopEnds = task->getLastBlock(0);
+  auto basicBlockToJumpToWhenTheLoopEnds = task->getCloneOfOriginalBasicBlock(
+      loopGoverningIVAttr->getExitBlockFromHeader());
   ivUtility.updateConditionAndBranchToCatchIteratingPastExitValue(
       cmpInst,
       brInst,
@@ -276,6 +287,31 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
   assert(valueUsedToCompareAgainstExitConditionValue != nullptr);
   auto stepSize = clonedStepSizeMap.at(&loopGoverningIV);
 
+  /*
+   * Check if the sign of the step of the loop-governing IV is only known at
+   * run time.
+   * In this case, the exit condition has been transformed assuming the sign it
+   * implies. If the step turns out to have the other sign (or it is 0), then
+   * the original loop executes either no iteration or forever. Either way, only
+   * the first task can execute the loop as the other ones would start from
+   * values of the IV that the original loop never reaches.
+   */
+  Value *mustSkipTheLoop = nullptr;
+  if (!loopGoverningIV.isStepValueSignKnown()) {
+    IRBuilder<> preheaderBuilder(preheaderClone->getTerminator());
+    auto hasTheExpectedSign =
+        ivUtility.generateCodeToCheckIfTheStepValueHasTheExpectedSign(
+            preheaderBuilder,
+            stepSize);
+    auto isNotTheFirstTask = preheaderBuilder.CreateICmpNE(
+        task->coreArg,
+        ConstantInt::get(task->coreArg->getType(), 0));
+    mustSkipTheLoop =
+        preheaderBuilder.CreateAnd(isNotTheFirstTask,
+                                   preheaderBuilder.CreateNot(
+                                       hasTheExpectedSign));
+  }
+
   /*
    * Check if we need to check whether we need to add a condition to execute
    * instructions in the new header for tasks that are executing the header in
@@ -370,7 +406,7 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
        * this will be the live out value from the header
        */
       IRBuilder<> exitBuilder(
-          task->getLastBlock(0)->getFirstNonPHIOrDbgOrLifetime());
+          basicBlockToJumpToWhenTheLoopEnds->getFirstNonPHIOrDbgOrLifetime());
       auto prevIterationValue =
           ivUtility.generateCodeToComputeValueToUseForAnIterationAgo(
               exitBuilder,
@@ -415,10 +451,19 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
     }
 
     /*
-     * There is no need for pre-header / latch guards, so we return
+     * There is no need for latch guards.
+     * The pre-header needs a guard only if the task must skip the loop.
      * TODO: Isolate reducible live out guards and pre-header / latch guards to
      * helper methods so this function's control flow is simpler
      */
+    if (mustSkipTheLoop != nullptr) {
+      auto preheaderTerminator = preheaderClone->getTerminator();
+      IRBuilder<> preheaderBuilder(preheaderTerminator);
+      preheaderBuilder.CreateCondBr(mustSkipTheLoop,
+                                    task->getExit(),
+                                    headerClone);
+      preheaderTerminator->eraseFromParent();
+    }
     return;
   }
 
@@ -494,7 +539,7 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
         prevIterationValue);
     latchBuilder.Insert(clonedCmpInst);
     latchBuilder.CreateCondBr(clonedCmpInst,
-                              task->getLastBlock(0),
+                              basicBlockToJumpToWhenTheLoopEnds,
                               headerClone);
   }
 
@@ -524,10 +569,305 @@ void DOALL::rewireLoopToIterateChunks(LoopDependenceInfo *LDI) {
   auto startValue = fetchClone(loopGoverningIV.getStartValue());
   auto isNotFirstIteration =
       preheaderBuilder.CreateICmpNE(offsetStartValue, startValue);
-  preheaderBuilder.CreateCondBr(
-      preheaderBuilder.CreateAnd(isNotFirstIteration, clonedExitCmpInst),
-      task->getExit(),
-      headerClone);
+  Value *mustExit =
+      preheaderBuilder.CreateAnd(isNotFirstIteration, clonedExitCmpInst);
+  if (mustSkipTheLoop != nullptr) {
+    mustExit = preheaderBuilder.CreateOr(mustExit, mustSkipTheLoop);
+  }
+  preheaderBuilder.CreateCondBr(mustExit, task->getExit(), headerClone);
+
+  return;
+}
+
+void DOALL::rewireLoopToFetchChunksDynamically(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = (DOALLTask *)tasks[0];
+  assert(task != nullptr);
+  assert(this->fetchNextChunk != nullptr);
+
+  /*
+   * Fetch loop and IV information.
+   */
+  auto loopSummary = LDI->getLoopStructure();
+  auto loopHeader = loopSummary->getHeader();
+  auto loopPreHeader = loopSummary->getPreHeader();
+  auto preheaderClone = task->getCloneOfOriginalBasicBlock(loopPreHeader);
+  auto headerClone = task->getCloneOfOriginalBasicBlock(loopHeader);
+  auto allIVInfo = LDI->getInductionVariableManager();
+  auto taskFunction = task->getTaskBody();
+  auto &cxt = taskFunction->getContext();
+
+  /*
+   * Collect clones of step size deriving values for all induction variables
+   * of the top level loop
+   */
+  IRBuilder<> entryBuilder(task->getEntry());
+  entryBuilder.SetInsertPoint(task->getEntry()->getTerminator());
+  auto clonedStepSizeMap =
+      this->cloneIVStepValueComputation(LDI, 0, entryBuilder);
+
+  /*
+   * Fetch the PHI that tracks the progress within the current chunk.
+   * This has been generated by rewireLoopToIterateChunks.
+   */
+  auto chunkPHI = task->chunkPHI;
+  assert(chunkPHI != nullptr);
+
+  /*
+   * Fetch the predecessors of the header that belong to the loop.
+   */
+  std::vector<BasicBlock *> latches;
+  for (auto pred : predecessors(headerClone)) {
+    if (pred == preheaderClone) {
+      continue;
+    }
+    latches.push_back(pred);
+  }
+
+  /*
+   * For every latch, when the current chunk is completed, ask the runtime for
+   * the next chunk to execute and jump to its first iteration:
+   *
+   * latch:
+   *   ...
+   *   br %checkChunk
+   *
+   * checkChunk:
+   *   br %chunkIsCompleted, %fetchNextChunk, %header
+   *
+   * fetchNextChunk:
+   *   %chunk = call NOELLE_DOALL_fetchNextChunk()
+   *   %iv = start + step * (%chunk * chunkSize)
+   *   br %header
+   */
+  for (auto latch : latches) {
+
+    /*
+     * Fetch the condition that tells us whether the current chunk has been
+     * completed.
+     */
+    auto chunkWrap =
+        cast<SelectInst>(chunkPHI->getIncomingValueForBlock(latch));
+    auto isChunkCompleted = chunkWrap->getCondition();
+
+    /*
+     * Create the new basic blocks.
+     */
+    auto checkChunkBB =
+        BasicBlock::Create(cxt, "check_if_chunk_is_completed", taskFunction);
+    auto fetchChunkBB =
+        BasicBlock::Create(cxt, "fetch_next_chunk", taskFunction);
+    IRBuilder<> checkChunkBuilder(checkChunkBB);
+    checkChunkBuilder.CreateCondBr(isChunkCompleted, fetchChunkBB, headerClone);
+    IRBuilder<> fetchChunkBuilder(fetchChunkBB);
+    auto nextChunk = fetchChunkBuilder.CreateCall(this->fetchNextChunk);
+    auto firstIterationOfNextChunk =
+        fetchChunkBuilder.CreateMul(nextChunk,
+                                    task->chunkSizeArg,
+                                    "nextChunk_X_chunkSize");
+    fetchChunkBuilder.CreateBr(headerClone);
+
+    /*
+     * Redirect the latch to the new check.
+     */
+    auto latchTerminator = latch->getTerminator();
+    for (auto i = 0; i < latchTerminator->getNumSuccessors(); i++) {
+      if (latchTerminator->getSuccessor(i) == headerClone) {
+        latchTerminator->setSuccessor(i, checkChunkBB);
+      }
+    }
+
+    /*
+     * Update the PHIs of the header.
+     *
+     * All values but the induction variables flow unchanged through the new
+     * basic blocks. Induction variables restart from the first iteration of
+     * the next chunk.
+     */
+    for (auto &phi : headerClone->phis()) {
+      auto latchValue = phi.getIncomingValueForBlock(latch);
+      phi.setIncomingBlock(phi.getBasicBlockIndex(latch), checkChunkBB);
+      phi.addIncoming(latchValue, fetchChunkBB);
+    }
+    for (auto ivInfo : allIVInfo->getInductionVariables(*loopSummary)) {
+      auto ivPHI = cast<PHINode>(this->fetchClone(ivInfo->getLoopEntryPHI()));
+      auto startOfIV = this->fetchClone(ivInfo->getStartValue());
+      auto stepOfIV = clonedStepSizeMap.at(ivInfo);
+      auto ivAtNextChunk =
+          IVUtility::computeInductionVariableValueForIteration(
+              fetchChunkBB,
+              ivPHI,
+              startOfIV,
+              stepOfIV,
+              firstIterationOfNextChunk);
+      ivPHI->setIncomingValueForBlock(fetchChunkBB, ivAtNextChunk);
+    }
+  }
+
+  return;
+}
+
+void DOALL::rewireLoopToLeaveEarly(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = (DOALLTask *)tasks[0];
+  assert(task != nullptr);
+  assert(this->cancelLoop != nullptr);
+  assert(this->isLoopCancelled != nullptr);
+
+  /*
+   * Fetch loop and IV information.
+   */
+  auto loopSummary = LDI->getLoopStructure();
+  auto loopHeader = loopSummary->getHeader();
+  auto loopPreHeader = loopSummary->getPreHeader();
+  auto preheaderClone = task->getCloneOfOriginalBasicBlock(loopPreHeader);
+  auto headerClone = task->getCloneOfOriginalBasicBlock(loopHeader);
+  auto taskFunction = task->getTaskBody();
+  auto &cxt = taskFunction->getContext();
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  auto &loopGoverningIV = loopGoverningIVAttr->getInductionVariable();
+  auto ivPHI = cast<PHINode>(
+      task->getCloneOfOriginalInstruction(loopGoverningIV.getLoopEntryPHI()));
+  auto startOfIV = this->fetchClone(loopGoverningIV.getStartValue());
+  auto stepOfIV = loopGoverningIV.getSingleComputedStepValue();
+  assert(isa<ConstantInt>(stepOfIV));
+
+  /*
+   * Define the code to compute the iteration (counted from 0) that has a
+   * given value of the loop governing IV.
+   * The step of the IV is a positive constant (see canLeaveEarly).
+   */
+  auto tm = this->n.getTypesManager();
+  auto int64 = tm->getIntegerType(64);
+  auto computeIteration = [startOfIV, stepOfIV, int64](IRBuilder<> &builder,
+                                                       Value *ivValue) {
+    auto distance = builder.CreateSub(ivValue, startOfIV);
+    auto iteration = builder.CreateUDiv(distance, stepOfIV, "iteration");
+    return builder.CreateZExtOrTrunc(iteration, int64);
+  };
+
+  /*
+   * When an iteration leaves the loop early, tell the other tasks:
+   *
+   * earlyExit:
+   *   %iteration = (%iv - start) / step
+   *   call NOELLE_DOALL_cancel(%iteration, exitIndex)
+   *   br %taskExit
+   *
+   * The runtime keeps the earliest iteration that left the loop and it tells
+   * the code after the parallelized loop which exit block to jump to.
+   */
+  auto loopExitBlocks = loopSummary->getLoopExitBasicBlocks();
+  auto exitBlockOfIV = loopGoverningIVAttr->getExitBlockFromHeader();
+  for (auto i = 0; i < loopExitBlocks.size(); i++) {
+    auto exitBB = loopExitBlocks[i];
+    if (exitBB == exitBlockOfIV) {
+      continue;
+    }
+    auto exitClone = task->getCloneOfOriginalBasicBlock(exitBB);
+    IRBuilder<> exitBuilder(exitClone->getTerminator());
+    auto iteration = computeIteration(exitBuilder, ivPHI);
+    exitBuilder.CreateCall(
+        this->cancelLoop,
+        ArrayRef<Value *>({ iteration, ConstantInt::get(int64, i) }));
+  }
+
+  /*
+   * Fetch the PHI that tracks the progress within the current chunk.
+   * This has been generated by rewireLoopToIterateChunks.
+   */
+  auto chunkPHI = task->chunkPHI;
+  assert(chunkPHI != nullptr);
+
+  /*
+   * Fetch the predecessors of the header that belong to the loop.
+   */
+  std::vector<BasicBlock *> latches;
+  for (auto pred : predecessors(headerClone)) {
+    if (pred == preheaderClone) {
+      continue;
+    }
+    latches.push_back(pred);
+  }
+
+  /*
+   * Before starting a new chunk, check whether an earlier iteration has left
+   * the loop. If so, the task is done as the sequential loop would not have
+   * executed the chunk:
+   *
+   * latch:
+   *   ...
+   *   br %checkChunk
+   *
+   * checkChunk:
+   *   br %chunkIsNew, %checkCancellation, %header
+   *
+   * checkCancellation:
+   *   %iteration = (%iv - start) / step
+   *   %isCancelled = call NOELLE_DOALL_isCancelled(%iteration)
+   *   br %isCancelled, %taskExit, %header
+   */
+  for (auto latch : latches) {
+
+    /*
+     * Fetch the values that start the next iteration.
+     * The chunk PHI restarts from 0 when a new chunk begins.
+     */
+    auto chunkValue = chunkPHI->getIncomingValueForBlock(latch);
+    auto ivValue = ivPHI->getIncomingValueForBlock(latch);
+
+    /*
+     * Create the new basic blocks.
+     */
+    auto checkChunkBB =
+        BasicBlock::Create(cxt, "check_if_chunk_is_new", taskFunction);
+    auto checkCancellationBB =
+        BasicBlock::Create(cxt, "check_if_loop_is_cancelled", taskFunction);
+    IRBuilder<> checkChunkBuilder(checkChunkBB);
+    auto isChunkNew = checkChunkBuilder.CreateICmpEQ(
+        chunkValue,
+        ConstantInt::get(chunkValue->getType(), 0));
+    checkChunkBuilder.CreateCondBr(isChunkNew,
+                                   checkCancellationBB,
+                                   headerClone);
+    IRBuilder<> checkCancellationBuilder(checkCancellationBB);
+    auto iteration = computeIteration(checkCancellationBuilder, ivValue);
+    auto isCancelled = checkCancellationBuilder.CreateCall(
+        this->isLoopCancelled,
+        ArrayRef<Value *>({ iteration }));
+    auto mustStop = checkCancellationBuilder.CreateICmpNE(
+        isCancelled,
+        ConstantInt::get(isCancelled->getType(), 0));
+    checkCancellationBuilder.CreateCondBr(mustStop,
+                                          task->getExit(),
+                                          headerClone);
+
+    /*
+     * Redirect the latch to the new check.
+     */
+    auto latchTerminator = latch->getTerminator();
+    for (auto i = 0; i < latchTerminator->getNumSuccessors(); i++) {
+      if (latchTerminator->getSuccessor(i) == headerClone) {
+        latchTerminator->setSuccessor(i, checkChunkBB);
+      }
+    }
+
+    /*
+     * Update the PHIs of the header.
+     * All values flow unchanged through the new basic blocks.
+     */
+    for (auto &phi : headerClone->phis()) {
+      auto latchValue = phi.getIncomingValueForBlock(latch);
+      phi.setIncomingBlock(phi.getBasicBlockIndex(latch), checkChunkBB);
+      phi.addIncoming(latchValue, checkCancellationBB);
+    }
+  }
 
   return;
 }
@@ -28,6 +28,25 @@ DOALL::DOALL(Noelle &noelle)
   : ParallelizationTechnique{ noelle },
     enabled{ true },
     taskDispatcher{ nullptr },
+    taskDispatcherWithScheduling{ nullptr },
+    taskDispatcherWithTripCount{ nullptr },
+    taskDispatcherWithCancellation{ nullptr },
+    taskDispatcherWithSpeculation{ nullptr },
+    taskDispatcherWithFixedTasks{ nullptr },
+    taskDispatcherWithInspection{ nullptr },
+    taskDispatcherWithScan{ nullptr },
+    taskDispatcherDistributed{ nullptr },
+    allocateReductionArrays{ nullptr },
+    reduceArrays{ nullptr },
+    fetchNextChunk{ nullptr },
+    cancelLoop{ nullptr },
+    isLoopCancelled{ nullptr },
+    startChunk{ nullptr },
+    speculativeLoad{ nullptr },
+    speculativeStore{ nullptr },
+    dispatcherCall{ nullptr },
+    scan{ nullptr },
+    scanPrefixes{ nullptr },
     n{ noelle } {
 
   /*
@@ -55,6 +74,97 @@ DOALL::DOALL(Noelle &noelle)
     }
   }
 
+  /*
+   * Fetch the runtime functions needed to distribute chunks dynamically.
+   * These are optional: if they are missing, then DOALL loops are scheduled
+   * statically.
+   */
+  this->taskDispatcherWithScheduling = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithScheduling");
+  this->fetchNextChunk =
+      this->n.getProgram()->getFunction("NOELLE_DOALL_fetchNextChunk");
+
+  /*
+   * Fetch the dispatcher that runs DOALL loops with few iterations
+   * sequentially. This is optional as well.
+   */
+  this->taskDispatcherWithTripCount = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithTripCount");
+
+  /*
+   * Fetch the runtime functions needed to parallelize loops that can leave
+   * before their last iteration (e.g., search loops). These are optional: if
+   * they are missing, then such loops are not DOALL.
+   */
+  this->taskDispatcherWithCancellation = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithCancellation");
+  this->cancelLoop =
+      this->n.getProgram()->getFunction("NOELLE_DOALL_cancel");
+  this->isLoopCancelled =
+      this->n.getProgram()->getFunction("NOELLE_DOALL_isCancelled");
+
+  /*
+   * Fetch the runtime function that records the start of the chunks of a
+   * task. This is optional: if it is missing, then chunks are not recorded.
+   */
+  this->startChunk =
+      this->n.getProgram()->getFunction("NOELLE_DOALL_startChunk");
+
+  /*
+   * Fetch the runtime functions needed to run DOALL loops speculatively.
+   * These are optional: if they are missing, then loops with loop-carried
+   * memory dependences are not DOALL.
+   */
+  this->taskDispatcherWithSpeculation = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithSpeculation");
+  this->speculativeLoad =
+      this->n.getProgram()->getFunction("NOELLE_DOALL_speculativeLoad");
+  this->speculativeStore =
+      this->n.getProgram()->getFunction("NOELLE_DOALL_speculativeStore");
+
+  /*
+   * Fetch the dispatcher that runs a fixed number of tasks independently of
+   * the cores available, which is needed to reduce floating point variables
+   * reproducibly. This is optional: if it is missing, then such loops are not
+   * DOALL when reproducible reductions are requested.
+   */
+  this->taskDispatcherWithFixedTasks = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithFixedTasks");
+
+  /*
+   * Fetch the dispatcher that inspects the indices of loops with indirect
+   * subscripts (e.g., y[idx[i]]) before running them. This is optional: if it
+   * is missing, then such loops are not DOALL.
+   */
+  this->taskDispatcherWithInspection = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithInspection");
+
+  /*
+   * Fetch the runtime functions needed to privatize the arrays reduced by DOALL
+   * loops (e.g., histograms). These are optional: if they are missing, then
+   * such loops are not DOALL.
+   */
+  this->allocateReductionArrays = this->n.getProgram()->getFunction(
+      "NOELLE_allocateReductionArrays");
+  this->reduceArrays =
+      this->n.getProgram()->getFunction("NOELLE_reduceArrays");
+
+  /*
+   * Fetch the dispatcher that runs the loops that compute the prefix of a
+   * recurrence (e.g., running sums). This is optional: if it is missing, then
+   * such loops are not DOALL.
+   */
+  this->taskDispatcherWithScan = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherWithScan");
+
+  /*
+   * Fetch the dispatcher that splits DOALL loops across the MPI ranks of a
+   * batch job. This is optional: if it is missing, then loops run on the cores
+   * of a single process.
+   */
+  this->taskDispatcherDistributed = this->n.getProgram()->getFunction(
+      "NOELLE_DOALLDispatcherDistributed");
+
   return;
 }
 
@@ -96,7 +206,7 @@ bool DOALL::canBeAppliedToLoop(LoopDependenceInfo *LDI, Heuristics *h) const {
     }
     numOfExits++;
   }
-  if (numOfExits != 1) {
+  if (true && (numOfExits != 1) && (!this->canLeaveEarly(LDI))) {
     if (this->verbose != Verbosity::Disabled) {
       errs() << "DOALL:   More than 1 loop exit blocks\n";
     }
@@ -114,12 +224,48 @@ bool DOALL::canBeAppliedToLoop(LoopDependenceInfo *LDI, Heuristics *h) const {
     return false;
   }
 
+  /*
+   * Floating point variables reduced reproducibly need every iteration to be
+   * accumulated by the same private copy at every invocation.
+   * This is not the case if the tasks stop each other or iterations are
+   * executed again.
+   */
+  if (true && this->mustReduceDeterministically(LDI)
+      && ((this->taskDispatcherWithFixedTasks == nullptr)
+          || this->canLeaveEarly(LDI) || this->mustRunSpeculatively(LDI)
+          || this->mustBeInspected(LDI))) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs()
+          << "DOALL:   Floating point variables cannot be reduced reproducibly\n";
+    }
+    return false;
+  }
+
+  /*
+   * The output of the calls that write to streams is buffered per iteration,
+   * and it is written once in the order of the iterations.
+   * This is not the case if the iterations after an exit run, if iterations
+   * are executed again, or if the ranks of a batch job run them.
+   */
+  std::string distribution;
+  if (true && (LDI->getCallsWithBufferedOutput().size() > 0)
+      && ((!this->canBufferOutputOfLoop(LDI)) || this->canLeaveEarly(LDI)
+          || this->mustRunSpeculatively(LDI) || this->mustScan(LDI)
+          || this->mustDistribute(LDI, distribution))) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DOALL:   The output of the loop cannot be buffered\n";
+    }
+    return false;
+  }
+
   /*
    * The compiler must be able to remove loop-carried data dependences of all
    * SCCs with loop-carried data dependences.
    */
-  auto nonDOALLSCCs = DOALL::getSCCsThatBlockDOALLToBeApplicable(LDI, this->n);
-  if (nonDOALLSCCs.size() > 0) {
+  auto nonDOALLSCCs = this->getSCCsThatBlockTheParallelization(LDI);
+  if (true && (nonDOALLSCCs.size() > 0) && (!this->mustRunSpeculatively(LDI))
+      && (!this->mustBeInspected(LDI)) && (!this->mustReduceArrays(LDI))
+      && (!this->mustScan(LDI))) {
     if (this->verbose != Verbosity::Disabled) {
       for (auto scc : nonDOALLSCCs) {
         errs()
@@ -249,6 +395,17 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
     errs() << "DOALL: Start the parallelization\n";
     errs() << "DOALL:   Number of threads to extract = " << maxCores << "\n";
     errs() << "DOALL:   Chunk size = " << ltm->getChunkSize() << "\n";
+    switch (this->getChunkScheduling(LDI)) {
+      case DOALL_STATIC_SCHEDULING:
+        errs() << "DOALL:   Chunk scheduling = static\n";
+        break;
+      case DOALL_DYNAMIC_SCHEDULING:
+        errs() << "DOALL:   Chunk scheduling = dynamic\n";
+        break;
+      case DOALL_GUIDED_SCHEDULING:
+        errs() << "DOALL:   Chunk scheduling = guided\n";
+        break;
+    }
   }
 
   /*
@@ -258,6 +415,25 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
   this->addPredecessorAndSuccessorsBasicBlocksToTasks(LDI, { chunkerTask });
   this->numTaskInstances = maxCores;
 
+  /*
+   * The environment is only accessed by the task through its argument.
+   */
+  chunkerTask->getTaskBody()->addParamAttr(0, Attribute::NoAlias);
+
+  /*
+   * Floating point variables are reduced reproducibly by running a fixed
+   * number of tasks, each accumulating a fixed partition of the iterations.
+   */
+  this->reduceDeterministically = this->mustReduceDeterministically(LDI);
+  if (this->reduceDeterministically) {
+    this->numTaskInstances =
+        this->n.getNumberOfDeterministicReductionPartitions();
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DOALL:   Reproducible reductions with "
+             << this->numTaskInstances << " tasks\n";
+    }
+  }
+
   /*
    * Generate code to allocate and initialize the loop environment.
    */
@@ -303,6 +479,45 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
   };
   this->initializeEnvironmentBuilder(LDI, isReducible);
 
+  /*
+   * Allocate the private copies of the arrays reduced by the loop.
+   */
+  this->arrayReductions = this->getArraysToReduce(LDI);
+  if (this->arrayReductions.size() > 0) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DOALL:   Reduced arrays:\n";
+      for (auto &reduction : this->arrayReductions) {
+        errs() << "DOALL:     " << *reduction.array << "\n";
+      }
+    }
+    this->generateCodeToAllocatePrivateArrays(LDI);
+  }
+
+  /*
+   * Allocate the prefixes of the blocks of iterations of a scan.
+   */
+  this->scan = this->getScan(LDI);
+  if (this->scan != nullptr) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DOALL:   Scan of " << *this->scan->getSingleHeaderPHI()
+             << "\n";
+    }
+
+    /*
+     * Floating point scans split the iterations into the number of blocks
+     * requested for reproducible reductions.
+     */
+    if (this->scan->getSingleHeaderPHI()->getType()->isFloatingPointTy()) {
+      this->numTaskInstances =
+          this->n.getNumberOfDeterministicReductionPartitions();
+      if (this->verbose != Verbosity::Disabled) {
+        errs() << "DOALL:   Reproducible scan with "
+               << this->numTaskInstances << " blocks\n";
+      }
+    }
+    this->generateCodeToAllocatePrefixes(LDI);
+  }
+
   /*
    * Clone loop into the single task used by DOALL
    */
@@ -344,6 +559,29 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
     errs() << "DOALL:  Adjusted data flow\n";
   }
 
+  /*
+   * Redirect the updates of the reduced arrays to the private copies of the
+   * task.
+   */
+  if (this->arrayReductions.size() > 0) {
+    this->rewireLoopToReduceArrays(LDI);
+  }
+
+  /*
+   * Compute the invariants of the task once in the caller.
+   * Speculative tasks must load memory through the runtime, so their loads
+   * stay in the task.
+   */
+  auto hoistedInvariants = this->hoistInvariantsOfTheTaskIntoTheEnvironment(
+      LDI,
+      0,
+      !this->mustRunSpeculatively(LDI));
+  if (true && (hoistedInvariants > 0)
+      && (this->verbose != Verbosity::Disabled)) {
+    errs() << "DOALL:   " << hoistedInvariants
+           << " invariants are computed once by the caller\n";
+  }
+
   /*
    * Handle the reduction variables.
    */
@@ -358,6 +596,29 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
    * Perform the iteration-chunking optimization
    */
   this->rewireLoopToIterateChunks(LDI);
+  if (this->getChunkScheduling(LDI) != DOALL_STATIC_SCHEDULING) {
+    this->rewireLoopToFetchChunksDynamically(LDI);
+  }
+  if (this->canLeaveEarly(LDI)) {
+    this->rewireLoopToLeaveEarly(LDI);
+  }
+  auto runSpeculatively = this->mustRunSpeculatively(LDI);
+  if (runSpeculatively) {
+    this->rewireLoopToRunSpeculatively(LDI);
+  }
+  if (this->mustRecordChunks(LDI)) {
+    this->rewireLoopToRecordChunks(LDI);
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DOALL:   The task records the cycles of its chunks\n";
+    }
+  }
+  this->bufferOutputOfTask(LDI, 0);
+  if (this->canVectorizeChunkLoop(LDI)) {
+    this->addVectorizationHintsToChunkLoop(LDI);
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DOALL:   Added vectorization hints to the chunk loop\n";
+    }
+  }
   if (this->verbose >= Verbosity::Maximal) {
     errs() << "DOALL:  Rewired induction variables and reducible variables\n";
   }
@@ -368,6 +629,14 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
   IRBuilder<> exitB(tasks[0]->getExit());
   exitB.CreateRetVoid();
 
+  /*
+   * Start the variable of the scan from the prefix of the block of the task,
+   * and store the value of the block at the end of the task.
+   */
+  if (this->scan != nullptr) {
+    this->rewireLoopToScan(LDI);
+  }
+
   /*
    * Store final results to loop live-out variables. Note this occurs after
    * all other code is generated. Propagated PHIs through the generated
@@ -381,6 +650,25 @@ bool DOALL::apply(LoopDependenceInfo *LDI, Heuristics *h) {
 
   this->addChunkFunctionExecutionAsideOriginalLoop(LDI, loopFunction, this->n);
 
+  /*
+   * Prefetch the strided loads of the task, whose accesses jump from one chunk
+   * to the next one of the same core.
+   */
+  auto prefetchedLoads = this->addPrefetchesToTaskBody(LDI,
+                                                       0,
+                                                       ltm->getChunkSize(),
+                                                       this->numTaskInstances);
+  if (true && (prefetchedLoads > 0)
+      && (this->verbose != Verbosity::Disabled)) {
+    errs() << "DOALL:   " << prefetchedLoads
+           << " loads are prefetched by the task\n";
+  }
+
+  /*
+   * Lay out the basic blocks of the task.
+   */
+  this->layOutTaskBody(LDI, 0);
+
   /*
    * Final printing.
    */
@@ -425,6 +713,9 @@ void DOALL::addChunkFunctionExecutionAsideOriginalLoop(LoopDependenceInfo *LDI,
   auto ltm = LDI->getLoopTransformationsManager();
   auto cm = par.getConstantsManager();
   auto numCores = cm->getIntegerConstant(ltm->getMaximumNumberOfCores(), 64);
+  if (false || this->reduceDeterministically || (this->scan != nullptr)) {
+    numCores = cm->getIntegerConstant(this->numTaskInstances, 64);
+  }
 
   /*
    * Fetch the chunk size.
@@ -432,16 +723,202 @@ void DOALL::addChunkFunctionExecutionAsideOriginalLoop(LoopDependenceInfo *LDI,
   auto chunkSize = cm->getIntegerConstant(ltm->getChunkSize(), 64);
 
   /*
-   * Call the function that incudes the parallelized loop.
+   * Initialize the exit block taken by the loop, if it has more than one.
+   * Tasks do not store it: the loop leaves through the exit of the loop
+   * governing IV unless an iteration leaves it earlier, in which case the
+   * runtime stores the exit taken by the earliest such iteration.
    */
   IRBuilder<> doallBuilder(this->entryPointOfParallelizedLoop);
-  auto doallCallInst = doallBuilder.CreateCall(
-      this->taskDispatcher,
-      ArrayRef<Value *>(
-          { tasks[0]->getTaskBody(), envPtr, numCores, chunkSize }));
+  auto loopEnvironment = LDI->getEnvironment();
+  auto exitBlockEnvIndex = loopEnvironment->indexOfExitBlockTaken();
+  Value *exitBlockTakenPtr = nullptr;
+  if (exitBlockEnvIndex >= 0) {
+    exitBlockTakenPtr =
+        this->envBuilder->getEnvironmentVariable(exitBlockEnvIndex);
+    auto exitIndex = this->getIndexOfTheExitBlockOfTheLoopGoverningIV(LDI);
+    doallBuilder.CreateStore(cm->getIntegerConstant(exitIndex, 32),
+                             exitBlockTakenPtr);
+  }
+
+  /*
+   * Call the function that incudes the parallelized loop.
+   */
+  CallInst *doallCallInst = nullptr;
+  auto scheduling = this->getChunkScheduling(LDI);
+  auto canLeaveEarly = this->canLeaveEarly(LDI);
+  auto runSpeculatively = this->mustRunSpeculatively(LDI);
+  auto indices = this->getIndicesToInspect(LDI);
+  std::string distribution;
+  auto distribute = this->mustDistribute(LDI, distribution);
+  Value *tripCount = nullptr;
+  auto needsTripCount =
+      false || (this->taskDispatcherWithTripCount != nullptr)
+      || (indices != nullptr) || (this->scan != nullptr);
+  if (true && needsTripCount && (!canLeaveEarly) && (!runSpeculatively)
+      && (!this->reduceDeterministically) && (!distribute)) {
+    tripCount = this->generateCodeToComputeTheTripCount(LDI, doallBuilder);
+  }
+  if (distribute) {
+
+    /*
+     * Every MPI rank runs its share of the tasks, and the runtime combines the
+     * reduced live-outs of all ranks into the first private copy.
+     */
+    auto distributionValue = doallBuilder.CreateGlobalStringPtr(distribution);
+    doallCallInst = doallBuilder.CreateCall(
+        this->taskDispatcherDistributed,
+        ArrayRef<Value *>({ tasks[0]->getTaskBody(),
+                            envPtr,
+                            numCores,
+                            chunkSize,
+                            distributionValue }));
+
+  } else if (this->reduceDeterministically) {
+
+    /*
+     * The runtime runs all tasks even if fewer cores are available, so every
+     * private copy accumulates the same iterations at every invocation.
+     */
+    doallCallInst = doallBuilder.CreateCall(
+        this->taskDispatcherWithFixedTasks,
+        ArrayRef<Value *>(
+            { tasks[0]->getTaskBody(), envPtr, numCores, chunkSize }));
+
+  } else if (this->scan != nullptr) {
+
+    /*
+     * The runtime splits the iterations into one block per task.
+     */
+    assert(tripCount != nullptr);
+    doallCallInst = this->generateCodeToDispatchScan(LDI,
+                                                     envPtr,
+                                                     numCores,
+                                                     tripCount,
+                                                     doallBuilder);
+
+  } else if (true && (scheduling == DOALL_STATIC_SCHEDULING)
+             && (tripCount == nullptr) && (!canLeaveEarly)
+             && (!runSpeculatively)) {
+    doallCallInst = doallBuilder.CreateCall(
+        this->taskDispatcher,
+        ArrayRef<Value *>(
+            { tasks[0]->getTaskBody(), envPtr, numCores, chunkSize }));
+
+  } else {
+
+    /*
+     * The guided scheduling shrinks the chunks as the loop gets closer to its
+     * end. To this end, the runtime needs the total number of chunks. If this
+     * is not known at compile time, we pass 0 and the runtime falls back to
+     * hand out one chunk at a time.
+     */
+    uint64_t numberOfChunks = 0;
+    if (LDI->doesHaveCompileTimeKnownTripCount()) {
+      auto tripCount = LDI->getCompileTimeTripCount();
+      numberOfChunks =
+          (tripCount + ltm->getChunkSize() - 1) / ltm->getChunkSize();
+    }
+    auto schedulingValue = cm->getIntegerConstant(scheduling, 64);
+    auto numberOfChunksValue = cm->getIntegerConstant(numberOfChunks, 64);
+    if (canLeaveEarly) {
+
+      /*
+       * The tasks stop each other when an iteration leaves the loop.
+       */
+      assert(exitBlockTakenPtr != nullptr);
+      doallCallInst = doallBuilder.CreateCall(
+          this->taskDispatcherWithCancellation,
+          ArrayRef<Value *>({ tasks[0]->getTaskBody(),
+                              envPtr,
+                              numCores,
+                              chunkSize,
+                              schedulingValue,
+                              numberOfChunksValue,
+                              exitBlockTakenPtr }));
+
+    } else if (runSpeculatively) {
+
+      /*
+       * The runtime checks whether the tasks accessed the same memory and, if
+       * they did, runs the loop again sequentially.
+       */
+      doallCallInst = doallBuilder.CreateCall(
+          this->taskDispatcherWithSpeculation,
+          ArrayRef<Value *>({ tasks[0]->getTaskBody(),
+                              envPtr,
+                              numCores,
+                              chunkSize,
+                              schedulingValue,
+                              numberOfChunksValue }));
+
+    } else if (indices != nullptr) {
+
+      /*
+       * The runtime checks whether the iterations use distinct indices and,
+       * if they do not, runs the loop sequentially.
+       */
+      assert(tripCount != nullptr);
+      auto &DL = par.getProgram()->getDataLayout();
+      auto firstIndex =
+          this->generateCodeToComputeTheFirstIndex(LDI, indices, doallBuilder);
+      auto &IV = LDI->getLoopGoverningIVAttribution()->getInductionVariable();
+      auto stride = cast<ConstantInt>(IV.getSingleComputedStepValue());
+      doallCallInst = doallBuilder.CreateCall(
+          this->taskDispatcherWithInspection,
+          ArrayRef<Value *>(
+              { tasks[0]->getTaskBody(),
+                envPtr,
+                numCores,
+                chunkSize,
+                schedulingValue,
+                numberOfChunksValue,
+                firstIndex,
+                cm->getIntegerConstant(
+                    DL.getTypeStoreSize(indices->getType()),
+                    64),
+                cm->getIntegerConstant(stride->getSExtValue(), 64),
+                tripCount }));
+
+    } else if (tripCount != nullptr) {
+
+      /*
+       * The runtime can run the loop sequentially if it has few iterations.
+       */
+      doallCallInst = doallBuilder.CreateCall(
+          this->taskDispatcherWithTripCount,
+          ArrayRef<Value *>({ tasks[0]->getTaskBody(),
+                              envPtr,
+                              numCores,
+                              chunkSize,
+                              schedulingValue,
+                              numberOfChunksValue,
+                              tripCount }));
+
+    } else {
+      doallCallInst = doallBuilder.CreateCall(
+          this->taskDispatcherWithScheduling,
+          ArrayRef<Value *>({ tasks[0]->getTaskBody(),
+                              envPtr,
+                              numCores,
+                              chunkSize,
+                              schedulingValue,
+                              numberOfChunksValue }));
+    }
+  }
+  this->dispatcherCall = doallCallInst;
   auto numThreadsUsed =
       doallBuilder.CreateExtractValue(doallCallInst, (uint64_t)0);
 
+  /*
+   * Write the output buffered by the tasks.
+   */
+  this->generateCodeToWriteBufferedOutput(LDI, doallBuilder, envPtr);
+
+  /*
+   * Combine the private copies of the reduced arrays with the original ones.
+   */
+  this->generateCodeToReduceArrays(numThreadsUsed, doallBuilder);
+
   /*
    * Propagate the last value of live-out variables to the code outside the
    * parallelized loop.
@@ -474,6 +951,268 @@ Value *DOALL::fetchClone(Value *original) const {
   return iClone;
 }
 
+CallInst *DOALL::getDispatcherCall(void) const {
+  return this->dispatcherCall;
+}
+
+Function *DOALL::getTaskFunction(void) const {
+  return tasks[0]->getTaskBody();
+}
+
+bool DOALL::doesReduceDeterministically(void) const {
+  return this->reduceDeterministically;
+}
+
+bool DOALL::doesScan(void) const {
+  return this->scan != nullptr;
+}
+
+bool DOALL::mustReduceDeterministically(LoopDependenceInfo *LDI) const {
+  if (this->n.getNumberOfDeterministicReductionPartitions() == 0) {
+    return false;
+  }
+
+  return this->reducesFloatingPointVariables(LDI);
+}
+
+DOALLChunkScheduling DOALL::getChunkScheduling(
+    LoopDependenceInfo *LDI) const {
+
+  /*
+   * Fetch the policy requested for the loop.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  auto scheduling = ltm->getDOALLChunkScheduling();
+
+  /*
+   * Chunks handed out at run time would be accumulated by different private
+   * copies at different invocations.
+   */
+  if (this->mustReduceDeterministically(LDI)) {
+    return DOALL_STATIC_SCHEDULING;
+  }
+
+  /*
+   * Each task of a scan runs a fixed block of iterations.
+   */
+  if (this->mustScan(LDI)) {
+    return DOALL_STATIC_SCHEDULING;
+  }
+
+  /*
+   * Non-static policies need the runtime to hand out chunks.
+   * Fall back to the static policy if the runtime does not provide the APIs
+   * needed.
+   */
+  if (true && (scheduling != DOALL_STATIC_SCHEDULING)
+      && ((this->taskDispatcherWithScheduling == nullptr)
+          || (this->fetchNextChunk == nullptr))) {
+    return DOALL_STATIC_SCHEDULING;
+  }
+
+  return scheduling;
+}
+
+bool DOALL::canComputeTheTripCount(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Fetch the induction variable that governs the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  if (loopGoverningIVAttr == nullptr) {
+    return false;
+  }
+  auto &IV = loopGoverningIVAttr->getInductionVariable();
+
+  /*
+   * The trip count can be computed before entering the loop only if the
+   * induction variable is an integer or a pointer with a step whose sign is
+   * known at compile time, and the loop compares it directly against a value
+   * defined outside the loop.
+   * The step can be computed at run time as long as it is available before
+   * entering the loop.
+   */
+  auto stepValue = IV.getSingleComputedStepValue();
+  if (false
+      || (true && (!IV.getIVType()->isIntegerTy())
+          && (!IV.getIVType()->isPointerTy()))
+      || (stepValue == nullptr) || (!stepValue->getType()->isIntegerTy())
+      || (!IV.isStepValueSignKnown())
+      || (loopGoverningIVAttr->getConditionValueDerivation().size() > 0)) {
+    return false;
+  }
+  auto loopFunction = loopStructure->getFunction();
+  auto isDefinedOutsideTheLoop = [loopStructure,
+                                  loopFunction](Value *v) -> bool {
+    if (auto inst = dyn_cast<Instruction>(v)) {
+      return true && (inst->getFunction() == loopFunction)
+             && (!loopStructure->isIncluded(inst));
+    }
+    return true;
+  };
+  auto startValue = IV.getStartValue();
+  auto exitConditionValue = loopGoverningIVAttr->getExitConditionValue();
+  if (false || (!isDefinedOutsideTheLoop(startValue))
+      || (!isDefinedOutsideTheLoop(exitConditionValue))
+      || (!isDefinedOutsideTheLoop(stepValue))
+      || (startValue->getType() != exitConditionValue->getType())
+      || (IV.getIVType()->isIntegerTy()
+          && (startValue->getType() != stepValue->getType()))) {
+    return false;
+  }
+
+  return true;
+}
+
+Value *DOALL::generateCodeToComputeTheTripCount(LoopDependenceInfo *LDI,
+                                                IRBuilder<> &builder) {
+  if (!this->canComputeTheTripCount(LDI)) {
+    return nullptr;
+  }
+
+  /*
+   * Generate the code to compute the trip count.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  auto IVManager = LDI->getInductionVariableManager();
+  LoopGoverningIVUtility ivUtility(loopStructure,
+                                   *IVManager,
+                                   *loopGoverningIVAttr);
+  auto tripCount = ivUtility.generateCodeToComputeTheTripCount(builder);
+
+  /*
+   * The runtime takes the trip count as a 64-bit integer.
+   */
+  auto tm = this->n.getTypesManager();
+  auto tripCount64 =
+      builder.CreateZExtOrTrunc(tripCount, tm->getIntegerType(64));
+
+  return tripCount64;
+}
+
+bool DOALL::canLeaveEarly(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check if the runtime can stop the tasks of a DOALL loop.
+   */
+  if (false || (this->taskDispatcherWithCancellation == nullptr)
+      || (this->cancelLoop == nullptr) || (this->isLoopCancelled == nullptr)) {
+    return false;
+  }
+
+  /*
+   * The iteration that leaves the loop is computed from the induction variable
+   * that governs the loop. Hence, this must be an integer with a constant
+   * positive step.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  if (loopGoverningIVAttr == nullptr) {
+    return false;
+  }
+  auto &IV = loopGoverningIVAttr->getInductionVariable();
+  auto stepValue = IV.getSingleComputedStepValue();
+  if (false || (!IV.getIVType()->isIntegerTy()) || (stepValue == nullptr)
+      || (!isa<ConstantInt>(stepValue)) || (!IV.isStepValuePositive())
+      || (IV.getStartValue()->getType() != stepValue->getType())) {
+    return false;
+  }
+
+  /*
+   * The loop must have early exits: edges that leave the loop from a basic
+   * block other than the header.
+   * These must not reach the exit block of the loop governing IV; otherwise,
+   * we could not tell which one has been taken by the parallelized loop.
+   */
+  auto loopHeader = loopStructure->getHeader();
+  auto exitBlockOfIV = loopGoverningIVAttr->getExitBlockFromHeader();
+  auto hasEarlyExits = false;
+  for (auto exitEdge : loopStructure->getLoopExitEdges()) {
+    auto fromBB = exitEdge.first;
+    auto toBB = exitEdge.second;
+    if (fromBB == loopHeader) {
+      if (toBB != exitBlockOfIV) {
+        return false;
+      }
+      continue;
+    }
+    if (toBB == exitBlockOfIV) {
+      return false;
+    }
+    hasEarlyExits = true;
+  }
+  if (!hasEarlyExits) {
+    return false;
+  }
+
+  /*
+   * Iterations after the one that leaves the loop might have been executed by
+   * other tasks. So the loop must not produce values used after the loop, and
+   * it must not write to memory.
+   */
+  auto loopEnvironment = LDI->getEnvironment();
+  auto liveOuts = loopEnvironment->getEnvIndicesOfLiveOutVars();
+  if (liveOuts.begin() != liveOuts.end()) {
+    return false;
+  }
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (auto callInst = dyn_cast<CallInst>(&I)) {
+        if (callInst->isLifetimeStartOrEnd()) {
+          continue;
+        }
+      }
+      if (I.mayWriteToMemory()) {
+        return false;
+      }
+    }
+  }
+
+  /*
+   * The early exits must not depend on the specific basic block that left the
+   * loop: their PHIs must have a single constant value.
+   */
+  for (auto exitBB : loopStructure->getLoopExitBasicBlocks()) {
+    if (exitBB == exitBlockOfIV) {
+      continue;
+    }
+    for (auto &phi : exitBB->phis()) {
+      auto value = phi.hasConstantValue();
+      if (false || (value == nullptr) || (!isa<Constant>(value))) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+uint32_t DOALL::getIndexOfTheExitBlockOfTheLoopGoverningIV(
+    LoopDependenceInfo *LDI) const {
+
+  /*
+   * Fetch the exit block of the loop governing IV.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  assert(loopGoverningIVAttr != nullptr);
+  auto exitBlockOfIV = loopGoverningIVAttr->getExitBlockFromHeader();
+
+  /*
+   * Find its index among the exit blocks of the loop.
+   */
+  auto loopExitBlocks = loopStructure->getLoopExitBasicBlocks();
+  for (auto i = 0; i < loopExitBlocks.size(); i++) {
+    if (loopExitBlocks[i] == exitBlockOfIV) {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
 void DOALL::addJumpToLoop(LoopDependenceInfo *LDI, Task *t) {
 
   /*
@@ -25,7 +25,8 @@ using namespace llvm;
 using namespace llvm::noelle;
 
 DOALLTask::DOALLTask(FunctionType *taskSignature, Module &M)
-  : Task{ 0, taskSignature, M } {
+  : Task{ 0, taskSignature, M },
+    chunkPHI{ nullptr } {
 
   return;
 }
@@ -23,6 +23,58 @@
 
 namespace llvm::noelle {
 
+bool DOALL::canBeAppliedToLoopStructure(LoopStructure *loopStructure,
+                                        std::string &reason) {
+
+  /*
+   * The loop must exit.
+   */
+  if (loopStructure->numberOfExitBasicBlocks() == 0) {
+    reason = "the loop has no exits";
+    return false;
+  }
+
+  /*
+   * The loop must be governed by an induction variable, which is compared by
+   * the conditional branch of the header that leaves the loop.
+   */
+  auto header = loopStructure->getHeader();
+  auto headerBr = dyn_cast<BranchInst>(header->getTerminator());
+  if (false || (headerBr == nullptr) || (!headerBr->isConditional())
+      || (!isa<CmpInst>(headerBr->getCondition()))
+      || (true && loopStructure->isIncluded(headerBr->getSuccessor(0))
+          && loopStructure->isIncluded(headerBr->getSuccessor(1)))) {
+    reason = "the loop cannot have a loop-governing induction variable";
+    return false;
+  }
+
+  /*
+   * Calls to library functions that are neither pure nor thread safe might
+   * access any memory location, which creates loop-carried data dependences
+   * that cannot be removed.
+   */
+  for (auto inst : loopStructure->getInstructions()) {
+    auto call = dyn_cast<CallBase>(inst);
+    if (false || (call == nullptr) || (!call->mayReadOrWriteMemory())) {
+      continue;
+    }
+    auto callee = call->getCalledFunction();
+    if (false || (callee == nullptr) || (!callee->empty())
+        || callee->isIntrinsic()) {
+      continue;
+    }
+    if (false || PDGAnalysis::isTheLibraryFunctionPure(callee)
+        || PDGAnalysis::isTheLibraryFunctionThreadSafe(callee)) {
+      continue;
+    }
+    reason = "the loop invokes the library function " + callee->getName().str()
+             + " whose side effects are unknown";
+    return false;
+  }
+
+  return true;
+}
+
 std::set<SCC *> DOALL::getSCCsThatBlockDOALLToBeApplicable(
     LoopDependenceInfo *LDI,
     Noelle &par) {
@@ -107,4 +159,9 @@ std::set<SCC *> DOALL::getSCCsThatBlockDOALLToBeApplicable(
   return sccs;
 }
 
+std::set<SCC *> DOALL::getSCCsThatBlockTheParallelization(
+    LoopDependenceInfo *LDI) const {
+  return DOALL::getSCCsThatBlockDOALLToBeApplicable(LDI, this->n);
+}
+
 } // namespace llvm::noelle
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Analysis/ValueTracking.h"
+#include "DOALL.hpp"
+#include "DOALLTask.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Larger arrays are not privatized: allocating and combining a copy per task
+ * would cost more than running the loop.
+ */
+static const uint64_t maximumBytesOfReducedArrays = 1 << 20;
+
+bool DOALL::mustReduceArrays(LoopDependenceInfo *LDI) const {
+  return this->getArraysToReduce(LDI).size() > 0;
+}
+
+std::vector<DOALLArrayReduction> DOALL::getArraysToReduce(
+    LoopDependenceInfo *LDI) const {
+  std::vector<DOALLArrayReduction> reductions;
+
+  /*
+   * Check if the runtime can privatize arrays.
+   */
+  if (false || (this->allocateReductionArrays == nullptr)
+      || (this->reduceArrays == nullptr)) {
+    return reductions;
+  }
+
+  /*
+   * Check if the privatization has been disabled for this loop.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  if (false || (!this->n.isTransformationEnabled(ARRAY_REDUCTION_ID))
+      || (!ltm->isTransformationEnabled(ARRAY_REDUCTION_ID))) {
+    return reductions;
+  }
+
+  /*
+   * The privatization is needed only if some SCCs block DOALL.
+   */
+  auto nonDOALLSCCs = this->getSCCsThatBlockTheParallelization(LDI);
+  if (nonDOALLSCCs.size() == 0) {
+    return reductions;
+  }
+
+  /*
+   * Every loop-carried dependence that blocks DOALL must be through memory
+   * between two accesses to the same global variable or stack object.
+   */
+  auto &DL = this->n.getProgram()->getDataLayout();
+  auto getArrayOf = [&DL](Value *value) -> Value * {
+    auto inst = dyn_cast<Instruction>(value);
+    if (false || (inst == nullptr)
+        || ((!isa<LoadInst>(inst)) && (!isa<StoreInst>(inst)))) {
+      return nullptr;
+    }
+    auto array = GetUnderlyingObject(getLoadStorePointerOperand(inst), DL);
+    if (false || isa<GlobalVariable>(array) || isa<AllocaInst>(array)) {
+      return array;
+    }
+    return nullptr;
+  };
+  auto sccManager = LDI->getSCCManager();
+  std::vector<Value *> arrays;
+  auto canBeReduced = true;
+  for (auto scc : nonDOALLSCCs) {
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [&canBeReduced, &arrays, &getArrayOf](DGEdge<Value> *dep) -> bool {
+          if (dep->isControlDependence()) {
+            return false;
+          }
+          if (!dep->isMemoryDependence()) {
+            canBeReduced = false;
+            return true;
+          }
+          auto array = getArrayOf(dep->getOutgoingT());
+          if (false || (array == nullptr)
+              || (array != getArrayOf(dep->getIncomingT()))) {
+            canBeReduced = false;
+            return true;
+          }
+          if (std::find(arrays.begin(), arrays.end(), array) == arrays.end()) {
+            arrays.push_back(array);
+          }
+          return false;
+        });
+    if (!canBeReduced) {
+      return reductions;
+    }
+  }
+
+  /*
+   * All these objects must be reduced by the loop.
+   */
+  for (auto array : arrays) {
+    DOALLArrayReduction reduction;
+    if (!this->isArrayReduction(LDI, array, reduction)) {
+      reductions.clear();
+      return reductions;
+    }
+    reductions.push_back(reduction);
+  }
+
+  return reductions;
+}
+
+bool DOALL::isArrayReduction(LoopDependenceInfo *LDI,
+                             Value *array,
+                             DOALLArrayReduction &reduction) const {
+
+  /*
+   * The object must have a size known at compile time and be defined outside
+   * the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopFunction = loopStructure->getFunction();
+  auto &DL = this->n.getProgram()->getDataLayout();
+  Type *arrayType = nullptr;
+  uint64_t numberOfArrays = 1;
+  if (auto globalVariable = dyn_cast<GlobalVariable>(array)) {
+    arrayType = globalVariable->getValueType();
+  } else {
+    auto allocaInst = cast<AllocaInst>(array);
+    auto arraySize = dyn_cast<ConstantInt>(allocaInst->getArraySize());
+    if (false || (arraySize == nullptr)
+        || (allocaInst->getFunction() != loopFunction)
+        || loopStructure->isIncluded(allocaInst)) {
+      return false;
+    }
+    arrayType = allocaInst->getAllocatedType();
+    numberOfArrays = arraySize->getZExtValue();
+  }
+  if (!arrayType->isSized()) {
+    return false;
+  }
+  auto bytes = DL.getTypeAllocSize(arrayType) * numberOfArrays;
+  if (false || (bytes == 0) || (bytes > maximumBytesOfReducedArrays)) {
+    return false;
+  }
+
+  /*
+   * The object must be an array of integers or floating point values, which
+   * are reduced only if they can be considered real numbers.
+   */
+  auto elementType = arrayType;
+  while (auto arrayOfElements = dyn_cast<ArrayType>(elementType)) {
+    elementType = arrayOfElements->getElementType();
+  }
+  DOALLArrayReductionType elementTypeCode;
+  if (elementType->isIntegerTy(8)) {
+    elementTypeCode = DOALL_REDUCTION_INT8;
+  } else if (elementType->isIntegerTy(16)) {
+    elementTypeCode = DOALL_REDUCTION_INT16;
+  } else if (elementType->isIntegerTy(32)) {
+    elementTypeCode = DOALL_REDUCTION_INT32;
+  } else if (elementType->isIntegerTy(64)) {
+    elementTypeCode = DOALL_REDUCTION_INT64;
+  } else if (true && elementType->isFloatTy()
+             && this->n.canFloatsBeConsideredRealNumbers()) {
+    elementTypeCode = DOALL_REDUCTION_FLOAT;
+  } else if (true && elementType->isDoubleTy()
+             && this->n.canFloatsBeConsideredRealNumbers()) {
+    elementTypeCode = DOALL_REDUCTION_DOUBLE;
+  } else {
+    return false;
+  }
+
+  /*
+   * Collect the accesses of the loop to the object.
+   * They must access its elements one at a time.
+   */
+  std::vector<Instruction *> accesses;
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (true && (!isa<LoadInst>(&I)) && (!isa<StoreInst>(&I))) {
+        continue;
+      }
+      auto pointer = getLoadStorePointerOperand(&I);
+      if (GetUnderlyingObject(pointer, DL) != array) {
+        continue;
+      }
+      auto accessedType = I.getType();
+      if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+        accessedType = storeInst->getValueOperand()->getType();
+      }
+      if (false || (accessedType != elementType)
+          || (isa<LoadInst>(&I) && (!cast<LoadInst>(&I)->isSimple()))
+          || (isa<StoreInst>(&I) && (!cast<StoreInst>(&I)->isSimple()))) {
+        return false;
+      }
+      accesses.push_back(&I);
+    }
+  }
+
+  /*
+   * Every access must be the load or the store of an update
+   * array[j] = array[j] op value, where op is associative and commutative and
+   * value does not depend on the object.
+   * The load and the store of an update must be next to each other as far as
+   * the object is concerned.
+   */
+  auto isAccess = [&accesses](Value *value) -> bool {
+    return std::find(accesses.begin(), accesses.end(), value)
+           != accesses.end();
+  };
+  auto numberOfLoads = 0u;
+  auto numberOfUpdates = 0u;
+  auto operationIsKnown = false;
+  DOALLArrayReductionOperation operation = DOALL_REDUCTION_ADD;
+  for (auto access : accesses) {
+    if (isa<LoadInst>(access)) {
+      numberOfLoads++;
+      continue;
+    }
+    auto storeInst = cast<StoreInst>(access);
+    auto update = dyn_cast<BinaryOperator>(storeInst->getValueOperand());
+    if (false || (update == nullptr) || (!update->hasOneUse())) {
+      return false;
+    }
+
+    /*
+     * Fetch the operation of the update.
+     * Subtractions accumulate negated values, so they are combined by adding
+     * the copies.
+     */
+    DOALLArrayReductionOperation updateOperation;
+    auto isCommutative = true;
+    switch (update->getOpcode()) {
+      case Instruction::Sub:
+      case Instruction::FSub:
+        isCommutative = false;
+        updateOperation = DOALL_REDUCTION_ADD;
+        break;
+      case Instruction::Add:
+      case Instruction::FAdd:
+        updateOperation = DOALL_REDUCTION_ADD;
+        break;
+      case Instruction::Mul:
+      case Instruction::FMul:
+        updateOperation = DOALL_REDUCTION_MUL;
+        break;
+      case Instruction::And:
+        updateOperation = DOALL_REDUCTION_AND;
+        break;
+      case Instruction::Or:
+        updateOperation = DOALL_REDUCTION_OR;
+        break;
+      case Instruction::Xor:
+        updateOperation = DOALL_REDUCTION_XOR;
+        break;
+      default:
+        return false;
+    }
+    if (true && operationIsKnown && (updateOperation != operation)) {
+      return false;
+    }
+    operation = updateOperation;
+    operationIsKnown = true;
+
+    /*
+     * Fetch the load of the update.
+     */
+    auto loadInst = dyn_cast<LoadInst>(update->getOperand(0));
+    auto value = update->getOperand(1);
+    if (true && isCommutative
+        && ((loadInst == nullptr)
+            || (loadInst->getPointerOperand()
+                != storeInst->getPointerOperand()))) {
+      loadInst = dyn_cast<LoadInst>(update->getOperand(1));
+      value = update->getOperand(0);
+    }
+    if (false || (loadInst == nullptr) || (!isAccess(loadInst))
+        || isAccess(value) || (!loadInst->hasOneUse())
+        || (loadInst->getPointerOperand() != storeInst->getPointerOperand())
+        || (loadInst->getParent() != storeInst->getParent())) {
+      return false;
+    }
+    for (auto inst = loadInst->getNextNode(); inst != storeInst;
+         inst = inst->getNextNode()) {
+      if (false || isAccess(inst) || isa<CallBase>(inst)) {
+        return false;
+      }
+    }
+    numberOfUpdates++;
+  }
+  if (numberOfLoads != numberOfUpdates) {
+    return false;
+  }
+
+  /*
+   * The loop must not access the object in any other way.
+   * Hence, the accesses must depend through memory only on each other within
+   * the loop.
+   */
+  auto loopDG = LDI->getLoopDG();
+  auto isOtherAccessOfTheLoop = [loopStructure,
+                                 &isAccess](Value *value,
+                                            DGEdge<Value> *dep) -> bool {
+    auto inst = dyn_cast<Instruction>(value);
+    return true && (inst != nullptr) && loopStructure->isIncluded(inst)
+           && (!isAccess(inst));
+  };
+  for (auto access : accesses) {
+    if (false
+        || loopDG->iterateOverDependencesFrom(access,
+                                              false,
+                                              true,
+                                              false,
+                                              isOtherAccessOfTheLoop)
+        || loopDG->iterateOverDependencesTo(access,
+                                            false,
+                                            true,
+                                            false,
+                                            isOtherAccessOfTheLoop)) {
+      return false;
+    }
+  }
+
+  /*
+   * The object is reduced by the loop.
+   */
+  reduction.array = array;
+  reduction.bytes = bytes;
+  reduction.elementType = elementTypeCode;
+  reduction.operation = operation;
+  reduction.accesses = accesses;
+  reduction.copies = nullptr;
+
+  return true;
+}
+
+uint64_t DOALL::getStrideOfPrivateArrays(
+    DOALLArrayReduction const &reduction) const {
+
+  /*
+   * Private copies start at different cache lines to avoid false sharing.
+   */
+  return alignTo(reduction.bytes, 64);
+}
+
+void DOALL::generateCodeToAllocatePrivateArrays(LoopDependenceInfo *LDI) {
+
+  /*
+   * The copies are allocated by the caller just before jumping to the
+   * parallelized loop, and they are passed to the tasks through the
+   * environment.
+   */
+  auto loopEnvironment = LDI->getEnvironment();
+  auto cm = this->n.getConstantsManager();
+  IRBuilder<> builder(this->entryPointOfParallelizedLoop);
+  for (auto &reduction : this->arrayReductions) {
+    reduction.copies = builder.CreateCall(
+        this->allocateReductionArrays,
+        ArrayRef<Value *>(
+            { cm->getIntegerConstant(reduction.bytes, 64),
+              cm->getIntegerConstant(this->getStrideOfPrivateArrays(reduction),
+                                     64),
+              cm->getIntegerConstant(this->numTaskInstances, 64),
+              cm->getIntegerConstant(reduction.elementType, 64),
+              cm->getIntegerConstant(reduction.operation, 64) }));
+    auto copiesEnvIndex = loopEnvironment->addLiveInValue(reduction.copies, {});
+    this->envBuilder->addVariableToEnvironment(copiesEnvIndex,
+                                               reduction.copies->getType());
+
+    /*
+     * The tasks need the address of stack objects to compute the offsets of
+     * the elements they update.
+     */
+    if (true && isa<AllocaInst>(reduction.array)
+        && (!loopEnvironment->isLiveIn(reduction.array))) {
+      auto arrayEnvIndex = loopEnvironment->addLiveInValue(reduction.array, {});
+      this->envBuilder->addVariableToEnvironment(arrayEnvIndex,
+                                                 reduction.array->getType());
+    }
+  }
+
+  return;
+}
+
+void DOALL::rewireLoopToReduceArrays(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = (DOALLTask *)this->tasks[0];
+  auto tm = this->n.getTypesManager();
+  auto int64 = tm->getIntegerType(64);
+
+  /*
+   * Compute the private copy of each array at the entry of the task.
+   */
+  auto entryBlock = task->getEntry();
+  IRBuilder<> entryBuilder(entryBlock);
+  if (auto entryTerminator = entryBlock->getTerminator()) {
+    entryBuilder.SetInsertPoint(entryTerminator);
+  }
+  for (auto &reduction : this->arrayReductions) {
+    auto copies = task->getCloneOfOriginalLiveIn(reduction.copies);
+    auto copyOffset = entryBuilder.CreateMul(
+        task->coreArg,
+        ConstantInt::get(int64, this->getStrideOfPrivateArrays(reduction)));
+    auto privateCopy = entryBuilder.CreateInBoundsGEP(copies, copyOffset);
+    auto array = reduction.array;
+    if (task->isAnOriginalLiveIn(array)) {
+      array = task->getCloneOfOriginalLiveIn(array);
+    }
+    auto arrayAddress = entryBuilder.CreatePtrToInt(array, int64);
+
+    /*
+     * Each access of the task keeps its offset within the array, but it
+     * accesses the private copy instead.
+     */
+    for (auto access : reduction.accesses) {
+      auto accessClone = task->getCloneOfOriginalInstruction(access);
+      assert(accessClone != nullptr);
+      IRBuilder<> builder(accessClone);
+      auto pointer = getLoadStorePointerOperand(accessClone);
+      auto offset =
+          builder.CreateSub(builder.CreatePtrToInt(pointer, int64),
+                            arrayAddress);
+      auto privatePointer =
+          builder.CreateBitCast(builder.CreateInBoundsGEP(privateCopy, offset),
+                                pointer->getType());
+      auto pointerIndex = isa<LoadInst>(accessClone)
+                              ? LoadInst::getPointerOperandIndex()
+                              : StoreInst::getPointerOperandIndex();
+      accessClone->setOperand(pointerIndex, privatePointer);
+    }
+  }
+
+  return;
+}
+
+void DOALL::generateCodeToReduceArrays(Value *numberOfThreadsUsed,
+                                       IRBuilder<> &builder) {
+
+  /*
+   * Combine the copies of the tasks that ran with the original arrays, which
+   * releases the copies.
+   */
+  auto tm = this->n.getTypesManager();
+  auto cm = this->n.getConstantsManager();
+  for (auto &reduction : this->arrayReductions) {
+    assert(reduction.copies != nullptr);
+    auto array =
+        builder.CreateBitCast(reduction.array, tm->getVoidPointerType());
+    builder.CreateCall(
+        this->reduceArrays,
+        ArrayRef<Value *>(
+            { array,
+              reduction.copies,
+              cm->getIntegerConstant(reduction.bytes, 64),
+              cm->getIntegerConstant(this->getStrideOfPrivateArrays(reduction),
+                                     64),
+              cm->getIntegerConstant(this->numTaskInstances, 64),
+              builder.CreateZExt(numberOfThreadsUsed, tm->getIntegerType(64)),
+              cm->getIntegerConstant(reduction.elementType, 64),
+              cm->getIntegerConstant(reduction.operation, 64) }));
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "DOALL.hpp"
+#include "DOALLTask.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<bool> ChunkTelemetry(
+    "doall-chunk-telemetry",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Make DOALL tasks record the cycles of their chunks in the "
+             "telemetry of the runtime (see NOELLE_TELEMETRY), which can be "
+             "given to the planner with -noelle-planner-doall-telemetry"));
+
+bool DOALL::mustRecordChunks(LoopDependenceInfo *LDI) const {
+  if (false || (ChunkTelemetry.getNumOccurrences() == 0)
+      || (this->startChunk == nullptr)) {
+    return false;
+  }
+
+  /*
+   * The chunks are recorded with the ID of the loop, which must be the same
+   * in the next compilation of the program.
+   */
+  auto mm = this->n.getMetadataManager();
+  auto loopStructure = LDI->getLoopStructure();
+  if (!mm->doesHaveMetadata(loopStructure, "noelle.loop_ID")) {
+    return false;
+  }
+
+  return true;
+}
+
+void DOALL::rewireLoopToRecordChunks(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = (DOALLTask *)tasks[0];
+  assert(task != nullptr);
+  assert(this->startChunk != nullptr);
+
+  /*
+   * Fetch the loop and its ID.
+   */
+  auto loopSummary = LDI->getLoopStructure();
+  auto loopHeader = loopSummary->getHeader();
+  auto loopPreHeader = loopSummary->getPreHeader();
+  auto preheaderClone = task->getCloneOfOriginalBasicBlock(loopPreHeader);
+  auto headerClone = task->getCloneOfOriginalBasicBlock(loopHeader);
+  auto taskFunction = task->getTaskBody();
+  auto &cxt = taskFunction->getContext();
+  auto mm = this->n.getMetadataManager();
+  auto loopID = std::stoll(mm->getMetadata(loopSummary, "noelle.loop_ID"));
+  auto tm = this->n.getTypesManager();
+  auto loopIDValue = ConstantInt::get(tm->getIntegerType(64), loopID);
+
+  /*
+   * The first chunk of the task starts when the task does.
+   */
+  IRBuilder<> entryBuilder(task->getEntry()->getTerminator());
+  entryBuilder.CreateCall(this->startChunk, ArrayRef<Value *>({ loopIDValue }));
+
+  /*
+   * Fetch the PHI that tracks the progress within the current chunk.
+   * This has been generated by rewireLoopToIterateChunks.
+   */
+  auto chunkPHI = task->chunkPHI;
+  assert(chunkPHI != nullptr);
+
+  /*
+   * Fetch the predecessors of the header that belong to the loop.
+   * These can be the basic blocks added to fetch the next chunk or to check
+   * whether the loop has been cancelled: the chunk PHI restarts from 0 on all
+   * of them when a new chunk begins.
+   */
+  std::vector<BasicBlock *> latches;
+  for (auto pred : predecessors(headerClone)) {
+    if (pred == preheaderClone) {
+      continue;
+    }
+    latches.push_back(pred);
+  }
+
+  /*
+   * Record the start of every other chunk:
+   *
+   * latch:
+   *   ...
+   *   br %checkChunk
+   *
+   * checkChunk:
+   *   br %chunkIsNew, %recordChunk, %header
+   *
+   * recordChunk:
+   *   call NOELLE_DOALL_startChunk(loopID)
+   *   br %header
+   */
+  for (auto latch : latches) {
+    auto chunkValue = chunkPHI->getIncomingValueForBlock(latch);
+
+    /*
+     * Create the new basic blocks.
+     */
+    auto checkChunkBB =
+        BasicBlock::Create(cxt, "check_if_chunk_starts", taskFunction);
+    auto recordChunkBB =
+        BasicBlock::Create(cxt, "record_chunk_start", taskFunction);
+    IRBuilder<> checkChunkBuilder(checkChunkBB);
+    auto isChunkNew = checkChunkBuilder.CreateICmpEQ(
+        chunkValue,
+        ConstantInt::get(chunkValue->getType(), 0));
+    checkChunkBuilder.CreateCondBr(isChunkNew, recordChunkBB, headerClone);
+    IRBuilder<> recordChunkBuilder(recordChunkBB);
+    recordChunkBuilder.CreateCall(this->startChunk,
+                                  ArrayRef<Value *>({ loopIDValue }));
+    recordChunkBuilder.CreateBr(headerClone);
+
+    /*
+     * Redirect the latch to the new check.
+     */
+    auto latchTerminator = latch->getTerminator();
+    for (auto i = 0; i < latchTerminator->getNumSuccessors(); i++) {
+      if (latchTerminator->getSuccessor(i) == headerClone) {
+        latchTerminator->setSuccessor(i, checkChunkBB);
+      }
+    }
+
+    /*
+     * All values flow unchanged through the new basic blocks.
+     */
+    for (auto &phi : headerClone->phis()) {
+      auto latchValue = phi.getIncomingValueForBlock(latch);
+      phi.setIncomingBlock(phi.getBasicBlockIndex(latch), checkChunkBB);
+      phi.addIncoming(latchValue, recordChunkBB);
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "DOALL.hpp"
+#include "DOALLTask.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<bool> Distributed(
+    "doall-distributed",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Split the DOALL loops that do not write memory across the MPI "
+             "ranks of a batch job that runs the program once per rank (see "
+             "NOELLE_DOALLDispatcherDistributed)"));
+
+bool DOALL::mustDistribute(LoopDependenceInfo *LDI,
+                           std::string &distribution) const {
+  if (false || (Distributed.getNumOccurrences() == 0)
+      || (this->taskDispatcherDistributed == nullptr)) {
+    return false;
+  }
+
+  /*
+   * The tasks must run the same iterations at every invocation, and their
+   * only state to move between ranks must be the environment.
+   */
+  if (false || this->reduceDeterministically || (this->scan != nullptr)
+      || (this->arrayReductions.size() > 0) || this->canLeaveEarly(LDI)
+      || this->mustRunSpeculatively(LDI)
+      || (this->getIndicesToInspect(LDI) != nullptr)
+      || (this->getChunkScheduling(LDI) != DOALL_STATIC_SCHEDULING)) {
+    return false;
+  }
+
+  /*
+   * Every rank has its own memory, so the loop must not write it.
+   * Reading it is fine: the ranks run the same program, so they compute the
+   * same memory before the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (I.mayWriteToMemory()) {
+        return false;
+      }
+    }
+  }
+
+  /*
+   * Rank 0 broadcasts the scalar live-ins, which could differ between ranks
+   * (e.g., a timestamp). Pointers are not broadcast because they point to the
+   * memory of their own rank.
+   */
+  auto &DL = this->n.getProgram()->getDataLayout();
+  auto loopEnvironment = LDI->getEnvironment();
+  distribution = "";
+  for (auto envIndex : loopEnvironment->getEnvIndicesOfLiveInVars()) {
+    auto type = loopEnvironment->typeOfEnvironmentLocation(envIndex);
+    if (!type->isIntOrIntVectorTy() && !type->isFPOrFPVectorTy()) {
+      continue;
+    }
+    auto offset =
+        this->envBuilder->getOffsetOfEnvironmentVariable(envIndex)
+        * sizeof(int64_t);
+    distribution += (distribution == "") ? "" : ",";
+    distribution += "b:" + std::to_string(offset) + ":"
+                  + std::to_string(DL.getTypeStoreSize(type));
+  }
+
+  /*
+   * The live-outs must be reduced, so the ranks can combine them.
+   * The last value of the other live-outs is known only by the rank that runs
+   * the last iteration.
+   */
+  if (loopEnvironment->indexOfExitBlockTaken() >= 0) {
+    return false;
+  }
+  auto sccManager = LDI->getSCCManager();
+  for (auto envIndex : loopEnvironment->getEnvIndicesOfLiveOutVars()) {
+    if (!this->envBuilder->hasVariableBeenReduced(envIndex)) {
+      return false;
+    }
+    auto producer = loopEnvironment->producerAt(envIndex);
+    auto producerSCC = sccManager->getSCCDAG()->sccOfValue(producer);
+    auto producerSCCAttributes = sccManager->getSCCAttrs(producerSCC);
+    auto accumulators = producerSCCAttributes->getAccumulators();
+    if (accumulators.begin() == accumulators.end()) {
+      return false;
+    }
+
+    /*
+     * The accumulators of a reduction are the operations of a scan without
+     * the uses of its intermediate values.
+     */
+    auto firstAccumulator = *accumulators.begin();
+    if (!isa<BinaryOperator>(firstAccumulator)) {
+      return false;
+    }
+    DOALLArrayReductionType elementType;
+    DOALLArrayReductionOperation operation;
+    if (!this->getTypeAndOperationOfScan(firstAccumulator,
+                                         elementType,
+                                         operation)) {
+      return false;
+    }
+    auto offset =
+        this->envBuilder->getOffsetOfEnvironmentVariable(envIndex)
+        * sizeof(int64_t);
+    auto stride = LoopEnvironmentUser::getReducerStride(DL, producer->getType())
+                  * sizeof(int64_t);
+    distribution += (distribution == "") ? "" : ",";
+    distribution += "p:" + std::to_string(offset) + ":" + std::to_string(stride)
+                  + ":" + std::to_string(elementType) + ":"
+                  + std::to_string(operation);
+  }
+
+  return true;
+}
+
+} // namespace llvm::noelle
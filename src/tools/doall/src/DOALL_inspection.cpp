@@ -0,0 +1,325 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "DOALL.hpp"
+
+namespace llvm::noelle {
+
+bool DOALL::mustBeInspected(LoopDependenceInfo *LDI) const {
+  return this->getIndicesToInspect(LDI) != nullptr;
+}
+
+LoadInst *DOALL::getIndicesToInspect(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check if the runtime can inspect the indices of DOALL loops.
+   */
+  if (this->taskDispatcherWithInspection == nullptr) {
+    return nullptr;
+  }
+
+  /*
+   * Check if the inspection has been disabled for this loop.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  if (false || (!this->n.isTransformationEnabled(INSPECTOR_EXECUTOR_DOALL_ID))
+      || (!ltm->isTransformationEnabled(INSPECTOR_EXECUTOR_DOALL_ID))) {
+    return nullptr;
+  }
+
+  /*
+   * The runtime inspects the index of every iteration before running the loop.
+   * Hence, the trip count must be known when the loop starts, and the index
+   * of each iteration must be computable from the induction variable that
+   * governs the loop.
+   */
+  if (false || this->canLeaveEarly(LDI)
+      || (!this->canComputeTheTripCount(LDI))) {
+    return nullptr;
+  }
+
+  /*
+   * Arrays that can be privatized are reduced instead: their loops run in
+   * parallel whatever the indices are.
+   */
+  if (this->mustReduceArrays(LDI)) {
+    return nullptr;
+  }
+  auto &IV = LDI->getLoopGoverningIVAttribution()->getInductionVariable();
+  if (false || (!IV.getIVType()->isIntegerTy())
+      || (!isa<ConstantInt>(IV.getSingleComputedStepValue()))) {
+    return nullptr;
+  }
+  auto ivPHI = IV.getLoopEntryPHI();
+
+  /*
+   * The inspection is needed only if some SCCs block DOALL.
+   */
+  auto nonDOALLSCCs = this->getSCCsThatBlockTheParallelization(LDI);
+  if (nonDOALLSCCs.size() == 0) {
+    return nullptr;
+  }
+
+  /*
+   * The header of a loop that is not rotated runs once more than the
+   * iterations counted by the trip count. Hence, it must not access the
+   * memory inspected.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopFunction = loopStructure->getFunction();
+  auto loopHeader = loopStructure->getHeader();
+  auto headerIsLatch = loopStructure->getLatches().count(loopHeader) > 0;
+  auto isExecutedByEveryIterationCounted =
+      [loopHeader, headerIsLatch](Instruction *inst) -> bool {
+    return headerIsLatch || (inst->getParent() != loopHeader);
+  };
+  auto isDefinedOutsideTheLoop = [loopStructure,
+                                  loopFunction](Value *v) -> bool {
+    if (auto inst = dyn_cast<Instruction>(v)) {
+      return true && (inst->getFunction() == loopFunction)
+             && (!loopStructure->isIncluded(inst));
+    }
+    return true;
+  };
+
+  /*
+   * Return the index loaded by @inst to subscript an array defined outside the
+   * loop if @inst accesses memory as array[index] (possibly extended), or
+   * nullptr otherwise.
+   * The subscripts that are not the index must be loop invariant.
+   */
+  auto getIndexOf = [&](Instruction *inst) -> LoadInst * {
+    Value *pointer = nullptr;
+    if (auto loadInst = dyn_cast<LoadInst>(inst)) {
+      pointer = loadInst->getPointerOperand();
+    } else if (auto storeInst = dyn_cast<StoreInst>(inst)) {
+      pointer = storeInst->getPointerOperand();
+    }
+    auto gep = dyn_cast_or_null<GetElementPtrInst>(pointer);
+    if (false || (gep == nullptr)
+        || (!isDefinedOutsideTheLoop(gep->getPointerOperand()))) {
+      return nullptr;
+    }
+    LoadInst *index = nullptr;
+    for (auto &subscript : gep->indices()) {
+      if (isDefinedOutsideTheLoop(subscript)) {
+        continue;
+      }
+      Value *value = subscript;
+      if (false || isa<SExtInst>(value) || isa<ZExtInst>(value)) {
+        value = cast<CastInst>(value)->getOperand(0);
+      }
+      if (false || (index != nullptr) || (!isa<LoadInst>(value))) {
+        return nullptr;
+      }
+      index = cast<LoadInst>(value);
+    }
+    return index;
+  };
+
+  /*
+   * Check if @index loads idx[i] (possibly extended) from an array defined
+   * outside the loop that the loop does not write, where i is the induction
+   * variable that governs the loop.
+   */
+  auto &DL = this->n.getProgram()->getDataLayout();
+  auto loopDG = LDI->getLoopDG();
+  auto isIndexOfTheIteration = [&](LoadInst *index) -> bool {
+    auto indexType = index->getType();
+    if (false || (!index->isSimple()) || (!indexType->isIntegerTy())
+        || (!isExecutedByEveryIterationCounted(index))) {
+      return false;
+    }
+    auto size = DL.getTypeStoreSize(indexType);
+    if (false || ((size != 1) && (size != 2) && (size != 4) && (size != 8))) {
+      return false;
+    }
+    auto gep = dyn_cast<GetElementPtrInst>(index->getPointerOperand());
+    if (false || (gep == nullptr) || (gep->getResultElementType() != indexType)
+        || (!isDefinedOutsideTheLoop(gep->getPointerOperand()))
+        || (gep->getNumIndices() == 0)) {
+      return false;
+    }
+    for (auto &subscript : gep->indices()) {
+      if (&subscript == (gep->idx_end() - 1)) {
+        continue;
+      }
+      if (!isDefinedOutsideTheLoop(subscript)) {
+        return false;
+      }
+    }
+    Value *lastSubscript = *(gep->idx_end() - 1);
+    if (false || isa<SExtInst>(lastSubscript) || isa<ZExtInst>(lastSubscript)) {
+      lastSubscript = cast<CastInst>(lastSubscript)->getOperand(0);
+    }
+    if (lastSubscript != ivPHI) {
+      return false;
+    }
+    auto isWritten = loopDG->iterateOverDependencesTo(
+        index,
+        false,
+        true,
+        false,
+        [loopStructure](Value *fromValue, DGEdge<Value> *dep) -> bool {
+          auto fromInst = dyn_cast<Instruction>(fromValue);
+          return true && (fromInst != nullptr)
+                 && loopStructure->isIncluded(fromInst);
+        });
+    return !isWritten;
+  };
+
+  /*
+   * Check if @inst and @otherInst access the same element of the same array
+   * whenever their iterations use the same index.
+   */
+  auto getAccessedType = [](Instruction *inst) -> Type * {
+    if (auto storeInst = dyn_cast<StoreInst>(inst)) {
+      return storeInst->getValueOperand()->getType();
+    }
+    return inst->getType();
+  };
+  auto accessTheSameElement = [&getAccessedType](
+                                  Instruction *inst,
+                                  Instruction *otherInst) -> bool {
+    auto gep = cast<GetElementPtrInst>(getLoadStorePointerOperand(inst));
+    auto otherGEP =
+        cast<GetElementPtrInst>(getLoadStorePointerOperand(otherInst));
+    if (false || (gep->getNumOperands() != otherGEP->getNumOperands())
+        || (gep->getSourceElementType() != otherGEP->getSourceElementType())
+        || (getAccessedType(inst) != getAccessedType(otherInst))) {
+      return false;
+    }
+    for (auto i = 0u; i < gep->getNumOperands(); i++) {
+      auto operand = gep->getOperand(i);
+      auto otherOperand = otherGEP->getOperand(i);
+      if (operand == otherOperand) {
+        continue;
+      }
+      auto castInst = dyn_cast<CastInst>(operand);
+      auto otherCastInst = dyn_cast<CastInst>(otherOperand);
+      if (true && (castInst != nullptr) && (otherCastInst != nullptr)) {
+        if (false || (castInst->getOpcode() != otherCastInst->getOpcode())
+            || (castInst->getDestTy() != otherCastInst->getDestTy())) {
+          return false;
+        }
+        operand = castInst->getOperand(0);
+        otherOperand = otherCastInst->getOperand(0);
+      }
+      auto index = dyn_cast<LoadInst>(operand);
+      auto otherIndex = dyn_cast<LoadInst>(otherOperand);
+      if (false || (index == nullptr) || (otherIndex == nullptr)
+          || (index->getType() != otherIndex->getType())) {
+        return false;
+      }
+      auto indexPointer = cast<Instruction>(index->getPointerOperand());
+      auto otherIndexPointer =
+          cast<Instruction>(otherIndex->getPointerOperand());
+      if (true && (indexPointer != otherIndexPointer)
+          && (!indexPointer->isIdenticalTo(otherIndexPointer))) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  /*
+   * Every loop-carried dependence that blocks DOALL must be through memory
+   * between two accesses to the same element of an array indexed by the
+   * index of their iterations.
+   * These dependences do not exist if the iterations use distinct indices.
+   */
+  auto sccManager = LDI->getSCCManager();
+  LoadInst *indices = nullptr;
+  Instruction *firstAccess = nullptr;
+  auto canBeInspected = true;
+  auto isIndexedAccess = [&](Value *value) -> bool {
+    auto inst = dyn_cast<Instruction>(value);
+    if (false || (inst == nullptr)
+        || ((!isa<LoadInst>(inst)) && (!isa<StoreInst>(inst)))
+        || (!isExecutedByEveryIterationCounted(inst))) {
+      return false;
+    }
+    auto index = getIndexOf(inst);
+    if (false || (index == nullptr) || (!isIndexOfTheIteration(index))) {
+      return false;
+    }
+    if (firstAccess == nullptr) {
+      firstAccess = inst;
+      indices = index;
+      return true;
+    }
+    return accessTheSameElement(firstAccess, inst);
+  };
+  for (auto scc : nonDOALLSCCs) {
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [&canBeInspected, &isIndexedAccess](DGEdge<Value> *dep) -> bool {
+          if (dep->isControlDependence()) {
+            return false;
+          }
+          if (false || (!dep->isMemoryDependence())
+              || (!isIndexedAccess(dep->getOutgoingT()))
+              || (!isIndexedAccess(dep->getIncomingT()))) {
+            canBeInspected = false;
+            return true;
+          }
+          return false;
+        });
+    if (!canBeInspected) {
+      return nullptr;
+    }
+  }
+
+  return indices;
+}
+
+Value *DOALL::generateCodeToComputeTheFirstIndex(LoopDependenceInfo *LDI,
+                                                 LoadInst *indices,
+                                                 IRBuilder<> &builder) {
+
+  /*
+   * The index of the first iteration is the one loaded when the induction
+   * variable that governs the loop has its start value.
+   */
+  auto &IV = LDI->getLoopGoverningIVAttribution()->getInductionVariable();
+  auto ivPHI = IV.getLoopEntryPHI();
+  auto startValue = IV.getStartValue();
+  auto gep = cast<GetElementPtrInst>(indices->getPointerOperand());
+  auto firstIndex = cast<GetElementPtrInst>(gep->clone());
+  auto lastSubscript = firstIndex->getOperand(firstIndex->getNumOperands() - 1);
+  Value *firstSubscript = startValue;
+  if (lastSubscript != ivPHI) {
+    auto castInst = cast<CastInst>(lastSubscript);
+    firstSubscript = builder.CreateCast(castInst->getOpcode(),
+                                        startValue,
+                                        castInst->getDestTy());
+  }
+  firstIndex->setOperand(firstIndex->getNumOperands() - 1, firstSubscript);
+  builder.Insert(firstIndex);
+
+  /*
+   * The runtime takes the address of the index as a void pointer.
+   */
+  auto tm = this->n.getTypesManager();
+  return builder.CreateBitCast(firstIndex, tm->getVoidPointerType());
+}
+
+} // namespace llvm::noelle
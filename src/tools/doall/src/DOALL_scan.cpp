@@ -0,0 +1,351 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Analysis/ValueTracking.h"
+#include "DOALL.hpp"
+#include "DOALLTask.hpp"
+
+namespace llvm::noelle {
+
+bool DOALL::mustScan(LoopDependenceInfo *LDI) const {
+  return this->getScan(LDI) != nullptr;
+}
+
+SCCAttrs *DOALL::getScan(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check if the runtime can run scans.
+   */
+  if (this->taskDispatcherWithScan == nullptr) {
+    return nullptr;
+  }
+
+  /*
+   * Check if scans have been disabled for this loop.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  if (false || (!this->n.isTransformationEnabled(SCAN_ID))
+      || (!ltm->isTransformationEnabled(SCAN_ID))) {
+    return nullptr;
+  }
+
+  /*
+   * The only SCC that blocks DOALL must compute a scan.
+   */
+  auto nonDOALLSCCs = this->getSCCsThatBlockTheParallelization(LDI);
+  if (nonDOALLSCCs.size() != 1) {
+    return nullptr;
+  }
+  auto sccManager = LDI->getSCCManager();
+  auto sccInfo = sccManager->getSCCAttrs(*nonDOALLSCCs.begin());
+  auto operation = sccInfo->getScanOperation();
+  DOALLArrayReductionType elementType;
+  DOALLArrayReductionOperation operationCode;
+  if (false || (operation == nullptr)
+      || (sccInfo->getSingleHeaderPHI() == nullptr)
+      || (!this->getTypeAndOperationOfScan(operation,
+                                           elementType,
+                                           operationCode))) {
+    return nullptr;
+  }
+
+  /*
+   * Floating point scans depend on how the iterations are split into blocks.
+   * Hence, they are computed only if the user asked for reproducible floating
+   * point reductions, which fixes the number of blocks.
+   */
+  if (true
+      && sccInfo->getSingleHeaderPHI()->getType()->isFloatingPointTy()
+      && (this->n.getNumberOfDeterministicReductionPartitions() == 0)) {
+    return nullptr;
+  }
+
+  /*
+   * The runtime splits the iterations into blocks, so it needs the trip count
+   * and all iterations must run.
+   */
+  if (false || this->canLeaveEarly(LDI)
+      || (!this->canComputeTheTripCount(LDI))) {
+    return nullptr;
+  }
+
+  /*
+   * The iterations run twice, so running them again must not change the
+   * outcome of the loop.
+   * First, the loop cannot have live-out variables, which would be updated
+   * twice.
+   */
+  auto loopEnvironment = LDI->getEnvironment();
+  auto liveOuts = loopEnvironment->getEnvIndicesOfLiveOutVars();
+  if (liveOuts.begin() != liveOuts.end()) {
+    return nullptr;
+  }
+
+  /*
+   * Second, the only side effects of the loop must be stores that do not
+   * depend through memory on other accesses of the loop. Hence, the second
+   * execution of an iteration reads the same values as the first one, and it
+   * overwrites what the first one wrote.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopDG = LDI->getLoopDG();
+  auto isAccessOfTheLoop = [loopStructure](Value *value,
+                                           DGEdge<Value> *dep) -> bool {
+    auto inst = dyn_cast<Instruction>(value);
+    return (inst != nullptr) && loopStructure->isIncluded(inst);
+  };
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+        if (!storeInst->isSimple()) {
+          return nullptr;
+        }
+      } else if (I.mayHaveSideEffects()) {
+        return nullptr;
+      }
+      if (!I.mayReadOrWriteMemory()) {
+        continue;
+      }
+      if (false
+          || loopDG->iterateOverDependencesFrom(&I,
+                                                false,
+                                                true,
+                                                false,
+                                                isAccessOfTheLoop)
+          || loopDG->iterateOverDependencesTo(&I,
+                                              false,
+                                              true,
+                                              false,
+                                              isAccessOfTheLoop)) {
+        return nullptr;
+      }
+    }
+  }
+
+  return sccInfo;
+}
+
+bool DOALL::getTypeAndOperationOfScan(
+    Instruction *operation,
+    DOALLArrayReductionType &elementType,
+    DOALLArrayReductionOperation &operationCode) const {
+
+  /*
+   * Fetch the type of the variable.
+   */
+  auto variableType = operation->getType();
+  if (variableType->isIntegerTy(8)) {
+    elementType = DOALL_REDUCTION_INT8;
+  } else if (variableType->isIntegerTy(16)) {
+    elementType = DOALL_REDUCTION_INT16;
+  } else if (variableType->isIntegerTy(32)) {
+    elementType = DOALL_REDUCTION_INT32;
+  } else if (variableType->isIntegerTy(64)) {
+    elementType = DOALL_REDUCTION_INT64;
+  } else if (variableType->isFloatTy()) {
+    elementType = DOALL_REDUCTION_FLOAT;
+  } else if (variableType->isDoubleTy()) {
+    elementType = DOALL_REDUCTION_DOUBLE;
+  } else {
+    return false;
+  }
+
+  /*
+   * Fetch the operation.
+   */
+  if (auto binaryOperation = dyn_cast<BinaryOperator>(operation)) {
+    switch (binaryOperation->getOpcode()) {
+      case Instruction::Add:
+      case Instruction::FAdd:
+        operationCode = DOALL_REDUCTION_ADD;
+        return true;
+      case Instruction::Mul:
+      case Instruction::FMul:
+        operationCode = DOALL_REDUCTION_MUL;
+        return true;
+      case Instruction::And:
+        operationCode = DOALL_REDUCTION_AND;
+        return true;
+      case Instruction::Or:
+        operationCode = DOALL_REDUCTION_OR;
+        return true;
+      case Instruction::Xor:
+        operationCode = DOALL_REDUCTION_XOR;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /*
+   * The operation is a select of the result of a compare (see
+   * SCCDAGAttrs::getOperationOfScan).
+   * It computes a maximum if it selects the greater operand of the compare.
+   */
+  auto selectInst = cast<SelectInst>(operation);
+  auto cmpInst = cast<CmpInst>(selectInst->getCondition());
+  auto isGreater = false;
+  auto isUnsigned = false;
+  switch (cmpInst->getPredicate()) {
+    case CmpInst::ICMP_UGT:
+    case CmpInst::ICMP_UGE:
+      isUnsigned = true;
+      isGreater = true;
+      break;
+    case CmpInst::ICMP_ULT:
+    case CmpInst::ICMP_ULE:
+      isUnsigned = true;
+      break;
+    case CmpInst::ICMP_SGT:
+    case CmpInst::ICMP_SGE:
+    case CmpInst::FCMP_OGT:
+    case CmpInst::FCMP_OGE:
+    case CmpInst::FCMP_UGT:
+    case CmpInst::FCMP_UGE:
+      isGreater = true;
+      break;
+    case CmpInst::ICMP_SLT:
+    case CmpInst::ICMP_SLE:
+    case CmpInst::FCMP_OLT:
+    case CmpInst::FCMP_OLE:
+    case CmpInst::FCMP_ULT:
+    case CmpInst::FCMP_ULE:
+      break;
+    default:
+      return false;
+  }
+  auto isMaximum =
+      isGreater == (selectInst->getTrueValue() == cmpInst->getOperand(0));
+  if (isUnsigned) {
+    operationCode = isMaximum ? DOALL_REDUCTION_UMAX : DOALL_REDUCTION_UMIN;
+  } else {
+    operationCode = isMaximum ? DOALL_REDUCTION_MAX : DOALL_REDUCTION_MIN;
+  }
+
+  return true;
+}
+
+void DOALL::generateCodeToAllocatePrefixes(LoopDependenceInfo *LDI) {
+
+  /*
+   * The prefixes are a slot of 64 bits per task on the stack of the caller,
+   * and they are passed to the tasks through the environment.
+   */
+  auto loopFunction = LDI->getLoopStructure()->getFunction();
+  auto &entryBlock = loopFunction->getEntryBlock();
+  IRBuilder<> entryBuilder(&*entryBlock.getFirstInsertionPt());
+  auto tm = this->n.getTypesManager();
+  auto cm = this->n.getConstantsManager();
+  this->scanPrefixes = entryBuilder.CreateAlloca(
+      tm->getIntegerType(64),
+      cm->getIntegerConstant(this->numTaskInstances, 64));
+  auto loopEnvironment = LDI->getEnvironment();
+  auto prefixesEnvIndex =
+      loopEnvironment->addLiveInValue(this->scanPrefixes, {});
+  this->envBuilder->addVariableToEnvironment(prefixesEnvIndex,
+                                             this->scanPrefixes->getType());
+
+  return;
+}
+
+void DOALL::rewireLoopToScan(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the variable of the scan and its clones in the task.
+   */
+  auto task = (DOALLTask *)this->tasks[0];
+  auto phi = this->scan->getSingleHeaderPHI();
+  auto operation = this->scan->getScanOperation();
+  auto phiClone = cast<PHINode>(task->getCloneOfOriginalInstruction(phi));
+  auto operationClone = task->getCloneOfOriginalInstruction(operation);
+  auto loopPreHeader = LDI->getLoopStructure()->getPreHeader();
+  auto preheaderClone = task->getCloneOfOriginalBasicBlock(loopPreHeader);
+  assert(true && (phiClone != nullptr) && (operationClone != nullptr)
+         && (preheaderClone != nullptr));
+
+  /*
+   * The variable starts from the slot of the task.
+   */
+  auto entryBlock = task->getEntry();
+  IRBuilder<> entryBuilder(entryBlock->getTerminator());
+  auto prefixes = task->getCloneOfOriginalLiveIn(this->scanPrefixes);
+  auto slot = entryBuilder.CreateBitCast(
+      entryBuilder.CreateInBoundsGEP(prefixes, task->coreArg),
+      PointerType::getUnqual(phi->getType()));
+  auto startValue = entryBuilder.CreateLoad(slot);
+  phiClone->setIncomingValueForBlock(preheaderClone, startValue);
+
+  /*
+   * The task stores in its slot the last value of the variable, which is kept
+   * on the stack until the task ends.
+   */
+  auto lastValue = entryBuilder.CreateAlloca(phi->getType());
+  entryBuilder.CreateStore(startValue, lastValue);
+  IRBuilder<> updateBuilder(operationClone->getNextNode());
+  updateBuilder.CreateStore(operationClone, lastValue);
+  IRBuilder<> exitBuilder(task->getExit()->getTerminator());
+  exitBuilder.CreateStore(exitBuilder.CreateLoad(lastValue), slot);
+
+  return;
+}
+
+CallInst *DOALL::generateCodeToDispatchScan(LoopDependenceInfo *LDI,
+                                            Value *envPtr,
+                                            Value *numCores,
+                                            Value *tripCount,
+                                            IRBuilder<> &builder) {
+
+  /*
+   * The first slot holds the initial value of the variable.
+   */
+  auto phi = this->scan->getSingleHeaderPHI();
+  auto loopPreHeader = LDI->getLoopStructure()->getPreHeader();
+  auto initialValue = phi->getIncomingValueForBlock(loopPreHeader);
+  builder.CreateStore(
+      initialValue,
+      builder.CreateBitCast(this->scanPrefixes,
+                            PointerType::getUnqual(phi->getType())));
+
+  /*
+   * The runtime runs each task twice on its block of iterations.
+   */
+  DOALLArrayReductionType elementType;
+  DOALLArrayReductionOperation operation;
+  auto isScan = this->getTypeAndOperationOfScan(this->scan->getScanOperation(),
+                                                elementType,
+                                                operation);
+  assert(isScan);
+  auto tm = this->n.getTypesManager();
+  auto cm = this->n.getConstantsManager();
+  return builder.CreateCall(
+      this->taskDispatcherWithScan,
+      ArrayRef<Value *>(
+          { tasks[0]->getTaskBody(),
+            envPtr,
+            numCores,
+            tripCount,
+            builder.CreateBitCast(this->scanPrefixes,
+                                  tm->getVoidPointerType()),
+            cm->getIntegerConstant(elementType, 64),
+            cm->getIntegerConstant(operation, 64) }));
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "DOALL.hpp"
+
+namespace llvm::noelle {
+
+bool DOALL::mustRunSpeculatively(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check if the runtime can run DOALL loops speculatively.
+   */
+  if (false || (this->taskDispatcherWithSpeculation == nullptr)
+      || (this->speculativeLoad == nullptr)
+      || (this->speculativeStore == nullptr)) {
+    return false;
+  }
+
+  /*
+   * Check if the speculation has been requested for this loop.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  if (false || (!this->n.isTransformationEnabled(SPECULATIVE_DOALL_ID))
+      || (!ltm->isTransformationEnabled(SPECULATIVE_DOALL_ID))) {
+    return false;
+  }
+
+  /*
+   * Loops that leave early stop their tasks, which is not compatible with
+   * discarding their work.
+   */
+  if (this->canLeaveEarly(LDI)) {
+    return false;
+  }
+
+  /*
+   * Loops whose iterations can be checked before running them, or whose
+   * dependences can be removed by privatizing arrays, do not need to discard
+   * their work.
+   */
+  if (false || this->mustBeInspected(LDI) || this->mustReduceArrays(LDI)) {
+    return false;
+  }
+
+  /*
+   * The speculation is needed only if some SCCs block DOALL, and it can remove
+   * only dependences through memory.
+   * Moreover, the work of the tasks is discarded every time one of these
+   * dependences manifests. Hence, dependences that have been profiled to
+   * manifest often make the speculation not worth it.
+   */
+  auto nonDOALLSCCs = DOALL::getSCCsThatBlockDOALLToBeApplicable(LDI, this->n);
+  if (nonDOALLSCCs.size() == 0) {
+    return false;
+  }
+  auto dependenceProfiles = this->n.getLoopCarriedDependenceProfiles();
+  auto maximumManifestationFrequency = 0.01;
+  auto sccManager = LDI->getSCCManager();
+  auto canBeSpeculated = true;
+  for (auto scc : nonDOALLSCCs) {
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [&canBeSpeculated,
+         dependenceProfiles,
+         maximumManifestationFrequency](DGEdge<Value> *dep) -> bool {
+          if (dep->isControlDependence()) {
+            return false;
+          }
+          if (!dep->isMemoryDependence()) {
+            canBeSpeculated = false;
+            return true;
+          }
+          if (dependenceProfiles->getManifestationFrequency(dep)
+              > maximumManifestationFrequency) {
+            canBeSpeculated = false;
+            return true;
+          }
+          return false;
+        });
+    if (!canBeSpeculated) {
+      return false;
+    }
+  }
+
+  /*
+   * The stores of the tasks are written to memory after the tasks end.
+   * Hence, the loop must not use memory that is local to its tasks (their
+   * stack), which includes the memory locations cloned for them.
+   */
+  if (ltm->isOptimizationEnabled(
+          LoopDependenceInfoOptimization::MEMORY_CLONING_ID)) {
+    auto sccdag = sccManager->getSCCDAG();
+    auto usesClonedMemory = false;
+    sccdag->iterateOverSCCs([sccManager, &usesClonedMemory](SCC *scc) -> bool {
+      auto sccInfo = sccManager->getSCCAttrs(scc);
+      if (sccInfo->canBeClonedUsingLocalMemoryLocations()) {
+        usesClonedMemory = true;
+        return true;
+      }
+      return false;
+    });
+    if (usesClonedMemory) {
+      return false;
+    }
+  }
+
+  /*
+   * Every memory access of the loop must be a plain load or store of a
+   * scalar that the runtime can track.
+   */
+  auto &DL = this->n.getProgram()->getDataLayout();
+  auto canBeTracked = [&DL](Type *type) -> bool {
+    if (false || (!type->isSized())
+        || (!(false || type->isIntegerTy() || type->isPointerTy()
+              || type->isFloatTy() || type->isDoubleTy()))) {
+      return false;
+    }
+    auto size = DL.getTypeStoreSize(type);
+    return (false || (size == 1) || (size == 2) || (size == 4) || (size == 8));
+  };
+  auto loopStructure = LDI->getLoopStructure();
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (isa<AllocaInst>(&I)) {
+        return false;
+      }
+      if (auto loadInst = dyn_cast<LoadInst>(&I)) {
+        if (false || (!loadInst->isSimple())
+            || (!canBeTracked(loadInst->getType()))) {
+          return false;
+        }
+        continue;
+      }
+      if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+        if (false || (!storeInst->isSimple())
+            || (!canBeTracked(storeInst->getValueOperand()->getType()))) {
+          return false;
+        }
+        continue;
+      }
+      if (auto callInst = dyn_cast<CallInst>(&I)) {
+        if (false || callInst->isLifetimeStartOrEnd()
+            || isa<DbgInfoIntrinsic>(callInst)) {
+          continue;
+        }
+      }
+      if (I.mayReadOrWriteMemory()) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void DOALL::rewireLoopToRunSpeculatively(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = this->tasks[0];
+  auto tm = this->n.getTypesManager();
+  auto &DL = this->n.getProgram()->getDataLayout();
+  auto int64 = tm->getIntegerType(64);
+
+  /*
+   * Collect the memory accesses of the parallelized loop.
+   * Only the clones of the instructions of the original loop need to be
+   * tracked: the code added by DOALL accesses either the environment or the
+   * memory of the runtime.
+   */
+  std::vector<Instruction *> memoryAccesses;
+  auto loopStructure = LDI->getLoopStructure();
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (true && (!isa<LoadInst>(&I)) && (!isa<StoreInst>(&I))) {
+        continue;
+      }
+      memoryAccesses.push_back(&I);
+    }
+  }
+
+  /*
+   * Route the memory accesses through the runtime.
+   * The task keeps mapping the original accesses to the code that replaces
+   * them.
+   */
+  for (auto originalAccess : memoryAccesses) {
+    auto memoryAccess = task->getCloneOfOriginalInstruction(originalAccess);
+    assert(memoryAccess != nullptr);
+    IRBuilder<> builder(memoryAccess);
+
+    /*
+     * Replace loads.
+     * The runtime returns the bytes read in the least significant bytes of a
+     * 64-bit integer.
+     */
+    if (auto loadInst = dyn_cast<LoadInst>(memoryAccess)) {
+      auto loadedType = loadInst->getType();
+      auto size = DL.getTypeStoreSize(loadedType);
+      auto address = builder.CreateBitCast(loadInst->getPointerOperand(),
+                                           tm->getVoidPointerType());
+      Value *value = builder.CreateCall(
+          this->speculativeLoad,
+          ArrayRef<Value *>({ address, ConstantInt::get(int64, size) }));
+      auto bitsType = tm->getIntegerType(DL.getTypeSizeInBits(loadedType));
+      value = builder.CreateTrunc(value, bitsType);
+      if (loadedType->isPointerTy()) {
+        value = builder.CreateIntToPtr(value, loadedType);
+      } else if (!loadedType->isIntegerTy()) {
+        value = builder.CreateBitCast(value, loadedType);
+      }
+      loadInst->replaceAllUsesWith(value);
+      loadInst->eraseFromParent();
+      task->addInstruction(originalAccess, cast<Instruction>(value));
+      continue;
+    }
+
+    /*
+     * Replace stores.
+     */
+    auto storeInst = cast<StoreInst>(memoryAccess);
+    Value *value = storeInst->getValueOperand();
+    auto storedType = value->getType();
+    auto size = DL.getTypeStoreSize(storedType);
+    if (storedType->isPointerTy()) {
+      value = builder.CreatePtrToInt(value, int64);
+    } else if (!storedType->isIntegerTy()) {
+      auto bitsType = tm->getIntegerType(DL.getTypeSizeInBits(storedType));
+      value = builder.CreateBitCast(value, bitsType);
+    }
+    value = builder.CreateZExtOrTrunc(value, int64);
+    auto address = builder.CreateBitCast(storeInst->getPointerOperand(),
+                                         tm->getVoidPointerType());
+    auto storeCall = builder.CreateCall(
+        this->speculativeStore,
+        ArrayRef<Value *>({ address, value, ConstantInt::get(int64, size) }));
+    storeInst->eraseFromParent();
+    task->addInstruction(originalAccess, storeCall);
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "DOALL.hpp"
+#include "DOALLTask.hpp"
+
+namespace llvm::noelle {
+
+bool DOALL::canVectorizeChunkLoop(LoopDependenceInfo *LDI) const {
+
+  /*
+   * The chunk loop must iterate over consecutive iterations without calling
+   * the runtime.
+   */
+  if (false || (this->getChunkScheduling(LDI) != DOALL_STATIC_SCHEDULING)
+      || this->canLeaveEarly(LDI) || this->mustRunSpeculatively(LDI)) {
+    return false;
+  }
+
+  /*
+   * Only innermost loops are vectorized.
+   */
+  auto loopNode = LDI->getLoopHierarchyStructures();
+  if (loopNode->getNumberOfSubLoops() > 0) {
+    return false;
+  }
+
+  /*
+   * The memory locations cloned for the task are shared by all of its
+   * iterations. Hence, the iterations of a chunk cannot run at the same time.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto sccdag = sccManager->getSCCDAG();
+  auto ltm = LDI->getLoopTransformationsManager();
+  auto canBeVectorized = true;
+  if (ltm->isOptimizationEnabled(
+          LoopDependenceInfoOptimization::MEMORY_CLONING_ID)) {
+    sccdag->iterateOverSCCs([sccManager, &canBeVectorized](SCC *scc) -> bool {
+      auto sccInfo = sccManager->getSCCAttrs(scc);
+      if (sccInfo->canBeClonedUsingLocalMemoryLocations()) {
+        canBeVectorized = false;
+        return true;
+      }
+      return false;
+    });
+    if (!canBeVectorized) {
+      return false;
+    }
+  }
+
+  /*
+   * No iteration can access memory that another iteration accesses.
+   * The dependences of the loop have already been refined with the iteration
+   * domain space analysis.
+   */
+  sccdag->iterateOverSCCs([sccManager, &canBeVectorized](SCC *scc) -> bool {
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [&canBeVectorized](DGEdge<Value> *dep) -> bool {
+          if (dep->isMemoryDependence()) {
+            canBeVectorized = false;
+            return true;
+          }
+          return false;
+        });
+    return !canBeVectorized;
+  });
+
+  return canBeVectorized;
+}
+
+void DOALL::addVectorizationHintsToChunkLoop(LoopDependenceInfo *LDI) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = this->tasks[0];
+  auto &context = this->n.getProgram()->getContext();
+  auto loopStructure = LDI->getLoopStructure();
+  auto headerClone =
+      task->getCloneOfOriginalBasicBlock(loopStructure->getHeader());
+  auto preheaderClone =
+      task->getCloneOfOriginalBasicBlock(loopStructure->getPreHeader());
+
+  /*
+   * Tag the memory accesses of the loop as belonging to the same access group.
+   * The accesses of different iterations of the group are independent.
+   */
+  auto accessGroup = MDNode::getDistinct(context, {});
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      if (!I.mayReadOrWriteMemory()) {
+        continue;
+      }
+      auto cloneI = task->getCloneOfOriginalInstruction(&I);
+      if (cloneI == nullptr) {
+        continue;
+      }
+      cloneI->setMetadata(LLVMContext::MD_access_group, accessGroup);
+    }
+  }
+
+  /*
+   * Fetch the latches of the chunk loop.
+   */
+  std::vector<Instruction *> latchTerminators;
+  for (auto pred : predecessors(headerClone)) {
+    if (pred == preheaderClone) {
+      continue;
+    }
+    latchTerminators.push_back(pred->getTerminator());
+  }
+
+  /*
+   * Keep the hints of the original loop (e.g., the ones of the programmer).
+   * Vectorization is only enabled if the original loop did not disable it.
+   */
+  SmallVector<Metadata *, 4> loopProperties;
+  loopProperties.push_back(nullptr);
+  auto isVectorizationSpecified = false;
+  for (auto latchTerminator : latchTerminators) {
+    auto originalLoopID = latchTerminator->getMetadata(LLVMContext::MD_loop);
+    if (originalLoopID == nullptr) {
+      continue;
+    }
+    for (auto i = 1u; i < originalLoopID->getNumOperands(); ++i) {
+      auto property = dyn_cast<MDNode>(originalLoopID->getOperand(i));
+      if (property == nullptr) {
+        continue;
+      }
+      auto propertyName = dyn_cast<MDString>(property->getOperand(0));
+      if (false || (propertyName == nullptr)
+          || (propertyName->getString() == "llvm.loop.parallel_accesses")) {
+        continue;
+      }
+      if (propertyName->getString().startswith("llvm.loop.vectorize.")) {
+        isVectorizationSpecified = true;
+      }
+      loopProperties.push_back(property);
+    }
+    break;
+  }
+
+  /*
+   * Add the hints and tag the latches with them.
+   */
+  loopProperties.push_back(MDNode::get(
+      context,
+      { MDString::get(context, "llvm.loop.parallel_accesses"), accessGroup }));
+  if (!isVectorizationSpecified) {
+    loopProperties.push_back(MDNode::get(
+        context,
+        { MDString::get(context, "llvm.loop.vectorize.enable"),
+          ConstantAsMetadata::get(ConstantInt::getTrue(context)) }));
+  }
+  auto loopID = MDNode::getDistinct(context, loopProperties);
+  loopID->replaceOperandWith(0, loopID);
+  for (auto latchTerminator : latchTerminators) {
+    latchTerminator->setMetadata(LLVMContext::MD_loop, loopID);
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,358 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Wavefront.hpp"
+#include "DOALLTask.hpp"
+
+namespace llvm::noelle {
+
+Wavefront::Wavefront(Noelle &noelle)
+  : DOALL{ noelle },
+    waitForPreviousRow{ nullptr },
+    signalNextRow{ nullptr } {
+
+  /*
+   * Fetch the runtime functions needed to synchronize the rows.
+   */
+  auto program = this->n.getProgram();
+  this->taskDispatcher = program->getFunction("NOELLE_WavefrontDispatcher");
+  this->waitForPreviousRow = program->getFunction("NOELLE_Wavefront_wait");
+  this->signalNextRow = program->getFunction("NOELLE_Wavefront_signal");
+  this->enabled = true && (this->taskDispatcher != nullptr)
+                  && (this->waitForPreviousRow != nullptr)
+                  && (this->signalNextRow != nullptr);
+  if (true && (!this->enabled) && (this->verbose != Verbosity::Disabled)) {
+    errs()
+        << "Wavefront: WARNING: the wavefront runtime couldn't be found. Wavefront is disabled\n";
+  }
+
+  /*
+   * Rows are assigned statically to the tasks and each task must run all of
+   * its rows: the DOALL variants that distribute, skip, cancel, or re-execute
+   * iterations could leave a row waiting forever for its previous one.
+   */
+  this->taskDispatcherWithScheduling = nullptr;
+  this->fetchNextChunk = nullptr;
+  this->taskDispatcherWithTripCount = nullptr;
+  this->taskDispatcherWithCancellation = nullptr;
+  this->cancelLoop = nullptr;
+  this->isLoopCancelled = nullptr;
+  this->taskDispatcherWithSpeculation = nullptr;
+  this->speculativeLoad = nullptr;
+  this->speculativeStore = nullptr;
+  this->taskDispatcherWithFixedTasks = nullptr;
+  this->taskDispatcherWithInspection = nullptr;
+  this->taskDispatcherWithScan = nullptr;
+  this->allocateReductionArrays = nullptr;
+  this->reduceArrays = nullptr;
+
+  return;
+}
+
+bool Wavefront::canBeAppliedToLoop(LoopDependenceInfo *LDI,
+                                   Heuristics *h) const {
+  if (!this->enabled) {
+    return false;
+  }
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << "Wavefront: Checking if the loop is a wavefront\n";
+  }
+
+  /*
+   * The tasks synchronize by rows, so they cannot buffer their output per
+   * iteration of the loop.
+   */
+  if (LDI->getCallsWithBufferedOutput().size() > 0) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "Wavefront:   The output of the loop cannot be buffered\n";
+    }
+    return false;
+  }
+
+  /*
+   * The loop must include exactly one loop.
+   */
+  auto nestedLoop = this->getNestedLoop(LDI);
+  if (nestedLoop == nullptr) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "Wavefront:   The loop is not a 2-D loop nest\n";
+    }
+    return false;
+  }
+
+  /*
+   * The rows are the iterations of the loop, so these must be counted by the
+   * loop governing IV.
+   */
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  if (true && (loopGoverningIVAttr != nullptr)
+      && (!loopGoverningIVAttr->getInductionVariable()
+               .isStepValueSignKnown())) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs()
+          << "Wavefront:   The sign of the step of the loop governing IV is unknown\n";
+    }
+    return false;
+  }
+
+  /*
+   * The rest of the conditions are the ones of DOALL except for the
+   * loop-carried data dependences that can be synchronized by rows.
+   */
+  return DOALL::canBeAppliedToLoop(LDI, h);
+}
+
+LoopStructure *Wavefront::getNestedLoop(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Fetch the node of the loop in the loop forest.
+   */
+  auto loopNode = LDI->getLoopHierarchyStructures();
+  if (loopNode->getNumberOfSubLoops() != 1) {
+    return nullptr;
+  }
+
+  /*
+   * The loop has a single sub-loop, which is therefore its only child.
+   */
+  auto child = *loopNode->getChildren().begin();
+
+  return child->getLoop();
+}
+
+std::set<SCC *> Wavefront::getSCCsThatBlockTheParallelization(
+    LoopDependenceInfo *LDI) const {
+
+  /*
+   * Fetch the SCCs that block DOALL.
+   */
+  std::set<SCC *> sccs;
+  auto nestedLoop = this->getNestedLoop(LDI);
+  for (auto scc : DOALL::getSCCsThatBlockTheParallelization(LDI)) {
+
+    /*
+     * Check if the rows respect the dependences of the SCC once they are
+     * synchronized.
+     */
+    if (true && (nestedLoop != nullptr)
+        && this->canBeSynchronizedByRows(LDI, nestedLoop, scc)) {
+      continue;
+    }
+    sccs.insert(scc);
+  }
+
+  return sccs;
+}
+
+bool Wavefront::canBeSynchronizedByRows(LoopDependenceInfo *LDI,
+                                        LoopStructure *nestedLoop,
+                                        SCC *scc) const {
+
+  /*
+   * The distances between iterations come from the iteration domain of the
+   * memory accesses.
+   */
+  auto LIDS = LDI->getLoopIterationDomainSpaceAnalysis();
+  if (LIDS == nullptr) {
+    return false;
+  }
+
+  /*
+   * Check every loop-carried data dependence of the SCC.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto isSynchronized = true;
+  sccManager->iterateOverLoopCarriedDataDependences(
+      scc,
+      [this, LIDS, nestedLoop, &isSynchronized](DGEdge<Value> *dep) -> bool {
+        if (dep->isControlDependence()) {
+          return false;
+        }
+
+        /*
+         * Only memory dependences between accesses with known iteration
+         * domains can be synchronized.
+         */
+        auto fromInst = dyn_cast<Instruction>(dep->getOutgoingT());
+        auto toInst = dyn_cast<Instruction>(dep->getIncomingT());
+        int64_t distance = 0;
+        if (false || (!dep->isMemoryDependence()) || (fromInst == nullptr)
+            || (toInst == nullptr)
+            || (!LIDS->getDependenceDistanceBetweenIterations(fromInst,
+                                                              toInst,
+                                                              nestedLoop,
+                                                              distance))) {
+          isSynchronized = false;
+          return true;
+        }
+
+        /*
+         * A dependence towards a later row is respected only if its accesses
+         * run within the iterations of the nested loop, which are the ones
+         * the rows wait for.
+         */
+        if (true && (distance > 0)
+            && ((!nestedLoop->isIncluded(fromInst))
+                || (!nestedLoop->isIncluded(toInst)))) {
+          isSynchronized = false;
+          return true;
+        }
+
+        return false;
+      });
+
+  return isSynchronized;
+}
+
+bool Wavefront::apply(LoopDependenceInfo *LDI, Heuristics *h) {
+
+  /*
+   * Check if Wavefront is enabled.
+   */
+  if (!this->enabled) {
+    return false;
+  }
+  auto nestedLoop = this->getNestedLoop(LDI);
+  assert(nestedLoop != nullptr);
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << "Wavefront: Start the parallelization\n";
+    errs() << "Wavefront:   Nested loop = \""
+           << *nestedLoop->getEntryInstruction() << "\"\n";
+  }
+
+  /*
+   * Generate the task as DOALL does with chunks of a single iteration, so
+   * consecutive rows run on consecutive tasks.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  ltm->setChunkSize(1);
+  if (!DOALL::apply(LDI, h)) {
+    return false;
+  }
+
+  /*
+   * Synchronize the rows.
+   */
+  this->synchronizeRows(LDI, nestedLoop);
+  if (this->verbose >= Verbosity::Maximal) {
+    tasks[0]->getTaskBody()->print(errs()
+                                   << "Wavefront:  Final parallelized loop:\n");
+    errs() << "\n";
+  }
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << "Wavefront: Exit\n";
+  }
+
+  return true;
+}
+
+void Wavefront::synchronizeRows(LoopDependenceInfo *LDI,
+                                LoopStructure *nestedLoop) {
+
+  /*
+   * Fetch the headers of the loops within the task.
+   */
+  auto task = (DOALLTask *)this->tasks[0];
+  auto loopStructure = LDI->getLoopStructure();
+  auto preheaderClone =
+      task->getCloneOfOriginalBasicBlock(loopStructure->getPreHeader());
+  auto headerClone =
+      task->getCloneOfOriginalBasicBlock(loopStructure->getHeader());
+  auto nestedHeaderClone =
+      task->getCloneOfOriginalBasicBlock(nestedLoop->getHeader());
+  std::unordered_set<BasicBlock *> nestedLatchClones;
+  for (auto latch : nestedLoop->getLatches()) {
+    nestedLatchClones.insert(task->getCloneOfOriginalBasicBlock(latch));
+  }
+  auto cm = this->n.getConstantsManager();
+  auto rowType = task->coreArg->getType();
+
+  /*
+   * Track the row run by the task.
+   * The task runs the rows coreID, coreID + numCores, ...
+   */
+  IRBuilder<> headerBuilder(headerClone->getFirstNonPHI());
+  auto rowPHI = headerBuilder.CreatePHI(rowType,
+                                        pred_size(headerClone),
+                                        "wavefrontRow");
+  std::unordered_map<BasicBlock *, Value *> nextRows;
+  for (auto pred : predecessors(headerClone)) {
+    if (pred == preheaderClone) {
+      rowPHI->addIncoming(task->coreArg, pred);
+      continue;
+    }
+
+    /*
+     * @pred is a latch: the row is completed.
+     */
+    if (nextRows.find(pred) == nextRows.end()) {
+      IRBuilder<> latchBuilder(pred->getTerminator());
+      latchBuilder.CreateCall(
+          this->signalNextRow,
+          ArrayRef<Value *>({ rowPHI, cm->getIntegerConstant(-1, 64) }));
+      nextRows[pred] =
+          latchBuilder.CreateAdd(rowPHI, task->numCoresArg, "wavefrontNextRow");
+    }
+    rowPHI->addIncoming(nextRows[pred], pred);
+  }
+
+  /*
+   * Track the iteration of the nested loop run by the row.
+   */
+  IRBuilder<> nestedHeaderBuilder(nestedHeaderClone->getFirstNonPHI());
+  auto iterationPHI =
+      nestedHeaderBuilder.CreatePHI(rowType,
+                                    pred_size(nestedHeaderClone),
+                                    "wavefrontIteration");
+  std::unordered_map<BasicBlock *, Value *> nextIterations;
+  for (auto pred : predecessors(nestedHeaderClone)) {
+    if (nestedLatchClones.find(pred) == nestedLatchClones.end()) {
+      iterationPHI->addIncoming(cm->getIntegerConstant(0, 64), pred);
+      continue;
+    }
+
+    /*
+     * @pred is a latch of the nested loop: the iteration is completed and the
+     * next row can run it.
+     */
+    if (nextIterations.find(pred) == nextIterations.end()) {
+      IRBuilder<> latchBuilder(pred->getTerminator());
+      auto nextIteration =
+          latchBuilder.CreateAdd(iterationPHI,
+                                 cm->getIntegerConstant(1, 64),
+                                 "wavefrontNextIteration");
+      latchBuilder.CreateCall(this->signalNextRow,
+                              ArrayRef<Value *>({ rowPHI, nextIteration }));
+      nextIterations[pred] = nextIteration;
+    }
+    iterationPHI->addIncoming(nextIterations[pred], pred);
+  }
+
+  /*
+   * Wait for the previous row to complete the iteration before running it.
+   */
+  nestedHeaderBuilder.CreateCall(this->waitForPreviousRow,
+                                 ArrayRef<Value *>({ rowPHI, iterationPHI }));
+
+  return;
+}
+
+} // namespace llvm::noelle
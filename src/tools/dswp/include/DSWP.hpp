@@ -65,6 +65,12 @@ private:
   std::unordered_map<SCC *, DSWPTask *> sccToStage;
   std::vector<std::unique_ptr<QueueInfo>> queues;
 
+  /*
+   * Clonable SCCs that run only in the first stage that uses them.
+   * This stage sends their values to the other stages through queues.
+   */
+  std::unordered_set<SCC *> sentClonableSCCs;
+
   /*
    * Types for arrays storing dependencies and stages
    */
@@ -81,6 +87,22 @@ private:
    * Dispatcher
    */
   Function *taskDispatcher;
+  Function *taskDispatcherWithPlacement;
+  Function *taskDispatcherWithReplicas;
+
+  /*
+   * Replicas of the stages.
+   *
+   * Replica r of a stage executes the payload (i.e., its non-clonable SCCs)
+   * only of the iterations i such that i % replicas == r.
+   * The queues that connect a replicated stage with another one have a copy
+   * per replica. The values a replicated stage pops are pushed to every copy,
+   * while the values it pushes are popped from the copy of the replica that
+   * executed the iteration.
+   * The last slot of the queue array holds the ID of the replica.
+   */
+  std::vector<uint32_t> stageReplicas;
+  uint32_t numberOfQueueSlots;
 
   /*
    * Pipeline
@@ -88,12 +110,21 @@ private:
   void partitionSCCDAG(LoopDependenceInfo *LDI, Heuristics *h);
   void clusterSubloops(LoopDependenceInfo *LDI);
   void generateStagesFromPartitionedSCCs(LoopDependenceInfo *LDI);
-  void addClonableSCCsToStages(LoopDependenceInfo *LDI);
+  void addClonableSCCsToStages(LoopDependenceInfo *LDI, Heuristics *h);
+  void cloneClonableSCCsIntoStages(LoopDependenceInfo *LDI);
+  bool canClonableSCCBeSent(LoopDependenceInfo *LDI, SCC *scc) const;
   bool isCompleteAndValidStageStructure(LoopDependenceInfo *LDI) const;
   void generateLoopSubsetForStage(LoopDependenceInfo *LDI, int taskIndex);
   void generateLoadsOfQueuePointers(Noelle &par, int taskIndex);
   void popValueQueues(LoopDependenceInfo *LDI, Noelle &par, int taskIndex);
   void pushValueQueues(LoopDependenceInfo *LDI, Noelle &par, int taskIndex);
+  void flushBatchedQueues(LoopDependenceInfo *LDI, Noelle &par, int taskIndex);
+  void packQueues(LoopDependenceInfo *LDI, Noelle &par);
+  bool isSPSCQueueUsed(Noelle &par, QueueInfo *queueInfo) const;
+  Type *getQueueElementType(Noelle &par, QueueInfo *queueInfo) const;
+  Type *getQueueType(Noelle &par, QueueInfo *queueInfo) const;
+  Function *getQueuePushFunction(Noelle &par, QueueInfo *queueInfo) const;
+  Function *getQueuePopFunction(Noelle &par, QueueInfo *queueInfo) const;
   void createPipelineFromStages(LoopDependenceInfo *LDI, Noelle &par);
   Value *createStagesArrayFromStages(LoopDependenceInfo *LDI,
                                      IRBuilder<> funcBuilder,
@@ -101,6 +132,32 @@ private:
   Value *createQueueSizesArrayFromStages(LoopDependenceInfo *LDI,
                                          IRBuilder<> funcBuilder,
                                          Noelle &par);
+  Value *createQueueConsumersArrayFromStages(LoopDependenceInfo *LDI,
+                                             IRBuilder<> funcBuilder,
+                                             Noelle &par);
+  Value *createStageReplicasArray(LoopDependenceInfo *LDI,
+                                  IRBuilder<> funcBuilder,
+                                  Noelle &par);
+
+  /*
+   * Replication of stages
+   */
+  void replicateStages(LoopDependenceInfo *LDI, Heuristics *h);
+  bool canStageBeReplicated(LoopDependenceInfo *LDI, DSWPTask *task) const;
+  bool isReplicated(int taskIndex) const;
+  bool needsIterationCounter(int taskIndex) const;
+  void createIterationCounter(LoopDependenceInfo *LDI, int taskIndex);
+  void completeIterationCounter(LoopDependenceInfo *LDI, int taskIndex);
+  void executeOnlyIterationsOfReplica(LoopDependenceInfo *LDI, int taskIndex);
+  void collectCostsOfStages(std::vector<std::set<SCC *>> &stageSCCs,
+                            std::vector<std::set<SCC *>> &clonedSCCs,
+                            std::vector<std::set<Value *>> &poppedValues) const;
+
+  /*
+   * Capacity of queues
+   */
+  void sizeQueues(LoopDependenceInfo *LDI, Heuristics *h);
+  void adjustQueueCapacitiesToTelemetry(LoopDependenceInfo *LDI);
 
   /*
    * Recursively inline queue push/pop functions in DSWP Utils and ThreadPool
@@ -108,6 +165,12 @@ private:
    */
   void inlineQueueCalls(int taskIndex);
 
+  /*
+   * Speculation that the loop continues in stages that wait for its exit
+   * condition
+   */
+  uint32_t speculateLoopExitInStage(LoopDependenceInfo *LDI, int taskIndex);
+
   /*
    * Information collection helpers
    */
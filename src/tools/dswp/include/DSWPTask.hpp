@@ -71,6 +71,18 @@ public:
    */
   unordered_map<int, std::unique_ptr<QueueInstrs>> queueInstrMap;
 
+  /*
+   * Replication of the stage
+   *
+   * @iterationCounter counts the iterations of the loop executed by the stage.
+   * @replicaID is the ID of the replica running the stage.
+   * @pushInstructions are the instructions that push the values the stage
+   * produces.
+   */
+  PHINode *iterationCounter;
+  Value *replicaID;
+  std::set<Instruction *> pushInstructions;
+
   void extractFuncArgs(void) override;
 };
 
@@ -80,6 +92,66 @@ struct QueueInfo {
   int bitLength;
   bool isMemoryDependence;
 
+  /*
+   * Values are moved in batches. The producer must flush the queue when it
+   * exits the loop.
+   */
+  bool isBatched;
+
+  /*
+   * Exactly one stage pushes to the queue and exactly one stage pops from it.
+   */
+  bool isSingleProducerSingleConsumer;
+
+  /*
+   * Values are moved through slots of @slotBytes bytes that hold a value of
+   * type @slotType.
+   */
+  bool isSlotQueue;
+  uint64_t slotBytes;
+  Type *slotType;
+
+  /*
+   * Values of queues that connect the same stages and that are produced in
+   * the same basic block can be packed into the slot of a single queue.
+   *
+   * @packedQueues are the queues whose values are packed into this queue's
+   * slot, in the order of the fields of @slotType.
+   * @packedInto is the queue this queue's value is packed into, or -1.
+   */
+  std::vector<int> packedQueues;
+  int packedInto;
+
+  /*
+   * Queues that connect a replicated stage have a copy per replica.
+   * The copies take the slots of the queue array that start from
+   * @firstReplicaSlot.
+   */
+  int replicas;
+  int firstReplicaSlot;
+
+  /*
+   * Number of slots of the queue, which is a power of 2.
+   * It is 0 if the runtime picks it.
+   */
+  uint64_t capacity;
+
+  /*
+   * Flags added to the size of a queue passed to the runtime.
+   * These values must match NOELLE_DSWP_BATCHED_QUEUE, NOELLE_DSWP_SPSC_QUEUE,
+   * and NOELLE_DSWP_SLOT_QUEUE of the runtime.
+   */
+  static const int batchedQueueSizeFlag = 1024;
+  static const int spscQueueSizeFlag = 2048;
+  static const int64_t slotQueueSizeFlag = 1LL << 40;
+
+  /*
+   * The log2 of the capacity of a queue is added to its size shifted by
+   * @capacitySizeShift.
+   * This value must match NOELLE_DSWP_QUEUE_CAPACITY_SHIFT of the runtime.
+   */
+  static const int capacitySizeShift = 48;
+
   Instruction *producer;
   std::set<Instruction *> consumers;
   unordered_map<Instruction *, int> consumerToPushIndex;
@@ -87,12 +159,22 @@ struct QueueInfo {
   QueueInfo(Instruction *p, Instruction *c, Type *type, bool isMemoryDependence)
     : producer{ p },
       dependentType{ type },
-      isMemoryDependence{ isMemoryDependence } {
+      isMemoryDependence{ isMemoryDependence },
+      isBatched{ false },
+      isSingleProducerSingleConsumer{ false },
+      isSlotQueue{ false },
+      slotBytes{ 0 },
+      slotType{ nullptr },
+      packedInto{ -1 },
+      replicas{ 1 },
+      firstReplicaSlot{ -1 },
+      capacity{ 0 } {
     consumers.insert(c);
     if (isMemoryDependence) {
       dependentType = IntegerType::get(c->getContext(), 1);
       bitLength = 1;
-    } else if (dependentType->isPointerTy()) {
+    } else if (dependentType->isPointerTy()
+               || dependentType->isAggregateType()) {
       bitLength =
           DataLayout(p->getModule()).getTypeAllocSize(dependentType) * 8;
     } else {
@@ -113,8 +195,16 @@ struct QueueInfo {
 struct QueueInstrs {
   Value *queuePtr;
   Value *queueCall;
+  Value *flushCall;
   Value *alloca;
   Value *allocaCast;
   Value *load;
+
+  /*
+   * Pointers to the copies of the queue of the other replicas, and the calls
+   * that push to or flush them.
+   */
+  std::vector<Value *> replicaQueuePtrs;
+  std::vector<Value *> replicaQueueCalls;
 };
 } // namespace llvm::noelle
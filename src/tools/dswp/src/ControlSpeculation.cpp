@@ -0,0 +1,144 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Analysis/ValueTracking.h"
+#include "DSWP.hpp"
+
+namespace llvm::noelle {
+
+uint32_t DSWP::speculateLoopExitInStage(LoopDependenceInfo *LDI,
+                                        int taskIndex) {
+  auto task = (DSWPTask *)this->tasks[taskIndex];
+
+  /*
+   * Fetch the branch of the header of the loop.
+   * The stage must pop its condition from the stage that computes it.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopHeader = loopStructure->getHeader();
+  auto headerBr = dyn_cast<BranchInst>(loopHeader->getTerminator());
+  if (false || (headerBr == nullptr) || (!headerBr->isConditional())) {
+    return 0;
+  }
+  auto popsTheCondition = false;
+  for (auto queueIndex : task->popValueQueues) {
+    auto &queueInfo = this->queues[queueIndex];
+    if (queueInfo->consumers.count(headerBr) > 0) {
+      popsTheCondition = true;
+      break;
+    }
+  }
+  if (!popsTheCondition) {
+    return 0;
+  }
+
+  /*
+   * Fetch the successor of the header that continues the loop.
+   * The prediction is that the loop continues, so the exit must be rare.
+   */
+  BasicBlock *continueBB = nullptr;
+  for (auto succBB : successors(loopHeader)) {
+    if (loopStructure->isIncluded(succBB)) {
+      if (continueBB != nullptr) {
+        return 0;
+      }
+      continueBB = succBB;
+    }
+  }
+  if (false || (continueBB == nullptr)
+      || (continueBB->getSinglePredecessor() != loopHeader)) {
+    return 0;
+  }
+  auto hot = this->noelle.getProfiles();
+  if (true && hot->isAvailable() && hot->hasBeenExecuted(loopHeader)) {
+    auto headerInvocations = hot->getInvocations(loopHeader);
+    auto continueInvocations = hot->getInvocations(continueBB);
+    if ((continueInvocations * 10) < (headerInvocations * 9)) {
+      return 0;
+    }
+  }
+
+  /*
+   * Fetch the clones of both blocks.
+   * The instructions of the successor are hoisted before the first one of the
+   * header that accesses memory or has side effects. This is the case for the
+   * pops of the queues, which include the one of the condition.
+   */
+  auto headerClone = task->getCloneOfOriginalBasicBlock(loopHeader);
+  auto continueClone = task->getCloneOfOriginalBasicBlock(continueBB);
+  if (false || (headerClone == nullptr) || (continueClone == nullptr)) {
+    return 0;
+  }
+  Instruction *insertionPoint = nullptr;
+  std::unordered_set<Instruction *> available;
+  for (auto &I : *headerClone) {
+    if (true && (!isa<PHINode>(&I))
+        && (I.mayReadOrWriteMemory() || I.mayHaveSideEffects()
+            || I.isTerminator())) {
+      insertionPoint = &I;
+      break;
+    }
+    available.insert(&I);
+  }
+  assert(insertionPoint != nullptr);
+
+  /*
+   * Hoist the instructions of the successor that can run in an iteration the
+   * loop does not execute: they do not access memory, they cannot trap, and
+   * they use only values available at the insertion point.
+   * A misprediction does not need a recovery: the values hoisted are simply
+   * not used. Hence, the stage computes them while it waits for the condition.
+   */
+  std::vector<Instruction *> instructionsToHoist;
+  for (auto &I : *continueClone) {
+    if (false || isa<PHINode>(&I) || I.isTerminator()
+        || I.mayReadOrWriteMemory() || I.mayHaveSideEffects()
+        || (!isSafeToSpeculativelyExecute(&I))) {
+      continue;
+    }
+    auto areOperandsAvailable = true;
+    for (auto op : I.operand_values()) {
+      auto opInst = dyn_cast<Instruction>(op);
+      if (false || (opInst == nullptr)
+          || ((opInst->getParent() != headerClone)
+              && (opInst->getParent() != continueClone))) {
+        continue;
+      }
+      if (available.count(opInst) == 0) {
+        areOperandsAvailable = false;
+        break;
+      }
+    }
+    if (!areOperandsAvailable) {
+      continue;
+    }
+    instructionsToHoist.push_back(&I);
+    available.insert(&I);
+  }
+  for (auto I : instructionsToHoist) {
+    I->dropPoisonGeneratingFlags();
+    I->moveBefore(insertionPoint);
+  }
+
+  return instructionsToHoist.size();
+}
+
+} // namespace llvm::noelle
@@ -30,8 +30,11 @@ DSWP::DSWP(Noelle &n, bool forceParallelization, bool enableSCCMerging)
     queues{},
     queueArrayType{ nullptr },
     sccToStage{},
+    sentClonableSCCs{},
     stageArrayType{ nullptr },
-    zeroIndexForBaseArray{ nullptr } {
+    zeroIndexForBaseArray{ nullptr },
+    stageReplicas{},
+    numberOfQueueSlots{ 0 } {
 
   /*
    * Fetch the function that dispatch the parallelized loop.
@@ -39,6 +42,20 @@ DSWP::DSWP(Noelle &n, bool forceParallelization, bool enableSCCMerging)
   auto program = this->noelle.getProgram();
   this->taskDispatcher = program->getFunction("NOELLE_DSWPDispatcher");
 
+  /*
+   * Fetch the dispatcher that places stages and their queues on the cores.
+   * This dispatcher is optional.
+   */
+  this->taskDispatcherWithPlacement =
+      program->getFunction("NOELLE_DSWPDispatcherWithPlacement");
+
+  /*
+   * Fetch the dispatcher that runs replicas of stages.
+   * This dispatcher is optional.
+   */
+  this->taskDispatcherWithReplicas =
+      program->getFunction("NOELLE_DSWPDispatcherWithReplicas");
+
   /*
    * Fetch the function that executes a stage.
    */
@@ -64,6 +81,18 @@ bool DSWP::canBeAppliedToLoop(LoopDependenceInfo *LDI, Heuristics *h) const {
     return false;
   }
 
+  /*
+   * The dependences between the calls that write to streams have been removed
+   * for techniques that buffer their output in the order of the iterations,
+   * which the stages of DSWP do not.
+   */
+  if (LDI->getCallsWithBufferedOutput().size() > 0) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DSWP:  The output of the loop cannot be buffered\n";
+    }
+    return false;
+  }
+
   /*
    * Fetch the profiles
    */
@@ -233,7 +262,7 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
    * Determine DSWP tasks (stages)
    */
   generateStagesFromPartitionedSCCs(LDI);
-  addClonableSCCsToStages(LDI);
+  addClonableSCCsToStages(LDI, h);
   // writeStageGraphsAsDot(*LDI);
   assert(isCompleteAndValidStageStructure(LDI));
 
@@ -248,6 +277,7 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
    */
   collectDataAndMemoryQueueInfo(LDI, this->noelle);
   collectControlQueueInfo(LDI, this->noelle);
+  packQueues(LDI, this->noelle);
   // assert(areQueuesAcyclical());
   // writeStageQueuesAsDot(*LDI);
 
@@ -259,6 +289,17 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
   collectLiveInEnvInfo(LDI);
   collectLiveOutEnvInfo(LDI);
 
+  /*
+   * Replicate the stages that are the bottleneck of the pipeline if their
+   * iterations are independent.
+   */
+  this->replicateStages(LDI, h);
+
+  /*
+   * Size the queues on the speeds of the stages they connect.
+   */
+  this->sizeQueues(LDI, h);
+
   if (this->verbose >= Verbosity::Minimal) {
     printStageSCCs(LDI);
   }
@@ -277,7 +318,7 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
       cast<Value>(ConstantInt::get(this->noelle.int64, 0));
   this->queueArrayType =
       ArrayType::get(PointerType::getUnqual(this->noelle.int8),
-                     this->queues.size());
+                     this->numberOfQueueSlots);
   this->stageArrayType =
       ArrayType::get(PointerType::getUnqual(this->noelle.int8),
                      this->tasks.size());
@@ -292,6 +333,14 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
      * Add instructions of the current pipeline stage to the task function
      */
     generateLoopSubsetForStage(LDI, i);
+
+    /*
+     * Count the iterations if the stage is replicated or if it pops values
+     * pushed by a replicated stage.
+     */
+    if (this->needsIterationCounter(i)) {
+      this->createIterationCounter(LDI, i);
+    }
     // if (this->verbose >= Verbosity::Maximal) {
     // printStageClonedValues(*LDI, i);
     // }
@@ -355,6 +404,9 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
      */
     IRBuilder<> entryBuilder(task->getEntry());
     entryBuilder.CreateBr(task->getCloneOfOriginalBasicBlock(loopHeader));
+    if (task->iterationCounter != nullptr) {
+      this->completeIterationCounter(LDI, i);
+    }
 
     /*
      * Add the return instruction at the end of the exit basic block.
@@ -362,6 +414,11 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
     IRBuilder<> exitBuilder(task->getExit());
     exitBuilder.CreateRetVoid();
 
+    /*
+     * Flush the batched queues the current pipeline stage pushes to.
+     */
+    flushBatchedQueues(LDI, this->noelle, i);
+
     /*
      * Store final results to loop live-out variables.
      * Generate a store to propagate the information about which exit block has
@@ -373,11 +430,36 @@ bool DSWP::apply(LoopDependenceInfo *LDI, Heuristics *h) {
       errs() << "DSWP:  Stored live out instructions\n";
     }
 
+    /*
+     * Execute the payload of a replicated stage only in the iterations of the
+     * current replica.
+     */
+    if (this->isReplicated(i)) {
+      this->executeOnlyIterationsOfReplica(LDI, i);
+    }
+
+    /*
+     * Compute the instructions of the next iteration while the stage waits
+     * for the exit condition of the loop.
+     */
+    if (!this->isReplicated(i)) {
+      auto hoisted = this->speculateLoopExitInStage(LDI, i);
+      if (this->verbose >= Verbosity::Maximal) {
+        errs() << "DSWP:  Stage " << i << ": " << hoisted
+               << " instructions run ahead of the exit condition\n";
+      }
+    }
+
     /*
      * Inline recursively calls to queues.
      */
     inlineQueueCalls(i);
 
+    /*
+     * Lay out the basic blocks of the pipeline stage.
+     */
+    this->layOutTaskBody(LDI, i);
+
     if (this->verbose >= Verbosity::Maximal) {
       task->getTaskBody()->print(errs() << "Pipeline stage " << i << ":\n");
       errs() << "\n";
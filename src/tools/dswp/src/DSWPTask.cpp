@@ -27,7 +27,9 @@ using namespace llvm::noelle;
 DSWPTask::DSWPTask(uint32_t ID, FunctionType *taskSignature, Module &M)
   : Task{ ID, taskSignature, M },
     stageSCCs{},
-    clonableSCCs{} {
+    clonableSCCs{},
+    iterationCounter{ nullptr },
+    replicaID{ nullptr } {
 
   return;
 }
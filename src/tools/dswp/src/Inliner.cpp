@@ -30,6 +30,12 @@ void DSWP::inlineQueueCalls(int taskIndex) {
   for (auto &queueInstrPair : task->queueInstrMap) {
     auto &queueInstr = queueInstrPair.second;
     callsToInline.insert(cast<CallInst>(queueInstr->queueCall));
+    if (queueInstr->flushCall != nullptr) {
+      callsToInline.insert(cast<CallInst>(queueInstr->flushCall));
+    }
+    for (auto replicaQueueCall : queueInstr->replicaQueueCalls) {
+      callsToInline.insert(cast<CallInst>(replicaQueueCall));
+    }
   }
   doNestedInlineOfCalls(task->getTaskBody(), callsToInline);
 }
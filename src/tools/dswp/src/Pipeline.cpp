@@ -62,7 +62,127 @@ void DSWP::generateStagesFromPartitionedSCCs(LoopDependenceInfo *LDI) {
   return;
 }
 
-void DSWP::addClonableSCCsToStages(LoopDependenceInfo *LDI) {
+void DSWP::addClonableSCCsToStages(LoopDependenceInfo *LDI, Heuristics *h) {
+
+  /*
+   * Clone the clonable SCCs into every stage that depends on them.
+   */
+  this->sentClonableSCCs.clear();
+  this->cloneClonableSCCsIntoStages(LDI);
+  if (h == nullptr) {
+    return;
+  }
+
+  /*
+   * Check which clonable SCCs are cheaper to compute once and send through
+   * queues than to clone.
+   */
+  auto sccManager = LDI->getSCCManager();
+  for (auto sccNode : sccManager->getSCCDAG()->getNodes()) {
+    auto scc = sccNode->getT();
+    if (!this->canClonableSCCBeSent(LDI, scc)) {
+      continue;
+    }
+
+    /*
+     * Fetch the stages that clone the SCC.
+     * The first one would compute it for the others.
+     */
+    std::vector<DSWPTask *> stages;
+    for (auto techniqueTask : this->tasks) {
+      auto task = (DSWPTask *)techniqueTask;
+      if (task->clonableSCCs.find(scc) != task->clonableSCCs.end()) {
+        stages.push_back(task);
+      }
+    }
+    if (stages.size() < 2) {
+      continue;
+    }
+
+    /*
+     * Collect the values the other stages would pop.
+     */
+    std::vector<std::set<Value *>> sentValues;
+    for (auto i = 1u; i < stages.size(); i++) {
+      std::set<Value *> values;
+      for (auto sccEdge : sccNode->getOutgoingEdges()) {
+        auto toSCC = sccEdge->getIncomingT();
+        if (stages[i]->stageSCCs.find(toSCC) == stages[i]->stageSCCs.end()) {
+          continue;
+        }
+        for (auto subEdge : sccEdge->getSubEdges()) {
+          values.insert(subEdge->getOutgoingT());
+        }
+      }
+      sentValues.push_back(values);
+    }
+    if (!h->shouldSendClonableSCCOfDSWP(scc, sentValues, this->verbose)) {
+      continue;
+    }
+    this->sentClonableSCCs.insert(scc);
+    this->sccToStage[scc] = stages[0];
+  }
+  if (this->sentClonableSCCs.size() == 0) {
+    return;
+  }
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << "DSWP:  Send " << this->sentClonableSCCs.size()
+           << " clonable SCCs through queues\n";
+  }
+
+  /*
+   * Clone the clonable SCCs again.
+   * This time, the sent ones are cloned only in the stages that compute them.
+   */
+  for (auto techniqueTask : this->tasks) {
+    auto task = (DSWPTask *)techniqueTask;
+    task->clonableSCCs.clear();
+  }
+  this->cloneClonableSCCsIntoStages(LDI);
+
+  return;
+}
+
+bool DSWP::canClonableSCCBeSent(LoopDependenceInfo *LDI, SCC *scc) const {
+  auto sccManager = LDI->getSCCManager();
+  auto sccInfo = sccManager->getSCCAttrs(scc);
+  if (false || (!sccInfo->canBeCloned())
+      || sccInfo->isInductionVariableSCC()) {
+    return false;
+  }
+
+  /*
+   * The SCC must not decide the control flow, which every stage replicates.
+   */
+  for (auto nodePair : scc->internalNodePairs()) {
+    auto inst = dyn_cast<Instruction>(nodePair.first);
+    if (false || (inst == nullptr) || inst->isTerminator()) {
+      return false;
+    }
+  }
+
+  /*
+   * The SCC must send only data values, and only to SCCs that run in a single
+   * stage. Hence, no other clonable SCC needs it to be cloned.
+   */
+  auto sccNode = sccManager->getSCCDAG()->fetchNode(scc);
+  for (auto sccEdge : sccNode->getOutgoingEdges()) {
+    auto toSCC = sccEdge->getIncomingT();
+    if (sccManager->getSCCAttrs(toSCC)->canBeCloned()) {
+      return false;
+    }
+    for (auto subEdge : sccEdge->getSubEdges()) {
+      if (false || subEdge->isControlDependence()
+          || subEdge->isMemoryDependence()) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void DSWP::cloneClonableSCCsIntoStages(LoopDependenceInfo *LDI) {
   auto sccManager = LDI->getSCCManager();
   for (auto techniqueTask : this->tasks) {
     auto task = (DSWPTask *)techniqueTask;
@@ -85,6 +205,16 @@ void DSWP::addClonableSCCsToStages(LoopDependenceInfo *LDI) {
         auto fromSCC = fromSCCNode->getT();
         if (visitedNodes.find(fromSCCNode) != visitedNodes.end())
           continue;
+
+        /*
+         * Clonable SCCs sent through queues are cloned only in the stage that
+         * computes them.
+         */
+        if (true && (this->sentClonableSCCs.count(fromSCC) > 0)
+            && (this->sccToStage.at(fromSCC) != task)) {
+          visitedNodes.insert(fromSCCNode);
+          continue;
+        }
         auto fromSCCInfo = sccManager->getSCCAttrs(fromSCC);
         if (fromSCCInfo->canBeCloned()) {
           task->clonableSCCs.insert(fromSCC);
@@ -168,17 +298,46 @@ void DSWP::createPipelineFromStages(LoopDependenceInfo *LDI, Noelle &par) {
    * array
    */
   auto queuesCount =
-      cast<Value>(ConstantInt::get(par.int64, this->queues.size()));
+      cast<Value>(ConstantInt::get(par.int64, this->numberOfQueueSlots));
   auto stagesCount =
       cast<Value>(ConstantInt::get(par.int64, this->numTaskInstances));
 
   /*
    * Add the call to the task dispatcher
+   *
+   * If the runtime can place stages, then we also pass the stage that consumes
+   * each queue so the runtime can allocate the queue close to its consumer.
    */
-  auto runtimeCall = builder.CreateCall(
-      taskDispatcher,
-      ArrayRef<Value *>(
-          { envPtr, queueSizesPtr, stagesPtr, stagesCount, queuesCount }));
+  CallInst *runtimeCall = nullptr;
+  auto isAnyStageReplicated = false;
+  for (auto i = 0; i < this->numTaskInstances; ++i) {
+    isAnyStageReplicated |= this->isReplicated(i);
+  }
+  if (isAnyStageReplicated) {
+    auto stageReplicasPtr = createStageReplicasArray(LDI, builder, par);
+    runtimeCall = builder.CreateCall(this->taskDispatcherWithReplicas,
+                                     ArrayRef<Value *>({ envPtr,
+                                                         queueSizesPtr,
+                                                         stagesPtr,
+                                                         stageReplicasPtr,
+                                                         stagesCount,
+                                                         queuesCount }));
+  } else if (this->taskDispatcherWithPlacement != nullptr) {
+    auto queueConsumersPtr =
+        createQueueConsumersArrayFromStages(LDI, builder, par);
+    runtimeCall = builder.CreateCall(this->taskDispatcherWithPlacement,
+                                     ArrayRef<Value *>({ envPtr,
+                                                         queueSizesPtr,
+                                                         queueConsumersPtr,
+                                                         stagesPtr,
+                                                         stagesCount,
+                                                         queuesCount }));
+  } else {
+    runtimeCall = builder.CreateCall(
+        taskDispatcher,
+        ArrayRef<Value *>(
+            { envPtr, queueSizesPtr, stagesPtr, stagesCount, queuesCount }));
+  }
   auto numThreadsUsed = builder.CreateExtractValue(runtimeCall, (uint64_t)0);
 
   /*
@@ -218,17 +377,53 @@ Value *DSWP::createStagesArrayFromStages(LoopDependenceInfo *LDI,
 Value *DSWP::createQueueSizesArrayFromStages(LoopDependenceInfo *LDI,
                                              IRBuilder<> funcBuilder,
                                              Noelle &par) {
-  auto queuesAlloca = cast<Value>(
-      funcBuilder.CreateAlloca(ArrayType::get(par.int64, this->queues.size())));
+  /*
+   * Compute the size of each slot of the queue array.
+   * The slots of queues that have a copy per replica are left empty, and so
+   * is the slot that holds the ID of the replica.
+   * The ID of the loop follows the sizes, so the runtime can report the
+   * stalls of the queues of the loop (see -dswp-queue-telemetry).
+   */
+  std::vector<int64_t> queueSizes(this->numberOfQueueSlots + 1, 0);
   for (int i = 0; i < this->queues.size(); ++i) {
     auto &queue = this->queues[i];
+    int64_t queueSize = queue->bitLength;
+    if (queue->packedInto != -1) {
+      queueSize = 0;
+    } else if (queue->isSlotQueue) {
+      queueSize = QueueInfo::slotQueueSizeFlag + queue->slotBytes;
+    } else if (queue->isBatched) {
+      queueSize += QueueInfo::batchedQueueSizeFlag;
+    } else if (this->isSPSCQueueUsed(par, queue.get())) {
+      queueSize += QueueInfo::spscQueueSizeFlag;
+    }
+    if ((queueSize != 0) && (queue->capacity > 0)) {
+      queueSize += ((int64_t)Log2_64(queue->capacity))
+                   << QueueInfo::capacitySizeShift;
+    }
+    if (queue->replicas > 1) {
+      for (auto r = 0; r < queue->replicas; r++) {
+        queueSizes[queue->firstReplicaSlot + r] = queueSize;
+      }
+      queueSize = 0;
+    }
+    queueSizes[i] = queueSize;
+  }
+  queueSizes[this->numberOfQueueSlots] = LDI->getID();
+
+  /*
+   * Store the sizes.
+   */
+  auto queuesAlloca = cast<Value>(funcBuilder.CreateAlloca(
+      ArrayType::get(par.int64, queueSizes.size())));
+  for (auto i = 0u; i < queueSizes.size(); ++i) {
     auto queueIndex = cast<Value>(ConstantInt::get(par.int64, i));
     auto queuePtr = funcBuilder.CreateInBoundsGEP(
         queuesAlloca,
         ArrayRef<Value *>({ this->zeroIndexForBaseArray, queueIndex }));
     auto queueCast =
         funcBuilder.CreateBitCast(queuePtr, PointerType::getUnqual(par.int64));
-    funcBuilder.CreateStore(ConstantInt::get(par.int64, queue->bitLength),
+    funcBuilder.CreateStore(ConstantInt::get(par.int64, queueSizes[i]),
                             queueCast);
   }
 
@@ -236,3 +431,49 @@ Value *DSWP::createQueueSizesArrayFromStages(LoopDependenceInfo *LDI,
       funcBuilder.CreateBitCast(queuesAlloca,
                                 PointerType::getUnqual(par.int64)));
 }
+
+Value *DSWP::createQueueConsumersArrayFromStages(LoopDependenceInfo *LDI,
+                                                 IRBuilder<> funcBuilder,
+                                                 Noelle &par) {
+  auto consumersAlloca = cast<Value>(
+      funcBuilder.CreateAlloca(ArrayType::get(par.int64, this->queues.size())));
+  for (int i = 0; i < this->queues.size(); ++i) {
+    auto &queue = this->queues[i];
+    auto queueIndex = cast<Value>(ConstantInt::get(par.int64, i));
+    auto consumerPtr = funcBuilder.CreateInBoundsGEP(
+        consumersAlloca,
+        ArrayRef<Value *>({ this->zeroIndexForBaseArray, queueIndex }));
+    auto consumerCast =
+        funcBuilder.CreateBitCast(consumerPtr,
+                                  PointerType::getUnqual(par.int64));
+    funcBuilder.CreateStore(ConstantInt::get(par.int64, queue->toStage),
+                            consumerCast);
+  }
+
+  return cast<Value>(
+      funcBuilder.CreateBitCast(consumersAlloca,
+                                PointerType::getUnqual(par.int64)));
+}
+
+Value *DSWP::createStageReplicasArray(LoopDependenceInfo *LDI,
+                                      IRBuilder<> funcBuilder,
+                                      Noelle &par) {
+  auto replicasAlloca = cast<Value>(funcBuilder.CreateAlloca(
+      ArrayType::get(par.int64, this->numTaskInstances)));
+  for (int i = 0; i < this->numTaskInstances; ++i) {
+    auto stageIndex = cast<Value>(ConstantInt::get(par.int64, i));
+    auto replicasPtr = funcBuilder.CreateInBoundsGEP(
+        replicasAlloca,
+        ArrayRef<Value *>({ this->zeroIndexForBaseArray, stageIndex }));
+    auto replicasCast =
+        funcBuilder.CreateBitCast(replicasPtr,
+                                  PointerType::getUnqual(par.int64));
+    funcBuilder.CreateStore(
+        ConstantInt::get(par.int64, this->stageReplicas[i]),
+        replicasCast);
+  }
+
+  return cast<Value>(
+      funcBuilder.CreateBitCast(replicasAlloca,
+                                PointerType::getUnqual(par.int64)));
+}
@@ -59,12 +59,38 @@ void DSWP::registerQueue(Noelle &par,
     auto &queueTypes = par.queues.queueSizeToIndex;
     bool byteSize = queueTypes.find(queueInfo->bitLength) != queueTypes.end();
     if (!byteSize) {
-      errs() << "NOT SUPPORTED BYTE SIZE (" << queueInfo->bitLength << "): ";
-      producer->getType()->print(errs());
-      errs() << "\n";
-      producer->print(errs() << "Producer: ");
-      errs() << "\n";
-      abort();
+
+      /*
+       * Values of any other size are moved through slots of their size.
+       */
+      if (par.queues.queueSlotPush == nullptr) {
+        errs() << "NOT SUPPORTED BYTE SIZE (" << queueInfo->bitLength << "): ";
+        producer->getType()->print(errs());
+        errs() << "\n";
+        producer->print(errs() << "Producer: ");
+        errs() << "\n";
+        abort();
+      }
+      queueInfo->isSlotQueue = true;
+      queueInfo->slotType = queueInfo->dependentType;
+      queueInfo->slotBytes = DataLayout(producer->getModule())
+                                 .getTypeAllocSize(queueInfo->slotType);
+    }
+
+    /*
+     * A queue connects the producer and the consumer stages only.
+     */
+    queueInfo->isSingleProducerSingleConsumer = true;
+
+    /*
+     * Move values in batches unless the consumer needs them with low latency.
+     * This is the case for memory dependences, which are used to synchronize
+     * the consumer with the producer.
+     */
+    if (true && (!isMemoryDependence) && (!queueInfo->isSlotQueue)
+        && queueInfo->isSingleProducerSingleConsumer
+        && (par.queues.queueBatchedPushes.size() > 0)) {
+      queueInfo->isBatched = true;
     }
   }
 
@@ -260,7 +286,8 @@ void DSWP::collectDataAndMemoryQueueInfo(LoopDependenceInfo *LDI, Noelle &par) {
            sccManager->getSCCDAG()->fetchNode(scc)->getIncomingEdges()) {
         auto fromSCC = sccEdge->getOutgoingT();
         auto fromSCCInfo = sccManager->getSCCAttrs(fromSCC);
-        if (fromSCCInfo->canBeCloned()) {
+        if (true && fromSCCInfo->canBeCloned()
+            && (this->sentClonableSCCs.count(fromSCC) == 0)) {
           continue;
         }
 
@@ -338,24 +365,87 @@ void DSWP::generateLoadsOfQueuePointers(Noelle &par, int taskIndex) {
       entryBuilder.CreateBitCast(task->queueArg,
                                  PointerType::getUnqual(this->queueArrayType));
 
+  /*
+   * Load the ID of the replica from the last slot of the queue array.
+   */
+  if (this->isReplicated(taskIndex)) {
+    auto replicaSlot =
+        ConstantInt::get(par.int64, this->numberOfQueueSlots - 1);
+    auto replicaPtr = entryBuilder.CreateInBoundsGEP(
+        queuesArray,
+        ArrayRef<Value *>({ this->zeroIndexForBaseArray, replicaSlot }));
+    task->replicaID =
+        entryBuilder.CreatePtrToInt(entryBuilder.CreateLoad(replicaPtr),
+                                    par.int64);
+  }
+
   /*
    * Load this stage's relevant queues
    */
   auto loadQueuePtrFromIndex = [&](int queueIndex) -> void {
     auto queueInfo = this->queues[queueIndex].get();
-    auto queueIndexValue = cast<Value>(ConstantInt::get(par.int64, queueIndex));
-    auto queuePtr = entryBuilder.CreateInBoundsGEP(
-        queuesArray,
-        ArrayRef<Value *>({ this->zeroIndexForBaseArray, queueIndexValue }));
-    auto parQueueIndex = par.queues.queueSizeToIndex[queueInfo->bitLength];
-    auto queueType = par.queues.queueTypes[parQueueIndex];
-    auto queueElemType = par.queues.queueElementTypes[parQueueIndex];
-    auto queueCast =
-        entryBuilder.CreateBitCast(queuePtr, PointerType::getUnqual(queueType));
+
+    /*
+     * Values packed into the slot of another queue do not need their queue.
+     */
+    if (queueInfo->packedInto != -1) {
+      return;
+    }
+    auto queueType = this->getQueueType(par, queueInfo);
+    auto queueElemType = this->getQueueElementType(par, queueInfo);
+    auto loadQueuePtrFromSlot = [&](Value *slot) -> Value * {
+      auto queuePtr = entryBuilder.CreateInBoundsGEP(
+          queuesArray,
+          ArrayRef<Value *>({ this->zeroIndexForBaseArray, slot }));
+      auto queueCast =
+          entryBuilder.CreateBitCast(queuePtr,
+                                     PointerType::getUnqual(queueType));
+      return entryBuilder.CreateLoad(queueCast);
+    };
 
     auto queueInstrs = std::make_unique<QueueInstrs>();
-    queueInstrs->queuePtr = entryBuilder.CreateLoad(queueCast);
-    queueInstrs->alloca = entryBuilder.CreateAlloca(queueInfo->dependentType);
+    queueInstrs->queuePtr = nullptr;
+    queueInstrs->flushCall = nullptr;
+    if (queueInfo->replicas == 1) {
+      queueInstrs->queuePtr =
+          loadQueuePtrFromSlot(ConstantInt::get(par.int64, queueIndex));
+
+    } else if (this->isReplicated(taskIndex)) {
+
+      /*
+       * A replica uses only its own copy of the queue.
+       */
+      auto slot = entryBuilder.CreateAdd(
+          ConstantInt::get(par.int64, queueInfo->firstReplicaSlot),
+          task->replicaID);
+      queueInstrs->queuePtr = loadQueuePtrFromSlot(slot);
+
+    } else if (queueInfo->fromStage == taskIndex) {
+
+      /*
+       * The values popped by a replicated stage are pushed to the copies of
+       * all its replicas.
+       */
+      for (auto r = 0; r < queueInfo->replicas; r++) {
+        auto slot =
+            ConstantInt::get(par.int64, queueInfo->firstReplicaSlot + r);
+        auto replicaQueuePtr = loadQueuePtrFromSlot(slot);
+        if (r == 0) {
+          queueInstrs->queuePtr = replicaQueuePtr;
+          continue;
+        }
+        queueInstrs->replicaQueuePtrs.push_back(replicaQueuePtr);
+      }
+    }
+
+    /*
+     * The values pushed by a replicated stage are popped from the copy of the
+     * replica that executed the iteration. This copy is loaded where the value
+     * is popped.
+     */
+    auto valueType = queueInfo->isSlotQueue ? queueInfo->slotType
+                                            : queueInfo->dependentType;
+    queueInstrs->alloca = entryBuilder.CreateAlloca(valueType);
     queueInstrs->allocaCast =
         entryBuilder.CreateBitCast(queueInstrs->alloca,
                                    PointerType::getUnqual(queueElemType));
@@ -373,9 +463,10 @@ void DSWP::popValueQueues(LoopDependenceInfo *LDI, Noelle &par, int taskIndex) {
 
   for (auto queueIndex : task->popValueQueues) {
     auto &queueInfo = this->queues[queueIndex];
+    if (queueInfo->packedInto != -1) {
+      continue;
+    }
     auto queueInstrs = task->queueInstrMap[queueIndex].get();
-    auto queueCallArgs =
-        ArrayRef<Value *>({ queueInstrs->queuePtr, queueInstrs->allocaCast });
 
     /*
      * Determine the clone of the basic block of the original producer
@@ -386,10 +477,55 @@ void DSWP::popValueQueues(LoopDependenceInfo *LDI, Noelle &par, int taskIndex) {
     auto clonedB = task->getCloneOfOriginalBasicBlock(originalB);
     Instruction *insertionPoint = clonedB->getFirstNonPHIOrDbgOrLifetime();
     IRBuilder<> builder(insertionPoint);
-    auto queuePopFunction =
-        par.queues.queuePops[par.queues.queueSizeToIndex[queueInfo->bitLength]];
+
+    /*
+     * Load the copy of the queue of the replica that executed the current
+     * iteration if the value has been pushed by a replicated stage.
+     */
+    if (queueInstrs->queuePtr == nullptr) {
+      assert(task->iterationCounter != nullptr);
+      auto replicasValue = ConstantInt::get(par.int64, queueInfo->replicas);
+      auto slot = builder.CreateAdd(
+          ConstantInt::get(par.int64, queueInfo->firstReplicaSlot),
+          builder.CreateURem(task->iterationCounter, replicasValue));
+      auto queuesArray = builder.CreateBitCast(
+          task->queueArg,
+          PointerType::getUnqual(this->queueArrayType));
+      auto queuePtr = builder.CreateInBoundsGEP(
+          queuesArray,
+          ArrayRef<Value *>({ this->zeroIndexForBaseArray, slot }));
+      auto queueType = this->getQueueType(par, queueInfo.get());
+      auto queueCast =
+          builder.CreateBitCast(queuePtr, PointerType::getUnqual(queueType));
+      queueInstrs->queuePtr = builder.CreateLoad(queueCast);
+    }
+    auto queueCallArgs =
+        ArrayRef<Value *>({ queueInstrs->queuePtr, queueInstrs->allocaCast });
+    auto queuePopFunction = this->getQueuePopFunction(par, queueInfo.get());
     queueInstrs->queueCall =
         builder.CreateCall(queuePopFunction, queueCallArgs);
+
+    /*
+     * Check if the slot holds the values of several queues.
+     */
+    if (queueInfo->packedQueues.size() > 1) {
+
+      /*
+       * Load each value from its field of the slot.
+       * Map from each producer to its load.
+       */
+      for (auto i = 0u; i < queueInfo->packedQueues.size(); i++) {
+        auto &packedQueueInfo = this->queues[queueInfo->packedQueues[i]];
+        auto fieldPtr = builder.CreateStructGEP(queueInstrs->alloca, i);
+        auto fieldLoad = builder.CreateLoad(fieldPtr);
+        if (i == 0) {
+          queueInstrs->load = fieldLoad;
+        }
+        task->addInstruction(packedQueueInfo->producer,
+                             cast<Instruction>(fieldLoad));
+      }
+      continue;
+    }
     queueInstrs->load = builder.CreateLoad(queueInstrs->alloca);
 
     /*
@@ -406,29 +542,259 @@ void DSWP::pushValueQueues(LoopDependenceInfo *LDI,
   auto task = (DSWPTask *)this->tasks[taskIndex];
 
   for (auto queueIndex : task->pushValueQueues) {
-    auto queueInstrs = task->queueInstrMap[queueIndex].get();
     auto queueInfo = this->queues[queueIndex].get();
+    if (queueInfo->packedInto != -1) {
+      continue;
+    }
+    auto queueInstrs = task->queueInstrMap[queueIndex].get();
     auto queueCallArgs =
         ArrayRef<Value *>({ queueInstrs->queuePtr, queueInstrs->allocaCast });
-    auto queuePushFunction =
-        par.queues
-            .queuePushes[par.queues.queueSizeToIndex[queueInfo->bitLength]];
+    auto queuePushFunction = this->getQueuePushFunction(par, queueInfo);
 
     /*
-     * Store the produced value immediately
-     * Push the value immediately
+     * Check if the slot holds the values of several queues.
      */
-    auto producerBlock = queueInfo->producer->getParent();
-    auto producerClone =
-        task->getCloneOfOriginalInstruction(queueInfo->producer);
-    auto producerCloneBlock = producerClone->getParent();
-    auto insertPoint = producerClone->getNextNode();
-    if (isa<PHINode>(insertPoint)) {
-      insertPoint = producerCloneBlock->getFirstNonPHIOrDbgOrLifetime();
+    Instruction *insertPoint = nullptr;
+    if (queueInfo->packedQueues.size() > 1) {
+
+      /*
+       * Push the slot after the last value has been produced.
+       * Values are packed in the order they are produced.
+       */
+      auto &lastQueueInfo = this->queues[queueInfo->packedQueues.back()];
+      auto lastProducerClone =
+          task->getCloneOfOriginalInstruction(lastQueueInfo->producer);
+      insertPoint = lastProducerClone->getNextNode();
+      if (isa<PHINode>(insertPoint)) {
+        insertPoint =
+            lastProducerClone->getParent()->getFirstNonPHIOrDbgOrLifetime();
+      }
+
+    } else {
+
+      /*
+       * Store the produced value immediately
+       * Push the value immediately
+       */
+      auto producerClone =
+          task->getCloneOfOriginalInstruction(queueInfo->producer);
+      auto producerCloneBlock = producerClone->getParent();
+      insertPoint = producerClone->getNextNode();
+      if (isa<PHINode>(insertPoint)) {
+        insertPoint = producerCloneBlock->getFirstNonPHIOrDbgOrLifetime();
+      }
     }
+    auto instBeforePush = insertPoint->getPrevNode();
     IRBuilder<> builder(insertPoint);
-    builder.CreateStore(producerClone, queueInstrs->alloca);
+    if (queueInfo->packedQueues.size() > 1) {
+      for (auto i = 0u; i < queueInfo->packedQueues.size(); i++) {
+        auto &packedQueueInfo = this->queues[queueInfo->packedQueues[i]];
+        auto producerClone =
+            task->getCloneOfOriginalInstruction(packedQueueInfo->producer);
+        auto fieldPtr = builder.CreateStructGEP(queueInstrs->alloca, i);
+        builder.CreateStore(producerClone, fieldPtr);
+      }
+    } else {
+      auto producerClone =
+          task->getCloneOfOriginalInstruction(queueInfo->producer);
+      builder.CreateStore(producerClone, queueInstrs->alloca);
+    }
     queueInstrs->queueCall =
         builder.CreateCall(queuePushFunction, queueCallArgs);
+
+    /*
+     * Push the value to the copies of the queue of the other replicas of the
+     * consumer.
+     */
+    for (auto replicaQueuePtr : queueInstrs->replicaQueuePtrs) {
+      auto replicaQueueCall = builder.CreateCall(
+          queuePushFunction,
+          ArrayRef<Value *>({ replicaQueuePtr, queueInstrs->allocaCast }));
+      queueInstrs->replicaQueueCalls.push_back(replicaQueueCall);
+    }
+
+    /*
+     * Keep track of the instructions that push the value.
+     * A replicated stage executes them only in its own iterations.
+     */
+    auto pushInst = (instBeforePush != nullptr)
+                        ? instBeforePush->getNextNode()
+                        : &*insertPoint->getParent()->begin();
+    for (; pushInst != insertPoint; pushInst = pushInst->getNextNode()) {
+      task->pushInstructions.insert(pushInst);
+    }
+  }
+}
+
+void DSWP::packQueues(LoopDependenceInfo *LDI, Noelle &par) {
+
+  /*
+   * Check if the runtime can move values through slots of any size.
+   */
+  if (par.queues.queueSlotPush == nullptr) {
+    return;
+  }
+
+  /*
+   * Group the queues that connect the same stages and whose values are
+   * produced in the same basic block.
+   * Memory dependences are not packed as they synchronize the stages.
+   */
+  std::map<std::tuple<int, int, BasicBlock *>, std::vector<int>> groups;
+  for (auto queueIndex = 0u; queueIndex < this->queues.size(); queueIndex++) {
+    auto &queueInfo = this->queues[queueIndex];
+    if (queueInfo->isMemoryDependence) {
+      continue;
+    }
+    auto key = std::make_tuple(queueInfo->fromStage,
+                               queueInfo->toStage,
+                               queueInfo->producer->getParent());
+    groups[key].push_back(queueIndex);
   }
+
+  /*
+   * Pack each group into the slot of its first queue.
+   */
+  for (auto &group : groups) {
+    auto &queueIndices = group.second;
+    if (queueIndices.size() < 2) {
+      continue;
+    }
+
+    /*
+     * Sort the queues by the position of their producers in the basic block.
+     */
+    auto producerBlock = std::get<2>(group.first);
+    std::unordered_map<Instruction *, uint32_t> positions;
+    uint32_t position = 0;
+    for (auto &inst : *producerBlock) {
+      positions[&inst] = position++;
+    }
+    std::sort(queueIndices.begin(),
+              queueIndices.end(),
+              [this, &positions](int q0, int q1) -> bool {
+                return positions[this->queues[q0]->producer]
+                       < positions[this->queues[q1]->producer];
+              });
+
+    /*
+     * Define the slot.
+     */
+    std::vector<Type *> fieldTypes;
+    for (auto queueIndex : queueIndices) {
+      fieldTypes.push_back(this->queues[queueIndex]->dependentType);
+    }
+    auto slotType = StructType::get(producerBlock->getContext(),
+                                    ArrayRef<Type *>(fieldTypes));
+    auto leaderIndex = queueIndices[0];
+    auto &leader = this->queues[leaderIndex];
+    leader->isSlotQueue = true;
+    leader->isBatched = false;
+    leader->slotType = slotType;
+    leader->slotBytes =
+        DataLayout(producerBlock->getModule()).getTypeAllocSize(slotType);
+    leader->packedQueues = queueIndices;
+    for (auto queueIndex : queueIndices) {
+      if (queueIndex == leaderIndex) {
+        continue;
+      }
+      auto &queueInfo = this->queues[queueIndex];
+      queueInfo->packedInto = leaderIndex;
+      queueInfo->isBatched = false;
+    }
+  }
+
+  return;
+}
+
+bool DSWP::isSPSCQueueUsed(Noelle &par, QueueInfo *queueInfo) const {
+  return true && queueInfo->isSingleProducerSingleConsumer
+         && (!queueInfo->isBatched) && (!queueInfo->isSlotQueue)
+         && (par.queues.queueSPSCPushes.size() > 0);
+}
+
+Type *DSWP::getQueueElementType(Noelle &par, QueueInfo *queueInfo) const {
+  if (queueInfo->isSlotQueue) {
+    return par.int8;
+  }
+  auto parQueueIndex = par.queues.queueSizeToIndex[queueInfo->bitLength];
+
+  return par.queues.queueElementTypes[parQueueIndex];
+}
+
+Type *DSWP::getQueueType(Noelle &par, QueueInfo *queueInfo) const {
+  if (queueInfo->isSlotQueue) {
+    return par.queues.queueSlotType;
+  }
+  auto parQueueIndex = par.queues.queueSizeToIndex[queueInfo->bitLength];
+  if (queueInfo->isBatched) {
+    return par.queues.queueBatchedTypes[parQueueIndex];
+  }
+  if (this->isSPSCQueueUsed(par, queueInfo)) {
+    return par.queues.queueSPSCTypes[parQueueIndex];
+  }
+
+  return par.queues.queueTypes[parQueueIndex];
+}
+
+Function *DSWP::getQueuePushFunction(Noelle &par, QueueInfo *queueInfo) const {
+  if (queueInfo->isSlotQueue) {
+    return par.queues.queueSlotPush;
+  }
+  auto parQueueIndex = par.queues.queueSizeToIndex[queueInfo->bitLength];
+  if (queueInfo->isBatched) {
+    return par.queues.queueBatchedPushes[parQueueIndex];
+  }
+  if (this->isSPSCQueueUsed(par, queueInfo)) {
+    return par.queues.queueSPSCPushes[parQueueIndex];
+  }
+
+  return par.queues.queuePushes[parQueueIndex];
+}
+
+Function *DSWP::getQueuePopFunction(Noelle &par, QueueInfo *queueInfo) const {
+  if (queueInfo->isSlotQueue) {
+    return par.queues.queueSlotPop;
+  }
+  auto parQueueIndex = par.queues.queueSizeToIndex[queueInfo->bitLength];
+  if (queueInfo->isBatched) {
+    return par.queues.queueBatchedPops[parQueueIndex];
+  }
+  if (this->isSPSCQueueUsed(par, queueInfo)) {
+    return par.queues.queueSPSCPops[parQueueIndex];
+  }
+
+  return par.queues.queuePops[parQueueIndex];
+}
+
+void DSWP::flushBatchedQueues(LoopDependenceInfo *LDI,
+                              Noelle &par,
+                              int taskIndex) {
+  auto task = (DSWPTask *)this->tasks[taskIndex];
+
+  /*
+   * Publish the values left in the batches of the queues the stage pushes to.
+   * This must happen just before the stage returns.
+   */
+  IRBuilder<> builder(task->getExit()->getTerminator());
+  for (auto queueIndex : task->pushValueQueues) {
+    auto queueInfo = this->queues[queueIndex].get();
+    if (!queueInfo->isBatched) {
+      continue;
+    }
+    auto queueInstrs = task->queueInstrMap[queueIndex].get();
+    auto parQueueIndex = par.queues.queueSizeToIndex[queueInfo->bitLength];
+    auto queueFlushFunction = par.queues.queueBatchedFlushes[parQueueIndex];
+    queueInstrs->flushCall =
+        builder.CreateCall(queueFlushFunction,
+                           ArrayRef<Value *>({ queueInstrs->queuePtr }));
+    for (auto replicaQueuePtr : queueInstrs->replicaQueuePtrs) {
+      auto replicaFlushCall =
+          builder.CreateCall(queueFlushFunction,
+                             ArrayRef<Value *>({ replicaQueuePtr }));
+      queueInstrs->replicaQueueCalls.push_back(replicaFlushCall);
+    }
+  }
+
+  return;
 }
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "noelle/core/Architecture.hpp"
+#include "DSWP.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<std::string> QueueTelemetryFileName(
+    "dswp-queue-telemetry",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Telemetry dumped by a previous run (see NOELLE_TELEMETRY) with "
+             "the stalls of the DSWP queues"));
+
+/*
+ * Minimum number of slots of a queue sized by the telemetry.
+ */
+static const uint64_t minimumQueueCapacity = 16;
+
+void DSWP::sizeQueues(LoopDependenceInfo *LDI, Heuristics *h) {
+
+  /*
+   * Collect the queues whose capacity the runtime can change, which are the
+   * ring buffers with one producer and one consumer.
+   * A slot of a batched queue holds a cache line of values.
+   */
+  std::vector<QueueInfo *> sizedQueues;
+  std::vector<std::pair<uint32_t, uint32_t>> queueStages;
+  std::vector<uint64_t> slotBytes;
+  for (auto &queue : this->queues) {
+    if (queue->packedInto != -1) {
+      continue;
+    }
+    uint64_t bytes = 0;
+    if (queue->isSlotQueue) {
+      bytes = queue->slotBytes;
+    } else if (queue->isBatched) {
+      bytes = Architecture::getCacheLineBytes();
+    } else if (this->isSPSCQueueUsed(this->noelle, queue.get())) {
+      bytes = std::max(queue->bitLength / 8, 1);
+    } else {
+      continue;
+    }
+    sizedQueues.push_back(queue.get());
+    queueStages.push_back(std::make_pair(queue->fromStage, queue->toStage));
+    slotBytes.push_back(bytes);
+  }
+  if (sizedQueues.size() == 0) {
+    return;
+  }
+
+  /*
+   * Size the queues on the speeds of the stages they connect.
+   */
+  if (h != nullptr) {
+    std::vector<std::set<SCC *>> stageSCCs;
+    std::vector<std::set<SCC *>> clonedSCCs;
+    std::vector<std::set<Value *>> poppedValues;
+    this->collectCostsOfStages(stageSCCs, clonedSCCs, poppedValues);
+    auto capacities = h->getCapacitiesOfDSWPQueues(stageSCCs,
+                                                   clonedSCCs,
+                                                   poppedValues,
+                                                   this->stageReplicas,
+                                                   queueStages,
+                                                   slotBytes,
+                                                   this->verbose);
+    for (auto i = 0u; i < sizedQueues.size(); i++) {
+      sizedQueues[i]->capacity = capacities[i];
+    }
+  }
+
+  /*
+   * Adjust the capacities to the stalls of the queues measured by a previous
+   * run.
+   */
+  this->adjustQueueCapacitiesToTelemetry(LDI);
+
+  return;
+}
+
+void DSWP::adjustQueueCapacitiesToTelemetry(LoopDependenceInfo *LDI) {
+  if (QueueTelemetryFileName.getNumOccurrences() == 0) {
+    return;
+  }
+
+  /*
+   * Read the telemetry.
+   */
+  auto buffer = MemoryBuffer::getFile(QueueTelemetryFileName);
+  if (!buffer) {
+    errs() << "DSWP: WARNING = cannot read " << QueueTelemetryFileName
+           << "\n";
+    return;
+  }
+  auto telemetry = json::parse((*buffer)->getBuffer());
+  if (!telemetry) {
+    consumeError(telemetry.takeError());
+    errs() << "DSWP: WARNING = " << QueueTelemetryFileName
+           << " is not a telemetry file\n";
+    return;
+  }
+  auto telemetryObject = telemetry->getAsObject();
+  if (telemetryObject == nullptr) {
+    return;
+  }
+  auto loops = telemetryObject->getArray("loops");
+  if (loops == nullptr) {
+    return;
+  }
+
+  /*
+   * Fetch the queues of the loop.
+   * Their counters are indexed by the slot of the queue array they take.
+   */
+  auto loopID = LDI->getID();
+  json::Array *capacities = nullptr;
+  json::Array *fullStalls = nullptr;
+  json::Array *emptyStalls = nullptr;
+  for (auto &loop : *loops) {
+    auto loopObject = loop.getAsObject();
+    if (loopObject == nullptr) {
+      continue;
+    }
+    auto id = loopObject->getInteger("loopID");
+    if (false || (!id) || (*id < 0) || ((uint64_t)*id != loopID)) {
+      continue;
+    }
+    capacities = loopObject->getArray("queueCapacities");
+    fullStalls = loopObject->getArray("queueFullStalls");
+    emptyStalls = loopObject->getArray("queueEmptyStalls");
+    break;
+  }
+  if (false || (capacities == nullptr) || (fullStalls == nullptr)
+      || (emptyStalls == nullptr)) {
+    return;
+  }
+  if (false || (capacities->size() != this->numberOfQueueSlots)
+      || (fullStalls->size() != this->numberOfQueueSlots)
+      || (emptyStalls->size() != this->numberOfQueueSlots)) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DSWP:  The telemetry of the queues does not match the loop\n";
+    }
+    return;
+  }
+  auto valueOf = [](json::Array *values, uint32_t slot) -> uint64_t {
+    auto value = (*values)[slot].getAsInteger();
+    if (!value || (*value < 0)) {
+      return 0;
+    }
+    return *value;
+  };
+
+  /*
+   * Adjust the capacity of each queue.
+   *
+   * If both the producer and the consumer waited, then the speeds of the
+   * stages vary across iterations and a larger queue absorbs the
+   * differences. If only one side waited, then the queue was always full (or
+   * always empty), and fewer slots give the same throughput with less cache.
+   */
+  auto cacheBytes = Architecture::getL2CacheBytes();
+  for (auto i = 0u; i < this->queues.size(); i++) {
+    auto &queue = this->queues[i];
+    if (queue->packedInto != -1) {
+      continue;
+    }
+
+    /*
+     * Add up the counters of the copies of the queue.
+     */
+    std::vector<uint32_t> slots;
+    if (queue->replicas > 1) {
+      for (auto r = 0; r < queue->replicas; r++) {
+        slots.push_back(queue->firstReplicaSlot + r);
+      }
+    } else {
+      slots.push_back(i);
+    }
+    uint64_t capacity = 0;
+    uint64_t full = 0;
+    uint64_t empty = 0;
+    for (auto slot : slots) {
+      capacity = std::max(capacity, valueOf(capacities, slot));
+      full += valueOf(fullStalls, slot);
+      empty += valueOf(emptyStalls, slot);
+    }
+    if (false || (capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+      continue;
+    }
+
+    /*
+     * Compute the new capacity.
+     */
+    auto newCapacity = capacity;
+    if ((full > 0) && (empty > 0)) {
+      uint64_t bytes = (queue->bitLength + 7) / 8;
+      if (queue->isSlotQueue) {
+        bytes = queue->slotBytes;
+      } else if (queue->isBatched) {
+        bytes = Architecture::getCacheLineBytes();
+      }
+      if ((capacity * 2 * bytes) <= cacheBytes) {
+        newCapacity = capacity * 2;
+      }
+    } else if (true && ((full > 0) || (empty > 0))
+               && (capacity > minimumQueueCapacity)) {
+      newCapacity = capacity / 2;
+    }
+    queue->capacity = newCapacity;
+
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "DSWP:  Queue " << i << " stalled " << full
+             << " times when full and " << empty
+             << " times when empty with " << capacity << " slots; it now has "
+             << newCapacity << " slots\n";
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,432 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Transforms/Utils/Local.h"
+#include "DSWP.hpp"
+
+namespace llvm::noelle {
+
+void DSWP::replicateStages(LoopDependenceInfo *LDI, Heuristics *h) {
+
+  /*
+   * By default, every stage runs on one core and every queue takes one slot
+   * of the queue array.
+   */
+  this->stageReplicas.assign(this->tasks.size(), 1);
+  this->numberOfQueueSlots = this->queues.size();
+
+  /*
+   * Check if the runtime can run replicas of stages.
+   */
+  if (false || (this->taskDispatcherWithReplicas == nullptr)
+      || (h == nullptr)) {
+    return;
+  }
+
+  /*
+   * Collect the information the heuristics need to size the replicas.
+   */
+  std::vector<std::set<SCC *>> stageSCCs;
+  std::vector<std::set<SCC *>> clonedSCCs;
+  std::vector<std::set<Value *>> poppedValues;
+  this->collectCostsOfStages(stageSCCs, clonedSCCs, poppedValues);
+  std::vector<bool> canBeReplicated;
+  auto isAnyStageReplicable = false;
+  for (auto techniqueTask : this->tasks) {
+    auto task = (DSWPTask *)techniqueTask;
+    auto isReplicable = this->canStageBeReplicated(LDI, task);
+    canBeReplicated.push_back(isReplicable);
+    isAnyStageReplicable |= isReplicable;
+  }
+  if (!isAnyStageReplicable) {
+    return;
+  }
+
+  /*
+   * Size the replicas.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  this->stageReplicas =
+      h->getReplicasOfDSWPStages(stageSCCs,
+                                 clonedSCCs,
+                                 poppedValues,
+                                 canBeReplicated,
+                                 ltm->getMaximumNumberOfCores(),
+                                 this->verbose);
+
+  /*
+   * A queue that connects two replicated stages would need a copy per pair of
+   * replicas. Hence, only the producer of such a queue is replicated.
+   */
+  for (auto &queue : this->queues) {
+    if (true && (this->stageReplicas[queue->fromStage] > 1)
+        && (this->stageReplicas[queue->toStage] > 1)) {
+      this->stageReplicas[queue->toStage] = 1;
+    }
+  }
+  auto isAnyStageReplicated = false;
+  for (auto i = 0u; i < this->stageReplicas.size(); i++) {
+    isAnyStageReplicated |= this->isReplicated(i);
+  }
+  if (!isAnyStageReplicated) {
+    return;
+  }
+
+  /*
+   * Assign the slots of the copies of the queues that connect replicated
+   * stages.
+   * Values packed into the slot of another queue travel with that queue.
+   */
+  for (auto &queue : this->queues) {
+    if (queue->packedInto != -1) {
+      continue;
+    }
+    auto replicas = std::max(this->stageReplicas[queue->fromStage],
+                             this->stageReplicas[queue->toStage]);
+    if (replicas == 1) {
+      continue;
+    }
+    queue->replicas = replicas;
+    queue->firstReplicaSlot = this->numberOfQueueSlots;
+    this->numberOfQueueSlots += replicas;
+  }
+
+  /*
+   * Add the slot that holds the ID of the replica.
+   */
+  this->numberOfQueueSlots++;
+
+  if (this->verbose != Verbosity::Disabled) {
+    for (auto i = 0u; i < this->stageReplicas.size(); i++) {
+      if (!this->isReplicated(i)) {
+        continue;
+      }
+      errs() << "DSWP:  Stage " << i << " has " << this->stageReplicas[i]
+             << " replicas\n";
+    }
+  }
+
+  return;
+}
+
+void DSWP::collectCostsOfStages(
+    std::vector<std::set<SCC *>> &stageSCCs,
+    std::vector<std::set<SCC *>> &clonedSCCs,
+    std::vector<std::set<Value *>> &poppedValues) const {
+  for (auto techniqueTask : this->tasks) {
+    auto task = (DSWPTask *)techniqueTask;
+    stageSCCs.push_back(task->stageSCCs);
+    clonedSCCs.push_back(task->clonableSCCs);
+    std::set<Value *> popped;
+    for (auto queueIndex : task->popValueQueues) {
+      popped.insert(this->queues[queueIndex]->producer);
+    }
+    poppedValues.push_back(popped);
+  }
+
+  return;
+}
+
+bool DSWP::canStageBeReplicated(LoopDependenceInfo *LDI,
+                                DSWPTask *task) const {
+
+  /*
+   * Fetch the SCCDAG.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto sccdag = sccManager->getSCCDAG();
+  auto loopCarriedSCCs = sccManager->getSCCsWithLoopCarriedDependencies();
+
+  for (auto scc : task->stageSCCs) {
+
+    /*
+     * The iterations of the stage must be independent.
+     */
+    auto sccInfo = sccManager->getSCCAttrs(scc);
+    if (false || (!sccInfo->canExecuteIndependently())
+        || (loopCarriedSCCs.count(scc) > 0)) {
+      return false;
+    }
+    for (auto edge : scc->getEdges()) {
+      if (edge->isLoopCarriedDependence()) {
+        return false;
+      }
+    }
+    auto sccNode = sccdag->fetchNode(scc);
+    for (auto sccEdge : sccNode->getIncomingEdges()) {
+      for (auto subEdge : sccEdge->getSubEdges()) {
+        if (subEdge->isLoopCarriedDependence()) {
+          return false;
+        }
+      }
+    }
+
+    /*
+     * The code executed by all replicas must not depend on the stage.
+     * Hence, the stage must not decide the control flow, and the SCCs cloned
+     * in the replicas must not use its values.
+     */
+    for (auto nodePair : scc->internalNodePairs()) {
+      auto inst = dyn_cast<Instruction>(nodePair.first);
+      if (false || (inst == nullptr) || inst->isTerminator()) {
+        return false;
+      }
+    }
+    for (auto sccEdge : sccNode->getOutgoingEdges()) {
+      auto toSCC = sccEdge->getIncomingT();
+      if (sccManager->getSCCAttrs(toSCC)->canBeCloned()) {
+        return false;
+      }
+      for (auto subEdge : sccEdge->getSubEdges()) {
+        if (subEdge->isLoopCarriedDependence()) {
+          return false;
+        }
+      }
+    }
+  }
+
+  /*
+   * Every replica computes the clonable SCCs sent through queues.
+   * Hence, the stage must neither send nor receive their values.
+   */
+  std::set<int> queueIndices(task->pushValueQueues.begin(),
+                             task->pushValueQueues.end());
+  queueIndices.insert(task->popValueQueues.begin(),
+                      task->popValueQueues.end());
+  for (auto queueIndex : queueIndices) {
+    auto producerSCC = sccdag->sccOfValue(this->queues[queueIndex]->producer);
+    if (this->sentClonableSCCs.count(producerSCC) > 0) {
+      return false;
+    }
+  }
+
+  /*
+   * The stage must not produce live-out values, which are produced by the
+   * last iteration only.
+   */
+  auto environment = LDI->getEnvironment();
+  for (auto envIndex : environment->getEnvIndicesOfLiveOutVars()) {
+    auto producer = environment->producerAt(envIndex);
+    auto producerSCC = sccdag->sccOfValue(producer);
+    if (task->stageSCCs.count(producerSCC) > 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool DSWP::isReplicated(int taskIndex) const {
+  if (taskIndex >= this->stageReplicas.size()) {
+    return false;
+  }
+
+  return this->stageReplicas[taskIndex] > 1;
+}
+
+bool DSWP::needsIterationCounter(int taskIndex) const {
+  if (this->isReplicated(taskIndex)) {
+    return true;
+  }
+
+  /*
+   * Check if the stage pops values pushed by a replicated stage.
+   */
+  auto task = (DSWPTask *)this->tasks[taskIndex];
+  for (auto queueIndex : task->popValueQueues) {
+    auto &queueInfo = this->queues[queueIndex];
+    if (true && (queueInfo->replicas > 1)
+        && this->isReplicated(queueInfo->fromStage)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void DSWP::createIterationCounter(LoopDependenceInfo *LDI, int taskIndex) {
+  auto task = (DSWPTask *)this->tasks[taskIndex];
+
+  /*
+   * Add the counter to the header of the loop.
+   * Its incoming values are added once the entry of the task branches to the
+   * header.
+   */
+  auto loopHeader = LDI->getLoopStructure()->getHeader();
+  auto header = task->getCloneOfOriginalBasicBlock(loopHeader);
+  IRBuilder<> builder(&*header->begin());
+  task->iterationCounter = builder.CreatePHI(this->noelle.int64, 2);
+
+  return;
+}
+
+void DSWP::completeIterationCounter(LoopDependenceInfo *LDI, int taskIndex) {
+  auto task = (DSWPTask *)this->tasks[taskIndex];
+  auto counter = task->iterationCounter;
+  auto header = counter->getParent();
+
+  /*
+   * The counter starts from 0 and it is incremented by the latches.
+   * A predecessor that branches to the header several times provides the same
+   * value for all its edges.
+   */
+  std::unordered_map<BasicBlock *, Value *> incomingValues;
+  for (auto pred : predecessors(header)) {
+    if (incomingValues.find(pred) == incomingValues.end()) {
+      if (pred == task->getEntry()) {
+        incomingValues[pred] = ConstantInt::get(this->noelle.int64, 0);
+      } else {
+        IRBuilder<> latchBuilder(pred->getTerminator());
+        incomingValues[pred] = latchBuilder.CreateAdd(
+            counter,
+            ConstantInt::get(this->noelle.int64, 1));
+      }
+    }
+    counter->addIncoming(incomingValues[pred], pred);
+  }
+
+  return;
+}
+
+void DSWP::executeOnlyIterationsOfReplica(LoopDependenceInfo *LDI,
+                                          int taskIndex) {
+  auto task = (DSWPTask *)this->tasks[taskIndex];
+  auto loopStructure = LDI->getLoopStructure();
+
+  /*
+   * Collect the payload of the stage.
+   * This is the code of its SCCs and the code that pushes the values they
+   * produce. The rest of the stage (i.e., its control flow, the clonable SCCs,
+   * and the pops) is executed by every replica in every iteration.
+   */
+  std::unordered_set<Instruction *> payload;
+  for (auto scc : task->stageSCCs) {
+    for (auto nodePair : scc->internalNodePairs()) {
+      auto inst = cast<Instruction>(nodePair.first);
+      auto clone = task->getCloneOfOriginalInstruction(inst);
+      if (clone == nullptr) {
+        continue;
+      }
+      payload.insert(clone);
+    }
+  }
+  payload.insert(task->pushInstructions.begin(), task->pushInstructions.end());
+
+  /*
+   * The payload is going to be moved to basic blocks executed only in the
+   * iterations of the replica. Hence, the values that flow across basic
+   * blocks go through the stack.
+   */
+  std::vector<PHINode *> phis;
+  for (auto inst : payload) {
+    if (auto phi = dyn_cast<PHINode>(inst)) {
+      phis.push_back(phi);
+    }
+  }
+  for (auto phi : phis) {
+    payload.erase(phi);
+    DemotePHIToStack(phi);
+  }
+  std::vector<Instruction *> valuesToDemote;
+  for (auto inst : payload) {
+    for (auto user : inst->users()) {
+      auto userInst = cast<Instruction>(user);
+      if (false || (userInst->getParent() != inst->getParent())
+          || isa<PHINode>(userInst)) {
+        valuesToDemote.push_back(inst);
+        break;
+      }
+    }
+  }
+  for (auto inst : valuesToDemote) {
+    DemoteRegToStack(*inst);
+  }
+
+  /*
+   * The stores added above are part of the payload.
+   */
+  std::queue<Instruction *> instsToCheck;
+  for (auto inst : payload) {
+    instsToCheck.push(inst);
+  }
+  while (!instsToCheck.empty()) {
+    auto inst = instsToCheck.front();
+    instsToCheck.pop();
+    for (auto user : inst->users()) {
+      auto userInst = cast<Instruction>(user);
+      if (payload.find(userInst) != payload.end()) {
+        continue;
+      }
+      assert(!userInst->isTerminator());
+      payload.insert(userInst);
+      instsToCheck.push(userInst);
+    }
+  }
+
+  /*
+   * Compute whether the current iteration belongs to the replica at the
+   * beginning of the iteration.
+   */
+  auto loopHeader = loopStructure->getHeader();
+  auto header = task->getCloneOfOriginalBasicBlock(loopHeader);
+  IRBuilder<> headerBuilder(header->getFirstNonPHI());
+  auto replicas =
+      ConstantInt::get(this->noelle.int64, this->stageReplicas[taskIndex]);
+  auto iterationOwner =
+      headerBuilder.CreateURem(task->iterationCounter, replicas);
+  auto isOwned = headerBuilder.CreateICmpEQ(iterationOwner, task->replicaID);
+
+  /*
+   * Move the payload of every basic block to a new one executed only if the
+   * iteration belongs to the replica.
+   */
+  std::vector<BasicBlock *> loopBlocks;
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    if (!task->isAnOriginalBasicBlock(bb)) {
+      continue;
+    }
+    loopBlocks.push_back(task->getCloneOfOriginalBasicBlock(bb));
+  }
+  for (auto bb : loopBlocks) {
+    std::vector<Instruction *> payloadOfBB;
+    for (auto &inst : *bb) {
+      if (payload.find(&inst) != payload.end()) {
+        payloadOfBB.push_back(&inst);
+      }
+    }
+    if (payloadOfBB.size() == 0) {
+      continue;
+    }
+    auto joinBB = bb->splitBasicBlock(bb->getTerminator());
+    auto payloadBB =
+        BasicBlock::Create(bb->getContext(), "", bb->getParent(), joinBB);
+    auto branchToJoin = BranchInst::Create(joinBB, payloadBB);
+    for (auto inst : payloadOfBB) {
+      inst->moveBefore(branchToJoin);
+    }
+    bb->getTerminator()->eraseFromParent();
+    BranchInst::Create(payloadBB, joinBB, isOwned, bb);
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -19,6 +19,9 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/Transforms/Utils/CallPromotionUtils.h"
+#include "noelle/core/Architecture.hpp"
 #include "EnablersManager.hpp"
 
 namespace llvm::noelle {
@@ -30,6 +33,97 @@ bool EnablersManager::applyEnablers(
     LoopInvariantCodeMotion &loopInvariantCodeMotion,
     SCEVSimplification &scevSimplification) {
 
+  /*
+   * Specialize loops for the values their trip counts have most of the time.
+   * This runs first because the trip counts of the specialized copies become
+   * known at compile time, which the other enablers can rely on.
+   */
+  if (par.isTransformationEnabled(Transformation::LOOP_SPECIALIZATION_ID)) {
+    errs() << "EnablersManager:     Try to specialize loops for hot values\n";
+    if (this->applyLoopSpecialization(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The loop has been specialized\n";
+      return true;
+    }
+  }
+
+  /*
+   * Peel the first and the last iterations when they are the only ones that
+   * take some paths of the loop (e.g., an initialization done when the IV is
+   * 0). This runs before the other enablers because it removes dependences
+   * that they would otherwise try to work around.
+   */
+  if (par.isTransformationEnabled(Transformation::ITERATION_PEELING_ID)) {
+    errs() << "EnablersManager:     Try to peel conditional iterations\n";
+    if (this->applyIterationPeeling(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       Iterations have been peeled\n";
+      return true;
+    }
+  }
+
+  /*
+   * Version loops whose pointers might overlap.
+   * This runs first because it removes dependences that loop distribution
+   * would otherwise pull out of the loop.
+   */
+  if (par.isTransformationEnabled(Transformation::LOOP_VERSIONING_ID)) {
+    errs() << "EnablersManager:     Try to version loops with alias checks\n";
+    if (this->applyLoopVersioning(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The loop has been versioned\n";
+      return true;
+    }
+  }
+
+  /*
+   * Interchange perfect loop nests whose inner loop walks memory with a
+   * larger stride than the outer one. This runs before the collapse and the
+   * tiling, which rely on the order of the loops of the nest.
+   */
+  if (par.isTransformationEnabled(Transformation::LOOP_INTERCHANGE_ID)) {
+    errs() << "EnablersManager:     Try to interchange loop nests\n";
+    if (this->applyLoopInterchange(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The loop nest has been interchanged\n";
+      return true;
+    }
+  }
+
+  /*
+   * Collapse perfect loop nests whose outer loop does not have enough
+   * iterations to keep all cores busy.
+   */
+  if (par.isTransformationEnabled(Transformation::LOOP_COLLAPSE_ID)) {
+    errs() << "EnablersManager:     Try to collapse loop nests\n";
+    if (this->applyLoopCollapse(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The loop nest has been collapsed\n";
+      return true;
+    }
+  }
+
+  /*
+   * Tile loop nests whose inner loops access more data than what fits in the
+   * cache. The loop that iterates over the tiles is the one to parallelize.
+   */
+  if (par.isTransformationEnabled(Transformation::LOOP_TILING_ID)) {
+    errs() << "EnablersManager:     Try to tile loop nests\n";
+    if (this->applyLoopTiling(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The loop nest has been tiled\n";
+      return true;
+    }
+  }
+
+  /*
+   * Give each iteration its own copy of the temporaries that the iterations
+   * reuse, when this makes the loop a DOALL. This runs before the loop
+   * distribution because it removes dependences that the latter would
+   * otherwise pull out of the loop.
+   */
+  if (par.isTransformationEnabled(Transformation::SCALAR_EXPANSION_ID)) {
+    errs() << "EnablersManager:     Try to expand temporaries\n";
+    if (this->applyScalarExpansion(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       Temporaries have been expanded\n";
+      return true;
+    }
+  }
+
   /*
    * Apply loop distribution.
    */
@@ -41,6 +135,20 @@ bool EnablersManager::applyEnablers(
     }
   }
 
+  /*
+   * Fuse adjacent loops that iterate over the same space.
+   * This runs after the loop distribution because the latter can produce
+   * loops that can be fused (e.g., the ones that do not include the SCCs that
+   * have been pulled out).
+   */
+  if (par.isTransformationEnabled(Transformation::LOOP_FUSION_ID)) {
+    errs() << "EnablersManager:     Try to fuse adjacent loops\n";
+    if (this->applyLoopFusion(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The loops have been fused\n";
+      return true;
+    }
+  }
+
   /*
    * Try to devirtualize functions.
    */
@@ -52,6 +160,21 @@ bool EnablersManager::applyEnablers(
     }
   }
 
+  /*
+   * Traverse linked lists in chunks of nodes, so the nodes of a chunk can be
+   * processed by a loop with a governing IV. This runs after the
+   * devirtualizer, which can remove the dependences between the traversal and
+   * the rest of the loop.
+   */
+  if (par.isTransformationEnabled(
+          Transformation::POINTER_CHASING_CHUNKING_ID)) {
+    errs() << "EnablersManager:     Try to traverse linked lists in chunks\n";
+    if (this->applyPointerChasingChunking(LDI, par, LoopTransformer)) {
+      errs() << "EnablersManager:       The list is traversed in chunks\n";
+      return true;
+    }
+  }
+
   /*
    * Run the whilifier.
    */
@@ -128,6 +251,168 @@ bool EnablersManager::applyLoopWhilifier(LoopDependenceInfo *LDI,
   return modified;
 }
 
+bool EnablersManager::applyLoopVersioning(LoopDependenceInfo *LDI,
+                                          Noelle &par,
+                                          LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Check if the loop has memory dependences carried between iterations.
+   * These are the only ones that a check on the pointers can remove.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto SCCDAG = sccManager->getSCCDAG();
+  auto hasMemoryLCDs = false;
+  SCCDAG->iterateOverSCCs(
+      [sccManager, &hasMemoryLCDs](SCC *currentSCC) -> bool {
+        sccManager->iterateOverLoopCarriedDataDependences(
+            currentSCC,
+            [&hasMemoryLCDs](DGEdge<Value> *dep) -> bool {
+              if (dep->isMemoryDependence()) {
+                hasMemoryLCDs = true;
+                return true;
+              }
+              return false;
+            });
+        return hasMemoryLCDs;
+      });
+  if (!hasMemoryLCDs) {
+    return false;
+  }
+
+  /*
+   * Version the loop
+   */
+  auto modified = LoopTransformer.versionLoopWithAliasChecks(LDI);
+
+  return modified;
+}
+
+bool EnablersManager::applyLoopSpecialization(
+    LoopDependenceInfo *LDI,
+    Noelle &par,
+    LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Check if the trip count of the loop is unknown at compile time only
+   * because of the values of its live-ins.
+   */
+  if (LDI->doesHaveCompileTimeKnownTripCount()) {
+    return false;
+  }
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  if (loopGoverningIVAttr == nullptr) {
+    return false;
+  }
+  auto valueProfiles = par.getLoopValueProfiles();
+  if (!valueProfiles->isAvailable()) {
+    return false;
+  }
+
+  /*
+   * Fetch the values that the bound and the start value of the
+   * loop-governing IV have most of the time.
+   * The specialization is worth it only if the hottest value of each of them
+   * occurs in at least half of the invocations of the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto &IV = loopGoverningIVAttr->getInductionVariable();
+  std::vector<std::pair<Value *, ConstantInt *>> values;
+  for (auto liveIn :
+       { loopGoverningIVAttr->getExitConditionValue(), IV.getStartValue() }) {
+    if (false || (liveIn == nullptr) || isa<Constant>(liveIn)) {
+      continue;
+    }
+    auto hotValues = valueProfiles->getHotValues(loopStructure, liveIn);
+    if (hotValues.size() == 0) {
+      return false;
+    }
+    auto invocations = valueProfiles->getInvocations(loopStructure, liveIn);
+    if ((hotValues[0].second * 2) < invocations) {
+      return false;
+    }
+    auto liveInType = cast<IntegerType>(liveIn->getType());
+    values.push_back(
+        { liveIn, ConstantInt::get(liveInType, hotValues[0].first, true) });
+  }
+  if (values.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Specialize the loop.
+   */
+  auto modified = LoopTransformer.specializeLoop(LDI, values);
+
+  return modified;
+}
+
+bool EnablersManager::applyLoopCollapse(LoopDependenceInfo *LDI,
+                                        Noelle &par,
+                                        LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Check if the loop includes a single loop, which includes no other loop.
+   */
+  auto loopNode = LDI->getLoopHierarchyStructures();
+  auto children = loopNode->getChildren();
+  if (children.size() != 1) {
+    return false;
+  }
+  auto innerNode = *children.begin();
+  if (innerNode->getChildren().size() > 0) {
+    return false;
+  }
+
+  /*
+   * Check if the loop has too few iterations to keep all cores busy.
+   * Each core should get several iterations; otherwise, the cores that get
+   * one more than the others dominate the execution time.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  auto minimumIterationsPerCore = 4;
+  auto minimumIterations =
+      ltm->getMaximumNumberOfCores() * minimumIterationsPerCore;
+  auto loopStructure = LDI->getLoopStructure();
+  double iterations = 0;
+  if (LDI->doesHaveCompileTimeKnownTripCount()) {
+    iterations = LDI->getCompileTimeTripCount();
+  } else {
+    auto hot = par.getProfiles();
+    if (!hot->isAvailable()) {
+      return false;
+    }
+    iterations = hot->getAverageLoopIterationsPerInvocation(loopStructure);
+  }
+  if (iterations >= minimumIterations) {
+    return false;
+  }
+
+  /*
+   * The collapsed loop can be parallelized only if the iterations of both
+   * loops are independent.
+   */
+  if (!this->areIterationsIndependent(LDI)) {
+    return false;
+  }
+  auto innerLDI = par.getLoop(innerNode->getLoop());
+  auto areInnerLoopIterationsIndependent =
+      this->areIterationsIndependent(innerLDI);
+  delete innerLDI;
+  if (!areInnerLoopIterationsIndependent) {
+    return false;
+  }
+
+  /*
+   * Collapse the loop nest.
+   */
+  auto modified = LoopTransformer.collapseLoopNest(LDI);
+
+  return modified;
+}
+
 bool EnablersManager::applyLoopDistribution(LoopDependenceInfo *LDI,
                                             Noelle &par,
                                             LoopTransformer &loopTransformer) {
@@ -177,6 +462,18 @@ bool EnablersManager::applyLoopDistribution(LoopDependenceInfo *LDI,
   };
   SCCDAG->iterateOverSCCs(collectSequentialSCCsFunction);
 
+  /*
+   * Try to bring all sequential SCCs outside the loop at once if the profiles
+   * suggest the rest of the loop is worth parallelizing.
+   */
+  if (true && this->profileGuidedDistribution
+      && this->applyProfileGuidedLoopDistribution(LDI,
+                                                  par,
+                                                  loopTransformer,
+                                                  sequentialSCCs)) {
+    return true;
+  }
+
   /*
    * Check every sequential SCC of the loop and decide which ones to bring
    * outside the loop to parallelize.
@@ -205,6 +502,63 @@ bool EnablersManager::applyLoopDistribution(LoopDependenceInfo *LDI,
   return false;
 }
 
+bool EnablersManager::applyProfileGuidedLoopDistribution(
+    LoopDependenceInfo *LDI,
+    Noelle &par,
+    LoopTransformer &loopTransformer,
+    std::set<SCC *> const &sequentialSCCs) {
+
+  /*
+   * Check if there is something to pull out.
+   */
+  if (sequentialSCCs.size() == 0) {
+    return false;
+  }
+
+  /*
+   * The decision relies on the profiles.
+   */
+  auto hot = par.getProfiles();
+  if (!hot->isAvailable()) {
+    return false;
+  }
+  auto ls = LDI->getLoopStructure();
+  auto loopInstructions = hot->getTotalInstructions(ls);
+  if (loopInstructions == 0) {
+    return false;
+  }
+
+  /*
+   * Compute how much of the loop the sequential SCCs execute.
+   * Pulling them out is worth it only if they are a small part of the loop, so
+   * the rest of it can be parallelized with DOALL.
+   */
+  uint64_t sequentialInstructions = 0;
+  for (auto sequentialSCC : sequentialSCCs) {
+    sequentialInstructions += hot->getTotalInstructions(sequentialSCC);
+  }
+  auto sequentialShare =
+      ((double)sequentialInstructions) / ((double)loopInstructions);
+  if (sequentialShare
+      > (((double)this->maximumSequentialShareToDistribute) / 100)) {
+    return false;
+  }
+
+  /*
+   * Pull all sequential SCCs into a separate loop that executes after the
+   * parallel one, forwarding the values they consume.
+   */
+  std::set<Instruction *> instsRemoved;
+  std::set<Instruction *> instsAdded;
+  auto splitted = loopTransformer.splitLoop(LDI,
+                                            sequentialSCCs,
+                                            instsRemoved,
+                                            instsAdded,
+                                            true);
+
+  return splitted;
+}
+
 bool EnablersManager::applyDevirtualizer(LoopDependenceInfo *LDI,
                                          Noelle &par,
                                          LoopTransformer &lt) {
@@ -288,16 +642,528 @@ bool EnablersManager::applyDevirtualizer(LoopDependenceInfo *LDI,
       }
     }
   }
-  if (!fullyUnroll) {
+  if (fullyUnroll) {
+
+    /*
+     * Fully unroll the loop.
+     */
+    auto modified = lt.fullyUnrollLoop(LDI);
+
+    return modified;
+  }
+
+  /*
+   * Promote the indirect calls of the loop to direct calls to the targets they
+   * invoke most of the time.
+   */
+  auto modified = this->promoteIndirectCallsToDominantTargets(LDI, par);
+
+  return modified;
+}
+
+bool EnablersManager::promoteIndirectCallsToDominantTargets(
+    LoopDependenceInfo *LDI,
+    Noelle &par) {
+
+  /*
+   * The targets of the indirect calls come from the profiles.
+   */
+  auto hot = par.getProfiles();
+  if (!hot->isAvailable()) {
     return false;
   }
 
   /*
-   * Fully unroll the loop.
+   * Collect the indirect calls of the loop.
    */
-  auto modified = lt.fullyUnrollLoop(LDI);
+  auto ls = LDI->getLoopStructure();
+  std::vector<CallInst *> indirectCalls;
+  for (auto bb : ls->getBasicBlocks()) {
+    for (auto &inst : *bb) {
+      auto callInst = dyn_cast<CallInst>(&inst);
+      if (false || (callInst == nullptr)
+          || (callInst->getCalledFunction() != nullptr)
+          || callInst->isInlineAsm()) {
+        continue;
+      }
+      indirectCalls.push_back(callInst);
+    }
+  }
+
+  /*
+   * Promote the dominant targets of each call.
+   * Each promoted target is invoked directly if the function pointer matches
+   * it; the indirect call is kept for the other targets.
+   */
+  auto modified = false;
+  MDBuilder mdBuilder(ls->getFunction()->getContext());
+  for (auto callInst : indirectCalls) {
+    auto targets = hot->getIndirectCallTargets(callInst);
+    uint64_t remainingCalls = 0;
+    for (auto &target : targets) {
+      remainingCalls += target.second;
+    }
+    auto promotedTargets = 0u;
+    for (auto &target : targets) {
+      if (false || (promotedTargets == this->maximumTargetsToPromote)
+          || ((target.second * 100)
+              < (remainingCalls * this->minimumShareOfTargetToPromote))) {
+        break;
+      }
+      if (!isLegalToPromote(CallSite(callInst), target.first)) {
+        continue;
+      }
+      errs() << "EnablersManager:       Promote the call to "
+             << target.first->getName() << " invoked " << target.second
+             << " out of " << remainingCalls << " times\n";
+      auto branchWeights =
+          mdBuilder.createBranchWeights(target.second,
+                                        remainingCalls - target.second);
+      promoteCallWithIfThenElse(CallSite(callInst),
+                                target.first,
+                                branchWeights);
+      remainingCalls -= target.second;
+      promotedTargets++;
+      modified = true;
+    }
+  }
 
   return modified;
 }
 
+bool EnablersManager::applyLoopInterchange(LoopDependenceInfo *LDI,
+                                           Noelle &par,
+                                           LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Check if the loop includes a single loop, which includes no other loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopNode = LDI->getLoopHierarchyStructures();
+  auto children = loopNode->getChildren();
+  if (children.size() != 1) {
+    return false;
+  }
+  auto innerNode = *children.begin();
+  if (innerNode->getChildren().size() > 0) {
+    return false;
+  }
+  auto innerLoopStructure = innerNode->getLoop();
+
+  /*
+   * Compute the strides of the memory accesses of the inner loop with respect
+   * to both loops of the nest.
+   * Strides that are not known at compile time (e.g., the size of the rows of
+   * an array allocated at run time) are assumed to be larger than a cache
+   * line.
+   */
+  auto function = loopStructure->getFunction();
+  auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*function).getSE();
+  uint64_t cacheLineBytes = Architecture::getCacheLineBytes();
+  auto getStride = [&SE,
+                    cacheLineBytes](const SCEV *pointerSCEV,
+                                    LoopStructure *ls) -> uint64_t {
+    auto addRec = dyn_cast<SCEVAddRecExpr>(pointerSCEV);
+    while (true && (addRec != nullptr)
+           && (addRec->getLoop()->getHeader() != ls->getHeader())) {
+      addRec = dyn_cast<SCEVAddRecExpr>(addRec->getStart());
+    }
+    if (addRec == nullptr) {
+      return 0;
+    }
+    auto step = dyn_cast<SCEVConstant>(addRec->getStepRecurrence(SE));
+    if (step == nullptr) {
+      return cacheLineBytes;
+    }
+    return step->getAPInt().abs().getLimitedValue();
+  };
+  uint32_t accessesToImprove = 0;
+  uint32_t accessesToWorsen = 0;
+  for (auto bb : innerLoopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      Value *pointer = nullptr;
+      if (auto loadInst = dyn_cast<LoadInst>(&I)) {
+        pointer = loadInst->getPointerOperand();
+      } else if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+        pointer = storeInst->getPointerOperand();
+      } else {
+        continue;
+      }
+      auto pointerSCEV = SE.getSCEV(pointer);
+      auto innerStride = getStride(pointerSCEV, innerLoopStructure);
+      auto outerStride = getStride(pointerSCEV, loopStructure);
+      if (true && (innerStride >= cacheLineBytes)
+          && (outerStride < cacheLineBytes)) {
+        accessesToImprove++;
+      } else if (true && (outerStride >= cacheLineBytes)
+                 && (innerStride < cacheLineBytes)) {
+        accessesToWorsen++;
+      }
+    }
+  }
+
+  /*
+   * Interchange the nest only if more accesses of the inner loop would move to
+   * consecutive locations than the ones that would stop doing so.
+   */
+  if (accessesToImprove <= accessesToWorsen) {
+    return false;
+  }
+
+  /*
+   * Check that the new order of the iterations respects the dependences of
+   * the nest.
+   * Every dependence carried by the outer loop must connect instances of the
+   * inner loop at its same iteration (i.e., its distance vector is (d, 0)).
+   * Dependences carried by the inner loop only become carried by the new
+   * outer loop, which is the one to parallelize. Hence, the iterations of the
+   * inner loop must be independent.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto LIDS = LDI->getLoopIterationDomainSpaceAnalysis();
+  if (LIDS == nullptr) {
+    return false;
+  }
+  auto isLegal = true;
+  sccManager->getSCCDAG()->iterateOverSCCs([sccManager,
+                                            LIDS,
+                                            innerLoopStructure,
+                                            &isLegal](SCC *scc) -> bool {
+    auto sccInfo = sccManager->getSCCAttrs(scc);
+    if (false || (!sccInfo->mustExecuteSequentially())
+        || sccInfo->canBeCloned()
+        || sccInfo->canBeClonedUsingLocalMemoryLocations()) {
+      return false;
+    }
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [LIDS, innerLoopStructure, &isLegal](DGEdge<Value> *dep) -> bool {
+          if (dep->isControlDependence()) {
+            return false;
+          }
+          auto fromInst = dyn_cast<Instruction>(dep->getOutgoingT());
+          auto toInst = dyn_cast<Instruction>(dep->getIncomingT());
+          int64_t distance = 0;
+          if (false || (!dep->isMemoryDependence()) || (fromInst == nullptr)
+              || (toInst == nullptr)
+              || (!LIDS->getDependenceDistanceBetweenIterations(
+                  fromInst,
+                  toInst,
+                  innerLoopStructure,
+                  distance))) {
+            isLegal = false;
+            return true;
+          }
+          return false;
+        });
+    return !isLegal;
+  });
+  if (!isLegal) {
+    return false;
+  }
+  auto innerLDI = par.getLoop(innerLoopStructure);
+  auto areInnerLoopIterationsIndependent =
+      this->areIterationsIndependent(innerLDI);
+  delete innerLDI;
+  if (!areInnerLoopIterationsIndependent) {
+    return false;
+  }
+
+  /*
+   * Interchange the loop nest.
+   */
+  auto modified = LoopTransformer.interchangeLoopNest(LDI);
+
+  return modified;
+}
+
+bool EnablersManager::applyLoopTiling(LoopDependenceInfo *LDI,
+                                      Noelle &par,
+                                      LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Check if the loop includes a single loop, which includes no other loop.
+   */
+  auto loopNode = LDI->getLoopHierarchyStructures();
+  auto children = loopNode->getChildren();
+  if (children.size() != 1) {
+    return false;
+  }
+  auto innerNode = *children.begin();
+  if (innerNode->getChildren().size() > 0) {
+    return false;
+  }
+  auto innerLoopStructure = innerNode->getLoop();
+
+  /*
+   * Compute the bytes accessed by an iteration of the inner loop.
+   */
+  auto &DL = par.getProgram()->getDataLayout();
+  uint64_t bytesPerIteration = 0;
+  uint64_t minimumAccessBytes = Architecture::getCacheLineBytes();
+  for (auto bb : innerLoopStructure->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      Type *accessedType = nullptr;
+      if (auto loadInst = dyn_cast<LoadInst>(&I)) {
+        accessedType = loadInst->getType();
+      } else if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+        accessedType = storeInst->getValueOperand()->getType();
+      } else {
+        continue;
+      }
+      uint64_t accessBytes = DL.getTypeStoreSize(accessedType);
+      bytesPerIteration += accessBytes;
+      minimumAccessBytes = std::min(minimumAccessBytes, accessBytes);
+    }
+  }
+  if (false || (bytesPerIteration == 0) || (minimumAccessBytes == 0)) {
+    return false;
+  }
+
+  /*
+   * Check if the data accessed by an invocation of the inner loop does not
+   * fit in the cache. In this case, the data reused by the next iteration of
+   * the outer loop has been evicted already.
+   */
+  auto innerLDI = par.getLoop(innerLoopStructure);
+  double innerIterations = 0;
+  if (innerLDI->doesHaveCompileTimeKnownTripCount()) {
+    innerIterations = innerLDI->getCompileTimeTripCount();
+  } else {
+    auto hot = par.getProfiles();
+    if (hot->isAvailable()) {
+      innerIterations =
+          hot->getAverageLoopIterationsPerInvocation(innerLoopStructure);
+    }
+  }
+  delete innerLDI;
+  auto innerBytes = innerIterations * bytesPerIteration;
+  if (innerBytes <= Architecture::getL2CacheBytes()) {
+    return false;
+  }
+
+  /*
+   * The tiling changes the order between the iterations of the outer loop
+   * and the ones of the inner loop. Hence, the iterations of the outer loop
+   * must be independent.
+   */
+  if (!this->areIterationsIndependent(LDI)) {
+    return false;
+  }
+
+  /*
+   * Compute the size of the tiles.
+   * The data accessed by a tile must fit in the L1 data cache, and each tile
+   * must access entire cache lines.
+   */
+  uint64_t iterationsPerCacheLine =
+      std::max((uint64_t)1,
+               Architecture::getCacheLineBytes() / minimumAccessBytes);
+  auto tileSize = Architecture::getL1DataCacheBytes() / bytesPerIteration;
+  tileSize = (tileSize / iterationsPerCacheLine) * iterationsPerCacheLine;
+  tileSize = std::max(tileSize, iterationsPerCacheLine);
+  if (tileSize >= innerIterations) {
+    return false;
+  }
+
+  /*
+   * Tile the loop nest.
+   */
+  auto modified = LoopTransformer.tileLoopNest(LDI, tileSize);
+
+  return modified;
+}
+
+bool EnablersManager::applyLoopFusion(LoopDependenceInfo *LDI,
+                                      Noelle &par,
+                                      LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Fetch the loop that starts right after the current one ends.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto exitBlocks = loopStructure->getLoopExitBasicBlocks();
+  if (exitBlocks.size() != 1) {
+    return false;
+  }
+  auto loopExit = exitBlocks[0];
+  auto loopsOfFunction = par.getLoopStructures(loopStructure->getFunction());
+  LoopStructure *nextLoopStructure = nullptr;
+  for (auto ls : *loopsOfFunction) {
+    if (ls->getPreHeader() == loopExit) {
+      nextLoopStructure = ls;
+      break;
+    }
+  }
+  delete loopsOfFunction;
+  if (nextLoopStructure == nullptr) {
+    return false;
+  }
+
+  /*
+   * The fused loop can be parallelized only if the iterations of both loops
+   * are independent.
+   * Loops that cannot be parallelized independently should not be fused:
+   * a sequential loop would serialize the parallel one.
+   */
+  if (!this->areIterationsIndependent(LDI)) {
+    return false;
+  }
+  auto nextLDI = par.getLoop(nextLoopStructure);
+  auto modified = false;
+  if (this->areIterationsIndependent(nextLDI)) {
+
+    /*
+     * Fuse the loops.
+     */
+    modified = LoopTransformer.fuseLoops(LDI, nextLDI);
+  }
+  delete nextLDI;
+
+  return modified;
+}
+
+bool EnablersManager::applyPointerChasingChunking(
+    LoopDependenceInfo *LDI,
+    Noelle &par,
+    LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Check if the loop already has a governing IV.
+   */
+  if (LDI->getLoopGoverningIVAttribution() != nullptr) {
+    return false;
+  }
+
+  /*
+   * Fetch the node the loop visits, which is the PHI of the header that the
+   * exit condition compares with null.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto header = loopStructure->getHeader();
+  auto headerBr = dyn_cast<BranchInst>(header->getTerminator());
+  if (false || (headerBr == nullptr) || (!headerBr->isConditional())) {
+    return false;
+  }
+  auto cmpInst = dyn_cast<ICmpInst>(headerBr->getCondition());
+  if (cmpInst == nullptr) {
+    return false;
+  }
+  PHINode *nodePHI = nullptr;
+  for (auto op : cmpInst->operand_values()) {
+    auto phi = dyn_cast<PHINode>(op);
+    if (true && (phi != nullptr) && (phi->getParent() == header)
+        && phi->getType()->isPointerTy()) {
+      nodePHI = phi;
+    }
+  }
+  if (nodePHI == nullptr) {
+    return false;
+  }
+
+  /*
+   * Chunking the traversal pays off only if the traversal is the only code
+   * that the iterations of the loop must execute in order.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto domainSpaceAnalysis = LDI->getLoopIterationDomainSpaceAnalysis();
+  auto independent = true;
+  sccManager->getSCCDAG()->iterateOverSCCs(
+      [sccManager, domainSpaceAnalysis, nodePHI, &independent](
+          SCC *scc) -> bool {
+        auto sccInfo = sccManager->getSCCAttrs(scc);
+        if (false || (!sccInfo->mustExecuteSequentially())
+            || sccInfo->canBeCloned()
+            || sccInfo->canBeClonedUsingLocalMemoryLocations()
+            || scc->isInternal(nodePHI)) {
+          return false;
+        }
+        sccManager->iterateOverLoopCarriedDataDependences(
+            scc,
+            [domainSpaceAnalysis, &independent](DGEdge<Value> *dep) -> bool {
+              if (dep->isControlDependence()) {
+                return false;
+              }
+              auto fromInst = dyn_cast<Instruction>(dep->getOutgoingT());
+              auto toInst = dyn_cast<Instruction>(dep->getIncomingT());
+              if (false || (!dep->isMemoryDependence())
+                  || (fromInst == nullptr) || (toInst == nullptr)
+                  || (domainSpaceAnalysis == nullptr)
+                  || (!domainSpaceAnalysis
+                           ->areInstructionsAccessingDisjointMemoryLocationsBetweenIterations(
+                               fromInst,
+                               toInst))) {
+                independent = false;
+                return true;
+              }
+              return false;
+            });
+        return !independent;
+      });
+  if (!independent) {
+    return false;
+  }
+
+  /*
+   * Each chunk gives a few nodes to every core.
+   */
+  auto chunkSize = Architecture::getNumberOfLogicalCores() * 64;
+
+  /*
+   * Chunk the traversal of the list.
+   * The parallelizer collects the nodes of the next chunk while the tasks
+   * process the current one.
+   */
+  auto modified = LoopTransformer.chunkPointerChasingLoop(LDI, chunkSize);
+
+  return modified;
+}
+
+bool EnablersManager::areIterationsIndependent(LoopDependenceInfo *LDI) {
+
+  /*
+   * Check every SCC that must execute sequentially.
+   * Dependences through memory are ignored if the domain space analysis
+   * proves that they access disjoint locations in different iterations.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto domainSpaceAnalysis = LDI->getLoopIterationDomainSpaceAnalysis();
+  auto independent = true;
+  sccManager->getSCCDAG()->iterateOverSCCs(
+      [sccManager, domainSpaceAnalysis, &independent](SCC *scc) -> bool {
+        auto sccInfo = sccManager->getSCCAttrs(scc);
+        if (false || (!sccInfo->mustExecuteSequentially())
+            || sccInfo->canBeCloned()
+            || sccInfo->canBeClonedUsingLocalMemoryLocations()) {
+          return false;
+        }
+        sccManager->iterateOverLoopCarriedDataDependences(
+            scc,
+            [domainSpaceAnalysis, &independent](DGEdge<Value> *dep) -> bool {
+              if (dep->isControlDependence()) {
+                return false;
+              }
+              auto fromInst = dyn_cast<Instruction>(dep->getOutgoingT());
+              auto toInst = dyn_cast<Instruction>(dep->getIncomingT());
+              if (false || (!dep->isMemoryDependence())
+                  || (fromInst == nullptr) || (toInst == nullptr)
+                  || (!domainSpaceAnalysis
+                           ->areInstructionsAccessingDisjointMemoryLocationsBetweenIterations(
+                               fromInst,
+                               toInst))) {
+                independent = false;
+                return true;
+              }
+              return false;
+            });
+        return !independent;
+      });
+
+  return independent;
+}
+
 } // namespace llvm::noelle
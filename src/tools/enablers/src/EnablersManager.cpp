@@ -20,6 +20,8 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/Noelle.hpp"
+#include "llvm/Support/MD5.h"
+#include "llvm/Transforms/Utils.h"
 #include "EnablersManager.hpp"
 
 namespace llvm::noelle {
@@ -48,9 +50,21 @@ bool EnablersManager::runOnModule(Module &M) {
    * Create the enablers.
    */
   auto &loopTransformer = noelle.getLoopTransformer();
-  auto loopInvariantCodeMotion = LoopInvariantCodeMotion(noelle);
+  auto loopInvariantCodeMotion =
+      LoopInvariantCodeMotion(noelle, this->promoteAcrossLoopNests);
   auto scevSimplification = SCEVSimplification(noelle);
 
+  /*
+   * Change the layout of the data accessed by the hot loops.
+   * This runs first because it changes the memory accesses of every function
+   * that uses the data.
+   */
+  auto modified = false;
+  if (noelle.isTransformationEnabled(Transformation::STRUCTURE_SPLITTING_ID)) {
+    errs() << "EnablersManager:   Try to split arrays of structures\n";
+    modified |= this->splitArraysOfStructures(M, noelle);
+  }
+
   /*
    * Fetch all the loops we want to parallelize.
    */
@@ -76,33 +90,139 @@ bool EnablersManager::runOnModule(Module &M) {
   auto forest = noelle.organizeLoopsInTheirNestingForest(*loopsToParallelize);
 
   /*
-   * Fetch the trees.
+   * Sort the trees by hotness
    */
   auto trees = forest->getTrees();
+  auto sortedTrees = noelle.sortByHotness(trees);
 
   /*
-   * Sort the trees by hotness
+   * Order the functions by the hottest loop they include.
+   */
+  std::vector<Function *> functions;
+  std::unordered_set<Function *> functionsIncluded;
+  for (auto tree : sortedTrees) {
+    auto f = tree->getLoop()->getFunction();
+    if (functionsIncluded.insert(f).second) {
+      functions.push_back(f);
+    }
+  }
+
+  /*
+   * Free the memory.
    */
+  delete forest;
+  delete loopsToParallelize;
+
+  /*
+   * Transform the loops of one function at a time until they cannot be
+   * improved anymore.
+   * After a loop has been modified, only the dependences of its function are
+   * recomputed before trying again.
+   *
+   * When the fixed point is computed in this invocation, the function is also
+   * normalized after every modification, and the function has converged when
+   * its code did not change.
+   * The analyses of the other functions (e.g., their dependences, the call
+   * graph, and the results of SVF) are reused across rounds.
+   */
+  for (auto f : functions) {
+    errs() << "EnablersManager:   Function \"" << f->getName() << "\"\n";
+    uint32_t round = 0;
+    auto functionHash = this->computeFixedPoint ? this->hashFunction(f) : "";
+    while (true) {
+      if (round == this->maximumRoundsPerFunction) {
+        errs() << "EnablersManager:     The function has been modified "
+               << round
+               << " times, so its remaining loops will be improved by the "
+                  "next invocation\n";
+        break;
+      }
+      hot->snapshotProfiles(f);
+      auto modifiedFunction =
+          this->improveLoopsOfFunction(f,
+                                       noelle,
+                                       loopTransformer,
+                                       loopInvariantCodeMotion,
+                                       scevSimplification,
+                                       round > 0);
+      if (!modifiedFunction) {
+        break;
+      }
+      modified = true;
+      round++;
+
+      /*
+       * Refresh the dependences of the function modified.
+       */
+      if (this->computeFixedPoint) {
+        this->normalizeFunction(f);
+      }
+      noelle.refreshDependences(f);
+
+      /*
+       * Carry the profiles of the function through its modification, so the
+       * next round still knows which loops are hot.
+       */
+      hot->remapProfiles(f);
+
+      /*
+       * Check if the code of the function has changed.
+       */
+      if (this->computeFixedPoint) {
+        auto newFunctionHash = this->hashFunction(f);
+        if (newFunctionHash == functionHash) {
+          errs() << "EnablersManager:     The code of the function did not "
+                    "change, so it reached its fixed point\n";
+          break;
+        }
+        functionHash = newFunctionHash;
+      }
+    }
+  }
+
+  errs() << "EnablersManager: Exit\n";
+  return modified;
+}
+
+bool EnablersManager::improveLoopsOfFunction(
+    Function *f,
+    Noelle &noelle,
+    LoopTransformer &loopTransformer,
+    LoopInvariantCodeMotion &loopInvariantCodeMotion,
+    SCEVSimplification &scevSimplification,
+    bool functionHasBeenModified) {
+
+  /*
+   * Fetch the loops of the function that have been executed.
+   */
+  auto loops = noelle.getLoopStructures(f);
+  auto hot = noelle.getProfiles();
+  auto filter = [hot](LoopStructure *l) -> bool {
+    if (!hot->hasBeenExecuted(l)) {
+      return true;
+    }
+    return false;
+  };
+  noelle.filterOutLoops(*loops, filter);
+  auto forest = noelle.organizeLoopsInTheirNestingForest(*loops);
+  auto trees = forest->getTrees();
   auto sortedTrees = noelle.sortByHotness(trees);
 
   /*
-   * Transform the loops selected.
+   * Improve the loops starting from the leafs of the hottest tree.
+   * The loop structures describe the code before any transformation, so we
+   * stop at the first loop modified.
    */
   auto modified = false;
-  std::unordered_map<Function *, bool> modifiedFunctions;
   for (auto tree : sortedTrees) {
-
-    /*
-     * Parallelize all loops within this tree starting from the leafs.
-     */
-    auto f = [&loopTransformer,
-              &loopInvariantCodeMotion,
-              &scevSimplification,
-              &noelle,
-              &modifiedFunctions,
-              this,
-              &modified](StayConnectedNestedLoopForestNode *n,
-                         uint32_t l) -> bool {
+    auto improveLoop = [&loopTransformer,
+                        &loopInvariantCodeMotion,
+                        &scevSimplification,
+                        &noelle,
+                        functionHasBeenModified,
+                        this,
+                        &modified](StayConnectedNestedLoopForestNode *n,
+                                   uint32_t l) -> bool {
       /*
        * Fetch the loop
        */
@@ -120,17 +240,14 @@ bool EnablersManager::runOnModule(Module &M) {
              << *loopStructure->getHeader()->getFirstNonPHI() << "\n";
 
       /*
-       * Fetch the function that contains the current loop.
-       */
-      auto f = loopStructure->getFunction();
-
-      /*
-       * Check if we have already modified the function.
+       * Unless the fixed point is computed in this invocation, the code is
+       * normalized only between invocations.
+       * Hence, loops that a previous transformation left without a pre-header
+       * are improved by the next invocation.
        */
-      if (modifiedFunctions[f]) {
-        errs()
-            << "EnablersManager:     The current loop belongs to the function "
-            << f->getName() << " , which has already been modified.\n";
+      if (true && functionHasBeenModified && (!this->computeFixedPoint)
+          && (loopStructure->getPreHeader() == nullptr)) {
+        errs() << "EnablersManager:     The loop is not normalized anymore\n";
         return false;
       }
 
@@ -142,25 +259,57 @@ bool EnablersManager::runOnModule(Module &M) {
       /*
        * Improve the current loop.
        */
-      modifiedFunctions[f] |= this->applyEnablers(&*loopToImprove,
-                                                  noelle,
-                                                  loopTransformer,
-                                                  loopInvariantCodeMotion,
-                                                  scevSimplification);
-      modified |= modifiedFunctions[f];
-
-      return false;
+      modified = this->applyEnablers(&*loopToImprove,
+                                     noelle,
+                                     loopTransformer,
+                                     loopInvariantCodeMotion,
+                                     scevSimplification);
+
+      return modified;
     };
-    tree->visitPostOrder(f);
+    if (tree->visitPostOrder(improveLoop)) {
+      break;
+    }
   }
 
   /*
    * Free the memory.
    */
-  delete loopsToParallelize;
+  delete forest;
+  delete loops;
 
-  errs() << "EnablersManager: Exit\n";
   return modified;
 }
 
+void EnablersManager::normalizeFunction(Function *f) {
+
+  /*
+   * Restore the shape of the loops that the enablers rely on (see
+   * noelle-norm).
+   */
+  legacy::FunctionPassManager normalization(f->getParent());
+  normalization.add(createBreakCriticalEdgesPass());
+  normalization.add(createLoopSimplifyPass());
+  normalization.add(createLCSSAPass());
+  normalization.doInitialization();
+  normalization.run(*f);
+  normalization.doFinalization();
+
+  return;
+}
+
+std::string EnablersManager::hashFunction(Function *f) {
+  std::string code;
+  raw_string_ostream stream(code);
+  f->print(stream);
+  stream.flush();
+
+  MD5 hasher;
+  hasher.update(code);
+  MD5::MD5Result result;
+  hasher.final(result);
+
+  return std::string(result.digest().str());
+}
+
 } // namespace llvm::noelle
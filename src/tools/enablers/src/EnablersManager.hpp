@@ -47,6 +47,14 @@ private:
    * Fields
    */
   bool enableEnablers;
+  uint32_t maximumRoundsPerFunction;
+  bool computeFixedPoint;
+  bool promoteAcrossLoopNests;
+  bool profileGuidedDistribution;
+  uint32_t maximumSequentialShareToDistribute;
+  uint32_t minimumShareOfTargetToPromote;
+  uint32_t maximumTargetsToPromote;
+  uint32_t maximumBytesToExpand;
 
   /*
    * Methods
@@ -54,6 +62,17 @@ private:
   std::vector<LoopDependenceInfo *> getLoopsToParallelize(Module &M,
                                                           Noelle &par);
 
+  bool improveLoopsOfFunction(Function *f,
+                              Noelle &par,
+                              LoopTransformer &LoopTransformer,
+                              LoopInvariantCodeMotion &loopInvariantCodeMotion,
+                              SCEVSimplification &scevSimplification,
+                              bool functionHasBeenModified);
+
+  void normalizeFunction(Function *f);
+
+  std::string hashFunction(Function *f);
+
   bool applyEnablers(LoopDependenceInfo *LDI,
                      Noelle &par,
                      LoopTransformer &LoopTransformer,
@@ -68,9 +87,62 @@ private:
                              Noelle &par,
                              LoopTransformer &LoopTransformer);
 
+  bool applyProfileGuidedLoopDistribution(
+      LoopDependenceInfo *LDI,
+      Noelle &par,
+      LoopTransformer &LoopTransformer,
+      std::set<SCC *> const &sequentialSCCs);
+
+  bool applyLoopVersioning(LoopDependenceInfo *LDI,
+                           Noelle &par,
+                           LoopTransformer &LoopTransformer);
+
+  bool applyLoopSpecialization(LoopDependenceInfo *LDI,
+                               Noelle &par,
+                               LoopTransformer &LoopTransformer);
+
+  bool applyLoopCollapse(LoopDependenceInfo *LDI,
+                         Noelle &par,
+                         LoopTransformer &LoopTransformer);
+
+  bool applyLoopInterchange(LoopDependenceInfo *LDI,
+                            Noelle &par,
+                            LoopTransformer &LoopTransformer);
+
+  bool applyLoopTiling(LoopDependenceInfo *LDI,
+                       Noelle &par,
+                       LoopTransformer &LoopTransformer);
+
+  bool applyLoopFusion(LoopDependenceInfo *LDI,
+                       Noelle &par,
+                       LoopTransformer &LoopTransformer);
+
+  bool applyPointerChasingChunking(LoopDependenceInfo *LDI,
+                                   Noelle &par,
+                                   LoopTransformer &LoopTransformer);
+
+  bool applyScalarExpansion(LoopDependenceInfo *LDI,
+                            Noelle &par,
+                            LoopTransformer &LoopTransformer);
+
+  bool applyIterationPeeling(LoopDependenceInfo *LDI,
+                             Noelle &par,
+                             LoopTransformer &LoopTransformer);
+
   bool applyDevirtualizer(LoopDependenceInfo *LDI,
                           Noelle &par,
                           LoopTransformer &lt);
+
+  bool promoteIndirectCallsToDominantTargets(LoopDependenceInfo *LDI,
+                                             Noelle &par);
+
+  bool areIterationsIndependent(LoopDependenceInfo *LDI);
+
+  /*
+   * Split the arrays of structures whose fields are accessed separately by
+   * the hot loops into one array per field.
+   */
+  bool splitArraysOfStructures(Module &M, Noelle &par);
 };
 
 } // namespace llvm::noelle
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "EnablersManager.hpp"
+
+namespace llvm::noelle {
+
+bool EnablersManager::applyIterationPeeling(LoopDependenceInfo *LDI,
+                                            Noelle &par,
+                                            LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Fetch the branches that take one of their paths only in the first or in
+   * the last iteration of the loop.
+   */
+  std::set<BranchInst *> firstIterationBranches;
+  std::set<BranchInst *> lastIterationBranches;
+  LoopTransformer.fetchBranchesOfConditionalIterations(LDI,
+                                                       firstIterationBranches,
+                                                       lastIterationBranches);
+  if (true && (firstIterationBranches.size() == 0)
+      && (lastIterationBranches.size() == 0)) {
+    return false;
+  }
+
+  /*
+   * Fetch the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopFunction = loopStructure->getFunction();
+  auto sccManager = LDI->getSCCManager();
+  auto sccdag = sccManager->getSCCDAG();
+
+  /*
+   * Define the code that checks whether an instruction belongs to an SCC
+   * that keeps the iterations of the loop from running in parallel.
+   */
+  auto isSequential = [sccManager, sccdag](Instruction *inst) -> bool {
+    auto scc = sccdag->sccOfValue(inst);
+    if (scc == nullptr) {
+      return false;
+    }
+    auto sccInfo = sccManager->getSCCAttrs(scc);
+    return true && sccInfo->mustExecuteSequentially()
+           && (!sccInfo->canBeCloned())
+           && (!sccInfo->canBeClonedUsingLocalMemoryLocations());
+  };
+
+  /*
+   * Peeling an iteration is worth it only if the branch, or the code that
+   * runs only when the branch takes its conditional path, is included in a
+   * sequential SCC (e.g., an initialization done in the first iteration that
+   * creates loop-carried dependences).
+   */
+  auto DS = par.getDominators(loopFunction);
+  auto loopBlocks = loopStructure->getBasicBlocks();
+  auto isWorthIt = [&isSequential, DS, &loopBlocks](BranchInst *branch)
+      -> bool {
+    if (isSequential(branch)) {
+      return true;
+    }
+    auto cmpInst = cast<ICmpInst>(branch->getCondition());
+    auto isConditionTrue = (cmpInst->getPredicate() == ICmpInst::ICMP_EQ);
+    auto conditionalPath = branch->getSuccessor(isConditionTrue ? 0 : 1);
+    if (conditionalPath->getSinglePredecessor() != branch->getParent()) {
+      return false;
+    }
+    for (auto bb : loopBlocks) {
+      if (!DS->DT.dominates(conditionalPath, bb)) {
+        continue;
+      }
+      for (auto &inst : *bb) {
+        if (isSequential(&inst)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+  for (auto branches : { &firstIterationBranches, &lastIterationBranches }) {
+    for (auto it = branches->begin(); it != branches->end();) {
+      if (isWorthIt(*it)) {
+        it++;
+      } else {
+        it = branches->erase(it);
+      }
+    }
+  }
+  delete DS;
+  if (true && (firstIterationBranches.size() == 0)
+      && (lastIterationBranches.size() == 0)) {
+    return false;
+  }
+
+  /*
+   * Peel the iterations.
+   * The dependences of the loop that runs the remaining iterations are
+   * computed again by the next round of the enablers.
+   */
+  auto modified =
+      LoopTransformer.peelConditionalIterations(LDI,
+                                                firstIterationBranches,
+                                                lastIterationBranches);
+
+  return modified;
+}
+
+} // namespace llvm::noelle
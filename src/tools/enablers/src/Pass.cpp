@@ -28,10 +28,83 @@ static cl::opt<bool> DisableEnablers("noelle-disable-enablers",
                                      cl::ZeroOrMore,
                                      cl::Hidden,
                                      cl::desc("Disable all enablers"));
+static cl::opt<bool> ComputeFixedPoint(
+    "noelle-enablers-fixedpoint",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Run the enablers until the code does not change within this invocation"));
+static cl::opt<int> MaximumRoundsPerFunction(
+    "noelle-enablers-max-rounds",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Maximum number of times the loops of a function are modified per invocation (default: 100)"));
+static cl::opt<bool> PromoteAcrossLoopNests(
+    "noelle-enablers-nest-promotion",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Promote memory locations to registers in the outermost loop of their nest where this is legal"));
+static cl::opt<bool> ProfileGuidedDistribution(
+    "noelle-enablers-distribution-profile",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Use the profiles to pull all sequential SCCs of a loop into a separate loop, forwarding the values they need"));
+static cl::opt<int> MaximumSequentialShareToDistribute(
+    "noelle-enablers-distribution-max-sequential",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Maximum percentage of the instructions of a loop that its sequential SCCs can execute for them to be pulled out by the profile-guided distribution (default: 20)"));
+static cl::opt<int> MinimumShareOfTargetToPromote(
+    "noelle-enablers-devirtualizer-min-share",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Minimum percentage of the invocations of an indirect call that a target must have to be promoted to a direct call (default: 40)"));
+static cl::opt<int> MaximumTargetsToPromote(
+    "noelle-enablers-devirtualizer-max-targets",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Maximum number of targets of an indirect call to promote to direct calls (default: 2)"));
+static cl::opt<int> MaximumBytesToExpand(
+    "noelle-enablers-expansion-max-bytes",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Maximum number of bytes the per-iteration copies of the temporaries of a loop can take (default: 1048576)"));
 
 bool EnablersManager::doInitialization(Module &M) {
   this->enableEnablers =
       (DisableEnablers.getNumOccurrences() == 0) ? true : false;
+  this->computeFixedPoint =
+      (ComputeFixedPoint.getNumOccurrences() > 0) ? true : false;
+  this->maximumRoundsPerFunction =
+      (MaximumRoundsPerFunction.getNumOccurrences() > 0)
+          ? MaximumRoundsPerFunction.getValue()
+          : 100;
+  this->promoteAcrossLoopNests =
+      (PromoteAcrossLoopNests.getNumOccurrences() > 0) ? true : false;
+  this->profileGuidedDistribution =
+      (ProfileGuidedDistribution.getNumOccurrences() > 0) ? true : false;
+  this->maximumSequentialShareToDistribute =
+      (MaximumSequentialShareToDistribute.getNumOccurrences() > 0)
+          ? MaximumSequentialShareToDistribute.getValue()
+          : 20;
+  this->minimumShareOfTargetToPromote =
+      (MinimumShareOfTargetToPromote.getNumOccurrences() > 0)
+          ? MinimumShareOfTargetToPromote.getValue()
+          : 40;
+  this->maximumTargetsToPromote =
+      (MaximumTargetsToPromote.getNumOccurrences() > 0)
+          ? MaximumTargetsToPromote.getValue()
+          : 2;
+  this->maximumBytesToExpand = (MaximumBytesToExpand.getNumOccurrences() > 0)
+                                   ? MaximumBytesToExpand.getValue()
+                                   : (1 << 20);
 
   return false;
 }
@@ -0,0 +1,372 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "EnablersManager.hpp"
+#include "DOALL.hpp"
+
+namespace llvm::noelle {
+
+bool EnablersManager::applyScalarExpansion(LoopDependenceInfo *LDI,
+                                           Noelle &par,
+                                           LoopTransformer &LoopTransformer) {
+  assert(LDI != nullptr);
+
+  /*
+   * Fetch the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopFunction = loopStructure->getFunction();
+  auto &DL = loopFunction->getParent()->getDataLayout();
+
+  /*
+   * Define the code that fetches the temporary a pointer points to.
+   * The temporary is either an alloca of the entry block or a global variable
+   * visible only within the module.
+   * The pointer can only be computed by casting the temporary, or by adding
+   * constant offsets to it.
+   */
+  std::function<Value *(Value *)> getTemporary;
+  getTemporary = [&getTemporary, loopFunction](Value *pointer) -> Value * {
+    if (auto allocaInst = dyn_cast<AllocaInst>(pointer)) {
+      if (false || (!allocaInst->isStaticAlloca())
+          || allocaInst->isArrayAllocation()
+          || (allocaInst->getParent() != &loopFunction->getEntryBlock())) {
+        return nullptr;
+      }
+      return allocaInst;
+    }
+    if (auto g = dyn_cast<GlobalVariable>(pointer)) {
+      if (false || (!g->hasLocalLinkage()) || g->isConstant()
+          || g->isThreadLocal() || (!g->hasInitializer())) {
+        return nullptr;
+      }
+      return g;
+    }
+    if (auto castPointer = dyn_cast<BitCastOperator>(pointer)) {
+      return getTemporary(castPointer->getOperand(0));
+    }
+    if (auto gep = dyn_cast<GEPOperator>(pointer)) {
+      if (!gep->hasAllConstantIndices()) {
+        return nullptr;
+      }
+      return getTemporary(gep->getPointerOperand());
+    }
+    return nullptr;
+  };
+
+  /*
+   * Define the code that fetches the pointers an instruction accesses.
+   * Only loads, stores, and memory intrinsics are considered: calls can
+   * access memory other than their arguments.
+   */
+  auto getAccessedPointers = [](Instruction *inst) -> std::vector<Value *> {
+    if (auto loadInst = dyn_cast<LoadInst>(inst)) {
+      return { loadInst->getPointerOperand() };
+    }
+    if (auto storeInst = dyn_cast<StoreInst>(inst)) {
+      return { storeInst->getPointerOperand() };
+    }
+    if (auto memTransfer = dyn_cast<MemTransferInst>(inst)) {
+      return { memTransfer->getRawDest(), memTransfer->getRawSource() };
+    }
+    if (auto memIntrinsic = dyn_cast<MemIntrinsic>(inst)) {
+      return { memIntrinsic->getRawDest() };
+    }
+    return {};
+  };
+
+  /*
+   * The temporaries are expanded only if this makes the loop a DOALL, so the
+   * other conditions of DOALL must hold already.
+   */
+  std::string reason;
+  auto sccManager = LDI->getSCCManager();
+  if (false || (!DOALL::canBeAppliedToLoopStructure(loopStructure, reason))
+      || (LDI->getLoopGoverningIVAttribution() == nullptr)
+      || (!sccManager->areAllLiveOutValuesReducable(LDI->getEnvironment()))) {
+    return false;
+  }
+
+  /*
+   * Fetch the loop-carried data dependences of the SCCs that block DOALL.
+   * The SCCs DOALL can handle by itself are left to it.
+   * For example, DOALL clones the allocas it can within each task, which
+   * takes one copy per core rather than one per iteration.
+   */
+  auto blockingSCCs = DOALL::getSCCsThatBlockDOALLToBeApplicable(LDI, par);
+  if (blockingSCCs.size() == 0) {
+    return false;
+  }
+  std::vector<std::pair<Instruction *, Instruction *>> blockingDependences;
+  auto isDependenceRemovable = true;
+  for (auto scc : blockingSCCs) {
+    sccManager->iterateOverLoopCarriedDataDependences(
+        scc,
+        [&blockingDependences,
+         &isDependenceRemovable](DGEdge<Value> *dep) -> bool {
+          if (dep->isControlDependence()) {
+            return false;
+          }
+          auto fromInst = dyn_cast<Instruction>(dep->getOutgoingT());
+          auto toInst = dyn_cast<Instruction>(dep->getIncomingT());
+          if (false || (!dep->isMemoryDependence()) || (fromInst == nullptr)
+              || (toInst == nullptr)) {
+            isDependenceRemovable = false;
+            return true;
+          }
+          blockingDependences.push_back(std::make_pair(fromInst, toInst));
+          return false;
+        });
+    if (!isDependenceRemovable) {
+      return false;
+    }
+  }
+
+  /*
+   * Fetch the temporaries accessed by the blocking dependences.
+   * These temporaries are the ones that we want to expand.
+   */
+  std::unordered_set<Value *> candidates;
+  for (auto &dep : blockingDependences) {
+    for (auto inst : { dep.first, dep.second }) {
+      auto pointers = getAccessedPointers(inst);
+      if (pointers.size() == 0) {
+        return false;
+      }
+      for (auto pointer : pointers) {
+        auto temporary = getTemporary(pointer);
+        if (temporary == nullptr) {
+          return false;
+        }
+        candidates.insert(temporary);
+      }
+    }
+  }
+  if (candidates.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Each iteration gets its own copy of the temporaries expanded.
+   * Hence, the copies can fit in memory only if the temporaries are small
+   * or if the number of iterations is known.
+   * The loop falls back to its original code when, at run time, the copies
+   * take more than the bytes allowed.
+   */
+  uint64_t maximumBytes = 64;
+  if (LDI->doesHaveCompileTimeKnownTripCount()) {
+    auto tripCount = std::max<uint64_t>(LDI->getCompileTimeTripCount(), 1);
+    maximumBytes =
+        std::max<uint64_t>(maximumBytes,
+                           this->maximumBytesToExpand / tripCount);
+  }
+
+  /*
+   * Keep only the temporaries that can be expanded.
+   */
+  auto DS = par.getDominators(loopFunction);
+  std::unordered_set<Value *> temporaries;
+  for (auto temporary : candidates) {
+    Type *temporaryType = nullptr;
+    uint64_t alignment = 0;
+    if (auto allocaInst = dyn_cast<AllocaInst>(temporary)) {
+      temporaryType = allocaInst->getAllocatedType();
+      alignment = allocaInst->getAlignment();
+    } else {
+      auto g = cast<GlobalVariable>(temporary);
+      temporaryType = g->getValueType();
+      alignment = g->getAlignment();
+    }
+    auto temporarySize = DL.getTypeAllocSize(temporaryType);
+    alignment = std::max<uint64_t>(alignment,
+                                   DL.getABITypeAlignment(temporaryType));
+    if (false || (temporarySize == 0) || (temporarySize > maximumBytes)
+        || (alignment > 16)) {
+      continue;
+    }
+
+    /*
+     * Collect the instructions that read and write the temporary.
+     * The temporary cannot escape: every instruction that uses it must belong
+     * to the loop, and it must either access its memory or be a callee that
+     * does not capture it.
+     * Lifetime markers are removed by the expansion, so they are allowed
+     * everywhere.
+     */
+    std::vector<Instruction *> reads;
+    std::unordered_set<Instruction *> fullWrites;
+    std::function<bool(Value *, bool)> collectAccesses;
+    collectAccesses = [&](Value *pointer, bool isStartOfTemporary) -> bool {
+      for (auto &use : pointer->uses()) {
+        auto user = use.getUser();
+        if (auto intrinsic = dyn_cast<IntrinsicInst>(user)) {
+          auto intrinsicID = intrinsic->getIntrinsicID();
+          if (false || (intrinsicID == Intrinsic::lifetime_start)
+              || (intrinsicID == Intrinsic::lifetime_end)) {
+            continue;
+          }
+        }
+        if (auto expr = dyn_cast<ConstantExpr>(user)) {
+          auto isStart = isStartOfTemporary;
+          if (auto gep = dyn_cast<GEPOperator>(expr)) {
+            isStart &= gep->hasAllZeroIndices();
+          } else if (expr->getOpcode() != Instruction::BitCast) {
+            return false;
+          }
+          if (!collectAccesses(expr, isStart)) {
+            return false;
+          }
+          continue;
+        }
+        auto userInst = dyn_cast<Instruction>(user);
+        if (false || (userInst == nullptr)
+            || (!loopStructure->isIncluded(userInst))) {
+          return false;
+        }
+        if (isa<BitCastInst>(userInst)) {
+          if (!collectAccesses(userInst, isStartOfTemporary)) {
+            return false;
+          }
+          continue;
+        }
+        if (auto gep = dyn_cast<GetElementPtrInst>(userInst)) {
+          if (false || (!gep->hasAllConstantIndices())
+              || (use.getOperandNo() != 0)) {
+            return false;
+          }
+          auto isStart = isStartOfTemporary && gep->hasAllZeroIndices();
+          if (!collectAccesses(gep, isStart)) {
+            return false;
+          }
+          continue;
+        }
+        if (auto loadInst = dyn_cast<LoadInst>(userInst)) {
+          if (!loadInst->isSimple()) {
+            return false;
+          }
+          reads.push_back(loadInst);
+          continue;
+        }
+        if (auto storeInst = dyn_cast<StoreInst>(userInst)) {
+          if (false || (!storeInst->isSimple())
+              || (storeInst->getPointerOperand() != pointer)) {
+            return false;
+          }
+          auto storedType = storeInst->getValueOperand()->getType();
+          if (true && isStartOfTemporary
+              && (DL.getTypeStoreSize(storedType) >= temporarySize)) {
+            fullWrites.insert(storeInst);
+          }
+          continue;
+        }
+        if (auto memIntrinsic = dyn_cast<MemIntrinsic>(userInst)) {
+          if (memIntrinsic->isVolatile()) {
+            return false;
+          }
+          if (memIntrinsic->getRawDest() != pointer) {
+            reads.push_back(memIntrinsic);
+            continue;
+          }
+          auto length = dyn_cast<ConstantInt>(memIntrinsic->getLength());
+          if (true && isStartOfTemporary && (length != nullptr)
+              && (length->getZExtValue() >= temporarySize)) {
+            fullWrites.insert(memIntrinsic);
+          }
+          continue;
+        }
+        if (auto callInst = dyn_cast<CallBase>(userInst)) {
+          if (false || (!callInst->isArgOperand(&use))
+              || (!callInst->doesNotCapture(callInst->getArgOperandNo(&use)))) {
+            return false;
+          }
+
+          /*
+           * The callee can both read and write the temporary.
+           */
+          reads.push_back(callInst);
+          continue;
+        }
+        return false;
+      }
+      return true;
+    };
+    if (!collectAccesses(temporary, true)) {
+      continue;
+    }
+
+    /*
+     * Every iteration must write the whole temporary before reading it.
+     * Hence, no value stored in the temporary flows to another iteration, or
+     * outside the loop.
+     */
+    auto isPrivate = true;
+    for (auto readInst : reads) {
+      auto isWrittenBefore = false;
+      for (auto writeInst : fullWrites) {
+        if (true && (writeInst != readInst)
+            && DS->DT.dominates(writeInst, readInst)) {
+          isWrittenBefore = true;
+          break;
+        }
+      }
+      if (!isWrittenBefore) {
+        isPrivate = false;
+        break;
+      }
+    }
+    if (!isPrivate) {
+      continue;
+    }
+    errs() << "EnablersManager:       Expand the temporary " << *temporary
+           << "\n";
+    temporaries.insert(temporary);
+  }
+  delete DS;
+  if (temporaries.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Every blocking dependence must be removed by the expansion.
+   * Otherwise, the loop would not be a DOALL.
+   */
+  for (auto &dep : blockingDependences) {
+    for (auto inst : { dep.first, dep.second }) {
+      for (auto pointer : getAccessedPointers(inst)) {
+        if (temporaries.count(getTemporary(pointer)) == 0) {
+          return false;
+        }
+      }
+    }
+  }
+
+  /*
+   * Expand the temporaries.
+   */
+  auto modified =
+      LoopTransformer.expandTemporaries(LDI,
+                                        temporaries,
+                                        this->maximumBytesToExpand);
+
+  return modified;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2019 - 2021 Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "EnablersManager.hpp"
+
+namespace llvm::noelle {
+
+bool EnablersManager::splitArraysOfStructures(Module &M, Noelle &par) {
+
+  /*
+   * Define the code that fetches the field of a structure of the array @g
+   * that a pointer points to.
+   * The pointer must be computed by indexing @g, then an element of the
+   * array, and then a constant field of the structure.
+   */
+  auto getField = [](GlobalVariable *g, Value *pointer) -> int64_t {
+    auto gep = dyn_cast<GEPOperator>(pointer);
+    if (false || (gep == nullptr) || (gep->getPointerOperand() != g)
+        || (gep->getNumIndices() < 3)) {
+      return -1;
+    }
+    auto firstIndex = dyn_cast<ConstantInt>(gep->getOperand(1));
+    auto fieldIndex = dyn_cast<ConstantInt>(gep->getOperand(3));
+    if (false || (firstIndex == nullptr) || (!firstIndex->isZero())
+        || (fieldIndex == nullptr)) {
+      return -1;
+    }
+    return fieldIndex->getZExtValue();
+  };
+
+  /*
+   * Define the code that collects the functions that use a constant.
+   */
+  std::function<void(User *, std::unordered_set<Function *> &)>
+      collectFunctions;
+  collectFunctions = [&collectFunctions](User *user,
+                                         std::unordered_set<Function *> &fs) {
+    if (auto inst = dyn_cast<Instruction>(user)) {
+      fs.insert(inst->getFunction());
+      return;
+    }
+    for (auto constantUser : user->users()) {
+      collectFunctions(constantUser, fs);
+    }
+  };
+
+  /*
+   * Fetch the arrays of structures we can split.
+   * They must be visible only within the module, and every use must compute
+   * the pointer to a field of one of their structures. Hence, every access to
+   * them is resolvable, and no pointer to an entire structure exists.
+   */
+  std::vector<GlobalVariable *> candidates;
+  for (auto &g : M.globals()) {
+    auto arrayType = dyn_cast<ArrayType>(g.getValueType());
+    if (false || (!g.hasLocalLinkage()) || g.isExternallyInitialized()
+        || (!g.hasInitializer()) || (arrayType == nullptr)
+        || (!arrayType->getElementType()->isStructTy())) {
+      continue;
+    }
+    auto canBeSplit = true;
+    for (auto user : g.users()) {
+      if (getField(&g, user) < 0) {
+        canBeSplit = false;
+        break;
+      }
+    }
+    if (canBeSplit) {
+      candidates.push_back(&g);
+    }
+  }
+  if (candidates.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Keep only the arrays for which a hot loop touches only some of the fields
+   * of their structures. These loops waste the cache bandwidth to load the
+   * other fields, and different cores can share the cache lines of the fields
+   * they do not touch.
+   */
+  auto hot = par.getProfiles();
+  auto loops = par.getLoopStructures();
+  std::unordered_map<GlobalVariable *, bool> isWorthSplitting;
+  for (auto loop : *loops) {
+    if (true && hot->isAvailable() && (!hot->hasBeenExecuted(loop))) {
+      continue;
+    }
+    std::unordered_map<GlobalVariable *, std::unordered_set<int64_t>> fields;
+    for (auto bb : loop->getBasicBlocks()) {
+      for (auto &I : *bb) {
+        Value *pointer = nullptr;
+        if (auto loadInst = dyn_cast<LoadInst>(&I)) {
+          pointer = loadInst->getPointerOperand();
+        } else if (auto storeInst = dyn_cast<StoreInst>(&I)) {
+          pointer = storeInst->getPointerOperand();
+        } else {
+          continue;
+        }
+        for (auto g : candidates) {
+          auto field = getField(g, pointer);
+          if (field >= 0) {
+            fields[g].insert(field);
+          }
+        }
+      }
+    }
+    for (auto &pair : fields) {
+      auto structType = cast<StructType>(
+          cast<ArrayType>(pair.first->getValueType())->getElementType());
+      if (pair.second.size() < structType->getNumElements()) {
+        isWorthSplitting[pair.first] = true;
+      }
+    }
+  }
+  delete loops;
+
+  /*
+   * Split the arrays.
+   */
+  auto modified = false;
+  std::unordered_set<Function *> modifiedFunctions;
+  for (auto g : candidates) {
+    if (!isWorthSplitting[g]) {
+      continue;
+    }
+    auto arrayType = cast<ArrayType>(g->getValueType());
+    auto structType = cast<StructType>(arrayType->getElementType());
+    auto numberOfElements = arrayType->getNumElements();
+    errs() << "EnablersManager:     Split the array of structures \""
+           << g->getName() << "\" into " << structType->getNumElements()
+           << " arrays\n";
+
+    /*
+     * Allocate one array per field, each one initialized with the values of
+     * its field.
+     */
+    std::vector<GlobalVariable *> fieldArrays;
+    auto initializer = g->getInitializer();
+    for (auto f = 0u; f < structType->getNumElements(); f++) {
+      auto fieldType = structType->getElementType(f);
+      auto fieldArrayType = ArrayType::get(fieldType, numberOfElements);
+      Constant *fieldInitializer = nullptr;
+      if (initializer->isNullValue()) {
+        fieldInitializer = ConstantAggregateZero::get(fieldArrayType);
+      } else {
+        std::vector<Constant *> fieldValues;
+        for (auto e = 0u; e < numberOfElements; e++) {
+          auto element = initializer->getAggregateElement(e);
+          assert(element != nullptr);
+          auto fieldValue = element->getAggregateElement(f);
+          assert(fieldValue != nullptr);
+          fieldValues.push_back(fieldValue);
+        }
+        fieldInitializer = ConstantArray::get(fieldArrayType, fieldValues);
+      }
+      auto fieldArray =
+          new GlobalVariable(M,
+                             fieldArrayType,
+                             g->isConstant(),
+                             g->getLinkage(),
+                             fieldInitializer,
+                             g->getName() + "." + std::to_string(f),
+                             g,
+                             g->getThreadLocalMode(),
+                             g->getAddressSpace());
+      fieldArray->setAlignment(g->getAlignment());
+      fieldArrays.push_back(fieldArray);
+    }
+
+    /*
+     * Redirect the pointers to the fields to the new arrays.
+     * A pointer to g[i].f[j]... becomes a pointer to g.f[i][j]...
+     */
+    std::vector<User *> users(g->user_begin(), g->user_end());
+    for (auto user : users) {
+      collectFunctions(user, modifiedFunctions);
+      auto gep = cast<GEPOperator>(user);
+      auto fieldArray = fieldArrays[getField(g, gep)];
+      std::vector<Value *> indices;
+      for (auto i = 0u; i < gep->getNumIndices(); i++) {
+        if (i != 2) {
+          indices.push_back(gep->getOperand(i + 1));
+        }
+      }
+      if (auto gepInst = dyn_cast<GetElementPtrInst>(gep)) {
+        auto newGEP = GetElementPtrInst::Create(fieldArray->getValueType(),
+                                                fieldArray,
+                                                indices,
+                                                gepInst->getName(),
+                                                gepInst);
+        newGEP->setIsInBounds(gepInst->isInBounds());
+        newGEP->setDebugLoc(gepInst->getDebugLoc());
+        gepInst->replaceAllUsesWith(newGEP);
+        gepInst->eraseFromParent();
+        continue;
+      }
+      auto gepConstant = cast<ConstantExpr>(gep);
+      std::vector<Constant *> constantIndices;
+      for (auto index : indices) {
+        constantIndices.push_back(cast<Constant>(index));
+      }
+      auto newGEP =
+          ConstantExpr::getGetElementPtr(fieldArray->getValueType(),
+                                         fieldArray,
+                                         constantIndices,
+                                         gep->isInBounds());
+      gepConstant->replaceAllUsesWith(newGEP);
+      gepConstant->destroyConstant();
+    }
+    assert(g->use_empty());
+    g->eraseFromParent();
+    modified = true;
+  }
+
+  /*
+   * The dependences of the functions that access the new arrays are stale.
+   */
+  for (auto f : modifiedFunctions) {
+    par.refreshDependences(f);
+  }
+
+  return modified;
+}
+
+} // namespace llvm::noelle
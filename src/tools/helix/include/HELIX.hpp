@@ -62,6 +62,8 @@ public:
 
   bool doesHaveASequentialPrologue(LoopDependenceInfo *LDI) const;
 
+  BasicBlock *getHeaderOfTheParallelizedLoop(void) const;
+
   virtual ~HELIX();
 
 protected:
@@ -108,23 +110,54 @@ protected:
   std::vector<SequentialSegment *> identifySequentialSegments(
       LoopDependenceInfo *originalLDI,
       LoopDependenceInfo *LDI,
-      DataFlowResult *reachabilityDFR);
+      DataFlowResult *reachabilityDFR,
+      Heuristics *h);
 
   void squeezeSequentialSegments(LoopDependenceInfo *LDI,
                                  std::vector<SequentialSegment *> *sss,
                                  DataFlowResult *reachabilityDFR);
 
-  void scheduleSequentialSegments(LoopDependenceInfo *LDI,
+  bool scheduleSequentialSegments(LoopDependenceInfo *LDI,
                                   std::vector<SequentialSegment *> *sss,
                                   DataFlowResult *reachabilityDFR);
 
   void addSynchronizations(LoopDependenceInfo *LDI,
                            std::vector<SequentialSegment *> *sss);
 
+  /*
+   * Profiling of the sequential segments (see -helix-segment-profile).
+   * Return the ID of the loop LDI, or -1 if its segments must not be profiled.
+   */
+  int64_t getIDOfLoopToProfileSegments(LoopDependenceInfo *LDI) const;
+
+  void dumpSequentialSegmentsMap(LoopDependenceInfo *LDI,
+                                 int64_t loopID,
+                                 std::vector<SequentialSegment *> *sss);
+
+  void forwardSpilledLoopCarriedValuesThroughSignals(
+      LoopDependenceInfo *LDI,
+      std::vector<SequentialSegment *> *sss,
+      std::vector<Value *> &ssPastPtrs,
+      std::vector<Value *> &ssFuturePtrs);
+
   void inlineCalls(Task *task);
 
   void rewireLoopForIVsToIterateNthIterations(LoopDependenceInfo *LDI);
 
+  bool doesClaimIterationsDynamically(LoopDependenceInfo *LDI) const;
+
+  /*
+   * Decoupling of the sequential prologue (see -helix-decoupled-prologue).
+   * The prologue runs ahead on a core of its own, and it sends the values the
+   * rest of each iteration needs to the cores that run the iterations.
+   * Return true if the prologue of LDI will be decoupled.
+   */
+  bool selectTheSequentialPrologueToDecouple(LoopDependenceInfo *LDI);
+
+  void decoupleTheSequentialPrologue(LoopDependenceInfo *LDI);
+
+  bool isPartOfTheDecoupledPrologue(SCC *taskSCC) const;
+
   BasicBlock *getBasicBlockExecutedOnlyByLastIterationBeforeExitingTask(
       LoopDependenceInfo *LDI,
       uint32_t taskIndex,
@@ -132,6 +165,13 @@ protected:
 
 private:
   Function *waitSSCall, *signalSSCall;
+  Function *waitAdaptiveSSCall, *signalAdaptiveSSCall;
+  Function *waitDynamicSSCall, *signalDynamicSSCall, *claimIterationCall;
+  Function *enterCriticalSectionCall, *exitCriticalSectionCall;
+  Function *segmentProfileWaitCall, *segmentProfileEnterCall;
+  Function *segmentProfileExitCall;
+  Function *producePrologueCall, *publishPrologueCall;
+  Function *consumePrologueCall, *releasePrologueCall, *endPrologueCall;
   LoopDependenceInfo *originalLDI;
   PDG *taskFunctionDG;
 
@@ -140,9 +180,16 @@ private:
   std::unordered_map<Instruction *, Instruction *>
       lastIterationExecutionDuplicateMap;
   BasicBlock *lastIterationExecutionBlock;
+  PHINode *iterationTicket;
+  double predictedSequentialFraction;
   bool enableInliner;
   Function *taskDispatcherSS;
   Function *taskDispatcherCS;
+  Function *taskDispatcherDynamicSS;
+  Function *taskDispatcherDecoupledPrologue;
+  SCC *decoupledPrologueSCC;
+  std::vector<Instruction *> decoupledPrologueInstructions;
+  CallInst *prologueConsume;
   std::string prefixString;
   void squeezeSequentialSegment(LoopDependenceInfo *LDI,
                                 DataFlowResult *reachabilityDFR,
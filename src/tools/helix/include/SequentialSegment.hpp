@@ -34,6 +34,7 @@ public:
                     DataFlowResult *reachabilityDFR,
                     SCCSet *sccs,
                     int32_t ID,
+                    bool isCommutative,
                     Verbosity verbosity,
                     const std::string &prefixString);
 
@@ -43,6 +44,12 @@ public:
 
   int32_t getID(void);
 
+  /*
+   * Return true if the iterations can execute the sequential segment in any
+   * order (one at a time), false if they must follow the loop order.
+   */
+  bool isCommutative(void) const;
+
   iterator_range<unordered_set<SCC *>::iterator> getSCCs(void);
 
   std::unordered_set<Instruction *> getInstructions(void);
@@ -52,6 +59,7 @@ private:
   std::set<Instruction *> exits;
   SCCSet *sccs;
   int32_t ID;
+  bool commutative;
   Verbosity verbosity;
 
   void determineEntryAndExitFrontier(
@@ -31,6 +31,11 @@ HELIX::HELIX(Noelle &n, bool forceParallelization)
     loopCarriedLoopEnvironmentBuilder{ nullptr },
     taskFunctionDG{ nullptr },
     lastIterationExecutionBlock{ nullptr },
+    iterationTicket{ nullptr },
+    taskDispatcherDecoupledPrologue{ nullptr },
+    decoupledPrologueSCC{ nullptr },
+    prologueConsume{ nullptr },
+    predictedSequentialFraction{ -1 },
     enableInliner{ true },
     prefixString{ "HELIX: " } {
 
@@ -57,6 +62,58 @@ HELIX::HELIX(Noelle &n, bool forceParallelization)
     abort();
   }
 
+  /*
+   * Fetch the functions to synchronize sequential segments with a bounded spin
+   * followed by yielding the core.
+   * If they are not available, then we fall back to the spinlock-based ones.
+   */
+  this->waitAdaptiveSSCall = program->getFunction("HELIX_waitAdaptive");
+  this->signalAdaptiveSSCall = program->getFunction("HELIX_signalAdaptive");
+
+  /*
+   * Fetch the functions to let cores claim iterations dynamically and the
+   * dispatcher of such loops.
+   * If they are not available, then the iterations are assigned round-robin.
+   */
+  this->claimIterationCall = program->getFunction("HELIX_claimIteration");
+  this->waitDynamicSSCall = program->getFunction("HELIX_waitDynamic");
+  this->signalDynamicSSCall = program->getFunction("HELIX_signalDynamic");
+  this->taskDispatcherDynamicSS = program->getFunction(
+      "NOELLE_HELIX_dispatcher_dynamicSequentialSegments");
+
+  /*
+   * Fetch the synchronization functions of commutative sequential segments.
+   * If they are not available, then these sequential segments follow the order
+   * of the iterations like the others.
+   */
+  this->enterCriticalSectionCall =
+      program->getFunction("HELIX_enterCriticalSection");
+  this->exitCriticalSectionCall =
+      program->getFunction("HELIX_exitCriticalSection");
+
+  /*
+   * Fetch the functions that profile the sequential segments.
+   */
+  this->segmentProfileWaitCall =
+      program->getFunction("HELIX_segmentProfileWait");
+  this->segmentProfileEnterCall =
+      program->getFunction("HELIX_segmentProfileEnter");
+  this->segmentProfileExitCall =
+      program->getFunction("HELIX_segmentProfileExit");
+
+  /*
+   * Fetch the functions to decouple the sequential prologue of a loop and the
+   * dispatcher of such loops.
+   * If they are not available, then the prologue is a sequential segment.
+   */
+  this->producePrologueCall = program->getFunction("HELIX_producePrologue");
+  this->publishPrologueCall = program->getFunction("HELIX_publishPrologue");
+  this->consumePrologueCall = program->getFunction("HELIX_consumePrologue");
+  this->releasePrologueCall = program->getFunction("HELIX_releasePrologue");
+  this->endPrologueCall = program->getFunction("HELIX_endPrologue");
+  this->taskDispatcherDecoupledPrologue =
+      program->getFunction("NOELLE_HELIX_dispatcher_decoupledPrologue");
+
   /*
    * Fetch the LLVM types of the HELIX_dispatcher arguments.
    */
@@ -91,6 +148,32 @@ bool HELIX::canBeAppliedToLoop(LoopDependenceInfo *LDI, Heuristics *h) const {
     return false;
   }
 
+  /*
+   * The iterations are distributed among cores by stepping the loop-governing
+   * IV, which requires the direction of the IV to be known at compile time.
+   */
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  if (true && (loopGoverningIVAttr != nullptr)
+      && (!loopGoverningIVAttr->getInductionVariable()
+               .isStepValueSignKnown())) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs()
+          << "HELIX:  The sign of the step of the loop-governing IV is unknown at compile time\n";
+    }
+    return false;
+  }
+
+  /*
+   * The output of the calls that write to streams is buffered per iteration.
+   */
+  if (true && (LDI->getCallsWithBufferedOutput().size() > 0)
+      && (!this->canBufferOutputOfLoop(LDI))) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "HELIX:  The output of the loop cannot be buffered\n";
+    }
+    return false;
+  }
+
   /*
    * Check if we are forced to parallelize
    */
@@ -255,6 +338,16 @@ void HELIX::createParallelizableTask(LoopDependenceInfo *LDI, Heuristics *h) {
    */
   auto reachabilityDFR = this->computeReachabilityFromInstructions(LDI);
 
+  /*
+   * Check if the sequential prologue can run ahead on a core of its own.
+   * This must be known before spilling the loop-carried variables because the
+   * ones of the prologue are not spilled.
+   */
+  if (this->selectTheSequentialPrologueToDecouple(LDI)) {
+    errs() << this->prefixString
+           << "  The sequential prologue will be decoupled\n";
+  }
+
   /*
    * Generate empty tasks for the HELIX execution.
    */
@@ -344,6 +437,16 @@ void HELIX::createParallelizableTask(LoopDependenceInfo *LDI, Heuristics *h) {
   this->adjustDataFlowToUseClones(LDI, 0);
   this->setReducableVariablesToBeginAtIdentityValue(LDI, 0);
 
+  /*
+   * Compute the invariants of the task once in the caller.
+   */
+  auto hoistedInvariants =
+      this->hoistInvariantsOfTheTaskIntoTheEnvironment(LDI, 0, true);
+  if (hoistedInvariants > 0) {
+    errs() << this->prefixString << "  " << hoistedInvariants
+           << " invariants are computed once by the caller\n";
+  }
+
   /*
    * Add the unconditional branch from the entry basic block to the header of
    * the loop.
@@ -375,6 +478,13 @@ void HELIX::createParallelizableTask(LoopDependenceInfo *LDI, Heuristics *h) {
   IRBuilder<> exitB(helixTask->getExit());
   exitB.CreateRetVoid();
 
+  /*
+   * Move the sequential prologue to its producer.
+   */
+  if (this->decoupledPrologueSCC != nullptr) {
+    this->decoupleTheSequentialPrologue(LDI);
+  }
+
   if (this->verbose >= Verbosity::Maximal) {
     SubCFGs execGraph(*helixTask->getTaskBody());
     // DGPrinter::writeGraph<SubCFGs, BasicBlock>("unsync-helixtask-loop" +
@@ -412,7 +522,10 @@ bool HELIX::synchronizeTask(LoopDependenceInfo *LDI, Heuristics *h) {
    * squeezing.
    */
   auto sequentialSegments =
-      this->identifySequentialSegments(this->originalLDI, LDI, reachabilityDFR);
+      this->identifySequentialSegments(this->originalLDI,
+                                       LDI,
+                                       reachabilityDFR,
+                                       h);
   this->squeezeSequentialSegments(LDI, &sequentialSegments, reachabilityDFR);
 
   /*
@@ -432,13 +545,18 @@ bool HELIX::synchronizeTask(LoopDependenceInfo *LDI, Heuristics *h) {
   }
   reachabilityDFR = this->computeReachabilityFromInstructions(LDI);
   sequentialSegments =
-      this->identifySequentialSegments(this->originalLDI, LDI, reachabilityDFR);
+      this->identifySequentialSegments(this->originalLDI,
+                                       LDI,
+                                       reachabilityDFR,
+                                       h);
 
   /*
    * Schedule the sequential segments to overlap parallel and sequential
    * segments.
    */
-  this->scheduleSequentialSegments(LDI, &sequentialSegments, reachabilityDFR);
+  auto scheduled = this->scheduleSequentialSegments(LDI,
+                                                    &sequentialSegments,
+                                                    reachabilityDFR);
 
   /*
    * Delete reachability results here before we decide whether to continue with
@@ -446,6 +564,23 @@ bool HELIX::synchronizeTask(LoopDependenceInfo *LDI, Heuristics *h) {
    */
   delete reachabilityDFR;
 
+  /*
+   * Re-compute the entries and exits of the sequential segments if their
+   * instructions have been moved.
+   */
+  if (scheduled) {
+    for (auto ss : sequentialSegments) {
+      delete ss;
+    }
+    reachabilityDFR = this->computeReachabilityFromInstructions(LDI);
+    sequentialSegments =
+        this->identifySequentialSegments(this->originalLDI,
+                                         LDI,
+                                         reachabilityDFR,
+                                         h);
+    delete reachabilityDFR;
+  }
+
   /*
    * Check if any sequential segment's entry and exit frontier spans the entire
    * loop execution If so, do not parallelize
@@ -483,6 +618,24 @@ bool HELIX::synchronizeTask(LoopDependenceInfo *LDI, Heuristics *h) {
     }
   }
 
+  /*
+   * Report the fraction of an iteration predicted to be spent in sequential
+   * segments. This can be compared with the telemetry of the runtime.
+   */
+  if (true && (this->verbose != Verbosity::Disabled)
+      && (this->predictedSequentialFraction >= 0)) {
+    errs() << this->prefixString << "  Predicted sequential fraction of an "
+           << "iteration: " << (this->predictedSequentialFraction * 100)
+           << "\%\n";
+  }
+
+  /*
+   * Buffer the output of the task.
+   * This is done before adding the synchronizations, whose calls to the
+   * runtime get inlined in the task.
+   */
+  this->bufferOutputOfTask(this->originalLDI, 0);
+
   /*
    * Add synchronization instructions.
    */
@@ -578,6 +731,26 @@ bool HELIX::synchronizeTask(LoopDependenceInfo *LDI, Heuristics *h) {
    */
   this->inlineCalls(helixTask);
 
+  /*
+   * Prefetch the strided loads of the task.
+   * Each core runs a single iteration out of every @numTaskInstances ones.
+   */
+  auto prefetchedLoads =
+      this->addPrefetchesToTaskBody(this->originalLDI,
+                                    0,
+                                    1,
+                                    this->numTaskInstances);
+  if (true && (prefetchedLoads > 0)
+      && (this->verbose != Verbosity::Disabled)) {
+    errs() << this->prefixString << "  " << prefetchedLoads
+           << " loads are prefetched by the task\n";
+  }
+
+  /*
+   * Lay out the basic blocks of the task.
+   */
+  this->layOutTaskBody(this->originalLDI, 0);
+
   /*
    * Print the HELIX task.
    */
@@ -604,6 +777,12 @@ Function *HELIX::getTaskFunction(void) const {
   return tasks[0]->getTaskBody();
 }
 
+BasicBlock *HELIX::getHeaderOfTheParallelizedLoop(void) const {
+  auto originalHeader = this->originalLDI->getLoopStructure()->getHeader();
+
+  return tasks[0]->getCloneOfOriginalBasicBlock(originalHeader);
+}
+
 HELIX::~HELIX() {
   return;
 }
@@ -0,0 +1,518 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/core/Architecture.hpp"
+#include "HELIX.hpp"
+#include "HELIXTask.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<bool> DecoupledPrologue(
+    "helix-decoupled-prologue",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Run the sequential prologue of HELIX loops ahead on a core of "
+             "its own, which sends the values of the prologue to the cores "
+             "that run the iterations"));
+
+/*
+ * Offsets of the fields of a slot of a prologue queue (see
+ * HELIX_prologueSlot_t in the runtime).
+ */
+static const uint64_t prologueTokenOffset = 8;
+static const uint64_t prologueValuesOffset = 16;
+
+/*
+ * Tokens of a slot of a prologue queue.
+ */
+static const uint64_t prologueContinues = 0;
+static const uint64_t prologueExits = 1;
+
+bool HELIX::selectTheSequentialPrologueToDecouple(LoopDependenceInfo *LDI) {
+  this->decoupledPrologueSCC = nullptr;
+  this->decoupledPrologueInstructions.clear();
+
+  /*
+   * Check if the decoupling has been requested and if the runtime provides it.
+   */
+  if (DecoupledPrologue.getNumOccurrences() == 0) {
+    return false;
+  }
+  if (false || (this->producePrologueCall == nullptr)
+      || (this->publishPrologueCall == nullptr)
+      || (this->consumePrologueCall == nullptr)
+      || (this->releasePrologueCall == nullptr)
+      || (this->endPrologueCall == nullptr)
+      || (this->taskDispatcherDecoupledPrologue == nullptr)) {
+    return false;
+  }
+  auto reject = [this](std::string reason) -> bool {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << this->prefixString
+             << "  The sequential prologue is not decoupled: " << reason
+             << "\n";
+    }
+    return false;
+  };
+
+  /*
+   * The producer sends the values of the iterations in their order, which
+   * the cores run round-robin.
+   */
+  if (this->doesClaimIterationsDynamically(LDI)) {
+    return reject("the cores claim the iterations dynamically");
+  }
+
+  /*
+   * The cores tell the runtime which iteration they run from the loop header,
+   * which the producer runs on their behalf.
+   */
+  if (LDI->getCallsWithBufferedOutput().size() > 0) {
+    return reject("the output of the loop is buffered");
+  }
+
+  /*
+   * Fetch the prologue.
+   */
+  auto prologueSCC =
+      this->getTheSequentialSCCThatCreatesTheSequentialPrologue(LDI);
+  if (prologueSCC == nullptr) {
+    return false;
+  }
+
+  /*
+   * The prologue must decide whether the loop exits at the start of each
+   * iteration, so the producer knows which iterations run.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopHeader = loopStructure->getHeader();
+  auto latches = loopStructure->getLatches();
+  if (false || (loopStructure->getPreHeader() == nullptr)
+      || (latches.size() != 1)) {
+    return reject("the loop is not in simplified form");
+  }
+  auto latch = *latches.begin();
+  for (auto exitEdge : loopStructure->getLoopExitEdges()) {
+    if (exitEdge.first != loopHeader) {
+      return reject("the loop exits outside its header");
+    }
+  }
+  auto headerBr = dyn_cast<BranchInst>(loopHeader->getTerminator());
+  if (false || (headerBr == nullptr) || (!headerBr->isConditional())
+      || (!prologueSCC->isInternal(headerBr))) {
+    return reject("the prologue does not compute the exit condition");
+  }
+
+  /*
+   * The producer runs the instructions of the prologue straight, so they must
+   * run in every iteration that does not exit the loop.
+   * These are the ones in the basic blocks that dominate the latch, which are
+   * ordered by their depth in the dominator tree.
+   */
+  auto loopFunction = loopStructure->getFunction();
+  auto DS = this->noelle.getDominators(loopFunction);
+  std::vector<BasicBlock *> chain;
+  for (auto bb : loopStructure->getBasicBlocks()) {
+    if (DS->DT.dominates(bb, latch)) {
+      chain.push_back(bb);
+    }
+  }
+  std::sort(chain.begin(),
+            chain.end(),
+            [DS](BasicBlock *b1, BasicBlock *b2) -> bool {
+              return DS->DT.getNode(b1)->getLevel()
+                     < DS->DT.getNode(b2)->getLevel();
+            });
+  delete DS;
+  std::vector<Instruction *> instructions;
+  for (auto bb : chain) {
+    for (auto &inst : *bb) {
+      if (prologueSCC->isInternal(&inst)) {
+        instructions.push_back(&inst);
+      }
+    }
+  }
+  if (instructions.size() != prologueSCC->numInternalNodes()) {
+    return reject("the prologue does not run in every iteration");
+  }
+
+  /*
+   * The producer computes the prologue without the rest of the iterations.
+   * Hence, the prologue must only compute values, and the memory it reads must
+   * not be written by the rest of the loop.
+   */
+  auto loopDG = LDI->getLoopDG();
+  auto valuesToSend = 0u;
+  for (auto inst : instructions) {
+    if (true && (inst != headerBr) && (!isa<CastInst>(inst))
+        && (!isa<GetElementPtrInst>(inst)) && (!isa<BinaryOperator>(inst))
+        && (!isa<CmpInst>(inst)) && (!isa<SelectInst>(inst))) {
+      auto phi = dyn_cast<PHINode>(inst);
+      auto load = dyn_cast<LoadInst>(inst);
+      if (false || ((phi == nullptr) && (load == nullptr))
+          || ((phi != nullptr) && (phi->getParent() != loopHeader))
+          || ((load != nullptr) && (!load->isSimple()))) {
+        return reject("the prologue has " + std::string(inst->getOpcodeName()));
+      }
+    }
+    for (auto &op : inst->operands()) {
+      auto opInst = dyn_cast<Instruction>(op.get());
+      if (true && (opInst != nullptr) && loopStructure->isIncluded(opInst)
+          && (!prologueSCC->isInternal(opInst))) {
+        return reject("the prologue uses values of the rest of the loop");
+      }
+    }
+    if (isa<LoadInst>(inst)) {
+      for (auto edge : loopDG->fetchNode(inst)->getIncomingEdges()) {
+        if (true && edge->isMemoryDependence()
+            && (!prologueSCC->isInternal(edge->getOutgoingT()))) {
+          return reject("the loop writes the memory the prologue reads");
+        }
+      }
+    }
+
+    /*
+     * Check the values the prologue needs to send.
+     */
+    auto isUsedOutside = false;
+    for (auto user : inst->users()) {
+      if (!prologueSCC->isInternal(user)) {
+        isUsedOutside = true;
+        break;
+      }
+    }
+    if (!isUsedOutside) {
+      continue;
+    }
+    auto type = inst->getType();
+    if (true && (!type->isPointerTy()) && (!type->isFloatTy())
+        && (!type->isDoubleTy())
+        && ((!type->isIntegerTy()) || (type->getIntegerBitWidth() > 64))) {
+      return reject("the prologue computes a value that cannot be sent");
+    }
+    valuesToSend++;
+  }
+  auto slotBytes = Architecture::getCacheLineBytes();
+  if (valuesToSend > ((slotBytes - prologueValuesOffset) / 8)) {
+    return reject("the prologue computes too many values for the rest of "
+                  "the loop");
+  }
+
+  /*
+   * The prologue can be decoupled.
+   */
+  this->decoupledPrologueSCC = prologueSCC;
+  this->decoupledPrologueInstructions = instructions;
+
+  return true;
+}
+
+void HELIX::decoupleTheSequentialPrologue(LoopDependenceInfo *LDI) {
+  assert(this->decoupledPrologueSCC != nullptr);
+
+  /*
+   * Fetch the task and the loop.
+   */
+  auto helixTask = static_cast<HELIXTask *>(this->tasks[0]);
+  auto taskBody = helixTask->getTaskBody();
+  auto &cxt = taskBody->getContext();
+  auto int8 = IntegerType::get(cxt, 8);
+  auto int32 = IntegerType::get(cxt, 32);
+  auto int64 = IntegerType::get(cxt, 64);
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopHeader = loopStructure->getHeader();
+  auto loopPreHeader = loopStructure->getPreHeader();
+  auto latch = *loopStructure->getLatches().begin();
+  auto entry = helixTask->getEntry();
+  auto headerClone = helixTask->getCloneOfOriginalBasicBlock(loopHeader);
+  auto latchClone = helixTask->getCloneOfOriginalBasicBlock(latch);
+  auto preheaderClone = helixTask->getCloneOfOriginalBasicBlock(loopPreHeader);
+  auto prologueSCC = this->decoupledPrologueSCC;
+  auto originalBr = cast<BranchInst>(loopHeader->getTerminator());
+  auto brClone =
+      cast<BranchInst>(helixTask->getCloneOfOriginalInstruction(originalBr));
+  auto exitsWhenTrue = !loopStructure->isIncluded(originalBr->getSuccessor(0));
+  auto slotBytes = Architecture::getCacheLineBytes();
+
+  /*
+   * Identify the values of the prologue that the rest of the loop uses.
+   */
+  std::unordered_map<Instruction *, Instruction *> prologueClones;
+  std::vector<Instruction *> valuesToSend;
+  for (auto inst : this->decoupledPrologueInstructions) {
+    prologueClones[inst] = helixTask->getCloneOfOriginalInstruction(inst);
+    for (auto user : inst->users()) {
+      if (!prologueSCC->isInternal(user)) {
+        valuesToSend.push_back(inst);
+        break;
+      }
+    }
+  }
+
+  /*
+   * Define the helpers that access the fields of a slot of the queue.
+   * The values are sent as 64 bits integers.
+   */
+  auto fetchField = [int8, int64](IRBuilder<> &builder,
+                                  Value *slot,
+                                  uint64_t offset) -> Value * {
+    auto field =
+        builder.CreateInBoundsGEP(int8, slot, ConstantInt::get(int64, offset));
+    return builder.CreateBitCast(field, PointerType::getUnqual(int64));
+  };
+  auto encode = [int32, int64](IRBuilder<> &builder, Value *v) -> Value * {
+    auto type = v->getType();
+    if (type->isPointerTy()) {
+      return builder.CreatePtrToInt(v, int64);
+    }
+    if (type->isDoubleTy()) {
+      return builder.CreateBitCast(v, int64);
+    }
+    if (type->isFloatTy()) {
+      return builder.CreateZExt(builder.CreateBitCast(v, int32), int64);
+    }
+    return builder.CreateZExtOrBitCast(v, int64);
+  };
+  auto decode = [int32](IRBuilder<> &builder, Value *v, Type *type) -> Value * {
+    if (type->isPointerTy()) {
+      return builder.CreateIntToPtr(v, type);
+    }
+    if (type->isDoubleTy()) {
+      return builder.CreateBitCast(v, type);
+    }
+    if (type->isFloatTy()) {
+      return builder.CreateBitCast(builder.CreateTrunc(v, int32), type);
+    }
+    return builder.CreateTruncOrBitCast(v, type);
+  };
+
+  /*
+   * Create the producer, which is the task with the core ID equal to the
+   * number of cores that run the iterations.
+   *
+   * It runs the prologue of each iteration until the loop exits, and it sends
+   * the values of the iteration that are used outside the prologue.
+   * The instructions of the prologue that follow the exit condition run only
+   * if the loop does not exit.
+   */
+  auto producerHeader =
+      BasicBlock::Create(cxt, "prologue-producer-header", taskBody);
+  auto producerBody =
+      BasicBlock::Create(cxt, "prologue-producer-body", taskBody);
+  auto producerEnd = BasicBlock::Create(cxt, "prologue-producer-end", taskBody);
+  IRBuilder<> producerHeaderBuilder(producerHeader);
+  IRBuilder<> producerBodyBuilder(producerBody);
+  auto iteration = producerHeaderBuilder.CreatePHI(int64, 2);
+  iteration->addIncoming(ConstantInt::get(int64, 0), entry);
+  std::unordered_map<Value *, Value *> producerClones;
+  auto fetchProducerClone = [&producerClones](Value *v) -> Value * {
+    if (producerClones.find(v) == producerClones.end()) {
+      return v;
+    }
+    return producerClones.at(v);
+  };
+  std::vector<std::pair<PHINode *, PHINode *>> producerPHIs;
+  for (auto inst : this->decoupledPrologueInstructions) {
+    auto cloneI = prologueClones.at(inst);
+    if (cloneI == brClone) {
+      continue;
+    }
+    auto &builder = (inst->getParent() == loopHeader) ? producerHeaderBuilder
+                                                      : producerBodyBuilder;
+    if (auto clonePHI = dyn_cast<PHINode>(cloneI)) {
+      auto producerPHI = builder.CreatePHI(clonePHI->getType(), 2);
+      producerPHI->addIncoming(
+          clonePHI->getIncomingValueForBlock(preheaderClone),
+          entry);
+      producerPHIs.push_back(std::make_pair(clonePHI, producerPHI));
+      producerClones[clonePHI] = producerPHI;
+      continue;
+    }
+    auto producerI = cloneI->clone();
+    builder.Insert(producerI);
+    producerClones[cloneI] = producerI;
+  }
+  for (auto &pair : producerClones) {
+    auto producerI = cast<Instruction>(pair.second);
+    if (isa<PHINode>(producerI)) {
+      continue;
+    }
+    for (auto &op : producerI->operands()) {
+      op.set(fetchProducerClone(op.get()));
+    }
+  }
+  auto producerExitCondition =
+      fetchProducerClone(brClone->getCondition());
+  producerHeaderBuilder.CreateCondBr(producerExitCondition,
+                                     exitsWhenTrue ? producerEnd : producerBody,
+                                     exitsWhenTrue ? producerBody
+                                                   : producerEnd);
+
+  /*
+   * Send the values of the iteration.
+   * An iteration that exits the loop sends only the values computed before
+   * the exit condition.
+   */
+  auto flag = helixTask->loopIsOverFlagArg;
+  auto sendValues = [&](IRBuilder<> &builder,
+                        uint64_t token,
+                        bool exits) -> void {
+    auto slot =
+        builder.CreateCall(this->producePrologueCall,
+                           ArrayRef<Value *>({ flag, iteration }));
+    builder.CreateStore(ConstantInt::get(int64, token),
+                        fetchField(builder, slot, prologueTokenOffset));
+    for (auto i = 0u; i < valuesToSend.size(); i++) {
+      auto inst = valuesToSend[i];
+      if (exits && (inst->getParent() != loopHeader)) {
+        continue;
+      }
+      auto value = fetchProducerClone(prologueClones.at(inst));
+      builder.CreateStore(
+          encode(builder, value),
+          fetchField(builder, slot, prologueValuesOffset + (i * 8)));
+    }
+    builder.CreateCall(this->publishPrologueCall, ArrayRef<Value *>({ slot }));
+  };
+  sendValues(producerBodyBuilder, prologueContinues, false);
+  auto nextIteration =
+      producerBodyBuilder.CreateAdd(iteration, ConstantInt::get(int64, 1));
+  producerBodyBuilder.CreateBr(producerHeader);
+  iteration->addIncoming(nextIteration, producerBody);
+  for (auto &pair : producerPHIs) {
+    auto clonePHI = pair.first;
+    auto producerPHI = pair.second;
+    auto latchValue = clonePHI->getIncomingValueForBlock(latchClone);
+    producerPHI->addIncoming(fetchProducerClone(latchValue), producerBody);
+  }
+
+  /*
+   * Once the loop exits, tell the cores that did not run the last iteration to
+   * leave the task.
+   */
+  IRBuilder<> producerEndBuilder(producerEnd);
+  sendValues(producerEndBuilder, prologueExits, true);
+  producerEndBuilder.CreateCall(
+      this->endPrologueCall,
+      ArrayRef<Value *>({ flag, iteration, helixTask->numCoresArg }));
+  producerEndBuilder.CreateRetVoid();
+
+  /*
+   * Branch to the producer at the entry of the task.
+   * The loop keeps its own preheader.
+   */
+  auto entryTerminator = entry->getTerminator();
+  auto workerEntry =
+      entry->splitBasicBlock(entryTerminator, "prologue-consumer-entry");
+  entry->getTerminator()->eraseFromParent();
+  IRBuilder<> entryBuilder(entry);
+  auto isProducer =
+      entryBuilder.CreateICmpEQ(helixTask->coreArg, helixTask->numCoresArg);
+  entryBuilder.CreateCondBr(isProducer, producerHeader, workerEntry);
+  helixTask->addBasicBlock(loopPreHeader, workerEntry);
+
+  /*
+   * Consume the values of the current iteration at the start of the header.
+   * The cores run the iterations round-robin.
+   */
+  IRBuilder<> phiBuilder(&*headerClone->begin());
+  auto consumedIteration = phiBuilder.CreatePHI(int64, 2);
+  consumedIteration->addIncoming(helixTask->coreArg, workerEntry);
+  IRBuilder<> latchBuilder(latchClone->getTerminator());
+  auto nextConsumedIteration =
+      latchBuilder.CreateAdd(consumedIteration, helixTask->numCoresArg);
+  consumedIteration->addIncoming(nextConsumedIteration, latchClone);
+  IRBuilder<> consumerBuilder(headerClone->getFirstNonPHI());
+  this->prologueConsume = consumerBuilder.CreateCall(
+      this->consumePrologueCall,
+      ArrayRef<Value *>({ flag, consumedIteration }));
+  auto token = consumerBuilder.CreateLoad(
+      fetchField(consumerBuilder, this->prologueConsume, prologueTokenOffset));
+  std::vector<Instruction *> receivedValues;
+  for (auto i = 0u; i < valuesToSend.size(); i++) {
+    auto value = consumerBuilder.CreateLoad(
+        fetchField(consumerBuilder,
+                   this->prologueConsume,
+                   prologueValuesOffset + (i * 8)));
+    auto receivedValue =
+        decode(consumerBuilder, value, valuesToSend[i]->getType());
+    receivedValues.push_back(cast<Instruction>(receivedValue));
+  }
+  consumerBuilder.CreateCall(this->releasePrologueCall,
+                             ArrayRef<Value *>({ this->prologueConsume }));
+
+  /*
+   * Leave the task if the loop exited in an earlier iteration.
+   * Otherwise, exit the loop if the producer says so.
+   */
+  auto isOver = consumerBuilder.CreateICmpUGT(
+      token,
+      ConstantInt::get(int64, prologueExits));
+  auto exits = consumerBuilder.CreateICmpEQ(
+      token,
+      ConstantInt::get(int64, prologueExits));
+  auto exitCondition = exitsWhenTrue ? exits : consumerBuilder.CreateNot(exits);
+  auto consumedBlock = headerClone->splitBasicBlock(
+      cast<Instruction>(exitCondition)->getNextNode(),
+      "prologue-consumed");
+  headerClone->getTerminator()->eraseFromParent();
+  IRBuilder<> headerBuilder(headerClone);
+  headerBuilder.CreateCondBr(isOver, helixTask->getExit(), consumedBlock);
+  brClone->setCondition(exitCondition);
+
+  /*
+   * Replace the prologue with the values received.
+   */
+  for (auto i = 0u; i < valuesToSend.size(); i++) {
+    auto inst = valuesToSend[i];
+    auto cloneI = prologueClones.at(inst);
+    cloneI->replaceAllUsesWith(receivedValues[i]);
+    helixTask->addInstruction(inst, receivedValues[i]);
+  }
+  std::vector<Instruction *> clonesToErase;
+  for (auto inst : this->decoupledPrologueInstructions) {
+    if (inst == originalBr) {
+      continue;
+    }
+    auto cloneI = prologueClones.at(inst);
+    if (std::find(valuesToSend.begin(), valuesToSend.end(), inst)
+        == valuesToSend.end()) {
+      cloneI->replaceAllUsesWith(UndefValue::get(cloneI->getType()));
+      helixTask->removeOriginalInstruction(inst);
+    }
+    clonesToErase.push_back(cloneI);
+  }
+  for (auto cloneI : clonesToErase) {
+    cloneI->eraseFromParent();
+  }
+
+  return;
+}
+
+bool HELIX::isPartOfTheDecoupledPrologue(SCC *taskSCC) const {
+  if (this->prologueConsume == nullptr) {
+    return false;
+  }
+
+  return taskSCC->isInternal(this->prologueConsume);
+}
+
+} // namespace llvm::noelle
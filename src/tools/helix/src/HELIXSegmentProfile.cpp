@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021 - 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "HELIX.hpp"
+#include "HELIXTask.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<bool> SegmentProfile(
+    "helix-segment-profile",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Make HELIX tasks profile the cycles spent waiting for and "
+             "holding their sequential segments (see NOELLE_HELIX_SEGMENTS)"));
+
+static cl::opt<std::string> SegmentMapFile(
+    "helix-segment-map",
+    cl::init("noelle_helix_segments.txt"),
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File to write with the instructions of the profiled "
+             "sequential segments (see -helix-segment-profile)"));
+
+int64_t HELIX::getIDOfLoopToProfileSegments(LoopDependenceInfo *LDI) const {
+  if (false || (SegmentProfile.getNumOccurrences() == 0)
+      || (this->segmentProfileWaitCall == nullptr)
+      || (this->segmentProfileEnterCall == nullptr)
+      || (this->segmentProfileExitCall == nullptr)) {
+    return -1;
+  }
+
+  /*
+   * The segments are profiled with the ID of the loop, which maps them back to
+   * their instructions.
+   */
+  auto mm = this->noelle.getMetadataManager();
+  auto loopStructure = LDI->getLoopStructure();
+  if (!mm->doesHaveMetadata(loopStructure, "noelle.loop_ID")) {
+    return -1;
+  }
+
+  return std::stoll(mm->getMetadata(loopStructure, "noelle.loop_ID"));
+}
+
+void HELIX::dumpSequentialSegmentsMap(LoopDependenceInfo *LDI,
+                                      int64_t loopID,
+                                      std::vector<SequentialSegment *> *sss) {
+
+  /*
+   * Open the map.
+   * The first loop profiled by the current compilation overwrites the map of
+   * the previous one.
+   */
+  static bool isMapNew = true;
+  std::error_code EC;
+  auto flags = isMapNew ? sys::fs::F_Text : sys::fs::F_Append;
+  raw_fd_ostream map(SegmentMapFile, EC, flags);
+  if (EC) {
+    errs() << this->prefixString
+           << "ERROR = cannot open the map of the sequential segments \""
+           << SegmentMapFile << "\"\n";
+    return;
+  }
+  if (isMapNew) {
+    map << "# LOOP_ID SEGMENT_ID KIND LOCATION INSTRUCTION\n";
+    isMapNew = false;
+  }
+
+  /*
+   * Write one line per instruction of every sequential segment.
+   * Instructions are located by their debug location, if any.
+   */
+  auto loopFunction = LDI->getLoopStructure()->getFunction();
+  for (auto ss : *sss) {
+    auto kind = ss->isCommutative() ? "commutative" : "ordered";
+    for (auto inst : ss->getInstructions()) {
+      std::string location = loopFunction->getName().str() + ":?";
+      if (auto debugLocation = inst->getDebugLoc().get()) {
+        location = debugLocation->getFilename().str() + ":"
+                   + std::to_string(debugLocation->getLine()) + ":"
+                   + std::to_string(debugLocation->getColumn());
+      }
+      std::string instText;
+      raw_string_ostream instStream(instText);
+      inst->print(instStream);
+      instStream.flush();
+      auto firstCharacter = instText.find_first_not_of(" ");
+      if (firstCharacter != std::string::npos) {
+        instText = instText.substr(firstCharacter);
+      }
+      map << loopID << " " << ss->getID() << " " << kind << " " << location
+          << " " << instText << "\n";
+    }
+  }
+
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << this->prefixString << "  Profile the sequential segments of "
+           << "the loop " << loopID << " (see " << SegmentMapFile << ")\n";
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
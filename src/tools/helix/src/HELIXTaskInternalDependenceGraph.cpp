@@ -54,18 +54,24 @@ PDG *HELIX::constructTaskInternalDependenceGraphFromOriginalLoopDG(
 
   auto copyEdgeUsingTaskClonedValues =
       [&](DGEdge<Value> *originalEdge) -> void {
+    /*
+     * Instructions of a decoupled prologue have no clone in the task.
+     */
+    auto srcClone = helixTask->getCloneOfOriginalInstruction(
+        cast<Instruction>(originalEdge->getOutgoingT()));
+    auto dstClone = helixTask->getCloneOfOriginalInstruction(
+        cast<Instruction>(originalEdge->getIncomingT()));
+    if (false || (srcClone == nullptr) || (dstClone == nullptr)) {
+      return;
+    }
+
     DGEdge<Value> edgeToPointToClones(*originalEdge);
 
     // Loop carry dependencies will be recomputed
     edgeToPointToClones.setLoopCarried(false);
 
-    edgeToPointToClones.setNodePair(
-        this->taskFunctionDG->fetchNode(
-            helixTask->getCloneOfOriginalInstruction(
-                cast<Instruction>(originalEdge->getOutgoingT()))),
-        this->taskFunctionDG->fetchNode(
-            helixTask->getCloneOfOriginalInstruction(
-                cast<Instruction>(originalEdge->getIncomingT()))));
+    edgeToPointToClones.setNodePair(this->taskFunctionDG->fetchNode(srcClone),
+                                    this->taskFunctionDG->fetchNode(dstClone));
     this->taskFunctionDG->copyAddEdge(edgeToPointToClones);
   };
 
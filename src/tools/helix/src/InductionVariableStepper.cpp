@@ -100,42 +100,127 @@ void HELIX::rewireLoopForIVsToIterateNthIterations(LoopDependenceInfo *LDI) {
   auto clonedStepSizeMap = cloneIVStepValueComputation(LDI, 0, entryBuilder);
 
   /*
-   * Determine start value of the IV for the task
-   * core_start: original_start + original_step_size * core_id
+   * Check if the cores claim the iterations dynamically rather than running
+   * every N-th one.
    */
-  for (auto ivInfo : ivInfos) {
-    auto startOfIV = fetchClone(ivInfo->getStartValue());
-    auto stepOfIV = clonedStepSizeMap.at(ivInfo);
-    auto originalIVPHI = ivInfo->getLoopEntryPHI();
-    auto ivPHI = cast<PHINode>(fetchClone(originalIVPHI));
-
-    auto offsetStartValue =
-        IVUtility::computeInductionVariableValueForIteration(preheaderClone,
-                                                             ivPHI,
-                                                             startOfIV,
-                                                             stepOfIV,
-                                                             task->coreArg);
-    ivPHI->setIncomingValueForBlock(preheaderClone, offsetStartValue);
-  }
+  this->iterationTicket = nullptr;
+  if (this->doesClaimIterationsDynamically(LDI)) {
 
-  /*
-   * Determine additional step size to account for n cores each executing the
-   * task jump_step_size: original_step_size * (num_cores - 1)
-   */
-  for (auto ivInfo : ivInfos) {
-    auto stepOfIV = clonedStepSizeMap.at(ivInfo);
-    auto originalIVPHI = ivInfo->getLoopEntryPHI();
-    auto ivPHI = cast<PHINode>(fetchClone(originalIVPHI));
-
-    auto numCoresMinusOne = entryBuilder.CreateSub(
-        task->numCoresArg,
-        ConstantInt::get(task->numCoresArg->getType(), 1));
-    auto jumpStepSize = IVUtility::scaleInductionVariableStep(preheaderClone,
-                                                              ivPHI,
-                                                              stepOfIV,
-                                                              numCoresMinusOne);
-
-    IVUtility::stepInductionVariablePHI(preheaderClone, ivPHI, jumpStepSize);
+    /*
+     * Claim the first iteration of the task before entering the loop.
+     */
+    std::vector<Value *> claimArgs{ task->ssPastArrayArg };
+    IRBuilder<> preheaderBuilder(preheaderClone->getTerminator());
+    auto firstTicket =
+        preheaderBuilder.CreateCall(this->claimIterationCall, claimArgs);
+
+    /*
+     * Track the ticket of the current iteration in the header.
+     * Each latch claims the ticket of the next iteration the task runs.
+     */
+    IRBuilder<> headerBuilder(&*headerClone->begin());
+    auto ticketType = firstTicket->getType();
+    this->iterationTicket =
+        headerBuilder.CreatePHI(ticketType, pred_size(headerClone));
+    this->iterationTicket->addIncoming(firstTicket, preheaderClone);
+    std::unordered_map<BasicBlock *, Value *> skippedIterations;
+    for (auto latch : loopStructure->getLatches()) {
+      auto latchClone = task->getCloneOfOriginalBasicBlock(latch);
+      IRBuilder<> latchBuilder(latchClone->getTerminator());
+      auto nextTicket =
+          latchBuilder.CreateCall(this->claimIterationCall, claimArgs);
+      this->iterationTicket->addIncoming(nextTicket, latchClone);
+
+      /*
+       * Compute the iterations claimed by the other cores in between.
+       */
+      auto ticketsInBetween =
+          latchBuilder.CreateSub(nextTicket, this->iterationTicket);
+      skippedIterations[latchClone] =
+          latchBuilder.CreateSub(ticketsInBetween,
+                                 ConstantInt::get(ticketType, 1));
+    }
+
+    /*
+     * Determine start value of the IV for the task
+     * core_start: original_start + original_step_size * first_ticket
+     *
+     * Then, skip the iterations claimed by the other cores at every latch
+     * latch_step_size: original_step_size * (next_ticket - ticket - 1)
+     */
+    for (auto ivInfo : ivInfos) {
+      auto startOfIV = fetchClone(ivInfo->getStartValue());
+      auto stepOfIV = clonedStepSizeMap.at(ivInfo);
+      auto originalIVPHI = ivInfo->getLoopEntryPHI();
+      auto ivPHI = cast<PHINode>(fetchClone(originalIVPHI));
+
+      auto offsetStartValue =
+          IVUtility::computeInductionVariableValueForIteration(preheaderClone,
+                                                               ivPHI,
+                                                               startOfIV,
+                                                               stepOfIV,
+                                                               firstTicket);
+      ivPHI->setIncomingValueForBlock(preheaderClone, offsetStartValue);
+
+      for (auto i = 0; i < ivPHI->getNumIncomingValues(); ++i) {
+        auto B = ivPHI->getIncomingBlock(i);
+        if (B == preheaderClone) {
+          continue;
+        }
+        auto skipStepSize =
+            IVUtility::scaleInductionVariableStep(B,
+                                                  ivPHI,
+                                                  stepOfIV,
+                                                  skippedIterations.at(B));
+        auto nextValue = IVUtility::offsetIVPHI(B,
+                                                ivPHI,
+                                                ivPHI->getIncomingValue(i),
+                                                skipStepSize);
+        ivPHI->setIncomingValue(i, nextValue);
+      }
+    }
+
+  } else {
+
+    /*
+     * Determine start value of the IV for the task
+     * core_start: original_start + original_step_size * core_id
+     */
+    for (auto ivInfo : ivInfos) {
+      auto startOfIV = fetchClone(ivInfo->getStartValue());
+      auto stepOfIV = clonedStepSizeMap.at(ivInfo);
+      auto originalIVPHI = ivInfo->getLoopEntryPHI();
+      auto ivPHI = cast<PHINode>(fetchClone(originalIVPHI));
+
+      auto offsetStartValue =
+          IVUtility::computeInductionVariableValueForIteration(preheaderClone,
+                                                               ivPHI,
+                                                               startOfIV,
+                                                               stepOfIV,
+                                                               task->coreArg);
+      ivPHI->setIncomingValueForBlock(preheaderClone, offsetStartValue);
+    }
+
+    /*
+     * Determine additional step size to account for n cores each executing the
+     * task jump_step_size: original_step_size * (num_cores - 1)
+     */
+    for (auto ivInfo : ivInfos) {
+      auto stepOfIV = clonedStepSizeMap.at(ivInfo);
+      auto originalIVPHI = ivInfo->getLoopEntryPHI();
+      auto ivPHI = cast<PHINode>(fetchClone(originalIVPHI));
+
+      auto numCoresMinusOne = entryBuilder.CreateSub(
+          task->numCoresArg,
+          ConstantInt::get(task->numCoresArg->getType(), 1));
+      auto jumpStepSize =
+          IVUtility::scaleInductionVariableStep(preheaderClone,
+                                                ivPHI,
+                                                stepOfIV,
+                                                numCoresMinusOne);
+
+      IVUtility::stepInductionVariablePHI(preheaderClone, ivPHI, jumpStepSize);
+    }
   }
 
   /*
@@ -496,4 +581,27 @@ void HELIX::rewireLoopForIVsToIterateNthIterations(LoopDependenceInfo *LDI) {
   return;
 }
 
+bool HELIX::doesClaimIterationsDynamically(LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check if the loop asks for it.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  if (ltm->getHELIXSynchronization() != HELIX_DYNAMIC_SYNCHRONIZATION) {
+    return false;
+  }
+
+  /*
+   * Check if the runtime provides it.
+   */
+  if (false || (this->claimIterationCall == nullptr)
+      || (this->waitDynamicSSCall == nullptr)
+      || (this->signalDynamicSSCall == nullptr)
+      || (this->taskDispatcherDynamicSS == nullptr)) {
+    return false;
+  }
+
+  return true;
+}
+
 } // namespace llvm::noelle
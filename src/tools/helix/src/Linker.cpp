@@ -71,9 +71,16 @@ void HELIX::addChunkFunctionExecutionAsideOriginalLoop(
   /*
    * Call the function that incudes the parallelized loop.
    */
+  auto dispatcher = this->taskDispatcherSS;
+  if (this->iterationTicket != nullptr) {
+    dispatcher = this->taskDispatcherDynamicSS;
+  }
+  if (this->decoupledPrologueSCC != nullptr) {
+    dispatcher = this->taskDispatcherDecoupledPrologue;
+  }
   IRBuilder<> helixBuilder(this->entryPointOfParallelizedLoop);
   auto runtimeCall = helixBuilder.CreateCall(
-      this->taskDispatcherSS,
+      dispatcher,
       ArrayRef<Value *>({ (Value *)tasks[0]->getTaskBody(),
                           envPtr,
                           loopCarriedEnvPtr,
@@ -82,6 +89,11 @@ void HELIX::addChunkFunctionExecutionAsideOriginalLoop(
   auto numThreadsUsed =
       helixBuilder.CreateExtractValue(runtimeCall, (uint64_t)0);
 
+  /*
+   * Write the output buffered by the tasks.
+   */
+  this->generateCodeToWriteBufferedOutput(LDI, helixBuilder, envPtr);
+
   /*
    * Propagate the last value of live-out variables to the code outside the
    * parallelized loop.
@@ -76,10 +76,216 @@ void HELIX::squeezeSequentialSegments(LoopDependenceInfo *LDI,
   return;
 }
 
-void HELIX::scheduleSequentialSegments(LoopDependenceInfo *LDI,
+/*
+ * Return the number of instructions that are within the sequential segment
+ * @ssInstructions in each basic block of @blocks (i.e., from the first to the
+ * last instruction of the sequential segment of that block).
+ */
+static uint64_t getLengthOfSequentialSegment(
+    std::unordered_set<BasicBlock *> &blocks,
+    std::unordered_set<Instruction *> &ssInstructions) {
+  uint64_t length = 0;
+  for (auto block : blocks) {
+    uint64_t instructions = 0;
+    uint64_t instructionsUntilLastOfSS = 0;
+    for (auto &I : *block) {
+      if (true && (instructions == 0)
+          && (ssInstructions.find(&I) == ssInstructions.end())) {
+        continue;
+      }
+      instructions++;
+      if (ssInstructions.find(&I) != ssInstructions.end()) {
+        instructionsUntilLastOfSS = instructions;
+      }
+    }
+    length += instructionsUntilLastOfSS;
+  }
+
+  return length;
+}
+
+/*
+ * Check if @I depends on, or is depended on by, an instruction of @others
+ * according to @dg.
+ * Instructions that are not in @dg depend on everything.
+ */
+static bool isDependentOn(Instruction *I,
+                          std::unordered_set<Instruction *> &others,
+                          PDG *dg) {
+  if (!dg->isInGraph(I)) {
+    return true;
+  }
+  for (auto other : others) {
+    if (!dg->isInGraph(other)) {
+      return true;
+    }
+  }
+  auto node = dg->fetchNode(I);
+  for (auto edge : node->getIncomingEdges()) {
+    auto src = dyn_cast<Instruction>(edge->getOutgoingT());
+    if (true && (src != nullptr) && (others.find(src) != others.end())) {
+      return true;
+    }
+  }
+  for (auto edge : node->getOutgoingEdges()) {
+    auto dst = dyn_cast<Instruction>(edge->getIncomingT());
+    if (true && (dst != nullptr) && (others.find(dst) != others.end())) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Move the instructions of @block that are between the ones of a sequential
+ * segment (@ssInstructions), but that do not belong to it, out of it.
+ * Instructions are hoisted before the first instruction of the sequential
+ * segment if the dependences allow it, and they are sunk after the last one
+ * otherwise (if the dependences allow it).
+ * Instructions of other sequential segments (@otherSSsInstructions) are not
+ * moved.
+ */
+static bool compactSequentialSegmentInBlock(
+    BasicBlock *block,
+    std::unordered_set<Instruction *> &ssInstructions,
+    std::unordered_set<Instruction *> &otherSSsInstructions,
+    PDG *dg) {
+
+  /*
+   * Fetch the instructions from the first to the last one of the sequential
+   * segment.
+   */
+  std::vector<Instruction *> span;
+  uint64_t spanLength = 0;
+  for (auto &I : *block) {
+    auto isOfSS = (ssInstructions.find(&I) != ssInstructions.end());
+    if (true && span.empty() && (!isOfSS)) {
+      continue;
+    }
+    span.push_back(&I);
+    if (isOfSS) {
+      spanLength = span.size();
+    }
+  }
+  span.resize(spanLength);
+  if (span.size() <= 2) {
+    return false;
+  }
+  auto first = span.front();
+  auto last = span.back();
+
+  /*
+   * Define the instructions that can be moved.
+   */
+  auto canBeMoved = [&](Instruction *I) -> bool {
+    if (false || (ssInstructions.find(I) != ssInstructions.end())
+        || (otherSSsInstructions.find(I) != otherSSsInstructions.end())
+        || isa<PHINode>(I) || isa<AllocaInst>(I) || I->isTerminator()
+        || I->isEHPad()) {
+      return false;
+    }
+    return true;
+  };
+
+  /*
+   * Hoist the instructions that do not depend on the ones that stay in the
+   * sequential segment before them.
+   */
+  auto modified = false;
+  std::unordered_set<Instruction *> staying{ first };
+  std::unordered_set<Instruction *> hoisted;
+  for (auto i = 1u; i < (span.size() - 1); i++) {
+    auto I = span[i];
+    if (true && canBeMoved(I) && (!isDependentOn(I, staying, dg))) {
+      I->moveBefore(first);
+      hoisted.insert(I);
+      modified = true;
+      continue;
+    }
+    staying.insert(I);
+  }
+
+  /*
+   * Sink the remaining instructions that are not depended on by the ones that
+   * stay in the sequential segment after them.
+   */
+  if (last->isTerminator()) {
+    return modified;
+  }
+  staying.clear();
+  staying.insert(last);
+  auto insertPoint = last->getNextNode();
+  for (auto i = span.size() - 2; i > 0; i--) {
+    auto I = span[i];
+    if (hoisted.find(I) != hoisted.end()) {
+      continue;
+    }
+    if (false || (!canBeMoved(I)) || isDependentOn(I, staying, dg)) {
+      staying.insert(I);
+      continue;
+    }
+    I->moveBefore(insertPoint);
+    insertPoint = I;
+    modified = true;
+  }
+
+  return modified;
+}
+
+bool HELIX::scheduleSequentialSegments(LoopDependenceInfo *LDI,
                                        std::vector<SequentialSegment *> *sss,
                                        DataFlowResult *reachabilityDFR) {
-  // TODO
 
-  return;
+  /*
+   * Fetch the dependence graph of the task.
+   * It includes the dependences between the loads and stores of the spilled
+   * loop-carried variables.
+   */
+  auto taskDG = LDI->getLoopDG();
+
+  /*
+   * Compact the sequential segments within each basic block.
+   */
+  auto modified = false;
+  for (auto ss : *sss) {
+
+    /*
+     * Fetch the instructions of the sequential segment and the ones of the
+     * others.
+     */
+    auto ssInstructions = ss->getInstructions();
+    std::unordered_set<Instruction *> otherSSsInstructions;
+    for (auto otherSS : *sss) {
+      if (otherSS == ss) {
+        continue;
+      }
+      auto instructions = otherSS->getInstructions();
+      otherSSsInstructions.insert(instructions.begin(), instructions.end());
+    }
+    std::unordered_set<BasicBlock *> blocks;
+    for (auto I : ssInstructions) {
+      blocks.insert(I->getParent());
+    }
+
+    /*
+     * Compact the sequential segment.
+     */
+    auto lengthBefore = getLengthOfSequentialSegment(blocks, ssInstructions);
+    for (auto block : blocks) {
+      modified |= compactSequentialSegmentInBlock(block,
+                                                  ssInstructions,
+                                                  otherSSsInstructions,
+                                                  taskDG);
+    }
+    auto lengthAfter = getLengthOfSequentialSegment(blocks, ssInstructions);
+
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << this->prefixString << "  Sequential segment " << ss->getID()
+             << ": " << lengthBefore << " instructions before scheduling, "
+             << lengthAfter << " after\n";
+    }
+  }
+
+  return modified;
 }
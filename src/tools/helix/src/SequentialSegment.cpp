@@ -29,9 +29,11 @@ SequentialSegment::SequentialSegment(Noelle &noelle,
                                      DataFlowResult *reachabilityDFR,
                                      SCCSet *sccs,
                                      int32_t ID,
+                                     bool isCommutative,
                                      Verbosity verbosity,
                                      const std::string &prefixString)
-  : verbosity{ verbosity } {
+  : commutative{ isCommutative },
+    verbosity{ verbosity } {
 
   /*
    * Set the loop function, header, ID, and SCC set of the SS
@@ -123,6 +125,10 @@ int32_t SequentialSegment::getID(void) {
   return this->ID;
 }
 
+bool SequentialSegment::isCommutative(void) const {
+  return this->commutative;
+}
+
 void SequentialSegment::determineEntryAndExitFrontier(
     LoopDependenceInfo *LDI,
     DominatorSummary *DS,
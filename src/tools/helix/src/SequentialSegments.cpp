@@ -28,7 +28,8 @@ namespace llvm::noelle {
 std::vector<SequentialSegment *> HELIX::identifySequentialSegments(
     LoopDependenceInfo *originalLDI,
     LoopDependenceInfo *LDI,
-    DataFlowResult *reachabilityDFR) {
+    DataFlowResult *reachabilityDFR,
+    Heuristics *h) {
 
   /*
    * Fetch the task.
@@ -148,27 +149,16 @@ std::vector<SequentialSegment *> HELIX::identifySequentialSegments(
   auto wasOriginalLoopIVGoverned =
       originalLDI->getLoopGoverningIVAttribution() != nullptr;
 
-  /*
-   * Fetch the subsets.
-   */
-  auto sets = this->partitioner->getDepthOrderedSets();
-
   /*
    * Fetch the set of SCCs that have loop-carried data dependences.
    */
   auto depsSCCs = sccManager->getSCCsWithLoopCarriedDataDependencies();
 
   /*
-   * Allocate the sequential segments, one per partition.
+   * Define the code that checks if a set of SCCs requires a sequential
+   * segment.
    */
-  int32_t ssID = 0;
-  std::vector<SequentialSegment *> sss;
-  for (auto set : sets) {
-
-    /*
-     * Check if the current set of SCCs require a sequential segment.
-     */
-    auto requireSS = false;
+  auto requiresSS = [&](SCCSet *set) -> bool {
     for (auto scc : set->sccs) {
 
       /*
@@ -184,6 +174,15 @@ std::vector<SequentialSegment *> HELIX::identifySequentialSegments(
         sccInfo = originalSCCManager->getSCCAttrs(sccToAnalyze);
       }
 
+      /*
+       * Do not synchronize a decoupled prologue: its producer runs it, and the
+       * consumption of its values follows the order of the iterations already.
+       */
+      if (false || (sccToAnalyze == this->decoupledPrologueSCC)
+          || this->isPartOfTheDecoupledPrologue(scc)) {
+        continue;
+      }
+
       /*
        * Do not synchronize induction variables
        */
@@ -205,11 +204,76 @@ std::vector<SequentialSegment *> HELIX::identifySequentialSegments(
        * FIXME: A reducible SCC should not be sequential in nature
        */
       if (sccInfo->mustExecuteSequentially()) {
-        requireSS = true;
-        break;
+        return true;
+      }
+    }
+    return false;
+  };
+
+  /*
+   * Define the code that checks if the SCCs of a sequential segment can run in
+   * any order across iterations (i.e., all of its sequential SCCs are
+   * commutative).
+   */
+  auto isCommutative = [&](SCCSet *set) -> bool {
+    for (auto scc : set->sccs) {
+      auto sccInfo = sccManager->getSCCAttrs(scc);
+      if (taskToOriginalFunctionSCCMap.find(scc)
+          != taskToOriginalFunctionSCCMap.end()) {
+        auto originalSCC = taskToOriginalFunctionSCCMap.at(scc);
+        sccInfo = originalSCCManager->getSCCAttrs(originalSCC);
+      }
+      if (sccInfo->isInductionVariableSCC()) {
+        continue;
+      }
+      if (true && wasOriginalLoopIVGoverned
+          && (depsSCCs.find(scc) == depsSCCs.end())) {
+        continue;
+      }
+      if (true && sccInfo->mustExecuteSequentially()
+          && (!sccInfo->isCommutative())) {
+        return false;
       }
     }
-    if (!requireSS) {
+    return true;
+  };
+
+  /*
+   * Merge sequential segments depending on how long they take, which requires
+   * the profiles of the original loop.
+   */
+  auto profiles = this->noelle.getProfiles();
+  auto originalLoopStructure = originalLDI->getLoopStructure();
+  this->predictedSequentialFraction = -1;
+  if (true && profiles->isAvailable()
+      && (profiles->getIterations(originalLoopStructure) > 0)) {
+    auto ltm = LDI->getLoopTransformationsManager();
+    this->predictedSequentialFraction = h->adjustSequentialSegmentsForHELIX(
+        this->partitioner,
+        requiresSS,
+        taskToOriginalFunctionSCCMap,
+        originalSCCDAG,
+        profiles->getIterations(originalLoopStructure),
+        ltm->getMaximumNumberOfCores(),
+        this->verbose);
+  }
+
+  /*
+   * Fetch the subsets.
+   */
+  auto sets = this->partitioner->getDepthOrderedSets();
+
+  /*
+   * Allocate the sequential segments, one per partition.
+   */
+  int32_t ssID = 0;
+  std::vector<SequentialSegment *> sss;
+  for (auto set : sets) {
+
+    /*
+     * Check if the current set of SCCs require a sequential segment.
+     */
+    if (!requiresSS(set)) {
       continue;
     }
 
@@ -223,6 +287,7 @@ std::vector<SequentialSegment *> HELIX::identifySequentialSegments(
                                     reachabilityDFR,
                                     set,
                                     ssID,
+                                    isCommutative(set),
                                     this->verbose,
                                     s);
 
@@ -21,6 +21,7 @@
  */
 #include "HELIX.hpp"
 #include "HELIXTask.hpp"
+#include "noelle/core/Architecture.hpp"
 
 namespace llvm::noelle {
 
@@ -72,6 +73,9 @@ void HELIX::spillLoopCarriedDataDependencies(LoopDependenceInfo *LDI,
     if (loopIVManager->doesContributeToComputeAnInductionVariable(&phi)) {
       continue;
     }
+    if (phiSCC == this->decoupledPrologueSCC) {
+      continue;
+    }
     errs() << this->prefixString << "    Spill " << phi << "\n";
     originalLoopCarriedPHIs.push_back(&phi);
     auto clonePHI = (PHINode *)(helixTask->getCloneOfOriginalInstruction(&phi));
@@ -534,4 +538,157 @@ void HELIX::replaceUsesOfSpilledPHIWithLoads(
   return;
 }
 
+void HELIX::forwardSpilledLoopCarriedValuesThroughSignals(
+    LoopDependenceInfo *LDI,
+    std::vector<SequentialSegment *> *sss,
+    std::vector<Value *> &ssPastPtrs,
+    std::vector<Value *> &ssFuturePtrs) {
+
+  /*
+   * Fetch the task and the loop.
+   */
+  auto helixTask = static_cast<HELIXTask *>(this->tasks[0]);
+  auto loopStructure = LDI->getLoopStructure();
+  auto &DL = this->noelle.getProgram()->getDataLayout();
+  auto tm = this->noelle.getTypesManager();
+  auto int8 = tm->getIntegerType(8);
+  auto int64 = tm->getIntegerType(64);
+  auto entryBlock = helixTask->getEntry();
+  IRBuilder<> entryBuilder(entryBlock->getTerminator());
+
+  /*
+   * The mailbox of a sequential segment is the part of its cache line that
+   * follows the synchronization variables (see HELIX_sequentialSegment_t in
+   * the runtime).
+   * Core i writes the mailbox of core i+1 (its future array) just before
+   * signaling it, so core i+1 receives the value with the cache line it waits
+   * on.
+   */
+  uint64_t mailboxBegin = 8;
+  uint64_t mailboxEnd = Architecture::getCacheLineBytes();
+  std::vector<uint64_t> mailboxOffsets(sss->size(), mailboxBegin);
+  auto isFirstCore = entryBuilder.CreateICmpEQ(
+      helixTask->coreArg,
+      ConstantInt::get(helixTask->coreArg->getType(), 0));
+
+  for (auto spill : this->spills) {
+
+    /*
+     * Fetch the sequential segment that protects the spilled variable.
+     */
+    auto spillStore = *spill->environmentStores.begin();
+    auto spillPtr = spillStore->getPointerOperand();
+    SequentialSegment *spillSS = nullptr;
+    for (auto ss : *sss) {
+      auto ssInstructions = ss->getInstructions();
+      if (ssInstructions.find(spillStore) != ssInstructions.end()) {
+        spillSS = ss;
+        break;
+      }
+    }
+    if (spillSS == nullptr) {
+      continue;
+    }
+
+    /*
+     * Commutative sequential segments do not pass their cache line from a core
+     * to the next one.
+     */
+    if (spillSS->isCommutative()) {
+      continue;
+    }
+
+    /*
+     * Every access to the spilled variable within the loop must be protected
+     * by that sequential segment. Accesses outside the loop follow the waits
+     * injected at the loop exits.
+     */
+    auto ssInstructions = spillSS->getInstructions();
+    std::vector<Instruction *> spillAccesses;
+    auto canBeForwarded = true;
+    for (auto user : spillPtr->users()) {
+      auto userInst = dyn_cast<Instruction>(user);
+      auto storeInst = dyn_cast_or_null<StoreInst>(userInst);
+      if (false || (userInst == nullptr)
+          || (true && (!isa<LoadInst>(userInst)) && (storeInst == nullptr))
+          || (true && (storeInst != nullptr)
+              && (storeInst->getPointerOperand() != spillPtr))) {
+        canBeForwarded = false;
+        break;
+      }
+      if (true && loopStructure->isIncluded(userInst)
+          && (ssInstructions.find(userInst) == ssInstructions.end())) {
+        canBeForwarded = false;
+        break;
+      }
+      spillAccesses.push_back(userInst);
+    }
+    if (!canBeForwarded) {
+      continue;
+    }
+
+    /*
+     * Reserve the space for the variable in the mailbox.
+     */
+    auto spillType = spillStore->getValueOperand()->getType();
+    auto ssID = spillSS->getID();
+    auto offset = alignTo(mailboxOffsets.at(ssID),
+                          DL.getABITypeAlignment(spillType));
+    auto size = DL.getTypeAllocSize(spillType);
+    if ((offset + size) > mailboxEnd) {
+      continue;
+    }
+    mailboxOffsets[ssID] = offset + size;
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << this->prefixString << "  Forward " << *spillType
+             << " through the signals of sequential segment " << ssID << "\n";
+    }
+
+    /*
+     * Compute the pointers to the mailboxes.
+     */
+    auto fetchMailbox = [&entryBuilder, int8, int64, offset, spillPtr](
+                            Value *ssEntry) -> Value * {
+      auto mailbox =
+          entryBuilder.CreateInBoundsGEP(int8,
+                                         ssEntry,
+                                         ConstantInt::get(int64, offset));
+      return entryBuilder.CreateBitCast(mailbox, spillPtr->getType());
+    };
+    auto pastMailbox = fetchMailbox(ssPastPtrs.at(ssID));
+    auto futureMailbox = fetchMailbox(ssFuturePtrs.at(ssID));
+
+    /*
+     * The first iteration runs on the first core, which receives the initial
+     * value from the spill environment.
+     * The mailboxes of the other cores are written by their predecessors,
+     * possibly before they start. Hence, they write a local slot instead.
+     */
+    auto unusedSlot = entryBuilder.CreateAlloca(spillType);
+    unusedSlot->moveBefore(entryBlock->getFirstNonPHIOrDbgOrLifetime());
+    auto initialValue = entryBuilder.CreateLoad(spillPtr);
+    auto initialSlot =
+        entryBuilder.CreateSelect(isFirstCore, pastMailbox, unusedSlot);
+    entryBuilder.CreateStore(initialValue, initialSlot);
+
+    /*
+     * Redirect the accesses to the mailboxes.
+     * Stores also write the mailbox of the current core because the current
+     * iteration can load the variable again after having stored it.
+     */
+    for (auto access : spillAccesses) {
+      if (auto loadInst = dyn_cast<LoadInst>(access)) {
+        loadInst->setOperand(loadInst->getPointerOperandIndex(), pastMailbox);
+        continue;
+      }
+      auto storeInst = cast<StoreInst>(access);
+      storeInst->setOperand(storeInst->getPointerOperandIndex(), pastMailbox);
+      IRBuilder<> forwardBuilder(storeInst->getNextNode());
+      forwardBuilder.CreateStore(storeInst->getValueOperand(), futureMailbox);
+    }
+  }
+
+  return;
+}
+
 } // namespace llvm::noelle
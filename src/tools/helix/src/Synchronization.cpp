@@ -58,6 +58,40 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
   auto &cxt = loopFunction->getContext();
   auto int64 = IntegerType::get(cxt, 64);
 
+  /*
+   * Select the synchronization functions to use.
+   * A loop uses a single mechanism.
+   * The dynamic one waits by spinning and then yielding the core like the
+   * adaptive one does, so it subsumes it.
+   */
+  auto waitCall = this->waitSSCall;
+  auto signalCall = this->signalSSCall;
+  auto ltm = LDI->getLoopTransformationsManager();
+  auto synchronization = ltm->getHELIXSynchronization();
+  auto dynamicIterations = (this->iterationTicket != nullptr);
+  if (dynamicIterations) {
+    assert(synchronization == HELIX_DYNAMIC_SYNCHRONIZATION);
+    waitCall = this->waitDynamicSSCall;
+    signalCall = this->signalDynamicSSCall;
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << this->prefixString << "  Cores claim iterations dynamically\n";
+    }
+  } else if (true && (synchronization == HELIX_ADAPTIVE_SYNCHRONIZATION)
+             && (this->waitAdaptiveSSCall != nullptr)
+             && (this->signalAdaptiveSSCall != nullptr)) {
+    waitCall = this->waitAdaptiveSSCall;
+    signalCall = this->signalAdaptiveSSCall;
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << this->prefixString
+             << "  Use adaptive synchronization of sequential segments\n";
+    }
+  } else if (true && (synchronization != HELIX_SPINLOCK_SYNCHRONIZATION)
+             && (this->verbose != Verbosity::Disabled)) {
+    errs() << this->prefixString
+           << "  The synchronization requested is not available in the "
+              "runtime; use spin locks\n";
+  }
+
   /*
    * HACK: Fetch the first sequential segment instructions that can be entered
    * This is necessary because we do not re-order instructions not dependent on
@@ -86,6 +120,69 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
     }
   }
 
+  /*
+   * Identify the sequential segments that do not need to follow the order of
+   * the iterations.
+   * These are the commutative ones: each iteration executes them one at a time
+   * (within a critical section), but in any order.
+   */
+  std::unordered_set<SequentialSegment *> unorderedSSs;
+  if (true && (this->enterCriticalSectionCall != nullptr)
+      && (this->exitCriticalSectionCall != nullptr)) {
+    for (auto ss : *sss) {
+      if (true && ss->isCommutative() && (ss != preambleSS)) {
+        unorderedSSs.insert(ss);
+        if (this->verbose != Verbosity::Disabled) {
+          errs() << this->prefixString << "  Sequential segment "
+                 << ss->getID()
+                 << " is commutative: use a critical section\n";
+        }
+      }
+    }
+  }
+  auto getWaitCall = [&](SequentialSegment *ss) -> Function * {
+    if (unorderedSSs.find(ss) != unorderedSSs.end()) {
+      return this->enterCriticalSectionCall;
+    }
+    return waitCall;
+  };
+  auto getSignalCall = [&](SequentialSegment *ss) -> Function * {
+    if (unorderedSSs.find(ss) != unorderedSSs.end()) {
+      return this->exitCriticalSectionCall;
+    }
+    return signalCall;
+  };
+
+  /*
+   * Define a helper to fetch the arguments of a synchronization call.
+   * When the iterations are claimed dynamically, the ordered sequential
+   * segments are synchronized on the ticket of the current iteration.
+   */
+  auto getSyncArgs = [&](SequentialSegment *ss,
+                         Value *ssPtr) -> std::vector<Value *> {
+    std::vector<Value *> args{ ssPtr };
+    if (true && dynamicIterations
+        && (unorderedSSs.find(ss) == unorderedSSs.end())) {
+      args.push_back(this->iterationTicket);
+    }
+    return args;
+  };
+
+  /*
+   * Check if the sequential segments must be profiled.
+   * In this case, their instructions are written to the map that the profile
+   * is matched against.
+   */
+  auto loopIDToProfile = this->getIDOfLoopToProfileSegments(LDI);
+  auto profileSegments = (loopIDToProfile >= 0);
+  if (profileSegments) {
+    this->dumpSequentialSegmentsMap(LDI, loopIDToProfile, sss);
+  }
+  auto getProfileArgs = [&](SequentialSegment *ss) -> std::vector<Value *> {
+    return { ConstantInt::get(int64, loopIDToProfile),
+             ConstantInt::get(int64, ss->getID()) };
+  };
+
   /*
    * Define a helper to fetch the appropriate ss entry in synchronization arrays
    */
@@ -110,10 +207,33 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
    * Allocate space to track sequential segment entry state
    */
   std::vector<Value *> ssPastPtrs{}, ssFuturePtrs{}, ssStates{};
+  auto program = loopFunction->getParent();
   for (auto ss : *sss) {
-    ssPastPtrs.push_back(fetchEntry(helixTask->ssPastArrayArg, ss->getID()));
-    ssFuturePtrs.push_back(
-        fetchEntry(helixTask->ssFutureArrayArg, ss->getID()));
+    if (unorderedSSs.find(ss) == unorderedSSs.end()) {
+      ssPastPtrs.push_back(fetchEntry(helixTask->ssPastArrayArg, ss->getID()));
+      ssFuturePtrs.push_back(
+          fetchEntry(helixTask->ssFutureArrayArg, ss->getID()));
+
+    } else {
+
+      /*
+       * The critical section of a commutative sequential segment is shared by
+       * all cores.
+       * It has its own cache line to avoid false sharing.
+       */
+      auto lock =
+          new GlobalVariable(*program,
+                             int64,
+                             false,
+                             GlobalValue::InternalLinkage,
+                             ConstantInt::get(int64, 0),
+                             "noelle.helix.criticalSection");
+      lock->setAlignment(Architecture::getCacheLineBytes());
+      auto lockPtr =
+          ConstantExpr::getBitCast(lock, helixTask->ssPastArrayArg->getType());
+      ssPastPtrs.push_back(lockPtr);
+      ssFuturePtrs.push_back(lockPtr);
+    }
 
     /*
      * We must execute exactly one wait instruction for each sequential segment,
@@ -174,8 +294,17 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
     auto ssWaitBB =
         BasicBlock::Create(cxt, ssWaitBBName, helixTask->getTaskBody());
     IRBuilder<> ssWaitBuilder(ssWaitBB);
-    auto wait = ssWaitBuilder.CreateCall(this->waitSSCall,
-                                         { ssPastPtrs.at(ss->getID()) });
+    if (profileSegments) {
+      ssWaitBuilder.CreateCall(this->segmentProfileWaitCall,
+                               getProfileArgs(ss));
+    }
+    auto wait = ssWaitBuilder.CreateCall(
+        getWaitCall(ss),
+        getSyncArgs(ss, ssPastPtrs.at(ss->getID())));
+    if (profileSegments) {
+      ssWaitBuilder.CreateCall(this->segmentProfileEnterCall,
+                               getProfileArgs(ss));
+    }
     auto ssState = ssStates.at(ss->getID());
     ssWaitBuilder.CreateStore(ConstantInt::get(int64, 1), ssState);
     ssWaitBuilder.CreateBr(ssEntryBB);
@@ -217,9 +346,13 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
                                      ? terminator
                                      : justBeforeExit->getNextNode();
       IRBuilder<> beforeExitBuilder(insertPoint);
-      auto signal =
-          beforeExitBuilder.CreateCall(this->signalSSCall,
-                                       { ssFuturePtrs.at(ss->getID()) });
+      if (profileSegments) {
+        beforeExitBuilder.CreateCall(this->segmentProfileExitCall,
+                                     getProfileArgs(ss));
+      }
+      auto signal = beforeExitBuilder.CreateCall(
+          getSignalCall(ss),
+          getSyncArgs(ss, ssFuturePtrs.at(ss->getID())));
       helixTask->signals.insert(cast<CallInst>(signal));
       return;
     }
@@ -227,9 +360,13 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
     for (auto successorBlock : successors(block)) {
       IRBuilder<> beforeExitBuilder(
           successorBlock->getFirstNonPHIOrDbgOrLifetime());
-      auto signal =
-          beforeExitBuilder.CreateCall(this->signalSSCall,
-                                       { ssFuturePtrs.at(ss->getID()) });
+      if (profileSegments) {
+        beforeExitBuilder.CreateCall(this->segmentProfileExitCall,
+                                     getProfileArgs(ss));
+      }
+      auto signal = beforeExitBuilder.CreateCall(
+          getSignalCall(ss),
+          getSyncArgs(ss, ssFuturePtrs.at(ss->getID())));
       helixTask->signals.insert(cast<CallInst>(signal));
     }
   };
@@ -266,8 +403,18 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
    * Add wait and signal instructions to the last-iteration-body if it exists.
    */
   if (this->lastIterationExecutionBlock != nullptr) {
+    auto lastIterationTerminator =
+        this->lastIterationExecutionBlock->getTerminator();
     for (auto ss : *sss) {
       injectWait(ss, this->lastIterationExecutionBlock->getFirstNonPHI());
+
+      /*
+       * The critical section of a commutative sequential segment must be left
+       * for the other cores to complete their iterations.
+       */
+      if (unorderedSSs.find(ss) != unorderedSSs.end()) {
+        injectSignal(ss, lastIterationTerminator);
+      }
     }
   }
 
@@ -404,6 +551,23 @@ void HELIX::addSynchronizations(LoopDependenceInfo *LDI,
     }
   }
 
+  /*
+   * Forward the spilled variables through the cache lines of the sequential
+   * segments that protect them.
+   * This must follow the injection of waits and signals because the values
+   * need to be stored just before signaling.
+   *
+   * The values are not forwarded when the iterations are claimed dynamically
+   * because the core that runs the first iteration is unknown at compile time.
+   */
+  if (true && this->noelle.shouldHELIXForwardLoopCarriedValues()
+      && (!dynamicIterations)) {
+    this->forwardSpilledLoopCarriedValuesThroughSignals(LDI,
+                                                        sss,
+                                                        ssPastPtrs,
+                                                        ssFuturePtrs);
+  }
+
   return;
 }
 
@@ -42,14 +42,86 @@ public:
   /*
    * Methods
    */
-  Heuristics(Noelle &noelle);
+  Heuristics(Noelle &noelle,
+             const std::string &microArchitecture,
+             const std::string &overheadsFileName,
+             uint32_t numberOfThreads);
 
   void adjustParallelizationPartitionForDSWP(SCCDAGPartitioner *partitioner,
                                              SCCDAGAttrs &attrs,
                                              uint64_t numThreads,
                                              Verbosity verbose);
 
+  /*
+   * Compute the number of cores each stage of a DSWP pipeline runs on.
+   * The work of @stageSCCs is split across the replicas of a stage, while
+   * each replica executes all of @clonedSCCs and pops all of @poppedValues.
+   * Only the stages flagged in @canBeReplicated get more than one core.
+   */
+  std::vector<uint32_t> getReplicasOfDSWPStages(
+      std::vector<std::set<SCC *>> const &stageSCCs,
+      std::vector<std::set<SCC *>> const &clonedSCCs,
+      std::vector<std::set<Value *>> const &poppedValues,
+      std::vector<bool> const &canBeReplicated,
+      uint64_t numThreads,
+      Verbosity verbose);
+
+  /*
+   * Compute the number of slots of each queue of a DSWP pipeline whose stages
+   * run on @replicas cores (see getReplicasOfDSWPStages for the other
+   * arguments).
+   * Queue i goes from stage @queueStages[i].first to stage
+   * @queueStages[i].second, and each of its slots takes @slotBytes[i] bytes.
+   * The capacities are powers of 2.
+   */
+  std::vector<uint64_t> getCapacitiesOfDSWPQueues(
+      std::vector<std::set<SCC *>> const &stageSCCs,
+      std::vector<std::set<SCC *>> const &clonedSCCs,
+      std::vector<std::set<Value *>> const &poppedValues,
+      std::vector<uint32_t> const &replicas,
+      std::vector<std::pair<uint32_t, uint32_t>> const &queueStages,
+      std::vector<uint64_t> const &slotBytes,
+      Verbosity verbose);
+
+  /*
+   * Decide whether a clonable SCC of a DSWP pipeline should run only in the
+   * first stage that uses it, which then sends its values to the other
+   * stages that use it through queues.
+   * @sentValues[i] are the values the other i-th stage would pop.
+   * Return false if cloning the SCC into every stage is cheaper.
+   */
+  bool shouldSendClonableSCCOfDSWP(
+      SCC *scc,
+      std::vector<std::set<Value *>> const &sentValues,
+      Verbosity verbose);
+
+  /*
+   * Merge the sequential segments of a HELIX loop when the profiles predict
+   * that saving their synchronizations outweighs the overlap lost.
+   * @isSequential tells whether a set of @partitioner runs as a sequential
+   * segment. @profiledSCCs maps the SCCs of the partition to the SCCs of
+   * @profiledSCCDAG that have been profiled, which executed @iterations
+   * iterations.
+   * Return the predicted fraction of an iteration spent in sequential
+   * segments.
+   */
+  double adjustSequentialSegmentsForHELIX(
+      SCCDAGPartitioner *partitioner,
+      std::function<bool(SCCSet *set)> isSequential,
+      std::unordered_map<SCC *, SCC *> const &profiledSCCs,
+      SCCDAG *profiledSCCDAG,
+      uint64_t iterations,
+      uint64_t numThreads,
+      Verbosity verbose);
+
 private:
+  void computeCyclesOfDSWPStages(
+      std::vector<std::set<SCC *>> const &stageSCCs,
+      std::vector<std::set<SCC *>> const &clonedSCCs,
+      std::vector<std::set<Value *>> const &poppedValues,
+      std::vector<uint64_t> &work,
+      std::vector<uint64_t> &fixedCost);
+
   void minMaxMergePartition(SCCDAGPartitioner &partitioner,
                             SCCDAGAttrs &attrs,
                             uint64_t numThreads,
@@ -60,7 +132,10 @@ private:
                                   uint64_t numThreads,
                                   Verbosity verbose);
 
+  InstructionLatencies latencies;
+  ParallelizationOverheads overheads;
   InvocationLatency invocationLatency;
+  uint32_t numberOfThreads;
 };
 
 } // namespace llvm::noelle
@@ -43,5 +43,10 @@ public:
   bool runOnModule(Module &M) override;
 
   Heuristics *getHeuristics(Noelle &noelle);
+
+private:
+  std::string microArchitecture;
+  std::string overheadsFileName;
+  uint32_t numberOfThreads;
 };
 } // namespace llvm::noelle
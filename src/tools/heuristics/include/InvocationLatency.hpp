@@ -26,15 +26,35 @@
 #include "noelle/core/SCCDAGAttrs.hpp"
 #include "noelle/core/SCCDAGPartition.hpp"
 #include "noelle/core/Hot.hpp"
+#include "noelle/core/InstructionLatencies.hpp"
+#include "noelle/core/ParallelizationOverheads.hpp"
 
 namespace llvm::noelle {
 
+/*
+ * Cycles spent by the code of a loop on the current target.
+ * The cycles of the instructions come from the latency table of the target,
+ * and the ones of the queues come from the measured parallelization
+ * overheads.
+ */
 class InvocationLatency {
 public:
-  InvocationLatency(Hot *hot);
+  InvocationLatency(Hot *hot,
+                    InstructionLatencies const &latencies,
+                    ParallelizationOverheads const &overheads);
 
+  /*
+   * The instructions of an SCC with a dependence cycle are serialized, so
+   * they take their latencies. The other ones overlap, so they take their
+   * reciprocal throughputs.
+   */
   uint64_t latencyPerInvocation(SCC *scc);
 
+  /*
+   * Once the latency of a group of sets has been computed, the latency of any
+   * other group of the same SCCs only reads memoized results. Hence, it can
+   * be computed by several threads in parallel.
+   */
   uint64_t latencyPerInvocation(SCCDAGAttrs *,
                                 std::unordered_set<SCCSet *> &subsets);
 
@@ -47,8 +67,11 @@ public:
   std::set<SCC *> &memoizeParents(SCCDAGAttrs *, SCC *);
 
 private:
+  double cyclesOfCallees(Instruction *inst) const;
+
   Hot *profiles;
-  std::unordered_map<Function *, uint64_t> funcToCost;
+  InstructionLatencies const &latencies;
+  ParallelizationOverheads const &overheads;
   std::unordered_map<Value *, uint64_t> queueValToCost;
   std::unordered_map<SCC *, uint64_t> sccToCost;
   std::unordered_map<SCC *, std::set<Value *>> incomingExternals;
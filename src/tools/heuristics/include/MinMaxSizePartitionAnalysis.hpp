@@ -45,5 +45,12 @@ public:
     : PartitionCostAnalysis{ IL, p, attrs, cores, v } {};
 
   void checkIfShouldMerge(SCCSet *sA, SCCSet *sB);
+
+protected:
+  bool evaluateMerge(SCCSet *sA,
+                     SCCSet *sB,
+                     std::unordered_set<SCCSet *> &setsInMerge,
+                     uint64_t &cost,
+                     uint64_t &instructionCount) override;
 };
 } // namespace llvm::noelle
@@ -50,11 +50,36 @@ public:
 
   bool mergeCandidateSubsets();
 
+  /*
+   * Merge the cheapest candidate until no candidate is left.
+   * This is equivalent to alternating traverseAllPartitionSubsets and
+   * mergeCandidateSubsets, but candidates are kept in a priority queue and
+   * only the ones that include the merged set are evaluated after a merge.
+   * Evaluations run on @numThreads threads.
+   *
+   * @return true if at least one merge happened.
+   */
+  bool mergeAllCandidateSubsets(uint32_t numThreads);
+
   void printCandidate(raw_ostream &stream);
 
   const static std::string prefix;
 
 protected:
+  /*
+   * Evaluate merging @sA with @sB: set @setsInMerge to the sets that would be
+   * merged, @cost to the latency of the merged set, and @instructionCount to
+   * its static instructions.
+   * It only reads the partition, so it can be invoked in parallel.
+   *
+   * @return false if the sets should not be merged.
+   */
+  virtual bool evaluateMerge(SCCSet *sA,
+                             SCCSet *sB,
+                             std::unordered_set<SCCSet *> &setsInMerge,
+                             uint64_t &cost,
+                             uint64_t &instructionCount);
+
   InvocationLatency &IL;
   SCCDAGPartitioner &partitioner;
   SCCDAGAttrs &dagAttrs;
@@ -70,6 +95,19 @@ protected:
   uint64_t costOfMergedSet;
 
   Verbosity verbose;
+
+private:
+  struct MergeCandidate {
+    SCC *sccOfParent;
+    SCC *sccOfChild;
+    uint64_t cost;
+    uint64_t instructionCount;
+    uint64_t id;
+  };
+
+  std::vector<MergeCandidate> evaluateMerges(
+      std::vector<std::pair<SCCSet *, SCCSet *>> const &pairs,
+      uint32_t numThreads);
 };
 
 } // namespace llvm::noelle
@@ -19,13 +19,25 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "noelle/core/Architecture.hpp"
 #include "../include/Heuristics.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
 
-Heuristics::Heuristics(Noelle &noelle)
-  : invocationLatency{ noelle.getProfiles() } {
+Heuristics::Heuristics(Noelle &noelle,
+                       const std::string &microArchitecture,
+                       const std::string &overheadsFileName,
+                       uint32_t numberOfThreads)
+  : latencies{ microArchitecture },
+    overheads{},
+    invocationLatency{ noelle.getProfiles(), latencies, overheads },
+    numberOfThreads{ numberOfThreads } {
+
+  /*
+   * Load the measured costs of the queues.
+   */
+  this->overheads.load(overheadsFileName);
 
   return;
 }
@@ -39,25 +51,329 @@ void Heuristics::adjustParallelizationPartitionForDSWP(
   minMaxMergePartition(*partitioner, attrs, numThreads, verbose);
 }
 
+std::vector<uint32_t> Heuristics::getReplicasOfDSWPStages(
+    std::vector<std::set<SCC *>> const &stageSCCs,
+    std::vector<std::set<SCC *>> const &clonedSCCs,
+    std::vector<std::set<Value *>> const &poppedValues,
+    std::vector<bool> const &canBeReplicated,
+    uint64_t numThreads,
+    Verbosity verbose) {
+  auto numStages = stageSCCs.size();
+  std::vector<uint32_t> replicas(numStages, 1);
+
+  /*
+   * Compute the cycles of each stage.
+   */
+  std::vector<uint64_t> work;
+  std::vector<uint64_t> fixedCost;
+  this->computeCyclesOfDSWPStages(stageSCCs,
+                                  clonedSCCs,
+                                  poppedValues,
+                                  work,
+                                  fixedCost);
+  auto cyclesOfStage = [&work, &fixedCost](uint32_t stage,
+                                           uint32_t replicas) -> uint64_t {
+    return (work[stage] / replicas) + fixedCost[stage];
+  };
+
+  /*
+   * The pipeline runs at the speed of its slowest stage.
+   * Give the spare cores to the slowest stage, one at a time, until it cannot
+   * be replicated or until another replica would not speed it up.
+   */
+  auto cores = numStages;
+  while (cores < numThreads) {
+    uint32_t slowestStage = 0;
+    for (auto i = 1u; i < numStages; i++) {
+      if (cyclesOfStage(i, replicas[i])
+          > cyclesOfStage(slowestStage, replicas[slowestStage])) {
+        slowestStage = i;
+      }
+    }
+    if (!canBeReplicated[slowestStage]) {
+      break;
+    }
+    auto currentCycles = cyclesOfStage(slowestStage, replicas[slowestStage]);
+    auto newCycles = cyclesOfStage(slowestStage, replicas[slowestStage] + 1);
+    if (newCycles >= currentCycles) {
+      break;
+    }
+    replicas[slowestStage]++;
+    cores++;
+  }
+
+  if (verbose != Verbosity::Disabled) {
+    for (auto i = 0u; i < numStages; i++) {
+      if (replicas[i] == 1) {
+        continue;
+      }
+      errs() << "Heuristics:  DSWP stage " << i << " runs on " << replicas[i]
+             << " cores\n";
+    }
+  }
+
+  return replicas;
+}
+
+std::vector<uint64_t> Heuristics::getCapacitiesOfDSWPQueues(
+    std::vector<std::set<SCC *>> const &stageSCCs,
+    std::vector<std::set<SCC *>> const &clonedSCCs,
+    std::vector<std::set<Value *>> const &poppedValues,
+    std::vector<uint32_t> const &replicas,
+    std::vector<std::pair<uint32_t, uint32_t>> const &queueStages,
+    std::vector<uint64_t> const &slotBytes,
+    Verbosity verbose) {
+  assert(queueStages.size() == slotBytes.size());
+  auto numQueues = queueStages.size();
+  std::vector<uint64_t> capacities(numQueues, 0);
+  if (numQueues == 0) {
+    return capacities;
+  }
+
+  /*
+   * Compute the cycles of an iteration of each stage.
+   */
+  std::vector<uint64_t> work;
+  std::vector<uint64_t> fixedCost;
+  this->computeCyclesOfDSWPStages(stageSCCs,
+                                  clonedSCCs,
+                                  poppedValues,
+                                  work,
+                                  fixedCost);
+  auto cyclesOfStage = [&](uint32_t stage) -> double {
+    return (double)((work[stage] / replicas[stage]) + fixedCost[stage]) + 1;
+  };
+
+  /*
+   * The queues of a pipeline share the L2 cache of the cores of their
+   * stages. Give each of them at most half of the cache divided evenly.
+   */
+  const uint64_t defaultCapacity = 1024;
+  const uint64_t minimumCapacity = 16;
+  auto bytesPerQueue = Architecture::getL2CacheBytes() / (2 * numQueues);
+
+  /*
+   * A queue absorbs the differences between the speeds of the iterations of
+   * its stages. If one stage is much faster than the other, the queue is
+   * either always full or always empty no matter its capacity, so a few
+   * slots are enough. Queues between stages of balanced speeds get the most
+   * slots.
+   */
+  for (auto i = 0u; i < numQueues; i++) {
+    auto producerCycles = cyclesOfStage(queueStages[i].first);
+    auto consumerCycles = cyclesOfStage(queueStages[i].second);
+    auto balance = std::min(producerCycles, consumerCycles)
+                   / std::max(producerCycles, consumerCycles);
+    auto slots = (uint64_t)(defaultCapacity * balance);
+    auto maximumSlots =
+        std::max<uint64_t>(bytesPerQueue / std::max<uint64_t>(slotBytes[i], 1),
+                           minimumCapacity);
+    slots = std::min(std::max(slots, minimumCapacity), maximumSlots);
+
+    /*
+     * Round the capacity down to a power of 2.
+     */
+    uint64_t capacity = minimumCapacity;
+    while ((capacity * 2) <= slots) {
+      capacity *= 2;
+    }
+    capacities[i] = capacity;
+
+    if (verbose != Verbosity::Disabled) {
+      errs() << "Heuristics:  DSWP queue " << i << " from stage "
+             << queueStages[i].first << " to stage " << queueStages[i].second
+             << " has " << capacity << " slots\n";
+    }
+  }
+
+  return capacities;
+}
+
+bool Heuristics::shouldSendClonableSCCOfDSWP(
+    SCC *scc,
+    std::vector<std::set<Value *>> const &sentValues,
+    Verbosity verbose) {
+
+  /*
+   * Compute the cycles saved by the stages that would not clone the SCC.
+   */
+  uint64_t recomputationCycles =
+      this->invocationLatency.latencyPerInvocation(scc) * sentValues.size();
+
+  /*
+   * Compute the cycles these stages would spend popping the values instead.
+   */
+  uint64_t communicationCycles = 0;
+  for (auto &values : sentValues) {
+    for (auto value : values) {
+      communicationCycles += this->invocationLatency.queueLatency(value);
+    }
+  }
+  auto shouldSend = (communicationCycles < recomputationCycles);
+
+  if (verbose >= Verbosity::Maximal) {
+    errs() << "Heuristics:  DSWP clonable SCC: recomputing it costs "
+           << recomputationCycles << " cycles, sending it costs "
+           << communicationCycles << " cycles\n";
+  }
+
+  return shouldSend;
+}
+
+void Heuristics::computeCyclesOfDSWPStages(
+    std::vector<std::set<SCC *>> const &stageSCCs,
+    std::vector<std::set<SCC *>> const &clonedSCCs,
+    std::vector<std::set<Value *>> const &poppedValues,
+    std::vector<uint64_t> &work,
+    std::vector<uint64_t> &fixedCost) {
+
+  /*
+   * The work of the SCCs of a stage is split across its replicas. The rest is
+   * executed by every replica.
+   */
+  auto numStages = stageSCCs.size();
+  work.assign(numStages, 0);
+  fixedCost.assign(numStages, 0);
+  for (auto i = 0u; i < numStages; i++) {
+    for (auto scc : stageSCCs[i]) {
+      work[i] += this->invocationLatency.latencyPerInvocation(scc);
+    }
+    for (auto scc : clonedSCCs[i]) {
+      fixedCost[i] += this->invocationLatency.latencyPerInvocation(scc);
+    }
+    for (auto value : poppedValues[i]) {
+      fixedCost[i] += this->invocationLatency.queueLatency(value);
+    }
+  }
+
+  return;
+}
+
+double Heuristics::adjustSequentialSegmentsForHELIX(
+    SCCDAGPartitioner *partitioner,
+    std::function<bool(SCCSet *set)> isSequential,
+    std::unordered_map<SCC *, SCC *> const &profiledSCCs,
+    SCCDAG *profiledSCCDAG,
+    uint64_t iterations,
+    uint64_t numThreads,
+    Verbosity verbose) {
+  assert(iterations > 0);
+  assert(numThreads > 0);
+
+  /*
+   * Compute the cycles of an iteration of the loop.
+   */
+  double loopCycles = 0;
+  for (auto nodePair : profiledSCCDAG->internalNodePairs()) {
+    loopCycles += this->invocationLatency.latencyPerInvocation(nodePair.first);
+  }
+  loopCycles /= iterations;
+  auto cyclesOfSet = [this, &profiledSCCs, iterations](SCCSet *set) -> double {
+    double cycles = 0;
+    for (auto scc : set->sccs) {
+      auto profiledSCC = profiledSCCs.find(scc);
+      if (profiledSCC == profiledSCCs.end()) {
+        continue;
+      }
+      cycles +=
+          this->invocationLatency.latencyPerInvocation(profiledSCC->second);
+    }
+    return cycles / iterations;
+  };
+
+  /*
+   * The cycles of an iteration are bounded by two costs:
+   * 1) the work of the loop, including the synchronizations, split across the
+   *    cores, and
+   * 2) the slowest sequential segment, which is passed from core to core once
+   *    per iteration.
+   */
+  auto synchronizationCycles = this->overheads.getSequentialSegmentCycles();
+  auto predictCycles = [loopCycles, synchronizationCycles, numThreads](
+                           std::vector<double> const &segments) -> double {
+    double slowestSegment = 0;
+    for (auto segment : segments) {
+      slowestSegment =
+          std::max(slowestSegment, segment + synchronizationCycles);
+    }
+    auto work = loopCycles + (segments.size() * synchronizationCycles);
+    return std::max(slowestSegment, work / numThreads);
+  };
+
+  /*
+   * Merge consecutive sequential segments, one pair at a time, as long as the
+   * predicted cycles of an iteration decrease.
+   * The sets between the two segments (if any) are merged with them, so they
+   * become sequential as well.
+   */
+  std::vector<double> segments;
+  while (true) {
+    std::vector<SCCSet *> sequentialSets;
+    segments.clear();
+    for (auto set : partitioner->getDepthOrderedSets()) {
+      if (!isSequential(set)) {
+        continue;
+      }
+      sequentialSets.push_back(set);
+      segments.push_back(cyclesOfSet(set));
+    }
+    auto bestCycles = predictCycles(segments);
+    std::pair<SCCSet *, SCCSet *> bestPair{ nullptr, nullptr };
+    for (auto i = 1u; i < sequentialSets.size(); i++) {
+      auto setA = sequentialSets[i - 1];
+      auto setB = sequentialSets[i];
+      auto mergedSets = partitioner->getCycleIntroducedByMerging(setA, setB);
+      double mergedSegment = 0;
+      std::vector<double> newSegments;
+      for (auto j = 0u; j < sequentialSets.size(); j++) {
+        if (mergedSets.find(sequentialSets[j]) == mergedSets.end()) {
+          newSegments.push_back(segments[j]);
+        }
+      }
+      for (auto set : mergedSets) {
+        mergedSegment += cyclesOfSet(set);
+      }
+      newSegments.push_back(mergedSegment);
+      auto newCycles = predictCycles(newSegments);
+      if (newCycles < bestCycles) {
+        bestCycles = newCycles;
+        bestPair = { setA, setB };
+      }
+    }
+    if (bestPair.first == nullptr) {
+      break;
+    }
+    partitioner->mergePair(bestPair.first, bestPair.second);
+    if (verbose != Verbosity::Disabled) {
+      errs() << "Heuristics:  Merge two HELIX sequential segments (predicted "
+             << (uint64_t)bestCycles << " cycles per iteration)\n";
+    }
+  }
+
+  /*
+   * Compute the fraction of an iteration spent in sequential segments.
+   */
+  if (loopCycles <= 0) {
+    return 0;
+  }
+  double sequentialCycles = 0;
+  for (auto segment : segments) {
+    sequentialCycles += segment;
+  }
+
+  return std::min(sequentialCycles / loopCycles, 1.0);
+}
+
 void Heuristics::minMaxMergePartition(SCCDAGPartitioner &partitioner,
                                       SCCDAGAttrs &attrs,
                                       uint64_t numThreads,
                                       Verbosity verbose) {
-  auto modified = false;
   MinMaxSizePartitionAnalysis PCA(invocationLatency,
                                   partitioner,
                                   attrs,
                                   numThreads,
                                   verbose);
-  do {
-    modified = false;
-
-    PCA.resetCandidateSubsetInfo();
-    PCA.traverseAllPartitionSubsets();
-    if (verbose >= Verbosity::Maximal)
-      PCA.printCandidate(errs());
-    modified = PCA.mergeCandidateSubsets();
-  } while (modified);
+  PCA.mergeAllCandidateSubsets(this->numberOfThreads);
 }
 
 void Heuristics::smallestSizeMergePartition(SCCDAGPartitioner &partitioner,
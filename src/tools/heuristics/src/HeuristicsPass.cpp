@@ -32,12 +32,67 @@
 
 #include "llvm/ADT/iterator_range.h"
 
+#include <fstream>
+#include <thread>
+
 #include "HeuristicsPass.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
 
+static cl::opt<std::string> MicroArchitecture(
+    "noelle-heuristics-uarch",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Micro-architecture whose instruction latencies drive the "
+             "partitioning (generic, skylake, zen2, cortex-a72). The one of "
+             "the current machine is used by default"));
+static cl::opt<std::string> OverheadsFileName(
+    "noelle-heuristics-overheads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Model file with the queue costs of the machine "
+             "(see noelle-overheads)"));
+static cl::opt<int> HeuristicsThreads(
+    "noelle-heuristics-threads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Number of threads used to evaluate the merges of DSWP "
+             "partitions (0: all cores)"));
+
 bool HeuristicsPass::doInitialization(Module &M) {
+
+  /*
+   * Select the target.
+   */
+  this->microArchitecture = InstructionLatencies::getHostMicroArchitecture();
+  if (MicroArchitecture.getNumOccurrences() > 0) {
+    this->microArchitecture = MicroArchitecture.getValue();
+  }
+
+  /*
+   * Select the model of the queues.
+   */
+  this->overheadsFileName = ParallelizationOverheads::defaultFileName;
+  if (OverheadsFileName.getNumOccurrences() > 0) {
+    this->overheadsFileName = OverheadsFileName.getValue();
+    std::ifstream file(this->overheadsFileName);
+    if (!file.good()) {
+      errs() << "Heuristics: Warning = file " << this->overheadsFileName
+             << " cannot be read\n";
+    }
+  }
+
+  /*
+   * Select the threads to use.
+   */
+  this->numberOfThreads = (HeuristicsThreads.getValue() > 0)
+                              ? HeuristicsThreads.getValue()
+                              : std::thread::hardware_concurrency();
+  if (this->numberOfThreads == 0) {
+    this->numberOfThreads = 1;
+  }
+
   return false;
 }
 
@@ -50,12 +105,15 @@ bool HeuristicsPass::runOnModule(Module &M) {
   return false;
 }
 
-HeuristicsPass::HeuristicsPass() : ModulePass{ ID } {
+HeuristicsPass::HeuristicsPass() : ModulePass{ ID }, numberOfThreads{ 1 } {
   return;
 }
 
 Heuristics *HeuristicsPass::getHeuristics(Noelle &noelle) {
-  return new Heuristics(noelle);
+  return new Heuristics(noelle,
+                        this->microArchitecture,
+                        this->overheadsFileName,
+                        this->numberOfThreads);
 }
 
 // Next there is code to register your pass to "opt"
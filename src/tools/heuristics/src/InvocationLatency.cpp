@@ -24,7 +24,13 @@
 using namespace llvm;
 using namespace llvm::noelle;
 
-InvocationLatency::InvocationLatency(Hot *hot) : profiles{ hot } {
+InvocationLatency::InvocationLatency(
+    Hot *hot,
+    InstructionLatencies const &latencies,
+    ParallelizationOverheads const &overheads)
+  : profiles{ hot },
+    latencies{ latencies },
+    overheads{ overheads } {
   return;
 }
 
@@ -32,15 +38,31 @@ uint64_t InvocationLatency::latencyPerInvocation(SCC *scc) {
 
   /*
    * Check if we have already computed the latency of this SCC.
+   * Memoized latencies are only read, so they can be queried in parallel.
    */
-  if (this->sccToCost.find(scc) != this->sccToCost.end()) {
-    return this->sccToCost[scc];
+  auto costIter = this->sccToCost.find(scc);
+  if (costIter != this->sccToCost.end()) {
+    return costIter->second;
   }
 
   /*
    * Compute the latency of the SCC.
    */
-  auto cost = this->profiles->getTotalInstructions(scc);
+  double cycles = 0;
+  if (scc->hasCycle()) {
+    scc->iterateOverInstructions([this, &cycles](Instruction *I) -> bool {
+      cycles += this->latencyPerInvocation(I);
+      return false;
+    });
+  } else {
+    scc->iterateOverInstructions([this, &cycles](Instruction *I) -> bool {
+      auto executions = this->profiles->getInvocations(I);
+      cycles += executions * this->latencies.getReciprocalThroughput(I);
+      cycles += this->cyclesOfCallees(I);
+      return false;
+    });
+  }
+  auto cost = (uint64_t)cycles;
   sccToCost[scc] = cost;
 
   return cost;
@@ -84,26 +106,57 @@ uint64_t InvocationLatency::latencyPerInvocation(
 uint64_t InvocationLatency::latencyPerInvocation(Instruction *inst) {
 
   /*
-   * Identify 0 latency instructions
+   * Estimate the latency.
+   * Instructions that do not generate machine code (e.g., PHIs, GEPs, and
+   * integer casts) have no latency in the table.
    */
-  auto isSyntacticSugar = [&](Instruction *I) -> bool {
-    return isa<PHINode>(I) || isa<GetElementPtrInst>(I) || isa<CastInst>(I);
-  };
-  if (isSyntacticSugar(inst)) {
-    return 0;
-  }
+  auto executions = this->profiles->getInvocations(inst);
+  auto cycles = executions * this->latencies.getLatency(inst);
+  cycles += this->cyclesOfCallees(inst);
+
+  return (uint64_t)cycles;
+}
+
+double InvocationLatency::cyclesOfCallees(Instruction *inst) const {
 
   /*
-   * Estimate the latency.
+   * The instructions executed by the callees of a call have no table entry.
+   * They take the average cycles of an instruction.
    */
-  auto latency = this->profiles->getTotalInstructions(inst);
+  auto totalInstructions = this->profiles->getTotalInstructions(inst);
+  auto selfInstructions = this->profiles->getSelfInstructions(inst);
+  if (totalInstructions <= selfInstructions) {
+    return 0;
+  }
+  auto calleeInstructions = totalInstructions - selfInstructions;
 
-  return latency;
+  return calleeInstructions * this->overheads.getCyclesPerInstruction();
 }
 
 uint64_t InvocationLatency::queueLatency(Value *queueVal) {
-  // TODO(angelo): use primitive size of bits of type of value?
-  return 100;
+  auto queueIter = this->queueValToCost.find(queueVal);
+  if (queueIter != this->queueValToCost.end()) {
+    return queueIter->second;
+  }
+
+  /*
+   * Every value produced is pushed to the queue and popped from it.
+   * The queues of the runtime carry up to 64 bits per push.
+   */
+  uint64_t executions = 1;
+  if (auto inst = dyn_cast<Instruction>(queueVal)) {
+    executions = this->profiles->getInvocations(inst);
+  }
+  uint64_t bits =
+      std::max(queueVal->getType()->getPrimitiveSizeInBits(), (unsigned)1);
+  auto pushes = (bits + 63) / 64;
+  auto cycles = executions * pushes
+                * (this->overheads.getQueuePushCycles()
+                   + this->overheads.getQueuePopCycles());
+  auto cost = (uint64_t)cycles;
+  this->queueValToCost[queueVal] = cost;
+
+  return cost;
 }
 
 /*
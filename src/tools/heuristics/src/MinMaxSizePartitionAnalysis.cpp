@@ -24,33 +24,52 @@
 using namespace llvm;
 using namespace llvm::noelle;
 
-void MinMaxSizePartitionAnalysis::checkIfShouldMerge(SCCSet *sA, SCCSet *sB) {
+bool MinMaxSizePartitionAnalysis::evaluateMerge(
+    SCCSet *sA,
+    SCCSet *sB,
+    std::unordered_set<SCCSet *> &setsInMerge,
+    uint64_t &cost,
+    uint64_t &instructionCount) {
 
   /*
    * Hard stop merging once we have fewer partitions than cores
    */
   if (partitioner.getPartitionGraph()->numNodes() <= numCores)
-    return;
+    return false;
 
   /*
    * Compute all sets that have to be merged if the two target sets are merged
    */
-  std::unordered_set<SCCSet *> setsInMerge =
-      partitioner.getCycleIntroducedByMerging(sA, sB);
+  setsInMerge = partitioner.getCycleIntroducedByMerging(sA, sB);
 
   /*
    * Compute the cost of running all these sets on one core
    */
   SCCSet potentialMerge;
-  uint64_t instCountOfMerge = 0;
+  instructionCount = 0;
   for (auto set : setsInMerge) {
     potentialMerge.sccs.insert(set->sccs.begin(), set->sccs.end());
     for (auto scc : set->sccs) {
-      instCountOfMerge += this->sccToInstructionCountMap.at(scc);
+      instructionCount += this->sccToInstructionCountMap.at(scc);
     }
   }
   std::unordered_set<SCCSet *> singleSet = { &potentialMerge };
-  uint64_t costOnceMerged = IL.latencyPerInvocation(&dagAttrs, singleSet);
+  cost = IL.latencyPerInvocation(&dagAttrs, singleSet);
+
+  return true;
+}
+
+void MinMaxSizePartitionAnalysis::checkIfShouldMerge(SCCSet *sA, SCCSet *sB) {
+  std::unordered_set<SCCSet *> setsInMerge;
+  uint64_t costOnceMerged = 0;
+  uint64_t instCountOfMerge = 0;
+  if (!this->evaluateMerge(sA,
+                           sB,
+                           setsInMerge,
+                           costOnceMerged,
+                           instCountOfMerge)) {
+    return;
+  }
 
   /*
    * Only merge if it is the cheapest of the merges
@@ -19,6 +19,8 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <future>
+
 #include "PartitionCostAnalysis.hpp"
 
 using namespace llvm;
@@ -104,6 +106,178 @@ bool PartitionCostAnalysis::mergeCandidateSubsets() {
   return true;
 }
 
+bool PartitionCostAnalysis::evaluateMerge(
+    SCCSet *sA,
+    SCCSet *sB,
+    std::unordered_set<SCCSet *> &setsInMerge,
+    uint64_t &cost,
+    uint64_t &instructionCount) {
+  return false;
+}
+
+std::vector<PartitionCostAnalysis::MergeCandidate> PartitionCostAnalysis::
+    evaluateMerges(std::vector<std::pair<SCCSet *, SCCSet *>> const &pairs,
+                   uint32_t numThreads) {
+
+  /*
+   * Evaluate the pairs.
+   * Every latency needed has been memoized when this analysis has been
+   * created, so the evaluations only read shared data. Each thread evaluates
+   * a contiguous range of pairs.
+   */
+  std::vector<MergeCandidate> evaluations(pairs.size());
+  std::vector<uint8_t> canBeMerged(pairs.size(), 0);
+  auto evaluate = [this, &pairs, &evaluations, &canBeMerged](uint64_t first,
+                                                             uint64_t last) {
+    for (auto i = first; i < last; i++) {
+      auto &pair = pairs[i];
+      auto &candidate = evaluations[i];
+      std::unordered_set<SCCSet *> setsInMerge;
+      canBeMerged[i] = this->evaluateMerge(pair.first,
+                                           pair.second,
+                                           setsInMerge,
+                                           candidate.cost,
+                                           candidate.instructionCount);
+      candidate.sccOfParent = *pair.first->sccs.begin();
+      candidate.sccOfChild = *pair.second->sccs.begin();
+    }
+  };
+  if (false || (numThreads <= 1) || (pairs.size() <= 1)) {
+    evaluate(0, pairs.size());
+  } else {
+    std::vector<std::future<void>> tasks;
+    uint64_t pairsPerTask = (pairs.size() + numThreads - 1) / numThreads;
+    for (uint64_t first = 0; first < pairs.size(); first += pairsPerTask) {
+      auto last = std::min(first + pairsPerTask, (uint64_t)pairs.size());
+      tasks.push_back(std::async(std::launch::async, evaluate, first, last));
+    }
+    for (auto &task : tasks) {
+      task.get();
+    }
+  }
+
+  /*
+   * Keep the pairs that can be merged, in the order they have been given.
+   */
+  std::vector<MergeCandidate> candidates;
+  for (auto i = 0u; i < pairs.size(); i++) {
+    if (canBeMerged[i]) {
+      candidates.push_back(evaluations[i]);
+    }
+  }
+
+  return candidates;
+}
+
+bool PartitionCostAnalysis::mergeAllCandidateSubsets(uint32_t numThreads) {
+  auto partition = partitioner.getPartitionGraph();
+
+  /*
+   * Candidates are ordered by the cost of their merged set, then by its
+   * instructions, then by the order they have been evaluated.
+   */
+  auto isLessUrgent = [](const MergeCandidate &a,
+                         const MergeCandidate &b) -> bool {
+    if (a.cost != b.cost) {
+      return a.cost > b.cost;
+    }
+    if (a.instructionCount != b.instructionCount) {
+      return a.instructionCount > b.instructionCount;
+    }
+    return a.id > b.id;
+  };
+  std::priority_queue<MergeCandidate,
+                      std::vector<MergeCandidate>,
+                      decltype(isLessUrgent)>
+      candidates(isLessUrgent);
+  uint64_t nextID = 0;
+  auto addCandidates =
+      [this, &candidates, &nextID, numThreads](
+          std::vector<std::pair<SCCSet *, SCCSet *>> const &pairs) {
+        for (auto candidate : this->evaluateMerges(pairs, numThreads)) {
+          candidate.id = nextID++;
+          candidates.push(candidate);
+        }
+      };
+
+  /*
+   * Evaluate every set with each of its children.
+   */
+  std::vector<std::pair<SCCSet *, SCCSet *>> pairs;
+  for (auto set : partitioner.getSets()) {
+    for (auto child : partitioner.getChildren(set)) {
+      pairs.push_back(std::make_pair(set, child));
+    }
+  }
+  addCandidates(pairs);
+
+  /*
+   * Merge the cheapest candidates.
+   * Candidates are identified by one SCC of each of their sets, which keeps
+   * identifying the set that includes it after merges.
+   * Merges can only grow the sets of a candidate, and so its cost. Hence, a
+   * candidate whose cost changed since its evaluation is pushed back with
+   * the new cost, and a candidate that is still up to date when it is the
+   * cheapest one is the cheapest candidate of the whole partition.
+   */
+  auto modified = false;
+  while (!candidates.empty()) {
+    auto candidate = candidates.top();
+    candidates.pop();
+    auto parent = partition->setOfSCC(candidate.sccOfParent);
+    auto child = partition->setOfSCC(candidate.sccOfChild);
+    if (parent == child) {
+      continue;
+    }
+    std::unordered_set<SCCSet *> setsInMerge;
+    uint64_t cost = 0;
+    uint64_t instructionCount = 0;
+    if (!this->evaluateMerge(parent,
+                             child,
+                             setsInMerge,
+                             cost,
+                             instructionCount)) {
+      continue;
+    }
+    if (false || (cost != candidate.cost)
+        || (instructionCount != candidate.instructionCount)) {
+      candidate.cost = cost;
+      candidate.instructionCount = instructionCount;
+      candidate.id = nextID++;
+      candidates.push(candidate);
+      continue;
+    }
+
+    /*
+     * Merge the candidate.
+     */
+    this->minSetsToMerge = setsInMerge;
+    this->costOfMergedSet = cost;
+    this->numInstructionsInSetsBeingMerged = instructionCount;
+    if (verbose >= Verbosity::Maximal) {
+      this->printCandidate(errs());
+    }
+    this->mergeCandidateSubsets();
+    modified = true;
+
+    /*
+     * Evaluate the merged set with its parents and its children.
+     */
+    auto mergedSet = partition->setOfSCC(candidate.sccOfParent);
+    pairs.clear();
+    for (auto parentOfMerged : partitioner.getParents(mergedSet)) {
+      pairs.push_back(std::make_pair(parentOfMerged, mergedSet));
+    }
+    for (auto childOfMerged : partitioner.getChildren(mergedSet)) {
+      pairs.push_back(std::make_pair(mergedSet, childOfMerged));
+    }
+    addCandidates(pairs);
+  }
+  this->resetCandidateSubsetInfo();
+
+  return modified;
+}
+
 void PartitionCostAnalysis::printCandidate(raw_ostream &stream) {
   if (verbose == Verbosity::Disabled)
     return;
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "HotFunctions.hpp"
+
+namespace llvm::noelle {
+
+std::set<Function *> HotFunctions::identifyHotFunctions(Noelle &noelle,
+                                                       bool includeCallers) {
+  std::set<Function *> functions;
+
+  /*
+   * Fetch the hot loops.
+   */
+  auto loops = noelle.getLoopStructures();
+  if (loops->size() == 0) {
+    delete loops;
+    return functions;
+  }
+
+  /*
+   * Fetch the functions that include the hot loops.
+   */
+  std::vector<Function *> worklist;
+  for (auto loop : *loops) {
+    auto f = loop->getFunction();
+    if (functions.insert(f).second) {
+      worklist.push_back(f);
+    }
+  }
+  delete loops;
+
+  /*
+   * Add the functions that they can invoke.
+   * Indirect calls are described by may edges of the call graph.
+   */
+  auto fm = noelle.getFunctionsManager();
+  auto pcg = fm->getProgramCallGraph();
+  auto callees = functions;
+  while (!worklist.empty()) {
+    auto f = worklist.back();
+    worklist.pop_back();
+    auto node = pcg->getFunctionNode(f);
+    for (auto edge : node->getOutgoingEdges()) {
+      auto callee = edge->getCallee()->getFunction();
+      if (callee->empty()) {
+        continue;
+      }
+      if (callees.insert(callee).second) {
+        worklist.push_back(callee);
+      }
+    }
+  }
+
+  if (!includeCallers) {
+    functions.insert(callees.begin(), callees.end());
+    return functions;
+  }
+
+  /*
+   * Add the functions that can invoke them.
+   * This keeps them reachable from the entry function, which is where the
+   * NOELLE tools start looking for loops.
+   */
+  auto callers = functions;
+  for (auto f : functions) {
+    worklist.push_back(f);
+  }
+  while (!worklist.empty()) {
+    auto f = worklist.back();
+    worklist.pop_back();
+    auto node = pcg->getFunctionNode(f);
+    for (auto edge : node->getIncomingEdges()) {
+      auto caller = edge->getCaller()->getFunction();
+      if (callers.insert(caller).second) {
+        worklist.push_back(caller);
+      }
+    }
+  }
+  functions.insert(callees.begin(), callees.end());
+  functions.insert(callers.begin(), callers.end());
+  functions.insert(fm->getEntryFunction());
+
+  return functions;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Noelle.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Write the names of the functions that the analyses of the hot loops need
+ * to see, one per line.
+ * These are the functions with a hot loop (see -noelle-min-hot), the
+ * functions these loops can invoke (transitively), and the functions that
+ * can invoke them from the entry function.
+ *
+ * The list is meant for noelle-extract-hot, which materializes only the
+ * bodies of these functions from the bitcode, so the other tools can run
+ * on a small module.
+ */
+class HotFunctions : public ModulePass {
+public:
+  HotFunctions();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /*
+   * Return the functions with a hot loop and the functions these loops can
+   * invoke (transitively).
+   * If @includeCallers is set, the functions that can invoke them from the
+   * entry function are included as well.
+   */
+  static std::set<Function *> identifyHotFunctions(Noelle &noelle,
+                                                   bool includeCallers);
+
+  /*
+   * Class fields
+   */
+  static char ID;
+
+private:
+  /*
+   * Fields
+   */
+  std::string outputFileName;
+};
+
+} // namespace llvm::noelle
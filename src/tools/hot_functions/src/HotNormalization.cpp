@@ -0,0 +1,109 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils.h"
+#include "llvm/Transforms/Utils/UnifyFunctionExitNodes.h"
+
+#include "HotFunctions.hpp"
+#include "HotNormalization.hpp"
+
+namespace llvm::noelle {
+
+HotNormalization::HotNormalization() : ModulePass{ ID } {
+
+  return;
+}
+
+bool HotNormalization::doInitialization(Module &M) {
+  return false;
+}
+
+bool HotNormalization::runOnModule(Module &M) {
+  errs() << "HotNormalization: Start\n";
+
+  /*
+   * Identify the functions the hot loops can execute.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+  auto functions = HotFunctions::identifyHotFunctions(noelle, false);
+
+  /*
+   * Normalize them following the order of the module.
+   */
+  auto modified = false;
+  uint64_t normalizedFunctions = 0;
+  uint64_t functionsWithBody = 0;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    functionsWithBody++;
+    if (functions.find(&F) == functions.end()) {
+      continue;
+    }
+    modified |= this->normalizeFunction(F);
+    normalizedFunctions++;
+  }
+  errs() << "HotNormalization:   " << normalizedFunctions << " out of "
+         << functionsWithBody << " functions have been normalized\n";
+
+  errs() << "HotNormalization: Exit\n";
+  return modified;
+}
+
+bool HotNormalization::normalizeFunction(Function &F) {
+
+  /*
+   * Run the normalization of noelle-norm on @F.
+   * The inter-procedural passes of noelle-norm (i.e., the inference of the
+   * attributes of the functions) are not run because they would change the
+   * other functions.
+   */
+  legacy::FunctionPassManager normalization(F.getParent());
+  normalization.add(createPromoteMemoryToRegisterPass());
+  normalization.add(createCFGSimplificationPass());
+  normalization.add(createLowerSwitchPass());
+  normalization.add(createUnifyFunctionExitNodesPass());
+  normalization.add(createBreakCriticalEdgesPass());
+  normalization.add(createLoopSimplifyPass());
+  normalization.add(createLCSSAPass());
+  normalization.add(createIndVarSimplifyPass());
+  normalization.doInitialization();
+  auto modified = normalization.run(F);
+  normalization.doFinalization();
+
+  return modified;
+}
+
+void HotNormalization::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<Noelle>();
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+// Next there is code to register your pass to "opt"
+char llvm::noelle::HotNormalization::ID = 0;
+static RegisterPass<HotNormalization> X(
+    "HotNormalization",
+    "Normalize only the functions that the hot loops can execute");
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Support/FileSystem.h"
+
+#include "HotFunctions.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<std::string> HotFunctionsOutput(
+    "noelle-hot-functions-output",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init("-"),
+    cl::desc("File to write the names of the hot functions to (-: stdout)"));
+
+HotFunctions::HotFunctions() : ModulePass{ ID } {
+
+  return;
+}
+
+bool HotFunctions::doInitialization(Module &M) {
+  this->outputFileName = HotFunctionsOutput.getValue();
+
+  return false;
+}
+
+bool HotFunctions::runOnModule(Module &M) {
+
+  /*
+   * Open the output file.
+   */
+  std::error_code EC;
+  raw_fd_ostream output(this->outputFileName, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << "HotFunctions: ERROR = cannot write " << this->outputFileName
+           << "\n";
+    return false;
+  }
+
+  /*
+   * Identify the functions that the hot loops need.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+  auto functions = HotFunctions::identifyHotFunctions(noelle, true);
+
+  /*
+   * Print them.
+   * Functions are sorted by name so the list does not depend on the order of
+   * the module.
+   */
+  std::set<std::string> names;
+  uint64_t functionsWithBody = 0;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    functionsWithBody++;
+    if (functions.find(&F) != functions.end()) {
+      names.insert(F.getName().str());
+    }
+  }
+  for (auto &name : names) {
+    output << name << "\n";
+  }
+  errs() << "HotFunctions: " << names.size() << " out of " << functionsWithBody
+         << " functions are needed by the hot loops\n";
+
+  return false;
+}
+
+void HotFunctions::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<Noelle>();
+  AU.setPreservesAll();
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+// Next there is code to register your pass to "opt"
+char llvm::noelle::HotFunctions::ID = 0;
+static RegisterPass<HotFunctions> X(
+    "HotFunctions",
+    "Identify the functions needed by the analyses of the hot loops");
@@ -29,7 +29,6 @@
 #include "noelle/core/SCCDAG.hpp"
 #include "noelle/core/LoopDependenceInfo.hpp"
 #include "noelle/core/Noelle.hpp"
-#include <fstream>
 
 namespace llvm::noelle {
 
@@ -51,11 +50,33 @@ private:
   uint32_t maxNumberOfFunctionCallsToInlinePerLoop;
   uint32_t maxProgramInstructions;
 
+  /*
+   * Budget of the code growth: the maximum percentage of the program
+   * instructions that inlining can add.
+   */
+  uint32_t maxCodeGrowth;
+  uint64_t codeGrowthBudget;
+  uint64_t instructionsAddedByInlining;
+
+  /*
+   * Call graph of the program, which is updated after every inlining.
+   */
+  noelle::CallGraph *pcg;
+
   /*
    * Inlining procedure
    */
   void getLoopsToInline(Noelle &noelle, Hot *profiles);
-  bool registerRemainingLoops(std::string filename);
+
+  /*
+   * Return the fraction of the cycles of @loop spent within the calls of the
+   * caller of its function where it is the hottest (see
+   * noelle-loop-profiles-instr).
+   *
+   * @return 1 if the calling contexts of @loop have not been profiled.
+   */
+  double getFractionOfTheHottestCaller(Hot *profiles,
+                                       LoopStructure *loop) const;
   bool inlineCallsInvolvedInLoopCarriedDataDependences(Noelle &noelle,
                                                        noelle::CallGraph *pcg);
   bool inlineCallsInvolvedInLoopCarriedDataDependencesWithinLoop(
@@ -64,12 +85,19 @@ private:
       noelle::CallGraph *pcg,
       Noelle &noelle);
 
-  void getFunctionsToInline(std::string filename);
+  double getGainOfInlining(Hot *p,
+                           LoopStructure *loop,
+                           SCC *scc,
+                           uint32_t memEdgeCount);
 
-  bool registerRemainingFunctions(std::string filename);
+  void getFunctionsToInline(void);
 
   bool inlineFnsOfLoopsToCGRoot(Hot *p);
 
+  void refreshAfterInlining(Module &M, Noelle &noelle, Function *main);
+
+  void normalizeFunction(Function *f);
+
   /*
    * Inline tracking
    */
@@ -88,7 +116,7 @@ private:
    * Function and loop order tracking
    */
   void collectFnGraph(Function *main);
-  void collectFnCallsAndCalled(llvm::CallGraph &CG, Function *parentF);
+  void collectFnCallsAndCalled(noelle::CallGraph &CG, Function *parentF);
   void collectInDepthOrderFns(Function *main);
   void createPreOrderedLoopSummariesFor(Function *F);
   std::vector<Loop *> *collectPreOrderedLoopsFor(Function *F, LoopInfo &LI);
@@ -19,6 +19,7 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "llvm/Transforms/Utils.h"
 #include "Inliner.hpp"
 
 namespace llvm::noelle {
@@ -27,6 +28,10 @@ Inliner::Inliner()
   : ModulePass{ ID },
     maxNumberOfFunctionCallsToInlinePerLoop{ 10 },
     maxProgramInstructions{ 50000 },
+    maxCodeGrowth{ 20 },
+    codeGrowthBudget{ 0 },
+    instructionsAddedByInlining{ 0 },
+    pcg{ nullptr },
     fnsAffected{},
     parentFns{},
     childrenFns{},
@@ -82,8 +87,11 @@ bool Inliner::runOnModule(Module &M) {
 
   /*
    * Fetch the call graph.
+   * The inliner keeps it up to date after every inlining, so the rest of
+   * NOELLE (e.g., the PDG) can keep using it.
    */
   auto pcg = fm->getProgramCallGraph();
+  this->pcg = pcg;
 
   /*
    * Collect function and loop ordering to track inlining progress
@@ -116,25 +124,28 @@ bool Inliner::runOnModule(Module &M) {
   }
 
   /*
-   * Inline calls involved in loop-carried data dependences.
+   * Compute the budget of the code growth.
    */
-  getLoopsToInline(noelle, profiles);
+  this->codeGrowthBudget =
+      (((uint64_t)programInstructions) * this->maxCodeGrowth) / 100;
+  this->instructionsAddedByInlining = 0;
+  errs() << "Inliner:   Inlining can add at most " << this->codeGrowthBudget
+         << " instructions (" << this->maxCodeGrowth
+         << "% of the program)\n";
 
   /*
-   * Perform the inlining.
+   * Inline calls involved in loop-carried data dependences until no call is
+   * worth its code growth.
+   * The state of the inliner is kept in memory and it is refreshed after every
+   * round of inlining.
    */
-  auto inlined =
-      this->inlineCallsInvolvedInLoopCarriedDataDependences(noelle, pcg);
-  if (inlined) {
+  auto modified = false;
+  getLoopsToInline(noelle, profiles);
+  while (this->inlineCallsInvolvedInLoopCarriedDataDependences(noelle, pcg)) {
     errs() << "Inliner:   Inlined calls due to loop-carried data dependences\n";
-
-    /*
-     * Free the memory.
-     */
-    delete pcg;
-
-    errs() << "Inliner: Exit\n";
-    return true;
+    modified = true;
+    this->refreshAfterInlining(M, noelle, main);
+    getLoopsToInline(noelle, profiles);
   }
 
   /*
@@ -150,63 +161,94 @@ bool Inliner::runOnModule(Module &M) {
    * Check if we should hoist loops to main.
    */
   if (!noelle.shouldLoopsBeHoistToMain()) {
-    errs() << "Inliner:   The code has not been modified\n";
-
-    /*
-     * Free the memory.
-     */
-    delete pcg;
+    if (!modified) {
+      errs() << "Inliner:   The code has not been modified\n";
+    }
+    errs() << "Inliner:   Inlining added " << this->instructionsAddedByInlining
+           << " instructions\n";
 
     errs() << "Inliner: Exit\n";
-    return false;
+    return modified;
   }
 
   /*
    * Inline functions containing targeted loops so the loop is in main
    */
-  std::string filename = "dgsimplify_loop_hoisting.txt";
-  getFunctionsToInline(filename);
-
-  inlined = this->inlineFnsOfLoopsToCGRoot(profiles);
-  if (inlined) {
+  getFunctionsToInline();
+  while (this->inlineFnsOfLoopsToCGRoot(profiles)) {
     errs()
         << "Inliner:   Inlined functions to hoist loops to the entry funtion of the program\n";
-    getAnalysis<CallGraphWrapperPass>().runOnModule(M);
-    parentFns.clear();
-    childrenFns.clear();
-    orderedCalled.clear();
-    orderedCalls.clear();
-    collectFnGraph(main);
-    collectInDepthOrderFns(main);
+    modified = true;
+    this->refreshAfterInlining(M, noelle, main);
     printFnOrder();
   }
-
-  auto remaining = registerRemainingFunctions(filename);
   printFnInfo();
-  if (!remaining && this->verbose != Verbosity::Disabled) {
+  if (this->verbose != Verbosity::Disabled) {
     errs() << "Inliner:   No remaining hoists\n";
   }
+  errs() << "Inliner:   Inlining added " << this->instructionsAddedByInlining
+         << " instructions\n";
+
+  errs() << "Inliner: Exit\n";
+  return modified;
+}
+
+void Inliner::refreshAfterInlining(Module &M, Noelle &noelle, Function *main) {
 
   /*
-   * Free the memory.
+   * Restore the shape of the loops of the functions modified by inlining (see
+   * noelle-norm) and update their dependences.
    */
-  delete pcg;
+  auto profiles = noelle.getProfiles();
+  for (auto F : fnsAffected) {
+    this->normalizeFunction(F);
+    noelle.refreshDependences(F);
+    profiles->remapProfiles(F);
+  }
+  fnsAffected.clear();
 
-  errs() << "Inliner: Exit\n";
-  return inlined;
+  /*
+   * Recompute the function graph and its order from the call graph, which is
+   * updated after every inlining.
+   */
+  parentFns.clear();
+  childrenFns.clear();
+  orderedCalled.clear();
+  orderedCalls.clear();
+  collectFnGraph(main);
+  collectInDepthOrderFns(main);
 
   /*
-   * Free the memory.
+   * Recompute the loops of the functions.
    */
-  delete pcg;
+  for (auto orderedLoops : preOrderedLoops) {
+    delete orderedLoops.second;
+  }
+  preOrderedLoops.clear();
+  for (auto l : loopSummaries) {
+    delete l;
+  }
+  loopSummaries.clear();
+  loopsToCheck.clear();
+  for (auto func : depthOrderedFns) {
+    createPreOrderedLoopSummariesFor(func);
+  }
 
-  errs() << "Inliner: Exit\n";
-  return false;
+  return;
+}
+
+void Inliner::normalizeFunction(Function *f) {
+  legacy::FunctionPassManager normalization(f->getParent());
+  normalization.add(createBreakCriticalEdgesPass());
+  normalization.add(createLoopSimplifyPass());
+  normalization.add(createLCSSAPass());
+  normalization.doInitialization();
+  normalization.run(*f);
+  normalization.doFinalization();
+
+  return;
 }
 
-/*
- * Progress Tracking using file system
- */
 void Inliner::getLoopsToInline(Noelle &noelle, Hot *profiles) {
   assert(profiles != nullptr);
 
@@ -221,8 +263,12 @@ void Inliner::getLoopsToInline(Noelle &noelle, Hot *profiles) {
 
         /*
          * Check if the loop is hot enough.
+         *
+         * Inlining brings the loop to the callers of its function, where it
+         * is only as hot as it is within their calls.
          */
         auto hotness = profiles->getDynamicTotalInstructionCoverage(summary);
+        hotness *= this->getFractionOfTheHottestCaller(profiles, summary);
         if (hotness < noelle.getMinimumHotness()) {
 
           /*
@@ -236,51 +282,60 @@ void Inliner::getLoopsToInline(Noelle &noelle, Hot *profiles) {
   }
 }
 
-void Inliner::getFunctionsToInline(std::string filename) {
-  fnsToCheck.clear();
-  ifstream infile(filename);
-  if (infile.good()) {
-    std::string line;
-    while (getline(infile, line)) {
-      int fnInd = std::stoi(line);
-      assert(fnInd > 0 && fnInd < depthOrderedFns.size());
-      fnsToCheck.insert(depthOrderedFns[fnInd]);
-    }
-  } else {
-    // NOTE(angelo): Default to select all functions with loops in them
-    for (auto funcLoops : preOrderedLoops) {
-      fnsToCheck.insert(funcLoops.first);
-    }
-  }
-}
+double Inliner::getFractionOfTheHottestCaller(Hot *profiles,
+                                              LoopStructure *loop) const {
 
-bool Inliner::registerRemainingFunctions(std::string filename) {
-  remove(filename.c_str());
-  if (fnsToCheck.empty()) {
-    return false;
+  /*
+   * Check if the calling contexts of the loop have been profiled.
+   */
+  auto loopCycles = profiles->getCycles(loop);
+  if (false || (loopCycles == 0)
+      || (profiles->getCallingContexts(loop).size() == 0)) {
+    return 1;
+  }
+  auto node = this->pcg->getFunctionNode(loop->getFunction());
+  if (node == nullptr) {
+    return 1;
   }
 
-  ofstream outfile(filename);
-  std::vector<int> fnInds;
-  for (auto F : fnsToCheck) {
-    auto fID = fnOrders[F];
-    if (fID == 0) {
-      continue;
+  /*
+   * Fetch the cycles of the loop within the calls of each caller.
+   * The cycles of the contexts that have not been profiled (e.g., the ones
+   * of indirect calls) are considered to come from a single caller.
+   */
+  uint64_t hottestCallerCycles = 0;
+  uint64_t callersCycles = 0;
+  for (auto edge : node->getIncomingEdges()) {
+    uint64_t callerCycles = 0;
+    for (auto subEdge : edge->getSubEdges()) {
+      auto call = dyn_cast<CallBase>(subEdge->getCaller()->getInstruction());
+      if (call == nullptr) {
+        continue;
+      }
+      callerCycles += profiles->getCycles(loop, { call });
     }
-    fnInds.push_back(fID);
+    hottestCallerCycles = std::max(hottestCallerCycles, callerCycles);
+    callersCycles += callerCycles;
+  }
+  if (callersCycles < loopCycles) {
+    hottestCallerCycles =
+        std::max(hottestCallerCycles, loopCycles - callersCycles);
   }
 
-  std::sort(fnInds.begin(), fnInds.end());
+  return std::min(1.0, ((double)hottestCallerCycles) / ((double)loopCycles));
+}
 
-  for (auto ind : fnInds) {
-    outfile << ind << "\n";
-  }
-  outfile.close();
+void Inliner::getFunctionsToInline(void) {
 
-  if (fnInds.size() > 0) {
-    return true;
+  /*
+   * Select all functions with loops in them.
+   * Functions are removed from this set once they have been inlined in all
+   * their callers.
+   */
+  fnsToCheck.clear();
+  for (auto funcLoops : preOrderedLoops) {
+    fnsToCheck.insert(funcLoops.first);
   }
-  return false;
 }
 
 bool Inliner::inlineFnsOfLoopsToCGRoot(Hot *hot) {
@@ -435,6 +490,19 @@ bool Inliner::inlineFunctionCall(Hot *p,
     return false;
   }
 
+  /*
+   * Avoid inlining if the code growth does not fit the budget.
+   */
+  auto growth = p->getStaticInstructions(childF);
+  if (this->instructionsAddedByInlining + growth > this->codeGrowthBudget) {
+    if (this->verbose != Verbosity::Disabled) {
+      errs() << "Inliner:   The budget does not allow to inline "
+             << childF->getName() << " (" << growth << " instructions) in "
+             << F->getName() << "\n";
+    }
+    return false;
+  }
+
   /*
    * Try to inline the function.
    */
@@ -454,8 +522,11 @@ bool Inliner::inlineFunctionCall(Hot *p,
   /*
    * Inline the call.
    */
+  p->snapshotProfiles(F);
   InlineFunctionInfo IFI;
   if (InlineFunction(call, IFI)) {
+    this->instructionsAddedByInlining += growth;
+    this->pcg->refreshFunction(F);
     fnsAffected.insert(F);
     adjustLoopOrdersAfterInline(F, childF, loopIndAfterCall);
     adjustFnGraphAfterInline(F, childF, callInd);
@@ -569,7 +640,7 @@ void Inliner::adjustFnGraphAfterInline(Function *parentF,
 }
 
 void Inliner::collectFnGraph(Function *main) {
-  auto &callGraph = getAnalysis<CallGraphWrapperPass>().getCallGraph();
+  auto &callGraph = *this->pcg;
   std::queue<Function *> funcToTraverse;
   std::set<Function *> reached;
 
@@ -607,20 +678,23 @@ void Inliner::collectFnGraph(Function *main) {
   }
 }
 
-void Inliner::collectFnCallsAndCalled(llvm::CallGraph &CG, Function *parentF) {
+void Inliner::collectFnCallsAndCalled(noelle::CallGraph &CG,
+                                      Function *parentF) {
 
   // Collect call instructions to already linked functions
   std::set<CallInst *> unorderedCalls;
-  auto funcCGNode = CG[parentF];
-  for (auto &callRecord : make_range(funcCGNode->begin(), funcCGNode->end())) {
-    auto weakVH = callRecord.first;
-    if (!weakVH.pointsToAliveValue() || !isa<CallInst>(&*weakVH))
-      continue;
-    auto call = (CallInst *)(&*weakVH);
-    auto F = call->getCalledFunction();
-    if (!F || F->empty())
-      continue;
-    unorderedCalls.insert(call);
+  auto funcCGNode = CG.getFunctionNode(parentF);
+  for (auto edge : funcCGNode->getOutgoingEdges()) {
+    for (auto subEdge : edge->getSubEdges()) {
+      auto inst = subEdge->getCaller()->getInstruction();
+      if (!isa<CallInst>(inst))
+        continue;
+      auto call = cast<CallInst>(inst);
+      auto F = call->getCalledFunction();
+      if (!F || F->empty())
+        continue;
+      unorderedCalls.insert(call);
+    }
   }
 
   // Sort call instructions in program forward order
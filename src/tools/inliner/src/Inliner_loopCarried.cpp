@@ -174,9 +174,8 @@ bool Inliner::inlineCallsInvolvedInLoopCarriedDataDependences(
 
 /*
  * GOAL: Go through loops in function
- * If there is only one non-clonable/reducable SCC,
- * try inlining the function call in that SCC with the
- * most memory edges to other internal/external values
+ * Among the calls that belong to the SCCs that block DOALL, try inlining the
+ * one with the highest expected gain per instruction added to the program.
  */
 bool Inliner::inlineCallsInvolvedInLoopCarriedDataDependencesWithinLoop(
     Function *F,
@@ -210,7 +209,7 @@ bool Inliner::inlineCallsInvolvedInLoopCarriedDataDependencesWithinLoop(
   /*
    * Check every sequential SCC.
    */
-  int64_t maxMemEdges = 0;
+  double maxGainPerInstruction = 0;
   uint32_t numberOfFunctionCallsToInline = 0;
   CallInst *inlineCall = nullptr;
   auto nonDOALLSCCs = DOALL::getSCCsThatBlockDOALLToBeApplicable(LDI, noelle);
@@ -311,15 +310,20 @@ bool Inliner::inlineCallsInvolvedInLoopCarriedDataDependencesWithinLoop(
       }
 
       /*
-       * Consider only the call instruction with the maximum number of memory
-       * edges. Also, consider only calls to functions that are smaller than the
-       * current loop size.
+       * Consider only the call instruction with the maximum gain per
+       * instruction added to the program. Also, consider only calls to
+       * functions that are smaller than the current loop size.
        */
       numberOfFunctionCallsToInline++;
-      if (true && (memEdgeCount > maxMemEdges)
-          && (hot->getStaticInstructions(callF)
-              < hot->getStaticInstructions(loopStructure))) {
-        maxMemEdges = memEdgeCount;
+      auto growth = hot->getStaticInstructions(callF);
+      if (growth >= hot->getStaticInstructions(loopStructure)) {
+        continue;
+      }
+      auto gain =
+          this->getGainOfInlining(hot, loopStructure, scc, memEdgeCount);
+      auto gainPerInstruction = gain / ((double)std::max<uint64_t>(growth, 1));
+      if (gainPerInstruction > maxGainPerInstruction) {
+        maxGainPerInstruction = gainPerInstruction;
         inlineCall = call;
       }
     }
@@ -353,10 +357,45 @@ bool Inliner::inlineCallsInvolvedInLoopCarriedDataDependencesWithinLoop(
   /*
    * Inline the call instruction.
    */
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << "Inliner:   The best call to inline of the loop "
+           << *loopStructure->getHeader()->getFirstNonPHI()
+           << " has an expected gain of " << maxGainPerInstruction
+           << " per instruction added\n";
+  }
   auto inlined =
       inlineFunctionCall(hot, F, inlineCall->getCalledFunction(), inlineCall);
 
   return inlined;
 }
 
+double Inliner::getGainOfInlining(Hot *p,
+                                  LoopStructure *loop,
+                                  SCC *scc,
+                                  uint32_t memEdgeCount) {
+
+  /*
+   * Without profiles, estimate the gain by the number of memory dependences
+   * that inlining could make more precise.
+   */
+  if (!p->isAvailable()) {
+    return memEdgeCount;
+  }
+
+  /*
+   * Use the model of the time saved by the planner: the fraction of the
+   * execution time of the program that can run in parallel if the SCC stops
+   * blocking the loop.
+   */
+  auto loopInsts = p->getTotalInstructions(loop);
+  if (loopInsts == 0) {
+    return 0;
+  }
+  auto sccInsts = p->getTotalInstructions(scc);
+  auto loopFractionSaved = ((double)sccInsts) / ((double)loopInsts);
+  auto gain = loopFractionSaved * p->getDynamicTotalInstructionCoverage(loop);
+
+  return gain;
+}
+
 } // namespace llvm::noelle
@@ -32,9 +32,18 @@ static cl::opt<int> Verbose(
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Verbose output (0: disabled, 1: minimal, 2: maximal"));
+static cl::opt<int> MaxCodeGrowth(
+    "noelle-inliner-max-code-growth",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc(
+        "Maximum percentage of the program instructions that inlining can add (default: 20)"));
 
 bool Inliner::doInitialization(Module &M) {
   this->verbose = static_cast<Verbosity>(Verbose.getValue());
+  if (MaxCodeGrowth.getNumOccurrences() > 0) {
+    this->maxCodeGrowth = MaxCodeGrowth.getValue();
+  }
 
   return false;
 }
@@ -42,7 +51,6 @@ bool Inliner::doInitialization(Module &M) {
 void Inliner::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<Noelle>();
   AU.addRequired<LoopInfoWrapperPass>();
-  AU.addRequired<CallGraphWrapperPass>();
   AU.addRequired<DominatorTreeWrapperPass>();
 
   return;
@@ -35,6 +35,12 @@ public:
    */
   LoopInvariantCodeMotion(Noelle &noelle);
 
+  /*
+   * If @promoteAcrossLoopNests is set, memory locations are promoted to
+   * registers in the outermost loop of the nest where this is legal.
+   */
+  LoopInvariantCodeMotion(Noelle &noelle, bool promoteAcrossLoopNests);
+
   bool extractInvariantsFromLoop(LoopDependenceInfo const &LDI);
 
   bool promoteMemoryLocationsToRegisters(LoopDependenceInfo const &LDI);
@@ -44,6 +50,7 @@ private:
    * Fields
    */
   Noelle &noelle;
+  bool promoteAcrossLoopNests;
 
   /*
    * Methods
@@ -52,6 +59,9 @@ private:
 
   bool hoistInvariantValues(LoopDependenceInfo const &LDI);
 
+  bool promoteMemoryLocationsToRegistersOfOuterLoops(
+      LoopDependenceInfo const &LDI);
+
   std::vector<Instruction *> getSourceDependenceInstructionsFrom(
       LoopDependenceInfo const &LDI,
       Instruction &I);
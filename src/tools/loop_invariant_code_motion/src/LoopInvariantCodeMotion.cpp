@@ -26,12 +26,23 @@ using namespace llvm;
 using namespace llvm::noelle;
 
 LoopInvariantCodeMotion::LoopInvariantCodeMotion(Noelle &noelle)
-  : noelle{ noelle } {
+  : LoopInvariantCodeMotion(noelle, false) {
+  return;
+}
+
+LoopInvariantCodeMotion::LoopInvariantCodeMotion(Noelle &noelle,
+                                                 bool promoteAcrossLoopNests)
+  : noelle{ noelle },
+    promoteAcrossLoopNests{ promoteAcrossLoopNests } {
   return;
 }
 
 bool LoopInvariantCodeMotion::promoteMemoryLocationsToRegisters(
     LoopDependenceInfo const &LDI) {
+  if (this->promoteMemoryLocationsToRegistersOfOuterLoops(LDI)) {
+    return true;
+  }
+
   Mem2RegNonAlloca mem2Reg(LDI, this->noelle);
 
   auto result = mem2Reg.promoteMemoryToRegister();
@@ -46,6 +57,10 @@ bool LoopInvariantCodeMotion::extractInvariantsFromLoop(
     return true;
   }
 
+  if (this->promoteMemoryLocationsToRegistersOfOuterLoops(LDI)) {
+    return true;
+  }
+
   Mem2RegNonAlloca mem2Reg(LDI, noelle);
   if (mem2Reg.promoteMemoryToRegister()) {
     return true;
@@ -53,3 +68,60 @@ bool LoopInvariantCodeMotion::extractInvariantsFromLoop(
 
   return false;
 }
+
+bool LoopInvariantCodeMotion::promoteMemoryLocationsToRegistersOfOuterLoops(
+    LoopDependenceInfo const &LDI) {
+  if (!this->promoteAcrossLoopNests) {
+    return false;
+  }
+
+  /*
+   * Fetch the memory locations that can be promoted within the loop.
+   */
+  Mem2RegNonAlloca mem2Reg(LDI, this->noelle);
+  auto memoryLocations = mem2Reg.getPromotableMemoryLocations();
+  if (memoryLocations.empty()) {
+    return false;
+  }
+
+  /*
+   * Fetch the outer loops, from the outermost one.
+   */
+  std::vector<LoopStructure *> outerLoops;
+  auto loopNode = LDI.getLoopHierarchyStructures();
+  for (auto outerLoopNode = loopNode->getParent(); outerLoopNode != nullptr;
+       outerLoopNode = outerLoopNode->getParent()) {
+    outerLoops.insert(outerLoops.begin(), outerLoopNode->getLoop());
+  }
+
+  /*
+   * Promote the memory locations in the outermost loop where this is legal.
+   * This rewrites the whole nest at once, so the promoted values are carried
+   * by registers across all its levels rather than being loaded and stored
+   * around each inner loop.
+   */
+  auto canBePromoted = [&memoryLocations](Value *memoryLocation) -> bool {
+    return memoryLocations.find(memoryLocation) != memoryLocations.end();
+  };
+  for (auto outerLoop : outerLoops) {
+    if (outerLoop->getPreHeader() == nullptr) {
+      continue;
+    }
+    auto outerLDI = this->noelle.getLoop(outerLoop);
+    Mem2RegNonAlloca outerMem2Reg(*outerLDI, this->noelle);
+    auto promoted = outerMem2Reg.promoteMemoryToRegister(canBePromoted);
+    delete outerLDI;
+    if (promoted) {
+      if (this->noelle.getVerbosity() != Verbosity::Disabled) {
+        errs() << "LICM: Promoted memory locations to registers in the loop "
+               << *outerLoop->getHeader()->getFirstNonPHI()
+               << " that includes the loop "
+               << *LDI.getLoopStructure()->getHeader()->getFirstNonPHI()
+               << "\n";
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
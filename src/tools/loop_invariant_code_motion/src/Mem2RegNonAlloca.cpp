@@ -33,6 +33,23 @@ Mem2RegNonAlloca::Mem2RegNonAlloca(LoopDependenceInfo const &LDI,
 }
 
 bool Mem2RegNonAlloca::promoteMemoryToRegister(void) {
+  auto canBePromoted = [](Value *memoryLocation) -> bool { return true; };
+
+  return this->promoteMemoryToRegister(canBePromoted);
+}
+
+std::unordered_set<Value *> Mem2RegNonAlloca::getPromotableMemoryLocations(
+    void) {
+  std::unordered_set<Value *> memoryLocations;
+  for (auto memoryAndSCCPair : this->findSCCsWithSingleMemoryLocations()) {
+    memoryLocations.insert(memoryAndSCCPair.first);
+  }
+
+  return memoryLocations;
+}
+
+bool Mem2RegNonAlloca::promoteMemoryToRegister(
+    std::function<bool(Value *)> canBePromoted) {
 
   /*
    * Fetch the loop structure.
@@ -93,6 +110,9 @@ bool Mem2RegNonAlloca::promoteMemoryToRegister(void) {
      */
     auto memoryInst = memoryAndSCCPair.first;
     auto memorySCC = memoryAndSCCPair.second;
+    if (!canBePromoted(memoryInst)) {
+      continue;
+    }
 
     if (noelle.getVerbosity() >= Verbosity::Maximal) {
       memoryInst->print(errs()
@@ -38,6 +38,14 @@ public:
 
   bool promoteMemoryToRegister(void);
 
+  /*
+   * Promote to registers only the memory locations accepted by
+   * @canBePromoted.
+   */
+  bool promoteMemoryToRegister(std::function<bool(Value *)> canBePromoted);
+
+  std::unordered_set<Value *> getPromotableMemoryLocations(void);
+
 private:
   LoopDependenceInfo const &LDI;
   Noelle &noelle;
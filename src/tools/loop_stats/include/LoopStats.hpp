@@ -41,6 +41,8 @@ public:
 private:
   struct Stats {
     int64_t loopID = -1;
+    int64_t uniqueLoopID = -1;
+    Function *function = nullptr;
     int64_t numberOfIVs = 0;
     int64_t numberOfDynamicIVs = 0;
     int64_t isGovernedByIV = 0;
@@ -82,19 +84,41 @@ private:
   std::unordered_map<int, Stats *> statsByLoopAccordingToLLVM;
   std::unordered_map<int, Stats *> statsByLoopAccordingToNoelle;
 
+  /*
+   * Number of threads used to compute the SCCDAGs of the loops.
+   */
+  uint32_t threads;
+
+  /*
+   * Files to dump the statistics to (empty if they should not be dumped).
+   */
+  std::string jsonFileName;
+  std::string csvFileName;
+
   void collectStatsForLoops(Noelle &noelle,
                             std::vector<LoopDependenceInfo *> const &loops);
 
+  /*
+   * Compute the SCCDAG of the instructions of each loop of @loops, without
+   * merging its SCCs.
+   * The loops of different functions are handled in parallel.
+   */
+  std::unordered_map<LoopDependenceInfo *, SCCDAG *> computeLoopSCCDAGs(
+      std::vector<LoopDependenceInfo *> const &loops);
+
   void collectStatsForLoop(Hot *profiles,
                            int id,
                            ScalarEvolution &SE,
-                           PDG *loopDG,
+                           SCCDAG *loopSCCDAG,
                            Loop &llvmLoop);
   void collectStatsForLoop(Hot *profiles,
                            LoopDependenceInfo &LDI,
+                           SCCDAG *loopSCCDAG,
                            Loop &llvmLoop);
 
-  void collectStatsOnLLVMSCCs(Hot *profiles, PDG *loopDG, Stats *statsForLoop);
+  void collectStatsOnLLVMSCCs(Hot *profiles,
+                              SCCDAG *loopSCCDAG,
+                              Stats *statsForLoop);
   void collectStatsOnLLVMIVs(Hot *profiles,
                              ScalarEvolution &SE,
                              Loop &llvmLoop,
@@ -108,6 +132,7 @@ private:
                                Stats *stats);
   void collectStatsOnNoelleSCCs(Hot *profiles,
                                 LoopDependenceInfo &LDI,
+                                SCCDAG *loopSCCDAG,
                                 Stats *stats,
                                 Loop &llvmLoop);
   void collectStatsOnNoelleInvariants(Hot *profiles,
@@ -122,6 +147,14 @@ private:
 
   void printPerLoopStats(Hot *profiles, Stats *stats);
   void printStatsHumanReadable(Hot *profiles);
+  void printStatsAsJSON(Hot *profiles);
+  void printStatsAsCSV(Hot *profiles);
+
+  /*
+   * Return the IDs of the loops sorted, so the statistics are printed in a
+   * stable order.
+   */
+  std::vector<int> getSortedLoopIDs(void) const;
 };
 
 } // namespace llvm::noelle
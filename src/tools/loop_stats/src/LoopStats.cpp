@@ -38,6 +38,12 @@ void LoopStats::collectStatsForLoops(
     errs() << "LoopStats: WARNING: the profiles are not available\n";
   }
 
+  /*
+   * Compute the SCCDAGs of the loops, which are shared by the statistics
+   * computed with noelle's abstractions and the ones computed with LLVM's.
+   */
+  auto loopSCCDAGs = this->computeLoopSCCDAGs(loops);
+
   /*
    * Collect statistics about each loop using noelle's abstractions.
    */
@@ -53,7 +59,7 @@ void LoopStats::collectStatsForLoops(
     auto &LI = getAnalysis<LoopInfoWrapperPass>(*loopFunction).getLoopInfo();
     auto llvmLoop = LI.getLoopFor(loopHeader);
 
-    collectStatsForLoop(profiles, *loop, *llvmLoop);
+    collectStatsForLoop(profiles, *loop, loopSCCDAGs.at(loop), *llvmLoop);
   }
 
   /*
@@ -68,20 +74,32 @@ void LoopStats::collectStatsForLoops(
     auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(*loopFunction).getSE();
     auto &LI = getAnalysis<LoopInfoWrapperPass>(*loopFunction).getLoopInfo();
     auto llvmLoop = LI.getLoopFor(loopHeader);
-    auto loopDG = LDI->getLoopDG();
 
-    collectStatsForLoop(profiles, id, SE, loopDG, *llvmLoop);
+    collectStatsForLoop(profiles, id, SE, loopSCCDAGs.at(LDI), *llvmLoop);
+  }
+
+  /*
+   * Free the memory.
+   */
+  for (auto &pair : loopSCCDAGs) {
+    delete pair.second;
   }
 
   /*
    * Print the statistics.
    */
   printStatsHumanReadable(profiles);
+  if (this->jsonFileName != "") {
+    printStatsAsJSON(profiles);
+  }
+  if (this->csvFileName != "") {
+    printStatsAsCSV(profiles);
+  }
 
   return;
 }
 
-LoopStats::LoopStats() : ModulePass{ ID } {
+LoopStats::LoopStats() : ModulePass{ ID }, threads{ 1 } {
   return;
 }
 
@@ -19,14 +19,14 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <future>
+
 #include "LoopStats.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
 
-void LoopStats::collectStatsOnLLVMSCCs(Hot *profiles,
-                                       PDG *loopDG,
-                                       Stats *statsForLoop) {
+static SCCDAG *computeLoopInternalSCCDAG(PDG *loopDG) {
 
   /*
    * Construct loop internal SCCDAG (it uses LLVM's scc_iterator)
@@ -36,18 +36,89 @@ void LoopStats::collectStatsOnLLVMSCCs(Hot *profiles,
     loopInternals.push_back(internalNode.first);
   }
   auto loopInternalDG = loopDG->createSubgraphFromValues(loopInternals, false);
-  auto loopInternalSCCDAG = SCCDAG(loopInternalDG);
-  collectStatsOnSCCDAG(profiles,
-                       &loopInternalSCCDAG,
-                       nullptr,
-                       nullptr,
-                       statsForLoop);
+
+  return new SCCDAG(loopInternalDG);
+}
+
+std::unordered_map<LoopDependenceInfo *, SCCDAG *> LoopStats::
+    computeLoopSCCDAGs(std::vector<LoopDependenceInfo *> const &loops) {
+  std::unordered_map<LoopDependenceInfo *, SCCDAG *> loopSCCDAGs;
+
+  /*
+   * Fetch the dependence graphs of the loops, grouped by function.
+   * The graphs of the loops might be computed lazily, which is not
+   * thread-safe, so they are fetched before starting the parallel tasks.
+   */
+  std::vector<std::vector<std::pair<LoopDependenceInfo *, PDG *>>> jobs;
+  std::unordered_map<Function *, uint64_t> jobOfFunction;
+  for (auto LDI : loops) {
+    auto loopFunction = LDI->getLoopStructure()->getFunction();
+    if (jobOfFunction.find(loopFunction) == jobOfFunction.end()) {
+      jobOfFunction[loopFunction] = jobs.size();
+      jobs.push_back({});
+    }
+    jobs[jobOfFunction[loopFunction]].push_back(
+        std::make_pair(LDI, LDI->getLoopDG()));
+  }
+
+  /*
+   * Check if the SCCDAGs should be computed sequentially.
+   */
+  if (this->threads <= 1) {
+    for (auto &job : jobs) {
+      for (auto &pair : job) {
+        loopSCCDAGs[pair.first] = computeLoopInternalSCCDAG(pair.second);
+      }
+    }
+    return loopSCCDAGs;
+  }
+
+  /*
+   * Compute the SCCDAGs, one task per function.
+   * Computing the SCCDAG of a loop only reads its dependence graph and the IR.
+   * At most one task per thread is in flight.
+   */
+  typedef std::vector<std::pair<LoopDependenceInfo *, SCCDAG *>> JobResult;
+  std::deque<std::future<JobResult>> tasks;
+  uint64_t nextJob = 0;
+  for (auto i = 0u; i < jobs.size(); i++) {
+    while (true && (nextJob < jobs.size()) && (tasks.size() < this->threads)) {
+      auto &job = jobs[nextJob];
+      auto computeTask = [&job]() -> JobResult {
+        JobResult result;
+        for (auto &pair : job) {
+          auto loopSCCDAG = computeLoopInternalSCCDAG(pair.second);
+          result.push_back(std::make_pair(pair.first, loopSCCDAG));
+        }
+        return result;
+      };
+      tasks.push_back(std::async(std::launch::async, computeTask));
+      nextJob++;
+    }
+
+    /*
+     * Collect the SCCDAGs of the oldest task.
+     */
+    for (auto &pair : tasks.front().get()) {
+      loopSCCDAGs[pair.first] = pair.second;
+    }
+    tasks.pop_front();
+  }
+
+  return loopSCCDAGs;
+}
+
+void LoopStats::collectStatsOnLLVMSCCs(Hot *profiles,
+                                       SCCDAG *loopSCCDAG,
+                                       Stats *statsForLoop) {
+  collectStatsOnSCCDAG(profiles, loopSCCDAG, nullptr, nullptr, statsForLoop);
 
   return;
 }
 
 void LoopStats::collectStatsOnNoelleSCCs(Hot *profiles,
                                          LoopDependenceInfo &LDI,
+                                         SCCDAG *loopSCCDAG,
                                          Stats *statsForLoop,
                                          Loop &llvmLoop) {
 
@@ -57,15 +128,11 @@ void LoopStats::collectStatsOnNoelleSCCs(Hot *profiles,
    * parallelization schemes
    *
    * Once this hack is removed, this can go away
+   *
+   * The SCCDAG of the loop is the same one used for the LLVM statistics.
    */
   auto loopStructure = LDI.getLoopStructure();
   auto loopDG = LDI.getLoopDG();
-  std::vector<Value *> loopInternals;
-  for (auto internalNode : loopDG->internalNodePairs()) {
-    loopInternals.push_back(internalNode.first);
-  }
-  auto loopInternalDG = loopDG->createSubgraphFromValues(loopInternals, false);
-  auto loopInternalSCCDAG = SCCDAG(loopInternalDG);
 
   auto loopHierarchy = LDI.getLoopHierarchyStructures();
   auto loopFunction = loopStructure->getFunction();
@@ -80,21 +147,21 @@ void LoopStats::collectStatsOnNoelleSCCs(Hot *profiles,
   auto inductionVariables = InductionVariableManager(loopHierarchy,
                                                      *invariantManager,
                                                      SE,
-                                                     loopInternalSCCDAG,
+                                                     *loopSCCDAG,
                                                      environment,
                                                      llvmLoop);
   auto sccdagAttrs = SCCDAGAttrs(true,
                                  loopDG,
-                                 &loopInternalSCCDAG,
+                                 loopSCCDAG,
                                  loopHierarchy,
                                  SE,
                                  inductionVariables,
                                  DS);
 
   // DGPrinter::writeGraph<SCCDAG, SCC>("sccdag-" + std::to_string(LDI.getID())
-  // + ".dot", &loopInternalSCCDAG);
+  // + ".dot", loopSCCDAG);
   collectStatsOnSCCDAG(profiles,
-                       &loopInternalSCCDAG,
+                       loopSCCDAG,
                        &sccdagAttrs,
                        &LDI,
                        statsForLoop);
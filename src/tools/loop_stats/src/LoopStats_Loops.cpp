@@ -19,6 +19,7 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "noelle/core/UniqueIRMarkerReader.hpp"
 #include "LoopStats.hpp"
 
 using namespace llvm;
@@ -27,17 +28,22 @@ using namespace llvm::noelle;
 void LoopStats::collectStatsForLoop(Hot *profiles,
                                     int id,
                                     ScalarEvolution &SE,
-                                    PDG *loopDG,
+                                    SCCDAG *loopSCCDAG,
                                     Loop &llvmLoop) {
   auto statsForLoop = new Stats();
   statsByLoopAccordingToLLVM.insert(std::make_pair(id, statsForLoop));
   statsForLoop->loopID = id;
 
   auto loopFunction = llvmLoop.getHeader()->getParent();
+  statsForLoop->function = loopFunction;
+  auto uniqueLoopID = UniqueIRMarkerReader::getLoopID(&llvmLoop);
+  if (uniqueLoopID) {
+    statsForLoop->uniqueLoopID = uniqueLoopID.value();
+  }
 
   collectStatsOnLLVMIVs(profiles, SE, llvmLoop, statsForLoop);
   collectStatsOnLLVMInvariants(profiles, llvmLoop, statsForLoop);
-  collectStatsOnLLVMSCCs(profiles, loopDG, statsForLoop);
+  collectStatsOnLLVMSCCs(profiles, loopSCCDAG, statsForLoop);
 
   /*
    * Compute the coverage for the loop.
@@ -51,15 +57,21 @@ void LoopStats::collectStatsForLoop(Hot *profiles,
 
 void LoopStats::collectStatsForLoop(Hot *profiles,
                                     LoopDependenceInfo &LDI,
+                                    SCCDAG *loopSCCDAG,
                                     Loop &llvmLoop) {
   auto loopStructure = LDI.getLoopStructure();
   auto statsForLoop = new Stats();
   statsByLoopAccordingToNoelle.insert(
       std::make_pair(LDI.getID(), statsForLoop));
   statsForLoop->loopID = loopStructure->getID();
+  statsForLoop->function = loopStructure->getFunction();
+  auto uniqueLoopID = UniqueIRMarkerReader::getLoopID(&llvmLoop);
+  if (uniqueLoopID) {
+    statsForLoop->uniqueLoopID = uniqueLoopID.value();
+  }
 
   collectStatsOnNoelleIVs(profiles, LDI, statsForLoop);
-  collectStatsOnNoelleSCCs(profiles, LDI, statsForLoop, llvmLoop);
+  collectStatsOnNoelleSCCs(profiles, LDI, loopSCCDAG, statsForLoop, llvmLoop);
   collectStatsOnNoelleInvariants(profiles, LDI, statsForLoop);
 
   /*
@@ -19,6 +19,7 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "llvm/Support/JSON.h"
 #include "LoopStats.hpp"
 
 using namespace llvm;
@@ -148,3 +149,113 @@ void LoopStats::printStatsHumanReadable(Hot *profiles) {
 
   return;
 }
+
+std::vector<int> LoopStats::getSortedLoopIDs(void) const {
+  std::vector<int> ids;
+  for (auto &idAndNoelleLoop : this->statsByLoopAccordingToNoelle) {
+    ids.push_back(idAndNoelleLoop.first);
+  }
+  std::sort(ids.begin(), ids.end());
+
+  return ids;
+}
+
+void LoopStats::printStatsAsJSON(Hot *profiles) {
+  std::error_code EC;
+  raw_fd_ostream file(this->jsonFileName, EC);
+  if (EC) {
+    errs() << "LoopStats: ERROR: cannot write " << this->jsonFileName << "\n";
+    return;
+  }
+
+  /*
+   * Loops are identified by their ID set by the UniqueIRMarker pass, which is
+   * stable across compilations (null if the loop has not been marked).
+   */
+  json::OStream J(file, 2);
+  auto printStats = [&J](Stats *stats) {
+    J.attribute("ivs", stats->numberOfIVs);
+    J.attribute("dynamic_ivs", stats->numberOfDynamicIVs);
+    J.attribute("governing_ivs", stats->isGovernedByIV);
+    J.attribute("dynamic_governing_ivs", stats->numberOfDynamicGovernedIVs);
+    J.attribute("invariants", stats->numberOfInvariants);
+    J.attribute("dynamic_invariants", stats->numberOfDynamicInvariants);
+    J.attribute("sccdag_nodes", stats->numberOfNodesInSCCDAG);
+    J.attribute("sccs", stats->numberOfSCCs);
+    J.attribute("sequential_sccs", stats->numberOfSequentialSCCs);
+    J.attribute("dynamic_instructions_of_sequential_sccs",
+                stats->dynamicInstructionsOfSequentialSCCs);
+    J.attribute("dynamic_total_instructions",
+                (int64_t)stats->dynamicTotalInstructions);
+  };
+  Stats totalInfoNoelle{};
+  Stats totalInfoLLVM{};
+  J.object([&] {
+    J.attribute("profiles_available", profiles->isAvailable());
+    J.attributeArray("loops", [&] {
+      for (auto id : this->getSortedLoopIDs()) {
+        auto noelleStats = this->statsByLoopAccordingToNoelle.at(id);
+        auto llvmStats = this->statsByLoopAccordingToLLVM.at(id);
+        totalInfoNoelle = totalInfoNoelle + *noelleStats;
+        totalInfoLLVM = totalInfoLLVM + *llvmStats;
+        J.object([&] {
+          if (noelleStats->uniqueLoopID != -1) {
+            J.attribute("id", noelleStats->uniqueLoopID);
+          } else {
+            J.attribute("id", nullptr);
+          }
+          J.attribute("function", noelleStats->function->getName());
+          J.attributeObject("noelle", [&] { printStats(noelleStats); });
+          J.attributeObject("llvm", [&] { printStats(llvmStats); });
+        });
+      }
+    });
+    J.attributeObject("total", [&] {
+      J.attributeObject("noelle", [&] { printStats(&totalInfoNoelle); });
+      J.attributeObject("llvm", [&] { printStats(&totalInfoLLVM); });
+    });
+  });
+  file << "\n";
+
+  return;
+}
+
+void LoopStats::printStatsAsCSV(Hot *profiles) {
+  std::error_code EC;
+  raw_fd_ostream file(this->csvFileName, EC);
+  if (EC) {
+    errs() << "LoopStats: ERROR: cannot write " << this->csvFileName << "\n";
+    return;
+  }
+
+  /*
+   * Each loop has one row per source of statistics (noelle and LLVM).
+   * The ID of a loop is empty if the loop has not been marked by the
+   * UniqueIRMarker pass.
+   */
+  file << "id,function,source,ivs,dynamic_ivs,governing_ivs,"
+          "dynamic_governing_ivs,invariants,dynamic_invariants,sccdag_nodes,"
+          "sccs,sequential_sccs,dynamic_instructions_of_sequential_sccs,"
+          "dynamic_total_instructions\n";
+  auto printRow = [&file](Stats *stats, StringRef source) {
+    if (stats->uniqueLoopID != -1) {
+      file << stats->uniqueLoopID;
+    }
+    file << "," << stats->function->getName() << "," << source;
+    file << "," << stats->numberOfIVs << "," << stats->numberOfDynamicIVs;
+    file << "," << stats->isGovernedByIV << ","
+         << stats->numberOfDynamicGovernedIVs;
+    file << "," << stats->numberOfInvariants << ","
+         << stats->numberOfDynamicInvariants;
+    file << "," << stats->numberOfNodesInSCCDAG << "," << stats->numberOfSCCs
+         << "," << stats->numberOfSequentialSCCs;
+    file << "," << stats->dynamicInstructionsOfSequentialSCCs << ","
+         << stats->dynamicTotalInstructions << "\n";
+  };
+  for (auto id : this->getSortedLoopIDs()) {
+    printRow(this->statsByLoopAccordingToNoelle.at(id), "noelle");
+    printRow(this->statsByLoopAccordingToLLVM.at(id), "llvm");
+  }
+
+  return;
+}
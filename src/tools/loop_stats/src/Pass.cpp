@@ -19,12 +19,42 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "noelle/core/Architecture.hpp"
 #include "LoopStats.hpp"
 
 using namespace llvm;
 using namespace llvm::noelle;
 
+static cl::opt<int> Threads(
+    "loop-stats-threads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Number of threads used to compute the SCCDAGs of the loops "
+             "(0: all cores)"));
+static cl::opt<std::string> JSONFile(
+    "loop-stats-json",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Dump the statistics of the loops to a JSON file"));
+static cl::opt<std::string> CSVFile(
+    "loop-stats-csv",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Dump the statistics of the loops to a CSV file"));
+
 bool LoopStats::doInitialization(Module &M) {
+  if (Threads.getNumOccurrences() > 0) {
+    this->threads = (Threads.getValue() > 0)
+                        ? Threads.getValue()
+                        : Architecture::getNumberOfLogicalCores();
+  }
+  if (JSONFile.getNumOccurrences() > 0) {
+    this->jsonFileName = JSONFile.getValue();
+  }
+  if (CSVFile.getNumOccurrences() > 0) {
+    this->csvFileName = CSVFile.getValue();
+  }
+
   return false;
 }
 
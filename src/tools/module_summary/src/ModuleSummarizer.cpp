@@ -0,0 +1,226 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "noelle/core/LibraryFunctions.hpp"
+#include "ModuleSummarizer.hpp"
+
+namespace llvm::noelle {
+
+ModuleSummarizer::FunctionSummary::FunctionSummary()
+  : reads{ false },
+    writes{ false },
+    argMemOnly{ true } {
+  return;
+}
+
+ModuleSummarizer::FunctionSummary ModuleSummarizer::summarizeFunction(
+    Function &F) const {
+  FunctionSummary summary;
+  for (auto &I : instructions(F)) {
+    auto callee = this->addToSummary(summary, &I);
+    if (callee.has_value()) {
+      summary.callees.insert(callee.value());
+    }
+  }
+
+  return summary;
+}
+
+std::optional<std::string> ModuleSummarizer::addToSummary(
+    FunctionSummary &summary,
+    Instruction *I) const {
+
+  /*
+   * Fetch the abstract memory object accessed through @pointer.
+   * Accesses to the stack of the function are not visible to its callers.
+   */
+  auto &DL = I->getModule()->getDataLayout();
+  auto localFunction = I->getFunction();
+  auto addAccess = [&summary, &DL, localFunction](Value *pointer,
+                                                  bool isWrite) {
+    auto object = GetUnderlyingObject(pointer, DL);
+    if (auto alloca = dyn_cast<AllocaInst>(object)) {
+      if (alloca->getFunction() == localFunction) {
+        return;
+      }
+    }
+    if (isWrite) {
+      summary.writes = true;
+    } else {
+      summary.reads = true;
+    }
+    if (!isa<Argument>(object)) {
+      summary.argMemOnly = false;
+    }
+  };
+
+  /*
+   * Loads, stores, and atomics.
+   */
+  if (auto load = dyn_cast<LoadInst>(I)) {
+    addAccess(load->getPointerOperand(), false);
+    return {};
+  }
+  if (auto store = dyn_cast<StoreInst>(I)) {
+    addAccess(store->getPointerOperand(), true);
+    return {};
+  }
+  if (auto rmw = dyn_cast<AtomicRMWInst>(I)) {
+    addAccess(rmw->getPointerOperand(), false);
+    addAccess(rmw->getPointerOperand(), true);
+    return {};
+  }
+  if (auto cmpXchg = dyn_cast<AtomicCmpXchgInst>(I)) {
+    addAccess(cmpXchg->getPointerOperand(), false);
+    addAccess(cmpXchg->getPointerOperand(), true);
+    return {};
+  }
+
+  /*
+   * Calls.
+   */
+  auto call = dyn_cast<CallBase>(I);
+  if (call == nullptr) {
+    if (I->mayReadOrWriteMemory()) {
+      summary.reads = true;
+      summary.writes = true;
+      summary.argMemOnly = false;
+    }
+    return {};
+  }
+  if (false || isa<DbgInfoIntrinsic>(call) || call->isLifetimeStartOrEnd()
+      || call->doesNotAccessMemory()) {
+    return {};
+  }
+  if (auto memoryIntrinsic = dyn_cast<MemIntrinsic>(call)) {
+    addAccess(memoryIntrinsic->getRawDest(), true);
+    if (auto transfer = dyn_cast<MemTransferInst>(call)) {
+      addAccess(transfer->getRawSource(), false);
+    }
+    return {};
+  }
+
+  /*
+   * Indirect calls can invoke any function.
+   */
+  auto callee =
+      dyn_cast<Function>(call->getCalledOperand()->stripPointerCasts());
+  if (callee == nullptr) {
+    return std::string("*");
+  }
+
+  /*
+   * Functions defined in the unit are described by their own summaries.
+   */
+  auto calleeName = callee->getName();
+  if (!callee->isDeclaration()) {
+    return calleeName.str();
+  }
+
+  /*
+   * Declarations whose effects are known (e.g., from their attributes or
+   * from the library specifications) are summarized here.
+   * The other ones could be defined by another unit.
+   */
+  if (LibraryFunctions::isPure(calleeName)) {
+    return {};
+  }
+  auto readOnly =
+      (call->onlyReadsMemory() || LibraryFunctions::isReadOnly(calleeName));
+  auto argMemOnly = (call->onlyAccessesArgMemory()
+                     || LibraryFunctions::isArgMemOnly(calleeName));
+  if (callee->isIntrinsic() || readOnly) {
+    if (!argMemOnly) {
+      summary.reads = true;
+      summary.writes |= !readOnly;
+      summary.argMemOnly = false;
+      return {};
+    }
+    for (auto &argument : call->args()) {
+      if (!argument->getType()->isPointerTy()) {
+        continue;
+      }
+      addAccess(argument, false);
+      if (!readOnly) {
+        addAccess(argument, true);
+      }
+    }
+    return {};
+  }
+
+  return calleeName.str();
+}
+
+void ModuleSummarizer::printSummary(Module &M, raw_ostream &output) {
+  output << "# NOELLE summary of " << M.getModuleIdentifier() << "\n";
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+
+    /*
+     * Print the summary of the function.
+     */
+    auto summary = this->summarizeFunction(F);
+    auto toString = [](bool value) -> std::string {
+      return value ? "yes" : "no";
+    };
+    output << "function " << F.getName() << " "
+           << (F.hasLocalLinkage() ? "internal" : "external") << " "
+           << toString(summary.reads) << " " << toString(summary.writes)
+           << " " << toString(summary.argMemOnly) << "\n";
+    for (auto &callee : summary.callees) {
+      output << "call " << F.getName() << " " << callee << "\n";
+    }
+
+    /*
+     * Print the callees of its loops.
+     */
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    auto loopIndex = 0;
+    for (auto loop : LI.getLoopsInPreorder()) {
+      std::set<std::string> loopCallees;
+      FunctionSummary loopSummary;
+      for (auto bb : loop->blocks()) {
+        for (auto &I : *bb) {
+          auto callee = this->addToSummary(loopSummary, &I);
+          if (callee.has_value()) {
+            loopCallees.insert(callee.value());
+          }
+        }
+      }
+      output << "loop " << F.getName() << " " << loopIndex;
+      for (auto &callee : loopCallees) {
+        output << " " << callee;
+      }
+      output << "\n";
+      loopIndex++;
+    }
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
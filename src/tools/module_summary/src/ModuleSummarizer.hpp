@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Summarize the functions and the loops of a compilation unit, so the
+ * decisions that need the whole program (e.g., whether a call to a function
+ * of another unit can write memory) do not need to link all of it in one
+ * module (see noelle-summary-link).
+ *
+ * A summary is a text file with one entry per line:
+ *   function NAME external|internal READS WRITES ARGMEMONLY
+ *   call CALLER CALLEE
+ *   loop FUNCTION INDEX CALLEE ...
+ * READS, WRITES, and ARGMEMONLY are yes or no, and they describe the memory
+ * accessed by the function itself (its stack excluded), not by its callees.
+ * The callees recorded are the functions whose effects are not known in the
+ * unit (i.e., the ones defined in the unit and the ones of other units);
+ * an indirect callee is "*".
+ * Loops are numbered in preorder within their function.
+ */
+class ModuleSummarizer : public ModulePass {
+public:
+  ModuleSummarizer();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /*
+   * Class fields
+   */
+  static char ID;
+
+private:
+  class FunctionSummary {
+  public:
+    bool reads;
+    bool writes;
+    bool argMemOnly;
+    std::set<std::string> callees;
+
+    FunctionSummary();
+  };
+
+  /*
+   * Fields
+   */
+  std::string outputFileName;
+
+  /*
+   * Methods
+   */
+  FunctionSummary summarizeFunction(Function &F) const;
+
+  /*
+   * Add the effects of @I to @summary, and return the callee of @I to record
+   * (if any).
+   */
+  std::optional<std::string> addToSummary(FunctionSummary &summary,
+                                          Instruction *I) const;
+
+  void printSummary(Module &M, raw_ostream &output);
+};
+
+} // namespace llvm::noelle
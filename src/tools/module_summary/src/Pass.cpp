@@ -0,0 +1,78 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "ModuleSummarizer.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<std::string> SummaryOutput(
+    "noelle-summary-output",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init("-"),
+    cl::desc("File to write the summary of the module to (-: stdout)"));
+
+ModuleSummarizer::ModuleSummarizer() : ModulePass{ ID } {
+
+  return;
+}
+
+bool ModuleSummarizer::doInitialization(Module &M) {
+  this->outputFileName = SummaryOutput.getValue();
+
+  return false;
+}
+
+bool ModuleSummarizer::runOnModule(Module &M) {
+
+  /*
+   * Open the summary file.
+   */
+  std::error_code EC;
+  raw_fd_ostream output(this->outputFileName, EC, sys::fs::F_Text);
+  if (EC) {
+    errs() << "ModuleSummarizer: ERROR = cannot write "
+           << this->outputFileName << "\n";
+    return false;
+  }
+
+  /*
+   * Summarize the module.
+   */
+  this->printSummary(M, output);
+
+  return false;
+}
+
+void ModuleSummarizer::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
+  AU.setPreservesAll();
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+// Next there is code to register your pass to "opt"
+char llvm::noelle::ModuleSummarizer::ID = 0;
+static RegisterPass<ModuleSummarizer> X(
+    "ModuleSummarizer",
+    "Summarize the functions and loops of a compilation unit");
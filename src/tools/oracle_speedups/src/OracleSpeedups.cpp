@@ -0,0 +1,248 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "OracleSpeedups.hpp"
+
+namespace llvm::noelle {
+
+double OracleSpeedups::LoopSpeedups::getBest(void) const {
+  return std::max({ 1.0, this->doall, this->helix, this->dswp });
+}
+
+double OracleSpeedups::LoopSpeedups::getSavedTime(void) const {
+  return this->coverage * (1 - (1 / this->getBest()));
+}
+
+double OracleSpeedups::LoopSpeedups::getProgramSpeedup(void) const {
+  return 1 / (1 - this->getSavedTime());
+}
+
+uint64_t OracleSpeedups::computeCriticalPath(Hot *profiles,
+                                             LoopDependenceInfo *ldi) const {
+  auto sccManager = ldi->getSCCManager();
+  auto sccdag = sccManager->getSCCDAG();
+
+  /*
+   * Compute the heaviest path that starts from each SCC.
+   * The SCCDAG is acyclic, so the paths are memoized.
+   */
+  std::unordered_map<DGNode<SCC> *, uint64_t> heaviestPath;
+  std::function<uint64_t(DGNode<SCC> *)> computePath;
+  computePath = [&](DGNode<SCC> *node) -> uint64_t {
+    auto it = heaviestPath.find(node);
+    if (it != heaviestPath.end()) {
+      return it->second;
+    }
+    uint64_t successorPath = 0;
+    for (auto edge : node->getOutgoingEdges()) {
+      successorPath =
+          std::max(successorPath, computePath(edge->getIncomingNode()));
+    }
+    auto path = profiles->getTotalInstructions(node->getT()) + successorPath;
+    heaviestPath[node] = path;
+
+    return path;
+  };
+
+  uint64_t criticalPath = 0;
+  for (auto node : sccdag->getTopLevelNodes()) {
+    criticalPath = std::max(criticalPath, computePath(node));
+  }
+
+  return criticalPath;
+}
+
+OracleSpeedups::LoopSpeedups OracleSpeedups::computeSpeedups(
+    Noelle &noelle,
+    Hot *profiles,
+    LoopStructure *ls,
+    uint32_t cores) const {
+  LoopSpeedups s{ ls, profiles->getDynamicTotalInstructionCoverage(ls),
+                  1,  1,
+                  1,  0,
+                  0 };
+
+  /*
+   * Check if the loop has been executed.
+   */
+  auto loopInsts = (double)profiles->getTotalInstructions(ls);
+  auto invocations = (double)profiles->getInvocations(ls);
+  auto iterations = (double)profiles->getIterations(ls);
+  if (false || (loopInsts == 0) || (invocations == 0) || (iterations == 0)) {
+    return s;
+  }
+
+  /*
+   * Fetch the dependences of the loop.
+   */
+  auto optimizations = { LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+                         LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID };
+  auto ldi = noelle.getLoop(ls, optimizations);
+  auto sccManager = ldi->getSCCManager();
+  auto sccdag = sccManager->getSCCDAG();
+
+  /*
+   * Compute the dynamic instructions of the sequential SCCs.
+   */
+  uint64_t sequentialInsts = 0;
+  uint64_t biggestSequentialSCCInsts = 0;
+  for (auto node : sccdag->getNodes()) {
+    auto scc = node->getT();
+    if (!sccManager->getSCCAttrs(scc)->mustExecuteSequentially()) {
+      continue;
+    }
+    auto sccInsts = profiles->getTotalInstructions(scc);
+    sequentialInsts += sccInsts;
+    biggestSequentialSCCInsts = std::max(biggestSequentialSCCInsts, sccInsts);
+  }
+  auto criticalPathInsts = this->computeCriticalPath(profiles, ldi);
+  s.sequentialFraction = std::min(1.0, sequentialInsts / loopInsts);
+  s.criticalPathFraction = std::min(1.0, criticalPathInsts / loopInsts);
+
+  /*
+   * Compute the latencies of an average invocation.
+   * The latency of the sequential execution is the one of all its iterations.
+   */
+  auto itersPerInvocation = iterations / invocations;
+  auto instsPerIteration = loopInsts / iterations;
+  auto sequentialLatency = itersPerInvocation * instsPerIteration;
+  auto parallelLatency = sequentialLatency / cores;
+
+  /*
+   * DOALL: the iterations are distributed among the cores, so each core runs
+   * the iterations of its share one after the other.
+   */
+  std::string reason;
+  auto canBeDOALL =
+      (true && DOALL::canBeAppliedToLoopStructure(ls, reason)
+       && DOALL::getSCCsThatBlockDOALLToBeApplicable(ldi, noelle).empty());
+  if (canBeDOALL) {
+    auto latency = std::ceil(itersPerInvocation / cores) * instsPerIteration;
+    s.doall = sequentialLatency / std::max(latency, parallelLatency);
+  }
+
+  /*
+   * HELIX and DSWP.
+   */
+  auto canBeOthers =
+      ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences::
+          canBeAppliedToLoopStructure(ls, reason);
+  if (canBeOthers) {
+
+    /*
+     * HELIX: the sequential segments of consecutive iterations run one after
+     * the other, and the last iteration runs entirely after the sequential
+     * segments of the previous ones.
+     */
+    auto sequentialInstsPerIteration = sequentialInsts / iterations;
+    auto helixLatency =
+        ((itersPerInvocation - 1) * sequentialInstsPerIteration)
+        + instsPerIteration;
+    s.helix = sequentialLatency / std::max(helixLatency, parallelLatency);
+
+    /*
+     * DSWP: the biggest sequential SCC is the bottleneck of the pipeline, which
+     * is filled after the critical path of the SCCDAG of an iteration.
+     */
+    auto bottleneckPerIteration = biggestSequentialSCCInsts / iterations;
+    auto criticalPathPerIteration = criticalPathInsts / iterations;
+    auto dswpLatency = ((itersPerInvocation - 1) * bottleneckPerIteration)
+                       + criticalPathPerIteration;
+    s.dswp = sequentialLatency / std::max(dswpLatency, parallelLatency);
+  }
+
+  /*
+   * Free the memory.
+   */
+  delete ldi;
+
+  return s;
+}
+
+double OracleSpeedups::computeBestSavedTime(
+    StayConnectedNestedLoopForestNode *node) const {
+  double childrenSavedTime = 0;
+  for (auto child : node->getChildren()) {
+    childrenSavedTime += this->computeBestSavedTime(child);
+  }
+  auto savedTime = this->speedups.at(node->getLoop()).getSavedTime();
+
+  return std::max(savedTime, childrenSavedTime);
+}
+
+void OracleSpeedups::printReport(StayConnectedNestedLoopForest *forest,
+                                 uint32_t cores) const {
+
+  /*
+   * Rank the loops by the speedup they can give to the whole program.
+   */
+  std::vector<const LoopSpeedups *> ranking;
+  for (auto &pair : this->speedups) {
+    ranking.push_back(&pair.second);
+  }
+  auto compareOperator = [](const LoopSpeedups *s1, const LoopSpeedups *s2) {
+    if (s1->getSavedTime() != s2->getSavedTime()) {
+      return s1->getSavedTime() > s2->getSavedTime();
+    }
+    return s1->loop->getID() < s2->loop->getID();
+  };
+  std::sort(ranking.begin(), ranking.end(), compareOperator);
+
+  /*
+   * Print the loops.
+   */
+  errs() << "Oracle speedups with " << cores << " cores\n";
+  errs() << "  Rank  Loop  Coverage  Sequential  Critical path   DOALL   HELIX "
+            "   DSWP  Program\n";
+  auto rank = 1;
+  for (auto s : ranking) {
+    errs() << format(
+        "  %4d  %4lu  %7.2f%%  %9.2f%%  %12.2f%%  %6.2f  %6.2f  %6.2f  %7.3f",
+        rank++,
+        (uint64_t)s->loop->getID(),
+        s->coverage * 100,
+        s->sequentialFraction * 100,
+        s->criticalPathFraction * 100,
+        s->doall,
+        s->helix,
+        s->dswp,
+        s->getProgramSpeedup());
+    errs() << "  \"" << s->loop->getFunction()->getName() << "\"\n";
+  }
+
+  /*
+   * Print the upper bound of the whole program.
+   */
+  double savedTime = 0;
+  for (auto tree : forest->getTrees()) {
+    savedTime += this->computeBestSavedTime(tree);
+  }
+  savedTime = std::min(savedTime, 1.0);
+  auto programSpeedup =
+      (savedTime < 1) ? (1 / (1 - savedTime)) : (double)cores;
+  errs() << "Whole-program speedup upper bound: "
+         << format("%.3f", programSpeedup) << " ("
+         << format("%.2f", savedTime * 100) << "% of the time saved)\n";
+
+  return;
+}
+
+} // namespace llvm::noelle
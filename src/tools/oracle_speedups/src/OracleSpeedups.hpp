@@ -0,0 +1,110 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/LoopDependenceInfo.hpp"
+#include "noelle/core/SCCDAG.hpp"
+#include "noelle/core/Noelle.hpp"
+#include "DOALL.hpp"
+#include "noelle/tools/ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Upper bounds of the speedups that DOALL, HELIX, and DSWP can obtain on the
+ * hot loops of a profiled program.
+ * These ignore the overheads of the parallelization (see Planner); they tell
+ * where parallelizing is worth the effort before running the parallelizer.
+ */
+class OracleSpeedups : public ModulePass {
+public:
+  OracleSpeedups();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /*
+   * Class fields
+   */
+  static char ID;
+
+private:
+  class LoopSpeedups {
+  public:
+    LoopStructure *loop;
+    double coverage;
+    double doall;
+    double helix;
+    double dswp;
+    double sequentialFraction;
+    double criticalPathFraction;
+
+    double getBest(void) const;
+
+    /*
+     * Speedup of the whole program when only this loop is parallelized with
+     * the best technique (Amdahl's law).
+     */
+    double getProgramSpeedup(void) const;
+
+    /*
+     * Fraction of the execution time of the whole program saved by
+     * parallelizing this loop with the best technique.
+     */
+    double getSavedTime(void) const;
+  };
+
+  /*
+   * Fields
+   */
+  std::unordered_map<LoopStructure *, LoopSpeedups> speedups;
+
+  /*
+   * Methods
+   */
+  LoopSpeedups computeSpeedups(Noelle &noelle,
+                               Hot *profiles,
+                               LoopStructure *ls,
+                               uint32_t cores) const;
+
+  /*
+   * Return the dynamic instructions of the heaviest path of the SCCDAG of
+   * @ldi, which bounds the latency of an iteration.
+   */
+  uint64_t computeCriticalPath(Hot *profiles, LoopDependenceInfo *ldi) const;
+
+  /*
+   * Return the fraction of the execution time of the program saved by the
+   * best choice of loops in the tree rooted at @node: parallelizing a loop
+   * disables the parallelization of its descendants.
+   */
+  double computeBestSavedTime(StayConnectedNestedLoopForestNode *node) const;
+
+  void printReport(StayConnectedNestedLoopForest *forest,
+                   uint32_t cores) const;
+};
+
+} // namespace llvm::noelle
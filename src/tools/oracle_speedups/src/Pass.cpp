@@ -0,0 +1,118 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "OracleSpeedups.hpp"
+
+namespace llvm::noelle {
+
+OracleSpeedups::OracleSpeedups() : ModulePass{ ID } {
+
+  return;
+}
+
+bool OracleSpeedups::doInitialization(Module &M) {
+  return false;
+}
+
+bool OracleSpeedups::runOnModule(Module &M) {
+
+  /*
+   * Fetch NOELLE.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+
+  /*
+   * Fetch the profiles.
+   */
+  auto profiles = noelle.getProfiles();
+  if (!profiles->isAvailable()) {
+    errs() << "OracleSpeedups: the module has no profiles (see "
+              "noelle-meta-prof-embed)\n";
+    return false;
+  }
+
+  /*
+   * Fetch the hot loops.
+   */
+  auto programLoops = noelle.getLoopStructures();
+  if (programLoops->size() == 0) {
+    errs() << "OracleSpeedups: there is no hot loop\n";
+    delete programLoops;
+    return false;
+  }
+  auto forest = noelle.organizeLoopsInTheirNestingForest(*programLoops);
+  delete programLoops;
+
+  /*
+   * Compute the speedups of every loop.
+   */
+  auto cores = noelle.getCompilationOptionsManager()->getMaximumNumberOfCores();
+  for (auto tree : forest->getTrees()) {
+    auto computeSpeedups = [this, &noelle, profiles, cores](
+                               StayConnectedNestedLoopForestNode *n,
+                               uint32_t treeLevel) -> bool {
+      auto ls = n->getLoop();
+      this->speedups.emplace(
+          ls,
+          this->computeSpeedups(noelle, profiles, ls, cores));
+      return false;
+    };
+    tree->visitPreOrder(computeSpeedups);
+  }
+
+  /*
+   * Print the report.
+   */
+  this->printReport(forest, cores);
+
+  return false;
+}
+
+void OracleSpeedups::getAnalysisUsage(AnalysisUsage &AU) const {
+
+  /*
+   * Analyses.
+   */
+  AU.addRequired<LoopInfoWrapperPass>();
+  AU.addRequired<ScalarEvolutionWrapperPass>();
+  AU.addRequired<DominatorTreeWrapperPass>();
+  AU.addRequired<PostDominatorTreeWrapperPass>();
+
+  /*
+   * Noelle.
+   */
+  AU.addRequired<Noelle>();
+
+  /*
+   * The report does not modify the code.
+   */
+  AU.setPreservesAll();
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+// Next there is code to register your pass to "opt"
+char llvm::noelle::OracleSpeedups::ID = 0;
+static RegisterPass<OracleSpeedups> X(
+    "OracleSpeedups",
+    "Upper bounds of the speedups of the hot loops");
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "Planner.hpp"
+
+namespace llvm::noelle {
+
+bool Planner::loadDOALLChunkProfiles(const std::string &fileName) {
+
+  /*
+   * Read the telemetry.
+   */
+  auto buffer = MemoryBuffer::getFile(fileName);
+  if (!buffer) {
+    return false;
+  }
+  auto telemetry = json::parse((*buffer)->getBuffer());
+  if (!telemetry) {
+    consumeError(telemetry.takeError());
+    return false;
+  }
+  auto telemetryObject = telemetry->getAsObject();
+  if (telemetryObject == nullptr) {
+    return false;
+  }
+  auto loops = telemetryObject->getArray("loops");
+  if (loops == nullptr) {
+    return false;
+  }
+
+  /*
+   * Fetch the chunks of the DOALL loops.
+   * Only the loops compiled with -doall-chunk-telemetry have them.
+   */
+  for (auto &loop : *loops) {
+    auto loopObject = loop.getAsObject();
+    if (loopObject == nullptr) {
+      continue;
+    }
+    auto id = loopObject->getInteger("loopID");
+    auto chunkSize = loopObject->getInteger("chunkSize");
+    auto chunks = loopObject->getInteger("chunks");
+    auto invocations = loopObject->getInteger("invocations");
+    auto mean = loopObject->getNumber("chunkCyclesMean");
+    auto variance = loopObject->getNumber("chunkCyclesVariance");
+    if (false || (!id) || (!chunkSize) || (!chunks) || (!invocations)
+        || (!mean) || (!variance)) {
+      continue;
+    }
+    if (false || (*chunkSize < 1) || (*chunks < 1) || (*invocations < 1)) {
+      continue;
+    }
+    auto &profile = this->chunkProfiles[*id];
+    profile.chunkSize = *chunkSize;
+    profile.chunksPerInvocation = (double)*chunks / (double)*invocations;
+    profile.cyclesMean = *mean;
+    profile.cyclesVariance = *variance;
+  }
+
+  return true;
+}
+
+void Planner::embedDOALLChunkProfile(Noelle &noelle, LoopStructure *ls) {
+
+  /*
+   * Fetch the profile of the loop.
+   */
+  auto mm = noelle.getMetadataManager();
+  if (!mm->doesHaveMetadata(ls, "noelle.loop_ID")) {
+    return;
+  }
+  auto loopID = std::stoll(mm->getMetadata(ls, "noelle.loop_ID"));
+  auto profileIt = this->chunkProfiles.find(loopID);
+  if (profileIt == this->chunkProfiles.end()) {
+    return;
+  }
+  auto &profile = profileIt->second;
+
+  /*
+   * Attach the profile to the loop.
+   * DOALL chooses its chunk size and its scheduling from it.
+   */
+  mm->setIntegerMetadata(ls,
+                         "noelle.doall.profile.chunk_size",
+                         profile.chunkSize);
+  mm->setDoubleMetadata(ls,
+                        "noelle.doall.profile.chunks_per_invocation",
+                        profile.chunksPerInvocation);
+  mm->setDoubleMetadata(ls,
+                        "noelle.doall.profile.chunk_cycles_mean",
+                        profile.cyclesMean);
+  mm->setDoubleMetadata(ls,
+                        "noelle.doall.profile.chunk_cycles_variance",
+                        profile.cyclesVariance);
+
+  return;
+}
+
+} // namespace llvm::noelle
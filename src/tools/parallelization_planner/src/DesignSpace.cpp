@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Planner.hpp"
+
+namespace llvm::noelle {
+
+void Planner::writeDesignSpace(Noelle &noelle,
+                               StayConnectedNestedLoopForest *forest) const {
+  errs() << "Planner:  Write the design space to " << this->designSpaceFileName
+         << "\n";
+
+  /*
+   * Open the file.
+   */
+  std::error_code EC;
+  raw_fd_ostream file(this->designSpaceFileName, EC, sys::fs::F_None);
+  if (EC) {
+    errs() << "Planner: Warning = file " << this->designSpaceFileName
+           << " cannot be written: " << EC.message() << "\n";
+    return;
+  }
+
+  /*
+   * Describe the loops from the outermost to the inner ones.
+   * Loops without an index cannot be configured by INDEX_FILE, so their
+   * descendants are attached to the closest ancestor that has one.
+   */
+  for (auto tree : forest->getTrees()) {
+    auto describeLoop = [this, &noelle, &file](
+                            StayConnectedNestedLoopForestNode *n,
+                            uint32_t treeLevel) -> bool {
+      auto ls = n->getLoop();
+      uint32_t loopIndex;
+      if (!noelle.getLoopIndex(ls, loopIndex)) {
+        return false;
+      }
+
+      /*
+       * Fetch the parent.
+       */
+      int64_t parentIndex = -1;
+      for (auto parent = n->getParent(); parent != nullptr;
+           parent = parent->getParent()) {
+        uint32_t index;
+        if (noelle.getLoopIndex(parent->getLoop(), index)) {
+          parentIndex = index;
+          break;
+        }
+      }
+
+      /*
+       * Fetch the savings.
+       * Loops whose dependences have not been analyzed have no savings.
+       */
+      auto savings = 0.0;
+      auto savedTimeIter = this->savedTime.find(ls);
+      if (savedTimeIter != this->savedTime.end()) {
+        savings = savedTimeIter->second * 100;
+      }
+      file << loopIndex << " " << parentIndex << " " << savings << "\n";
+
+      return false;
+    };
+    tree->visitPreOrder(describeLoop);
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
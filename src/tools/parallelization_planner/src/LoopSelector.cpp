@@ -23,6 +23,207 @@
 
 namespace llvm::noelle {
 
+double Planner::getCoverage(Hot *profiles, LoopStructure *ls) const {
+  if (true && this->useCycles && profiles->areCyclesAvailable(ls)) {
+    return profiles->getDynamicCycleCoverage(ls);
+  }
+
+  /*
+   * Aggregate the coverages of the inputs the program has been profiled with,
+   * if any (see noelle-planner-inputs).
+   */
+  if (this->inputsAggregation == "minimum") {
+    return profiles->getMinimumDynamicTotalInstructionCoverage(ls);
+  }
+  if (this->inputsAggregation == "maximum") {
+    return profiles->getMaximumDynamicTotalInstructionCoverage(ls);
+  }
+
+  return profiles->getExpectedDynamicTotalInstructionCoverage(ls);
+}
+
+double Planner::getFractionWithinOtherCandidates(Hot *profiles,
+                                                  LoopStructure *ls) const {
+  if (!profiles->areCyclesAvailable(ls)) {
+    return 0;
+  }
+  auto loopCycles = profiles->getCycles(ls);
+  if (loopCycles == 0) {
+    return 0;
+  }
+
+  /*
+   * Add up the cycles of the calling contexts with a call within another
+   * candidate loop.
+   */
+  uint64_t cyclesWithinOthers = 0;
+  for (auto &context : profiles->getCallingContexts(ls)) {
+    auto isWithinOthers = false;
+    for (auto call : context) {
+      for (auto candidate : this->candidateLoops) {
+        if (true && (candidate != ls) && candidate->isIncluded(call)) {
+          isWithinOthers = true;
+          break;
+        }
+      }
+      if (isWithinOthers) {
+        break;
+      }
+    }
+    if (isWithinOthers) {
+      cyclesWithinOthers += profiles->getCycles(ls, context);
+    }
+  }
+
+  return std::min(1.0, ((double)cyclesWithinOthers) / ((double)loopCycles));
+}
+
+std::string Planner::getProfilesKey(Hot *profiles, LoopStructure *ls) const {
+  std::stringstream key;
+  key << profiles->getTotalInstructions(ls) << " "
+      << profiles->getIterations(ls) << " " << profiles->getInvocations(ls);
+  if (profiles->areCyclesAvailable(ls)) {
+    key << " " << profiles->getCycles(ls);
+  }
+  key << " " << this->getCoverage(profiles, ls) << " "
+      << this->getFractionWithinOtherCandidates(profiles, ls);
+
+  /*
+   * The instructions executed by the SCCs of the loop follow from the ones of
+   * its basic blocks and of its calls.
+   */
+  for (auto bb : ls->getBasicBlocks()) {
+    key << " " << profiles->getInvocations(bb);
+    for (auto &inst : *bb) {
+      if (isa<CallBase>(&inst)) {
+        key << ":" << profiles->getTotalInstructions(&inst);
+      }
+    }
+  }
+
+  return key.str();
+}
+
+double Planner::getOverheads(Hot *profiles,
+                             LoopDependenceInfo *ldi,
+                             uint64_t sequentialSegments) const {
+  auto ls = ldi->getLoopStructure();
+
+  /*
+   * Compute the cycles of the overheads of an invocation.
+   */
+  auto env = ldi->getEnvironment();
+  auto liveIns = env->getEnvIndicesOfLiveInVars();
+  auto liveOuts = env->getEnvIndicesOfLiveOutVars();
+  auto invocationCycles =
+      this->overheads.getDispatchCycles()
+      + (std::distance(liveIns.begin(), liveIns.end())
+         * this->overheads.getLiveInCycles())
+      + (std::distance(liveOuts.begin(), liveOuts.end())
+         * this->overheads.getLiveOutCycles());
+
+  /*
+   * Compute the cycles of the overheads of all invocations and iterations.
+   */
+  auto cycles = (invocationCycles * profiles->getInvocations(ls))
+                + (sequentialSegments
+                   * this->overheads.getSequentialSegmentCycles()
+                   * profiles->getIterations(ls));
+
+  /*
+   * Convert the cycles to instructions.
+   * The cycles per instruction of the loop are used if they have been
+   * profiled.
+   */
+  auto cyclesPerInstruction = this->overheads.getCyclesPerInstruction();
+  auto loopInsts = profiles->getTotalInstructions(ls);
+  if (true && this->useCycles && profiles->areCyclesAvailable(ls)
+      && (loopInsts > 0)) {
+    cyclesPerInstruction =
+        ((double)profiles->getCycles(ls)) / ((double)loopInsts);
+  }
+  if (cyclesPerInstruction <= 0) {
+    return 0;
+  }
+
+  return cycles / cyclesPerInstruction;
+}
+
+void Planner::removeLoopsThatCannotBeParallelized(
+    Noelle &noelle,
+    Hot *profiles,
+    StayConnectedNestedLoopForest *forest) {
+
+  /*
+   * Fetch the parallelization techniques that are enabled.
+   */
+  auto isDOALLEnabled = (false || noelle.isTransformationEnabled(DOALL_ID)
+                         || noelle.isTransformationEnabled(WAVEFRONT_ID));
+  auto areOtherTechniquesEnabled =
+      (false || noelle.isTransformationEnabled(HELIX_ID)
+       || noelle.isTransformationEnabled(DSWP_ID));
+
+  /*
+   * Filter out loops that no technique can parallelize, or that cannot save
+   * enough time even if they were fully parallelized.
+   * These checks only rely on the loop structures and on the profiles; hence,
+   * they do not require the dependences of the loops.
+   */
+  errs() << "Planner:  Filter out loops that cannot be parallelized\n";
+  auto filter = [this,
+                 profiles,
+                 isDOALLEnabled,
+                 areOtherTechniquesEnabled](LoopStructure *ls) -> bool {
+    auto loopID = ls->getID();
+
+    /*
+     * Check if at least one parallelization technique might be applicable.
+     */
+    std::string doallReason{ "it is disabled" };
+    std::string otherReason{ "they are disabled" };
+    auto canBeDOALL = (true && isDOALLEnabled
+                       && DOALL::canBeAppliedToLoopStructure(ls, doallReason));
+    auto canBeOthers =
+        (true && areOtherTechniquesEnabled
+         && ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences::
+             canBeAppliedToLoopStructure(ls, otherReason));
+    if (!(canBeDOALL || canBeOthers)) {
+      errs() << "Planner:    Loop " << loopID << " cannot be parallelized\n";
+      errs() << "Planner:      DOALL: " << doallReason << "\n";
+      errs() << "Planner:      HELIX and DSWP: " << otherReason << "\n";
+
+      /*
+       * Remove the loop.
+       */
+      return true;
+    }
+
+    /*
+     * Check if the loop could save enough time even if all its instructions
+     * were executed in parallel.
+     */
+    if (true && (!this->forceParallelization) && profiles->isAvailable()) {
+      auto maximumSavedTime = this->getCoverage(profiles, ls) * 100;
+      if (maximumSavedTime < this->minimumSavedTime) {
+        errs() << "Planner:    Loop " << loopID << " can save at most "
+               << maximumSavedTime << "\% of the execution time\n";
+        errs() << "Planner:      It is too low. The threshold is "
+               << this->minimumSavedTime << "\%\n";
+
+        /*
+         * Remove the loop.
+         */
+        return true;
+      }
+    }
+
+    return false;
+  };
+  noelle.filterOutLoops(forest, filter);
+
+  return;
+}
+
 void Planner::removeLoopsNotWorthParallelizing(
     Noelle &noelle,
     Hot *profiles,
@@ -32,7 +233,7 @@ void Planner::removeLoopsNotWorthParallelizing(
    * Filter out loops that are not worth parallelizing.
    */
   errs() << "Planner:  Filter out loops not worth considering\n";
-  auto filter = [this, forest, profiles](LoopStructure *ls) -> bool {
+  auto filter = [this, forest, profiles, &noelle](LoopStructure *ls) -> bool {
     /*
      * Fetch the loop ID.
      */
@@ -94,7 +295,7 @@ void Planner::removeLoopsNotWorthParallelizing(
     /*
      * Check the minimum hotness
      */
-    auto hotness = profiles->getDynamicTotalInstructionCoverage(ls) * 100;
+    auto hotness = this->getCoverage(profiles, ls) * 100;
     auto minimumHotness = 0.0;
     if (true && (!this->forceParallelization) && (hotness < minimumHotness)) {
       errs() << "Planner:    Loop " << loopID << " has only " << hotness
@@ -108,6 +309,22 @@ void Planner::removeLoopsNotWorthParallelizing(
       return true;
     }
 
+    /*
+     * Check if the memory dependences of the loop are precise enough.
+     */
+    if (true && (!this->forceParallelization)
+        && noelle.hasCoarseMemoryDependences(ls->getFunction())) {
+      errs() << "Planner:    Loop " << loopID
+             << " only has coarse memory dependences\n";
+      errs() << "Planner:      Computing them precisely exceeded the budget of "
+                "its function\n";
+
+      /*
+       * Remove the loop.
+       */
+      return true;
+    }
+
     return false;
   };
   noelle.filterOutLoops(forest, filter);
@@ -204,20 +421,58 @@ std::vector<LoopDependenceInfo *> Planner::selectTheOrderOfLoopsToParallelize(
   /*
    * Compute the amount of time that can be saved by a parallelization technique
    * per loop.
+   * The dependences of a loop are computed only if its savings have not been
+   * cached (see -noelle-planner-cache).
    */
-  std::map<LoopDependenceInfo *, uint64_t> timeSavedLoops;
-  auto selector = [&noelle, &timeSavedLoops, profiles](
-                      StayConnectedNestedLoopForestNode *n,
-                      uint32_t treeLevel) -> bool {
+  std::unordered_set<LoopDependenceInfoOptimization> optimizations = {
+    LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+    LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID
+  };
+  if (noelle.canLoopsBufferTheirOutput()) {
+    optimizations.insert(LoopDependenceInfoOptimization::BUFFERED_OUTPUT_ID);
+  }
+  std::map<LoopStructure *, double> timeSavedLoopStructures;
+  std::unordered_map<LoopStructure *, LoopDependenceInfo *> loopDependences;
+  auto selector = [this,
+                   &noelle,
+                   &timeSavedLoopStructures,
+                   &loopDependences,
+                   &optimizations,
+                   profiles,
+                   verbose](StayConnectedNestedLoopForestNode *n,
+                            uint32_t treeLevel) -> bool {
     /*
      * Fetch the loop.
      */
     auto ls = n->getLoop();
-    auto optimizations = {
-      LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
-      LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID
-    };
+
+    /*
+     * Replay the savings of the loop if they have been cached.
+     */
+    std::string profilesKey;
+    if (this->cache != nullptr) {
+      profilesKey = this->getProfilesKey(profiles, ls);
+      if (optimizations.count(
+              LoopDependenceInfoOptimization::BUFFERED_OUTPUT_ID)) {
+        profilesKey += " buffered-output";
+      }
+      double cachedSavedTime = 0;
+      if (this->cache->fetchSavedTime(ls, profilesKey, cachedSavedTime)) {
+        if (verbose != Verbosity::Disabled) {
+          errs() << "Planner: LoopSelector:  Loop " << ls->getID()
+                 << " reuses its cached savings\n";
+        }
+        timeSavedLoopStructures[ls] = cachedSavedTime;
+        this->savedTime[ls] = cachedSavedTime;
+        return false;
+      }
+    }
+
+    /*
+     * Compute the dependences of the loop.
+     */
     auto ldi = noelle.getLoop(ls, optimizations);
+    loopDependences[ls] = ldi;
 
     /*
      * Fetch the set of sequential SCCs.
@@ -247,9 +502,15 @@ std::vector<LoopDependenceInfo *> Planner::selectTheOrderOfLoopsToParallelize(
     /*
      * Compute the maximum amount of time saved by any parallelization
      * technique.
+     * This is the fraction of the execution time of the program: the
+     * fraction of the instructions of the loop that could run in parallel,
+     * minus the overheads of running them in parallel, scaled by the
+     * coverage of the loop. Loops that would slow down have negative
+     * savings.
      */
-    timeSavedLoops[ldi] = 0;
-    if (profiles->getIterations(ls) > 0) {
+    double loopSavedTime = 0;
+    auto loopInsts = profiles->getTotalInstructions(ls);
+    if (true && (profiles->getIterations(ls) > 0) && (loopInsts > 0)) {
       auto instsPerIteration =
           profiles->getAverageTotalInstructionsPerIteration(ls);
       auto instsInBiggestSCCPerIteration =
@@ -258,7 +519,56 @@ std::vector<LoopDependenceInfo *> Planner::selectTheOrderOfLoopsToParallelize(
       auto timeSavedPerIteration =
           (double)(instsPerIteration - instsInBiggestSCCPerIteration);
       auto timeSaved = timeSavedPerIteration * profiles->getIterations(ls);
-      timeSavedLoops[ldi] = (uint64_t)timeSaved;
+      timeSaved -= this->getOverheads(profiles, ldi, sequentialSCCs.size());
+      auto loopFractionSaved = timeSaved / ((double)loopInsts);
+      loopSavedTime = loopFractionSaved * this->getCoverage(profiles, ls);
+
+      /*
+       * Only count the time of the calling contexts of the loop that other
+       * loops do not run in parallel already.
+       */
+      auto fractionWithinOthers =
+          this->getFractionWithinOtherCandidates(profiles, ls);
+      if (fractionWithinOthers > 0) {
+        loopSavedTime *= (1 - fractionWithinOthers);
+        if (verbose != Verbosity::Disabled) {
+          errs() << "Planner: LoopSelector:  Loop " << ldi->getID()
+                 << " spends " << (fractionWithinOthers * 100)
+                 << "\% of its cycles within calls from other loops that "
+                    "can be parallelized\n";
+        }
+      }
+
+      /*
+       * Print the savings across the inputs the program has been profiled
+       * with.
+       */
+      if (true && (verbose != Verbosity::Disabled)
+          && (profiles->getInputs().size() > 0)
+          && (!this->useCycles || !profiles->areCyclesAvailable(ls))) {
+        auto expected =
+            loopFractionSaved
+            * profiles->getExpectedDynamicTotalInstructionCoverage(ls) * 100;
+        auto minimum =
+            loopFractionSaved
+            * profiles->getMinimumDynamicTotalInstructionCoverage(ls) * 100;
+        auto maximum =
+            loopFractionSaved
+            * profiles->getMaximumDynamicTotalInstructionCoverage(ls) * 100;
+        if (loopFractionSaved < 0) {
+          std::swap(minimum, maximum);
+        }
+        errs() << "Planner: LoopSelector:  Loop " << ldi->getID()
+               << " saves " << expected << "\% of the execution time on "
+               << "average across " << profiles->getInputs().size()
+               << " inputs (between " << minimum << "\% and " << maximum
+               << "\%)\n";
+      }
+    }
+    timeSavedLoopStructures[ls] = loopSavedTime;
+    this->savedTime[ls] = loopSavedTime;
+    if (this->cache != nullptr) {
+      this->cache->storeSavedTime(ls, profilesKey, loopSavedTime);
     }
 
     return false;
@@ -268,35 +578,41 @@ std::vector<LoopDependenceInfo *> Planner::selectTheOrderOfLoopsToParallelize(
   /*
    * Filter out loops that should not be parallelized.
    */
-  for (auto loopPair : timeSavedLoops) {
+  std::map<LoopDependenceInfo *, double> timeSavedLoops;
+  for (auto loopPair : timeSavedLoopStructures) {
 
     /*
      * Fetch the loop.
      */
-    auto ldi = loopPair.first;
+    auto ls = loopPair.first;
 
     /*
      * Compute the total amount of time saved by parallelizing this loop.
      */
-    auto savedTimeTotal = ((double)timeSavedLoops[ldi])
-                          / ((double)profiles->getTotalInstructions());
-    savedTimeTotal *= 100;
+    auto savedTimeTotal = loopPair.second * 100;
 
     /*
      * Check if the time saved is enough.
      */
-    if (true && (!this->forceParallelization) && (savedTimeTotal < 2)) {
+    if (true && (!this->forceParallelization)
+        && (savedTimeTotal < this->minimumSavedTime)) {
       errs()
-          << "Planner: LoopSelector:  Loop " << ldi->getID() << " saves only "
+          << "Planner: LoopSelector:  Loop " << ls->getID() << " saves only "
           << savedTimeTotal << " when parallelized. Skip it\n";
       continue;
     }
 
     /*
      * The loop is worth parallelizing it.
+     * Its dependences are computed now if its savings have been cached.
      *
      * Add it.
      */
+    auto ldiIt = loopDependences.find(ls);
+    auto ldi = (ldiIt != loopDependences.end())
+                   ? ldiIt->second
+                   : noelle.getLoop(ls, optimizations);
+    timeSavedLoops[ldi] = loopPair.second;
     selectedLoops.push_back(ldi);
   }
 
@@ -346,19 +662,17 @@ std::vector<LoopDependenceInfo *> Planner::selectTheOrderOfLoopsToParallelize(
       auto loopFunction = ls->getFunction();
 
       /*
-       * Compute the savings
+       * Compute the coverage
        */
-      auto savedTimeRelative = ((double)timeSavedLoops[l])
-                               / ((double)profiles->getTotalInstructions(ls));
-      auto savedTimeTotal = ((double)timeSavedLoops[l])
-                            / ((double)profiles->getTotalInstructions());
-      savedTimeRelative *= 100;
-      savedTimeTotal *= 100;
+      auto coverage = this->getCoverage(profiles, ls);
+      auto hotness = coverage * 100;
 
       /*
-       * Compute the coverage
+       * Compute the savings
        */
-      auto hotness = profiles->getDynamicTotalInstructionCoverage(ls) * 100;
+      auto savedTimeTotal = timeSavedLoops[l] * 100;
+      auto savedTimeRelative =
+          (coverage > 0) ? (timeSavedLoops[l] / coverage) * 100 : 0;
 
       /*
        * Print
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Planner.hpp"
+
+namespace llvm::noelle {
+
+LoopStructure *Planner::planNestedParallelism(Noelle &noelle,
+                                              Hot *profiles,
+                                              LoopDependenceInfo *ldi) {
+
+  /*
+   * Check if DOALL can run the parent, and HELIX or DSWP can run @ldi.
+   */
+  if (false || (!noelle.isTransformationEnabled(DOALL_ID))
+      || (!(noelle.isTransformationEnabled(HELIX_ID)
+            || noelle.isTransformationEnabled(DSWP_ID)))) {
+    return nullptr;
+  }
+  if (!profiles->isAvailable()) {
+    return nullptr;
+  }
+
+  /*
+   * Check if @ldi needs HELIX or DSWP.
+   * Loops that DOALL can parallelize already use all the cores on their own.
+   */
+  auto ls = ldi->getLoopStructure();
+  if (false || (ls->getNestingLevel() <= 1)
+      || (DOALL::getSCCsThatBlockDOALLToBeApplicable(ldi, noelle).size()
+          == 0)) {
+    return nullptr;
+  }
+
+  /*
+   * Fetch the parent of @ldi.
+   */
+  auto loopFunction = ls->getFunction();
+  auto functionLoops = noelle.getLoopStructures(loopFunction, 0);
+  LoopStructure *parentLS = nullptr;
+  for (auto loop : *functionLoops) {
+    if (true && (parentLS == nullptr)
+        && (loop->getNestingLevel() == (ls->getNestingLevel() - 1))
+        && loop->isIncluded(ls->getHeader())) {
+      parentLS = loop;
+      continue;
+    }
+    delete loop;
+  }
+  delete functionLoops;
+  if (parentLS == nullptr) {
+    return nullptr;
+  }
+
+  /*
+   * Check if the parent has already been planned to run one of its loops.
+   */
+  auto mm = noelle.getMetadataManager();
+  if (mm->doesHaveMetadata(parentLS, "noelle.parallelizer.nested")) {
+    delete parentLS;
+    return nullptr;
+  }
+
+  /*
+   * Compute the number of groups of cores.
+   * The parent must have too few iterations per invocation to use all the
+   * cores with DOALL, while each group must have at least two cores for @ldi.
+   */
+  auto maxCores =
+      noelle.getCompilationOptionsManager()->getMaximumNumberOfCores();
+  auto averageIterations =
+      profiles->getAverageLoopIterationsPerInvocation(parentLS);
+  if (averageIterations >= maxCores) {
+    delete parentLS;
+    return nullptr;
+  }
+  auto groups = std::min((uint32_t)averageIterations, maxCores / 2);
+  if (groups < 2) {
+    delete parentLS;
+    return nullptr;
+  }
+
+  /*
+   * Check if DOALL can parallelize the parent.
+   */
+  std::string reason;
+  if (!DOALL::canBeAppliedToLoopStructure(parentLS, reason)) {
+    delete parentLS;
+    return nullptr;
+  }
+  auto optimizations = { LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+                         LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID };
+  auto parentLDI = noelle.getLoop(parentLS, optimizations);
+  auto isParentDOALL =
+      (DOALL::getSCCsThatBlockDOALLToBeApplicable(parentLDI, noelle).size()
+       == 0);
+  delete parentLDI;
+  if (!isParentDOALL) {
+    delete parentLS;
+    return nullptr;
+  }
+
+  /*
+   * Tag the loops.
+   */
+  errs() << "Planner: NestedParallelism: Loop " << parentLS->getID()
+         << " runs loop " << ls->getID() << " on " << groups
+         << " groups of " << (maxCores / groups) << " cores\n";
+  mm->setIntegerMetadata(parentLS, "noelle.parallelizer.nested", groups);
+  mm->setIntegerMetadata(ls, "noelle.parallelizer.nested.inner", 1);
+
+  return parentLS;
+}
+
+} // namespace llvm::noelle
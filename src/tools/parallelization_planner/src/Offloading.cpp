@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Planner.hpp"
+
+namespace llvm::noelle {
+
+bool Planner::isWorthOffloading(Noelle &noelle,
+                                Hot *profiles,
+                                LoopDependenceInfo *ldi,
+                                uint64_t &bytesPerInvocation) const {
+  auto ls = ldi->getLoopStructure();
+  if (!profiles->isAvailable()) {
+    return false;
+  }
+
+  /*
+   * Check if the iterations of the loop are independent.
+   */
+  std::string reason;
+  if (false || (!DOALL::canBeAppliedToLoopStructure(ls, reason))
+      || (DOALL::getSCCsThatBlockDOALLToBeApplicable(ldi, noelle).size()
+          > 0)) {
+    return false;
+  }
+
+  /*
+   * Check if the loop can run on an accelerator, and compute the bytes it
+   * accesses per iteration.
+   */
+  auto lids = ldi->getLoopIterationDomainSpaceAnalysis();
+  auto &DL = ls->getFunction()->getParent()->getDataLayout();
+  uint64_t bytesPerIteration = 0;
+  for (auto inst : ls->getInstructions()) {
+    if (auto call = dyn_cast<CallBase>(inst)) {
+      if (false || isa<DbgInfoIntrinsic>(call)
+          || call->isLifetimeStartOrEnd()) {
+        continue;
+      }
+      return false;
+    }
+    Type *accessedType = nullptr;
+    if (auto load = dyn_cast<LoadInst>(inst)) {
+      accessedType = load->getType();
+    } else if (auto store = dyn_cast<StoreInst>(inst)) {
+      accessedType = store->getValueOperand()->getType();
+    } else {
+      continue;
+    }
+    if (!lids->isMemoryAccessSpaceKnown(inst)) {
+      return false;
+    }
+    bytesPerIteration += DL.getTypeStoreSize(accessedType);
+  }
+
+  /*
+   * Compare the cycles of running the loop with DOALL with the ones of
+   * running it on the accelerator, which include moving the data it accesses.
+   */
+  auto invocations = profiles->getInvocations(ls);
+  if (invocations == 0) {
+    return false;
+  }
+  auto iterations = profiles->getIterations(ls);
+  auto loopCycles = profiles->getTotalInstructions(ls)
+                    * this->overheads.getCyclesPerInstruction();
+  auto maxCores =
+      noelle.getCompilationOptionsManager()->getMaximumNumberOfCores();
+  auto cpuCycles = (loopCycles / maxCores)
+                   + (this->overheads.getDispatchCycles() * invocations);
+  auto offloadCycles =
+      (loopCycles / this->overheads.getOffloadSpeedup())
+      + (this->overheads.getOffloadLaunchCycles() * invocations)
+      + (bytesPerIteration * iterations
+         * this->overheads.getOffloadCyclesPerByte());
+  bytesPerInvocation = (bytesPerIteration * iterations) / invocations;
+  errs() << "Planner: Offloading: Loop " << ldi->getID() << " takes "
+         << cpuCycles << " cycles with DOALL and " << offloadCycles
+         << " cycles on an accelerator\n";
+
+  return (offloadCycles < cpuCycles);
+}
+
+} // namespace llvm::noelle
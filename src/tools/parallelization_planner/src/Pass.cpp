@@ -31,8 +31,72 @@ static cl::opt<bool> ForceParallelizationPlanner(
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Force the parallelization"));
+static cl::opt<bool> UseCyclesPlanner(
+    "noelle-planner-cycles",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Estimate the time of loops using the cycles they have been "
+             "profiled with (see noelle-prof-coverage -loop-profiles)"));
+static cl::opt<bool> NestedParallelismPlanner(
+    "noelle-planner-nested",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Run the outer loops that have too few iterations to use all "
+             "the cores with DOALL on groups of cores, each group running "
+             "their inner loop with HELIX or DSWP"));
+static cl::opt<bool> OffloadingPlanner(
+    "noelle-planner-offload",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Tag the DOALL loops that would run faster on an accelerator "
+             "with \"noelle.offload\" (see noelle-planner-overheads)"));
+static cl::opt<std::string> OverheadsPlanner(
+    "noelle-planner-overheads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Model file with the parallelization overheads of the machine "
+             "(see noelle-overheads)"));
+static cl::opt<std::string> DesignSpacePlanner(
+    "noelle-planner-design-space",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File to write the loops worth tuning to, with their estimated "
+             "savings and their parents in the loop nesting forest (see "
+             "noelle-parallel-autotuner)"));
+static cl::opt<std::string> InputsPlanner(
+    "noelle-planner-inputs",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init("expected"),
+    cl::desc("When the program has been profiled with several inputs (see "
+             "noelle-meta-prof-embed -inputs), estimate the time saved by a "
+             "loop with its \"expected\" coverage among them (default), "
+             "its \"minimum\" one, or its \"maximum\" one"));
+static cl::opt<std::string> DOALLTelemetryPlanner(
+    "noelle-planner-doall-telemetry",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Telemetry of a run of the program compiled with "
+             "-doall-chunk-telemetry: DOALL chooses the chunk size and the "
+             "scheduling of the loops from the cycles of their chunks"));
+static cl::opt<std::string> CachePlanner(
+    "noelle-planner-cache",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File that caches the savings of the loops across builds: the "
+             "dependences of a loop whose code and profiles did not change "
+             "are computed only if the loop is selected"));
 
-Planner::Planner() : ModulePass{ ID }, forceParallelization{ false } {
+Planner::Planner()
+  : ModulePass{ ID },
+    forceParallelization{ false },
+    useCycles{ false },
+    nestedParallelism{ false },
+    offloading{ false },
+    minimumSavedTime{ 2 },
+    designSpaceFileName{},
+    inputsAggregation{ "expected" },
+    cache{ nullptr } {
 
   return;
 }
@@ -40,6 +104,42 @@ Planner::Planner() : ModulePass{ ID }, forceParallelization{ false } {
 bool Planner::doInitialization(Module &M) {
   this->forceParallelization =
       (ForceParallelizationPlanner.getNumOccurrences() > 0);
+  this->useCycles = (UseCyclesPlanner.getNumOccurrences() > 0);
+  this->nestedParallelism = (NestedParallelismPlanner.getNumOccurrences() > 0);
+  this->offloading = (OffloadingPlanner.getNumOccurrences() > 0);
+  this->designSpaceFileName = DesignSpacePlanner.getValue();
+  this->inputsAggregation = InputsPlanner.getValue();
+  if (true && (this->inputsAggregation != "expected")
+      && (this->inputsAggregation != "minimum")
+      && (this->inputsAggregation != "maximum")) {
+    errs() << "Planner: ERROR = the aggregation of the inputs \""
+           << this->inputsAggregation << "\" does not exist\n";
+    abort();
+  }
+
+  /*
+   * Load the model of the parallelization overheads.
+   * The default model file is used if it exists; otherwise, the overheads
+   * keep their default estimates.
+   */
+  if (OverheadsPlanner.getNumOccurrences() > 0) {
+    if (!this->overheads.load(OverheadsPlanner.getValue())) {
+      errs() << "Planner: Warning = file " << OverheadsPlanner.getValue()
+             << " cannot be read\n";
+    }
+  } else {
+    this->overheads.load(ParallelizationOverheads::defaultFileName);
+  }
+
+  /*
+   * Load the cycles of the DOALL chunks.
+   */
+  if (DOALLTelemetryPlanner.getNumOccurrences() > 0) {
+    if (!this->loadDOALLChunkProfiles(DOALLTelemetryPlanner.getValue())) {
+      errs() << "Planner: Warning = file " << DOALLTelemetryPlanner.getValue()
+             << " cannot be read\n";
+    }
+  }
 
   return false;
 }
@@ -87,12 +187,43 @@ bool Planner::runOnModule(Module &M) {
   auto forest = noelle.organizeLoopsInTheirNestingForest(*programLoops);
   delete programLoops;
 
+  /*
+   * Load the savings of the loops estimated by previous builds.
+   * The configuration of the planner is part of the keys of the loops.
+   */
+  if (CachePlanner.getNumOccurrences() > 0) {
+    std::stringstream configuration;
+    configuration << this->useCycles << " " << this->forceParallelization
+                  << " " << this->inputsAggregation << " "
+                  << this->overheads.getDispatchCycles() << " "
+                  << this->overheads.getLiveInCycles() << " "
+                  << this->overheads.getLiveOutCycles() << " "
+                  << this->overheads.getSequentialSegmentCycles() << " "
+                  << this->overheads.getCyclesPerInstruction();
+    this->cache =
+        new PlannerCache(CachePlanner.getValue(), configuration.str());
+  }
+
+  /*
+   * Filter out loops that cannot be parallelized.
+   * This is done before computing the dependences of the loops.
+   */
+  this->removeLoopsThatCannotBeParallelized(noelle, profiles, forest);
+
   /*
    * Filter out loops that are not worth parallelizing.
    */
   if (!this->forceParallelization) {
     this->removeLoopsNotWorthParallelizing(noelle, profiles, forest);
   }
+  for (auto tree : forest->getTrees()) {
+    auto collectLoop = [this](StayConnectedNestedLoopForestNode *n,
+                              uint32_t treeLevel) -> bool {
+      this->candidateLoops.push_back(n->getLoop());
+      return false;
+    };
+    tree->visitPreOrder(collectLoop);
+  }
 
   /*
    * Plan parallelization of the loops selected.
@@ -114,15 +245,48 @@ bool Planner::runOnModule(Module &M) {
     /*
      * Attach metadata representing the loop's order in the parallelization plan
      * to each loop we are considering.
+     *
+     * A loop nested in a parent that runs it on groups of cores is
+     * parallelized within the tasks of its parent. Hence, the parent takes its
+     * place in the plan.
      */
+    std::unordered_set<BasicBlock *> headersInThePlan;
     for (auto ldi : loopsToParallelize) {
       auto ls = ldi->getLoopStructure();
-      auto ldiParallelizationOrderIndex =
-          std::to_string(parallelizationOrderIndex++);
-      mm->addMetadata(ls,
-                      "noelle.parallelizer.looporder",
-                      ldiParallelizationOrderIndex);
+      LoopStructure *parentLS = nullptr;
+      if (this->nestedParallelism) {
+        parentLS = this->planNestedParallelism(noelle, profiles, ldi);
+        if (parentLS != nullptr) {
+          ls = parentLS;
+        }
+      }
+      if (headersInThePlan.count(ls->getHeader()) == 0) {
+        headersInThePlan.insert(ls->getHeader());
+        mm->setIntegerMetadata(ls,
+                               "noelle.parallelizer.looporder",
+                               parallelizationOrderIndex++);
+      }
+      delete parentLS;
       modified = true;
+
+      /*
+       * Tag the loop if it is worth running on an accelerator.
+       */
+      uint64_t bytesPerInvocation = 0;
+      if (true && this->offloading
+          && this->isWorthOffloading(noelle,
+                                     profiles,
+                                     ldi,
+                                     bytesPerInvocation)) {
+        mm->setIntegerMetadata(ldi->getLoopStructure(),
+                               "noelle.offload",
+                               bytesPerInvocation);
+      }
+
+      /*
+       * Tag the loop with the cycles of its DOALL chunks.
+       */
+      this->embedDOALLChunkProfile(noelle, ldi->getLoopStructure());
     }
 
     /*
@@ -133,6 +297,22 @@ bool Planner::runOnModule(Module &M) {
     }
   }
 
+  /*
+   * Describe the loops to the autotuner.
+   */
+  if (this->designSpaceFileName != "") {
+    this->writeDesignSpace(noelle, forest);
+  }
+
+  /*
+   * Store the savings of the loops for the next builds.
+   */
+  if (this->cache != nullptr) {
+    this->cache->save();
+    delete this->cache;
+    this->cache = nullptr;
+  }
+
   errs() << "Planner: Exit\n";
   return modified;
 }
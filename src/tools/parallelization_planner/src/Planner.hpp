@@ -47,7 +47,10 @@
 #include "noelle/core/SCCDAG.hpp"
 #include "noelle/core/Noelle.hpp"
 #include "noelle/core/MetadataManager.hpp"
+#include "noelle/core/ParallelizationOverheads.hpp"
 #include "DOALL.hpp"
+#include "PlannerCache.hpp"
+#include "noelle/tools/ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences.hpp"
 
 namespace llvm::noelle {
 
@@ -71,6 +74,49 @@ private:
    * Fields
    */
   bool forceParallelization;
+  bool useCycles;
+  bool nestedParallelism;
+  bool offloading;
+  double minimumSavedTime;
+  ParallelizationOverheads overheads;
+  std::string designSpaceFileName;
+
+  /*
+   * How to aggregate the coverages of the inputs the program has been
+   * profiled with: "expected" (their mean weighted by the inputs), "minimum",
+   * or "maximum".
+   */
+  std::string inputsAggregation;
+
+  /*
+   * Cycles of the chunks of the DOALL loops measured by a run of the program
+   * (see -noelle-planner-doall-telemetry), indexed by the ID of the loops.
+   */
+  struct DOALLChunkProfile {
+    int64_t chunkSize;
+    double chunksPerInvocation;
+    double cyclesMean;
+    double cyclesVariance;
+  };
+  std::unordered_map<int64_t, DOALLChunkProfile> chunkProfiles;
+
+  /*
+   * Fraction of the execution time of the program saved by parallelizing each
+   * loop considered.
+   */
+  std::unordered_map<LoopStructure *, double> savedTime;
+
+  /*
+   * Loops left to consider after filtering out the ones that cannot be
+   * parallelized or that are not worth parallelizing.
+   */
+  std::vector<LoopStructure *> candidateLoops;
+
+  /*
+   * Savings of the loops estimated by previous builds (see
+   * -noelle-planner-cache), or nullptr if they are not cached.
+   */
+  PlannerCache *cache;
 
   /*
    * Methods
@@ -79,14 +125,100 @@ private:
   std::vector<LoopDependenceInfo *> getLoopsToParallelize(Module &M,
                                                           Noelle &par);
 
+  void removeLoopsThatCannotBeParallelized(Noelle &noelle,
+                                           Hot *profiles,
+                                           StayConnectedNestedLoopForest *f);
+
   void removeLoopsNotWorthParallelizing(Noelle &noelle,
                                         Hot *profiles,
                                         StayConnectedNestedLoopForest *f);
 
+  /*
+   * Return the fraction of the execution time of the program spent in @ls.
+   * This is based on the cycles of @ls if they are used and profiled, and on
+   * the instructions it executed otherwise.
+   */
+  double getCoverage(Hot *profiles, LoopStructure *ls) const;
+
+  /*
+   * Return the fraction of the cycles of @ls spent when its function has been
+   * invoked through a call within another candidate loop (see
+   * noelle-loop-profiles-instr).
+   * Parallelizing that loop already runs these invocations of @ls in
+   * parallel, so @ls can only save time in the rest of its calling contexts.
+   */
+  double getFractionWithinOtherCandidates(Hot *profiles,
+                                          LoopStructure *ls) const;
+
+  /*
+   * Return a summary of the profiles of @ls that its savings depend on: its
+   * coverage, iterations, and invocations, and the instructions executed by
+   * its basic blocks and by the calls within it.
+   */
+  std::string getProfilesKey(Hot *profiles, LoopStructure *ls) const;
+
+  /*
+   * Return the instructions that the overheads of running @ldi in parallel
+   * cost over all its invocations: dispatching its tasks, moving its live-ins
+   * and live-outs through the environment, and synchronizing its
+   * @sequentialSegments sequential segments at every iteration.
+   */
+  double getOverheads(Hot *profiles,
+                      LoopDependenceInfo *ldi,
+                      uint64_t sequentialSegments) const;
+
+  /*
+   * Check if the parent of @ldi should run its iterations with DOALL on groups
+   * of cores, each group running @ldi with HELIX or DSWP.
+   * This is the case when only the parent can be parallelized with DOALL, but
+   * it has too few iterations per invocation to use all the cores.
+   * If so, the parent is tagged with the number of groups, @ldi is tagged as
+   * the loop the groups run, and the parent is returned (the caller owns it).
+   * Otherwise, nullptr is returned.
+   */
+  LoopStructure *planNestedParallelism(Noelle &noelle,
+                                       Hot *profiles,
+                                       LoopDependenceInfo *ldi);
+
+  /*
+   * Check if @ldi would run faster on an accelerator than with DOALL on the
+   * cores, following the model of the parallelization overheads.
+   * Only DOALL loops without calls whose memory accesses have known ranges
+   * can run on an accelerator: their data can be moved before and after them.
+   * The bytes moved per invocation are stored in @bytesPerInvocation.
+   */
+  bool isWorthOffloading(Noelle &noelle,
+                         Hot *profiles,
+                         LoopDependenceInfo *ldi,
+                         uint64_t &bytesPerInvocation) const;
+
   std::vector<LoopDependenceInfo *> selectTheOrderOfLoopsToParallelize(
       Noelle &noelle,
       Hot *profiles,
       noelle::StayConnectedNestedLoopForestNode *tree);
+
+  /*
+   * Write to designSpaceFileName a line per loop of @forest: the index of the
+   * loop (its line in INDEX_FILE), the index of its parent in @forest (-1 for
+   * roots), and the percentage of the execution time saved by parallelizing
+   * it.
+   * Parallelizing a loop disables the parallelization of its descendants;
+   * moreover, loops of different trees can be tuned independently.
+   */
+  void writeDesignSpace(Noelle &noelle,
+                        StayConnectedNestedLoopForest *forest) const;
+
+  /*
+   * Read the cycles of the DOALL chunks from the telemetry @fileName of the
+   * runtime (see NOELLE_TELEMETRY).
+   * Return false if the file cannot be read.
+   */
+  bool loadDOALLChunkProfiles(const std::string &fileName);
+
+  /*
+   * Tag @ls with the cycles of its DOALL chunks, if they have been measured.
+   */
+  void embedDOALLChunkProfile(Noelle &noelle, LoopStructure *ls);
 };
 
 } // namespace llvm::noelle
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cstring>
+#include <fstream>
+
+#include "llvm/Support/MD5.h"
+#include "PlannerCache.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Version of the format of the cache file.
+ * Files with a different version are ignored.
+ */
+static const char cacheMagic[8] = { 'N', 'P', 'L', 'N', 'C', '0', '0', '1' };
+
+PlannerCache::PlannerCache(const std::string &fileName,
+                           const std::string &configuration)
+  : fileName{ fileName },
+    configuration{ configuration },
+    modified{ false } {
+  this->load();
+
+  return;
+}
+
+bool PlannerCache::fetchSavedTime(LoopStructure *ls,
+                                  const std::string &profilesKey,
+                                  double &savedTime) {
+
+  /*
+   * Check if the loop has been cached with the same key.
+   */
+  auto it = this->loops.find(this->getName(ls));
+  if (it == this->loops.end()) {
+    return false;
+  }
+  if (it->second.key != this->computeKey(ls, profilesKey)) {
+    return false;
+  }
+  savedTime = it->second.savedTime;
+
+  return true;
+}
+
+void PlannerCache::storeSavedTime(LoopStructure *ls,
+                                  const std::string &profilesKey,
+                                  double savedTime) {
+  CachedLoop cachedLoop;
+  cachedLoop.key = this->computeKey(ls, profilesKey);
+  cachedLoop.savedTime = savedTime;
+  this->loops[this->getName(ls)] = std::move(cachedLoop);
+  this->modified = true;
+
+  return;
+}
+
+void PlannerCache::save(void) {
+
+  /*
+   * Check if there is something new to save.
+   */
+  if (!this->modified) {
+    return;
+  }
+
+  /*
+   * Write the cache.
+   */
+  std::ofstream file(this->fileName, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    errs() << "Planner: WARNING = cannot write the planner cache "
+           << this->fileName << "\n";
+    return;
+  }
+  auto writeInteger = [&file](uint32_t value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+  };
+  auto writeString = [&file, &writeInteger](const std::string &s) {
+    writeInteger(s.size());
+    file.write(s.data(), s.size());
+  };
+  file.write(cacheMagic, sizeof(cacheMagic));
+  writeInteger(this->loops.size());
+  for (auto &pair : this->loops) {
+    writeString(pair.first);
+    writeString(pair.second.key);
+    file.write(reinterpret_cast<const char *>(&pair.second.savedTime),
+               sizeof(pair.second.savedTime));
+  }
+  this->modified = false;
+
+  return;
+}
+
+void PlannerCache::load(void) {
+
+  /*
+   * Open the cache.
+   * A missing cache is not an error: it will be created.
+   */
+  std::ifstream file(this->fileName, std::ios::binary);
+  if (!file.is_open()) {
+    return;
+  }
+
+  /*
+   * Check the format.
+   */
+  char magic[sizeof(cacheMagic)];
+  if (false || (!file.read(magic, sizeof(magic)))
+      || (std::memcmp(magic, cacheMagic, sizeof(cacheMagic)) != 0)) {
+    return;
+  }
+
+  /*
+   * Read the cached loops.
+   */
+  auto readInteger = [&file](uint32_t &value) -> bool {
+    return !!file.read(reinterpret_cast<char *>(&value), sizeof(value));
+  };
+  auto readString = [&file, &readInteger](std::string &s) -> bool {
+    uint32_t size;
+    if (!readInteger(size)) {
+      return false;
+    }
+    s.resize(size);
+    return !!file.read(&s[0], size);
+  };
+  uint32_t numberOfLoops;
+  if (!readInteger(numberOfLoops)) {
+    return;
+  }
+  std::unordered_map<std::string, CachedLoop> loopsRead;
+  for (uint32_t i = 0; i < numberOfLoops; i++) {
+    std::string name;
+    CachedLoop cachedLoop;
+    if (false || (!readString(name)) || (!readString(cachedLoop.key))
+        || (!file.read(reinterpret_cast<char *>(&cachedLoop.savedTime),
+                       sizeof(cachedLoop.savedTime)))) {
+      return;
+    }
+    loopsRead[name] = std::move(cachedLoop);
+  }
+
+  /*
+   * The cache is valid.
+   */
+  this->loops = std::move(loopsRead);
+
+  return;
+}
+
+std::string PlannerCache::getName(LoopStructure *ls) const {
+
+  /*
+   * Loops are named by their function and by the position of their header
+   * within it.
+   */
+  auto header = ls->getHeader();
+  auto F = ls->getFunction();
+  uint64_t headerIndex = 0;
+  for (auto &bb : *F) {
+    if (&bb == header) {
+      break;
+    }
+    headerIndex++;
+  }
+
+  return F->getName().str() + ":" + std::to_string(headerIndex);
+}
+
+std::string PlannerCache::computeKey(LoopStructure *ls,
+                                     const std::string &profilesKey) {
+  MD5 hasher;
+
+  /*
+   * Hash the configuration, the profiles, and the body of the loop.
+   */
+  hasher.update(this->configuration);
+  hasher.update(profilesKey);
+  auto F = ls->getFunction();
+  hasher.update(PlannerCache::computeHash(
+      *F,
+      [ls](Instruction *inst) -> bool { return ls->isIncluded(inst); }));
+
+  /*
+   * Hash the callees of the loop.
+   * The dependences of the loop depend on the mod/ref summaries of its
+   * callees, which depend on the callees they reach transitively through
+   * direct calls.
+   * The callees are hashed ordered by name to keep the key stable across runs.
+   */
+  std::set<std::string> reachableCallees;
+  for (auto bb : ls->getBasicBlocks()) {
+    for (auto &I : *bb) {
+      auto call = dyn_cast<CallBase>(&I);
+      if (call == nullptr) {
+        continue;
+      }
+      auto callee = call->getCalledFunction();
+      if (callee == nullptr) {
+        continue;
+      }
+      auto &calleeSummaries = this->fetchReachableCallees(*callee);
+      reachableCallees.insert(calleeSummaries.begin(), calleeSummaries.end());
+    }
+  }
+  for (auto &summary : reachableCallees) {
+    hasher.update(summary);
+    hasher.update(StringRef("\0", 1));
+  }
+
+  MD5::MD5Result result;
+  hasher.final(result);
+
+  return result.digest().str();
+}
+
+const std::set<std::string> &PlannerCache::fetchReachableCallees(
+    Function &F) {
+
+  /*
+   * Check if we have already collected the callees of the function.
+   */
+  auto it = this->reachableCallees.find(&F);
+  if (it != this->reachableCallees.end()) {
+    return it->second;
+  }
+
+  /*
+   * Summarize @F and every function it reaches through direct calls.
+   * A function without a body is represented by its attributes.
+   */
+  std::set<std::string> summaries;
+  std::unordered_set<Function *> visited{ &F };
+  std::vector<Function *> worklist{ &F };
+  while (!worklist.empty()) {
+    auto function = worklist.back();
+    worklist.pop_back();
+    auto summary = function->getName().str() + ":"
+                   + function->getAttributes().getAsString(
+                       AttributeList::FunctionIndex);
+    if (!function->empty()) {
+      summary += ":" + this->computeBodyHash(*function);
+    }
+    summaries.insert(summary);
+    for (auto &I : instructions(*function)) {
+      auto call = dyn_cast<CallBase>(&I);
+      if (call == nullptr) {
+        continue;
+      }
+      auto callee = call->getCalledFunction();
+      if (true && (callee != nullptr) && visited.insert(callee).second) {
+        worklist.push_back(callee);
+      }
+    }
+  }
+  auto &cached = this->reachableCallees[&F];
+  cached = std::move(summaries);
+
+  return cached;
+}
+
+std::string PlannerCache::computeBodyHash(Function &F) {
+
+  /*
+   * Check if we have already hashed the function.
+   */
+  auto it = this->bodyHashes.find(&F);
+  if (it != this->bodyHashes.end()) {
+    return it->second;
+  }
+
+  auto hash =
+      PlannerCache::computeHash(F, [](Instruction *inst) { return true; });
+  this->bodyHashes[&F] = hash;
+
+  return hash;
+}
+
+std::string PlannerCache::computeHash(
+    Function &F,
+    std::function<bool(Instruction *)> isIncluded) {
+
+  /*
+   * Number the values local to the function.
+   */
+  std::unordered_map<Value *, uint64_t> localIDs;
+  for (auto &arg : F.args()) {
+    uint64_t localID = localIDs.size();
+    localIDs[&arg] = localID;
+  }
+  for (auto &bb : F) {
+    uint64_t localID = localIDs.size();
+    localIDs[&bb] = localID;
+    for (auto &I : bb) {
+      localID = localIDs.size();
+      localIDs[&I] = localID;
+    }
+  }
+
+  /*
+   * Hash the signature of the function.
+   */
+  MD5 hasher;
+  auto hashString = [&hasher](const std::string &s) {
+    hasher.update(s);
+    hasher.update(StringRef("\0", 1));
+  };
+  auto printType = [](Type *type) -> std::string {
+    std::string s;
+    raw_string_ostream os(s);
+    type->print(os);
+    return os.str();
+  };
+  hashString(F.getName().str());
+  hashString(printType(F.getFunctionType()));
+
+  /*
+   * Hash the instructions.
+   */
+  for (auto &I : instructions(F)) {
+    if (!isIncluded(&I)) {
+      continue;
+    }
+    hashString(std::to_string(localIDs[&I]));
+    hashString(I.getOpcodeName());
+    hashString(printType(I.getType()));
+    if (auto cmp = dyn_cast<CmpInst>(&I)) {
+      hashString(std::to_string(cmp->getPredicate()));
+    }
+    if (auto load = dyn_cast<LoadInst>(&I)) {
+      hashString(std::to_string(load->isVolatile()) + "."
+                 + std::to_string((unsigned)load->getOrdering()));
+    }
+    if (auto store = dyn_cast<StoreInst>(&I)) {
+      hashString(std::to_string(store->isVolatile()) + "."
+                 + std::to_string((unsigned)store->getOrdering()));
+    }
+    for (auto &op : I.operands()) {
+      auto v = op.get();
+      auto localIt = localIDs.find(v);
+      if (localIt != localIDs.end()) {
+        hashString("%" + std::to_string(localIt->second));
+      } else if (auto global = dyn_cast<GlobalValue>(v)) {
+        hashString("@" + global->getName().str());
+      } else if (isa<Constant>(v)) {
+        std::string s;
+        raw_string_ostream os(s);
+        v->print(os);
+        hashString(os.str());
+      } else {
+        hashString("?");
+      }
+    }
+  }
+
+  MD5::MD5Result result;
+  hasher.final(result);
+
+  return result.digest().str();
+}
+
+} // namespace llvm::noelle
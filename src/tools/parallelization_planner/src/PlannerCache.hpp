@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/LoopStructure.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * On-disk cache of the time saved by parallelizing loops (see
+ * -noelle-planner-cache).
+ *
+ * The savings of a loop are reused only if its key did not change. The key
+ * hashes the configuration of the planner, the structure of the body of the
+ * loop together with the bodies of its direct callees, and the profiles of
+ * the loop. Hence, editing a loop (or a function it calls) or profiling it
+ * again invalidates its entry.
+ */
+class PlannerCache {
+public:
+  PlannerCache(const std::string &fileName, const std::string &configuration);
+
+  /*
+   * Fetch the savings of @ls cached with @profilesKey, which summarizes
+   * the profiles of @ls.
+   *
+   * @return false if @ls has not been cached with the same key.
+   */
+  bool fetchSavedTime(LoopStructure *ls,
+                      const std::string &profilesKey,
+                      double &savedTime);
+
+  void storeSavedTime(LoopStructure *ls,
+                      const std::string &profilesKey,
+                      double savedTime);
+
+  void save(void);
+
+private:
+  struct CachedLoop {
+    std::string key;
+    double savedTime;
+  };
+
+  std::string fileName;
+  std::string configuration;
+  bool modified;
+  std::unordered_map<std::string, CachedLoop> loops;
+  std::unordered_map<Function *, std::string> bodyHashes;
+  std::unordered_map<Function *, std::set<std::string>> reachableCallees;
+
+  void load(void);
+  std::string getName(LoopStructure *ls) const;
+  std::string computeKey(LoopStructure *ls, const std::string &profilesKey);
+  std::string computeBodyHash(Function &F);
+
+  /*
+   * Summaries of @F and of the functions it reaches through direct calls.
+   */
+  const std::set<std::string> &fetchReachableCallees(Function &F);
+
+  /*
+   * Hash the instructions of @F that satisfy @isIncluded.
+   * Local values are identified by their position in @F, which makes the hash
+   * independent of their names.
+   */
+  static std::string computeHash(Function &F,
+                                 std::function<bool(Instruction *)> isIncluded);
+};
+
+} // namespace llvm::noelle
@@ -55,10 +55,21 @@ public:
 
   Value *getEnvArray(void) const;
 
+  /*
+   * Return the cache line of the environment array that holds the variable
+   * @envIndex.
+   */
+  uint64_t getCacheLineOfEnvironmentVariable(uint32_t envIndex) const;
+
   BasicBlock *getParLoopEntryPoint(void) const;
 
   BasicBlock *getParLoopExitPoint(void) const;
 
+  /*
+   * Return the functions that implement the tasks of the parallelized loop.
+   */
+  std::vector<Function *> getTaskBodies(void) const;
+
   /*
    * Destructor.
    */
@@ -98,6 +109,14 @@ protected:
 
   void populateLiveInEnvironment(LoopDependenceInfo *LDI);
 
+  /*
+   * Report the layout of the environment of the loop LDI and the cache lines
+   * it falsely shares (see -noelle-environment-layout-report).
+   * The parallelized loop also registers its environment to the runtime,
+   * which reports where it is at run time (see NOELLE_ENVIRONMENT_REPORT).
+   */
+  void reportEnvironmentLayout(LoopDependenceInfo *LDI);
+
   virtual BasicBlock *performReductionToAllReducableLiveOutVariables(
       LoopDependenceInfo *LDI,
       Value *numberOfThreadsExecuted);
@@ -131,6 +150,19 @@ protected:
   virtual void generateCodeToStoreLiveOutVariables(LoopDependenceInfo *LDI,
                                                    int taskIndex);
 
+  /*
+   * Compute once in the caller the loop invariants that every core of the
+   * task would otherwise compute, and pass them to the task through new
+   * variables of the environment.
+   * This must follow adjusting the data flow of the task to use the clones,
+   * and it must precede populating the environment.
+   * Invariant loads are computed by the caller only if @hoistLoads is true.
+   * The number of invariants passed to the task is returned.
+   */
+  uint32_t hoistInvariantsOfTheTaskIntoTheEnvironment(LoopDependenceInfo *LDI,
+                                                      int taskIndex,
+                                                      bool hoistLoads);
+
   Instruction *
   fetchOrCreatePHIForIntermediateProducerValueOfReducibleLiveOutVariable(
       LoopDependenceInfo *LDI,
@@ -172,6 +204,25 @@ protected:
       uint32_t taskIndex,
       BasicBlock &bb) = 0;
 
+  /*
+   * Lay out the basic blocks of the task so the hot ones, according to the
+   * profiles, are contiguous and the cold ones are moved out of the hot path.
+   */
+  void layOutTaskBody(LoopDependenceInfo *LDI, uint32_t taskIndex);
+
+  /*
+   * Prefetch the memory locations the strided loads of the task access a few
+   * iterations ahead, as the hardware prefetchers lose track of them across
+   * the chunks of iterations of the instances of the task.
+   * An instance runs @chunkSize consecutive iterations of the loop out of
+   * every @chunkSize * @numberOfInstances ones.
+   * The number of loads prefetched is returned.
+   */
+  uint32_t addPrefetchesToTaskBody(LoopDependenceInfo *LDI,
+                                   uint32_t taskIndex,
+                                   uint64_t chunkSize,
+                                   uint32_t numberOfInstances);
+
   /*
    * Partition SCCDAG.
    */
@@ -185,6 +236,26 @@ protected:
   float computeSequentialFractionOfExecution(LoopDependenceInfo *LDI,
                                              Noelle &par) const;
 
+  /*
+   * Check if the loop has floating point live-out variables that are reduced.
+   */
+  bool reducesFloatingPointVariables(LoopDependenceInfo *LDI) const;
+
+  /*
+   * Buffered output (see LoopDependenceInfo::getCallsWithBufferedOutput).
+   *
+   * The calls of a task that write to streams format their output into the
+   * buffer of their iteration, which the runtime keeps per core. The output
+   * is written in the order of the iterations when the loop ends.
+   */
+  bool canBufferOutputOfLoop(LoopDependenceInfo *LDI) const;
+
+  bool bufferOutputOfTask(LoopDependenceInfo *LDI, uint32_t taskIndex);
+
+  void generateCodeToWriteBufferedOutput(LoopDependenceInfo *LDI,
+                                         IRBuilder<> &builder,
+                                         Value *envPtr);
+
   /*
    * Debug
    */
@@ -204,6 +275,18 @@ protected:
   BasicBlock *entryPointOfParallelizedLoop, *exitPointOfParallelizedLoop;
   std::vector<Task *> tasks;
   uint32_t numTaskInstances;
+
+  /*
+   * Basic blocks of the tasks executed only when leaving them after the last
+   * iteration (see getBasicBlockExecutedOnlyByLastIterationBeforeExitingTask).
+   */
+  std::unordered_set<BasicBlock *> blocksExecutedOnlyByLastIteration;
+
+  /*
+   * Combine the private copies of reduced variables in a fixed order (see
+   * LoopEnvironmentBuilder::reduceLiveOutVariablesDeterministically).
+   */
+  bool reduceDeterministically;
 };
 
 } // namespace llvm::noelle
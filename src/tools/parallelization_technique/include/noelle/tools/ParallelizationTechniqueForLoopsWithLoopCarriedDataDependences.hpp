@@ -39,6 +39,14 @@ public:
   bool canBeAppliedToLoop(LoopDependenceInfo *LDI,
                           Heuristics *h) const override;
 
+  /*
+   * Check the conditions that only depend on the loop structure.
+   * They can be checked before computing the dependences of the loop.
+   * If they do not hold, then the reason is stored in @reason.
+   */
+  static bool canBeAppliedToLoopStructure(LoopStructure *ls,
+                                          std::string &reason);
+
   /*
    * Destructor.
    */
@@ -19,14 +19,26 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "noelle/tools/ParallelizationTechnique.hpp"
 
 namespace llvm::noelle {
 
+static cl::opt<bool> EnvironmentLayoutReport(
+    "noelle-environment-layout-report",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Report the layout of the environments of the parallelized "
+             "loops and the cache lines they falsely share, and make the "
+             "runtime report where they are (see NOELLE_ENVIRONMENT_REPORT)"));
+
 ParallelizationTechnique::ParallelizationTechnique(Noelle &n)
   : noelle{ n },
     tasks{},
-    envBuilder{ nullptr } {
+    envBuilder{ nullptr },
+    reduceDeterministically{ false } {
   this->verbose = n.getVerbosity();
 
   return;
@@ -36,6 +48,11 @@ Value *ParallelizationTechnique::getEnvArray(void) const {
   return this->envBuilder->getEnvironmentArray();
 }
 
+uint64_t ParallelizationTechnique::getCacheLineOfEnvironmentVariable(
+    uint32_t envIndex) const {
+  return this->envBuilder->getCacheLineOfEnvironmentVariable(envIndex);
+}
+
 void ParallelizationTechnique::initializeEnvironmentBuilder(
     LoopDependenceInfo *LDI,
     std::set<uint32_t> simpleVars,
@@ -204,6 +221,62 @@ void ParallelizationTechnique::populateLiveInEnvironment(
                     std::to_string(envIndex));
   }
 
+  /*
+   * Report the layout of the environment.
+   */
+  this->reportEnvironmentLayout(LDI);
+
+  return;
+}
+
+void ParallelizationTechnique::reportEnvironmentLayout(
+    LoopDependenceInfo *LDI) {
+
+  /*
+   * Check if the layout must be reported.
+   */
+  if (EnvironmentLayoutReport.getNumOccurrences() == 0) {
+    return;
+  }
+
+  /*
+   * Fetch the ID of the loop, which is -1 for loops without one.
+   */
+  auto mm = this->noelle.getMetadataManager();
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopFunction = loopStructure->getFunction();
+  auto &DL = loopFunction->getParent()->getDataLayout();
+  int64_t loopID = -1;
+  if (mm->doesHaveMetadata(loopStructure, "noelle.loop_ID")) {
+    loopID = std::stoll(mm->getMetadata(loopStructure, "noelle.loop_ID"));
+  }
+
+  /*
+   * Print the layout.
+   */
+  errs() << "Parallelizer: Environment of the loop " << loopID << " of "
+         << loopFunction->getName() << "\n";
+  this->envBuilder->printLayout(errs(), DL, "Parallelizer:   ");
+
+  /*
+   * Register the environment to the runtime just before the tasks start.
+   */
+  auto registerEnvironment =
+      this->noelle.getProgram()->getFunction("NOELLE_registerEnvironment");
+  if (registerEnvironment == nullptr) {
+    return;
+  }
+  auto tm = this->noelle.getTypesManager();
+  IRBuilder<> builder(this->entryPointOfParallelizedLoop);
+  auto loopIDValue = ConstantInt::get(tm->getIntegerType(64), loopID);
+  auto layout = builder.CreateGlobalStringPtr(
+      this->envBuilder->getLayoutDescriptor(DL));
+  builder.CreateCall(
+      registerEnvironment,
+      ArrayRef<Value *>(
+          { loopIDValue, this->envBuilder->getEnvironmentArrayVoidPtr(),
+            layout }));
+
   return;
 }
 
@@ -236,6 +309,7 @@ BasicBlock *ParallelizationTechnique::
    */
   std::unordered_map<uint32_t, Instruction::BinaryOps> reducableBinaryOps;
   std::unordered_map<uint32_t, Value *> initialValues;
+  std::unordered_map<uint32_t, Value *> identityValues;
   for (auto envInd : environment->getEnvIndicesOfLiveOutVars()) {
 
     /*
@@ -271,14 +345,27 @@ BasicBlock *ParallelizationTechnique::
     auto initialValue = loopEntryProducerPHI->getIncomingValue(initValPHIIndex);
     initialValues[envInd] =
         castToCorrectReducibleType(*builder, initialValue, producer->getType());
+    identityValues[envInd] =
+        this->getIdentityValueForEnvironmentValue(LDI,
+                                                  envInd,
+                                                  producer->getType());
   }
 
-  auto afterReductionB = this->envBuilder->reduceLiveOutVariables(
-      this->entryPointOfParallelizedLoop,
-      *builder,
-      reducableBinaryOps,
-      initialValues,
-      numberOfThreadsExecuted);
+  BasicBlock *afterReductionB = nullptr;
+  if (this->reduceDeterministically) {
+    afterReductionB = this->envBuilder->reduceLiveOutVariablesDeterministically(
+        this->entryPointOfParallelizedLoop,
+        reducableBinaryOps,
+        initialValues);
+  } else {
+    afterReductionB = this->envBuilder->reduceLiveOutVariables(
+        this->entryPointOfParallelizedLoop,
+        *builder,
+        reducableBinaryOps,
+        initialValues,
+        identityValues,
+        numberOfThreadsExecuted);
+  }
 
   /*
    * Free the memory.
@@ -506,14 +593,14 @@ void ParallelizationTechnique::cloneMemoryLocationsLocallyAndRewireLoop(
   assert(environment != nullptr);
 
   /*
-   * Check every stack object that can be safely cloned.
+   * Check every memory object that can be safely cloned.
    */
   for (auto location : memoryCloningAnalysis->getClonableMemoryLocations()) {
 
     /*
-     * Fetch the stack object.
+     * Fetch the memory object.
      */
-    auto alloca = location->getAllocation();
+    auto object = location->getMemoryObject();
 
     /*
      * Check if this is an allocation used by this task
@@ -537,12 +624,14 @@ void ParallelizationTechnique::cloneMemoryLocationsLocallyAndRewireLoop(
 
     /*
      *
-     * The stack object can be safely cloned (thanks to the object-cloning
+     * The memory object can be safely cloned (thanks to the object-cloning
      * analysis) and it is used by our loop.
      *
-     * First, we need to remove the alloca instruction to be a live-in.
+     * First, we need to remove the object to be a live-in.
      */
-    task->removeLiveIn(alloca);
+    if (auto objectInst = dyn_cast<Instruction>(object)) {
+      task->removeLiveIn(objectInst);
+    }
 
     /*
      * Now we need to traverse operands of loop instructions to clone
@@ -645,7 +734,7 @@ void ParallelizationTechnique::cloneMemoryLocationsLocallyAndRewireLoop(
            * Check if the current operand is the alloca instruction that will be
            * cloned.
            */
-          if (opJ == alloca) {
+          if (opJ == object) {
             assert(!task->isAnOriginalLiveIn(opJ));
             continue;
           }
@@ -703,15 +792,84 @@ void ParallelizationTechnique::cloneMemoryLocationsLocallyAndRewireLoop(
     /*
      * Clone the stack object at the beginning of the task.
      */
-    auto allocaClone = alloca->clone();
     auto firstInst = &*entryBlock.begin();
     entryBuilder.SetInsertPoint(firstInst);
-    entryBuilder.Insert(allocaClone);
+    if (auto alloca = location->getAllocation()) {
+      auto allocaClone = alloca->clone();
+      entryBuilder.Insert(allocaClone);
+
+      /*
+       * Keep track of the original-clone mapping.
+       */
+      task->addInstruction(alloca, allocaClone);
+      continue;
+    }
+
+    /*
+     * Heap objects and global variables are privatized by allocating a copy
+     * of them at the beginning of the task.
+     * Copies larger than a page are requested from the runtime, which keeps
+     * them in a pool to avoid allocating memory every time a task starts.
+     * Smaller copies are allocated in the stack of the task with the
+     * alignment guaranteed by malloc.
+     */
+    auto program = this->noelle.getProgram();
+    auto tm = this->noelle.getTypesManager();
+    auto sizeInBytes = location->getSizeInBytes();
+    auto sizeValue = ConstantInt::get(tm->getIntegerType(64), sizeInBytes);
+    auto allocateCopy = program->getFunction("NOELLE_allocatePrivateCopy");
+    auto releaseCopy = program->getFunction("NOELLE_releasePrivateCopy");
+    Value *copy = nullptr;
+    if (true && (allocateCopy != nullptr) && (releaseCopy != nullptr)
+        && (sizeInBytes > 4096)) {
+      copy = entryBuilder.CreateCall(allocateCopy,
+                                     ArrayRef<Value *>({ sizeValue }));
+
+      /*
+       * Give the copy back to the runtime when the task ends.
+       */
+      auto exitBlock = task->getExit();
+      IRBuilder<> exitBuilder(exitBlock);
+      if (auto exitTerminator = exitBlock->getTerminator()) {
+        exitBuilder.SetInsertPoint(exitTerminator);
+      }
+      exitBuilder.CreateCall(releaseCopy,
+                             ArrayRef<Value *>({ copy, sizeValue }));
+
+    } else {
+      auto copyType = ArrayType::get(tm->getIntegerType(8), sizeInBytes);
+      auto copyAlloca = entryBuilder.CreateAlloca(copyType);
+      copyAlloca->setAlignment(16);
+      copy = copyAlloca;
+    }
+    auto copyCast =
+        cast<Instruction>(entryBuilder.CreateBitCast(copy, object->getType()));
+
+    /*
+     * Keep track of the original-clone mapping for heap objects.
+     */
+    if (auto objectInst = dyn_cast<Instruction>(object)) {
+      task->addInstruction(objectInst, copyCast);
+      continue;
+    }
 
     /*
-     * Keep track of the original-clone mapping.
+     * Global variables are constants, so the data flow adjustment does not
+     * rewire their uses.
+     * Redirect the uses of the clones of the task to the copy.
      */
-    task->addInstruction(alloca, allocaClone);
+    auto instructionsUsingLocation =
+        location->getLoopInstructionsUsingLocation();
+    for (auto I : location->getInstructionsUsingLocationOutsideLoop()) {
+      instructionsUsingLocation.insert(I);
+    }
+    for (auto I : instructionsUsingLocation) {
+      if (!task->isAnOriginalInstruction(I)) {
+        continue;
+      }
+      auto cloneI = task->getCloneOfOriginalInstruction(I);
+      cloneI->replaceUsesOfWith(object, copyCast);
+    }
   }
   task->getTaskBody()->print(errs());
   rootLoop->getFunction()->print(errs());
@@ -774,6 +932,244 @@ void ParallelizationTechnique::generateCodeToLoadLiveInVariables(
   return;
 }
 
+uint32_t ParallelizationTechnique::hoistInvariantsOfTheTaskIntoTheEnvironment(
+    LoopDependenceInfo *LDI,
+    int taskIndex,
+    bool hoistLoads) {
+
+  /*
+   * Fetch the task.
+   */
+  auto task = this->tasks[taskIndex];
+  auto entryBlock = task->getEntry();
+
+  /*
+   * Fetch the loop.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopHeader = loopStructure->getHeader();
+  auto loopFunction = loopStructure->getFunction();
+  auto environment = LDI->getEnvironment();
+  auto envUser = this->envBuilder->getUser(taskIndex);
+  auto invariantManager = LDI->getInvariantManager();
+
+  /*
+   * Define the code that checks whether a basic block of the loop is executed
+   * by every invocation of the loop (i.e., it runs before the loop can exit).
+   * Instructions of these basic blocks can be computed by the caller even if
+   * they could trap.
+   */
+  DominatorTree DT(*loopFunction);
+  auto exitEdges = loopStructure->getLoopExitEdges();
+  auto isExecutedByEveryInvocation = [&DT, &exitEdges](BasicBlock *bb) -> bool {
+    for (auto &exitEdge : exitEdges) {
+      if (!DT.dominates(bb, exitEdge.first)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  /*
+   * Define the code that checks whether an operand of an invariant is
+   * available to the caller of the task.
+   * Operands defined outside the loop must be live-ins the task loads from
+   * the environment (e.g., not locally cloned memory locations).
+   */
+  std::unordered_set<Instruction *> hoistable;
+  auto isOperandAvailableToTheCaller = [&](Value *operand) -> bool {
+    if (isa<Constant>(operand)) {
+      return true;
+    }
+    if (auto operandInst = dyn_cast<Instruction>(operand)) {
+      if (loopStructure->isIncluded(operandInst)) {
+        return hoistable.count(operandInst) > 0;
+      }
+    } else if (!isa<Argument>(operand)) {
+      return false;
+    }
+    if (!task->isAnOriginalLiveIn(operand)) {
+      return false;
+    }
+    auto liveInClone =
+        dyn_cast<LoadInst>(task->getCloneOfOriginalLiveIn(operand));
+
+    return (liveInClone != nullptr) && (liveInClone->getParent() == entryBlock);
+  };
+
+  /*
+   * Collect the invariants the caller can compute.
+   * Basic blocks are visited following the dominator tree, so the invariants
+   * that compute the operands of an invariant are collected before it.
+   */
+  std::vector<Instruction *> hoistableInOrder;
+  for (auto node : depth_first(DT.getNode(loopHeader))) {
+    auto bb = node->getBlock();
+    if (!loopStructure->isIncluded(bb)) {
+      continue;
+    }
+    for (auto &inst : *bb) {
+      if (false || isa<PHINode>(&inst) || isa<CallBase>(&inst)
+          || isa<AllocaInst>(&inst) || inst.isTerminator()
+          || inst.mayHaveSideEffects() || inst.getType()->isVoidTy()
+          || (!task->isAnOriginalInstruction(&inst))
+          || (!invariantManager->isLoopInvariant(&inst))) {
+        continue;
+      }
+      if (auto load = dyn_cast<LoadInst>(&inst)) {
+        if (false || (!hoistLoads) || (!load->isSimple())) {
+          continue;
+        }
+      }
+      if (true && (!isSafeToSpeculativelyExecute(&inst))
+          && (!isExecutedByEveryInvocation(bb))) {
+        continue;
+      }
+      auto available = true;
+      for (auto &operand : inst.operands()) {
+        if (!isOperandAvailableToTheCaller(operand.get())) {
+          available = false;
+          break;
+        }
+      }
+      if (!available) {
+        continue;
+      }
+      hoistable.insert(&inst);
+      hoistableInOrder.push_back(&inst);
+    }
+  }
+
+  /*
+   * Select the invariants to pass through the environment: these are the ones
+   * used by the code of the loop that stays in the task.
+   * Each of them takes a new variable of the environment, so only the ones
+   * that save a load or more than one instruction per core are passed.
+   */
+  std::unordered_set<Instruction *> toHoist;
+  std::vector<Instruction *> invariantsToPass;
+  for (auto inv : hoistableInOrder) {
+    auto usedByTheTask = false;
+    for (auto user : inv->users()) {
+      auto userInst = dyn_cast<Instruction>(user);
+      if (true && (userInst != nullptr) && loopStructure->isIncluded(userInst)
+          && (hoistable.count(userInst) == 0)) {
+        usedByTheTask = true;
+        break;
+      }
+    }
+    if (!usedByTheTask) {
+      continue;
+    }
+
+    /*
+     * Collect the invariants needed to compute the current one.
+     */
+    std::unordered_set<Instruction *> slice;
+    std::vector<Instruction *> worklist = { inv };
+    auto includesLoads = false;
+    while (!worklist.empty()) {
+      auto sliceInst = worklist.back();
+      worklist.pop_back();
+      if (!slice.insert(sliceInst).second) {
+        continue;
+      }
+      if (isa<LoadInst>(sliceInst)) {
+        includesLoads = true;
+      }
+      for (auto &operand : sliceInst->operands()) {
+        auto operandInst = dyn_cast<Instruction>(operand.get());
+        if (true && (operandInst != nullptr)
+            && (hoistable.count(operandInst) > 0)) {
+          worklist.push_back(operandInst);
+        }
+      }
+    }
+    if (true && (!includesLoads) && (slice.size() < 2)) {
+      continue;
+    }
+    invariantsToPass.push_back(inv);
+    toHoist.insert(slice.begin(), slice.end());
+  }
+  if (invariantsToPass.size() == 0) {
+    return 0;
+  }
+
+  /*
+   * Compute the invariants in the caller, just before the environment is
+   * populated.
+   */
+  IRBuilder<> callerBuilder(this->entryPointOfParallelizedLoop);
+  if (auto terminator = this->entryPointOfParallelizedLoop->getTerminator()) {
+    callerBuilder.SetInsertPoint(terminator);
+  }
+  std::unordered_map<Instruction *, Instruction *> callerClones;
+  for (auto inv : hoistableInOrder) {
+    if (toHoist.count(inv) == 0) {
+      continue;
+    }
+    auto callerClone = inv->clone();
+    for (auto &operand : callerClone->operands()) {
+      auto operandInst = dyn_cast<Instruction>(operand.get());
+      if (true && (operandInst != nullptr)
+          && (callerClones.count(operandInst) > 0)) {
+        operand.set(callerClones[operandInst]);
+      }
+    }
+    callerBuilder.Insert(callerClone);
+    callerClones[inv] = callerClone;
+  }
+
+  /*
+   * Pass the invariants to the task through new variables of the environment.
+   * The clones of the invariants the task does not use anymore are left to
+   * the dead code elimination.
+   */
+  IRBuilder<> entryBuilder(entryBlock);
+  if (auto terminator = entryBlock->getTerminator()) {
+    entryBuilder.SetInsertPoint(terminator);
+  }
+  for (auto inv : invariantsToPass) {
+    auto callerClone = callerClones[inv];
+
+    /*
+     * Make space in the environment for the new live-in.
+     */
+    std::unordered_set<Instruction *> consumers;
+    for (auto user : inv->users()) {
+      auto userInst = dyn_cast<Instruction>(user);
+      if (true && (userInst != nullptr) && loopStructure->isIncluded(userInst)
+          && (toHoist.count(userInst) == 0)) {
+        consumers.insert(userInst);
+      }
+    }
+    auto envIndex = environment->addLiveInValue(callerClone, consumers);
+    this->envBuilder->addVariableToEnvironment(envIndex,
+                                               callerClone->getType());
+    envUser->addLiveInIndex(envIndex);
+
+    /*
+     * Load the invariant inside the task.
+     */
+    auto envPointer =
+        envUser->createEnvironmentVariablePointer(entryBuilder,
+                                                  envIndex,
+                                                  callerClone->getType());
+    auto metaString = std::string{ "noelle_environment_variable_" };
+    metaString.append(std::to_string(envIndex));
+    auto envLoad = entryBuilder.CreateLoad(envPointer, metaString);
+    task->addLiveIn(callerClone, envLoad);
+
+    /*
+     * Use the loaded value in the task.
+     */
+    auto taskClone = task->getCloneOfOriginalInstruction(inv);
+    taskClone->replaceAllUsesWith(envLoad);
+  }
+
+  return invariantsToPass.size();
+}
+
 void ParallelizationTechnique::generateCodeToStoreLiveOutVariables(
     LoopDependenceInfo *LDI,
     int taskIndex) {
@@ -989,6 +1385,9 @@ void ParallelizationTechnique::generateCodeToStoreLiveOutVariables(
                     taskIndex,
                     *BB);
             assert(lastIterationBB != nullptr);
+            if (lastIterationBB != BB) {
+              this->blocksExecutedOnlyByLastIteration.insert(lastIterationBB);
+            }
             auto lastIterationBBTerminator = lastIterationBB->getTerminator();
             if (lastIterationBBTerminator != nullptr) {
               store->insertBefore(lastIterationBBTerminator);
@@ -1744,6 +2143,343 @@ float ParallelizationTechnique::computeSequentialFractionOfExecution(
   return sequentialInstructionCount / totalInstructionCount;
 }
 
+bool ParallelizationTechnique::reducesFloatingPointVariables(
+    LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check every live-out variable.
+   */
+  auto sccManager = LDI->getSCCManager();
+  auto environment = LDI->getEnvironment();
+  for (auto envIndex : environment->getEnvIndicesOfLiveOutVars()) {
+    auto producer = environment->producerAt(envIndex);
+    if (!producer->getType()->getScalarType()->isFloatingPointTy()) {
+      continue;
+    }
+    auto scc = sccManager->getSCCDAG()->sccOfValue(producer);
+    auto sccInfo = sccManager->getSCCAttrs(scc);
+    if (sccInfo->canExecuteReducibly()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ParallelizationTechnique::layOutTaskBody(LoopDependenceInfo *LDI,
+                                              uint32_t taskIndex) {
+  assert(LDI != nullptr);
+  assert(taskIndex < this->tasks.size());
+
+  /*
+   * The layout relies on the profiles of the loop.
+   */
+  auto hot = this->noelle.getProfiles();
+  auto loopStructure = LDI->getLoopStructure();
+  if (false || (!hot->isAvailable())
+      || (!hot->hasBeenExecuted(loopStructure))) {
+    return;
+  }
+  auto loopInvocations = hot->getInvocations(loopStructure);
+
+  /*
+   * Fetch the task.
+   */
+  auto task = this->tasks[taskIndex];
+  auto taskBody = task->getTaskBody();
+
+  /*
+   * Identify the cold basic blocks of the task.
+   *
+   * A clone of a basic block of the loop is cold if the original one does not
+   * run more than once per invocation of the loop (e.g., it never runs, or it
+   * is executed only when leaving the loop).
+   * The blocks executed only when leaving the task are cold as well.
+   */
+  std::unordered_set<BasicBlock *> coldBBs{};
+  for (auto originalBB : loopStructure->getBasicBlocks()) {
+    auto cloneBB = task->getCloneOfOriginalBasicBlock(originalBB);
+    if (cloneBB == nullptr) {
+      continue;
+    }
+    if (hot->getInvocations(originalBB) <= loopInvocations) {
+      coldBBs.insert(cloneBB);
+    }
+  }
+  for (auto bb : this->blocksExecutedOnlyByLastIteration) {
+    if (bb->getParent() == taskBody) {
+      coldBBs.insert(bb);
+    }
+  }
+  for (auto i = 0u; i < task->getNumberOfLastBlocks(); i++) {
+    coldBBs.insert(task->getLastBlock(i));
+  }
+  coldBBs.insert(task->getExit());
+  coldBBs.erase(task->getEntry());
+  coldBBs.erase(&taskBody->getEntryBlock());
+
+  /*
+   * Make the hot basic blocks contiguous by moving the cold ones at the end of
+   * the task, keeping their relative order.
+   */
+  std::vector<BasicBlock *> coldBBsInOrder{};
+  for (auto &bb : *taskBody) {
+    if (coldBBs.find(&bb) != coldBBs.end()) {
+      coldBBsInOrder.push_back(&bb);
+    }
+  }
+  for (auto bb : coldBBsInOrder) {
+    bb->moveAfter(&taskBody->back());
+  }
+
+  /*
+   * Tell the back-end which successors are unlikely, so it can place the cold
+   * basic blocks out of the hot path (e.g., in .text.unlikely when splitting
+   * functions).
+   */
+  MDBuilder mdBuilder(taskBody->getContext());
+  for (auto &bb : *taskBody) {
+    auto br = dyn_cast<BranchInst>(bb.getTerminator());
+    if (false || (br == nullptr) || (!br->isConditional())
+        || (br->getMetadata(LLVMContext::MD_prof) != nullptr)) {
+      continue;
+    }
+    auto isSucc0Cold = coldBBs.find(br->getSuccessor(0)) != coldBBs.end();
+    auto isSucc1Cold = coldBBs.find(br->getSuccessor(1)) != coldBBs.end();
+    if (isSucc0Cold == isSucc1Cold) {
+      continue;
+    }
+    auto weights = isSucc0Cold ? mdBuilder.createBranchWeights(1, 2000)
+                               : mdBuilder.createBranchWeights(2000, 1);
+    br->setMetadata(LLVMContext::MD_prof, weights);
+  }
+
+  return;
+}
+
+uint32_t ParallelizationTechnique::addPrefetchesToTaskBody(
+    LoopDependenceInfo *LDI,
+    uint32_t taskIndex,
+    uint64_t chunkSize,
+    uint32_t numberOfInstances) {
+  assert(LDI != nullptr);
+  assert(taskIndex < this->tasks.size());
+  assert(chunkSize > 0);
+  assert(numberOfInstances > 0);
+
+  /*
+   * The loads to prefetch are the ones with memory locations known for every
+   * iteration of the loop.
+   */
+  auto LIDS = LDI->getLoopIterationDomainSpaceAnalysis();
+  if (LIDS == nullptr) {
+    return 0;
+  }
+  auto loopStructure = LDI->getLoopStructure();
+  auto task = this->tasks[taskIndex];
+  auto taskBody = task->getTaskBody();
+
+  /*
+   * Compute how many iterations an instance of the task must run ahead to
+   * hide the latency of the memory.
+   * The instructions per iteration come from the profiles when available.
+   */
+  uint64_t const instructionsToHideMemoryLatency = 256;
+  uint64_t const maximumIterationsAhead = 32;
+  double instructionsPerIteration = loopStructure->getNumberOfInstructions();
+  auto hot = this->noelle.getProfiles();
+  if (true && hot->isAvailable() && hot->hasBeenExecuted(loopStructure)) {
+    instructionsPerIteration =
+        hot->getAverageTotalInstructionsPerIteration(loopStructure);
+  }
+  instructionsPerIteration = std::max(instructionsPerIteration, 1.0);
+  auto iterationsAhead = std::min(
+      maximumIterationsAhead,
+      (uint64_t)std::ceil(instructionsToHideMemoryLatency
+                          / instructionsPerIteration));
+  iterationsAhead = std::max(iterationsAhead, (uint64_t)1);
+
+  /*
+   * An instance of the task runs @chunkSize consecutive iterations of the loop
+   * out of every @chunkSize * @numberOfInstances ones.
+   * Translate the iterations it runs ahead into iterations of the loop.
+   */
+  auto chunksAhead = iterationsAhead / chunkSize;
+  auto loopIterationsAhead =
+      iterationsAhead + chunksAhead * chunkSize * (numberOfInstances - 1);
+
+  /*
+   * Fetch the clones of the integer IVs of the loop with a constant step.
+   * Each one holds the value of the IV at the current iteration.
+   */
+  auto IVM = LDI->getInductionVariableManager();
+  std::unordered_map<PHINode *, ConstantInt *> ivSteps;
+  for (auto IV : IVM->getInductionVariables(*loopStructure)) {
+    auto step = dyn_cast_or_null<ConstantInt>(IV->getSingleComputedStepValue());
+    auto clonePHI = dyn_cast_or_null<PHINode>(
+        task->getCloneOfOriginalInstruction(IV->getLoopEntryPHI()));
+    if (false || (step == nullptr) || (clonePHI == nullptr)
+        || (!IV->getIVType()->isIntegerTy())) {
+      continue;
+    }
+    ivSteps[clonePHI] = step;
+  }
+  std::unordered_set<BasicBlock *> loopBBs;
+  for (auto originalBB : loopStructure->getBasicBlocks()) {
+    auto cloneBB = task->getCloneOfOriginalBasicBlock(originalBB);
+    if (cloneBB != nullptr) {
+      loopBBs.insert(cloneBB);
+    }
+  }
+
+  /*
+   * Define the code that fetches the slice of an address of the task, where
+   * an instruction follows the ones it uses.
+   * The slice can include only instructions without side effects that cannot
+   * trap, and its only PHIs must be IVs. Hence, the address of a later
+   * iteration can be computed without reading memory.
+   */
+  std::function<bool(Value *,
+                     std::unordered_set<Instruction *> &,
+                     std::vector<Instruction *> &)>
+      getSlice;
+  getSlice = [&](Value *v,
+                 std::unordered_set<Instruction *> &visited,
+                 std::vector<Instruction *> &slice) -> bool {
+    auto inst = dyn_cast<Instruction>(v);
+    if (false || (inst == nullptr) || (loopBBs.count(inst->getParent()) == 0)
+        || (visited.count(inst) > 0)) {
+      return true;
+    }
+    visited.insert(inst);
+    if (auto phi = dyn_cast<PHINode>(inst)) {
+      if (ivSteps.count(phi) == 0) {
+        return false;
+      }
+      slice.push_back(phi);
+      return true;
+    }
+    auto isSafe = false || isa<CastInst>(inst) || isa<GetElementPtrInst>(inst)
+                  || isa<CmpInst>(inst) || isa<SelectInst>(inst);
+    if (auto binOp = dyn_cast<BinaryOperator>(inst)) {
+      switch (binOp->getOpcode()) {
+        case Instruction::UDiv:
+        case Instruction::SDiv:
+        case Instruction::URem:
+        case Instruction::SRem:
+          break;
+        default:
+          isSafe = true;
+          break;
+      }
+    }
+    if (!isSafe) {
+      return false;
+    }
+    for (auto op : inst->operand_values()) {
+      if (!getSlice(op, visited, slice)) {
+        return false;
+      }
+    }
+    slice.push_back(inst);
+
+    return true;
+  };
+
+  /*
+   * Prefetch the addresses the loads of the loop will access
+   * @loopIterationsAhead iterations later.
+   * Loads of nested loops are not considered, as their addresses depend on
+   * the iterations of the nested loops as well.
+   * Indirect loads are not considered either: computing their later
+   * addresses requires loading memory that might not be accessible.
+   */
+  auto &cxt = taskBody->getContext();
+  auto int8Ptr = PointerType::getUnqual(IntegerType::get(cxt, 8));
+  auto int32 = IntegerType::get(cxt, 32);
+  auto prefetch =
+      Intrinsic::getDeclaration(taskBody->getParent(), Intrinsic::prefetch);
+  std::unordered_set<Value *> prefetchedAddresses;
+  uint32_t prefetches = 0;
+  for (auto originalBB : loopStructure->getBasicBlocks()) {
+    for (auto &I : *originalBB) {
+      auto load = dyn_cast<LoadInst>(&I);
+      if (false || (load == nullptr) || load->isVolatile()
+          || (LDI->getNestedMostLoopStructure(load) != loopStructure)
+          || (!LIDS->isMemoryAccessSpaceKnown(load))) {
+        continue;
+      }
+      auto cloneLoad =
+          dyn_cast_or_null<LoadInst>(task->getCloneOfOriginalInstruction(load));
+      if (cloneLoad == nullptr) {
+        continue;
+      }
+      auto address = cloneLoad->getPointerOperand();
+      if (prefetchedAddresses.count(address) > 0) {
+        continue;
+      }
+      std::unordered_set<Instruction *> visited;
+      std::vector<Instruction *> slice;
+      if (false || (!getSlice(address, visited, slice))
+          || (!std::any_of(slice.begin(), slice.end(), [](Instruction *inst) {
+               return isa<PHINode>(inst);
+             }))) {
+        continue;
+      }
+      prefetchedAddresses.insert(address);
+
+      /*
+       * Compute the address of the later iteration right before the load.
+       * The IVs are moved ahead by their steps.
+       */
+      IRBuilder<> builder{ cloneLoad };
+      std::unordered_map<Value *, Value *> laterValues;
+      for (auto sliceInst : slice) {
+        if (auto clonePHI = dyn_cast<PHINode>(sliceInst)) {
+          auto step = ivSteps[clonePHI];
+          auto offset = ConstantInt::get(
+              clonePHI->getType(),
+              step->getValue().sextOrTrunc(
+                  clonePHI->getType()->getIntegerBitWidth())
+                  * loopIterationsAhead);
+          laterValues[clonePHI] = builder.CreateAdd(clonePHI, offset);
+          continue;
+        }
+        auto laterInst = sliceInst->clone();
+        for (auto i = 0u; i < laterInst->getNumOperands(); i++) {
+          auto op = laterInst->getOperand(i);
+          if (laterValues.count(op) > 0) {
+            laterInst->setOperand(i, laterValues[op]);
+          }
+        }
+
+        /*
+         * The later iteration might not run, so its values must not be
+         * poison.
+         */
+        laterInst->dropPoisonGeneratingFlags();
+        laterInst->setDebugLoc(DebugLoc());
+        builder.Insert(laterInst);
+        laterValues[sliceInst] = laterInst;
+      }
+
+      /*
+       * Prefetch the address for reading with high temporal locality, as the
+       * same instance of the task uses it soon.
+       */
+      auto laterAddress = builder.CreateBitCast(laterValues[address], int8Ptr);
+      builder.CreateCall(prefetch,
+                         ArrayRef<Value *>({ laterAddress,
+                                             ConstantInt::get(int32, 0),
+                                             ConstantInt::get(int32, 3),
+                                             ConstantInt::get(int32, 1) }));
+      prefetches++;
+    }
+  }
+
+  return prefetches;
+}
+
 void ParallelizationTechnique::dumpToFile(LoopDependenceInfo &LDI) {
   std::error_code EC;
   raw_fd_ostream File(
@@ -1832,4 +2568,13 @@ BasicBlock *ParallelizationTechnique::getParLoopExitPoint(void) const {
   return exitPointOfParallelizedLoop;
 }
 
+std::vector<Function *> ParallelizationTechnique::getTaskBodies(void) const {
+  std::vector<Function *> taskBodies;
+  for (auto task : this->tasks) {
+    taskBodies.push_back(task->getTaskBody());
+  }
+
+  return taskBodies;
+}
+
 } // namespace llvm::noelle
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "noelle/tools/ParallelizationTechnique.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Stream functions of the C library and the functions of the runtime that
+ * buffer their output.
+ */
+static const std::map<std::string, std::string> bufferedOutputFunctions{
+  { "printf", "NOELLE_bufferedPrintf" },
+  { "fprintf", "NOELLE_bufferedFprintf" },
+  { "puts", "NOELLE_bufferedPuts" },
+  { "putchar", "NOELLE_bufferedPutchar" },
+  { "fputs", "NOELLE_bufferedFputs" },
+  { "fputc", "NOELLE_bufferedFputc" },
+  { "putc", "NOELLE_bufferedFputc" },
+  { "fwrite", "NOELLE_bufferedFwrite" }
+};
+
+bool ParallelizationTechnique::canBufferOutputOfLoop(
+    LoopDependenceInfo *LDI) const {
+
+  /*
+   * Check if the runtime provides the buffers.
+   */
+  auto program = this->noelle.getProgram();
+  auto iterationFunction =
+      program->getFunction("NOELLE_bufferedOutputIteration");
+  auto writeFunction = program->getFunction("NOELLE_bufferedOutputWrite");
+  if (false || (iterationFunction == nullptr) || (writeFunction == nullptr)) {
+    return false;
+  }
+  for (auto call : LDI->getCallsWithBufferedOutput()) {
+    auto calleeName = call->getCalledFunction()->getName().str();
+    auto bufferedFunction = bufferedOutputFunctions.find(calleeName);
+    if (false || (bufferedFunction == bufferedOutputFunctions.end())
+        || (program->getFunction(bufferedFunction->second) == nullptr)) {
+      return false;
+    }
+  }
+
+  /*
+   * The runtime orders the output by the value the loop-governing IV has in
+   * the iteration that produced it.
+   * This requires the direction of the IV to be known at compile time.
+   */
+  auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+  if (loopGoverningIVAttr == nullptr) {
+    return false;
+  }
+  auto &IV = loopGoverningIVAttr->getInductionVariable();
+  auto IVType = IV.getLoopEntryPHI()->getType();
+  if (false || (!IV.isStepValueSignKnown())
+      || (!(IVType->isIntegerTy() || IVType->isPointerTy()))
+      || (IVType->getPrimitiveSizeInBits() > 64)) {
+    return false;
+  }
+
+  return true;
+}
+
+bool ParallelizationTechnique::bufferOutputOfTask(LoopDependenceInfo *LDI,
+                                                  uint32_t taskIndex) {
+  auto &calls = LDI->getCallsWithBufferedOutput();
+  if (calls.size() == 0) {
+    return false;
+  }
+  assert(this->canBufferOutputOfLoop(LDI));
+
+  /*
+   * Fetch the task.
+   */
+  auto task = this->tasks[taskIndex];
+  auto program = this->noelle.getProgram();
+
+  /*
+   * Tell the runtime which iteration runs at the beginning of each iteration
+   * of the task.
+   * Iterations are identified by the value of the loop-governing IV, which is
+   * negated if the IV decreases so the iterations run in increasing order.
+   */
+  auto &IV = LDI->getLoopGoverningIVAttribution()->getInductionVariable();
+  auto originalHeader = LDI->getLoopStructure()->getHeader();
+  auto header = task->getCloneOfOriginalBasicBlock(originalHeader);
+  auto phi = task->getCloneOfOriginalInstruction(IV.getLoopEntryPHI());
+  assert(header != nullptr);
+  assert(phi != nullptr);
+  IRBuilder<> headerBuilder{ header->getFirstNonPHI() };
+  auto int64 = this->noelle.int64;
+  Value *iteration = nullptr;
+  if (phi->getType()->isPointerTy()) {
+    iteration = headerBuilder.CreatePtrToInt(phi, int64);
+  } else {
+    iteration = headerBuilder.CreateSExtOrTrunc(phi, int64);
+  }
+  if (!IV.isStepValuePositive()) {
+    iteration = headerBuilder.CreateNeg(iteration);
+  }
+  auto iterationFunction =
+      program->getFunction("NOELLE_bufferedOutputIteration");
+  headerBuilder.CreateCall(
+      iterationFunction,
+      ArrayRef<Value *>({ task->getEnvironment(), iteration }));
+
+  /*
+   * Redirect the calls to the runtime.
+   * They format their output in parallel into the buffers of the iterations.
+   */
+  for (auto call : calls) {
+    auto callClone = cast<CallBase>(task->getCloneOfOriginalInstruction(call));
+    auto calleeName = call->getCalledFunction()->getName().str();
+    auto runtimeFunction =
+        program->getFunction(bufferedOutputFunctions.at(calleeName));
+    auto calleeType = callClone->getFunctionType();
+    auto callee = ConstantExpr::getBitCast(runtimeFunction,
+                                           PointerType::getUnqual(calleeType));
+    callClone->setCalledFunction(calleeType, callee);
+  }
+  if (this->verbose != Verbosity::Disabled) {
+    errs() << "ParallelizationTechnique: " << calls.size()
+           << " calls of the task buffer their output\n";
+  }
+
+  return true;
+}
+
+void ParallelizationTechnique::generateCodeToWriteBufferedOutput(
+    LoopDependenceInfo *LDI,
+    IRBuilder<> &builder,
+    Value *envPtr) {
+  if (LDI->getCallsWithBufferedOutput().size() == 0) {
+    return;
+  }
+
+  /*
+   * Write the output of the tasks before the code after the loop writes its
+   * own.
+   */
+  auto writeFunction =
+      this->noelle.getProgram()->getFunction("NOELLE_bufferedOutputWrite");
+  builder.CreateCall(writeFunction, ArrayRef<Value *>({ envPtr }));
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -37,12 +37,29 @@ ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences::
 bool ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences::
     canBeAppliedToLoop(LoopDependenceInfo *LDI, Heuristics *h) const {
 
+  /*
+   * The private copies of the reduced variables accumulate the iterations
+   * executed by each core, which depend on the cores available.
+   * Hence, floating point variables cannot be reduced reproducibly.
+   */
+  if (true && (this->noelle.getNumberOfDeterministicReductionPartitions() > 0)
+      && this->reducesFloatingPointVariables(LDI)) {
+    return false;
+  }
+
+  std::string reason;
+  return canBeAppliedToLoopStructure(LDI->getLoopStructure(), reason);
+}
+
+bool ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences::
+    canBeAppliedToLoopStructure(LoopStructure *ls, std::string &reason) {
+
   /*
    * We do not handle loops with no successors.
    */
-  auto ls = LDI->getLoopStructure();
   auto exits = ls->getLoopExitBasicBlocks();
   if (exits.size() == 0) {
+    reason = "the loop has no exits";
     return false;
   }
 
@@ -54,6 +71,7 @@ bool ParallelizationTechniqueForLoopsWithLoopCarriedDataDependences::
    */
   for (auto i : ls->getInstructions()) {
     if (isa<InvokeInst>(i)) {
+      reason = "the loop includes invoke instructions";
       return false;
     }
   }
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+bool Parallelizer::canLoopBeAdaptive(LoopDependenceInfo *LDI,
+                                     Noelle &par) const {
+
+  /*
+   * Check if the adaptive version of the loop has been requested.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto mm = par.getMetadataManager();
+  auto adaptiveMetadata = "noelle.parallelizer.adaptive";
+  if (true && (!this->adaptiveLoops)
+      && (!mm->doesHaveMetadata(loopStructure, adaptiveMetadata))) {
+    return false;
+  }
+
+  /*
+   * Check if the runtime can select the version of the loop.
+   */
+  auto M = par.getProgram();
+  if (false || (M->getFunction("NOELLE_adaptiveLoopBegin") == nullptr)
+      || (M->getFunction("NOELLE_adaptiveLoopEnd") == nullptr)) {
+    return false;
+  }
+
+  /*
+   * The invocation of the loop ends at its exits.
+   * Hence, these must be reachable only from the loop; otherwise, an
+   * invocation would end without having started.
+   */
+  for (auto exitBB : loopStructure->getLoopExitBasicBlocks()) {
+    for (auto predBB : predecessors(exitBB)) {
+      if (!loopStructure->isIncluded(predBB)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void Parallelizer::makeLoopAdaptive(LoopDependenceInfo *LDI,
+                                    Noelle &par,
+                                    DOALL &doall,
+                                    BasicBlock *loopPreHeader,
+                                    std::vector<BasicBlock *> &loopExitBlocks) {
+
+  /*
+   * Fetch the runtime functions.
+   */
+  auto M = par.getProgram();
+  auto beginFunction = M->getFunction("NOELLE_adaptiveLoopBegin");
+  auto endFunction = M->getFunction("NOELLE_adaptiveLoopEnd");
+  assert(beginFunction != nullptr);
+  assert(endFunction != nullptr);
+  auto cm = par.getConstantsManager();
+  auto tm = par.getTypesManager();
+  auto loopID = cm->getIntegerConstant(LDI->getID(), 64);
+
+  /*
+   * Fetch the branch that selects between the sequential and the
+   * parallelized loop.
+   * Its condition holds if no other invocation runs the parallelized loop.
+   */
+  auto selector = cast<BranchInst>(loopPreHeader->getTerminator());
+  assert(selector->isConditional());
+  auto canRunInParallel = selector->getCondition();
+
+  /*
+   * Let the runtime select the version to run.
+   * The runtime returns the chunk size to use, or 0 for the sequential loop.
+   */
+  auto dispatcherCall = doall.getDispatcherCall();
+  assert(dispatcherCall != nullptr);
+  IRBuilder<> beginBuilder{ selector };
+  auto chunkSize = beginBuilder.CreateCall(
+      beginFunction,
+      ArrayRef<Value *>(
+          { loopID,
+            beginBuilder.CreateZExt(canRunInParallel, tm->getIntegerType(64)),
+            dispatcherCall->getArgOperand(3) }));
+  auto runInParallel =
+      beginBuilder.CreateICmpNE(chunkSize, cm->getIntegerConstant(0, 64));
+  selector->setCondition(runInParallel);
+
+  /*
+   * Run the parallelized loop with the chunk size selected.
+   * The number of chunks computed at compile time (used by the guided
+   * scheduling) does not hold for other chunk sizes, so the runtime computes
+   * it.
+   */
+  dispatcherCall->setArgOperand(3, chunkSize);
+  if (dispatcherCall->getNumArgOperands() > 5) {
+    dispatcherCall->setArgOperand(5, cm->getIntegerConstant(0, 64));
+  }
+
+  /*
+   * End the invocation at the exits, which are shared by both versions.
+   */
+  for (auto exitBB : loopExitBlocks) {
+    IRBuilder<> endBuilder{ &*exitBB->getFirstInsertionPt() };
+    endBuilder.CreateCall(endFunction, ArrayRef<Value *>({ loopID }));
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,439 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+std::vector<Instruction *> Parallelizer::
+    getInstructionsThatCanOverlapWithTheLoop(LoopDependenceInfo *LDI,
+                                             Noelle &par,
+                                             BasicBlock *exitPoint) const {
+  std::vector<Instruction *> overlappingInsts;
+
+  /*
+   * The code after the loop must start at a single exit.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  auto loopExitBlocks = loopStructure->getLoopExitBasicBlocks();
+  if (loopExitBlocks.size() != 1) {
+    return overlappingInsts;
+  }
+  auto exitBB = loopExitBlocks[0];
+
+  /*
+   * The exit must be reachable only from the loop and from the parallelized
+   * loop.
+   */
+  for (auto predBB : predecessors(exitBB)) {
+    if (false || (predBB == exitPoint) || loopStructure->isIncluded(predBB)) {
+      continue;
+    }
+    return overlappingInsts;
+  }
+
+  /*
+   * Collect the longest sequence of instructions at the beginning of the exit
+   * that do not depend on the loop.
+   * The loop dependence graph includes every instruction outside the loop
+   * that has a dependence with the loop as an external node.
+   */
+  auto loopDG = LDI->getLoopDG();
+  std::unordered_set<Instruction *> overlappingSet;
+  for (auto &inst : *exitBB) {
+    if (isa<PHINode>(&inst)) {
+      continue;
+    }
+    if (inst.isTerminator()) {
+      break;
+    }
+
+    /*
+     * Calls can synchronize with the tasks (e.g., through locks or I/O), and
+     * other instructions can have effects the dependence graph does not
+     * capture.
+     */
+    if (false || isa<CallBase>(&inst) || isa<AllocaInst>(&inst)
+        || inst.isEHPad() || inst.isAtomic()) {
+      break;
+    }
+    if (auto loadInst = dyn_cast<LoadInst>(&inst)) {
+      if (!loadInst->isSimple()) {
+        break;
+      }
+    }
+    if (auto storeInst = dyn_cast<StoreInst>(&inst)) {
+      if (!storeInst->isSimple()) {
+        break;
+      }
+    }
+
+    /*
+     * Check the instruction does not depend on the loop, and the loop does not
+     * depend on it.
+     */
+    if (loopDG->isInGraph(&inst)) {
+      break;
+    }
+
+    /*
+     * Check the instruction does not use the live-out values of the loop.
+     * These are either the PHIs of the exit or values defined inside the loop.
+     */
+    auto usesTheLoop = false;
+    for (auto &op : inst.operands()) {
+      auto opInst = dyn_cast<Instruction>(op.get());
+      if (opInst == nullptr) {
+        continue;
+      }
+      if (opInst->getParent() == exitBB) {
+        if (overlappingSet.find(opInst) == overlappingSet.end()) {
+          usesTheLoop = true;
+          break;
+        }
+        continue;
+      }
+      if (loopStructure->isIncluded(opInst)) {
+        usesTheLoop = true;
+        break;
+      }
+    }
+    if (usesTheLoop) {
+      break;
+    }
+
+    overlappingInsts.push_back(&inst);
+    overlappingSet.insert(&inst);
+  }
+
+  return overlappingInsts;
+}
+
+bool Parallelizer::overlapLoopWithTheCodeAfterIt(
+    LoopDependenceInfo *LDI,
+    Noelle &par,
+    DOALL &doall,
+    BasicBlock *exitPoint,
+    std::vector<BasicBlock *> &loopExitBlocks) {
+
+  /*
+   * Fetch the runtime functions.
+   */
+  auto M = par.getProgram();
+  auto asyncDispatcher = M->getFunction("NOELLE_DOALLDispatcherAsync");
+  auto joinFunction = M->getFunction("NOELLE_DOALLJoin");
+  if (false || (asyncDispatcher == nullptr) || (joinFunction == nullptr)) {
+    return false;
+  }
+
+  /*
+   * Only the dispatcher with the static scheduling of chunks has an
+   * asynchronous version.
+   */
+  auto dispatcherCall = doall.getDispatcherCall();
+  assert(dispatcherCall != nullptr);
+  auto dispatcher = dispatcherCall->getCalledFunction();
+  if (false || (dispatcher == nullptr)
+      || (dispatcher->getName() != "NOELLE_DOALLDispatcher")) {
+    return false;
+  }
+
+  /*
+   * Fetch the code after the loop that can run while the loop runs.
+   */
+  auto overlappingInsts =
+      this->getInstructionsThatCanOverlapWithTheLoop(LDI, par, exitPoint);
+  if (overlappingInsts.size() == 0) {
+    return false;
+  }
+  assert(loopExitBlocks.size() == 1);
+  auto exitBB = loopExitBlocks[0];
+
+  /*
+   * Dispatch the loop without waiting for it.
+   * Then, run a copy of the overlapping instructions and wait for the loop.
+   */
+  IRBuilder<> dispatchBuilder{ dispatcherCall };
+  std::vector<Value *> dispatcherArgs;
+  for (auto argID = 0u; argID < dispatcherCall->getNumArgOperands(); argID++) {
+    dispatcherArgs.push_back(dispatcherCall->getArgOperand(argID));
+  }
+  auto handle = dispatchBuilder.CreateCall(asyncDispatcher,
+                                           ArrayRef<Value *>(dispatcherArgs));
+  ValueToValueMapTy clones;
+  for (auto inst : overlappingInsts) {
+    auto cloneInst = inst->clone();
+    RemapInstruction(cloneInst,
+                     clones,
+                     RF_IgnoreMissingLocals | RF_NoModuleLevelChanges);
+    dispatchBuilder.Insert(cloneInst);
+    clones[inst] = cloneInst;
+  }
+  auto joinCall =
+      dispatchBuilder.CreateCall(joinFunction, ArrayRef<Value *>({ handle }));
+  dispatcherCall->replaceAllUsesWith(joinCall);
+  dispatcherCall->eraseFromParent();
+
+  /*
+   * Split the exit after the overlapping instructions.
+   * The sequential loop still runs them, while the parallelized loop skips
+   * them.
+   */
+  auto lastOverlappingInst = overlappingInsts.back();
+  auto afterOverlapBB =
+      SplitBlock(exitBB, lastOverlappingInst->getNextNode());
+  auto exitPointTerminator = exitPoint->getTerminator();
+  exitPointTerminator->replaceUsesOfWith(exitBB, afterOverlapBB);
+
+  /*
+   * Merge the values that come from the two versions of the loop.
+   * First, the PHIs of the exit (i.e., the live-out values).
+   */
+  IRBuilder<> mergeBuilder{ &*afterOverlapBB->begin() };
+  std::vector<PHINode *> exitPHIs;
+  for (auto &phi : exitBB->phis()) {
+    exitPHIs.push_back(&phi);
+  }
+  for (auto phi : exitPHIs) {
+    auto parallelValue = phi->getIncomingValueForBlock(exitPoint);
+    phi->removeIncomingValue(exitPoint, /*DeletePHIIfEmpty=*/false);
+    auto mergePHI = mergeBuilder.CreatePHI(phi->getType(), 2);
+    phi->replaceAllUsesWith(mergePHI);
+    mergePHI->addIncoming(phi, exitBB);
+    mergePHI->addIncoming(parallelValue, exitPoint);
+  }
+
+  /*
+   * Second, the overlapping instructions used after the exit.
+   */
+  for (auto inst : overlappingInsts) {
+    if (inst->getType()->isVoidTy()) {
+      continue;
+    }
+    auto mergePHI = mergeBuilder.CreatePHI(inst->getType(), 2);
+    inst->replaceUsesOutsideBlock(mergePHI, exitBB);
+    mergePHI->addIncoming(inst, exitBB);
+    mergePHI->addIncoming(clones[inst], exitPoint);
+  }
+
+  return true;
+}
+
+bool Parallelizer::overlapChunkWithTheFillOfTheNextOne(
+    LoopDependenceInfo *LDI,
+    Noelle &par,
+    DOALL &doall,
+    BasicBlock *exitPoint,
+    std::vector<BasicBlock *> &loopExitBlocks) {
+
+  /*
+   * Fetch the runtime functions.
+   */
+  auto M = par.getProgram();
+  auto asyncDispatcher = M->getFunction("NOELLE_DOALLDispatcherAsync");
+  auto joinFunction = M->getFunction("NOELLE_DOALLJoin");
+  if (false || (asyncDispatcher == nullptr) || (joinFunction == nullptr)) {
+    return false;
+  }
+
+  /*
+   * Only the dispatcher with the static scheduling of chunks has an
+   * asynchronous version.
+   */
+  auto dispatcherCall = doall.getDispatcherCall();
+  assert(dispatcherCall != nullptr);
+  auto dispatcher = dispatcherCall->getCalledFunction();
+  if (false || (dispatcher == nullptr)
+      || (dispatcher->getName() != "NOELLE_DOALLDispatcher")) {
+    return false;
+  }
+
+  /*
+   * The loop must iterate over the nodes of a chunk of a list, and its exit
+   * must lead only to the loop that collects the nodes of the next chunk
+   * (see LoopTransformer::chunkPointerChasingLoop).
+   * This loop is composed by its header and its latch, and it leaves to a
+   * single block.
+   */
+  if (loopExitBlocks.size() != 1) {
+    return false;
+  }
+  auto drainBB = loopExitBlocks[0];
+  auto drainBr = dyn_cast<BranchInst>(drainBB->getTerminator());
+  if (false || (drainBr == nullptr) || drainBr->isConditional()
+      || (drainBB->getFirstNonPHI() != drainBr)) {
+    return false;
+  }
+  auto fillHeader = drainBr->getSuccessor(0);
+  auto fillBr = dyn_cast<BranchInst>(fillHeader->getTerminator());
+  if (false || (fillBr == nullptr) || (!fillBr->isConditional())) {
+    return false;
+  }
+  auto fillExit = fillBr->getSuccessor(0);
+  auto fillLatch = fillBr->getSuccessor(1);
+  auto fillLatchBr = dyn_cast<BranchInst>(fillLatch->getTerminator());
+  if (false || (fillLatchBr == nullptr) || fillLatchBr->isConditional()
+      || (fillLatchBr->getSuccessor(0) != fillHeader)
+      || (fillLatch->getSinglePredecessor() != fillHeader)
+      || (fillExit->getSinglePredecessor() != fillHeader)
+      || (pred_size(fillHeader) != 2)) {
+    return false;
+  }
+  auto fillLoopID = fillLatchBr->getMetadata(LLVMContext::MD_loop);
+  if (false || (fillLoopID == nullptr)
+      || (findOptionMDForLoopID(fillLoopID, "noelle.loop.chunk.fill")
+          == nullptr)) {
+    return false;
+  }
+
+  /*
+   * The chunking guarantees that the fill reads only nodes the loop does not
+   * write, and that it writes only the buffer the loop does not read.
+   * Hence, the fill can run while the tasks run if it does not need any value
+   * the loop produces, and if the values it produces reach the rest of the
+   * function only through the PHIs of its exit.
+   */
+  auto loopStructure = LDI->getLoopStructure();
+  std::vector<BasicBlock *> fillBlocks{ fillHeader, fillLatch };
+  for (auto bb : fillBlocks) {
+    for (auto &inst : *bb) {
+      if (false || isa<CallBase>(&inst) || inst.isAtomic()) {
+        return false;
+      }
+      if (auto loadInst = dyn_cast<LoadInst>(&inst)) {
+        if (!loadInst->isSimple()) {
+          return false;
+        }
+      }
+      if (auto storeInst = dyn_cast<StoreInst>(&inst)) {
+        if (!storeInst->isSimple()) {
+          return false;
+        }
+      }
+      for (auto &op : inst.operands()) {
+        auto opInst = dyn_cast<Instruction>(op.get());
+        if (true && (opInst != nullptr)
+            && (loopStructure->isIncluded(opInst)
+                || (opInst->getParent() == drainBB))) {
+          return false;
+        }
+      }
+      for (auto user : inst.users()) {
+        auto userInst = cast<Instruction>(user);
+        auto userBB = userInst->getParent();
+        if (false || (userBB == fillHeader) || (userBB == fillLatch)
+            || (true && (userBB == fillExit) && isa<PHINode>(userInst))) {
+          continue;
+        }
+        return false;
+      }
+    }
+  }
+
+  /*
+   * The values the loop produces must leave it through the PHIs of its exit.
+   */
+  for (auto inst : loopStructure->getInstructions()) {
+    for (auto user : inst->users()) {
+      auto userInst = cast<Instruction>(user);
+      if (false || loopStructure->isIncluded(userInst)
+          || (true && (userInst->getParent() == drainBB)
+              && isa<PHINode>(userInst))) {
+        continue;
+      }
+      return false;
+    }
+  }
+
+  /*
+   * Dispatch the chunk without waiting for it.
+   * Then, run a copy of the fill and wait for the chunk.
+   */
+  auto dispatchBB = dispatcherCall->getParent();
+  IRBuilder<> dispatchBuilder{ dispatcherCall };
+  std::vector<Value *> dispatcherArgs;
+  for (auto argID = 0u; argID < dispatcherCall->getNumArgOperands(); argID++) {
+    dispatcherArgs.push_back(dispatcherCall->getArgOperand(argID));
+  }
+  auto handle = dispatchBuilder.CreateCall(asyncDispatcher,
+                                           ArrayRef<Value *>(dispatcherArgs));
+  auto waitBB = SplitBlock(dispatchBB, dispatcherCall);
+  auto parallelExitBB = (exitPoint == dispatchBB) ? waitBB : exitPoint;
+  IRBuilder<> waitBuilder{ dispatcherCall };
+  auto joinCall =
+      waitBuilder.CreateCall(joinFunction, ArrayRef<Value *>({ handle }));
+  dispatcherCall->replaceAllUsesWith(joinCall);
+  dispatcherCall->eraseFromParent();
+  ValueToValueMapTy clones;
+  SmallVector<BasicBlock *, 2> fillClones;
+  auto loopFunction = dispatchBB->getParent();
+  for (auto bb : fillBlocks) {
+    auto cloneBB = CloneBasicBlock(bb, clones, "", loopFunction);
+    clones[bb] = cloneBB;
+    fillClones.push_back(cloneBB);
+  }
+  remapInstructionsInBlocks(fillClones, clones);
+  auto fillHeaderClone = cast<BasicBlock>(clones[fillHeader]);
+  for (auto &phi : fillHeaderClone->phis()) {
+    auto index = phi.getBasicBlockIndex(drainBB);
+    phi.setIncomingBlock(index, dispatchBB);
+  }
+  fillHeaderClone->getTerminator()->replaceUsesOfWith(fillExit, waitBB);
+  dispatchBB->getTerminator()->replaceUsesOfWith(waitBB, fillHeaderClone);
+
+  /*
+   * The parallelized loop skips the fill, which it has run already.
+   * Hence, merge the values that come from the two versions of the loop.
+   * First, the PHIs of the exit of the loop (i.e., the live-out values).
+   */
+  parallelExitBB->getTerminator()->replaceUsesOfWith(drainBB, fillExit);
+  IRBuilder<> mergeBuilder{ fillExit->getFirstNonPHI() };
+  std::vector<PHINode *> drainPHIs;
+  for (auto &phi : drainBB->phis()) {
+    drainPHIs.push_back(&phi);
+  }
+  for (auto phi : drainPHIs) {
+    auto parallelValue = phi->getIncomingValueForBlock(parallelExitBB);
+    phi->removeIncomingValue(parallelExitBB, /*DeletePHIIfEmpty=*/false);
+    auto mergePHI = mergeBuilder.CreatePHI(phi->getType(), 2);
+    phi->replaceAllUsesWith(mergePHI);
+    mergePHI->addIncoming(phi, fillHeader);
+    mergePHI->addIncoming(parallelValue, parallelExitBB);
+  }
+
+  /*
+   * Second, the PHIs of the exit of the fill.
+   */
+  for (auto &phi : fillExit->phis()) {
+    if (phi.getBasicBlockIndex(parallelExitBB) >= 0) {
+      continue;
+    }
+    auto fillValue = phi.getIncomingValueForBlock(fillHeader);
+    if (clones.count(fillValue) > 0) {
+      fillValue = clones[fillValue];
+    }
+    phi.addIncoming(fillValue, parallelExitBB);
+  }
+
+  return true;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,314 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+#include "noelle/core/Outliner.hpp"
+#include "CallSiteTask.hpp"
+
+namespace llvm::noelle {
+
+bool Parallelizer::parallelizeCallSites(Module &M, Noelle &par) {
+  errs() << "Parallelizer:  Run independent calls in parallel\n";
+
+  /*
+   * Fetch the runtime.
+   */
+  auto dispatcher = M.getFunction("NOELLE_TaskDispatcherAsync");
+  auto joiner = M.getFunction("NOELLE_TaskJoin");
+  if (false || (dispatcher == nullptr) || (joiner == nullptr)) {
+    errs() << "Parallelizer:    The runtime does not run tasks of calls\n";
+    return false;
+  }
+
+  /*
+   * Select the calls of every function first, as running a call in parallel
+   * creates new functions.
+   */
+  std::vector<
+      std::pair<Function *, std::vector<std::pair<CallInst *, Instruction *>>>>
+      callsToRunInParallel;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    auto calls = this->getCallsToRunInParallel(&F, par);
+    if (calls.size() > 0) {
+      callsToRunInParallel.push_back({ &F, calls });
+    }
+  }
+
+  /*
+   * Run the calls in parallel.
+   */
+  auto modified = false;
+  for (auto &functionCalls : callsToRunInParallel) {
+    auto F = functionCalls.first;
+    auto functionModified = false;
+    for (auto &callJoinPair : functionCalls.second) {
+      auto call = callJoinPair.first;
+      errs() << "Parallelizer:    Run in parallel " << *call << "\n";
+      if (this->runCallInParallel(call,
+                                  callJoinPair.second,
+                                  par,
+                                  dispatcher,
+                                  joiner)) {
+        functionModified = true;
+      }
+    }
+
+    /*
+     * Update the dependences of the function.
+     */
+    if (functionModified) {
+      par.refreshDependences(F);
+      modified = true;
+    }
+  }
+
+  return modified;
+}
+
+std::vector<std::pair<CallInst *, Instruction *>> Parallelizer::
+    getCallsToRunInParallel(Function *F, Noelle &par) {
+  std::vector<std::pair<CallInst *, Instruction *>> calls;
+
+  /*
+   * Fetch the profiles.
+   * Calls are worth running in parallel only if they are heavy. This is known
+   * only from the profiles, unless the parallelization is forced.
+   */
+  auto profiles = par.getProfiles();
+  if (true && (!this->forceParallelization) && (!profiles->isAvailable())) {
+    return {};
+  }
+  auto minimumInstructionsPerInvocation = 2000;
+  auto isHeavy = [this, profiles, minimumInstructionsPerInvocation](
+                     Instruction *inst) -> bool {
+    auto call = dyn_cast<CallInst>(inst);
+    if (call == nullptr) {
+      return false;
+    }
+
+    /*
+     * Check the callee.
+     */
+    auto callee = call->getCalledFunction();
+    if (false || (callee == nullptr) || callee->empty()
+        || callee->isIntrinsic() || call->isMustTailCall()
+        || call->isInlineAsm()) {
+      return false;
+    }
+
+    /*
+     * Check the instructions executed per invocation of the call.
+     */
+    if (this->forceParallelization) {
+      return true;
+    }
+    auto invocations = profiles->getInvocations(call);
+    if (invocations == 0) {
+      return false;
+    }
+    auto instructionsPerInvocation =
+        profiles->getTotalInstructions(call) / invocations;
+    return (instructionsPerInvocation >= minimumInstructionsPerInvocation);
+  };
+
+  /*
+   * Check if the function has enough heavy calls to run at least two in
+   * parallel.
+   */
+  auto heavyCalls = 0;
+  for (auto &inst : instructions(*F)) {
+    if (isHeavy(&inst)) {
+      heavyCalls++;
+    }
+  }
+  if (heavyCalls < 2) {
+    return {};
+  }
+
+  /*
+   * Fetch the dependences of the function.
+   * They are recomputed as loops of the function might have been
+   * parallelized.
+   */
+  par.refreshDependences(F);
+  auto fdg = par.getFunctionDependenceGraph(F);
+
+  /*
+   * Select the calls to run in parallel.
+   */
+  for (auto &bb : *F) {
+    for (auto &inst : bb) {
+      if (!isHeavy(&inst)) {
+        continue;
+      }
+      auto call = cast<CallInst>(&inst);
+
+      /*
+       * The value returned by the call must not be used, as its task does not
+       * return it.
+       */
+      if (call->getNumUses() > 0) {
+        continue;
+      }
+
+      /*
+       * Fetch the instructions of the basic block that depend on the call.
+       * Memory dependences are considered in both directions.
+       */
+      std::unordered_set<Value *> dependences;
+      auto collectDependence = [&dependences](Value *v,
+                                              DGEdge<Value> *dep) -> bool {
+        dependences.insert(v);
+        return false;
+      };
+      fdg->iterateOverDependencesFrom(call,
+                                      true,
+                                      true,
+                                      true,
+                                      collectDependence);
+      fdg->iterateOverDependencesTo(call,
+                                    false,
+                                    true,
+                                    false,
+                                    collectDependence);
+
+      /*
+       * Find the first instruction after the call that depends on it.
+       * The task of the call runs in parallel with the code before it, and it
+       * is joined just before it.
+       */
+      Instruction *joinPoint = bb.getTerminator();
+      auto isThereAnotherHeavyCall = false;
+      for (auto nextInst = call->getNextNode(); nextInst != bb.getTerminator();
+           nextInst = nextInst->getNextNode()) {
+        if (dependences.count(nextInst) > 0) {
+          joinPoint = nextInst;
+          break;
+        }
+        if (isHeavy(nextInst)) {
+          isThereAnotherHeavyCall = true;
+        }
+      }
+
+      /*
+       * Check if another heavy call runs in parallel with the current one.
+       */
+      if (!isThereAnotherHeavyCall) {
+        continue;
+      }
+      calls.push_back({ call, joinPoint });
+    }
+  }
+
+  return calls;
+}
+
+bool Parallelizer::runCallInParallel(CallInst *call,
+                                     Instruction *joinPoint,
+                                     Noelle &par,
+                                     Function *dispatcher,
+                                     Function *joiner) {
+  auto F = call->getFunction();
+  auto &M = *F->getParent();
+  auto &cxt = M.getContext();
+
+  /*
+   * Outline the call.
+   * The new function receives the arguments of the call.
+   */
+  Outliner outliner;
+  auto nextInst = call->getNextNode();
+  auto outlinedF = outliner.outline({ call }, nextInst);
+  if (outlinedF == nullptr) {
+    return false;
+  }
+  auto outlinedCall = cast<CallInst>(nextInst->getPrevNode());
+
+  /*
+   * Create the task.
+   * It loads the arguments of the call from its environment, and it invokes
+   * the outlined function.
+   */
+  std::vector<Type *> envTypes;
+  for (auto &arg : outlinedF->args()) {
+    envTypes.push_back(arg.getType());
+  }
+  auto envType = StructType::get(cxt, envTypes);
+  auto int8Ptr = PointerType::getUnqual(par.int8);
+  auto taskSignature = FunctionType::get(Type::getVoidTy(cxt),
+                                         ArrayRef<Type *>({ int8Ptr }),
+                                         false);
+  CallSiteTask task{ taskSignature, M };
+  task.extractFuncArgs();
+  auto zeroV = ConstantInt::get(par.int32, 0);
+  IRBuilder<> taskBuilder{ task.getEntry() };
+  auto taskEnv = taskBuilder.CreateBitCast(task.getEnvironment(),
+                                           PointerType::getUnqual(envType));
+  std::vector<Value *> taskArgs;
+  for (auto i = 0u; i < envTypes.size(); i++) {
+    auto indexV = ConstantInt::get(par.int32, i);
+    auto argPtr = taskBuilder.CreateInBoundsGEP(
+        taskEnv,
+        ArrayRef<Value *>({ zeroV, indexV }));
+    taskArgs.push_back(taskBuilder.CreateLoad(argPtr));
+  }
+  taskBuilder.CreateCall(outlinedF, ArrayRef<Value *>(taskArgs));
+  taskBuilder.CreateBr(task.getExit());
+  IRBuilder<> exitBuilder{ task.getExit() };
+  exitBuilder.CreateRetVoid();
+
+  /*
+   * Allocate the environment of the task.
+   */
+  IRBuilder<> entryBuilder{ &*F->getEntryBlock().getFirstInsertionPt() };
+  auto env = entryBuilder.CreateAlloca(envType);
+
+  /*
+   * Dispatch the task instead of invoking the outlined function.
+   */
+  IRBuilder<> builder{ outlinedCall };
+  for (auto i = 0u; i < envTypes.size(); i++) {
+    auto indexV = ConstantInt::get(par.int32, i);
+    auto argPtr =
+        builder.CreateInBoundsGEP(env, ArrayRef<Value *>({ zeroV, indexV }));
+    builder.CreateStore(outlinedCall->getArgOperand(i), argPtr);
+  }
+  auto dispatcherType = dispatcher->getFunctionType();
+  auto taskPtr = builder.CreateBitCast(task.getTaskBody(),
+                                       dispatcherType->getParamType(0));
+  auto envPtr = builder.CreateBitCast(env, dispatcherType->getParamType(1));
+  auto handle =
+      builder.CreateCall(dispatcher, ArrayRef<Value *>({ taskPtr, envPtr }));
+  outlinedCall->eraseFromParent();
+
+  /*
+   * Join the task just before the first instruction that depends on the call.
+   */
+  IRBuilder<> joinBuilder{ joinPoint };
+  joinBuilder.CreateCall(joiner, ArrayRef<Value *>({ handle }));
+
+  return true;
+}
+
+} // namespace llvm::noelle
@@ -57,6 +57,63 @@ bool Parallelizer::collectThreadPoolHelperFunctionsAndTypes(Module &M,
   for (auto queueF : par.queues.queuePushes) {
     par.queues.queueTypes.push_back(queueF->arg_begin()->getType());
   }
+
+  /*
+   * Define the code to fetch optional functions of the runtime.
+   * If any of them is missing, then none of them is returned.
+   */
+  auto fetchOptionalFunctions =
+      [&M](std::string prefix) -> std::vector<Function *> {
+    std::vector<Function *> functions;
+    for (auto bits : { "8", "16", "32", "64" }) {
+      auto function = M.getFunction(prefix + bits);
+      if (function == nullptr) {
+        return {};
+      }
+      functions.push_back(function);
+    }
+    return functions;
+  };
+
+  /*
+   * Fetch the functions of batched queues.
+   */
+  auto batchedPushes = fetchOptionalFunctions("queueBatchedPush");
+  auto batchedPops = fetchOptionalFunctions("queueBatchedPop");
+  auto batchedFlushes = fetchOptionalFunctions("queueBatchedFlush");
+  if (true && (batchedPushes.size() > 0) && (batchedPops.size() > 0)
+      && (batchedFlushes.size() > 0)) {
+    par.queues.queueBatchedPushes = batchedPushes;
+    par.queues.queueBatchedPops = batchedPops;
+    par.queues.queueBatchedFlushes = batchedFlushes;
+    for (auto queueF : batchedPushes) {
+      par.queues.queueBatchedTypes.push_back(queueF->arg_begin()->getType());
+    }
+  }
+
+  /*
+   * Fetch the functions of single-producer single-consumer queues.
+   */
+  auto spscPushes = fetchOptionalFunctions("queueSPSCPush");
+  auto spscPops = fetchOptionalFunctions("queueSPSCPop");
+  if (true && (spscPushes.size() > 0) && (spscPops.size() > 0)) {
+    par.queues.queueSPSCPushes = spscPushes;
+    par.queues.queueSPSCPops = spscPops;
+    for (auto queueF : spscPushes) {
+      par.queues.queueSPSCTypes.push_back(queueF->arg_begin()->getType());
+    }
+  }
+
+  /*
+   * Fetch the functions of queues with slots of any number of bytes.
+   */
+  auto slotPush = M.getFunction("queueSlotPush");
+  auto slotPop = M.getFunction("queueSlotPop");
+  if (true && (slotPush != nullptr) && (slotPop != nullptr)) {
+    par.queues.queueSlotPush = slotPush;
+    par.queues.queueSlotPop = slotPop;
+    par.queues.queueSlotType = slotPush->arg_begin()->getType();
+  }
   par.queues.queueSizeToIndex = unordered_map<int, int>(
       { { 1, 0 }, { 8, 0 }, { 16, 1 }, { 32, 2 }, { 64, 3 } });
   par.queues.queueElementTypes =
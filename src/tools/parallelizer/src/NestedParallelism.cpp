@@ -0,0 +1,111 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+uint32_t Parallelizer::splitCoresIntoGroups(LoopDependenceInfo *LDI,
+                                            Noelle &par,
+                                            DOALL &doall,
+                                            Heuristics *h) {
+
+  /*
+   * Check if the planner selected the loop to run one of its nested loops on
+   * groups of cores.
+   */
+  auto mm = par.getMetadataManager();
+  auto ls = LDI->getLoopStructure();
+  if (!mm->doesHaveMetadata(ls, "noelle.parallelizer.nested")) {
+    return 0;
+  }
+  auto groups = mm->getIntegerMetadata(ls, "noelle.parallelizer.nested");
+
+  /*
+   * The groups are the tasks of DOALL, and each group needs at least two
+   * cores to run the nested loop in parallel.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  auto maxCores = ltm->getMaximumNumberOfCores();
+  if (false || (groups < 2) || ((maxCores / groups) < 2)
+      || (!par.isTransformationEnabled(DOALL_ID))
+      || (!ltm->isTransformationEnabled(DOALL_ID))
+      || (!doall.canBeAppliedToLoop(LDI, h))) {
+    return 0;
+  }
+
+  /*
+   * Give a core of each group to DOALL.
+   * The other cores of the group are reserved by the nested loop when its
+   * task runs it (see NoelleRuntime::enterParallelRegion).
+   */
+  ltm->setMaximumNumberOfCores(groups);
+
+  return maxCores / groups;
+}
+
+bool Parallelizer::parallelizeTheNestedLoop(Noelle &par,
+                                            Heuristics *h,
+                                            DOALL &doall,
+                                            uint32_t coresPerGroup) {
+
+  /*
+   * Update the dependences of the tasks.
+   */
+  auto taskFunction = doall.getTaskFunction();
+  par.refreshDependences(taskFunction);
+
+  /*
+   * Fetch the clone of the nested loop within the tasks.
+   * The clone keeps the metadata the planner tagged the nested loop with.
+   */
+  auto mm = par.getMetadataManager();
+  auto loops = par.getLoopStructures(taskFunction, 0);
+  LoopStructure *nestedLS = nullptr;
+  for (auto loop : *loops) {
+    if (mm->doesHaveMetadata(loop, "noelle.parallelizer.nested.inner")) {
+      nestedLS = loop;
+      break;
+    }
+  }
+  if (nestedLS == nullptr) {
+    delete loops;
+    return false;
+  }
+  auto optimizations = { LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+                         LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID };
+  auto nestedLDI = par.getLoop(nestedLS, optimizations);
+  delete loops;
+
+  /*
+   * Parallelize the nested loop on the cores of a group.
+   */
+  errs() << "Parallelizer:    Parallelize loop " << nestedLS->getID()
+         << " within the tasks of its parent\n";
+  nestedLDI->getLoopTransformationsManager()->setMaximumNumberOfCores(
+      coresPerGroup);
+  auto parallelized = this->parallelizeLoop(nestedLDI, par, h);
+  delete nestedLDI;
+
+  return parallelized;
+}
+
+} // namespace llvm::noelle
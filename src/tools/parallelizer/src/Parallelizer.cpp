@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "Parallelizer.hpp"
+#include "noelle/core/PhaseTimer.hpp"
 
 namespace llvm::noelle {
 
@@ -39,6 +40,7 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
    */
   DSWP dswp{ par, this->forceParallelization, !this->forceNoSCCPartition };
   DOALL doall{ par };
+  Wavefront wavefront{ par };
   HELIX helix{ par, this->forceParallelization };
 
   /*
@@ -59,6 +61,12 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
   auto loopFunction = loopStructure->getFunction();
   assert(par.verifyCode());
 
+  /*
+   * Split the cores into groups if each iteration of the loop runs one of its
+   * nested loops in parallel.
+   */
+  auto coresPerGroup = this->splitCoresIntoGroups(LDI, par, doall, h);
+
   /*
    * Print
    */
@@ -87,9 +95,25 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
     /*
      * Apply DOALL.
      */
-    codeModified = doall.apply(LDI, h);
+    {
+      PhaseTimer timer("doall-apply", "DOALL::apply");
+      codeModified = doall.apply(LDI, h);
+    }
     usedTechnique = &doall;
 
+  } else if (true && par.isTransformationEnabled(WAVEFRONT_ID)
+             && ltm->isTransformationEnabled(WAVEFRONT_ID)
+             && wavefront.canBeAppliedToLoop(LDI, h)) {
+
+    /*
+     * Apply Wavefront.
+     */
+    {
+      PhaseTimer timer("wavefront-apply", "Wavefront::apply");
+      codeModified = wavefront.apply(LDI, h);
+    }
+    usedTechnique = &wavefront;
+
   } else if (true && par.isTransformationEnabled(HELIX_ID)
              && ltm->isTransformationEnabled(HELIX_ID)
              && helix.canBeAppliedToLoop(LDI, h)) {
@@ -97,7 +121,10 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
     /*
      * Apply HELIX
      */
-    codeModified = helix.apply(LDI, h);
+    {
+      PhaseTimer timer("helix-apply", "HELIX::apply");
+      codeModified = helix.apply(LDI, h);
+    }
 
     auto function = helix.getTaskFunction();
     auto &LI = getAnalysis<LoopInfoWrapperPass>(*function).getLoopInfo();
@@ -117,7 +144,12 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
     }
 
     auto DS = par.getDominators(function);
-    auto l = LI.getLoopsInPreorder()[0];
+
+    /*
+     * The task can have other loops (e.g., the one of a decoupled prologue).
+     */
+    auto l = LI.getLoopFor(helix.getHeaderOfTheParallelizedLoop());
+    assert(l != nullptr);
     auto newLoops = par.getLoopStructures(function, 0);
     auto newForest = par.organizeLoopsInTheirNestingForest(*newLoops);
     auto newLoopNode = newForest->getInnermostLoopThatContains(l->getHeader());
@@ -132,7 +164,10 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
         par.canFloatsBeConsideredRealNumbers());
     newLDI->copyParallelizationOptionsFrom(LDI);
 
-    codeModified = helix.apply(newLDI, h);
+    {
+      PhaseTimer timer("helix-apply", "HELIX::apply");
+      codeModified = helix.apply(newLDI, h);
+    }
     usedTechnique = &helix;
 
   } else if (true && par.isTransformationEnabled(DSWP_ID)
@@ -142,7 +177,10 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
     /*
      * Apply DSWP.
      */
-    codeModified = dswp.apply(LDI, h);
+    {
+      PhaseTimer timer("dswp-apply", "DSWP::apply");
+      codeModified = dswp.apply(LDI, h);
+    }
     usedTechnique = &dswp;
   }
 
@@ -178,10 +216,17 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
   if (verbose != Verbosity::Disabled) {
     errs() << prefix << "  Link the parallelize loop\n";
   }
-  auto exitIndex =
-      ConstantInt::get(par.int64,
-                       LDI->getEnvironment()->indexOfExitBlockTaken());
+  auto exitBlockEnvIndex = LDI->getEnvironment()->indexOfExitBlockTaken();
+  auto exitIndex = ConstantInt::get(
+      par.int64,
+      (exitBlockEnvIndex >= 0)
+          ? usedTechnique->getCacheLineOfEnvironmentVariable(exitBlockEnvIndex)
+          : exitBlockEnvIndex);
   auto loopExitBlocks = loopStructure->getLoopExitBasicBlocks();
+  auto isAdaptive = (true && (usedTechnique == &doall)
+                     && (!doall.doesReduceDeterministically())
+                     && (!doall.doesScan())
+                     && this->canLoopBeAdaptive(LDI, par));
   par.linkTransformedLoopToOriginalFunction(loopFunction->getParent(),
                                             loopPreHeader,
                                             entryPoint,
@@ -189,6 +234,53 @@ bool Parallelizer::parallelizeLoop(LoopDependenceInfo *LDI,
                                             envArray,
                                             exitIndex,
                                             loopExitBlocks);
+  if (isAdaptive) {
+    if (verbose != Verbosity::Disabled) {
+      errs() << prefix << "  Select the version of the loop at run time\n";
+    }
+    this->makeLoopAdaptive(LDI, par, doall, loopPreHeader, loopExitBlocks);
+
+  } else if (true && (usedTechnique == &doall)
+             && this->overlapChunkWithTheFillOfTheNextOne(LDI,
+                                                          par,
+                                                          doall,
+                                                          exitPoint,
+                                                          loopExitBlocks)) {
+    if (verbose != Verbosity::Disabled) {
+      errs() << prefix
+             << "  The next chunk is collected while the loop runs\n";
+    }
+
+  } else if (true && this->asyncLoops && (usedTechnique == &doall)
+             && this->overlapLoopWithTheCodeAfterIt(LDI,
+                                                    par,
+                                                    doall,
+                                                    exitPoint,
+                                                    loopExitBlocks)) {
+    if (verbose != Verbosity::Disabled) {
+      errs() << prefix
+             << "  The code after the loop runs while the loop runs\n";
+    }
+  }
+
+  /*
+   * Parallelize the nested loop within the tasks of the loop.
+   */
+  if (true && (coresPerGroup > 0) && (usedTechnique == &doall)
+      && this->parallelizeTheNestedLoop(par, h, doall, coresPerGroup)) {
+    if (verbose != Verbosity::Disabled) {
+      errs() << prefix << "  Each task runs its nested loop on "
+             << coresPerGroup << " cores\n";
+    }
+  }
+
+  /*
+   * Let the tasks allocate memory from the runtime.
+   */
+  if (true && this->taskAllocator
+      && this->redirectAllocationsOfTheTasks(usedTechnique, par)) {
+    this->tasksAllocateFromTheRuntime = true;
+  }
   assert(par.verifyCode());
   // if (verbose >= Verbosity::Maximal) {
   //   loopFunction->print(errs() << "Final printout:\n"); errs() << "\n";
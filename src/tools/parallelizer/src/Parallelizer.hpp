@@ -31,6 +31,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/ScalarEvolution.h"
@@ -50,6 +51,7 @@
 #include "HeuristicsPass.hpp"
 #include "DSWP.hpp"
 #include "DOALL.hpp"
+#include "Wavefront.hpp"
 #include "HELIX.hpp"
 
 namespace llvm::noelle {
@@ -75,17 +77,184 @@ private:
    */
   bool forceParallelization;
   bool forceNoSCCPartition;
+  std::string variantsFileName;
+  std::string variantsPrefix;
+  bool adaptiveLoops;
+  bool asyncLoops;
+  bool parallelizeCalls;
+  bool parallelizeRecursion;
+  bool prefetchLoops;
+  bool taskAllocator;
+  bool tasksAllocateFromTheRuntime;
 
   /*
    * Methods
    */
   bool parallelizeLoop(LoopDependenceInfo *LDI, Noelle &par, Heuristics *h);
 
+  /*
+   * Unroll the loop by the factor selected by its loop transformations
+   * manager. The LoopDependenceInfo of the unrolled loop is returned, or
+   * nullptr if the loop has not been unrolled.
+   */
+  LoopDependenceInfo *unrollLoop(LoopDependenceInfo *LDI, Noelle &par);
+
+  bool parallelizeLoops(
+      Module &M,
+      Noelle &par,
+      Heuristics *h,
+      std::map<uint32_t, LoopDependenceInfo *> const &loopParallelizationOrder);
+
+  /*
+   * Generate a parallelized variant of the module per configuration of the
+   * file variantsFileName.
+   * The loops are analyzed only once, before generating the variants.
+   */
+  void generateVariants(
+      Module &M,
+      Noelle &par,
+      Heuristics *h,
+      std::map<uint32_t, LoopDependenceInfo *> const &loopParallelizationOrder);
+
   std::vector<LoopDependenceInfo *> getLoopsToParallelize(Module &M,
                                                           Noelle &par);
 
   bool collectThreadPoolHelperFunctionsAndTypes(Module &M, Noelle &par);
 
+  bool addPersistentRegions(Module &M, Noelle &par);
+
+  /*
+   * Adaptive loops select at run time whether to run sequentially or in
+   * parallel, and with which chunk size, based on the cycles taken by their
+   * previous invocations.
+   */
+  bool canLoopBeAdaptive(LoopDependenceInfo *LDI, Noelle &par) const;
+
+  void makeLoopAdaptive(LoopDependenceInfo *LDI,
+                        Noelle &par,
+                        DOALL &doall,
+                        BasicBlock *loopPreHeader,
+                        std::vector<BasicBlock *> &loopExitBlocks);
+
+  /*
+   * Asynchronous loops are dispatched without waiting for their tasks, so the
+   * code after them that does not depend on them runs while they run. The
+   * loop is joined right before the first instruction that depends on it.
+   */
+  std::vector<Instruction *> getInstructionsThatCanOverlapWithTheLoop(
+      LoopDependenceInfo *LDI,
+      Noelle &par,
+      BasicBlock *exitPoint) const;
+
+  bool overlapLoopWithTheCodeAfterIt(LoopDependenceInfo *LDI,
+                                     Noelle &par,
+                                     DOALL &doall,
+                                     BasicBlock *exitPoint,
+                                     std::vector<BasicBlock *> &loopExitBlocks);
+
+  /*
+   * A loop over the nodes of a chunk of a list is dispatched without waiting
+   * for its tasks, so the nodes of the next chunk are collected while they
+   * run (see LoopTransformer::chunkPointerChasingLoop).
+   */
+  bool overlapChunkWithTheFillOfTheNextOne(
+      LoopDependenceInfo *LDI,
+      Noelle &par,
+      DOALL &doall,
+      BasicBlock *exitPoint,
+      std::vector<BasicBlock *> &loopExitBlocks);
+
+  /*
+   * Heavy calls run in parallel with the code after them, up to the first
+   * instruction of their basic block that depends on them, if this code
+   * includes another heavy call. Each call is outlined, and the task that
+   * invokes the outlined function is joined just before that instruction.
+   */
+  bool parallelizeCallSites(Module &M, Noelle &par);
+
+  std::vector<std::pair<CallInst *, Instruction *>> getCallsToRunInParallel(
+      Function *F,
+      Noelle &par);
+
+  bool runCallInParallel(CallInst *call,
+                         Instruction *joinPoint,
+                         Noelle &par,
+                         Function *dispatcher,
+                         Function *joiner);
+
+  /*
+   * Recursive calls are spawned as tasks if the code after them, up to the
+   * first instruction of their basic block that depends on them, includes
+   * another recursive call. The task is synchronized just before that
+   * instruction. The runtime decides how deep the recursion spawns tasks.
+   */
+  bool parallelizeRecursiveFunctions(Module &M, Noelle &par);
+
+  std::vector<std::pair<CallInst *, Instruction *>> getRecursiveCallsToSpawn(
+      Function *F,
+      Noelle &par,
+      std::function<bool(Function *)> isRecursive);
+
+  void spawnRecursiveCall(CallInst *call,
+                          Instruction *syncPoint,
+                          Noelle &par,
+                          Function *spawner,
+                          Function *syncer);
+
+  /*
+   * Hot sequential loops run with a helper thread on the SMT sibling of their
+   * core. At every iteration, the helper computes the addresses of the loads
+   * the loop runs a few iterations later, and it prefetches them. Only the
+   * addresses with a slice that does not depend on loaded data, and that the
+   * hardware prefetchers are unlikely to fetch, are prefetched.
+   */
+  bool prefetchForSequentialLoops(Module &M,
+                                  Noelle &par,
+                                  StayConnectedNestedLoopForest *forest);
+
+  std::unordered_map<PHINode *, InductionVariable *>
+  getInductionVariablesToRecompute(LoopDependenceInfo *LDI) const;
+
+  std::vector<LoadInst *> getLoadsToPrefetch(
+      LoopDependenceInfo *LDI,
+      std::unordered_set<BasicBlock *> const &nestedBlocks);
+
+  bool addHelperPrefetcher(LoopDependenceInfo *LDI,
+                           std::vector<LoadInst *> const &loads,
+                           Noelle &par,
+                           Function *starter,
+                           Function *throttle,
+                           Function *stopper);
+
+  /*
+   * Loops tagged by the planner with a number of groups of cores run their
+   * iterations with DOALL on that many cores. Each of their tasks then runs the
+   * nested loop tagged by the planner on the cores of its group.
+   * The number of cores per group is returned, or 0 if @LDI does not run one of
+   * its nested loops this way.
+   */
+  uint32_t splitCoresIntoGroups(LoopDependenceInfo *LDI,
+                                Noelle &par,
+                                DOALL &doall,
+                                Heuristics *h);
+
+  bool parallelizeTheNestedLoop(Noelle &par,
+                                Heuristics *h,
+                                DOALL &doall,
+                                uint32_t coresPerGroup);
+
+  /*
+   * Tasks allocate from the thread-caching allocator of the runtime, which
+   * keeps a cache of free blocks per thread. Blocks freed by a thread other
+   * than their allocator go back to the cache of their allocator.
+   * As blocks allocated by the tasks can escape them, every call of the
+   * module that frees or resizes a block goes through the runtime as well.
+   */
+  bool redirectAllocationsOfTheTasks(ParallelizationTechnique *technique,
+                                     Noelle &par);
+
+  bool redirectDeallocationsToTheRuntime(Module &M, Noelle &par);
+
   /*
    * Debug utilities
    */
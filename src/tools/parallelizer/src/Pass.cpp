@@ -36,11 +36,69 @@ static cl::opt<bool> ForceNoSCCPartition(
     cl::ZeroOrMore,
     cl::Hidden,
     cl::desc("Force no SCC merging when parallelizing"));
+static cl::opt<std::string> VariantsConfigurations(
+    "noelle-parallelizer-variants",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File with one configuration per line (in the format of "
+             "INDEX_FILE): the module is analyzed once and a parallelized "
+             "variant is generated per configuration"));
+static cl::opt<std::string> VariantsPrefix(
+    "noelle-parallelizer-variants-prefix",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init("variant_"),
+    cl::desc("Prefix of the bitcode files of the variants"));
+static cl::opt<bool> AdaptiveLoops(
+    "noelle-parallelizer-adaptive",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Let DOALL loops select at run time whether to run sequentially "
+             "or in parallel and their chunk size"));
+static cl::opt<bool> AsyncLoops(
+    "noelle-parallelizer-async",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Dispatch DOALL loops without waiting for them, and wait for "
+             "them at the first instruction after them that depends on them"));
+static cl::opt<bool> ParallelizeCalls(
+    "noelle-parallelizer-calls",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Run heavy calls in parallel with the independent heavy calls "
+             "that follow them"));
+static cl::opt<bool> ParallelizeRecursion(
+    "noelle-parallelizer-recursion",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Spawn the independent recursive calls of recursive functions as "
+             "tasks"));
+static cl::opt<bool> PrefetchLoops(
+    "noelle-parallelizer-prefetch",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Run hot sequential loops with a helper thread that prefetches "
+             "the addresses they load"));
+static cl::opt<bool> TaskAllocator(
+    "noelle-parallelizer-task-allocator",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Let the tasks of parallelized loops allocate memory from the "
+             "thread-caching allocator of the runtime"));
 
 Parallelizer::Parallelizer()
   : ModulePass{ ID },
     forceParallelization{ false },
-    forceNoSCCPartition{ false } {
+    forceNoSCCPartition{ false },
+    variantsFileName{},
+    variantsPrefix{},
+    adaptiveLoops{ false },
+    asyncLoops{ false },
+    parallelizeCalls{ false },
+    parallelizeRecursion{ false },
+    prefetchLoops{ false },
+    taskAllocator{ false },
+    tasksAllocateFromTheRuntime{ false } {
 
   return;
 }
@@ -48,6 +106,14 @@ Parallelizer::Parallelizer()
 bool Parallelizer::doInitialization(Module &M) {
   this->forceParallelization = (ForceParallelization.getNumOccurrences() > 0);
   this->forceNoSCCPartition = (ForceNoSCCPartition.getNumOccurrences() > 0);
+  this->variantsFileName = VariantsConfigurations.getValue();
+  this->variantsPrefix = VariantsPrefix.getValue();
+  this->adaptiveLoops = (AdaptiveLoops.getNumOccurrences() > 0);
+  this->asyncLoops = (AsyncLoops.getNumOccurrences() > 0);
+  this->parallelizeCalls = (ParallelizeCalls.getNumOccurrences() > 0);
+  this->parallelizeRecursion = (ParallelizeRecursion.getNumOccurrences() > 0);
+  this->prefetchLoops = (PrefetchLoops.getNumOccurrences() > 0);
+  this->taskAllocator = (TaskAllocator.getNumOccurrences() > 0);
 
   return false;
 }
@@ -94,8 +160,18 @@ bool Parallelizer::runOnModule(Module &M) {
      */
     delete programLoops;
 
+    /*
+     * Run the independent calls in parallel.
+     */
+    auto modified = (true && this->parallelizeCalls
+                     && this->parallelizeCallSites(M, noelle));
+    if (true && this->parallelizeRecursion
+        && this->parallelizeRecursiveFunctions(M, noelle)) {
+      modified = true;
+    }
+
     errs() << "Parallelizer: Exit\n";
-    return false;
+    return modified;
   }
   errs() << "Parallelizer:    There are " << programLoops->size()
          << " loops in the program we are going to consider\n";
@@ -107,9 +183,9 @@ bool Parallelizer::runOnModule(Module &M) {
    * Determine the parallelization order from the metadata.
    */
   auto mm = noelle.getMetadataManager();
-  std::map<uint32_t, LoopDependenceInfo *> loopParallelizationOrder;
+  std::map<uint32_t, LoopStructure *> loopsToParallelize;
   for (auto tree : forest->getTrees()) {
-    auto selector = [&noelle, &mm, &loopParallelizationOrder](
+    auto selector = [&mm, &loopsToParallelize](
                         StayConnectedNestedLoopForestNode *n,
                         uint32_t treeLevel) -> bool {
       auto ls = n->getLoop();
@@ -117,22 +193,104 @@ bool Parallelizer::runOnModule(Module &M) {
         return false;
       }
       auto parallelizationOrderIndex =
-          std::stoi(mm->getMetadata(ls, "noelle.parallelizer.looporder"));
-      auto optimizations = {
-        LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
-        LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID
-      };
-      auto ldi = noelle.getLoop(ls, optimizations);
-      loopParallelizationOrder[parallelizationOrderIndex] = ldi;
+          mm->getIntegerMetadata(ls, "noelle.parallelizer.looporder");
+      loopsToParallelize[parallelizationOrderIndex] = ls;
       return false;
     };
     tree->visitPreOrder(selector);
   }
 
+  /*
+   * Compute the abstractions of the loops to parallelize.
+   * The dependence graphs of their functions are computed in parallel.
+   */
+  std::vector<LoopStructure *> loopsInOrder;
+  for (auto indexLoopPair : loopsToParallelize) {
+    loopsInOrder.push_back(indexLoopPair.second);
+  }
+  std::unordered_set<LoopDependenceInfoOptimization> optimizations = {
+    LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+    LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID
+  };
+  if (noelle.canLoopsBufferTheirOutput()) {
+    optimizations.insert(LoopDependenceInfoOptimization::BUFFERED_OUTPUT_ID);
+  }
+  auto ldis = noelle.getLoops(loopsInOrder, optimizations);
+  std::map<uint32_t, LoopDependenceInfo *> loopParallelizationOrder;
+  auto nextLDI = 0u;
+  for (auto indexLoopPair : loopsToParallelize) {
+    loopParallelizationOrder[indexLoopPair.first] = ldis[nextLDI];
+    nextLDI++;
+  }
+
+  /*
+   * Check if we need to generate variants of the program rather than
+   * parallelizing it.
+   */
+  if (this->variantsFileName != "") {
+    this->generateVariants(M, noelle, heuristics, loopParallelizationOrder);
+    for (auto indexLoopPair : loopParallelizationOrder) {
+      delete indexLoopPair.second;
+    }
+    errs() << "Parallelizer: Exit\n";
+    return false;
+  }
+
+  /*
+   * Parallelize the loops in order.
+   */
+  auto modified =
+      this->parallelizeLoops(M, noelle, heuristics, loopParallelizationOrder);
+
+  /*
+   * Prefetch for the hot loops that still run sequentially.
+   */
+  if (true && this->prefetchLoops
+      && this->prefetchForSequentialLoops(M, noelle, forest)) {
+    modified = true;
+  }
+
+  /*
+   * Run the independent calls in parallel.
+   * This is done after parallelizing the loops, as the tasks of the calls would
+   * add dependences to the loops that include them.
+   */
+  if (true && this->parallelizeCalls && this->parallelizeCallSites(M, noelle)) {
+    modified = true;
+  }
+
+  /*
+   * Spawn the independent recursive calls.
+   * Calls run in parallel by the previous step are outlined, so they are not
+   * spawned again.
+   */
+  if (true && this->parallelizeRecursion
+      && this->parallelizeRecursiveFunctions(M, noelle)) {
+    modified = true;
+  }
+
+  /*
+   * Free the memory.
+   */
+  for (auto indexLoopPair : loopParallelizationOrder) {
+    delete indexLoopPair.second;
+  }
+
+  errs() << "Parallelizer: Exit\n";
+  return modified;
+}
+
+bool Parallelizer::parallelizeLoops(
+    Module &M,
+    Noelle &noelle,
+    Heuristics *heuristics,
+    std::map<uint32_t, LoopDependenceInfo *> const &loopParallelizationOrder) {
+
   /*
    * Parallelize the loops in order.
    */
   auto modified = false;
+  this->tasksAllocateFromTheRuntime = false;
   std::unordered_map<BasicBlock *, bool> modifiedBBs{};
   for (auto indexLoopPair : loopParallelizationOrder) {
     auto ldi = indexLoopPair.second;
@@ -156,10 +314,24 @@ bool Parallelizer::runOnModule(Module &M) {
       continue;
     }
 
+    /*
+     * Unroll the current loop if this has been requested.
+     * The loop is then parallelized in its unrolled form.
+     */
+    auto unrolledLDI = this->unrollLoop(ldi, noelle);
+    if (unrolledLDI != nullptr) {
+      modified = true;
+      for (auto bb : ls->getBasicBlocks()) {
+        modifiedBBs[bb] = true;
+      }
+    }
+    auto ldiToParallelize = (unrolledLDI != nullptr) ? unrolledLDI : ldi;
+
     /*
      * Parallelize the current loop.
      */
-    auto loopIsParallelized = this->parallelizeLoop(ldi, noelle, heuristics);
+    auto loopIsParallelized =
+        this->parallelizeLoop(ldiToParallelize, noelle, heuristics);
 
     /*
      * Keep track of the parallelization.
@@ -172,16 +344,27 @@ bool Parallelizer::runOnModule(Module &M) {
         modifiedBBs[bb] = true;
       }
     }
+
+    /*
+     * Free the memory.
+     */
+    delete unrolledLDI;
   }
 
   /*
-   * Free the memory.
+   * Blocks allocated by the tasks must be freed through the runtime.
    */
-  for (auto indexLoopPair : loopParallelizationOrder) {
-    delete indexLoopPair.second;
+  if (this->tasksAllocateFromTheRuntime) {
+    this->redirectDeallocationsToTheRuntime(M, noelle);
+  }
+
+  /*
+   * Keep the threads awake across adjacent invocations of parallelized loops.
+   */
+  if (modified && this->addPersistentRegions(M, noelle)) {
+    errs() << "Parallelizer:    Persistent regions have been added\n";
   }
 
-  errs() << "Parallelizer: Exit\n";
   return modified;
 }
 
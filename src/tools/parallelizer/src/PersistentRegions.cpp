@@ -0,0 +1,199 @@
+/*
+ * Copyright 2016 - 2021  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+bool Parallelizer::addPersistentRegions(Module &M, Noelle &par) {
+
+  /*
+   * Fetch the runtime functions that open and close a persistent region.
+   * These are optional: if they are missing, then every parallelized loop
+   * dispatches its own threads.
+   */
+  auto beginRegion = M.getFunction("NOELLE_beginPersistentRegion");
+  auto endRegion = M.getFunction("NOELLE_endPersistentRegion");
+  if (false || (beginRegion == nullptr) || (endRegion == nullptr)) {
+    return false;
+  }
+
+  /*
+   * Fetch the dispatchers of the parallelized loops.
+   * Only DOALL loops run on the team of a persistent region. The other
+   * techniques reserve their own cores, so regions that include them would
+   * leave the team idle while starving them.
+   */
+  std::unordered_set<Function *> doallDispatchers;
+  for (auto name : { "NOELLE_DOALLDispatcher",
+                     "NOELLE_DOALLDispatcherWithScheduling",
+                     "NOELLE_DOALLDispatcherWithTripCount",
+                     "NOELLE_DOALLDispatcherWithCancellation",
+                     "NOELLE_DOALLDispatcherWithSpeculation",
+                     "NOELLE_DOALLDispatcherWithInspection" }) {
+    auto dispatcher = M.getFunction(name);
+    if (dispatcher != nullptr) {
+      doallDispatchers.insert(dispatcher);
+    }
+  }
+  std::unordered_set<Function *> otherDispatchers;
+  for (auto name : { "NOELLE_HELIX_dispatcher_sequentialSegments",
+                     "NOELLE_HELIX_dispatcher_criticalSections",
+                     "NOELLE_HELIX_dispatcher_dynamicSequentialSegments",
+                     "NOELLE_DSWPDispatcher",
+                     "NOELLE_DSWPDispatcherWithPlacement",
+                     "NOELLE_DSWPDispatcherWithReplicas" }) {
+    auto dispatcher = M.getFunction(name);
+    if (dispatcher != nullptr) {
+      otherDispatchers.insert(dispatcher);
+    }
+  }
+
+  /*
+   * Add the persistent regions function by function.
+   */
+  auto tm = par.getTypesManager();
+  auto modified = false;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+
+    /*
+     * Fetch the invocations of parallelized loops.
+     */
+    std::vector<CallInst *> invocations;
+    for (auto &BB : F) {
+      for (auto &I : BB) {
+        auto callInst = dyn_cast<CallInst>(&I);
+        if (callInst == nullptr) {
+          continue;
+        }
+        auto callee = callInst->getCalledFunction();
+        if (false || (doallDispatchers.count(callee) > 0)
+            || (otherDispatchers.count(callee) > 0)) {
+          invocations.push_back(callInst);
+        }
+      }
+    }
+    if (invocations.size() == 0) {
+      continue;
+    }
+
+    /*
+     * Group the invocations by the outermost loop that includes them.
+     * Invocations not included in any loop are grouped together (the group
+     * is identified by nullptr).
+     * The loops of the function need to be computed again because the code
+     * has been modified by the parallelization.
+     */
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+    std::vector<Loop *> regionLoops;
+    std::unordered_map<Loop *, std::vector<CallInst *>> regionInvocations;
+    for (auto callInst : invocations) {
+      auto loop = LI.getLoopFor(callInst->getParent());
+      while ((loop != nullptr) && (loop->getParentLoop() != nullptr)) {
+        loop = loop->getParentLoop();
+      }
+      if (regionInvocations.find(loop) == regionInvocations.end()) {
+        regionLoops.push_back(loop);
+      }
+      regionInvocations[loop].push_back(callInst);
+    }
+
+    /*
+     * Add the regions.
+     */
+    for (auto loop : regionLoops) {
+      auto &calls = regionInvocations[loop];
+
+      /*
+       * Check if the region is worth it.
+       * This is the case if it includes several invocations of DOALL loops,
+       * or if it includes one within a loop (i.e., it is invoked repeatedly).
+       */
+      auto isWorthIt = (false || (calls.size() > 1) || (loop != nullptr));
+      uint64_t maxCores = 0;
+      for (auto callInst : calls) {
+        if (doallDispatchers.count(callInst->getCalledFunction()) == 0) {
+          isWorthIt = false;
+          break;
+        }
+        auto cores = dyn_cast<ConstantInt>(callInst->getArgOperand(2));
+        if (cores == nullptr) {
+          isWorthIt = false;
+          break;
+        }
+        maxCores = std::max(maxCores, cores->getZExtValue());
+      }
+      if (!isWorthIt) {
+        continue;
+      }
+      auto maxCoresValue = ConstantInt::get(tm->getIntegerType(64), maxCores);
+
+      /*
+       * Open the region before the loop and close it at its exits.
+       * The exits must be reachable only from the loop; otherwise, the region
+       * would be closed without having been opened.
+       */
+      if (loop != nullptr) {
+        auto preHeader = loop->getLoopPreheader();
+        if (false || (preHeader == nullptr) || (!loop->hasDedicatedExits())) {
+          continue;
+        }
+        IRBuilder<> beginBuilder{ preHeader->getTerminator() };
+        beginBuilder.CreateCall(beginRegion,
+                                ArrayRef<Value *>({ maxCoresValue }));
+        SmallVector<BasicBlock *, 4> exitBlocks;
+        loop->getUniqueExitBlocks(exitBlocks);
+        for (auto exitBlock : exitBlocks) {
+          IRBuilder<> endBuilder{ &*exitBlock->getFirstInsertionPt() };
+          endBuilder.CreateCall(endRegion);
+        }
+        modified = true;
+        continue;
+      }
+
+      /*
+       * The invocations are not included in a loop.
+       * Open the region when the function starts and close it when the
+       * function returns.
+       */
+      IRBuilder<> beginBuilder{ F.getEntryBlock().getTerminator() };
+      beginBuilder.CreateCall(beginRegion,
+                              ArrayRef<Value *>({ maxCoresValue }));
+      for (auto &BB : F) {
+        auto terminator = BB.getTerminator();
+        if (false || isa<ReturnInst>(terminator)
+            || isa<ResumeInst>(terminator)) {
+          IRBuilder<> endBuilder{ terminator };
+          endBuilder.CreateCall(endRegion);
+        }
+      }
+      modified = true;
+    }
+  }
+
+  return modified;
+}
+
+} // namespace llvm::noelle
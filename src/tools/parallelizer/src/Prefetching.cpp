@@ -0,0 +1,563 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+#include "PrefetcherTask.hpp"
+
+namespace llvm::noelle {
+
+bool Parallelizer::prefetchForSequentialLoops(
+    Module &M,
+    Noelle &par,
+    StayConnectedNestedLoopForest *forest) {
+  errs() << "Parallelizer:  Prefetch for sequential loops\n";
+
+  /*
+   * Fetch the runtime.
+   */
+  auto starter = M.getFunction("NOELLE_prefetcherStart");
+  auto throttle = M.getFunction("NOELLE_prefetcherThrottle");
+  auto stopper = M.getFunction("NOELLE_prefetcherStop");
+  if (false || (starter == nullptr) || (throttle == nullptr)
+      || (stopper == nullptr)) {
+    errs() << "Parallelizer:    The runtime does not run helper prefetchers\n";
+    return false;
+  }
+
+  /*
+   * Fetch the profiles.
+   * A helper thread is started at every invocation of its loop, so only loops
+   * that run long enough per invocation are worth it. This is known only from
+   * the profiles, unless the parallelization is forced.
+   */
+  auto profiles = par.getProfiles();
+  if (true && (!this->forceParallelization) && (!profiles->isAvailable())) {
+    errs() << "Parallelizer:    The profiles are not available\n";
+    return false;
+  }
+  auto minimumInstructionsPerInvocation = 100000;
+  auto minimumHotness = par.getMinimumHotness();
+  auto isHot = [this,
+                profiles,
+                minimumInstructionsPerInvocation,
+                minimumHotness](LoopStructure *ls) -> bool {
+    if (this->forceParallelization) {
+      return true;
+    }
+    if (profiles->getDynamicTotalInstructionCoverage(ls) < minimumHotness) {
+      return false;
+    }
+    return (profiles->getAverageTotalInstructionsPerInvocation(ls)
+            >= minimumInstructionsPerInvocation);
+  };
+
+  /*
+   * Select the loops.
+   * Loops selected for parallelization, and the loops that include them, do
+   * not run sequentially. Among the others, the outermost hot loop with
+   * addresses worth prefetching is selected.
+   */
+  auto mm = par.getMetadataManager();
+  auto isParallelized = [mm](StayConnectedNestedLoopForestNode *n) -> bool {
+    return mm->doesHaveMetadata(n->getLoop(), "noelle.parallelizer.looporder");
+  };
+  std::set<Function *> refreshedFunctions;
+  std::vector<std::pair<LoopDependenceInfo *, std::vector<LoadInst *>>>
+      loopsToPrefetch;
+  std::function<void(StayConnectedNestedLoopForestNode *)> selectLoops;
+  selectLoops = [&](StayConnectedNestedLoopForestNode *n) {
+    if (isParallelized(n)) {
+      return;
+    }
+    auto descendants = n->getDescendants();
+    auto isAnyNestedLoopParallelized =
+        std::any_of(descendants.begin(), descendants.end(), isParallelized);
+    auto ls = n->getLoop();
+    if (true && (!isAnyNestedLoopParallelized) && isHot(ls)) {
+
+      /*
+       * Fetch the loop.
+       * Its dependences are recomputed as other loops of its function might
+       * have been parallelized.
+       */
+      auto F = ls->getFunction();
+      if (refreshedFunctions.count(F) == 0) {
+        par.refreshDependences(F);
+        refreshedFunctions.insert(F);
+      }
+      auto ldi = par.getLoop(ls);
+
+      /*
+       * Fetch the blocks of the nested loops.
+       * Their loads do not run once per iteration of the loop.
+       */
+      std::unordered_set<BasicBlock *> nestedBlocks;
+      for (auto d : descendants) {
+        auto bbs = d->getLoop()->getBasicBlocks();
+        nestedBlocks.insert(bbs.begin(), bbs.end());
+      }
+      auto loads = this->getLoadsToPrefetch(ldi, nestedBlocks);
+      if (loads.size() > 0) {
+        loopsToPrefetch.push_back({ ldi, loads });
+        return;
+      }
+      delete ldi;
+    }
+    for (auto child : n->getChildren()) {
+      selectLoops(child);
+    }
+  };
+  for (auto tree : forest->getTrees()) {
+    selectLoops(tree);
+  }
+
+  /*
+   * Add the helper prefetchers.
+   */
+  auto modified = false;
+  for (auto &loopLoadsPair : loopsToPrefetch) {
+    auto ldi = loopLoadsPair.first;
+    auto ls = ldi->getLoopStructure();
+    errs() << "Parallelizer:    Loop " << ls->getID() << " prefetches "
+           << loopLoadsPair.second.size() << " loads\n";
+    if (this->addHelperPrefetcher(ldi,
+                                  loopLoadsPair.second,
+                                  par,
+                                  starter,
+                                  throttle,
+                                  stopper)) {
+      modified = true;
+    }
+    delete ldi;
+  }
+
+  return modified;
+}
+
+std::unordered_map<PHINode *, InductionVariable *> Parallelizer::
+    getInductionVariablesToRecompute(LoopDependenceInfo *LDI) const {
+  std::unordered_map<PHINode *, InductionVariable *> ivs;
+
+  /*
+   * The helper computes the value of an induction variable at iteration k as
+   * start + k * step, so the step must be known before the loop starts.
+   */
+  auto ls = LDI->getLoopStructure();
+  auto ivManager = LDI->getInductionVariableManager();
+  for (auto iv : ivManager->getInductionVariables(*ls)) {
+    auto phi = iv->getLoopEntryPHI();
+    auto step = iv->getSingleComputedStepValue();
+    if (false || (phi->getParent() != ls->getHeader())
+        || (!phi->getType()->isIntegerTy()) || (step == nullptr)
+        || (step->getType() != phi->getType())) {
+      continue;
+    }
+    auto stepInst = dyn_cast<Instruction>(step);
+    if (true && (stepInst != nullptr) && ls->isIncluded(stepInst)) {
+      continue;
+    }
+    ivs[phi] = iv;
+  }
+
+  return ivs;
+}
+
+std::vector<LoadInst *> Parallelizer::getLoadsToPrefetch(
+    LoopDependenceInfo *LDI,
+    std::unordered_set<BasicBlock *> const &nestedBlocks) {
+  auto ls = LDI->getLoopStructure();
+  auto ivs = this->getInductionVariablesToRecompute(LDI);
+
+  /*
+   * Check that the helper can be stopped at every exit of the loop.
+   */
+  auto exitBlocks = ls->getLoopExitBasicBlocks();
+  if (exitBlocks.size() == 0) {
+    return {};
+  }
+  for (auto exitBB : exitBlocks) {
+    for (auto predBB : predecessors(exitBB)) {
+      if (!ls->isIncluded(predBB)) {
+        return {};
+      }
+    }
+  }
+
+  /*
+   * Define the code that checks whether the helper can compute a value of an
+   * iteration.
+   * The slice of an address can include only instructions without side
+   * effects that cannot trap, and it cannot depend on loaded data. Its roots
+   * are values defined outside the loop and induction variables.
+   */
+  std::unordered_map<Instruction *, bool> computable;
+  std::function<bool(Value *)> canBeComputed;
+  canBeComputed = [&](Value *v) -> bool {
+    auto inst = dyn_cast<Instruction>(v);
+    if (false || (inst == nullptr) || (!ls->isIncluded(inst))) {
+      return true;
+    }
+    if (computable.count(inst) > 0) {
+      return computable[inst];
+    }
+    computable[inst] = false;
+    auto canInstBeComputed = false;
+    if (auto phi = dyn_cast<PHINode>(inst)) {
+      canInstBeComputed = (ivs.count(phi) > 0);
+
+    } else if (nestedBlocks.count(inst->getParent()) == 0) {
+      auto isSafe = false;
+      if (auto binOp = dyn_cast<BinaryOperator>(inst)) {
+        isSafe = true;
+        switch (binOp->getOpcode()) {
+          case Instruction::UDiv:
+          case Instruction::SDiv:
+          case Instruction::URem:
+          case Instruction::SRem: {
+            auto divisor = dyn_cast<ConstantInt>(binOp->getOperand(1));
+            isSafe = (true && (divisor != nullptr) && (!divisor->isZero())
+                      && (!divisor->isMinusOne()));
+            break;
+          }
+          default:
+            break;
+        }
+      } else if (false || isa<CastInst>(inst) || isa<GetElementPtrInst>(inst)
+                 || isa<CmpInst>(inst) || isa<SelectInst>(inst)) {
+        isSafe = true;
+      }
+      canInstBeComputed = isSafe;
+      for (auto &op : inst->operands()) {
+        if (!canInstBeComputed) {
+          break;
+        }
+        canInstBeComputed = canBeComputed(op.get());
+      }
+    }
+    computable[inst] = canInstBeComputed;
+
+    return canInstBeComputed;
+  };
+
+  /*
+   * Define the code that checks whether the hardware prefetchers are likely to
+   * miss an address.
+   * They catch the strided accesses, which are the ones with addresses that
+   * are affine functions of the induction variables.
+   */
+  auto isAffine = [ls](Instruction *inst) -> bool {
+    if (false || isa<PHINode>(inst) || isa<GetElementPtrInst>(inst)
+        || isa<SExtInst>(inst) || isa<ZExtInst>(inst) || isa<TruncInst>(inst)
+        || isa<BitCastInst>(inst)) {
+      return true;
+    }
+    switch (inst->getOpcode()) {
+      case Instruction::Add:
+      case Instruction::Sub:
+        return true;
+      case Instruction::Mul:
+      case Instruction::Shl:
+        return (false || ls->isLoopInvariant(inst->getOperand(0))
+                || ls->isLoopInvariant(inst->getOperand(1)));
+      default:
+        return false;
+    }
+  };
+
+  /*
+   * Select the loads.
+   * The slices of all of them must be cheap enough for the helper to run ahead
+   * of the loop.
+   */
+  std::vector<LoadInst *> loads;
+  std::unordered_set<Instruction *> slices;
+  for (auto bb : ls->getBasicBlocks()) {
+    if (nestedBlocks.count(bb) > 0) {
+      continue;
+    }
+    for (auto &inst : *bb) {
+      auto load = dyn_cast<LoadInst>(&inst);
+      if (false || (load == nullptr) || load->isVolatile()
+          || (!canBeComputed(load->getPointerOperand()))) {
+        continue;
+      }
+
+      /*
+       * Fetch the slice of the address.
+       */
+      std::unordered_set<Instruction *> slice;
+      std::vector<Value *> toVisit{ load->getPointerOperand() };
+      while (toVisit.size() > 0) {
+        auto inst = dyn_cast<Instruction>(toVisit.back());
+        toVisit.pop_back();
+        if (false || (inst == nullptr) || (!ls->isIncluded(inst))
+            || (slice.count(inst) > 0)) {
+          continue;
+        }
+        slice.insert(inst);
+        if (!isa<PHINode>(inst)) {
+          toVisit.insert(toVisit.end(),
+                         inst->operand_values().begin(),
+                         inst->operand_values().end());
+        }
+      }
+
+      /*
+       * Check the address.
+       * It must change across iterations, and the hardware prefetchers must be
+       * unlikely to fetch it.
+       */
+      auto dependsOnAnIV = false;
+      auto isAddressAffine = true;
+      for (auto sliceInst : slice) {
+        if (isa<PHINode>(sliceInst)) {
+          dependsOnAnIV = true;
+        }
+        if (!isAffine(sliceInst)) {
+          isAddressAffine = false;
+        }
+      }
+      if (false || (!dependsOnAnIV) || isAddressAffine) {
+        continue;
+      }
+      loads.push_back(load);
+      slices.insert(slice.begin(), slice.end());
+    }
+  }
+  if (true && (loads.size() > 0)
+      && ((slices.size() * 2) > ls->getNumberOfInstructions())) {
+    return {};
+  }
+
+  return loads;
+}
+
+bool Parallelizer::addHelperPrefetcher(LoopDependenceInfo *LDI,
+                                       std::vector<LoadInst *> const &loads,
+                                       Noelle &par,
+                                       Function *starter,
+                                       Function *throttle,
+                                       Function *stopper) {
+  auto ls = LDI->getLoopStructure();
+  auto F = ls->getFunction();
+  auto &M = *F->getParent();
+  auto &cxt = M.getContext();
+  auto ivs = this->getInductionVariablesToRecompute(LDI);
+
+  /*
+   * Collect the instructions of the slices in the order they have to be
+   * computed, and the live-ins they use.
+   */
+  std::vector<Instruction *> slice;
+  std::vector<Value *> liveIns;
+  std::unordered_set<Value *> visited;
+  auto addLiveIn = [&liveIns, &visited](Value *v) {
+    if (false || isa<Constant>(v) || (visited.count(v) > 0)) {
+      return;
+    }
+    visited.insert(v);
+    liveIns.push_back(v);
+  };
+  std::function<void(Value *)> collect;
+  collect = [&](Value *v) {
+    auto inst = dyn_cast<Instruction>(v);
+    if (false || (inst == nullptr) || (!ls->isIncluded(inst))) {
+      addLiveIn(v);
+      return;
+    }
+    if (visited.count(inst) > 0) {
+      return;
+    }
+    visited.insert(inst);
+    if (auto phi = dyn_cast<PHINode>(inst)) {
+      auto iv = ivs.at(phi);
+      addLiveIn(iv->getStartValue());
+      addLiveIn(iv->getSingleComputedStepValue());
+    } else {
+      for (auto op : inst->operand_values()) {
+        collect(op);
+      }
+    }
+    slice.push_back(inst);
+  };
+  for (auto load : loads) {
+    collect(load->getPointerOperand());
+  }
+
+  /*
+   * Create the task.
+   * It loads the live-ins from its environment. Then, it computes and
+   * prefetches the addresses of the iterations the throttle of the runtime
+   * lets it run.
+   */
+  std::vector<Type *> envTypes;
+  for (auto liveIn : liveIns) {
+    envTypes.push_back(liveIn->getType());
+  }
+  auto envType = StructType::get(cxt, envTypes);
+  auto int8Ptr = PointerType::getUnqual(par.int8);
+  auto taskSignature = FunctionType::get(Type::getVoidTy(cxt),
+                                         ArrayRef<Type *>({ int8Ptr, int8Ptr }),
+                                         false);
+  PrefetcherTask task{ taskSignature, M };
+  task.extractFuncArgs();
+  auto taskF = task.getTaskBody();
+  auto zeroV = ConstantInt::get(par.int32, 0);
+  IRBuilder<> entryBuilder{ task.getEntry() };
+  auto taskEnv = entryBuilder.CreateBitCast(task.getEnvironment(),
+                                            PointerType::getUnqual(envType));
+  for (auto i = 0u; i < liveIns.size(); i++) {
+    auto indexV = ConstantInt::get(par.int32, i);
+    auto liveInPtr = entryBuilder.CreateInBoundsGEP(
+        taskEnv,
+        ArrayRef<Value *>({ zeroV, indexV }));
+    task.addLiveIn(liveIns[i], entryBuilder.CreateLoad(liveInPtr));
+  }
+  auto headerBB = BasicBlock::Create(cxt, "", taskF);
+  auto bodyBB = BasicBlock::Create(cxt, "", taskF);
+  entryBuilder.CreateBr(headerBB);
+
+  /*
+   * Ask the throttle which iteration to prefetch for.
+   */
+  IRBuilder<> headerBuilder{ headerBB };
+  auto iterationPHI = headerBuilder.CreatePHI(par.int64, 2);
+  iterationPHI->addIncoming(ConstantInt::get(par.int64, 0), task.getEntry());
+  auto iteration = headerBuilder.CreateCall(
+      throttle,
+      ArrayRef<Value *>({ task.getPrefetcher(), iterationPHI }));
+  auto isLoopOver =
+      headerBuilder.CreateICmpSLT(iteration, ConstantInt::get(par.int64, 0));
+  headerBuilder.CreateCondBr(isLoopOver, task.getExit(), bodyBB);
+
+  /*
+   * Compute the addresses of the iteration.
+   */
+  IRBuilder<> bodyBuilder{ bodyBB };
+  auto fetchClone = [&task](Value *original) -> Value * {
+    if (task.isAnOriginalLiveIn(original)) {
+      return task.getCloneOfOriginalLiveIn(original);
+    }
+    auto inst = dyn_cast<Instruction>(original);
+    if (true && (inst != nullptr) && task.isAnOriginalInstruction(inst)) {
+      return task.getCloneOfOriginalInstruction(inst);
+    }
+    return original;
+  };
+  for (auto inst : slice) {
+    if (auto phi = dyn_cast<PHINode>(inst)) {
+      auto iv = ivs.at(phi);
+      auto ivIteration =
+          bodyBuilder.CreateSExtOrTrunc(iteration, phi->getType());
+      auto offset = bodyBuilder.CreateMul(
+          ivIteration,
+          fetchClone(iv->getSingleComputedStepValue()));
+      auto ivValue =
+          bodyBuilder.CreateAdd(fetchClone(iv->getStartValue()), offset);
+      task.addInstruction(phi, cast<Instruction>(ivValue));
+      continue;
+    }
+    auto cloneInst = task.cloneAndAddInstruction(inst);
+    for (auto i = 0u; i < cloneInst->getNumOperands(); i++) {
+      cloneInst->setOperand(i, fetchClone(inst->getOperand(i)));
+    }
+    cloneInst->setDebugLoc(DebugLoc());
+
+    /*
+     * The helper computes the addresses of iterations the loop might not run,
+     * so they must not be poison.
+     */
+    cloneInst->dropPoisonGeneratingFlags();
+    bodyBuilder.Insert(cloneInst);
+  }
+
+  /*
+   * Prefetch the addresses for reading with high temporal locality, as the
+   * loop uses them soon on the same physical core.
+   */
+  auto prefetch = Intrinsic::getDeclaration(&M, Intrinsic::prefetch);
+  for (auto load : loads) {
+    auto address =
+        bodyBuilder.CreateBitCast(fetchClone(load->getPointerOperand()),
+                                  int8Ptr);
+    bodyBuilder.CreateCall(prefetch,
+                           ArrayRef<Value *>({ address,
+                                               ConstantInt::get(par.int32, 0),
+                                               ConstantInt::get(par.int32, 3),
+                                               ConstantInt::get(par.int32,
+                                                                1) }));
+  }
+  auto nextIteration =
+      bodyBuilder.CreateAdd(iteration, ConstantInt::get(par.int64, 1));
+  iterationPHI->addIncoming(nextIteration, bodyBB);
+  bodyBuilder.CreateBr(headerBB);
+  IRBuilder<> exitBuilder{ task.getExit() };
+  exitBuilder.CreateRetVoid();
+
+  /*
+   * Start the helper before the loop.
+   */
+  IRBuilder<> allocaBuilder{ &*F->getEntryBlock().getFirstInsertionPt() };
+  auto env = allocaBuilder.CreateAlloca(envType);
+  IRBuilder<> builder{ ls->getPreHeader()->getTerminator() };
+  for (auto i = 0u; i < liveIns.size(); i++) {
+    auto indexV = ConstantInt::get(par.int32, i);
+    auto liveInPtr =
+        builder.CreateInBoundsGEP(env, ArrayRef<Value *>({ zeroV, indexV }));
+    builder.CreateStore(liveIns[i], liveInPtr);
+  }
+  auto starterType = starter->getFunctionType();
+  auto taskPtr = builder.CreateBitCast(taskF, starterType->getParamType(0));
+  auto envPtr = builder.CreateBitCast(env, starterType->getParamType(1));
+  auto prefetcher =
+      builder.CreateCall(starter, ArrayRef<Value *>({ taskPtr, envPtr }));
+  auto progress =
+      builder.CreateBitCast(prefetcher, PointerType::getUnqual(par.int64));
+
+  /*
+   * Publish the iterations completed by the loop at its latches.
+   */
+  auto header = ls->getHeader();
+  IRBuilder<> loopHeaderBuilder{ &*header->begin() };
+  auto counterPHI = loopHeaderBuilder.CreatePHI(par.int64, 2);
+  counterPHI->addIncoming(ConstantInt::get(par.int64, 0), ls->getPreHeader());
+  for (auto latch : ls->getLatches()) {
+    IRBuilder<> latchBuilder{ latch->getTerminator() };
+    auto nextCounter =
+        latchBuilder.CreateAdd(counterPHI, ConstantInt::get(par.int64, 1));
+    auto store = latchBuilder.CreateStore(nextCounter, progress);
+    store->setAtomic(AtomicOrdering::Monotonic);
+    store->setAlignment(8);
+    counterPHI->addIncoming(nextCounter, latch);
+  }
+
+  /*
+   * Stop the helper at the exits of the loop.
+   */
+  for (auto exitBB : ls->getLoopExitBasicBlocks()) {
+    IRBuilder<> exitBBBuilder{ &*exitBB->getFirstInsertionPt() };
+    exitBBBuilder.CreateCall(stopper, ArrayRef<Value *>({ prefetcher }));
+  }
+
+  return true;
+}
+
+} // namespace llvm::noelle
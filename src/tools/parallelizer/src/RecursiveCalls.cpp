@@ -0,0 +1,334 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+#include "CallSiteTask.hpp"
+
+namespace llvm::noelle {
+
+bool Parallelizer::parallelizeRecursiveFunctions(Module &M, Noelle &par) {
+  errs() << "Parallelizer:  Spawn independent recursive calls as tasks\n";
+
+  /*
+   * Fetch the runtime.
+   */
+  auto spawner = M.getFunction("NOELLE_TaskSpawn");
+  auto syncer = M.getFunction("NOELLE_TaskSync");
+  if (false || (spawner == nullptr) || (syncer == nullptr)) {
+    errs() << "Parallelizer:    The runtime does not spawn tasks\n";
+    return false;
+  }
+
+  /*
+   * Fetch the recursive functions.
+   * They are the ones that belong to an SCC of the call graph.
+   */
+  auto fm = par.getFunctionsManager();
+  auto pcg = fm->getProgramCallGraph();
+  auto sccCAG = pcg->getSCCCAG();
+  std::vector<Function *> recursiveFunctions;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    if (pcg->doesItBelongToASCC(&F)) {
+      recursiveFunctions.push_back(&F);
+    }
+  }
+
+  /*
+   * Select the recursive calls of every function first, as spawning a call
+   * creates new functions.
+   */
+  std::vector<
+      std::pair<Function *, std::vector<std::pair<CallInst *, Instruction *>>>>
+      callsToSpawn;
+  for (auto F : recursiveFunctions) {
+    auto sccOfF = sccCAG->getNode(pcg->getFunctionNode(F));
+    auto isRecursive = [pcg, sccCAG, sccOfF](Function *callee) -> bool {
+      auto calleeNode = pcg->getFunctionNode(callee);
+      if (calleeNode == nullptr) {
+        return false;
+      }
+      return (sccCAG->getNode(calleeNode) == sccOfF);
+    };
+    auto calls = this->getRecursiveCallsToSpawn(F, par, isRecursive);
+    if (calls.size() > 0) {
+      callsToSpawn.push_back({ F, calls });
+    }
+  }
+
+  /*
+   * Spawn the calls.
+   */
+  auto modified = false;
+  for (auto &functionCalls : callsToSpawn) {
+    auto F = functionCalls.first;
+    for (auto &callSyncPair : functionCalls.second) {
+      auto call = callSyncPair.first;
+      errs() << "Parallelizer:    Spawn " << *call << "\n";
+      this->spawnRecursiveCall(call, callSyncPair.second, par, spawner, syncer);
+    }
+
+    /*
+     * Update the dependences of the function.
+     */
+    par.refreshDependences(F);
+    modified = true;
+  }
+
+  return modified;
+}
+
+std::vector<std::pair<CallInst *, Instruction *>> Parallelizer::
+    getRecursiveCallsToSpawn(Function *F,
+                             Noelle &par,
+                             std::function<bool(Function *)> isRecursive) {
+  std::vector<std::pair<CallInst *, Instruction *>> calls;
+
+  /*
+   * Fetch the profiles.
+   * Like for the calls run in parallel by "parallelizeCallSites", recursive
+   * calls are known to be heavy only from the profiles, unless the
+   * parallelization is forced. How deep the recursion spawns tasks is then
+   * decided at run time.
+   */
+  auto profiles = par.getProfiles();
+  if (true && (!this->forceParallelization) && (!profiles->isAvailable())) {
+    return {};
+  }
+  auto minimumInstructionsPerInvocation = 2000;
+  auto isHeavyRecursiveCall =
+      [this, profiles, minimumInstructionsPerInvocation, &isRecursive](
+          Instruction *inst) -> bool {
+    auto call = dyn_cast<CallInst>(inst);
+    if (call == nullptr) {
+      return false;
+    }
+
+    /*
+     * Check the callee.
+     */
+    auto callee = call->getCalledFunction();
+    if (false || (callee == nullptr) || callee->empty() || callee->isVarArg()
+        || call->isMustTailCall() || call->isInlineAsm()
+        || (!isRecursive(callee))) {
+      return false;
+    }
+
+    /*
+     * Check the instructions executed per invocation of the call.
+     */
+    if (this->forceParallelization) {
+      return true;
+    }
+    auto invocations = profiles->getInvocations(call);
+    if (invocations == 0) {
+      return false;
+    }
+    auto instructionsPerInvocation =
+        profiles->getTotalInstructions(call) / invocations;
+    return (instructionsPerInvocation >= minimumInstructionsPerInvocation);
+  };
+
+  /*
+   * Fetch the dependences of the function.
+   * The recursive calls that do not depend on each other are found from the
+   * memory dependences between them, which account for what the calls can
+   * modify and reference.
+   */
+  par.refreshDependences(F);
+  auto fdg = par.getFunctionDependenceGraph(F);
+
+  /*
+   * Select the recursive calls to spawn.
+   */
+  for (auto &bb : *F) {
+    for (auto &inst : bb) {
+      if (!isHeavyRecursiveCall(&inst)) {
+        continue;
+      }
+      auto call = cast<CallInst>(&inst);
+
+      /*
+       * Fetch the instructions that depend on the call.
+       * Memory dependences are considered in both directions.
+       */
+      std::unordered_set<Value *> dependences;
+      auto collectDependence = [&dependences](Value *v,
+                                              DGEdge<Value> *dep) -> bool {
+        dependences.insert(v);
+        return false;
+      };
+      fdg->iterateOverDependencesFrom(call,
+                                      true,
+                                      true,
+                                      true,
+                                      collectDependence);
+      fdg->iterateOverDependencesTo(call,
+                                    false,
+                                    true,
+                                    false,
+                                    collectDependence);
+
+      /*
+       * Find the first instruction after the call that depends on it.
+       * The task of the call runs in parallel with the code before it, and it
+       * is synchronized just before it.
+       * Uses of the value returned by the call that are in other basic blocks
+       * come after the terminator of the current one.
+       */
+      Instruction *syncPoint = bb.getTerminator();
+      auto isThereASiblingCall = false;
+      for (auto nextInst = call->getNextNode(); nextInst != bb.getTerminator();
+           nextInst = nextInst->getNextNode()) {
+        if (dependences.count(nextInst) > 0) {
+          syncPoint = nextInst;
+          break;
+        }
+        if (isHeavyRecursiveCall(nextInst)) {
+          isThereASiblingCall = true;
+        }
+      }
+
+      /*
+       * Check if a sibling recursive call runs in parallel with the task.
+       */
+      if (!isThereASiblingCall) {
+        continue;
+      }
+      calls.push_back({ call, syncPoint });
+    }
+  }
+
+  return calls;
+}
+
+void Parallelizer::spawnRecursiveCall(CallInst *call,
+                                      Instruction *syncPoint,
+                                      Noelle &par,
+                                      Function *spawner,
+                                      Function *syncer) {
+  auto F = call->getFunction();
+  auto &M = *F->getParent();
+  auto &cxt = M.getContext();
+  auto callee = call->getCalledFunction();
+  assert(callee != nullptr);
+
+  /*
+   * Define the environment of the task.
+   * It includes the arguments of the call followed by the value it returns,
+   * if any.
+   */
+  std::vector<Type *> envTypes;
+  for (auto argID = 0u; argID < call->getNumArgOperands(); argID++) {
+    envTypes.push_back(call->getArgOperand(argID)->getType());
+  }
+  auto numberOfArguments = envTypes.size();
+  auto returnsValue = !call->getType()->isVoidTy();
+  if (returnsValue) {
+    envTypes.push_back(call->getType());
+  }
+  auto envType = StructType::get(cxt, envTypes);
+
+  /*
+   * Create the task.
+   * It loads the arguments of the call from its environment, it invokes the
+   * callee, and it stores the value returned in its environment.
+   */
+  auto int8Ptr = PointerType::getUnqual(par.int8);
+  auto taskSignature = FunctionType::get(Type::getVoidTy(cxt),
+                                         ArrayRef<Type *>({ int8Ptr }),
+                                         false);
+  CallSiteTask task{ taskSignature, M };
+  task.extractFuncArgs();
+  auto zeroV = ConstantInt::get(par.int32, 0);
+  IRBuilder<> taskBuilder{ task.getEntry() };
+  auto taskEnv = taskBuilder.CreateBitCast(task.getEnvironment(),
+                                           PointerType::getUnqual(envType));
+  std::vector<Value *> taskArgs;
+  for (auto i = 0u; i < numberOfArguments; i++) {
+    auto indexV = ConstantInt::get(par.int32, i);
+    auto argPtr = taskBuilder.CreateInBoundsGEP(
+        taskEnv,
+        ArrayRef<Value *>({ zeroV, indexV }));
+    taskArgs.push_back(taskBuilder.CreateLoad(argPtr));
+  }
+  auto taskCall = taskBuilder.CreateCall(callee, ArrayRef<Value *>(taskArgs));
+  taskCall->setCallingConv(call->getCallingConv());
+  taskCall->setAttributes(call->getAttributes());
+  if (returnsValue) {
+    auto indexV = ConstantInt::get(par.int32, numberOfArguments);
+    auto retPtr = taskBuilder.CreateInBoundsGEP(
+        taskEnv,
+        ArrayRef<Value *>({ zeroV, indexV }));
+    taskBuilder.CreateStore(taskCall, retPtr);
+  }
+  taskBuilder.CreateBr(task.getExit());
+  IRBuilder<> exitBuilder{ task.getExit() };
+  exitBuilder.CreateRetVoid();
+
+  /*
+   * Allocate the environment of the task.
+   * Every invocation of the recursive function has its own, and the task is
+   * synchronized before the invocation returns.
+   */
+  IRBuilder<> entryBuilder{ &*F->getEntryBlock().getFirstInsertionPt() };
+  auto env = entryBuilder.CreateAlloca(envType);
+
+  /*
+   * Spawn the task instead of invoking the callee.
+   */
+  IRBuilder<> builder{ call };
+  for (auto i = 0u; i < numberOfArguments; i++) {
+    auto indexV = ConstantInt::get(par.int32, i);
+    auto argPtr =
+        builder.CreateInBoundsGEP(env, ArrayRef<Value *>({ zeroV, indexV }));
+    builder.CreateStore(call->getArgOperand(i), argPtr);
+  }
+  auto spawnerType = spawner->getFunctionType();
+  auto taskPtr = builder.CreateBitCast(task.getTaskBody(),
+                                       spawnerType->getParamType(0));
+  auto envPtr = builder.CreateBitCast(env, spawnerType->getParamType(1));
+  auto handle =
+      builder.CreateCall(spawner, ArrayRef<Value *>({ taskPtr, envPtr }));
+
+  /*
+   * Synchronize the task just before the first instruction that depends on the
+   * call.
+   * Then, its uses get the value the task returned.
+   */
+  IRBuilder<> syncBuilder{ syncPoint };
+  syncBuilder.CreateCall(syncer, ArrayRef<Value *>({ handle }));
+  if (returnsValue) {
+    auto indexV = ConstantInt::get(par.int32, numberOfArguments);
+    auto retPtr = syncBuilder.CreateInBoundsGEP(
+        env,
+        ArrayRef<Value *>({ zeroV, indexV }));
+    auto returnedValue = syncBuilder.CreateLoad(retPtr);
+    call->replaceAllUsesWith(returnedValue);
+  }
+  call->eraseFromParent();
+
+  return;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2016 - 2021  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Pairs of allocation functions of the C library and of the thread-caching
+ * allocator of the runtime that replaces them.
+ */
+static std::vector<std::pair<std::string, std::string>>
+    allocationFunctionsOfTheRuntime = { { "malloc", "NOELLE_malloc" },
+                                        { "calloc", "NOELLE_calloc" },
+                                        { "realloc", "NOELLE_realloc" },
+                                        { "free", "NOELLE_free" } };
+
+/*
+ * Redirect the calls to the functions of @functionsToRedirect invoked by @F to
+ * their counterparts of the runtime.
+ * The number of calls redirected is returned.
+ */
+static uint64_t redirectCalls(
+    Function *F,
+    std::unordered_map<Function *, Function *> const &functionsToRedirect) {
+  uint64_t redirectedCalls = 0;
+  for (auto &inst : instructions(F)) {
+    auto call = dyn_cast<CallBase>(&inst);
+    if (call == nullptr) {
+      continue;
+    }
+    auto callee = call->getCalledFunction();
+    if (callee == nullptr) {
+      continue;
+    }
+    auto it = functionsToRedirect.find(callee);
+    if (it == functionsToRedirect.end()) {
+      continue;
+    }
+    call->setCalledFunction(it->second);
+    redirectedCalls++;
+  }
+
+  return redirectedCalls;
+}
+
+bool Parallelizer::redirectAllocationsOfTheTasks(
+    ParallelizationTechnique *technique,
+    Noelle &par) {
+  auto prefix = "Parallelizer: parallelizerLoop: ";
+
+  /*
+   * Fetch the allocation functions invoked by the tasks that the runtime
+   * replaces.
+   * Functions whose signature differs from the one of the runtime (e.g.,
+   * they are declared by the program with other types) are left untouched.
+   */
+  auto M = par.getProgram();
+  std::unordered_map<Function *, Function *> functionsToRedirect;
+  for (auto &namePair : allocationFunctionsOfTheRuntime) {
+    auto libraryFunction = M->getFunction(namePair.first);
+    auto runtimeFunction = M->getFunction(namePair.second);
+    if (false || (libraryFunction == nullptr) || (runtimeFunction == nullptr)
+        || (libraryFunction->getFunctionType()
+            != runtimeFunction->getFunctionType())) {
+      continue;
+    }
+    functionsToRedirect[libraryFunction] = runtimeFunction;
+  }
+  if (functionsToRedirect.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Redirect the allocations of the tasks.
+   */
+  uint64_t redirectedCalls = 0;
+  for (auto taskBody : technique->getTaskBodies()) {
+    redirectedCalls += redirectCalls(taskBody, functionsToRedirect);
+  }
+  if (redirectedCalls == 0) {
+    return false;
+  }
+  if (par.getVerbosity() != Verbosity::Disabled) {
+    errs() << prefix << "  " << redirectedCalls
+           << " calls of the tasks allocate from the runtime\n";
+  }
+
+  return true;
+}
+
+bool Parallelizer::redirectDeallocationsToTheRuntime(Module &M, Noelle &par) {
+
+  /*
+   * Blocks allocated by the tasks can be freed or resized by the rest of the
+   * program. Hence, every call of the module that frees or resizes a block
+   * needs to go through the runtime, which hands the blocks it did not
+   * allocate back to the C library.
+   */
+  std::unordered_map<Function *, Function *> functionsToRedirect;
+  std::unordered_set<Function *> runtimeFunctions;
+  for (auto &namePair : allocationFunctionsOfTheRuntime) {
+    auto libraryFunction = M.getFunction(namePair.first);
+    auto runtimeFunction = M.getFunction(namePair.second);
+    if (runtimeFunction != nullptr) {
+      runtimeFunctions.insert(runtimeFunction);
+    }
+    if (false || (namePair.first == "malloc") || (namePair.first == "calloc")
+        || (libraryFunction == nullptr) || (runtimeFunction == nullptr)
+        || (libraryFunction->getFunctionType()
+            != runtimeFunction->getFunctionType())) {
+      continue;
+    }
+    functionsToRedirect[libraryFunction] = runtimeFunction;
+  }
+  if (functionsToRedirect.size() == 0) {
+    return false;
+  }
+
+  /*
+   * The functions of the runtime allocator are the only ones that keep
+   * invoking the C library.
+   */
+  uint64_t redirectedCalls = 0;
+  for (auto &F : M) {
+    if (false || F.empty() || (runtimeFunctions.count(&F) > 0)) {
+      continue;
+    }
+    redirectedCalls += redirectCalls(&F, functionsToRedirect);
+  }
+  errs() << "Parallelizer:    " << redirectedCalls
+         << " calls free or resize blocks through the runtime\n";
+
+  return redirectedCalls > 0;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+LoopDependenceInfo *Parallelizer::unrollLoop(LoopDependenceInfo *LDI,
+                                             Noelle &par) {
+
+  /*
+   * Check if the loop should be unrolled.
+   */
+  auto ltm = LDI->getLoopTransformationsManager();
+  auto unrollFactor = ltm->getUnrollFactor();
+  if (unrollFactor <= 1) {
+    return nullptr;
+  }
+
+  /*
+   * Unroll the loop.
+   * Unrolling amortizes the per-iteration overheads of the parallelized loop
+   * (e.g., the synchronizations of the HELIX sequential segments) over
+   * @unrollFactor iterations of the original loop.
+   */
+  auto ls = LDI->getLoopStructure();
+  auto header = ls->getHeader();
+  auto loopFunction = ls->getFunction();
+  errs() << "Parallelizer:    Unroll loop " << ls->getID() << " by "
+         << unrollFactor << "\n";
+  auto &loopTransformer = par.getLoopTransformer();
+  if (!loopTransformer.partiallyUnrollLoop(LDI, unrollFactor)) {
+    return nullptr;
+  }
+
+  /*
+   * Update the dependences of the function.
+   */
+  par.refreshDependences(loopFunction);
+
+  /*
+   * Fetch the unrolled loop, which keeps the header of the original one.
+   */
+  auto loops = par.getLoopStructures(loopFunction, 0);
+  LoopStructure *unrolledLS = nullptr;
+  for (auto loop : *loops) {
+    if (loop->getHeader() == header) {
+      unrolledLS = loop;
+      break;
+    }
+  }
+  if (unrolledLS == nullptr) {
+
+    /*
+     * The loop has been fully unrolled.
+     */
+    delete loops;
+    return nullptr;
+  }
+  auto optimizations = { LoopDependenceInfoOptimization::MEMORY_CLONING_ID,
+                         LoopDependenceInfoOptimization::THREAD_SAFE_LIBRARY_ID };
+  auto unrolledLDI = par.getLoop(unrolledLS, optimizations);
+  delete loops;
+
+  /*
+   * The unrolled loop is parallelized as the original one would have been.
+   */
+  unrolledLDI->copyParallelizationOptionsFrom(LDI);
+  unrolledLDI->getLoopTransformationsManager()->setUnrollFactor(1);
+
+  return unrolledLDI;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "Parallelizer.hpp"
+
+namespace llvm::noelle {
+
+void Parallelizer::generateVariants(
+    Module &M,
+    Noelle &par,
+    Heuristics *h,
+    std::map<uint32_t, LoopDependenceInfo *> const &loopParallelizationOrder) {
+
+  /*
+   * Read the configurations.
+   * Each line is a configuration, which has the values of the INDEX_FILE file
+   * for every loop of the program.
+   */
+  std::ifstream configurationsFile(this->variantsFileName);
+  if (!configurationsFile.good()) {
+    errs() << "Parallelizer:    ERROR: the file " << this->variantsFileName
+           << " cannot be read\n";
+    return;
+  }
+  std::vector<std::vector<uint32_t>> configurations;
+  std::string line;
+  while (std::getline(configurationsFile, line)) {
+    std::istringstream lineStream(line);
+    std::vector<uint32_t> configuration;
+    uint32_t value = 0;
+    while (lineStream >> value) {
+      configuration.push_back(value);
+    }
+    if (configuration.size() == 0) {
+      continue;
+    }
+    configurations.push_back(configuration);
+  }
+  errs() << "Parallelizer:  Generating " << configurations.size()
+         << " variants\n";
+
+  /*
+   * Analyze the loops.
+   * The variants are generated by child processes, which share the analyses
+   * computed so far with the current one.
+   */
+  for (auto indexLoopPair : loopParallelizationOrder) {
+    indexLoopPair.second->getSCCManager();
+  }
+
+  /*
+   * Generate the variants.
+   */
+  auto valuesPerLoop = 9;
+  for (auto variantID = 0u; variantID < configurations.size(); variantID++) {
+    auto &configuration = configurations[variantID];
+    auto variantFileName =
+        this->variantsPrefix + std::to_string(variantID) + ".bc";
+
+    /*
+     * Generate the current variant in a child process, which has its own copy
+     * of the module and of the loop abstractions.
+     */
+    outs().flush();
+    auto pid = fork();
+    if (pid < 0) {
+      errs() << "Parallelizer:    ERROR: the variant " << variantID
+             << " cannot be generated\n";
+      return;
+    }
+    if (pid == 0) {
+
+      /*
+       * Configure the loops of the variant.
+       * Loops without a configuration stay sequential.
+       */
+      std::map<uint32_t, LoopDependenceInfo *> variantLoops;
+      for (auto indexLoopPair : loopParallelizationOrder) {
+        auto ldi = indexLoopPair.second;
+        uint32_t loopIndex = 0;
+        if (!par.getLoopIndex(ldi->getLoopStructure(), loopIndex)) {
+          continue;
+        }
+        auto firstValue = loopIndex * valuesPerLoop;
+        if ((firstValue + valuesPerLoop) > configuration.size()) {
+          continue;
+        }
+        auto shouldBeParallelized = configuration[firstValue];
+        auto technique = configuration[firstValue + 3];
+        auto cores = configuration[firstValue + 4];
+        auto DOALLChunkFactor = configuration[firstValue + 5];
+        if (false || (shouldBeParallelized == 0) || (cores < 2)) {
+          continue;
+        }
+        if (technique > 6) {
+          errs() << "Parallelizer:    ERROR: the variant " << variantID
+                 << " disables techniques " << technique
+                 << ", which do not exist\n";
+          _exit(1);
+        }
+        par.configureLoop(ldi, technique, DOALLChunkFactor, cores);
+        variantLoops[indexLoopPair.first] = ldi;
+      }
+
+      /*
+       * Parallelize the variant and write it.
+       */
+      this->parallelizeLoops(M, par, h, variantLoops);
+      std::error_code EC;
+      raw_fd_ostream variantFile(variantFileName, EC, sys::fs::F_None);
+      if (EC) {
+        errs() << "Parallelizer:    ERROR: the file " << variantFileName
+               << " cannot be written\n";
+        _exit(1);
+      }
+      WriteBitcodeToFile(M, variantFile);
+      variantFile.flush();
+      _exit(0);
+    }
+
+    /*
+     * Wait for the variant.
+     */
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (false || (!WIFEXITED(status)) || (WEXITSTATUS(status) != 0)) {
+      errs() << "Parallelizer:    The variant " << variantID << " failed\n";
+      continue;
+    }
+    errs() << "Parallelizer:    The variant " << variantID
+           << " has been written to " << variantFileName << "\n";
+  }
+
+  return;
+}
+
+} // namespace llvm::noelle
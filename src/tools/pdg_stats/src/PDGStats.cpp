@@ -19,8 +19,14 @@
  OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <chrono>
+#include <future>
 #include "noelle/core/PDGPrinter.hpp"
+#include "noelle/core/DGSnapshot.hpp"
+#include "noelle/core/PDGAnalysis.hpp"
 #include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/UniqueIRMarkerReader.hpp"
+#include "llvm/Support/JSON.h"
 #include "PDGStats.hpp"
 
 using namespace llvm;
@@ -33,6 +39,12 @@ bool PDGStats::runOnModule(Module &M) {
    */
   auto &noelle = getAnalysis<Noelle>();
 
+  /*
+   * Compute the loops (and hence their dependence graphs and the PDG of their
+   * functions) first, so the time of the dependence analyses can be measured.
+   */
+  auto start = std::chrono::steady_clock::now();
+
   /*
    * Compute the loops for all functions.
    */
@@ -74,22 +86,17 @@ bool PDGStats::runOnModule(Module &M) {
    * Compute the memory edges in the PDG.
    */
   auto PDG = noelle.getProgramDependenceGraph();
-  for (auto edge : PDG->getEdges()) {
-
-    /*
-     * Handle dependence.
-     */
-    this->analyzeDependence(edge);
-  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  this->secondsToComputeTheDependences = elapsed.count();
+  DGSnapshot<Value> pdgSnapshot(*PDG);
+  this->analyzeDependences(pdgSnapshot, this->stats);
 
   /*
    * Collect the statistics for all functions.
    */
+  this->collectStatsForFunctions(M, programLoopForests, lsToLDI);
   for (auto &F : M) {
-    this->collectStatsForNodes(F);
-    this->collectStatsForPotentialEdges(programLoopForests, F);
-    this->collectStatsForLoopEdges(noelle, programLoopForests, lsToLDI, F);
-
     if (this->dumpLoopDG) {
       this->printRefinedLoopGraphsForFunction(noelle,
                                               programLoopForests,
@@ -98,29 +105,160 @@ bool PDGStats::runOnModule(Module &M) {
     }
   }
 
+  /*
+   * Export the dependence graphs.
+   */
+  if (this->exportFileName != "") {
+    this->exportDependenceGraphs(M, noelle, programLoopForests, lsToLDI);
+  }
+
+  /*
+   * Collect the statistics for the loops that the dependences allow to
+   * parallelize.
+   */
+  this->collectStatsForDOALLLoops(noelle, programLoops);
+
   /*
    * Print the statistics.
    */
   printStats();
+  if (this->jsonFileName != "") {
+    printStatsAsJSON();
+  }
+  if (this->csvFileName != "") {
+    printStatsAsCSV();
+  }
 
   return false;
 }
 
-void PDGStats::collectStatsForNodes(Function &F) {
+void PDGStats::collectStatsForFunctions(
+    Module &M,
+    std::unordered_map<Function *, StayConnectedNestedLoopForest *>
+        &programLoops,
+    std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI) {
+
+  /*
+   * The dependence graphs of the loops might be computed lazily, which is not
+   * thread-safe, so they are computed before starting the parallel tasks.
+   */
+  std::vector<Function *> functions;
+  for (auto &F : M) {
+    functions.push_back(&F);
+  }
+  for (auto &pair : lsToLDI) {
+    pair.second->getLoopDG();
+  }
+
+  /*
+   * Collect the statistics of a function.
+   * This only reads the IR and the dependence graphs of the loops.
+   */
+  typedef std::pair<Stats, std::vector<LoopRecord>> JobResult;
+  auto computeTask = [this, &programLoops, &lsToLDI](Function *F) -> JobResult {
+    JobResult result;
+    this->collectStatsForNodes(*F, result.first);
+    this->collectStatsForPotentialEdges(programLoops, *F, result.first);
+    this->collectStatsForLoopEdges(programLoops,
+                                   lsToLDI,
+                                   *F,
+                                   result.first,
+                                   result.second);
+    return result;
+  };
+  auto collectResult = [this](JobResult result) {
+    this->stats += result.first;
+    for (auto &record : result.second) {
+      this->loopRecords.push_back(record);
+    }
+  };
+
+  /*
+   * Check if the statistics should be collected sequentially.
+   */
+  if (this->threads <= 1) {
+    for (auto F : functions) {
+      collectResult(computeTask(F));
+    }
+    return;
+  }
+
+  /*
+   * Collect the statistics, one task per function.
+   * At most one task per thread is in flight, and the results are collected
+   * in the order of the functions.
+   */
+  std::deque<std::future<JobResult>> tasks;
+  uint64_t nextJob = 0;
+  for (auto i = 0u; i < functions.size(); i++) {
+    while (true && (nextJob < functions.size())
+           && (tasks.size() < this->threads)) {
+      tasks.push_back(
+          std::async(std::launch::async, computeTask, functions[nextJob]));
+      nextJob++;
+    }
+    collectResult(tasks.front().get());
+    tasks.pop_front();
+  }
+
+  return;
+}
+
+void PDGStats::collectStatsForDOALLLoops(
+    Noelle &noelle,
+    std::unordered_map<Function *, std::vector<LoopDependenceInfo *> *>
+        &programLoops) {
+
+  /*
+   * The loops returned by NOELLE are the hot ones.
+   * A loop is DOALL-able if its structure allows DOALL and none of its SCCs
+   * blocks it.
+   */
+  std::unordered_map<LoopStructure *, LoopRecord *> recordOfLoop;
+  for (auto &record : this->loopRecords) {
+    recordOfLoop[record.loop] = &record;
+  }
+  for (auto &functionLoops : programLoops) {
+    if (functionLoops.second == nullptr) {
+      continue;
+    }
+    for (auto LDI : *functionLoops.second) {
+      this->numberOfHotLoops++;
+      std::string reason;
+      if (!DOALL::canBeAppliedToLoopStructure(LDI->getLoopStructure(),
+                                              reason)) {
+        continue;
+      }
+      if (!DOALL::getSCCsThatBlockDOALLToBeApplicable(LDI, noelle).empty()) {
+        continue;
+      }
+      this->numberOfDOALLLoops++;
+      auto recordIt = recordOfLoop.find(LDI->getLoopStructure());
+      if (recordIt != recordOfLoop.end()) {
+        recordIt->second->isDOALL = true;
+      }
+    }
+  }
+
+  return;
+}
+
+void PDGStats::collectStatsForNodes(Function &F, Stats &functionStats) {
   for (auto &arg : F.args()) {
-    this->numberOfNodes++;
+    functionStats.numberOfNodes++;
   }
   for (auto &B : F) {
-    this->numberOfNodes += B.size();
+    functionStats.numberOfNodes += B.size();
   }
 
   return;
 }
 
 void PDGStats::collectStatsForPotentialEdges(
-    std::unordered_map<Function *, StayConnectedNestedLoopForest *>
+    std::unordered_map<Function *, StayConnectedNestedLoopForest *> const
         &programLoops,
-    Function &F) {
+    Function &F,
+    Stats &functionStats) {
 
   /*
    * Compute the total number of instructions that could access memory.
@@ -142,7 +280,7 @@ void PDGStats::collectStatsForPotentialEdges(
       continue;
     }
   }
-  this->numberOfPotentialMemoryDependences +=
+  functionStats.numberOfPotentialMemoryDependences +=
       this->computePotentialEdges(totLoads, totStores, totCalls);
 
   /*
@@ -153,7 +291,7 @@ void PDGStats::collectStatsForPotentialEdges(
   totStores = 0;
   totCalls = 0;
   if (programLoops.find(&F) != programLoops.end()) {
-    auto loopForest = programLoops[&F];
+    auto loopForest = programLoops.at(&F);
     for (auto loopTree : loopForest->getTrees()) {
       auto visitor = [&totLoads, &totStores, &totCalls](
                          StayConnectedNestedLoopForestNode *n,
@@ -178,7 +316,7 @@ void PDGStats::collectStatsForPotentialEdges(
       loopTree->visitPreOrder(visitor);
     }
   }
-  this->numberOfPotentialMemoryDependences +=
+  functionStats.numberOfPotentialMemoryDependences +=
       this->computePotentialEdges(totLoads, totStores, totCalls);
 
   return;
@@ -229,26 +367,99 @@ void PDGStats::printRefinedLoopGraphsForFunction(
   return;
 }
 
-void PDGStats::collectStatsForLoopEdges(
+void PDGStats::exportDependenceGraphs(
+    Module &M,
     Noelle &noelle,
     std::unordered_map<Function *, StayConnectedNestedLoopForest *>
         &programLoops,
-    std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI,
-    Function &F) {
+    std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI) {
+  DGExporter exporter(this->exportFileName,
+                      this->exportFormat,
+                      this->exportFilter);
+  if (!exporter.isOpen()) {
+    return;
+  }
+
+  /*
+   * Loop-carried dependences and SCCDAGs only exist for loops.
+   */
+  auto exportLoops = false || (this->exportLoopID >= 0)
+                     || this->exportFilter.onlyLoopCarried
+                     || this->exportSCCDAGs;
+  for (auto &F : M) {
+    if (F.empty()) {
+      continue;
+    }
+    if (true && (this->exportFunctionName != "")
+        && (F.getName() != this->exportFunctionName)) {
+      continue;
+    }
+
+    /*
+     * Export the dependence graph of the function.
+     */
+    if (!exportLoops) {
+      auto fdg = noelle.getFunctionDependenceGraph(&F);
+      exporter.exportGraph(F.getName().str(), fdg);
+      delete fdg;
+      continue;
+    }
+
+    /*
+     * Export the dependence graphs of the loops of the function.
+     */
+    if (programLoops.find(&F) == programLoops.end()) {
+      continue;
+    }
+    for (auto loopTree : programLoops[&F]->getTrees()) {
+      auto visitor = [this, &lsToLDI, &exporter, &F](
+                         StayConnectedNestedLoopForestNode *n,
+                         uint32_t level) -> bool {
+        auto ls = n->getLoop();
+        if (true && (this->exportLoopID >= 0)
+            && (ls->getID() != ((uint64_t)this->exportLoopID))) {
+          return false;
+        }
+        auto ldi = lsToLDI.at(ls);
+        auto name = F.getName().str() + ":loop" + std::to_string(ls->getID());
+        if (this->exportSCCDAGs) {
+          exporter.exportSCCDAG(name, ldi->getSCCManager()->getSCCDAG());
+        } else {
+          exporter.exportGraph(name, ldi->getLoopDG());
+        }
+        return false;
+      };
+      loopTree->visitPreOrder(visitor);
+    }
+  }
+  errs() << "PDGStats: the dependence graphs are in " << this->exportFileName
+         << "\n";
+
+  return;
+}
+
+void PDGStats::collectStatsForLoopEdges(
+    std::unordered_map<Function *, StayConnectedNestedLoopForest *> const
+        &programLoops,
+    std::unordered_map<LoopStructure *, LoopDependenceInfo *> const &lsToLDI,
+    Function &F,
+    Stats &functionStats,
+    std::vector<LoopRecord> &functionLoopRecords) {
 
   /*
    * Check every loop of the program.
    */
   if (programLoops.find(&F) != programLoops.end()) {
-    auto loopForest = programLoops[&F];
+    auto loopForest = programLoops.at(&F);
     for (auto loopTree : loopForest->getTrees()) {
-      auto visitor = [this, &lsToLDI](StayConnectedNestedLoopForestNode *n,
-                                      uint32_t level) -> bool {
+      auto visitor = [this, &lsToLDI, &functionStats, &functionLoopRecords](
+                         StayConnectedNestedLoopForestNode *n,
+                         uint32_t level) -> bool {
         /*
          * Fetch the loop.
          */
         auto currentLoop = n->getLoop();
-        auto currentLDI = lsToLDI[currentLoop];
+        auto currentLDI = lsToLDI.at(currentLoop);
         assert(currentLDI != nullptr);
 
         /*
@@ -259,9 +470,31 @@ void PDGStats::collectStatsForLoopEdges(
         /*
          * Iterate over the dependences.
          */
-        for (auto edge : loopDG->getEdges()) {
-          this->analyzeDependence(edge);
+        LoopRecord record;
+        record.loop = currentLoop;
+        DGSnapshot<Value> loopDGSnapshot(*loopDG);
+        this->analyzeDependences(loopDGSnapshot, record.stats);
+        functionStats += record.stats;
+
+        /*
+         * Compute the nodes and the potential memory dependences of the loop.
+         */
+        uint64_t totLoads = 0;
+        uint64_t totStores = 0;
+        uint64_t totCalls = 0;
+        for (auto inst : currentLoop->getInstructions()) {
+          record.stats.numberOfNodes++;
+          if (isa<LoadInst>(inst)) {
+            totLoads++;
+          } else if (isa<StoreInst>(inst)) {
+            totStores++;
+          } else if (false || isa<CallInst>(inst) || isa<InvokeInst>(inst)) {
+            totCalls++;
+          }
         }
+        record.stats.numberOfPotentialMemoryDependences =
+            this->computePotentialEdges(totLoads, totStores, totCalls);
+        functionLoopRecords.push_back(record);
 
         return false;
       };
@@ -284,26 +517,159 @@ bool PDGStats::edgeIsDependenceOf(MDNode *edgeM,
 }
 
 void PDGStats::printStats() {
-  errs() << "Number of Nodes: " << this->numberOfNodes << "\n";
-  errs() << "Number of Edges (a.k.a. dependences): " << this->numberOfEdges
-         << "\n";
-  errs()
-      << " Number of control dependences: " << this->numberOfControlDependence
-      << "\n";
+  errs() << "Precision of the PDG: "
+         << PDGAnalysis::getPrecisionName(PDGAnalysis::getPrecision()) << "\n";
+  errs() << "Time to compute the dependences (seconds): "
+         << this->secondsToComputeTheDependences << "\n";
+  errs() << "Number of Nodes: " << this->stats.numberOfNodes << "\n";
+  errs() << "Number of Edges (a.k.a. dependences): "
+         << this->stats.numberOfEdges << "\n";
+  errs() << " Number of control dependences: "
+         << this->stats.numberOfControlDependence << "\n";
   errs() << " Number of data dependences: "
-         << this->numberOfEdges - this->numberOfControlDependence << "\n";
+         << this->stats.numberOfEdges - this->stats.numberOfControlDependence
+         << "\n";
   errs() << "   Number of variable dependences: "
-         << this->numberOfVariableDependence << "\n";
-  errs()
-      << "   Number of memory dependences: " << this->numberOfMemoryDependence
-      << "\n";
+         << this->stats.numberOfVariableDependence << "\n";
+  errs() << "   Number of memory dependences: "
+         << this->stats.numberOfMemoryDependence << "\n";
   errs() << "     Number of memory must dependences: "
-         << this->numberOfMemoryMustDependence << "\n";
+         << this->stats.numberOfMemoryMustDependence << "\n";
   errs() << "     Number of memory may dependences: "
-         << this->numberOfMemoryDependence - this->numberOfMemoryMustDependence
+         << this->stats.numberOfMemoryDependence
+                - this->stats.numberOfMemoryMustDependence
          << "\n";
   errs() << "     Number of potential memory dependences: "
-         << this->numberOfPotentialMemoryDependences << "\n";
+         << this->stats.numberOfPotentialMemoryDependences << "\n";
+  errs() << "Number of hot loops: " << this->numberOfHotLoops << "\n";
+  errs() << " Number of hot loops that could be DOALL: "
+         << this->numberOfDOALLLoops << "\n";
+  errs() << "Number of alias queries answered by the cache: "
+         << PDGAnalysis::getNumberOfAliasQueryCacheHits() << "\n";
+  errs() << "Number of alias queries computed: "
+         << PDGAnalysis::getNumberOfAliasQueryCacheMisses() << "\n";
+
+  return;
+}
+
+std::vector<int64_t> PDGStats::getUniqueLoopIDs(void) {
+  std::vector<int64_t> ids;
+
+  /*
+   * The IDs are attached to the LLVM loops.
+   */
+  for (auto &record : this->loopRecords) {
+    auto loopFunction = record.loop->getFunction();
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(*loopFunction).getLoopInfo();
+    auto llvmLoop = LI.getLoopFor(record.loop->getHeader());
+    int64_t id = -1;
+    if (llvmLoop != nullptr) {
+      auto uniqueLoopID = UniqueIRMarkerReader::getLoopID(llvmLoop);
+      if (uniqueLoopID) {
+        id = uniqueLoopID.value();
+      }
+    }
+    ids.push_back(id);
+  }
+
+  return ids;
+}
+
+void PDGStats::printStatsAsJSON(void) {
+  std::error_code EC;
+  raw_fd_ostream file(this->jsonFileName, EC);
+  if (EC) {
+    errs() << "PDGStats: ERROR: cannot write " << this->jsonFileName << "\n";
+    return;
+  }
+
+  /*
+   * Loops are identified by their ID set by the UniqueIRMarker pass, which is
+   * stable across compilations (null if the loop has not been marked).
+   */
+  json::OStream J(file, 2);
+  auto printStats = [&J](const Stats &stats) {
+    J.attribute("edges", stats.numberOfEdges);
+    J.attribute("control_dependences", stats.numberOfControlDependence);
+    J.attribute("data_dependences",
+                stats.numberOfEdges - stats.numberOfControlDependence);
+    J.attribute("variable_dependences", stats.numberOfVariableDependence);
+    J.attribute("memory_dependences", stats.numberOfMemoryDependence);
+    J.attribute("memory_must_dependences", stats.numberOfMemoryMustDependence);
+    J.attribute("memory_may_dependences",
+                stats.numberOfMemoryDependence
+                    - stats.numberOfMemoryMustDependence);
+    J.attribute("potential_memory_dependences",
+                stats.numberOfPotentialMemoryDependences);
+  };
+  auto ids = this->getUniqueLoopIDs();
+  J.object([&] {
+    J.attribute("precision",
+                PDGAnalysis::getPrecisionName(PDGAnalysis::getPrecision()));
+    J.attribute("seconds_to_compute_the_dependences",
+                this->secondsToComputeTheDependences);
+    J.attribute("nodes", this->stats.numberOfNodes);
+    printStats(this->stats);
+    J.attribute("hot_loops", this->numberOfHotLoops);
+    J.attribute("doall_loops", this->numberOfDOALLLoops);
+    J.attribute("alias_query_cache_hits",
+                (int64_t)PDGAnalysis::getNumberOfAliasQueryCacheHits());
+    J.attribute("alias_query_cache_misses",
+                (int64_t)PDGAnalysis::getNumberOfAliasQueryCacheMisses());
+    J.attributeArray("loops", [&] {
+      for (auto i = 0u; i < this->loopRecords.size(); i++) {
+        auto &record = this->loopRecords[i];
+        J.object([&] {
+          if (ids[i] != -1) {
+            J.attribute("id", ids[i]);
+          } else {
+            J.attribute("id", nullptr);
+          }
+          J.attribute("function", record.loop->getFunction()->getName());
+          J.attribute("instructions", record.stats.numberOfNodes);
+          printStats(record.stats);
+          J.attribute("doall", record.isDOALL);
+        });
+      }
+    });
+  });
+  file << "\n";
+
+  return;
+}
+
+void PDGStats::printStatsAsCSV(void) {
+  std::error_code EC;
+  raw_fd_ostream file(this->csvFileName, EC);
+  if (EC) {
+    errs() << "PDGStats: ERROR: cannot write " << this->csvFileName << "\n";
+    return;
+  }
+
+  /*
+   * Each hot loop has a row.
+   * The ID of a loop is empty if the loop has not been marked by the
+   * UniqueIRMarker pass.
+   */
+  file << "id,function,instructions,edges,control_dependences,"
+          "variable_dependences,memory_dependences,memory_must_dependences,"
+          "potential_memory_dependences,doall\n";
+  auto ids = this->getUniqueLoopIDs();
+  for (auto i = 0u; i < this->loopRecords.size(); i++) {
+    auto &record = this->loopRecords[i];
+    auto &stats = record.stats;
+    if (ids[i] != -1) {
+      file << ids[i];
+    }
+    file << "," << record.loop->getFunction()->getName();
+    file << "," << stats.numberOfNodes << "," << stats.numberOfEdges;
+    file << "," << stats.numberOfControlDependence << ","
+         << stats.numberOfVariableDependence;
+    file << "," << stats.numberOfMemoryDependence << ","
+         << stats.numberOfMemoryMustDependence;
+    file << "," << stats.numberOfPotentialMemoryDependences;
+    file << "," << (record.isDOALL ? 1 : 0) << "\n";
+  }
 
   return;
 }
@@ -340,34 +706,37 @@ uint64_t PDGStats::computePotentialEdges(uint64_t totLoads,
   return tot;
 }
 
-void PDGStats::analyzeDependence(DGEdge<Value> *edge) {
-  this->numberOfEdges++;
+void PDGStats::analyzeDependences(const DGSnapshot<Value> &dg,
+                                  Stats &dgStats) {
+  for (auto edge = 0u; edge < dg.numEdges(); edge++) {
+    dgStats.numberOfEdges++;
 
-  /*
-   * Handle memory dependences.
-   */
-  if (edge->isMemoryDependence()) {
-    this->numberOfMemoryDependence++;
-    if (edge->isMustDependence()) {
-      this->numberOfMemoryMustDependence++;
+    /*
+     * Handle memory dependences.
+     */
+    if (dg.isMemoryDependence(edge)) {
+      dgStats.numberOfMemoryDependence++;
+      if (dg.isMustDependence(edge)) {
+        dgStats.numberOfMemoryMustDependence++;
+      }
+      continue;
     }
-    return;
-  }
 
-  /*
-   * Handle variable dependences.
-   */
-  if (edge->isDataDependence()) {
-    this->numberOfVariableDependence++;
-    return;
-  }
+    /*
+     * Handle variable dependences.
+     */
+    if (dg.isDataDependence(edge)) {
+      dgStats.numberOfVariableDependence++;
+      continue;
+    }
 
-  /*
-   * Handle control dependences.
-   */
-  if (edge->isControlDependence()) {
-    this->numberOfControlDependence++;
-    return;
+    /*
+     * Handle control dependences.
+     */
+    if (dg.isControlDependence(edge)) {
+      dgStats.numberOfControlDependence++;
+      continue;
+    }
   }
 
   return;
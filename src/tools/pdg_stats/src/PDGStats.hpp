@@ -22,6 +22,9 @@
 #pragma once
 
 #include "noelle/core/Noelle.hpp"
+#include "noelle/core/DGSnapshot.hpp"
+#include "noelle/core/DGExporter.hpp"
+#include "DOALL.hpp"
 
 namespace llvm::noelle {
 
@@ -44,20 +47,88 @@ public:
   bool runOnModule(Module &M) override;
 
 private:
+  struct Stats {
+    int64_t numberOfNodes = 0;
+    int64_t numberOfEdges = 0;
+    int64_t numberOfVariableDependence = 0;
+    int64_t numberOfMemoryDependence = 0;
+    int64_t numberOfMemoryMustDependence = 0;
+    int64_t numberOfPotentialMemoryDependences = 0;
+    int64_t numberOfControlDependence = 0;
+
+    Stats &operator+=(Stats const &obj) {
+      this->numberOfNodes += obj.numberOfNodes;
+      this->numberOfEdges += obj.numberOfEdges;
+      this->numberOfVariableDependence += obj.numberOfVariableDependence;
+      this->numberOfMemoryDependence += obj.numberOfMemoryDependence;
+      this->numberOfMemoryMustDependence += obj.numberOfMemoryMustDependence;
+      this->numberOfPotentialMemoryDependences +=
+          obj.numberOfPotentialMemoryDependences;
+      this->numberOfControlDependence += obj.numberOfControlDependence;
+
+      return *this;
+    }
+  };
+
+  /*
+   * Statistics of the dependence graph of a hot loop.
+   */
+  struct LoopRecord {
+    LoopStructure *loop = nullptr;
+    Stats stats;
+    bool isDOALL = false;
+  };
+
   bool dumpLoopDG = false;
-  int64_t numberOfNodes = 0;
-  int64_t numberOfEdges = 0;
-  int64_t numberOfVariableDependence = 0;
-  int64_t numberOfMemoryDependence = 0;
-  int64_t numberOfMemoryMustDependence = 0;
-  int64_t numberOfPotentialMemoryDependences = 0;
-  int64_t numberOfControlDependence = 0;
-
-  void collectStatsForNodes(Function &F);
-  void collectStatsForPotentialEdges(
+  Stats stats;
+  int64_t numberOfHotLoops = 0;
+  int64_t numberOfDOALLLoops = 0;
+  double secondsToComputeTheDependences = 0;
+
+  /*
+   * The statistics of the loops, in the order their functions appear in the
+   * module.
+   */
+  std::vector<LoopRecord> loopRecords;
+
+  /*
+   * Number of threads used to collect the statistics of the functions.
+   */
+  uint32_t threads = 1;
+
+  /*
+   * Files to dump the statistics to (empty if they should not be dumped).
+   */
+  std::string jsonFileName;
+  std::string csvFileName;
+
+  /*
+   * File to stream the dependence graphs to (empty if they should not be
+   * exported), and the graphs to write there (see -noelle-pdg-stats-export).
+   */
+  std::string exportFileName;
+  DGExporter::Format exportFormat = DGExporter::Format::DOT;
+  DGExporter::Filter exportFilter;
+  std::string exportFunctionName;
+  int64_t exportLoopID = -1;
+  bool exportSCCDAGs = false;
+
+  /*
+   * Collect the statistics of each function of @M.
+   * Functions are independent, so they are handled in parallel.
+   */
+  void collectStatsForFunctions(
+      Module &M,
       std::unordered_map<Function *, StayConnectedNestedLoopForest *>
           &programLoops,
-      Function &F);
+      std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI);
+
+  void collectStatsForNodes(Function &F, Stats &functionStats);
+  void collectStatsForPotentialEdges(
+      std::unordered_map<Function *, StayConnectedNestedLoopForest *> const
+          &programLoops,
+      Function &F,
+      Stats &functionStats);
 
   void printRefinedLoopGraphsForFunction(
       Noelle &noelle,
@@ -66,17 +137,44 @@ private:
       std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI,
       Function &F);
 
-  void collectStatsForLoopEdges(
+  /*
+   * Stream the dependence graphs selected by the export options to
+   * exportFileName.
+   * The graphs of the functions are written, unless an option refers to
+   * loops: then, the graphs of their loops are written instead.
+   */
+  void exportDependenceGraphs(
+      Module &M,
       Noelle &noelle,
       std::unordered_map<Function *, StayConnectedNestedLoopForest *>
           &programLoops,
-      std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI,
-      Function &F);
+      std::unordered_map<LoopStructure *, LoopDependenceInfo *> &lsToLDI);
 
-  void analyzeDependence(DGEdge<Value> *edge);
+  void collectStatsForLoopEdges(
+      std::unordered_map<Function *, StayConnectedNestedLoopForest *> const
+          &programLoops,
+      std::unordered_map<LoopStructure *, LoopDependenceInfo *> const &lsToLDI,
+      Function &F,
+      Stats &functionStats,
+      std::vector<LoopRecord> &functionLoopRecords);
+
+  void collectStatsForDOALLLoops(
+      Noelle &noelle,
+      std::unordered_map<Function *, std::vector<LoopDependenceInfo *> *>
+          &programLoops);
+
+  void analyzeDependences(const DGSnapshot<Value> &dg, Stats &dgStats);
 
   bool edgeIsDependenceOf(MDNode *edgeM, EDGE_ATTRIBUTE edgeAttribute);
   void printStats();
+  void printStatsAsJSON(void);
+  void printStatsAsCSV(void);
+
+  /*
+   * Return the ID set by the UniqueIRMarker pass of the loop of each record
+   * (-1 if the loop has not been marked).
+   */
+  std::vector<int64_t> getUniqueLoopIDs(void);
   uint64_t computePotentialEdges(uint64_t totLoads,
                                  uint64_t totStores,
                                  uint64_t totCalls);
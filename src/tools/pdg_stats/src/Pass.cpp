@@ -20,6 +20,7 @@
  OR OTHER DEALINGS IN THE SOFTWARE.
  */
 #include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Architecture.hpp"
 #include "PDGStats.hpp"
 
 using namespace llvm;
@@ -29,13 +30,104 @@ static cl::opt<bool> LoopDGDump("noelle-refined-loopdg-dump",
                                 cl::ZeroOrMore,
                                 cl::Hidden,
                                 cl::desc("Dump the refined Loop DG"));
+static cl::opt<int> Threads(
+    "noelle-pdg-stats-threads",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Number of threads used to collect the statistics of the "
+             "functions (0: all cores)"));
+static cl::opt<std::string> JSONFile(
+    "noelle-pdg-stats-json",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Dump the statistics of the PDG and of its hot loops to a JSON "
+             "file"));
+static cl::opt<std::string> CSVFile(
+    "noelle-pdg-stats-csv",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Dump the statistics of the hot loops to a CSV file"));
+static cl::opt<std::string> ExportFile(
+    "noelle-pdg-stats-export",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Stream the dependence graphs of the functions (or of their "
+             "loops) to a file while they are visited"));
+static cl::opt<std::string> ExportFormat(
+    "noelle-pdg-stats-export-format",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init("dot"),
+    cl::desc("Format of the exported graphs: \"dot\" (default) or \"json\" "
+             "(a node or an edge per line)"));
+static cl::opt<std::string> ExportFunction(
+    "noelle-pdg-stats-export-function",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Export only the graphs of the function with this name"));
+static cl::opt<int> ExportLoop(
+    "noelle-pdg-stats-export-loop",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Export only the dependence graph of the loop with this ID"));
+static cl::opt<std::string> ExportDependences(
+    "noelle-pdg-stats-export-dependences",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Comma separated kinds of the dependences to export among "
+             "\"variable\", \"memory\", and \"control\" (default: all)"));
+static cl::opt<bool> ExportLoopCarried(
+    "noelle-pdg-stats-export-loop-carried",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Export only the loop-carried dependences of the loops"));
+static cl::opt<bool> ExportSCCs(
+    "noelle-pdg-stats-export-sccs",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Export the SCCDAGs of the loops, with a node per SCC"));
 
 bool PDGStats::doInitialization(Module &M) {
   this->dumpLoopDG = LoopDGDump;
+  if (Threads.getNumOccurrences() > 0) {
+    this->threads = (Threads.getValue() > 0)
+                        ? Threads.getValue()
+                        : Architecture::getNumberOfLogicalCores();
+  }
+  if (JSONFile.getNumOccurrences() > 0) {
+    this->jsonFileName = JSONFile.getValue();
+  }
+  if (CSVFile.getNumOccurrences() > 0) {
+    this->csvFileName = CSVFile.getValue();
+  }
+  if (ExportFile.getNumOccurrences() > 0) {
+    this->exportFileName = ExportFile.getValue();
+    if (!DGExporter::parseFormat(ExportFormat.getValue(),
+                                 this->exportFormat)) {
+      errs() << "PDGStats: ERROR: the format " << ExportFormat.getValue()
+             << " does not exist\n";
+      abort();
+    }
+    if (true && (ExportDependences.getNumOccurrences() > 0)
+        && !DGExporter::parseDependenceKinds(ExportDependences.getValue(),
+                                             this->exportFilter)) {
+      errs() << "PDGStats: ERROR: the kinds of dependences "
+             << ExportDependences.getValue() << " do not exist\n";
+      abort();
+    }
+    this->exportFilter.onlyLoopCarried =
+        (ExportLoopCarried.getNumOccurrences() > 0);
+    this->exportFunctionName = ExportFunction.getValue();
+    if (ExportLoop.getNumOccurrences() > 0) {
+      this->exportLoopID = ExportLoop.getValue();
+    }
+    this->exportSCCDAGs = (ExportSCCs.getNumOccurrences() > 0);
+  }
   return false;
 }
 
 void PDGStats::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<LoopInfoWrapperPass>();
   AU.addRequired<Noelle>();
   AU.setPreservesAll();
   return;
@@ -95,12 +95,22 @@ private:
                         InvariantManager &invariantManager) const;
   bool isPartOfShlShrTruncationPair(Instruction *I) const;
 
+  uint64_t fingerprintLoop(LoopStructure *loop) const;
+
   /*
    * Fields
    */
   Noelle &noelle;
   unsigned ptrSizeInBits;
   IntegerType *intTypeForPtrSize;
+
+  /*
+   * Loops (keyed by their header) whose IV related SCEVs have nothing to
+   * simplify, with the fingerprint of their code when this was computed.
+   * This avoids analyzing the same unchanged loops again when the enablers
+   * run until a fixed point is reached.
+   */
+  std::unordered_map<BasicBlock *, uint64_t> loopsWithNothingToSimplify;
 };
 
 } // namespace llvm::noelle
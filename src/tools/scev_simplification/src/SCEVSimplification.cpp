@@ -274,6 +274,21 @@ bool SCEVSimplification::simplifyIVRelatedSCEVs(
   assert(rootLoopNode != nullptr);
   auto rootLoop = rootLoopNode->getLoop();
 
+  /*
+   * Check if we already know that the loop has nothing to simplify.
+   */
+  auto rootLoopHeader = rootLoop->getHeader();
+  auto rootLoopFingerprint = this->fingerprintLoop(rootLoop);
+  auto memoizedLoop = this->loopsWithNothingToSimplify.find(rootLoopHeader);
+  if (true && (memoizedLoop != this->loopsWithNothingToSimplify.end())
+      && (memoizedLoop->second == rootLoopFingerprint)) {
+    if (noelle.getVerbosity() != Verbosity::Disabled) {
+      errs()
+          << "SCEVSimplification:  The loop has not changed since it was found to have nothing to simplify\n";
+    }
+    return false;
+  }
+
   IVCachedInfo ivCache;
   this->cacheIVInfo(ivCache, rootLoopNode, ivManager);
   searchForInstructionsDerivedFromMultipleIVs(ivCache,
@@ -343,9 +358,41 @@ bool SCEVSimplification::simplifyIVRelatedSCEVs(
     delete gepDerivation;
   }
 
+  /*
+   * Remember the loop if there was nothing to simplify.
+   */
+  if (modified) {
+    this->loopsWithNothingToSimplify.erase(rootLoopHeader);
+  } else {
+    this->loopsWithNothingToSimplify[rootLoopHeader] = rootLoopFingerprint;
+  }
+
   return modified;
 }
 
+uint64_t SCEVSimplification::fingerprintLoop(LoopStructure *loop) const {
+
+  /*
+   * Combine the instructions of the loop with their operands.
+   * The fingerprints of the basic blocks are added up because the order of the
+   * basic blocks of the loop is not deterministic.
+   */
+  uint64_t fingerprint = 0;
+  for (auto bb : loop->getBasicBlocks()) {
+    auto bbFingerprint = hash_value(bb);
+    for (auto &I : *bb) {
+      bbFingerprint =
+          hash_combine(bbFingerprint, &I, I.getOpcode(), I.getType());
+      for (auto &op : I.operands()) {
+        bbFingerprint = hash_combine(bbFingerprint, op.get());
+      }
+    }
+    fingerprint += bbFingerprint;
+  }
+
+  return fingerprint;
+}
+
 void SCEVSimplification::cacheIVInfo(
     IVCachedInfo &ivCache,
     StayConnectedNestedLoopForestNode *rootLoopNode,
@@ -36,4 +36,17 @@ patchInstallDir "noelle-fixedpoint" ;
 patchInstallDir "noelle-pdg-stats" ;
 patchInstallDir "noelle-loop-stats" ;
 patchInstallDir "noelle-parallelization-planner" ;
+patchInstallDir "noelle-oracle-speedups" ;
+patchInstallDir "noelle-blocker-report" ;
+patchInstallDir "noelle-server" ;
+patchInstallDir "noelle-server-query" ;
+patchInstallDir "noelle-summary" ;
+patchInstallDir "noelle-summary-link" ;
+patchInstallDir "noelle-hot-functions" ;
+patchInstallDir "noelle-extract-hot" ;
 patchInstallDir "noelle-parallelizer-loop" ;
+patchInstallDir "noelle-prof-dependences" ;
+patchInstallDir "noelle-meta-dep-embed" ;
+patchInstallDir "noelle-prof-values" ;
+patchInstallDir "noelle-meta-value-embed" ;
+patchInstallDir "noelle-parallelizer-variants" ;
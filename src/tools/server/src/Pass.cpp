@@ -0,0 +1,82 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "Server.hpp"
+
+namespace llvm::noelle {
+
+static cl::opt<std::string> ServerSocket(
+    "noelle-server-socket",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init("noelle.socket"),
+    cl::desc("Unix socket the NOELLE server listens to"));
+
+Server::Server() : ModulePass{ ID }, modified{ false }, shutdown{ false } {
+
+  return;
+}
+
+bool Server::doInitialization(Module &M) {
+  this->socketName = ServerSocket.getValue();
+
+  return false;
+}
+
+bool Server::runOnModule(Module &M) {
+
+  /*
+   * Fetch NOELLE.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+
+  /*
+   * Compute the analyses that every client needs, so the first request does
+   * not pay for them.
+   */
+  noelle.getProgramDependenceGraph();
+  this->fetchLoops(noelle);
+  if (this->loops.size() == 0) {
+    errs() << "Server: WARNING = no loop has an ID (see "
+              "noelle-meta-loop-embed)\n";
+  }
+
+  /*
+   * Answer the clients until one of them shuts the server down.
+   */
+  this->serveClients(noelle);
+
+  return this->modified;
+}
+
+void Server::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<Noelle>();
+
+  return;
+}
+
+} // namespace llvm::noelle
+
+// Next there is code to register your pass to "opt"
+char llvm::noelle::Server::ID = 0;
+static RegisterPass<Server> X(
+    "NoelleServer",
+    "Answer requests about a resident module and its analyses");
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "Server.hpp"
+
+namespace llvm::noelle {
+
+void Server::serveClients(Noelle &noelle) {
+
+  /*
+   * Create the socket.
+   * A socket left behind by a server that did not shut down is replaced.
+   */
+  struct sockaddr_un address;
+  if (this->socketName.size() >= sizeof(address.sun_path)) {
+    errs() << "Server: ERROR = the name of the socket " << this->socketName
+           << " is too long\n";
+    return;
+  }
+  auto listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0) {
+    errs() << "Server: ERROR = cannot create a socket\n";
+    return;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, this->socketName.c_str());
+  unlink(this->socketName.c_str());
+  if (false
+      || (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0)
+      || (listen(listener, 16) != 0)) {
+    errs() << "Server: ERROR = cannot listen to " << this->socketName
+           << "\n";
+    close(listener);
+    return;
+  }
+  errs() << "Server: listening to " << this->socketName << "\n";
+
+  /*
+   * Answer one client at a time.
+   * Requests modify the module, so they must not run concurrently.
+   */
+  while (!this->shutdown) {
+    auto client = accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      errs() << "Server: ERROR = cannot accept a client\n";
+      break;
+    }
+    this->serveClient(noelle, client);
+    close(client);
+  }
+
+  /*
+   * Remove the socket.
+   */
+  close(listener);
+  unlink(this->socketName.c_str());
+
+  return;
+}
+
+void Server::serveClient(Noelle &noelle, int client) {
+  std::string pending;
+  char buffer[4096];
+  while (!this->shutdown) {
+
+    /*
+     * Read the requests sent so far.
+     */
+    auto bytes = read(client, buffer, sizeof(buffer));
+    if (bytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (bytes == 0) {
+      return;
+    }
+    pending.append(buffer, bytes);
+
+    /*
+     * Answer the requests that are complete.
+     */
+    size_t endOfLine;
+    while ((endOfLine = pending.find('\n')) != std::string::npos) {
+      auto line = pending.substr(0, endOfLine);
+      pending.erase(0, endOfLine + 1);
+
+      /*
+       * Split the request into its words.
+       */
+      std::vector<std::string> request;
+      std::istringstream words(line);
+      std::string word;
+      while (words >> word) {
+        request.push_back(word);
+      }
+      if (request.size() == 0) {
+        continue;
+      }
+      if (request[0] == "close") {
+        return;
+      }
+
+      /*
+       * Answer the request.
+       */
+      std::string reply;
+      std::string error;
+      if (this->serveRequest(noelle, request, reply, error)) {
+        reply += "OK\n";
+      } else {
+        reply += "ERROR " + error + "\n";
+      }
+      size_t sent = 0;
+      while (sent < reply.size()) {
+        auto written =
+            write(client, reply.data() + sent, reply.size() - sent);
+        if (written <= 0) {
+          if ((written < 0) && (errno == EINTR)) {
+            continue;
+          }
+          return;
+        }
+        sent += written;
+      }
+      if (this->shutdown) {
+        return;
+      }
+    }
+  }
+
+  return;
+}
+
+bool Server::serveRequest(Noelle &noelle,
+                          const std::vector<std::string> &request,
+                          std::string &reply,
+                          std::string &error) {
+  auto &command = request[0];
+  if (command == "ping") {
+    reply += "pong\n";
+    return true;
+  }
+  if (command == "shutdown") {
+    this->shutdown = true;
+    return true;
+  }
+  if (command == "loops") {
+    return this->listLoops(reply);
+  }
+  if (command == "loop") {
+    uint64_t loopID;
+    if (false || (request.size() != 2)
+        || (!to_integer(request[1], loopID, 10))) {
+      error = "USAGE: loop LOOP_ID";
+      return false;
+    }
+    return this->describeLoop(noelle, loopID, reply, error);
+  }
+  if (false || (command == "pdg") || (command == "function")) {
+    return this->describeDependenceGraph(noelle, request, reply, error);
+  }
+  if (false || (command == "whilify") || (command == "unroll")) {
+    return this->transformLoop(noelle, request, reply, error);
+  }
+  if (command == "write") {
+    if (request.size() != 2) {
+      error = "USAGE: write FILE";
+      return false;
+    }
+    return this->writeModule(*noelle.getProgram(), request[1], error);
+  }
+
+  error = "unknown request " + command
+          + " (requests: ping loops loop pdg function whilify unroll write "
+            "close shutdown)";
+  return false;
+}
+
+bool Server::writeModule(Module &M,
+                         const std::string &fileName,
+                         std::string &error) {
+  std::error_code EC;
+  raw_fd_ostream output(fileName, EC, sys::fs::F_None);
+  if (EC) {
+    error = "cannot write " + fileName + ": " + EC.message();
+    return false;
+  }
+  WriteBitcodeToFile(M, output);
+
+  return true;
+}
+
+} // namespace llvm::noelle
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Noelle.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Keep a module and its analyses (e.g., the PDG and the loop abstractions)
+ * resident, and answer the requests of clients over a Unix socket.
+ * Scripts that issue many requests (e.g., autotuners) then pay the loading
+ * of the module and the computation of the PDG only once.
+ *
+ * A client sends one request per line and the server answers with the lines
+ * of the reply followed by a line that is either "OK" or "ERROR MESSAGE".
+ * Loops are identified by their IDs (see noelle-meta-loop-embed).
+ */
+class Server : public ModulePass {
+public:
+  Server();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  /*
+   * Class fields
+   */
+  static char ID;
+
+private:
+  /*
+   * Fields
+   */
+  std::string socketName;
+  bool modified;
+  bool shutdown;
+  std::map<uint64_t, LoopStructure *> loops;
+  std::unordered_map<uint64_t, LoopDependenceInfo *> loopContents;
+
+  /*
+   * Methods
+   */
+  void serveClients(Noelle &noelle);
+
+  void serveClient(Noelle &noelle, int client);
+
+  /*
+   * Answer @request by appending the lines of the reply to @reply.
+   * Return false if the request failed; @error then describes why.
+   */
+  bool serveRequest(Noelle &noelle,
+                    const std::vector<std::string> &request,
+                    std::string &reply,
+                    std::string &error);
+
+  bool listLoops(std::string &reply);
+
+  bool describeLoop(Noelle &noelle,
+                    uint64_t loopID,
+                    std::string &reply,
+                    std::string &error);
+
+  bool describeDependenceGraph(Noelle &noelle,
+                               const std::vector<std::string> &request,
+                               std::string &reply,
+                               std::string &error);
+
+  bool transformLoop(Noelle &noelle,
+                     const std::vector<std::string> &request,
+                     std::string &reply,
+                     std::string &error);
+
+  bool writeModule(Module &M, const std::string &fileName, std::string &error);
+
+  /*
+   * Fetch the loops of the program that have an ID.
+   */
+  void fetchLoops(Noelle &noelle);
+
+  /*
+   * Drop the abstractions of the loops of @F, which a transformation made
+   * stale.
+   */
+  void dropLoopContents(Function *F);
+
+  LoopDependenceInfo *getLoopContent(Noelle &noelle, uint64_t loopID);
+};
+
+} // namespace llvm::noelle
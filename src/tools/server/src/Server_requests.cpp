@@ -0,0 +1,220 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/ADT/StringExtras.h"
+
+#include "Server.hpp"
+
+namespace llvm::noelle {
+
+bool Server::listLoops(std::string &reply) {
+  for (auto &idLoopPair : this->loops) {
+    auto ls = idLoopPair.second;
+    reply += std::to_string(idLoopPair.first) + " "
+             + ls->getFunction()->getName().str() + " "
+             + std::to_string(ls->getNestingLevel()) + " "
+             + std::to_string(ls->getNumberOfInstructions()) + "\n";
+  }
+
+  return true;
+}
+
+bool Server::describeLoop(Noelle &noelle,
+                          uint64_t loopID,
+                          std::string &reply,
+                          std::string &error) {
+
+  /*
+   * Fetch the loop.
+   */
+  auto ldi = this->getLoopContent(noelle, loopID);
+  if (ldi == nullptr) {
+    error = "there is no loop " + std::to_string(loopID);
+    return false;
+  }
+  auto ls = ldi->getLoopStructure();
+
+  /*
+   * Describe the loop.
+   */
+  auto sccManager = ldi->getSCCManager();
+  auto tripCount = ldi->doesHaveCompileTimeKnownTripCount()
+                       ? std::to_string(ldi->getCompileTimeTripCount())
+                       : std::string("unknown");
+  auto invariants =
+      ldi->getInvariantManager()->getLoopInstructionsThatAreLoopInvariants();
+  auto IVs = ldi->getInductionVariableManager()->getInductionVariables();
+  reply += "function " + ls->getFunction()->getName().str() + "\n";
+  reply += "nesting_level " + std::to_string(ls->getNestingLevel()) + "\n";
+  reply += "instructions " + std::to_string(ls->getNumberOfInstructions())
+           + "\n";
+  reply += "trip_count " + tripCount + "\n";
+  reply += "sccs " + std::to_string(sccManager->getSCCDAG()->numNodes())
+           + "\n";
+  reply += "loop_carried_sccs "
+           + std::to_string(
+               sccManager->getSCCsWithLoopCarriedDependencies().size())
+           + "\n";
+  reply += "induction_variables " + std::to_string(IVs.size()) + "\n";
+  reply += "invariants " + std::to_string(invariants.size()) + "\n";
+
+  return true;
+}
+
+bool Server::describeDependenceGraph(Noelle &noelle,
+                                     const std::vector<std::string> &request,
+                                     std::string &reply,
+                                     std::string &error) {
+
+  /*
+   * Fetch the dependence graph.
+   */
+  PDG *dg = nullptr;
+  if (request[0] == "pdg") {
+    dg = noelle.getProgramDependenceGraph();
+  } else {
+    if (request.size() != 2) {
+      error = "USAGE: function FUNCTION_NAME";
+      return false;
+    }
+    auto f = noelle.getProgram()->getFunction(request[1]);
+    if (false || (f == nullptr) || f->empty()) {
+      error = "there is no function " + request[1] + " with a body";
+      return false;
+    }
+    dg = noelle.getFunctionDependenceGraph(f);
+  }
+
+  /*
+   * Describe the dependence graph.
+   */
+  reply += "nodes " + std::to_string(dg->numNodes()) + "\n";
+  reply += "edges " + std::to_string(dg->numEdges()) + "\n";
+
+  return true;
+}
+
+bool Server::transformLoop(Noelle &noelle,
+                           const std::vector<std::string> &request,
+                           std::string &reply,
+                           std::string &error) {
+
+  /*
+   * Parse the request.
+   */
+  auto isUnroll = (request[0] == "unroll");
+  uint64_t loopID;
+  uint32_t unrollFactor = 0;
+  if (false || (request.size() != (isUnroll ? 3 : 2))
+      || (!to_integer(request[1], loopID, 10))
+      || (isUnroll && (!to_integer(request[2], unrollFactor, 10)))) {
+    error = isUnroll ? "USAGE: unroll LOOP_ID FACTOR"
+                     : "USAGE: whilify LOOP_ID";
+    return false;
+  }
+
+  /*
+   * Fetch the loop.
+   */
+  auto ldi = this->getLoopContent(noelle, loopID);
+  if (ldi == nullptr) {
+    error = "there is no loop " + std::to_string(loopID);
+    return false;
+  }
+  auto f = ldi->getLoopStructure()->getFunction();
+
+  /*
+   * Transform the loop.
+   */
+  auto &loopTransformer = noelle.getLoopTransformer();
+  auto modified = isUnroll
+                      ? loopTransformer.partiallyUnrollLoop(ldi, unrollFactor)
+                      : loopTransformer.whilifyLoop(ldi);
+  reply += std::string("modified ") + (modified ? "yes" : "no") + "\n";
+  if (!modified) {
+    return true;
+  }
+  this->modified = true;
+
+  /*
+   * Update the analyses of the function transformed.
+   */
+  this->dropLoopContents(f);
+  noelle.refreshDependences(f);
+  this->fetchLoops(noelle);
+
+  return true;
+}
+
+void Server::fetchLoops(Noelle &noelle) {
+  this->loops.clear();
+
+  auto mm = noelle.getMetadataManager();
+  auto programLoops = noelle.getLoopStructures();
+  for (auto ls : *programLoops) {
+    if (!mm->doesHaveMetadata(ls, "noelle.loop_ID")) {
+      continue;
+    }
+    auto loopID = std::stoull(mm->getMetadata(ls, "noelle.loop_ID"));
+    this->loops[loopID] = ls;
+  }
+  delete programLoops;
+
+  return;
+}
+
+void Server::dropLoopContents(Function *F) {
+  for (auto it = this->loopContents.begin();
+       it != this->loopContents.end();) {
+    auto ldi = it->second;
+    if (ldi->getLoopStructure()->getFunction() != F) {
+      it++;
+      continue;
+    }
+    delete ldi;
+    it = this->loopContents.erase(it);
+  }
+
+  return;
+}
+
+LoopDependenceInfo *Server::getLoopContent(Noelle &noelle, uint64_t loopID) {
+
+  /*
+   * Check if the abstraction of the loop has been computed already.
+   */
+  if (this->loopContents.find(loopID) != this->loopContents.end()) {
+    return this->loopContents.at(loopID);
+  }
+
+  /*
+   * Compute the abstraction of the loop.
+   */
+  if (this->loops.find(loopID) == this->loops.end()) {
+    return nullptr;
+  }
+  auto ldi = noelle.getLoop(this->loops.at(loopID));
+  this->loopContents[loopID] = ldi;
+
+  return ldi;
+}
+
+} // namespace llvm::noelle
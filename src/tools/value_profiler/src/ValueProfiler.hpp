@@ -0,0 +1,95 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include "noelle/core/SystemHeaders.hpp"
+#include "noelle/core/Noelle.hpp"
+#include "noelle/core/LoopValueProfiles.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Profiler of the integer live-ins of the hot loops.
+ *
+ * The bounds and the start values of the loop-governing induction variables
+ * are always profiled; the other integer live-ins are profiled only if
+ * requested.
+ *
+ * The instrumented binary appends to ValueProfilerInstrumenter::
+ * defaultFileName one line per profiled live-in as
+ * "INVOCATIONS VALUE COUNT ... VALUE COUNT HEADER_INDEX LIVE_IN_INDEX
+ * FUNCTION", where the header index is the position of the header of the
+ * loop within its function, and the live-in index is the position of the
+ * argument or, after the arguments, of the instruction within its function.
+ * Hence, the profiles can be embedded only into the bitcode that has been
+ * instrumented.
+ */
+class ValueProfilerInstrumenter : public ModulePass {
+public:
+  static char ID;
+
+  static constexpr const char *defaultFileName = "noelle_value_profiles.txt";
+
+  /*
+   * Each live-in has the number of invocations of its loop followed by a
+   * pair (value, count) per value tracked.
+   */
+  static constexpr uint64_t countersPerLiveIn =
+      1 + 2 * LoopValueProfiles::numberOfValues;
+
+  ValueProfilerInstrumenter();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+private:
+  struct ProfiledLiveIn {
+    LoopStructure *loop;
+    Value *liveIn;
+  };
+
+  std::vector<ProfiledLiveIn> fetchLiveIns(Noelle &noelle);
+
+  Function *createRecordFunction(Module &M);
+
+  Function *createDumpFunction(Module &M,
+                               GlobalVariable *counters,
+                               std::vector<std::string> &names);
+};
+
+class ValueProfilerEmbedder : public ModulePass {
+public:
+  static char ID;
+
+  ValueProfilerEmbedder();
+
+  bool doInitialization(Module &M) override;
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+};
+
+} // namespace llvm::noelle
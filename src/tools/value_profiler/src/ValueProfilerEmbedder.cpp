@@ -0,0 +1,230 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <fstream>
+#include "ValueProfiler.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<std::string> ProfilesFile(
+    "noelle-value-profiles-file",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("File with the profiles dumped by the live-ins "
+             "instrumented by noelle-value-profiler-instr"));
+
+ValueProfilerEmbedder::ValueProfilerEmbedder() : ModulePass(ID) {
+  return;
+}
+
+bool ValueProfilerEmbedder::doInitialization(Module &M) {
+  return false;
+}
+
+bool ValueProfilerEmbedder::runOnModule(Module &M) {
+
+  /*
+   * Open the file with the profiles.
+   */
+  std::string fileName = ValueProfilerInstrumenter::defaultFileName;
+  if (ProfilesFile.getNumOccurrences() > 0) {
+    fileName = ProfilesFile.getValue();
+  }
+  std::ifstream file(fileName);
+  if (!file.good()) {
+    errs() << "ValueProfilerEmbedder: Warning = file " << fileName
+           << " cannot be read\n";
+    return false;
+  }
+
+  /*
+   * Read the profiles.
+   * Each line is "INVOCATIONS VALUE COUNT ... VALUE COUNT HEADER_INDEX
+   * LIVE_IN_INDEX FUNCTION_NAME". Several runs of the program append to the
+   * same file, so the invocations and the counts of a value are summed.
+   */
+  struct ValueProfile {
+    uint64_t invocations = 0;
+    std::map<int64_t, uint64_t> counts;
+  };
+  std::map<std::string,
+           std::map<std::pair<uint64_t, uint64_t>, ValueProfile>>
+      profiles;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream lineStream(line);
+    uint64_t invocations = 0;
+    if (!(lineStream >> invocations)) {
+      continue;
+    }
+    std::vector<std::pair<int64_t, uint64_t>> values;
+    for (auto i = 0u; i < LoopValueProfiles::numberOfValues; i++) {
+      int64_t value = 0;
+      uint64_t count = 0;
+      lineStream >> value >> count;
+      values.push_back({ value, count });
+    }
+    uint64_t headerIndex = 0;
+    uint64_t liveInIndex = 0;
+    std::string functionName;
+    if (!(lineStream >> headerIndex >> liveInIndex)) {
+      continue;
+    }
+    lineStream >> std::ws;
+    std::getline(lineStream, functionName);
+    auto &profile = profiles[functionName][{ headerIndex, liveInIndex }];
+    profile.invocations += invocations;
+    for (auto &pair : values) {
+      if (pair.second > 0) {
+        profile.counts[pair.first] += pair.second;
+      }
+    }
+  }
+  if (profiles.size() == 0) {
+    return false;
+  }
+
+  /*
+   * Remove the profiles embedded before.
+   */
+  auto valueMetadataName = LoopValueProfiles::valueMetadataName;
+  auto metadataName = LoopValueProfiles::metadataName;
+  for (auto &F : M) {
+    for (auto &I : instructions(F)) {
+      I.setMetadata(valueMetadataName, nullptr);
+      I.setMetadata(metadataName, nullptr);
+    }
+  }
+
+  /*
+   * Embed the profiles.
+   */
+  auto &context = M.getContext();
+  auto int64 = IntegerType::get(context, 64);
+  auto getValueMetadata = [int64](uint64_t value) -> Metadata * {
+    return ConstantAsMetadata::get(ConstantInt::get(int64, value));
+  };
+  for (auto &F : M) {
+    auto found = profiles.find(F.getName().str());
+    if (found == profiles.end()) {
+      continue;
+    }
+
+    /*
+     * Map the indices to the basic blocks and to the values of the function.
+     */
+    std::vector<BasicBlock *> basicBlocks;
+    for (auto &bb : F) {
+      basicBlocks.push_back(&bb);
+    }
+    std::vector<Value *> values;
+    for (auto &arg : F.args()) {
+      values.push_back(&arg);
+    }
+    for (auto &I : instructions(F)) {
+      values.push_back(&I);
+    }
+
+    /*
+     * Attach the profiles to the headers of the loops.
+     */
+    std::map<BasicBlock *, std::vector<Metadata *>> headers;
+    std::vector<BasicBlock *> headersOrder;
+    for (auto &pair : found->second) {
+      auto headerIndex = pair.first.first;
+      auto liveInIndex = pair.first.second;
+      if (false || (headerIndex >= basicBlocks.size())
+          || (liveInIndex >= values.size())) {
+        errs() << "ValueProfilerEmbedder: Warning = the profiles of "
+               << F.getName() << " do not match its code\n";
+        break;
+      }
+
+      /*
+       * Identify the live-in.
+       */
+      Metadata *liveInID = nullptr;
+      auto liveIn = values[liveInIndex];
+      if (auto liveInInst = dyn_cast<Instruction>(liveIn)) {
+        auto valueID = liveInInst->getMetadata(valueMetadataName);
+        if (valueID == nullptr) {
+          valueID = MDNode::getDistinct(context, {});
+          liveInInst->setMetadata(valueMetadataName, valueID);
+        }
+        liveInID = valueID;
+      } else {
+        liveInID = getValueMetadata(liveInIndex);
+      }
+
+      /*
+       * Keep the most frequent values.
+       */
+      std::vector<std::pair<int64_t, uint64_t>> hotValues(
+          pair.second.counts.begin(),
+          pair.second.counts.end());
+      std::stable_sort(hotValues.begin(),
+                       hotValues.end(),
+                       [](const std::pair<int64_t, uint64_t> &a,
+                          const std::pair<int64_t, uint64_t> &b) -> bool {
+                         return a.second > b.second;
+                       });
+      if (hotValues.size() > LoopValueProfiles::numberOfValues) {
+        hotValues.resize(LoopValueProfiles::numberOfValues);
+      }
+      std::vector<Metadata *> profile = {
+        liveInID,
+        getValueMetadata(pair.second.invocations)
+      };
+      for (auto &hotValue : hotValues) {
+        profile.push_back(getValueMetadata(hotValue.first));
+        profile.push_back(getValueMetadata(hotValue.second));
+      }
+
+      auto header = basicBlocks[headerIndex];
+      if (headers.find(header) == headers.end()) {
+        headersOrder.push_back(header);
+      }
+      headers[header].push_back(MDNode::get(context, profile));
+    }
+    for (auto header : headersOrder) {
+      header->getTerminator()->setMetadata(
+          metadataName,
+          MDNode::get(context, headers[header]));
+    }
+  }
+
+  return true;
+}
+
+void ValueProfilerEmbedder::getAnalysisUsage(AnalysisUsage &AU) const {
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char ValueProfilerEmbedder::ID = 0;
+static RegisterPass<ValueProfilerEmbedder> X(
+    "noelle-value-profiler-embed",
+    "Embed the profiles of the live-ins of loops");
+
+} // namespace llvm::noelle
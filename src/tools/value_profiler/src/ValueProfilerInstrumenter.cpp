@@ -0,0 +1,421 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "llvm/Transforms/Utils/ModuleUtils.h"
+#include "ValueProfiler.hpp"
+
+namespace llvm::noelle {
+
+/*
+ * Options of the pass.
+ */
+static cl::opt<bool> ProfileLiveIns(
+    "noelle-value-profiler-live-ins",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Profile all integer live-ins of the hot loops"));
+
+ValueProfilerInstrumenter::ValueProfilerInstrumenter() : ModulePass(ID) {
+  return;
+}
+
+bool ValueProfilerInstrumenter::doInitialization(Module &M) {
+  return false;
+}
+
+bool ValueProfilerInstrumenter::runOnModule(Module &M) {
+
+  /*
+   * Fetch the live-ins to profile.
+   */
+  auto &noelle = getAnalysis<Noelle>();
+  auto liveIns = this->fetchLiveIns(noelle);
+  if (liveIns.size() == 0) {
+    return false;
+  }
+  errs() << "ValueProfiler: Profile " << liveIns.size() << " live-ins\n";
+
+  /*
+   * Name the live-ins by the positions of their loop and of themselves
+   * within their function.
+   */
+  std::unordered_map<Value *, uint64_t> indices;
+  for (auto &profiledLiveIn : liveIns) {
+    auto F = profiledLiveIn.loop->getFunction();
+    if (indices.find(profiledLiveIn.loop->getHeader()) != indices.end()) {
+      continue;
+    }
+    uint64_t index = 0;
+    for (auto &bb : *F) {
+      indices[&bb] = index;
+      index++;
+    }
+    index = 0;
+    for (auto &arg : F->args()) {
+      indices[&arg] = index;
+      index++;
+    }
+    for (auto &I : instructions(F)) {
+      indices[&I] = index;
+      index++;
+    }
+  }
+  std::vector<std::string> names;
+  for (auto &profiledLiveIn : liveIns) {
+    auto loop = profiledLiveIn.loop;
+    names.push_back(std::to_string(indices[loop->getHeader()]) + " "
+                    + std::to_string(indices[profiledLiveIn.liveIn]) + " "
+                    + loop->getFunction()->getName().str());
+  }
+
+  /*
+   * Allocate the counters of the live-ins.
+   */
+  auto int64 = IntegerType::get(M.getContext(), 64);
+  auto zero = ConstantInt::get(int64, 0);
+  auto countersType =
+      ArrayType::get(int64, liveIns.size() * countersPerLiveIn);
+  auto counters = new GlobalVariable(M,
+                                     countersType,
+                                     /*isConstant=*/false,
+                                     GlobalValue::InternalLinkage,
+                                     Constant::getNullValue(countersType),
+                                     "noelle.value_profiles.counters");
+
+  /*
+   * Record the live-ins when their loop starts.
+   */
+  auto recordFunction = this->createRecordFunction(M);
+  for (uint64_t index = 0; index < liveIns.size(); index++) {
+    auto &profiledLiveIn = liveIns[index];
+    IRBuilder<> builder{
+      profiledLiveIn.loop->getPreHeader()->getTerminator()
+    };
+    auto liveInCounters = builder.CreateInBoundsGEP(
+        counters,
+        ArrayRef<Value *>(
+            { zero, ConstantInt::get(int64, index * countersPerLiveIn) }));
+    auto value = builder.CreateSExtOrTrunc(profiledLiveIn.liveIn, int64);
+    builder.CreateCall(recordFunction,
+                       ArrayRef<Value *>({ liveInCounters, value }));
+  }
+
+  /*
+   * Dump the profiles when the program exits.
+   */
+  auto dumpFunction = this->createDumpFunction(M, counters, names);
+  appendToGlobalDtors(M, dumpFunction, 0);
+
+  return true;
+}
+
+std::vector<ValueProfilerInstrumenter::ProfiledLiveIn>
+ValueProfilerInstrumenter::fetchLiveIns(Noelle &noelle) {
+  std::vector<ProfiledLiveIn> liveIns;
+
+  /*
+   * Fetch the live-ins of the hot loops.
+   * Only integers that are available before the loop starts can be profiled.
+   */
+  auto loops = noelle.getLoopStructures();
+  for (auto loop : *loops) {
+    if (loop->getPreHeader() == nullptr) {
+      continue;
+    }
+    auto canBeProfiled = [loop](Value *v) -> bool {
+      if (false || (!v->getType()->isIntegerTy())
+          || (v->getType()->getIntegerBitWidth() > 64)) {
+        return false;
+      }
+      if (isa<Argument>(v)) {
+        return true;
+      }
+      if (auto inst = dyn_cast<Instruction>(v)) {
+        return !loop->isIncluded(inst);
+      }
+      return false;
+    };
+
+    /*
+     * Fetch the bound and the start value of the loop-governing IV.
+     */
+    std::vector<Value *> liveInsOfLoop;
+    auto LDI = noelle.getLoop(loop);
+    auto loopGoverningIVAttr = LDI->getLoopGoverningIVAttribution();
+    if (loopGoverningIVAttr != nullptr) {
+      auto &IV = loopGoverningIVAttr->getInductionVariable();
+      liveInsOfLoop.push_back(loopGoverningIVAttr->getExitConditionValue());
+      liveInsOfLoop.push_back(IV.getStartValue());
+    }
+
+    /*
+     * Fetch the other live-ins.
+     */
+    if (ProfileLiveIns.getNumOccurrences() > 0) {
+      auto env = LDI->getEnvironment();
+      for (auto producer : env->getProducers()) {
+        if (env->isLiveIn(producer)) {
+          liveInsOfLoop.push_back(producer);
+        }
+      }
+    }
+
+    std::unordered_set<Value *> profiled;
+    for (auto liveIn : liveInsOfLoop) {
+      if (false || (liveIn == nullptr) || (!canBeProfiled(liveIn))
+          || (profiled.count(liveIn) > 0)) {
+        continue;
+      }
+      profiled.insert(liveIn);
+      liveIns.push_back({ loop, liveIn });
+    }
+  }
+  delete loops;
+
+  return liveIns;
+}
+
+Function *ValueProfilerInstrumenter::createRecordFunction(Module &M) {
+  auto &context = M.getContext();
+  auto int64 = IntegerType::get(context, 64);
+  auto one = ConstantInt::get(int64, 1);
+
+  /*
+   * Create the function.
+   * It takes the counters of a live-in and its current value.
+   */
+  auto recordFunction = Function::Create(
+      FunctionType::get(Type::getVoidTy(context),
+                        { PointerType::getUnqual(int64), int64 },
+                        false),
+      GlobalValue::InternalLinkage,
+      "noelle.value_profiles.record",
+      M);
+  auto counters = &*recordFunction->arg_begin();
+  auto value = &*(recordFunction->arg_begin() + 1);
+  auto entryBB = BasicBlock::Create(context, "entry", recordFunction);
+  auto slotBB = BasicBlock::Create(context, "slot", recordFunction);
+  auto compareBB = BasicBlock::Create(context, "compare", recordFunction);
+  auto hitBB = BasicBlock::Create(context, "hit", recordFunction);
+  auto claimBB = BasicBlock::Create(context, "claim", recordFunction);
+  auto nextSlotBB = BasicBlock::Create(context, "nextSlot", recordFunction);
+  auto exitBB = BasicBlock::Create(context, "exit", recordFunction);
+
+  /*
+   * Count the invocation.
+   */
+  IRBuilder<> builder{ entryBB };
+  builder.CreateStore(builder.CreateAdd(builder.CreateLoad(counters), one),
+                      counters);
+  builder.CreateBr(slotBB);
+
+  /*
+   * Iterate over the slots of the values.
+   * The first free slot is claimed by a value seen for the first time.
+   */
+  builder.SetInsertPoint(slotBB);
+  auto slot = builder.CreatePHI(int64, 2);
+  slot->addIncoming(ConstantInt::get(int64, 0), entryBB);
+  auto valueIndex =
+      builder.CreateAdd(builder.CreateMul(slot, ConstantInt::get(int64, 2)),
+                        one);
+  auto valuePtr = builder.CreateInBoundsGEP(counters, valueIndex);
+  auto countPtr =
+      builder.CreateInBoundsGEP(counters, builder.CreateAdd(valueIndex, one));
+  auto count = builder.CreateLoad(countPtr);
+  builder.CreateCondBr(builder.CreateICmpEQ(count, ConstantInt::get(int64, 0)),
+                       claimBB,
+                       compareBB);
+
+  builder.SetInsertPoint(compareBB);
+  auto slotValue = builder.CreateLoad(valuePtr);
+  builder.CreateCondBr(builder.CreateICmpEQ(slotValue, value),
+                       hitBB,
+                       nextSlotBB);
+
+  builder.SetInsertPoint(hitBB);
+  builder.CreateStore(builder.CreateAdd(count, one), countPtr);
+  builder.CreateRetVoid();
+
+  builder.SetInsertPoint(claimBB);
+  builder.CreateStore(value, valuePtr);
+  builder.CreateStore(one, countPtr);
+  builder.CreateRetVoid();
+
+  builder.SetInsertPoint(nextSlotBB);
+  auto nextSlot = builder.CreateAdd(slot, one);
+  slot->addIncoming(nextSlot, nextSlotBB);
+  builder.CreateCondBr(
+      builder.CreateICmpEQ(
+          nextSlot,
+          ConstantInt::get(int64, LoopValueProfiles::numberOfValues)),
+      exitBB,
+      slotBB);
+
+  builder.SetInsertPoint(exitBB);
+  builder.CreateRetVoid();
+
+  return recordFunction;
+}
+
+Function *ValueProfilerInstrumenter::createDumpFunction(
+    Module &M,
+    GlobalVariable *counters,
+    std::vector<std::string> &names) {
+  auto &context = M.getContext();
+  auto voidType = Type::getVoidTy(context);
+  auto int32 = IntegerType::get(context, 32);
+  auto int64 = IntegerType::get(context, 64);
+  auto ptrType = PointerType::getUnqual(IntegerType::get(context, 8));
+
+  /*
+   * Fetch the functions of the C library used to dump the profiles.
+   * Files are represented as opaque pointers.
+   */
+  auto fopenFunction = M.getOrInsertFunction(
+      "fopen",
+      FunctionType::get(ptrType, { ptrType, ptrType }, false));
+  auto fprintfFunction = M.getOrInsertFunction(
+      "fprintf",
+      FunctionType::get(int32, { ptrType, ptrType }, true));
+  auto fcloseFunction =
+      M.getOrInsertFunction("fclose",
+                            FunctionType::get(int32, { ptrType }, false));
+
+  /*
+   * Create the function.
+   */
+  auto dumpFunction = Function::Create(FunctionType::get(voidType, false),
+                                       GlobalValue::InternalLinkage,
+                                       "noelle.value_profiles.dump",
+                                       M);
+  auto entryBB = BasicBlock::Create(context, "entry", dumpFunction);
+  auto liveInBB = BasicBlock::Create(context, "liveIn", dumpFunction);
+  auto printBB = BasicBlock::Create(context, "print", dumpFunction);
+  auto nextLiveInBB = BasicBlock::Create(context, "nextLiveIn", dumpFunction);
+  auto closeBB = BasicBlock::Create(context, "close", dumpFunction);
+  auto exitBB = BasicBlock::Create(context, "exit", dumpFunction);
+
+  /*
+   * Open the file.
+   */
+  IRBuilder<> builder{ entryBB };
+  std::vector<Constant *> nameConstants;
+  for (auto &name : names) {
+    nameConstants.push_back(
+        cast<Constant>(builder.CreateGlobalStringPtr(name)));
+  }
+  auto namesType = ArrayType::get(ptrType, nameConstants.size());
+  auto namesArray =
+      new GlobalVariable(M,
+                         namesType,
+                         /*isConstant=*/true,
+                         GlobalValue::InternalLinkage,
+                         ConstantArray::get(namesType, nameConstants),
+                         "noelle.value_profiles.names");
+  auto file = builder.CreateCall(
+      fopenFunction,
+      ArrayRef<Value *>({ builder.CreateGlobalStringPtr(defaultFileName),
+                          builder.CreateGlobalStringPtr("a") }));
+  auto isFileOpen =
+      builder.CreateICmpNE(file, ConstantPointerNull::get(ptrType));
+  std::string format = "%llu";
+  for (auto i = 0u; i < LoopValueProfiles::numberOfValues; i++) {
+    format += " %lld %llu";
+  }
+  format += " %s\n";
+  auto formatString = builder.CreateGlobalStringPtr(format);
+  builder.CreateCondBr(isFileOpen, liveInBB, exitBB);
+
+  /*
+   * Iterate over the live-ins.
+   */
+  auto zero = ConstantInt::get(int64, 0);
+  builder.SetInsertPoint(liveInBB);
+  auto liveInIndex = builder.CreatePHI(int64, 2);
+  liveInIndex->addIncoming(zero, entryBB);
+  auto firstCounter = builder.CreateMul(
+      liveInIndex,
+      ConstantInt::get(int64, countersPerLiveIn));
+  auto invocations = builder.CreateLoad(builder.CreateInBoundsGEP(
+      counters,
+      ArrayRef<Value *>({ zero, firstCounter })));
+  builder.CreateCondBr(builder.CreateICmpEQ(invocations, zero),
+                       nextLiveInBB,
+                       printBB);
+
+  /*
+   * Dump the live-ins whose loop has been invoked as
+   * "INVOCATIONS VALUE COUNT ... VALUE COUNT HEADER_INDEX LIVE_IN_INDEX
+   * FUNCTION_NAME"
+   */
+  builder.SetInsertPoint(printBB);
+  std::vector<Value *> arguments = { file, formatString };
+  for (uint64_t i = 0; i < countersPerLiveIn; i++) {
+    auto counter = builder.CreateLoad(builder.CreateInBoundsGEP(
+        counters,
+        ArrayRef<Value *>(
+            { zero,
+              builder.CreateAdd(firstCounter, ConstantInt::get(int64, i)) })));
+    arguments.push_back(counter);
+  }
+  auto name = builder.CreateLoad(
+      builder.CreateInBoundsGEP(namesArray,
+                                ArrayRef<Value *>({ zero, liveInIndex })));
+  arguments.push_back(name);
+  builder.CreateCall(fprintfFunction, arguments);
+  builder.CreateBr(nextLiveInBB);
+
+  builder.SetInsertPoint(nextLiveInBB);
+  auto nextLiveInIndex =
+      builder.CreateAdd(liveInIndex, ConstantInt::get(int64, 1));
+  liveInIndex->addIncoming(nextLiveInIndex, nextLiveInBB);
+  auto isLastLiveIn =
+      builder.CreateICmpEQ(nextLiveInIndex,
+                           ConstantInt::get(int64, names.size()));
+  builder.CreateCondBr(isLastLiveIn, closeBB, liveInBB);
+
+  /*
+   * Close the file.
+   */
+  builder.SetInsertPoint(closeBB);
+  builder.CreateCall(fcloseFunction, ArrayRef<Value *>({ file }));
+  builder.CreateBr(exitBB);
+
+  builder.SetInsertPoint(exitBB);
+  builder.CreateRetVoid();
+
+  return dumpFunction;
+}
+
+void ValueProfilerInstrumenter::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<Noelle>();
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char ValueProfilerInstrumenter::ID = 0;
+static RegisterPass<ValueProfilerInstrumenter> X(
+    "noelle-value-profiler-instr",
+    "Instrument the hot loops to profile the values of their live-ins");
+
+} // namespace llvm::noelle
@@ -0,0 +1,448 @@
+/*
+ * Copyright 2022  Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <chrono>
+#include "llvm/Support/Path.h"
+#include "noelle/core/Noelle.hpp"
+#include "noelle/core/BitMatrix.hpp"
+
+using namespace llvm;
+using namespace llvm::noelle;
+
+/*
+ * Micro-benchmarks of the graph and data-flow primitives NOELLE is built on.
+ *
+ * Each benchmark prints a line "BENCHMARK INPUT SIZE NANOSECONDS" where SIZE
+ * is the number of elements it processed (e.g., edges or instructions) and
+ * NANOSECONDS is its fastest repetition.
+ * The benchmarks on the input program add up the measurements of all its
+ * functions (or loops).
+ */
+static cl::opt<std::string> InputName(
+    "graph-benchmarks-input",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::desc("Name of the input program to print (default: the name of the "
+             "module)"));
+static cl::opt<int> Repetitions(
+    "graph-benchmarks-repetitions",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init(5),
+    cl::desc("Number of repetitions of each benchmark (default: 5)"));
+static cl::opt<int> MaxSyntheticSize(
+    "graph-benchmarks-max-synthetic",
+    cl::ZeroOrMore,
+    cl::Hidden,
+    cl::init(4096),
+    cl::desc("Largest synthetic relation to close transitively (0: skip the "
+             "synthetic benchmarks)"));
+
+namespace {
+
+class GraphBenchmarks : public ModulePass {
+public:
+  static char ID;
+
+  GraphBenchmarks() : ModulePass{ ID } {}
+
+  bool doInitialization(Module &M) override {
+    return false;
+  }
+
+  bool runOnModule(Module &M) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<Noelle>();
+    AU.setPreservesAll();
+    return;
+  }
+
+private:
+  void benchmarkEdges(const std::string &input, Module &M);
+
+  void benchmarkSubgraphs(const std::string &input, Module &M, Noelle &noelle);
+
+  void benchmarkTransitiveClosure(const std::string &input,
+                                  Module &M,
+                                  Noelle &noelle);
+
+  void benchmarkSyntheticTransitiveClosure(void);
+
+  void benchmarkDataFlow(const std::string &input,
+                         Module &M,
+                         Noelle &noelle);
+};
+
+/*
+ * Run @body the number of repetitions requested and return the nanoseconds of
+ * the fastest one.
+ * @setup and @teardown run around each repetition and they are not measured.
+ */
+uint64_t measure(std::function<void(void)> setup,
+                 std::function<void(void)> body,
+                 std::function<void(void)> teardown) {
+  uint64_t fastest = 0;
+  auto repetitions = std::max(1, Repetitions.getValue());
+  for (auto r = 0; r < repetitions; r++) {
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    teardown();
+    uint64_t time =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count();
+    if (false || (r == 0) || (time < fastest)) {
+      fastest = time;
+    }
+  }
+
+  return fastest;
+}
+
+void printMeasurement(const std::string &benchmark,
+                      const std::string &input,
+                      uint64_t size,
+                      uint64_t nanoseconds) {
+  outs() << benchmark << " " << input << " " << size << " " << nanoseconds
+         << "\n";
+  return;
+}
+
+/*
+ * Return the instructions of @loop in the order of the blocks of its
+ * function, which makes the benchmarks reproducible.
+ */
+std::vector<Value *> getLoopValues(LoopStructure *loop) {
+  std::vector<Value *> values;
+  auto f = loop->getFunction();
+  for (auto &bb : *f) {
+    if (!loop->isIncluded(&bb)) {
+      continue;
+    }
+    for (auto &inst : bb) {
+      values.push_back(&inst);
+    }
+  }
+
+  return values;
+}
+
+} // namespace
+
+bool GraphBenchmarks::runOnModule(Module &M) {
+  auto &noelle = getAnalysis<Noelle>();
+
+  /*
+   * Fetch the name of the input.
+   */
+  std::string input = InputName.getValue();
+  if (input == "") {
+    input = sys::path::stem(M.getModuleIdentifier()).str();
+  }
+
+  outs() << "# BENCHMARK INPUT SIZE NANOSECONDS\n";
+  this->benchmarkEdges(input, M);
+  this->benchmarkSubgraphs(input, M, noelle);
+  this->benchmarkTransitiveClosure(input, M, noelle);
+  this->benchmarkSyntheticTransitiveClosure();
+  this->benchmarkDataFlow(input, M, noelle);
+
+  return false;
+}
+
+void GraphBenchmarks::benchmarkEdges(const std::string &input, Module &M) {
+
+  /*
+   * Collect the def-use chains of the program, which are the edges to add.
+   */
+  std::vector<std::pair<Value *, Value *>> chains;
+  std::vector<Value *> values;
+  for (auto &f : M) {
+    for (auto &inst : instructions(f)) {
+      values.push_back(&inst);
+      for (auto user : inst.users()) {
+        if (!isa<Instruction>(user)) {
+          continue;
+        }
+        chains.push_back(std::make_pair(&inst, user));
+      }
+    }
+  }
+
+  /*
+   * Add the edges to graphs with and without the arena allocation.
+   */
+  for (auto arena : { false, true }) {
+    DG<Value> *graph = nullptr;
+    auto setup = [&]() {
+      graph = new DG<Value>();
+      if (arena) {
+        graph->enableArenaAllocation();
+      }
+      for (auto value : values) {
+        graph->addNode(value, true);
+      }
+    };
+    auto body = [&]() {
+      for (auto &chain : chains) {
+        graph->addEdge(chain.first, chain.second);
+      }
+    };
+    auto teardown = [&]() { delete graph; };
+    auto time = measure(setup, body, teardown);
+    printMeasurement(arena ? "DG::addEdge(arena)" : "DG::addEdge",
+                     input,
+                     chains.size(),
+                     time);
+  }
+
+  /*
+   * Fetch the edges between the nodes of each def-use chain.
+   */
+  DG<Value> graph;
+  for (auto value : values) {
+    graph.addNode(value, true);
+  }
+  for (auto &chain : chains) {
+    graph.addEdge(chain.first, chain.second);
+  }
+  uint64_t fetched = 0;
+  auto body = [&]() {
+    fetched = 0;
+    for (auto &chain : chains) {
+      auto fromNode = graph.fetchNode(chain.first);
+      auto toNode = graph.fetchNode(chain.second);
+      fetched += graph.fetchEdges(fromNode, toNode).size();
+    }
+  };
+  auto time = measure([]() {}, body, []() {});
+  printMeasurement("DG::fetchEdges", input, fetched, time);
+
+  return;
+}
+
+void GraphBenchmarks::benchmarkSubgraphs(const std::string &input,
+                                         Module &M,
+                                         Noelle &noelle) {
+  uint64_t subgraphTime = 0;
+  uint64_t subgraphValues = 0;
+  uint64_t sccdagTime = 0;
+  uint64_t sccdagNodes = 0;
+  for (auto &f : M) {
+    if (f.empty()) {
+      continue;
+    }
+    auto loops = noelle.getLoopStructures(&f);
+    if (loops->size() == 0) {
+      delete loops;
+      continue;
+    }
+    auto fdg = noelle.getFunctionDependenceGraph(&f);
+
+    for (auto loop : *loops) {
+      auto values = getLoopValues(loop);
+
+      /*
+       * Extract the dependence graph of the loop.
+       */
+      PDG *loopDG = nullptr;
+      auto extract = [&]() {
+        loopDG = fdg->createSubgraphFromValues(values, true);
+      };
+      auto release = [&]() { delete loopDG; };
+      subgraphTime += measure([]() {}, extract, release);
+      subgraphValues += values.size();
+
+      /*
+       * Compute the SCCDAG of the loop.
+       */
+      loopDG = fdg->createSubgraphFromValues(values, false);
+      SCCDAG *sccdag = nullptr;
+      auto compute = [&]() { sccdag = new SCCDAG(loopDG); };
+      auto releaseSCCDAG = [&]() { delete sccdag; };
+      sccdagTime += measure([]() {}, compute, releaseSCCDAG);
+      sccdagNodes += loopDG->numNodes();
+      delete loopDG;
+    }
+    delete fdg;
+    delete loops;
+  }
+  printMeasurement("PDG::createSubgraphFromValues",
+                   input,
+                   subgraphValues,
+                   subgraphTime);
+  printMeasurement("SCCDAG", input, sccdagNodes, sccdagTime);
+
+  return;
+}
+
+void GraphBenchmarks::benchmarkTransitiveClosure(const std::string &input,
+                                                 Module &M,
+                                                 Noelle &noelle) {
+  uint64_t time = 0;
+  uint64_t nodes = 0;
+  for (auto &f : M) {
+    if (f.empty()) {
+      continue;
+    }
+
+    /*
+     * Map the internal nodes of the dependence graph of the function to the
+     * rows of a relation.
+     */
+    auto fdg = noelle.getFunctionDependenceGraph(&f);
+    std::unordered_map<DGNode<Value> *, uint32_t> rows;
+    for (auto nodePair : fdg->internalNodePairs()) {
+      auto row = rows.size();
+      rows[nodePair.second] = row;
+    }
+    BitMatrix relation;
+    auto setup = [&]() {
+      relation.resize(rows.size());
+      for (auto edge : fdg->getEdges()) {
+        auto from = rows.find(edge->getOutgoingNode());
+        auto to = rows.find(edge->getIncomingNode());
+        if (false || (from == rows.end()) || (to == rows.end())) {
+          continue;
+        }
+        relation.set(from->second, to->second);
+      }
+    };
+    auto body = [&]() { relation.transitiveClosure(); };
+    time += measure(setup, body, []() {});
+    nodes += rows.size();
+    delete fdg;
+  }
+  printMeasurement("BitMatrix::transitiveClosure", input, nodes, time);
+
+  return;
+}
+
+void GraphBenchmarks::benchmarkSyntheticTransitiveClosure(void) {
+
+  /*
+   * Close relations with four successors per row.
+   * Acyclic relations are the ones of DAGs (e.g., SCCDAGs) while the cyclic
+   * ones are the ones of dependence graphs.
+   */
+  for (uint32_t size = 64; size <= (uint32_t)MaxSyntheticSize.getValue();
+       size *= 4) {
+    for (auto acyclic : { true, false }) {
+      BitMatrix relation;
+      auto setup = [&]() {
+        relation.resize(size);
+        uint64_t seed = 1;
+        for (uint32_t row = 0; row < size; row++) {
+          for (auto s = 0; s < 4; s++) {
+            seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+            auto col = (uint32_t)((seed >> 33) % size);
+            if (acyclic) {
+              if (row + 1 >= size) {
+                continue;
+              }
+              col = row + 1 + (col % (size - row - 1));
+            }
+            relation.set(row, col);
+          }
+        }
+      };
+      auto body = [&]() { relation.transitiveClosure(); };
+      auto time = measure(setup, body, []() {});
+      printMeasurement("BitMatrix::transitiveClosure",
+                       std::string(acyclic ? "synthetic_dag_" : "synthetic_")
+                           + std::to_string(size),
+                       size,
+                       time);
+    }
+  }
+
+  return;
+}
+
+void GraphBenchmarks::benchmarkDataFlow(const std::string &input,
+                                        Module &M,
+                                        Noelle &noelle) {
+
+  /*
+   * Reaching stores: the stores that reach each instruction within its
+   * function.
+   */
+  auto computeGEN = [](Instruction *i, DataFlowResult *df) {
+    if (!isa<StoreInst>(i)) {
+      return;
+    }
+    auto &gen = df->GEN(i);
+    gen.insert(i);
+    return;
+  };
+  auto initializeIN = [](Instruction *inst, std::set<Value *> &IN) { return; };
+  auto initializeOUT = [](Instruction *inst, std::set<Value *> &OUT) {
+    return;
+  };
+  auto computeIN = [](Instruction *inst,
+                      std::set<Value *> &IN,
+                      Instruction *predecessor,
+                      DataFlowResult *df) {
+    auto &outP = df->OUT(predecessor);
+    IN.insert(outP.begin(), outP.end());
+    return;
+  };
+  auto computeOUT =
+      [](Instruction *inst, std::set<Value *> &OUT, DataFlowResult *df) {
+        auto &inI = df->IN(inst);
+        auto &genI = df->GEN(inst);
+        OUT.insert(inI.begin(), inI.end());
+        OUT.insert(genI.begin(), genI.end());
+        return;
+      };
+
+  uint64_t time = 0;
+  uint64_t instructions = 0;
+  auto dfa = noelle.getDataFlowEngine();
+  for (auto &f : M) {
+    if (f.empty()) {
+      continue;
+    }
+    DataFlowResult *result = nullptr;
+    auto body = [&]() {
+      result = dfa.applyForward(&f,
+                                computeGEN,
+                                initializeIN,
+                                initializeOUT,
+                                computeIN,
+                                computeOUT);
+    };
+    auto release = [&]() { delete result; };
+    time += measure([]() {}, body, release);
+    instructions += f.getInstructionCount();
+  }
+  printMeasurement("DataFlowEngine::applyForward", input, instructions, time);
+
+  return;
+}
+
+// Next there is code to register your pass to "opt"
+char GraphBenchmarks::ID = 0;
+static RegisterPass<GraphBenchmarks> X(
+    "GraphBenchmarks",
+    "Micro-benchmarks of the dependence graphs and of the data-flow engine");
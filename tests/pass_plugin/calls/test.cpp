@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+static int increment (int *p){
+  *p = *p + 1;
+  return *p;
+}
+
+static int decrement (int *p){
+  *p = *p - 1;
+  return *p;
+}
+
+int main (int argc, char *argv[]){
+  auto v = (int *) malloc(sizeof(int) * 100);
+  int (*f)(int *) = (argc > 1) ? increment : decrement;
+
+  for (int i = 0; i < 100; ++i) {
+    v[i] = i;
+    increment(&v[i]);
+    f(&v[i]);
+  }
+
+  printf("%d\n", v[argc]);
+  free(v);
+  return 0;
+}
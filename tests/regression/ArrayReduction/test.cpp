@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+long long int histogram[64];
+long long int weights[64];
+long long int notCommutative[64];
+
+long long int computeBin (long long int i){
+  long long int v = i;
+  for (auto j=0; j < 100; j++){
+    v = (v * 31 + j) % 1009;
+  }
+
+  return v;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 1000;
+
+  /*
+   * Many iterations update the same bin, so the private copies of the tasks
+   * must be merged.
+   */
+  for (auto i=0; i < iterations; i++){
+    auto b = computeBin(i);
+    histogram[b % 64]++;
+  }
+
+  /*
+   * Each iteration updates two bins that can be the same one.
+   */
+  double sums[32] = { 0 };
+  for (auto i=0; i < iterations; i++){
+    auto b = computeBin(i * 3);
+    weights[b % 64] += b;
+    weights[(b / 7) % 64] -= i;
+    sums[b % 32] += (double)(b % 5);
+  }
+
+  /*
+   * The updates do not commute, so the loop cannot use private copies.
+   */
+  for (auto i=0; i < iterations; i++){
+    auto b = computeBin(i * 5);
+    notCommutative[b % 64] = (notCommutative[b % 64] * 3 + b) % 1000003;
+  }
+
+  for (auto j=0; j < 64; j++){
+    printf("%d: %lld %lld %lld %.1f\n", j, histogram[j], weights[j], notCommutative[j], sums[j % 32]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+void printSquareRoots (long long int first, long long int iters){
+
+  for (auto i=first; i < iters; i++){
+    auto v = sqrt((double)i);
+    printf("Root of %lld = %.3f\n", i, v);
+  }
+  printf("Printed %lld roots\n", iters - first);
+
+  return ;
+}
+
+void printCountDown (long long int iters){
+
+  for (auto i=iters; i > 0; i--){
+    auto v = (i * 42) % 17;
+    printf("Count down %lld: %lld\n", i, v);
+  }
+
+  return ;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 10;
+
+  /*
+   * Invoke the loops more than once.
+   * The output of an invocation must be written when the invocation returns.
+   */
+  for (auto j=0; j < 3; j++){
+    printSquareRoots(j, iterations);
+    printCountDown(iterations + j);
+  }
+
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoi(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 10;
+
+  /*
+   * The value printed depends on the previous iteration.
+   */
+  unsigned long long int t = 1;
+  for (auto i=0; i < iterations; i++){
+    unsigned long long int w = i;
+    for (auto j=0; j < 1000; j++){
+      w = (w * 31 + j) % 1000003;
+    }
+    t = (t * 7 + w) % 1000000007;
+    printf("Iteration %d: %llu %llu\n", i, w, t);
+  }
+  printf("Total = %llu\n", t);
+
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoi(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 10;
+
+  /*
+   * Prepare a line longer than the buffer of a single formatted output.
+   */
+  char line[600];
+  for (auto i=0; i < 599; i++){
+    line[i] = 'a' + (i % 26);
+  }
+  line[599] = '\0';
+
+  /*
+   * The output of the loop is the last output of the program.
+   * Hence, it must reach the stream before the program exits.
+   */
+  for (auto i=0; i < iterations; i++){
+    putchar('0' + (i % 10));
+    putchar(':');
+    fwrite(line + (i % 26), 1, 300, stdout);
+    putchar('\n');
+    puts(line + (i % 13));
+  }
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * The updates of the histogram commute, so the iterations can apply them in
+ * any order.
+ */
+long long int histogram[16] __attribute__((annotate("noelle.commutative")));
+
+long long int computeValue (long long int i){
+  long long int v = i;
+  for (auto j=0; j < 1000; j++){
+    v = (v * 31 + j) % 1000003;
+  }
+
+  return v;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 100;
+
+  /*
+   * Every iteration updates the histogram.
+   */
+  for (auto i=0; i < iterations; i++){
+    auto v = computeValue(i);
+    histogram[v % 16] += v;
+  }
+
+  /*
+   * The loop can exit from its body, which must leave the critical section.
+   */
+  long long int i = 0;
+  while (i < iterations){
+    auto v = computeValue(i);
+    histogram[v % 16]++;
+    if ((v % 1009) == 7){
+      break;
+    }
+    i++;
+  }
+
+  for (auto j=0; j < 16; j++){
+    printf("%d: %lld\n", j, histogram[j]);
+  }
+  printf("Last iteration: %lld\n", i);
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+double computeValue (double v){
+  for (auto j=0; j < 100; j++){
+    v = v * 0.5 + j;
+  }
+
+  return v;
+}
+
+void scatter (double *y, int *idx, double *x, long long int iters){
+  for (auto i=0; i < iters; i++){
+    y[idx[i]] += computeValue(x[i]);
+  }
+
+  return ;
+}
+
+void print (double *y, long long int iters){
+  double s = 0;
+  for (auto i=0; i < iters; i++){
+    s += y[i] * (i % 13);
+  }
+  printf("Checksum %.3f %.3f %.3f\n", s, y[0], y[iters - 1]);
+
+  return ;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 1000;
+
+  double *x = (double *) malloc(sizeof(double) * iterations);
+  double *y = (double *) calloc(iterations, sizeof(double));
+  int *idx = (int *) malloc(sizeof(int) * iterations);
+  for (auto i=0; i < iterations; i++){
+    x[i] = i % 17;
+  }
+
+  /*
+   * Distinct subscripts: the iterations are independent.
+   * The second invocation uses the same subscripts.
+   */
+  for (auto i=0; i < iterations; i++){
+    idx[i] = (i * 7919) % iterations;
+    if ((iterations % 7919) == 0){
+      idx[i] = iterations - 1 - i;
+    }
+  }
+  scatter(y, idx, x, iterations);
+  print(y, iterations);
+  scatter(y, idx, x, iterations);
+  print(y, iterations);
+
+  /*
+   * Conflicting subscripts: several iterations update the same element.
+   */
+  for (auto i=0; i < iterations; i++){
+    idx[i] = (i * i) % 97;
+  }
+  scatter(y, idx, x, iterations);
+  print(y, iterations);
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+long long int computeValue (long long int i){
+  long long int v = i;
+  for (auto j=0; j < 100; j++){
+    v = (v * 31 + j) % 1009;
+  }
+
+  return v;
+}
+
+/*
+ * Only the first iteration takes the conditional path (eq).
+ */
+long long int peelFirst (long long int *a, long long int n){
+  long long int first = 0;
+  for (long long int i=0; i < n; i++){
+    if (i == 0){
+      first = computeValue(n);
+    }
+    a[i] = computeValue(i) + first;
+  }
+
+  return first;
+}
+
+/*
+ * Only the last iteration takes the conditional path (ne).
+ */
+long long int peelLast (long long int *a, long long int n){
+  long long int last = 0;
+  for (long long int i=0; i < n; i++){
+    if (i != (n - 1)){
+      a[i] = computeValue(i);
+    } else {
+      last = computeValue(i * 3);
+      a[i] = last;
+    }
+  }
+
+  return last;
+}
+
+/*
+ * Both the first and the last iterations take conditional paths.
+ */
+long long int peelBoth (long long int *a, long long int n){
+  long long int ends = 0;
+  for (long long int i=0; i < n; i++){
+    if (i != 0){
+      a[i] = computeValue(i);
+    } else {
+      ends += computeValue(n * 7);
+      a[i] = ends;
+    }
+    if (i == (n - 1)){
+      ends += computeValue(n * 11);
+    }
+  }
+
+  return ends;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 100;
+
+  /*
+   * Run the loops with no iteration, one, two, and many.
+   */
+  long long int *a = (long long int *) calloc(iterations, sizeof(long long int));
+  long long int tripCounts[] = { 0, 1, 2, iterations };
+  for (auto t : tripCounts){
+    auto first = peelFirst(a, t);
+    auto s1 = (t > 0) ? a[t - 1] : -1;
+    auto last = peelLast(a, t);
+    auto s2 = (t > 0) ? a[t - 1] : -1;
+    auto both = peelBoth(a, t);
+    auto s3 = (t > 0) ? a[0] + a[t - 1] : -1;
+    printf("%lld: %lld %lld %lld %lld %lld %lld\n", t, first, s1, last, s2, both, s3);
+  }
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+long long int computeValue (long long int i, long long int j){
+  long long int v = i * 7 + j;
+  for (auto k=0; k < 100; k++){
+    v = (v * 31 + k) % 1009;
+  }
+
+  return v;
+}
+
+/*
+ * The outer loop has too few iterations to keep all cores busy, and the
+ * iterations of both loops are independent.
+ */
+long long int collapsible (long long int *a, long long int m){
+  long long int sum = 0;
+  for (long long int i=0; i < 4; i++){
+    for (long long int j=0; j < m; j++){
+      auto v = computeValue(i, j);
+      a[i * m + j] = v;
+      sum += v;
+    }
+  }
+
+  return sum;
+}
+
+/*
+ * Every iteration of the outer loop updates the same row.
+ * The nest must not be collapsed.
+ */
+void dependentOuterLoop (long long int *a, long long int m){
+  for (long long int i=0; i < 4; i++){
+    for (long long int j=0; j < m; j++){
+      a[j] = (a[j] * 3 + computeValue(i, j)) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * The iteration space of the nest is a triangle.
+ * The nest must not be collapsed.
+ */
+void triangular (long long int *a, long long int m){
+  for (long long int i=0; i < 4; i++){
+    for (long long int j=0; j < (m * i) / 4; j++){
+      a[i * m + j] += computeValue(j, i);
+    }
+  }
+
+  return ;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 100;
+
+  long long int *a = (long long int *) calloc(4 * iterations, sizeof(long long int));
+  long long int *b = (long long int *) calloc(iterations, sizeof(long long int));
+
+  auto sum = collapsible(a, iterations);
+  dependentOuterLoop(b, iterations);
+  triangular(a, iterations);
+
+  long long int checkA = 0;
+  for (auto i=0; i < 4 * iterations; i++){
+    checkA = (checkA * 7 + a[i]) % 1000003;
+  }
+  long long int checkB = 0;
+  for (auto i=0; i < iterations; i++){
+    checkB = (checkB * 7 + b[i]) % 1000003;
+  }
+  printf("%lld %lld %lld\n", sum, checkA, checkB);
+
+  return 0;
+}
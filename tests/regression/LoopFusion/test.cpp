@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+long long int computeValue (long long int i){
+  long long int v = i;
+  for (auto k=0; k < 100; k++){
+    v = (v * 31 + k) % 1009;
+  }
+
+  return v;
+}
+
+/*
+ * The second loop reads only the element the first loop writes at the same
+ * iteration.
+ */
+void fusible (long long int *a, long long int *b, long long int n){
+  for (long long int i=0; i < n; i++){
+    a[i] = computeValue(i);
+  }
+  for (long long int i=0; i < n; i++){
+    b[i] = a[i] * 2 + computeValue(i + 1);
+  }
+
+  return ;
+}
+
+/*
+ * The second loop reads the element the first loop writes at the next
+ * iteration.
+ * The loops must not be fused.
+ */
+void laterIteration (long long int *a, long long int *b, long long int n){
+  for (long long int i=0; i < n; i++){
+    a[i] = computeValue(i + 3);
+  }
+  for (long long int i=0; i < n; i++){
+    b[i] = a[(i + 1) % n] + computeValue(i);
+  }
+
+  return ;
+}
+
+/*
+ * The second loop needs the value the first loop computes.
+ * The loops must not be fused.
+ */
+void valueOfTheFirstLoop (long long int *a, long long int *b, long long int n){
+  long long int sum = 0;
+  for (long long int i=0; i < n; i++){
+    a[i] = computeValue(i * 5);
+    sum += a[i];
+  }
+  for (long long int i=0; i < n; i++){
+    b[i] = (sum + a[i]) % 1000003;
+  }
+
+  return ;
+}
+
+/*
+ * The loops iterate a different number of times.
+ * The loops must not be fused.
+ */
+void differentTripCounts (long long int *a, long long int *b, long long int n){
+  for (long long int i=0; i < n; i++){
+    a[i] = computeValue(i * 7);
+  }
+  for (long long int i=0; i < (n - 1); i++){
+    b[i] = a[i] + computeValue(i);
+  }
+
+  return ;
+}
+
+long long int checksum (long long int *a, long long int n){
+  long long int c = 0;
+  for (auto i=0; i < n; i++){
+    c = (c * 7 + a[i]) % 1000003;
+  }
+
+  return c;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 2){
+    iterations = 2;
+  }
+  iterations *= 100;
+
+  long long int *a = (long long int *) calloc(iterations, sizeof(long long int));
+  long long int *b = (long long int *) calloc(iterations, sizeof(long long int));
+
+  fusible(a, b, iterations);
+  printf("%lld %lld\n", checksum(a, iterations), checksum(b, iterations));
+  laterIteration(a, b, iterations);
+  printf("%lld %lld\n", checksum(a, iterations), checksum(b, iterations));
+  valueOfTheFirstLoop(a, b, iterations);
+  printf("%lld %lld\n", checksum(a, iterations), checksum(b, iterations));
+  differentTripCounts(a, b, iterations);
+  printf("%lld %lld\n", checksum(a, iterations), checksum(b, iterations));
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROWS 256
+#define COLUMNS 256
+
+long long int A[ROWS][COLUMNS];
+long long int B[ROWS][COLUMNS];
+
+void initialize (long long int seed){
+  for (long long int i=0; i < ROWS; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      A[i][j] = (i * 31 + j * 17 + seed) % 101;
+      B[i][j] = 0;
+    }
+  }
+
+  return ;
+}
+
+long long int checksum (void){
+  long long int c = 0;
+  for (long long int i=0; i < ROWS; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      c = (c * 7 + A[i][j]) % 1000003;
+      c = (c * 7 + B[i][j]) % 1000003;
+    }
+  }
+
+  return c;
+}
+
+/*
+ * The inner loop walks down the columns, and all the cells are independent.
+ */
+void independentCells (long long int iterations){
+  for (long long int j=0; j < COLUMNS; j++){
+    for (long long int i=0; i < ROWS; i++){
+      B[i][j] = A[i][j] * 2 + iterations;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every column depends on the previous column of the same row: the distance
+ * vector is (1, 0).
+ */
+void previousColumn (long long int iterations){
+  for (long long int j=1; j < COLUMNS; j++){
+    for (long long int i=0; i < ROWS; i++){
+      A[i][j] = (A[i][j - 1] * 3 + iterations) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every row depends on the previous row of the same column, so the iterations
+ * of the inner loop are dependent.
+ * The nest must not be interchanged.
+ */
+void previousRow (long long int iterations){
+  for (long long int j=0; j < COLUMNS; j++){
+    for (long long int i=1; i < ROWS; i++){
+      A[i][j] = (A[i - 1][j] * 5 + iterations) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every column depends on the next row of the previous column: the distance
+ * vector is (1, -1).
+ * The nest must not be interchanged.
+ */
+void nextRowOfThePreviousColumn (long long int iterations){
+  for (long long int j=1; j < COLUMNS; j++){
+    for (long long int i=0; i < (ROWS - 1); i++){
+      A[i][j] = (A[i + 1][j - 1] * 7 + iterations) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+
+  initialize(iterations);
+  independentCells(iterations);
+  printf("%lld\n", checksum());
+
+  initialize(iterations);
+  previousColumn(iterations);
+  printf("%lld\n", checksum());
+
+  initialize(iterations);
+  previousRow(iterations);
+  printf("%lld\n", checksum());
+
+  initialize(iterations);
+  nextRowOfThePreviousColumn(iterations);
+  printf("%lld\n", checksum());
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * An invocation of the inner loops touches more data than what fits in L2.
+ */
+#define COLUMNS (1 << 18)
+
+/*
+ * The iterations of the outer loop are independent.
+ */
+void tileable (long long int *out, long long int *in, long long int rows){
+  for (long long int i=0; i < rows; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      out[i * COLUMNS + j] = in[j] * (i + 1) + i;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every iteration of the outer loop accumulates into the same row.
+ * The nest must not be tiled.
+ */
+void dependentOuterLoop (long long int *acc, long long int *in, long long int rows){
+  for (long long int i=0; i < rows; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      acc[j] = (acc[j] * 3 + in[j] + i) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every iteration of the outer loop reads the row the previous iteration
+ * wrote.
+ * The nest must not be tiled.
+ */
+void previousRow (long long int *out, long long int rows){
+  for (long long int i=1; i < rows; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      out[i * COLUMNS + j] = (out[(i - 1) * COLUMNS + (COLUMNS - 1 - j)] + j) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+long long int checksum (long long int *a, long long int n){
+  long long int c = 0;
+  for (long long int i=0; i < n; i++){
+    c = (c * 7 + a[i]) % 1000003;
+  }
+
+  return c;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto rows = atoll(argv[1]);
+  if (rows < 2){
+    rows = 2;
+  }
+  if (rows > 64){
+    rows = 64;
+  }
+
+  long long int *in = (long long int *) calloc(COLUMNS, sizeof(long long int));
+  long long int *acc = (long long int *) calloc(COLUMNS, sizeof(long long int));
+  long long int *out = (long long int *) calloc(rows * COLUMNS, sizeof(long long int));
+  for (long long int j=0; j < COLUMNS; j++){
+    in[j] = (j * 13) % 101;
+  }
+
+  tileable(out, in, rows);
+  printf("%lld\n", checksum(out, rows * COLUMNS));
+  dependentOuterLoop(acc, in, rows);
+  printf("%lld\n", checksum(acc, COLUMNS));
+  previousRow(out, rows);
+  printf("%lld\n", checksum(out, rows * COLUMNS));
+
+  return 0;
+}
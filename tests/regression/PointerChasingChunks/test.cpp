@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+struct node {
+  long long int key;
+  long long int value;
+  struct node *next;
+};
+
+long long int computeValue (long long int i){
+  long long int v = i;
+  for (auto k=0; k < 100; k++){
+    v = (v * 31 + k) % 1009;
+  }
+
+  return v;
+}
+
+struct node * createList (long long int length){
+  struct node *head = NULL;
+  for (long long int i=0; i < length; i++){
+    auto n = (struct node *) malloc(sizeof(struct node));
+    n->key = (i * 13) % 1000;
+    n->value = 0;
+    n->next = head;
+    head = n;
+  }
+
+  return head;
+}
+
+void destroyList (struct node *n){
+  while (n != NULL){
+    auto next = n->next;
+    free(n);
+    n = next;
+  }
+
+  return ;
+}
+
+/*
+ * Only the traversal of the list must run in order.
+ */
+long long int processNodes (struct node *n){
+  long long int sum = 0;
+  while (n != NULL){
+    n->value = computeValue(n->key);
+    sum += n->value;
+    n = n->next;
+  }
+
+  return sum;
+}
+
+/*
+ * The hash of the values must be computed in the order of the list.
+ * The traversal must not be chunked.
+ */
+long long int hashNodes (struct node *n){
+  long long int hash = 0;
+  while (n != NULL){
+    hash = (hash * 31 + n->value) % 1000003;
+    n = n->next;
+  }
+
+  return hash;
+}
+
+/*
+ * The traversal reads the pointers that the loop writes.
+ * The traversal must not be chunked.
+ */
+struct node * reverseList (struct node *n){
+  struct node *previous = NULL;
+  while (n != NULL){
+    auto next = n->next;
+    n->next = previous;
+    previous = n;
+    n = next;
+  }
+
+  return previous;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 100;
+
+  /*
+   * Run the loops with lists shorter than, as long as, and longer than a
+   * chunk.
+   */
+  long long int lengths[] = { 0, 1, 63, 64, 65, iterations };
+  for (auto length : lengths){
+    auto list = createList(length);
+    auto sum = processNodes(list);
+    list = reverseList(list);
+    auto hash = hashNodes(list);
+    printf("%lld: %lld %lld\n", length, sum, hash);
+    destroyList(list);
+  }
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+long long int computeValue (long long int i){
+  long long int v = i;
+  for (auto j=0; j < 100; j++){
+    v = (v * 31 + j) % 1009;
+  }
+
+  return v;
+}
+
+/*
+ * The temporary is 64 bytes and the trip count is known only at run time.
+ */
+void smallTemporary (long long int *a, long long int n){
+  long long int t[8];
+  for (long long int i=0; i < n; i++){
+    for (auto j=0; j < 8; j++){
+      t[j] = computeValue(i + j);
+    }
+    long long int s = 0;
+    for (auto j=0; j < 8; j++){
+      s += t[j] * j;
+    }
+    a[i] = s;
+  }
+
+  return ;
+}
+
+/*
+ * The temporary is larger than 64 bytes, so it is not expanded when the trip
+ * count is known only at run time.
+ */
+void largeTemporary (long long int *a, long long int n){
+  long long int t[9];
+  for (long long int i=0; i < n; i++){
+    for (auto j=0; j < 9; j++){
+      t[j] = computeValue(i * j);
+    }
+    a[i] = t[i % 9] + t[(i + 4) % 9];
+  }
+
+  return ;
+}
+
+/*
+ * The loop can exit from its body: the copies must be freed at both exits.
+ */
+long long int earlyExit (long long int *a, long long int n){
+  long long int t[4];
+  long long int i;
+  for (i=0; i < n; i++){
+    memset(t, 0, sizeof(t));
+    t[i % 4] = computeValue(i);
+    if (t[i % 4] == 7){
+      break;
+    }
+    a[i] = t[0] + t[1] + t[2] + t[3];
+  }
+
+  return i;
+}
+
+/*
+ * The temporary is read before being written, so its value flows from one
+ * iteration to the next one and it cannot be expanded.
+ */
+long long int notDominated (long long int *a, long long int n){
+  long long int t[2] = { 1, 2 };
+  for (long long int i=0; i < n; i++){
+    a[i] = t[0] + t[1];
+    t[0] = computeValue(i);
+    t[1] = a[i] % 13;
+  }
+
+  return t[0];
+}
+
+/*
+ * The temporary is a global variable and the copies it needs take more than
+ * 1 MiB, so the original loop runs.
+ */
+static long long int buffer[2];
+long long int manyIterations (long long int n){
+  long long int s = 0;
+  for (long long int i=0; i < n; i++){
+    memset(buffer, 0, sizeof(buffer));
+    buffer[0] = i * 3;
+    buffer[1] = i % 7;
+    s += buffer[0] * buffer[1];
+  }
+
+  return s;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 100;
+
+  long long int *a = (long long int *) calloc(iterations, sizeof(long long int));
+  long long int checksum = 0;
+  for (auto k=0; k < 10; k++){
+    smallTemporary(a, iterations);
+    checksum += a[iterations - 1];
+    largeTemporary(a, iterations);
+    checksum += a[iterations - 1];
+    checksum += earlyExit(a, iterations);
+    checksum += a[iterations / 2];
+    checksum += notDominated(a, iterations);
+    checksum += a[iterations - 1];
+    checksum += manyIterations(iterations * 1000);
+  }
+  printf("%lld\n", checksum);
+
+  return 0;
+}
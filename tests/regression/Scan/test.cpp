@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+long long int computeValue (long long int i){
+  long long int v = i;
+  for (auto j=0; j < 100; j++){
+    v = (v * 31 + j) % 1009;
+  }
+
+  return v;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 1000;
+
+  long long int *sums = (long long int *) malloc(sizeof(long long int) * iterations);
+  long long int *maxs = (long long int *) malloc(sizeof(long long int) * iterations);
+
+  /*
+   * The loop uses the intermediate values of the sum.
+   */
+  long long int s = argc;
+  for (auto i=0; i < iterations; i++){
+    s = s + computeValue(i);
+    sums[i] = s;
+  }
+
+  /*
+   * Running maximum written as a compare and a select.
+   */
+  long long int m = 0;
+  for (auto i=0; i < iterations; i++){
+    auto v = computeValue(i * 7);
+    m = (v > m) ? v : m;
+    maxs[i] = m;
+  }
+
+  for (auto i=0; i < iterations; i += (iterations / 10)){
+    printf("%d: %lld %lld\n", i, sums[i], maxs[i]);
+  }
+  printf("Last: %lld %lld\n", sums[iterations - 1], maxs[iterations - 1]);
+
+  return 0;
+}
@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+  if (iterations < 1){
+    iterations = 1;
+  }
+  iterations *= 1000;
+
+  double *values = (double *) malloc(sizeof(double) * iterations);
+  double *sums = (double *) malloc(sizeof(double) * iterations);
+  for (auto i=0; i < iterations; i++){
+    values[i] = (double)(i % 7) * 0.5;
+  }
+
+  /*
+   * The values are exact in binary, so the sums do not depend on how the
+   * iterations are split.
+   */
+  double s = 0;
+  for (auto i=0; i < iterations; i++){
+    s = s + values[i];
+    sums[i] = s;
+  }
+
+  for (auto i=0; i < iterations; i += (iterations / 10)){
+    printf("%d: %.1f\n", i, sums[i]);
+  }
+  printf("Last: %.1f\n", sums[iterations - 1]);
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ROWS 64
+#define COLUMNS 512
+
+long long int A[ROWS][COLUMNS];
+long long int rowSums[ROWS];
+
+void initialize (long long int seed){
+  for (long long int i=0; i < ROWS; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      A[i][j] = (i * 31 + j * 17 + seed) % 101;
+    }
+    rowSums[i] = 0;
+  }
+
+  return ;
+}
+
+long long int checksum (void){
+  long long int c = 0;
+  for (long long int i=0; i < ROWS; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      c = (c * 7 + A[i][j]) % 1000003;
+    }
+    c = (c * 7 + rowSums[i]) % 1000003;
+  }
+
+  return c;
+}
+
+/*
+ * Every cell depends on the same column of the previous row and on the
+ * previous column of its own row.
+ */
+void synchronizedByRows (long long int iterations){
+  for (long long int i=1; i < ROWS; i++){
+    for (long long int j=1; j < COLUMNS; j++){
+      A[i][j] = (A[i - 1][j] + A[i][j - 1] * 3 + iterations) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every cell depends on the next column of the previous row, which the
+ * previous row computes after the one of the cell.
+ * The rows cannot be synchronized by iterations of the inner loop.
+ */
+void nextColumn (long long int iterations){
+  for (long long int i=1; i < ROWS; i++){
+    for (long long int j=0; j < (COLUMNS - 1); j++){
+      A[i][j] = (A[i - 1][j + 1] * 5 + iterations) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every cell depends on the mirrored column of the previous row.
+ * The rows cannot be synchronized by iterations of the inner loop.
+ */
+void mirroredColumn (long long int iterations){
+  for (long long int i=1; i < ROWS; i++){
+    for (long long int j=0; j < COLUMNS; j++){
+      A[i][j] = (A[i - 1][COLUMNS - 1 - j] * 7 + j + iterations) % 1000003;
+    }
+  }
+
+  return ;
+}
+
+/*
+ * Every row depends on the sum of the previous row, which is computed after
+ * its inner loop.
+ * The rows cannot be synchronized by iterations of the inner loop.
+ */
+void afterTheInnerLoop (long long int iterations){
+  for (long long int i=1; i < ROWS; i++){
+    long long int sum = 0;
+    for (long long int j=0; j < COLUMNS; j++){
+      A[i][j] = (A[i][j] + rowSums[i - 1] + iterations) % 1000003;
+      sum += A[i][j];
+    }
+    rowSums[i] = sum % 1000003;
+  }
+
+  return ;
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto iterations = atoll(argv[1]);
+
+  initialize(iterations);
+  synchronizedByRows(iterations);
+  printf("%lld\n", checksum());
+
+  initialize(iterations);
+  nextColumn(iterations);
+  printf("%lld\n", checksum());
+
+  initialize(iterations);
+  mirroredColumn(iterations);
+  printf("%lld\n", checksum());
+
+  initialize(iterations);
+  afterTheInnerLoop(iterations);
+  printf("%lld\n", checksum());
+
+  return 0;
+}
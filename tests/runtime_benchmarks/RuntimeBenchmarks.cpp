@@ -0,0 +1,396 @@
+/*
+ * Copyright 2016 - 2022  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights to
+ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ of the Software, and to permit persons to whom the Software is furnished to do
+ so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Micro-benchmarks of the primitives of the NOELLE runtime.
+ * They must be linked with Parallelizer_utils.cpp.
+ *
+ * Every measurement is printed to the standard output as a line
+ *   BENCHMARK CORES CALLERS CHUNK_SIZE WIDTH_BYTES CYCLES
+ * where the parameters that do not apply to a benchmark are 0.
+ * These lines can be compared between runtime versions with
+ * tests/scripts/compare_runtime_benchmarks.sh.
+ *
+ * If a model file is given, the costs measured here that are part of the
+ * planner model (see ParallelizationOverheads) are written to it.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#include <ThreadSafeLockFreeQueue.hpp>
+
+extern "C" {
+
+class DispatcherInfo {
+public:
+  int32_t numberOfThreadsUsed;
+  int64_t unusedVariableToPreventOptIfStructHasOnlyOneVariable;
+};
+
+DispatcherInfo NOELLE_DOALLDispatcher(
+    void (*parallelizedLoop)(void *, int64_t, int64_t, int64_t),
+    void *env,
+    int64_t maxNumberOfCores,
+    int64_t chunkSize);
+
+void HELIX_wait(void *sequentialSegment);
+
+void HELIX_signal(void *sequentialSegment);
+
+void queuePush8(void *queue, int8_t *val);
+void queuePop8(void *queue, int8_t *val);
+void queuePush16(void *queue, int16_t *val);
+void queuePop16(void *queue, int16_t *val);
+void queuePush32(void *queue, int32_t *val);
+void queuePop32(void *queue, int32_t *val);
+void queuePush64(void *queue, int64_t *val);
+void queuePop64(void *queue, int64_t *val);
+}
+
+/*
+ * The cycles are measured as the runtime does.
+ */
+static inline uint64_t getCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+#endif
+}
+
+/*
+ * Each core writes its own cache line of the environment, as in the code
+ * generated by NOELLE.
+ */
+static const int64_t valuesPerCacheLine = 64 / sizeof(int64_t);
+static const int64_t maximumCores = 128;
+static const int64_t loopIterations = 1 << 16;
+static const int64_t repetitions = 200;
+static const int64_t handOffs = 100000;
+static const int64_t queueValues = 1000000;
+static volatile int64_t sink = 0;
+
+static void emptyTask(void *env,
+                      int64_t coreID,
+                      int64_t cores,
+                      int64_t chunk) {
+  return;
+}
+
+/*
+ * A loop of @loopIterations iterations whose chunks are distributed
+ * round-robin among the cores, as DOALL does.
+ */
+static void chunkedLoopTask(void *env,
+                            int64_t coreID,
+                            int64_t cores,
+                            int64_t chunk) {
+  auto values = (volatile int64_t *)env;
+  int64_t sum = 0;
+  for (auto start = coreID * chunk; start < loopIterations;
+       start += cores * chunk) {
+    auto end = std::min(start + chunk, loopIterations);
+    for (auto i = start; i < end; i++) {
+      sum += i;
+      asm volatile("" : "+r"(sum));
+    }
+  }
+  values[coreID * valuesPerCacheLine] = sum;
+
+  return;
+}
+
+static void printResult(const char *benchmark,
+                        int64_t cores,
+                        int64_t callers,
+                        int64_t chunk,
+                        int64_t width,
+                        double cycles) {
+  printf("%s %ld %ld %ld %ld %f\n",
+         benchmark,
+         cores,
+         callers,
+         chunk,
+         width,
+         cycles);
+  fflush(stdout);
+
+  return;
+}
+
+/*
+ * Return the average cycles of an invocation of @task with @cores cores.
+ */
+static double measureDispatch(void (*task)(void *, int64_t, int64_t, int64_t),
+                              int64_t *env,
+                              int64_t cores,
+                              int64_t chunk) {
+  for (auto i = 0; i < 10; i++) {
+    NOELLE_DOALLDispatcher(task, env, cores, chunk);
+  }
+  auto start = getCycles();
+  for (auto i = 0; i < repetitions; i++) {
+    NOELLE_DOALLDispatcher(task, env, cores, chunk);
+  }
+  auto end = getCycles();
+
+  return ((double)(end - start)) / repetitions;
+}
+
+/*
+ * Return the average cycles of an invocation of a DOALL loop with @cores
+ * cores while @callers threads invoke DOALL loops at the same time.
+ * The invocations compete for the thread pool and for the memory of the
+ * runtime that stores the arguments of the tasks (getDOALLArgs).
+ */
+static double measureConcurrentDispatch(int64_t cores, int64_t callers) {
+  std::vector<std::vector<int64_t>> envs(
+      callers,
+      std::vector<int64_t>(maximumCores * valuesPerCacheLine, 0));
+  std::vector<uint64_t> cycles(callers, 0);
+  std::atomic<int64_t> ready{ 0 };
+  std::vector<std::thread> threads;
+  for (auto c = 0; c < callers; c++) {
+    threads.emplace_back([&envs, &cycles, &ready, cores, callers, c]() {
+      ready++;
+      while (ready.load() < callers) {
+      }
+      auto start = getCycles();
+      for (auto i = 0; i < repetitions; i++) {
+        NOELLE_DOALLDispatcher(emptyTask, envs[c].data(), cores, 1);
+      }
+      cycles[c] = getCycles() - start;
+    });
+  }
+  uint64_t totalCycles = 0;
+  for (auto c = 0; c < callers; c++) {
+    threads[c].join();
+    totalCycles += cycles[c];
+  }
+
+  return ((double)totalCycles) / (callers * repetitions);
+}
+
+/*
+ * Entry of a sequential segment array of the runtime.
+ */
+typedef struct {
+  pthread_spinlock_t lock;
+  uint8_t padding[64 - sizeof(pthread_spinlock_t)];
+} SequentialSegment_t;
+
+/*
+ * Return the average cycles to hand a sequential segment from a core to
+ * another one with HELIX_wait and HELIX_signal.
+ * Two cores alternate in two sequential segments: each one waits for its own
+ * segment and signals the one of the other core, as consecutive iterations of
+ * a HELIX loop do.
+ */
+static double measureHELIXPingPong(void) {
+  SequentialSegment_t segments[2] __attribute__((aligned(64)));
+  for (auto &segment : segments) {
+    pthread_spin_init(&segment.lock, PTHREAD_PROCESS_SHARED);
+  }
+  pthread_spin_lock(&segments[1].lock);
+
+  std::thread other([&segments]() {
+    for (int64_t i = 0; i < handOffs; i++) {
+      HELIX_wait(&segments[1]);
+      HELIX_signal(&segments[0]);
+    }
+  });
+  auto start = getCycles();
+  for (int64_t i = 0; i < handOffs; i++) {
+    HELIX_wait(&segments[0]);
+    HELIX_signal(&segments[1]);
+  }
+  auto end = getCycles();
+  other.join();
+  for (auto &segment : segments) {
+    pthread_spin_destroy(&segment.lock);
+  }
+
+  return ((double)(end - start)) / (2 * handOffs);
+}
+
+/*
+ * Measure the average cycles to push a value of type T to a queue used by DSWP
+ * and to pop a value from it, while a producer and a consumer stream values
+ * through it.
+ */
+template <typename T>
+static void measureQueue(void (*push)(void *, T *),
+                         void (*pop)(void *, T *),
+                         double &pushCycles,
+                         double &popCycles) {
+  auto queue = new MARC::ThreadSafeLockFreeQueue<T>();
+  uint64_t consumerCycles = 0;
+  std::thread consumer([queue, pop, &consumerCycles]() {
+    T value = 0;
+    int64_t sum = 0;
+    auto start = getCycles();
+    for (int64_t i = 0; i < queueValues; i++) {
+      pop(queue, &value);
+      sum += value;
+    }
+    consumerCycles = getCycles() - start;
+    sink = sum;
+  });
+  auto start = getCycles();
+  for (int64_t i = 0; i < queueValues; i++) {
+    T value = (T)i;
+    push(queue, &value);
+  }
+  auto producerCycles = getCycles() - start;
+  consumer.join();
+  delete queue;
+
+  pushCycles = ((double)producerCycles) / queueValues;
+  popCycles = ((double)consumerCycles) / queueValues;
+
+  return;
+}
+
+template <typename T>
+static void runQueueBenchmark(void (*push)(void *, T *),
+                              void (*pop)(void *, T *),
+                              double &pushCycles,
+                              double &popCycles) {
+  measureQueue<T>(push, pop, pushCycles, popCycles);
+  printResult("queue_push", 0, 0, 0, sizeof(T), pushCycles);
+  printResult("queue_pop", 0, 0, 0, sizeof(T), popCycles);
+
+  return;
+}
+
+int main(int argc, char *argv[]) {
+
+  /*
+   * Fetch the inputs.
+   */
+  if (argc > 3) {
+    fprintf(stderr, "USAGE: %s [MAX_CORES [MODEL_FILE]]\n", argv[0]);
+    return 1;
+  }
+  int64_t maxCores = std::thread::hardware_concurrency();
+  if (argc > 1) {
+    maxCores = atol(argv[1]);
+  }
+  maxCores = std::max(std::min(maxCores, maximumCores), (int64_t)2);
+  const char *modelFile = (argc > 2) ? argv[2] : nullptr;
+  std::vector<int64_t> env(maximumCores * valuesPerCacheLine, 0);
+
+  /*
+   * Plan the sweep.
+   * The cores that NOELLE uses by default are measured as well because they
+   * calibrate the planner model.
+   */
+  int64_t defaultCores = std::max(
+      std::min((int64_t)std::thread::hardware_concurrency() / 2, maxCores),
+      (int64_t)2);
+  std::vector<int64_t> coresToMeasure;
+  for (int64_t cores = 2; cores <= maxCores; cores *= 2) {
+    coresToMeasure.push_back(cores);
+  }
+  if (std::find(coresToMeasure.begin(), coresToMeasure.end(), defaultCores)
+      == coresToMeasure.end()) {
+    coresToMeasure.push_back(defaultCores);
+    std::sort(coresToMeasure.begin(), coresToMeasure.end());
+  }
+  auto chunkSizes = { 1, 8, 64, 512 };
+
+  printf("# Measured with up to %ld cores\n", maxCores);
+  printf("# benchmark cores callers chunk_size width_bytes cycles\n");
+
+  /*
+   * DOALL fork/join latency and loops distributed with different chunk
+   * sizes.
+   */
+  double dispatch = 0;
+  for (auto cores : coresToMeasure) {
+    auto cycles = measureDispatch(emptyTask, env.data(), cores, 1);
+    printResult("doall_fork_join", cores, 1, 0, 0, cycles);
+    if (cores == defaultCores) {
+      dispatch = cycles;
+    }
+    for (auto chunk : chunkSizes) {
+      cycles = measureDispatch(chunkedLoopTask, env.data(), cores, chunk);
+      printResult("doall_chunked_loop", cores, 1, chunk, 0, cycles);
+    }
+  }
+
+  /*
+   * DOALL loops invoked concurrently.
+   */
+  for (int64_t callers = 2; callers <= std::max(maxCores / 2, (int64_t)2);
+       callers *= 2) {
+    auto cycles = measureConcurrentDispatch(2, callers);
+    printResult("doall_concurrent_dispatch", 2, callers, 0, 0, cycles);
+  }
+
+  /*
+   * HELIX sequential segments.
+   */
+  auto sequentialSegment = measureHELIXPingPong();
+  printResult("helix_ping_pong", 2, 0, 0, 0, sequentialSegment);
+
+  /*
+   * DSWP queues.
+   */
+  double queuePush = 0;
+  double queuePop = 0;
+  runQueueBenchmark<int8_t>(queuePush8, queuePop8, queuePush, queuePop);
+  runQueueBenchmark<int16_t>(queuePush16, queuePop16, queuePush, queuePop);
+  runQueueBenchmark<int32_t>(queuePush32, queuePop32, queuePush, queuePop);
+  runQueueBenchmark<int64_t>(queuePush64, queuePop64, queuePush, queuePop);
+
+  /*
+   * Write the costs of the planner model.
+   * The live-in, live-out, and instruction costs are measured by
+   * noelle-overheads.
+   */
+  if (modelFile != nullptr) {
+    auto model = fopen(modelFile, "w");
+    if (model == nullptr) {
+      fprintf(stderr, "Cannot write %s\n", modelFile);
+      return 1;
+    }
+    fprintf(model, "# Measured with %ld cores\n", defaultCores);
+    fprintf(model, "dispatch_cycles %f\n", dispatch);
+    fprintf(model, "sequential_segment_cycles %f\n", sequentialSegment);
+    fprintf(model, "queue_push_cycles %f\n", queuePush);
+    fprintf(model, "queue_pop_cycles %f\n", queuePop);
+    fclose(model);
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+import argparse
+import random
+import sys
+
+## Generate a synthetic program to stress the analyses of NOELLE.
+#
+# The program has @functions functions. Each one runs a loop nest of @depth loops whose innermost body has (about) @memory memory instructions.
+# The pointers these instructions access follow the @aliasing pattern:
+#   none:    each function accesses its own global arrays, so accesses to different arrays never alias
+#   globals: all functions access the same global arrays at different offsets
+#   args:    functions access the arrays through pointer arguments that overlap at run time
+#   mixed:   each access picks one of the patterns above at random
+#
+# The program reads the trip count of the loops from its first argument, and it prints a checksum of the arrays.
+#
+
+ALIASING_PATTERNS = ['none', 'globals', 'args', 'mixed']
+ARRAY_SIZE = 256
+MAX_OFFSET = 8
+ARRAYS_PER_PATTERN = 3
+
+def getArgs():
+  parser = argparse.ArgumentParser(description='Generate a synthetic program to stress the analyses of NOELLE.')
+  parser.add_argument('--functions', type=int, default=8, help='number of functions with a loop nest')
+  parser.add_argument('--depth', type=int, default=2, help='nesting depth of the loops of each function')
+  parser.add_argument('--memory', type=int, default=16, help='memory instructions of the innermost loop body of each function')
+  parser.add_argument('--aliasing', choices=ALIASING_PATTERNS, default='mixed', help='pattern of the pointers accessed')
+  parser.add_argument('--seed', type=int, default=0, help='seed of the random choices, which makes the program reproducible')
+  parser.add_argument('-o', '--output', default='-', help='file to generate (default: the standard output)')
+  args = parser.parse_args()
+  if (args.functions < 1) or (args.depth < 1) or (args.memory < 1):
+    parser.error('--functions, --depth, and --memory must be positive')
+
+  return args
+
+## Return the expression of an array to access.
+#
+def getArray(rng, aliasing, functionID):
+  if aliasing == 'mixed':
+    aliasing = rng.choice(ALIASING_PATTERNS[:-1])
+  index = rng.randrange(ARRAYS_PER_PATTERN)
+  if aliasing == 'none':
+    return 'private_' + str(functionID) + '_' + str(index)
+  if aliasing == 'globals':
+    return 'shared_' + str(index)
+  return 'p' + str(index)
+
+## Return the statements of the innermost body of a loop nest.
+#
+# Each statement averages two values and stores the result (3 memory instructions).
+#
+def getBody(rng, aliasing, functionID, depth, memory):
+  iv = 'i' + str(depth - 1)
+  statements = []
+  for s in range(0, (memory + 2) // 3):
+    dst = getArray(rng, aliasing, functionID)
+    src = getArray(rng, aliasing, functionID)
+    dstOffset = rng.randrange(MAX_OFFSET)
+    srcOffset = rng.randrange(MAX_OFFSET)
+    statements.append('{0}[{1} + {2}] = ({0}[{1} + {2}] + {3}[{1} + {4}]) * 0.5;'.format(dst, iv, dstOffset, src, srcOffset))
+
+  return statements
+
+def generateFunction(rng, aliasing, functionID, depth, memory):
+  lines = []
+  lines.append('void f_{} (double *p0, double *p1, double *p2, int64_t n){{'.format(functionID))
+  indentation = '  '
+  for d in range(0, depth):
+    lines.append('{}for (int64_t i{} = 0; i{} < n; i{}++){{'.format(indentation, d, d, d))
+    indentation += '  '
+  for s in getBody(rng, aliasing, functionID, depth, memory):
+    lines.append(indentation + s)
+  for d in range(0, depth):
+    indentation = indentation[:-2]
+    lines.append(indentation + '}')
+  lines.append('}')
+  lines.append('')
+
+  return lines
+
+def generateProgram(args):
+  rng = random.Random(args.seed)
+  lines = []
+  lines.append('// Generated by generate_module.py --functions {} --depth {} --memory {} --aliasing {} --seed {}'.format(args.functions, args.depth, args.memory, args.aliasing, args.seed))
+  lines.append('#include <stdio.h>')
+  lines.append('#include <stdint.h>')
+  lines.append('#include <stdlib.h>')
+  lines.append('')
+
+  # Arrays
+  arrays = []
+  for i in range(0, ARRAYS_PER_PATTERN):
+    arrays.append('shared_' + str(i))
+  if args.aliasing in ['none', 'mixed']:
+    for f in range(0, args.functions):
+      for i in range(0, ARRAYS_PER_PATTERN):
+        arrays.append('private_' + str(f) + '_' + str(i))
+  for a in arrays:
+    lines.append('static double {}[{}];'.format(a, ARRAY_SIZE))
+  lines.append('')
+
+  # Functions
+  for f in range(0, args.functions):
+    lines += generateFunction(rng, args.aliasing, f, args.depth, args.memory)
+
+  # Entry point
+  lines.append('int main (int argc, char *argv[]){')
+  lines.append('  int64_t n = (argc > 1) ? atoll(argv[1]) : 10;')
+  lines.append('  if (n > {}) {{'.format(ARRAY_SIZE - MAX_OFFSET))
+  lines.append('    n = {};'.format(ARRAY_SIZE - MAX_OFFSET))
+  lines.append('  }')
+  lines.append('  for (int64_t i = 0; i < {}; i++){{'.format(ARRAY_SIZE))
+  for a in arrays:
+    lines.append('    {}[i] = (double)(i % 7);'.format(a))
+  lines.append('  }')
+  lines.append('')
+  lines.append('  // The pointer arguments overlap')
+  for f in range(0, args.functions):
+    lines.append('  f_{} (shared_0, shared_0 + 1, shared_{} + 2, n);'.format(f, f % ARRAYS_PER_PATTERN))
+  lines.append('')
+  lines.append('  double checksum = 0;')
+  lines.append('  for (int64_t i = 0; i < {}; i++){{'.format(ARRAY_SIZE))
+  for a in arrays:
+    lines.append('    checksum += {}[i];'.format(a))
+  lines.append('  }')
+  lines.append('  printf("%f\\n", checksum);')
+  lines.append('')
+  lines.append('  return 0;')
+  lines.append('}')
+
+  return '\n'.join(lines) + '\n'
+
+args = getArgs()
+program = generateProgram(args)
+if args.output == '-':
+  sys.stdout.write(program)
+else:
+  with open(args.output, 'w') as f:
+    f.write(program)
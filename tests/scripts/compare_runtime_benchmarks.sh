@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Fetch the inputs
+if test $# -lt 2 ; then
+  echo "USAGE: `basename $0` BASELINE_OUTPUT RUN2_OUTPUT [THRESHOLD] [UNIT]" ;
+  echo "  THRESHOLD: slowdown (in %) reported as a regression (10 by default)" ;
+  echo "  UNIT: unit of the measurements (cycles by default)" ;
+  exit 1;
+fi
+threshold=10 ;
+if test $# -ge 3 ; then
+  threshold="$3" ;
+fi
+unit="cycles" ;
+if test $# -ge 4 ; then
+  unit="$4" ;
+fi
+
+# Compare the measurements that have the same parameters.
+# The measurement is the last field of each line, and the other fields are its parameters.
+awk -v threshold="$threshold" -v unit="$unit" '
+  function getKey(    i, key) {
+    key = $1 ;
+    for (i = 2; i < NF; i++){
+      key = key " " $i ;
+    }
+    return key ;
+  }
+  /^#/ { next ; }
+  FNR == NR {
+    baseline[getKey()] = $NF ;
+    next ;
+  }
+  {
+    key = getKey() ;
+    if (!(key in baseline) || (baseline[key] <= 0)){
+      next ;
+    }
+    delta = (($NF - baseline[key]) / baseline[key]) * 100 ;
+    tag = "" ;
+    if (delta > threshold){
+      tag = " REGRESSION" ;
+      regressions++ ;
+    }
+    printf("%s %.1f -> %.1f %s (%+.1f %%)%s\n", key, baseline[key], $NF, unit, delta, tag) ;
+  }
+  END {
+    if (regressions > 0){
+      printf("%d measurements are more than %s %% slower\n", regressions, threshold) ;
+      exit 1 ;
+    }
+  }
+' $1 $2 ;
@@ -1,45 +1,197 @@
 #!/bin/bash
 
+# Report the overheads of the parallelized loops from the telemetry of the runtime.
+# The telemetry of a run is generated by setting NOELLE_TELEMETRY to the file to write.
+# Loops are matched across runs by their technique and the offset of their task in the binary.
+function printUsage {
+  echo "USAGE: `basename $0` [-b BASELINE_TELEMETRY]... TELEMETRY [TELEMETRY...]" ;
+  echo "  The telemetry files of several runs of the same binary are summarized together." ;
+  echo "  The telemetry files given with -b are the runs of the baseline to compare against." ;
+}
+
 # Fetch the inputs
-if test $# -lt 2 ; then
-  echo "USAGE: `basename $0` BASELINE_OUTPUT RUN2_OUTPUT" ;
-  exit 1;
+baselines="" ;
+runs="" ;
+while test $# -gt 0 ; do
+  case "$1" in
+    -b)
+      if test $# -lt 2 ; then
+        printUsage ;
+        exit 1 ;
+      fi
+      baselines="$baselines $2" ;
+      shift 2 ;
+      ;;
+    -h|--help)
+      printUsage ;
+      exit 0 ;
+      ;;
+    *)
+      runs="$runs $1" ;
+      shift ;
+      ;;
+  esac
+done
+if test "$runs" == "" ; then
+  printUsage ;
+  exit 1 ;
 fi
+for i in $baselines $runs ; do
+  if ! test -f $i ; then
+    echo "ERROR: the telemetry file $i does not exist" ;
+    exit 1 ;
+  fi
+done
+
+# Print the metrics of each loop of each run (one line per loop per run).
+#   SET RUN KEY INVOCATIONS THREADS WALL_S SETUP_S DISPATCH_S BODY_S JOIN_S SYNC_WAIT_S BUSY_S WASTED_CORE_S
+function telemetryToMetrics {
+  local set=$1 ;
+  local run=0 ;
+  for file in "${@:2}" ; do
+    awk -v set=$set -v run=$run '
+      function value(line) {
+        sub(/^[^:]*: */, "", line) ;
+        gsub(/[",]/, "", line) ;
+        return line ;
+      }
+      function sum(line,    values, n, i, total) {
+        sub(/^[^\[]*\[/, "", line) ;
+        sub(/\].*$/, "", line) ;
+        n = split(line, values, ",") ;
+        total = 0 ;
+        for (i = 1; i <= n; i++){
+          total += values[i] ;
+        }
+        return total ;
+      }
+      function emit(    freq, body) {
+        if (loop == ""){
+          return ;
+        }
+        freq = (cyclesPerSecond > 0) ? cyclesPerSecond : 1 ;
+        body = cycles - setup - dispatch - join ;
+        if (body < 0){
+          body = 0 ;
+        }
+        printf("%s %d %s@%s %d %d %.9f %.9f %.9f %.9f %.9f %.9f %.9f %.9f\n", set, run, technique, offset, invocations, threads, cycles / freq, setup / freq, dispatch / freq, body / freq, join / freq, syncWait / freq, busy / freq, idle / freq) ;
+        loop = "" ;
+      }
+      /"cyclesPerSecond"/  { cyclesPerSecond = value($0) ; }
+      /"loop"/             { emit() ; loop = value($0) ; offset = loop ; setup = dispatch = join = syncWait = busy = idle = 0 ; }
+      /"offset"/           { offset = value($0) ; }
+      /"technique"/        { technique = value($0) ; }
+      /"invocations"/      { invocations = value($0) ; }
+      /"threadsUsed"/      { threads = value($0) ; }
+      /"cycles"/           { cycles = value($0) ; }
+      /"setupCycles"/      { setup = value($0) ; }
+      /"dispatchCycles"/   { dispatch = value($0) ; }
+      /"joinCycles"/       { join = value($0) ; }
+      /"busyCycles"/       { busy = sum($0) ; }
+      /"idleCycles"/       { idle = sum($0) ; }
+      /"segmentWaitCycles"/ { syncWait = sum($0) ; }
+      END                  { emit() ; }
+    ' $file ;
+    let run=$run+1 ;
+  done
+}
+
+metrics=`mktemp` ;
+telemetryToMetrics "run" $runs > $metrics ;
+if test "$baselines" != "" ; then
+  telemetryToMetrics "baseline" $baselines >> $metrics ;
+fi
+
+# Summarize the runs
+awk '
+  function stdev(s, s2, n,    v) {
+    if (n < 2){
+      return 0 ;
+    }
+    v = (s2 - (s * s / n)) / (n - 1) ;
+    return (v > 0) ? sqrt(v) : 0 ;
+  }
+  function delta(now, before) {
+    if (before == 0){
+      return "     -" ;
+    }
+    return sprintf("%+6.1f%%", ((now - before) / before) * 100) ;
+  }
+  {
+    set = $1 ;
+    key = $3 ;
+    if (!((set, key) in runs)){
+      if (set == "run"){
+        keys[++numberOfKeys] = key ;
+      }
+    }
+    runs[set, key]++ ;
+    invocations[set, key] += $4 ;
+    threads[set, key] += $5 ;
+    wall[set, key] += $6 ;
+    wall2[set, key] += $6 * $6 ;
+    setup[set, key] += $7 ;
+    dispatch[set, key] += $8 ;
+    body[set, key] += $9 ;
+    join[set, key] += $10 ;
+    syncWait[set, key] += $11 ;
+    busy[set, key] += $12 ;
+    wasted[set, key] += $13 ;
+  }
+  END {
+    if (numberOfKeys == 0){
+      print "There is no parallelized loop in the telemetry" ;
+      exit 0 ;
+    }
+
+    # Times are per invocation, averaged across the runs.
+    print "Per-loop breakdown (microseconds per invocation, average of the runs)" ;
+    printf("  %-24s %4s %11s %11s %10s %10s %12s %10s %10s %17s %12s\n", "Loop", "Runs", "Invocations", "Wall (s)", "Setup", "Dispatch", "Body", "Join", "Sync wait", "Speedup (pred.)", "Wasted core-s") ;
+    for (k = 1; k <= numberOfKeys; k++){
+      key = keys[k] ;
+      n = runs["run", key] ;
+      i = invocations["run", key] ;
+      i = (i > 0) ? i : 1 ;
+
+      # Assume the tasks would have run sequentially in the time they were busy
+      achieved = (wall["run", key] > 0) ? (busy["run", key] / wall["run", key]) : 0 ;
+      predicted = threads["run", key] / i ;
+      printf("  %-24s %4d %11.0f %6.3f±%-5.3f %10.2f %10.2f %12.2f %10.2f %10.2f %8.2fx (%5.2fx) %12.4f\n", key, n, i / n, wall["run", key] / n, stdev(wall["run", key], wall2["run", key], n), (setup["run", key] / i) * 1e6, (dispatch["run", key] / i) * 1e6, (body["run", key] / i) * 1e6, (join["run", key] / i) * 1e6, (syncWait["run", key] / i) * 1e6, achieved, predicted, wasted["run", key] / n) ;
+    }
+
+    # Compare against the baseline
+    compared = 0 ;
+    for (k = 1; k <= numberOfKeys; k++){
+      key = keys[k] ;
+      if (!(("baseline", key) in runs)){
+        continue ;
+      }
+      if (compared == 0){
+        print "" ;
+        print "Compared to the baseline (per invocation)" ;
+        printf("  %-24s %8s %8s %8s %8s %8s %9s %13s\n", "Loop", "Wall", "Setup", "Dispatch", "Join", "Sync", "Overhead", "Wasted core-s") ;
+      }
+      compared++ ;
+      i = invocations["run", key] / runs["run", key] ;
+      bi = invocations["baseline", key] / runs["baseline", key] ;
+      i = (i > 0) ? i : 1 ;
+      bi = (bi > 0) ? bi : 1 ;
+      f = 1 / (i * runs["run", key]) ;
+      bf = 1 / (bi * runs["baseline", key]) ;
+      overhead = (setup["run", key] + dispatch["run", key] + join["run", key]) * f ;
+      baselineOverhead = (setup["baseline", key] + dispatch["baseline", key] + join["baseline", key]) * bf ;
+      printf("  %-24s %8s %8s %8s %8s %8s %9s %13s\n", key, delta(wall["run", key] * f, wall["baseline", key] * bf), delta(setup["run", key] * f, setup["baseline", key] * bf), delta(dispatch["run", key] * f, dispatch["baseline", key] * bf), delta(join["run", key] * f, join["baseline", key] * bf), delta(syncWait["run", key] * f, syncWait["baseline", key] * bf), delta(overhead, baselineOverhead), delta(wasted["run", key] / runs["run", key], wasted["baseline", key] / runs["baseline", key])) ;
+    }
+    for (key in runs){
+      split(key, parts, SUBSEP) ;
+      if ((parts[1] == "baseline") && !(("run", parts[2]) in runs)){
+        print "  Loop " parts[2] " of the baseline has not run" ;
+      }
+    }
+  }
+' $metrics ;
+
+# Clean
+rm -f $metrics ;
 
-setup1=`grep overhead $1 | grep Setup | awk '{c += $5} END {print c}'` ;
-setup2=`grep overhead $2 | grep Setup | awk '{c += $5} END {print c}'` ;
-delta=`echo "scale=3; (($setup2 - $setup1) / $setup1) * 100" | bc`;
-echo "Setup overhead = $delta %" ;
-
-forking1=`grep overhead $1 | grep Task | awk '{c += $6} END {print c}'` ;
-forking2=`grep overhead $2 | grep Task | awk '{c += $6} END {print c}'` ;
-delta=`echo "scale=3; (($forking2 - $forking1) / $forking1) * 100" | bc`;
-echo "Forking overhead = $delta %" ;
-
-joining1=`grep overhead $1 | grep Joining | awk '{c += $5} END {print c}'`;
-joining2=`grep overhead $2 | grep Joining | awk '{c += $5} END {print c}'`;
-delta=`echo "scale=3; (($joining2 - $joining1) / $joining1) * 100" | bc`;
-echo "Joining overhead = $delta %" ;
-
-tot1=`echo "$setup1 + $forking1 + $joining1" | bc`;
-tot2=`echo "$setup2 + $forking2 + $joining2" | bc`;
-delta=`echo "scale=3; (($tot2 - $tot1) / $tot1) * 100" | bc`;
-echo "Total overhead = $delta %" ;
-
-setup1Rel=`echo "scale=3; ($setup1 / $tot1) * 100" | bc` ;
-forking1Rel=`echo "scale=3; ($forking1 / $tot1) * 100" | bc` ;
-joining1Rel=`echo "scale=3; ($joining1 / $tot1) * 100" | bc` ;
-echo "$1 breakdown" ;
-echo "  $setup1Rel % (Setup)";
-echo "  $forking1Rel % (Forking)";
-echo "  $joining1Rel % (Joining)";
-
-setup2Rel=`echo "scale=3; ($setup2 / $tot2) * 100" | bc` ;
-forking2Rel=`echo "scale=3; ($forking2 / $tot2) * 100" | bc` ;
-joining2Rel=`echo "scale=3; ($joining2 / $tot2) * 100" | bc` ;
-invocs=`grep overhead $2 | grep Setup | wc -l | awk '{print $1}'` ;
-tot2Avg=`echo "$tot2 / $invocs" | bc`;
-echo "$2 breakdown of $tot2Avg clock cycles per invocation (among $invocs invocations)" ;
-echo "  $setup2Rel % (Setup)";
-echo "  $forking2Rel % (Forking)";
-echo "  $joining2Rel % (Joining)";
+exit 0 ;
@@ -0,0 +1,173 @@
+#!/bin/bash
+
+# Harness options
+#   COMPILE_TIME_CORPUS: directory with the bitcode files to compile (e.g., polybench, SPEC-like, or fully inlined modules).
+#                        By default, these are the bitcode files of the performance tests.
+#   COMPILE_TIME_OUTPUT: file to generate
+#   COMPILE_TIME_TOOLS: tools to measure among pdg, planner, parallelizer, and enable (default: all of them)
+COMPILE_TIME_CORPUS=${COMPILE_TIME_CORPUS:-} ;
+COMPILE_TIME_OUTPUT=${COMPILE_TIME_OUTPUT:-`pwd`/compile_time.json} ;
+COMPILE_TIME_TOOLS=${COMPILE_TIME_TOOLS:-pdg planner parallelizer enable} ;
+
+# Print the times (in seconds) of the NOELLE phases reported by -time-passes as JSON fields.
+# The reports of multiple invocations (e.g., the ones of noelle-enable) are added up.
+function phasesToJSON {
+  if ! test -s $1 ; then
+    echo -n "{}" ;
+    return ;
+  fi
+  awk '
+    /===/ {
+      next ;
+    }
+    /NOELLE phases/ {
+      inSection = 1 ;
+      next ;
+    }
+    /Total Execution Time/ {
+      next ;
+    }
+    /^ *$/ {
+      if (inSection && seenPhases){
+        inSection = 0 ;
+        seenPhases = 0 ;
+      }
+      next ;
+    }
+    inSection && /%\)/ {
+
+      # The wall time is the last column before the name of the phase
+      for (i = NF; (i > 0) && ($i !~ /%\)$/); i--) ;
+      wall = ($(i - 1) == "(") ? $(i - 2) : $(i - 1) ;
+      name = "" ;
+      for (j = i + 1; j <= NF; j++){
+        name = name (name == "" ? "" : " ") $j ;
+      }
+      if (name == "Total"){
+        next ;
+      }
+      if (!(name in times)){
+        names[++phases] = name ;
+      }
+      times[name] += wall ;
+      seenPhases = 1 ;
+    }
+    END {
+      printf("{") ;
+      for (p = 1; p <= phases; p++){
+        printf("%s\"%s\": %.6f", (p > 1) ? ", " : "", names[p], times[names[p]]) ;
+      }
+      printf("}") ;
+    }' $1 ;
+}
+
+# Compile a bitcode file with a NOELLE tool and append a JSON record of the measurements.
+# Any argument after the tool and its input are passed to the tool.
+function measureTool {
+  local bitcode=$1 ;
+  local tool=$2 ;
+  local input=$3 ;
+  local measures=`mktemp` ;
+  local phases=`mktemp` ;
+  rm -f $phases ;
+
+  echo "  $tool" ;
+  local status="ok" ;
+  if test -x /usr/bin/time ; then
+    /usr/bin/time -f "%e %M" -o $measures $tool $input "${@:4}" -time-passes -info-output-file=$phases &>> compiler_output_compile_time.txt ;
+    if test $? -ne 0 ; then
+      status="error" ;
+    fi
+  else
+    local start=`date +%s%N` ;
+    $tool $input "${@:4}" -time-passes -info-output-file=$phases &>> compiler_output_compile_time.txt ;
+    if test $? -ne 0 ; then
+      status="error" ;
+    fi
+    local end=`date +%s%N` ;
+    echo "$start $end" | awk '{ printf("%.2f 0\n", ($2 - $1) / 1000000000) }' > $measures ;
+  fi
+  local wall=`tail -n 1 $measures | awk '{ print $1 }'` ;
+  local rss=`tail -n 1 $measures | awk '{ print $2 }'` ;
+  echo "    Wall time: $wall s, peak RSS: $rss KB ($status)" ;
+
+  # Append the record
+  if test "$records" != "0" ; then
+    echo "," >> $COMPILE_TIME_OUTPUT ;
+  fi
+  echo -n "  {\"bitcode\": \"$bitcode\", \"tool\": \"$tool\", \"status\": \"$status\", \"wall_seconds\": $wall, \"peak_rss_kb\": $rss, \"phases\": `phasesToJSON $phases`}" >> $COMPILE_TIME_OUTPUT ;
+  let records=$records+1 ;
+
+  # Clean
+  rm -f $measures $phases ;
+
+  return ;
+}
+
+function compileBitcode {
+  local bitcode=$1 ;
+  local name=$2 ;
+  local plan=`mktemp` ;
+  local output=`mktemp` ;
+
+  echo "Compiling $name" ;
+  for tool in $COMPILE_TIME_TOOLS ; do
+    case $tool in
+      pdg)
+        measureTool $name noelle-pdg $bitcode ;
+        ;;
+      planner)
+        measureTool $name noelle-parallelization-planner $bitcode -o $plan ;
+        ;;
+      parallelizer)
+        measureTool $name noelle-parallelizer-loop $plan -o $output ;
+        ;;
+      enable)
+        measureTool $name noelle-enable $bitcode $output ;
+        ;;
+    esac
+  done
+
+  rm -f $plan $output ;
+
+  return ;
+}
+
+export PATH=`pwd`/../install/bin:$PATH ;
+
+echo "[" > $COMPILE_TIME_OUTPUT ;
+records="0" ;
+if test "$COMPILE_TIME_CORPUS" != "" ; then
+
+  # Compile the bitcode files of the corpus
+  for i in `ls $COMPILE_TIME_CORPUS/*.bc` ; do
+    compileBitcode `realpath $i` `basename $i .bc` ;
+  done
+
+else
+
+  # Compile the bitcode files of the performance tests
+  cd performance ;
+  for i in `ls`; do
+    if ! test -d $i ; then
+      continue ;
+    fi
+    pushd ./ ;
+    cd $i ;
+    make baseline_pre.bc >> compiler_output.txt 2>&1 ;
+    if ! test -f baseline_pre.bc ; then
+      echo "ERROR: `pwd` did not generate baseline_pre.bc" ;
+      popd ;
+      continue ;
+    fi
+    compileBitcode `pwd`/baseline_pre.bc $i ;
+    popd ;
+  done
+  cd ../ ;
+fi
+echo "" >> $COMPILE_TIME_OUTPUT ;
+echo "]" >> $COMPILE_TIME_OUTPUT ;
+
+echo "The measurements are in $COMPILE_TIME_OUTPUT" ;
+
+exit 0;
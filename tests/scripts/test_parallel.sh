@@ -0,0 +1,312 @@
+#!/bin/bash
+
+# Run the regression and unit tests in parallel on the local cores or on SSH hosts.
+#
+# Each test of each configuration is a job. Jobs are sharded among the hosts, and each host runs several of them at once.
+# SSH hosts must see this repository (and its installation of NOELLE) at the same path (e.g., through NFS), like the condor jobs do.
+#
+# Results of tests that passed are cached, and they are keyed by the hash of the NOELLE installation, of the files of the test, and of the options used.
+# Hence, re-running the tests after a change only runs the tests that change could affect.
+#
+# Options
+#   -j JOBS: number of jobs to run at once per host (default: the number of cores)
+#   -H HOSTS: comma separated list of SSH hosts, each optionally followed by ":JOBS" (default: this machine only)
+#   -s SUITES: suites to run, which are "regression", "unit", or "all" (default: all)
+#   -C: ignore and do not update the cache of the results
+#
+# Environment
+#   NOELLE_TEST_CACHE: directory of the cache of the results (default: ~/.cache/noelle/tests)
+
+# Configurations of the regression tests (see test_regression.sh)
+configurations=(
+  "-noelle-disable-helix -noelle-disable-dswp -noelle-disable-doall"
+  ""
+  "-noelle-parallelizer-force -noelle-disable-helix"
+  "-noelle-parallelizer-force -noelle-disable-helix -dswp-no-scc-merge"
+  "-noelle-parallelizer-force -noelle-disable-dswp"
+  "-noelle-parallelizer-force -noelle-disable-dswp -dswp-no-scc-merge"
+  "-noelle-parallelizer-force -noelle-disable-doall"
+  "-noelle-parallelizer-force -noelle-disable-doall -dswp-no-scc-merge"
+  "-noelle-parallelizer-force -noelle-disable-doall -noelle-disable-helix"
+  "-noelle-parallelizer-force -noelle-disable-doall -noelle-disable-helix -dswp-no-scc-merge"
+  "-noelle-parallelizer-force -noelle-disable-doall -noelle-disable-dswp"
+  "-noelle-parallelizer-force -noelle-disable-doall -noelle-disable-dswp -dswp-no-scc-merge"
+) ;
+
+# Directory with the state of the jobs.
+jobsDir="regression_jobs" ;
+
+function printUsage {
+  echo "USAGE: `basename $0` [-j JOBS] [-H HOST[:JOBS],...] [-s regression|unit|all] [-C]" ;
+}
+
+# Print the hash of the names and contents of the files in a directory (following symbolic links).
+# The files generated by the tests are skipped.
+function hashDirectory {
+  pushd $1 > /dev/null ;
+  find -L . -type f ! -name "*.txt" ! -name "*.bc" ! -name "*.ll" ! -name "*.o" ! -name "baseline" ! -name "parallelized" ! -name "*prof*" | sort | xargs -r sha256sum | sha256sum | awk '{print $1}' ;
+  popd > /dev/null ;
+}
+
+# Print the hash of a job.
+function hashJob {
+  echo "$@" | sha256sum | awk '{print $1}' ;
+}
+
+# Run a regression test in the current directory.
+function runRegressionTest {
+  local options="$1" ;
+
+  # Clean
+  make clean > /dev/null ;
+
+  # Compile
+  make PARALLELIZATION_OPTIONS="-noelle-verbose=3 ${options}" >> compiler_output.txt 2>&1 ;
+
+  # Generate the input
+  make input.txt &> /dev/null ;
+
+  # Baseline
+  ./baseline `cat input.txt` &> output_baseline.txt ;
+
+  # Transformation
+  timeout 30m ./parallelized `cat input.txt` &> output_parallelized.txt ;
+
+  # Check the output
+  cmp output_baseline.txt output_parallelized.txt &> /dev/null ;
+
+  return $? ;
+}
+
+# Run the unit test @2 of the suite @1.
+function runUnitTest {
+  local suite="$1" ;
+  local test="$2" ;
+
+  cd unit ;
+  ../scripts/run_unit.sh $suite $test > /dev/null 2>&1 ;
+  grep -q "Failures: 0" $suite/suite/$test/test_output.txt 2> /dev/null ;
+  local result=$? ;
+  cd ../ ;
+
+  return $result ;
+}
+
+# Run the job @2 of the job file @1.
+# A job is a line with its kind, its directory, its key in the cache, and its options, separated by tabs.
+function runJob {
+  local jobFile="$1" ;
+  local jobID="$2" ;
+  local job="`sed -n "${jobID}p" $jobFile`" ;
+  local kind="`echo "$job" | cut -f1`" ;
+  local dir="`echo "$job" | cut -f2`" ;
+  local key="`echo "$job" | cut -f3`" ;
+  local options="`echo "$job" | cut -f4-`" ;
+
+  # Run the test
+  local result="FAIL" ;
+  if test "$kind" == "regression" ; then
+    pushd $dir > /dev/null ;
+    runRegressionTest "$options" ;
+    if test $? -eq 0 ; then
+      result="PASS" ;
+    fi
+    popd > /dev/null ;
+  else
+    runUnitTest `dirname $dir` `basename $dir` ;
+    if test $? -eq 0 ; then
+      result="PASS" ;
+    fi
+  fi
+  echo "$result `hostname`" > $jobsDir/results/$jobID ;
+
+  # Cache the result
+  if test "$result" == "PASS" -a "$useCache" == "1" ; then
+    touch $cacheDir/$key ;
+  fi
+
+  return ;
+}
+
+# Add a job to run, unless its result is cached.
+function addJob {
+  local kind="$1" ;
+  local dir="$2" ;
+  local key="$3" ;
+  local options="$4" ;
+
+  let numberOfJobs=$numberOfJobs+1 ;
+  printf "%s\t%s\t%s\t%s\n" "$kind" "$dir" "$key" "$options" >> $jobsDir/jobs.txt ;
+  if test "$useCache" == "1" -a -f $cacheDir/$key ; then
+    echo "CACHED" > $jobsDir/results/$numberOfJobs ;
+    return 1 ;
+  fi
+  echo $numberOfJobs >> $jobsDir/pending.txt ;
+
+  return 0 ;
+}
+
+# Fetch the options
+useCache="1" ;
+cacheDir=${NOELLE_TEST_CACHE:-$HOME/.cache/noelle/tests} ;
+if test "$1" == "-job" ; then
+  useCache="$4" ;
+  cacheDir="$5" ;
+  runJob "$2" "$3" ;
+  exit 0 ;
+fi
+jobsPerHost=`nproc` ;
+hosts="" ;
+suites="all" ;
+while getopts "j:H:s:Ch" opt ; do
+  case $opt in
+    j) jobsPerHost="$OPTARG" ;;
+    H) hosts="`echo $OPTARG | tr ',' ' '`" ;;
+    s) suites="$OPTARG" ;;
+    C) useCache="0" ;;
+    *) printUsage ; exit 1 ;;
+  esac
+done
+if test "$suites" != "all" -a "$suites" != "regression" -a "$suites" != "unit" ; then
+  printUsage ;
+  exit 1 ;
+fi
+
+export PATH=`pwd`/../install/bin:$PATH ;
+testsDir=`pwd` ;
+mkdir -p $cacheDir ;
+
+# Prepare the jobs
+rm -rf $jobsDir regression_[0-9]* ;
+mkdir -p $jobsDir/results ;
+touch $jobsDir/jobs.txt $jobsDir/pending.txt ;
+numberOfJobs=0 ;
+if test "$suites" != "unit" ; then
+  echo "Preparing the regression tests" ;
+  ./scripts/add_symbolic_link.sh > /dev/null ;
+  buildHash=`hashDirectory ../install` ;
+  declare -A testHashes ;
+  for test in `ls regression` ; do
+    if ! test -d regression/$test ; then
+      continue ;
+    fi
+    testHashes[$test]=`hashDirectory regression/$test` ;
+  done
+  for idx in ${!configurations[@]} ; do
+    options="${configurations[$idx]}" ;
+    for test in `ls regression` ; do
+      if ! test -d regression/$test ; then
+        continue ;
+      fi
+      dir="regression_${idx}/$test" ;
+      key=`hashJob "regression" "$test" "$buildHash" "${testHashes[$test]}" "$options"` ;
+      addJob "regression" "$dir" "$key" "$options" ;
+      if test $? -eq 0 ; then
+
+        # Each configuration compiles its own copy of the test
+        mkdir -p regression_${idx} ;
+        cp -a regression/$test regression_${idx}/ ;
+      fi
+    done
+  done
+fi
+if test "$suites" != "regression" ; then
+  echo "Building the unit tests" ;
+  cd unit ;
+  make &> ../$jobsDir/unit_build.txt ;
+  if test $? -ne 0 ; then
+    echo "ERROR: the unit tests cannot be built (see $jobsDir/unit_build.txt)" ;
+  fi
+  cd ../ ;
+  buildHash=`hashDirectory ../install` ;
+  for suite in `ls unit` ; do
+    if ! test -d unit/$suite/suite ; then
+      continue ;
+    fi
+    for test in `ls unit/$suite/suite` ; do
+      if ! test -f unit/$suite/suite/$test/test.cpp ; then
+        continue ;
+      fi
+      testHash=`hashDirectory unit/$suite/suite/$test` ;
+      key=`hashJob "unit" "$suite/$test" "$buildHash" "$testHash"` ;
+      addJob "unit" "$suite/$test" "$key" "" ;
+    done
+  done
+fi
+numberOfPendingJobs=`wc -l < $jobsDir/pending.txt` ;
+echo "Running $numberOfPendingJobs jobs ($(( $numberOfJobs - $numberOfPendingJobs )) cached)" ;
+
+# Run the jobs
+jobCommand="./scripts/test_parallel.sh -job $jobsDir/jobs.txt {} $useCache $cacheDir" ;
+if test "$hosts" == "" ; then
+  xargs -a $jobsDir/pending.txt -P $jobsPerHost -I{} $jobCommand ;
+else
+
+  # Shard the jobs among the hosts
+  numberOfHosts=`echo $hosts | wc -w` ;
+  awk -v hosts=$numberOfHosts -v dir=$jobsDir '{ print > (dir "/pending_" (NR % hosts) ".txt") }' $jobsDir/pending.txt ;
+  hostIndex=0 ;
+  for host in $hosts ; do
+    hostName=`echo $host | cut -d: -f1` ;
+    hostJobs=`echo $host | cut -s -d: -f2` ;
+    hostJobs=${hostJobs:-$jobsPerHost} ;
+    if test -f $jobsDir/pending_${hostIndex}.txt ; then
+      ssh $hostName "cd $testsDir && export PATH=$testsDir/../install/bin:\$PATH && xargs -a $jobsDir/pending_${hostIndex}.txt -P $hostJobs -I{} $jobCommand" &
+    fi
+    let hostIndex=$hostIndex+1 ;
+  done
+  wait ;
+fi
+
+# Print the results
+failures=0 ;
+jobID=0 ;
+previousGroup="" ;
+function printGroup {
+  if test "$previousGroup" == "" ; then
+    return ;
+  fi
+  echo "$previousGroup" ;
+  echo "   Tests passed: ${passed} / ${checked} (${cached} cached)" ;
+  if test "${failed}" != "" ; then
+    echo "    Tests failed: ${failed}" ;
+  fi
+  echo "" ;
+}
+while IFS=$'\t' read -r kind dir key options ; do
+  let jobID=$jobID+1 ;
+  if test "$kind" == "regression" ; then
+    if test "$options" == "" ; then
+      group="Testing the default configuration" ;
+    else
+      group="Testing with \"$options\"" ;
+    fi
+  else
+    group="Testing the unit tests" ;
+  fi
+  if test "$group" != "$previousGroup" ; then
+    printGroup ;
+    previousGroup="$group" ;
+    passed=0 ;
+    checked=0 ;
+    cached=0 ;
+    failed="" ;
+  fi
+  let checked=$checked+1 ;
+  result=`awk '{print $1}' $jobsDir/results/$jobID 2> /dev/null` ;
+  if test "$result" == "PASS" -o "$result" == "CACHED" ; then
+    let passed=$passed+1 ;
+    if test "$result" == "CACHED" ; then
+      let cached=$cached+1 ;
+    fi
+  else
+    failed="${failed}${failed:+ }${dir}" ;
+    let failures=$failures+1 ;
+  fi
+done < $jobsDir/jobs.txt
+printGroup ;
+
+if test $failures -ne 0 ; then
+  exit 1 ;
+fi
+exit 0 ;
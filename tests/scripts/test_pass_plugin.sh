@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# Run the NOELLE analyses through the new pass manager of opt (-load-pass-plugin).
+# A test passes if opt succeeds and it prints the PDG and the loops of the test.
+function runTest {
+  local passes="$1" ;
+  local expected="$2" ;
+
+  noelle-load-npm -passes="${passes}" test.bc -disable-output &> output_plugin.txt ;
+  if test $? -ne 0 ; then
+    return 1 ;
+  fi
+  grep -q "${expected}" output_plugin.txt ;
+  if test $? -ne 0 ; then
+    return 1 ;
+  fi
+
+  return 0 ;
+}
+
+export PATH=`pwd`/../install/bin:$PATH
+
+cd pass_plugin ;
+
+checked_tests=0 ;
+passed_tests=0 ;
+dirs_of_failed_tests="" ;
+for i in `ls`; do
+  if ! test -d $i ; then
+    continue ;
+  fi
+  checked_tests=`echo "$checked_tests + 1" | bc` ;
+  cd $i ;
+
+  # Compile
+  rm -f *.bc output_plugin.txt ;
+  clang++ -std=c++14 -emit-llvm -O0 -Xclang -disable-O0-optnone -c test.cpp -o test_pre.bc &> compiler_output.txt ;
+  opt -mem2reg test_pre.bc -o test.bc &>> compiler_output.txt ;
+
+  # Run the analyses of NOELLE
+  if true \
+     && runTest "require<noelle-pdg>,print<noelle-pdg>" "PDG of" \
+     && runTest "noelle-analyses,function(print<noelle-ldi>)" "SCCs" ; then
+    passed_tests=`echo "$passed_tests + 1" | bc` ;
+  else
+    dirs_of_failed_tests="${i} ${dirs_of_failed_tests}" ;
+  fi
+
+  cd ../ ;
+done
+
+# Print the results
+echo "   Tests passed: ${passed_tests} / ${checked_tests}" ;
+if test "${dirs_of_failed_tests}" != "" ; then
+  echo "    Tests failed: ${dirs_of_failed_tests}" ;
+fi
+
+cd ../ ;
+
+exit 0;
@@ -1,40 +1,246 @@
 #!/bin/bash
 
+# Harness options
+#   PERF_WARMUP_RUNS: runs executed before measuring a binary
+#   PERF_RUNS: runs measured per binary
+#   PERF_CPUS: CPUs the binaries are pinned to (taskset list, e.g., 0-15)
+#   PERF_STRICT: if 1, refuse to measure when the CPU frequency can change
+#   PERF_UPDATE_REFERENCE: if 1, the current times become the reference of the regression checks
+#   PERF_MIN_REGRESSION: slowdown (in %) below which regressions are not reported
+PERF_WARMUP_RUNS=${PERF_WARMUP_RUNS:-2} ;
+PERF_RUNS=${PERF_RUNS:-15} ;
+PERF_CPUS=${PERF_CPUS:-} ;
+PERF_STRICT=${PERF_STRICT:-0} ;
+PERF_UPDATE_REFERENCE=${PERF_UPDATE_REFERENCE:-0} ;
+PERF_MIN_REGRESSION=${PERF_MIN_REGRESSION:-2} ;
+
+# Counters captured by perf (if available)
+PERF_EVENTS="cycles,instructions,LLC-load-misses" ;
+
+# Tests that are significantly slower than their reference
+regressions="" ;
+
+function checkMachine {
+
+  # Check the frequency governors
+  local governors=`cat /sys/devices/system/cpu/cpu*/cpufreq/scaling_governor 2> /dev/null | sort -u | tr '\n' ' '` ;
+  governor="${governors% }" ;
+  if test "$governor" == "" ; then
+    governor="unknown" ;
+  fi
+  local unstable="0" ;
+  if test "$governor" != "performance" -a "$governor" != "unknown" ; then
+    echo "WARNING: the frequency governor is \"$governor\" rather than \"performance\"" ;
+    unstable="1" ;
+  fi
+
+  # Check the frequency boost
+  if test "`cat /sys/devices/system/cpu/cpufreq/boost 2> /dev/null`" == "1" ; then
+    echo "WARNING: the frequency boost is enabled" ;
+    unstable="1" ;
+  fi
+  if test "`cat /sys/devices/system/cpu/intel_pstate/no_turbo 2> /dev/null`" == "0" ; then
+    echo "WARNING: Intel turbo boost is enabled" ;
+    unstable="1" ;
+  fi
+  if test "$unstable" == "1" -a "$PERF_STRICT" == "1" ; then
+    echo "ERROR: the CPU frequency can change during the measurements (PERF_STRICT=1)" ;
+    exit 1;
+  fi
+
+  # Set the command to pin the binaries
+  pinCommand="" ;
+  if test "$PERF_CPUS" != "" ; then
+    if ! command -v taskset &> /dev/null ; then
+      echo "ERROR: taskset is needed to pin the binaries to the CPUs $PERF_CPUS" ;
+      exit 1;
+    fi
+    pinCommand="taskset -c $PERF_CPUS" ;
+  fi
+
+  # Check if the hardware counters can be read
+  perfCommand="" ;
+  if command -v perf &> /dev/null && perf stat -x, -e $PERF_EVENTS -o /dev/null true &> /dev/null ; then
+    perfCommand="perf stat -x, -e $PERF_EVENTS" ;
+  else
+    echo "WARNING: perf is not available, the hardware counters will not be captured" ;
+  fi
+
+  return ;
+}
+
+# Print "median ci_low ci_high mean stddev runs" of the times (one per line) stored in a file.
+# The confidence interval of the median is the 95% one computed from the order statistics.
+function summarizeTimes {
+  sort -g $1 | awk '
+    {
+      t[NR] = $1 ;
+      sum += $1 ;
+    }
+    END {
+      n = NR ;
+      if (n == 0){
+        print "0 0 0 0 0 0" ;
+        exit ;
+      }
+      if (n % 2) {
+        median = t[(n + 1) / 2] ;
+      } else {
+        median = (t[n / 2] + t[n / 2 + 1]) / 2 ;
+      }
+      delta = 1.96 * sqrt(n) ;
+      low = int((n - delta) / 2) ;
+      high = int(1 + (n + delta) / 2 + 0.999999) ;
+      if (low < 1) low = 1 ;
+      if (high > n) high = n ;
+      mean = sum / n ;
+      for (i = 1; i <= n; i++){
+        variance += (t[i] - mean) ^ 2 ;
+      }
+      stddev = (n > 1) ? sqrt(variance / (n - 1)) : 0 ;
+      printf("%.6f %.6f %.6f %.6f %.6f %d\n", median, t[low], t[high], mean, stddev, n) ;
+    }' ;
+}
+
+# Return 0 if the times of the second file are significantly higher than the ones of the first file.
+# This is a one-sided Mann-Whitney U test with a 1% significance level. Slowdowns of the median below PERF_MIN_REGRESSION are ignored.
+function isSlower {
+  { awk '{ print $1, 0 }' $1 ; awk '{ print $1, 1 }' $2 ; } | sort -g | awk -v minSlowdown=$PERF_MIN_REGRESSION '
+    {
+      v[NR] = $1 ;
+      l[NR] = $2 ;
+    }
+    END {
+      for (i = 1; i <= NR; i = j){
+        for (j = i; (j <= NR) && (v[j] == v[i]); j++) ;
+        rank = (i + j - 1) / 2 ;
+        ties += (j - i) ^ 3 - (j - i) ;
+        for (k = i; k < j; k++){
+          if (l[k]){
+            ranks += rank ;
+            n2++ ;
+            times2[n2] = v[k] ;
+          } else {
+            n1++ ;
+            times1[n1] = v[k] ;
+          }
+        }
+      }
+      if ((n1 < 2) || (n2 < 2)){
+        exit 1 ;
+      }
+      n = n1 + n2 ;
+      u = ranks - n2 * (n2 + 1) / 2 ;
+      sd = sqrt((n1 * n2 / 12) * ((n + 1) - ties / (n * (n - 1)))) ;
+      if (sd == 0){
+        exit 1 ;
+      }
+      z = (u - n1 * n2 / 2) / sd ;
+      median1 = (times1[int((n1 + 1) / 2)] + times1[int(n1 / 2) + 1]) / 2 ;
+      median2 = (times2[int((n2 + 1) / 2)] + times2[int(n2 / 2) + 1]) / 2 ;
+      slowdown = ((median2 - median1) / median1) * 100 ;
+      if ((z > 2.326) && (slowdown > minSlowdown)){
+        exit 0 ;
+      }
+      exit 1 ;
+    }' ;
+}
+
+# Print the hardware counters captured by "perf stat -x," as JSON fields.
+function countersToJSON {
+  if ! test -s $1 ; then
+    echo -n "\"counters\": {}" ;
+    return ;
+  fi
+  awk -F, '
+    BEGIN {
+      names["cycles"] = "cycles" ;
+      names["instructions"] = "instructions" ;
+      names["LLC-load-misses"] = "llc_misses" ;
+      printf("\"counters\": {") ;
+    }
+    /^#/ || NF < 3 {
+      next ;
+    }
+    {
+      event = $3 ;
+      sub(/:.*/, "", event) ;
+      if (!(event in names) || ($1 !~ /^[0-9.]+$/)){
+        next ;
+      }
+      printf("%s\"%s\": %s", sep, names[event], $1) ;
+      sep = ", " ;
+    }
+    END {
+      printf("}") ;
+    }' $1 ;
+}
+
+# Print the measurements of a binary as a JSON object.
+function timesToJSON {
+  local times=$1 ;
+  local counters=$2 ;
+
+  if ! test -s $times ; then
+    echo -n "null" ;
+    return ;
+  fi
+  summarizeTimes $times | awk '{ printf("{\"median\": %s, \"ci95_low\": %s, \"ci95_high\": %s, \"mean\": %s, \"stddev\": %s, \"runs\": %s", $1, $2, $3, $4, $5, $6) }' ;
+  echo -n ", \"times\": [`paste -s -d, $times`], " ;
+  countersToJSON $counters ;
+  echo -n "}" ;
+}
+
+function runBinary {
+  $pinCommand ./$1 $2 ;
+}
+
 function measureTime {
   local binaryName=$1 ;
   local outputTimeFileName=$2 ;
   local outputFileName=$3 ;
+  local timesFileName=$4 ;
+  local countersFileName=$5 ;
 
   # Read input for arguments to performance runs
   local ARGS=$(< perf_args.info) ;
 
-  # Create a temporary file
-  tempFile=`mktemp` ;
-  tempFile2=`mktemp` ;
-  tempFile3=`mktemp` ;
+  # Warm up the caches and the file system
+  for j in `seq 1 $PERF_WARMUP_RUNS` ; do
+    runBinary $binaryName "$ARGS" &> /dev/null ;
+    if test $? -ne 0 ; then
+      echo "ERROR: `pwd` crashed" ;
+      echo "0" > $outputTimeFileName ;
+      return 1;
+    fi
+  done
 
   # Measure the execution times
-  for j in `seq 0 7` ; do
+  > $timesFileName ;
+  for j in `seq 1 $PERF_RUNS` ; do
 
     # Measure the time
-    { time ./$binaryName $ARGS ; } &> $tempFile ;
+    local start=`date +%s%N` ;
+    runBinary $binaryName "$ARGS" &> /dev/null ;
 
     # Check if the execution crashed
     if test $? -ne 0 ; then
       echo "ERROR: `pwd` crashed" ;
       echo "0" > $outputTimeFileName ;
-      return 1; 
+      return 1;
     fi
 
     # Append the time
-    local MATCHER="/real\t(.*)m(.*)s/" ;
-    local PRINTER="{ print a[1] * 60 + a[2] }" ;
-    local GAWK_CMD=" match(\$0, ${MATCHER}, a) ${PRINTER} " ;
-    local timeMeasured=$(gawk "$GAWK_CMD" $tempFile) ;
-    echo $timeMeasured >> $tempFile2 ;
-
+    local end=`date +%s%N` ;
+    echo "$start $end" | awk '{ printf("%.6f\n", ($2 - $1) / 1000000000) }' >> $timesFileName ;
   done
 
+  # Capture the hardware counters in a separate run to not perturb the times
+  > $countersFileName ;
+  if test "$perfCommand" != "" ; then
+    $perfCommand -o $countersFileName $pinCommand ./$binaryName $ARGS &> /dev/null ;
+  fi
+
   # Check if the baseline output already exists
   if ! test -e $outputFileName ; then
 
@@ -45,40 +251,45 @@ function measureTime {
     if test $? -ne 0 ; then
       echo "ERROR: `pwd` crashed" ;
       echo "0" > $outputTimeFileName ;
-      return 1; 
+      return 1;
     fi
 
     # Compress it
     xz --compress ${outputFileName} ;
   fi
 
-  # Sort the times
-  sort -g $tempFile2 > $tempFile3 ;
-
-  # Fetch the number of lines of the file
-  lines=`wc -l $tempFile3 | awk '{print $1}'` ;
-
-   # Compute the median
-  median=`echo "$lines / 2" | bc` ;
+  # Print the median
+  local summary=`summarizeTimes $timesFileName` ;
+  echo "$summary" | awk '{ print $1 }' > $outputTimeFileName ;
+  echo "$summary" | awk '{ printf("   Median: %s s (95%% CI: %s - %s s, %s runs)\n", $1, $2, $3, $6) }' ;
 
-  # Fetch the median
-  result=`awk -v median=$median '
-    BEGIN {
-      c = 0;
-    }{
-      if (c == median){
-        print ;
-      }
-      c++;
-    }' $tempFile3` ;
+  return ;
+}
 
-  # Print the median
-  echo "$result" > $outputTimeFileName ;
+# Print a number as JSON (e.g., .5 as 0.5)
+function toJSONNumber {
+  echo "$1" | awk '{ printf("%g", $1) }' ;
+}
 
-  # Clean
-  rm $tempFile ;
-  rm $tempFile2 ;
-  rm $tempFile3 ;
+# Dump the results of the current test to perf_results.json
+function dumpResults {
+  local testName=$1 ;
+  local speedup=$2 ;
+  local regressed=$3 ;
+
+  {
+    echo "{" ;
+    echo "  \"test\": \"$testName\"," ;
+    echo "  \"warmup_runs\": $PERF_WARMUP_RUNS," ;
+    echo "  \"cpus\": \"$PERF_CPUS\"," ;
+    echo "  \"governor\": \"$governor\"," ;
+    echo "  \"time_baseline\": `toJSONNumber $(< time_baseline.txt)`," ;
+    echo "  \"baseline\": `timesToJSON times_baseline.txt counters_baseline.txt`," ;
+    echo "  \"parallelized\": `timesToJSON times_parallelized.txt counters_parallelized.txt`," ;
+    echo "  \"speedup\": `toJSONNumber $speedup`," ;
+    echo "  \"regression\": $regressed" ;
+    echo "}" ;
+  } > perf_results.json ;
 
   return ;
 }
@@ -105,7 +316,8 @@ function runningTests {
 
     # Clean
     # echo "   Make clean " ;
-    make clean > /dev/null ; 
+    make clean > /dev/null ;
+    rm -f times_*.txt counters_*.txt perf_results.json ;
 
     # Check if we need to override options
     if test -f parallelization_options.txt ; then
@@ -120,9 +332,9 @@ function runningTests {
     local ARGS=$(< perf_args.info) ;
 
     # Measure the baseline
-    if ! test -f time_baseline.txt ; then 
+    if ! test -f time_baseline.txt ; then
       echo -e "  Running baseline " ;
-      measureTime baseline time_baseline.txt baseline_output.txt ;
+      measureTime baseline time_baseline.txt baseline_output.txt times_baseline.txt counters_baseline.txt ;
       if test $? -ne 0 ; then
         popd ;
         echo "0" >> $4 ;
@@ -139,7 +351,7 @@ function runningTests {
 
     # Measure the parallelized binary
     echo -e "  Running performance " ;
-    measureTime parallelized time_parallelized.txt output_parallelized.txt ;
+    measureTime parallelized time_parallelized.txt output_parallelized.txt times_parallelized.txt counters_parallelized.txt ;
     local PAR=`cat time_parallelized.txt` ;
 
     # Check if the outputs match
@@ -150,18 +362,31 @@ function runningTests {
       continue ;
     fi
 	  cmp baseline_output.txt.xz output_parallelized.txt.xz &> /dev/null ;
-    if test $? -ne 0 ; then 
+    if test $? -ne 0 ; then
       echo "ERROR: `pwd` did not generate the correct output" ;
       popd ;
       echo "0" >> $4 ;
       continue ;
     fi
-    popd ;
+
+    # Compare the parallelized binary with its reference times
+    local regressed="false" ;
+    if test -f time_parallelized_reference.txt -a "$PERF_UPDATE_REFERENCE" != "1" ; then
+      if isSlower time_parallelized_reference.txt times_parallelized.txt ; then
+        echo "ERROR: `pwd` is significantly slower than its reference" ;
+        regressed="true" ;
+        regressions="$regressions $i" ;
+      fi
+    else
+      cp times_parallelized.txt time_parallelized_reference.txt ;
+    fi
 
     # Dump the speedup
     local SPEEDUP=$(bc <<< " scale=3; $BASE / $PAR ") ;
     echo -e "  Speedup: $SPEEDUP" ;
     echo $SPEEDUP >> $4 ;
+    dumpResults $i $SPEEDUP $regressed ;
+    popd ;
   done
 
   echo "Done"
@@ -169,10 +394,19 @@ function runningTests {
 
 export PATH=`pwd`/../install/bin:$PATH ;
 
+# Check the machine
+checkMachine ;
+
 # Run
 cd performance ;
 runningTests "Measuring the default configuration" "-noelle-verbose=3" " " "speedups.txt" ;
 
 cd ../ ;
 
+# Check the regressions
+if test "$regressions" != "" ; then
+  echo "ERROR: the following tests are significantly slower than their reference:$regressions" ;
+  exit 1;
+fi
+
 exit 0;
@@ -0,0 +1,187 @@
+#!/bin/bash
+
+# Measure how the analyses of NOELLE scale on synthetic programs (see scaling/generate_module.py).
+# Each sweep varies one parameter of the programs and keeps the others to their base values.
+# The exponent of the growth of each phase (i.e., the slope of its time in log-log scale) is then fitted for each sweep.
+#
+# Harness options
+#   SCALING_FUNCTIONS: numbers of functions to sweep
+#   SCALING_MEMORY: memory instructions per loop body to sweep (the programs have a single function)
+#   SCALING_DEPTH: loop nesting depths to sweep
+#   SCALING_ALIASING: aliasing patterns to sweep
+#   SCALING_TOOLS: tools to measure (see COMPILE_TIME_TOOLS of test_compile_time.sh)
+#   SCALING_OUTPUT: file to generate with the measurements
+#   SCALING_UPDATE_REFERENCE: set to 1 to store the exponents as the reference the next runs compare against
+SCALING_FUNCTIONS=${SCALING_FUNCTIONS:-1 2 4 8 16 32 64} ;
+SCALING_MEMORY=${SCALING_MEMORY:-4 8 16 32 64 128 256} ;
+SCALING_DEPTH=${SCALING_DEPTH:-1 2 3 4 5} ;
+SCALING_ALIASING=${SCALING_ALIASING:-none globals args mixed} ;
+SCALING_TOOLS=${SCALING_TOOLS:-pdg planner} ;
+SCALING_OUTPUT=${SCALING_OUTPUT:-`pwd`/scaling.json} ;
+SCALING_UPDATE_REFERENCE=${SCALING_UPDATE_REFERENCE:-0} ;
+
+exponentsFile="`pwd`/scaling_exponents.txt" ;
+referenceFile="`pwd`/scaling_exponents_reference.txt" ;
+corpusDir="`pwd`/scaling/corpus" ;
+
+# Generate the program of a point of a sweep, and add its profiled bitcode to the corpus.
+function generatePoint {
+  local name="$1" ;
+  local generatorOptions="${@:2}" ;
+
+  echo "Generating $name ($generatorOptions)" ;
+  mkdir -p scaling/$name ;
+  pushd ./ > /dev/null ;
+  cd scaling/$name ;
+  ../generate_module.py $generatorOptions -o test.cpp ;
+  echo "8" > test_args.info ;
+  if ! test -f Makefile ; then
+    ln -s ../../scripts/Makefile ;
+  fi
+  if ! test -f Parallelizer_utils.cpp ; then
+    ln -s ../../../src/core/runtime/Parallelizer_utils.cpp ;
+  fi
+  make baseline_pre.bc >> compiler_output.txt 2>&1 ;
+  if test -f baseline_pre.bc ; then
+    ln -sf `pwd`/baseline_pre.bc $corpusDir/${name}.bc ;
+  else
+    echo "ERROR: `pwd` did not generate baseline_pre.bc" ;
+  fi
+  popd > /dev/null ;
+
+  return ;
+}
+
+# Print the exponents of the growth of the tools and phases for each numeric sweep.
+# Points are named SWEEP_VALUE.
+function fitExponents {
+  awk '
+    /"bitcode"/ {
+      split($0, fields, "\"phases\": \\{") ;
+      record = fields[1] ;
+      phases = fields[2] ;
+      sub(/\}\}.*$/, "", phases) ;
+
+      # Fetch the point
+      match(record, /"bitcode": "[^"]*"/) ;
+      point = substr(record, RSTART + 12, RLENGTH - 13) ;
+      sweep = point ;
+      sub(/_[^_]*$/, "", sweep) ;
+      value = point ;
+      sub(/^.*_/, "", value) ;
+      match(record, /"tool": "[^"]*"/) ;
+      tool = substr(record, RSTART + 9, RLENGTH - 10) ;
+      match(record, /"wall_seconds": [0-9.]+/) ;
+      wall = substr(record, RSTART + 16, RLENGTH - 16) ;
+
+      add(sweep, value, tool " (wall)", wall) ;
+      n = split(phases, pairs, ", ") ;
+      for (i = 1; i <= n; i++){
+        if (pairs[i] == ""){
+          continue ;
+        }
+        split(pairs[i], pair, ": ") ;
+        phase = pair[1] ;
+        gsub(/"/, "", phase) ;
+        add(sweep, value, tool ": " phase, pair[2]) ;
+      }
+    }
+    function add(sweep, value, metric, time,    key) {
+      key = sweep SUBSEP metric ;
+      if (!(key in points)){
+        keys[++numberOfKeys] = key ;
+      }
+      points[key]++ ;
+      values[key, points[key]] = value ;
+      times[key, points[key]] = time ;
+    }
+    END {
+      for (k = 1; k <= numberOfKeys; k++){
+        key = keys[k] ;
+        split(key, parts, SUBSEP) ;
+
+        # Fit the exponent on the points that take a measurable time
+        n = sx = sy = sxx = sxy = 0 ;
+        series = "" ;
+        numeric = 1 ;
+        for (p = 1; p <= points[key]; p++){
+          v = values[key, p] ;
+          t = times[key, p] ;
+          series = series " " v "=" t ;
+          if (v !~ /^[0-9]+$/){
+            numeric = 0 ;
+            continue ;
+          }
+          if ((v <= 0) || (t < 0.001)){
+            continue ;
+          }
+          x = log(v) ;
+          y = log(t) ;
+          n++ ;
+          sx += x ;
+          sy += y ;
+          sxx += x * x ;
+          sxy += x * y ;
+        }
+        exponent = "-" ;
+        if (numeric && (n >= 2) && ((n * sxx - sx * sx) != 0)){
+          exponent = sprintf("%.2f", (n * sxy - sx * sy) / (n * sxx - sx * sx)) ;
+        }
+        printf("%s|%s|%s|%s\n", parts[1], parts[2], exponent, series) ;
+      }
+    }
+  ' $1 ;
+}
+
+export PATH=`pwd`/../install/bin:$PATH ;
+
+# Generate the programs
+rm -rf $corpusDir ;
+mkdir -p $corpusDir ;
+for i in $SCALING_FUNCTIONS ; do
+  generatePoint functions_$i --functions $i ;
+done
+for i in $SCALING_MEMORY ; do
+  generatePoint memory_$i --functions 1 --memory $i ;
+done
+for i in $SCALING_DEPTH ; do
+  generatePoint depth_$i --depth $i ;
+done
+for i in $SCALING_ALIASING ; do
+  generatePoint aliasing_$i --aliasing $i ;
+done
+
+# Measure the analyses
+COMPILE_TIME_CORPUS=$corpusDir COMPILE_TIME_OUTPUT=$SCALING_OUTPUT COMPILE_TIME_TOOLS="$SCALING_TOOLS" ./scripts/test_compile_time.sh ;
+
+# Fit the exponents
+fitExponents $SCALING_OUTPUT > $exponentsFile ;
+echo "" ;
+echo "Growth of the time of the analyses (exponent of the size of each sweep; superlinear ones are marked with *)" ;
+awk -F'|' -v referenceFile=$referenceFile '
+  BEGIN {
+    while ((getline line < referenceFile) > 0){
+      split(line, fields, "|") ;
+      reference[fields[1] SUBSEP fields[2]] = fields[3] ;
+    }
+  }
+  {
+    if ($1 != sweep){
+      sweep = $1 ;
+      printf("  Sweep %s\n", sweep) ;
+    }
+    mark = (($3 != "-") && ($3 >= 1.5)) ? "*" : " " ;
+    old = (($1 SUBSEP $2) in reference) ? (" (reference " reference[$1 SUBSEP $2] ")") : "" ;
+    printf("   %s %6s%s  %s\n", mark, $3, old, $2) ;
+    if ($3 == "-"){
+      printf("              %s\n", $4) ;
+    }
+  }
+' $exponentsFile ;
+if test "$SCALING_UPDATE_REFERENCE" == "1" ; then
+  cp $exponentsFile $referenceFile ;
+  echo "The exponents are now the reference" ;
+fi
+echo "The measurements are in $SCALING_OUTPUT" ;
+
+exit 0 ;
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2016 - 2019  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "AffineDependencesTestSuite.hpp"
+
+using namespace parallelizertests;
+
+namespace llvm::noelle {
+
+// Register pass to "opt"
+char AffineDependencesTestSuite::ID = 0;
+static RegisterPass<AffineDependencesTestSuite> X("UnitTester", "Affine Dependences Unit Tester");
+
+// Register pass to "clang"
+static AffineDependencesTestSuite * _PassMaker = NULL;
+static RegisterStandardPasses _RegPass1(PassManagerBuilder::EP_OptimizerLast,
+    [](const PassManagerBuilder&, legacy::PassManagerBase& PM) {
+        if(!_PassMaker){ PM.add(_PassMaker = new AffineDependencesTestSuite());}}); // ** for -Ox
+static RegisterStandardPasses _RegPass2(PassManagerBuilder::EP_EnabledOnOptLevel0,
+    [](const PassManagerBuilder&, legacy::PassManagerBase& PM) {
+        if(!_PassMaker){ PM.add(_PassMaker = new AffineDependencesTestSuite());}});// ** for -O0
+
+const char *AffineDependencesTestSuite::tests[] = {
+  "loops with dependences across iterations",
+  "loops without dependences across iterations"
+};
+
+TestFunction AffineDependencesTestSuite::testFns[] = {
+  AffineDependencesTestSuite::loopsWithDependencesAcrossIterations,
+  AffineDependencesTestSuite::loopsWithoutDependencesAcrossIterations
+};
+
+bool AffineDependencesTestSuite::doInitialization (Module &M) {
+  errs() << "AffineDependencesTestSuite: Initialize\n";
+  const int numTests = sizeof(tests) / sizeof(tests[0]);
+  this->suite = new TestSuite("AffineDependencesTestSuite", tests, testFns, numTests, "test.txt");
+  this->M = &M;
+  return false;
+}
+
+void AffineDependencesTestSuite::getAnalysisUsage (AnalysisUsage &AU) const {
+  AU.addRequired<ScalarEvolutionWrapperPass>();
+  AU.addRequired<LoopInfoWrapperPass>();
+}
+
+bool AffineDependencesTestSuite::runOnModule (Module &M) {
+  errs() << "AffineDependencesTestSuite: Start\n";
+
+  this->classifyLoops();
+
+  suite->runTests((ModulePass &)*this);
+
+  return false;
+}
+
+Values AffineDependencesTestSuite::loopsWithDependencesAcrossIterations (ModulePass &pass, TestSuite &suite) {
+  AffineDependencesTestSuite &attrPass = static_cast<AffineDependencesTestSuite &>(pass);
+  return attrPass.dependentLoops;
+}
+
+Values AffineDependencesTestSuite::loopsWithoutDependencesAcrossIterations (ModulePass &pass, TestSuite &suite) {
+  AffineDependencesTestSuite &attrPass = static_cast<AffineDependencesTestSuite &>(pass);
+  return attrPass.independentLoops;
+}
+
+void AffineDependencesTestSuite::classifyLoops (void) {
+  for (auto &F : *this->M) {
+    if (F.empty()) continue;
+
+    /*
+     * Fetch the outermost loop of the function.
+     */
+    auto &SE = getAnalysis<ScalarEvolutionWrapperPass>(F).getSE();
+    auto &LI = getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
+    if (LI.empty()) continue;
+    auto loop = *LI.begin();
+
+    /*
+     * Fetch the memory accesses of the loop.
+     */
+    std::vector<Instruction *> memoryAccesses;
+    for (auto B : loop->getBlocks()) {
+      for (auto &I : *B) {
+        if (isa<StoreInst>(&I) || isa<LoadInst>(&I)) {
+          memoryAccesses.push_back(&I);
+        }
+      }
+    }
+
+    /*
+     * Check every pair of accesses that includes a store, including a store
+     * with itself.
+     */
+    AffineDependenceAnalysis affine{ loop, SE };
+    auto isDependent = false;
+    for (auto access1 : memoryAccesses) {
+      for (auto access2 : memoryAccesses) {
+        if (!isa<StoreInst>(access1) && !isa<StoreInst>(access2)) continue;
+        if (affine.canAccessTheSameLocationAcrossIterations(access1, access2)) {
+          isDependent = true;
+        }
+      }
+    }
+
+    if (isDependent) {
+      this->dependentLoops.insert(F.getName().str());
+    } else {
+      this->independentLoops.insert(F.getName().str());
+    }
+  }
+
+  return ;
+}
+
+}
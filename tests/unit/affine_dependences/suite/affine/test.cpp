@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+char M[100][100];
+
+extern "C" {
+
+void dependent_shift (int *a, long long n){
+  for (long long i = 0; i < n; i++){
+    a[i + 1] = a[i] + 1;
+  }
+}
+
+void independent_same (int *a, long long n){
+  for (long long i = 0; i < n; i++){
+    a[i] += 1;
+  }
+}
+
+void independent_parity (int *a, long long n){
+  for (long long i = 0; i < n; i++){
+    a[2 * i] = a[2 * i + 1] + 1;
+  }
+}
+
+void dependent_sign_flip (int *a, long long n){
+  for (long long i = 0; i < n; i++){
+    a[i] = a[n - 1 - i] + 1;
+  }
+}
+
+void independent_sign_flip (int *a, long long n){
+  for (long long i = 0; i < n; i++){
+    a[2 * i] = a[2 * (n - i) + 1] + 1;
+  }
+}
+
+/*
+ * Coupled subscripts: M[i][i] and M[99-i][99-i] meet when the two iterations
+ * add up to 99.
+ */
+void dependent_coupled_sign_flip (void){
+  for (long long i = 0; i < 100; i++){
+    M[i][i] = M[99 - i][99 - i] + 1;
+  }
+}
+
+/*
+ * Coupled subscripts: M[i][i] and M[99-i][98-i] never meet.
+ */
+void independent_coupled_sign_flip (void){
+  for (long long i = 0; i < 99; i++){
+    M[i][i] = M[99 - i][98 - i] + 1;
+  }
+}
+
+/*
+ * The loops are rotated so their trip counts are affine.
+ */
+void independent_delinearized (long long *A, long long n){
+  if (n <= 0) return ;
+  long long i = 0;
+  do {
+    long long j = 0;
+    do {
+      A[i * n + j] += 1;
+      j++;
+    } while (j < n);
+    i++;
+  } while (i < n);
+}
+
+/*
+ * The column j can reach the next row when m is larger than n.
+ */
+void dependent_out_of_bounds (long long *A, long long n, long long m){
+  if ((n <= 0) || (m <= 0)) return ;
+  long long i = 0;
+  do {
+    long long j = 0;
+    do {
+      A[i * n + j] += 1;
+      j++;
+    } while (j < m);
+    i++;
+  } while (i < n);
+}
+
+/*
+ * The accesses meet after 2^40 - 1 iterations of the outer loop.
+ * The coefficients do not fit in 64 bits once they get combined.
+ */
+void dependent_overflow (char *a, long long n){
+  if (n <= 0) return ;
+  long long i = 0;
+  do {
+    long long j = 0;
+    do {
+      a[i * ((1LL << 40) + 1) + j * ((1LL << 40) - 1)] = 0;
+      j++;
+    } while (j < n);
+    i++;
+  } while (i < n);
+}
+
+}
+
+int main (int argc, char *argv[]){
+
+  /*
+   * Check the inputs.
+   */
+  if (argc < 2){
+    fprintf(stderr, "USAGE: %s LOOP_ITERATIONS\n", argv[0]);
+    return -1;
+  }
+  auto n = atoll(argv[1]);
+
+  auto a = (int *)calloc(4 * n + 2, sizeof(int));
+  auto A = (long long *)calloc(n * (n + 1) + 1, sizeof(long long));
+
+  dependent_shift(a, n);
+  independent_same(a, n);
+  independent_parity(a, n);
+  dependent_sign_flip(a, n);
+  independent_sign_flip(a, n);
+  dependent_coupled_sign_flip();
+  independent_coupled_sign_flip();
+  independent_delinearized(A, n);
+  dependent_out_of_bounds(A, n, n + 1);
+  if (argc > 100){
+    dependent_overflow((char *)A, n);
+  }
+
+  printf("%d %d %d %lld %lld\n", M[7][7], a[0], a[n], A[0], A[n * n]);
+  free(a);
+  free(A);
+
+  return 0;
+}
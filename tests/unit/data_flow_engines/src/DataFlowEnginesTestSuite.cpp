@@ -0,0 +1,241 @@
+/*
+ * Copyright 2016 - 2019  Angelo Matni, Simone Campanoni
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "DataFlowEnginesTestSuite.hpp"
+
+using namespace parallelizertests;
+
+namespace llvm::noelle {
+
+// Register pass to "opt"
+char DataFlowEnginesTestSuite::ID = 0;
+static RegisterPass<DataFlowEnginesTestSuite> X("UnitTester", "Data-Flow Engines Unit Tester");
+
+// Register pass to "clang"
+static DataFlowEnginesTestSuite * _PassMaker = NULL;
+static RegisterStandardPasses _RegPass1(PassManagerBuilder::EP_OptimizerLast,
+    [](const PassManagerBuilder&, legacy::PassManagerBase& PM) {
+        if(!_PassMaker){ PM.add(_PassMaker = new DataFlowEnginesTestSuite());}}); // ** for -Ox
+static RegisterStandardPasses _RegPass2(PassManagerBuilder::EP_EnabledOnOptLevel0,
+    [](const PassManagerBuilder&, legacy::PassManagerBase& PM) {
+        if(!_PassMaker){ PM.add(_PassMaker = new DataFlowEnginesTestSuite());}});// ** for -O0
+
+const char *DataFlowEnginesTestSuite::tests[] = {
+  "bit-vector engine matches on reaching stores",
+  "bit-vector engine matches on live values"
+};
+
+TestFunction DataFlowEnginesTestSuite::testFns[] = {
+  DataFlowEnginesTestSuite::reachingStoresMatch,
+  DataFlowEnginesTestSuite::liveValuesMatch
+};
+
+bool DataFlowEnginesTestSuite::doInitialization (Module &M) {
+  errs() << "DataFlowEnginesTestSuite: Initialize\n";
+  const int numTests = sizeof(tests) / sizeof(tests[0]);
+  this->suite = new TestSuite("DataFlowEnginesTestSuite", tests, testFns, numTests, "test.txt");
+  this->M = &M;
+  return false;
+}
+
+void DataFlowEnginesTestSuite::getAnalysisUsage (AnalysisUsage &AU) const {
+  AU.setPreservesAll();
+}
+
+bool DataFlowEnginesTestSuite::runOnModule (Module &M) {
+  errs() << "DataFlowEnginesTestSuite: Start\n";
+
+  suite->runTests((ModulePass &)*this);
+
+  return false;
+}
+
+/*
+ * Reaching stores: a store kills the other stores to the same pointer.
+ */
+Values DataFlowEnginesTestSuite::reachingStoresMatch (ModulePass &pass, TestSuite &suite) {
+  DataFlowEnginesTestSuite &attrPass = static_cast<DataFlowEnginesTestSuite &>(pass);
+
+  auto killedStores = [](Instruction *i) -> std::vector<Instruction *> {
+    std::vector<Instruction *> killed;
+    auto store = dyn_cast<StoreInst>(i);
+    if (store == nullptr) {
+      return killed;
+    }
+    auto pointer = store->getPointerOperand();
+    for (auto user : pointer->users()) {
+      auto otherStore = dyn_cast<StoreInst>(user);
+      if (true && (otherStore != nullptr) && (otherStore != store)
+          && (otherStore->getPointerOperand() == pointer)) {
+        killed.push_back(otherStore);
+      }
+    }
+    return killed;
+  };
+
+  /*
+   * Engine based on sets.
+   */
+  auto computeGEN = [](Instruction *i, DataFlowResult *df) {
+    if (isa<StoreInst>(i)) {
+      df->GEN(i).insert(i);
+    }
+  };
+  auto computeKILL = [&killedStores](Instruction *i, DataFlowResult *df) {
+    for (auto killed : killedStores(i)) {
+      df->KILL(i).insert(killed);
+    }
+  };
+  auto initializeIN = [](Instruction *inst, std::set<Value *> &IN) { return ; };
+  auto initializeOUT = [](Instruction *inst, std::set<Value *> &OUT) { return ; };
+  auto computeIN = [](Instruction *inst, std::set<Value *> &IN, Instruction *predecessor, DataFlowResult *df) {
+    auto &outP = df->OUT(predecessor);
+    IN.insert(outP.begin(), outP.end());
+  };
+  auto computeOUT = [](Instruction *inst, std::set<Value *> &OUT, DataFlowResult *df) {
+    auto &killI = df->KILL(inst);
+    for (auto v : df->IN(inst)) {
+      if (killI.find(v) == killI.end()) {
+        OUT.insert(v);
+      }
+    }
+    auto &genI = df->GEN(inst);
+    OUT.insert(genI.begin(), genI.end());
+  };
+
+  /*
+   * Engine based on bit vectors.
+   */
+  auto computeBitGEN = [](Instruction *i, DataFlowBitVectorResult *df) {
+    if (isa<StoreInst>(i)) {
+      df->GEN(i).set(df->getIndex(i));
+    }
+  };
+  auto computeBitKILL = [&killedStores](Instruction *i, DataFlowBitVectorResult *df) {
+    for (auto killed : killedStores(i)) {
+      df->KILL(i).set(df->getIndex(killed));
+    }
+  };
+  auto initializeBitIN = [](Instruction *inst, BitVector &IN) { return ; };
+  auto initializeBitOUT = [](Instruction *inst, BitVector &OUT) { return ; };
+  auto computeBitIN = [](Instruction *inst, BitVector &IN, Instruction *predecessor, DataFlowBitVectorResult *df) {
+    IN |= df->OUT(predecessor->getParent());
+  };
+
+  Values matches;
+  DataFlowEngine setEngine;
+  DataFlowBitVectorEngine bitEngine;
+  for (auto &F : *attrPass.M) {
+    if (F.empty()) continue;
+    auto sets = setEngine.applyForward(&F, computeGEN, computeKILL, initializeIN, initializeOUT, computeIN, computeOUT);
+    auto bits = bitEngine.applyForward(&F, computeBitGEN, computeBitKILL, initializeBitIN, initializeBitOUT, computeBitIN);
+    if (doResultsMatch(F, sets, bits)) {
+      matches.insert(F.getName().str());
+    }
+    delete sets;
+    delete bits;
+  }
+
+  return matches;
+}
+
+/*
+ * Live values: an instruction uses its operands that are instructions or
+ * arguments, and it defines itself.
+ */
+Values DataFlowEnginesTestSuite::liveValuesMatch (ModulePass &pass, TestSuite &suite) {
+  DataFlowEnginesTestSuite &attrPass = static_cast<DataFlowEnginesTestSuite &>(pass);
+
+  auto usedValues = [](Instruction *i) -> std::vector<Value *> {
+    std::vector<Value *> used;
+    for (auto &op : i->operands()) {
+      if (isa<Instruction>(op.get()) || isa<Argument>(op.get())) {
+        used.push_back(op.get());
+      }
+    }
+    return used;
+  };
+
+  /*
+   * Engine based on sets.
+   */
+  auto computeGEN = [&usedValues](Instruction *i, DataFlowResult *df) {
+    for (auto v : usedValues(i)) {
+      df->GEN(i).insert(v);
+    }
+  };
+  auto computeKILL = [](Instruction *i, DataFlowResult *df) {
+    df->KILL(i).insert(i);
+  };
+  auto computeIN = [](std::set<Value *> &IN, Instruction *inst, DataFlowResult *df) {
+    auto &killI = df->KILL(inst);
+    for (auto v : df->OUT(inst)) {
+      if (killI.find(v) == killI.end()) {
+        IN.insert(v);
+      }
+    }
+    auto &genI = df->GEN(inst);
+    IN.insert(genI.begin(), genI.end());
+  };
+  auto computeOUT = [](std::set<Value *> &OUT, Instruction *successor, DataFlowResult *df) {
+    auto &inS = df->IN(successor);
+    OUT.insert(inS.begin(), inS.end());
+  };
+
+  /*
+   * Engine based on bit vectors.
+   */
+  auto computeBitGEN = [&usedValues](Instruction *i, DataFlowBitVectorResult *df) {
+    for (auto v : usedValues(i)) {
+      df->GEN(i).set(df->getIndex(v));
+    }
+  };
+  auto computeBitKILL = [](Instruction *i, DataFlowBitVectorResult *df) {
+    df->KILL(i).set(df->getIndex(i));
+  };
+  auto computeBitOUT = [](BitVector &OUT, Instruction *successor, DataFlowBitVectorResult *df) {
+    OUT |= df->IN(successor->getParent());
+  };
+
+  Values matches;
+  DataFlowEngine setEngine;
+  DataFlowBitVectorEngine bitEngine;
+  for (auto &F : *attrPass.M) {
+    if (F.empty()) continue;
+    auto sets = setEngine.applyBackward(&F, computeGEN, computeKILL, computeIN, computeOUT);
+    auto bits = bitEngine.applyBackward(&F, computeBitGEN, computeBitKILL, computeBitOUT);
+    if (doResultsMatch(F, sets, bits)) {
+      matches.insert(F.getName().str());
+    }
+    delete sets;
+    delete bits;
+  }
+
+  return matches;
+}
+
+bool DataFlowEnginesTestSuite::doResultsMatch (Function &f, DataFlowResult *sets, DataFlowBitVectorResult *bits) {
+  for (auto &bb : f) {
+    for (auto &I : bb) {
+      if (sets->IN(&I) != bits->getValues(bits->IN(&I))) {
+        errs() << "DataFlowEnginesTestSuite: IN mismatch at " << I << "\n";
+        return false;
+      }
+      if (sets->OUT(&I) != bits->getValues(bits->OUT(&I))) {
+        errs() << "DataFlowEnginesTestSuite: OUT mismatch at " << I << "\n";
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+long long int counter;
+
+extern "C" {
+
+long long int straightLine (long long int *a, long long int x){
+  a[0] = x;
+  a[0] = x * 2;
+  counter = a[0] + 1;
+  counter = counter * 3;
+
+  return counter + a[0];
+}
+
+long long int branches (long long int *a, long long int x){
+  if (x > 10){
+    a[0] = x;
+    counter = x;
+  } else {
+    a[1] = x * 3;
+  }
+  a[2] = a[0] + a[1];
+
+  return a[2] + counter;
+}
+
+long long int loops (long long int *a, long long int n){
+  long long int sum = 0;
+  for (long long int i=0; i < n; i++){
+    a[i % 4] = i;
+    if ((i % 3) == 0){
+      counter += a[(i + 1) % 4];
+      continue;
+    }
+    for (long long int j=0; j < i; j++){
+      sum += a[j % 4] * j;
+      a[0] = sum % 1009;
+    }
+  }
+
+  return sum;
+}
+
+long long int switches (long long int *a, long long int x){
+  long long int r = 0;
+  while (x > 0){
+    switch (x % 4){
+      case 0:
+        a[0] = x;
+        r += a[1];
+        break;
+      case 1:
+        a[1] = x;
+        break;
+      case 2:
+        counter = r;
+        r -= a[0];
+        break;
+      default:
+        return r + x;
+    }
+    x--;
+  }
+
+  return r;
+}
+
+}
+
+int main (int argc, char *argv[]){
+  if (argc < 2) return 0;
+
+  auto x = atoll(argv[1]);
+  long long int a[4] = { 0, 0, 0, 0 };
+  auto r = straightLine(a, x);
+  r += branches(a, x);
+  r += loops(a, x);
+  r += switches(a, x);
+  printf("%lld\n", r);
+
+  return 0;
+}
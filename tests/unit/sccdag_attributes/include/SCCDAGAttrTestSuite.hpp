@@ -67,6 +67,14 @@ namespace llvm::noelle {
 
       static Values loopCarriedDependencies (ModulePass &pass, TestSuite &suite) ;
 
+      static Values mergedSCCsMatchFreshSCCDAG (ModulePass &pass, TestSuite &suite) ;
+      static Values splitSCCsMatchFreshSCCDAG (ModulePass &pass, TestSuite &suite) ;
+
+      static std::string describeSCC (TestSuite &suite, SCC *scc) ;
+      static Values describeSCCDAG (TestSuite &suite, SCCDAG &dag) ;
+      static Values compareSCCDAGs (Values &incremental, Values &fresh, std::string update) ;
+      std::vector<Value *> getLoopInternals (void) ;
+
       static Values printSCCs (ModulePass &pass, TestSuite &suite, std::set<SCC *> sccs) ;
 
       TestSuite *suite;
@@ -74,6 +82,8 @@ namespace llvm::noelle {
       ScalarEvolution *SE;
       LoopInfo *LI;
       PDG *fdg;
+      PDG *loopDG;
+      Loop *topLoop;
       SCCDAG *sccdag;
       SCCDAGAttrs *attrs;
   };
@@ -32,7 +32,9 @@ const char *SCCDAGAttrTestSuite::tests[] = {
   "reducible SCC",
   "clonable SCC",
   "clonable SCC into local memory",
-  "loop carried dependencies (top loop)"
+  "loop carried dependencies (top loop)",
+  "merged SCCs match a fresh SCCDAG",
+  "split SCCs match a fresh SCCDAG"
 };
 TestFunction SCCDAGAttrTestSuite::testFns[] = {
   SCCDAGAttrTestSuite::sccdagHasCorrectSCCs,
@@ -40,7 +42,9 @@ TestFunction SCCDAGAttrTestSuite::testFns[] = {
   SCCDAGAttrTestSuite::reducibleSCCsAreFound,
   SCCDAGAttrTestSuite::clonableSCCsAreFound,
   SCCDAGAttrTestSuite::clonableSCCsIntoLocalMemoryAreFound,
-  SCCDAGAttrTestSuite::loopCarriedDependencies
+  SCCDAGAttrTestSuite::loopCarriedDependencies,
+  SCCDAGAttrTestSuite::mergedSCCsMatchFreshSCCDAG,
+  SCCDAGAttrTestSuite::splitSCCsMatchFreshSCCDAG
 };
 
 bool SCCDAGAttrTestSuite::doInitialization (Module &M) {
@@ -90,6 +94,8 @@ bool SCCDAGAttrTestSuite::runOnModule (Module &M) {
   auto sccManager = loopDI->getSCCManager();
 
   this->sccdag = sccManager->getSCCDAG();
+  this->loopDG = loopDI->getLoopDG();
+  this->topLoop = topLoop;
 
   errs() << "SCCDAGAttrTestSuite: Constructing IVAttributes\n";
   auto IV = loopDI->getInvariantManager();
@@ -203,4 +209,226 @@ Values SCCDAGAttrTestSuite::loopCarriedDependencies (ModulePass &pass, TestSuite
   return valueNames;
 }
 
+std::string SCCDAGAttrTestSuite::describeSCC (TestSuite &suite, SCC *scc) {
+  std::vector<std::string> values;
+  for (auto nodePair : scc->internalNodePairs()) {
+    values.push_back(suite.valueToString(nodePair.first));
+  }
+  std::sort(values.begin(), values.end());
+  return TestSuite::combineValues(values, suite.unorderedValueDelimiter);
+}
+
+Values SCCDAGAttrTestSuite::describeSCCDAG (TestSuite &suite, SCCDAG &dag) {
+
+  /*
+   * Describe an SCCDAG by its SCCs and by the dependences between them.
+   * The direction an SCC edge has been created with is not relevant.
+   */
+  Values description;
+  for (auto node : dag.getNodes()) {
+    description.insert("SCC " + describeSCC(suite, node->getT()));
+  }
+  for (auto edge : dag.getEdges()) {
+    auto from = describeSCC(suite, edge->getOutgoingT());
+    auto to = describeSCC(suite, edge->getIncomingT());
+    if (to < from) {
+      std::swap(from, to);
+    }
+    for (auto subEdge : edge->getSubEdges()) {
+      description.insert("Edge " + from + " - " + to + " : "
+        + suite.valueToString(subEdge->getOutgoingT()) + " -> "
+        + suite.valueToString(subEdge->getIncomingT()));
+    }
+  }
+  return description;
+}
+
+Values SCCDAGAttrTestSuite::compareSCCDAGs (Values &incremental, Values &fresh, std::string update) {
+  if (incremental == fresh) {
+    return { "match" };
+  }
+
+  Values differences;
+  for (auto &v : incremental) {
+    if (fresh.find(v) == fresh.end()) {
+      differences.insert("Only after the " + update + ": " + v);
+    }
+  }
+  for (auto &v : fresh) {
+    if (incremental.find(v) == incremental.end()) {
+      differences.insert("Only after the rebuild: " + v);
+    }
+  }
+  return differences;
+}
+
+std::vector<Value *> SCCDAGAttrTestSuite::getLoopInternals (void) {
+  std::vector<Value *> loopInternals;
+  for (auto bb : this->topLoop->blocks()) {
+    for (auto &I : *bb) {
+      loopInternals.push_back(&I);
+    }
+  }
+  return loopInternals;
+}
+
+Values SCCDAGAttrTestSuite::mergedSCCsMatchFreshSCCDAG (ModulePass &pass, TestSuite &suite) {
+  auto &attrPass = static_cast<SCCDAGAttrTestSuite &>(pass);
+
+  /*
+   * Fetch the instructions of the loop.
+   */
+  auto loopInternals = attrPass.getLoopInternals();
+
+  /*
+   * Try to merge two internal SCCs connected by a dependence.
+   * The SCCDAG obtained must be the one built from scratch after adding a
+   * dependence that closes a cycle between them. That dependence is internal
+   * to the merged SCC, so it does not show up in the description.
+   */
+  auto loopInternalDG = attrPass.loopDG->createSubgraphFromValues(loopInternals, false);
+  auto candidates = new SCCDAG(loopInternalDG);
+  for (auto edge : candidates->getEdges()) {
+    auto fromSCC = edge->getOutgoingT();
+    auto toSCC = edge->getIncomingT();
+    if (false
+        || (fromSCC == toSCC)
+        || (!candidates->isInternal(fromSCC))
+        || (!candidates->isInternal(toSCC))) {
+      continue;
+    }
+
+    /*
+     * Build the SCCDAG from scratch with the dependence that closes the cycle.
+     * Skip the SCCs that would merge together with others in between.
+     */
+    auto cycleDG = attrPass.loopDG->createSubgraphFromValues(loopInternals, false);
+    auto toValue = toSCC->internalNodePairs().begin()->first;
+    auto fromValue = fromSCC->internalNodePairs().begin()->first;
+    cycleDG->addEdge(toValue, fromValue);
+    auto fresh = new SCCDAG(cycleDG);
+    auto mergedSCC = fresh->sccOfValue(fromValue);
+    if (mergedSCC->numInternalNodes() != (fromSCC->numInternalNodes() + toSCC->numInternalNodes())) {
+      delete fresh;
+      delete cycleDG;
+      continue;
+    }
+
+    /*
+     * Merge the two SCCs incrementally.
+     */
+    auto merged = new SCCDAG(loopInternalDG);
+    std::set<DGNode<SCC> *> sccsToMerge{
+      merged->fetchNode(merged->sccOfValue(fromValue)),
+      merged->fetchNode(merged->sccOfValue(toValue))
+    };
+    merged->mergeSCCs(sccsToMerge);
+
+    /*
+     * Compare them.
+     */
+    auto mergedDescription = describeSCCDAG(suite, *merged);
+    auto freshDescription = describeSCCDAG(suite, *fresh);
+    delete merged;
+    delete fresh;
+    delete cycleDG;
+    delete candidates;
+    delete loopInternalDG;
+
+    return compareSCCDAGs(mergedDescription, freshDescription, "merge");
+  }
+  delete candidates;
+  delete loopInternalDG;
+
+  return { "no SCCs to merge" };
+}
+
+Values SCCDAGAttrTestSuite::splitSCCsMatchFreshSCCDAG (ModulePass &pass, TestSuite &suite) {
+  auto &attrPass = static_cast<SCCDAGAttrTestSuite &>(pass);
+
+  /*
+   * Fetch the instructions of the loop.
+   */
+  auto loopInternals = attrPass.getLoopInternals();
+
+  /*
+   * Try to remove a dependence internal to an SCC that breaks its cycles.
+   * The SCCDAG obtained by splitting that SCC must be the one built from
+   * scratch without that dependence.
+   */
+  auto loopInternalDG = attrPass.loopDG->createSubgraphFromValues(loopInternals, false);
+  auto candidates = new SCCDAG(loopInternalDG);
+  for (auto edge : loopInternalDG->getEdges()) {
+    auto fromValue = edge->getOutgoingT();
+    auto toValue = edge->getIncomingT();
+    auto scc = candidates->sccOfValue(fromValue);
+    if (false
+        || (fromValue == toValue)
+        || (scc != candidates->sccOfValue(toValue))) {
+      continue;
+    }
+
+    /*
+     * Build the SCCDAG from scratch without the dependence.
+     * Skip the dependences whose removal leaves the SCC whole.
+     */
+    auto splitDG = attrPass.loopDG->createSubgraphFromValues(loopInternals, false, { edge });
+    auto fresh = new SCCDAG(splitDG);
+    if (fresh->numNodes() == candidates->numNodes()) {
+      delete fresh;
+      delete splitDG;
+      continue;
+    }
+
+    /*
+     * Split the SCC incrementally.
+     */
+    auto splitDGToUpdate = attrPass.loopDG->createSubgraphFromValues(loopInternals, false);
+    auto split = new SCCDAG(splitDGToUpdate);
+    for (auto copy : splitDGToUpdate->fetchEdges(splitDGToUpdate->fetchNode(fromValue), splitDGToUpdate->fetchNode(toValue))) {
+      if (true
+          && (copy->isMemoryDependence() == edge->isMemoryDependence())
+          && (copy->isControlDependence() == edge->isControlDependence())
+          && (copy->isRAWDependence() == edge->isRAWDependence())
+          && (copy->isWARDependence() == edge->isWARDependence())
+          && (copy->isWAWDependence() == edge->isWAWDependence())) {
+        splitDGToUpdate->removeEdge(copy);
+        break;
+      }
+    }
+    split->splitSCC(split->sccOfValue(fromValue), splitDGToUpdate);
+
+    /*
+     * Compare them.
+     */
+    auto splitDescription = describeSCCDAG(suite, *split);
+    auto freshDescription = describeSCCDAG(suite, *fresh);
+    auto sameOrdering = true;
+    for (auto node : fresh->getNodes()) {
+      for (auto other : fresh->getNodes()) {
+        auto incrementalFrom = split->sccOfValue(node->getT()->internalNodePairs().begin()->first);
+        auto incrementalTo = split->sccOfValue(other->getT()->internalNodePairs().begin()->first);
+        if (fresh->orderedBefore(node->getT(), other->getT()) != split->orderedBefore(incrementalFrom, incrementalTo)) {
+          sameOrdering = false;
+        }
+      }
+    }
+    delete split;
+    delete splitDGToUpdate;
+    delete fresh;
+    delete splitDG;
+    delete candidates;
+    delete loopInternalDG;
+    if (!sameOrdering) {
+      splitDescription.insert("Different ordering among SCCs");
+    }
+
+    return compareSCCDAGs(splitDescription, freshDescription, "split");
+  }
+  delete candidates;
+  delete loopInternalDG;
+
+  return { "no SCCs to split" };
+}
+
 }